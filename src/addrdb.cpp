@@ -235,7 +235,10 @@ CAddrDB::CAddrDB()
 
 bool CAddrDB::Write(const CAddrMan& addr)
 {
-    return SerializeFileDB("peers", pathAddr, addr, CLIENT_VERSION);
+    // Take a snapshot first, so addrman is locked only once and not while writing and syncing the file
+    CDataStream ssPeers(SER_DISK, CLIENT_VERSION);
+    ssPeers << addr;
+    return SerializeFileDB("peers", pathAddr, ssPeers, CLIENT_VERSION);
 }
 
 bool CAddrDB::Read(CAddrMan& addr)
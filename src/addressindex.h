@@ -114,6 +114,13 @@ public:
         return 66;
     }
 
+    friend bool operator==(const CAddressIndexKey& a, const CAddressIndexKey& b) {
+        auto to_tuple = [](const CAddressIndexKey& obj) {
+            return std::tie(obj.m_address_type, obj.m_address_bytes, obj.m_block_height, obj.m_block_tx_pos, obj.m_tx_hash, obj.m_tx_index, obj.m_tx_spent);
+        };
+        return to_tuple(a) == to_tuple(b);
+    }
+
     template<typename Stream>
     void Serialize(Stream& s) const {
         ser_writedata8(s, ToUnderlying(m_address_type));
@@ -161,6 +168,13 @@ public:
         return 21;
     }
 
+    friend bool operator<(const CAddressIndexIteratorKey& a, const CAddressIndexIteratorKey& b) {
+        auto to_tuple = [](const CAddressIndexIteratorKey& obj) {
+            return std::tie(obj.m_address_type, obj.m_address_bytes);
+        };
+        return to_tuple(a) < to_tuple(b);
+    }
+
     template<typename Stream>
     void Serialize(Stream& s) const {
         ser_writedata8(s, ToUnderlying(m_address_type));
@@ -214,6 +228,29 @@ public:
     }
 };
 
+struct CAddressBalance {
+public:
+    CAmount m_balance{0};
+    CAmount m_received{0};
+    uint64_t m_tx_count{0};
+
+public:
+    CAddressBalance() = default;
+
+    CAddressBalance(CAmount balance, CAmount received, uint64_t tx_count) :
+        m_balance{balance}, m_received{received}, m_tx_count{tx_count} {};
+
+    bool IsNull() const {
+        return m_tx_count == 0;
+    }
+
+public:
+    SERIALIZE_METHODS(CAddressBalance, obj)
+    {
+        READWRITE(obj.m_balance, obj.m_received, VARINT(obj.m_tx_count));
+    }
+};
+
 bool AddressBytesFromScript(const CScript& script, AddressType& address_type, uint160& address_bytes);
 
 #endif // BITCOIN_ADDRESSINDEX_H
@@ -7,6 +7,8 @@
 #include <random.h>
 #include <util/time.h>
 
+#include <atomic>
+#include <thread>
 #include <vector>
 
 /* A "source" is a source address from which we have received a bunch of other addresses. */
@@ -91,6 +93,35 @@ static void AddrManSelect(benchmark::Bench& bench)
     });
 }
 
+static void AddrManSelectConcurrent(benchmark::Bench& bench)
+{
+    CAddrMan addrman;
+
+    FillAddrMan(addrman);
+
+    // Other threads keep selecting like the connection opening thread and getaddr handling do
+    std::atomic<bool> stop{false};
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 3; ++i) {
+        threads.emplace_back([&] {
+            while (!stop) {
+                const auto& address = addrman.Select();
+                assert(address.GetPort() > 0);
+            }
+        });
+    }
+
+    bench.run([&] {
+        const auto& address = addrman.Select();
+        assert(address.GetPort() > 0);
+    });
+
+    stop = true;
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
 static void AddrManGetAddr(benchmark::Bench& bench)
 {
     CAddrMan addrman;
@@ -136,5 +167,6 @@ static void AddrManGood(benchmark::Bench& bench)
 
 BENCHMARK(AddrManAdd);
 BENCHMARK(AddrManSelect);
+BENCHMARK(AddrManSelectConcurrent);
 BENCHMARK(AddrManGetAddr);
 BENCHMARK(AddrManGood);
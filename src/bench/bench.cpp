@@ -6,6 +6,8 @@
 
 #include <chainparams.h>
 #include <test/util/setup_common.h>
+#include <univalue.h>
+#include <util/perfcounters.h>
 #include <validation.h>
 
 #include <algorithm>
@@ -33,6 +35,36 @@ void GenerateTemplateResults(const std::vector<ankerl::nanobench::Result>& bench
     std::cout << "Created '" << filename << "'" << std::endl;
 }
 
+// The metrics updated while the benchmarks ran, histograms as count and total and mean microseconds
+void GeneratePerfResults(const std::string& filename)
+{
+    if (filename.empty()) {
+        return;
+    }
+    UniValue metrics(UniValue::VOBJ);
+    for (const perf::MetricSnapshot& metric : perf::GetSnapshot()) {
+        UniValue entry(UniValue::VOBJ);
+        if (metric.type == perf::MetricType::HISTOGRAM) {
+            if (metric.histogram.count == 0) continue;
+            entry.pushKV("count", metric.histogram.count);
+            entry.pushKV("total_us", metric.histogram.sum);
+            entry.pushKV("mean_us", double(metric.histogram.sum) / metric.histogram.count);
+        } else {
+            if (metric.value == 0) continue;
+            entry.pushKV("value", metric.value);
+        }
+        metrics.pushKV(metric.name, entry);
+    }
+    std::ofstream fout(filename);
+    if (fout.is_open()) {
+        fout << metrics.write(4) << std::endl;
+    } else {
+        std::cout << "Could not write to file '" << filename << "'" << std::endl;
+    }
+
+    std::cout << "Created '" << filename << "'" << std::endl;
+}
+
 } // namespace
 
 benchmark::BenchRunner::BenchmarkMap& benchmark::BenchRunner::benchmarks()
@@ -83,4 +115,5 @@ void benchmark::BenchRunner::RunAll(const Args& args)
                                                                "{{#result}}{{name}}, {{epochs}}, {{average(iterations)}}, {{sumProduct(iterations, elapsed)}}, {{minimum(elapsed)}}, {{maximum(elapsed)}}, {{median(elapsed)}}\n"
                                                                "{{/result}}");
     GenerateTemplateResults(benchmarkResults, args.output_json, ankerl::nanobench::templates::json());
+    GeneratePerfResults(args.output_perf);
 }
@@ -43,6 +43,7 @@ struct Args {
     std::vector<double> asymptote;
     std::string output_csv;
     std::string output_json;
+    std::string output_perf;
 };
 
 class BenchRunner
@@ -303,6 +303,43 @@ static void BLS_Verify_Batched(benchmark::Bench& bench)
     });
 }
 
+static void BLS_Verify_BatchedRandomized(benchmark::Bench& bench)
+{
+    std::vector<CBLSPublicKey> pubKeys;
+    std::vector<CBLSSecretKey> secKeys;
+    std::vector<CBLSSignature> sigs;
+    std::vector<uint256> msgHashes;
+    std::vector<bool> invalid;
+    BuildTestVectors(1000, 0, pubKeys, secKeys, sigs, msgHashes, invalid);
+
+    // Benchmark.
+    size_t i = 0;
+    size_t j = 0;
+    size_t batchSize = 16;
+    bench.minEpochIterations(1000).run([&] {
+        j++;
+        if ((j % batchSize) != 0) {
+            return;
+        }
+
+        std::vector<CBLSPublicKey> testPubKeys;
+        std::vector<CBLSSignature> testSigs;
+        std::vector<uint256> testMsgHashes;
+        testPubKeys.reserve(batchSize);
+        testSigs.reserve(batchSize);
+        testMsgHashes.reserve(batchSize);
+        for (size_t k = 0; k < batchSize; k++) {
+            testPubKeys.emplace_back(pubKeys[i]);
+            testSigs.emplace_back(sigs[i]);
+            testMsgHashes.emplace_back(msgHashes[i]);
+            i = (i + 1) % pubKeys.size();
+        }
+
+        bool batchValid = CBLSSignature::VerifyBatchRandomized(testSigs, testPubKeys, testMsgHashes);
+        assert(batchValid);
+    });
+}
+
 static void BLS_Verify_BatchedParallel(benchmark::Bench& bench)
 {
     std::vector<CBLSPublicKey> pubKeys;
@@ -370,4 +407,5 @@ BENCHMARK(BLS_Verify_LargeAggregatedBlock100)
 BENCHMARK(BLS_Verify_LargeAggregatedBlock1000)
 BENCHMARK(BLS_Verify_LargeAggregatedBlock1000PreVerified)
 BENCHMARK(BLS_Verify_Batched)
+BENCHMARK(BLS_Verify_BatchedRandomized)
 BENCHMARK(BLS_Verify_BatchedParallel)
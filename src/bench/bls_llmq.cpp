@@ -0,0 +1,206 @@
+// Copyright (c) 2026 The Dash Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <bls/bls_batchverifier.h>
+#include <bls/bls_worker.h>
+#include <llmq/params.h>
+#include <random.h>
+
+#include <algorithm>
+#include <cassert>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+// The BLS work a node does for quorums of the real LLMQ sizes, with both the legacy and the basic scheme
+
+static const Consensus::LLMQParams& GetLLMQParams(Consensus::LLMQType type)
+{
+    const auto it = std::find_if(Consensus::available_llmqs.begin(), Consensus::available_llmqs.end(),
+                                 [type](const auto& params) { return params.type == type; });
+    assert(it != Consensus::available_llmqs.end());
+    return *it;
+}
+
+/** A quorum after a DKG, with the key shares of all members */
+class BenchQuorum
+{
+public:
+    const Consensus::LLMQParams& params;
+    std::vector<CBLSId> ids;
+    BLSVerificationVectorPtr vvec;
+    std::vector<CBLSSecretKey> skShares;
+    std::vector<CBLSPublicKey> pkShares;
+    CBLSWorker worker;
+
+private:
+    const bool prevLegacy;
+
+public:
+    BenchQuorum(Consensus::LLMQType type, bool legacy) :
+        params(GetLLMQParams(type)),
+        prevLegacy(bls::bls_legacy_scheme.exchange(legacy))
+    {
+        worker.Start();
+        FastRandomContext rng(true);
+        for (int i = 0; i < params.size; i++) {
+            ids.emplace_back(rng.rand256());
+        }
+        // One dealer gives the same kind of shares as the sum of all contributions
+        bool ok = worker.GenerateContributions(params.threshold, ids, vvec, skShares);
+        assert(ok);
+        for (const auto& skShare : skShares) {
+            pkShares.emplace_back(skShare.GetPublicKey());
+        }
+    }
+    ~BenchQuorum()
+    {
+        worker.Stop();
+        bls::bls_legacy_scheme.store(prevLegacy);
+    }
+
+    /** Shares of signHash by about 3/4 of the members, in no particular order */
+    std::vector<std::pair<size_t, CBLSSignature>> SignShares(const uint256& signHash, FastRandomContext& rng) const
+    {
+        std::vector<std::pair<size_t, CBLSSignature>> sigShares;
+        for (size_t member = 0; member < skShares.size(); member++) {
+            if (rng.randrange(4) == 0) continue;
+            sigShares.emplace_back(member, skShares[member].Sign(signHash));
+        }
+        Shuffle(sigShares.begin(), sigShares.end(), rng);
+        return sigShares;
+    }
+};
+
+static uint32_t EpochIterations(const Consensus::LLMQParams& params)
+{
+    return params.size >= 400 ? 1 : 10;
+}
+
+// One ProcessPendingSigShares round: the shares of a few signing sessions verified in one batch
+static void BLS_LLMQ_VerifySigShares(benchmark::Bench& bench, Consensus::LLMQType type, bool legacy)
+{
+    static constexpr size_t SESSIONS = 4;
+    BenchQuorum quorum(type, legacy);
+    FastRandomContext rng(true);
+    std::vector<std::pair<uint256, std::vector<std::pair<size_t, CBLSSignature>>>> sessions;
+    for (size_t i = 0; i < SESSIONS; i++) {
+        const uint256 signHash = rng.rand256();
+        sessions.emplace_back(signHash, quorum.SignShares(signHash, rng));
+    }
+
+    bench.minEpochIterations(EpochIterations(quorum.params)).run([&] {
+        CBLSBatchVerifier<size_t, std::pair<uint256, size_t>> batchVerifier(false, true, 0, &quorum.worker);
+        for (const auto& [signHash, sigShares] : sessions) {
+            for (const auto& [member, sigShare] : sigShares) {
+                batchVerifier.PushMessage(member, std::make_pair(signHash, member), signHash, sigShare, quorum.pkShares[member]);
+            }
+        }
+        batchVerifier.Verify();
+        assert(batchVerifier.badSources.empty());
+    });
+}
+
+// Recovery from the first threshold shares which arrived, as TryRecoverSig does it
+static void BLS_LLMQ_RecoverSig(benchmark::Bench& bench, Consensus::LLMQType type, bool legacy, bool worker)
+{
+    BenchQuorum quorum(type, legacy);
+    FastRandomContext rng(true);
+    const uint256 signHash = rng.rand256();
+    const auto sigShares = quorum.SignShares(signHash, rng);
+    std::vector<CBLSSignature> sigs;
+    std::vector<CBLSId> ids;
+    for (size_t i = 0; i < size_t(quorum.params.threshold); i++) {
+        sigs.emplace_back(sigShares[i].second);
+        ids.emplace_back(quorum.ids[sigShares[i].first]);
+    }
+
+    bench.minEpochIterations(EpochIterations(quorum.params)).run([&] {
+        CBLSSignature recoveredSig;
+        bool ok = worker ? quorum.worker.RecoverSig(sigs, ids, recoveredSig) : recoveredSig.Recover(sigs, ids);
+        assert(ok);
+    });
+}
+
+// The public key share of a member, which is built from the quorum verification vector once per member
+static void BLS_LLMQ_BuildPubKeyShare(benchmark::Bench& bench, Consensus::LLMQType type, bool legacy)
+{
+    BenchQuorum quorum(type, legacy);
+    size_t member = 0;
+    bench.minEpochIterations(EpochIterations(quorum.params)).run([&] {
+        const CBLSPublicKey pkShare = CBLSWorker::BuildPubKeyShare(quorum.vvec, quorum.ids[member]);
+        assert(pkShare == quorum.pkShares[member]);
+        member = (member + 1) % quorum.ids.size();
+    });
+}
+
+// Recovered signatures of many quorums, like a block's worth of islocks, verified securely in one batch
+static void BLS_LLMQ_VerifyRecoveredSigs(benchmark::Bench& bench, bool legacy)
+{
+    static constexpr size_t QUORUMS = 24;
+    static constexpr size_t SIGS_PER_QUORUM = 4;
+    const bool prevLegacy = bls::bls_legacy_scheme.exchange(legacy);
+    CBLSWorker worker;
+    worker.Start();
+    FastRandomContext rng(true);
+    std::vector<std::tuple<uint256, CBLSSignature, CBLSPublicKey>> recoveredSigs;
+    for (size_t i = 0; i < QUORUMS; i++) {
+        CBLSSecretKey quorumSk;
+        quorumSk.MakeNewKey();
+        for (size_t j = 0; j < SIGS_PER_QUORUM; j++) {
+            const uint256 signHash = rng.rand256();
+            recoveredSigs.emplace_back(signHash, quorumSk.Sign(signHash), quorumSk.GetPublicKey());
+        }
+    }
+
+    bench.minEpochIterations(10).run([&] {
+        CBLSBatchVerifier<size_t, uint256> batchVerifier(true, true, 0, &worker);
+        for (size_t i = 0; i < recoveredSigs.size(); i++) {
+            const auto& [signHash, sig, pubKey] = recoveredSigs[i];
+            batchVerifier.PushMessage(i, signHash, signHash, sig, pubKey);
+        }
+        batchVerifier.Verify();
+        assert(batchVerifier.badSources.empty());
+    });
+
+    worker.Stop();
+    bls::bls_legacy_scheme.store(prevLegacy);
+}
+
+#define BENCH_LLMQ(llmq_type, scheme, legacy) \
+    static void BLS_LLMQ_VerifySigShares_##llmq_type##_##scheme(benchmark::Bench& bench) \
+    { \
+        BLS_LLMQ_VerifySigShares(bench, Consensus::LLMQType::llmq_type, legacy); \
+    } \
+    static void BLS_LLMQ_Recover_##llmq_type##_##scheme(benchmark::Bench& bench) \
+    { \
+        BLS_LLMQ_RecoverSig(bench, Consensus::LLMQType::llmq_type, legacy, false); \
+    } \
+    static void BLS_LLMQ_RecoverWorker_##llmq_type##_##scheme(benchmark::Bench& bench) \
+    { \
+        BLS_LLMQ_RecoverSig(bench, Consensus::LLMQType::llmq_type, legacy, true); \
+    } \
+    static void BLS_LLMQ_BuildPubKeyShare_##llmq_type##_##scheme(benchmark::Bench& bench) \
+    { \
+        BLS_LLMQ_BuildPubKeyShare(bench, Consensus::LLMQType::llmq_type, legacy); \
+    } \
+    BENCHMARK(BLS_LLMQ_VerifySigShares_##llmq_type##_##scheme) \
+    BENCHMARK(BLS_LLMQ_Recover_##llmq_type##_##scheme) \
+    BENCHMARK(BLS_LLMQ_RecoverWorker_##llmq_type##_##scheme) \
+    BENCHMARK(BLS_LLMQ_BuildPubKeyShare_##llmq_type##_##scheme)
+
+BENCH_LLMQ(LLMQ_50_60, legacy, true)
+BENCH_LLMQ(LLMQ_50_60, basic, false)
+BENCH_LLMQ(LLMQ_100_67, legacy, true)
+BENCH_LLMQ(LLMQ_100_67, basic, false)
+BENCH_LLMQ(LLMQ_400_60, legacy, true)
+BENCH_LLMQ(LLMQ_400_60, basic, false)
+BENCH_LLMQ(LLMQ_400_85, legacy, true)
+BENCH_LLMQ(LLMQ_400_85, basic, false)
+
+static void BLS_LLMQ_VerifyRecoveredSigs_legacy(benchmark::Bench& bench) { BLS_LLMQ_VerifyRecoveredSigs(bench, true); }
+static void BLS_LLMQ_VerifyRecoveredSigs_basic(benchmark::Bench& bench) { BLS_LLMQ_VerifyRecoveredSigs(bench, false); }
+BENCHMARK(BLS_LLMQ_VerifyRecoveredSigs_legacy)
+BENCHMARK(BLS_LLMQ_VerifyRecoveredSigs_basic)
@@ -0,0 +1,139 @@
+// Copyright (c) 2026 The Dash Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <cachemap.h>
+#include <cachemultimap.h>
+#include <random.h>
+#include <saltedhasher.h>
+#include <uint256.h>
+#include <unordered_lru_cache.h>
+
+#include <list>
+#include <map>
+#include <vector>
+
+static constexpr size_t CACHE_SIZE = 100000;
+
+// What CacheMap used to be, a std::list for the order and a std::map for the index
+class ListMapCache
+{
+    using item_t = CacheItem<uint256, int64_t>;
+    size_t nMaxSize;
+    std::list<item_t> listItems;
+    std::map<uint256, std::list<item_t>::iterator> mapIndex;
+
+public:
+    explicit ListMapCache(size_t nMaxSizeIn) : nMaxSize(nMaxSizeIn) {}
+
+    bool Insert(const uint256& key, int64_t value)
+    {
+        if (mapIndex.count(key)) return false;
+        if (listItems.size() == nMaxSize) {
+            mapIndex.erase(listItems.back().key);
+            listItems.pop_back();
+        }
+        listItems.emplace_front(key, value);
+        mapIndex.emplace(key, listItems.begin());
+        return true;
+    }
+
+    bool HasKey(const uint256& key) const { return mapIndex.count(key); }
+};
+
+static std::vector<uint256> MakeKeys(size_t count)
+{
+    FastRandomContext rng(true);
+    std::vector<uint256> keys(count);
+    for (auto& key : keys) {
+        key = rng.rand256();
+    }
+    return keys;
+}
+
+// Inserting into a full cache, every insert evicts the oldest item
+
+template<typename Insert>
+static void InsertEvict(benchmark::Bench& bench, Insert insert)
+{
+    const std::vector<uint256> keys = MakeKeys(CACHE_SIZE * 4);
+    for (size_t i = 0; i < CACHE_SIZE; ++i) {
+        insert(keys[i]);
+    }
+    size_t i = CACHE_SIZE;
+    bench.run([&] {
+        insert(keys[i]);
+        if (++i == keys.size()) i = 0;
+    });
+}
+
+static void CacheMapInsertEvict(benchmark::Bench& bench)
+{
+    CacheMap<uint256, int64_t> cache(CACHE_SIZE);
+    InsertEvict(bench, [&](const uint256& key) { cache.Insert(key, 0); });
+}
+
+static void ListMapCacheInsertEvict(benchmark::Bench& bench)
+{
+    ListMapCache cache(CACHE_SIZE);
+    InsertEvict(bench, [&](const uint256& key) { cache.Insert(key, 0); });
+}
+
+static void UnorderedLruCacheInsertEvict(benchmark::Bench& bench)
+{
+    unordered_lru_cache<uint256, int64_t, StaticSaltedHasher> cache(CACHE_SIZE);
+    InsertEvict(bench, [&](const uint256& key) { cache.insert(key, 0); });
+}
+
+static void CacheMultiMapInsertEvict(benchmark::Bench& bench)
+{
+    // A handful of values per key, like orphan votes per governance object
+    CacheMultiMap<uint256, int64_t> cache(CACHE_SIZE);
+    int64_t n{0};
+    InsertEvict(bench, [&](const uint256& key) { cache.Insert(key, ++n % 8); });
+}
+
+// Lookups of keys which are half of the time in the cache
+
+template<typename Lookup>
+static void RunLookup(benchmark::Bench& bench, const std::vector<uint256>& keys, Lookup lookup)
+{
+    size_t i = 0;
+    bench.run([&] {
+        ankerl::nanobench::doNotOptimizeAway(lookup(keys[i]));
+        if (++i == keys.size()) i = 0;
+    });
+}
+
+static void CacheMapLookup(benchmark::Bench& bench)
+{
+    const std::vector<uint256> keys = MakeKeys(CACHE_SIZE * 2);
+    CacheMap<uint256, int64_t> cache(CACHE_SIZE);
+    for (size_t i = 0; i < CACHE_SIZE; ++i) cache.Insert(keys[i * 2], 0);
+    RunLookup(bench, keys, [&](const uint256& key) { return cache.HasKey(key); });
+}
+
+static void ListMapCacheLookup(benchmark::Bench& bench)
+{
+    const std::vector<uint256> keys = MakeKeys(CACHE_SIZE * 2);
+    ListMapCache cache(CACHE_SIZE);
+    for (size_t i = 0; i < CACHE_SIZE; ++i) cache.Insert(keys[i * 2], 0);
+    RunLookup(bench, keys, [&](const uint256& key) { return cache.HasKey(key); });
+}
+
+static void UnorderedLruCacheLookup(benchmark::Bench& bench)
+{
+    const std::vector<uint256> keys = MakeKeys(CACHE_SIZE * 2);
+    unordered_lru_cache<uint256, int64_t, StaticSaltedHasher> cache(CACHE_SIZE);
+    for (size_t i = 0; i < CACHE_SIZE; ++i) cache.insert(keys[i * 2], 0);
+    RunLookup(bench, keys, [&](const uint256& key) { return cache.exists(key); });
+}
+
+BENCHMARK(CacheMapInsertEvict);
+BENCHMARK(ListMapCacheInsertEvict);
+BENCHMARK(UnorderedLruCacheInsertEvict);
+BENCHMARK(CacheMultiMapInsertEvict);
+BENCHMARK(CacheMapLookup);
+BENCHMARK(ListMapCacheLookup);
+BENCHMARK(UnorderedLruCacheLookup);
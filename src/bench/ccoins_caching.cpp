@@ -2,12 +2,14 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include <arith_uint256.h>
 #include <bench/bench.h>
 #include <coins.h>
 #include <policy/policy.h>
 #include <script/signingprovider.h>
 #include <test/util/transaction_utils.h>
 
+#include <thread>
 #include <vector>
 
 // Microbenchmark for simple accesses to a CCoinsViewCache database. Note from
@@ -50,4 +52,40 @@ static void CCoinsCaching(benchmark::Bench& bench)
     ECC_Stop();
 }
 
+// Add, access and spend coins in caches of several threads at once, like validation threads with a view each do.
+// The cache entries come from a pool per cache, so the threads don't contend on the global allocator.
+static void CCoinsCachingParallel(benchmark::Bench& bench)
+{
+    constexpr int NUM_THREADS = 4;
+    constexpr uint32_t NUM_COINS = 2000;
+
+    CCoinsView coinsDummy;
+    const Coin coin(CTxOut(COIN, CScript() << OP_1), 1, /* fCoinBaseIn = */ false);
+
+    auto work = [&](int thread) {
+        CCoinsViewCache coins(&coinsDummy);
+        const uint256 txid{ArithToUint256(arith_uint256(thread + 1))};
+        for (uint32_t n = 0; n < NUM_COINS; ++n) {
+            coins.AddCoin(COutPoint(txid, n), Coin(coin), /* possible_overwrite = */ false);
+        }
+        for (uint32_t n = 0; n < NUM_COINS; ++n) {
+            assert(!coins.AccessCoin(COutPoint(txid, n)).IsSpent());
+        }
+        for (uint32_t n = 0; n < NUM_COINS; ++n) {
+            coins.SpendCoin(COutPoint(txid, n));
+        }
+    };
+
+    bench.run([&] {
+        std::vector<std::thread> threads;
+        for (int i = 0; i < NUM_THREADS; ++i) {
+            threads.emplace_back(work, i);
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    });
+}
+
 BENCHMARK(CCoinsCaching);
+BENCHMARK(CCoinsCachingParallel);
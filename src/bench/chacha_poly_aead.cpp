@@ -4,10 +4,12 @@
 
 
 #include <bench/bench.h>
+#include <bench/data.h>
 #include <crypto/chacha_poly_aead.h>
 #include <crypto/poly1305.h> // for the POLY1305_TAGLEN constant
 #include <hash.h>
 
+#include <algorithm>
 #include <assert.h>
 #include <limits>
 
@@ -89,6 +91,22 @@ static void CHACHA20_POLY1305_AEAD_1MB_ENCRYPT_DECRYPT(benchmark::Bench& bench)
     CHACHA20_POLY1305_AEAD(bench, BUFFER_SIZE_LARGE, true);
 }
 
+// Encrypt a block message the way it would be relayed to each peer
+
+static void CHACHA20_POLY1305_AEAD_BLOCK_ENCRYPT(benchmark::Bench& bench)
+{
+    const std::vector<uint8_t>& block = benchmark::data::block813851;
+    std::vector<unsigned char> in(CHACHA20_POLY1305_AEAD_AAD_LEN + block.size() + POLY1305_TAGLEN, 0);
+    std::copy(block.begin(), block.end(), in.begin() + CHACHA20_POLY1305_AEAD_AAD_LEN);
+    std::vector<unsigned char> out(in.size(), 0);
+    uint64_t seqnr = 0;
+    bench.batch(block.size()).unit("byte").run([&] {
+        const bool crypt_ok = aead.Crypt(seqnr, seqnr, 0, out.data(), out.size(), in.data(), CHACHA20_POLY1305_AEAD_AAD_LEN + block.size(), true);
+        assert(crypt_ok);
+        seqnr++;
+    });
+}
+
 // Add Hash() (dbl-sha256) bench for comparison
 
 static void HASH(benchmark::Bench& bench, size_t buffersize)
@@ -121,6 +139,7 @@ BENCHMARK(CHACHA20_POLY1305_AEAD_1MB_ONLY_ENCRYPT);
 BENCHMARK(CHACHA20_POLY1305_AEAD_64BYTES_ENCRYPT_DECRYPT);
 BENCHMARK(CHACHA20_POLY1305_AEAD_256BYTES_ENCRYPT_DECRYPT);
 BENCHMARK(CHACHA20_POLY1305_AEAD_1MB_ENCRYPT_DECRYPT);
+BENCHMARK(CHACHA20_POLY1305_AEAD_BLOCK_ENCRYPT);
 BENCHMARK(HASH_64BYTES);
 BENCHMARK(HASH_256BYTES);
 BENCHMARK(HASH_1MB);
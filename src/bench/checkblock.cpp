@@ -28,6 +28,23 @@ static void DeserializeBlockTest(benchmark::Bench& bench)
     });
 }
 
+// The transactions without the shared pointers and the txids, which is what reading the block without building
+// CTransaction objects could save at most
+static void DeserializeBlockMutableTxsTest(benchmark::Bench& bench)
+{
+    CDataStream stream(benchmark::data::block813851, SER_NETWORK, PROTOCOL_VERSION);
+    std::byte a{0};
+    stream.write({&a, 1}); // Prevent compaction
+
+    bench.unit("block").run([&] {
+        CBlockHeader header;
+        std::vector<CMutableTransaction> txs;
+        stream >> header >> txs;
+        bool rewound = stream.Rewind(benchmark::data::block813851.size());
+        assert(rewound);
+    });
+}
+
 static void DeserializeAndCheckBlockTest(benchmark::Bench& bench)
 {
     CDataStream stream(benchmark::data::block813851, SER_NETWORK, PROTOCOL_VERSION);
@@ -50,4 +67,5 @@ static void DeserializeAndCheckBlockTest(benchmark::Bench& bench)
 }
 
 BENCHMARK(DeserializeBlockTest);
+BENCHMARK(DeserializeBlockMutableTxsTest);
 BENCHMARK(DeserializeAndCheckBlockTest);
@@ -3,11 +3,13 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include <bench/bench.h>
+#include <coinjoin/common.h>
 #include <interfaces/chain.h>
 #include <node/context.h>
 #include <wallet/coinselection.h>
 #include <wallet/wallet.h>
 
+#include <array>
 #include <set>
 
 static void addCoin(const CAmount& nValue, const CWallet& wallet, std::vector<std::unique_ptr<CWalletTx>>& wtxs)
@@ -61,6 +63,45 @@ static void CoinSelection(benchmark::Bench& bench)
     });
 }
 
+// A wallet which mixed most of its funds, with the denominations in proportions CoinJoin tends to create
+static void CoinSelectionMixedWallet(benchmark::Bench& bench, bool fFullyMixedOnly)
+{
+    NodeContext node;
+    auto chain = interfaces::MakeChain(node);
+    CWallet wallet(chain.get(), /*coinjoin_loader=*/ nullptr, "", CreateDummyWalletDatabase());
+    wallet.SetupLegacyScriptPubKeyMan();
+    std::vector<std::unique_ptr<CWalletTx>> wtxs;
+    LOCK(wallet.cs_wallet);
+
+    static constexpr auto denoms = CoinJoin::GetStandardDenominations();
+    static constexpr std::array<int, denoms.size()> counts{50, 400, 1000, 1000, 600};
+    for (size_t i = 0; i < denoms.size(); ++i) {
+        for (int j = 0; j < counts[i]; ++j) {
+            addCoin(denoms[i], wallet, wtxs);
+        }
+    }
+    if (!fFullyMixedOnly) {
+        for (int i = 0; i < 20; ++i) {
+            addCoin(i * COIN + 12345, wallet, wtxs);
+        }
+    }
+
+    std::vector<OutputGroup> groups;
+    for (const auto& wtx : wtxs) {
+        COutput output(wtx.get(), 0 /* iIn */, 6 * 24 /* nDepthIn */, true /* spendable */, true /* solvable */, true /* safe */);
+        groups.emplace_back(output.GetInputCoin(), 6, false, 0, 0);
+    }
+    bench.run([&] {
+        std::set<CInputCoin> setCoinsRet;
+        CAmount nValueRet;
+        bool success = KnapsackSolver(123 * COIN + 45678901, groups, setCoinsRet, nValueRet, fFullyMixedOnly, COIN / 10);
+        assert(success);
+    });
+}
+
+static void CoinSelectionFullyMixed(benchmark::Bench& bench) { CoinSelectionMixedWallet(bench, true); }
+static void CoinSelectionMixedWalletKnapsack(benchmark::Bench& bench) { CoinSelectionMixedWallet(bench, false); }
+
 typedef std::set<CInputCoin> CoinSet;
 static NodeContext testNode;
 static auto testChain = interfaces::MakeChain(testNode);
@@ -112,3 +153,5 @@ static void BnBExhaustion(benchmark::Bench& bench)
 
 BENCHMARK(CoinSelection);
 BENCHMARK(BnBExhaustion);
+BENCHMARK(CoinSelectionFullyMixed);
+BENCHMARK(CoinSelectionMixedWalletKnapsack);
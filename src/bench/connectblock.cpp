@@ -0,0 +1,63 @@
+// Copyright (c) 2026 The Dash Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <chain.h>
+#include <consensus/validation.h>
+#include <script/script.h>
+#include <test/util/setup_common.h>
+#include <validation.h>
+
+#include <cassert>
+#include <memory>
+#include <vector>
+
+// The last blocks of a chain after the DIP3 activation are disconnected and connected again through
+// ConnectTip, so every run reads them from disk and goes through ConnectBlock with the special
+// transaction, quorum commitment and credit pool processing. Run with -output_perf to get the time
+// of each stage from the validation.connectblock and validation.connecttip histograms.
+static void ConnectBlockReplay(benchmark::Bench& bench)
+{
+    constexpr int REPLAY_BLOCKS{10};
+    constexpr int TXS_PER_BLOCK{20};
+    const auto setup = std::make_unique<TestChainDIP3Setup>();
+    CChainState& chainstate = setup->m_node.chainman->ActiveChainstate();
+    const CScript script_pub = CScript() << ToByteVector(setup->coinbaseKey.GetPubKey()) << OP_CHECKSIG;
+
+    // Blocks with a coinbase payload and transactions spending the mature coinbases of the setup chain
+    size_t next_coinbase{0};
+    for (int b = 0; b < REPLAY_BLOCKS; ++b) {
+        std::vector<CMutableTransaction> txs;
+        for (int i = 0; i < TXS_PER_BLOCK; ++i) {
+            const CTransactionRef coinbase = setup->m_coinbase_txns.at(next_coinbase);
+            txs.push_back(setup->CreateValidMempoolTransaction(coinbase, 0, next_coinbase + 1, setup->coinbaseKey, script_pub,
+                                                               coinbase->vout[0].nValue - 1000, /* submit */ false));
+            ++next_coinbase;
+        }
+        setup->CreateAndProcessBlock(txs, script_pub);
+    }
+
+    CBlockIndex* first_replayed;
+    const CBlockIndex* tip;
+    {
+        LOCK(cs_main);
+        tip = chainstate.m_chain.Tip();
+        first_replayed = chainstate.m_chain[tip->nHeight - REPLAY_BLOCKS + 1];
+    }
+
+    bench.minEpochIterations(5).run([&] {
+        BlockValidationState state;
+        bool ok = chainstate.InvalidateBlock(state, first_replayed);
+        assert(ok);
+        {
+            LOCK(cs_main);
+            chainstate.ResetBlockFailureFlags(first_replayed);
+        }
+        ok = chainstate.ActivateBestChain(state);
+        assert(ok);
+        assert(WITH_LOCK(cs_main, return chainstate.m_chain.Tip()) == tip);
+    });
+}
+
+BENCHMARK(ConnectBlockReplay);
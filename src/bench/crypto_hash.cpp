@@ -57,6 +57,26 @@ static void HASH_1MB_DSHA256(benchmark::Bench& bench)
     });
 }
 
+static void HASH_X16R_0080b_single(benchmark::Bench& bench)
+{
+    const uint256 prev = uint256S("0x0123456789abcdeffedcba98765432100123456789abcdeffedcba9876543210");
+    std::vector<uint8_t> in(80,0);
+    bench.minEpochIterations(1000).run([&] {
+        ankerl::nanobench::doNotOptimizeAway(HashX11(in.begin(), in.end(), prev));
+        ++in[76];
+    });
+}
+
+static void HASH_X16R_0080b_schedule(benchmark::Bench& bench)
+{
+    const X16RSchedule schedule(uint256S("0x0123456789abcdeffedcba98765432100123456789abcdeffedcba9876543210"));
+    std::vector<uint8_t> in(80,0);
+    bench.minEpochIterations(1000).run([&] {
+        ankerl::nanobench::doNotOptimizeAway(schedule.Hash(in.begin(), in.end()));
+        ++in[76];
+    });
+}
+
 static void HASH_1MB_SHA512(benchmark::Bench& bench)
 {
     uint8_t hash[CSHA512::OUTPUT_SIZE];
@@ -162,6 +182,16 @@ static void HASH_SHA256D64_1024(benchmark::Bench& bench)
     });
 }
 
+/* Hash 1024 blobs 64 bytes each via SHA256, as done for masternode scores */
+
+static void HASH_SHA256S64_1024(benchmark::Bench& bench)
+{
+    std::vector<uint8_t> in(64 * 1024, 0);
+    bench.minEpochIterations(1000).run([&] {
+        SHA256S64(in.data(), in.data(), 1024);
+    });
+}
+
 /* FastRandom for uint32_t and bool */
 
 static void FastRandom_32bit(benchmark::Bench& bench)
@@ -242,6 +272,8 @@ BENCHMARK(HASH_DSHA256_0128b_single);
 BENCHMARK(HASH_DSHA256_0512b_single);
 BENCHMARK(HASH_DSHA256_1024b_single);
 BENCHMARK(HASH_DSHA256_2048b_single);
+BENCHMARK(HASH_X16R_0080b_single);
+BENCHMARK(HASH_X16R_0080b_schedule);
 // BENCHMARK(HASH_X11_0032b_single);
 // BENCHMARK(HASH_X11_0080b_single);
 // BENCHMARK(HASH_X11_0128b_single);
@@ -253,6 +285,7 @@ BENCHMARK(HASH_SHA256_32b);
 BENCHMARK(HASH_SipHash_32b);
 
 BENCHMARK(HASH_SHA256D64_1024);
+BENCHMARK(HASH_SHA256S64_1024);
 
 BENCHMARK(FastRandom_32bit);
 BENCHMARK(FastRandom_1bit);
@@ -0,0 +1,53 @@
+// Copyright (c) 2026 The Dash Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <dbwrapper.h>
+#include <random.h>
+#include <uint256.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+using RootTransaction = CDBTransaction<CDBWrapper, CDBBatch>;
+using CurTransaction = CDBTransaction<RootTransaction, RootTransaction>;
+
+static const std::string DB_ENTRY = "bench_e";
+
+// Nested transactions like the evodb ones while connecting a block: a few thousand entries are
+// written and read back in the inner transaction, which is then committed through the root
+// transaction into a batch
+static void DBTransactionConnectBlock(benchmark::Bench& bench)
+{
+    static constexpr size_t ENTRIES = 2000;
+
+    CDBWrapper db("", 1 << 20, true, true);
+    CDBBatch batch(db);
+    RootTransaction root(db, batch);
+    CurTransaction cur(root, root);
+
+    FastRandomContext rng(true);
+    std::vector<uint256> keys(ENTRIES);
+    for (auto& key : keys) {
+        key = rng.rand256();
+    }
+    const std::vector<unsigned char> value(200, 0x42);
+
+    bench.batch(ENTRIES).unit("entry").run([&] {
+        for (const auto& key : keys) {
+            cur.Write(std::make_pair(DB_ENTRY, key), value);
+        }
+        std::vector<unsigned char> read_value;
+        for (size_t i = 0; i < keys.size(); i += 2) {
+            cur.Read(std::make_pair(DB_ENTRY, keys[i]), read_value);
+        }
+        cur.Commit();
+        root.Commit();
+        db.WriteBatch(batch);
+        batch.Clear();
+    });
+}
+
+BENCHMARK(DBTransactionConnectBlock);
@@ -0,0 +1,275 @@
+// Copyright (c) 2026 The Dash Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <bls/bls.h>
+#include <chain.h>
+#include <clientversion.h>
+#include <evo/deterministicmns.h>
+#include <evo/simplifiedmns.h>
+#include <netbase.h>
+#include <random.h>
+#include <script/standard.h>
+#include <streams.h>
+#include <test/util/setup_common.h>
+#include <tinyformat.h>
+
+#include <cassert>
+#include <memory>
+#include <vector>
+
+// Masternode lists of mainnet size, with the share of Evo nodes and PoSe banned masternodes mainnet has
+static constexpr size_t REGULAR_MNS = 3500;
+static constexpr size_t EVO_MNS = 500;
+static constexpr int LIST_HEIGHT = 2000000;
+
+static CDeterministicMNCPtr MakeBenchMN(uint64_t internalId, MnType type, int height, FastRandomContext& rng)
+{
+    auto dmn = std::make_shared<CDeterministicMN>(internalId, type);
+    dmn->proTxHash = rng.rand256();
+    dmn->collateralOutpoint = COutPoint(dmn->proTxHash, 1);
+    dmn->nOperatorReward = rng.randrange(2) ? 0 : rng.randrange(10000);
+
+    auto state = std::make_shared<CDeterministicMNState>();
+    state->nVersion = CProRegTx::BASIC_BLS_VERSION;
+    state->nRegisteredHeight = height - 1 - rng.randrange(500000);
+    state->nLastPaidHeight = height - 1 - rng.randrange(REGULAR_MNS + EVO_MNS);
+    state->UpdateConfirmedHash(dmn->proTxHash, rng.rand256());
+    state->keyIDOwner = CKeyID(uint160(rng.randbytes(20)));
+    state->keyIDVoting = rng.randrange(4) ? state->keyIDOwner : CKeyID(uint160(rng.randbytes(20)));
+    CBLSSecretKey sk;
+    sk.MakeNewKey();
+    state->pubKeyOperator.Set(sk.GetPublicKey(), bls::bls_legacy_scheme.load());
+    const bool ok = Lookup(strprintf("%d.%d.%d.%d", 1 + (internalId >> 16) % 200, (internalId >> 8) & 0xff, internalId & 0xff, 1 + rng.randrange(250)),
+                           state->addr, 9999, false);
+    assert(ok);
+    state->scriptPayout = GetScriptForDestination(PKHash(uint160(rng.randbytes(20))));
+    if (dmn->nOperatorReward != 0) {
+        state->scriptOperatorPayout = GetScriptForDestination(PKHash(uint160(rng.randbytes(20))));
+    }
+    if (type == MnType::Evo) {
+        state->platformNodeID = uint160(rng.randbytes(20));
+        state->platformP2PPort = 26656;
+        state->platformHTTPPort = 443;
+    }
+    if (rng.randrange(50) == 0) {
+        state->BanIfNotBanned(height - rng.randrange(1000));
+    }
+    dmn->pdmnState = state;
+    return dmn;
+}
+
+static CDeterministicMNList MakeBenchMNList(FastRandomContext& rng)
+{
+    CDeterministicMNList mnList(rng.rand256(), LIST_HEIGHT, 0);
+    for (uint64_t i = 0; i < REGULAR_MNS + EVO_MNS; i++) {
+        mnList.AddMN(MakeBenchMN(i, i < EVO_MNS ? MnType::Evo : MnType::Regular, LIST_HEIGHT, rng));
+    }
+    return mnList;
+}
+
+/** What a block does to the list: a payment, a few service and PoSe updates, a registration and a revocation */
+static CDeterministicMNList MakeNextBenchMNList(const CDeterministicMNList& mnList, FastRandomContext& rng)
+{
+    CDeterministicMNList next = mnList;
+    next.SetBlockHash(rng.rand256());
+    next.SetHeight(mnList.GetHeight() + 1);
+
+    std::vector<CDeterministicMNCPtr> mns;
+    next.ForEachMNShared(false, [&](const CDeterministicMNCPtr& dmn) { mns.emplace_back(dmn); });
+
+    const auto payee = mns[rng.randrange(mns.size())];
+    auto paidState = std::make_shared<CDeterministicMNState>(*payee->pdmnState);
+    paidState->nLastPaidHeight = next.GetHeight();
+    next.UpdateMN(*payee, paidState);
+    for (int i = 0; i < 10; i++) {
+        const auto dmn = next.GetMN(mns[rng.randrange(mns.size())]->proTxHash);
+        auto newState = std::make_shared<CDeterministicMNState>(*dmn->pdmnState);
+        newState->nPoSePenalty++;
+        next.UpdateMN(*dmn, newState);
+    }
+    next.RemoveMN(mns[rng.randrange(mns.size())]->proTxHash);
+    next.AddMN(MakeBenchMN(next.GetTotalRegisteredCount(), MnType::Regular, next.GetHeight(), rng));
+    return next;
+}
+
+static void DMNList_ForEachMN(benchmark::Bench& bench)
+{
+    const auto testing_setup = MakeNoLogFileContext<const BasicTestingSetup>(CBaseChainParams::MAIN);
+    FastRandomContext rng(true);
+    const CDeterministicMNList mnList = MakeBenchMNList(rng);
+
+    bench.run([&] {
+        size_t weight{0};
+        mnList.ForEachMN(true, [&](const CDeterministicMN& dmn) { weight += GetMnType(dmn.nType).voting_weight; });
+        assert(weight > REGULAR_MNS);
+    });
+}
+
+static void DMNList_CalculateQuorum(benchmark::Bench& bench, size_t size, bool onlyEvoNodes)
+{
+    const auto testing_setup = MakeNoLogFileContext<const BasicTestingSetup>(CBaseChainParams::MAIN);
+    FastRandomContext rng(true);
+    const CDeterministicMNList mnList = MakeBenchMNList(rng);
+
+    bench.run([&] {
+        const auto members = mnList.CalculateQuorum(size, rng.rand256(), onlyEvoNodes);
+        assert(members.size() == size);
+    });
+}
+
+static void DMNList_CalculateQuorum_50(benchmark::Bench& bench) { DMNList_CalculateQuorum(bench, 50, false); }
+static void DMNList_CalculateQuorum_400(benchmark::Bench& bench) { DMNList_CalculateQuorum(bench, 400, false); }
+static void DMNList_CalculateQuorum_Evo_100(benchmark::Bench& bench) { DMNList_CalculateQuorum(bench, 100, true); }
+
+static void DMNList_GetProjectedMNPayees(benchmark::Bench& bench)
+{
+    const auto testing_setup = MakeNoLogFileContext<const BasicTestingSetup>(CBaseChainParams::MAIN);
+    FastRandomContext rng(true);
+    const CDeterministicMNList mnList = MakeBenchMNList(rng);
+    const uint256 blockHash = mnList.GetBlockHash();
+    CBlockIndex index;
+    index.phashBlock = &blockHash;
+    index.nHeight = 0;
+
+    bench.run([&] {
+        const auto payees = mnList.GetProjectedMNPayees(&index);
+        assert(payees.size() >= mnList.GetValidMNsCount());
+    });
+}
+
+static void DMNList_BuildDiff(benchmark::Bench& bench)
+{
+    const auto testing_setup = MakeNoLogFileContext<const BasicTestingSetup>(CBaseChainParams::MAIN);
+    FastRandomContext rng(true);
+    const CDeterministicMNList mnList = MakeBenchMNList(rng);
+    const CDeterministicMNList next = MakeNextBenchMNList(mnList, rng);
+
+    bench.run([&] {
+        const auto diff = mnList.BuildDiff(next);
+        assert(diff.addedMNs.size() == 1 && diff.removedMns.size() == 1);
+    });
+}
+
+static void DMNList_ApplyDiff(benchmark::Bench& bench)
+{
+    const auto testing_setup = MakeNoLogFileContext<const BasicTestingSetup>(CBaseChainParams::MAIN);
+    FastRandomContext rng(true);
+    const CDeterministicMNList mnList = MakeBenchMNList(rng);
+    const CDeterministicMNList next = MakeNextBenchMNList(mnList, rng);
+    const auto diff = mnList.BuildDiff(next);
+    const uint256 blockHash = next.GetBlockHash();
+    CBlockIndex index;
+    index.phashBlock = &blockHash;
+    index.nHeight = next.GetHeight();
+
+    bench.run([&] {
+        const auto applied = mnList.ApplyDiff(&index, diff);
+        assert(applied.GetAllMNsCount() == next.GetAllMNsCount());
+    });
+}
+
+// The encoding of full lists on the network and the compact one of the snapshots in evoDB
+static void DMNList_Serialize(benchmark::Bench& bench, bool compact)
+{
+    const auto testing_setup = MakeNoLogFileContext<const BasicTestingSetup>(CBaseChainParams::MAIN);
+    FastRandomContext rng(true);
+    const CDeterministicMNList mnList = MakeBenchMNList(rng);
+
+    bench.run([&] {
+        CDataStream ss(SER_DISK, CLIENT_VERSION);
+        if (compact) {
+            mnList.SerializeCompact(ss);
+        } else {
+            ss << mnList;
+        }
+        assert(!ss.empty());
+    });
+}
+
+static void DMNList_Unserialize(benchmark::Bench& bench, bool compact)
+{
+    const auto testing_setup = MakeNoLogFileContext<const BasicTestingSetup>(CBaseChainParams::MAIN);
+    FastRandomContext rng(true);
+    const CDeterministicMNList mnList = MakeBenchMNList(rng);
+    CDataStream serialized(SER_DISK, CLIENT_VERSION);
+    if (compact) {
+        mnList.SerializeCompact(serialized);
+    } else {
+        serialized << mnList;
+    }
+
+    bench.run([&] {
+        CDataStream ss = serialized;
+        CDeterministicMNList result;
+        if (compact) {
+            result.UnserializeCompact(ss);
+        } else {
+            ss >> result;
+        }
+        assert(result.GetAllMNsCount() == mnList.GetAllMNsCount());
+    });
+}
+
+static void DMNList_Serialize_Full(benchmark::Bench& bench) { DMNList_Serialize(bench, false); }
+static void DMNList_Serialize_Compact(benchmark::Bench& bench) { DMNList_Serialize(bench, true); }
+static void DMNList_Unserialize_Full(benchmark::Bench& bench) { DMNList_Unserialize(bench, false); }
+static void DMNList_Unserialize_Compact(benchmark::Bench& bench) { DMNList_Unserialize(bench, true); }
+
+static void SimplifiedMNList_Build(benchmark::Bench& bench)
+{
+    const auto testing_setup = MakeNoLogFileContext<const BasicTestingSetup>(CBaseChainParams::MAIN);
+    FastRandomContext rng(true);
+    const CDeterministicMNList mnList = MakeBenchMNList(rng);
+
+    bench.run([&] {
+        const CSimplifiedMNList sml(mnList);
+        assert(sml.mnList.size() == mnList.GetAllMNsCount());
+    });
+}
+
+static void SimplifiedMNList_CalcMerkleRoot(benchmark::Bench& bench)
+{
+    const auto testing_setup = MakeNoLogFileContext<const BasicTestingSetup>(CBaseChainParams::MAIN);
+    FastRandomContext rng(true);
+    const CSimplifiedMNList sml(MakeBenchMNList(rng));
+
+    bench.run([&] {
+        bool mutated{true};
+        const uint256 root = sml.CalcMerkleRoot(&mutated);
+        assert(!root.IsNull() && !mutated);
+    });
+}
+
+// What CalcCbTxMerkleRootMNList costs per block with the tree kept from the previous block
+static void SimplifiedMNList_MerkleTreeUpdate(benchmark::Bench& bench)
+{
+    const auto testing_setup = MakeNoLogFileContext<const BasicTestingSetup>(CBaseChainParams::MAIN);
+    FastRandomContext rng(true);
+    const CDeterministicMNList mnList = MakeBenchMNList(rng);
+    const CDeterministicMNList next = MakeNextBenchMNList(mnList, rng);
+    CSimplifiedMNListMerkleTree tree;
+    tree.Update(mnList);
+
+    bool forward{true};
+    bench.run([&] {
+        tree.Update(forward ? next : mnList);
+        forward = !forward;
+    });
+}
+
+BENCHMARK(DMNList_ForEachMN)
+BENCHMARK(DMNList_CalculateQuorum_50)
+BENCHMARK(DMNList_CalculateQuorum_400)
+BENCHMARK(DMNList_CalculateQuorum_Evo_100)
+BENCHMARK(DMNList_GetProjectedMNPayees)
+BENCHMARK(DMNList_BuildDiff)
+BENCHMARK(DMNList_ApplyDiff)
+BENCHMARK(DMNList_Serialize_Full)
+BENCHMARK(DMNList_Serialize_Compact)
+BENCHMARK(DMNList_Unserialize_Full)
+BENCHMARK(DMNList_Unserialize_Compact)
+BENCHMARK(SimplifiedMNList_Build)
+BENCHMARK(SimplifiedMNList_CalcMerkleRoot)
+BENCHMARK(SimplifiedMNList_MerkleTreeUpdate)
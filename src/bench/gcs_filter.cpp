@@ -4,6 +4,12 @@
 
 #include <bench/bench.h>
 #include <blockfilter.h>
+#include <ctpl_stl.h>
+#include <util/system.h>
+
+#include <algorithm>
+#include <future>
+#include <vector>
 
 static void ConstructGCSFilter(benchmark::Bench& bench)
 {
@@ -22,6 +28,35 @@ static void ConstructGCSFilter(benchmark::Bench& bench)
     });
 }
 
+// Filters of a batch of blocks built on several threads, like BlockFilterIndex does while catching up
+static void ConstructGCSFilterMultiThreaded(benchmark::Bench& bench)
+{
+    static constexpr int BATCH_SIZE = 100;
+
+    GCSFilter::ElementSet elements;
+    for (int i = 0; i < 1000; ++i) {
+        GCSFilter::Element element(32);
+        element[0] = static_cast<unsigned char>(i);
+        element[1] = static_cast<unsigned char>(i >> 8);
+        elements.insert(std::move(element));
+    }
+
+    ctpl::thread_pool pool(std::clamp(GetNumCores() - 1, 1, 8));
+    uint64_t siphash_k0 = 0;
+    bench.batch(elements.size() * BATCH_SIZE).unit("elem").run([&] {
+        std::vector<std::future<void>> futures;
+        futures.reserve(BATCH_SIZE);
+        for (int i = 0; i < BATCH_SIZE; ++i) {
+            futures.emplace_back(pool.push([&elements, k0 = siphash_k0++](int) {
+                GCSFilter filter({k0, 0, 20, 1 << 20}, elements);
+            }));
+        }
+        for (auto& future : futures) {
+            future.get();
+        }
+    });
+}
+
 static void MatchGCSFilter(benchmark::Bench& bench)
 {
     GCSFilter::ElementSet elements;
@@ -39,4 +74,5 @@ static void MatchGCSFilter(benchmark::Bench& bench)
 }
 
 BENCHMARK(ConstructGCSFilter);
+BENCHMARK(ConstructGCSFilterMultiThreaded);
 BENCHMARK(MatchGCSFilter);
@@ -0,0 +1,78 @@
+// Copyright (c) 2026 The Dash Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <hash.h>
+#include <primitives/block.h>
+#include <uint256.h>
+
+#include <crypto-X16R/ethash/helpers.hpp>
+#include <crypto-X16R/ethash/include/ethash/progpow.hpp>
+
+static CBlockHeader MakeKAWPOWHeader()
+{
+    CBlockHeader header;
+    header.nVersion = 4;
+    header.hashPrevBlock = uint256S("0x2b1f8e4a3c5d6e7f8091a2b3c4d5e6f708192a3b4c5d6e7f8091a2b3c4d5e6f7");
+    header.hashMerkleRoot = uint256S("0x9c8b7a6f5e4d3c2b1a09f8e7d6c5b4a39281706f5e4d3c2b1a09f8e7d6c5b4a3");
+    header.nTime = 1700000000;
+    header.nBits = 0x1e0fffff;
+    header.nHeight = 1000000;
+    header.nNonce64 = 0x0123456789abcdefULL;
+    header.mix_hash = uint256S("0x5e4d3c2b1a09f8e7d6c5b4a39281706f5e4d3c2b1a09f8e7d6c5b4a392817060");
+    return header;
+}
+
+// The hex round-trip that KAWPOWHash_OnlyMix used to do around progpow for every header
+static void KAWPOWConvertHex(benchmark::Bench& bench)
+{
+    const CBlockHeader header = MakeKAWPOWHeader();
+    const uint256 header_hash = header.GetKAWPOWHeaderHash();
+    bench.run([&] {
+        const auto h = to_hash256(header_hash.GetHex());
+        const auto m = to_hash256(header.mix_hash.GetHex());
+        ankerl::nanobench::doNotOptimizeAway(uint256S(to_hex(h)));
+        ankerl::nanobench::doNotOptimizeAway(uint256S(to_hex(m)));
+    });
+}
+
+static void KAWPOWConvertBinary(benchmark::Bench& bench)
+{
+    const CBlockHeader header = MakeKAWPOWHeader();
+    const uint256 header_hash = header.GetKAWPOWHeaderHash();
+    bench.run([&] {
+        const auto h = UintToEthashHash(header_hash);
+        const auto m = UintToEthashHash(header.mix_hash);
+        ankerl::nanobench::doNotOptimizeAway(EthashHashToUint(h));
+        ankerl::nanobench::doNotOptimizeAway(EthashHashToUint(m));
+    });
+}
+
+static void KAWPOWHashOnlyMix(benchmark::Bench& bench)
+{
+    CBlockHeader header = MakeKAWPOWHeader();
+    bench.run([&] {
+        const uint256 hash = KAWPOWHash_OnlyMix(header);
+        ankerl::nanobench::doNotOptimizeAway(hash);
+        ++header.nNonce64;
+    });
+}
+
+// A full progpow hash with the light cache, as done for every header which is verified
+static void KAWPOWHashLight(benchmark::Bench& bench)
+{
+    const CBlockHeader header = MakeKAWPOWHeader();
+    const auto header_hash = UintToEthashHash(header.GetKAWPOWHeaderHash());
+    const auto& context = ethash::get_global_epoch_context(ethash::get_epoch_number(header.nHeight));
+    uint64_t nonce = header.nNonce64;
+    bench.minEpochIterations(10).run([&] {
+        const auto result = progpow::hash(context, header.nHeight, header_hash, nonce++);
+        ankerl::nanobench::doNotOptimizeAway(result);
+    });
+}
+
+BENCHMARK(KAWPOWConvertHex);
+BENCHMARK(KAWPOWConvertBinary);
+BENCHMARK(KAWPOWHashOnlyMix);
+BENCHMARK(KAWPOWHashLight);
@@ -26,7 +26,7 @@ struct Available {
     Available(CTransactionRef& ref, size_t tx_count) : ref(ref), tx_count(tx_count){}
 };
 
-static void ComplexMemPool(benchmark::Bench& bench)
+static void RunComplexMemPool(benchmark::Bench& bench, bool cluster_order)
 {
     int childTxs = 800;
     if (bench.complexityN() > 1) {
@@ -78,7 +78,7 @@ static void ComplexMemPool(benchmark::Bench& bench)
         available_coins.emplace_back(ordered_coins.back(), tx_counter++);
     }
     const auto testing_setup = MakeNoLogFileContext<const TestingSetup>(CBaseChainParams::MAIN);
-    CTxMemPool pool;
+    CTxMemPool pool(/* estimator */ nullptr, /* check_ratio */ 0, cluster_order);
     LOCK2(cs_main, pool.cs);
     bench.run([&]() NO_THREAD_SAFETY_ANALYSIS {
         for (auto& tx : ordered_coins) {
@@ -89,4 +89,8 @@ static void ComplexMemPool(benchmark::Bench& bench)
     });
 }
 
+static void ComplexMemPool(benchmark::Bench& bench) { RunComplexMemPool(bench, /* cluster_order */ false); }
+static void ComplexMemPoolCluster(benchmark::Bench& bench) { RunComplexMemPool(bench, /* cluster_order */ true); }
+
 BENCHMARK(ComplexMemPool);
+BENCHMARK(ComplexMemPoolCluster);
@@ -5,17 +5,24 @@
 #include <bench/bench.h>
 
 #include <consensus/merkle.h>
+#include <merkleblock.h>
 #include <random.h>
 #include <uint256.h>
 
-static void MerkleRoot(benchmark::Bench& bench)
+static std::vector<uint256> RandomLeaves(size_t count)
 {
     FastRandomContext rng(true);
     std::vector<uint256> leaves;
-    leaves.resize(9001);
+    leaves.resize(count);
     for (auto& item : leaves) {
         item = rng.rand256();
     }
+    return leaves;
+}
+
+static void MerkleRootOf(benchmark::Bench& bench, size_t count)
+{
+    std::vector<uint256> leaves = RandomLeaves(count);
     bench.batch(leaves.size()).unit("leaf").run([&] {
         bool mutation = false;
         uint256 hash = ComputeMerkleRoot(std::vector<uint256>(leaves), &mutation);
@@ -23,4 +30,27 @@ static void MerkleRoot(benchmark::Bench& bench)
     });
 }
 
+// A merkle proof for a few transactions, as for merkleblock and the coinbase proofs
+static void PartialMerkleTreeOf(benchmark::Bench& bench, size_t count)
+{
+    const std::vector<uint256> leaves = RandomLeaves(count);
+    std::vector<bool> matches(leaves.size());
+    for (size_t i = 0; i < matches.size(); i += 500) {
+        matches[i] = true;
+    }
+    bench.batch(leaves.size()).unit("leaf").run([&] {
+        CPartialMerkleTree tree(leaves, matches);
+        ankerl::nanobench::doNotOptimizeAway(tree);
+    });
+}
+
+static void MerkleRoot(benchmark::Bench& bench) { MerkleRootOf(bench, 9001); }
+// about the number of entries of the simplified masternode list
+static void MerkleRoot_SML(benchmark::Bench& bench) { MerkleRootOf(bench, 3500); }
+static void PartialMerkleTree_1000(benchmark::Bench& bench) { PartialMerkleTreeOf(bench, 1000); }
+static void PartialMerkleTree_9001(benchmark::Bench& bench) { PartialMerkleTreeOf(bench, 9001); }
+
 BENCHMARK(MerkleRoot);
+BENCHMARK(MerkleRoot_SML);
+BENCHMARK(PartialMerkleTree_1000);
+BENCHMARK(PartialMerkleTree_9001);
@@ -0,0 +1,52 @@
+// Copyright (c) 2026 The Dash Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <crypto/muhash.h>
+#include <ctpl_stl.h>
+#include <node/coinstats.h>
+#include <random.h>
+#include <streams.h>
+#include <version.h>
+
+#include <algorithm>
+#include <cassert>
+#include <memory>
+#include <vector>
+
+// Adding a snapshot worth of coins to a MuHash, as gettxoutsetinfo and the coinstats index do it
+
+static constexpr size_t MUHASH_ELEMENTS{10000};
+
+static void MuHashCoins(benchmark::Bench& bench, int threads)
+{
+    FastRandomContext rng(true);
+    std::vector<CDataStream> elements;
+    for (size_t i = 0; i < MUHASH_ELEMENTS; i++) {
+        CDataStream ss(SER_DISK, PROTOCOL_VERSION);
+        ss << rng.rand256() << rng.rand64();
+        elements.emplace_back(std::move(ss));
+    }
+    std::unique_ptr<ctpl::thread_pool> pool;
+    if (threads > 0) pool = std::make_unique<ctpl::thread_pool>(threads);
+
+    uint256 expected;
+    bench.batch(MUHASH_ELEMENTS).unit("coin").run([&] {
+        MuHash3072 acc;
+        ParallelMuHash muhash(acc, pool.get());
+        for (const auto& element : elements) {
+            muhash.Insert(CDataStream(element));
+        }
+        uint256 out;
+        muhash.Finish().Finalize(out);
+        if (expected.IsNull()) expected = out;
+        assert(out == expected);
+    });
+}
+
+static void MuHashCoins_Sequential(benchmark::Bench& bench) { MuHashCoins(bench, 0); }
+static void MuHashCoins_Parallel(benchmark::Bench& bench) { MuHashCoins(bench, std::max(GetMuHashThreads(), 1)); }
+
+BENCHMARK(MuHashCoins_Sequential)
+BENCHMARK(MuHashCoins_Parallel)
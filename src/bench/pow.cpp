@@ -0,0 +1,200 @@
+// Copyright (c) 2026 The Dash Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <chain.h>
+#include <chainparams.h>
+#include <hash.h>
+#include <pow.h>
+#include <primitives/block.h>
+#include <random.h>
+#include <uint256.h>
+#include <util/system.h>
+
+#include <crypto-X16R/ethash/include/ethash/ethash.hpp>
+
+#include <cstring>
+#include <limits>
+#include <vector>
+
+// X16R, one bench per algorithm: every round of the schedule runs the same one
+
+static uint256 SingleAlgorithmPrevHash(int algo)
+{
+    // GetHashSelection() reads the nibbles stored in the first 8 bytes
+    uint256 prev;
+    std::memset(prev.begin(), algo * 0x11, 8);
+    return prev;
+}
+
+static void X16RSingleAlgorithm(benchmark::Bench& bench, int algo)
+{
+    const uint256 prev = SingleAlgorithmPrevHash(algo);
+    assert(GetHashSelection(prev, 0) == algo && GetHashSelection(prev, 15) == algo);
+    std::vector<uint8_t> in(80, 0);
+    bench.run([&] {
+        const uint256 hash = HashX11(in.begin(), in.end(), prev);
+        std::memcpy(in.data(), hash.begin(), 32);
+    });
+}
+
+static void POW_X16R_00_BLAKE(benchmark::Bench& bench) { X16RSingleAlgorithm(bench, 0); }
+static void POW_X16R_01_BMW(benchmark::Bench& bench) { X16RSingleAlgorithm(bench, 1); }
+static void POW_X16R_02_GROESTL(benchmark::Bench& bench) { X16RSingleAlgorithm(bench, 2); }
+static void POW_X16R_03_JH(benchmark::Bench& bench) { X16RSingleAlgorithm(bench, 3); }
+static void POW_X16R_04_KECCAK(benchmark::Bench& bench) { X16RSingleAlgorithm(bench, 4); }
+static void POW_X16R_05_SKEIN(benchmark::Bench& bench) { X16RSingleAlgorithm(bench, 5); }
+static void POW_X16R_06_LUFFA(benchmark::Bench& bench) { X16RSingleAlgorithm(bench, 6); }
+static void POW_X16R_07_CUBEHASH(benchmark::Bench& bench) { X16RSingleAlgorithm(bench, 7); }
+static void POW_X16R_08_SHAVITE(benchmark::Bench& bench) { X16RSingleAlgorithm(bench, 8); }
+static void POW_X16R_09_SIMD(benchmark::Bench& bench) { X16RSingleAlgorithm(bench, 9); }
+static void POW_X16R_10_ECHO(benchmark::Bench& bench) { X16RSingleAlgorithm(bench, 10); }
+static void POW_X16R_11_HAMSI(benchmark::Bench& bench) { X16RSingleAlgorithm(bench, 11); }
+static void POW_X16R_12_FUGUE(benchmark::Bench& bench) { X16RSingleAlgorithm(bench, 12); }
+static void POW_X16R_13_SHABAL(benchmark::Bench& bench) { X16RSingleAlgorithm(bench, 13); }
+static void POW_X16R_14_WHIRLPOOL(benchmark::Bench& bench) { X16RSingleAlgorithm(bench, 14); }
+static void POW_X16R_15_SHA512(benchmark::Bench& bench) { X16RSingleAlgorithm(bench, 15); }
+
+// X16R the way the chain sees it: a different schedule for every parent
+static void POW_X16R_MIXED_SCHEDULES(benchmark::Bench& bench)
+{
+    FastRandomContext rng(true);
+    std::vector<uint256> prevs;
+    for (int i = 0; i < 16; ++i) {
+        prevs.push_back(rng.rand256());
+    }
+    std::vector<uint8_t> in(80, 0);
+    size_t i = 0;
+    bench.run([&] {
+        const uint256 hash = HashX11(in.begin(), in.end(), prevs[i++ % prevs.size()]);
+        std::memcpy(in.data(), hash.begin(), 32);
+    });
+}
+
+// KAWPOW, alternating between the last block of epoch 0 and the first of epoch 1
+
+static std::vector<CBlockHeader> MakeEpochSwitchHeaders()
+{
+    std::vector<CBlockHeader> headers(2);
+    for (size_t i = 0; i < headers.size(); ++i) {
+        headers[i].nVersion = 4;
+        headers[i].hashPrevBlock = uint256S("0x2b1f8e4a3c5d6e7f8091a2b3c4d5e6f708192a3b4c5d6e7f8091a2b3c4d5e6f7");
+        headers[i].hashMerkleRoot = uint256S("0x9c8b7a6f5e4d3c2b1a09f8e7d6c5b4a39281706f5e4d3c2b1a09f8e7d6c5b4a3");
+        headers[i].nTime = 1700000000;
+        headers[i].nBits = 0x1e0fffff;
+        headers[i].nHeight = ethash::epoch_length - 1 + i;
+        uint256 mix_hash;
+        // Also gets both epoch contexts built before timing starts
+        KAWPOWHash(headers[i], mix_hash);
+        headers[i].mix_hash = mix_hash;
+    }
+    return headers;
+}
+
+static void POW_KAWPOW_HASH_EPOCH_SWITCH(benchmark::Bench& bench)
+{
+    std::vector<CBlockHeader> headers = MakeEpochSwitchHeaders();
+    size_t i = 0;
+    bench.run([&] {
+        CBlockHeader& header = headers[i++ % headers.size()];
+        uint256 mix_hash;
+        ankerl::nanobench::doNotOptimizeAway(KAWPOWHash(header, mix_hash));
+        ++header.nNonce64;
+    });
+}
+
+static void POW_KAWPOW_ONLYMIX_EPOCH_SWITCH(benchmark::Bench& bench)
+{
+    std::vector<CBlockHeader> headers = MakeEpochSwitchHeaders();
+    size_t i = 0;
+    bench.run([&] {
+        CBlockHeader& header = headers[i++ % headers.size()];
+        ankerl::nanobench::doNotOptimizeAway(KAWPOWHash_OnlyMix(header));
+        ++header.nNonce64;
+    });
+}
+
+// What a node pays once per epoch to build the light cache
+static void POW_KAWPOW_LIGHT_CONTEXT(benchmark::Bench& bench)
+{
+    bench.epochs(3).epochIterations(1).run([&] {
+        const auto context = ethash::create_epoch_context(0);
+        assert(context);
+        ankerl::nanobench::doNotOptimizeAway(context->light_cache_num_items);
+    });
+}
+
+// Difficulty retargeting over a long chain with jittery times and targets
+
+static constexpr size_t RETARGET_CHAIN_LENGTH = 100000;
+
+static std::vector<CBlockIndex> MakeRetargetChain()
+{
+    FastRandomContext rng(true);
+    std::vector<CBlockIndex> chain(RETARGET_CHAIN_LENGTH);
+    for (size_t i = 0; i < chain.size(); ++i) {
+        chain[i].pprev = i ? &chain[i - 1] : nullptr;
+        chain[i].nHeight = i;
+        chain[i].nTime = 1600000000 + i * 60 + rng.randrange(60);
+        chain[i].nBits = 0x1b0f0000 + rng.randrange(0xffff);
+        chain[i].BuildSkip();
+    }
+    return chain;
+}
+
+static Consensus::Params RetargetParams(bool dgw)
+{
+    ArgsManager bench_args;
+    Consensus::Params params = CreateChainParams(bench_args, CBaseChainParams::MAIN)->GetConsensus();
+    params.nMinimumDifficultyBlocks = 0;
+    params.fPowAllowMinDifficultyBlocks = false;
+    params.fPowNoRetargeting = false;
+    params.nPowKGWHeight = 0;
+    params.nPowDGWHeight = dgw ? 0 : std::numeric_limits<int>::max();
+    // A day long timespan, so KGW may look back up to a week of blocks
+    params.nPowTargetTimespan = 24 * 60 * 60;
+    params.nPowTargetSpacing = 60;
+    return params;
+}
+
+static void Retarget(benchmark::Bench& bench, bool dgw)
+{
+    const std::vector<CBlockIndex> chain = MakeRetargetChain();
+    const Consensus::Params params = RetargetParams(dgw);
+    CBlockHeader header;
+    size_t height = chain.size() / 2;
+    bench.run([&] {
+        // Walk through tips so this isn't only measuring a hot cache
+        const CBlockIndex* tip = &chain[height];
+        header.nTime = tip->nTime + 60;
+        ankerl::nanobench::doNotOptimizeAway(GetNextWorkRequired(tip, &header, params));
+        if (++height == chain.size()) height = chain.size() / 2;
+    });
+}
+
+static void POW_DARK_GRAVITY_WAVE(benchmark::Bench& bench) { Retarget(bench, true); }
+static void POW_KIMOTO_GRAVITY_WELL(benchmark::Bench& bench) { Retarget(bench, false); }
+
+BENCHMARK(POW_X16R_00_BLAKE);
+BENCHMARK(POW_X16R_01_BMW);
+BENCHMARK(POW_X16R_02_GROESTL);
+BENCHMARK(POW_X16R_03_JH);
+BENCHMARK(POW_X16R_04_KECCAK);
+BENCHMARK(POW_X16R_05_SKEIN);
+BENCHMARK(POW_X16R_06_LUFFA);
+BENCHMARK(POW_X16R_07_CUBEHASH);
+BENCHMARK(POW_X16R_08_SHAVITE);
+BENCHMARK(POW_X16R_09_SIMD);
+BENCHMARK(POW_X16R_10_ECHO);
+BENCHMARK(POW_X16R_11_HAMSI);
+BENCHMARK(POW_X16R_12_FUGUE);
+BENCHMARK(POW_X16R_13_SHABAL);
+BENCHMARK(POW_X16R_14_WHIRLPOOL);
+BENCHMARK(POW_X16R_15_SHA512);
+BENCHMARK(POW_X16R_MIXED_SCHEDULES);
+BENCHMARK(POW_KAWPOW_HASH_EPOCH_SWITCH);
+BENCHMARK(POW_KAWPOW_ONLYMIX_EPOCH_SWITCH);
+BENCHMARK(POW_KAWPOW_LIGHT_CONTEXT);
+BENCHMARK(POW_DARK_GRAVITY_WAVE);
+BENCHMARK(POW_KIMOTO_GRAVITY_WELL);
@@ -0,0 +1,115 @@
+// Copyright (c) 2026 The Dash Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <llmq/signing_shares.h>
+#include <random.h>
+
+#include <vector>
+
+// The SigShareMap work of one CSigSharesManager cycle on a node in LLMQ_400 quorums
+
+static constexpr size_t SESSIONS = 40;
+static constexpr uint16_t MEMBERS = 400;
+
+static std::vector<uint256> MakeSignHashes()
+{
+    FastRandomContext rng(true);
+    std::vector<uint256> signHashes;
+    for (size_t i = 0; i < SESSIONS; ++i) {
+        signHashes.push_back(rng.rand256());
+    }
+    return signHashes;
+}
+
+static llmq::SigShareKey Key(const uint256& signHash, uint16_t member) { return std::make_pair(signHash, member); }
+
+static llmq::SigShareMap<llmq::CSigShare> MakeSigShares(const std::vector<uint256>& signHashes)
+{
+    FastRandomContext rng(true);
+    llmq::SigShareMap<llmq::CSigShare> sigShares;
+    for (const auto& signHash : signHashes) {
+        // Shares trickle in in no particular order, and only about 3/4 of the members send theirs
+        for (uint16_t member = 0; member < MEMBERS; ++member) {
+            if (rng.randrange(4) == 0) continue;
+            llmq::CSigShare sigShare(Consensus::LLMQType::LLMQ_400_60, signHash, signHash, signHash, member, CBLSLazySignature());
+            sigShare.key = Key(signHash, member);
+            sigShares.Add(sigShare.key, sigShare);
+        }
+    }
+    return sigShares;
+}
+
+// CollectSigSharesToSend: look up the shares a peer asked for
+static void SIGSHARES_COLLECT_TO_SEND(benchmark::Bench& bench)
+{
+    const auto signHashes = MakeSignHashes();
+    auto sigShares = MakeSigShares(signHashes);
+    bench.run([&] {
+        size_t found = 0;
+        for (const auto& signHash : signHashes) {
+            for (uint16_t member = 0; member < MEMBERS; member += 2) {
+                if (sigShares.Get(Key(signHash, member)) != nullptr) ++found;
+            }
+        }
+        ankerl::nanobench::doNotOptimizeAway(found);
+    });
+}
+
+// CollectSigSharesToAnnounce: walk the queued announcements and look up each share
+static void SIGSHARES_COLLECT_TO_ANNOUNCE(benchmark::Bench& bench)
+{
+    const auto signHashes = MakeSignHashes();
+    auto sigShares = MakeSigShares(signHashes);
+    llmq::SigShareMap<bool> queuedToAnnounce;
+    sigShares.ForEach([&](const llmq::SigShareKey& k, const llmq::CSigShare&) { queuedToAnnounce.Add(k, true); });
+    bench.run([&] {
+        size_t found = 0;
+        queuedToAnnounce.ForEach([&](const llmq::SigShareKey& k, bool) {
+            if (const auto* sigShare = sigShares.Get(k)) found += sigShare->getQuorumMember();
+        });
+        ankerl::nanobench::doNotOptimizeAway(found);
+    });
+}
+
+// Cleanup: several passes over all shares, and timing out requests
+static void SIGSHARES_CLEANUP(benchmark::Bench& bench)
+{
+    const auto signHashes = MakeSignHashes();
+    auto sigShares = MakeSigShares(signHashes);
+    llmq::SigShareMap<int64_t> requested;
+    sigShares.ForEach([&](const llmq::SigShareKey& k, const llmq::CSigShare&) { requested.Add(k, k.second); });
+    bench.run([&] {
+        size_t count = 0;
+        sigShares.ForEach([&](const llmq::SigShareKey&, const llmq::CSigShare& sigShare) {
+            count += size_t(sigShare.getLlmqType());
+        });
+        // Nothing times out, so every cycle sees the same map
+        requested.EraseIf([&](const llmq::SigShareKey&, int64_t t) { return t > MEMBERS; });
+        ankerl::nanobench::doNotOptimizeAway(count);
+    });
+}
+
+// Shares coming and going in random order, like pendingIncomingSigShares
+static void SIGSHARES_ADD_ERASE(benchmark::Bench& bench)
+{
+    const auto signHashes = MakeSignHashes();
+    std::vector<llmq::SigShareKey> keys;
+    for (const auto& signHash : signHashes) {
+        for (uint16_t member = 0; member < MEMBERS; ++member) {
+            keys.push_back(Key(signHash, member));
+        }
+    }
+    Shuffle(keys.begin(), keys.end(), FastRandomContext(true));
+    llmq::SigShareMap<int64_t> pending;
+    bench.run([&] {
+        for (const auto& k : keys) pending.Add(k, k.second);
+        for (const auto& k : keys) pending.Erase(k);
+    });
+}
+
+BENCHMARK(SIGSHARES_COLLECT_TO_SEND);
+BENCHMARK(SIGSHARES_COLLECT_TO_ANNOUNCE);
+BENCHMARK(SIGSHARES_CLEANUP);
+BENCHMARK(SIGSHARES_ADD_ERASE);
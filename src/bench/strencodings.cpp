@@ -0,0 +1,72 @@
+// Copyright (c) 2026 The Dash Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <random.h>
+#include <uint256.h>
+#include <util/strencodings.h>
+
+#include <string>
+#include <vector>
+
+// Hashes as printed by getblock, getrawmempool, protx list and the like
+static void HexStrHash(benchmark::Bench& bench)
+{
+    const uint256 hash = GetRandHash();
+    bench.run([&] {
+        ankerl::nanobench::doNotOptimizeAway(HexStr(hash));
+    });
+}
+
+static void Uint256GetHex(benchmark::Bench& bench)
+{
+    const uint256 hash = GetRandHash();
+    bench.run([&] {
+        ankerl::nanobench::doNotOptimizeAway(hash.GetHex());
+    });
+}
+
+static void Uint256WriteHex(benchmark::Bench& bench)
+{
+    const uint256 hash = GetRandHash();
+    char out[64];
+    bench.run([&] {
+        hash.WriteHex(out);
+        ankerl::nanobench::doNotOptimizeAway(out);
+    });
+}
+
+static void Uint256SetHex(benchmark::Bench& bench)
+{
+    const std::string hex = GetRandHash().GetHex();
+    bench.run([&] {
+        ankerl::nanobench::doNotOptimizeAway(uint256S(hex));
+    });
+}
+
+// A serialized transaction of a typical size, as in getrawtransaction and sendrawtransaction
+static void HexStrTx(benchmark::Bench& bench)
+{
+    FastRandomContext rng(true);
+    const std::vector<unsigned char> data = rng.randbytes(250);
+    bench.batch(data.size()).unit("byte").run([&] {
+        ankerl::nanobench::doNotOptimizeAway(HexStr(data));
+    });
+}
+
+static void ParseHexTx(benchmark::Bench& bench)
+{
+    FastRandomContext rng(true);
+    const std::string hex = HexStr(rng.randbytes(250));
+    bench.batch(hex.size() / 2).unit("byte").run([&] {
+        ankerl::nanobench::doNotOptimizeAway(ParseHex(hex));
+    });
+}
+
+BENCHMARK(HexStrHash);
+BENCHMARK(Uint256GetHex);
+BENCHMARK(Uint256WriteHex);
+BENCHMARK(Uint256SetHex);
+BENCHMARK(HexStrTx);
+BENCHMARK(ParseHexTx);
@@ -3,6 +3,9 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include <bench/bench.h>
+#include <primitives/transaction.h>
+#include <random.h>
+#include <script/interpreter.h>
 #include <script/script.h>
 #include <script/standard.h>
 
@@ -31,3 +34,35 @@ static void VerifyNestedIfScript(benchmark::Bench& bench) {
 
 
 BENCHMARK(VerifyNestedIfScript);
+
+// A CoinJoin final transaction: as many inputs as outputs of one denomination, every input signed with SIGHASH_ALL
+static void LegacySigHashCoinJoin(benchmark::Bench& bench, size_t inputs, bool midstates)
+{
+    FastRandomContext rng(true);
+    CMutableTransaction mtx;
+    for (size_t i = 0; i < inputs; ++i) {
+        mtx.vin.emplace_back(COutPoint(rng.rand256(), rng.randrange(10)));
+        mtx.vout.emplace_back(100001, GetScriptForDestination(PKHash(uint160(rng.randbytes(20)))));
+    }
+    const CTransaction tx(mtx);
+    const CScript scriptCode = GetScriptForDestination(PKHash(uint160(rng.randbytes(20))));
+
+    bench.unit("tx").run([&] {
+        PrecomputedTransactionData txdata;
+        if (midstates) txdata.Init(tx, {});
+        for (unsigned int i = 0; i < tx.vin.size(); ++i) {
+            const uint256 sighash = SignatureHash(scriptCode, tx, i, SIGHASH_ALL, 0, SigVersion::BASE, midstates ? &txdata : nullptr);
+            ankerl::nanobench::doNotOptimizeAway(sighash);
+        }
+    });
+}
+
+static void LegacySigHashCoinJoin_20(benchmark::Bench& bench) { LegacySigHashCoinJoin(bench, 20, false); }
+static void LegacySigHashCoinJoin_20_Midstates(benchmark::Bench& bench) { LegacySigHashCoinJoin(bench, 20, true); }
+static void LegacySigHashCoinJoin_180(benchmark::Bench& bench) { LegacySigHashCoinJoin(bench, 180, false); }
+static void LegacySigHashCoinJoin_180_Midstates(benchmark::Bench& bench) { LegacySigHashCoinJoin(bench, 180, true); }
+
+BENCHMARK(LegacySigHashCoinJoin_20);
+BENCHMARK(LegacySigHashCoinJoin_20_Midstates);
+BENCHMARK(LegacySigHashCoinJoin_180);
+BENCHMARK(LegacySigHashCoinJoin_180_Midstates);
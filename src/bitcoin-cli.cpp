@@ -11,6 +11,7 @@
 #include <chainparamsbase.h>
 #include <clientversion.h>
 #include <compat.h>
+#include <fs.h>
 #include <rpc/client.h>
 #include <rpc/mining.h>
 #include <rpc/protocol.h>
@@ -18,13 +19,16 @@
 #include <stacktraces.h>
 #include <tinyformat.h>
 #include <util/strencodings.h>
+#include <util/string.h>
 #include <util/system.h>
 #include <util/translation.h>
 #include <util/url.h>
 
 #include <algorithm>
 #include <cmath>
+#include <exception>
 #include <functional>
+#include <map>
 #include <memory>
 #include <optional>
 #include <stdio.h>
@@ -44,6 +48,10 @@ UrlDecodeFn* const URL_DECODE = urlDecode;
 static const char DEFAULT_RPCCONNECT[] = "127.0.0.1";
 static const int DEFAULT_HTTP_CLIENT_TIMEOUT=900;
 static const bool DEFAULT_NAMED=false;
+static const int DEFAULT_BATCH_SIZE = 50;
+static const int MAX_BATCH_SIZE = 1000;
+static const int DEFAULT_BATCH_CONNECTIONS = 4;
+static const int MAX_BATCH_CONNECTIONS = 64;
 static const int CONTINUE_EXECUTION=-1;
 
 /** Default number of blocks to generate for RPC generatetoaddress. */
@@ -58,6 +66,9 @@ static void SetupCliArgs(ArgsManager& argsman)
     const auto regtestBaseParams = CreateBaseChainParams(CBaseChainParams::REGTEST);
 
     argsman.AddArg("-version", "Print version and exit", ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-batch=<file>", "Run the commands of <file>, or of standard input without one, and print their replies as one JSON object per line in the same order. Commands are one per line, the method and its arguments separated by spaces or as a JSON array. The exit code is 1 if any command failed", ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-batchconnections=<n>", strprintf("Number of connections -batch sends commands over at a time, up to %d (default: %d)", MAX_BATCH_CONNECTIONS, DEFAULT_BATCH_CONNECTIONS), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-batchsize=<n>", strprintf("Number of commands -batch sends as one JSON-RPC batch, up to %d (default: %d)", MAX_BATCH_SIZE, DEFAULT_BATCH_SIZE), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-conf=<file>", strprintf("Specify configuration file. Relative paths will be prefixed by datadir location. (default: %s)", BITCOIN_CONF_FILENAME), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-datadir=<dir>", "Specify data directory", ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-generate", strprintf("Generate blocks immediately, equivalent to RPC getnewaddress followed by RPC generatetoaddress. Optional positional integer arguments are number of blocks to generate (default: %s) and maximum iterations to try (default: %s), equivalent to RPC generatetoaddress nblocks and maxtries arguments. Example: dash-cli -generate 4 1000", DEFAULT_NBLOCKS, DEFAULT_MAX_TRIES), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
@@ -594,48 +605,38 @@ public:
     }
 };
 
-static UniValue CallRPC(BaseRequestHandler* rh, const std::string& strMethod, const std::vector<std::string>& args, const std::optional<std::string>& rpcwallet = {})
+/** The host and port of the RPC server. In preference order the port is -rpcport, the one in -rpcconnect and the default port for the chain. */
+static void GetRPCHostPort(std::string& host, uint16_t& port)
 {
-    std::string host;
-    // In preference order, we choose the following for the port:
-    //     1. -rpcport
-    //     2. port in -rpcconnect (ie following : in ipv4 or ]: in ipv6)
-    //     3. default port for chain
-    uint16_t port{BaseParams().RPCPort()};
+    port = BaseParams().RPCPort();
     SplitHostPort(gArgs.GetArg("-rpcconnect", DEFAULT_RPCCONNECT), port, host);
     port = static_cast<uint16_t>(gArgs.GetArg("-rpcport", port));
+}
 
-    // Obtain event base
-    raii_event_base base = obtain_event_base();
-
+/** Set up a connection to the RPC server with the -rpcclienttimeout, it connects with the first request */
+static raii_evhttp_connection ConnectRPC(struct event_base* base, const std::string& host, uint16_t port)
+{
     // Synchronously look up hostname
-    raii_evhttp_connection evcon = obtain_evhttp_connection_base(base.get(), host, port);
+    raii_evhttp_connection evcon = obtain_evhttp_connection_base(base, host, port);
 
-    // Set connection timeout
-    {
-        const int timeout = gArgs.GetArg("-rpcclienttimeout", DEFAULT_HTTP_CLIENT_TIMEOUT);
-        if (timeout > 0) {
-            evhttp_connection_set_timeout(evcon.get(), timeout);
-        } else {
-            // Indefinite request timeouts are not possible in libevent-http, so we
-            // set the timeout to a very long time period instead.
+    const int timeout = gArgs.GetArg("-rpcclienttimeout", DEFAULT_HTTP_CLIENT_TIMEOUT);
+    if (timeout > 0) {
+        evhttp_connection_set_timeout(evcon.get(), timeout);
+    } else {
+        // Indefinite request timeouts are not possible in libevent-http, so we
+        // set the timeout to a very long time period instead.
 
-            constexpr int YEAR_IN_SECONDS = 31556952; // Average length of year in Gregorian calendar
-            evhttp_connection_set_timeout(evcon.get(), 5 * YEAR_IN_SECONDS);
-        }
+        constexpr int YEAR_IN_SECONDS = 31556952; // Average length of year in Gregorian calendar
+        evhttp_connection_set_timeout(evcon.get(), 5 * YEAR_IN_SECONDS);
     }
+    return evcon;
+}
 
-    HTTPReply response;
-    raii_evhttp_request req = obtain_evhttp_request(http_request_done, (void*)&response);
-    if (req == nullptr)
-        throw std::runtime_error("create http request failed");
-#if LIBEVENT_VERSION_NUMBER >= 0x02010300
-    evhttp_request_set_error_cb(req.get(), http_error_cb);
-#endif
-
-    // Get credentials
+/** The credentials of -rpcuser and -rpcpassword, or of the auth cookie without a password */
+static std::string GetRPCUserColonPass(bool& failedToGetAuthCookie)
+{
     std::string strRPCUserColonPass;
-    bool failedToGetAuthCookie = false;
+    failedToGetAuthCookie = false;
     if (gArgs.GetArg("-rpcpassword", "") == "") {
         // Try fall back to cookie-based authentication if no password is provided
         if (!GetAuthCookie(&strRPCUserColonPass)) {
@@ -644,21 +645,37 @@ static UniValue CallRPC(BaseRequestHandler* rh, const std::string& strMethod, co
     } else {
         strRPCUserColonPass = gArgs.GetArg("-rpcuser", "") + ":" + gArgs.GetArg("-rpcpassword", "");
     }
+    return strRPCUserColonPass;
+}
+
+/** Create a POST request of strRequest, the connection is closed after it unless keep_alive */
+static raii_evhttp_request PrepareHTTPRequest(void (*cb)(struct evhttp_request*, void*), void* ctx, const std::string& host,
+                                              const std::string& strRPCUserColonPass, const std::string& strRequest, bool keep_alive)
+{
+    raii_evhttp_request req = obtain_evhttp_request(cb, ctx);
+    if (req == nullptr)
+        throw std::runtime_error("create http request failed");
+#if LIBEVENT_VERSION_NUMBER >= 0x02010300
+    evhttp_request_set_error_cb(req.get(), http_error_cb);
+#endif
 
     struct evkeyvalq* output_headers = evhttp_request_get_output_headers(req.get());
     assert(output_headers);
     evhttp_add_header(output_headers, "Host", host.c_str());
-    evhttp_add_header(output_headers, "Connection", "close");
+    if (!keep_alive) evhttp_add_header(output_headers, "Connection", "close");
     evhttp_add_header(output_headers, "Content-Type", "application/json");
     evhttp_add_header(output_headers, "Authorization", (std::string("Basic ") + EncodeBase64(strRPCUserColonPass)).c_str());
 
     // Attach request data
-    std::string strRequest = rh->PrepareRequest(strMethod, args).write() + "\n";
     struct evbuffer* output_buffer = evhttp_request_get_output_buffer(req.get());
     assert(output_buffer);
     evbuffer_add(output_buffer, strRequest.data(), strRequest.size());
+    return req;
+}
 
-    // check if we should use a special wallet endpoint
+/** The path of the RPC endpoint, with -rpcwallet the one of the wallet */
+static std::string GetRPCEndpoint(const std::optional<std::string>& rpcwallet)
+{
     std::string endpoint = "/";
     if (rpcwallet) {
         char* encodedURI = evhttp_uriencode(rpcwallet->data(), rpcwallet->size(), false);
@@ -669,14 +686,12 @@ static UniValue CallRPC(BaseRequestHandler* rh, const std::string& strMethod, co
             throw CConnectionFailed("uri-encode failed");
         }
     }
-    int r = evhttp_make_request(evcon.get(), req.get(), EVHTTP_REQ_POST, endpoint.c_str());
-    req.release(); // ownership moved to evcon in above call
-    if (r != 0) {
-        throw CConnectionFailed("send http request failed");
-    }
-
-    event_base_dispatch(base.get());
+    return endpoint;
+}
 
+/** Throw for replies which carry no JSON-RPC reply and parse the body of the others */
+static UniValue ParseHTTPReply(const HTTPReply& response, const std::string& host, uint16_t port, bool failedToGetAuthCookie)
+{
     if (response.status == 0) {
         std::string responseErrorMessage;
         if (response.error != -1) {
@@ -698,11 +713,42 @@ static UniValue CallRPC(BaseRequestHandler* rh, const std::string& strMethod, co
     else if (response.body.empty())
         throw std::runtime_error("no response from server");
 
-    // Parse reply
     UniValue valReply(UniValue::VSTR);
     if (!valReply.read(response.body))
         throw std::runtime_error("couldn't parse reply from server");
-    const UniValue reply = rh->ProcessReply(valReply);
+    return valReply;
+}
+
+static UniValue CallRPC(BaseRequestHandler* rh, const std::string& strMethod, const std::vector<std::string>& args, const std::optional<std::string>& rpcwallet = {})
+{
+    std::string host;
+    uint16_t port;
+    GetRPCHostPort(host, port);
+
+    // Obtain event base
+    raii_event_base base = obtain_event_base();
+    raii_evhttp_connection evcon = ConnectRPC(base.get(), host, port);
+
+    // Get credentials
+    bool failedToGetAuthCookie;
+    const std::string strRPCUserColonPass = GetRPCUserColonPass(failedToGetAuthCookie);
+
+    HTTPReply response;
+    const std::string strRequest = rh->PrepareRequest(strMethod, args).write() + "\n";
+    raii_evhttp_request req = PrepareHTTPRequest(http_request_done, (void*)&response, host, strRPCUserColonPass, strRequest, /* keep_alive= */ false);
+
+    // check if we should use a special wallet endpoint
+    const std::string endpoint = GetRPCEndpoint(rpcwallet);
+    int r = evhttp_make_request(evcon.get(), req.get(), EVHTTP_REQ_POST, endpoint.c_str());
+    req.release(); // ownership moved to evcon in above call
+    if (r != 0) {
+        throw CConnectionFailed("send http request failed");
+    }
+
+    event_base_dispatch(base.get());
+
+    // Parse reply
+    const UniValue reply = rh->ProcessReply(ParseHTTPReply(response, host, port, failedToGetAuthCookie));
     if (reply.empty())
         throw std::runtime_error("expected reply to have result, error and id properties");
 
@@ -824,6 +870,184 @@ static void SetGenerateToAddressArgs(const std::string& address, std::vector<std
     args.emplace(args.begin() + 1, address);
 }
 
+/** Split a line of -batch into the method and its arguments, JSON arrays hold arguments with spaces */
+static std::vector<std::string> ParseBatchCommand(const std::string& line)
+{
+    std::vector<std::string> args;
+    if (line[0] == '[') {
+        UniValue command;
+        if (!command.read(line) || !command.isArray() || command.empty() || !command[0].isStr()) {
+            throw std::runtime_error("expected a JSON array of the method and its arguments");
+        }
+        for (const UniValue& arg : command.getValues()) {
+            args.push_back(arg.isStr() ? arg.get_str() : arg.write());
+        }
+    } else {
+        for (std::string& arg : SplitString(line, " \t")) {
+            if (!arg.empty()) args.push_back(std::move(arg));
+        }
+    }
+    if (args.empty()) throw std::runtime_error("empty command");
+    return args;
+}
+
+/**
+ * Runs the commands of -batch. Up to -batchsize of them are sent as one JSON-RPC batch, and each of the
+ * -batchconnections keep-alive connections has one batch in flight. The replies are printed as one JSON object
+ * per line in the order of the commands, as soon as the replies of all commands before them are in.
+ */
+class BatchRPC
+{
+public:
+    explicit BatchRPC(std::istream& input) :
+        m_input(input),
+        m_batch_size(std::clamp<int64_t>(gArgs.GetArg("-batchsize", DEFAULT_BATCH_SIZE), 1, MAX_BATCH_SIZE)),
+        m_rpcwallet(gArgs.IsArgSet("-rpcwallet") ? std::optional<std::string>{gArgs.GetArg("-rpcwallet", "")} : std::nullopt)
+    {
+    }
+
+    /** Returns whether all commands succeeded, throws if the server couldn't be reached */
+    bool Run()
+    {
+        GetRPCHostPort(m_host, m_port);
+        m_userpass = GetRPCUserColonPass(m_failed_auth_cookie);
+        m_endpoint = GetRPCEndpoint(m_rpcwallet);
+
+        m_base = obtain_event_base();
+        const int n_connections = std::clamp<int64_t>(gArgs.GetArg("-batchconnections", DEFAULT_BATCH_CONNECTIONS), 1, MAX_BATCH_CONNECTIONS);
+        for (int i = 0; i < n_connections; ++i) {
+            m_connections.push_back(ConnectRPC(m_base.get(), m_host, m_port));
+        }
+        for (auto& evcon : m_connections) {
+            SendNext(evcon.get());
+        }
+        if (m_in_flight > 0) {
+            event_base_dispatch(m_base.get());
+        }
+        m_connections.clear();
+        if (m_exception) std::rethrow_exception(m_exception);
+        return m_success;
+    }
+
+private:
+    struct Request {
+        BatchRPC& batch;
+        struct evhttp_connection* evcon;
+        size_t index;
+        //! the ids of the commands, and the replies of the ones which failed before they were sent
+        std::vector<std::pair<int, UniValue>> commands;
+        HTTPReply reply;
+    };
+
+    std::istream& m_input;
+    const size_t m_batch_size;
+    const std::optional<std::string> m_rpcwallet;
+    std::string m_host;
+    uint16_t m_port;
+    std::string m_userpass;
+    bool m_failed_auth_cookie{false};
+    std::string m_endpoint;
+
+    //! the connections go first, they may still hold requests pointing here
+    std::map<size_t, std::unique_ptr<Request>> m_requests;
+    raii_event_base m_base;
+    std::vector<raii_evhttp_connection> m_connections;
+    int m_in_flight{0};
+    int m_next_id{0};
+    size_t m_next_index{0};
+    //! the replies of the batches, printed once all before them are
+    std::map<size_t, std::vector<UniValue>> m_replies;
+    size_t m_next_print{0};
+    bool m_success{true};
+    std::exception_ptr m_exception;
+
+    /** Send the next batch of commands over evcon, until the input ends */
+    void SendNext(struct evhttp_connection* evcon)
+    {
+        while (!m_exception) {
+            auto request = std::make_unique<Request>(Request{*this, evcon, m_next_index, {}, {}});
+            UniValue batch(UniValue::VARR);
+            std::string line;
+            while (request->commands.size() < m_batch_size && std::getline(m_input, line)) {
+                line = TrimString(line);
+                if (line.empty() || line[0] == '#') continue;
+                const int id = ++m_next_id;
+                try {
+                    const std::vector<std::string> args = ParseBatchCommand(line);
+                    const std::vector<std::string> params(args.begin() + 1, args.end());
+                    batch.push_back(JSONRPCRequestObj(args.at(0), gArgs.GetBoolArg("-named", DEFAULT_NAMED) ? RPCConvertNamedValues(args[0], params) : RPCConvertValues(args[0], params), id));
+                    request->commands.emplace_back(id, NullUniValue);
+                } catch (const std::exception& e) {
+                    request->commands.emplace_back(id, JSONRPCReplyObj(NullUniValue, JSONRPCError(RPC_PARSE_ERROR, e.what()), id));
+                }
+            }
+            if (request->commands.empty()) return;
+            ++m_next_index;
+
+            if (batch.empty()) {
+                AddReplies(*request, UniValue(UniValue::VARR));
+                continue;
+            }
+            raii_evhttp_request req = PrepareHTTPRequest(batch_request_done, request.get(), m_host, m_userpass, batch.write() + "\n", /* keep_alive= */ true);
+            int r = evhttp_make_request(evcon, req.get(), EVHTTP_REQ_POST, m_endpoint.c_str());
+            req.release(); // ownership moved to evcon in above call
+            if (r != 0) {
+                throw CConnectionFailed("send http request failed");
+            }
+            ++m_in_flight;
+            m_requests.emplace(request->index, std::move(request));
+            return;
+        }
+    }
+
+    static void batch_request_done(struct evhttp_request* req, void* ctx)
+    {
+        Request& request = *static_cast<Request*>(ctx);
+        BatchRPC& batch = request.batch;
+        http_request_done(req, &request.reply);
+        --batch.m_in_flight;
+        // exceptions can't pass the event loop, the first one ends it and is rethrown by Run()
+        try {
+            batch.AddReplies(request, ParseHTTPReply(request.reply, batch.m_host, batch.m_port, batch.m_failed_auth_cookie));
+            batch.SendNext(request.evcon);
+        } catch (...) {
+            if (!batch.m_exception) batch.m_exception = std::current_exception();
+        }
+        batch.m_requests.erase(request.index);
+        // idle keep-alive connections keep the event loop running
+        if (batch.m_in_flight == 0 || batch.m_exception) event_base_loopbreak(batch.m_base.get());
+    }
+
+    void AddReplies(const Request& request, const UniValue& batch_reply)
+    {
+        std::map<int, UniValue> sent_replies;
+        if (batch_reply.isArray()) {
+            for (const UniValue& reply : batch_reply.getValues()) {
+                if (reply["id"].isNum()) sent_replies.emplace(reply["id"].get_int(), reply);
+            }
+        }
+        std::vector<UniValue>& replies = m_replies[request.index];
+        for (const auto& [id, failed_reply] : request.commands) {
+            UniValue reply = failed_reply;
+            if (reply.isNull()) {
+                const auto it = sent_replies.find(id);
+                // a server which rejects the whole batch replies with one error object for all of it
+                reply = it != sent_replies.end() ? it->second : batch_reply.isObject() ? JSONRPCReplyObj(NullUniValue, batch_reply["error"], id)
+                                                                                         : JSONRPCReplyObj(NullUniValue, JSONRPCError(RPC_MISC_ERROR, "no reply from server"), id);
+            }
+            if (!reply["error"].isNull()) m_success = false;
+            replies.push_back(std::move(reply));
+        }
+
+        for (auto it = m_replies.begin(); it != m_replies.end() && it->first == m_next_print; it = m_replies.erase(it), ++m_next_print) {
+            for (const UniValue& reply : it->second) {
+                tfm::format(std::cout, "%s\n", reply.write());
+            }
+        }
+        std::cout.flush();
+    }
+};
+
 static int CommandLineRPC(int argc, char *argv[])
 {
     std::string strPrint;
@@ -878,6 +1102,25 @@ static int CommandLineRPC(int argc, char *argv[])
                 fputc('\n', stdout);
             }
         }
+        if (gArgs.IsArgSet("-batch") && !gArgs.IsArgNegated("-batch")) {
+            if (!args.empty()) {
+                throw std::runtime_error("-batch takes its commands from a file or standard input, not from the command line");
+            }
+            if (gArgs.GetBoolArg("-rpcwait", false)) {
+                DefaultRequestHandler rh;
+                ConnectAndCallRPC(&rh, "uptime", /* args=*/{});
+            }
+            const std::string batch_file = gArgs.GetArg("-batch", "");
+            fsbridge::ifstream file;
+            if (!batch_file.empty() && batch_file != "-") {
+                file.open(fs::path(batch_file));
+                if (!file.is_open()) {
+                    throw std::runtime_error(strprintf("cannot open %s", batch_file));
+                }
+            }
+            BatchRPC batch(file.is_open() ? static_cast<std::istream&>(file) : std::cin);
+            return batch.Run() ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
         std::unique_ptr<BaseRequestHandler> rh;
         std::string method;
         if (gArgs.IsArgSet("-getinfo")) {
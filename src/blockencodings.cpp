@@ -9,6 +9,7 @@
 #include <crypto-X16R/sha256.h>
 #include <crypto/siphash.h>
 #include <random.h>
+#include <statsd_client.h>
 #include <streams.h>
 #include <txmempool.h>
 #include <validation.h>
@@ -210,6 +211,10 @@ ReadStatus PartiallyDownloadedBlock::FillBlock(CBlock& block, const std::vector<
     }
 
     LogPrint(BCLog::CMPCTBLOCK, "Successfully reconstructed block %s with %lu txn prefilled, %lu txn from mempool (incl at least %lu from extra pool) and %lu txn requested\n", hash.ToString(), prefilled_count, mempool_count, extra_count, vtx_missing.size());
+    statsClient.inc(vtx_missing.empty() ? "blocks.compact.reconstructed_direct" : "blocks.compact.reconstructed_requested", 1.0f);
+    statsClient.count("blocks.compact.txs_from_mempool", mempool_count, 1.0f);
+    statsClient.count("blocks.compact.txs_from_extra", extra_count, 1.0f);
+    statsClient.count("blocks.compact.txs_requested", vtx_missing.size(), 1.0f);
     if (vtx_missing.size() < 5) {
         for (const auto& tx : vtx_missing) {
             LogPrint(BCLog::CMPCTBLOCK, "Reconstructed block %s required tx %s\n", hash.ToString(), tx->GetHash().ToString());
@@ -134,6 +134,8 @@ public:
     // extra_txn is a list of extra transactions to look at, in <hash, reference> form
     ReadStatus InitData(const CBlockHeaderAndShortTxIDs& cmpctblock, const std::vector<std::pair<uint256, CTransactionRef>>& extra_txn);
     bool IsTxAvailable(size_t index) const;
+    // Transactions of the block reconstructed so far, nullptr for missing ones
+    const std::vector<CTransactionRef>& GetAvailableTxs() const { return txn_available; }
     ReadStatus FillBlock(CBlock& block, const std::vector<CTransactionRef>& vtx_missing);
 };
 
@@ -18,6 +18,7 @@
 #include <util/fastrange.h>
 
 #include <algorithm>
+#include <cassert>
 #include <cmath>
 #include <cstdlib>
 #include <limits>
@@ -26,6 +27,43 @@
 static constexpr double LN2SQUARED = 0.4804530139182014246671025263266649717305529515945455;
 static constexpr double LN2 = 0.6931471805599453094172321214581765680755001343602552;
 
+CBloomTxElements::CBloomTxElements(const CTransaction& tx)
+{
+    m_vout_end.reserve(tx.vout.size());
+    for (const CTxOut& txout : tx.vout) {
+        AddScript(txout.scriptPubKey);
+        m_vout_end.push_back(m_elements.size());
+    }
+    m_vin_end.reserve(tx.vin.size());
+    for (const CTxIn& txin : tx.vin) {
+        CDataStream stream(SER_NETWORK, PROTOCOL_VERSION);
+        stream << txin.prevout;
+        AddElement(MakeUCharSpan(stream));
+        AddScript(txin.scriptSig);
+        m_vin_end.push_back(m_elements.size());
+    }
+}
+
+void CBloomTxElements::AddElement(Span<const unsigned char> element)
+{
+    m_elements.emplace_back(m_data.size(), element.size());
+    m_data.insert(m_data.end(), element.begin(), element.end());
+}
+
+// The same elements CheckScript checks
+void CBloomTxElements::AddScript(const CScript& script)
+{
+    CScript::const_iterator pc = script.begin();
+    std::vector<unsigned char> data;
+    while (pc < script.end()) {
+        opcodetype opcode;
+        if (!script.GetOp(pc, opcode, data))
+            break;
+        if (data.size() != 0)
+            AddElement(data);
+    }
+}
+
 CBloomFilter::CBloomFilter(const unsigned int nElements, const double nFPRate, const unsigned int nTweakIn, unsigned char nFlagsIn) :
     /**
      * The ideal size for a bloom filter with a given number of elements and false positive rate is:
@@ -110,6 +148,15 @@ bool CBloomFilter::CheckScript(const CScript &script) const
     return false;
 }
 
+bool CBloomFilter::ContainsAny(const CBloomTxElements& elements, size_t begin, size_t end) const
+{
+    for (size_t i = begin; i < end; ++i) {
+        if (contains(elements.Element(i)))
+            return true;
+    }
+    return false;
+}
+
 // If the transaction is a special transaction that has a registration
 // transaction hash, test the registration transaction hash.
 // If the transaction is a special transaction with any public keys or any
@@ -197,30 +244,41 @@ bool CBloomFilter::CheckSpecialTransactionMatchesAndUpdate(const CTransaction &t
 }
 
 bool CBloomFilter::ProcessTxOut(const CTxOut& txout, const uint256& hash, unsigned int index)
+{
+    if (!CheckScript(txout.scriptPubKey))
+        return false;
+    UpdateMatchedTxOut(txout, hash, index);
+    return true;
+}
+
+void CBloomFilter::UpdateMatchedTxOut(const CTxOut& txout, const uint256& hash, unsigned int index)
 {
     // Match if the filter contains any arbitrary script data element in any scriptPubKey in tx
     // If this matches, also add the specific output that was matched.
     // This means clients don't have to update the filter themselves when a new relevant tx
     // is discovered in order to find spending transactions, which avoids round-tripping and race conditions.
-    bool fFound = false;
-    if(CheckScript(txout.scriptPubKey)) {
-        fFound = true;
-        if ((nFlags & BLOOM_UPDATE_MASK) == BLOOM_UPDATE_ALL)
+    if ((nFlags & BLOOM_UPDATE_MASK) == BLOOM_UPDATE_ALL)
+        insert(COutPoint(hash, index));
+    else if ((nFlags & BLOOM_UPDATE_MASK) == BLOOM_UPDATE_P2PUBKEY_ONLY)
+    {
+        std::vector<std::vector<unsigned char> > vSolutions;
+        TxoutType type = Solver(txout.scriptPubKey, vSolutions);
+        if (type == TxoutType::PUBKEY || type == TxoutType::MULTISIG) {
             insert(COutPoint(hash, index));
-        else if ((nFlags & BLOOM_UPDATE_MASK) == BLOOM_UPDATE_P2PUBKEY_ONLY)
-        {
-            std::vector<std::vector<unsigned char> > vSolutions;
-            TxoutType type = Solver(txout.scriptPubKey, vSolutions);
-            if (type == TxoutType::PUBKEY || type == TxoutType::MULTISIG) {
-                insert(COutPoint(hash, index));
-            }
         }
     }
-    return fFound;
 }
 
 bool CBloomFilter::IsRelevantAndUpdate(const CTransaction& tx)
 {
+    if (vData.empty()) // zero-size = "match-all" filter
+        return true;
+    return IsRelevantAndUpdate(tx, CBloomTxElements(tx));
+}
+
+bool CBloomFilter::IsRelevantAndUpdate(const CTransaction& tx, const CBloomTxElements& elements)
+{
+    assert(elements.OutputCount() == tx.vout.size() && elements.InputCount() == tx.vin.size());
     bool fFound = false;
     // Match if the filter contains the hash of tx
     //  for finding tx when they appear in a block
@@ -235,20 +293,19 @@ bool CBloomFilter::IsRelevantAndUpdate(const CTransaction& tx)
 
     for (unsigned int i = 0; i < tx.vout.size(); i++)
     {
-        fFound = ProcessTxOut(tx.vout[i], hash, i) || fFound;
+        if (ContainsAny(elements, elements.OutputBegin(i), elements.OutputEnd(i))) {
+            fFound = true;
+            UpdateMatchedTxOut(tx.vout[i], hash, i);
+        }
     }
 
     if (fFound)
         return true;
 
-    for (const CTxIn& txin : tx.vin)
+    // Match if the filter contains an outpoint tx spends or any arbitrary script data element in any scriptSig in tx
+    for (unsigned int i = 0; i < tx.vin.size(); i++)
     {
-        // Match if the filter contains an outpoint tx spends
-        if (contains(txin.prevout))
-            return true;
-
-        // Match if the filter contains any arbitrary script data element in any scriptSig in tx
-        if(CheckScript(txin.scriptSig))
+        if (ContainsAny(elements, elements.InputBegin(i), elements.InputEnd(i)))
             return true;
     }
 
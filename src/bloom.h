@@ -8,6 +8,8 @@
 #include <serialize.h>
 #include <span.h>
 
+#include <cstdint>
+#include <utility>
 #include <vector>
 
 class COutPoint;
@@ -33,6 +35,39 @@ enum bloomflags
     BLOOM_UPDATE_MASK = 3,
 };
 
+/**
+ * The data elements of a transaction which IsRelevantAndUpdate matches a filter against: the script pushes of the
+ * outputs, and for each input the outpoint it spends followed by the pushes of its scriptSig. They don't depend on
+ * the filter, so a transaction which is matched against the filters of many peers is only parsed once.
+ */
+class CBloomTxElements
+{
+public:
+    explicit CBloomTxElements(const CTransaction& tx);
+
+    size_t OutputBegin(size_t n) const { return n == 0 ? 0 : m_vout_end[n - 1]; }
+    size_t OutputEnd(size_t n) const { return m_vout_end[n]; }
+    size_t InputBegin(size_t n) const { return n > 0 ? m_vin_end[n - 1] : m_vout_end.empty() ? 0 : m_vout_end.back(); }
+    size_t InputEnd(size_t n) const { return m_vin_end[n]; }
+    size_t OutputCount() const { return m_vout_end.size(); }
+    size_t InputCount() const { return m_vin_end.size(); }
+
+    Span<const unsigned char> Element(size_t i) const
+    {
+        return Span<const unsigned char>{m_data}.subspan(m_elements[i].first, m_elements[i].second);
+    }
+
+private:
+    //! the elements are kept back to back in one buffer, as offset and size
+    std::vector<unsigned char> m_data;
+    std::vector<std::pair<uint32_t, uint32_t>> m_elements;
+    std::vector<uint32_t> m_vout_end;
+    std::vector<uint32_t> m_vin_end;
+
+    void AddElement(Span<const unsigned char> element);
+    void AddScript(const CScript& script);
+};
+
 /**
  * BloomFilter is a probabilistic filter which SPV clients provide
  * so that we can filter the transactions we send them.
@@ -56,8 +91,12 @@ private:
 
     // Check matches for arbitrary script data elements
     bool CheckScript(const CScript& script) const;
+    // Check for any of the elements [begin, end)
+    bool ContainsAny(const CBloomTxElements& elements, size_t begin, size_t end) const;
     // Check particular CTxOut helper
     bool ProcessTxOut(const CTxOut& txout, const uint256& hash, unsigned int index);
+    // Add the outpoint of a matched output, as far as nFlags asks for it
+    void UpdateMatchedTxOut(const CTxOut& txout, const uint256& hash, unsigned int index);
     // Check additional matches for special transactions
     bool CheckSpecialTransactionMatchesAndUpdate(const CTransaction& tx);
 public:
@@ -87,6 +126,8 @@ public:
 
     //! Also adds any outputs which match the filter to the filter (to match their spending txes)
     bool IsRelevantAndUpdate(const CTransaction& tx);
+    //! Same with the elements of tx parsed already
+    bool IsRelevantAndUpdate(const CTransaction& tx, const CBloomTxElements& elements);
 };
 
 /**
@@ -5,13 +5,19 @@
 #include <bls/bls.h>
 
 #include <random.h>
+#include <support/cleanse.h>
+#include <util/ranges.h>
 
 #ifndef BUILD_BITCOIN_INTERNAL
 #include <support/allocators/mt_pooled_secure.h>
+#include <unordered_lru_cache.h>
+#include <util/hasher.h>
 #endif
 
 #include <cassert>
 #include <cstring>
+#include <map>
+#include <set>
 
 namespace bls {
     std::atomic<bool> bls_legacy_scheme = std::atomic<bool>(true);
@@ -104,6 +110,63 @@ bool CBLSSecretKey::SecretKeyShare(Span<CBLSSecretKey> msk, const CBLSId& _id)
     return true;
 }
 
+bool CBLSSecretKey::SecretKeyShares(Span<CBLSSecretKey> msk, Span<CBLSId> ids, Span<CBLSSecretKey> sharesRet)
+{
+    assert(ids.size() == sharesRet.size());
+    // dashbls' Evaluate needs at least 2 coefficients as well
+    if (msk.size() < 2) {
+        return false;
+    }
+
+    // Horner's method like Threshold::PrivateKeyShare, but the coefficients are only read once for all ids and the
+    // intermediate values stay plain numbers instead of becoming securely allocated PrivateKeys
+    bn_t order, x, y;
+    bn_new(order);
+    bn_new(x);
+    bn_new(y);
+    g2_get_ord(order);
+
+    if (!ranges::all_of(msk, [](const auto& sk) { return sk.IsValid(); }) ||
+        !ranges::all_of(ids, [](const auto& id) { return id.IsValid(); })) {
+        return false;
+    }
+
+    bool ret{true};
+    std::vector<bn_st> coeffs(msk.size());
+    uint8_t buf[BLS_CURVE_SECKEY_SIZE];
+    for (size_t i = 0; i < msk.size(); i++) {
+        bn_new(&coeffs[i]);
+        msk[i].impl.Serialize(buf);
+        bn_read_bin(&coeffs[i], buf, sizeof(buf));
+    }
+
+    for (size_t i = 0; i < ids.size(); i++) {
+        bn_read_bin(x, ids[i].impl.begin(), ids[i].impl.size());
+        bn_mod(x, x, order);
+
+        bn_copy(y, &coeffs.back());
+        for (size_t j = coeffs.size() - 1; j-- > 0;) {
+            bn_mul(y, y, x);
+            bn_add(y, y, &coeffs[j]);
+            bn_mod(y, y, order);
+        }
+        bn_write_bin(buf, sizeof(buf), y);
+        try {
+            sharesRet[i].impl = bls::PrivateKey::FromBytes(bls::Bytes(buf, sizeof(buf)));
+        } catch (...) {
+            ret = false;
+            break;
+        }
+        sharesRet[i].fValid = true;
+        sharesRet[i].cachedHash.SetNull();
+    }
+
+    memory_cleanse(coeffs.data(), coeffs.size() * sizeof(bn_st));
+    memory_cleanse(y, sizeof(bn_t));
+    memory_cleanse(buf, sizeof(buf));
+    return ret;
+}
+
 CBLSPublicKey CBLSSecretKey::GetPublicKey() const
 {
     if (!IsValid()) {
@@ -357,6 +420,124 @@ bool CBLSSignature::VerifySecureAggregated(Span<CBLSPublicKey> pks, const uint25
     }
 }
 
+// 1 == prod(e(g1s[i], g2s[i])) in one multi-pairing, the way CoreMPL::NativeVerify checks it
+static bool VerifyPairingProduct(const std::vector<bls::G1Element>& g1s, const std::vector<bls::G2Element>& g2s)
+{
+    assert(g1s.size() == g2s.size());
+    std::vector<g1_st> nativeG1(g1s.size());
+    std::vector<g2_st> nativeG2(g2s.size());
+    for (size_t i = 0; i < g1s.size(); i++) {
+        g1s[i].ToNative(&nativeG1[i]);
+        g2s[i].ToNative(&nativeG2[i]);
+    }
+
+    gt_t target, candidate, tmpPairing;
+    fp12_zero(target);
+    fp_set_dig(target[0][0][0], 1);
+    fp12_zero(candidate);
+    fp_set_dig(candidate[0][0][0], 1);
+    for (size_t i = 0; i < nativeG1.size(); i += 250) {
+        const size_t numPairings = std::min(nativeG1.size() - i, size_t(250));
+        pc_map_sim(tmpPairing, (g1_t*)nativeG1.data() + i, (g2_t*)nativeG2.data() + i, numPairings);
+        fp12_mul(candidate, candidate, tmpPairing);
+    }
+    if (gt_cmp(target, candidate) != RLC_EQ || core_get()->code != RLC_OK) {
+        core_get()->code = RLC_OK;
+        return false;
+    }
+    bls::BLS::CheckRelicErrors();
+    return true;
+}
+
+bool CBLSSignature::VerifyBatchRandomized(Span<CBLSSignature> sigs, Span<CBLSPublicKey> pubKeys, Span<uint256> hashes)
+{
+    assert(!sigs.empty() && sigs.size() == pubKeys.size() && sigs.size() == hashes.size());
+
+    std::set<uint256> distinctHashes;
+    std::set<uint256> distinctPubKeys;
+    for (size_t i = 0; i < sigs.size(); i++) {
+        if (!sigs[i].IsValid() || !pubKeys[i].IsValid()) {
+            return false;
+        }
+        distinctHashes.emplace(hashes[i]);
+        distinctPubKeys.emplace(pubKeys[i].GetHash());
+    }
+
+    const bool fLegacy = bls::bls_legacy_scheme.load();
+    const auto randomFactor = [](bn_t r) {
+        uint8_t buf[8];
+        GetRandBytes(buf, sizeof(buf));
+        buf[0] |= 1;
+        bn_read_bin(r, buf, sizeof(buf));
+    };
+
+    try {
+        bls::G2Element aggSig;
+        if (distinctHashes.size() <= distinctPubKeys.size()) {
+            // e(g1, sum(r_i * sig_i)) == prod(e(sum(r_i * pubKey_i), H(hash))) over the distinct hashes
+            std::map<uint256, bls::G1Element> aggPubKeys;
+            for (size_t i = 0; i < sigs.size(); i++) {
+                bn_t r;
+                bn_new(r);
+                randomFactor(r);
+
+                aggSig += sigs[i].impl * r;
+                auto [it, inserted] = aggPubKeys.try_emplace(hashes[i]);
+                it->second += pubKeys[i].impl * r;
+            }
+
+            std::vector<bls::G1Element> pubKeyVec;
+            std::vector<bls::Bytes> hashVec;
+            pubKeyVec.reserve(aggPubKeys.size());
+            hashVec.reserve(aggPubKeys.size());
+            for (const auto& [hash, pubKey] : aggPubKeys) {
+                pubKeyVec.push_back(pubKey);
+                hashVec.emplace_back(hash.begin(), hash.size());
+            }
+            return Scheme(fLegacy)->AggregateVerify(pubKeyVec, hashVec, aggSig);
+        }
+
+        // Recovered sigs, islocks and clsigs are signed by the few active quorums, so most of their hashes share
+        // a public key with many others. A pairing costs far more than hashing to G2 and the scalar multiplications,
+        // so the hashes are aggregated per public key instead.
+        // e(g1, sum(r_i * sig_i)) == prod(e(pubKey, sum(r_i * H(hash_i)))) over the distinct public keys
+        std::map<uint256, std::pair<bls::G1Element, bls::G2Element>> aggHashes;
+        for (size_t i = 0; i < sigs.size(); i++) {
+            bn_t r;
+            bn_new(r);
+            randomFactor(r);
+
+            const bls::Bytes message(hashes[i].begin(), hashes[i].size());
+            const bls::G2Element hashedPoint = fLegacy
+                ? bls::G2Element::FromMessage(message, nullptr, 0, true)
+                : bls::G2Element::FromMessage(message, (const uint8_t*)bls::BasicSchemeMPL::CIPHERSUITE_ID.c_str(),
+                                              bls::BasicSchemeMPL::CIPHERSUITE_ID.length());
+            aggSig += sigs[i].impl * r;
+            auto [it, inserted] = aggHashes.try_emplace(pubKeys[i].GetHash(), pubKeys[i].impl, bls::G2Element());
+            it->second.second += hashedPoint * r;
+        }
+
+        if (!aggSig.IsValid()) {
+            return false;
+        }
+        std::vector<bls::G1Element> g1s{bls::G1Element::Generator().Negate()};
+        std::vector<bls::G2Element> g2s{aggSig};
+        g1s.reserve(aggHashes.size() + 1);
+        g2s.reserve(aggHashes.size() + 1);
+        for (const auto& [pubKeyHash, p] : aggHashes) {
+            // The same subgroup check AggregateVerify does, once per public key instead of once per message
+            if (!p.first.IsValid()) {
+                return false;
+            }
+            g1s.push_back(p.first);
+            g2s.push_back(p.second);
+        }
+        return VerifyPairingProduct(g1s, g2s);
+    } catch (...) {
+        return false;
+    }
+}
+
 bool CBLSSignature::Recover(Span<CBLSSignature> sigs, Span<CBLSId> ids)
 {
     fValid = false;
@@ -390,6 +571,105 @@ bool CBLSSignature::Recover(Span<CBLSSignature> sigs, Span<CBLSId> ids)
     return true;
 }
 
+bool CBLSSignature::GetLagrangeCoefficients(Span<CBLSId> ids, std::vector<uint256>& coeffsRet)
+{
+    // Same as dashbls' LagrangeInterpolate, which needs at least 2 shares:
+    // delta_i(0) = prod_{j != i} id_j / (id_j - id_i) = a / b
+    // where a = prod id_j, b = id_i * prod_{j != i} (id_j - id_i)
+    const size_t k = ids.size();
+    if (k < 2) {
+        return false;
+    }
+
+    bn_t order, a, b, v, iv;
+    bn_new(order);
+    bn_new(a);
+    bn_new(b);
+    bn_new(v);
+    bn_new(iv);
+    g2_get_ord(order);
+
+    std::vector<bn_st> idsBn(k);
+    for (size_t i = 0; i < k; i++) {
+        if (!ids[i].IsValid()) {
+            return false;
+        }
+        bn_new(&idsBn[i]);
+        bn_read_bin(&idsBn[i], ids[i].impl.begin(), ids[i].impl.size());
+        bn_mod(&idsBn[i], &idsBn[i], order);
+    }
+
+    bn_copy(a, &idsBn[0]);
+    for (size_t i = 1; i < k; i++) {
+        bn_mul(a, a, &idsBn[i]);
+        bn_mod(a, a, order);
+    }
+    if (bn_is_zero(a)) {
+        return false;
+    }
+
+    coeffsRet.resize(k);
+    for (size_t i = 0; i < k; i++) {
+        bn_copy(b, &idsBn[i]);
+        for (size_t j = 0; j < k; j++) {
+            if (j == i) continue;
+            bn_sub(v, &idsBn[j], &idsBn[i]);
+            bn_mod(v, v, order);
+            if (bn_is_zero(v)) {
+                // duplicate id
+                return false;
+            }
+            bn_mul(b, b, v);
+            bn_mod(b, b, order);
+        }
+        bn_mod_inv(iv, b, order);
+        bn_mul(v, a, iv);
+        bn_mod(v, v, order);
+        bn_write_bin(coeffsRet[i].begin(), coeffsRet[i].size(), v);
+    }
+    return true;
+}
+
+CBLSSignature CBLSSignature::LinearCombination(Span<CBLSSignature> sigs, Span<const uint256> coeffs)
+{
+    assert(sigs.size() == coeffs.size());
+
+    // relic's g2_mul_sim_lot gives wrong results for more than 10 points, its interleaved multiplication up to that
+    // is still about a third cheaper than multiplying one by one
+    static constexpr size_t CHUNK_SIZE{10};
+
+    CBLSSignature ret;
+    std::vector<g2_st> points(std::min(sigs.size(), CHUNK_SIZE));
+    std::vector<bn_st> scalars(points.size());
+    for (auto& scalar : scalars) {
+        bn_new(&scalar);
+    }
+    g2_t sum, part;
+    g2_new(sum);
+    g2_new(part);
+    g2_set_infty(sum);
+    try {
+        for (size_t begin = 0; begin < sigs.size(); begin += CHUNK_SIZE) {
+            const size_t n = std::min(CHUNK_SIZE, sigs.size() - begin);
+            for (size_t i = 0; i < n; i++) {
+                if (!sigs[begin + i].IsValid()) {
+                    return ret;
+                }
+                sigs[begin + i].impl.ToNative(&points[i]);
+                bn_read_bin(&scalars[i], coeffs[begin + i].begin(), coeffs[begin + i].size());
+            }
+            g2_mul_sim_lot(part, reinterpret_cast<g2_t*>(points.data()), reinterpret_cast<const bn_t*>(scalars.data()), n);
+            g2_add(sum, sum, part);
+        }
+        g2_norm(sum, sum);
+        ret.impl = bls::G2Element::FromNative(sum);
+    } catch (...) {
+        return ret;
+    }
+    ret.fValid = true;
+    return ret;
+}
+
 #ifndef BUILD_BITCOIN_INTERNAL
 
 static std::once_flag init_flag;
@@ -428,6 +708,44 @@ static void secure_free(void* p)
     size_t n = *reinterpret_cast<size_t*>(ptr);
     return get_secure_allocator().deallocate(ptr, n);
 }
+
+static std::mutex pubkey_cache_mutex;
+static unordered_lru_cache<uint256, CBLSPublicKey, BlockHasher> pubkey_cache(BLS_PUBLIC_KEY_CACHE_SIZE);
+static std::atomic<uint64_t> pubkey_cache_hits{0};
+static std::atomic<uint64_t> pubkey_cache_misses{0};
+
+bool GetCachedBLSPublicKey(const std::vector<uint8_t>& vecBytes, bool specificLegacyScheme, CBLSPublicKey& pubKey)
+{
+    const uint8_t legacy = specificLegacyScheme;
+    const uint256 key = Hash(vecBytes, Span{&legacy, 1});
+    {
+        std::unique_lock<std::mutex> l(pubkey_cache_mutex);
+        if (pubkey_cache.get(key, pubKey)) {
+            pubkey_cache_hits++;
+            return true;
+        }
+    }
+    pubkey_cache_misses++;
+
+    // decompress outside of the lock, keys are only cached once they passed all checks
+    pubKey.SetByteVector(vecBytes, specificLegacyScheme);
+    if (!pubKey.IsValid() || !pubKey.CheckMalleable(vecBytes, specificLegacyScheme)) {
+        return false;
+    }
+    std::unique_lock<std::mutex> l(pubkey_cache_mutex);
+    pubkey_cache.insert(key, pubKey);
+    return true;
+}
+
+CBLSPublicKeyCacheStats GetBLSPublicKeyCacheStats()
+{
+    CBLSPublicKeyCacheStats stats;
+    stats.hits = pubkey_cache_hits;
+    stats.misses = pubkey_cache_misses;
+    std::unique_lock<std::mutex> l(pubkey_cache_mutex);
+    stats.size = pubkey_cache.size();
+    return stats;
+}
 #endif
 
 bool BLSInit()
@@ -24,6 +24,7 @@
 
 #include <array>
 #include <mutex>
+#include <type_traits>
 #include <unistd.h>
 
 #include <atomic>
@@ -204,7 +205,7 @@ public:
         Unserialize(s, bls::bls_legacy_scheme.load());
     }
 
-    inline bool CheckMalleable(Span<uint8_t> vecBytes, const bool specificLegacyScheme) const
+    inline bool CheckMalleable(Span<const uint8_t> vecBytes, const bool specificLegacyScheme) const
     {
         if (memcmp(vecBytes.data(), ToByteVector(specificLegacyScheme).data(), SerSize)) {
             // TODO not sure if this is actually possible with the BLS libs. I'm assuming here that somewhere deep inside
@@ -215,7 +216,7 @@ public:
         return true;
     }
 
-    inline bool CheckMalleable(Span<uint8_t> vecBytes) const
+    inline bool CheckMalleable(Span<const uint8_t> vecBytes) const
     {
         return CheckMalleable(vecBytes, bls::bls_legacy_scheme.load());
     }
@@ -282,6 +283,8 @@ public:
     void MakeNewKey();
 #endif
     bool SecretKeyShare(Span<CBLSSecretKey> msk, const CBLSId& id);
+    // SecretKeyShare for all ids at once, sharesRet must have the size of ids
+    [[nodiscard]] static bool SecretKeyShares(Span<CBLSSecretKey> msk, Span<CBLSId> ids, Span<CBLSSecretKey> sharesRet);
 
     [[nodiscard]] CBLSPublicKey GetPublicKey() const;
     [[nodiscard]] CBLSSignature Sign(const uint256& hash) const;
@@ -367,7 +370,19 @@ public:
 
     [[nodiscard]] bool VerifySecureAggregated(Span<CBLSPublicKey> pks, const uint256& hash) const;
 
+    // Verifies each of sigs against the pubKey and hash with the same index in one multi-pairing. Every signature and
+    // public key is weighted with a random 64 bit factor first, so unlike with VerifyInsecureAggregated invalid
+    // signatures can't cancel each other out. Depending on which has fewer distinct values, public keys with the same hash
+    // or hashes with the same public key share a pairing
+    [[nodiscard]] static bool VerifyBatchRandomized(Span<CBLSSignature> sigs, Span<CBLSPublicKey> pubKeys, Span<uint256> hashes);
+
     bool Recover(Span<CBLSSignature> sigs, Span<CBLSId> ids);
+
+    // The two halves of Recover, see CBLSWorker::RecoverSig. The Lagrange coefficients at 0 only depend on the ids, so
+    // they can be reused for the same set of members. Recovery is LinearCombination of the shares with them
+    [[nodiscard]] static bool GetLagrangeCoefficients(Span<CBLSId> ids, std::vector<uint256>& coeffsRet);
+    // sum(coeffs[i] * sigs[i]) with the coefficients as written by GetLagrangeCoefficients, invalid if any sig is
+    [[nodiscard]] static CBLSSignature LinearCombination(Span<CBLSSignature> sigs, Span<const uint256> coeffs);
 };
 
 class CBLSSignatureVersionWrapper {
@@ -390,6 +405,21 @@ public:
 };
 
 #ifndef BUILD_BITCOIN_INTERNAL
+// Number of decompressed public keys kept for CBLSLazyPublicKeys, the cache is truncated when twice as many are in it
+static constexpr size_t BLS_PUBLIC_KEY_CACHE_SIZE{10000};
+
+struct CBLSPublicKeyCacheStats {
+    uint64_t hits{0};
+    uint64_t misses{0};
+    size_t size{0};
+};
+
+// Masternode lists are copied and read from evodb all the time and every copy would decompress and check the same
+// operator keys again, so CBLSLazyPublicKeys share a process-wide cache of the keys by the hash of their
+// serialization. Returns false if vecBytes is not a valid public key
+bool GetCachedBLSPublicKey(const std::vector<uint8_t>& vecBytes, bool specificLegacyScheme, CBLSPublicKey& pubKey);
+CBLSPublicKeyCacheStats GetBLSPublicKeyCacheStats();
+
 template<typename BLSObject>
 class CBLSLazyWrapper
 {
@@ -499,14 +529,21 @@ public:
             return invalidObj;
         }
         if (!objInitialized) {
-            obj.SetByteVector(vecBytes, bufLegacyScheme);
-            if (!obj.IsValid()) {
-                bufValid = false;
-                return invalidObj;
-            }
-            if (!obj.CheckMalleable(vecBytes, bufLegacyScheme)) {
-                bufValid = false;
-                return invalidObj;
+            if constexpr (std::is_same_v<BLSObject, CBLSPublicKey>) {
+                if (!GetCachedBLSPublicKey(vecBytes, bufLegacyScheme, obj)) {
+                    bufValid = false;
+                    return invalidObj;
+                }
+            } else {
+                obj.SetByteVector(vecBytes, bufLegacyScheme);
+                if (!obj.IsValid()) {
+                    bufValid = false;
+                    return invalidObj;
+                }
+                if (!obj.CheckMalleable(vecBytes, bufLegacyScheme)) {
+                    bufValid = false;
+                    return invalidObj;
+                }
             }
             objInitialized = true;
         }
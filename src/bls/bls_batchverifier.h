@@ -6,8 +6,11 @@
 #define DASH_CRYPTO_BLS_BATCHVERIFIER_H
 
 #include <bls/bls.h>
+#include <bls/bls_worker.h>
 
+#include <algorithm>
 #include <map>
+#include <set>
 #include <vector>
 
 template<typename SourceId, typename MessageId>
@@ -24,10 +27,16 @@ private:
     using MessageMap = std::map<MessageId, Message>;
     using MessageMapIterator = typename MessageMap::iterator;
     using MessagesBySourceMap = std::map<SourceId, std::vector<MessageMapIterator>>;
+    using ByMessageHashMap = std::map<uint256, std::vector<MessageMapIterator>>;
+
+    // Don't split batches across more parallel jobs than needed to give each at least this many messages, as every
+    // job pays for its own final pairing
+    static constexpr size_t MIN_MESSAGES_PER_JOB{16};
 
     bool secureVerification;
     bool perMessageFallback;
     size_t subBatchSize;
+    CBLSWorker* worker;
 
     MessageMap messages;
     MessagesBySourceMap messagesBySource;
@@ -37,10 +46,11 @@ public:
     std::set<MessageId> badMessages;
 
 public:
-    CBLSBatchVerifier(bool _secureVerification, bool _perMessageFallback, size_t _subBatchSize = 0) :
+    CBLSBatchVerifier(bool _secureVerification, bool _perMessageFallback, size_t _subBatchSize = 0, CBLSWorker* _worker = nullptr) :
             secureVerification(_secureVerification),
             perMessageFallback(_perMessageFallback),
-            subBatchSize(_subBatchSize)
+            subBatchSize(_subBatchSize),
+            worker(_worker)
     {
     }
 
@@ -68,58 +78,165 @@ public:
         return messagesBySource.size();
     }
 
+    // Verifies everything pushed so far. The whole batch is checked first, which is the common case. If that fails,
+    // the suspicious messages are split in halves and verified again until the bad sources (and with
+    // perMessageFallback, the bad messages) are pinned down, so a few bad signatures in a big batch only cost a
+    // logarithmic number of extra verifications. If a worker was passed in, all checks of one round run in parallel
     void Verify()
     {
-        std::map<uint256, std::vector<MessageMapIterator>> byMessageHash;
-
-        for (auto it = messages.begin(); it != messages.end(); ++it) {
-            byMessageHash[it->second.msgHash].emplace_back(it);
+        // Split by message hash for the worker threads, which keeps messages with the same hash together and thus
+        // the number of pairings as low as in a single batch
+        std::vector<std::pair<uint256, std::vector<MessageMapIterator>>> byHash;
+        {
+            ByMessageHashMap byMessageHash;
+            for (auto it = messages.begin(); it != messages.end(); ++it) {
+                byMessageHash[it->second.msgHash].emplace_back(it);
+            }
+            byHash.assign(std::make_move_iterator(byMessageHash.begin()), std::make_move_iterator(byMessageHash.end()));
         }
-
-        if (VerifyBatch(byMessageHash)) {
+        auto addHashMessages = [](const auto& p, ByMessageHashMap& byMessageHash) {
+            auto& v = byMessageHash[p.first];
+            v.insert(v.end(), p.second.begin(), p.second.end());
+        };
+        const auto ranges = SplitRange(0, byHash.size(), GetJobCount(byHash.size(), messages.size()));
+        const auto valid = VerifyRanges(byHash, ranges, addHashMessages);
+
+        std::set<MessageId> suspects;
+        for (size_t i = 0; i < ranges.size(); i++) {
+            if (valid[i]) {
+                continue;
+            }
+            for (size_t j = ranges[i].first; j < ranges[i].second; j++) {
+                for (const auto& msgIt : byHash[j].second) {
+                    suspects.emplace(msgIt->first);
+                }
+            }
+        }
+        if (suspects.empty()) {
             // full batch is valid
             return;
         }
 
-        // revert to per-source verification
-        for (const auto& p : messagesBySource) {
-            bool batchValid = false;
-
-            // no need to verify it again if there was just one source
-            if (messagesBySource.size() != 1) {
-                byMessageHash.clear();
-                for (auto it = p.second.begin(); it != p.second.end(); ++it) {
-                    byMessageHash[(*it)->second.msgHash].emplace_back(*it);
+        // Only sources which sent one of the suspicious messages can be bad, and only those messages need another look
+        std::vector<std::pair<SourceId, std::vector<MessageMapIterator>>> suspectSources;
+        size_t suspectCount = 0;
+        for (const auto& [sourceId, msgIts] : messagesBySource) {
+            std::vector<MessageMapIterator> v;
+            for (const auto& msgIt : msgIts) {
+                if (suspects.count(msgIt->first)) {
+                    v.emplace_back(msgIt);
                 }
-                batchValid = VerifyBatch(byMessageHash);
             }
-            if (!batchValid) {
-                badSources.emplace(p.first);
-
-                if (perMessageFallback) {
-                    // revert to per-message verification
-                    if (p.second.size() == 1) {
-                        // no need to re-verify a single message
-                        badMessages.emplace(p.second[0]->second.msgId);
-                    } else {
-                        for (const auto& msgIt : p.second) {
-                            if (badMessages.count(msgIt->first)) {
-                                // same message might be invalid from different source, so no need to re-verify it
-                                continue;
-                            }
-
-                            const auto& msg = msgIt->second;
-                            if (!msg.sig.VerifyInsecure(msg.pubKey, msg.msgHash)) {
-                                badMessages.emplace(msg.msgId);
-                            }
-                        }
-                    }
+            if (!v.empty()) {
+                suspectCount += v.size();
+                suspectSources.emplace_back(sourceId, std::move(v));
+            }
+        }
+        auto addSourceMessages = [](const auto& p, ByMessageHashMap& byMessageHash) {
+            for (const auto& msgIt : p.second) {
+                byMessageHash[msgIt->second.msgHash].emplace_back(msgIt);
+            }
+        };
+        std::vector<MessageMapIterator> badSourceMessages;
+        std::set<MessageId> dups;
+        for (const auto& [sourceId, msgIts] : Bisect(suspectSources, suspectCount, addSourceMessages)) {
+            badSources.emplace(sourceId);
+            for (const auto& msgIt : msgIts) {
+                // same message might come from different sources, so no need to verify it twice
+                if (dups.emplace(msgIt->first).second) {
+                    badSourceMessages.emplace_back(msgIt);
                 }
             }
         }
+
+        if (perMessageFallback) {
+            auto addMessage = [](const MessageMapIterator& msgIt, ByMessageHashMap& byMessageHash) {
+                byMessageHash[msgIt->second.msgHash].emplace_back(msgIt);
+            };
+            for (const auto& msgIt : Bisect(badSourceMessages, badSourceMessages.size(), addMessage)) {
+                badMessages.emplace(msgIt->first);
+            }
+        }
     }
 
 private:
+    // [begin, end) range of indexes
+    using Range = std::pair<size_t, size_t>;
+
+    static std::vector<Range> SplitRange(size_t begin, size_t end, size_t count)
+    {
+        std::vector<Range> ranges;
+        for (size_t i = 0; i < count; i++) {
+            ranges.emplace_back(begin + (end - begin) * i / count, begin + (end - begin) * (i + 1) / count);
+        }
+        return ranges;
+    }
+
+    size_t GetJobCount(size_t itemCount, size_t messageCount) const
+    {
+        if (worker == nullptr || itemCount < 2) {
+            return 1;
+        }
+        const size_t maxJobs = std::min(itemCount, worker->GetWorkerCount() + 1);
+        return std::clamp<size_t>(messageCount / MIN_MESSAGES_PER_JOB, 1, maxJobs);
+    }
+
+    // Verifies the items in each range as a batch of its own. addMessages(item, byMessageHash) adds the messages of
+    // an item to a batch
+    template<typename Item, typename AddMessages>
+    std::vector<uint8_t> VerifyRanges(const std::vector<Item>& items, const std::vector<Range>& ranges, const AddMessages& addMessages)
+    {
+        // not a std::vector<bool>, jobs write to it concurrently
+        std::vector<uint8_t> valid(ranges.size());
+        auto verifyRange = [&](size_t idx) {
+            ByMessageHashMap byMessageHash;
+            for (size_t i = ranges[idx].first; i < ranges[idx].second; i++) {
+                addMessages(items[i], byMessageHash);
+            }
+            valid[idx] = VerifyBatch(byMessageHash);
+        };
+        if (worker != nullptr && ranges.size() > 1) {
+            worker->RunParallel(ranges.size(), verifyRange);
+        } else {
+            for (size_t idx = 0; idx < ranges.size(); idx++) {
+                verifyRange(idx);
+            }
+        }
+        return valid;
+    }
+
+    // Returns the items which fail to verify on their own, given that all of them together are known to fail
+    template<typename Item, typename AddMessages>
+    std::vector<Item> Bisect(const std::vector<Item>& items, size_t messageCount, const AddMessages& addMessages)
+    {
+        std::vector<Item> invalid;
+        if (items.size() <= 1) {
+            // no need to re-verify a single item
+            invalid = items;
+            return invalid;
+        }
+
+        auto ranges = SplitRange(0, items.size(), std::max<size_t>(GetJobCount(items.size(), messageCount), 2));
+        while (!ranges.empty()) {
+            const auto valid = VerifyRanges(items, ranges, addMessages);
+            std::vector<Range> next;
+            for (size_t idx = 0; idx < ranges.size(); idx++) {
+                if (valid[idx]) {
+                    continue;
+                }
+                const auto [begin, end] = ranges[idx];
+                if (end - begin == 1) {
+                    invalid.emplace_back(items[begin]);
+                } else {
+                    const auto halves = SplitRange(begin, end, 2);
+                    next.insert(next.end(), halves.begin(), halves.end());
+                }
+            }
+            ranges = std::move(next);
+        }
+        return invalid;
+    }
+
     // All Verify methods take ownership of the passed byMessageHash map and thus might modify the map. This is to avoid
     // unnecessary copies
 
@@ -139,8 +256,8 @@ private:
         std::vector<CBLSPublicKey> pubKeys;
         std::set<MessageId> dups;
 
-        msgHashes.reserve(messages.size());
-        pubKeys.reserve(messages.size());
+        msgHashes.reserve(byMessageHash.size());
+        pubKeys.reserve(byMessageHash.size());
 
         for (const auto& p : byMessageHash) {
             const auto& msgHash = p.first;
@@ -183,57 +300,32 @@ private:
         return aggSig.VerifyInsecureAggregated(pubKeys, msgHashes);
     }
 
-    bool VerifyBatchSecure(std::map<uint256, std::vector<MessageMapIterator>>& byMessageHash)
+    bool VerifyBatchSecure(const std::map<uint256, std::vector<MessageMapIterator>>& byMessageHash)
     {
-        // Loop until the byMessageHash map is empty, which means that all messages were verified
-        // The secure form of verification will only aggregate one message for the same message hash, even if multiple
-        // exist (signed with different keys). This avoids the rogue public key attack.
-        // This is slower than the insecure form as it requires more pairings
-        while (!byMessageHash.empty()) {
-            if (!VerifyBatchSecureStep(byMessageHash)) {
-                return false;
-            }
-        }
-        return true;
-    }
-
-    bool VerifyBatchSecureStep(std::map<uint256, std::vector<MessageMapIterator>>& byMessageHash)
-    {
-        CBLSSignature aggSig;
-        std::vector<uint256> msgHashes;
+        // The random weights keep rogue public keys and invalid signatures canceling each other out from passing,
+        // so messages with the same hash can still share a pairing
+        std::vector<CBLSSignature> sigs;
         std::vector<CBLSPublicKey> pubKeys;
+        std::vector<uint256> msgHashes;
         std::set<MessageId> dups;
 
-        msgHashes.reserve(messages.size());
-        pubKeys.reserve(messages.size());
-
-        for (auto it = byMessageHash.begin(); it != byMessageHash.end(); ) {
-            const auto& msgHash = it->first;
-            auto& messageIts = it->second;
-            const auto& msg = messageIts.back()->second;
-
-            if (dups.emplace(msg.msgId).second) {
-                msgHashes.emplace_back(msgHash);
-                pubKeys.emplace_back(msg.pubKey);
-
-                if (!aggSig.IsValid()) {
-                    aggSig = msg.sig;
-                } else {
-                    aggSig.AggregateInsecure(msg.sig);
+        for (const auto& [msgHash, msgIts] : byMessageHash) {
+            for (const auto& msgIt : msgIts) {
+                const auto& msg = msgIt->second;
+                if (!dups.emplace(msg.msgId).second) {
+                    continue;
                 }
-            }
-
-            messageIts.pop_back();
-            if (messageIts.empty()) {
-                it = byMessageHash.erase(it);
-            } else {
-                ++it;
+                sigs.emplace_back(msg.sig);
+                pubKeys.emplace_back(msg.pubKey);
+                msgHashes.emplace_back(msgHash);
             }
         }
 
-        assert(!msgHashes.empty());
+        if (sigs.empty()) {
+            return true;
+        }
 
-        return aggSig.VerifyInsecureAggregated(pubKeys, msgHashes);
+        return CBLSSignature::VerifyBatchRandomized(sigs, pubKeys, msgHashes);
     }
 };
 
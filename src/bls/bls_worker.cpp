@@ -9,6 +9,8 @@
 #include <util/ranges.h>
 #include <util/system.h>
 
+#include <atomic>
+#include <condition_variable>
 #include <memory>
 #include <utility>
 
@@ -59,8 +61,9 @@ CBLSWorker::~CBLSWorker()
 
 void CBLSWorker::Start()
 {
-    int workerCount = std::thread::hardware_concurrency() / 2;
-    workerCount = std::max(std::min(1, workerCount), 4);
+    // DKG sessions of large quorums aggregate and verify hundreds of vectors, let them use all but one core
+    int workerCount = int(std::thread::hardware_concurrency()) - 1;
+    workerCount = std::max(workerCount, 4);
     workerPool.resize(workerCount);
     RenameThreadPool(workerPool, "bls-work");
 }
@@ -100,12 +103,7 @@ bool CBLSWorker::GenerateContributions(int quorumThreshold, Span<CBLSId> ids, BL
         size_t start = i;
         size_t count = std::min(batchSize, ids.size() - start);
         auto f = [&, start, count](int threadId) {
-            for (size_t j = start; j < start + count; j++) {
-                if (!skSharesRet[j].SecretKeyShare(svec, ids[j])) {
-                    return false;
-                }
-            }
-            return true;
+            return CBLSSecretKey::SecretKeyShares(svec, ids.subspan(start, count), Span{skSharesRet}.subspan(start, count));
         };
         futures.emplace_back(workerPool.push(f));
     }
@@ -766,6 +764,63 @@ void CBLSWorker::AsyncSign(const CBLSSecretKey& secKey, const uint256& msgHash,
     });
 }
 
+std::vector<CBLSSignature> CBLSWorker::SignBatch(const CBLSSecretKey& secKey, Span<uint256> msgHashes)
+{
+    std::vector<CBLSSignature> sigs(msgHashes.size());
+    RunParallel(msgHashes.size(), [&](size_t i) {
+        sigs[i] = secKey.Sign(msgHashes[i]);
+    });
+    return sigs;
+}
+
+bool CBLSWorker::RecoverSig(Span<CBLSSignature> sigs, Span<CBLSId> ids, CBLSSignature& sigRet)
+{
+    sigRet = CBLSSignature();
+    if (sigs.empty() || sigs.size() != ids.size()) {
+        return false;
+    }
+
+    CHashWriter hw(SER_GETHASH, 0);
+    for (const auto& id : ids) {
+        hw << id;
+    }
+    const uint256 idsHash = hw.GetHash();
+
+    std::shared_ptr<const std::vector<uint256>> coeffs;
+    {
+        std::unique_lock<std::mutex> l(recoveryCoeffsMutex);
+        recoveryCoeffsCache.get(idsHash, coeffs);
+    }
+    if (coeffs == nullptr) {
+        auto newCoeffs = std::make_shared<std::vector<uint256>>();
+        if (!CBLSSignature::GetLagrangeCoefficients(ids, *newCoeffs)) {
+            return false;
+        }
+        coeffs = newCoeffs;
+        std::unique_lock<std::mutex> l(recoveryCoeffsMutex);
+        recoveryCoeffsCache.insert(idsHash, coeffs);
+    }
+
+    // Chunks of the size CBLSSignature::LinearCombination multiplies at once
+    static constexpr size_t CHUNK_SIZE{10};
+    const size_t chunkCount = (sigs.size() + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    std::vector<CBLSSignature> parts(chunkCount);
+    const Span<const uint256> coeffsSpan{*coeffs};
+    RunParallel(chunkCount, [&](size_t i) {
+        const size_t begin = i * CHUNK_SIZE;
+        const size_t count = std::min(CHUNK_SIZE, sigs.size() - begin);
+        parts[i] = CBLSSignature::LinearCombination(sigs.subspan(begin, count), coeffsSpan.subspan(begin, count));
+    });
+
+    for (const auto& part : parts) {
+        if (!part.IsValid()) {
+            return false;
+        }
+    }
+    sigRet = CBLSSignature::AggregateInsecure(parts);
+    return sigRet.IsValid();
+}
+
 void CBLSWorker::AsyncVerifySig(const CBLSSignature& sig, const CBLSPublicKey& pubKey, const uint256& msgHash,
                                 CBLSWorker::SigVerifyDoneCallback doneCallback, CancelCond cancelCond)
 {
@@ -876,3 +931,48 @@ void CBLSWorker::PushSigVerifyBatch()
     sigVerifyBatchesInProgress++;
     workerPool.push(f, batch);
 }
+
+void CBLSWorker::RunParallel(size_t count, const std::function<void(size_t)>& job)
+{
+    if (count == 0) {
+        return;
+    }
+
+    // Helpers may only get to run after we returned, so they must not touch anything but this shared state
+    struct State {
+        std::atomic<size_t> next{0};
+        size_t count;
+        const std::function<void(size_t)>* job;
+        std::mutex mutex;
+        std::condition_variable cv;
+        size_t done{0};
+    };
+    auto state = std::make_shared<State>();
+    state->count = count;
+    state->job = &job;
+
+    auto drain = [](State& s) {
+        size_t idx;
+        while ((idx = s.next++) < s.count) {
+            (*s.job)(idx);
+            std::lock_guard<std::mutex> lock(s.mutex);
+            if (++s.done == s.count) {
+                s.cv.notify_all();
+            }
+        }
+    };
+
+    const size_t helpers = std::min(count - 1, GetWorkerCount());
+    for (size_t i = 0; i < helpers; i++) {
+        workerPool.push([state, drain](int threadId) { drain(*state); });
+    }
+    drain(*state);
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->cv.wait(lock, [&] { return state->done == state->count; });
+}
+
+size_t CBLSWorker::GetWorkerCount()
+{
+    return size_t(workerPool.size());
+}
@@ -8,6 +8,8 @@
 #include <bls/bls.h>
 
 #include <ctpl_stl.h>
+#include <saltedhasher.h>
+#include <unordered_lru_cache.h>
 
 #include <future>
 #include <mutex>
@@ -48,6 +50,11 @@ private:
     int sigVerifyBatchesInProgress{0};
     std::vector<SigVerifyJob> sigVerifyQueue;
 
+    // Lagrange coefficients of RecoverSig, keyed by the hash of the ids they were computed for
+    static const size_t RECOVERY_COEFFS_CACHE_SIZE = 64;
+    std::mutex recoveryCoeffsMutex;
+    unordered_lru_cache<uint256, std::shared_ptr<const std::vector<uint256>>, StaticSaltedHasher, RECOVERY_COEFFS_CACHE_SIZE> recoveryCoeffsCache;
+
 public:
     CBLSWorker();
     ~CBLSWorker();
@@ -121,6 +128,20 @@ public:
     std::future<bool> AsyncVerifySig(const CBLSSignature& sig, const CBLSPublicKey& pubKey, const uint256& msgHash, CancelCond cancelCond = [] { return false; });
     bool IsAsyncVerifyInProgress();
 
+    // Signs all msgHashes with the same key, spread over the worker pool and the calling thread. Each signature costs
+    // a hash to G2 and a scalar multiplication with a different base point, so there's nothing to share between them
+    std::vector<CBLSSignature> SignBatch(const CBLSSecretKey& secKey, Span<uint256> msgHashes);
+
+    // Same as CBLSSignature::Recover, but the multiplications of the shares with their Lagrange coefficients are spread
+    // over the worker pool and the calling thread. The coefficients are cached, quorums tend to recover from the
+    // same members over and over again
+    bool RecoverSig(Span<CBLSSignature> sigs, Span<CBLSId> ids, CBLSSignature& sigRet);
+
+    // Runs job(0) to job(count - 1) on the worker pool and the calling thread and returns once all of them are done
+    // As the calling thread picks up jobs as well, this also makes progress when the pool is busy or stopped
+    void RunParallel(size_t count, const std::function<void(size_t)>& job);
+    size_t GetWorkerCount();
+
 private:
     void PushSigVerifyBatch();
 };
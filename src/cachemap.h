@@ -5,11 +5,18 @@
 #ifndef BITCOIN_CACHEMAP_H
 #define BITCOIN_CACHEMAP_H
 
-#include <map>
-#include <list>
 #include <cstddef>
-
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+#include <saltedhasher.h>
 #include <serialize.h>
+#include <uint256.h>
 
 /**
  * Serializable structure for key/value items
@@ -34,11 +41,347 @@ struct CacheItem
     }
 };
 
+/**
+ * Hasher used for the index of the cache containers, salted for uint256 keys
+ */
+template<typename K>
+struct CacheMapHasher : std::hash<K> {};
+
+template<>
+struct CacheMapHasher<uint256> : StaticSaltedHasher {};
+
+/**
+ * Doubly linked list of CacheItems which lives in a single vector. Items refer
+ * to their neighbours by index and the slots of erased items are reused, so a
+ * cache stops allocating once it was full and walking it stays in one block of
+ * memory. Indexes of items stay valid until the item is erased.
+ *
+ * Serializes exactly like a std::list of the same items.
+ */
+template<typename K, typename V>
+class CacheItemList
+{
+public:
+    using item_t = CacheItem<K,V>;
+
+    using index_t = uint32_t;
+
+    static constexpr index_t NONE = std::numeric_limits<index_t>::max();
+
+private:
+    struct Node {
+        std::optional<item_t> item;
+        index_t prev{NONE};
+        index_t next{NONE};
+    };
+
+    std::vector<Node> vecNodes;
+
+    index_t nHead{NONE};
+
+    index_t nTail{NONE};
+
+    index_t nFree{NONE};
+
+    size_t nSize{0};
+
+public:
+    template<bool IsConst>
+    class iterator_type
+    {
+        template<bool> friend class iterator_type;
+        friend class CacheItemList;
+
+        using list_ptr = std::conditional_t<IsConst, const CacheItemList*, CacheItemList*>;
+
+        list_ptr list{nullptr};
+        index_t index{NONE};
+
+        iterator_type(list_ptr listIn, index_t indexIn) : list(listIn), index(indexIn) {}
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = item_t;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<IsConst, const item_t*, item_t*>;
+        using reference = std::conditional_t<IsConst, const item_t&, item_t&>;
+
+        iterator_type() = default;
+
+        template<bool C = IsConst, typename = std::enable_if_t<C>>
+        iterator_type(const iterator_type<false>& other) : list(other.list), index(other.index) {}
+
+        reference operator*() const { return *list->vecNodes[index].item; }
+        pointer operator->() const { return &*list->vecNodes[index].item; }
+
+        iterator_type& operator++()
+        {
+            index = list->vecNodes[index].next;
+            return *this;
+        }
+
+        iterator_type operator++(int)
+        {
+            iterator_type ret = *this;
+            ++*this;
+            return ret;
+        }
+
+        bool operator==(const iterator_type& other) const { return index == other.index; }
+        bool operator!=(const iterator_type& other) const { return index != other.index; }
+
+        index_t GetIndex() const { return index; }
+    };
+
+    using iterator = iterator_type<false>;
+
+    using const_iterator = iterator_type<true>;
+
+    iterator begin() { return iterator(this, nHead); }
+    iterator end() { return iterator(this, NONE); }
+    const_iterator begin() const { return const_iterator(this, nHead); }
+    const_iterator end() const { return const_iterator(this, NONE); }
+
+    size_t size() const { return nSize; }
+    bool empty() const { return nSize == 0; }
+
+    //! Index of the most recently added item, NONE if empty
+    index_t front_index() const { return nHead; }
+    //! Index of the oldest item, NONE if empty
+    index_t back_index() const { return nTail; }
+    //! All indexes handed out so far are below this
+    size_t index_end() const { return vecNodes.size(); }
+
+    item_t& at(index_t index) { return *vecNodes[index].item; }
+    const item_t& at(index_t index) const { return *vecNodes[index].item; }
+
+    index_t push_front(const item_t& item)
+    {
+        const index_t index = Allocate(item);
+        Node& node = vecNodes[index];
+        node.prev = NONE;
+        node.next = nHead;
+        if (nHead != NONE) {
+            vecNodes[nHead].prev = index;
+        } else {
+            nTail = index;
+        }
+        nHead = index;
+        return index;
+    }
+
+    index_t push_back(const item_t& item)
+    {
+        const index_t index = Allocate(item);
+        Node& node = vecNodes[index];
+        node.prev = nTail;
+        node.next = NONE;
+        if (nTail != NONE) {
+            vecNodes[nTail].next = index;
+        } else {
+            nHead = index;
+        }
+        nTail = index;
+        return index;
+    }
+
+    void erase(index_t index)
+    {
+        Node& node = vecNodes[index];
+        if (node.prev != NONE) {
+            vecNodes[node.prev].next = node.next;
+        } else {
+            nHead = node.next;
+        }
+        if (node.next != NONE) {
+            vecNodes[node.next].prev = node.prev;
+        } else {
+            nTail = node.prev;
+        }
+        node.item.reset();
+        node.prev = NONE;
+        node.next = nFree;
+        nFree = index;
+        --nSize;
+    }
+
+    void clear()
+    {
+        vecNodes.clear();
+        nHead = nTail = nFree = NONE;
+        nSize = 0;
+    }
+
+    template<typename Stream>
+    void Serialize(Stream& s) const
+    {
+        WriteCompactSize(s, nSize);
+        for (const item_t& item : *this) {
+            s << item;
+        }
+    }
+
+    template<typename Stream>
+    void Unserialize(Stream& s)
+    {
+        clear();
+        const unsigned int nCount = ReadCompactSize(s);
+        for (unsigned int i = 0; i < nCount; ++i) {
+            item_t item;
+            s >> item;
+            push_back(item);
+        }
+    }
+
+private:
+    index_t Allocate(const item_t& item)
+    {
+        index_t index;
+        if (nFree != NONE) {
+            index = nFree;
+            nFree = vecNodes[index].next;
+        } else {
+            index = vecNodes.size();
+            vecNodes.emplace_back();
+        }
+        vecNodes[index].item.emplace(item);
+        ++nSize;
+        return index;
+    }
+};
+
+/**
+ * Open addressing hash index from keys to CacheItemList indexes. Keys are not
+ * stored here but looked up in the list through a getter. The 32 bit hash of
+ * every key is kept next to its index, which decides the slot, saves most key
+ * comparisons and lets the table grow without hashing again.
+ */
+template<typename K, typename Hasher>
+class CacheIndex
+{
+public:
+    using index_t = uint32_t;
+
+    static constexpr index_t NONE = std::numeric_limits<index_t>::max();
+
+private:
+    struct Slot {
+        index_t index{NONE};
+        uint32_t hash{0};
+    };
+
+    std::vector<Slot> vecSlots;
+
+    size_t nSize{0};
+
+    Hasher hasher;
+
+public:
+    size_t size() const { return nSize; }
+
+    void clear()
+    {
+        vecSlots.clear();
+        nSize = 0;
+    }
+
+    template<typename GetKey>
+    index_t find(const K& key, const GetKey& getKey) const
+    {
+        const size_t pos = FindSlot(key, getKey);
+        return pos == vecSlots.size() ? NONE : vecSlots[pos].index;
+    }
+
+    //! Add a key which is not in the index yet
+    void insert(const K& key, index_t index)
+    {
+        if ((nSize + 1) * 4 > vecSlots.size() * 3) {
+            Rehash(vecSlots.empty() ? 16 : vecSlots.size() * 2);
+        }
+        const uint32_t hash = Hash(key);
+        size_t pos = hash & Mask();
+        while (vecSlots[pos].index != NONE) {
+            pos = (pos + 1) & Mask();
+        }
+        vecSlots[pos] = Slot{index, hash};
+        ++nSize;
+    }
+
+    //! Point an existing key to another index
+    template<typename GetKey>
+    void update(const K& key, index_t index, const GetKey& getKey)
+    {
+        const size_t pos = FindSlot(key, getKey);
+        if (pos != vecSlots.size()) {
+            vecSlots[pos].index = index;
+        }
+    }
+
+    //! Remove a key, returns the index it pointed to or NONE
+    template<typename GetKey>
+    index_t erase(const K& key, const GetKey& getKey)
+    {
+        size_t hole = FindSlot(key, getKey);
+        if (hole == vecSlots.size()) {
+            return NONE;
+        }
+        const index_t ret = vecSlots[hole].index;
+        // Backward shift deletion: pull following entries of the probe sequence
+        // into the hole unless that would move them before their own slot
+        for (size_t pos = (hole + 1) & Mask(); vecSlots[pos].index != NONE; pos = (pos + 1) & Mask()) {
+            const size_t ideal = vecSlots[pos].hash & Mask();
+            if (((pos - ideal) & Mask()) >= ((pos - hole) & Mask())) {
+                vecSlots[hole] = vecSlots[pos];
+                hole = pos;
+            }
+        }
+        vecSlots[hole] = Slot{};
+        --nSize;
+        return ret;
+    }
+
+private:
+    uint32_t Hash(const K& key) const { return static_cast<uint32_t>(hasher(key)); }
+
+    size_t Mask() const { return vecSlots.size() - 1; }
+
+    template<typename GetKey>
+    size_t FindSlot(const K& key, const GetKey& getKey) const
+    {
+        if (vecSlots.empty()) {
+            return 0;
+        }
+        const uint32_t hash = Hash(key);
+        for (size_t pos = hash & Mask(); vecSlots[pos].index != NONE; pos = (pos + 1) & Mask()) {
+            if (vecSlots[pos].hash == hash && getKey(vecSlots[pos].index) == key) {
+                return pos;
+            }
+        }
+        return vecSlots.size();
+    }
+
+    void Rehash(size_t nSlots)
+    {
+        std::vector<Slot> vecOld;
+        vecOld.swap(vecSlots);
+        vecSlots.resize(nSlots);
+        for (const Slot& slot : vecOld) {
+            if (slot.index == NONE) {
+                continue;
+            }
+            size_t pos = slot.hash & Mask();
+            while (vecSlots[pos].index != NONE) {
+                pos = (pos + 1) & Mask();
+            }
+            vecSlots[pos] = slot;
+        }
+    }
+};
 
 /**
  * Map like container that keeps the N most recently added items
  */
-template<typename K, typename V, typename Size = uint32_t>
+template<typename K, typename V, typename Size = uint32_t, typename Hasher = CacheMapHasher<K>>
 class CacheMap
 {
 public:
@@ -46,17 +389,15 @@ public:
 
     using item_t = CacheItem<K,V>;
 
-    using list_t = std::list<item_t>;
+    using list_t = CacheItemList<K,V>;
 
     using list_it = typename list_t::iterator;
 
     using list_cit = typename list_t::const_iterator;
 
-    using map_t = std::map<K, list_it>;
+    using index_t = typename list_t::index_t;
 
-    using map_it = typename map_t::iterator;
-
-    using map_cit = typename map_t::const_iterator;
+    using map_t = CacheIndex<K, Hasher>;
 
 private:
     size_type nMaxSize;
@@ -72,14 +413,6 @@ public:
           mapIndex()
     {}
 
-    explicit CacheMap(const CacheMap<K,V>& other)
-        : nMaxSize(other.nMaxSize),
-          listItems(other.listItems),
-          mapIndex()
-    {
-        RebuildIndex();
-    }
-
     void Clear()
     {
         mapIndex.clear();
@@ -101,55 +434,44 @@ public:
 
     bool Insert(const K& key, const V& value)
     {
-        if(mapIndex.find(key) != mapIndex.end()) {
+        if(Find(key) != list_t::NONE) {
             return false;
         }
         if(listItems.size() == nMaxSize) {
             PruneLast();
         }
-        listItems.push_front(item_t(key, value));
-        mapIndex.emplace(key, listItems.begin());
+        mapIndex.insert(key, listItems.push_front(item_t(key, value)));
         return true;
     }
 
     bool HasKey(const K& key) const
     {
-        return (mapIndex.find(key) != mapIndex.end());
+        return Find(key) != list_t::NONE;
     }
 
     bool Get(const K& key, V& value) const
     {
-        map_cit it = mapIndex.find(key);
-        if(it == mapIndex.end()) {
+        const index_t index = Find(key);
+        if(index == list_t::NONE) {
             return false;
         }
-        const item_t& item = *(it->second);
-        value = item.value;
+        value = listItems.at(index).value;
         return true;
     }
 
     void Erase(const K& key)
     {
-        map_it it = mapIndex.find(key);
-        if(it == mapIndex.end()) {
+        const index_t index = mapIndex.erase(key, KeyGetter());
+        if(index == list_t::NONE) {
             return;
         }
-        listItems.erase(it->second);
-        mapIndex.erase(it);
+        listItems.erase(index);
     }
 
     const list_t& GetItemList() const {
         return listItems;
     }
 
-    CacheMap<K,V>& operator=(const CacheMap<K,V>& other)
-    {
-        nMaxSize = other.nMaxSize;
-        listItems = other.listItems;
-        RebuildIndex();
-        return *this;
-    }
-
     SERIALIZE_METHODS(CacheMap, obj)
     {
         READWRITE(obj.nMaxSize, obj.listItems);
@@ -157,21 +479,33 @@ public:
     }
 
 private:
+    auto KeyGetter() const
+    {
+        return [this](index_t index) -> const K& { return listItems.at(index).key; };
+    }
+
+    index_t Find(const K& key) const
+    {
+        return mapIndex.find(key, KeyGetter());
+    }
+
     void PruneLast()
     {
         if(listItems.empty()) {
             return;
         }
-        item_t& item = listItems.back();
-        mapIndex.erase(item.key);
-        listItems.pop_back();
+        const index_t index = listItems.back_index();
+        mapIndex.erase(listItems.at(index).key, KeyGetter());
+        listItems.erase(index);
     }
 
     void RebuildIndex()
     {
         mapIndex.clear();
-        for(list_it it = listItems.begin(); it != listItems.end(); ++it) {
-            mapIndex.emplace(it->key, it);
+        for(list_cit it = listItems.begin(); it != listItems.end(); ++it) {
+            if(Find(it->key) == list_t::NONE) {
+                mapIndex.insert(it->key, it.GetIndex());
+            }
         }
     }
 };
@@ -5,10 +5,9 @@
 #ifndef BITCOIN_CACHEMULTIMAP_H
 #define BITCOIN_CACHEMULTIMAP_H
 
+#include <algorithm>
 #include <cstddef>
-#include <map>
-#include <list>
-#include <set>
+#include <vector>
 
 #include <serialize.h>
 
@@ -17,7 +16,7 @@
 /**
  * Map like container that keeps the N most recently added items
  */
-template<typename K, typename V, typename Size = uint32_t>
+template<typename K, typename V, typename Size = uint32_t, typename Hasher = CacheMapHasher<K>>
 class CacheMultiMap
 {
 public:
@@ -25,31 +24,32 @@ public:
 
     using item_t = CacheItem<K,V>;
 
-    using list_t = std::list<item_t>;
+    using list_t = CacheItemList<K,V>;
 
     using list_it = typename list_t::iterator;
 
     using list_cit = typename list_t::const_iterator;
 
-    using it_map_t = std::map<V,list_it>;
+    using index_t = typename list_t::index_t;
 
-    using it_map_it = typename it_map_t::iterator;
-
-    using it_map_cit = typename it_map_t::const_iterator;
-
-    using map_t = std::map<K, it_map_t>;
-
-    using map_it = typename map_t::iterator;
-
-    using map_cit = typename map_t::const_iterator;
+    //! Points to one item of every key, the others are reached through vecKeyLinks
+    using map_t = CacheIndex<K, Hasher>;
 
 private:
+    //! Chains all items of a key, indexed like the items in listItems
+    struct KeyLinks {
+        index_t prev{list_t::NONE};
+        index_t next{list_t::NONE};
+    };
+
     size_type nMaxSize;
 
     list_t listItems;
 
     map_t mapIndex;
 
+    std::vector<KeyLinks> vecKeyLinks;
+
 public:
     explicit CacheMultiMap(size_type nMaxSizeIn = 0)
         : nMaxSize(nMaxSizeIn),
@@ -57,18 +57,11 @@ public:
           mapIndex()
     {}
 
-    explicit CacheMultiMap(const CacheMap<K,V>& other)
-        : nMaxSize(other.nMaxSize),
-          listItems(other.listItems),
-          mapIndex()
-    {
-        RebuildIndex();
-    }
-
     void Clear()
     {
         mapIndex.clear();
         listItems.clear();
+        vecKeyLinks.clear();
     }
 
     void SetMaxSize(size_type nMaxSizeIn)
@@ -86,13 +79,7 @@ public:
 
     bool Insert(const K& key, const V& value)
     {
-        map_it mit = mapIndex.find(key);
-        if(mit == mapIndex.end()) {
-            mit = mapIndex.emplace(key, it_map_t()).first;
-        }
-        it_map_t& mapIt = mit->second;
-
-        if(mapIt.count(value) > 0) {
+        if(FindValue(key, value) != list_t::NONE) {
             // Don't insert duplicates
             return false;
         }
@@ -100,98 +87,88 @@ public:
         if(listItems.size() == nMaxSize) {
             PruneLast();
         }
-        listItems.push_front(item_t(key, value));
-        mapIt.emplace(value, listItems.begin());
+        const index_t index = listItems.push_front(item_t(key, value));
+        if(vecKeyLinks.size() < listItems.index_end()) {
+            vecKeyLinks.resize(listItems.index_end());
+        }
+        LinkKey(key, index);
         return true;
     }
 
     bool HasKey(const K& key) const
     {
-        return (mapIndex.find(key) != mapIndex.end());
+        return Find(key) != list_t::NONE;
     }
 
+    //! Get the smallest value of a key
     bool Get(const K& key, V& value) const
     {
-        map_cit it = mapIndex.find(key);
-        if(it == mapIndex.end()) {
+        index_t best = Find(key);
+        if(best == list_t::NONE) {
             return false;
         }
-        const it_map_t& mapIt = it->second;
-        const item_t& item = *(mapIt.begin()->second);
-        value = item.value;
+        for(index_t index = vecKeyLinks[best].next; index != list_t::NONE; index = vecKeyLinks[index].next) {
+            if(listItems.at(index).value < listItems.at(best).value) {
+                best = index;
+            }
+        }
+        value = listItems.at(best).value;
         return true;
     }
 
-    bool GetAll(const K& key, std::vector<V>& vecValues)
+    //! Get all values of a key, ordered by value
+    bool GetAll(const K& key, std::vector<V>& vecValues) const
     {
-        map_cit mit = mapIndex.find(key);
-        if(mit == mapIndex.end()) {
+        std::vector<index_t> vecIndexes;
+        for(index_t index = Find(key); index != list_t::NONE; index = vecKeyLinks[index].next) {
+            vecIndexes.push_back(index);
+        }
+        if(vecIndexes.empty()) {
             return false;
         }
-        const it_map_t& mapIt = mit->second;
-
-        for(it_map_cit it = mapIt.begin(); it != mapIt.end(); ++it) {
-            const item_t& item = *(it->second);
-            vecValues.push_back(item.value);
+        std::sort(vecIndexes.begin(), vecIndexes.end(), [this](index_t a, index_t b) {
+            return listItems.at(a).value < listItems.at(b).value;
+        });
+        for(const index_t index : vecIndexes) {
+            vecValues.push_back(listItems.at(index).value);
         }
         return true;
     }
 
-    void GetKeys(std::vector<K>& vecKeys)
+    void GetKeys(std::vector<K>& vecKeys) const
     {
-        for(map_cit it = mapIndex.begin(); it != mapIndex.end(); ++it) {
-            vecKeys.push_back(it->first);
+        for(list_cit it = listItems.begin(); it != listItems.end(); ++it) {
+            if(vecKeyLinks[it.GetIndex()].prev == list_t::NONE) {
+                vecKeys.push_back(it->key);
+            }
         }
     }
 
     void Erase(const K& key)
     {
-        map_it mit = mapIndex.find(key);
-        if(mit == mapIndex.end()) {
-            return;
+        index_t index = mapIndex.erase(key, KeyGetter());
+        while(index != list_t::NONE) {
+            const index_t next = vecKeyLinks[index].next;
+            vecKeyLinks[index] = KeyLinks{};
+            listItems.erase(index);
+            index = next;
         }
-        it_map_t& mapIt = mit->second;
-
-        for(it_map_it it = mapIt.begin(); it != mapIt.end(); ++it) {
-            listItems.erase(it->second);
-        }
-
-        mapIndex.erase(mit);
     }
 
     void Erase(const K& key, const V& value)
     {
-        map_it mit = mapIndex.find(key);
-        if(mit == mapIndex.end()) {
+        const index_t index = FindValue(key, value);
+        if(index == list_t::NONE) {
             return;
         }
-        it_map_t& mapIt = mit->second;
-
-        it_map_it it = mapIt.find(value);
-        if(it == mapIt.end()) {
-            return;
-        }
-
-        listItems.erase(it->second);
-        mapIt.erase(it);
-
-        if(mapIt.empty()) {
-            mapIndex.erase(mit);
-        }
+        UnlinkKey(index);
+        listItems.erase(index);
     }
 
     const list_t& GetItemList() const {
         return listItems;
     }
 
-    CacheMap<K,V>& operator=(const CacheMap<K,V>& other)
-    {
-        nMaxSize = other.nMaxSize;
-        listItems = other.listItems;
-        RebuildIndex();
-        return *this;
-    }
-
     SERIALIZE_METHODS(CacheMultiMap, obj)
     {
         READWRITE(obj.nMaxSize, obj.listItems);
@@ -199,42 +176,81 @@ public:
     }
 
 private:
-    void PruneLast()
+    auto KeyGetter() const
     {
-        if(listItems.empty()) {
-            return;
-        }
-
-        list_it lit = listItems.end();
-        --lit;
-        item_t& item = *lit;
+        return [this](index_t index) -> const K& { return listItems.at(index).key; };
+    }
 
-        map_it mit = mapIndex.find(item.key);
+    index_t Find(const K& key) const
+    {
+        return mapIndex.find(key, KeyGetter());
+    }
 
-        if(mit != mapIndex.end()) {
-            it_map_t& mapIt = mit->second;
+    //! Values are the same if neither is smaller than the other, just like in a std::map
+    index_t FindValue(const K& key, const V& value) const
+    {
+        for(index_t index = Find(key); index != list_t::NONE; index = vecKeyLinks[index].next) {
+            const V& other = listItems.at(index).value;
+            if(!(other < value) && !(value < other)) {
+                return index;
+            }
+        }
+        return list_t::NONE;
+    }
 
-            mapIt.erase(item.value);
+    void LinkKey(const K& key, index_t index)
+    {
+        const index_t first = Find(key);
+        if(first == list_t::NONE) {
+            vecKeyLinks[index] = KeyLinks{};
+            mapIndex.insert(key, index);
+            return;
+        }
+        // Link in behind the first item so the index doesn't need to change
+        const index_t next = vecKeyLinks[first].next;
+        vecKeyLinks[index] = KeyLinks{first, next};
+        if(next != list_t::NONE) {
+            vecKeyLinks[next].prev = index;
+        }
+        vecKeyLinks[first].next = index;
+    }
 
-            if(mapIt.empty()) {
-                mapIndex.erase(item.key);
+    void UnlinkKey(index_t index)
+    {
+        const KeyLinks links = vecKeyLinks[index];
+        if(links.prev == list_t::NONE) {
+            const K& key = listItems.at(index).key;
+            if(links.next == list_t::NONE) {
+                mapIndex.erase(key, KeyGetter());
+            } else {
+                mapIndex.update(key, links.next, KeyGetter());
+                vecKeyLinks[links.next].prev = list_t::NONE;
+            }
+        } else {
+            vecKeyLinks[links.prev].next = links.next;
+            if(links.next != list_t::NONE) {
+                vecKeyLinks[links.next].prev = links.prev;
             }
         }
+        vecKeyLinks[index] = KeyLinks{};
+    }
 
-        listItems.pop_back();
+    void PruneLast()
+    {
+        if(listItems.empty()) {
+            return;
+        }
+        const index_t index = listItems.back_index();
+        UnlinkKey(index);
+        listItems.erase(index);
     }
 
     void RebuildIndex()
     {
         mapIndex.clear();
-        for(list_it lit = listItems.begin(); lit != listItems.end(); ++lit) {
-            item_t& item = *lit;
-            map_it mit = mapIndex.find(item.key);
-            if(mit == mapIndex.end()) {
-                mit = mapIndex.emplace(item.key, it_map_t()).first;
-            }
-            it_map_t& mapIt = mit->second;
-            mapIt.emplace(item.value, lit);
+        vecKeyLinks.assign(listItems.index_end(), KeyLinks{});
+        for(list_cit it = listItems.begin(); it != listItems.end(); ++it) {
+            LinkKey(it->key, it.GetIndex());
         }
     }
 };
@@ -134,8 +134,8 @@ enum BlockStatus: uint32_t {
 class CBlockIndex
 {
 public:
-    //! pointer to the hash of the block, if any. Memory is owned by this CBlockIndex
-    const uint256* phashBlock{nullptr};
+    // The fields used by walks along the chain, like GetAncestor, retargeting and GetMedianTimePast, come first and
+    // share a cache line, the rest follows by size so that no padding is needed in between.
 
     //! pointer to the index of the predecessor of this block
     CBlockIndex* pprev{nullptr};
@@ -146,24 +146,32 @@ public:
     //! height of the entry in the chain. The genesis block has height 0
     int nHeight{0};
 
-    //! Which # file this block is stored in (blk?????.dat)
-    int nFile{0};
+    //! block header
+    uint32_t nTime{0};
+    uint32_t nBits{0};
 
-    //! Byte offset within blk?????.dat where this block's data is stored
-    unsigned int nDataPos{0};
+    //! Verification status of this block. See enum BlockStatus
+    //!
+    //! Note: this value is modified to show BLOCK_OPT_WITNESS during UTXO snapshot
+    //! load to avoid the block index being spuriously rewound.
+    //! @sa RewindBlockIndex
+    //! @sa ActivateSnapshot
+    uint32_t nStatus{0};
 
-    //! Byte offset within rev?????.dat where this block's undo data is stored
-    unsigned int nUndoPos{0};
+    //! pointer to the hash of the block, if any. Memory is owned by this CBlockIndex
+    const uint256* phashBlock{nullptr};
+
+    //! block header
+    uint64_t nNonce64{0};
 
     //! (memory only) Total amount of work (expected number of hashes) in the chain up to and including this block
     arith_uint256 nChainWork{};
 
-    //! Number of transactions in this block.
-    //! Note: in a potential headers-first mode, this number cannot be relied upon
-    //! Note: this value is faked during UTXO snapshot load to ensure that
-    //! LoadBlockIndex() will load index entries for blocks that we lack data for.
-    //! @sa ActivateSnapshot
-    unsigned int nTx{0};
+    //! (memory only) Maximum nTime in the chain up to and including this block.
+    unsigned int nTimeMax{0};
+
+    //! (memory only) Sequential id assigned to distinguish order in which blocks are received.
+    int32_t nSequenceId{0};
 
     //! (memory only) Number of transactions in the chain up to and including this block.
     //! This value will be non-zero only if and only if transactions for this block and all its parents are available.
@@ -175,41 +183,40 @@ public:
     //! @sa ActivateSnapshot
     unsigned int nChainTx{0};
 
-    //! Verification status of this block. See enum BlockStatus
-    //!
-    //! Note: this value is modified to show BLOCK_OPT_WITNESS during UTXO snapshot
-    //! load to avoid the block index being spuriously rewound.
-    //! @sa RewindBlockIndex
+    //! Number of transactions in this block.
+    //! Note: in a potential headers-first mode, this number cannot be relied upon
+    //! Note: this value is faked during UTXO snapshot load to ensure that
+    //! LoadBlockIndex() will load index entries for blocks that we lack data for.
     //! @sa ActivateSnapshot
-    uint32_t nStatus{0};
+    unsigned int nTx{0};
+
+    //! Which # file this block is stored in (blk?????.dat)
+    int nFile{0};
+
+    //! Byte offset within blk?????.dat where this block's data is stored
+    unsigned int nDataPos{0};
+
+    //! Byte offset within rev?????.dat where this block's undo data is stored
+    unsigned int nUndoPos{0};
 
     //! block header
     int32_t nVersion{0};
-    uint256 hashMerkleRoot{};
-    uint32_t nTime{0};
-    uint32_t nBits{0};
     uint32_t nNonce{0};
-    uint64_t nNonce64;
+    uint256 hashMerkleRoot{};
     uint256 mix_hash;
-    //! (memory only) Sequential id assigned to distinguish order in which blocks are received.
-    int32_t nSequenceId{0};
-
-    //! (memory only) Maximum nTime in the chain up to and including this block.
-    unsigned int nTimeMax{0};
 
     CBlockIndex()
     {
     }
 
     explicit CBlockIndex(const CBlockHeader& block)
-        : nVersion{block.nVersion},
-          hashMerkleRoot{block.hashMerkleRoot},
+        : nHeight{block.nHeight},
           nTime{block.nTime},
           nBits{block.nBits},
-          nHeight{block.nHeight},
           nNonce64{block.nNonce64},
+          nVersion{block.nVersion},
+          hashMerkleRoot{block.hashMerkleRoot},
           mix_hash{block.mix_hash}
-
     {
     }
 
@@ -244,6 +251,9 @@ public:
         block.nHeight        = nHeight;
         block.nNonce64       = nNonce64;
         block.mix_hash       = mix_hash;
+        if (phashBlock) {
+            block.SetKnownHash(*phashBlock);
+        }
         return block;
     }
 
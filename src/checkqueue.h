@@ -7,9 +7,17 @@
 
 #include <sync.h>
 #include <tinyformat.h>
+#include <logging.h>
+#include <util/thread.h>
 #include <util/threadnames.h>
 
 #include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <string>
+#include <thread>
 #include <vector>
 
 template <typename T>
@@ -24,12 +32,22 @@ class CCheckQueueControl;
   * onto the queue, where they are processed by N-1 worker threads. When
   * the master is done adding work, it temporarily joins the worker pool
   * as an N'th worker, until all jobs are done.
+  *
+  * Every worker, and the master, has a queue of its own. The batches added
+  * are spread over them, each worker takes work from the back of its own queue
+  * and once it is empty steals from the front of the others, so the workers
+  * don't all wait for one lock. m_mutex is only taken to sleep and wake up.
   */
 template <typename T>
 class CCheckQueue
 {
 private:
-    //! Mutex to protect the inner state
+    struct WorkerQueue {
+        Mutex m_mutex;
+        std::deque<T> m_checks GUARDED_BY(m_mutex);
+    };
+
+    //! Mutex for the worker and master threads to wait on
     Mutex m_mutex;
 
     //! Worker threads block on this when out of work
@@ -38,25 +56,24 @@ private:
     //! Master thread blocks on this when out of work
     std::condition_variable m_master_cv;
 
-    //! The queue of elements to be processed.
-    //! As the order of booleans doesn't matter, it is used as a LIFO (stack)
-    std::vector<T> queue GUARDED_BY(m_mutex);
+    //! The queues of the workers, the last one is the master's
+    std::vector<std::unique_ptr<WorkerQueue>> m_queues;
 
-    //! The number of workers (including the master) that are idle.
-    int nIdle GUARDED_BY(m_mutex){0};
+    //! The queue the next batch is added to
+    size_t m_next_queue{0};
 
-    //! The total number of workers (including the master).
-    int nTotal GUARDED_BY(m_mutex){0};
+    //! Number of checks which are queued and not taken by a worker yet
+    std::atomic<unsigned int> m_queued{0};
 
     //! The temporary evaluation result.
-    bool fAllOk GUARDED_BY(m_mutex){true};
+    std::atomic<bool> fAllOk{true};
 
     /**
      * Number of verifications that haven't completed yet.
      * This includes elements that are no longer queued, but still in the
      * worker's own batches.
      */
-    unsigned int nTodo GUARDED_BY(m_mutex){0};
+    std::atomic<unsigned int> nTodo{0};
 
     //! The maximum number of elements to be processed in one batch
     const unsigned int nBatchSize;
@@ -64,67 +81,72 @@ private:
     std::vector<std::thread> m_worker_threads;
     bool m_request_stop GUARDED_BY(m_mutex){false};
 
+    /** Take up to half of a queue, at most nBatchSize: from the back of the own one, the front of another */
+    bool Take(WorkerQueue& queue, bool own, std::vector<T>& vChecks)
+    {
+        LOCK(queue.m_mutex);
+        if (queue.m_checks.empty()) return false;
+        const size_t nNow = std::max<size_t>(1, std::min<size_t>(nBatchSize, queue.m_checks.size() / 2));
+        vChecks.resize(nNow);
+        for (size_t i = 0; i < nNow; i++) {
+            // swap instead of copying, like the checks were added
+            if (own) {
+                vChecks[i].swap(queue.m_checks.back());
+                queue.m_checks.pop_back();
+            } else {
+                vChecks[i].swap(queue.m_checks.front());
+                queue.m_checks.pop_front();
+            }
+        }
+        m_queued -= nNow;
+        return true;
+    }
+
+    /** Get work from the own queue, else from the others, starting with the next one */
+    bool TakeAny(size_t self, std::vector<T>& vChecks)
+    {
+        if (m_queued == 0) return false;
+        for (size_t i = 0; i < m_queues.size(); i++) {
+            const size_t index = (self + i) % m_queues.size();
+            if (Take(*m_queues[index], i == 0, vChecks)) return true;
+        }
+        return false;
+    }
+
     /** Internal function that does bulk of the verification work. */
-    bool Loop(bool fMaster)
+    bool Loop(size_t self, bool fMaster)
     {
-        std::condition_variable& cond = fMaster ? m_master_cv : m_worker_cv;
         std::vector<T> vChecks;
         vChecks.reserve(nBatchSize);
-        unsigned int nNow = 0;
-        bool fOk = true;
         do {
-            {
+            if (!TakeAny(self, vChecks)) {
                 WAIT_LOCK(m_mutex, lock);
-                // first do the clean-up of the previous loop run (allowing us to do it in the same critsect)
-                if (nNow) {
-                    fAllOk &= fOk;
-                    nTodo -= nNow;
-                    if (nTodo == 0 && !fMaster)
-                        // We processed the last element; inform the master it can exit and return the result
-                        m_master_cv.notify_one();
+                if (fMaster) {
+                    m_master_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return nTodo == 0 || m_queued > 0; });
+                    if (nTodo == 0) {
+                        // return the current status and reset it for new work later
+                        return fAllOk.exchange(true);
+                    }
                 } else {
-                    // first iteration
-                    nTotal++;
-                }
-                // logically, the do loop starts here
-                while (queue.empty() && !m_request_stop) {
-                    if (fMaster && nTodo == 0) {
-                        nTotal--;
-                        bool fRet = fAllOk;
-                        // reset the status for new work later
-                        fAllOk = true;
-                        // return the current status
-                        return fRet;
+                    m_worker_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return m_request_stop || m_queued > 0; });
+                    if (m_request_stop) {
+                        return false;
                     }
-                    nIdle++;
-                    cond.wait(lock); // wait
-                    nIdle--;
-                }
-                if (m_request_stop) {
-                    return false;
-                }
-
-                // Decide how many work units to process now.
-                // * Do not try to do everything at once, but aim for increasingly smaller batches so
-                //   all workers finish approximately simultaneously.
-                // * Try to account for idle jobs which will instantly start helping.
-                // * Don't do batches smaller than 1 (duh), or larger than nBatchSize.
-                nNow = std::max(1U, std::min(nBatchSize, (unsigned int)queue.size() / (nTotal + nIdle + 1)));
-                vChecks.resize(nNow);
-                for (unsigned int i = 0; i < nNow; i++) {
-                    // We want the lock on the m_mutex to be as short as possible, so swap jobs from the global
-                    // queue to the local batch vector instead of copying.
-                    vChecks[i].swap(queue.back());
-                    queue.pop_back();
                 }
-                // Check whether we need to do work at all
-                fOk = fAllOk;
+                continue;
             }
-            // execute work
+            // execute work, unless a check failed already
+            const unsigned int nNow = vChecks.size();
+            bool fOk = fAllOk;
             for (T& check : vChecks)
                 if (fOk)
                     fOk = check();
             vChecks.clear();
+            if (!fOk) fAllOk = false;
+            if ((nTodo -= nNow) == 0) {
+                // We processed the last element; inform the master it can exit and return the result
+                WITH_LOCK(m_mutex, m_master_cv.notify_one());
+            }
         } while (true);
     }
 
@@ -134,24 +156,33 @@ public:
 
     //! Create a new check queue
     explicit CCheckQueue(unsigned int nBatchSizeIn)
-        : nBatchSize(nBatchSizeIn)
+        : m_queues(1), nBatchSize(nBatchSizeIn)
     {
+        m_queues[0] = std::make_unique<WorkerQueue>();
     }
 
-    //! Create a pool of new worker threads.
-    void StartWorkerThreads(const int threads_num)
+    /**
+     * Create a pool of new worker threads. With pin_threads each of them runs on one core only, starting
+     * with the second one which is left to the master. Consecutive cores usually share a NUMA node.
+     */
+    void StartWorkerThreads(const int threads_num, const std::string& thread_name = "scriptch", bool pin_threads = false)
     {
-        {
-            LOCK(m_mutex);
-            nIdle = 0;
-            nTotal = 0;
-            fAllOk = true;
-        }
+        fAllOk = true;
         assert(m_worker_threads.empty());
+        assert(m_queued == 0 && nTodo == 0);
+        m_queues.resize(threads_num + 1);
+        for (auto& queue : m_queues) {
+            if (!queue) queue = std::make_unique<WorkerQueue>();
+        }
+        m_next_queue = 0;
+        const unsigned int cores = std::thread::hardware_concurrency();
         for (int n = 0; n < threads_num; ++n) {
-            m_worker_threads.emplace_back([this, n]() {
-                util::ThreadRename(strprintf("scriptch.%i", n));
-                Loop(false /* worker thread */);
+            m_worker_threads.emplace_back([this, n, thread_name, pin_threads, cores]() {
+                util::ThreadRename(strprintf("%s.%i", thread_name, n));
+                if (pin_threads && cores > 1 && !util::PinThreadToCore((n + 1) % cores)) {
+                    LogPrintf("%s: Failed to pin %s.%i to a core\n", __func__, thread_name, n);
+                }
+                Loop(n, false /* worker thread */);
             });
         }
     }
@@ -159,7 +190,7 @@ public:
     //! Wait until execution finishes, and return whether all evaluations were successful.
     bool Wait()
     {
-        return Loop(true /* master thread */);
+        return Loop(m_queues.size() - 1, true /* master thread */);
     }
 
     //! Add a batch of checks to the queue
@@ -169,15 +200,22 @@ public:
             return;
         }
 
+        // Count first, so a worker never takes more than m_queued says is there
+        nTodo += vChecks.size();
+        m_queued += vChecks.size();
+        // Only the master adds, it spreads the batches over the queues
+        WorkerQueue& queue = *m_queues[m_next_queue];
+        m_next_queue = (m_next_queue + 1) % m_queues.size();
         {
-            LOCK(m_mutex);
+            LOCK(queue.m_mutex);
             for (T& check : vChecks) {
-                queue.emplace_back();
-                check.swap(queue.back());
+                queue.m_checks.emplace_back();
+                check.swap(queue.m_checks.back());
             }
-            nTodo += vChecks.size();
         }
 
+        // taking the lock orders this with a worker that is about to wait
+        WITH_LOCK(m_mutex, );
         if (vChecks.size() == 1) {
             m_worker_cv.notify_one();
         } else {
@@ -194,6 +232,8 @@ public:
             t.join();
         }
         m_worker_threads.clear();
+        m_queues.resize(1);
+        m_next_queue = 0;
         WITH_LOCK(m_mutex, m_request_stop = false);
     }
 
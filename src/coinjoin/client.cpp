@@ -19,6 +19,7 @@
 #include <util/moneystr.h>
 #include <util/ranges.h>
 #include <util/system.h>
+#include <util/trace.h>
 #include <util/translation.h>
 #include <validation.h>
 #include <version.h>
@@ -26,6 +27,7 @@
 #include <wallet/coincontrol.h>
 #include <wallet/fees.h>
 
+#include <algorithm>
 #include <memory>
 #include <univalue.h>
 
@@ -49,8 +51,8 @@ PeerMsgRet CCoinJoinClientQueueManager::ProcessDSQueue(const CNode& peer, CDataS
         return tl::unexpected{100};
     }
 
+    const auto mnList = deterministicMNManager->GetListAtChainTip();
     if (dsq.masternodeOutpoint.IsNull()) {
-        auto mnList = deterministicMNManager->GetListAtChainTip();
         if (auto dmn = mnList.GetValidMN(dsq.m_protxHash)) {
             dsq.masternodeOutpoint = dmn->collateralOutpoint;
         } else {
@@ -82,7 +84,6 @@ PeerMsgRet CCoinJoinClientQueueManager::ProcessDSQueue(const CNode& peer, CDataS
 
         if (dsq.IsTimeOutOfBounds()) return {};
 
-        auto mnList = deterministicMNManager->GetListAtChainTip();
         auto dmn = mnList.GetValidMNByCollateral(dsq.masternodeOutpoint);
         if (!dmn) return {};
 
@@ -90,7 +91,7 @@ PeerMsgRet CCoinJoinClientQueueManager::ProcessDSQueue(const CNode& peer, CDataS
             dsq.m_protxHash = dmn->proTxHash;
         }
 
-        if (!dsq.CheckSignature(dmn->pdmnState->pubKeyOperator.Get())) {
+        if (!CheckQueueSignature(dsq, dmn->pdmnState->pubKeyOperator.Get())) {
             return tl::unexpected{10};
         }
 
@@ -559,11 +560,9 @@ bool CCoinJoinClientSession::SignFinalTransaction(const CTxMemPool& mempool, con
 
     // STEP 1: check final transaction general rules
 
-    // Make sure it's BIP69 compliant
-    sort(finalMutableTransaction.vin.begin(), finalMutableTransaction.vin.end(), CompareInputBIP69());
-    sort(finalMutableTransaction.vout.begin(), finalMutableTransaction.vout.end(), CompareOutputBIP69());
-
-    if (finalMutableTransaction.GetHash() != finalTransactionNew.GetHash()) {
+    // Make sure it's BIP69 compliant, checking the order doesn't need to sort a copy and hash it
+    if (!std::is_sorted(finalMutableTransaction.vin.begin(), finalMutableTransaction.vin.end(), CompareInputBIP69()) ||
+        !std::is_sorted(finalMutableTransaction.vout.begin(), finalMutableTransaction.vout.end(), CompareOutputBIP69())) {
         WalletCJLogPrint(m_wallet, "CCoinJoinClientSession::%s -- ERROR! Masternode %s is not BIP69 compliant!\n", __func__, mixingMasternode->proTxHash.ToString());
         UnlockCoins();
         keyHolderStorage.ReturnAll();
@@ -1416,15 +1415,21 @@ bool CCoinJoinClientSession::MakeCollateralAmounts(const CBlockPolicyEstimator&
         return a.nAmount < b.nAmount;
     });
 
+    // Even one collateral output would take more than these have, don't bother building txes for them.
+    // The tally is sorted, so these are all at the front.
+    const auto itFirstUsable = std::find_if(vecTally.begin(), vecTally.end(), [](const CompactTallyItem& item) {
+        return item.nAmount > CoinJoin::GetCollateralAmount();
+    });
+
     // First try to use only non-denominated funds
-    for (const auto& item : vecTally) {
-        if (!MakeCollateralAmounts(fee_estimator, item, false)) continue;
+    for (auto it = itFirstUsable; it != vecTally.end(); ++it) {
+        if (!MakeCollateralAmounts(fee_estimator, *it, false)) continue;
         return true;
     }
 
     // There should be at least some denominated funds we should be able to break in pieces to continue mixing
-    for (const auto& item : vecTally) {
-        if (!MakeCollateralAmounts(fee_estimator, item, true)) continue;
+    for (auto it = itFirstUsable; it != vecTally.end(); ++it) {
+        if (!MakeCollateralAmounts(fee_estimator, *it, true)) continue;
         return true;
     }
 
@@ -1599,8 +1604,17 @@ bool CCoinJoinClientSession::CreateDenominated(CBlockPolicyEstimator& fee_estima
 
     bool fCreateMixingCollaterals = !m_wallet.HasCollateralInputs();
 
+    // Count the denoms we already have once instead of going through all the wallet's coins again for
+    // every denom and every tally item we try
+    const std::map<CAmount, int> mapDenomCount = m_wallet.CountInputsWithAmounts(CoinJoin::GetStandardDenominations());
+
+    // Anything that can't even fit the smallest denom (and the collateral) won't make a tx, and as the
+    // tally is sorted neither will anything after it
+    const CAmount nMinAmount = CoinJoin::GetSmallestDenomination() + (fCreateMixingCollaterals ? CoinJoin::GetMaxCollateralAmount() : 0);
+
     for (const auto& item : vecTally) {
-        if (!CreateDenominated(fee_estimator, nBalanceToDenominate, item, fCreateMixingCollaterals)) continue;
+        if (item.nAmount < nMinAmount) break;
+        if (!CreateDenominated(fee_estimator, nBalanceToDenominate, item, fCreateMixingCollaterals, mapDenomCount)) continue;
         return true;
     }
 
@@ -1609,7 +1623,7 @@ bool CCoinJoinClientSession::CreateDenominated(CBlockPolicyEstimator& fee_estima
 }
 
 // Create denominations
-bool CCoinJoinClientSession::CreateDenominated(CBlockPolicyEstimator& fee_estimator, CAmount nBalanceToDenominate, const CompactTallyItem& tallyItem, bool fCreateMixingCollaterals)
+bool CCoinJoinClientSession::CreateDenominated(CBlockPolicyEstimator& fee_estimator, CAmount nBalanceToDenominate, const CompactTallyItem& tallyItem, bool fCreateMixingCollaterals, std::map<CAmount, int> mapDenomCount)
 {
     AssertLockHeld(m_wallet.cs_wallet);
 
@@ -1643,11 +1657,6 @@ bool CCoinJoinClientSession::CreateDenominated(CBlockPolicyEstimator& fee_estima
     bool fAddFinal = true;
     auto denoms = CoinJoin::GetStandardDenominations();
 
-    std::map<CAmount, int> mapDenomCount;
-    for (auto nDenomValue : denoms) {
-        mapDenomCount.insert(std::pair<CAmount, int>(nDenomValue, m_wallet.CountInputsWithAmount(nDenomValue)));
-    }
-
     // Will generate outputs for the createdenoms up to coinjoinmaxdenoms per denom
 
     // This works in the way creating PS denoms has traditionally worked, assuming enough funds,
@@ -1818,6 +1827,11 @@ void CCoinJoinClientSession::RelayIn(const CCoinJoinEntry& entry, CConnman& conn
 void CCoinJoinClientSession::SetState(PoolState nStateNew)
 {
     WalletCJLogPrint(m_wallet, "CCoinJoinClientSession::SetState -- nState: %d, nStateNew: %d\n", nState.load(), nStateNew);
+    TRACE4(coinjoin, client_state,
+        nSessionID.load(),
+        nSessionDenom,
+        nState.load(),
+        nStateNew);
     nState = nStateNew;
 }
 
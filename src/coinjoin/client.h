@@ -124,7 +124,7 @@ private:
 
     /// Create denominations
     bool CreateDenominated(CBlockPolicyEstimator& fee_estimator, CAmount nBalanceToDenominate);
-    bool CreateDenominated(CBlockPolicyEstimator& fee_estimator, CAmount nBalanceToDenominate, const CompactTallyItem& tallyItem, bool fCreateMixingCollaterals);
+    bool CreateDenominated(CBlockPolicyEstimator& fee_estimator, CAmount nBalanceToDenominate, const CompactTallyItem& tallyItem, bool fCreateMixingCollaterals, std::map<CAmount, int> mapDenomCount);
 
     /// Split up large inputs or make fee sized inputs
     bool MakeCollateralAmounts(const CBlockPolicyEstimator& fee_estimator);
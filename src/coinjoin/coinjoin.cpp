@@ -9,6 +9,7 @@
 #include <chainparams.h>
 #include <consensus/validation.h>
 #include <governance/common.h>
+#include <hash.h>
 #include <llmq/chainlocks.h>
 #include <llmq/instantsend.h>
 #include <masternode/node.h>
@@ -18,6 +19,7 @@
 #include <txmempool.h>
 #include <util/moneystr.h>
 #include <util/system.h>
+#include <util/trace.h>
 #include <util/translation.h>
 #include <validation.h>
 
@@ -155,6 +157,9 @@ void CCoinJoinBaseSession::SetNull()
 {
     // Both sides
     AssertLockHeld(cs_coinjoin);
+    TRACE2(coinjoin, session_reset,
+        nSessionID.load(),
+        nState.load());
     nState = POOL_STATE_IDLE;
     nSessionID = 0;
     nSessionDenom = 0;
@@ -187,6 +192,21 @@ void CCoinJoinBaseManager::CheckQueue()
     }
 }
 
+bool CCoinJoinBaseManager::CheckQueueSignature(const CCoinJoinQueue& dsq, const CBLSPublicKey& blsPubKey)
+{
+    CHashWriter hw(SER_GETHASH, 0);
+    hw << dsq << dsq.vchSig << blsPubKey;
+    const uint256 key = hw.GetHash();
+
+    bool valid;
+    if (WITH_LOCK(cs_checked_signatures, return checkedSignatures.get(key, valid))) {
+        return valid;
+    }
+    valid = dsq.CheckSignature(blsPubKey);
+    WITH_LOCK(cs_checked_signatures, checkedSignatures.insert(key, valid));
+    return valid;
+}
+
 bool CCoinJoinBaseManager::GetQueueItemAndTry(CCoinJoinQueue& dsqRet)
 {
     TRY_LOCK(cs_vecqueue, lockDS);
@@ -268,9 +288,22 @@ bool CCoinJoinBaseSession::IsValidInOuts(const CTxMemPool& mempool, const std::v
         nFees -= txout.nValue;
     }
 
-    CCoinsViewMemPool viewMemPool(WITH_LOCK(cs_main, return &::ChainstateActive().CoinsTip()), mempool);
+    // Look all inputs up in one go rather than going through the chain tip and the mempool once per input,
+    // a default constructed coin is spent so missing inputs are caught below
+    std::vector<Coin> vecCoins(vin.size());
+    {
+        LOCK2(cs_main, mempool.cs);
+        CCoinsViewMemPool viewMemPool(&::ChainstateActive().CoinsTip(), mempool);
+        for (size_t i = 0; i < vin.size(); ++i) {
+            if (!vin[i].prevout.IsNull()) {
+                viewMemPool.GetCoin(vin[i].prevout, vecCoins[i]);
+            }
+        }
+    }
 
-    for (const auto& txin : vin) {
+    for (size_t i = 0; i < vin.size(); ++i) {
+        const CTxIn& txin = vin[i];
+        const Coin& coin = vecCoins[i];
         LogPrint(BCLog::COINJOIN, "CCoinJoinBaseSession::%s -- txin=%s\n", __func__, txin.ToString());
 
         if (txin.prevout.IsNull()) {
@@ -280,8 +313,7 @@ bool CCoinJoinBaseSession::IsValidInOuts(const CTxMemPool& mempool, const std::v
             return false;
         }
 
-        Coin coin;
-        if (!viewMemPool.GetCoin(txin.prevout, coin) || coin.IsSpent() ||
+        if (coin.IsSpent() ||
             (coin.nHeight == MEMPOOL_HEIGHT && !llmq::quorumInstantSendManager->IsLocked(txin.prevout.hash))) {
             LogPrint(BCLog::COINJOIN, "CCoinJoinBaseSession::%s -- ERROR: missing, spent or non-locked mempool input! txin=%s\n", __func__, txin.ToString());
             nMessageIDRet = ERR_MISSING_TX;
@@ -436,32 +468,53 @@ std::unique_ptr<CDSTXManager> dstxManager;
 
 void CDSTXManager::AddDSTX(const CCoinJoinBroadcastTx& dstx)
 {
-    AssertLockNotHeld(cs_mapdstx);
-    LOCK(cs_mapdstx);
-    mapDSTX.insert(std::make_pair(dstx.tx->GetHash(), dstx));
+    const uint256 hash = dstx.tx->GetHash();
+    Shard& shard = GetShard(hash);
+    LOCK(shard.cs_mapdstx);
+    const auto [it, inserted] = shard.mapDSTX.emplace(hash, dstx);
+    if (const auto nHeight = it->second.GetConfirmedHeight(); inserted && nHeight.has_value()) {
+        shard.mapDSTXByHeight[*nHeight].insert(hash);
+    }
 }
 
 CCoinJoinBroadcastTx CDSTXManager::GetDSTX(const uint256& hash)
 {
-    AssertLockNotHeld(cs_mapdstx);
-    LOCK(cs_mapdstx);
-    auto it = mapDSTX.find(hash);
-    return (it == mapDSTX.end()) ? CCoinJoinBroadcastTx() : it->second;
+    Shard& shard = GetShard(hash);
+    LOCK(shard.cs_mapdstx);
+    auto it = shard.mapDSTX.find(hash);
+    return (it == shard.mapDSTX.end()) ? CCoinJoinBroadcastTx() : it->second;
+}
+
+bool CDSTXManager::HasDSTX(const uint256& hash)
+{
+    Shard& shard = GetShard(hash);
+    LOCK(shard.cs_mapdstx);
+    return shard.mapDSTX.count(hash) != 0;
 }
 
 void CDSTXManager::CheckDSTXes(const CBlockIndex* pindex, const llmq::CChainLocksHandler& clhandler)
 {
-    AssertLockNotHeld(cs_mapdstx);
-    LOCK(cs_mapdstx);
-    auto it = mapDSTX.begin();
-    while (it != mapDSTX.end()) {
-        if (it->second.IsExpired(pindex, clhandler)) {
-            mapDSTX.erase(it++);
-        } else {
-            ++it;
+    size_t nErased{0};
+    size_t nSize{0};
+    for (Shard& shard : shards) {
+        LOCK(shard.cs_mapdstx);
+        // Whether a DSTX expired only depends on its confirmation height, if the oldest one
+        // at some height didn't expire yet then neither did anything confirmed later
+        auto it = shard.mapDSTXByHeight.begin();
+        while (it != shard.mapDSTXByHeight.end()) {
+            assert(!it->second.empty());
+            if (!shard.mapDSTX.at(*it->second.begin()).IsExpired(pindex, clhandler)) {
+                break;
+            }
+            for (const uint256& hash : it->second) {
+                shard.mapDSTX.erase(hash);
+                ++nErased;
+            }
+            it = shard.mapDSTXByHeight.erase(it);
         }
+        nSize += shard.mapDSTX.size();
     }
-    LogPrint(BCLog::COINJOIN, "CoinJoin::CheckDSTXes -- mapDSTX.size()=%llu\n", mapDSTX.size());
+    LogPrint(BCLog::COINJOIN, "CoinJoin::CheckDSTXes -- mapDSTX.size()=%llu, expired %llu\n", nSize, nErased);
 }
 
 void CDSTXManager::UpdatedBlockTip(const CBlockIndex* pindex, const llmq::CChainLocksHandler& clhandler, const CMasternodeSync& mn_sync)
@@ -480,29 +533,37 @@ void CDSTXManager::NotifyChainLock(const CBlockIndex* pindex, const llmq::CChain
 
 void CDSTXManager::UpdateDSTXConfirmedHeight(const CTransactionRef& tx, std::optional<int> nHeight)
 {
-    AssertLockHeld(cs_mapdstx);
+    const uint256& hash = tx->GetHash();
+    Shard& shard = GetShard(hash);
+    LOCK(shard.cs_mapdstx);
 
-    auto it = mapDSTX.find(tx->GetHash());
-    if (it == mapDSTX.end()) {
+    auto it = shard.mapDSTX.find(hash);
+    if (it == shard.mapDSTX.end()) {
         return;
     }
 
+    if (const auto nOldHeight = it->second.GetConfirmedHeight(); nOldHeight.has_value()) {
+        auto itHeight = shard.mapDSTXByHeight.find(*nOldHeight);
+        assert(itHeight != shard.mapDSTXByHeight.end());
+        itHeight->second.erase(hash);
+        if (itHeight->second.empty()) {
+            shard.mapDSTXByHeight.erase(itHeight);
+        }
+    }
     it->second.SetConfirmedHeight(nHeight);
-    LogPrint(BCLog::COINJOIN, "CDSTXManager::%s -- txid=%s, nHeight=%d\n", __func__, tx->GetHash().ToString(), nHeight.value_or(-1));
+    if (nHeight.has_value()) {
+        shard.mapDSTXByHeight[*nHeight].insert(hash);
+    }
+    LogPrint(BCLog::COINJOIN, "CDSTXManager::%s -- txid=%s, nHeight=%d\n", __func__, hash.ToString(), nHeight.value_or(-1));
 }
 
 void CDSTXManager::TransactionAddedToMempool(const CTransactionRef& tx)
 {
-    AssertLockNotHeld(cs_mapdstx);
-    LOCK(cs_mapdstx);
     UpdateDSTXConfirmedHeight(tx, std::nullopt);
 }
 
 void CDSTXManager::BlockConnected(const std::shared_ptr<const CBlock>& pblock, const CBlockIndex* pindex)
 {
-    AssertLockNotHeld(cs_mapdstx);
-    LOCK(cs_mapdstx);
-
     for (const auto& tx : pblock->vtx) {
         UpdateDSTXConfirmedHeight(tx, pindex->nHeight);
     }
@@ -510,8 +571,6 @@ void CDSTXManager::BlockConnected(const std::shared_ptr<const CBlock>& pblock, c
 
 void CDSTXManager::BlockDisconnected(const std::shared_ptr<const CBlock>& pblock, const CBlockIndex*)
 {
-    AssertLockNotHeld(cs_mapdstx);
-    LOCK(cs_mapdstx);
     for (const auto& tx : pblock->vtx) {
         UpdateDSTXConfirmedHeight(tx, std::nullopt);
     }
@@ -11,15 +11,20 @@
 #include <netaddress.h>
 #include <primitives/block.h>
 #include <primitives/transaction.h>
+#include <saltedhasher.h>
 #include <sync.h>
 #include <timedata.h>
+#include <unordered_lru_cache.h>
 #include <univalue.h>
 #include <util/translation.h>
 #include <version.h>
 
+#include <array>
 #include <atomic>
 #include <map>
 #include <optional>
+#include <set>
+#include <unordered_map>
 #include <utility>
 
 class CChainState;
@@ -136,7 +141,7 @@ public:
 
     friend bool operator==(const CCoinJoinAccept& a, const CCoinJoinAccept& b)
     {
-        return a.nDenom == b.nDenom && CTransaction(a.txCollateral) == CTransaction(b.txCollateral);
+        return a.nDenom == b.nDenom && a.txCollateral.GetHash() == b.txCollateral.GetHash();
     }
 };
 
@@ -287,6 +292,7 @@ public:
     bool Sign();
     [[nodiscard]] bool CheckSignature(const CBLSPublicKey& blsPubKey) const;
 
+    std::optional<int> GetConfirmedHeight() const { return nConfirmedHeight; }
     void SetConfirmedHeight(std::optional<int> nConfirmedHeightIn) { assert(nConfirmedHeightIn == std::nullopt || *nConfirmedHeightIn > 0); nConfirmedHeight = nConfirmedHeightIn; }
     bool IsExpired(const CBlockIndex* pindex, const llmq::CChainLocksHandler& clhandler) const;
     [[nodiscard]] bool IsValidStructure() const;
@@ -335,6 +341,17 @@ protected:
     void SetNull() LOCKS_EXCLUDED(cs_vecqueue);
     void CheckQueue() LOCKS_EXCLUDED(cs_vecqueue);
 
+    /**
+     * CCoinJoinQueue::CheckSignature with the results of recent checks kept, by queue, signature and key. Every
+     * peer relays the same queues, ready ones and the ones a masternode sends too often are not kept in
+     * vecCoinJoinQueue though, so without this each of them would be verified once per peer.
+     */
+    bool CheckQueueSignature(const CCoinJoinQueue& dsq, const CBLSPublicKey& blsPubKey) LOCKS_EXCLUDED(cs_checked_signatures);
+
+private:
+    mutable Mutex cs_checked_signatures;
+    unordered_lru_cache<uint256, bool, StaticSaltedHasher, 1024> checkedSignatures GUARDED_BY(cs_checked_signatures);
+
 public:
     CCoinJoinBaseManager() = default;
 
@@ -360,22 +377,35 @@ namespace CoinJoin
 
 class CDSTXManager
 {
-    Mutex cs_mapdstx;
-    std::map<uint256, CCoinJoinBroadcastTx> mapDSTX GUARDED_BY(cs_mapdstx);
+    //! Number of independently locked parts the DSTXes are spread over, relay lookups of different
+    //! transactions rarely wait on each other or on block processing
+    static constexpr size_t SHARD_COUNT{16};
+
+    struct Shard {
+        Mutex cs_mapdstx;
+        std::unordered_map<uint256, CCoinJoinBroadcastTx, StaticSaltedHasher> mapDSTX GUARDED_BY(cs_mapdstx);
+        //! Hashes of the confirmed DSTXes by confirmation height, the oldest expire first
+        std::map<int, std::set<uint256>> mapDSTXByHeight GUARDED_BY(cs_mapdstx);
+    };
+    std::array<Shard, SHARD_COUNT> shards;
 
 public:
     CDSTXManager() = default;
-    void AddDSTX(const CCoinJoinBroadcastTx& dstx) LOCKS_EXCLUDED(cs_mapdstx);
-    CCoinJoinBroadcastTx GetDSTX(const uint256& hash) LOCKS_EXCLUDED(cs_mapdstx);
+    void AddDSTX(const CCoinJoinBroadcastTx& dstx);
+    CCoinJoinBroadcastTx GetDSTX(const uint256& hash);
+    //! Cheaper than GetDSTX() when only the existence matters
+    bool HasDSTX(const uint256& hash);
 
     void UpdatedBlockTip(const CBlockIndex* pindex, const llmq::CChainLocksHandler& clhandler, const CMasternodeSync& mn_sync);
     void NotifyChainLock(const CBlockIndex* pindex, const llmq::CChainLocksHandler& clhandler, const CMasternodeSync& mn_sync);
 
-    void TransactionAddedToMempool(const CTransactionRef& tx) LOCKS_EXCLUDED(cs_mapdstx);
-    void BlockConnected(const std::shared_ptr<const CBlock>& pblock, const CBlockIndex* pindex) LOCKS_EXCLUDED(cs_mapdstx);
-    void BlockDisconnected(const std::shared_ptr<const CBlock>& pblock, const CBlockIndex*) LOCKS_EXCLUDED(cs_mapdstx);
+    void TransactionAddedToMempool(const CTransactionRef& tx);
+    void BlockConnected(const std::shared_ptr<const CBlock>& pblock, const CBlockIndex* pindex);
+    void BlockDisconnected(const std::shared_ptr<const CBlock>& pblock, const CBlockIndex*);
 
 private:
+    Shard& GetShard(const uint256& hash) { return shards[hash.GetUint64(0) % SHARD_COUNT]; }
+
     void CheckDSTXes(const CBlockIndex* pindex, const llmq::CChainLocksHandler& clhandler);
     void UpdateDSTXConfirmedHeight(const CTransactionRef& tx, std::optional<int> nHeight);
 
@@ -13,12 +13,14 @@
 #include <net.h>
 #include <netmessagemaker.h>
 #include <script/interpreter.h>
+#include <script/sigcache.h>
 #include <shutdown.h>
 #include <streams.h>
 #include <txmempool.h>
 #include <util/moneystr.h>
 #include <util/ranges.h>
 #include <util/system.h>
+#include <util/trace.h>
 #include <validation.h>
 #include <version.h>
 
@@ -115,8 +117,8 @@ PeerMsgRet CCoinJoinServer::ProcessDSQUEUE(const CNode& peer, CDataStream& vRecv
         return tl::unexpected{100};
     }
 
+    const auto mnList = deterministicMNManager->GetListAtChainTip();
     if (dsq.masternodeOutpoint.IsNull()) {
-        auto mnList = deterministicMNManager->GetListAtChainTip();
         if (auto dmn = mnList.GetValidMN(dsq.m_protxHash)) {
             dsq.masternodeOutpoint = dmn->collateralOutpoint;
         } else {
@@ -145,7 +147,6 @@ PeerMsgRet CCoinJoinServer::ProcessDSQUEUE(const CNode& peer, CDataStream& vRecv
 
     if (dsq.IsTimeOutOfBounds()) return {};
 
-    auto mnList = deterministicMNManager->GetListAtChainTip();
     auto dmn = mnList.GetValidMNByCollateral(dsq.masternodeOutpoint);
     if (!dmn) return {};
 
@@ -153,7 +154,7 @@ PeerMsgRet CCoinJoinServer::ProcessDSQUEUE(const CNode& peer, CDataStream& vRecv
         dsq.m_protxHash = dmn->proTxHash;
     }
 
-    if (!dsq.CheckSignature(dmn->pdmnState->pubKeyOperator.Get())) {
+    if (!CheckQueueSignature(dsq, dmn->pdmnState->pubKeyOperator.Get())) {
         return tl::unexpected{10};
     }
 
@@ -215,9 +216,18 @@ void CCoinJoinServer::ProcessDSSIGNFINALTX(CDataStream& vRecv)
     int nTxInIndex = 0;
     int nTxInsCount = (int)vecTxIn.size();
 
+    const CTransactionRef txFinal = WITH_LOCK(cs_coinjoin, return m_unsigned_final_tx);
+    if (txFinal == nullptr) {
+        LogPrint(BCLog::COINJOIN, "DSSIGNFINALTX -- no final transaction, session: %d\n", nSessionID);
+        LOCK(cs_coinjoin);
+        RelayStatus(STATUS_REJECTED);
+        return;
+    }
+    PrecomputedTransactionData txdata(*txFinal);
+
     for (const auto& txin : vecTxIn) {
         nTxInIndex++;
-        if (!AddScriptSig(txin)) {
+        if (!AddScriptSig(txin, *txFinal, txdata)) {
             LogPrint(BCLog::COINJOIN, "DSSIGNFINALTX -- AddScriptSig() failed at %d/%d, session: %d\n", nTxInIndex, nTxInsCount, nSessionID);
             LOCK(cs_coinjoin);
             RelayStatus(STATUS_REJECTED);
@@ -234,6 +244,7 @@ void CCoinJoinServer::SetNull()
     AssertLockHeld(cs_coinjoin);
     // MN side
     vecSessionCollaterals.clear();
+    m_unsigned_final_tx.reset();
 
     CCoinJoinBaseSession::SetNull();
     CCoinJoinBaseManager::SetNull();
@@ -284,6 +295,13 @@ void CCoinJoinServer::CreateFinalTransaction()
     CMutableTransaction txNew;
 
     // make our new transaction
+    size_t nInputs{0}, nOutputs{0};
+    for (const auto& entry : vecEntries) {
+        nInputs += entry.vecTxDSIn.size();
+        nOutputs += entry.vecTxOut.size();
+    }
+    txNew.vin.reserve(nInputs);
+    txNew.vout.reserve(nOutputs);
     for (const auto& entry : vecEntries) {
         for (const auto& txout : entry.vecTxOut) {
             txNew.vout.push_back(txout);
@@ -296,12 +314,14 @@ void CCoinJoinServer::CreateFinalTransaction()
     sort(txNew.vin.begin(), txNew.vin.end(), CompareInputBIP69());
     sort(txNew.vout.begin(), txNew.vout.end(), CompareOutputBIP69());
 
-    finalMutableTransaction = txNew;
-    LogPrint(BCLog::COINJOIN, "CCoinJoinServer::CreateFinalTransaction -- finalMutableTransaction=%s", txNew.ToString()); /* Continued */
+    // Signatures are put into finalMutableTransaction, the unsigned copy is sent out and checked against
+    m_unsigned_final_tx = MakeTransactionRef(txNew);
+    finalMutableTransaction = std::move(txNew);
+    LogPrint(BCLog::COINJOIN, "CCoinJoinServer::CreateFinalTransaction -- finalMutableTransaction=%s", m_unsigned_final_tx->ToString()); /* Continued */
 
     // request signatures from clients
     SetState(POOL_STATE_SIGNING);
-    RelayFinalTransaction(CTransaction(finalMutableTransaction));
+    RelayFinalTransaction(*m_unsigned_final_tx);
 }
 
 void CCoinJoinServer::CommitFinalTransaction()
@@ -309,8 +329,9 @@ void CCoinJoinServer::CommitFinalTransaction()
     AssertLockNotHeld(cs_coinjoin);
     if (!fMasternodeMode) return; // check and relay final tx only on masternode
 
-    CTransactionRef finalTransaction = WITH_LOCK(cs_coinjoin, return MakeTransactionRef(finalMutableTransaction));
-    uint256 hashTx = finalTransaction->GetHash();
+    // The session is reset whether the transaction is accepted or not, so the signed inputs can be moved out
+    CTransactionRef finalTransaction = WITH_LOCK(cs_coinjoin, return MakeTransactionRef(std::move(finalMutableTransaction)));
+    const uint256& hashTx = finalTransaction->GetHash();
 
     LogPrint(BCLog::COINJOIN, "CCoinJoinServer::CommitFinalTransaction -- finalTransaction=%s", finalTransaction->ToString()); /* Continued */
 
@@ -318,7 +339,10 @@ void CCoinJoinServer::CommitFinalTransaction()
         // See if the transaction is valid
         TRY_LOCK(cs_main, lockMain);
         mempool.PrioritiseTransaction(hashTx, 0.1 * COIN);
-        if (!lockMain || !ATMPIfSaneFee(m_chainstate, mempool, finalTransaction)) {
+        // Every entry passed IsValidInOuts() which only accepts inputs and outputs of the session denom
+        // in equal numbers, so there is no fee to sanity check like ATMPIfSaneFee() does by running
+        // the whole validation twice. The signatures were put into the signature cache as they came in.
+        if (!lockMain || AcceptToMemoryPool(m_chainstate, mempool, finalTransaction, /* bypass_limits */ false).m_result_type != MempoolAcceptResult::ResultType::VALID) {
             LogPrint(BCLog::COINJOIN, "CCoinJoinServer::CommitFinalTransaction -- AcceptToMemoryPool() error: Transaction not valid\n");
             WITH_LOCK(cs_coinjoin, SetNull());
             // not much we can do in this case, just notify clients
@@ -330,7 +354,7 @@ void CCoinJoinServer::CommitFinalTransaction()
     LogPrint(BCLog::COINJOIN, "CCoinJoinServer::CommitFinalTransaction -- CREATING DSTX\n");
 
     // create and sign masternode dstx transaction
-    if (!::dstxManager->GetDSTX(hashTx)) {
+    if (!::dstxManager->HasDSTX(hashTx)) {
         CCoinJoinBroadcastTx dstxNew(finalTransaction,
                                     WITH_LOCK(activeMasternodeInfoCs, return activeMasternodeInfo.outpoint),
                                     WITH_LOCK(activeMasternodeInfoCs, return activeMasternodeInfo.proTxHash),
@@ -511,45 +535,37 @@ void CCoinJoinServer::CheckForCompleteQueue()
 }
 
 // Check to make sure a given input matches an input in the pool and its scriptSig is valid
-bool CCoinJoinServer::IsInputScriptSigValid(const CTxIn& txin) const
+bool CCoinJoinServer::IsInputScriptSigValid(const CTxIn& txin, const CTransaction& txFinal, PrecomputedTransactionData& txdata) const
 {
     AssertLockHeld(cs_coinjoin);
-    CMutableTransaction txNew;
-    txNew.vin.clear();
-    txNew.vout.clear();
 
-    int nTxInIndex = -1;
     CScript sigPubKey = CScript();
-
-    {
-        int i = 0;
-        for (const auto &entry: vecEntries) {
-            for (const auto &txout: entry.vecTxOut) {
-                txNew.vout.push_back(txout);
-            }
-            for (const auto &txdsin: entry.vecTxDSIn) {
-                txNew.vin.push_back(txdsin);
-
-                if (txdsin.prevout == txin.prevout) {
-                    nTxInIndex = i;
-                    sigPubKey = txdsin.prevPubKey;
-                }
-                i++;
+    bool fFound{false};
+    for (const auto& entry : vecEntries) {
+        for (const auto& txdsin : entry.vecTxDSIn) {
+            if (txdsin.prevout == txin.prevout) {
+                sigPubKey = txdsin.prevPubKey;
+                fFound = true;
             }
         }
     }
-    if (nTxInIndex >= 0) { //might have to do this one input at a time?
-        txNew.vin[nTxInIndex].scriptSig = txin.scriptSig;
-        LogPrint(BCLog::COINJOIN, "CCoinJoinServer::IsInputScriptSigValid -- verifying scriptSig %s\n", ScriptToAsmStr(txin.scriptSig).substr(0, 24));
-        // TODO we're using amount=0 here but we should use the correct amount. This works because Dash ignores the amount while signing/verifying (only used in Bitcoin/Segwit)
-        if (!VerifyScript(txNew.vin[nTxInIndex].scriptSig, sigPubKey, SCRIPT_VERIFY_P2SH | SCRIPT_VERIFY_STRICTENC, MutableTransactionSignatureChecker(&txNew, nTxInIndex, 0))) {
-            LogPrint(BCLog::COINJOIN, "CCoinJoinServer::IsInputScriptSigValid -- VerifyScript() failed on input %d\n", nTxInIndex);
-            return false;
-        }
-    } else {
+
+    const auto it = ranges::find_if(txFinal.vin, [&txin](const auto& txinFinal){ return txinFinal.prevout == txin.prevout; });
+    if (!fFound || it == txFinal.vin.end()) {
         LogPrint(BCLog::COINJOIN, "CCoinJoinServer::IsInputScriptSigValid -- Failed to find matching input in pool, %s\n", txin.ToString());
         return false;
     }
+    const unsigned int nTxInIndex = std::distance(txFinal.vin.begin(), it);
+
+    LogPrint(BCLog::COINJOIN, "CCoinJoinServer::IsInputScriptSigValid -- verifying scriptSig %s\n", ScriptToAsmStr(txin.scriptSig).substr(0, 24));
+    // Signature hashes don't cover the scriptSigs of the inputs, so verifying against the final transaction
+    // as it was sent out for signing is the same as verifying against the fully signed one. Storing the
+    // signatures in the cache lets AcceptToMemoryPool() skip verifying them again in CommitFinalTransaction().
+    // TODO we're using amount=0 here but we should use the correct amount. This works because Dash ignores the amount while signing/verifying (only used in Bitcoin/Segwit)
+    if (!VerifyScript(txin.scriptSig, sigPubKey, SCRIPT_VERIFY_P2SH | SCRIPT_VERIFY_STRICTENC, CachingTransactionSignatureChecker(&txFinal, nTxInIndex, 0, txdata, /* storeIn */ true))) {
+        LogPrint(BCLog::COINJOIN, "CCoinJoinServer::IsInputScriptSigValid -- VerifyScript() failed on input %d\n", nTxInIndex);
+        return false;
+    }
 
     LogPrint(BCLog::COINJOIN, "CCoinJoinServer::IsInputScriptSigValid -- Successfully validated input and scriptSig\n");
     return true;
@@ -583,14 +599,18 @@ bool CCoinJoinServer::AddEntry(const CCoinJoinEntry& entry, PoolMessage& nMessag
     }
 
     std::vector<CTxIn> vin;
-    for (const auto& txin : entry.vecTxDSIn) {
-        LogPrint(BCLog::COINJOIN, "CCoinJoinServer::%s -- txin=%s\n", __func__, txin.ToString());
+    {
+        // Collect the inputs of all entries once instead of walking them again for every new input
         LOCK(cs_coinjoin);
+        std::set<COutPoint> setPrevouts;
         for (const auto& inner_entry : vecEntries) {
-            if (ranges::any_of(inner_entry.vecTxDSIn,
-                            [&txin](const auto& txdsin){
-                                    return txdsin.prevout == txin.prevout;
-                            })) {
+            for (const auto& txdsin : inner_entry.vecTxDSIn) {
+                setPrevouts.insert(txdsin.prevout);
+            }
+        }
+        for (const auto& txin : entry.vecTxDSIn) {
+            LogPrint(BCLog::COINJOIN, "CCoinJoinServer::%s -- txin=%s\n", __func__, txin.ToString());
+            if (!setPrevouts.insert(txin.prevout).second) {
                 LogPrint(BCLog::COINJOIN, "CCoinJoinServer::%s -- ERROR: already have this txin in entries\n", __func__);
                 nMessageIDRet = ERR_ALREADY_HAVE;
                 // Two peers sent the same input? Can't really say who is the malicious one here,
@@ -598,8 +618,8 @@ bool CCoinJoinServer::AddEntry(const CCoinJoinEntry& entry, PoolMessage& nMessag
                 // collateral consumption. Do not punish.
                 return false;
             }
+            vin.emplace_back(txin);
         }
-        vin.emplace_back(txin);
     }
 
     bool fConsumeCollateral{false};
@@ -619,7 +639,7 @@ bool CCoinJoinServer::AddEntry(const CCoinJoinEntry& entry, PoolMessage& nMessag
     return true;
 }
 
-bool CCoinJoinServer::AddScriptSig(const CTxIn& txinNew)
+bool CCoinJoinServer::AddScriptSig(const CTxIn& txinNew, const CTransaction& txFinal, PrecomputedTransactionData& txdata)
 {
     AssertLockNotHeld(cs_coinjoin);
     LogPrint(BCLog::COINJOIN, "CCoinJoinServer::AddScriptSig -- scriptSig=%s\n", ScriptToAsmStr(txinNew.scriptSig).substr(0, 24));
@@ -633,7 +653,7 @@ bool CCoinJoinServer::AddScriptSig(const CTxIn& txinNew)
         }
     }
 
-    if (!IsInputScriptSigValid(txinNew)) {
+    if (!IsInputScriptSigValid(txinNew, txFinal, txdata)) {
         LogPrint(BCLog::COINJOIN, "CCoinJoinServer::AddScriptSig -- Invalid scriptSig\n");
         return false;
     }
@@ -850,6 +870,10 @@ void CCoinJoinServer::RelayCompletedTransaction(PoolMessage nMessageID)
     AssertLockNotHeld(cs_coinjoin);
     LogPrint(BCLog::COINJOIN, "CCoinJoinServer::%s -- nSessionID: %d  nSessionDenom: %d (%s)\n",
         __func__, nSessionID, nSessionDenom, CoinJoin::DenominationToString(nSessionDenom));
+    TRACE3(coinjoin, session_completed,
+        nSessionID.load(),
+        nSessionDenom,
+        nMessageID);
 
     // final mixing tx with empty signatures should be relayed to mixing participants only
     LOCK(cs_coinjoin);
@@ -877,6 +901,11 @@ void CCoinJoinServer::SetState(PoolState nStateNew)
     }
 
     LogPrint(BCLog::COINJOIN, "CCoinJoinServer::SetState -- nState: %d, nStateNew: %d\n", nState, nStateNew);
+    TRACE4(coinjoin, server_state,
+        nSessionID.load(),
+        nSessionDenom,
+        nState.load(),
+        nStateNew);
     nTimeLastSuccessfulStep = GetTime();
     nState = nStateNew;
 }
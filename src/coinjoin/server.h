@@ -14,6 +14,7 @@ class CCoinJoinServer;
 class CDataStream;
 class CNode;
 class CTxMemPool;
+struct PrecomputedTransactionData;
 
 class UniValue;
 
@@ -30,13 +31,15 @@ private:
     // Mixing uses collateral transactions to trust parties entering the pool
     // to behave honestly. If they don't it takes their money.
     std::vector<CTransactionRef> vecSessionCollaterals;
+    // The final transaction as sent out for signing, the signatures are checked against it
+    CTransactionRef m_unsigned_final_tx GUARDED_BY(cs_coinjoin);
 
     bool fUnitTest;
 
     /// Add a clients entry to the pool
     bool AddEntry(const CCoinJoinEntry& entry, PoolMessage& nMessageIDRet) LOCKS_EXCLUDED(cs_coinjoin);
     /// Add signature to a txin
-    bool AddScriptSig(const CTxIn& txin) LOCKS_EXCLUDED(cs_coinjoin);
+    bool AddScriptSig(const CTxIn& txin, const CTransaction& txFinal, PrecomputedTransactionData& txdata) LOCKS_EXCLUDED(cs_coinjoin);
 
     /// Charge fees to bad actors (Charge clients a fee if they're abusive)
     void ChargeFees() const LOCKS_EXCLUDED(cs_coinjoin);
@@ -61,7 +64,7 @@ private:
     /// Check that all inputs are signed. (Are all inputs signed?)
     bool IsSignaturesComplete() const LOCKS_EXCLUDED(cs_coinjoin);
     /// Check to make sure a given input matches an input in the pool and its scriptSig is valid
-    bool IsInputScriptSigValid(const CTxIn& txin) const EXCLUSIVE_LOCKS_REQUIRED(cs_coinjoin);
+    bool IsInputScriptSigValid(const CTxIn& txin, const CTransaction& txFinal, PrecomputedTransactionData& txdata) const EXCLUSIVE_LOCKS_REQUIRED(cs_coinjoin);
 
     // Set the 'state' value, with some logging and capturing when the state changed
     void SetState(PoolState nStateNew);
@@ -61,6 +61,23 @@ uint256 ComputeMerkleRoot(std::vector<uint256> hashes, bool* mutated) {
     return hashes[0];
 }
 
+std::vector<std::vector<uint256>> ComputeMerkleTree(std::vector<uint256> hashes)
+{
+    std::vector<std::vector<uint256>> levels;
+    levels.push_back(std::move(hashes));
+    while (levels.back().size() > 1) {
+        const std::vector<uint256>& level = levels.back();
+        std::vector<uint256> parents((level.size() + 1) / 2);
+        // the pairs are next to each other already, so one call hashes the whole level
+        SHA256D64(parents[0].begin(), level[0].begin(), level.size() / 2);
+        if (level.size() & 1) {
+            parents.back() = Hash(level.back(), level.back());
+        }
+        levels.push_back(std::move(parents));
+    }
+    return levels;
+}
+
 
 uint256 BlockMerkleRoot(const CBlock& block, bool* mutated)
 {
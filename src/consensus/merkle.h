@@ -12,6 +12,13 @@
 
 uint256 ComputeMerkleRoot(std::vector<uint256> hashes, bool* mutated = nullptr);
 
+/*
+ * Compute all levels of the Merkle tree over hashes, from the hashes themselves to the root.
+ * A level with an odd number of nodes is paired with a copy of its last one, like ComputeMerkleRoot
+ * does, but the copy isn't stored.
+ */
+std::vector<std::vector<uint256>> ComputeMerkleTree(std::vector<uint256> hashes);
+
 /*
  * Compute the Merkle root of the transactions in a block.
  * *mutated is set to true if a duplicated subtree was found.
@@ -10,6 +10,9 @@
 #include <primitives/transaction.h>
 #include <consensus/validation.h>
 
+#include <algorithm>
+#include <vector>
+
 bool CheckTransaction(const CTransaction& tx, TxValidationState& state)
 {
     bool allowEmptyTxIn = false;
@@ -50,9 +53,15 @@ bool CheckTransaction(const CTransaction& tx, TxValidationState& state)
     // of a tx as spent, it does not check if the tx has duplicate inputs.
     // Failure to run this check will result in either a crash or an inflation bug, depending on the implementation of
     // the underlying coins database.
-    std::set<COutPoint> vInOutPoints;
-    for (const auto& txin : tx.vin) {
-        if (!vInOutPoints.insert(txin.prevout).second)
+    // A sorted vector instead of a set needs one allocation per transaction instead of one per input.
+    if (tx.vin.size() > 1) {
+        std::vector<COutPoint> vInOutPoints;
+        vInOutPoints.reserve(tx.vin.size());
+        for (const auto& txin : tx.vin) {
+            vInOutPoints.push_back(txin.prevout);
+        }
+        std::sort(vInOutPoints.begin(), vInOutPoints.end());
+        if (std::adjacent_find(vInOutPoints.begin(), vInOutPoints.end()) != vInOutPoints.end())
             return state.Invalid(TxValidationResult::TX_CONSENSUS, "bad-txns-inputs-duplicate");
     }
 
@@ -10,7 +10,9 @@
 #include "crypto-X16R/ethash/lib/ethash/kiss99.hpp"
 #include <crypto-X16R/ethash/include/ethash/keccak.hpp>
 
+#include <algorithm>
 #include <array>
+#include <memory>
 
 namespace progpow
 {
@@ -88,34 +90,69 @@ mix_rng_state::mix_rng_state(uint32_t* hash_seed) noexcept
 }
 
 
+/// The operations of random_math() and random_merge() of the ProgPoW spec, applied to all lanes at once.
+///
+/// The selectors are decoded when the program is generated, so these only switch once per
+/// operation and the loops over the lanes have no branches the compiler can't vectorize.
+enum class math_op : uint8_t
+{
+    add,
+    mul,
+    mul_hi,
+    min,
+    rotl,
+    rotr,
+    bit_and,
+    bit_or,
+    bit_xor,
+    clz,
+    popcount,
+};
+
+enum class merge_op : uint8_t
+{
+    mul_add,
+    xor_mul,
+    rotl_xor,
+    rotr_xor,
+};
+
+using lanes = std::array<uint32_t, num_lanes>;
+
+template <typename Op>
+inline void for_lanes(lanes& out, const lanes& a, const lanes& b, Op op) noexcept
+{
+    for (size_t l = 0; l < num_lanes; ++l)
+        out[l] = op(a[l], b[l]);
+}
+
 NO_SANITIZE("unsigned-integer-overflow")
-inline uint32_t random_math(uint32_t a, uint32_t b, uint32_t selector) noexcept
+inline void random_math(lanes& out, const lanes& a, const lanes& b, math_op op) noexcept
 {
-    switch (selector % 11)
+    switch (op)
     {
-    default:
-    case 0:
-        return a + b;
-    case 1:
-        return a * b;
-    case 2:
-        return mul_hi32(a, b);
-    case 3:
-        return std::min(a, b);
-    case 4:
-        return rotl32(a, b);
-    case 5:
-        return rotr32(a, b);
-    case 6:
-        return a & b;
-    case 7:
-        return a | b;
-    case 8:
-        return a ^ b;
-    case 9:
-        return clz32(a) + clz32(b);
-    case 10:
-        return popcount32(a) + popcount32(b);
+    case math_op::add:
+        return for_lanes(out, a, b, [](uint32_t x, uint32_t y) { return x + y; });
+    case math_op::mul:
+        return for_lanes(out, a, b, [](uint32_t x, uint32_t y) { return x * y; });
+    case math_op::mul_hi:
+        return for_lanes(out, a, b, [](uint32_t x, uint32_t y) { return mul_hi32(x, y); });
+    case math_op::min:
+        return for_lanes(out, a, b, [](uint32_t x, uint32_t y) { return std::min(x, y); });
+    case math_op::rotl:
+        return for_lanes(out, a, b, [](uint32_t x, uint32_t y) { return rotl32(x, y); });
+    case math_op::rotr:
+        return for_lanes(out, a, b, [](uint32_t x, uint32_t y) { return rotr32(x, y); });
+    case math_op::bit_and:
+        return for_lanes(out, a, b, [](uint32_t x, uint32_t y) { return x & y; });
+    case math_op::bit_or:
+        return for_lanes(out, a, b, [](uint32_t x, uint32_t y) { return x | y; });
+    case math_op::bit_xor:
+        return for_lanes(out, a, b, [](uint32_t x, uint32_t y) { return x ^ y; });
+    case math_op::clz:
+        return for_lanes(out, a, b, [](uint32_t x, uint32_t y) { return clz32(x) + clz32(y); });
+    case math_op::popcount:
+        return for_lanes(out, a, b, [](uint32_t x, uint32_t y) { return popcount32(x) + popcount32(y); });
     }
 }
 
@@ -123,26 +160,126 @@ inline uint32_t random_math(uint32_t a, uint32_t b, uint32_t selector) noexcept
 /// Assuming `a` has high entropy, only do ops that retain entropy even if `b`
 /// has low entropy (i.e. do not do `a & b`).
 NO_SANITIZE("unsigned-integer-overflow")
-inline void random_merge(uint32_t& a, uint32_t b, uint32_t selector) noexcept
+inline void random_merge(lanes& a, const lanes& b, merge_op op, uint32_t rot) noexcept
+{
+    switch (op)
+    {
+    case merge_op::mul_add:
+        return for_lanes(a, a, b, [](uint32_t x, uint32_t y) { return (x * 33) + y; });
+    case merge_op::xor_mul:
+        return for_lanes(a, a, b, [](uint32_t x, uint32_t y) { return (x ^ y) * 33; });
+    case merge_op::rotl_xor:
+        return for_lanes(a, a, b, [rot](uint32_t x, uint32_t y) { return rotl32(x, rot) ^ y; });
+    case merge_op::rotr_xor:
+        return for_lanes(a, a, b, [rot](uint32_t x, uint32_t y) { return rotr32(x, rot) ^ y; });
+    }
+}
+
+/// A random merge with its selector decoded.
+struct merge_sel
+{
+    merge_op op;
+    uint8_t rot;
+
+    explicit merge_sel(uint32_t selector = 0) noexcept
+      : op{static_cast<merge_op>(selector % 4)},
+        rot{static_cast<uint8_t>((selector >> 16) % 31 + 1)}  // Additional non-zero selector from higher bits.
+    {}
+};
+
+constexpr int max_operations =
+    num_cache_accesses > num_math_operations ? num_cache_accesses : num_math_operations;
+constexpr size_t num_words_per_lane = sizeof(hash2048) / (sizeof(uint32_t) * num_lanes);
+
+/// The random program of a period.
+///
+/// All rounds start from the same RNG state, which only depends on the period, so they run
+/// the same sequence of operations. It is generated once and the rounds only execute it.
+struct program
 {
-    const auto x = (selector >> 16) % 31 + 1;  // Additional non-zero selector from higher bits.
-    switch (selector % 4)
+    struct cache_access
+    {
+        uint8_t src;
+        uint8_t dst;
+        merge_sel merge;
+    };
+
+    struct math_operation
+    {
+        uint8_t src1;
+        uint8_t src2;
+        uint8_t dst;
+        math_op math;
+        merge_sel merge;
+    };
+
+    std::array<cache_access, num_cache_accesses> cache_accesses;
+    std::array<math_operation, num_math_operations> math_operations;
+    std::array<uint8_t, num_words_per_lane> dag_dsts;
+    std::array<merge_sel, num_words_per_lane> dag_merges;
+
+    explicit program(uint64_t period_number) noexcept;
+};
+
+program::program(uint64_t period_number) noexcept
+{
+    uint32_t seed[2];
+    seed[0] = static_cast<uint32_t>(period_number);
+    seed[1] = static_cast<uint32_t>(period_number >> 32);
+    mix_rng_state state{seed};
+
+    // The random selections are drawn in the order the operations are interleaved in a round.
+    for (int i = 0; i < max_operations; ++i)
+    {
+        if (i < num_cache_accesses)
+        {
+            auto& op = cache_accesses[i];
+            op.src = static_cast<uint8_t>(state.next_src());
+            op.dst = static_cast<uint8_t>(state.next_dst());
+            op.merge = merge_sel{state.rng()};
+        }
+        if (i < num_math_operations)
+        {
+            // Generate 2 unique source indexes.
+            const auto src_rnd = state.rng() % (num_regs * (num_regs - 1));
+            const auto src1 = src_rnd % num_regs;  // O <= src1 < num_regs
+            auto src2 = src_rnd / num_regs;        // 0 <= src2 < num_regs - 1
+            if (src2 >= src1)
+                ++src2;
+
+            auto& op = math_operations[i];
+            op.src1 = static_cast<uint8_t>(src1);
+            op.src2 = static_cast<uint8_t>(src2);
+            op.math = static_cast<math_op>(state.rng() % 11);
+            op.dst = static_cast<uint8_t>(state.next_dst());
+            op.merge = merge_sel{state.rng()};
+        }
+    }
+
+    // DAG access pattern.
+    for (size_t i = 0; i < num_words_per_lane; ++i)
     {
-    case 0:
-        a = (a * 33) + b;
-        break;
-    case 1:
-        a = (a ^ b) * 33;
-        break;
-    case 2:
-        a = rotl32(a, x) ^ b;
-        break;
-    case 3:
-        a = rotr32(a, x) ^ b;
-        break;
+        dag_dsts[i] = static_cast<uint8_t>(i == 0 ? 0 : state.next_dst());
+        dag_merges[i] = merge_sel{state.rng()};
     }
 }
 
+/// The program of the period of block_number, the last one is kept per thread.
+const program& get_program(int block_number) noexcept
+{
+    struct cached_program
+    {
+        uint64_t period_number;
+        program prog;
+    };
+    thread_local std::unique_ptr<cached_program> cache;
+
+    const auto period_number = uint64_t(block_number / period_length);
+    if (!cache || cache->period_number != period_number)
+        cache.reset(new cached_program{period_number, program{period_number}});
+    return cache->prog;
+}
+
 static const uint32_t round_constants[22] = {
         0x00000001,0x00008082,0x0000808A,
         0x80008000,0x0000808B,0x80000001,
@@ -174,73 +311,48 @@ static const uint32_t aipgcoin_kawpow[15] = {
 
 using lookup_fn = hash2048 (*)(const epoch_context&, uint32_t);
 
-using mix_array = std::array<std::array<uint32_t, num_regs>, num_lanes>;
+/// The mix registers, register-major so the lanes of a register are contiguous.
+using mix_array = std::array<lanes, num_regs>;
 
 void round(
-    const epoch_context& context, uint32_t r, mix_array& mix, mix_rng_state state, lookup_fn lookup)
+    const epoch_context& context, uint32_t r, mix_array& mix, const program& prog, lookup_fn lookup)
 {
     const uint32_t num_items = static_cast<uint32_t>(context.full_dataset_num_items / 2);
-    const uint32_t item_index = mix[r % num_lanes][0] % num_items;
+    const uint32_t item_index = mix[0][r % num_lanes] % num_items;
     const hash2048 item = lookup(context, item_index);
 
-    constexpr size_t num_words_per_lane = sizeof(item) / (sizeof(uint32_t) * num_lanes);
-    constexpr int max_operations =
-        num_cache_accesses > num_math_operations ? num_cache_accesses : num_math_operations;
+    lanes data;
 
     // Process lanes.
     for (int i = 0; i < max_operations; ++i)
     {
         if (i < num_cache_accesses)  // Random access to cached memory.
         {
-            const auto src = state.next_src();
-            const auto dst = state.next_dst();
-            const auto sel = state.rng();
-
+            const auto& op = prog.cache_accesses[i];
             for (size_t l = 0; l < num_lanes; ++l)
             {
-                const size_t offset = mix[l][src] % l1_cache_num_items;
-                random_merge(mix[l][dst], le::uint32(context.l1_cache[offset]), sel);
+                const size_t offset = mix[op.src][l] % l1_cache_num_items;
+                data[l] = le::uint32(context.l1_cache[offset]);
             }
+            random_merge(mix[op.dst], data, op.merge.op, op.merge.rot);
         }
         if (i < num_math_operations)  // Random math.
         {
-            // Generate 2 unique source indexes.
-            const auto src_rnd = state.rng() % (num_regs * (num_regs - 1));
-            const auto src1 = src_rnd % num_regs;  // O <= src1 < num_regs
-            auto src2 = src_rnd / num_regs;        // 0 <= src2 < num_regs - 1
-            if (src2 >= src1)
-                ++src2;
-
-            const auto sel1 = state.rng();
-            const auto dst = state.next_dst();
-            const auto sel2 = state.rng();
-
-            for (size_t l = 0; l < num_lanes; ++l)
-            {
-                const uint32_t data = random_math(mix[l][src1], mix[l][src2], sel1);
-                random_merge(mix[l][dst], data, sel2);
-            }
+            const auto& op = prog.math_operations[i];
+            random_math(data, mix[op.src1], mix[op.src2], op.math);
+            random_merge(mix[op.dst], data, op.merge.op, op.merge.rot);
         }
     }
 
-    // DAG access pattern.
-    uint32_t dsts[num_words_per_lane];
-    uint32_t sels[num_words_per_lane];
-    for (size_t i = 0; i < num_words_per_lane; ++i)
-    {
-        dsts[i] = i == 0 ? 0 : state.next_dst();
-        sels[i] = state.rng();
-    }
-
     // DAG access.
-    for (size_t l = 0; l < num_lanes; ++l)
+    for (size_t i = 0; i < num_words_per_lane; ++i)
     {
-        const auto offset = ((l ^ r) % num_lanes) * num_words_per_lane;
-        for (size_t i = 0; i < num_words_per_lane; ++i)
+        for (size_t l = 0; l < num_lanes; ++l)
         {
-            const auto word = le::uint32(item.word32s[offset + i]);
-            random_merge(mix[l][dsts[i]], word, sels[i]);
+            const auto offset = ((l ^ r) % num_lanes) * num_words_per_lane;
+            data[l] = le::uint32(item.word32s[offset + i]);
         }
+        random_merge(mix[prog.dag_dsts[i]], data, prog.dag_merges[i].op, prog.dag_merges[i].rot);
     }
 }
 
@@ -250,14 +362,14 @@ mix_array init_mix(uint32_t* hash_seed)
     const uint32_t w = fnv1a(z, static_cast<uint32_t>(hash_seed[1]));
 
     mix_array mix;
-    for (uint32_t l = 0; l < mix.size(); ++l)
+    for (uint32_t l = 0; l < num_lanes; ++l)
     {
         const uint32_t jsr = fnv1a(w, l);
         const uint32_t jcong = fnv1a(jsr, l);
         kiss99 rng{z, w, jsr, jcong};
 
-        for (auto& row : mix[l])
-            row = rng();
+        for (auto& reg : mix)
+            reg[l] = rng();
     }
     return mix;
 }
@@ -266,14 +378,10 @@ hash256 hash_mix(
     const epoch_context& context, int block_number, uint32_t * seed, lookup_fn lookup) noexcept
 {
     auto mix = init_mix(seed);
-    auto number = uint64_t(block_number / period_length);
-    uint32_t new_state[2];
-    new_state[0] = number;
-    new_state[1] = number >> 32;
-    mix_rng_state state{new_state};
+    const program& prog = get_program(block_number);
 
     for (uint32_t i = 0; i < 64; ++i)
-        round(context, i, mix, state, lookup);
+        round(context, i, mix, prog, lookup);
 
     // Reduce mix data to a single per-lane result.
     uint32_t lane_hash[num_lanes];
@@ -281,7 +389,7 @@ hash256 hash_mix(
     {
         lane_hash[l] = fnv_offset_basis;
         for (uint32_t i = 0; i < num_regs; ++i)
-            lane_hash[l] = fnv1a(lane_hash[l], mix[l][i]);
+            lane_hash[l] = fnv1a(lane_hash[l], mix[i][l]);
     }
 
     // Reduce all lanes to a single 256-bit result.
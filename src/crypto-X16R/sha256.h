@@ -36,4 +36,7 @@ std::string SHA256AutoDetect();
 
 void SHA256D64(unsigned char* output, const unsigned char* input, size_t blocks);
 
+/** Compute multiple single-SHA256's of 64-byte blobs, laid out like for SHA256D64() */
+void SHA256S64(unsigned char* output, const unsigned char* input, size_t blocks);
+
 #endif // AIPG_CRYPTO_SHA256_H
@@ -11,6 +11,8 @@
 #include <algorithm>
 #include <string.h>
 
+#include <compat/cpuid.h>
+
 constexpr static inline uint32_t rotl32(uint32_t v, int c) { return (v << c) | (v >> (32 - c)); }
 
 #define QUARTERROUND(a,b,c,d) \
@@ -21,6 +23,45 @@ constexpr static inline uint32_t rotl32(uint32_t v, int c) { return (v << c) | (
 
 #define REPEAT10(a) do { {a}; {a}; {a}; {a}; {a}; {a}; {a}; {a}; {a}; {a}; } while(0)
 
+#if defined(ENABLE_AVX2) && !defined(BUILD_BITCOIN_INTERNAL)
+namespace chacha20_avx2 {
+void Crypt_8way(const uint32_t input[12], const unsigned char* in, unsigned char* out, size_t groups);
+}
+
+namespace {
+#if defined(USE_ASM) && defined(HAVE_GETCPUID)
+bool ChaCha20AVXEnabled()
+{
+    uint32_t a, d;
+    __asm__("xgetbv" : "=a"(a), "=d"(d) : "c"(0));
+    return (a & 6) == 6;
+}
+#endif
+
+bool DetectChaCha20AVX2()
+{
+#if defined(USE_ASM) && defined(HAVE_GETCPUID)
+    uint32_t eax, ebx, ecx, edx;
+    GetCPUID(1, 0, eax, ebx, ecx, edx);
+    const bool have_xsave = (ecx >> 27) & 1;
+    const bool have_avx = (ecx >> 28) & 1;
+    if (!have_xsave || !have_avx || !ChaCha20AVXEnabled()) return false;
+    GetCPUID(7, 0, eax, ebx, ecx, edx);
+    return (ebx >> 5) & 1;
+#else
+    return false;
+#endif
+}
+
+/** Whether runs of at least 8 blocks are computed by the 8-way AVX2 block function */
+bool HaveChaCha20AVX2()
+{
+    static const bool have_avx2 = DetectChaCha20AVX2();
+    return have_avx2;
+}
+} // namespace
+#endif
+
 void ChaCha20Aligned::SetKey32(const unsigned char* k)
 {
     input[0] = ReadLE32(k + 0);
@@ -66,6 +107,17 @@ inline void ChaCha20Aligned::Keystream64(unsigned char* c, size_t blocks)
 
     if (!blocks) return;
 
+#if defined(ENABLE_AVX2) && !defined(BUILD_BITCOIN_INTERNAL)
+    if (blocks >= 8 && HaveChaCha20AVX2()) {
+        const size_t groups = blocks / 8;
+        chacha20_avx2::Crypt_8way(input, nullptr, c, groups);
+        Seek64(((uint64_t)input[9] << 32 | input[8]) + groups * 8);
+        c += groups * 512;
+        blocks -= groups * 8;
+        if (!blocks) return;
+    }
+#endif
+
     j4 = input[0];
     j5 = input[1];
     j6 = input[2];
@@ -163,6 +215,18 @@ inline void ChaCha20Aligned::Crypt64(const unsigned char* m, unsigned char* c, s
 
     if (!blocks) return;
 
+#if defined(ENABLE_AVX2) && !defined(BUILD_BITCOIN_INTERNAL)
+    if (blocks >= 8 && HaveChaCha20AVX2()) {
+        const size_t groups = blocks / 8;
+        chacha20_avx2::Crypt_8way(input, m, c, groups);
+        Seek64(((uint64_t)input[9] << 32 | input[8]) + groups * 8);
+        m += groups * 512;
+        c += groups * 512;
+        blocks -= groups * 8;
+        if (!blocks) return;
+    }
+#endif
+
     j4 = input[0];
     j5 = input[1];
     j6 = input[2];
@@ -0,0 +1,113 @@
+// Copyright (c) 2026 The Dash Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+// 8-way AVX2 version of the ChaCha20 block function, computing 8 consecutive blocks at once.
+// This must produce exactly what the scalar implementation in chacha20.cpp does.
+
+#ifdef ENABLE_AVX2
+
+#include <stdint.h>
+#include <immintrin.h>
+
+#include <crypto/common.h>
+
+namespace chacha20_avx2 {
+namespace {
+
+__m256i inline Add(__m256i x, __m256i y) { return _mm256_add_epi32(x, y); }
+__m256i inline Xor(__m256i x, __m256i y) { return _mm256_xor_si256(x, y); }
+
+template <int N>
+__m256i inline Rotl(__m256i x) { return _mm256_or_si256(_mm256_slli_epi32(x, N), _mm256_srli_epi32(x, 32 - N)); }
+
+/** Rotations by whole bytes are a single shuffle */
+__m256i inline Rotl16(__m256i x)
+{
+    return _mm256_shuffle_epi8(x, _mm256_set_epi8(13, 12, 15, 14, 9, 8, 11, 10, 5, 4, 7, 6, 1, 0, 3, 2,
+                                                  13, 12, 15, 14, 9, 8, 11, 10, 5, 4, 7, 6, 1, 0, 3, 2));
+}
+
+__m256i inline Rotl8(__m256i x)
+{
+    return _mm256_shuffle_epi8(x, _mm256_set_epi8(14, 13, 12, 15, 10, 9, 8, 11, 6, 5, 4, 7, 2, 1, 0, 3,
+                                                  14, 13, 12, 15, 10, 9, 8, 11, 6, 5, 4, 7, 2, 1, 0, 3));
+}
+
+void inline __attribute__((always_inline)) QuarterRound(__m256i& a, __m256i& b, __m256i& c, __m256i& d)
+{
+    a = Add(a, b); d = Rotl16(Xor(d, a));
+    c = Add(c, d); b = Rotl<12>(Xor(b, c));
+    a = Add(a, b); d = Rotl8(Xor(d, a));
+    c = Add(c, d); b = Rotl<7>(Xor(b, c));
+}
+
+} // namespace
+
+/**
+ * Output the keystream of groups*8 blocks, starting at the block counter in input[8..9], into out. If in is not
+ * null the keystream is xored with it. The counter in input is left to the caller to advance.
+ */
+void Crypt_8way(const uint32_t input[12], const unsigned char* in, unsigned char* out, size_t groups)
+{
+    uint64_t counter = (uint64_t)input[9] << 32 | input[8];
+
+    for (size_t g = 0; g < groups; ++g) {
+        // Each lane computes one block, lane i the block with counter + i
+        alignas(32) uint32_t counter_lo[8], counter_hi[8];
+        for (int i = 0; i < 8; ++i) {
+            counter_lo[i] = (uint32_t)(counter + i);
+            counter_hi[i] = (uint32_t)((counter + i) >> 32);
+        }
+        counter += 8;
+
+        __m256i j[16];
+        j[0] = _mm256_set1_epi32(0x61707865);
+        j[1] = _mm256_set1_epi32(0x3320646e);
+        j[2] = _mm256_set1_epi32(0x79622d32);
+        j[3] = _mm256_set1_epi32(0x6b206574);
+        for (int i = 0; i < 8; ++i) {
+            j[4 + i] = _mm256_set1_epi32(input[i]);
+        }
+        j[12] = _mm256_load_si256((const __m256i*)counter_lo);
+        j[13] = _mm256_load_si256((const __m256i*)counter_hi);
+        j[14] = _mm256_set1_epi32(input[10]);
+        j[15] = _mm256_set1_epi32(input[11]);
+
+        __m256i x[16];
+        for (int i = 0; i < 16; ++i) {
+            x[i] = j[i];
+        }
+
+        for (int round = 0; round < 10; ++round) {
+            QuarterRound(x[0], x[4], x[8], x[12]);
+            QuarterRound(x[1], x[5], x[9], x[13]);
+            QuarterRound(x[2], x[6], x[10], x[14]);
+            QuarterRound(x[3], x[7], x[11], x[15]);
+            QuarterRound(x[0], x[5], x[10], x[15]);
+            QuarterRound(x[1], x[6], x[11], x[12]);
+            QuarterRound(x[2], x[7], x[8], x[13]);
+            QuarterRound(x[3], x[4], x[9], x[14]);
+        }
+
+        alignas(32) uint32_t words[16][8];
+        for (int i = 0; i < 16; ++i) {
+            _mm256_store_si256((__m256i*)words[i], Add(x[i], j[i]));
+        }
+
+        for (int block = 0; block < 8; ++block) {
+            for (int i = 0; i < 16; ++i) {
+                uint32_t word = words[i][block];
+                if (in) word ^= ReadLE32(in + 64 * block + 4 * i);
+                WriteLE32(out + 64 * block + 4 * i, word);
+            }
+        }
+
+        if (in) in += 512;
+        out += 512;
+    }
+}
+
+} // namespace chacha20_avx2
+
+#endif
@@ -70,9 +70,8 @@ void inline Write8(unsigned char* out, int offset, __m256i v) {
     WriteLE32(out + 224 + offset, _mm256_extract_epi32(v, 0));
 }
 
-}
-
-void Transform_8way(unsigned char* out, const unsigned char* in)
+/** Transforms 1 and 2, the single SHA-256 of the eight 64 byte inputs. Leaves the resulting state in w0..w7. */
+void inline __attribute__((always_inline)) Transform64(__m256i& w0, __m256i& w1, __m256i& w2, __m256i& w3, __m256i& w4, __m256i& w5, __m256i& w6, __m256i& w7, const unsigned char* in)
 {
     // Transform 1
     __m256i a = K(0x6a09e667ul);
@@ -84,7 +83,7 @@ void Transform_8way(unsigned char* out, const unsigned char* in)
     __m256i g = K(0x1f83d9abul);
     __m256i h = K(0x5be0cd19ul);
 
-    __m256i w0, w1, w2, w3, w4, w5, w6, w7, w8, w9, w10, w11, w12, w13, w14, w15;
+    __m256i w8, w9, w10, w11, w12, w13, w14, w15;
 
     Round(a, b, c, d, e, f, g, h, Add(K(0x428a2f98ul), w0 = Read8(in, 0)));
     Round(h, a, b, c, d, e, f, g, Add(K(0x71374491ul), w1 = Read8(in, 4)));
@@ -236,16 +235,24 @@ void Transform_8way(unsigned char* out, const unsigned char* in)
     w5 = Add(t5, f);
     w6 = Add(t6, g);
     w7 = Add(t7, h);
+}
+
+}
+
+void Transform_8way(unsigned char* out, const unsigned char* in)
+{
+    __m256i w0, w1, w2, w3, w4, w5, w6, w7, w8, w9, w10, w11, w12, w13, w14, w15;
+    Transform64(w0, w1, w2, w3, w4, w5, w6, w7, in);
 
     // Transform 3
-    a = K(0x6a09e667ul);
-    b = K(0xbb67ae85ul);
-    c = K(0x3c6ef372ul);
-    d = K(0xa54ff53aul);
-    e = K(0x510e527ful);
-    f = K(0x9b05688cul);
-    g = K(0x1f83d9abul);
-    h = K(0x5be0cd19ul);
+    __m256i a = K(0x6a09e667ul);
+    __m256i b = K(0xbb67ae85ul);
+    __m256i c = K(0x3c6ef372ul);
+    __m256i d = K(0xa54ff53aul);
+    __m256i e = K(0x510e527ful);
+    __m256i f = K(0x9b05688cul);
+    __m256i g = K(0x1f83d9abul);
+    __m256i h = K(0x5be0cd19ul);
 
     Round(a, b, c, d, e, f, g, h, Add(K(0x428a2f98ul), w0));
     Round(h, a, b, c, d, e, f, g, Add(K(0x71374491ul), w1));
@@ -323,6 +330,21 @@ void Transform_8way(unsigned char* out, const unsigned char* in)
     Write8(out, 28, Add(h, K(0x5be0cd19ul)));
 }
 
+void TransformSingle_8way(unsigned char* out, const unsigned char* in)
+{
+    __m256i w0, w1, w2, w3, w4, w5, w6, w7;
+    Transform64(w0, w1, w2, w3, w4, w5, w6, w7, in);
+
+    Write8(out, 0, w0);
+    Write8(out, 4, w1);
+    Write8(out, 8, w2);
+    Write8(out, 12, w3);
+    Write8(out, 16, w4);
+    Write8(out, 20, w5);
+    Write8(out, 24, w6);
+    Write8(out, 28, w7);
+}
+
 }
 
 #endif
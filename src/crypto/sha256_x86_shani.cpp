@@ -141,10 +141,12 @@ void Transform(uint32_t* s, const unsigned char* chunk, size_t blocks)
 
 namespace sha256d64_x86_shani {
 
-void Transform_2way(unsigned char* out, const unsigned char* in)
+namespace {
+/** Transforms 1 and 2, the single SHA-256 of the two 64 byte inputs. Leaves the resulting, unshuffled, states in as0/as1 and bs0/bs1. */
+void inline __attribute__((always_inline)) Transform64_2way(__m128i& as0, __m128i& as1, __m128i& bs0, __m128i& bs1, const unsigned char* in)
 {
-    __m128i am0, am1, am2, am3, as0, as1, aso0, aso1;
-    __m128i bm0, bm1, bm2, bm3, bs0, bs1, bso0, bso1;
+    __m128i am0, am1, am2, am3, aso0, aso1;
+    __m128i bm0, bm1, bm2, bm3, bso0, bso1;
 
     /* Transform 1 */
     bs0 = as0 = _mm_load_si128((const __m128i*)INIT0);
@@ -267,6 +269,17 @@ void Transform_2way(unsigned char* out, const unsigned char* in)
     /* Extract hash */
     Unshuffle(as0, as1);
     Unshuffle(bs0, bs1);
+}
+}
+
+void Transform_2way(unsigned char* out, const unsigned char* in)
+{
+    __m128i am0, am1, am2, am3, as0, as1;
+    __m128i bm0, bm1, bm2, bm3, bs0, bs1;
+
+    Transform64_2way(as0, as1, bs0, bs1, in);
+
+    /* Extract hash */
     am0 = as0;
     bm0 = bs0;
     am1 = as1;
@@ -351,6 +364,18 @@ void Transform_2way(unsigned char* out, const unsigned char* in)
     Save(out + 48, bs1);
 }
 
+void TransformSingle_2way(unsigned char* out, const unsigned char* in)
+{
+    __m128i as0, as1, bs0, bs1;
+
+    Transform64_2way(as0, as1, bs0, bs1, in);
+
+    Save(out, as0);
+    Save(out + 16, as1);
+    Save(out + 32, bs0);
+    Save(out + 48, bs1);
+}
+
 }
 
 #endif
@@ -385,8 +385,9 @@ public:
      * @post one of the following: All previously inserted elements and e are
      * now in the table, one previously inserted element is evicted from the
      * table, the entry attempted to be inserted is evicted.
+     * @returns true if an element was evicted
      */
-    inline void insert(Element e)
+    inline bool insert(Element e)
     {
         epoch_check();
         uint32_t last_loc = invalid();
@@ -398,7 +399,7 @@ public:
             if (table[loc] == e) {
                 please_keep(loc);
                 epoch_flags[loc] = last_epoch;
-                return;
+                return false;
             }
         for (uint8_t depth = 0; depth < depth_limit; ++depth) {
             // First try to insert to an empty slot, if one exists
@@ -408,7 +409,7 @@ public:
                 table[loc] = std::move(e);
                 please_keep(loc);
                 epoch_flags[loc] = last_epoch;
-                return;
+                return false;
             }
             /** Swap with the element at the location that was
             * not the last one looked at. Example:
@@ -434,6 +435,7 @@ public:
             // Recompute the locs -- unfortunately happens one too many times!
             locs = compute_hashes(e);
         }
+        return true;
     }
 
     /** contains iterates through the hash locations for a given element
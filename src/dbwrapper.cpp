@@ -6,6 +6,9 @@
 
 #include <memory>
 #include <random.h>
+#include <util/perfcounters.h>
+#include <util/string.h>
+#include <util/time.h>
 
 #include <leveldb/cache.h>
 #include <leveldb/env.h>
@@ -13,7 +16,11 @@
 #include <leveldb/helpers/memenv/memenv.h>
 #include <stdint.h>
 #include <algorithm>
+#include <atomic>
+#include <locale>
+#include <map>
 #include <optional>
+#include <sstream>
 
 class CBitcoinLevelDBLogger : public leveldb::Logger {
 public:
@@ -98,12 +105,164 @@ static void SetMaxOpenFiles(leveldb::Options *options) {
              options->max_open_files, default_open_files);
 }
 
-static leveldb::Options GetOptions(size_t nCacheSize)
+/** Counts the hits and misses of a LevelDB block cache */
+class CountingCache : public leveldb::Cache
+{
+private:
+    const std::unique_ptr<leveldb::Cache> m_cache;
+    perf::Counter& m_hits;
+    perf::Counter& m_misses;
+
+public:
+    CountingCache(leveldb::Cache* cache, perf::Counter& hits, perf::Counter& misses) :
+        m_cache(cache), m_hits(hits), m_misses(misses) {}
+
+    Handle* Insert(const leveldb::Slice& key, void* value, size_t charge,
+                   void (*deleter)(const leveldb::Slice& key, void* value)) override
+    {
+        return m_cache->Insert(key, value, charge, deleter);
+    }
+    Handle* Lookup(const leveldb::Slice& key) override
+    {
+        Handle* handle = m_cache->Lookup(key);
+        (handle ? m_hits : m_misses).Add();
+        return handle;
+    }
+    void Release(Handle* handle) override { m_cache->Release(handle); }
+    void* Value(Handle* handle) override { return m_cache->Value(handle); }
+    void Erase(const leveldb::Slice& key) override { m_cache->Erase(key); }
+    uint64_t NewId() override { return m_cache->NewId(); }
+    void Prune() override { m_cache->Prune(); }
+    size_t TotalCharge() const override { return m_cache->TotalCharge(); }
+};
+
+struct CDBWrapper::Metrics {
+    perf::Counter& cache_hits;
+    perf::Counter& cache_misses;
+    perf::Gauge& size;
+    perf::Gauge& compaction_read;
+    perf::Gauge& compaction_written;
+    perf::Gauge& memory;
+    //! the time after which the statistics are read again
+    std::atomic<int64_t> next_update{0};
+
+    explicit Metrics(const std::string& prefix) :
+        cache_hits(perf::GetCounter(prefix + ".cache_hits", "Reads of table blocks found in the LevelDB block cache")),
+        cache_misses(perf::GetCounter(prefix + ".cache_misses", "Reads of table blocks not found in the LevelDB block cache")),
+        size(perf::GetGauge(prefix + ".size_bytes", "Size of the LevelDB tables")),
+        compaction_read(perf::GetGauge(prefix + ".compaction_read_bytes", "Bytes LevelDB read in compactions since the database was opened")),
+        compaction_written(perf::GetGauge(prefix + ".compaction_write_bytes", "Bytes LevelDB wrote in compactions since the database was opened")),
+        memory(perf::GetGauge(prefix + ".memory_bytes", "Memory used by the LevelDB block cache and write buffers"))
+    {
+    }
+};
+
+namespace {
+
+/** Databases whose access patterns differ from what the default profile is made for */
+const std::map<std::string, DBProfile>& BuiltinDBProfiles()
+{
+    static const std::map<std::string, DBProfile> profiles{
+        // Most lookups are for hashes which aren't there, more bits per key save disk reads for them
+        {"evodb", {16, 4096, 50, 25}},
+        {"llmq/isdb", {16, 4096, 50, 25}},
+        {"llmq/recsigdb", {16, 4096, 50, 25}},
+        // Large snapshots, read as a whole and rarely twice, but looked up for every block on the way back to one
+        {"evodb/snapshots", {16, 64 << 10, 25, 25}},
+        // Only read with range scans, which don't use the bloom filters
+        {"indexes/timestampindex", {0, 16 << 10, 50, 25}},
+    };
+    return profiles;
+}
+
+bool ApplyDBProfileSetting(DBProfile& profile, const std::string& setting, std::string& error)
+{
+    const size_t pos = setting.find('=');
+    const std::optional<int64_t> value = pos == std::string::npos ? std::nullopt : ToIntegral<int64_t>(setting.substr(pos + 1));
+    if (!value) {
+        error = strprintf("invalid setting '%s'", setting);
+        return false;
+    }
+    const std::string key = setting.substr(0, pos);
+    if (key == "bloombits" && *value >= 0 && *value <= 64) {
+        profile.bloom_bits = *value;
+    } else if (key == "blocksize" && *value >= 1024 && *value <= (4 << 20)) {
+        profile.block_size = *value;
+    } else if (key == "blockcache" && *value >= 1 && *value <= 100) {
+        profile.block_cache_percent = *value;
+    } else if (key == "writebuffer" && *value >= 1 && *value <= 100) {
+        profile.write_buffer_percent = *value;
+    } else {
+        error = strprintf("unknown setting or value out of range '%s'", setting);
+        return false;
+    }
+    return true;
+}
+
+bool ParseDBProfileArg(const std::string& arg, std::string& name, std::vector<std::string>& settings, std::string& error)
+{
+    const size_t pos = arg.find(':');
+    if (pos == std::string::npos || pos == 0 || pos + 1 == arg.size()) {
+        error = strprintf("expected <db>:<setting>=<value>[,<setting>=<value>...], got '%s'", arg);
+        return false;
+    }
+    name = arg.substr(0, pos);
+    settings = SplitString(arg.substr(pos + 1), ',');
+    return true;
+}
+
+} // namespace
+
+std::string GetDBProfileName(const fs::path& path)
+{
+    if (path.empty()) return "";
+    const std::string datadir = GetDataDir().generic_string() + "/";
+    std::string name = path.generic_string();
+    if (name.compare(0, datadir.size(), datadir) != 0) return "";
+    name.erase(0, datadir.size());
+    // The indexes with a directory of their own keep their database in a "db" subdirectory of it
+    if (name.size() > 3 && name.compare(name.size() - 3, 3, "/db") == 0) {
+        name.resize(name.size() - 3);
+    }
+    return name;
+}
+
+DBProfile GetDBProfile(const std::string& name)
+{
+    const auto it = BuiltinDBProfiles().find(name);
+    DBProfile profile = it != BuiltinDBProfiles().end() ? it->second : DBProfile{};
+    for (const std::string& arg : gArgs.GetArgs("-dbprofile")) {
+        std::string arg_name, error;
+        std::vector<std::string> settings;
+        // The arguments were checked by CheckDBProfileArg() on startup
+        if (!ParseDBProfileArg(arg, arg_name, settings, error) || arg_name != name) continue;
+        for (const std::string& setting : settings) {
+            ApplyDBProfileSetting(profile, setting, error);
+        }
+    }
+    return profile;
+}
+
+bool CheckDBProfileArg(const std::string& arg, std::string& error)
+{
+    std::string name;
+    std::vector<std::string> settings;
+    if (!ParseDBProfileArg(arg, name, settings, error)) return false;
+    DBProfile profile;
+    for (const std::string& setting : settings) {
+        if (!ApplyDBProfileSetting(profile, setting, error)) return false;
+    }
+    return true;
+}
+
+static leveldb::Options GetOptions(size_t nCacheSize, const DBProfile& profile, perf::Counter* cache_hits, perf::Counter* cache_misses)
 {
     leveldb::Options options;
-    options.block_cache = leveldb::NewLRUCache(nCacheSize / 2);
-    options.write_buffer_size = nCacheSize / 4; // up to two write buffers may be held in memory simultaneously
-    options.filter_policy = leveldb::NewBloomFilterPolicy(10);
+    leveldb::Cache* block_cache = leveldb::NewLRUCache(uint64_t{nCacheSize} * profile.block_cache_percent / 100);
+    options.block_cache = cache_hits ? new CountingCache(block_cache, *cache_hits, *cache_misses) : block_cache;
+    options.write_buffer_size = uint64_t{nCacheSize} * profile.write_buffer_percent / 100; // up to two write buffers may be held in memory simultaneously
+    options.block_size = profile.block_size;
+    options.filter_policy = profile.bloom_bits > 0 ? leveldb::NewBloomFilterPolicy(profile.bloom_bits) : nullptr;
     options.compression = leveldb::kNoCompression;
     options.info_log = new CBitcoinLevelDBLogger();
     if (leveldb::kMajorVersion > 1 || (leveldb::kMajorVersion == 1 && leveldb::kMinorVersion >= 16)) {
@@ -116,14 +275,23 @@ static leveldb::Options GetOptions(size_t nCacheSize)
 }
 
 CDBWrapper::CDBWrapper(const fs::path& path, size_t nCacheSize, bool fMemory, bool fWipe, bool obfuscate)
-    : m_name{path.stem().string()}
+    : m_name{path.stem().string()}, m_profile_name{GetDBProfileName(path)}
 {
     penv = nullptr;
     readoptions.verify_checksums = true;
     iteroptions.verify_checksums = true;
     iteroptions.fill_cache = false;
     syncoptions.sync = true;
-    options = GetOptions(nCacheSize);
+    const DBProfile profile = GetDBProfile(m_profile_name);
+    if (!m_profile_name.empty()) {
+        std::string prefix = "leveldb." + m_profile_name;
+        std::replace(prefix.begin(), prefix.end(), '/', '.');
+        m_metrics = std::make_unique<Metrics>(prefix);
+    }
+    options = GetOptions(nCacheSize, profile, m_metrics ? &m_metrics->cache_hits : nullptr, m_metrics ? &m_metrics->cache_misses : nullptr);
+    LogPrint(BCLog::LEVELDB, "LevelDB profile for %s: bloombits=%d blocksize=%u blockcache=%d%% writebuffer=%d%%\n",
+             m_profile_name.empty() ? m_name : m_profile_name, profile.bloom_bits, profile.block_size,
+             profile.block_cache_percent, profile.write_buffer_percent);
     options.create_if_missing = true;
     if (fMemory) {
         penv = leveldb::NewMemEnv(leveldb::Env::Default());
@@ -165,6 +333,7 @@ CDBWrapper::CDBWrapper(const fs::path& path, size_t nCacheSize, bool fMemory, bo
     }
 
     LogPrintf("Using obfuscation key for %s: %s\n", path.string(), HexStr(obfuscate_key));
+    UpdateMetrics();
 }
 
 CDBWrapper::~CDBWrapper()
@@ -190,6 +359,7 @@ bool CDBWrapper::WriteBatch(CDBBatch& batch, bool fSync)
     }
     leveldb::Status status = pdb->Write(fSync ? syncoptions : writeoptions, &batch.batch);
     dbwrapper_private::HandleError(status);
+    UpdateMetrics();
     if (log_memory) {
         double mem_after = DynamicMemoryUsage() / 1024.0 / 1024;
         LogPrint(BCLog::LEVELDB, "WriteBatch memory usage: db=%s, before=%.1fMiB, after=%.1fMiB\n",
@@ -198,6 +368,39 @@ bool CDBWrapper::WriteBatch(CDBBatch& batch, bool fSync)
     return true;
 }
 
+void CDBWrapper::UpdateMetrics()
+{
+    if (!m_metrics) return;
+    // Building the statistics holds up the writes to the database, don't do it for every batch
+    const int64_t now = GetTime<std::chrono::seconds>().count();
+    int64_t next_update = m_metrics->next_update.load();
+    if (now < next_update || !m_metrics->next_update.compare_exchange_strong(next_update, now + 10)) return;
+
+    std::string stats;
+    if (pdb->GetProperty("leveldb.stats", &stats)) {
+        // One line per level, with the size of the level and the compaction totals in MiB:
+        // Level  Files Size(MB) Time(sec) Read(MB) Write(MB)
+        double size_mib{0}, read_mib{0}, written_mib{0};
+        std::istringstream lines(stats);
+        std::string line;
+        while (std::getline(lines, line)) {
+            std::istringstream fields(line);
+            fields.imbue(std::locale::classic());
+            int level, files;
+            double size, time, read, written;
+            if (fields >> level >> files >> size >> time >> read >> written) {
+                size_mib += size;
+                read_mib += read;
+                written_mib += written;
+            }
+        }
+        m_metrics->size.Set(size_mib * 1048576);
+        m_metrics->compaction_read.Set(read_mib * 1048576);
+        m_metrics->compaction_written.Set(written_mib * 1048576);
+    }
+    m_metrics->memory.Set(DynamicMemoryUsage());
+}
+
 size_t CDBWrapper::DynamicMemoryUsage() const
 {
     std::string memory;
@@ -13,6 +13,7 @@
 #include <util/strencodings.h>
 #include <util/system.h>
 
+#include <memory>
 #include <typeindex>
 
 #include <leveldb/db.h>
@@ -29,6 +30,31 @@ public:
 
 class CDBWrapper;
 
+/** How the LevelDB options of a database are shaped */
+struct DBProfile {
+    //! bits per key of the bloom filters, 0 for none
+    int bloom_bits{10};
+    //! approximate size of the blocks within the tables
+    size_t block_size{4096};
+    //! percentage of the cache size used for the block cache
+    int block_cache_percent{50};
+    //! percentage of the cache size used for the write buffer, up to two of them may be held in memory
+    int write_buffer_percent{25};
+};
+
+/**
+ * The name of the database at path for its profile and metrics, its path relative to the data
+ * directory, e.g. "chainstate", "llmq/isdb" or "indexes/blockfilter/basic". Empty for databases
+ * outside of it.
+ */
+std::string GetDBProfileName(const fs::path& path);
+
+/** The built in profile of a database, with the -dbprofile settings for it applied */
+DBProfile GetDBProfile(const std::string& name);
+
+/** Check the syntax of a -dbprofile=<db>:<setting>=<value>[,<setting>=<value>...] argument */
+bool CheckDBProfileArg(const std::string& arg, std::string& error);
+
 /** These should be considered an implementation detail of the specific database.
  */
 namespace dbwrapper_private {
@@ -222,6 +248,15 @@ private:
     //! the name of this database
     std::string m_name;
 
+    //! the name of the profile and the metrics of this database, see GetDBProfileName()
+    std::string m_profile_name;
+
+    struct Metrics;
+    //! the LevelDB statistics of this database exported as metrics, nullptr for unnamed databases
+    std::unique_ptr<Metrics> m_metrics;
+
+    void UpdateMetrics();
+
     //! a key used for optional XOR-obfuscation of the database
     std::vector<unsigned char> obfuscate_key;
 
@@ -557,18 +592,19 @@ protected:
         size_t memoryUsage;
         explicit ValueHolder(size_t _memoryUsage) : memoryUsage(_memoryUsage) {}
         virtual ~ValueHolder() = default;
-        virtual void Write(const CDataStream& ssKey, CommitTarget &parent) = 0;
+        virtual void Write(CDataStream&& ssKey, CommitTarget &parent) = 0;
     };
     typedef std::unique_ptr<ValueHolder> ValueHolderPtr;
 
     template <typename V>
     struct ValueHolderImpl : ValueHolder {
-        ValueHolderImpl(const V &_value, size_t _memoryUsage) : ValueHolder(_memoryUsage), value(_value) {}
+        template <typename T>
+        ValueHolderImpl(T&& _value, size_t _memoryUsage) : ValueHolder(_memoryUsage), value(std::forward<T>(_value)) {}
 
-        virtual void Write(const CDataStream& ssKey, CommitTarget &commitTarget) override {
-            // we're moving the value instead of copying it. This means that Write() can only be called once per
-            // ValueHolderImpl instance. Commit() clears the write maps, so this ok.
-            commitTarget.Write(ssKey, std::move(value));
+        virtual void Write(CDataStream&& ssKey, CommitTarget &commitTarget) override {
+            // we're moving the key and value instead of copying them. This means that Write() can only be called once
+            // per ValueHolderImpl instance. Commit() takes the entries out of the write maps, so this ok.
+            commitTarget.Write(std::move(ssKey), std::move(value));
         }
         V value;
     };
@@ -591,24 +627,31 @@ public:
     CDBTransaction(Parent &_parent, CommitTarget &_commitTarget) : parent(_parent), commitTarget(_commitTarget) {}
 
     template <typename K, typename V>
-    void Write(const K& key, const V& v) {
-        Write(KeyToDataStream(key), v);
+    void Write(const K& key, V&& v) {
+        Write(KeyToDataStream(key), std::forward<V>(v));
+    }
+
+    template <typename V>
+    void Write(const CDataStream& ssKey, V&& v) {
+        Write(CDataStream{ssKey}, std::forward<V>(v));
     }
 
     template <typename V>
-    void Write(const CDataStream& ssKey, const V& v) {
+    void Write(CDataStream&& ssKey, V&& v) {
         auto valueMemoryUsage = ::GetSerializeSize(v, CLIENT_VERSION);
+        const size_t keySize = ssKey.size();
 
         if (deletes.erase(ssKey)) {
-            memoryUsage -= ssKey.size();
+            memoryUsage -= keySize;
         }
-        auto it = writes.emplace(ssKey, nullptr).first;
-        if (it->second) {
-            memoryUsage -= ssKey.size() + it->second->memoryUsage;
+        // the key is only moved into the map if it isn't in there yet
+        auto [it, inserted] = writes.try_emplace(std::move(ssKey), nullptr);
+        if (!inserted) {
+            memoryUsage -= keySize + it->second->memoryUsage;
         }
-        it->second = std::make_unique<ValueHolderImpl<V>>(v, valueMemoryUsage);
+        it->second = std::make_unique<ValueHolderImpl<std::decay_t<V>>>(std::forward<V>(v), valueMemoryUsage);
 
-        memoryUsage += ssKey.size() + valueMemoryUsage;
+        memoryUsage += keySize + valueMemoryUsage;
     }
 
     template <typename K, typename V>
@@ -678,8 +721,10 @@ public:
         for (const auto &k : deletes) {
             commitTarget.Erase(k);
         }
-        for (auto &p : writes) {
-            p.second->Write(p.first, commitTarget);
+        // hand the keys over to the commit target with the values, instead of copying them
+        while (!writes.empty()) {
+            auto node = writes.extract(writes.begin());
+            node.mapped()->Write(std::move(node.key()), commitTarget);
         }
         Clear();
     }
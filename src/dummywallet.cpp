@@ -66,6 +66,8 @@ void DummyWalletInit::AddWalletOptions(ArgsManager& argsman) const
         "-flushwallet",
         "-privdb",
         "-walletrejectlongchains",
+        "-walletsqlitemmap=<n>",
+        "-walletsqlitewal",
         "-unsafesqlitesync"
     });
 }
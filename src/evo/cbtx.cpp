@@ -17,6 +17,7 @@
 #include <chainparams.h>
 #include <consensus/merkle.h>
 #include <deploymentstatus.h>
+#include <util/perfcounters.h>
 #include <validation.h>
 
 bool CheckCbTx(const CTransaction& tx, const CBlockIndex* pindexPrev, TxValidationState& state)
@@ -81,6 +82,8 @@ bool CheckCbTxMerkleRoots(const CBlock& block, const CBlockIndex* pindex, const
     if (pindex) {
         static int64_t nTimeMerkleMNL = 0;
         static int64_t nTimeMerkleQuorum = 0;
+        static perf::Histogram& perf_merkle_mnl{perf::GetHistogram("evo.cbtx.merklerootmnlist", "Time to check the masternode list merkle root of a coinbase")};
+        static perf::Histogram& perf_merkle_quorum{perf::GetHistogram("evo.cbtx.merklerootquorums", "Time to check the quorum merkle root of a coinbase")};
 
         uint256 calculatedMerkleRoot;
         if (!CalcCbTxMerkleRootMNList(block, pindex->pprev, calculatedMerkleRoot, state, view)) {
@@ -92,6 +95,7 @@ bool CheckCbTxMerkleRoots(const CBlock& block, const CBlockIndex* pindex, const
         }
 
         int64_t nTime3 = GetTimeMicros(); nTimeMerkleMNL += nTime3 - nTime2;
+        perf_merkle_mnl.Observe(nTime3 - nTime2);
         LogPrint(BCLog::BENCHMARK, "          - CalcCbTxMerkleRootMNList: %.2fms [%.2fs]\n", 0.001 * (nTime3 - nTime2), nTimeMerkleMNL * 0.000001);
 
         if (cbTx.nVersion >= CCbTx::Version::MERKLE_ROOT_QUORUMS) {
@@ -105,6 +109,7 @@ bool CheckCbTxMerkleRoots(const CBlock& block, const CBlockIndex* pindex, const
         }
 
         int64_t nTime4 = GetTimeMicros(); nTimeMerkleQuorum += nTime4 - nTime3;
+        perf_merkle_quorum.Observe(nTime4 - nTime3);
         LogPrint(BCLog::BENCHMARK, "          - CalcCbTxMerkleRootQuorums: %.2fms [%.2fs]\n", 0.001 * (nTime4 - nTime3), nTimeMerkleQuorum * 0.000001);
 
     }
@@ -116,7 +121,6 @@ bool CalcCbTxMerkleRootMNList(const CBlock& block, const CBlockIndex* pindexPrev
 {
     try {
         static std::atomic<int64_t> nTimeDMN = 0;
-        static std::atomic<int64_t> nTimeSMNL = 0;
         static std::atomic<int64_t> nTimeMerkle = 0;
 
         int64_t nTime1 = GetTimeMicros();
@@ -130,34 +134,16 @@ bool CalcCbTxMerkleRootMNList(const CBlock& block, const CBlockIndex* pindexPrev
         int64_t nTime2 = GetTimeMicros(); nTimeDMN += nTime2 - nTime1;
         LogPrint(BCLog::BENCHMARK, "            - BuildNewListFromBlock: %.2fms [%.2fs]\n", 0.001 * (nTime2 - nTime1), nTimeDMN * 0.000001);
 
-        CSimplifiedMNList sml(tmpMNList);
-
-        int64_t nTime3 = GetTimeMicros(); nTimeSMNL += nTime3 - nTime2;
-        LogPrint(BCLog::BENCHMARK, "            - CSimplifiedMNList: %.2fms [%.2fs]\n", 0.001 * (nTime3 - nTime2), nTimeSMNL * 0.000001);
-
+        // Only the entries which changed since the last list we were asked about get rehashed
         static Mutex cached_mutex;
-        static CSimplifiedMNList smlCached GUARDED_BY(cached_mutex);
-        static uint256 merkleRootCached GUARDED_BY(cached_mutex);
-        static bool mutatedCached GUARDED_BY(cached_mutex) {false};
+        static CSimplifiedMNListMerkleTree merkleTreeCached GUARDED_BY(cached_mutex);
 
         LOCK(cached_mutex);
-        if (sml == smlCached) {
-            merkleRootRet = merkleRootCached;
-            if (mutatedCached) {
-                return state.Invalid(BlockValidationResult::BLOCK_CONSENSUS, "mutated-cached-calc-cb-mnmerkleroot");
-            }
-            return true;
-        }
-
         bool mutated = false;
-        merkleRootRet = sml.CalcMerkleRoot(&mutated);
+        merkleRootRet = merkleTreeCached.Update(tmpMNList, &mutated);
 
-        int64_t nTime4 = GetTimeMicros(); nTimeMerkle += nTime4 - nTime3;
-        LogPrint(BCLog::BENCHMARK, "            - CalcMerkleRoot: %.2fms [%.2fs]\n", 0.001 * (nTime4 - nTime3), nTimeMerkle * 0.000001);
-
-        smlCached = std::move(sml);
-        merkleRootCached = merkleRootRet;
-        mutatedCached = mutated;
+        int64_t nTime3 = GetTimeMicros(); nTimeMerkle += nTime3 - nTime2;
+        LogPrint(BCLog::BENCHMARK, "            - CalcMerkleRoot: %.2fms [%.2fs]\n", 0.001 * (nTime3 - nTime2), nTimeMerkle * 0.000001);
 
         if (mutated) {
             return state.Invalid(BlockValidationResult::BLOCK_CONSENSUS, "mutated-calc-cb-mnmerkleroot");
@@ -206,17 +192,17 @@ auto CachedGetQcHashesQcIndexedHashes(const CBlockIndex* pindexPrev, const llmq:
         vec_hashes.reserve(vecBlockIndexes.size());
         auto& map_indexed_hashes = qcIndexedHashes_cached[llmqType];
         for (const auto& blockIndex : vecBlockIndexes) {
-            uint256 dummyHash;
-            llmq::CFinalCommitmentPtr pqc = quorum_block_processor.GetMinedCommitment(llmqType, blockIndex->GetBlockHash(), dummyHash);
-            if (pqc == nullptr) {
+            // only the commitments which became active since the last call are read from disk
+            const auto qcHash = quorum_block_processor.GetMinedCommitmentHash(llmqType, blockIndex->GetBlockHash());
+            if (!qcHash.has_value()) {
                 // this should never happen
                 return std::nullopt;
             }
-            auto qcHash = ::SerializeHash(*pqc);
             if (rotation_enabled) {
-                map_indexed_hashes[pqc->quorumIndex] = qcHash;
+                // a rotated quorum's base block is the start of its cycle plus its quorumIndex
+                map_indexed_hashes[int16_t(blockIndex->nHeight % llmq_params_opt->dkgInterval)] = *qcHash;
             } else {
-                vec_hashes.emplace_back(qcHash);
+                vec_hashes.emplace_back(*qcHash);
             }
         }
     }
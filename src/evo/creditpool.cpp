@@ -92,6 +92,9 @@ std::optional<CCreditPool> CCreditPoolManager::GetFromCache(const CBlockIndex& b
         if (creditPoolCache.get(block_hash, pool)) {
             return pool;
         }
+        if (snapshotPool && snapshotPool->first == block_hash) {
+            return snapshotPool->second;
+        }
     }
     if (block_index.nHeight % DISK_SNAPSHOT_PERIOD == 0) {
         if (evoDb.Read(std::make_pair(DB_CREDITPOOL_SNAPSHOT, block_hash), pool)) {
@@ -160,18 +163,10 @@ CCreditPool CCreditPoolManager::ConstructCreditPool(const CBlockIndex* const blo
     if (std::any_of(blockData.indexes.begin(), blockData.indexes.end(), [&](const uint64_t index) { return !indexes.Add(index); })) {
         throw std::runtime_error(strprintf("%s: failed-getcreditpool-index-duplicated", __func__));
     }
+    WITH_LOCK(cache_mutex, unlockedCache.insert(block_index->GetBlockHash(), blockData.unlocked));
 
-    const CBlockIndex* distant_block_index = block_index;
-    for (size_t i = 0; i < CCreditPoolManager::LimitBlocksToTrace; ++i) {
-        distant_block_index = distant_block_index->pprev;
-        if (distant_block_index == nullptr) break;
-    }
-    CAmount distantUnlocked{0};
-    if (distant_block_index) {
-        if (std::optional<CBlock> distant_block = GetBlockForCreditPool(distant_block_index, consensusParams); distant_block) {
-            distantUnlocked = GetDataFromUnlockTxes(distant_block->vtx).unlocked;
-        }
-    }
+    const CBlockIndex* distant_block_index = block_index->GetAncestor(block_index->nHeight - CCreditPoolManager::LimitBlocksToTrace);
+    const CAmount distantUnlocked = distant_block_index ? GetUnlockedAmount(distant_block_index, consensusParams) : 0;
 
     // Unlock limits are # max(100, min(.10 * assetlockpool, 1000)) inside window
     CAmount currentLimit = locked;
@@ -197,6 +192,28 @@ CCreditPool CCreditPoolManager::ConstructCreditPool(const CBlockIndex* const blo
 
 }
 
+CAmount CCreditPoolManager::GetUnlockedAmount(const CBlockIndex* block_index, const Consensus::Params& consensusParams)
+{
+    const uint256 block_hash = block_index->GetBlockHash();
+    CAmount unlocked{0};
+    {
+        LOCK(cache_mutex);
+        if (const auto it = mapSnapshotUnlocked.find(block_hash); it != mapSnapshotUnlocked.end()) {
+            return it->second;
+        }
+        if (unlockedCache.get(block_hash, unlocked)) {
+            return unlocked;
+        }
+    }
+    // don't hold the lock while reading the block
+    if (std::optional<CBlock> block = GetBlockForCreditPool(block_index, consensusParams); block) {
+        unlocked = GetDataFromUnlockTxes(block->vtx).unlocked;
+    }
+    LOCK(cache_mutex);
+    unlockedCache.insert(block_hash, unlocked);
+    return unlocked;
+}
+
 CCreditPool CCreditPoolManager::GetCreditPool(const CBlockIndex* block_index, const Consensus::Params& consensusParams)
 {
     std::stack<const CBlockIndex *> to_calculate;
@@ -214,6 +231,26 @@ CCreditPool CCreditPoolManager::GetCreditPool(const CBlockIndex* block_index, co
     return *poolTmp;
 }
 
+std::vector<std::pair<uint256, CAmount>> CCreditPoolManager::GetUnlockedAmounts(const CBlockIndex* block_index, const Consensus::Params& consensusParams)
+{
+    std::vector<std::pair<uint256, CAmount>> ret;
+    for (size_t i = 0; i < CCreditPoolManager::LimitBlocksToTrace && block_index != nullptr; ++i, block_index = block_index->pprev) {
+        if (!DeploymentActiveAt(*block_index, consensusParams, Consensus::DEPLOYMENT_V20)) break;
+        ret.emplace_back(block_index->GetBlockHash(), GetUnlockedAmount(block_index, consensusParams));
+    }
+    return ret;
+}
+
+void CCreditPoolManager::ImportSnapshot(const CBlockIndex& block_index, const CCreditPool& pool, const std::vector<std::pair<uint256, CAmount>>& unlocked)
+{
+    {
+        LOCK(cache_mutex);
+        snapshotPool = std::make_pair(block_index.GetBlockHash(), pool);
+        mapSnapshotUnlocked.insert(unlocked.begin(), unlocked.end());
+    }
+    AddToCache(block_index.GetBlockHash(), block_index.nHeight, pool);
+}
+
 CCreditPoolManager::CCreditPoolManager(CEvoDB& _evoDb)
 : evoDb(_evoDb)
 {
@@ -17,8 +17,10 @@
 #include <unordered_lru_cache.h>
 #include <util/ranges_set.h>
 
+#include <map>
 #include <optional>
 #include <unordered_set>
+#include <vector>
 
 class CBlockIndex;
 class BlockValidationState;
@@ -106,10 +108,18 @@ private:
     static constexpr size_t CreditPoolCacheSize = 1000;
     RecursiveMutex cache_mutex;
     unordered_lru_cache<uint256, CCreditPool, StaticSaltedHasher> creditPoolCache GUARDED_BY(cache_mutex) {CreditPoolCacheSize};
+    // amounts unlocked by blocks, each is needed again when it drops out of the window LimitBlocksToTrace blocks later
+    unordered_lru_cache<uint256, CAmount, StaticSaltedHasher> unlockedCache GUARDED_BY(cache_mutex) {LimitBlocksToTrace * 2};
 
     CEvoDB& evoDb;
 
-    static constexpr int DISK_SNAPSHOT_PERIOD = 576; // once per day
+    // The pool at the base of a UTXO snapshot and the amounts unlocked in the blocks before it, which aren't on disk
+    std::optional<std::pair<uint256, CCreditPool>> snapshotPool GUARDED_BY(cache_mutex);
+    std::map<uint256, CAmount> mapSnapshotUnlocked GUARDED_BY(cache_mutex);
+
+    // Pools are small, a snapshot every few hours keeps the number of blocks to read after a restart low.
+    // Snapshots written once per day by earlier versions are still found as the period divides 576.
+    static constexpr int DISK_SNAPSHOT_PERIOD = 48;
 
 public:
     static constexpr int LimitBlocksToTrace = 576;
@@ -127,11 +137,20 @@ public:
       */
     CCreditPool GetCreditPool(const CBlockIndex* block, const Consensus::Params& consensusParams);
 
+    /**
+     * The amounts unlocked in the LimitBlocksToTrace blocks up to block, which the limits of the blocks after it depend on.
+     * Together with the pool at block this is what a UTXO snapshot needs to carry.
+     */
+    std::vector<std::pair<uint256, CAmount>> GetUnlockedAmounts(const CBlockIndex* block, const Consensus::Params& consensusParams);
+    /** Make the pool at block and the amounts unlocked before it known, for a node which doesn't have these blocks */
+    void ImportSnapshot(const CBlockIndex& block, const CCreditPool& pool, const std::vector<std::pair<uint256, CAmount>>& unlocked);
+
 private:
     std::optional<CCreditPool> GetFromCache(const CBlockIndex& block_index);
     void AddToCache(const uint256& block_hash, int height, const CCreditPool& pool);
 
     CCreditPool ConstructCreditPool(const CBlockIndex* block_index, CCreditPool prev, const Consensus::Params& consensusParams);
+    CAmount GetUnlockedAmount(const CBlockIndex* block_index, const Consensus::Params& consensusParams);
 };
 
 std::optional<CCreditPoolDiff> GetCreditPoolDiffForBlock(const CBlock& block, const CBlockIndex* pindexPrev, const Consensus::Params& consensusParams,
@@ -13,7 +13,9 @@
 #include <base58.h>
 #include <chainparams.h>
 #include <consensus/validation.h>
+#include <crypto-X16R/sha256.h>
 #include <deploymentstatus.h>
+#include <memusage.h>
 #include <script/standard.h>
 #include <validation.h>
 #include <validationinterface.h>
@@ -24,7 +26,8 @@
 #include <optional>
 #include <memory>
 
-static const std::string DB_LIST_SNAPSHOT = "dmn_S3";
+static const std::string DB_LIST_SNAPSHOT = EVODB_LIST_SNAPSHOT;
+static const std::string DB_LIST_SNAPSHOT_LEGACY = EVODB_LIST_SNAPSHOT_LEGACY;
 static const std::string DB_LIST_DIFF = "dmn_D3";
 
 std::unique_ptr<CDeterministicMNManager> deterministicMNManager;
@@ -117,12 +120,14 @@ CDeterministicMNCPtr CDeterministicMNList::GetValidMN(const uint256& proTxHash)
 
 CDeterministicMNCPtr CDeterministicMNList::GetMNByOperatorKey(const CBLSPublicKey& pubKey) const
 {
-    const auto it = ranges::find_if(mnMap,
-                              [&pubKey](const auto& p){return p.second->pdmnState->pubKeyOperator.Get() == pubKey;});
-    if (it == mnMap.end()) {
+    if (!pubKey.IsValid()) {
         return nullptr;
     }
-    return it->second;
+    auto proTxHash = mnOperatorKeyMap.find(GetOperatorKeyIndexHash(pubKey));
+    if (!proTxHash) {
+        return nullptr;
+    }
+    return GetMN(*proTxHash);
 }
 
 CDeterministicMNCPtr CDeterministicMNList::GetMNByCollateral(const COutPoint& collateralOutpoint) const
@@ -141,7 +146,11 @@ CDeterministicMNCPtr CDeterministicMNList::GetValidMNByCollateral(const COutPoin
 
 CDeterministicMNCPtr CDeterministicMNList::GetMNByService(const CService& service) const
 {
-    return GetUniquePropertyMN(service);
+    auto proTxHash = mnServiceMap.find(service);
+    if (!proTxHash) {
+        return nullptr;
+    }
+    return GetMN(*proTxHash);
 }
 
 CDeterministicMNCPtr CDeterministicMNList::GetMNByInternalId(uint64_t internalId) const
@@ -174,46 +183,41 @@ static bool CompareByLastPaid(const CDeterministicMN& _a, const CDeterministicMN
         return ah < bh;
     }
 }
-static bool CompareByLastPaid(const CDeterministicMN* _a, const CDeterministicMN* _b)
+
+CDeterministicMNCPtr CDeterministicMNList::GetUnfinishedEvoPayee() const
 {
-    return CompareByLastPaid(*_a, *_b);
+    // The payee of this block is paid at nHeight, nothing can sort behind it in the payment order
+    CDeterministicMNCPtr ret{nullptr};
+    for (auto it = mnPaymentOrder.rbegin(); it != mnPaymentOrder.rend() && CompareByLastPaid_GetHeight(**it) >= nHeight; ++it) {
+        const auto& dmn = *it;
+        if (dmn->pdmnState->nLastPaidHeight == nHeight) {
+            // We found the last MN Payee.
+            // If the last payee is an EvoNode, we need to check its consecutive payments and pay him again if needed
+            if (dmn->nType == MnType::Evo && dmn->pdmnState->nConsecutivePayments < dmn_types::Evo.voting_weight) {
+                ret = dmn;
+            }
+        }
+    }
+    return ret;
 }
 
 CDeterministicMNCPtr CDeterministicMNList::GetMNPayee(gsl::not_null<const CBlockIndex*> pindexPrev) const
 {
-    if (mnMap.size() == 0) {
+    if (mnPaymentOrder.empty()) {
         return nullptr;
     }
 
     const bool isv19Active{DeploymentActiveAfter(pindexPrev, Params().GetConsensus(), Consensus::DEPLOYMENT_V19)};
     const bool isMNRewardReallocation{DeploymentActiveAfter(pindexPrev, Params().GetConsensus(), Consensus::DEPLOYMENT_MN_RR)};
     // EvoNodes are rewarded 4 blocks in a row until MNRewardReallocation (Platform release)
-    // For optimization purposes we also check if v19 active to avoid loop over all masternodes
-    CDeterministicMNCPtr best = nullptr;
     if (isv19Active && !isMNRewardReallocation) {
-        ForEachMNShared(true, [&](const CDeterministicMNCPtr& dmn) {
-            if (dmn->pdmnState->nLastPaidHeight == nHeight) {
-                // We found the last MN Payee.
-                // If the last payee is an EvoNode, we need to check its consecutive payments and pay him again if needed
-                if (dmn->nType == MnType::Evo && dmn->pdmnState->nConsecutivePayments < dmn_types::Evo.voting_weight) {
-                    best = dmn;
-                }
-            }
-        });
-
-        if (best != nullptr) return best;
+        if (auto best = GetUnfinishedEvoPayee()) return best;
 
         // Note: If the last payee was a regular MN or if the payee is an EvoNode that was removed from the mnList then that's fine.
         // We can proceed with classic MN payee selection
     }
 
-    ForEachMNShared(true, [&](const CDeterministicMNCPtr& dmn) {
-        if (best == nullptr || CompareByLastPaid(dmn.get(), best.get())) {
-            best = dmn;
-        }
-    });
-
-    return best;
+    return mnPaymentOrder.front();
 }
 
 std::vector<CDeterministicMNCPtr> CDeterministicMNList::GetProjectedMNPayees(gsl::not_null<const CBlockIndex* const> pindexPrev, int nCount) const
@@ -221,51 +225,34 @@ std::vector<CDeterministicMNCPtr> CDeterministicMNList::GetProjectedMNPayees(gsl
     if (nCount < 0 ) {
         return {};
     }
-    const auto weighted_count = GetValidWeightedMNsCount();
-    nCount = std::min(nCount, int(weighted_count));
 
     std::vector<CDeterministicMNCPtr> result;
-    result.reserve(weighted_count);
+    result.reserve(std::min<size_t>(nCount, mnPaymentOrder.size()));
+    const auto add = [&](const CDeterministicMNCPtr& dmn, int count) {
+        for (int i = 0; i < count && int(result.size()) < nCount; ++i) {
+            result.emplace_back(dmn);
+        }
+    };
 
-    int remaining_evo_payments{0};
     CDeterministicMNCPtr evo_to_be_skipped{nullptr};
     const bool isMNRewardReallocation{DeploymentActiveAfter(pindexPrev, Params().GetConsensus(), Consensus::DEPLOYMENT_MN_RR)};
     if (!isMNRewardReallocation) {
-        ForEachMNShared(true, [&](const CDeterministicMNCPtr& dmn) {
-            if (dmn->pdmnState->nLastPaidHeight == nHeight) {
-                // We found the last MN Payee.
-                // If the last payee is an EvoNode, we need to check its consecutive payments and pay him again if needed
-                if (dmn->nType == MnType::Evo && dmn->pdmnState->nConsecutivePayments < dmn_types::Evo.voting_weight) {
-                    remaining_evo_payments = dmn_types::Evo.voting_weight - dmn->pdmnState->nConsecutivePayments;
-                    for ([[maybe_unused]] auto _ : irange::range(remaining_evo_payments)) {
-                        result.emplace_back(dmn);
-                        evo_to_be_skipped = dmn;
-                    }
-                }
-            }
-        });
-    }
-
-    ForEachMNShared(true, [&](const CDeterministicMNCPtr& dmn) {
-        if (dmn == evo_to_be_skipped) return;
-        for ([[maybe_unused]] auto _ : irange::range(GetMnType(dmn->nType).voting_weight)) {
-            result.emplace_back(dmn);
+        evo_to_be_skipped = GetUnfinishedEvoPayee();
+        if (evo_to_be_skipped != nullptr) {
+            add(evo_to_be_skipped, dmn_types::Evo.voting_weight - evo_to_be_skipped->pdmnState->nConsecutivePayments);
         }
-    });
+    }
 
-    if (evo_to_be_skipped != nullptr) {
-        // if EvoNode is in the middle of payments, add entries for already paid ones to the end of the list
-        for ([[maybe_unused]] auto _ : irange::range(evo_to_be_skipped->pdmnState->nConsecutivePayments)) {
-            result.emplace_back(evo_to_be_skipped);
+    for (auto it = mnPaymentOrder.begin(); it != mnPaymentOrder.end() && int(result.size()) < nCount; ++it) {
+        const auto& dmn = *it;
+        if (evo_to_be_skipped != nullptr && dmn->proTxHash == evo_to_be_skipped->proTxHash) {
+            // if EvoNode is in the middle of payments, entries for already paid ones come at its place in the order
+            add(dmn, dmn->pdmnState->nConsecutivePayments);
+        } else {
+            add(dmn, GetMnType(dmn->nType).voting_weight);
         }
     }
 
-    std::sort(result.begin() + remaining_evo_payments, result.end(), [&](const CDeterministicMNCPtr& a, const CDeterministicMNCPtr& b) {
-        return CompareByLastPaid(a.get(), b.get());
-    });
-
-    result.resize(nCount);
-
     return result;
 }
 
@@ -274,13 +261,19 @@ std::vector<CDeterministicMNCPtr> CDeterministicMNList::CalculateQuorum(size_t m
     auto scores = CalculateScores(modifier, onlyEvoNodes);
 
     // sort is descending order
-    std::sort(scores.rbegin(), scores.rend(), [](const std::pair<arith_uint256, CDeterministicMNCPtr>& a, const std::pair<arith_uint256, CDeterministicMNCPtr>& b) {
+    const auto cmp = [](const std::pair<arith_uint256, CDeterministicMNCPtr>& a, const std::pair<arith_uint256, CDeterministicMNCPtr>& b) {
         if (a.first == b.first) {
             // this should actually never happen, but we should stay compatible with how the non-deterministic MNs did the sorting
-            return a.second->collateralOutpoint < b.second->collateralOutpoint;
+            return b.second->collateralOutpoint < a.second->collateralOutpoint;
         }
-        return a.first < b.first;
-    });
+        return b.first < a.first;
+    };
+    // only the top maxSize entries are needed, no need to order the rest
+    if (maxSize < scores.size()) {
+        std::partial_sort(scores.begin(), scores.begin() + maxSize, scores.end(), cmp);
+    } else {
+        std::sort(scores.begin(), scores.end(), cmp);
+    }
 
     // take top maxSize entries and return it
     std::vector<CDeterministicMNCPtr> result;
@@ -293,8 +286,8 @@ std::vector<CDeterministicMNCPtr> CDeterministicMNList::CalculateQuorum(size_t m
 
 std::vector<std::pair<arith_uint256, CDeterministicMNCPtr>> CDeterministicMNList::CalculateScores(const uint256& modifier, const bool onlyEvoNodes) const
 {
-    std::vector<std::pair<arith_uint256, CDeterministicMNCPtr>> scores;
-    scores.reserve(GetAllMNsCount());
+    std::vector<CDeterministicMNCPtr> dmns;
+    dmns.reserve(GetAllMNsCount());
     ForEachMNShared(true, [&](const CDeterministicMNCPtr& dmn) {
         if (dmn->pdmnState->confirmedHash.IsNull()) {
             // we only take confirmed MNs into account to avoid hash grinding on the ProRegTxHash to sneak MNs into a
@@ -305,19 +298,30 @@ std::vector<std::pair<arith_uint256, CDeterministicMNCPtr>> CDeterministicMNList
             if (dmn->nType != MnType::Evo)
                 return;
         }
-        // calculate sha256(sha256(proTxHash, confirmedHash), modifier) per MN
-        // Please note that this is not a double-sha256 but a single-sha256
-        // The first part is already precalculated (confirmedHashWithProRegTxHash)
-        // TODO When https://github.com/bitcoin/bitcoin/pull/13191 gets backported, implement something that is similar but for single-sha256
-        uint256 h;
-        CSHA256 sha256;
-        sha256.Write(dmn->pdmnState->confirmedHashWithProRegTxHash.begin(), dmn->pdmnState->confirmedHashWithProRegTxHash.size());
-        sha256.Write(modifier.begin(), modifier.size());
-        sha256.Finalize(h.begin());
-
-        scores.emplace_back(UintToArith256(h), dmn);
+        dmns.emplace_back(dmn);
     });
+    if (dmns.empty()) {
+        return {};
+    }
+
+    // calculate sha256(sha256(proTxHash, confirmedHash), modifier) per MN
+    // Please note that this is not a double-sha256 but a single-sha256
+    // The first part is already precalculated (confirmedHashWithProRegTxHash)
+    // All inputs are exactly 64 bytes long, so hash them all at once and let SHA256S64 use multiple lanes
+    std::vector<unsigned char> inputs(dmns.size() * 64);
+    for (size_t i = 0; i < dmns.size(); i++) {
+        const uint256& confirmedHashWithProRegTxHash = dmns[i]->pdmnState->confirmedHashWithProRegTxHash;
+        std::copy(confirmedHashWithProRegTxHash.begin(), confirmedHashWithProRegTxHash.end(), inputs.begin() + i * 64);
+        std::copy(modifier.begin(), modifier.end(), inputs.begin() + i * 64 + 32);
+    }
+    std::vector<uint256> hashes(dmns.size());
+    SHA256S64(hashes[0].begin(), inputs.data(), dmns.size());
 
+    std::vector<std::pair<arith_uint256, CDeterministicMNCPtr>> scores;
+    scores.reserve(dmns.size());
+    for (size_t i = 0; i < dmns.size(); i++) {
+        scores.emplace_back(UintToArith256(hashes[i]), std::move(dmns[i]));
+    }
     return scores;
 }
 
@@ -493,6 +497,8 @@ void CDeterministicMNList::AddMN(const CDeterministicMNCPtr& dmn, bool fBumpTota
 
     mnMap = mnMap.set(dmn->proTxHash, dmn);
     mnInternalIdMap = mnInternalIdMap.set(dmn->GetInternalId(), dmn->proTxHash);
+    AddToSecondaryIndexes(*dmn);
+    AddToPaymentOrder(dmn);
     if (fBumpTotalCount) {
         // nTotalRegisteredCount acts more like a checkpoint, not as a limit,
         nTotalRegisteredCount = std::max(dmn->GetInternalId() + 1, (uint64_t)nTotalRegisteredCount);
@@ -531,7 +537,20 @@ void CDeterministicMNList::UpdateMN(const CDeterministicMN& oldDmn, const std::s
         }
     }
 
-    dmn->pdmnState = pdmnState;
+    if (oldState->addr != pdmnState->addr || oldState->pubKeyOperator != pdmnState->pubKeyOperator) {
+        RemoveFromSecondaryIndexes(*dmn);
+        dmn->pdmnState = pdmnState;
+        AddToSecondaryIndexes(*dmn);
+    } else {
+        dmn->pdmnState = pdmnState;
+    }
+    // oldDmn may be owned by mnMap only, so this goes first
+    if (IsMNValid(oldDmn) && IsMNValid(*dmn) && CompareByLastPaid_GetHeight(oldDmn) == CompareByLastPaid_GetHeight(*dmn)) {
+        mnPaymentOrder = std::move(mnPaymentOrder).set(FindInPaymentOrder(oldDmn), dmn);
+    } else {
+        RemoveFromPaymentOrder(oldDmn);
+        AddToPaymentOrder(dmn);
+    }
     mnMap = mnMap.set(oldDmn.proTxHash, dmn);
 }
 
@@ -594,6 +613,207 @@ void CDeterministicMNList::RemoveMN(const uint256& proTxHash)
 
     mnMap = mnMap.erase(proTxHash);
     mnInternalIdMap = mnInternalIdMap.erase(dmn->GetInternalId());
+    RemoveFromSecondaryIndexes(*dmn);
+    RemoveFromPaymentOrder(*dmn);
+}
+
+uint256 CDeterministicMNList::GetOperatorKeyIndexHash(const CBLSPublicKey& pubKey)
+{
+    return ::Hash(pubKey.ToByteVector(false));
+}
+
+void CDeterministicMNList::AddToSecondaryIndexes(const CDeterministicMN& dmn)
+{
+    const auto& pubKey = dmn.pdmnState->pubKeyOperator.Get();
+    if (pubKey.IsValid()) {
+        mnOperatorKeyMap = mnOperatorKeyMap.set(GetOperatorKeyIndexHash(pubKey), dmn.proTxHash);
+    }
+    if (dmn.pdmnState->addr != CService()) {
+        mnServiceMap = mnServiceMap.set(dmn.pdmnState->addr, dmn.proTxHash);
+    }
+}
+
+void CDeterministicMNList::RemoveFromSecondaryIndexes(const CDeterministicMN& dmn)
+{
+    // Only drop entries which still point to this masternode
+    const auto& pubKey = dmn.pdmnState->pubKeyOperator.Get();
+    if (pubKey.IsValid()) {
+        const uint256 hash = GetOperatorKeyIndexHash(pubKey);
+        const auto p = mnOperatorKeyMap.find(hash);
+        if (p && *p == dmn.proTxHash) {
+            mnOperatorKeyMap = mnOperatorKeyMap.erase(hash);
+        }
+    }
+    if (dmn.pdmnState->addr != CService()) {
+        const auto p = mnServiceMap.find(dmn.pdmnState->addr);
+        if (p && *p == dmn.proTxHash) {
+            mnServiceMap = mnServiceMap.erase(dmn.pdmnState->addr);
+        }
+    }
+}
+
+size_t CDeterministicMNList::FindInPaymentOrder(const CDeterministicMN& dmn) const
+{
+    const auto it = std::lower_bound(mnPaymentOrder.begin(), mnPaymentOrder.end(), dmn,
+                                     [](const CDeterministicMNCPtr& a, const CDeterministicMN& b) { return CompareByLastPaid(*a, b); });
+    if (it == mnPaymentOrder.end() || (*it)->proTxHash != dmn.proTxHash) {
+        throw(std::runtime_error(strprintf("%s: Can't find a masternode %s in the payment order", __func__, dmn.proTxHash.ToString())));
+    }
+    return it - mnPaymentOrder.begin();
+}
+
+void CDeterministicMNList::AddToPaymentOrder(const CDeterministicMNCPtr& dmn)
+{
+    if (!IsMNValid(*dmn)) return;
+    const auto it = std::lower_bound(mnPaymentOrder.begin(), mnPaymentOrder.end(), *dmn,
+                                     [](const CDeterministicMNCPtr& a, const CDeterministicMN& b) { return CompareByLastPaid(*a, b); });
+    mnPaymentOrder = std::move(mnPaymentOrder).insert(it - mnPaymentOrder.begin(), dmn);
+}
+
+void CDeterministicMNList::RemoveFromPaymentOrder(const CDeterministicMN& dmn)
+{
+    if (!IsMNValid(dmn)) return;
+    mnPaymentOrder = std::move(mnPaymentOrder).erase(FindInPaymentOrder(dmn));
+}
+
+// Roughly what a masternode costs when no other cached list holds it: the masternode, its state and its entries in
+// the immer maps of a list (collateral, address, owner and operator key are unique properties)
+static size_t MNCacheUsage(const CDeterministicMNCPtr& dmn)
+{
+    return memusage::DynamicUsage(dmn) + memusage::DynamicUsage(dmn->pdmnState) +
+           sizeof(CDeterministicMNList::MnMap::value_type) + sizeof(CDeterministicMNList::MnInternalIdMap::value_type) +
+           4 * sizeof(CDeterministicMNList::MnUniquePropertyMap::value_type) +
+           sizeof(CDeterministicMNList::MnOperatorKeyMap::value_type) + sizeof(CDeterministicMNList::MnServiceMap::value_type) +
+           sizeof(CDeterministicMNList::MnPaymentOrder::value_type) +
+           memusage::MallocUsage(sizeof(memusage::unordered_node<std::pair<const CDeterministicMN* const, size_t>>));
+}
+
+static size_t DiffCacheUsage(const CDeterministicMNListDiff& diff)
+{
+    size_t usage = memusage::DynamicUsage(diff.addedMNs) + memusage::DynamicUsage(diff.updatedMNs) + memusage::DynamicUsage(diff.removedMns);
+    for (const auto& dmn : diff.addedMNs) {
+        usage += memusage::DynamicUsage(dmn) + memusage::DynamicUsage(dmn->pdmnState);
+    }
+    return usage;
+}
+
+template <typename T>
+static size_t CacheEntryUsage()
+{
+    // the map node plus the LRU list node
+    return memusage::MallocUsage(sizeof(memusage::unordered_node<std::pair<const uint256, T>>)) +
+           memusage::MallocUsage(sizeof(uint256) + 2 * sizeof(void*));
+}
+
+const CDeterministicMNList* CDeterministicMNListCache::GetList(const uint256& blockHash)
+{
+    auto it = m_lists.find(blockHash);
+    if (it == m_lists.end()) {
+        return nullptr;
+    }
+    it->second.last_used = ++m_tick;
+    m_lists_lru.splice(m_lists_lru.begin(), m_lists_lru, it->second.lru);
+    return &it->second.value;
+}
+
+const CDeterministicMNListDiff* CDeterministicMNListCache::GetDiff(const uint256& blockHash)
+{
+    auto it = m_diffs.find(blockHash);
+    if (it == m_diffs.end()) {
+        return nullptr;
+    }
+    it->second.last_used = ++m_tick;
+    m_diffs_lru.splice(m_diffs_lru.begin(), m_diffs_lru, it->second.lru);
+    return &it->second.value;
+}
+
+void CDeterministicMNListCache::AddList(const CDeterministicMNList& mnList)
+{
+    if (GetList(mnList.GetBlockHash()) != nullptr) {
+        return;
+    }
+    size_t usage = CacheEntryUsage<Entry<CDeterministicMNList>>();
+    mnList.ForEachMNShared(false, [&](const CDeterministicMNCPtr& dmn) {
+        if (++m_mn_refs[dmn.get()] == 1) {
+            usage += MNCacheUsage(dmn);
+        }
+    });
+    m_lists_lru.emplace_front(mnList.GetBlockHash());
+    m_lists.emplace(mnList.GetBlockHash(), Entry<CDeterministicMNList>{mnList, ++m_tick, m_lists_lru.begin()});
+    m_usage += usage;
+}
+
+void CDeterministicMNListCache::AddDiff(const uint256& blockHash, CDeterministicMNListDiff diff)
+{
+    if (GetDiff(blockHash) != nullptr) {
+        return;
+    }
+    const size_t usage = CacheEntryUsage<Entry<CDeterministicMNListDiff>>() + DiffCacheUsage(diff);
+    m_diffs_lru.emplace_front(blockHash);
+    m_diffs.emplace(blockHash, Entry<CDeterministicMNListDiff>{std::move(diff), ++m_tick, m_diffs_lru.begin()});
+    m_usage += usage;
+}
+
+void CDeterministicMNListCache::Erase(const uint256& blockHash)
+{
+    if (auto it = m_lists.find(blockHash); it != m_lists.end()) {
+        EraseList(it);
+    }
+    if (auto it = m_diffs.find(blockHash); it != m_diffs.end()) {
+        EraseDiff(it);
+    }
+}
+
+CDeterministicMNListCache::ListsMap::iterator CDeterministicMNListCache::EraseList(ListsMap::iterator it)
+{
+    // The list was charged for the masternodes it was the first to hold, which isn't necessarily the set of
+    // masternodes it is the last one to hold now. Release what is actually freed instead.
+    m_usage -= CacheEntryUsage<Entry<CDeterministicMNList>>();
+    it->second.value.ForEachMNShared(false, [&](const CDeterministicMNCPtr& dmn) {
+        auto itRefs = m_mn_refs.find(dmn.get());
+        assert(itRefs != m_mn_refs.end());
+        if (--itRefs->second == 0) {
+            m_mn_refs.erase(itRefs);
+            m_usage -= MNCacheUsage(dmn);
+        }
+    });
+    m_lists_lru.erase(it->second.lru);
+    return m_lists.erase(it);
+}
+
+CDeterministicMNListCache::DiffsMap::iterator CDeterministicMNListCache::EraseDiff(DiffsMap::iterator it)
+{
+    m_usage -= CacheEntryUsage<Entry<CDeterministicMNListDiff>>() + DiffCacheUsage(it->second.value);
+    m_diffs_lru.erase(it->second.lru);
+    return m_diffs.erase(it);
+}
+
+void CDeterministicMNListCache::Trim()
+{
+    // Always keep the most recently used list, it's usually the one for the tip
+    while (m_usage > m_max_usage && (m_lists.size() > 1 || !m_diffs.empty())) {
+        const Entry<CDeterministicMNList>* oldestList = m_lists.size() > 1 ? &m_lists.at(m_lists_lru.back()) : nullptr;
+        const Entry<CDeterministicMNListDiff>* oldestDiff = m_diffs.empty() ? nullptr : &m_diffs.at(m_diffs_lru.back());
+        if (oldestDiff == nullptr || (oldestList != nullptr && oldestList->last_used < oldestDiff->last_used)) {
+            EraseList(m_lists.find(m_lists_lru.back()));
+        } else {
+            EraseDiff(m_diffs.find(m_diffs_lru.back()));
+        }
+        m_evictions++;
+    }
+}
+
+CDeterministicMNListCache::Stats CDeterministicMNListCache::GetStats() const
+{
+    Stats stats;
+    stats.lists = m_lists.size();
+    stats.diffs = m_diffs.size();
+    stats.usage = m_usage;
+    stats.max_usage = m_max_usage;
+    stats.hits = m_hits;
+    stats.misses = m_misses;
+    stats.evictions = m_evictions;
+    return stats;
 }
 
 bool CDeterministicMNManager::ProcessBlock(const CBlock& block, gsl::not_null<const CBlockIndex*> pindex, BlockValidationState& state, const CCoinsViewCache& view, bool fJustCheck, std::optional<MNListUpdates>& updatesRet)
@@ -629,14 +849,28 @@ bool CDeterministicMNManager::ProcessBlock(const CBlock& block, gsl::not_null<co
 
         m_evoDb.Write(std::make_pair(DB_LIST_DIFF, newList.GetBlockHash()), diff);
         if ((nHeight % DISK_SNAPSHOT_PERIOD) == 0 || pindex->pprev == m_initial_snapshot_index) {
-            m_evoDb.Write(std::make_pair(DB_LIST_SNAPSHOT, newList.GetBlockHash()), newList);
-            mnListsCache.emplace(newList.GetBlockHash(), newList);
+            m_evoDb.Write(std::make_pair(DB_LIST_SNAPSHOT, newList.GetBlockHash()), CDeterministicMNListCompact(newList));
+            m_list_cache.AddList(newList);
             LogPrintf("CDeterministicMNManager::%s -- Wrote snapshot. nHeight=%d, mapCurMNs.allMNsCount=%d\n",
                 __func__, nHeight, newList.GetAllMNsCount());
+        } else if ((nHeight % DISK_SNAPSHOT_RECENT_PERIOD) == 0 && !m_chainstate.IsInitialBlockDownload()) {
+            // not worth it while syncing, they would be dropped again long before anybody asks for them
+            m_evoDb.Write(std::make_pair(DB_LIST_SNAPSHOT, newList.GetBlockHash()), CDeterministicMNListCompact(newList));
+        }
+        // Recent snapshots only bound the number of diffs to replay for a while. Dropping one is always safe,
+        // lookups fall back to the previous daily snapshot and the diffs in between.
+        const int nOldRecentHeight = nHeight - DISK_SNAPSHOT_RECENT_BLOCKS;
+        if (nOldRecentHeight > 0 && (nOldRecentHeight % DISK_SNAPSHOT_RECENT_PERIOD) == 0 && (nOldRecentHeight % DISK_SNAPSHOT_PERIOD) != 0) {
+            const CBlockIndex* pindexOld = pindex->GetAncestor(nOldRecentHeight);
+            if (pindexOld->pprev != m_initial_snapshot_index) {
+                m_evoDb.Erase(std::make_pair(DB_LIST_SNAPSHOT, pindexOld->GetBlockHash()));
+                m_evoDb.Erase(std::make_pair(DB_LIST_SNAPSHOT_LEGACY, pindexOld->GetBlockHash()));
+            }
         }
 
         diff.nHeight = pindex->nHeight;
-        mnListDiffsCache.emplace(pindex->GetBlockHash(), diff);
+        m_list_cache.AddDiff(pindex->GetBlockHash(), diff);
+        m_list_cache.Trim();
     } catch (const std::exception& e) {
         LogPrintf("CDeterministicMNManager::%s -- internal error: %s\n", __func__, e.what());
         return state.Invalid(BlockValidationResult::BLOCK_CONSENSUS, "failed-dmn-block");
@@ -677,8 +911,7 @@ bool CDeterministicMNManager::UndoBlock(gsl::not_null<const CBlockIndex*> pindex
             prevList = GetListForBlockInternal(pindex->pprev);
         }
 
-        mnListsCache.erase(blockHash);
-        mnListDiffsCache.erase(blockHash);
+        m_list_cache.Erase(blockHash);
     }
 
     if (diff.HasChanges()) {
@@ -1015,25 +1248,32 @@ CDeterministicMNList CDeterministicMNManager::GetListForBlockInternal(gsl::not_n
 {
     AssertLockHeld(cs);
     CDeterministicMNList snapshot;
-    std::list<const CBlockIndex*> listDiffIndexes;
+    // the cache doesn't evict anything before Trim(), so the diffs can be referenced until then
+    std::list<std::pair<const CBlockIndex*, const CDeterministicMNListDiff*>> listDiffIndexes;
+    bool fFromDisk{false};
 
     while (true) {
         // try using cache before reading from disk
-        auto itLists = mnListsCache.find(pindex->GetBlockHash());
-        if (itLists != mnListsCache.end()) {
-            snapshot = itLists->second;
+        if (const auto* cachedList = m_list_cache.GetList(pindex->GetBlockHash())) {
+            snapshot = *cachedList;
             break;
         }
 
-        if (m_evoDb.Read(std::make_pair(DB_LIST_SNAPSHOT, pindex->GetBlockHash()), snapshot)) {
-            mnListsCache.emplace(pindex->GetBlockHash(), snapshot);
+        if (CDeterministicMNListCompact compactSnapshot; m_evoDb.Read(std::make_pair(DB_LIST_SNAPSHOT, pindex->GetBlockHash()), compactSnapshot)) {
+            snapshot = std::move(compactSnapshot.list);
+            m_list_cache.AddList(snapshot);
+            fFromDisk = true;
+            break;
+        }
+        if (m_evoDb.Read(std::make_pair(DB_LIST_SNAPSHOT_LEGACY, pindex->GetBlockHash()), snapshot)) {
+            m_list_cache.AddList(snapshot);
+            fFromDisk = true;
             break;
         }
 
         // no snapshot found yet, check diffs
-        auto itDiffs = mnListDiffsCache.find(pindex->GetBlockHash());
-        if (itDiffs != mnListDiffsCache.end()) {
-            listDiffIndexes.emplace_front(pindex);
+        if (const auto* cachedDiff = m_list_cache.GetDiff(pindex->GetBlockHash())) {
+            listDiffIndexes.emplace_front(pindex, cachedDiff);
             pindex = pindex->pprev;
             continue;
         }
@@ -1043,32 +1283,41 @@ CDeterministicMNList CDeterministicMNManager::GetListForBlockInternal(gsl::not_n
             // no snapshot and no diff on disk means that it's the initial snapshot
             m_initial_snapshot_index = pindex;
             snapshot = CDeterministicMNList(pindex->GetBlockHash(), pindex->nHeight, 0);
-            mnListsCache.emplace(pindex->GetBlockHash(), snapshot);
+            m_list_cache.AddList(snapshot);
             LogPrintf("CDeterministicMNManager::%s -- initial snapshot. blockHash=%s nHeight=%d\n",
                     __func__, snapshot.GetBlockHash().ToString(), snapshot.GetHeight());
             break;
         }
 
         diff.nHeight = pindex->nHeight;
-        mnListDiffsCache.emplace(pindex->GetBlockHash(), std::move(diff));
-        listDiffIndexes.emplace_front(pindex);
+        m_list_cache.AddDiff(pindex->GetBlockHash(), std::move(diff));
+        listDiffIndexes.emplace_front(pindex, m_list_cache.GetDiff(pindex->GetBlockHash()));
+        fFromDisk = true;
         pindex = pindex->pprev;
     }
+    m_list_cache.CountLookup(!fFromDisk);
 
-    for (const auto& diffIndex : listDiffIndexes) {
-        const auto& diff = mnListDiffsCache.at(diffIndex->GetBlockHash());
+    // Long replays only happen for lists older than the recent snapshots. Remember the lists at the aligned heights
+    // passed on the way, lookups of nearby blocks (e.g. RPCs walking back in history) then replay much less until the
+    // next cache cleanup.
+    const bool fLongReplay = listDiffIndexes.size() > DISK_SNAPSHOT_RECENT_PERIOD;
+    for (const auto& [diffIndex, pdiff] : listDiffIndexes) {
+        const auto& diff = *pdiff;
         if (diff.HasChanges()) {
             snapshot = snapshot.ApplyDiff(diffIndex, diff);
         } else {
             snapshot.SetBlockHash(diffIndex->GetBlockHash());
             snapshot.SetHeight(diffIndex->nHeight);
         }
+        if (fLongReplay && diffIndex != listDiffIndexes.back().first && (diffIndex->nHeight % DISK_SNAPSHOT_RECENT_PERIOD) == 0) {
+            m_list_cache.AddList(snapshot);
+        }
     }
 
     if (tipIndex) {
         // always keep a snapshot for the tip
         if (snapshot.GetBlockHash() == tipIndex->GetBlockHash()) {
-            mnListsCache.emplace(snapshot.GetBlockHash(), snapshot);
+            m_list_cache.AddList(snapshot);
         } else {
             // keep snapshots for yet alive quorums
             if (ranges::any_of(Params().GetConsensus().llmqs, [&snapshot, this](const auto& params){
@@ -1076,15 +1325,71 @@ CDeterministicMNList CDeterministicMNManager::GetListForBlockInternal(gsl::not_n
                 return (snapshot.GetHeight() % params.dkgInterval == 0) &&
                 (snapshot.GetHeight() + params.dkgInterval * (params.keepOldConnections + 1) >= tipIndex->nHeight);
             })) {
-                mnListsCache.emplace(snapshot.GetBlockHash(), snapshot);
+                m_list_cache.AddList(snapshot);
             }
         }
     }
+    m_list_cache.Trim();
 
     assert(snapshot.GetHeight() != -1);
     return snapshot;
 }
 
+void CDeterministicMNManager::GetListsForSnapshot(gsl::not_null<const CBlockIndex*> pindex, int nBlocks, CDeterministicMNList& firstListRet,
+                                                  std::vector<std::pair<uint256, CDeterministicMNListDiff>>& diffsRet)
+{
+    const CBlockIndex* pindexFirst = pindex->GetAncestor(std::max(0, pindex->nHeight - nBlocks));
+
+    LOCK(cs);
+    firstListRet = GetListForBlockInternal(pindexFirst);
+    diffsRet.clear();
+    diffsRet.reserve(pindex->nHeight - pindexFirst->nHeight);
+    CDeterministicMNList prevList = firstListRet;
+    for (int nHeight = pindexFirst->nHeight + 1; nHeight <= pindex->nHeight; ++nHeight) {
+        const CBlockIndex* pindexDiff = pindex->GetAncestor(nHeight);
+        CDeterministicMNList curList = GetListForBlockInternal(pindexDiff);
+        diffsRet.emplace_back(pindexDiff->GetBlockHash(), prevList.BuildDiff(curList));
+        prevList = std::move(curList);
+    }
+}
+
+bool CDeterministicMNManager::ImportListsFromSnapshot(gsl::not_null<const CBlockIndex*> pindex, const CDeterministicMNList& firstList,
+                                                      const std::vector<std::pair<uint256, CDeterministicMNListDiff>>& diffs,
+                                                      CDeterministicMNList& listRet)
+{
+    if ((int)diffs.size() > pindex->nHeight) {
+        return false;
+    }
+    const CBlockIndex* pindexFirst = pindex->GetAncestor(pindex->nHeight - diffs.size());
+    if (firstList.GetBlockHash() != pindexFirst->GetBlockHash() || firstList.GetHeight() != pindexFirst->nHeight) {
+        return false;
+    }
+
+    LOCK(cs);
+    // Same as written by ProcessBlock, a snapshot to start from and the diffs of the blocks after it
+    m_evoDb.Write(std::make_pair(DB_LIST_SNAPSHOT, firstList.GetBlockHash()), CDeterministicMNListCompact(firstList));
+    listRet = firstList;
+    for (size_t i = 0; i < diffs.size(); ++i) {
+        const CBlockIndex* pindexDiff = pindex->GetAncestor(pindexFirst->nHeight + 1 + i);
+        CDeterministicMNListDiff diff = diffs[i].second;
+        if (diffs[i].first != pindexDiff->GetBlockHash()) {
+            return false;
+        }
+        diff.nHeight = pindexDiff->nHeight;
+        if (diff.HasChanges()) {
+            listRet = listRet.ApplyDiff(pindexDiff, diff);
+        } else {
+            listRet.SetBlockHash(pindexDiff->GetBlockHash());
+            listRet.SetHeight(pindexDiff->nHeight);
+        }
+        m_evoDb.Write(std::make_pair(DB_LIST_DIFF, pindexDiff->GetBlockHash()), diff);
+    }
+    // The following blocks start from the last list, keep a snapshot of it
+    m_evoDb.Write(std::make_pair(DB_LIST_SNAPSHOT, pindex->GetBlockHash()), CDeterministicMNListCompact(listRet));
+    m_list_cache.AddList(listRet);
+    return true;
+}
+
 CDeterministicMNList CDeterministicMNManager::GetListAtChainTip()
 {
     LOCK(cs);
@@ -1123,41 +1428,32 @@ void CDeterministicMNManager::CleanupCache(int nHeight)
 {
     AssertLockHeld(cs);
 
-    std::vector<uint256> toDeleteLists;
-    std::vector<uint256> toDeleteDiffs;
-    for (const auto& p : mnListsCache) {
-        if (p.second.GetHeight() + LIST_DIFFS_CACHE_SIZE < nHeight) {
+    m_list_cache.EraseListsIf([&](const CDeterministicMNList& mnList) {
+        AssertLockHeld(cs);
+        if (mnList.GetHeight() + LIST_DIFFS_CACHE_SIZE < nHeight) {
             // too old, drop it
-            toDeleteLists.emplace_back(p.first);
-            continue;
+            return true;
         }
-        if (tipIndex != nullptr && p.first == tipIndex->GetBlockHash()) {
+        if (tipIndex != nullptr && mnList.GetBlockHash() == tipIndex->GetBlockHash()) {
             // it's a snapshot for the tip, keep it
-            continue;
+            return false;
         }
-        bool fQuorumCache = ranges::any_of(Params().GetConsensus().llmqs, [&nHeight, &p](const auto& params){
-            return (p.second.GetHeight() % params.dkgInterval == 0) &&
-                   (p.second.GetHeight() + params.dkgInterval * (params.keepOldConnections + 1) >= nHeight);
+        bool fQuorumCache = ranges::any_of(Params().GetConsensus().llmqs, [&nHeight, &mnList](const auto& params){
+            return (mnList.GetHeight() % params.dkgInterval == 0) &&
+                   (mnList.GetHeight() + params.dkgInterval * (params.keepOldConnections + 1) >= nHeight);
         });
-        if (fQuorumCache) {
-            // at least one quorum could be using it, keep it
-            continue;
-        }
-        // none of the above, drop it
-        toDeleteLists.emplace_back(p.first);
-    }
-    for (const auto& h : toDeleteLists) {
-        mnListsCache.erase(h);
-    }
-    for (const auto& p : mnListDiffsCache) {
-        if (p.second.nHeight + LIST_DIFFS_CACHE_SIZE < nHeight) {
-            toDeleteDiffs.emplace_back(p.first);
-        }
-    }
-    for (const auto& h : toDeleteDiffs) {
-        mnListDiffsCache.erase(h);
-    }
+        // keep it if at least one quorum could be using it, drop it otherwise
+        return !fQuorumCache;
+    });
+    m_list_cache.EraseDiffsIf([&](const CDeterministicMNListDiff& diff) {
+        return diff.nHeight + LIST_DIFFS_CACHE_SIZE < nHeight;
+    });
+}
 
+CDeterministicMNListCache::Stats CDeterministicMNManager::GetCacheStats()
+{
+    LOCK(cs);
+    return m_list_cache.GetStats();
 }
 
 [[nodiscard]] static bool EraseOldDBData(CDBWrapper& db, const std::vector<std::string>& db_key_prefixes)
@@ -1266,13 +1562,15 @@ bool CDeterministicMNManager::MigrateDBIfNeeded()
         }
         CDeterministicMNList mnList;
         mnList.Unserialize(snapshot_data, CDeterministicMN::MN_OLD_FORMAT);
-        batch.Write(std::make_pair(DB_LIST_SNAPSHOT, pindex->GetBlockHash()), mnList);
+        batch.Write(std::make_pair(DB_LIST_SNAPSHOT_LEGACY, pindex->GetBlockHash()), mnList);
         m_evoDb.GetRawDB().WriteBatch(batch);
         batch.Clear();
         LogPrintf("CDeterministicMNManager::%s -- wrote snapshot at height %d\n", __func__, nHeight);
     }
 
     m_evoDb.GetRawDB().WriteBatch(batch);
+    // the snapshots were written to the main store directly
+    m_evoDb.MoveSnapshotsToOwnStore();
 
     // Writing EVODB_BEST_BLOCK (which is b_b4 now) marks the DB as upgraded
     auto dbTx = m_evoDb.BeginTransaction();
@@ -1377,13 +1675,15 @@ bool CDeterministicMNManager::MigrateDBIfNeeded2()
         }
         CDeterministicMNList mnList;
         mnList.Unserialize(snapshot_data, CDeterministicMN::MN_TYPE_FORMAT);
-        batch.Write(std::make_pair(DB_LIST_SNAPSHOT, pindex->GetBlockHash()), mnList);
+        batch.Write(std::make_pair(DB_LIST_SNAPSHOT_LEGACY, pindex->GetBlockHash()), mnList);
         m_evoDb.GetRawDB().WriteBatch(batch);
         batch.Clear();
         LogPrintf("CDeterministicMNManager::%s -- wrote snapshot at height %d\n", __func__, nHeight);
     }
 
     m_evoDb.GetRawDB().WriteBatch(batch);
+    // the snapshots were written to the main store directly
+    m_evoDb.MoveSnapshotsToOwnStore();
 
     // Writing EVODB_BEST_BLOCK (which is b_b4 now) marks the DB as upgraded
     auto dbTx = m_evoDb.BeginTransaction();
@@ -1478,27 +1778,35 @@ static bool CheckPlatformFields(const ProTx& proTx, TxValidationState& state)
 }
 
 template <typename ProTx>
-static bool CheckHashSig(const ProTx& proTx, const PKHash& pkhash, TxValidationState& state)
+static bool CheckHashSig(const ProTx& proTx, const PKHash& pkhash)
 {
-    if (std::string strError; !CHashSigner::VerifyHash(::SerializeHash(proTx), ToKeyID(pkhash), proTx.vchSig, strError)) {
-        return state.Invalid(TxValidationResult::TX_CONSENSUS, "bad-protx-sig");
-    }
-    return true;
+    std::string strError;
+    return CHashSigner::VerifyHash(::SerializeHash(proTx), ToKeyID(pkhash), proTx.vchSig, strError);
 }
 
 template <typename ProTx>
-static bool CheckStringSig(const ProTx& proTx, const PKHash& pkhash, TxValidationState& state)
+static bool CheckStringSig(const ProTx& proTx, const PKHash& pkhash)
 {
-    if (std::string strError; !CMessageSigner::VerifyMessage(ToKeyID(pkhash), proTx.vchSig, proTx.MakeSignString(), strError)) {
-        return state.Invalid(TxValidationResult::TX_CONSENSUS, "bad-protx-sig");
-    }
-    return true;
+    std::string strError;
+    return CMessageSigner::VerifyMessage(ToKeyID(pkhash), proTx.vchSig, proTx.MakeSignString(), strError);
 }
 
 template <typename ProTx>
-static bool CheckHashSig(const ProTx& proTx, const CBLSPublicKey& pubKey, TxValidationState& state)
+static bool CheckHashSig(const ProTx& proTx, const CBLSPublicKey& pubKey)
 {
-    if (!proTx.sig.VerifyInsecure(pubKey, ::SerializeHash(proTx))) {
+    return proTx.sig.VerifyInsecure(pubKey, ::SerializeHash(proTx));
+}
+
+// Runs a payload signature check right away, or leaves it to the caller if it collects sig_checks. The check must own
+// copies of the payload and key, it may well run after the list they came from is gone.
+template <typename Check>
+static bool CheckOrDeferPayloadSig(Check&& check, std::vector<CProTxSigCheck>* sig_checks, TxValidationState& state)
+{
+    if (sig_checks != nullptr) {
+        sig_checks->emplace_back(std::forward<Check>(check));
+        return true;
+    }
+    if (!check()) {
         return state.Invalid(TxValidationResult::TX_CONSENSUS, "bad-protx-sig");
     }
     return true;
@@ -1525,7 +1833,8 @@ static std::optional<ProTx> GetValidatedPayload(const CTransaction& tx, gsl::not
     return opt_ptx;
 }
 
-bool CheckProRegTx(const CTransaction& tx, gsl::not_null<const CBlockIndex*> pindexPrev, TxValidationState& state, const CCoinsViewCache& view, bool check_sigs)
+bool CheckProRegTx(const CTransaction& tx, gsl::not_null<const CBlockIndex*> pindexPrev, TxValidationState& state, const CCoinsViewCache& view, bool check_sigs,
+                   std::vector<CProTxSigCheck>* sig_checks)
 {
     const auto opt_ptx = GetValidatedPayload<CProRegTx>(tx, pindexPrev, state);
     if (!opt_ptx) {
@@ -1625,7 +1934,7 @@ bool CheckProRegTx(const CTransaction& tx, gsl::not_null<const CBlockIndex*> pin
 
     if (keyForPayloadSig) {
         // collateral is not part of this ProRegTx, so we must verify ownership of the collateral
-        if (check_sigs && !CheckStringSig(*opt_ptx, *keyForPayloadSig, state)) {
+        if (check_sigs && !CheckOrDeferPayloadSig([ptx = *opt_ptx, key = *keyForPayloadSig] { return CheckStringSig(ptx, key); }, sig_checks, state)) {
             // pass the state returned by the function above
             return false;
         }
@@ -1639,7 +1948,8 @@ bool CheckProRegTx(const CTransaction& tx, gsl::not_null<const CBlockIndex*> pin
     return true;
 }
 
-bool CheckProUpServTx(const CTransaction& tx, gsl::not_null<const CBlockIndex*> pindexPrev, TxValidationState& state, bool check_sigs)
+bool CheckProUpServTx(const CTransaction& tx, gsl::not_null<const CBlockIndex*> pindexPrev, TxValidationState& state, bool check_sigs,
+                      std::vector<CProTxSigCheck>* sig_checks)
 {
     const auto opt_ptx = GetValidatedPayload<CProUpServTx>(tx, pindexPrev, state);
     if (!opt_ptx) {
@@ -1691,7 +2001,7 @@ bool CheckProUpServTx(const CTransaction& tx, gsl::not_null<const CBlockIndex*>
         // pass the state returned by the function above
         return false;
     }
-    if (check_sigs && !CheckHashSig(*opt_ptx, mn->pdmnState->pubKeyOperator.Get(), state)) {
+    if (check_sigs && !CheckOrDeferPayloadSig([ptx = *opt_ptx, key = mn->pdmnState->pubKeyOperator.Get()] { return CheckHashSig(ptx, key); }, sig_checks, state)) {
         // pass the state returned by the function above
         return false;
     }
@@ -1699,7 +2009,8 @@ bool CheckProUpServTx(const CTransaction& tx, gsl::not_null<const CBlockIndex*>
     return true;
 }
 
-bool CheckProUpRegTx(const CTransaction& tx, gsl::not_null<const CBlockIndex*> pindexPrev, TxValidationState& state, const CCoinsViewCache& view, bool check_sigs)
+bool CheckProUpRegTx(const CTransaction& tx, gsl::not_null<const CBlockIndex*> pindexPrev, TxValidationState& state, const CCoinsViewCache& view, bool check_sigs,
+                     std::vector<CProTxSigCheck>* sig_checks)
 {
     const auto opt_ptx = GetValidatedPayload<CProUpRegTx>(tx, pindexPrev, state);
     if (!opt_ptx) {
@@ -1756,7 +2067,7 @@ bool CheckProUpRegTx(const CTransaction& tx, gsl::not_null<const CBlockIndex*> p
         // pass the state returned by the function above
         return false;
     }
-    if (check_sigs && !CheckHashSig(*opt_ptx, PKHash(dmn->pdmnState->keyIDOwner), state)) {
+    if (check_sigs && !CheckOrDeferPayloadSig([ptx = *opt_ptx, key = PKHash(dmn->pdmnState->keyIDOwner)] { return CheckHashSig(ptx, key); }, sig_checks, state)) {
         // pass the state returned by the function above
         return false;
     }
@@ -1764,7 +2075,8 @@ bool CheckProUpRegTx(const CTransaction& tx, gsl::not_null<const CBlockIndex*> p
     return true;
 }
 
-bool CheckProUpRevTx(const CTransaction& tx, gsl::not_null<const CBlockIndex*> pindexPrev, TxValidationState& state, bool check_sigs)
+bool CheckProUpRevTx(const CTransaction& tx, gsl::not_null<const CBlockIndex*> pindexPrev, TxValidationState& state, bool check_sigs,
+                     std::vector<CProTxSigCheck>* sig_checks)
 {
     const auto opt_ptx = GetValidatedPayload<CProUpRevTx>(tx, pindexPrev, state);
     if (!opt_ptx) {
@@ -1781,7 +2093,7 @@ bool CheckProUpRevTx(const CTransaction& tx, gsl::not_null<const CBlockIndex*> p
         // pass the state returned by the function above
         return false;
     }
-    if (check_sigs && !CheckHashSig(*opt_ptx, dmn->pdmnState->pubKeyOperator.Get(), state)) {
+    if (check_sigs && !CheckOrDeferPayloadSig([ptx = *opt_ptx, key = dmn->pdmnState->pubKeyOperator.Get()] { return CheckHashSig(ptx, key); }, sig_checks, state)) {
         // pass the state returned by the function above
         return false;
     }
@@ -18,13 +18,19 @@
 #include <sync.h>
 #include <gsl/pointers.h>
 
+#include <immer/flex_vector.hpp>
 #include <immer/map.hpp>
+#include <immer/memory_policy.hpp>
 
 #include <atomic>
+#include <functional>
 #include <limits>
+#include <list>
+#include <map>
 #include <numeric>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 class CBlock;
 class CBlockIndex;
@@ -115,6 +121,42 @@ public:
         SerializationOp(s, CSerActionUnserialize(), format_version);
     }
 
+    /** The encoding in the masternode list snapshots of evoDB, see CDeterministicMNList::SerializeCompact() */
+    template <typename Stream>
+    void SerializeCompact(Stream& s, const std::map<CScript, uint32_t>& script_ids) const
+    {
+        s << proTxHash;
+        WriteVarInt<Stream, VarIntMode::DEFAULT, uint64_t>(s, internalId);
+        // The collateral is usually an output of the ProRegTx itself
+        const bool collateral_in_protx = collateralOutpoint.hash == proTxHash;
+        s << collateral_in_protx;
+        if (!collateral_in_protx) s << collateralOutpoint.hash;
+        WriteVarInt<Stream, VarIntMode::DEFAULT, uint32_t>(s, collateralOutpoint.n);
+        WriteVarInt<Stream, VarIntMode::DEFAULT, uint16_t>(s, nOperatorReward);
+        s << nType;
+        pdmnState->SerializeCompact(s, proTxHash, script_ids);
+    }
+
+    template <typename Stream>
+    CDeterministicMN(deserialize_type, Stream& s, const std::vector<CScript>& scripts)
+    {
+        s >> proTxHash;
+        internalId = ReadVarInt<Stream, VarIntMode::DEFAULT, uint64_t>(s);
+        bool collateral_in_protx;
+        s >> collateral_in_protx;
+        if (collateral_in_protx) {
+            collateralOutpoint.hash = proTxHash;
+        } else {
+            s >> collateralOutpoint.hash;
+        }
+        collateralOutpoint.n = ReadVarInt<Stream, VarIntMode::DEFAULT, uint32_t>(s);
+        nOperatorReward = ReadVarInt<Stream, VarIntMode::DEFAULT, uint16_t>(s);
+        s >> nType;
+        auto state = std::make_shared<CDeterministicMNState>();
+        state->UnserializeCompact(s, proTxHash, scripts);
+        pdmnState = std::move(state);
+    }
+
     [[nodiscard]] uint64_t GetInternalId() const;
 
     [[nodiscard]] std::string ToString() const;
@@ -124,18 +166,18 @@ using CDeterministicMNCPtr = std::shared_ptr<const CDeterministicMN>;
 
 class CDeterministicMNListDiff;
 
-template <typename Stream, typename K, typename T, typename Hash, typename Equal>
-void SerializeImmerMap(Stream& os, const immer::map<K, T, Hash, Equal>& m)
+template <typename Stream, typename K, typename T, typename Hash, typename Equal, typename MemoryPolicy, immer::detail::hamts::bits_t B>
+void SerializeImmerMap(Stream& os, const immer::map<K, T, Hash, Equal, MemoryPolicy, B>& m)
 {
     WriteCompactSize(os, m.size());
-    for (typename immer::map<K, T, Hash, Equal>::const_iterator mi = m.begin(); mi != m.end(); ++mi)
+    for (typename immer::map<K, T, Hash, Equal, MemoryPolicy, B>::const_iterator mi = m.begin(); mi != m.end(); ++mi)
         Serialize(os, (*mi));
 }
 
-template <typename Stream, typename K, typename T, typename Hash, typename Equal>
-void UnserializeImmerMap(Stream& is, immer::map<K, T, Hash, Equal>& m)
+template <typename Stream, typename K, typename T, typename Hash, typename Equal, typename MemoryPolicy, immer::detail::hamts::bits_t B>
+void UnserializeImmerMap(Stream& is, immer::map<K, T, Hash, Equal, MemoryPolicy, B>& m)
 {
-    m = immer::map<K, T, Hash, Equal>();
+    m = immer::map<K, T, Hash, Equal, MemoryPolicy, B>();
     unsigned int nSize = ReadCompactSize(is);
     for (unsigned int i = 0; i < nSize; i++) {
         std::pair<K, T> item;
@@ -146,18 +188,27 @@ void UnserializeImmerMap(Stream& is, immer::map<K, T, Hash, Equal>& m)
 
 // For some reason the compiler is not able to choose the correct Serialize/Deserialize methods without a specialized
 // version of SerReadWrite. It otherwise always chooses the version that calls a.Serialize()
-template<typename Stream, typename K, typename T, typename Hash, typename Equal>
-inline void SerReadWrite(Stream& s, const immer::map<K, T, Hash, Equal>& m, CSerActionSerialize ser_action)
+template<typename Stream, typename K, typename T, typename Hash, typename Equal, typename MemoryPolicy, immer::detail::hamts::bits_t B>
+inline void SerReadWrite(Stream& s, const immer::map<K, T, Hash, Equal, MemoryPolicy, B>& m, CSerActionSerialize ser_action)
 {
     ::SerializeImmerMap(s, m);
 }
 
-template<typename Stream, typename K, typename T, typename Hash, typename Equal>
-inline void SerReadWrite(Stream& s, immer::map<K, T, Hash, Equal>& obj, CSerActionUnserialize ser_action)
+template<typename Stream, typename K, typename T, typename Hash, typename Equal, typename MemoryPolicy, immer::detail::hamts::bits_t B>
+inline void SerReadWrite(Stream& s, immer::map<K, T, Hash, Equal, MemoryPolicy, B>& obj, CSerActionUnserialize ser_action)
 {
     ::UnserializeImmerMap(s, obj);
 }
 
+template<>
+struct SaltedHasherImpl<CService>
+{
+    static std::size_t CalcHash(const CService& v, uint64_t k0, uint64_t k1)
+    {
+        const std::vector<unsigned char> key = v.GetKey();
+        return CSipHasher(k0, k1).Write(key.data(), key.size()).Finalize();
+    }
+};
 
 class CDeterministicMNList
 {
@@ -168,9 +219,21 @@ private:
     };
 
 public:
-    using MnMap = immer::map<uint256, CDeterministicMNCPtr, ImmerHasher>;
-    using MnInternalIdMap = immer::map<uint64_t, uint256>;
-    using MnUniquePropertyMap = immer::map<uint256, std::pair<uint256, uint32_t>, ImmerHasher>;
+    // Lists are shared between threads, so the refcounts have to stay atomic. Every block replaces a path of nodes
+    // in each container, the free lists are sized to keep what the lists of many blocks release for reuse instead
+    // of handing it back to the heap.
+    static constexpr std::size_t FREE_LIST_SIZE = 1 << 14;
+    using MemoryPolicy = immer::memory_policy<immer::free_list_heap_policy<immer::cpp_heap, FREE_LIST_SIZE>,
+                                              immer::refcount_policy, immer::spinlock_policy>;
+
+    using MnMap = immer::map<uint256, CDeterministicMNCPtr, ImmerHasher, std::equal_to<uint256>, MemoryPolicy>;
+    using MnInternalIdMap = immer::map<uint64_t, uint256, std::hash<uint64_t>, std::equal_to<uint64_t>, MemoryPolicy>;
+    using MnUniquePropertyMap = immer::map<uint256, std::pair<uint256, uint32_t>, ImmerHasher, std::equal_to<uint256>, MemoryPolicy>;
+    // secondary indexes for lookups which happen on every connection or share, values are proTxHashes
+    using MnOperatorKeyMap = immer::map<uint256, uint256, ImmerHasher, std::equal_to<uint256>, MemoryPolicy>;
+    using MnServiceMap = immer::map<CService, uint256, StaticSaltedHasher, std::equal_to<CService>, MemoryPolicy>;
+    // valid masternodes in the order they get paid in, by last paid (or revived or registered) height and proTxHash
+    using MnPaymentOrder = immer::flex_vector<CDeterministicMNCPtr, MemoryPolicy>;
 
 private:
     uint256 blockHash;
@@ -183,6 +246,11 @@ private:
     // we keep track of this as checking for duplicates would otherwise be painfully slow
     MnUniquePropertyMap mnUniquePropertyMap;
 
+    // not serialized, rebuilt by AddMN/UpdateMN/RemoveMN
+    MnOperatorKeyMap mnOperatorKeyMap;
+    MnServiceMap mnServiceMap;
+    MnPaymentOrder mnPaymentOrder;
+
 public:
     CDeterministicMNList() = default;
     explicit CDeterministicMNList(const uint256& _blockHash, int _height, uint32_t _totalRegisteredCount) :
@@ -217,6 +285,9 @@ public:
         mnMap = MnMap();
         mnUniquePropertyMap = MnUniquePropertyMap();
         mnInternalIdMap = MnInternalIdMap();
+        mnOperatorKeyMap = MnOperatorKeyMap();
+        mnServiceMap = MnServiceMap();
+        mnPaymentOrder = MnPaymentOrder();
 
         SerializationOpBase(s, CSerActionUnserialize());
 
@@ -226,12 +297,57 @@ public:
             if (evodb_migration) {
                 const auto dmn = std::make_shared<CDeterministicMN>(deserialize, s, format_version);
                 mnMap = mnMap.set(dmn->proTxHash, dmn);
+                AddToPaymentOrder(dmn);
             } else {
                 AddMN(std::make_shared<CDeterministicMN>(deserialize, s, format_version), false);
             }
         }
     }
 
+    /**
+     * The encoding of the snapshots in evoDB, written through CDeterministicMNListCompact. Payout
+     * scripts are often shared by many masternodes, they are stored once in a table in front of the
+     * masternodes, which refer to them by index.
+     */
+    template <typename Stream>
+    void SerializeCompact(Stream& s) const
+    {
+        const_cast<CDeterministicMNList*>(this)->SerializationOpBase(s, CSerActionSerialize());
+        std::vector<CScript> scripts;
+        std::map<CScript, uint32_t> script_ids;
+        for (const auto& p : mnMap) {
+            for (const CScript* script : {&p.second->pdmnState->scriptPayout, &p.second->pdmnState->scriptOperatorPayout}) {
+                if (script_ids.emplace(*script, scripts.size()).second) {
+                    scripts.push_back(*script);
+                }
+            }
+        }
+        s << scripts;
+        WriteCompactSize(s, mnMap.size());
+        for (const auto& p : mnMap) {
+            p.second->SerializeCompact(s, script_ids);
+        }
+    }
+
+    template <typename Stream>
+    void UnserializeCompact(Stream& s)
+    {
+        mnMap = MnMap();
+        mnUniquePropertyMap = MnUniquePropertyMap();
+        mnInternalIdMap = MnInternalIdMap();
+        mnOperatorKeyMap = MnOperatorKeyMap();
+        mnServiceMap = MnServiceMap();
+        mnPaymentOrder = MnPaymentOrder();
+
+        SerializationOpBase(s, CSerActionUnserialize());
+        std::vector<CScript> scripts;
+        s >> scripts;
+        size_t cnt = ReadCompactSize(s);
+        for (size_t i = 0; i < cnt; i++) {
+            AddMN(std::make_shared<CDeterministicMN>(deserialize, s, scripts), false);
+        }
+    }
+
     [[nodiscard]] size_t GetAllMNsCount() const
     {
         return mnMap.size();
@@ -345,7 +461,8 @@ public:
     /**
      * Calculates the projected MN payees for the next *count* blocks. The result is not guaranteed to be correct
      * as PoSe banning might occur later
-     * @param nCount the number of payees to return. "nCount = max()"" means "all", use it to avoid calling GetValidWeightedMNsCount twice.
+     * Walks the payment order maintained by AddMN/UpdateMN/RemoveMN, so it costs O(nCount) and nothing for the rest of the list.
+     * @param nCount the number of payees to return. "nCount = max()"" means "all".
      * @return
      */
     [[nodiscard]] std::vector<CDeterministicMNCPtr> GetProjectedMNPayees(gsl::not_null<const CBlockIndex* const> pindexPrev, int nCount = std::numeric_limits<int>::max()) const;
@@ -481,6 +598,16 @@ private:
         return true;
     }
 
+    // Operator keys are indexed by the hash of their basic scheme serialization, so legacy and basic keys match
+    [[nodiscard]] static uint256 GetOperatorKeyIndexHash(const CBLSPublicKey& pubKey);
+    void AddToSecondaryIndexes(const CDeterministicMN& dmn);
+    void RemoveFromSecondaryIndexes(const CDeterministicMN& dmn);
+    [[nodiscard]] size_t FindInPaymentOrder(const CDeterministicMN& dmn) const;
+    void AddToPaymentOrder(const CDeterministicMNCPtr& dmn);
+    void RemoveFromPaymentOrder(const CDeterministicMN& dmn);
+    /** The EvoNode which was paid for this block and gets paid again for the next one */
+    [[nodiscard]] CDeterministicMNCPtr GetUnfinishedEvoPayee() const;
+
     friend bool operator==(const CDeterministicMNList& a, const CDeterministicMNList& b)
     {
         return  a.blockHash == b.blockHash &&
@@ -492,6 +619,31 @@ private:
     }
 };
 
+/**
+ * A masternode list in the encoding of the snapshots in evoDB. It holds a copy of the list, evoDB
+ * transactions keep the values written to them until they are committed.
+ */
+class CDeterministicMNListCompact
+{
+public:
+    CDeterministicMNList list;
+
+    CDeterministicMNListCompact() = default;
+    explicit CDeterministicMNListCompact(const CDeterministicMNList& _list) : list(_list) {}
+
+    template <typename Stream>
+    void Serialize(Stream& s) const
+    {
+        list.SerializeCompact(s);
+    }
+
+    template <typename Stream>
+    void Unserialize(Stream& s)
+    {
+        list.UnserializeCompact(s);
+    }
+};
+
 class CDeterministicMNListDiff
 {
 public:
@@ -572,12 +724,104 @@ struct MNListUpdates
     CDeterministicMNListDiff diff;
 };
 
+//! Default for -maxmnlistcache, in MiB
+static constexpr int64_t DEFAULT_MAX_MNLIST_CACHE_SIZE = 64;
+
+/**
+ * Memory bounded LRU cache for masternode lists and list diffs.
+ *
+ * Lists built from each other share nearly all of their masternodes and the immer nodes holding them, so a list is
+ * only charged for the masternodes no other cached list holds. Keeping many nearby lists stays cheap, while clients
+ * walking through old lists can't grow the cache past its limit.
+ *
+ * Nothing is evicted before Trim(), pointers returned by GetList() and GetDiff() stay valid until then.
+ */
+class CDeterministicMNListCache
+{
+public:
+    struct Stats {
+        size_t lists{0};
+        size_t diffs{0};
+        size_t usage{0};
+        size_t max_usage{0};
+        uint64_t hits{0};
+        uint64_t misses{0};
+        uint64_t evictions{0};
+    };
+
+    explicit CDeterministicMNListCache(size_t max_usage) : m_max_usage(max_usage) {}
+
+    const CDeterministicMNList* GetList(const uint256& blockHash);
+    const CDeterministicMNListDiff* GetDiff(const uint256& blockHash);
+    void AddList(const CDeterministicMNList& mnList);
+    void AddDiff(const uint256& blockHash, CDeterministicMNListDiff diff);
+    void Erase(const uint256& blockHash);
+
+    //! Drop all lists the predicate holds for, this is pruning and not counted as eviction
+    template <typename Pred>
+    void EraseListsIf(Pred&& pred)
+    {
+        for (auto it = m_lists.begin(); it != m_lists.end(); ) {
+            it = pred(it->second.value) ? EraseList(it) : std::next(it);
+        }
+    }
+    //! Same as EraseListsIf() for diffs
+    template <typename Pred>
+    void EraseDiffsIf(Pred&& pred)
+    {
+        for (auto it = m_diffs.begin(); it != m_diffs.end(); ) {
+            it = pred(it->second.value) ? EraseDiff(it) : std::next(it);
+        }
+    }
+
+    //! Evict the least recently used lists and diffs until the cache fits into its limit again
+    void Trim();
+
+    //! A lookup was answered from memory only (hit) or had to read from disk (miss)
+    void CountLookup(bool hit) { hit ? m_hits++ : m_misses++; }
+
+    size_t DynamicMemoryUsage() const { return m_usage; }
+    Stats GetStats() const;
+
+private:
+    template <typename T>
+    struct Entry {
+        T value;
+        uint64_t last_used;
+        std::list<uint256>::iterator lru;
+    };
+    using ListsMap = std::unordered_map<uint256, Entry<CDeterministicMNList>, StaticSaltedHasher>;
+    using DiffsMap = std::unordered_map<uint256, Entry<CDeterministicMNListDiff>, StaticSaltedHasher>;
+
+    ListsMap::iterator EraseList(ListsMap::iterator it);
+    DiffsMap::iterator EraseDiff(DiffsMap::iterator it);
+
+    size_t m_max_usage;
+    size_t m_usage{0};
+    uint64_t m_tick{0};
+    uint64_t m_hits{0};
+    uint64_t m_misses{0};
+    uint64_t m_evictions{0};
+
+    ListsMap m_lists;
+    DiffsMap m_diffs;
+    // most recently used first
+    std::list<uint256> m_lists_lru;
+    std::list<uint256> m_diffs_lru;
+    // how many cached lists hold each masternode, only the first one is charged for it
+    std::unordered_map<const CDeterministicMN*, size_t> m_mn_refs;
+};
+
 class CDeterministicMNManager
 {
     static constexpr int DISK_SNAPSHOT_PERIOD = 576; // once per day
     // keep cache for enough disk snapshots to have all active quourms covered
     static constexpr int DISK_SNAPSHOTS = llmq_max_blocks() / DISK_SNAPSHOT_PERIOD + 1;
     static constexpr int LIST_DIFFS_CACHE_SIZE = DISK_SNAPSHOT_PERIOD * DISK_SNAPSHOTS;
+    // denser snapshots for the most recent blocks, dropped again once they get older than DISK_SNAPSHOT_RECENT_BLOCKS
+    static constexpr int DISK_SNAPSHOT_RECENT_PERIOD = 48;
+    static constexpr int DISK_SNAPSHOT_RECENT_BLOCKS = DISK_SNAPSHOT_PERIOD * 2;
+    static_assert(DISK_SNAPSHOT_PERIOD % DISK_SNAPSHOT_RECENT_PERIOD == 0);
 
 private:
     Mutex cs;
@@ -592,14 +836,14 @@ private:
     CConnman& connman;
     CEvoDB& m_evoDb;
 
-    std::unordered_map<uint256, CDeterministicMNList, StaticSaltedHasher> mnListsCache GUARDED_BY(cs);
-    std::unordered_map<uint256, CDeterministicMNListDiff, StaticSaltedHasher> mnListDiffsCache GUARDED_BY(cs);
+    CDeterministicMNListCache m_list_cache GUARDED_BY(cs);
     const CBlockIndex* tipIndex GUARDED_BY(cs) {nullptr};
     const CBlockIndex* m_initial_snapshot_index GUARDED_BY(cs) {nullptr};
 
 public:
-    explicit CDeterministicMNManager(CChainState& chainstate, CConnman& _connman, CEvoDB& evoDb) :
-        m_chainstate(chainstate), connman(_connman), m_evoDb(evoDb) {}
+    explicit CDeterministicMNManager(CChainState& chainstate, CConnman& _connman, CEvoDB& evoDb,
+                                     size_t nMaxCacheUsage = DEFAULT_MAX_MNLIST_CACHE_SIZE << 20) :
+        m_chainstate(chainstate), connman(_connman), m_evoDb(evoDb), m_list_cache(nMaxCacheUsage) {}
     ~CDeterministicMNManager() = default;
 
     bool ProcessBlock(const CBlock& block, gsl::not_null<const CBlockIndex*> pindex, BlockValidationState& state,
@@ -619,6 +863,20 @@ public:
     };
     CDeterministicMNList GetListAtChainTip() LOCKS_EXCLUDED(cs);
 
+    /**
+     * The list at the block nBlocks before pindex and the diffs of the blocks after it up to pindex, as carried by
+     * UTXO snapshots for the quorums of the blocks following them.
+     */
+    void GetListsForSnapshot(gsl::not_null<const CBlockIndex*> pindex, int nBlocks, CDeterministicMNList& firstListRet,
+                             std::vector<std::pair<uint256, CDeterministicMNListDiff>>& diffsRet) LOCKS_EXCLUDED(cs);
+    /**
+     * Write lists as returned by GetListsForSnapshot to evodb, for a node which doesn't have the blocks. Returns false
+     * if they don't follow the chain of pindex, the list at pindex is returned in listRet.
+     */
+    bool ImportListsFromSnapshot(gsl::not_null<const CBlockIndex*> pindex, const CDeterministicMNList& firstList,
+                                 const std::vector<std::pair<uint256, CDeterministicMNListDiff>>& diffs,
+                                 CDeterministicMNList& listRet) LOCKS_EXCLUDED(cs);
+
     // Test if given TX is a ProRegTx which also contains the collateral at index n
     static bool IsProTxWithCollateral(const CTransactionRef& tx, uint32_t n);
 
@@ -627,15 +885,40 @@ public:
 
     void DoMaintenance() LOCKS_EXCLUDED(cs);
 
+    CDeterministicMNListCache::Stats GetCacheStats() LOCKS_EXCLUDED(cs);
+
 private:
     void CleanupCache(int nHeight) EXCLUSIVE_LOCKS_REQUIRED(cs);
     CDeterministicMNList GetListForBlockInternal(gsl::not_null<const CBlockIndex*> pindex) EXCLUSIVE_LOCKS_REQUIRED(cs);
 };
 
-bool CheckProRegTx(const CTransaction& tx, gsl::not_null<const CBlockIndex*> pindexPrev, TxValidationState& state, const CCoinsViewCache& view, bool check_sigs);
-bool CheckProUpServTx(const CTransaction& tx, gsl::not_null<const CBlockIndex*> pindexPrev, TxValidationState& state, bool check_sigs);
-bool CheckProUpRegTx(const CTransaction& tx, gsl::not_null<const CBlockIndex*> pindexPrev, TxValidationState& state, const CCoinsViewCache& view, bool check_sigs);
-bool CheckProUpRevTx(const CTransaction& tx, gsl::not_null<const CBlockIndex*> pindexPrev, TxValidationState& state, bool check_sigs);
+/**
+ * A deferred ProTx payload signature check. ConnectBlock collects them while checking the special transactions of a
+ * block and runs them on a check queue while the rest of the block is processed.
+ */
+class CProTxSigCheck
+{
+private:
+    std::function<bool()> m_check;
+
+public:
+    CProTxSigCheck() = default;
+    explicit CProTxSigCheck(std::function<bool()> check) : m_check(std::move(check)) {}
+
+    bool operator()() { return m_check(); }
+
+    void swap(CProTxSigCheck& check) noexcept { std::swap(m_check, check.m_check); }
+};
+
+// With sig_checks set, payload signatures are not verified but added to it instead
+bool CheckProRegTx(const CTransaction& tx, gsl::not_null<const CBlockIndex*> pindexPrev, TxValidationState& state, const CCoinsViewCache& view, bool check_sigs,
+                   std::vector<CProTxSigCheck>* sig_checks = nullptr);
+bool CheckProUpServTx(const CTransaction& tx, gsl::not_null<const CBlockIndex*> pindexPrev, TxValidationState& state, bool check_sigs,
+                      std::vector<CProTxSigCheck>* sig_checks = nullptr);
+bool CheckProUpRegTx(const CTransaction& tx, gsl::not_null<const CBlockIndex*> pindexPrev, TxValidationState& state, const CCoinsViewCache& view, bool check_sigs,
+                     std::vector<CProTxSigCheck>* sig_checks = nullptr);
+bool CheckProUpRevTx(const CTransaction& tx, gsl::not_null<const CBlockIndex*> pindexPrev, TxValidationState& state, bool check_sigs,
+                     std::vector<CProTxSigCheck>* sig_checks = nullptr);
 
 extern std::unique_ptr<CDeterministicMNManager> deterministicMNManager;
 
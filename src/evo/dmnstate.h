@@ -12,8 +12,10 @@
 #include <script/script.h>
 #include <evo/providertx.h>
 
+#include <map>
 #include <memory>
 #include <utility>
+#include <vector>
 
 class CProRegTx;
 class UniValue;
@@ -243,6 +245,91 @@ public:
             obj.platformHTTPPort);
     }
 
+private:
+    enum CompactFlags : uint8_t {
+        COMPACT_CONFIRMED = 0x01,
+        // confirmedHashWithProRegTxHash isn't what UpdateConfirmedHash() gives, it's stored as is
+        COMPACT_CONFIRMED_HASH_STORED = 0x02,
+        COMPACT_PLATFORM = 0x04,
+    };
+
+    // Heights are -1 when unset, zigzag encoding keeps those in a single byte too
+    static uint32_t ZigZag(int n) { return (uint32_t(n) << 1) ^ uint32_t(n >> 31); }
+    static int UnZigZag(uint32_t n) { return int((n >> 1) ^ -(n & 1)); }
+
+public:
+    /**
+     * The encoding of the state in the masternode list snapshots of evoDB. Numbers are varints,
+     * payout scripts are indexes into the script table of the snapshot, and
+     * confirmedHashWithProRegTxHash is recomputed from proTxHash instead of stored.
+     */
+    template <typename Stream>
+    void SerializeCompact(Stream& s, const uint256& proTxHash, const std::map<CScript, uint32_t>& script_ids) const
+    {
+        uint8_t flags{0};
+        if (!confirmedHash.IsNull()) flags |= COMPACT_CONFIRMED;
+        CDeterministicMNState derived;
+        if (!confirmedHash.IsNull()) derived.UpdateConfirmedHash(proTxHash, confirmedHash);
+        if (derived.confirmedHashWithProRegTxHash != confirmedHashWithProRegTxHash) flags |= COMPACT_CONFIRMED_HASH_STORED;
+        if (!platformNodeID.IsNull() || platformP2PPort != 0 || platformHTTPPort != 0) flags |= COMPACT_PLATFORM;
+
+        s << flags;
+        for (const int n : {nVersion, nRegisteredHeight, nLastPaidHeight, nConsecutivePayments, nPoSePenalty, nPoSeRevivedHeight, nPoSeBanHeight}) {
+            WriteVarInt<Stream, VarIntMode::DEFAULT, uint32_t>(s, ZigZag(n));
+        }
+        WriteVarInt<Stream, VarIntMode::DEFAULT, uint16_t>(s, nRevocationReason);
+        if (flags & COMPACT_CONFIRMED) s << confirmedHash;
+        if (flags & COMPACT_CONFIRMED_HASH_STORED) s << confirmedHashWithProRegTxHash;
+        s << keyIDOwner;
+        s << CBLSLazyPublicKeyVersionWrapper(const_cast<CBLSLazyPublicKey&>(pubKeyOperator), nVersion == CProRegTx::LEGACY_BLS_VERSION);
+        s << keyIDVoting;
+        s << addr;
+        WriteVarInt<Stream, VarIntMode::DEFAULT, uint32_t>(s, script_ids.at(scriptPayout));
+        WriteVarInt<Stream, VarIntMode::DEFAULT, uint32_t>(s, script_ids.at(scriptOperatorPayout));
+        if (flags & COMPACT_PLATFORM) {
+            s << platformNodeID;
+            WriteVarInt<Stream, VarIntMode::DEFAULT, uint16_t>(s, platformP2PPort);
+            WriteVarInt<Stream, VarIntMode::DEFAULT, uint16_t>(s, platformHTTPPort);
+        }
+    }
+
+    template <typename Stream>
+    void UnserializeCompact(Stream& s, const uint256& proTxHash, const std::vector<CScript>& scripts)
+    {
+        uint8_t flags;
+        s >> flags;
+        for (int* n : {&nVersion, &nRegisteredHeight, &nLastPaidHeight, &nConsecutivePayments, &nPoSePenalty, &nPoSeRevivedHeight, &nPoSeBanHeight}) {
+            *n = UnZigZag(ReadVarInt<Stream, VarIntMode::DEFAULT, uint32_t>(s));
+        }
+        nRevocationReason = ReadVarInt<Stream, VarIntMode::DEFAULT, uint16_t>(s);
+        confirmedHash.SetNull();
+        confirmedHashWithProRegTxHash.SetNull();
+        if (flags & COMPACT_CONFIRMED) {
+            s >> confirmedHash;
+            UpdateConfirmedHash(proTxHash, confirmedHash);
+        }
+        if (flags & COMPACT_CONFIRMED_HASH_STORED) s >> confirmedHashWithProRegTxHash;
+        s >> keyIDOwner;
+        s >> CBLSLazyPublicKeyVersionWrapper(pubKeyOperator, nVersion == CProRegTx::LEGACY_BLS_VERSION);
+        s >> keyIDVoting;
+        s >> addr;
+        for (CScript* script : {&scriptPayout, &scriptOperatorPayout}) {
+            const uint32_t id = ReadVarInt<Stream, VarIntMode::DEFAULT, uint32_t>(s);
+            if (id >= scripts.size()) {
+                throw std::ios_base::failure("invalid script index in masternode list snapshot");
+            }
+            *script = scripts[id];
+        }
+        platformNodeID.SetNull();
+        platformP2PPort = 0;
+        platformHTTPPort = 0;
+        if (flags & COMPACT_PLATFORM) {
+            s >> platformNodeID;
+            platformP2PPort = ReadVarInt<Stream, VarIntMode::DEFAULT, uint16_t>(s);
+            platformHTTPPort = ReadVarInt<Stream, VarIntMode::DEFAULT, uint16_t>(s);
+        }
+    }
+
     void ResetOperatorFields()
     {
         nVersion = CProRegTx::LEGACY_BLS_VERSION;
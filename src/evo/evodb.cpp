@@ -6,6 +6,8 @@
 
 #include <uint256.h>
 
+#include <algorithm>
+
 CEvoDBScopedCommitter::CEvoDBScopedCommitter(CEvoDB &_evoDB) :
     evoDB(_evoDB)
 {
@@ -31,12 +33,89 @@ void CEvoDBScopedCommitter::Rollback()
     evoDB.RollbackCurTransaction();
 }
 
+CEvoDBStores::CEvoDBStores(CDBWrapper& _db, CDBWrapper& _snapshotDb, CDBBatch& _batch, CDBBatch& _snapshotBatch) :
+    db(_db),
+    snapshotDb(_snapshotDb),
+    batch(_batch),
+    snapshotBatch(_snapshotBatch),
+    snapshotKeyPrefix(MakeKeyPrefix(EVODB_LIST_SNAPSHOT)),
+    legacySnapshotKeyPrefix(MakeKeyPrefix(EVODB_LIST_SNAPSHOT_LEGACY))
+{
+}
+
+CDataStream CEvoDBStores::MakeKeyPrefix(const std::string& prefix)
+{
+    CDataStream ssPrefix(SER_DISK, CLIENT_VERSION);
+    ssPrefix << prefix;
+    return ssPrefix;
+}
+
+bool CEvoDBStores::HasPrefix(const CDataStream& ssKey, const CDataStream& ssPrefix)
+{
+    return ssKey.size() >= ssPrefix.size() && std::equal(ssPrefix.begin(), ssPrefix.end(), ssKey.begin());
+}
+
+bool CEvoDBStores::IsSnapshotKey(const CDataStream& ssKey) const
+{
+    return HasPrefix(ssKey, snapshotKeyPrefix) || HasPrefix(ssKey, legacySnapshotKeyPrefix);
+}
+
+// The snapshots get a small share of the cache, they are rarely read twice and the masternode list
+// cache keeps the recent ones in memory anyway
 CEvoDB::CEvoDB(size_t nCacheSize, bool fMemory, bool fWipe) :
-    db(fMemory ? "" : (GetDataDir() / "evodb"), nCacheSize, fMemory, fWipe),
+    db(fMemory ? "" : (GetDataDir() / "evodb"), nCacheSize - nCacheSize / 8, fMemory, fWipe),
+    snapshotDb(fMemory ? "" : (GetDataDir() / "evodb" / "snapshots"), nCacheSize / 8, fMemory, fWipe),
     rootBatch(db),
-    rootDBTransaction(db, rootBatch),
+    snapshotBatch(snapshotDb),
+    stores(db, snapshotDb, rootBatch, snapshotBatch),
+    frozenDBTransaction(stores, stores),
+    rootDBTransaction(frozenDBTransaction, frozenDBTransaction),
     curDBTransaction(rootDBTransaction, rootDBTransaction)
 {
+    MoveSnapshotsToOwnStore();
+}
+
+void CEvoDB::MoveSnapshotsToOwnStore()
+{
+    // Only snapshots in the old encoding were ever written to the main store
+    CDataStream ssPrefix(SER_DISK, CLIENT_VERSION);
+    ssPrefix << EVODB_LIST_SNAPSHOT_LEGACY;
+
+    std::unique_ptr<CDBIterator> pcursor(db.NewIterator());
+    pcursor->Seek(ssPrefix);
+
+    CDBBatch batch(snapshotDb);
+    CDBBatch eraseBatch(db);
+    size_t nMoved{0};
+    auto flush = [&] {
+        // Written to the snapshot store first, so that an interrupted move just starts over
+        snapshotDb.WriteBatch(batch, true);
+        db.WriteBatch(eraseBatch, true);
+        batch.Clear();
+        eraseBatch.Clear();
+    };
+    for (; pcursor->Valid(); pcursor->Next()) {
+        CDataStream ssKey = pcursor->GetKey();
+        if (!CEvoDBStores::HasPrefix(ssKey, ssPrefix)) {
+            break;
+        }
+        CDataStream ssValue(SER_DISK, CLIENT_VERSION);
+        if (!db.ReadDataStream(ssKey, ssValue)) {
+            throw std::runtime_error(strprintf("%s: failed to read snapshot from evodb", __func__));
+        }
+        batch.Write(ssKey, ssValue);
+        eraseBatch.Erase(ssKey);
+        if (batch.SizeEstimate() > (1 << 24)) {
+            flush();
+        }
+        ++nMoved;
+    }
+    if (nMoved == 0) {
+        return;
+    }
+    flush();
+    LogPrintf("CEvoDB::%s -- moved %d masternode list snapshots to their own store\n", __func__, nMoved);
+    db.CompactRange(std::make_pair(EVODB_LIST_SNAPSHOT_LEGACY, uint256()), std::make_pair(EVODB_LIST_SNAPSHOT_LEGACY, uint256S(std::string(64, 'f'))));
 }
 
 void CEvoDB::CommitCurTransaction()
@@ -56,7 +135,35 @@ bool CEvoDB::CommitRootTransaction()
     LOCK(cs);
     assert(curDBTransaction.IsClean());
     rootDBTransaction.Commit();
-    bool ret = db.WriteBatch(rootBatch);
+    return WriteFrozenTransaction();
+}
+
+void CEvoDB::FreezeRootTransaction()
+{
+    LOCK(cs);
+    assert(curDBTransaction.IsClean());
+    assert(frozenDBTransaction.IsClean());
+    rootDBTransaction.Commit();
+}
+
+bool CEvoDB::CommitFrozenTransaction()
+{
+    // Holding cs until the batches are written, the frozen changes must not be missed by reads in between
+    LOCK(cs);
+    return WriteFrozenTransaction();
+}
+
+bool CEvoDB::WriteFrozenTransaction()
+{
+    AssertLockHeld(cs);
+    frozenDBTransaction.Commit();
+    // The two stores can't be committed atomically. Snapshots are keyed by their block and lookups fall
+    // back to older snapshots and the diffs in between, so one which is committed without the rest or
+    // lost again is harmless. They are committed first and synced, so they aren't lost more often than
+    // the main store's entries.
+    bool ret = snapshotBatch.SizeEstimate() == 0 || snapshotDb.WriteBatch(snapshotBatch, true);
+    ret = ret && db.WriteBatch(rootBatch);
+    snapshotBatch.Clear();
     rootBatch.Clear();
     return ret;
 }
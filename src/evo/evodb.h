@@ -14,9 +14,67 @@ class uint256;
 // "b_b3" was used after masternode type introduction in evoDB
 // "b_b4" was used after storing protx version for each masternode in evoDB
 static const std::string EVODB_BEST_BLOCK = "b_b4";
+// Masternode list snapshots are large and written only every few blocks. They are kept in a store of
+// their own, so that compacting them doesn't hold up the compactions of the many small entries.
+// "dmn_S3" snapshots are in the full serialization of the masternode list, they are still read, but
+// new snapshots are written in the compact encoding of CDeterministicMNListCompact.
+static const std::string EVODB_LIST_SNAPSHOT = "dmn_S4";
+static const std::string EVODB_LIST_SNAPSHOT_LEGACY = "dmn_S3";
 
 class CEvoDB;
 
+/**
+ * The LevelDB stores the evodb is made of, which the root transaction reads from and commits to.
+ * Keys are routed by their prefix, snapshots written before they got a store of their own are
+ * moved there on startup.
+ */
+class CEvoDBStores
+{
+private:
+    CDBWrapper& db;
+    CDBWrapper& snapshotDb;
+    CDBBatch& batch;
+    CDBBatch& snapshotBatch;
+    const CDataStream snapshotKeyPrefix;
+    const CDataStream legacySnapshotKeyPrefix;
+
+public:
+    CEvoDBStores(CDBWrapper& _db, CDBWrapper& _snapshotDb, CDBBatch& _batch, CDBBatch& _snapshotBatch);
+
+    static CDataStream MakeKeyPrefix(const std::string& prefix);
+    static bool HasPrefix(const CDataStream& ssKey, const CDataStream& ssPrefix);
+
+    bool IsSnapshotKey(const CDataStream& ssKey) const;
+
+    template <typename V>
+    bool Read(const CDataStream& ssKey, V& value) const
+    {
+        return (IsSnapshotKey(ssKey) ? snapshotDb : db).Read(ssKey, value);
+    }
+
+    bool Exists(const CDataStream& ssKey) const
+    {
+        return (IsSnapshotKey(ssKey) ? snapshotDb : db).Exists(ssKey);
+    }
+
+    template <typename V>
+    void Write(const CDataStream& ssKey, const V& value)
+    {
+        (IsSnapshotKey(ssKey) ? snapshotBatch : batch).Write(ssKey, value);
+    }
+
+    void Erase(const CDataStream& ssKey)
+    {
+        (IsSnapshotKey(ssKey) ? snapshotBatch : batch).Erase(ssKey);
+    }
+
+    /** Iterates over the main store only, nothing iterates over the snapshots */
+    CDBIterator* NewIterator()
+    {
+        return db.NewIterator();
+    }
+};
+
 class CEvoDBScopedCommitter
 {
 private:
@@ -37,11 +95,17 @@ public:
     Mutex cs;
 private:
     CDBWrapper db;
+    CDBWrapper snapshotDb;
 
-    using RootTransaction = CDBTransaction<CDBWrapper, CDBBatch>;
+    // The frozen transaction holds the changes of a flush until they are written, see FreezeRootTransaction
+    using FrozenTransaction = CDBTransaction<CEvoDBStores, CEvoDBStores>;
+    using RootTransaction = CDBTransaction<FrozenTransaction, FrozenTransaction>;
     using CurTransaction = CDBTransaction<RootTransaction, RootTransaction>;
 
     CDBBatch rootBatch;
+    CDBBatch snapshotBatch;
+    CEvoDBStores stores;
+    FrozenTransaction frozenDBTransaction;
     RootTransaction rootDBTransaction;
     CurTransaction curDBTransaction;
 
@@ -95,12 +159,22 @@ public:
 
     [[nodiscard]] size_t GetMemoryUsage() const
     {
-        return rootDBTransaction.GetMemoryUsage();
+        return rootDBTransaction.GetMemoryUsage() + frozenDBTransaction.GetMemoryUsage();
     }
 
     bool CommitRootTransaction() LOCKS_EXCLUDED(cs);
 
-    bool IsEmpty() { return db.IsEmpty(); }
+    /**
+     * Set the changes so far aside to be written by CommitFrozenTransaction, e.g. on another thread once
+     * the coins of the same block are written. They stay readable until then.
+     */
+    void FreezeRootTransaction() LOCKS_EXCLUDED(cs);
+    bool CommitFrozenTransaction() LOCKS_EXCLUDED(cs);
+
+    bool IsEmpty() { return db.IsEmpty() && snapshotDb.IsEmpty(); }
+
+    /** Move the snapshots written to the main store, e.g. by earlier versions, to their own store */
+    void MoveSnapshotsToOwnStore();
 
     bool VerifyBestBlock(const uint256& hash);
     void WriteBestBlock(const uint256& hash);
@@ -110,6 +184,8 @@ private:
     friend class CEvoDBScopedCommitter;
     void CommitCurTransaction() LOCKS_EXCLUDED(cs);
     void RollbackCurTransaction() LOCKS_EXCLUDED(cs);
+
+    bool WriteFrozenTransaction() EXCLUSIVE_LOCKS_REQUIRED(cs);
 };
 
 #endif // BITCOIN_EVO_EVODB_H
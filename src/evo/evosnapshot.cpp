@@ -0,0 +1,155 @@
+// Copyright (c) 2026 The Dash Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <evo/evosnapshot.h>
+
+#include <evo/cbtx.h>
+#include <evo/evodb.h>
+#include <evo/simplifiedmns.h>
+#include <evo/specialtx.h>
+#include <llmq/blockprocessor.h>
+
+#include <chain.h>
+#include <chainparams.h>
+#include <node/blockstorage.h>
+#include <validation.h>
+
+#include <set>
+
+bool CreateEvoSnapshot(const CBlockIndex* pindex, CDeterministicMNManager& dmnman, CCreditPoolManager& cpoolman,
+                       CMNHFManager& mnhfman, llmq::CQuorumBlockProcessor& qblockman,
+                       CEvoSnapshot& snapshot, std::string& strError)
+{
+    AssertLockHeld(cs_main);
+
+    const auto& consensus_params = Params().GetConsensus();
+
+    CBlock block;
+    if (!ReadBlockFromDisk(block, pindex, consensus_params)) {
+        strError = "failed to read base block";
+        return false;
+    }
+    snapshot.m_base_blockhash = pindex->GetBlockHash();
+    snapshot.m_coinbase_tx = block.vtx[0];
+    std::vector<uint256> vtxid;
+    std::vector<bool> vmatch(block.vtx.size(), false);
+    vtxid.reserve(block.vtx.size());
+    for (const auto& tx : block.vtx) {
+        vtxid.emplace_back(tx->GetHash());
+    }
+    vmatch[0] = true;
+    snapshot.m_coinbase_proof = CPartialMerkleTree(vtxid, vmatch);
+
+    dmnman.GetListsForSnapshot(pindex, EVO_SNAPSHOT_LIST_BLOCKS, snapshot.m_first_list, snapshot.m_list_diffs);
+
+    // Commitments of all active quorums, for rotated ones also of the previous cycles their members are built from
+    std::set<std::pair<Consensus::LLMQType, uint256>> quorums;
+    for (const auto& [llmq_type, base_indexes] : qblockman.GetMinedAndActiveCommitmentsUntilBlock(pindex)) {
+        for (const auto* base_index : base_indexes) {
+            quorums.emplace(llmq_type, base_index->GetBlockHash());
+        }
+    }
+    for (const auto& llmq_params : consensus_params.llmqs) {
+        if (!llmq_params.useRotation) continue;
+        for (size_t cycle = 1; cycle <= 3; ++cycle) {
+            for (const auto& [quorum_index, base_index] : qblockman.GetLastMinedCommitmentsPerQuorumIndexUntilBlock(llmq_params.type, pindex, cycle)) {
+                quorums.emplace(llmq_params.type, base_index->GetBlockHash());
+            }
+        }
+        const int first_height = std::max(0, pindex->nHeight - EVO_SNAPSHOT_LIST_BLOCKS);
+        for (int height = pindex->nHeight - pindex->nHeight % llmq_params.dkgInterval; height >= first_height; height -= llmq_params.dkgInterval) {
+            if (auto quorum_snapshot = llmq::quorumSnapshotManager->GetSnapshotForBlock(llmq_params.type, pindex->GetAncestor(height))) {
+                snapshot.m_quorum_snapshots.emplace_back(llmq_params.type, height, std::move(*quorum_snapshot));
+            }
+        }
+    }
+    for (const auto& [llmq_type, quorum_hash] : quorums) {
+        uint256 mined_hash;
+        const auto qc = qblockman.GetMinedCommitment(llmq_type, quorum_hash, mined_hash);
+        const CBlockIndex* mined_index = g_chainman.m_blockman.LookupBlockIndex(mined_hash);
+        if (qc == nullptr || mined_index == nullptr) {
+            strError = strprintf("failed to read commitment of quorum %s", quorum_hash.ToString());
+            return false;
+        }
+        snapshot.m_commitments.emplace_back(*qc, mined_index->nHeight);
+    }
+
+    snapshot.m_credit_pool = cpoolman.GetCreditPool(pindex, consensus_params);
+    snapshot.m_unlocked = cpoolman.GetUnlockedAmounts(pindex, consensus_params);
+    snapshot.m_mnhf_signals = mnhfman.GetSignalsForSnapshot(pindex);
+    return true;
+}
+
+bool LoadEvoSnapshot(const CEvoSnapshot& snapshot, const CBlockIndex* pindex, CEvoDB& evoDb,
+                     CDeterministicMNManager& dmnman, CCreditPoolManager& cpoolman,
+                     CMNHFManager& mnhfman, llmq::CQuorumBlockProcessor& qblockman,
+                     std::string& strError)
+{
+    AssertLockHeld(cs_main);
+
+    if (snapshot.m_base_blockhash != pindex->GetBlockHash()) {
+        strError = "evo snapshot is for another block";
+        return false;
+    }
+
+    // The coinbase of the base block commits to the masternode list and the credit pool
+    std::vector<uint256> vmatch;
+    std::vector<unsigned int> vindex;
+    if (snapshot.m_coinbase_tx == nullptr || !snapshot.m_coinbase_tx->IsCoinBase() ||
+        CPartialMerkleTree(snapshot.m_coinbase_proof).ExtractMatches(vmatch, vindex) != pindex->hashMerkleRoot ||
+        vindex.size() != 1 || vindex[0] != 0 || vmatch[0] != snapshot.m_coinbase_tx->GetHash()) {
+        strError = "bad coinbase proof";
+        return false;
+    }
+    const auto opt_cbtx = GetTxPayload<CCbTx>(*snapshot.m_coinbase_tx);
+    if (!opt_cbtx) {
+        strError = "bad coinbase payload";
+        return false;
+    }
+    if (opt_cbtx->nVersion >= CCbTx::Version::CLSIG_AND_BALANCE && opt_cbtx->creditPoolBalance != snapshot.m_credit_pool.locked) {
+        strError = "credit pool doesn't match the coinbase";
+        return false;
+    }
+
+    // Rotated quorums are verified against these, they are keyed by block hash and harmless if loading fails
+    for (const auto& [llmq_type, height, quorum_snapshot] : snapshot.m_quorum_snapshots) {
+        if (height < 0 || height > pindex->nHeight) {
+            strError = "bad quorum snapshot height";
+            return false;
+        }
+        llmq::quorumSnapshotManager->StoreSnapshotForBlock(llmq_type, pindex->GetAncestor(height), quorum_snapshot);
+    }
+
+    auto dbTx = evoDb.BeginTransaction();
+
+    CDeterministicMNList list;
+    if (!dmnman.ImportListsFromSnapshot(pindex, snapshot.m_first_list, snapshot.m_list_diffs, list)) {
+        strError = "masternode lists don't follow the chain";
+        return false;
+    }
+    if (CSimplifiedMNList(list).CalcMerkleRoot() != opt_cbtx->merkleRootMNList) {
+        strError = "masternode list doesn't match the coinbase";
+        return false;
+    }
+
+    for (const auto& [qc, mined_height] : snapshot.m_commitments) {
+        if (mined_height < 0 || mined_height > pindex->nHeight ||
+            !qblockman.ImportMinedCommitment(qc, pindex->GetAncestor(mined_height))) {
+            strError = strprintf("bad commitment of quorum %s", qc.quorumHash.ToString());
+            return false;
+        }
+    }
+
+    mnhfman.ImportSignals(pindex, snapshot.m_mnhf_signals);
+
+    evoDb.WriteBestBlock(pindex->GetBlockHash());
+    dbTx->Commit();
+    if (!evoDb.CommitRootTransaction()) {
+        strError = "failed to write evodb";
+        return false;
+    }
+
+    cpoolman.ImportSnapshot(*pindex, snapshot.m_credit_pool, snapshot.m_unlocked);
+    return true;
+}
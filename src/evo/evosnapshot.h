@@ -0,0 +1,90 @@
+// Copyright (c) 2026 The Dash Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_EVO_EVOSNAPSHOT_H
+#define BITCOIN_EVO_EVOSNAPSHOT_H
+
+#include <evo/creditpool.h>
+#include <evo/deterministicmns.h>
+#include <evo/mnhftx.h>
+#include <llmq/commitment.h>
+#include <llmq/snapshot.h>
+#include <merkleblock.h>
+#include <primitives/transaction.h>
+#include <serialize.h>
+#include <sync.h>
+#include <uint256.h>
+
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+class CBlockIndex;
+class CEvoDB;
+
+namespace llmq {
+class CQuorumBlockProcessor;
+} // namespace llmq
+
+extern RecursiveMutex cs_main;
+
+/** Marks the evo section which follows the coins of a UTXO snapshot */
+static constexpr uint32_t EVO_SNAPSHOT_MAGIC{0x45564f53};
+
+/**
+ * Blocks of masternode lists carried by an evo snapshot. Rotated quorums are built from the lists up to four
+ * cycles back, so this covers twice what the longest lived quorums need.
+ */
+static constexpr int EVO_SNAPSHOT_LIST_BLOCKS{llmq_max_blocks() * 2};
+
+/**
+ * The Dash specific state at the base of a UTXO snapshot which a node can't rebuild without the blocks before it:
+ * the recent masternode lists, the commitments and rotation snapshots of the active quorums, the credit pool with
+ * the unlocks its limits depend on and the MNHF signals.
+ *
+ * The masternode list and the credit pool are checked against the coinbase of the base block, which is carried
+ * with a merkle proof, the commitments are verified like mined ones.
+ */
+class CEvoSnapshot
+{
+public:
+    uint256 m_base_blockhash;
+    CTransactionRef m_coinbase_tx;
+    CPartialMerkleTree m_coinbase_proof;
+
+    CDeterministicMNList m_first_list;
+    std::vector<std::pair<uint256, CDeterministicMNListDiff>> m_list_diffs;
+
+    // commitments with the height they were mined at
+    std::vector<std::pair<llmq::CFinalCommitment, int>> m_commitments;
+    std::vector<std::tuple<Consensus::LLMQType, int, llmq::CQuorumSnapshot>> m_quorum_snapshots;
+
+    CCreditPool m_credit_pool;
+    std::vector<std::pair<uint256, CAmount>> m_unlocked;
+
+    CMNHFManager::Signals m_mnhf_signals;
+
+    SERIALIZE_METHODS(CEvoSnapshot, obj)
+    {
+        READWRITE(obj.m_base_blockhash, obj.m_coinbase_tx, obj.m_coinbase_proof,
+                  obj.m_first_list, obj.m_list_diffs,
+                  obj.m_commitments, obj.m_quorum_snapshots,
+                  obj.m_credit_pool, obj.m_unlocked,
+                  obj.m_mnhf_signals);
+    }
+};
+
+/** Collect the evo state at pindex, which must be on disk, into snapshot */
+bool CreateEvoSnapshot(const CBlockIndex* pindex, CDeterministicMNManager& dmnman, CCreditPoolManager& cpoolman,
+                       CMNHFManager& mnhfman, llmq::CQuorumBlockProcessor& qblockman,
+                       CEvoSnapshot& snapshot, std::string& strError) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+
+/** Check snapshot against the base block pindex and write its state to evodb and the caches of the managers */
+bool LoadEvoSnapshot(const CEvoSnapshot& snapshot, const CBlockIndex* pindex, CEvoDB& evoDb,
+                     CDeterministicMNManager& dmnman, CCreditPoolManager& cpoolman,
+                     CMNHFManager& mnhfman, llmq::CQuorumBlockProcessor& qblockman,
+                     std::string& strError) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+
+#endif // BITCOIN_EVO_EVOSNAPSHOT_H
@@ -16,9 +16,13 @@
 #include <net.h>
 #include <net_types.h>
 #include <netmessagemaker.h>
+#include <saltedhasher.h>
 #include <util/time.h>
 #include <validation.h>
 
+#include <optional>
+#include <unordered_map>
+
 void CMNAuth::PushMNAUTH(CNode& peer, CConnman& connman, const CBlockIndex* tip)
 {
     LOCK(activeMasternodeInfoCs);
@@ -101,7 +105,7 @@ PeerMsgRet CMNAuth::ProcessMessage(CNode& peer, CConnman& connman, std::string_v
     if (Params().NetworkIDString() != CBaseChainParams::MAIN && gArgs.IsArgSet("-pushversion")) {
         nOurNodeVersion = gArgs.GetArg("-pushversion", PROTOCOL_VERSION);
     }
-    const CBlockIndex* tip = ::ChainActive().Tip();
+    const CBlockIndex* tip = WITH_LOCK(cs_main, return ::ChainActive().Tip());
     const bool is_basic_scheme_active{DeploymentActiveAfter(tip, Params().GetConsensus(), Consensus::DEPLOYMENT_V19)};
     ConstCBLSPublicKeyVersionWrapper pubKey(dmn->pdmnState->pubKeyOperator.Get(), !is_basic_scheme_active);
     // See comment in PushMNAUTH (fInbound is negated here as we're on the other side of the connection)
@@ -196,23 +200,35 @@ void CMNAuth::NotifyMasternodeListChanged(bool undo, const CDeterministicMNList&
         return;
     }
 
-    connman.ForEachNode([&oldMNList, &diff](CNode* pnode) {
+    // The MNs whose peers may have to go, with the new operator key hash of the updated ones. Only the MNs in
+    // the diff are looked up instead of the MN of every verified peer.
+    std::unordered_map<uint256, std::optional<uint256>, StaticSaltedHasher> affectedMNs;
+    for (const auto& internalId : diff.removedMns) {
+        if (const auto dmn = oldMNList.GetMNByInternalId(internalId)) {
+            affectedMNs.emplace(dmn->proTxHash, std::nullopt);
+        }
+    }
+    for (const auto& [internalId, stateDiff] : diff.updatedMNs) {
+        if (!(stateDiff.fields & CDeterministicMNStateDiff::Field_pubKeyOperator)) continue;
+        if (const auto dmn = oldMNList.GetMNByInternalId(internalId)) {
+            affectedMNs.emplace(dmn->proTxHash, stateDiff.state.pubKeyOperator.GetHash());
+        }
+    }
+    if (affectedMNs.empty()) {
+        return;
+    }
+
+    connman.ForEachNode([&affectedMNs](CNode* pnode) {
         const auto verifiedProRegTxHash = pnode->GetVerifiedProRegTxHash();
         if (verifiedProRegTxHash.IsNull()) {
             return;
         }
-        const auto verifiedDmn = oldMNList.GetMN(verifiedProRegTxHash);
-        if (!verifiedDmn) {
+        const auto it = affectedMNs.find(verifiedProRegTxHash);
+        if (it == affectedMNs.end()) {
             return;
         }
-        bool doRemove = false;
-        if (diff.removedMns.count(verifiedDmn->GetInternalId())) {
-            doRemove = true;
-        } else if (const auto it = diff.updatedMNs.find(verifiedDmn->GetInternalId()); it != diff.updatedMNs.end()) {
-            if ((it->second.fields & CDeterministicMNStateDiff::Field_pubKeyOperator) && it->second.state.pubKeyOperator.GetHash() != pnode->GetVerifiedPubKeyHash()) {
-                doRemove = true;
-            }
-        }
+        // removed, or the operator key changed to one the peer didn't authenticate with
+        const bool doRemove = !it->second || *it->second != pnode->GetVerifiedPubKeyHash();
 
         if (doRemove) {
             LogPrint(BCLog::NET_NETCONN, "CMNAuth::NotifyMasternodeListChanged -- Disconnecting MN %s due to key changed/removed, peer=%d\n",
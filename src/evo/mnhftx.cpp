@@ -54,7 +54,14 @@ CMNHFManager::~CMNHFManager()
 
 CMNHFManager::Signals CMNHFManager::GetSignalsStage(const CBlockIndex* const pindexPrev)
 {
-    Signals signals = GetForBlock(pindexPrev);
+    // See GetFromCache about phashBlock
+    const bool cacheable{pindexPrev->phashBlock != nullptr};
+    Signals signals;
+    if (cacheable && WITH_LOCK(cs_cache, return stageCache.get(pindexPrev->GetBlockHash(), signals))) {
+        return signals;
+    }
+
+    signals = GetForBlock(pindexPrev);
     const int height = pindexPrev->nHeight + 1;
     for (auto it = signals.begin(); it != signals.end(); ) {
         bool found{false};
@@ -80,6 +87,10 @@ CMNHFManager::Signals CMNHFManager::GetSignalsStage(const CBlockIndex* const pin
             it = signals.erase(it);
         }
     }
+    if (cacheable) {
+        LOCK(cs_cache);
+        stageCache.insert(pindexPrev->GetBlockHash(), signals);
+    }
     return signals;
 }
 
@@ -334,6 +345,8 @@ void CMNHFManager::AddToCache(const Signals& signals, const CBlockIndex* const p
     {
         LOCK(cs_cache);
         mnhfCache.insert(blockHash, signals);
+        // the stage of the next block is derived from these, AddSignal and ImportSignals may replace them
+        stageCache.erase(blockHash);
     }
     {
         LOCK(cs_cache);
@@ -349,6 +362,16 @@ void CMNHFManager::AddSignal(const CBlockIndex* const pindex, int bit)
     AddToCache(signals, pindex);
 }
 
+CMNHFManager::Signals CMNHFManager::GetSignalsForSnapshot(const CBlockIndex* const pindex)
+{
+    return GetForBlock(pindex);
+}
+
+void CMNHFManager::ImportSignals(const CBlockIndex* const pindex, const Signals& signals)
+{
+    AddToCache(signals, pindex);
+}
+
 std::string MNHFTx::ToString() const
 {
     return strprintf("MNHFTx(versionBit=%d, quorumHash=%s, sig=%s)",
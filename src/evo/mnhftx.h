@@ -100,6 +100,8 @@ private:
     Mutex cs_cache;
     // versionBit <-> height
     unordered_lru_cache<uint256, Signals, StaticSaltedHasher> mnhfCache GUARDED_BY(cs_cache) {MNHFCacheSize};
+    // GetSignalsStage results by hash of pindexPrev, versionbits asks for them once per deployment and block
+    unordered_lru_cache<uint256, Signals, StaticSaltedHasher> stageCache GUARDED_BY(cs_cache) {MNHFCacheSize};
 
     // This cache is used only for v20 activation to avoid double lock through VersionBitsConditionChecker::SignalHeight
     VersionBitsCache v20_activation GUARDED_BY(cs_cache);
@@ -123,14 +125,24 @@ public:
 
 
     // Implements interface
-    Signals GetSignalsStage(const CBlockIndex* const pindexPrev) override;
+    Signals GetSignalsStage(const CBlockIndex* const pindexPrev) override LOCKS_EXCLUDED(cs_cache);
 
     /**
      * Helper that used in Unit Test to forcely setup EHF signal for specific block
      */
     void AddSignal(const CBlockIndex* const pindex, int bit) LOCKS_EXCLUDED(cs_cache);
+
+    /**
+     * Signals known at block pindex, as carried by a UTXO snapshot of that block
+     */
+    Signals GetSignalsForSnapshot(const CBlockIndex* const pindex) LOCKS_EXCLUDED(cs_cache);
+
+    /**
+     * Store the signals of a UTXO snapshot for block pindex, whose ancestors can't be processed by this node
+     */
+    void ImportSignals(const CBlockIndex* const pindex, const Signals& signals) LOCKS_EXCLUDED(cs_cache);
 private:
-    void AddToCache(const Signals& signals, const CBlockIndex* const pindex);
+    void AddToCache(const Signals& signals, const CBlockIndex* const pindex) LOCKS_EXCLUDED(cs_cache);
 
     /**
      * This function returns list of signals available on previous block.
@@ -140,6 +140,137 @@ bool CSimplifiedMNList::operator==(const CSimplifiedMNList& rhs) const
             );
 }
 
+uint256 CSimplifiedMNListMerkleTree::Update(const CDeterministicMNList& mnList, bool* pmutated)
+{
+    // Only masternodes with a new state can have a new SML entry
+    std::vector<std::pair<uint256, uint256>> added;
+    std::vector<std::pair<uint256, uint256>> changed;
+    std::set<uint256> removed;
+    mnList.ForEachMN(false, [&](const auto& dmn) {
+        const auto oldDmn = m_list.GetMN(dmn.proTxHash);
+        if (!oldDmn) {
+            added.emplace_back(dmn.proTxHash, CSimplifiedMNListEntry(dmn).CalcHash());
+        } else if (oldDmn->pdmnState != dmn.pdmnState) {
+            changed.emplace_back(dmn.proTxHash, CSimplifiedMNListEntry(dmn).CalcHash());
+        }
+    });
+    m_list.ForEachMN(false, [&](const auto& dmn) {
+        if (!mnList.HasMN(dmn.proTxHash)) {
+            removed.emplace(dmn.proTxHash);
+        }
+    });
+
+    // Everything from the first added or removed leaf on has moved
+    size_t dirtyFrom = m_keys.size();
+    if (!added.empty() || !removed.empty()) {
+        std::sort(added.begin(), added.end());
+        const auto& oldLeaves = m_levels[0];
+        std::vector<uint256> keys;
+        std::vector<uint256> leaves;
+        keys.reserve(m_keys.size() + added.size());
+        leaves.reserve(m_keys.size() + added.size());
+        auto it = added.begin();
+        for (size_t i = 0; i < m_keys.size() || it != added.end(); ) {
+            if (it != added.end() && (i == m_keys.size() || it->first < m_keys[i])) {
+                dirtyFrom = std::min(dirtyFrom, keys.size());
+                keys.emplace_back(it->first);
+                leaves.emplace_back(it->second);
+                ++it;
+            } else if (removed.count(m_keys[i])) {
+                dirtyFrom = std::min(dirtyFrom, keys.size());
+                ++i;
+            } else {
+                keys.emplace_back(m_keys[i]);
+                leaves.emplace_back(oldLeaves[i]);
+                ++i;
+            }
+        }
+        m_keys = std::move(keys);
+        m_levels[0] = std::move(leaves);
+    }
+
+    std::vector<size_t> dirty;
+    for (const auto& [proTxHash, leaf] : changed) {
+        const size_t i = std::lower_bound(m_keys.begin(), m_keys.end(), proTxHash) - m_keys.begin();
+        if (m_levels[0][i] != leaf) {
+            m_levels[0][i] = leaf;
+            dirty.emplace_back(i);
+        }
+    }
+
+    RehashLevels(std::move(dirty), dirtyFrom);
+    m_list = mnList;
+
+    if (pmutated) *pmutated = IsMutated();
+    return GetRoot();
+}
+
+void CSimplifiedMNListMerkleTree::RehashLevels(std::vector<size_t> dirty, size_t dirtyFrom)
+{
+    std::sort(dirty.begin(), dirty.end());
+    size_t level = 0;
+    for (; m_levels[level].size() > 1; ++level) {
+        size_t parentFrom = dirtyFrom / 2;
+        if (m_levels.size() == level + 1) {
+            m_levels.emplace_back();
+            parentFrom = 0;
+        }
+        auto& children = m_levels[level];
+        auto& parents = m_levels[level + 1];
+        const size_t count = (children.size() + 1) / 2;
+        parents.resize(count);
+        parentFrom = std::min(parentFrom, count);
+
+        const auto setMutated = [&](size_t j) {
+            if (2 * j + 1 < children.size() && children[2 * j] == children[2 * j + 1]) {
+                m_mutated.emplace(level, j);
+            } else {
+                m_mutated.erase({level, j});
+            }
+        };
+
+        std::vector<size_t> dirtyParents;
+        for (const size_t i : dirty) {
+            const size_t j = i / 2;
+            if (j >= parentFrom || (!dirtyParents.empty() && dirtyParents.back() == j)) {
+                continue;
+            }
+            parents[j] = Hash(children[2 * j], children[std::min(2 * j + 1, children.size() - 1)]);
+            setMutated(j);
+            dirtyParents.emplace_back(j);
+        }
+
+        m_mutated.erase(m_mutated.lower_bound({level, parentFrom}), m_mutated.lower_bound({level + 1, 0}));
+        if (parentFrom < count) {
+            // Hash the whole moved range in one go, which lets SHA256D64 use its multi-way implementations
+            const bool odd = children.size() & 1;
+            if (odd) {
+                children.emplace_back(children.back());
+            }
+            SHA256D64(parents[parentFrom].begin(), children[2 * parentFrom].begin(), count - parentFrom);
+            if (odd) {
+                children.pop_back();
+            }
+            for (size_t j = parentFrom; j < count; ++j) {
+                setMutated(j);
+            }
+        }
+
+        dirty = std::move(dirtyParents);
+        dirtyFrom = parentFrom;
+    }
+    m_levels.resize(level + 1);
+    m_mutated.erase(m_mutated.lower_bound({level, 0}), m_mutated.end());
+}
+
+uint256 CSimplifiedMNListMerkleTree::GetRoot() const
+{
+    if (m_levels.back().empty()) {
+        return uint256();
+    }
+    return m_levels.back()[0];
+}
+
 CSimplifiedMNListDiff::CSimplifiedMNListDiff() = default;
 
 CSimplifiedMNListDiff::~CSimplifiedMNListDiff() = default;
@@ -296,7 +427,8 @@ CSimplifiedMNListDiff BuildSimplifiedDiff(const CDeterministicMNList& from, cons
         if (fromPtr == nullptr) {
             CSimplifiedMNListEntry sme(toPtr);
             diffRet.mnList.push_back(std::move(sme));
-        } else {
+        } else if (fromPtr->pdmnState != toPtr.pdmnState) {
+            // Masternodes which share their state also share their entry
             CSimplifiedMNListEntry sme1(toPtr);
             CSimplifiedMNListEntry sme2(*fromPtr);
             if ((sme1 != sme2) ||
@@ -383,3 +515,52 @@ bool BuildSimplifiedMNListDiff(const uint256& baseBlockHash, const uint256& bloc
 
     return true;
 }
+
+CMNListResponseCache::Buffer CMNListResponseCache::Get(const uint256& key)
+{
+    LOCK(cs);
+    const auto it = m_entries.find(key);
+    if (it == m_entries.end()) {
+        return nullptr;
+    }
+    m_lru.splice(m_lru.begin(), m_lru, it->second);
+    return it->second->second;
+}
+
+void CMNListResponseCache::Add(const uint256& key, Buffer buffer)
+{
+    assert(buffer != nullptr);
+    LOCK(cs);
+    if (m_entries.count(key)) {
+        return;
+    }
+    m_lru.emplace_front(key, std::move(buffer));
+    m_entries.emplace(key, m_lru.begin());
+    m_usage += m_lru.front().second->size();
+    // Never drop what was just added, even if it alone is above the limit
+    while (m_usage > m_max_usage && m_lru.size() > 1) {
+        m_usage -= m_lru.back().second->size();
+        m_entries.erase(m_lru.back().first);
+        m_lru.pop_back();
+    }
+}
+
+void CMNListResponseCache::Clear()
+{
+    LOCK(cs);
+    m_lru.clear();
+    m_entries.clear();
+    m_usage = 0;
+}
+
+size_t CMNListResponseCache::Size() const
+{
+    LOCK(cs);
+    return m_lru.size();
+}
+
+size_t CMNListResponseCache::DynamicMemoryUsage() const
+{
+    LOCK(cs);
+    return m_usage;
+}
@@ -12,6 +12,12 @@
 #include <netaddress.h>
 #include <pubkey.h>
 
+#include <list>
+#include <memory>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
 class UniValue;
 class CBlockIndex;
 class CDeterministicMNList;
@@ -109,6 +115,38 @@ public:
     bool operator==(const CSimplifiedMNList& rhs) const;
 };
 
+/**
+ * Merkle tree over the SML entries of a masternode list, in the same order and with the same root as
+ * CSimplifiedMNList::CalcMerkleRoot. Moving the tree to another list only rehashes the entries of masternodes
+ * whose state changed and the nodes above them. Adding or removing a masternode shifts all leaves after it, so
+ * nodes to the right of the first added/removed one are rehashed too, but leaves are never rehashed for that.
+ */
+class CSimplifiedMNListMerkleTree
+{
+public:
+    /**
+     * Update the tree to represent mnList and return its merkle root.
+     * *pmutated is set like ComputeMerkleRoot does.
+     */
+    uint256 Update(const CDeterministicMNList& mnList, bool* pmutated = nullptr);
+
+    [[nodiscard]] uint256 GetRoot() const;
+    [[nodiscard]] bool IsMutated() const { return !m_mutated.empty(); }
+    [[nodiscard]] size_t size() const { return m_keys.size(); }
+
+private:
+    void RehashLevels(std::vector<size_t> dirty, size_t dirtyFrom);
+
+    // The list the tree was last updated to, used to find what changed
+    CDeterministicMNList m_list;
+    // proRegTxHashes of the leaves, sorted
+    std::vector<uint256> m_keys;
+    // m_levels[0] are the leaf hashes, every following level is the one below it hashed pairwise
+    std::vector<std::vector<uint256>> m_levels = std::vector<std::vector<uint256>>(1);
+    // (level, index) of nodes whose two children are identical
+    std::set<std::pair<size_t, size_t>> m_mutated;
+};
+
 /// P2P messages
 
 class CGetSimplifiedMNListDiff
@@ -172,4 +210,37 @@ public:
 bool BuildSimplifiedMNListDiff(const uint256& baseBlockHash, const uint256& blockHash, CSimplifiedMNListDiff& mnListDiffRet,
                                const llmq::CQuorumBlockProcessor& quorum_block_processor, std::string& errorRet, bool extended = false);
 
+/**
+ * Serialized mnlistdiff and qrinfo responses. SPV clients keep asking for the very same diffs, this lets all of
+ * them be answered from one buffer instead of building and serializing the diff for every request.
+ *
+ * Keys are chosen by the caller and must cover everything the response depends on, including the protocol version
+ * it was serialized for. Least recently used entries are dropped once the buffers take more than the limit.
+ */
+class CMNListResponseCache
+{
+public:
+    using Buffer = std::shared_ptr<const std::vector<unsigned char>>;
+
+    static constexpr size_t DEFAULT_MAX_USAGE = 32 << 20;
+
+    explicit CMNListResponseCache(size_t nMaxUsage = DEFAULT_MAX_USAGE) : m_max_usage(nMaxUsage) {}
+
+    [[nodiscard]] Buffer Get(const uint256& key) LOCKS_EXCLUDED(cs);
+    void Add(const uint256& key, Buffer buffer) LOCKS_EXCLUDED(cs);
+    void Clear() LOCKS_EXCLUDED(cs);
+
+    [[nodiscard]] size_t Size() const LOCKS_EXCLUDED(cs);
+    [[nodiscard]] size_t DynamicMemoryUsage() const LOCKS_EXCLUDED(cs);
+
+private:
+    using LruList = std::list<std::pair<uint256, Buffer>>;
+
+    mutable Mutex cs;
+    const size_t m_max_usage;
+    LruList m_lru GUARDED_BY(cs);
+    std::unordered_map<uint256, LruList::iterator, StaticSaltedHasher> m_entries GUARDED_BY(cs);
+    size_t m_usage GUARDED_BY(cs){0};
+};
+
 #endif // BITCOIN_EVO_SIMPLIFIEDMNS_H
@@ -11,14 +11,37 @@
 #include <uint256.h>
 #include <version.h>
 
+#include <atomic>
+#include <memory>
 #include <string_view>
 #include <optional>
+#include <type_traits>
 #include <vector>
 
+namespace bls {
+extern std::atomic<bool> bls_legacy_scheme;
+} // namespace bls
+
+/** The payload GetTxPayload decoded from a CTransaction, kept in the transaction */
+struct CachedTxPayloadBase {
+    const void* const type_tag;
+    //! BLS objects which are serialized without a version are decoded with the scheme that is active
+    const bool legacy_scheme;
+};
+
+template <typename T>
+struct CachedTxPayload : CachedTxPayloadBase {
+    static inline const char TYPE_TAG{0};
+    const std::optional<T> payload;
+
+    CachedTxPayload(std::optional<T>&& payload_in, bool legacy_scheme_in) :
+        CachedTxPayloadBase{&TYPE_TAG, legacy_scheme_in}, payload(std::move(payload_in)) {}
+};
+
 template <typename T>
 std::optional<T> GetTxPayload(const std::vector<unsigned char>& payload)
 {
-    CDataStream ds(payload, SER_NETWORK, PROTOCOL_VERSION);
+    SpanReader ds(SER_NETWORK, PROTOCOL_VERSION, payload, 0);
     try {
         T obj;
         ds >> obj;
@@ -32,7 +55,19 @@ std::optional<T> GetTxPayload(const TxType& tx, bool assert_type = true)
 {
     if (assert_type) { ASSERT_IF_DEBUG(tx.nType == T::SPECIALTX_TYPE); }
     if (tx.nType != T::SPECIALTX_TYPE) return std::nullopt;
-    return GetTxPayload<T>(tx.vExtraPayload);
+    if constexpr (std::is_same_v<TxType, CTransaction>) {
+        // A CTransaction doesn't change, so its payload is only decoded once
+        const bool legacy_scheme{bls::bls_legacy_scheme.load()};
+        const auto cache = std::static_pointer_cast<const CachedTxPayloadBase>(tx.GetPayloadCache());
+        if (cache && cache->type_tag == &CachedTxPayload<T>::TYPE_TAG && cache->legacy_scheme == legacy_scheme) {
+            return static_cast<const CachedTxPayload<T>&>(*cache).payload;
+        }
+        auto entry = std::make_shared<const CachedTxPayload<T>>(GetTxPayload<T>(tx.vExtraPayload), legacy_scheme);
+        tx.SetPayloadCache(std::static_pointer_cast<const CachedTxPayloadBase>(entry));
+        return entry->payload;
+    } else {
+        return GetTxPayload<T>(tx.vExtraPayload);
+    }
 }
 
 template <typename T>
@@ -5,6 +5,7 @@
 #include <evo/specialtxman.h>
 
 #include <chainparams.h>
+#include <checkqueue.h>
 #include <consensus/validation.h>
 #include <deploymentstatus.h>
 #include <evo/cbtx.h>
@@ -17,9 +18,11 @@
 #include <llmq/blockprocessor.h>
 #include <llmq/commitment.h>
 #include <primitives/block.h>
+#include <util/trace.h>
 #include <validation.h>
 
-static bool CheckSpecialTxInner(const CTransaction& tx, const CBlockIndex* pindexPrev, const CCoinsViewCache& view, const std::optional<CRangesSet>& indexes, bool check_sigs, TxValidationState& state)
+static bool CheckSpecialTxInner(const CTransaction& tx, const CBlockIndex* pindexPrev, const CCoinsViewCache& view, const std::optional<CRangesSet>& indexes, bool check_sigs,
+                                std::vector<CProTxSigCheck>* sig_checks, TxValidationState& state)
 {
     AssertLockHeld(cs_main);
 
@@ -34,13 +37,13 @@ static bool CheckSpecialTxInner(const CTransaction& tx, const CBlockIndex* pinde
     try {
         switch (tx.nType) {
         case TRANSACTION_PROVIDER_REGISTER:
-            return CheckProRegTx(tx, pindexPrev, state, view, check_sigs);
+            return CheckProRegTx(tx, pindexPrev, state, view, check_sigs, sig_checks);
         case TRANSACTION_PROVIDER_UPDATE_SERVICE:
-            return CheckProUpServTx(tx, pindexPrev, state, check_sigs);
+            return CheckProUpServTx(tx, pindexPrev, state, check_sigs, sig_checks);
         case TRANSACTION_PROVIDER_UPDATE_REGISTRAR:
-            return CheckProUpRegTx(tx, pindexPrev, state, view, check_sigs);
+            return CheckProUpRegTx(tx, pindexPrev, state, view, check_sigs, sig_checks);
         case TRANSACTION_PROVIDER_UPDATE_REVOKE:
-            return CheckProUpRevTx(tx, pindexPrev, state, check_sigs);
+            return CheckProUpRevTx(tx, pindexPrev, state, check_sigs, sig_checks);
         case TRANSACTION_COINBASE:
             return CheckCbTx(tx, pindexPrev, state);
         case TRANSACTION_QUORUM_COMMITMENT:
@@ -76,7 +79,7 @@ static bool CheckSpecialTxInner(const CTransaction& tx, const CBlockIndex* pinde
 bool CheckSpecialTx(const CTransaction& tx, const CBlockIndex* pindexPrev, const CCoinsViewCache& view, bool check_sigs, TxValidationState& state)
 {
     AssertLockHeld(cs_main);
-    return CheckSpecialTxInner(tx, pindexPrev, view, std::nullopt, check_sigs, state);
+    return CheckSpecialTxInner(tx, pindexPrev, view, std::nullopt, check_sigs, nullptr, state);
 }
 
 static bool ProcessSpecialTx(const CTransaction& tx, const CBlockIndex* pindex, TxValidationState& state)
@@ -134,7 +137,8 @@ static bool UndoSpecialTx(const CTransaction& tx, const CBlockIndex* pindex)
 bool ProcessSpecialTxsInBlock(const CBlock& block, const CBlockIndex* pindex, CMNHFManager& mnhfManager,
                               llmq::CQuorumBlockProcessor& quorum_block_processor, const llmq::CChainLocksHandler& chainlock_handler,
                               const Consensus::Params& consensusParams, const CCoinsViewCache& view, bool fJustCheck, bool fCheckCbTxMerleRoots,
-                              BlockValidationState& state, std::optional<MNListUpdates>& updatesRet)
+                              BlockValidationState& state, std::optional<MNListUpdates>& updatesRet,
+                              CCheckQueueControl<CProTxSigCheck>* sig_check_control)
 {
     AssertLockHeld(cs_main);
 
@@ -153,11 +157,15 @@ bool ProcessSpecialTxsInBlock(const CBlock& block, const CBlockIndex* pindex, CM
             LogPrint(BCLog::CREDITPOOL, "%s: CCreditPool is %s\n", __func__, creditPool.ToString());
         }
 
+        // Payload signatures are the expensive part of checking ProTxs and don't depend on anything else in the block,
+        // let the check queue verify them while the block is processed further
+        std::vector<CProTxSigCheck> sig_checks;
+        auto* const p_sig_checks = sig_check_control != nullptr ? &sig_checks : nullptr;
         for (const auto& ptr_tx : block.vtx) {
             TxValidationState tx_state;
             // At this moment CheckSpecialTx() and ProcessSpecialTx() may fail by 2 possible ways:
             // consensus failures and "TX_BAD_SPECIAL"
-            if (!CheckSpecialTxInner(*ptr_tx, pindex->pprev, view, creditPool.indexes, fCheckCbTxMerleRoots, tx_state)) {
+            if (!CheckSpecialTxInner(*ptr_tx, pindex->pprev, view, creditPool.indexes, fCheckCbTxMerleRoots, p_sig_checks, tx_state)) {
                 assert(tx_state.GetResult() == TxValidationResult::TX_CONSENSUS || tx_state.GetResult() == TxValidationResult::TX_BAD_SPECIAL);
                 return state.Invalid(BlockValidationResult::BLOCK_CONSENSUS, tx_state.GetRejectReason(),
                                  strprintf("Special Transaction check failed (tx hash %s) %s", ptr_tx->GetHash().ToString(), tx_state.GetDebugMessage()));
@@ -169,6 +177,10 @@ bool ProcessSpecialTxsInBlock(const CBlock& block, const CBlockIndex* pindex, CM
             }
         }
 
+        if (sig_check_control != nullptr) {
+            sig_check_control->Add(sig_checks);
+        }
+
         int64_t nTime2 = GetTimeMicros();
         nTimeLoop += nTime2 - nTime1;
         LogPrint(BCLog::BENCHMARK, "        - Loop: %.2fms [%.2fs]\n", 0.001 * (nTime2 - nTime1), nTimeLoop * 0.000001);
@@ -218,6 +230,16 @@ bool ProcessSpecialTxsInBlock(const CBlock& block, const CBlockIndex* pindex, CM
         nTimeMnehf += nTime7 - nTime6;
         LogPrint(BCLog::BENCHMARK, "        - mnhfManager: %.2fms [%.2fs]\n", 0.001 * (nTime7 - nTime6), nTimeMnehf * 0.000001);
 
+        TRACE8(validation, special_txs_processed,
+            pindex->GetBlockHash().data(),
+            pindex->nHeight,
+            nTime2 - nTime1,
+            nTime3 - nTime2,
+            nTime4 - nTime3,
+            nTime5 - nTime4,
+            nTime6 - nTime5,
+            nTime7 - nTime6);
+
         if (Params().GetConsensus().V19Height == pindex->nHeight + 1) {
             // NOTE: The block next to the activation is the one that is using new rules.
             // V19 activated just activated, so we must switch to the new rules here.
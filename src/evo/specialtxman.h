@@ -16,8 +16,11 @@ class CBlock;
 class CBlockIndex;
 class CCoinsViewCache;
 class CMNHFManager;
+class CProTxSigCheck;
 class TxValidationState;
 struct MNListUpdates;
+template <typename T>
+class CCheckQueueControl;
 namespace llmq {
 class CQuorumBlockProcessor;
 class CChainLocksHandler;
@@ -33,7 +36,8 @@ bool CheckSpecialTx(const CTransaction& tx, const CBlockIndex* pindexPrev, const
 bool ProcessSpecialTxsInBlock(const CBlock& block, const CBlockIndex* pindex, CMNHFManager& mnhfManager,
                               llmq::CQuorumBlockProcessor& quorum_block_processor, const llmq::CChainLocksHandler& chainlock_handler,
                               const Consensus::Params& consensusParams, const CCoinsViewCache& view, bool fJustCheck, bool fCheckCbTxMerleRoots,
-                              BlockValidationState& state, std::optional<MNListUpdates>& updatesRet) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+                              BlockValidationState& state, std::optional<MNListUpdates>& updatesRet,
+                              CCheckQueueControl<CProTxSigCheck>* sig_check_control = nullptr) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 bool UndoSpecialTxsInBlock(const CBlock& block, const CBlockIndex* pindex, CMNHFManager& mnhfManager,
                            llmq::CQuorumBlockProcessor& quorum_block_processor, std::optional<MNListUpdates>& updatesRet) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 bool CheckCreditPoolDiffForBlock(const CBlock& block, const CBlockIndex* pindex, const Consensus::Params& consensusParams,
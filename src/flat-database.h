@@ -91,13 +91,14 @@ private:
         // Don't try to resize to a negative number if file is small
         if (dataSize < 0)
             dataSize = 0;
-        std::vector<unsigned char> vchData;
-        vchData.resize(dataSize);
+        // read straight into the stream which is deserialized from, no need for another copy of the data
+        CDataStream ssObj(SER_DISK, CLIENT_VERSION);
+        ssObj.resize(dataSize);
         uint256 hashIn;
 
         // read data and checksum from file
         try {
-            filein.read(MakeWritableByteSpan(vchData));
+            filein.read(MakeWritableByteSpan(ssObj));
             filein >> hashIn;
         }
         catch (std::exception &e) {
@@ -106,8 +107,6 @@ private:
         }
         filein.fclose();
 
-        CDataStream ssObj(vchData, SER_DISK, CLIENT_VERSION);
-
         // verify stored checksum matches input data
         uint256 hashTmp = Hash(ssObj);
         if (hashIn != hashTmp)
@@ -85,9 +85,14 @@ public:
      *
      * @param[in] pos The first unwritten position in the file to be flushed.
      * @param[in] finalize True if no more data will be written to this file.
+     * @param[in] commit_dir False if the caller commits the directory itself, e.g. once for
+     *                       several files flushed together.
      * @return true on success, false on failure.
      */
-    bool Flush(const FlatFilePos& pos, bool finalize = false);
+    bool Flush(const FlatFilePos& pos, bool finalize = false, bool commit_dir = true);
+
+    /** Commit the directory of the sequence to disk, so that new files are durable. */
+    void CommitDirectory() const;
 };
 
 #endif // BITCOIN_FLATFILE_H
@@ -8,6 +8,7 @@
 #include <consensus/validation.h>
 #include <core_io.h>
 #include <deploymentstatus.h>
+#include <evo/deterministicmns.h>
 #include <governance/governance.h>
 #include <key_io.h>
 #include <primitives/transaction.h>
@@ -127,6 +128,7 @@ bool CGovernanceTriggerManager::AddNewTrigger(uint256 nHash)
     pSuperblock->SetStatus(SeenObjectStatus::Valid);
 
     mapTrigger.insert(std::make_pair(nHash, pSuperblock));
+    InvalidateSuperblockCache();
 
     return !pSuperblock->IsExpired(*governance);
 }
@@ -192,6 +194,7 @@ void CGovernanceTriggerManager::CleanAndRemove()
             LogPrint(BCLog::GOBJECT, "CGovernanceTriggerManager::CleanAndRemove -- Removing trigger object %s\n", strDataAsPlainString);
             // delete the trigger
             mapTrigger.erase(it++);
+            InvalidateSuperblockCache();
         } else {
             ++it;
         }
@@ -221,44 +224,47 @@ std::vector<CSuperblock_sptr> CGovernanceTriggerManager::GetActiveTriggers()
     return vecResults;
 }
 
-/**
-*   Is Superblock Triggered
-*
-*   - Does this block have a non-executed and activated trigger?
-*/
+void CGovernanceTriggerManager::InvalidateSuperblockCache()
+{
+    AssertLockHeld(governance->cs);
+    superblockCache.reset();
+}
 
-bool CSuperblockManager::IsSuperblockTriggered(CGovernanceManager& governanceManager, int nBlockHeight)
+CGovernanceTriggerManager::SuperblockCache CSuperblockManager::GetSuperblockCache(CGovernanceManager& governanceManager, int nBlockHeight)
 {
-    LogPrint(BCLog::GOBJECT, "CSuperblockManager::IsSuperblockTriggered -- Start nBlockHeight = %d\n", nBlockHeight);
-    if (!CSuperblock::IsValidBlockHeight(nBlockHeight)) {
-        return false;
+    AssertLockHeld(governanceManager.cs);
+
+    // Block creation and both payment checks of ConnectBlock ask for the same height, the votes and the funding
+    // flags only change with the governance data and the MN list at the tip
+    const uint256 mnListHash = deterministicMNManager->GetListAtChainTip().GetBlockHash();
+    auto& cache = triggerman.superblockCache;
+    if (cache && cache->nBlockHeight == nBlockHeight && cache->mnListHash == mnListHash) {
+        return *cache;
     }
 
-    LOCK(governanceManager.cs);
+    cache = CGovernanceTriggerManager::SuperblockCache{nBlockHeight, mnListHash, false, nullptr};
+    int nYesCount = 0;
+
     // GET ALL ACTIVE TRIGGERS
     std::vector<CSuperblock_sptr> vecTriggers = triggerman.GetActiveTriggers();
 
-    LogPrint(BCLog::GOBJECT, "CSuperblockManager::IsSuperblockTriggered -- vecTriggers.size() = %d\n", vecTriggers.size());
+    LogPrint(BCLog::GOBJECT, "CSuperblockManager::GetSuperblockCache -- vecTriggers.size() = %d\n", vecTriggers.size());
 
     for (const auto& pSuperblock : vecTriggers) {
         if (!pSuperblock) {
-            LogPrintf("CSuperblockManager::IsSuperblockTriggered -- Non-superblock found, continuing\n");
+            LogPrintf("CSuperblockManager::GetSuperblockCache -- Non-superblock found, continuing\n");
             continue;
         }
 
         CGovernanceObject* pObj = pSuperblock->GetGovernanceObject(governanceManager);
 
         if (!pObj) {
-            LogPrintf("CSuperblockManager::IsSuperblockTriggered -- pObj == nullptr, continuing\n");
+            LogPrintf("CSuperblockManager::GetSuperblockCache -- pObj == nullptr, continuing\n");
             continue;
         }
 
-        LogPrint(BCLog::GOBJECT, "CSuperblockManager::IsSuperblockTriggered -- data = %s\n", pObj->GetDataAsPlainString());
-
-        // note : 12.1 - is epoch calculation correct?
-
         if (nBlockHeight != pSuperblock->GetBlockHeight()) {
-            LogPrint(BCLog::GOBJECT, "CSuperblockManager::IsSuperblockTriggered -- block height doesn't match nBlockHeight = %d, blockStart = %d, continuing\n",
+            LogPrint(BCLog::GOBJECT, "CSuperblockManager::GetSuperblockCache -- block height doesn't match nBlockHeight = %d, blockStart = %d, continuing\n",
                 nBlockHeight,
                 pSuperblock->GetBlockHeight());
             continue;
@@ -266,51 +272,55 @@ bool CSuperblockManager::IsSuperblockTriggered(CGovernanceManager& governanceMan
 
         // MAKE SURE THIS TRIGGER IS ACTIVE VIA FUNDING CACHE FLAG
 
-        pObj->UpdateSentinelVariables();
+        if (!cache->fTriggered) {
+            pObj->UpdateSentinelVariables();
+            cache->fTriggered = pObj->IsSetCachedFunding();
+            LogPrint(BCLog::GOBJECT, "CSuperblockManager::GetSuperblockCache -- data = %s, fCacheFunding = %d\n", pObj->GetDataAsPlainString(), cache->fTriggered);
+        }
+
+        // DO WE HAVE A NEW WINNER?
 
-        if (pObj->IsSetCachedFunding()) {
-            LogPrint(BCLog::GOBJECT, "CSuperblockManager::IsSuperblockTriggered -- fCacheFunding = true, returning true\n");
-            return true;
-        } else {
-            LogPrint(BCLog::GOBJECT, "CSuperblockManager::IsSuperblockTriggered -- fCacheFunding = false, continuing\n");
+        int nTempYesCount = pObj->GetAbsoluteYesCount(VOTE_SIGNAL_FUNDING);
+        if (nTempYesCount > nYesCount) {
+            nYesCount = nTempYesCount;
+            cache->pBest = pSuperblock;
         }
     }
 
-    return false;
+    return *cache;
 }
 
+/**
+*   Is Superblock Triggered
+*
+*   - Does this block have a non-executed and activated trigger?
+*/
 
-bool CSuperblockManager::GetBestSuperblock(CGovernanceManager& governanceManager, CSuperblock_sptr& pSuperblockRet, int nBlockHeight)
+bool CSuperblockManager::IsSuperblockTriggered(CGovernanceManager& governanceManager, int nBlockHeight)
 {
+    LogPrint(BCLog::GOBJECT, "CSuperblockManager::IsSuperblockTriggered -- Start nBlockHeight = %d\n", nBlockHeight);
     if (!CSuperblock::IsValidBlockHeight(nBlockHeight)) {
         return false;
     }
 
-    AssertLockHeld(governanceManager.cs);
-    std::vector<CSuperblock_sptr> vecTriggers = triggerman.GetActiveTriggers();
-    int nYesCount = 0;
-
-    for (const auto& pSuperblock : vecTriggers) {
-        if (!pSuperblock || nBlockHeight != pSuperblock->GetBlockHeight()) {
-            continue;
-        }
-
-        const CGovernanceObject* pObj = pSuperblock->GetGovernanceObject(governanceManager);
-
-        if (!pObj) {
-            continue;
-        }
+    LOCK(governanceManager.cs);
+    return GetSuperblockCache(governanceManager, nBlockHeight).fTriggered;
+}
 
-        // DO WE HAVE A NEW WINNER?
 
-        int nTempYesCount = pObj->GetAbsoluteYesCount(VOTE_SIGNAL_FUNDING);
-        if (nTempYesCount > nYesCount) {
-            nYesCount = nTempYesCount;
-            pSuperblockRet = pSuperblock;
-        }
+bool CSuperblockManager::GetBestSuperblock(CGovernanceManager& governanceManager, CSuperblock_sptr& pSuperblockRet, int nBlockHeight)
+{
+    if (!CSuperblock::IsValidBlockHeight(nBlockHeight)) {
+        return false;
     }
 
-    return nYesCount > 0;
+    AssertLockHeld(governanceManager.cs);
+    auto pBest = GetSuperblockCache(governanceManager, nBlockHeight).pBest;
+    if (pBest == nullptr) {
+        return false;
+    }
+    pSuperblockRet = std::move(pBest);
+    return true;
 }
 
 /**
@@ -387,6 +397,7 @@ void CSuperblockManager::ExecuteBestSuperblock(CGovernanceManager& governanceMan
         // All checks are done in CSuperblock::IsValid via IsBlockValueValid and IsBlockPayeeValid,
         // tip wouldn't be updated if anything was wrong. Mark this trigger as executed.
         pSuperblock->SetExecuted();
+        triggerman.InvalidateSuperblockCache();
         governanceManager.ResetVotedFundingTrigger();
     }
 }
@@ -420,7 +431,11 @@ CSuperblock::
         throw std::runtime_error("CSuperblock: Governance Object not a trigger");
     }
 
-    UniValue obj = pGovObj->GetJSONObject();
+    const auto payload = pGovObj->GetPayload();
+    if (!payload->fJSONValid) {
+        throw std::runtime_error(payload->strJSONError);
+    }
+    const UniValue& obj = payload->objJSON;
 
     if (obj["type"].get_int() != ToUnderlying(GovernanceObject::TRIGGER)) {
         throw std::runtime_error("CSuperblock: invalid data type");
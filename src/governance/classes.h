@@ -10,6 +10,8 @@
 #include <script/standard.h>
 #include <uint256.h>
 
+#include <optional>
+
 class CTxOut;
 class CTransaction;
 
@@ -38,7 +40,16 @@ class CGovernanceTriggerManager
     friend class CGovernanceManager;
 
 private:
+    /** What IsSuperblockTriggered and GetBestSuperblock found for a height, with the MN list the votes were counted against */
+    struct SuperblockCache {
+        int nBlockHeight;
+        uint256 mnListHash;
+        bool fTriggered;
+        CSuperblock_sptr pBest;
+    };
+
     std::map<uint256, CSuperblock_sptr> mapTrigger;
+    std::optional<SuperblockCache> superblockCache;
 
     std::vector<CSuperblock_sptr> GetActiveTriggers();
     bool AddNewTrigger(uint256 nHash);
@@ -47,6 +58,9 @@ private:
 public:
     CGovernanceTriggerManager() :
         mapTrigger() {}
+
+    /** Must be called with governance->cs held whenever governance objects or their votes change */
+    void InvalidateSuperblockCache();
 };
 
 /**
@@ -58,6 +72,8 @@ public:
 class CSuperblockManager
 {
 private:
+    /** Scan the triggers for nBlockHeight once per state of the governance data and the MN list */
+    static CGovernanceTriggerManager::SuperblockCache GetSuperblockCache(CGovernanceManager& governanceManager, int nBlockHeight);
     static bool GetBestSuperblock(CGovernanceManager& governanceManager, CSuperblock_sptr& pSuperblockRet, int nBlockHeight);
 
 public:
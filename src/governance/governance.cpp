@@ -5,31 +5,36 @@
 #include <governance/governance.h>
 
 #include <bloom.h>
+#include <bls/bls_batchverifier.h>
 #include <chain.h>
 #include <chainparams.h>
 #include <consensus/validation.h>
+#include <cxxtimer.hpp>
 #include <deploymentstatus.h>
 #include <evo/deterministicmns.h>
 #include <flat-database.h>
 #include <governance/classes.h>
 #include <governance/common.h>
-#include <governance/validators.h>
+#include <governance/governancedb.h>
 #include <masternode/meta.h>
 #include <masternode/node.h>
 #include <masternode/sync.h>
+#include <net_processing.h>
 #include <netfulfilledman.h>
 #include <netmessagemaker.h>
 #include <protocol.h>
 #include <shutdown.h>
 #include <spork.h>
 #include <util/time.h>
+#include <util/trace.h>
 #include <validation.h>
 
 std::unique_ptr<CGovernanceManager> governance;
 
 int nSubmittedFinalBudget;
 
-const std::string GovernanceStore::SERIALIZATION_VERSION_STRING = "CGovernanceManager-Version-16";
+const std::string GovernanceStore::SERIALIZATION_VERSION_STRING = "CGovernanceManager-Version-17";
+const std::string GovernanceStore::SERIALIZATION_VERSION_STRING_FLATDB = "CGovernanceManager-Version-16";
 const int CGovernanceManager::MAX_TIME_FUTURE_DEVIATION = 60 * 60;
 const int CGovernanceManager::RELIABLE_PROPAGATION_TIME = 60;
 
@@ -46,7 +51,6 @@ GovernanceStore::GovernanceStore() :
 }
 
 CGovernanceManager::CGovernanceManager() :
-    m_db{std::make_unique<db_type>("governance.dat", "magicGovernanceCache")},
     nTimeLastDiff(0),
     nCachedBlockHeight(0),
     setRequestedObjects(),
@@ -58,20 +62,100 @@ CGovernanceManager::CGovernanceManager() :
 CGovernanceManager::~CGovernanceManager()
 {
     if (!is_valid) return;
-    m_db->Store(*this);
+    Flush(true);
 }
 
 bool CGovernanceManager::LoadCache(bool load_cache)
 {
-    assert(m_db != nullptr);
-    is_valid = load_cache ? m_db->Load(*this) : m_db->Store(*this);
-    if (is_valid && load_cache) {
+    m_db = std::make_unique<CGovernanceDb>(false, !load_cache);
+    if (!load_cache) {
+        // make sure an old governance.dat doesn't get migrated later
+        fs::remove(GetDataDir() / "governance.dat");
+        is_valid = true;
+        return is_valid;
+    }
+
+    int64_t nStart = GetTimeMillis();
+    if (m_db->IsEmpty()) {
+        is_valid = MigrateFlatDB();
+    } else {
+        LOCK(cs);
+        // objects are read after the store, reading the store clears them
+        is_valid = m_db->ReadStore(*this) && m_db->ReadObjects(mapObjects);
+        for (auto& [_, govobj] : mapObjects) {
+            govobj.ClearDirtyDisk();
+        }
+        if (!m_db->ReadSyncedTime(nTimeLastSynced)) {
+            nTimeLastSynced = 0;
+        }
+    }
+    if (is_valid) {
+        LogPrintf("Loaded governance db  %dms\n", GetTimeMillis() - nStart);
         CheckAndRemove();
         InitOnLoad();
     }
     return is_valid;
 }
 
+bool CGovernanceManager::MigrateFlatDB()
+{
+    const fs::path path = GetDataDir() / "governance.dat";
+    if (!fs::exists(path)) {
+        return true;
+    }
+
+    CFlatDB<GovernanceStore> flatdb("governance.dat", "magicGovernanceCache");
+    if (!flatdb.Load(*this)) {
+        return false;
+    }
+
+    // all freshly loaded objects are dirty, so they all end up in the db
+    if (!Flush(true)) {
+        return false;
+    }
+    LogPrintf("Moved governance objects from %s to the governance db\n", path.string());
+    fs::remove(path);
+    return true;
+}
+
+bool CGovernanceManager::Flush(bool fSync)
+{
+    if (!m_db) return false;
+
+    LOCK(cs);
+    int64_t nStart = GetTimeMillis();
+
+    if (::masternodeSync != nullptr && ::masternodeSync->IsSynced()) {
+        nTimeLastSynced = GetTime();
+    }
+
+    std::vector<const CGovernanceObject*> updatedObjects;
+    for (const auto& [_, govobj] : mapObjects) {
+        if (govobj.IsSetDirtyDisk()) {
+            updatedObjects.emplace_back(&govobj);
+        }
+    }
+
+    if (!m_db->Write(*this, updatedObjects, setObjectsToErase, nTimeLastSynced, fSync)) {
+        return false;
+    }
+
+    for (auto& [_, govobj] : mapObjects) {
+        govobj.ClearDirtyDisk();
+    }
+    LogPrint(BCLog::GOBJECT, "CGovernanceManager::%s -- wrote %d objects, erased %d  %dms\n", __func__,
+             updatedObjects.size(), setObjectsToErase.size(), GetTimeMillis() - nStart);
+    setObjectsToErase.clear();
+    return true;
+}
+
+bool CGovernanceManager::IsSyncedWithin(int64_t nSeconds) const
+{
+    LOCK(cs);
+    const int64_t nNow = GetTime();
+    return nTimeLastSynced != 0 && nTimeLastSynced <= nNow && nNow - nTimeLastSynced <= nSeconds;
+}
+
 // Accessors for thread-safe access to maps
 bool CGovernanceManager::HaveObjectForHash(const uint256& nHash) const
 {
@@ -238,20 +322,121 @@ PeerMsgRet CGovernanceManager::ProcessMessage(CNode& peer, CConnman& connman, st
             return {};
         }
 
-        CGovernanceException exception;
-        if (ProcessVote(&peer, vote, exception, connman)) {
-            LogPrint(BCLog::GOBJECT, "MNGOVERNANCEOBJECTVOTE -- %s new\n", strHash);
-            ::masternodeSync->BumpAssetLastTime("MNGOVERNANCEOBJECTVOTE");
-            vote.Relay(connman);
-        } else {
-            LogPrint(BCLog::GOBJECT, "MNGOVERNANCEOBJECTVOTE -- Rejected vote, error = %s\n", exception.what());
-            if ((exception.GetNodePenalty() != 0) && ::masternodeSync->IsSynced()) {
-                return tl::unexpected{exception.GetNodePenalty()};
+        // verified in batches and applied by ProcessPendingVotes
+        LOCK(cs_pendingVotes);
+        pendingVotes.emplace_back(peer.GetId(), vote);
+    }
+    return {};
+}
+
+void CGovernanceManager::ProcessPendingVotes(CConnman& connman, PeerManager& peerman, CBLSWorker* blsWorker)
+{
+    while (true) {
+        std::vector<std::pair<NodeId, CGovernanceVote>> votes;
+        {
+            LOCK(cs_pendingVotes);
+            if (pendingVotes.empty()) {
+                return;
+            }
+            votes.reserve(std::min(pendingVotes.size(), MAX_VOTES_PER_BATCH));
+            while (!pendingVotes.empty() && votes.size() < MAX_VOTES_PER_BATCH) {
+                votes.emplace_back(std::move(pendingVotes.front()));
+                pendingVotes.pop_front();
+            }
+        }
+
+        cxxtimer::Timer verifyTimer(true);
+
+        // Which key each vote must be signed with. Votes for unknown objects are only kept as orphans and votes we've
+        // seen already are rejected anyway, so these need no verification
+        std::vector<std::optional<bool>> useVotingKey(votes.size());
+        std::set<std::pair<NodeId, uint256>> orphanParents;
+        {
+            LOCK(cs);
+            for (size_t i = 0; i < votes.size(); i++) {
+                const auto& [from, vote] = votes[i];
+                const uint256 nHashVote = vote.GetHash();
+                if (cmapVoteToObject.HasKey(nHashVote) || cmapInvalidVotes.HasKey(nHashVote)) {
+                    continue;
+                }
+                const auto it = mapObjects.find(vote.GetParentHash());
+                if (it == mapObjects.end()) {
+                    orphanParents.emplace(from, vote.GetParentHash());
+                    continue;
+                }
+                useVotingKey[i] = it->second.GetObjectType() == GovernanceObject::PROPOSAL && vote.GetSignal() == VOTE_SIGNAL_FUNDING;
             }
-            return {};
         }
+
+        const auto mnList = deterministicMNManager->GetListAtChainTip();
+        CBLSBatchVerifier<NodeId, uint256> batchVerifier(true, true, 0, blsWorker);
+        std::vector<bool> verified(votes.size(), false);
+        std::vector<bool> blsPushed(votes.size(), false);
+        for (size_t i = 0; i < votes.size(); i++) {
+            if (!useVotingKey[i]) {
+                continue;
+            }
+            const auto& [from, vote] = votes[i];
+            const auto dmn = mnList.GetMNByCollateral(vote.GetMasternodeOutpoint());
+            if (!dmn) {
+                continue;
+            }
+            if (*useVotingKey[i]) {
+                verified[i] = vote.CheckSignature(dmn->pdmnState->keyIDVoting);
+                continue;
+            }
+            CBLSSignature sig;
+            sig.SetByteVector(vote.GetSignature(), false);
+            const CBLSPublicKey pubKey = dmn->pdmnState->pubKeyOperator.Get();
+            if (!sig.IsValid() || !pubKey.IsValid()) {
+                continue;
+            }
+            batchVerifier.PushMessage(from, vote.GetHash(), vote.GetSignatureHash(), sig, pubKey);
+            blsPushed[i] = true;
+        }
+        batchVerifier.Verify();
+        for (size_t i = 0; i < votes.size(); i++) {
+            if (blsPushed[i] && !batchVerifier.badMessages.count(votes[i].second.GetHash())) {
+                verified[i] = true;
+            }
+        }
+        verifyTimer.stop();
+
+        // Keys could have changed in the meantime, in which case ProcessVote has to check the signatures again
+        const bool fKeysUnchanged = deterministicMNManager->GetListAtChainTip().GetBlockHash() == mnList.GetBlockHash();
+
+        size_t nAccepted{0};
+        for (size_t i = 0; i < votes.size(); i++) {
+            const auto& [from, vote] = votes[i];
+            CGovernanceException exception;
+            if (ProcessVote(nullptr, vote, exception, connman, fKeysUnchanged && verified[i])) {
+                LogPrint(BCLog::GOBJECT, "MNGOVERNANCEOBJECTVOTE -- %s new\n", vote.GetHash().ToString());
+                ::masternodeSync->BumpAssetLastTime("MNGOVERNANCEOBJECTVOTE");
+                vote.Relay(connman);
+                nAccepted++;
+            } else {
+                LogPrint(BCLog::GOBJECT, "MNGOVERNANCEOBJECTVOTE -- Rejected vote, error = %s\n", exception.what());
+                if ((exception.GetNodePenalty() != 0) && ::masternodeSync->IsSynced()) {
+                    peerman.Misbehaving(from, exception.GetNodePenalty());
+                }
+            }
+        }
+
+        for (const auto& [from, nHash] : orphanParents) {
+            connman.ForNode(from, CConnman::AllNodes, [&](CNode* pnode) {
+                RequestGovernanceObject(pnode, nHash, connman);
+                return true;
+            });
+        }
+
+        LogPrint(BCLog::GOBJECT, "CGovernanceManager::%s -- verified %d BLS and %d ECDSA signatures in %dms, accepted %d of %d votes\n", __func__,
+                 std::count(blsPushed.begin(), blsPushed.end(), true), std::count_if(useVotingKey.begin(), useVotingKey.end(), [](const auto& v) { return v.value_or(false); }),
+                 verifyTimer.count(), nAccepted, votes.size());
+        TRACE3(governance, votes_processed,
+            votes.size(),
+            nAccepted,
+            verifyTimer.count<std::chrono::microseconds>());
     }
-    return {};
 }
 
 void CGovernanceManager::CheckOrphanVotes(CGovernanceObject& govobj, CConnman& connman)
@@ -270,6 +455,7 @@ void CGovernanceManager::CheckOrphanVotes(CGovernanceObject& govobj, CConnman& c
         if (pairVote.second < nNow) {
             fRemove = true;
         } else if (govobj.ProcessVote(vote, e)) {
+            triggerman.InvalidateSuperblockCache();
             vote.Relay(connman);
             fRemove = true;
         }
@@ -301,6 +487,9 @@ void CGovernanceManager::AddGovernanceObject(CGovernanceObject& govobj, CConnman
     LogPrint(BCLog::GOBJECT, "CGovernanceManager::AddGovernanceObject -- Adding object: hash = %s, type = %d\n", nHash.ToString(),
              ToUnderlying(govobj.GetObjectType()));
 
+    // DECODE THE DATA NOW, THE COPY IN mapObjects SHARES IT
+    govobj.GetPayload();
+
     // INSERT INTO OUR GOVERNANCE OBJECT MEMORY
     // IF WE HAVE THIS OBJECT ALREADY, WE DON'T WANT ANOTHER COPY
     auto objpair = mapObjects.emplace(nHash, govobj);
@@ -309,6 +498,7 @@ void CGovernanceManager::AddGovernanceObject(CGovernanceObject& govobj, CConnman
         LogPrint(BCLog::GOBJECT, "CGovernanceManager::AddGovernanceObject -- already have governance object %s\n", nHash.ToString());
         return;
     }
+    triggerman.InvalidateSuperblockCache();
 
     // SHOULD WE ADD THIS OBJECT TO ANY OTHER MANAGERS?
 
@@ -322,6 +512,10 @@ void CGovernanceManager::AddGovernanceObject(CGovernanceObject& govobj, CConnman
     }
 
     LogPrint(BCLog::GOBJECT, "CGovernanceManager::AddGovernanceObject -- %s new, received from peer %s\n", strHash, pfrom ? pfrom->GetLogString() : "nullptr");
+    TRACE3(governance, object_accepted,
+        nHash.data(),
+        ToUnderlying(govobj.GetObjectType()),
+        pfrom ? pfrom->GetId() : -1);
     govobj.Relay(connman);
 
     // Update the rate buffer
@@ -348,6 +542,9 @@ void CGovernanceManager::UpdateCachesAndClean()
 
     LOCK2(cs_main, cs);
 
+    // votes are cleared, sentinel variables updated and objects erased below
+    triggerman.InvalidateSuperblockCache();
+
     for (const uint256& nHash : vecDirtyHashes) {
         auto it = mapObjects.find(nHash);
         if (it == mapObjects.end()) {
@@ -415,12 +612,13 @@ void CGovernanceManager::UpdateCachesAndClean()
             }
 
             mapErasedGovernanceObjects.insert(std::make_pair(nHash, nTimeExpired));
+            setObjectsToErase.insert(nHash);
             mapObjects.erase(it++);
         } else {
             // NOTE: triggers are handled via triggerman
             if (pObj->GetObjectType() == GovernanceObject::PROPOSAL) {
-                CProposalValidator validator(pObj->GetDataAsHexString());
-                if (!validator.Validate()) {
+                std::string strValidatorErrors;
+                if (!pObj->ValidateProposal(true, true, strValidatorErrors)) {
                     LogPrint(BCLog::GOBJECT, "CGovernanceManager::UpdateCachesAndClean -- set for deletion expired obj %s\n", strHash);
                     pObj->PrepareDeletion(nNow);
                 }
@@ -478,6 +676,8 @@ void CGovernanceManager::DeleteGovernanceObject(const uint256& nHash)
 
     if (mapObjects.count(nHash)) {
         mapObjects.erase(nHash);
+        setObjectsToErase.insert(nHash);
+        triggerman.InvalidateSuperblockCache();
     }
 }
 
@@ -604,7 +804,8 @@ std::optional<const CSuperblock> CGovernanceManager::CreateSuperblockCandidate(i
     CAmount budgetAllocated{};
     for (const auto& proposal : approvedProposals) {
         // Extract payment address and amount from proposal
-        UniValue jproposal = proposal->GetJSONObject();
+        const auto payload = proposal->GetPayload();
+        const UniValue& jproposal = payload->objJSON;
 
         CTxDestination dest = DecodeDestination(jproposal["payment_address"].getValStr());
         if (!IsValidDestination(dest)) continue;
@@ -782,6 +983,10 @@ void CGovernanceManager::ResetVotedFundingTrigger()
 void CGovernanceManager::DoMaintenance(CConnman& connman)
 {
     if (fDisableGovernance) return;
+
+    // write out what changed since the last run, also while still syncing
+    Flush();
+
     if (::masternodeSync == nullptr || !::masternodeSync->IsSynced()) return;
     if (ShutdownRequested()) return;
 
@@ -883,7 +1088,10 @@ void CGovernanceManager::SyncSingleObjVotes(CNode& peer, const uint256& nProp, c
 
         bool onlyVotingKeyAllowed = govobj.GetObjectType() == GovernanceObject::PROPOSAL && vote.GetSignal() == VOTE_SIGNAL_FUNDING;
 
-        if (filter.contains(nVoteHash) || !vote.IsValid(onlyVotingKeyAllowed)) {
+        // Signatures were checked when the votes were accepted and votes of masternodes which changed
+        // their keys are dropped by RemoveInvalidVotes, so don't verify every single one again here.
+        // The peer verifies whatever it ends up requesting anyway.
+        if (filter.contains(nVoteHash) || !vote.IsValid(onlyVotingKeyAllowed, false)) {
             continue;
         }
         peer.PushInventory(CInv(MSG_GOVERNANCE_OBJECT_VOTE, nVoteHash));
@@ -933,8 +1141,8 @@ PeerMsgRet CGovernanceManager::SyncObjects(CNode& peer, CConnman& connman) const
             // We know this proposal is valid locally, otherwise we would not store it.
             // But we don't want to relay it to pre-GOVSCRIPT_PROTO_VERSION peers if payment_address is p2sh
             // because they won't accept it anyway and will simply ban us eventually.
-            CProposalValidator validator(govobj.GetDataAsHexString(), false /* no script */);
-            if (!validator.Validate(false /* ignore expiration */)) {
+            std::string strValidatorErrors;
+            if (!govobj.ValidateProposal(false /* ignore expiration */, false /* no script */, strValidatorErrors)) {
                 // The only way we could get here is when proposal is valid but payment_address is actually p2sh.
                 LogPrintf("CGovernanceManager::%s -- not syncing p2sh govobj to older node: %s, peer=%d\n", __func__,
                     strHash, peer.GetId());
@@ -1046,7 +1254,7 @@ bool CGovernanceManager::MasternodeRateCheck(const CGovernanceObject& govobj, bo
     return false;
 }
 
-bool CGovernanceManager::ProcessVote(CNode* pfrom, const CGovernanceVote& vote, CGovernanceException& exception, CConnman& connman)
+bool CGovernanceManager::ProcessVote(CNode* pfrom, const CGovernanceVote& vote, CGovernanceException& exception, CConnman& connman, bool fSignatureVerified)
 {
     ENTER_CRITICAL_SECTION(cs)
     uint256 nHashVote = vote.GetHash();
@@ -1095,7 +1303,15 @@ bool CGovernanceManager::ProcessVote(CNode* pfrom, const CGovernanceVote& vote,
         return false;
     }
 
-    bool fOk = govobj.ProcessVote(vote, exception) && cmapVoteToObject.Insert(nHashVote, &govobj);
+    bool fOk = govobj.ProcessVote(vote, exception, fSignatureVerified) && cmapVoteToObject.Insert(nHashVote, &govobj);
+    if (fOk) {
+        triggerman.InvalidateSuperblockCache();
+        TRACE4(governance, vote_accepted,
+            nHashVote.data(),
+            nHashGovobj.data(),
+            ToUnderlying(vote.GetSignal()),
+            ToUnderlying(vote.GetOutcome()));
+    }
     LEAVE_CRITICAL_SECTION(cs)
     return fOk;
 }
@@ -1106,10 +1322,14 @@ void CGovernanceManager::CheckPostponedObjects(CConnman& connman)
 
     LOCK2(cs_main, cs);
 
-    // Check postponed proposals
-    for (auto it = mapPostponedObjects.begin(); it != mapPostponedObjects.end();) {
-        const uint256& nHash = it->first;
-        CGovernanceObject& govobj = it->second;
+    // Check postponed proposals, only the ones whose collateral can have enough confirmations by now
+    const int nHeight = ::ChainActive().Height();
+    for (auto it = mapPostponedHeights.begin(); it != mapPostponedHeights.end() && it->first <= nHeight;) {
+        const uint256 nHash = it->second;
+        it = mapPostponedHeights.erase(it);
+        auto itObject = mapPostponedObjects.find(nHash);
+        if (itObject == mapPostponedObjects.end()) continue;
+        CGovernanceObject& govobj = itObject->second;
 
         assert(govobj.GetObjectType() != GovernanceObject::TRIGGER);
 
@@ -1124,12 +1344,12 @@ void CGovernanceManager::CheckPostponedObjects(CConnman& connman)
 
         } else if (fMissingConfirmations) {
             // wait for more confirmations
-            ++it;
+            mapPostponedHeights.emplace(govobj.GetCollateralHeight() + GOVERNANCE_FEE_CONFIRMATIONS - 1, nHash);
             continue;
         }
 
         // remove processed or invalid object from the queue
-        mapPostponedObjects.erase(it++);
+        mapPostponedObjects.erase(itObject);
     }
 
 
@@ -1183,9 +1403,13 @@ void CGovernanceManager::RequestGovernanceObject(CNode* pfrom, const uint256& nH
         const CGovernanceObject* pObj = FindConstGovernanceObject(nHash);
 
         if (pObj) {
-            filter = CBloomFilter(Params().GetConsensus().nGovernanceFilterElements, GOVERNANCE_FILTER_FP_RATE, GetRandInt(999999), BLOOM_UPDATE_ALL);
+            // A peer which is mostly in sync should mostly get the votes it misses. Size the filter for the
+            // votes we actually know instead of the network wide maximum, a restarted node re-asks for every
+            // object and a full sized filter per object and peer is what most of that traffic used to be.
             std::vector<CGovernanceVote> vecVotes = pObj->GetVoteFile().GetVotes();
             nVoteCount = vecVotes.size();
+            const unsigned int nFilterElements = std::max<unsigned int>(nVoteCount, GOVERNANCE_FILTER_MIN_ELEMENTS);
+            filter = CBloomFilter(std::min<unsigned int>(nFilterElements, Params().GetConsensus().nGovernanceFilterElements), GOVERNANCE_FILTER_FP_RATE, GetRandInt(999999), BLOOM_UPDATE_ALL);
             for (const auto& vote : vecVotes) {
                 filter.insert(vote.GetHash());
             }
@@ -1550,6 +1774,7 @@ void CGovernanceManager::RemoveInvalidVotes()
             if (removed.empty()) {
                 continue;
             }
+            triggerman.InvalidateSuperblockCache();
             for (auto& voteHash : removed) {
                 cmapVoteToObject.Erase(voteHash);
                 cmapInvalidVotes.Erase(voteHash);
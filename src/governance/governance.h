@@ -12,13 +12,17 @@
 #include <cachemultimap.h>
 #include <net_types.h>
 
+#include <deque>
+#include <map>
 #include <optional>
 
 class CBloomFilter;
 class CBlockIndex;
-template<typename T>
-class CFlatDB;
+class CBLSWorker;
+class CGovernanceDb;
 class CInv;
+class PeerManager;
+using NodeId = int64_t;
 
 class CGovernanceManager;
 class CGovernanceTriggerManager;
@@ -154,6 +158,8 @@ protected:
 protected:
     static constexpr int MAX_CACHE_SIZE = 1000000;
     static const std::string SERIALIZATION_VERSION_STRING;
+    // governance.dat, which also contained mapObjects
+    static const std::string SERIALIZATION_VERSION_STRING_FLATDB;
 
 public:
     // critical section to protect the inner data structures
@@ -177,6 +183,7 @@ public:
     GovernanceStore();
     ~GovernanceStore() = default;
 
+    // Objects are not part of this, CGovernanceDb keeps each of them in its own record
     template<typename Stream>
     void Serialize(Stream &s) const
     {
@@ -185,7 +192,6 @@ public:
             << mapErasedGovernanceObjects
             << cmapInvalidVotes
             << cmmapOrphanVotes
-            << mapObjects
             << mapLastMasternodeObject
             << *lastMNListForVotingKeys;
     }
@@ -198,16 +204,20 @@ public:
         LOCK(cs);
         std::string strVersion;
         s >> strVersion;
-        if (strVersion != SERIALIZATION_VERSION_STRING) {
-            return;
+        if (strVersion == SERIALIZATION_VERSION_STRING) {
+            s   >> mapErasedGovernanceObjects
+                >> cmapInvalidVotes
+                >> cmmapOrphanVotes
+                >> mapLastMasternodeObject
+                >> *lastMNListForVotingKeys;
+        } else if (strVersion == SERIALIZATION_VERSION_STRING_FLATDB) {
+            s   >> mapErasedGovernanceObjects
+                >> cmapInvalidVotes
+                >> cmmapOrphanVotes
+                >> mapObjects
+                >> mapLastMasternodeObject
+                >> *lastMNListForVotingKeys;
         }
-
-        s   >> mapErasedGovernanceObjects
-            >> cmapInvalidVotes
-            >> cmmapOrphanVotes
-            >> mapObjects
-            >> mapLastMasternodeObject
-            >> *lastMNListForVotingKeys;
     }
 
     void Clear();
@@ -224,7 +234,6 @@ class CGovernanceManager : public GovernanceStore
 
 private:
     using hash_s_t = std::set<uint256>;
-    using db_type = CFlatDB<GovernanceStore>;
 
     class ScopedLockBool
     {
@@ -249,29 +258,53 @@ private:
 private:
     static const int MAX_TIME_FUTURE_DEVIATION;
     static const int RELIABLE_PROPAGATION_TIME;
+    static constexpr size_t MAX_VOTES_PER_BATCH = 4096;
 
 private:
-    const std::unique_ptr<db_type> m_db;
+    std::unique_ptr<CGovernanceDb> m_db;
     bool is_valid{false};
+    // objects erased from mapObjects which still have to be erased from m_db
+    hash_s_t setObjectsToErase GUARDED_BY(cs);
+    // the last time the state was flushed while the node was synced, also read from m_db on load
+    int64_t nTimeLastSynced GUARDED_BY(cs){0};
 
     int64_t nTimeLastDiff;
     // keep track of current block height
     int nCachedBlockHeight;
     std::map<uint256, CGovernanceObject> mapPostponedObjects;
+    // hashes of mapPostponedObjects by the height at which their collateral gets enough confirmations
+    std::multimap<int, uint256> mapPostponedHeights;
     hash_s_t setAdditionalRelayObjects;
     hash_s_t setRequestedObjects;
     hash_s_t setRequestedVotes;
     bool fRateChecksEnabled;
     std::optional<uint256> votedFundingYesTriggerHash;
 
+    // votes received from peers which still have to be verified and processed
+    Mutex cs_pendingVotes;
+    std::deque<std::pair<NodeId, CGovernanceVote>> pendingVotes GUARDED_BY(cs_pendingVotes);
+
 public:
     CGovernanceManager();
     ~CGovernanceManager();
 
     bool LoadCache(bool load_cache);
 
+    /**
+     * Write all objects which changed since the last flush and the rest of
+     * the governance state to the governance db. Happens regularly from
+     * DoMaintenance and on shutdown.
+     */
+    bool Flush(bool fSync = false);
+
     bool IsValid() const { return is_valid; }
 
+    /**
+     * Whether the governance state was flushed by a synced node in the last
+     * nSeconds, possibly before a restart, so a sync only has to catch up.
+     */
+    bool IsSyncedWithin(int64_t nSeconds) const;
+
     /**
      * This is called by AlreadyHave in net_processing.cpp as part of the inventory
      * retrieval process.  Returns true if we want to retrieve the object, otherwise
@@ -284,6 +317,14 @@ public:
 
     PeerMsgRet ProcessMessage(CNode& peer, CConnman& connman, std::string_view msg_type, CDataStream& vRecv);
 
+    /**
+     * Process the votes ProcessMessage queued up. Signatures are verified in
+     * batches without holding cs, BLS ones through CBLSBatchVerifier (on the
+     * BLS worker if one is passed), only votes with a good signature are then
+     * applied under the lock. Runs regularly on the scheduler.
+     */
+    void ProcessPendingVotes(CConnman& connman, PeerManager& peerman, CBLSWorker* blsWorker) LOCKS_EXCLUDED(cs_pendingVotes);
+
     void ResetVotedFundingTrigger();
 
     void DoMaintenance(CConnman& connman);
@@ -325,7 +366,10 @@ public:
     void AddPostponedObject(const CGovernanceObject& govobj)
     {
         LOCK(cs);
-        mapPostponedObjects.insert(std::make_pair(govobj.GetHash(), govobj));
+        const uint256 nHash = govobj.GetHash();
+        if (mapPostponedObjects.emplace(nHash, govobj).second) {
+            mapPostponedHeights.emplace(govobj.GetCollateralHeight() + GOVERNANCE_FEE_CONFIRMATIONS - 1, nHash);
+        }
     }
 
     void MasternodeRateUpdate(const CGovernanceObject& govobj);
@@ -357,6 +401,9 @@ public:
     int RequestGovernanceObjectVotes(Span<CNode*> vNodesCopy, CConnman& connman) const;
 
 private:
+    /// Move the objects of an existing governance.dat over into m_db
+    bool MigrateFlatDB();
+
     std::optional<const CSuperblock> CreateSuperblockCandidate(int nHeight) const;
     std::optional<const CGovernanceObject> CreateGovernanceTrigger(const std::optional<const CSuperblock>& sb_opt, CConnman& connman);
     void VoteGovernanceTriggers(const std::optional<const CGovernanceObject>& trigger_opt, CConnman& connman);
@@ -370,7 +417,7 @@ private:
         cmapInvalidVotes.Insert(vote.GetHash(), vote);
     }
 
-    bool ProcessVote(CNode* pfrom, const CGovernanceVote& vote, CGovernanceException& exception, CConnman& connman);
+    bool ProcessVote(CNode* pfrom, const CGovernanceVote& vote, CGovernanceException& exception, CConnman& connman, bool fSignatureVerified = false);
 
     /// Called to indicate a requested object has been received
     bool AcceptObjectMessage(const uint256& nHash);
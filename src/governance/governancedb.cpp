@@ -0,0 +1,79 @@
+// Copyright (c) 2026 The Dash Core developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <governance/governancedb.h>
+
+#include <dbwrapper.h>
+#include <evo/deterministicmns.h>
+#include <governance/governance.h>
+#include <governance/object.h>
+#include <util/system.h>
+
+static const std::string DB_GOVERNANCE_STORE = "gov_s";
+static const std::string DB_GOVERNANCE_OBJECT = "gov_o";
+static const std::string DB_GOVERNANCE_SYNCED_TIME = "gov_t";
+
+CGovernanceDb::CGovernanceDb(bool fMemory, bool fWipe) :
+    db(std::make_unique<CDBWrapper>(fMemory ? "" : (GetDataDir() / "governance"), 8 << 20, fMemory, fWipe))
+{
+}
+
+CGovernanceDb::~CGovernanceDb() = default;
+
+bool CGovernanceDb::IsEmpty()
+{
+    return db->IsEmpty();
+}
+
+bool CGovernanceDb::ReadStore(GovernanceStore& store) const
+{
+    return db->Read(DB_GOVERNANCE_STORE, store);
+}
+
+bool CGovernanceDb::ReadObjects(std::map<uint256, CGovernanceObject>& objects) const
+{
+    std::unique_ptr<CDBIterator> pcursor(db->NewIterator());
+
+    auto start = std::make_tuple(DB_GOVERNANCE_OBJECT, uint256());
+    pcursor->Seek(start);
+
+    while (pcursor->Valid()) {
+        decltype(start) k;
+        if (!pcursor->GetKey(k) || std::get<0>(k) != DB_GOVERNANCE_OBJECT) {
+            break;
+        }
+
+        auto it = objects.try_emplace(std::get<1>(k)).first;
+        if (!pcursor->GetValue(it->second)) {
+            objects.erase(it);
+            return error("%s: failed to read governance object %s", __func__, std::get<1>(k).ToString());
+        }
+
+        pcursor->Next();
+    }
+
+    return true;
+}
+
+bool CGovernanceDb::ReadSyncedTime(int64_t& nTime) const
+{
+    return db->Read(DB_GOVERNANCE_SYNCED_TIME, nTime);
+}
+
+bool CGovernanceDb::Write(const GovernanceStore& store, const std::vector<const CGovernanceObject*>& updatedObjects,
+                          const std::set<uint256>& erasedObjects, int64_t nTimeSynced, bool fSync)
+{
+    CDBBatch batch(*db);
+    for (const auto& hash : erasedObjects) {
+        batch.Erase(std::make_tuple(DB_GOVERNANCE_OBJECT, hash));
+    }
+    for (const auto* pObj : updatedObjects) {
+        batch.Write(std::make_tuple(DB_GOVERNANCE_OBJECT, pObj->GetHash()), *pObj);
+    }
+    batch.Write(DB_GOVERNANCE_STORE, store);
+    if (nTimeSynced != 0) {
+        batch.Write(DB_GOVERNANCE_SYNCED_TIME, nTimeSynced);
+    }
+    return db->WriteBatch(batch, fSync);
+}
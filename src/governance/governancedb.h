@@ -0,0 +1,53 @@
+// Copyright (c) 2026 The Dash Core developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_GOVERNANCE_GOVERNANCEDB_H
+#define BITCOIN_GOVERNANCE_GOVERNANCEDB_H
+
+#include <uint256.h>
+
+#include <map>
+#include <memory>
+#include <set>
+#include <vector>
+
+class CDBWrapper;
+class CGovernanceObject;
+class GovernanceStore;
+
+/**
+ * On-disk store of the governance manager, replacing governance.dat.
+ *
+ * Every object is kept in its own record together with its votes, so a flush
+ * only has to write the objects which changed since the last one. Everything
+ * else the manager keeps (erased objects, invalid and orphan votes, rate check
+ * buffers, ...) is small and goes into a single record.
+ */
+class CGovernanceDb
+{
+private:
+    std::unique_ptr<CDBWrapper> db;
+
+public:
+    explicit CGovernanceDb(bool fMemory, bool fWipe);
+    ~CGovernanceDb();
+
+    bool IsEmpty();
+
+    bool ReadStore(GovernanceStore& store) const;
+    bool ReadObjects(std::map<uint256, CGovernanceObject>& objects) const;
+    /** The time of the last write by a synced node, false if there was none */
+    bool ReadSyncedTime(int64_t& nTime) const;
+
+    /**
+     * Write the state of the store, the given objects and remove the erased
+     * ones, all in one batch. Objects are erased first, so an object which
+     * was erased and added again since the last write is kept. nTimeSynced
+     * is the last time the node was synced, 0 if it never was.
+     */
+    bool Write(const GovernanceStore& store, const std::vector<const CGovernanceObject*>& updatedObjects,
+               const std::set<uint256>& erasedObjects, int64_t nTimeSynced, bool fSync = false);
+};
+
+#endif // BITCOIN_GOVERNANCE_GOVERNANCEDB_H
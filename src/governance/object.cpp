@@ -32,10 +32,16 @@ CGovernanceObject::CGovernanceObject() :
     fCachedDelete(false),
     fCachedEndorsed(false),
     fDirtyCache(true),
+    fDirtyDisk(true),
     fExpired(false),
     fUnparsable(false),
+    pindexCollateral(nullptr),
     mapCurrentMNVotes(),
-    fileVotes()
+    voteTally(),
+    voteTallyBlockHash(),
+    fileVotes(),
+    cs_payload(),
+    m_payload()
 {
     // PARSE JSON DATA STORAGE (VCHDATA)
     LoadData();
@@ -52,10 +58,16 @@ CGovernanceObject::CGovernanceObject(const uint256& nHashParentIn, int nRevision
     fCachedDelete(false),
     fCachedEndorsed(false),
     fDirtyCache(true),
+    fDirtyDisk(true),
     fExpired(false),
     fUnparsable(false),
+    pindexCollateral(nullptr),
     mapCurrentMNVotes(),
-    fileVotes()
+    voteTally(),
+    voteTallyBlockHash(),
+    fileVotes(),
+    cs_payload(),
+    m_payload()
 {
     // PARSE JSON DATA STORAGE (VCHDATA)
     LoadData();
@@ -72,14 +84,20 @@ CGovernanceObject::CGovernanceObject(const CGovernanceObject& other) :
     fCachedDelete(other.fCachedDelete),
     fCachedEndorsed(other.fCachedEndorsed),
     fDirtyCache(other.fDirtyCache),
+    fDirtyDisk(other.fDirtyDisk),
     fExpired(other.fExpired),
     fUnparsable(other.fUnparsable),
+    pindexCollateral(other.pindexCollateral),
     mapCurrentMNVotes(other.mapCurrentMNVotes),
-    fileVotes(other.fileVotes)
+    voteTally(other.voteTally),
+    voteTallyBlockHash(other.voteTallyBlockHash),
+    fileVotes(other.fileVotes),
+    cs_payload(),
+    m_payload(WITH_LOCK(other.cs_payload, return other.m_payload))
 {
 }
 
-bool CGovernanceObject::ProcessVote(const CGovernanceVote& vote, CGovernanceException& exception)
+bool CGovernanceObject::ProcessVote(const CGovernanceVote& vote, CGovernanceException& exception, bool fSignatureVerified)
 {
     LOCK(cs);
 
@@ -167,7 +185,7 @@ bool CGovernanceObject::ProcessVote(const CGovernanceVote& vote, CGovernanceExce
     bool onlyVotingKeyAllowed = m_obj.type == GovernanceObject::PROPOSAL && vote.GetSignal() == VOTE_SIGNAL_FUNDING;
 
     // Finally check that the vote is actually valid (done last because of cost of signature verification)
-    if (!vote.IsValid(onlyVotingKeyAllowed)) {
+    if (!vote.IsValid(onlyVotingKeyAllowed, !fSignatureVerified)) {
         std::ostringstream ostr;
         ostr << "CGovernanceObject::ProcessVote -- Invalid vote"
              << ", MN outpoint = " << vote.GetMasternodeOutpoint().ToStringShort()
@@ -189,9 +207,19 @@ bool CGovernanceObject::ProcessVote(const CGovernanceVote& vote, CGovernanceExce
         return false;
     }
 
+    if (voteTallyBlockHash == mnList.GetBlockHash()) {
+        // the replaced vote was counted with the same weight
+        const int nWeight = GetMnType(dmn->nType).voting_weight;
+        voteTally[eSignal][voteInstanceRef.eOutcome] -= nWeight;
+        voteTally[eSignal][vote.GetOutcome()] += nWeight;
+    } else {
+        voteTallyBlockHash.reset();
+    }
+
     voteInstanceRef = vote_instance_t(vote.GetOutcome(), nVoteTimeUpdate, vote.GetTimestamp());
     fileVotes.AddVote(vote);
     fDirtyCache = true;
+    fDirtyDisk = true;
     // SEND NOTIFICATION TO SCRIPT/ZMQ
     GetMainSignals().NotifyGovernanceVote(std::make_shared<const CGovernanceVote>(vote));
     return true;
@@ -206,9 +234,14 @@ void CGovernanceObject::ClearMasternodeVotes()
     auto it = mapCurrentMNVotes.begin();
     while (it != mapCurrentMNVotes.end()) {
         if (!mnList.HasMNByCollateral(it->first)) {
+            // votes of MNs which are not in the list aren't counted, so the tally for this list stays the same
+            if (voteTallyBlockHash != mnList.GetBlockHash()) {
+                voteTallyBlockHash.reset();
+            }
             fileVotes.RemoveVotesFromMasternode(it->first);
             mapCurrentMNVotes.erase(it++);
             fDirtyCache = true;
+            fDirtyDisk = true;
         } else {
             ++it;
         }
@@ -243,6 +276,7 @@ std::set<uint256> CGovernanceObject::RemoveInvalidVotes(const COutPoint& mnOutpo
     if (it->second.mapInstances.empty()) {
         mapCurrentMNVotes.erase(it);
     }
+    voteTallyBlockHash.reset();
 
     std::string removedStr;
     for (const auto& h : removedVotes) {
@@ -250,6 +284,7 @@ std::set<uint256> CGovernanceObject::RemoveInvalidVotes(const COutPoint& mnOutpo
     }
     LogPrintf("CGovernanceObject::%s -- Removed %d invalid votes for %s from MN %s:\n%s", __func__, removedVotes.size(), nParentHash.ToString(), mnOutpoint.ToString(), removedStr); /* Continued */
     fDirtyCache = true;
+    fDirtyDisk = true;
 
     return removedVotes;
 }
@@ -262,7 +297,7 @@ uint256 CGovernanceObject::GetHash() const
 uint256 CGovernanceObject::GetDataHash() const
 {
     CHashWriter ss(SER_GETHASH, PROTOCOL_VERSION);
-    ss << GetDataAsHexString();
+    ss << GetPayload()->strDataHex;
 
     return ss.GetHash();
 }
@@ -305,23 +340,71 @@ bool CGovernanceObject::CheckSignature(const CBLSPublicKey& pubKey) const
  */
 UniValue CGovernanceObject::GetJSONObject() const
 {
-    UniValue obj(UniValue::VOBJ);
-    if (m_obj.vchData.empty()) {
-        return obj;
+    const auto payload = GetPayload();
+    if (!payload->fJSONValid) {
+        throw std::runtime_error(payload->strJSONError);
     }
+    return payload->objJSON;
+}
+
+std::shared_ptr<const CGovernanceObject::Payload> CGovernanceObject::GetPayload() const
+{
+    LOCK(cs_payload);
+    if (!m_payload) {
+        m_payload = BuildPayload();
+    }
+    return m_payload;
+}
+
+std::shared_ptr<const CGovernanceObject::Payload> CGovernanceObject::BuildPayload() const
+{
+    auto payload = std::make_shared<Payload>();
+    payload->strDataHex = m_obj.GetDataAsHexString();
 
     UniValue objResult(UniValue::VOBJ);
-    GetData(objResult);
+    if (!m_obj.vchData.empty()) {
+        GetData(objResult);
+        try {
+            if (objResult.isObject()) {
+                payload->objJSON = objResult;
+            } else {
+                std::vector<UniValue> arr1 = objResult.getValues();
+                std::vector<UniValue> arr2 = arr1.at(0).getValues();
+                payload->objJSON = arr2.at(1);
+            }
+        } catch (std::exception& e) {
+            payload->fJSONValid = false;
+            payload->strJSONError = e.what();
+        }
+    }
 
-    if (objResult.isObject()) {
-        obj = objResult;
-    } else {
-        std::vector<UniValue> arr1 = objResult.getValues();
-        std::vector<UniValue> arr2 = arr1.at(0).getValues();
-        obj = arr2.at(1);
+    // Only the expiration check depends on the time, everything else the validators look at is fixed
+    CProposalValidator validator(objResult, m_obj.vchData.size());
+    payload->fProposalValid = validator.Validate(false);
+    payload->strProposalErrors = validator.GetErrorMessages();
+    CProposalValidator validatorNoScript(objResult, m_obj.vchData.size(), false /* no script */);
+    payload->fProposalValidNoScript = validatorNoScript.Validate(false);
+    payload->strProposalErrorsNoScript = validatorNoScript.GetErrorMessages();
+    if (payload->fProposalValid) {
+        payload->nProposalEndEpoch = objResult["end_epoch"].get_int64();
     }
 
-    return obj;
+    return payload;
+}
+
+bool CGovernanceObject::ValidateProposal(bool fCheckExpiration, bool fAllowScript, std::string& strError) const
+{
+    const auto payload = GetPayload();
+    strError = fAllowScript ? payload->strProposalErrors : payload->strProposalErrorsNoScript;
+    if (!(fAllowScript ? payload->fProposalValid : payload->fProposalValidNoScript)) {
+        return false;
+    }
+    if (fCheckExpiration && payload->nProposalEndEpoch <= GetAdjustedTime()) {
+        // the messages CProposalValidator::ValidateStartEndEpoch() and Validate() leave
+        strError += "expired;Invalid start:end range;";
+        return false;
+    }
+    return true;
 }
 
 /**
@@ -340,8 +423,6 @@ void CGovernanceObject::LoadData()
 
     try {
         // ATTEMPT TO LOAD JSON STRING FROM VCHDATA
-        UniValue objResult(UniValue::VOBJ);
-        GetData(objResult);
         LogPrint(BCLog::GOBJECT, "CGovernanceObject::LoadData -- GetDataAsPlainString = %s\n", GetDataAsPlainString());
         UniValue obj = GetJSONObject();
         m_obj.type = GovernanceObject(obj["type"].get_int());
@@ -384,7 +465,7 @@ void CGovernanceObject::GetData(UniValue& objResult) const
 */
 std::string CGovernanceObject::GetDataAsHexString() const
 {
-    return m_obj.GetDataAsHexString();
+    return GetPayload()->strDataHex;
 }
 
 std::string CGovernanceObject::GetDataAsPlainString() const
@@ -425,12 +506,12 @@ bool CGovernanceObject::IsValidLocally(std::string& strError, bool& fMissingConf
 
     switch (m_obj.type) {
     case GovernanceObject::PROPOSAL: {
-        CProposalValidator validator(GetDataAsHexString());
+        std::string strValidatorErrors;
         // Note: It's ok to have expired proposals
         // they are going to be cleared by CGovernanceManager::UpdateCachesAndClean()
         // TODO: should they be tagged as "expired" to skip vote downloading?
-        if (!validator.Validate(false)) {
-            strError = strprintf("Invalid proposal data, error messages: %s", validator.GetErrorMessages());
+        if (!ValidateProposal(false, true, strValidatorErrors)) {
+            strError = strprintf("Invalid proposal data, error messages: %s", strValidatorErrors);
             return false;
         }
         if (fCheckCollateral && !IsCollateralValid(strError, fMissingConfirmations)) {
@@ -491,10 +572,54 @@ bool CGovernanceObject::IsCollateralValid(std::string& strError, bool& fMissingC
 
     strError = "";
     fMissingConfirmations = false;
+
+    // The collateral tx only has to be looked up and checked again if its block was disconnected
+    if (!pindexCollateral || !::ChainActive().Contains(pindexCollateral)) {
+        pindexCollateral = nullptr;
+        uint256 nBlockHash;
+        if (!CheckCollateralTx(strError, nBlockHash)) {
+            return false;
+        }
+        pindexCollateral = g_chainman.m_blockman.LookupBlockIndex(nBlockHash);
+    }
+
+    // GET CONFIRMATIONS FOR TRANSACTION
+
+    int nConfirmationsIn = 0;
+    if (pindexCollateral && ::ChainActive().Contains(pindexCollateral)) {
+        nConfirmationsIn += ::ChainActive().Height() - pindexCollateral->nHeight + 1;
+    }
+
+    if (nConfirmationsIn < GOVERNANCE_FEE_CONFIRMATIONS) {
+        strError = strprintf("Collateral requires at least %d confirmations to be relayed throughout the network (it has only %d)", GOVERNANCE_FEE_CONFIRMATIONS, nConfirmationsIn);
+        if (nConfirmationsIn >= GOVERNANCE_MIN_RELAY_FEE_CONFIRMATIONS) {
+            fMissingConfirmations = true;
+            strError += ", pre-accepted -- waiting for required confirmations";
+        } else {
+            strError += ", rejected -- try again later";
+        }
+        LogPrintf("CGovernanceObject::IsCollateralValid -- %s\n", strError);
+
+        return false;
+    }
+
+    strError = "valid";
+    return true;
+}
+
+int CGovernanceObject::GetCollateralHeight() const
+{
+    // nHeight of a block index never changes
+    return pindexCollateral ? pindexCollateral->nHeight : -1;
+}
+
+bool CGovernanceObject::CheckCollateralTx(std::string& strError, uint256& nBlockHash) const
+{
+    AssertLockHeld(cs_main);
+
     uint256 nExpectedHash = GetHash();
 
     // RETRIEVE TRANSACTION IN QUESTION
-    uint256 nBlockHash;
     CTransactionRef txCollateral = GetTransaction(/* block_index */ nullptr, /* mempool */ nullptr, m_obj.collateralHash, Params().GetConsensus(), nBlockHash);
     if (!txCollateral) {
         strError = strprintf("Can't find collateral tx %s", m_obj.collateralHash.ToString());
@@ -544,52 +669,46 @@ bool CGovernanceObject::IsCollateralValid(std::string& strError, bool& fMissingC
         return false;
     }
 
-    // GET CONFIRMATIONS FOR TRANSACTION
-
-    AssertLockHeld(cs_main);
-    int nConfirmationsIn = 0;
-    if (nBlockHash != uint256()) {
-        const CBlockIndex* pindex = g_chainman.m_blockman.LookupBlockIndex(nBlockHash);
-        if (pindex && ::ChainActive().Contains(pindex)) {
-            nConfirmationsIn += ::ChainActive().Height() - pindex->nHeight + 1;
-        }
-    }
-
-    if (nConfirmationsIn < GOVERNANCE_FEE_CONFIRMATIONS) {
-        strError = strprintf("Collateral requires at least %d confirmations to be relayed throughout the network (it has only %d)", GOVERNANCE_FEE_CONFIRMATIONS, nConfirmationsIn);
-        if (nConfirmationsIn >= GOVERNANCE_MIN_RELAY_FEE_CONFIRMATIONS) {
-            fMissingConfirmations = true;
-            strError += ", pre-accepted -- waiting for required confirmations";
-        } else {
-            strError += ", rejected -- try again later";
-        }
-        LogPrintf("CGovernanceObject::IsCollateralValid -- %s\n", strError);
-
-        return false;
-    }
-
-    strError = "valid";
     return true;
 }
 
 int CGovernanceObject::CountMatchingVotes(vote_signal_enum_t eVoteSignalIn, vote_outcome_enum_t eVoteOutcomeIn) const
 {
+    if (eVoteSignalIn < 0 || eVoteSignalIn > MAX_SUPPORTED_VOTE_SIGNAL || eVoteOutcomeIn < 0 || eVoteOutcomeIn > VOTE_OUTCOME_ABSTAIN) {
+        // such votes are never accepted
+        return 0;
+    }
+
     auto mnList = deterministicMNManager->GetListAtChainTip();
 
     LOCK(cs);
 
-    int nCount = 0;
-    for (const auto& votepair : mapCurrentMNVotes) {
-        const vote_rec_t& recVote = votepair.second;
-        auto it2 = recVote.mapInstances.find(eVoteSignalIn);
-        if (it2 != recVote.mapInstances.end() && it2->second.eOutcome == eVoteOutcomeIn) {
-            // 4x times weight vote for EvoNode owners.
-            // No need to check if v19 is active since no EvoNode are allowed to register before v19s
-            auto dmn = mnList.GetMNByCollateral(votepair.first);
-            if (dmn != nullptr) nCount += GetMnType(dmn->nType).voting_weight;
+    if (voteTallyBlockHash != mnList.GetBlockHash()) {
+        RecalculateVoteTally(mnList);
+    }
+    return voteTally[eVoteSignalIn][eVoteOutcomeIn];
+}
+
+void CGovernanceObject::RecalculateVoteTally(const CDeterministicMNList& mnList) const
+{
+    AssertLockHeld(cs);
+
+    voteTally = {};
+    for (const auto& [outpoint, recVote] : mapCurrentMNVotes) {
+        // 4x times weight vote for EvoNode owners.
+        // No need to check if v19 is active since no EvoNode are allowed to register before v19s
+        auto dmn = mnList.GetMNByCollateral(outpoint);
+        if (dmn == nullptr) {
+            continue;
+        }
+        const int nWeight = GetMnType(dmn->nType).voting_weight;
+        for (const auto& [nSignal, voteInstance] : recVote.mapInstances) {
+            if (nSignal >= 0 && nSignal <= MAX_SUPPORTED_VOTE_SIGNAL && voteInstance.eOutcome >= 0 && voteInstance.eOutcome <= VOTE_OUTCOME_ABSTAIN) {
+                voteTally[nSignal][voteInstance.eOutcome] += nWeight;
+            }
         }
     }
-    return nCount;
+    voteTallyBlockHash = mnList.GetBlockHash();
 }
 
 /**
@@ -646,8 +765,8 @@ void CGovernanceObject::Relay(CConnman& connman) const
         // We know this proposal is valid locally, otherwise we would not get to the point we should relay it.
         // But we don't want to relay it to pre-GOVSCRIPT_PROTO_VERSION peers if payment_address is p2sh
         // because they won't accept it anyway and will simply ban us eventually.
-        CProposalValidator validator(GetDataAsHexString(), false /* no script */);
-        if (!validator.Validate(false /* ignore expiration */)) {
+        std::string strValidatorErrors;
+        if (!ValidateProposal(false /* ignore expiration */, false /* no script */, strValidatorErrors)) {
             // The only way we could get here is when proposal is valid but payment_address is actually p2sh.
             LogPrint(BCLog::GOBJECT, "CGovernanceObject::Relay -- won't relay %s to older peers\n", GetHash().ToString());
             minProtoVersion = GOVSCRIPT_PROTO_VERSION;
@@ -685,6 +804,7 @@ void CGovernanceObject::UpdateSentinelVariables()
         fCachedDelete = true;
         if (nDeletionTime == 0) {
             nDeletionTime = GetTime<std::chrono::seconds>().count();
+            fDirtyDisk = true;
         }
     }
     if (GetAbsoluteYesCount(VOTE_SIGNAL_ENDORSED) >= nAbsVoteReq) fCachedEndorsed = true;
@@ -13,8 +13,14 @@
 
 #include <univalue.h>
 
+#include <array>
+#include <memory>
+#include <optional>
+
+class CBlockIndex;
 class CBLSSecretKey;
 class CBLSPublicKey;
+class CDeterministicMNList;
 class CNode;
 
 class CGovernanceObject;
@@ -23,6 +29,8 @@ class CGovernanceVote;
 extern RecursiveMutex cs_main;
 
 static constexpr double GOVERNANCE_FILTER_FP_RATE = 0.001;
+//! Vote filters sent with vote sync requests are sized for at least this many votes
+static constexpr unsigned int GOVERNANCE_FILTER_MIN_ELEMENTS = 100;
 
 
 static constexpr CAmount GOVERNANCE_PROPOSAL_FEE_TX = (1 * COIN);
@@ -91,6 +99,21 @@ class CGovernanceObject
 public: // Types
     using vote_m_t = std::map<COutPoint, vote_rec_t>;
 
+    /// Everything derived from vchData, which never changes once the object is created or deserialized
+    struct Payload {
+        std::string strDataHex;
+        /// what GetJSONObject() returns, fJSONValid is false and strJSONError is set if the data can't be decoded
+        UniValue objJSON{UniValue::VOBJ};
+        bool fJSONValid{true};
+        std::string strJSONError;
+        /// CProposalValidator results without the expiration check, with and without script payment addresses
+        bool fProposalValid{false};
+        std::string strProposalErrors;
+        bool fProposalValidNoScript{false};
+        std::string strProposalErrorsNoScript;
+        int64_t nProposalEndEpoch{0};
+    };
+
 private:
     /// critical section to protect the inner data structures
     mutable RecursiveMutex cs;
@@ -124,16 +147,32 @@ private:
     /// object was updated and cached values should be updated soon
     bool fDirtyCache;
 
+    /// object was updated since it was last written to the governance db
+    bool fDirtyDisk;
+
     /// Object is no longer of interest
     bool fExpired;
 
     /// Failed to parse object data
     bool fUnparsable;
 
+    /// block of the collateral tx once it passed all checks but the confirmations one, only used with cs_main held
+    mutable const CBlockIndex* pindexCollateral;
+
     vote_m_t mapCurrentMNVotes;
 
+    /// weighted vote counts per signal and outcome, kept up to date as votes come in
+    using vote_tally_t = std::array<std::array<int, VOTE_OUTCOME_ABSTAIN + 1>, MAX_SUPPORTED_VOTE_SIGNAL + 1>;
+    mutable vote_tally_t voteTally;
+    /// the MN list voteTally was counted against, it's recalculated when another one is used
+    mutable std::optional<uint256> voteTallyBlockHash;
+
     CGovernanceObjectVoteFile fileVotes;
 
+    /// the decoded data, built on first use and shared by all copies of the object
+    mutable Mutex cs_payload;
+    mutable std::shared_ptr<const Payload> m_payload GUARDED_BY(cs_payload);
+
 public:
     CGovernanceObject();
 
@@ -198,6 +237,16 @@ public:
         return fDirtyCache;
     }
 
+    bool IsSetDirtyDisk() const
+    {
+        return fDirtyDisk;
+    }
+
+    void ClearDirtyDisk()
+    {
+        fDirtyDisk = false;
+    }
+
     bool IsSetExpired() const
     {
         return fExpired;
@@ -206,6 +255,7 @@ public:
     void SetExpired()
     {
         fExpired = true;
+        fDirtyDisk = true;
     }
 
     const CGovernanceObjectVoteFile& GetVoteFile() const
@@ -230,6 +280,9 @@ public:
     /// Check the collateral transaction for the budget proposal/finalized budget
     bool IsCollateralValid(std::string& strError, bool& fMissingConfirmations) const EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
+    /// Height of the block the collateral transaction was found in by IsCollateralValid, -1 if it wasn't
+    int GetCollateralHeight() const;
+
     void UpdateLocalValidity();
 
     void UpdateSentinelVariables();
@@ -239,6 +292,7 @@ public:
         fCachedDelete = true;
         if (nDeletionTime == 0) {
             nDeletionTime = nDeletionTime_;
+            fDirtyDisk = true;
         }
     }
 
@@ -246,6 +300,11 @@ public:
 
     UniValue GetJSONObject() const;
 
+    std::shared_ptr<const Payload> GetPayload() const LOCKS_EXCLUDED(cs_payload);
+
+    /// Same as CProposalValidator(GetDataAsHexString(), fAllowScript).Validate(fCheckExpiration) but from the cached payload
+    bool ValidateProposal(bool fCheckExpiration, bool fAllowScript, std::string& strError) const;
+
     void Relay(CConnman& connman) const;
 
     uint256 GetHash() const;
@@ -263,6 +322,13 @@ public:
 
     bool GetCurrentMNVotes(const COutPoint& mnCollateralOutpoint, vote_rec_t& voteRecord) const;
 
+private:
+    void RecalculateVoteTally(const CDeterministicMNList& mnList) const;
+    bool CheckCollateralTx(std::string& strError, uint256& nBlockHash) const EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+    std::shared_ptr<const Payload> BuildPayload() const;
+
+public:
+
     // FUNCTIONS FOR DEALING WITH DATA STRING
 
     std::string GetDataAsHexString() const;
@@ -277,7 +343,10 @@ public:
         if (s.GetType() & SER_DISK) {
             // Only include these for the disk file format
             READWRITE(obj.nDeletionTime, obj.fExpired, obj.mapCurrentMNVotes, obj.fileVotes);
+            SER_READ(obj, obj.voteTallyBlockHash.reset());
         }
+        SER_READ(obj, WITH_LOCK(obj.cs_payload, obj.m_payload.reset()));
+        SER_READ(obj, obj.pindexCollateral = nullptr);
 
         // AFTER DESERIALIZATION OCCURS, CACHED VARIABLES MUST BE CALCULATED MANUALLY
     }
@@ -288,7 +357,7 @@ public:
     void LoadData();
     void GetData(UniValue& objResult) const;
 
-    bool ProcessVote(const CGovernanceVote& vote, CGovernanceException& exception);
+    bool ProcessVote(const CGovernanceVote& vote, CGovernanceException& exception, bool fSignatureVerified = false);
 
     /// Called when MN's which have voted on this object have been removed
     void ClearMasternodeVotes();
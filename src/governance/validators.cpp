@@ -27,6 +27,28 @@ CProposalValidator::CProposalValidator(const std::string& strHexData, bool fAllo
     }
 }
 
+CProposalValidator::CProposalValidator(const UniValue& objData, size_t nDataSize, bool fAllowScript) :
+    objJSON(UniValue::VOBJ),
+    fJSONValid(false),
+    fAllowScript(fAllowScript),
+    strErrorMessages()
+{
+    if (nDataSize > MAX_DATA_SIZE) {
+        strErrorMessages = strprintf("data exceeds %lu characters;", MAX_DATA_SIZE);
+        return;
+    }
+    if (nDataSize == 0) {
+        return;
+    }
+    // same as ParseJSONData
+    if (!objData.isObject()) {
+        strErrorMessages += "Proposal must be a JSON object;";
+        return;
+    }
+    objJSON = objData;
+    fJSONValid = true;
+}
+
 void CProposalValidator::ParseStrHexData(const std::string& strHexData)
 {
     std::vector<unsigned char> v = ParseHex(strHexData);
@@ -19,6 +19,8 @@ private:
 
 public:
     explicit CProposalValidator(const std::string& strDataHexIn = std::string(), bool fAllowScript = true);
+    /// From data which is already decoded, objData is the JSON read from the nDataSize bytes of the object data
+    CProposalValidator(const UniValue& objData, size_t nDataSize, bool fAllowScript = true);
 
     bool Validate(bool fCheckExpiration = true);
 
@@ -98,11 +98,14 @@ public:
 
     void SetSignature(const std::vector<unsigned char>& vchSigIn) { vchSig = vchSigIn; }
 
+    const std::vector<unsigned char>& GetSignature() const { return vchSig; }
+
     bool Sign(const CKey& key, const CKeyID& keyID);
     bool CheckSignature(const CKeyID& keyID) const;
     bool Sign(const CBLSSecretKey& key);
     bool CheckSignature(const CBLSPublicKey& pubKey) const;
-    bool IsValid(bool useVotingKey) const;
+    // fCheckSignature can be turned off for votes which had their signature batch-verified already
+    bool IsValid(bool useVotingKey, bool fCheckSignature = true) const;
     void Relay(CConnman& connman) const;
 
     const COutPoint& GetMasternodeOutpoint() const { return masternodeOutpoint; }
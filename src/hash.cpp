@@ -3,10 +3,12 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include <hash.h>
+#include <kawpow.h>
 #include <span.h>
 #include <crypto-X16R/common.h>
 #include <crypto-X16R/hmac_sha512.h>
 #include <primitives/block.h> 
+#include <util/trace.h>
 #include <crypto-X16R/ethash/include/ethash/progpow.hpp>
 
 //todo: remove these
@@ -88,35 +90,118 @@ uint256 SHA256Uint256(const uint256& input)
     return result;
 }
 
-uint256 KAWPOWHash(const CBlockHeader& blockHeader, uint256& mix_hash)
+namespace {
+/** Scratch space big enough for any of the 16 X16R contexts, only one is live at a time */
+union X16RContext {
+    sph_blake512_context blake;
+    sph_bmw512_context bmw;
+    sph_groestl512_context groestl;
+    sph_jh512_context jh;
+    sph_keccak512_context keccak;
+    sph_skein512_context skein;
+    sph_luffa512_context luffa;
+    sph_cubehash512_context cubehash;
+    sph_shavite512_context shavite;
+    sph_simd512_context simd;
+    sph_echo512_context echo;
+    sph_hamsi512_context hamsi;
+    sph_fugue512_context fugue;
+    sph_shabal512_context shabal;
+    sph_whirlpool_context whirlpool;
+    sph_sha512_context sha512;
+};
+
+/** Indexed by the nibble GetHashSelection() returns, in the same order as the HashX11() switch */
+const X16RSchedule::Algorithm X16R_ALGORITHMS[16] = {
+    {sph_blake512_init, sph_blake512, sph_blake512_close},
+    {sph_bmw512_init, sph_bmw512, sph_bmw512_close},
+    {sph_groestl512_init, sph_groestl512, sph_groestl512_close},
+    {sph_jh512_init, sph_jh512, sph_jh512_close},
+    {sph_keccak512_init, sph_keccak512, sph_keccak512_close},
+    {sph_skein512_init, sph_skein512, sph_skein512_close},
+    {sph_luffa512_init, sph_luffa512, sph_luffa512_close},
+    {sph_cubehash512_init, sph_cubehash512, sph_cubehash512_close},
+    {sph_shavite512_init, sph_shavite512, sph_shavite512_close},
+    {sph_simd512_init, sph_simd512, sph_simd512_close},
+    {sph_echo512_init, sph_echo512, sph_echo512_close},
+    {sph_hamsi512_init, sph_hamsi512, sph_hamsi512_close},
+    {sph_fugue512_init, sph_fugue512, sph_fugue512_close},
+    {sph_shabal512_init, sph_shabal512, sph_shabal512_close},
+    {sph_whirlpool_init, sph_whirlpool, sph_whirlpool_close},
+    {sph_sha512_init, sph_sha512, sph_sha512_close},
+};
+} // namespace
+
+X16RSchedule::X16RSchedule(const uint256& prev_block_hash) :
+    m_prev_block_hash(prev_block_hash)
 {
-    static ethash::epoch_context_ptr context{nullptr, nullptr};
-
-    // Get the context from the block height
-    const auto epoch_number = ethash::get_epoch_number(blockHeader.nHeight);
+    for (int i = 0; i < 16; ++i) {
+        m_selection[i] = GetHashSelection(prev_block_hash, i);
+        m_rounds[i] = &X16R_ALGORITHMS[m_selection[i]];
+    }
+}
 
-    if (!context || context->epoch_number != epoch_number)
-        context = ethash::create_epoch_context(epoch_number);
+uint256 X16RSchedule::Hash(const void* data, size_t len) const
+{
+    X16RContext ctx;
+    uint512 hash[2];
+
+    const void* toHash = data;
+    size_t lenToHash = len;
+    for (int i = 0; i < 16; ++i) {
+        // Ping-pong between two buffers, each round only reads the previous one
+        void* out = &hash[i & 1];
+        m_rounds[i]->init(&ctx);
+        m_rounds[i]->update(&ctx, toHash, lenToHash);
+        m_rounds[i]->close(&ctx, out);
+        toHash = out;
+        lenToHash = 64;
+    }
 
-    // Build the header_hash
-    uint256 nHeaderHash = blockHeader.GetKAWPOWHeaderHash();
-    const auto header_hash = to_hash256(nHeaderHash.GetHex());
+    return hash[1].trim256();
+}
 
-    // ProgPow hash
-    const auto result = progpow::hash(*context, blockHeader.nHeight, header_hash, blockHeader.nNonce64);
+uint256 KAWPOWHash(const CBlockHeader& blockHeader, uint256& mix_hash)
+{
+    const int epoch_number = ethash::get_epoch_number(blockHeader.nHeight);
+    TRACE2(pow, kawpow_hash_start,
+        blockHeader.nHeight,
+        epoch_number);
 
-    mix_hash = uint256S(to_hex(result.mix_hash));
-    return uint256S(to_hex(result.final_hash));
+    // Build the header_hash
+    const auto header_hash = UintToEthashHash(blockHeader.GetKAWPOWHeaderHash());
+
+    // ProgPow hash, straight from the full dataset with -kawpowfulldag once it is ready,
+    // otherwise from the light context shared with every other thread hashing this epoch
+    const auto full_context = g_kawpow_epoch_contexts.GetFullDataset(epoch_number);
+    const auto result = full_context ?
+        progpow::hash(*full_context, blockHeader.nHeight, header_hash, blockHeader.nNonce64) :
+        progpow::hash(*g_kawpow_epoch_contexts.Get(epoch_number), blockHeader.nHeight, header_hash, blockHeader.nNonce64);
+
+    mix_hash = EthashHashToUint(result.mix_hash);
+    const uint256 hash = EthashHashToUint(result.final_hash);
+    TRACE4(pow, kawpow_hash_done,
+        blockHeader.nHeight,
+        full_context != nullptr,
+        hash.data(),
+        mix_hash.data());
+    return hash;
 }
 
 uint256 KAWPOWHash_OnlyMix(const CBlockHeader& blockHeader)
 {
+    TRACE1(pow, kawpow_verify_start,
+        blockHeader.nHeight);
+
     // Build the header_hash
-    uint256 nHeaderHash = blockHeader.GetKAWPOWHeaderHash();
-    const auto header_hash = to_hash256(nHeaderHash.GetHex());
+    const auto header_hash = UintToEthashHash(blockHeader.GetKAWPOWHeaderHash());
 
     // ProgPow hash
-    const auto result = progpow::hash_no_verify(blockHeader.nHeight, header_hash, to_hash256(blockHeader.mix_hash.GetHex()), blockHeader.nNonce64);
+    const auto result = progpow::hash_no_verify(blockHeader.nHeight, header_hash, UintToEthashHash(blockHeader.mix_hash), blockHeader.nNonce64);
 
-    return uint256S(to_hex(result));
+    const uint256 hash = EthashHashToUint(result);
+    TRACE2(pow, kawpow_verify_done,
+        blockHeader.nHeight,
+        hash.data());
+    return hash;
 }
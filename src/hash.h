@@ -53,6 +53,8 @@
 #include "algo/gost_streebog.h"
 #include <crypto-X16R/ethash/helpers.hpp>
 
+#include <algorithm>
+#include <array>
 #include <vector>
 
 typedef uint256 ChainCode;
@@ -459,7 +461,71 @@ inline uint256 HashX11(const T1 pbegin, const T1 pend, const uint256 PrevBlockHa
     return hash[15].trim256();
 }
 
+/**
+ * X16R with the algorithm order worked out up front.
+ *
+ * The order of the 16 rounds only depends on hashPrevBlock, so a miner or
+ * validator hashing many headers on top of the same parent can build this once
+ * instead of calling GetHashSelection() and going through the switch in
+ * HashX11() for every round of every header. Results are identical to HashX11().
+ */
+class X16RSchedule
+{
+public:
+    struct Algorithm {
+        void (*init)(void* cc);
+        void (*update)(void* cc, const void* data, size_t len);
+        void (*close)(void* cc, void* dst);
+    };
+
+    explicit X16RSchedule(const uint256& prev_block_hash);
+
+    const uint256& GetPrevBlockHash() const { return m_prev_block_hash; }
+
+    /** Index into the HashX11() algorithm list used by the given round */
+    int GetSelection(int round) const { return m_selection[round]; }
+    const Algorithm& GetRound(int round) const { return *m_rounds[round]; }
+
+    uint256 Hash(const void* data, size_t len) const;
+
+    template<typename T1>
+    uint256 Hash(const T1 pbegin, const T1 pend) const
+    {
+        static unsigned char pblank[1];
+        return Hash(pbegin == pend ? pblank : static_cast<const void*>(&pbegin[0]), (pend - pbegin) * sizeof(pbegin[0]));
+    }
+
+private:
+    uint256 m_prev_block_hash;
+    std::array<uint8_t, 16> m_selection;
+    std::array<const Algorithm*, 16> m_rounds;
+};
+
+/* ----------- KAWPOW ------------------------------------------------ */
+
+/**
+ * ethash treats a hash as a big-endian byte string while uint256 keeps its
+ * bytes little-endian, so converting between the two is a plain byte reversal.
+ * This is equivalent to the to_hash256(GetHex()) / uint256S(to_hex()) pair
+ * without building and parsing hex strings on every header.
+ */
+inline ethash::hash256 UintToEthashHash(const uint256& hash)
+{
+    ethash::hash256 result;
+    std::reverse_copy(hash.begin(), hash.end(), result.bytes);
+    return result;
+}
+
+inline uint256 EthashHashToUint(const ethash::hash256& hash)
+{
+    uint256 result;
+    std::reverse_copy(std::begin(hash.bytes), std::end(hash.bytes), result.begin());
+    return result;
+}
+
+/** Full KAWPOW hash of a header and its mix hash, needs the epoch context of the header's height (mining, genesis) */
 uint256 KAWPOWHash(const CBlockHeader& blockHeader, uint256& mix_hash);
+/** KAWPOW hash from the header's own mix hash, this is what header validation uses and it needs no epoch context */
 uint256 KAWPOWHash_OnlyMix(const CBlockHeader& blockHeader);
 
 
@@ -156,7 +156,7 @@ uint256 CHDChain::GetSeedHash()
     return Hash(vchSeed);
 }
 
-void CHDChain::DeriveChildExtKey(uint32_t nAccountIndex, bool fInternal, uint32_t nChildIndex, CExtKey& extKeyRet, KeyOriginInfo& key_origin)
+void CHDChain::DeriveChangeExtKey(uint32_t nAccountIndex, bool fInternal, CExtKey& extKeyRet, KeyOriginInfo& key_origin)
 {
     LOCK(cs);
     // Use BIP44 keypath scheme i.e. m / purpose' / coin_type' / account' / change / address_index
@@ -164,8 +164,6 @@ void CHDChain::DeriveChildExtKey(uint32_t nAccountIndex, bool fInternal, uint32_
     CExtKey purposeKey;             //key at m/purpose'
     CExtKey cointypeKey;            //key at m/purpose'/coin_type'
     CExtKey accountKey;             //key at m/purpose'/coin_type'/account'
-    CExtKey changeKey;              //key at m/purpose'/coin_type'/account'/change
-    CExtKey childKey;               //key at m/purpose'/coin_type'/account'/change/address_index
 
     masterKey.SetSeed(vchSeed);
 
@@ -179,9 +177,7 @@ void CHDChain::DeriveChildExtKey(uint32_t nAccountIndex, bool fInternal, uint32_
     // derive m/purpose'/coin_type'/account'
     cointypeKey.Derive(accountKey, nAccountIndex | 0x80000000);
     // derive m/purpose'/coin_type'/account'/change
-    accountKey.Derive(changeKey, fInternal ? 1 : 0);
-    // derive m/purpose'/coin_type'/account'/change/address_index
-    changeKey.Derive(extKeyRet, nChildIndex);
+    accountKey.Derive(extKeyRet, fInternal ? 1 : 0);
 
 #ifdef ENABLE_WALLET
     // We should never ever update an already existing key_origin here
@@ -190,13 +186,25 @@ void CHDChain::DeriveChildExtKey(uint32_t nAccountIndex, bool fInternal, uint32_
     key_origin.path.push_back(Params().ExtCoinType() | 0x80000000);
     key_origin.path.push_back(nAccountIndex | 0x80000000);
     key_origin.path.push_back(fInternal ? 1 : 0);
-    key_origin.path.push_back(nChildIndex);
 
     CKeyID master_id = masterKey.key.GetPubKey().GetID();
     std::copy(master_id.begin(), master_id.begin() + 4, key_origin.fingerprint);
 #endif
 }
 
+void CHDChain::DeriveChildExtKey(uint32_t nAccountIndex, bool fInternal, uint32_t nChildIndex, CExtKey& extKeyRet, KeyOriginInfo& key_origin)
+{
+    CExtKey changeKey;              //key at m/purpose'/coin_type'/account'/change
+
+    DeriveChangeExtKey(nAccountIndex, fInternal, changeKey, key_origin);
+    // derive m/purpose'/coin_type'/account'/change/address_index
+    changeKey.Derive(extKeyRet, nChildIndex);
+
+#ifdef ENABLE_WALLET
+    key_origin.path.push_back(nChildIndex);
+#endif
+}
+
 void CHDChain::AddAccount()
 {
     LOCK(cs);
@@ -111,6 +111,8 @@ public:
     uint256 GetID() const { LOCK(cs); return id; }
 
     uint256 GetSeedHash();
+    /** Derive m/purpose'/coin_type'/account'/change, the keys of a chain are one non-hardened step from it */
+    void DeriveChangeExtKey(uint32_t nAccountIndex, bool fInternal, CExtKey& extKeyRet, KeyOriginInfo& key_origin);
     void DeriveChildExtKey(uint32_t nAccountIndex, bool fInternal, uint32_t nChildIndex, CExtKey& extKeyRet, KeyOriginInfo& key_origin);
 
     void AddAccount();
@@ -25,6 +25,9 @@
 /** WWW-Authenticate to present with 401 Unauthorized response */
 static const char* WWW_AUTH_HEADER_DATA = "Basic realm=\"jsonrpc\"";
 
+/** Largest request that is parsed to find its work class, larger ones go to the default work queue */
+static const size_t MAX_CLASSIFY_BODY_SIZE = 64 * 1024;
+
 /** Simple one-shot callback timer to be used by the RPC mechanism to e.g.
  * re-lock the wallet.
  */
@@ -89,7 +92,7 @@ static void JSONErrorReply(HTTPRequest* req, const UniValue& objError, const Uni
     std::string strReply = JSONRPCReply(NullUniValue, objError, id);
 
     req->WriteHeader("Content-Type", "application/json");
-    req->WriteReply(nStatus, strReply);
+    req->WriteReply(nStatus, std::move(strReply));
 }
 
 //This function checks username and password against -rpcauth
@@ -229,7 +232,7 @@ static bool HTTPReq_JSONRPC(const CoreContext& context, HTTPRequest* req)
             throw JSONRPCError(RPC_PARSE_ERROR, "Top-level object parse error");
 
         req->WriteHeader("Content-Type", "application/json");
-        req->WriteReply(HTTP_OK, strReply);
+        req->WriteReply(HTTP_OK, std::move(strReply));
     } catch (const UniValue& objError) {
         JSONErrorReply(req, objError, jreq.id);
         return false;
@@ -291,16 +294,52 @@ static bool InitRPCAuthentication()
     return true;
 }
 
+/** RPC methods, or "method subcommand", served by the slow work queue */
+static std::set<std::string> g_rpc_slow_methods;
+
+static bool IsSlowJSONRPCRequest(const UniValue& request)
+{
+    if (!request.isObject()) return false;
+    const UniValue& method = find_value(request, "method");
+    if (!method.isStr()) return false;
+    if (g_rpc_slow_methods.count(method.get_str())) return true;
+    const UniValue& params = find_value(request, "params");
+    return params.isArray() && !params.empty() && params[0].isStr() &&
+           g_rpc_slow_methods.count(method.get_str() + " " + params[0].get_str());
+}
+
+/** Queue requests to slow methods separately so they can't hold up the cheap ones */
+static HTTPWorkClass ClassifyJSONRPC(HTTPRequest* req, const std::string&)
+{
+    if (g_rpc_slow_methods.empty()) return HTTPWorkClass::DEFAULT;
+    UniValue valRequest;
+    if (!valRequest.read(req->PeekBody(MAX_CLASSIFY_BODY_SIZE))) return HTTPWorkClass::DEFAULT;
+    if (valRequest.isArray()) {
+        // A batch is as slow as its slowest request
+        for (size_t i = 0; i < valRequest.size(); ++i) {
+            if (IsSlowJSONRPCRequest(valRequest[i])) return HTTPWorkClass::SLOW;
+        }
+        return HTTPWorkClass::DEFAULT;
+    }
+    return IsSlowJSONRPCRequest(valRequest) ? HTTPWorkClass::SLOW : HTTPWorkClass::DEFAULT;
+}
+
 bool StartHTTPRPC(const CoreContext& context)
 {
     LogPrint(BCLog::RPC, "Starting HTTP RPC server\n");
     if (!InitRPCAuthentication())
         return false;
 
+    g_rpc_slow_methods.clear();
+    for (const std::string& method : SplitString(gArgs.GetArg("-rpcslowmethods", DEFAULT_RPC_SLOW_METHODS), ',')) {
+        const std::string trimmed{TrimString(method)};
+        if (!trimmed.empty()) g_rpc_slow_methods.insert(trimmed);
+    }
+
     auto handle_rpc = [&context](HTTPRequest* req, const std::string&) { return HTTPReq_JSONRPC(context, req); };
-    RegisterHTTPHandler("/", true, handle_rpc);
+    RegisterHTTPHandler("/", true, handle_rpc, ClassifyJSONRPC);
     if (g_wallet_init_interface.HasWalletSupport()) {
-        RegisterHTTPHandler("/wallet/", false, handle_rpc);
+        RegisterHTTPHandler("/wallet/", false, handle_rpc, ClassifyJSONRPC);
     }
     struct event_base* eventBase = EventBase();
     assert(eventBase);
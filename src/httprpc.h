@@ -7,6 +7,9 @@
 
 #include <context.h>
 
+/** RPC methods, or methods and their subcommand, served by the slow HTTP work queue by default */
+static const char* const DEFAULT_RPC_SLOW_METHODS = "getblock,getblockstats,gettxoutsetinfo,scantxoutset,getaddressdeltas,getaddresstxids,getaddressutxos,gobject list,protx list,protx diff";
+
 /** Start HTTP RPC subsystem.
  * Precondition; HTTP and RPC has been started.
  */
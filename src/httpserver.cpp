@@ -13,12 +13,15 @@
 #include <node/ui_interface.h>
 #include <rpc/protocol.h> // For HTTP status codes
 #include <shutdown.h>
+#include <statsd_client.h>
 #include <sync.h>
 #include <util/strencodings.h>
 #include <util/system.h>
 #include <util/threadnames.h>
+#include <util/time.h>
 #include <util/translation.h>
 
+#include <array>
 #include <deque>
 #include <stdio.h>
 #include <string>
@@ -39,17 +42,34 @@
 /** Maximum size of http request (request line + headers) */
 static const size_t MAX_HEADERS_SIZE = 8192;
 
+/** Name of a work class, used for thread names and metrics */
+static const char* HTTPWorkClassName(HTTPWorkClass work_class)
+{
+    switch (work_class) {
+    case HTTPWorkClass::DEFAULT:
+        return "default";
+    case HTTPWorkClass::SLOW:
+        return "slow";
+    }
+    assert(false);
+}
+
 /** HTTP request work item */
 class HTTPWorkItem final : public HTTPClosure
 {
 public:
-    HTTPWorkItem(std::unique_ptr<HTTPRequest> _req, const std::string &_path, const HTTPRequestHandler& _func):
-        req(std::move(_req)), path(_path), func(_func)
+    HTTPWorkItem(std::unique_ptr<HTTPRequest> _req, const std::string &_path, const HTTPRequestHandler& _func, HTTPWorkClass _work_class):
+        req(std::move(_req)), path(_path), func(_func), work_class(_work_class), queued(Now<SteadyMilliseconds>())
     {
     }
     void operator()() override
     {
+        const auto start = Now<SteadyMilliseconds>();
         func(req.get(), path);
+        const auto finish = Now<SteadyMilliseconds>();
+        const char* name = HTTPWorkClassName(work_class);
+        statsClient.timing(strprintf("http.workqueue.%s.wait_ms", name), count_milliseconds(start - queued), 1.0f);
+        statsClient.timing(strprintf("http.workqueue.%s.run_ms", name), count_milliseconds(finish - start), 1.0f);
     }
 
     std::unique_ptr<HTTPRequest> req;
@@ -57,6 +77,8 @@ public:
 private:
     std::string path;
     HTTPRequestHandler func;
+    HTTPWorkClass work_class;
+    SteadyMilliseconds queued;
 };
 
 /** Simple work queue for distributing work over multiple threads.
@@ -93,6 +115,12 @@ public:
         cond.notify_one();
         return true;
     }
+    /** Number of queued work items */
+    size_t Depth()
+    {
+        LOCK(cs);
+        return queue.size();
+    }
     /** Thread function */
     void Run()
     {
@@ -121,13 +149,14 @@ public:
 
 struct HTTPPathHandler
 {
-    HTTPPathHandler(std::string _prefix, bool _exactMatch, HTTPRequestHandler _handler):
-        prefix(_prefix), exactMatch(_exactMatch), handler(_handler)
+    HTTPPathHandler(std::string _prefix, bool _exactMatch, HTTPRequestHandler _handler, HTTPWorkClassifier _classifier):
+        prefix(_prefix), exactMatch(_exactMatch), handler(_handler), classifier(_classifier)
     {
     }
     std::string prefix;
     bool exactMatch;
     HTTPRequestHandler handler;
+    HTTPWorkClassifier classifier;
 };
 
 /** HTTP module state */
@@ -138,8 +167,11 @@ static struct event_base* eventBase = nullptr;
 static struct evhttp* eventHTTP = nullptr;
 //! List of subnets to allow RPC connections from
 static std::vector<CSubNet> rpc_allow_subnets;
-//! Work queue for handling longer requests off the event loop thread
-static std::unique_ptr<WorkQueue<HTTPClosure>> g_work_queue{nullptr};
+//! Work queues for handling longer requests off the event loop thread, by work class.
+//! A class without worker threads of its own has no queue and is served by the default one.
+static std::array<std::unique_ptr<WorkQueue<HTTPClosure>>, HTTP_WORK_CLASS_COUNT> g_work_queues;
+//! Number of worker threads for each work class
+static std::array<int, HTTP_WORK_CLASS_COUNT> g_work_threads{};
 //! Handlers for (sub)paths
 static std::vector<HTTPPathHandler> pathHandlers;
 //! Bound listening sockets
@@ -258,12 +290,19 @@ static void http_request_cb(struct evhttp_request* req, void* arg)
 
     // Dispatch to worker thread
     if (i != iend) {
-        auto item{std::make_unique<HTTPWorkItem>(std::move(hreq), path, i->handler)};
-        assert(g_work_queue);
-        if (g_work_queue->Enqueue(item.get())) {
+        HTTPWorkClass work_class = i->classifier ? i->classifier(hreq.get(), path) : HTTPWorkClass::DEFAULT;
+        if (!g_work_queues[static_cast<size_t>(work_class)]) {
+            work_class = HTTPWorkClass::DEFAULT;
+        }
+        auto& work_queue = g_work_queues[static_cast<size_t>(work_class)];
+        assert(work_queue);
+        auto item{std::make_unique<HTTPWorkItem>(std::move(hreq), path, i->handler, work_class)};
+        if (work_queue->Enqueue(item.get())) {
             item.release(); /* if true, queue took ownership */
+            statsClient.gauge(strprintf("http.workqueue.%s.depth", HTTPWorkClassName(work_class)), work_queue->Depth(), 1.0f);
         } else {
-            LogPrintf("WARNING: request rejected because http work queue depth exceeded, it can be increased with the -rpcworkqueue= setting\n");
+            LogPrintf("WARNING: request rejected because http %s work queue depth exceeded, it can be increased with the -rpcworkqueue= setting\n", HTTPWorkClassName(work_class));
+            statsClient.inc(strprintf("http.workqueue.%s.rejected", HTTPWorkClassName(work_class)), 1.0f);
             item->req->WriteReply(HTTP_SERVICE_UNAVAILABLE, "Work queue depth exceeded");
         }
     } else {
@@ -335,9 +374,9 @@ static bool HTTPBindAddresses(struct evhttp* http)
 }
 
 /** Simple wrapper to set thread name and run work queue */
-static void HTTPWorkQueueRun(WorkQueue<HTTPClosure>* queue, int worker_num)
+static void HTTPWorkQueueRun(WorkQueue<HTTPClosure>* queue, std::string thread_name)
 {
-    util::ThreadRename(strprintf("httpworker.%i", worker_num));
+    util::ThreadRename(std::move(thread_name));
     queue->Run();
 }
 
@@ -393,9 +432,14 @@ bool InitHTTPServer()
 
     LogPrint(BCLog::HTTP, "Initialized HTTP server\n");
     int workQueueDepth = std::max((long)gArgs.GetArg("-rpcworkqueue", DEFAULT_HTTP_WORKQUEUE), 1L);
-    LogPrintf("HTTP: creating work queue of depth %d\n", workQueueDepth);
+    g_work_threads[static_cast<size_t>(HTTPWorkClass::DEFAULT)] = std::max((long)gArgs.GetArg("-rpcthreads", DEFAULT_HTTP_THREADS), 1L);
+    g_work_threads[static_cast<size_t>(HTTPWorkClass::SLOW)] = std::max((long)gArgs.GetArg("-rpcslowthreads", DEFAULT_HTTP_SLOW_THREADS), 0L);
 
-    g_work_queue = std::make_unique<WorkQueue<HTTPClosure>>(workQueueDepth);
+    for (size_t i = 0; i < HTTP_WORK_CLASS_COUNT; ++i) {
+        if (g_work_threads[i] == 0) continue;
+        LogPrintf("HTTP: creating %s work queue of depth %d\n", HTTPWorkClassName(static_cast<HTTPWorkClass>(i)), workQueueDepth);
+        g_work_queues[i] = std::make_unique<WorkQueue<HTTPClosure>>(workQueueDepth);
+    }
     // transfer ownership to eventBase/HTTP via .release()
     eventBase = base_ctr.release();
     eventHTTP = http_ctr.release();
@@ -422,12 +466,17 @@ static std::vector<std::thread> g_thread_http_workers;
 void StartHTTPServer()
 {
     LogPrint(BCLog::HTTP, "Starting HTTP server\n");
-    int rpcThreads = std::max((long)gArgs.GetArg("-rpcthreads", DEFAULT_HTTP_THREADS), 1L);
-    LogPrintf("HTTP: starting %d worker threads\n", rpcThreads);
     g_thread_http = std::thread(ThreadHTTP, eventBase);
 
-    for (int i = 0; i < rpcThreads; i++) {
-        g_thread_http_workers.emplace_back(HTTPWorkQueueRun, g_work_queue.get(), i);
+    for (size_t i = 0; i < HTTP_WORK_CLASS_COUNT; ++i) {
+        if (!g_work_queues[i]) continue;
+        const auto work_class = static_cast<HTTPWorkClass>(i);
+        LogPrintf("HTTP: starting %d %s worker threads\n", g_work_threads[i], HTTPWorkClassName(work_class));
+        for (int j = 0; j < g_work_threads[i]; j++) {
+            // Keep the name of the default workers as it was, thread names are short
+            const std::string thread_name = work_class == HTTPWorkClass::DEFAULT ? strprintf("httpworker.%i", j) : strprintf("http%s.%i", HTTPWorkClassName(work_class), j);
+            g_thread_http_workers.emplace_back(HTTPWorkQueueRun, g_work_queues[i].get(), thread_name);
+        }
     }
 }
 
@@ -438,15 +487,17 @@ void InterruptHTTPServer()
         // Reject requests on current connections
         evhttp_set_gencb(eventHTTP, http_reject_request_cb, nullptr);
     }
-    if (g_work_queue) {
-        g_work_queue->Interrupt();
+    for (auto& work_queue : g_work_queues) {
+        if (work_queue) {
+            work_queue->Interrupt();
+        }
     }
 }
 
 void StopHTTPServer()
 {
     LogPrint(BCLog::HTTP, "Stopping HTTP server\n");
-    if (g_work_queue) {
+    if (!g_thread_http_workers.empty()) {
         LogPrint(BCLog::HTTP, "Waiting for HTTP worker threads to exit\n");
         for (auto& thread : g_thread_http_workers) {
             thread.join();
@@ -471,7 +522,9 @@ void StopHTTPServer()
         event_base_free(eventBase);
         eventBase = nullptr;
     }
-    g_work_queue.reset();
+    for (auto& work_queue : g_work_queues) {
+        work_queue.reset();
+    }
     LogPrint(BCLog::HTTP, "Stopped HTTP server\n");
 }
 
@@ -551,6 +604,21 @@ std::string HTTPRequest::ReadBody()
     return rv;
 }
 
+std::string HTTPRequest::PeekBody(size_t max_size) const
+{
+    struct evbuffer* buf = evhttp_request_get_input_buffer(req);
+    if (!buf)
+        return "";
+    size_t size = evbuffer_get_length(buf);
+    if (size > max_size)
+        return "";
+    // Copies the body out of a multi-segment buffer without draining it
+    std::string rv(size, '\0');
+    if (evbuffer_copyout(buf, rv.data(), size) != static_cast<ev_ssize_t>(size))
+        return "";
+    return rv;
+}
+
 void HTTPRequest::WriteHeader(const std::string& hdr, const std::string& value)
 {
     struct evkeyvalq* headers = evhttp_request_get_output_headers(req);
@@ -564,15 +632,42 @@ void HTTPRequest::WriteHeader(const std::string& hdr, const std::string& value)
  * this cannot be done from worker threads.
  */
 void HTTPRequest::WriteReply(int nStatus, const std::string& strReply)
+{
+    WriteReply(nStatus, MakeByteSpan(strReply));
+}
+
+void HTTPRequest::WriteReply(int nStatus, Span<const std::byte> reply)
+{
+    assert(!replySent && req);
+    struct evbuffer* evb = evhttp_request_get_output_buffer(req);
+    assert(evb);
+    evbuffer_add(evb, reply.data(), reply.size());
+    SendReply(nStatus);
+}
+
+void HTTPRequest::WriteReply(int nStatus, std::string&& strReply)
 {
     assert(!replySent && req);
+    struct evbuffer* evb = evhttp_request_get_output_buffer(req);
+    assert(evb);
+    if (!strReply.empty()) {
+        // The buffer references the string until the reply is sent, then frees it
+        auto* reply = new std::string(std::move(strReply));
+        if (evbuffer_add_reference(evb, reply->data(), reply->size(),
+                                   [](const void*, size_t, void* arg) { delete static_cast<std::string*>(arg); }, reply) != 0) {
+            evbuffer_add(evb, reply->data(), reply->size());
+            delete reply;
+        }
+    }
+    SendReply(nStatus);
+}
+
+void HTTPRequest::SendReply(int nStatus)
+{
     if (ShutdownRequested()) {
         WriteHeader("Connection", "close");
     }
     // Send event to main http thread to send reply message
-    struct evbuffer* evb = evhttp_request_get_output_buffer(req);
-    assert(evb);
-    evbuffer_add(evb, strReply.data(), strReply.size());
     auto req_copy = req;
     HTTPEvent* ev = new HTTPEvent(eventBase, true, [req_copy, nStatus]{
         evhttp_send_reply(req_copy, nStatus, nullptr, nullptr);
@@ -639,10 +734,10 @@ HTTPRequest::RequestMethod HTTPRequest::GetRequestMethod() const
     }
 }
 
-void RegisterHTTPHandler(const std::string &prefix, bool exactMatch, const HTTPRequestHandler &handler)
+void RegisterHTTPHandler(const std::string &prefix, bool exactMatch, const HTTPRequestHandler &handler, const HTTPWorkClassifier &classifier)
 {
     LogPrint(BCLog::HTTP, "Registering HTTP handler for %s (exactmatch %d)\n", prefix, exactMatch);
-    pathHandlers.push_back(HTTPPathHandler(prefix, exactMatch, handler));
+    pathHandlers.push_back(HTTPPathHandler(prefix, exactMatch, handler, classifier));
 }
 
 void UnregisterHTTPHandler(const std::string &prefix, bool exactMatch)
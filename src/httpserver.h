@@ -5,10 +5,13 @@
 #ifndef BITCOIN_HTTPSERVER_H
 #define BITCOIN_HTTPSERVER_H
 
+#include <span.h>
+
 #include <string>
 #include <functional>
 
 static const int DEFAULT_HTTP_THREADS=4;
+static const int DEFAULT_HTTP_SLOW_THREADS=2;
 static const int DEFAULT_HTTP_WORKQUEUE=16;
 static const int DEFAULT_HTTP_SERVER_TIMEOUT=30;
 
@@ -35,13 +38,23 @@ void StopHTTPServer();
  * libevent doesn't support debug logging.*/
 bool UpdateHTTPServerLogging(bool enable);
 
+/** Class of the work of a request, each class is served by a work queue and worker threads of its own */
+enum class HTTPWorkClass {
+    DEFAULT,
+    SLOW,
+};
+static constexpr size_t HTTP_WORK_CLASS_COUNT = 2;
+
 /** Handler for requests to a certain HTTP path */
 typedef std::function<bool(HTTPRequest* req, const std::string &)> HTTPRequestHandler;
+/** Classifier for requests to a certain HTTP path, called on the event loop thread before the request is queued */
+typedef std::function<HTTPWorkClass(HTTPRequest* req, const std::string &)> HTTPWorkClassifier;
 /** Register handler for prefix.
  * If multiple handlers match a prefix, the first-registered one will
- * be invoked.
+ * be invoked. Requests are queued as HTTPWorkClass::DEFAULT unless a
+ * classifier is given.
  */
-void RegisterHTTPHandler(const std::string &prefix, bool exactMatch, const HTTPRequestHandler &handler);
+void RegisterHTTPHandler(const std::string &prefix, bool exactMatch, const HTTPRequestHandler &handler, const HTTPWorkClassifier &classifier = nullptr);
 /** Unregister handler for prefix */
 void UnregisterHTTPHandler(const std::string &prefix, bool exactMatch);
 
@@ -59,6 +72,9 @@ private:
     struct evhttp_request* req;
     bool replySent;
 
+    /** Send the reply in the output buffer from the main http thread */
+    void SendReply(int nStatus);
+
 public:
     explicit HTTPRequest(struct evhttp_request* req, bool replySent = false);
     ~HTTPRequest();
@@ -97,6 +113,13 @@ public:
      */
     std::string ReadBody();
 
+    /**
+     * Read request body without consuming it.
+     *
+     * @note Returns an empty string if the body is larger than max_size.
+     */
+    std::string PeekBody(size_t max_size) const;
+
     /**
      * Write output header.
      *
@@ -113,6 +136,9 @@ public:
      * main thread, do not call any other HTTPRequest methods after calling this.
      */
     void WriteReply(int nStatus, const std::string& strReply = "");
+    void WriteReply(int nStatus, Span<const std::byte> reply);
+    /** Hands strReply to libevent instead of copying it, for large replies */
+    void WriteReply(int nStatus, std::string&& strReply);
 };
 
 /** Event handler closure.
@@ -0,0 +1,284 @@
+// Copyright (c) 2026 The Dash Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <index/addressindex.h>
+
+#include <chain.h>
+#include <chainparams.h>
+#include <compressor.h>
+#include <node/blockstorage.h>
+#include <undo.h>
+#include <util/system.h>
+
+#include <map>
+#include <set>
+
+static constexpr uint8_t DB_ADDRESSINDEX{'a'};
+static constexpr uint8_t DB_ADDRESSUNSPENTINDEX{'u'};
+static constexpr uint8_t DB_ADDRESSBALANCE{'b'};
+
+namespace {
+
+/** Unspent outputs are stored with their amount and script compressed like in the UTXO set */
+struct AddressUnspentValueCompression
+{
+    FORMATTER_METHODS(CAddressUnspentValue, obj)
+    {
+        READWRITE(Using<AmountCompression>(obj.m_amount), Using<ScriptCompression>(obj.m_tx_script),
+                  VARINT_MODE(obj.m_block_height, VarIntMode::NONNEGATIVE_SIGNED));
+    }
+};
+
+/**
+ * Balance changes are stored as their compressed magnitude, the sign follows
+ * from whether the key records a spend.
+ */
+bool ReadAddressDelta(CDBIterator& cursor, const CAddressIndexKey& key, CAmount& amount)
+{
+    auto value = Using<AmountCompression>(amount);
+    if (!cursor.GetValue(value)) {
+        return false;
+    }
+    if (key.m_tx_spent) {
+        amount = -amount;
+    }
+    return true;
+}
+
+} // namespace
+
+std::unique_ptr<AddressIndex> g_addressindex;
+
+AddressIndex::AddressIndex(size_t n_cache_size, bool f_memory, bool f_wipe)
+    : m_db(std::make_unique<BaseIndex::DB>(GetDataDir() / "indexes" / "addressindex", n_cache_size, f_memory, f_wipe))
+{}
+
+bool AddressIndex::UpdateBlock(const CBlock& block, const CBlockUndo& block_undo, const CBlockIndex* pindex, bool revert)
+{
+    if (block_undo.vtxundo.size() + 1 != block.vtx.size()) {
+        return error("%s: block and undo data inconsistent for %s", __func__, pindex->GetBlockHash().ToString());
+    }
+
+    CDBBatch batch(*m_db);
+
+    // Changes of the balance summaries of all addresses in the block, which are
+    // added when connecting and subtracted when reverting the block
+    std::map<CAddressIndexIteratorKey, CAddressBalance> balance_changes;
+
+    for (size_t n = 0; n < block.vtx.size(); n++) {
+        // Transactions are reverted in reverse order, an output may have been spent later in the same block
+        const unsigned int i = revert ? block.vtx.size() - 1 - n : n;
+        const CTransaction& tx = *block.vtx[i];
+        const uint256 txhash = tx.GetHash();
+        std::set<CAddressIndexIteratorKey> tx_addresses;
+
+        if (i > 0) { // not coinbases
+            const CTxUndo& txundo = block_undo.vtxundo[i - 1];
+            if (txundo.vprevout.size() != tx.vin.size()) {
+                return error("%s: transaction and undo data inconsistent for %s", __func__, txhash.ToString());
+            }
+            for (unsigned int j = 0; j < tx.vin.size(); j++) {
+                const COutPoint& prevout = tx.vin[j].prevout;
+                const Coin& coin = txundo.vprevout[j];
+
+                AddressType address_type{AddressType::UNKNOWN};
+                uint160 address_bytes;
+
+                if (!AddressBytesFromScript(coin.out.scriptPubKey, address_type, address_bytes)) {
+                    continue;
+                }
+
+                const auto key = std::make_pair(DB_ADDRESSINDEX, CAddressIndexKey(address_type, address_bytes, pindex->nHeight, i, txhash, j, true));
+                const auto unspent_key = std::make_pair(DB_ADDRESSUNSPENTINDEX, CAddressUnspentKey(address_type, address_bytes, prevout.hash, prevout.n));
+                if (revert) {
+                    // undo spending activity and restore unspent index
+                    batch.Erase(key);
+                    batch.Write(unspent_key, Using<AddressUnspentValueCompression>(CAddressUnspentValue(coin.out.nValue, coin.out.scriptPubKey, coin.nHeight)));
+                } else {
+                    // record spending activity and remove address from unspent index
+                    batch.Write(key, Using<AmountCompression>(coin.out.nValue));
+                    batch.Erase(unspent_key);
+                }
+
+                const CAddressIndexIteratorKey address(address_type, address_bytes);
+                balance_changes[address].m_balance -= coin.out.nValue;
+                tx_addresses.insert(address);
+            }
+        }
+
+        for (unsigned int k = 0; k < tx.vout.size(); k++) {
+            const CTxOut& out = tx.vout[k];
+
+            AddressType address_type{AddressType::UNKNOWN};
+            uint160 address_bytes;
+
+            if (!AddressBytesFromScript(out.scriptPubKey, address_type, address_bytes)) {
+                continue;
+            }
+
+            const auto key = std::make_pair(DB_ADDRESSINDEX, CAddressIndexKey(address_type, address_bytes, pindex->nHeight, i, txhash, k, false));
+            const auto unspent_key = std::make_pair(DB_ADDRESSUNSPENTINDEX, CAddressUnspentKey(address_type, address_bytes, txhash, k));
+            if (revert) {
+                // undo receiving activity and unspent index
+                batch.Erase(key);
+                batch.Erase(unspent_key);
+            } else {
+                // record receiving activity and unspent output
+                batch.Write(key, Using<AmountCompression>(out.nValue));
+                batch.Write(unspent_key, Using<AddressUnspentValueCompression>(CAddressUnspentValue(out.nValue, out.scriptPubKey, pindex->nHeight)));
+            }
+
+            const CAddressIndexIteratorKey address(address_type, address_bytes);
+            balance_changes[address].m_balance += out.nValue;
+            balance_changes[address].m_received += out.nValue;
+            tx_addresses.insert(address);
+        }
+
+        for (const auto& address : tx_addresses) {
+            ++balance_changes[address].m_tx_count;
+        }
+    }
+
+    // update the balance summaries in the same batch
+    for (const auto& [address, change] : balance_changes) {
+        CAddressBalance balance;
+        if (!FindAddressBalance(address.m_address_bytes, address.m_address_type, balance)) {
+            return error("%s: failed to read balance of address", __func__);
+        }
+        if (revert) {
+            balance = CAddressBalance(balance.m_balance - change.m_balance, balance.m_received - change.m_received, balance.m_tx_count - change.m_tx_count);
+        } else {
+            balance = CAddressBalance(balance.m_balance + change.m_balance, balance.m_received + change.m_received, balance.m_tx_count + change.m_tx_count);
+        }
+        const auto key = std::make_pair(DB_ADDRESSBALANCE, address);
+        if (balance.IsNull()) {
+            batch.Erase(key);
+        } else {
+            batch.Write(key, balance);
+        }
+    }
+
+    return m_db->WriteBatch(batch);
+}
+
+bool AddressIndex::WriteBlock(const CBlock& block, const CBlockIndex* pindex)
+{
+    // The outputs of the genesis block are not spendable and never were indexed
+    if (pindex->nHeight == 0) {
+        return true;
+    }
+
+    CBlockUndo block_undo;
+    if (!UndoReadFromDisk(block_undo, pindex)) {
+        return error("%s: Failed to read undo data of block %s", __func__, pindex->GetBlockHash().ToString());
+    }
+
+    return UpdateBlock(block, block_undo, pindex, /* revert */ false);
+}
+
+bool AddressIndex::Rewind(const CBlockIndex* current_tip, const CBlockIndex* new_tip)
+{
+    assert(current_tip->GetAncestor(new_tip->nHeight) == new_tip);
+
+    const auto& consensus_params{Params().GetConsensus()};
+    for (const CBlockIndex* iter_tip = current_tip; iter_tip != new_tip; iter_tip = iter_tip->pprev) {
+        CBlock block;
+        CBlockUndo block_undo;
+        if (!ReadBlockFromDisk(block, iter_tip, consensus_params) || !UndoReadFromDisk(block_undo, iter_tip)) {
+            return error("%s: Failed to read block %s from disk", __func__, iter_tip->GetBlockHash().ToString());
+        }
+        if (!UpdateBlock(block, block_undo, iter_tip, /* revert */ true)) {
+            return false;
+        }
+    }
+
+    return BaseIndex::Rewind(current_tip, new_tip);
+}
+
+bool AddressIndex::FindAddressIndex(const uint160& addressHash, AddressType type,
+                                    std::vector<std::pair<CAddressIndexKey, CAmount> >& addressIndex,
+                                    int start, int end,
+                                    const std::optional<CAddressIndexKey>& after, size_t max_count) const
+{
+    std::unique_ptr<CDBIterator> pcursor(m_db->NewIterator());
+
+    if (after && (start <= 0 || end <= 0 || after->m_block_height >= start)) {
+        pcursor->Seek(std::make_pair(DB_ADDRESSINDEX, *after));
+    } else if (start > 0 && end > 0) {
+        pcursor->Seek(std::make_pair(DB_ADDRESSINDEX, CAddressIndexIteratorHeightKey(type, addressHash, start)));
+    } else {
+        pcursor->Seek(std::make_pair(DB_ADDRESSINDEX, CAddressIndexIteratorKey(type, addressHash)));
+    }
+
+    for (size_t count = 0; count < max_count && pcursor->Valid();) {
+        std::pair<uint8_t, CAddressIndexKey> key;
+        if (pcursor->GetKey(key) && key.first == DB_ADDRESSINDEX && key.second.m_address_bytes == addressHash) {
+            if (end > 0 && key.second.m_block_height > end) {
+                break;
+            }
+            if (after && key.second == *after) {
+                pcursor->Next();
+                continue;
+            }
+            ++count;
+            CAmount nValue;
+            if (ReadAddressDelta(*pcursor, key.second, nValue)) {
+                addressIndex.push_back(std::make_pair(key.second, nValue));
+                pcursor->Next();
+            } else {
+                return error("failed to get address index value");
+            }
+        } else {
+            break;
+        }
+    }
+
+    return true;
+}
+
+bool AddressIndex::FindAddressUnspent(const uint160& addressHash, AddressType type,
+                                      std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> >& unspentOutputs,
+                                      const std::optional<CAddressUnspentKey>& after, size_t max_count) const
+{
+    std::unique_ptr<CDBIterator> pcursor(m_db->NewIterator());
+
+    if (after) {
+        pcursor->Seek(std::make_pair(DB_ADDRESSUNSPENTINDEX, *after));
+    } else {
+        pcursor->Seek(std::make_pair(DB_ADDRESSUNSPENTINDEX, CAddressIndexIteratorKey(type, addressHash)));
+    }
+
+    for (size_t count = 0; count < max_count && pcursor->Valid();) {
+        std::pair<uint8_t, CAddressUnspentKey> key;
+        if (pcursor->GetKey(key) && key.first == DB_ADDRESSUNSPENTINDEX && key.second.m_address_bytes == addressHash) {
+            if (after && key.second == *after) {
+                pcursor->Next();
+                continue;
+            }
+            ++count;
+            CAddressUnspentValue nValue;
+            auto value = Using<AddressUnspentValueCompression>(nValue);
+            if (pcursor->GetValue(value)) {
+                unspentOutputs.push_back(std::make_pair(key.second, nValue));
+                pcursor->Next();
+            } else {
+                return error("failed to get address unspent value");
+            }
+        } else {
+            break;
+        }
+    }
+
+    return true;
+}
+
+bool AddressIndex::FindAddressBalance(const uint160& addressHash, AddressType type, CAddressBalance& balance) const
+{
+    const auto key = std::make_pair(DB_ADDRESSBALANCE, CAddressIndexIteratorKey(type, addressHash));
+    if (!m_db->Exists(key)) {
+        balance = CAddressBalance();
+        return true;
+    }
+    return m_db->Read(key, balance);
+}
@@ -0,0 +1,64 @@
+// Copyright (c) 2026 The Dash Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_INDEX_ADDRESSINDEX_H
+#define BITCOIN_INDEX_ADDRESSINDEX_H
+
+#include <addressindex.h>
+#include <index/base.h>
+#include <spentindex.h>
+
+#include <limits>
+#include <optional>
+#include <vector>
+
+class CBlockUndo;
+
+/**
+ * AddressIndex records all changes to the balance of an address as well as
+ * its unspent outputs, used by the getaddress* RPCs.
+ */
+class AddressIndex final : public BaseIndex
+{
+private:
+    std::unique_ptr<BaseIndex::DB> m_db;
+
+    /// Write the changes of a block, or erase them again when reverting it
+    bool UpdateBlock(const CBlock& block, const CBlockUndo& block_undo, const CBlockIndex* pindex, bool revert);
+
+protected:
+    bool WriteBlock(const CBlock& block, const CBlockIndex* pindex) override;
+
+    bool Rewind(const CBlockIndex* current_tip, const CBlockIndex* new_tip) override;
+
+    BaseIndex::DB& GetDB() const override { return *m_db; }
+
+    const char* GetName() const override { return "addressindex"; }
+
+public:
+    /// Constructs the index, which becomes available to be queried.
+    explicit AddressIndex(size_t n_cache_size, bool f_memory = false, bool f_wipe = false);
+
+    /// Look up up to max_count balance changes of an address, following the key `after` if it is set.
+    /// A positive start and end limit the changes to that range of heights.
+    bool FindAddressIndex(const uint160& addressHash, AddressType type,
+                          std::vector<std::pair<CAddressIndexKey, CAmount> >& addressIndex,
+                          int start = 0, int end = 0,
+                          const std::optional<CAddressIndexKey>& after = std::nullopt,
+                          size_t max_count = std::numeric_limits<size_t>::max()) const;
+
+    /// Look up up to max_count unspent outputs of an address, following the key `after` if it is set.
+    bool FindAddressUnspent(const uint160& addressHash, AddressType type,
+                            std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> >& unspentOutputs,
+                            const std::optional<CAddressUnspentKey>& after = std::nullopt,
+                            size_t max_count = std::numeric_limits<size_t>::max()) const;
+
+    /// Look up the balance summary of an address, which is empty if the address was never used.
+    bool FindAddressBalance(const uint160& addressHash, AddressType type, CAddressBalance& balance) const;
+};
+
+/// The global address index, used by the getaddress* RPCs. May be null.
+extern std::unique_ptr<AddressIndex> g_addressindex;
+
+#endif // BITCOIN_INDEX_ADDRESSINDEX_H
@@ -129,8 +129,6 @@ void BaseIndex::ThreadSync()
 {
     const CBlockIndex* pindex = m_best_block_index.load();
     if (!m_synced) {
-        auto& consensus_params = Params().GetConsensus();
-
         std::chrono::steady_clock::time_point last_log_time{0s};
         std::chrono::steady_clock::time_point last_locator_write_time{0s};
         while (true) {
@@ -143,6 +141,7 @@ void BaseIndex::ThreadSync()
                 return;
             }
 
+            std::vector<const CBlockIndex*> block_indexes;
             {
                 LOCK(cs_main);
                 const CBlockIndex* pindex_next = NextSyncBlock(pindex, m_chainstate->m_chain);
@@ -158,34 +157,35 @@ void BaseIndex::ThreadSync()
                                __func__, GetName());
                     return;
                 }
-                pindex = pindex_next;
+                // The following blocks are successors on the active chain, no rewind is needed in between
+                const size_t batch_size = GetSyncBatchSize();
+                do {
+                    block_indexes.push_back(pindex_next);
+                    pindex_next = m_chainstate->m_chain.Next(pindex_next);
+                } while (pindex_next && block_indexes.size() < batch_size);
             }
 
             auto current_time{std::chrono::steady_clock::now()};
             if (last_log_time + SYNC_LOG_INTERVAL < current_time) {
                 LogPrintf("Syncing %s with block chain from height %d\n",
-                          GetName(), pindex->nHeight);
+                          GetName(), block_indexes.front()->nHeight);
                 last_log_time = current_time;
             }
 
+            if (!SyncBlocks(block_indexes)) {
+                FatalError("%s: Failed to write blocks %s to %s to index database",
+                           __func__, block_indexes.front()->GetBlockHash().ToString(),
+                           block_indexes.back()->GetBlockHash().ToString());
+                return;
+            }
+            pindex = block_indexes.back();
+
             if (last_locator_write_time + SYNC_LOCATOR_WRITE_INTERVAL < current_time) {
                 m_best_block_index = pindex;
                 last_locator_write_time = current_time;
                 // No need to handle errors in Commit. See rationale above.
                 Commit();
             }
-
-            CBlock block;
-            if (!ReadBlockFromDisk(block, pindex, consensus_params)) {
-                FatalError("%s: Failed to read block %s from disk",
-                           __func__, pindex->GetBlockHash().ToString());
-                return;
-            }
-            if (!WriteBlock(block, pindex)) {
-                FatalError("%s: Failed to write block %s to index database",
-                           __func__, pindex->GetBlockHash().ToString());
-                return;
-            }
         }
     }
 
@@ -196,6 +196,23 @@ void BaseIndex::ThreadSync()
     }
 }
 
+bool BaseIndex::SyncBlocks(const std::vector<const CBlockIndex*>& block_indexes)
+{
+    BlockReadAhead reader(block_indexes, /* read_undo */ false, Params().GetConsensus());
+    for (const CBlockIndex* pindex : block_indexes) {
+        CBlock block;
+        if (!reader.Next(block)) {
+            return error("%s: Failed to read block %s from disk",
+                         __func__, pindex->GetBlockHash().ToString());
+        }
+        if (!WriteBlock(block, pindex)) {
+            return error("%s: Failed to write block %s to index database",
+                         __func__, pindex->GetBlockHash().ToString());
+        }
+    }
+    return true;
+}
+
 bool BaseIndex::Commit()
 {
     CDBBatch batch(GetDB());
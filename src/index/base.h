@@ -12,6 +12,7 @@
 #include <validationinterface.h>
 
 #include <atomic>
+#include <vector>
 
 class CBlockIndex;
 class CChainState;
@@ -97,6 +98,13 @@ protected:
     /// Write update index entries for a newly connected block.
     virtual bool WriteBlock(const CBlock& block, const CBlockIndex* pindex) { return true; }
 
+    /// Maximum number of blocks handed to SyncBlocks() at once while the index is catching up.
+    virtual size_t GetSyncBatchSize() const { return 32; }
+
+    /// Write index entries for consecutive blocks of the active chain while the index is catching
+    /// up, in order of height. Reads the blocks ahead and calls WriteBlock() for each by default.
+    virtual bool SyncBlocks(const std::vector<const CBlockIndex*>& block_indexes);
+
     /// Virtual method called internally by Commit that can be overridden to atomically
     /// commit more index state.
     virtual bool CommitInternal(CDBBatch& batch);
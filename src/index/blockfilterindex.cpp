@@ -2,12 +2,19 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include <algorithm>
+#include <future>
 #include <map>
+#include <optional>
 
+#include <chainparams.h>
+#include <ctpl_stl.h>
 #include <dbwrapper.h>
 #include <index/blockfilterindex.h>
 #include <node/blockstorage.h>
 #include <serialize.h>
+#include <undo.h>
+#include <util/system.h>
 
 /* The index database stores three items for each block: the disk location of the encoded filter,
  * its dSHA256 hash, and the header. Those belonging to blocks on the active chain are indexed by
@@ -212,49 +219,111 @@ size_t BlockFilterIndex::WriteFilterToDisk(FlatFilePos& pos, const BlockFilter&
     return data_size;
 }
 
-bool BlockFilterIndex::WriteBlock(const CBlock& block, const CBlockIndex* pindex)
+bool BlockFilterIndex::ReadPrevHeader(const CBlockIndex* pindex, uint256& prev_header) const
 {
-    CBlockUndo block_undo;
-    uint256 prev_header;
-
-    if (pindex->nHeight > 0) {
-        if (!UndoReadFromDisk(block_undo, pindex)) {
-            return false;
-        }
-
-        std::pair<uint256, DBVal> read_out;
-        if (!m_db->Read(DBHeightKey(pindex->nHeight - 1), read_out)) {
-            return false;
-        }
+    if (pindex->nHeight == 0) {
+        prev_header.SetNull();
+        return true;
+    }
 
-        uint256 expected_block_hash = pindex->pprev->GetBlockHash();
-        if (read_out.first != expected_block_hash) {
-            return error("%s: previous block header belongs to unexpected block %s; expected %s",
-                         __func__, read_out.first.ToString(), expected_block_hash.ToString());
-        }
+    std::pair<uint256, DBVal> read_out;
+    if (!m_db->Read(DBHeightKey(pindex->nHeight - 1), read_out)) {
+        return false;
+    }
 
-        prev_header = read_out.second.header;
+    uint256 expected_block_hash = pindex->pprev->GetBlockHash();
+    if (read_out.first != expected_block_hash) {
+        return error("%s: previous block header belongs to unexpected block %s; expected %s",
+                     __func__, read_out.first.ToString(), expected_block_hash.ToString());
     }
 
-    BlockFilter filter(m_filter_type, block, block_undo);
+    prev_header = read_out.second.header;
+    return true;
+}
 
+bool BlockFilterIndex::WriteFilter(CDBBatch& batch, const CBlockIndex* pindex, const BlockFilter& filter, uint256& header)
+{
     size_t bytes_written = WriteFilterToDisk(m_next_filter_pos, filter);
     if (bytes_written == 0) return false;
 
     std::pair<uint256, DBVal> value;
     value.first = pindex->GetBlockHash();
     value.second.hash = filter.GetHash();
-    value.second.header = filter.ComputeHeader(prev_header);
+    value.second.header = filter.ComputeHeader(header);
     value.second.pos = m_next_filter_pos;
 
-    if (!m_db->Write(DBHeightKey(pindex->nHeight), value)) {
-        return false;
-    }
+    batch.Write(DBHeightKey(pindex->nHeight), value);
+    WITH_LOCK(m_cs_recent_cache, m_recent_cache.insert(value.first, {value.second.hash, value.second.header}));
 
+    header = value.second.header;
     m_next_filter_pos.nPos += bytes_written;
     return true;
 }
 
+bool BlockFilterIndex::WriteBlock(const CBlock& block, const CBlockIndex* pindex)
+{
+    CBlockUndo block_undo;
+    if (pindex->nHeight > 0 && !UndoReadFromDisk(block_undo, pindex)) {
+        return false;
+    }
+
+    uint256 header;
+    if (!ReadPrevHeader(pindex, header)) {
+        return false;
+    }
+
+    CDBBatch batch(*m_db);
+    if (!WriteFilter(batch, pindex, BlockFilter(m_filter_type, block, block_undo), header)) {
+        return false;
+    }
+    return m_db->WriteBatch(batch);
+}
+
+bool BlockFilterIndex::SyncBlocks(const std::vector<const CBlockIndex*>& block_indexes)
+{
+    // Reading the blocks and their undo data and building the filters is independent for every
+    // block, so it is done on several threads. Only the filter headers chain them together, they
+    // are computed when the filters are stored in order of height below.
+    const int n_threads = std::clamp(GetNumCores() - 1, 1, MAX_SYNC_THREADS);
+    ctpl::thread_pool worker_pool(std::min<int>(n_threads, block_indexes.size()));
+    RenameThreadPool(worker_pool, "bfidx");
+
+    const auto& consensus_params = Params().GetConsensus();
+    std::vector<std::future<std::optional<BlockFilter>>> filters;
+    filters.reserve(block_indexes.size());
+    for (const CBlockIndex* pindex : block_indexes) {
+        filters.emplace_back(worker_pool.push([this, pindex, &consensus_params](int) -> std::optional<BlockFilter> {
+            CBlock block;
+            CBlockUndo block_undo;
+            if (!ReadBlockFromDisk(block, pindex, consensus_params)) {
+                LogPrintf("%s: Failed to read block %s from disk\n", __func__, pindex->GetBlockHash().ToString());
+                return std::nullopt;
+            }
+            if (pindex->nHeight > 0 && !UndoReadFromDisk(block_undo, pindex)) {
+                LogPrintf("%s: Failed to read undo data of block %s from disk\n", __func__, pindex->GetBlockHash().ToString());
+                return std::nullopt;
+            }
+            return BlockFilter(m_filter_type, block, block_undo);
+        }));
+    }
+
+    uint256 header;
+    if (!ReadPrevHeader(block_indexes.front(), header)) {
+        worker_pool.stop(false);
+        return false;
+    }
+
+    CDBBatch batch(*m_db);
+    for (size_t i = 0; i < block_indexes.size(); ++i) {
+        const std::optional<BlockFilter> filter = filters[i].get();
+        if (!filter || !WriteFilter(batch, block_indexes[i], *filter, header)) {
+            worker_pool.stop(false);
+            return false;
+        }
+    }
+    return m_db->WriteBatch(batch);
+}
+
 static bool CopyHeightIndexToHashIndex(CDBIterator& db_it, CDBBatch& batch,
                                        const std::string& index_name,
                                        int start_height, int stop_height)
@@ -402,6 +471,12 @@ bool BlockFilterIndex::LookupFilterHeader(const CBlockIndex* block_index, uint25
         }
     }
 
+    FilterHashes recent;
+    if (WITH_LOCK(m_cs_recent_cache, return m_recent_cache.get(block_index->GetBlockHash(), recent))) {
+        header_out = recent.header;
+        return true;
+    }
+
     DBVal entry;
     if (!LookupOne(*m_db, block_index, entry)) {
         return false;
@@ -437,10 +512,35 @@ bool BlockFilterIndex::LookupFilterRange(int start_height, const CBlockIndex* st
     return true;
 }
 
+bool BlockFilterIndex::LookupRecentHashRange(int start_height, const CBlockIndex* stop_index,
+                                             std::vector<uint256>& hashes_out) const
+{
+    if (start_height < 0 || start_height > stop_index->nHeight) {
+        return false;
+    }
+
+    LOCK(m_cs_recent_cache);
+    hashes_out.resize(static_cast<size_t>(stop_index->nHeight - start_height + 1));
+    for (const CBlockIndex* block_index = stop_index;
+         block_index && block_index->nHeight >= start_height;
+         block_index = block_index->pprev) {
+        FilterHashes recent;
+        if (!m_recent_cache.get(block_index->GetBlockHash(), recent)) {
+            return false;
+        }
+        hashes_out[block_index->nHeight - start_height] = recent.hash;
+    }
+    return true;
+}
+
 bool BlockFilterIndex::LookupFilterHashRange(int start_height, const CBlockIndex* stop_index,
                                              std::vector<uint256>& hashes_out) const
 
 {
+    if (LookupRecentHashRange(start_height, stop_index, hashes_out)) {
+        return true;
+    }
+
     std::vector<DBVal> entries;
     if (!LookupRange(*m_db, m_name, start_height, stop_index, entries)) {
         return false;
@@ -451,6 +551,15 @@ bool BlockFilterIndex::LookupFilterHashRange(int start_height, const CBlockIndex
     for (const auto& entry : entries) {
         hashes_out.push_back(entry.hash);
     }
+
+    // The next client asking for this range is served from memory
+    LOCK(m_cs_recent_cache);
+    for (const CBlockIndex* block_index = stop_index;
+         block_index && block_index->nHeight >= start_height;
+         block_index = block_index->pprev) {
+        const auto& entry = entries[block_index->nHeight - start_height];
+        m_recent_cache.insert(block_index->GetBlockHash(), {entry.hash, entry.header});
+    }
     return true;
 }
 
@@ -10,6 +10,7 @@
 #include <chain.h>
 #include <flatfile.h>
 #include <index/base.h>
+#include <unordered_lru_cache.h>
 #include <util/hasher.h>
 
 /** Interval between compact filter checkpoints. See BIP 157. */
@@ -25,6 +26,13 @@ static constexpr int CFCHECKPT_INTERVAL = 1000;
 class BlockFilterIndex final : public BaseIndex
 {
 private:
+    /** Number of recent blocks whose filter hashes and headers are kept in memory, twice the getcfheaders limit. */
+    static constexpr size_t RECENT_CACHE_SIZE{4000};
+    /** Number of blocks whose filters are built together while the index is catching up. */
+    static constexpr size_t SYNC_BATCH_SIZE{100};
+    /** Maximum number of threads building filters while the index is catching up. */
+    static constexpr int MAX_SYNC_THREADS{8};
+
     BlockFilterType m_filter_type;
     std::string m_name;
     std::unique_ptr<BaseIndex::DB> m_db;
@@ -35,10 +43,27 @@ private:
     bool ReadFilterFromDisk(const FlatFilePos& pos, BlockFilter& filter) const;
     size_t WriteFilterToDisk(FlatFilePos& pos, const BlockFilter& filter);
 
+    /** Look up the header of the filter preceding the one of a block, which is zero for the genesis block. */
+    bool ReadPrevHeader(const CBlockIndex* pindex, uint256& prev_header) const;
+    /** Store the filter of a block, header is the one of the previous filter and is updated to the one of this filter. */
+    bool WriteFilter(CDBBatch& batch, const CBlockIndex* pindex, const BlockFilter& filter, uint256& header);
+
     Mutex m_cs_headers_cache;
     /** cache of block hash to filter header, to avoid disk access when responding to getcfcheckpt. */
     std::unordered_map<uint256, uint256, FilterHeaderHasher> m_headers_cache GUARDED_BY(m_cs_headers_cache);
 
+    struct FilterHashes {
+        uint256 hash;
+        uint256 header;
+    };
+    mutable Mutex m_cs_recent_cache;
+    /** cache of block hash to filter hash and header, to avoid disk access when responding to getcfheaders from
+     *  clients following the tip. Filled as the index advances and by lookups which missed it. */
+    mutable unordered_lru_cache<uint256, FilterHashes, FilterHeaderHasher, RECENT_CACHE_SIZE> m_recent_cache GUARDED_BY(m_cs_recent_cache);
+
+    /** Get the filter hashes of a range from the recent cache, fails if any of them isn't in it. */
+    bool LookupRecentHashRange(int start_height, const CBlockIndex* stop_index, std::vector<uint256>& hashes_out) const;
+
 protected:
     bool Init() override;
 
@@ -46,6 +71,10 @@ protected:
 
     bool WriteBlock(const CBlock& block, const CBlockIndex* pindex) override;
 
+    size_t GetSyncBatchSize() const override { return SYNC_BATCH_SIZE; }
+
+    bool SyncBlocks(const std::vector<const CBlockIndex*>& block_indexes) override;
+
     bool Rewind(const CBlockIndex* current_tip, const CBlockIndex* new_tip) override;
 
     BaseIndex::DB& GetDB() const LIFETIMEBOUND override { return *m_db; }
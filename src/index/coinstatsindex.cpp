@@ -5,6 +5,7 @@
 #include <chainparams.h>
 #include <coins.h>
 #include <crypto/muhash.h>
+#include <ctpl_stl.h>
 #include <index/coinstatsindex.h>
 #include <node/blockstorage.h>
 #include <serialize.h>
@@ -17,6 +18,9 @@ static constexpr uint8_t DB_BLOCK_HASH{'s'};
 static constexpr uint8_t DB_BLOCK_HEIGHT{'t'};
 static constexpr uint8_t DB_MUHASH{'M'};
 
+/** Blocks have far fewer coins than the UTXO set, smaller batches still spread them over the threads */
+static constexpr size_t MUHASH_BLOCK_BATCH_SIZE{128};
+
 namespace {
 
 struct DBVal {
@@ -102,6 +106,18 @@ CoinStatsIndex::CoinStatsIndex(size_t n_cache_size, bool f_memory, bool f_wipe)
     fs::create_directories(path);
 
     m_db = std::make_unique<CoinStatsIndex::DB>(path / "db", n_cache_size, f_memory, f_wipe);
+
+    if (const int n_threads = GetMuHashThreads(); n_threads > 0) {
+        m_muhash_pool = std::make_unique<ctpl::thread_pool>(n_threads);
+        RenameThreadPool(*m_muhash_pool, "coinstatsidx");
+    }
+}
+
+CoinStatsIndex::~CoinStatsIndex()
+{
+    // stop the index thread before the pool it hashes blocks on goes away, the base class would be too late
+    Interrupt();
+    Stop();
 }
 
 bool CoinStatsIndex::WriteBlock(const CBlock& block, const CBlockIndex* pindex)
@@ -136,6 +152,8 @@ bool CoinStatsIndex::WriteBlock(const CBlock& block, const CBlockIndex* pindex)
         bool is_bip30_block{(pindex->nHeight == 91722 && pindex->GetBlockHash() == uint256S("0x00000000000271a2dc26e7667f8419f2e15416dc6955e5a6c6cdf3f2574dd08e")) ||
                             (pindex->nHeight == 91812 && pindex->GetBlockHash() == uint256S("0x00000000000af0aed4792b1acee3d966af36cf5def14935db8de83d6f9306f2f"))};
 
+        ParallelMuHash muhash(m_muhash, m_muhash_pool.get(), MUHASH_BLOCK_BATCH_SIZE);
+
         // Add the new utxos created from the block
         for (size_t i = 0; i < block.vtx.size(); ++i) {
             const auto& tx{block.vtx.at(i)};
@@ -159,7 +177,7 @@ bool CoinStatsIndex::WriteBlock(const CBlock& block, const CBlockIndex* pindex)
                     continue;
                 }
 
-                m_muhash.Insert(MakeUCharSpan(TxOutSer(outpoint, coin)));
+                muhash.Insert(TxOutSer(outpoint, coin));
 
                 if (tx->IsCoinBase()) {
                     m_total_coinbase_amount += coin.out.nValue;
@@ -180,7 +198,7 @@ bool CoinStatsIndex::WriteBlock(const CBlock& block, const CBlockIndex* pindex)
                     Coin coin{tx_undo.vprevout[j]};
                     COutPoint outpoint{tx->vin[j].prevout.hash, tx->vin[j].prevout.n};
 
-                    m_muhash.Remove(MakeUCharSpan(TxOutSer(outpoint, coin)));
+                    muhash.Remove(TxOutSer(outpoint, coin));
 
                     m_total_prevout_spent_amount += coin.out.nValue;
 
@@ -190,6 +208,7 @@ bool CoinStatsIndex::WriteBlock(const CBlock& block, const CBlockIndex* pindex)
                 }
             }
         }
+        muhash.Finish();
     } else {
         // genesis block
         m_total_unspendable_amount += block_subsidy;
@@ -419,6 +438,8 @@ bool CoinStatsIndex::ReverseBlock(const CBlock& block, const CBlockIndex* pindex
         }
     }
 
+    ParallelMuHash muhash(m_muhash, m_muhash_pool.get(), MUHASH_BLOCK_BATCH_SIZE);
+
     // Remove the new UTXOs that were created from the block
     for (size_t i = 0; i < block.vtx.size(); ++i) {
         const auto& tx{block.vtx.at(i)};
@@ -435,7 +456,7 @@ bool CoinStatsIndex::ReverseBlock(const CBlock& block, const CBlockIndex* pindex
                 continue;
             }
 
-            m_muhash.Remove(MakeUCharSpan(TxOutSer(outpoint, coin)));
+            muhash.Remove(TxOutSer(outpoint, coin));
 
             if (tx->IsCoinBase()) {
                 m_total_coinbase_amount -= coin.out.nValue;
@@ -456,7 +477,7 @@ bool CoinStatsIndex::ReverseBlock(const CBlock& block, const CBlockIndex* pindex
                 Coin coin{tx_undo.vprevout[j]};
                 COutPoint outpoint{tx->vin[j].prevout.hash, tx->vin[j].prevout.n};
 
-                m_muhash.Insert(MakeUCharSpan(TxOutSer(outpoint, coin)));
+                muhash.Insert(TxOutSer(outpoint, coin));
 
                 m_total_prevout_spent_amount -= coin.out.nValue;
 
@@ -466,6 +487,7 @@ bool CoinStatsIndex::ReverseBlock(const CBlock& block, const CBlockIndex* pindex
             }
         }
     }
+    muhash.Finish();
 
     const CAmount unclaimed_rewards{(m_total_new_outputs_ex_coinbase_amount + m_total_coinbase_amount + m_total_unspendable_amount) - (m_total_prevout_spent_amount + m_total_subsidy)};
     m_total_unspendable_amount -= unclaimed_rewards;
@@ -21,6 +21,8 @@ private:
     std::unique_ptr<BaseIndex::DB> m_db;
 
     MuHash3072 m_muhash;
+    //! hashes the coins of a block for m_muhash, nullptr to do it on the index thread
+    std::unique_ptr<ctpl::thread_pool> m_muhash_pool;
     uint64_t m_transaction_output_count{0};
     uint64_t m_bogo_size{0};
     CAmount m_total_amount{0};
@@ -52,6 +54,7 @@ protected:
 public:
     // Constructs the index, which becomes available to be queried.
     explicit CoinStatsIndex(size_t n_cache_size, bool f_memory = false, bool f_wipe = false);
+    ~CoinStatsIndex() override;
 
     // Look up stats for a specific block using CBlockIndex
     bool LookUpStats(const CBlockIndex* block_index, CCoinsStats& coins_stats) const;
@@ -0,0 +1,111 @@
+// Copyright (c) 2026 The Dash Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <index/spentindex.h>
+
+#include <chain.h>
+#include <chainparams.h>
+#include <node/blockstorage.h>
+#include <txmempool.h>
+#include <undo.h>
+#include <util/system.h>
+
+static constexpr uint8_t DB_SPENTINDEX{'p'};
+
+std::unique_ptr<SpentIndex> g_spentindex;
+
+SpentIndex::SpentIndex(size_t n_cache_size, bool f_memory, bool f_wipe)
+    : m_db(std::make_unique<BaseIndex::DB>(GetDataDir() / "indexes" / "spentindex", n_cache_size, f_memory, f_wipe))
+{}
+
+bool SpentIndex::UpdateBlock(const CBlock& block, const CBlockIndex* pindex, bool revert)
+{
+    CBlockUndo block_undo;
+    if (!revert && !UndoReadFromDisk(block_undo, pindex)) {
+        return error("%s: Failed to read undo data of block %s", __func__, pindex->GetBlockHash().ToString());
+    }
+    if (!revert && block_undo.vtxundo.size() + 1 != block.vtx.size()) {
+        return error("%s: block and undo data inconsistent for %s", __func__, pindex->GetBlockHash().ToString());
+    }
+
+    CDBBatch batch(*m_db);
+
+    for (unsigned int i = 1; i < block.vtx.size(); i++) { // not coinbases
+        const CTransaction& tx = *block.vtx[i];
+        const uint256 txhash = tx.GetHash();
+
+        if (revert) {
+            // undo and delete the spent index
+            for (const CTxIn& input : tx.vin) {
+                batch.Erase(std::make_pair(DB_SPENTINDEX, CSpentIndexKey(input.prevout.hash, input.prevout.n)));
+            }
+            continue;
+        }
+
+        const CTxUndo& txundo = block_undo.vtxundo[i - 1];
+        if (txundo.vprevout.size() != tx.vin.size()) {
+            return error("%s: transaction and undo data inconsistent for %s", __func__, txhash.ToString());
+        }
+        for (unsigned int j = 0; j < tx.vin.size(); j++) {
+            const CTxIn& input = tx.vin[j];
+            const CTxOut& prevout = txundo.vprevout[j].out;
+
+            AddressType address_type{AddressType::UNKNOWN};
+            uint160 address_bytes;
+
+            AddressBytesFromScript(prevout.scriptPubKey, address_type, address_bytes);
+
+            // add the spent index to determine the txid and input that spent an output
+            // and to find the amount and address from an input
+            batch.Write(std::make_pair(DB_SPENTINDEX, CSpentIndexKey(input.prevout.hash, input.prevout.n)),
+                        CSpentIndexValue(txhash, j, pindex->nHeight, prevout.nValue, address_type, address_bytes));
+        }
+    }
+
+    return m_db->WriteBatch(batch);
+}
+
+bool SpentIndex::WriteBlock(const CBlock& block, const CBlockIndex* pindex)
+{
+    // The genesis block doesn't spend anything
+    if (pindex->nHeight == 0) {
+        return true;
+    }
+
+    return UpdateBlock(block, pindex, /* revert */ false);
+}
+
+bool SpentIndex::Rewind(const CBlockIndex* current_tip, const CBlockIndex* new_tip)
+{
+    assert(current_tip->GetAncestor(new_tip->nHeight) == new_tip);
+
+    const auto& consensus_params{Params().GetConsensus()};
+    for (const CBlockIndex* iter_tip = current_tip; iter_tip != new_tip; iter_tip = iter_tip->pprev) {
+        CBlock block;
+        if (!ReadBlockFromDisk(block, iter_tip, consensus_params)) {
+            return error("%s: Failed to read block %s from disk", __func__, iter_tip->GetBlockHash().ToString());
+        }
+        if (!UpdateBlock(block, iter_tip, /* revert */ true)) {
+            return false;
+        }
+    }
+
+    return BaseIndex::Rewind(current_tip, new_tip);
+}
+
+bool SpentIndex::FindSpentIndex(const CSpentIndexKey& key, CSpentIndexValue& value) const
+{
+    return m_db->Read(std::make_pair(DB_SPENTINDEX, key), value);
+}
+
+bool GetSpentIndex(CTxMemPool& mempool, CSpentIndexKey& key, CSpentIndexValue& value)
+{
+    if (!g_spentindex)
+        return false;
+
+    if (mempool.getSpentIndex(key, value))
+        return true;
+
+    return g_spentindex->FindSpentIndex(key, value);
+}
@@ -0,0 +1,48 @@
+// Copyright (c) 2026 The Dash Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_INDEX_SPENTINDEX_H
+#define BITCOIN_INDEX_SPENTINDEX_H
+
+#include <index/base.h>
+#include <spentindex.h>
+
+class CTxMemPool;
+
+/**
+ * SpentIndex records for every spent output the transaction input spending it,
+ * together with the amount and address of the output.
+ */
+class SpentIndex final : public BaseIndex
+{
+private:
+    std::unique_ptr<BaseIndex::DB> m_db;
+
+    /// Write the spent outputs of a block, or erase them again when reverting it
+    bool UpdateBlock(const CBlock& block, const CBlockIndex* pindex, bool revert);
+
+protected:
+    bool WriteBlock(const CBlock& block, const CBlockIndex* pindex) override;
+
+    bool Rewind(const CBlockIndex* current_tip, const CBlockIndex* new_tip) override;
+
+    BaseIndex::DB& GetDB() const override { return *m_db; }
+
+    const char* GetName() const override { return "spentindex"; }
+
+public:
+    /// Constructs the index, which becomes available to be queried.
+    explicit SpentIndex(size_t n_cache_size, bool f_memory = false, bool f_wipe = false);
+
+    /// Look up the input spending an output in the blockchain.
+    bool FindSpentIndex(const CSpentIndexKey& key, CSpentIndexValue& value) const;
+};
+
+/// The global spent index, used by the getspentinfo RPC and transaction details. May be null.
+extern std::unique_ptr<SpentIndex> g_spentindex;
+
+/// Look up the input spending an output in the mempool and, if not found there, in the spent index.
+bool GetSpentIndex(CTxMemPool& mempool, CSpentIndexKey& key, CSpentIndexValue& value);
+
+#endif // BITCOIN_INDEX_SPENTINDEX_H
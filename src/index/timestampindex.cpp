@@ -0,0 +1,62 @@
+// Copyright (c) 2026 The Dash Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <index/timestampindex.h>
+
+#include <chain.h>
+#include <util/system.h>
+
+static constexpr uint8_t DB_TIMESTAMPINDEX{'s'};
+
+std::unique_ptr<TimestampIndex> g_timestampindex;
+
+TimestampIndex::TimestampIndex(size_t n_cache_size, bool f_memory, bool f_wipe)
+    : m_db(std::make_unique<BaseIndex::DB>(GetDataDir() / "indexes" / "timestampindex", n_cache_size, f_memory, f_wipe))
+{}
+
+bool TimestampIndex::WriteBlock(const CBlock& block, const CBlockIndex* pindex)
+{
+    // The genesis block never was indexed
+    if (pindex->nHeight == 0) {
+        return true;
+    }
+
+    CDBBatch batch(*m_db);
+    batch.Write(std::make_pair(DB_TIMESTAMPINDEX, CTimestampIndexKey(pindex->nTime, pindex->GetBlockHash())), 0);
+    return m_db->WriteBatch(batch);
+}
+
+bool TimestampIndex::Rewind(const CBlockIndex* current_tip, const CBlockIndex* new_tip)
+{
+    assert(current_tip->GetAncestor(new_tip->nHeight) == new_tip);
+
+    CDBBatch batch(*m_db);
+    for (const CBlockIndex* iter_tip = current_tip; iter_tip != new_tip; iter_tip = iter_tip->pprev) {
+        batch.Erase(std::make_pair(DB_TIMESTAMPINDEX, CTimestampIndexKey(iter_tip->nTime, iter_tip->GetBlockHash())));
+    }
+    if (!m_db->WriteBatch(batch)) {
+        return false;
+    }
+
+    return BaseIndex::Rewind(current_tip, new_tip);
+}
+
+bool TimestampIndex::FindBlockHashes(unsigned int high, unsigned int low, std::vector<uint256>& hashes) const
+{
+    std::unique_ptr<CDBIterator> pcursor(m_db->NewIterator());
+
+    pcursor->Seek(std::make_pair(DB_TIMESTAMPINDEX, CTimestampIndexIteratorKey(low)));
+
+    while (pcursor->Valid()) {
+        std::pair<uint8_t, CTimestampIndexKey> key;
+        if (pcursor->GetKey(key) && key.first == DB_TIMESTAMPINDEX && key.second.m_block_time <= high) {
+            hashes.push_back(key.second.m_block_hash);
+            pcursor->Next();
+        } else {
+            break;
+        }
+    }
+
+    return true;
+}
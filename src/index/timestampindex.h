@@ -0,0 +1,41 @@
+// Copyright (c) 2026 The Dash Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_INDEX_TIMESTAMPINDEX_H
+#define BITCOIN_INDEX_TIMESTAMPINDEX_H
+
+#include <index/base.h>
+#include <timestampindex.h>
+
+#include <vector>
+
+/**
+ * TimestampIndex records the hashes of the blocks by their timestamp.
+ */
+class TimestampIndex final : public BaseIndex
+{
+private:
+    std::unique_ptr<BaseIndex::DB> m_db;
+
+protected:
+    bool WriteBlock(const CBlock& block, const CBlockIndex* pindex) override;
+
+    bool Rewind(const CBlockIndex* current_tip, const CBlockIndex* new_tip) override;
+
+    BaseIndex::DB& GetDB() const override { return *m_db; }
+
+    const char* GetName() const override { return "timestampindex"; }
+
+public:
+    /// Constructs the index, which becomes available to be queried.
+    explicit TimestampIndex(size_t n_cache_size, bool f_memory = false, bool f_wipe = false);
+
+    /// Look up the hashes of the blocks with a timestamp from low to high.
+    bool FindBlockHashes(unsigned int high, unsigned int low, std::vector<uint256>& hashes) const;
+};
+
+/// The global timestamp index, used by the getblockhashes RPC. May be null.
+extern std::unique_ptr<TimestampIndex> g_timestampindex;
+
+#endif // BITCOIN_INDEX_TIMESTAMPINDEX_H
@@ -2,8 +2,10 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include <chainparams.h>
 #include <index/disktxpos.h>
 #include <index/txindex.h>
+#include <node/blockstorage.h>
 #include <node/ui_interface.h>
 #include <shutdown.h>
 #include <util/system.h>
@@ -210,19 +212,45 @@ bool TxIndex::Init()
     return BaseIndex::Init();
 }
 
-bool TxIndex::WriteBlock(const CBlock& block, const CBlockIndex* pindex)
+static void AppendTxPositions(const CBlock& block, const CBlockIndex* pindex, std::vector<std::pair<uint256, CDiskTxPos>>& vPos)
 {
     // Exclude genesis block transaction because outputs are not spendable.
-    if (pindex->nHeight == 0) return true;
+    if (pindex->nHeight == 0) return;
 
     CDiskTxPos pos(pindex->GetBlockPos(), GetSizeOfCompactSize(block.vtx.size()));
-    std::vector<std::pair<uint256, CDiskTxPos>> vPos;
-    vPos.reserve(block.vtx.size());
     for (const auto& tx : block.vtx) {
         vPos.emplace_back(tx->GetHash(), pos);
         pos.nTxOffset += ::GetSerializeSize(*tx, CLIENT_VERSION);
     }
-    return m_db->WriteTxs(vPos);
+}
+
+bool TxIndex::WriteBlock(const CBlock& block, const CBlockIndex* pindex)
+{
+    std::vector<std::pair<uint256, CDiskTxPos>> vPos;
+    vPos.reserve(block.vtx.size());
+    AppendTxPositions(block, pindex, vPos);
+    return vPos.empty() || m_db->WriteTxs(vPos);
+}
+
+bool TxIndex::SyncBlocks(const std::vector<const CBlockIndex*>& block_indexes)
+{
+    // The blocks are read and their transactions hashed on the read ahead thread, which leaves little
+    // to do here but the database writes, so all positions of the blocks go into one batch.
+    BlockReadAhead reader(block_indexes, /* read_undo */ false, Params().GetConsensus());
+    std::vector<std::pair<uint256, CDiskTxPos>> vPos;
+    for (const CBlockIndex* pindex : block_indexes) {
+        CBlock block;
+        if (!reader.Next(block)) {
+            return error("%s: Failed to read block %s from disk",
+                         __func__, pindex->GetBlockHash().ToString());
+        }
+        AppendTxPositions(block, pindex, vPos);
+    }
+    if (!vPos.empty() && !m_db->WriteTxs(vPos)) {
+        return error("%s: Failed to write blocks %s to %s to index database", __func__,
+                     block_indexes.front()->GetBlockHash().ToString(), block_indexes.back()->GetBlockHash().ToString());
+    }
+    return true;
 }
 
 BaseIndex::DB& TxIndex::GetDB() const { return *m_db; }
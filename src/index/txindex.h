@@ -20,6 +20,9 @@ protected:
     class DB;
 
 private:
+    /** Number of blocks whose transaction positions are written in one batch while the index is catching up. */
+    static constexpr size_t SYNC_BATCH_SIZE{1000};
+
     const std::unique_ptr<DB> m_db;
 
 protected:
@@ -28,6 +31,10 @@ protected:
 
     bool WriteBlock(const CBlock& block, const CBlockIndex* pindex) override;
 
+    size_t GetSyncBatchSize() const override { return SYNC_BATCH_SIZE; }
+
+    bool SyncBlocks(const std::vector<const CBlockIndex*>& block_indexes) override;
+
     BaseIndex::DB& GetDB() const override;
 
     const char* GetName() const override { return "txindex"; }
@@ -18,6 +18,7 @@
 #include <chain.h>
 #include <chainparams.h>
 #include <context.h>
+#include <dbwrapper.h>
 #include <deploymentstatus.h>
 #include <node/coinstats.h>
 #include <fs.h>
@@ -25,9 +26,13 @@
 #include <httpserver.h>
 #include <httprpc.h>
 #include <interfaces/chain.h>
+#include <index/addressindex.h>
 #include <index/blockfilterindex.h>
 #include <index/coinstatsindex.h>
+#include <index/spentindex.h>
+#include <index/timestampindex.h>
 #include <index/txindex.h>
+#include <kawpow.h>
 #include <interfaces/node.h>
 #include <key.h>
 #include <mapport.h>
@@ -39,6 +44,7 @@
 #include <node/blockstorage.h>
 #include <node/context.h>
 #include <node/ui_interface.h>
+#include <policy/cluster.h>
 #include <policy/feerate.h>
 #include <policy/fees.h>
 #include <policy/policy.h>
@@ -59,6 +65,7 @@
 #include <util/asmap.h>
 #include <util/error.h>
 #include <util/moneystr.h>
+#include <util/perfcounters.h>
 #include <util/strencodings.h>
 #include <util/string.h>
 #include <util/system.h>
@@ -105,6 +112,7 @@
 #include <statsd_client.h>
 
 #include <functional>
+#include <future>
 #include <set>
 #include <stdint.h>
 #include <stdio.h>
@@ -132,6 +140,8 @@
 
 static const bool DEFAULT_PROXYRANDOMIZE = true;
 static const bool DEFAULT_REST_ENABLE = false;
+static constexpr int DEFAULT_MAINTENANCE_THREADS{1};
+static constexpr int MAX_MAINTENANCE_THREADS{8};
 
 static CDSNotificationInterface* pdsNotificationInterface = nullptr;
 
@@ -215,6 +225,15 @@ void Interrupt(NodeContext& node)
     if (g_coin_stats_index) {
         g_coin_stats_index->Interrupt();
     }
+    if (g_addressindex) {
+        g_addressindex->Interrupt();
+    }
+    if (g_spentindex) {
+        g_spentindex->Interrupt();
+    }
+    if (g_timestampindex) {
+        g_timestampindex->Interrupt();
+    }
 }
 
 /** Preparing steps before shutting down or restarting the wallet */
@@ -238,6 +257,10 @@ void PrepareShutdown(NodeContext& node)
     StopRPC();
     StopHTTPServer();
     if (node.llmq_ctx) node.llmq_ctx->Stop();
+    if (node.block_template_cache) {
+        UnregisterValidationInterface(node.block_template_cache.get());
+        node.block_template_cache->Stop();
+    }
 
     for (const auto& client : node.chain_clients) {
         client->flush();
@@ -258,6 +281,7 @@ void PrepareShutdown(NodeContext& node)
     // Thus the implicit locking order requirement is: (1) cs_main, (2) g_cs_orphans, (3) cs_vNodes.
     if (node.connman) {
         node.connman->StopThreads();
+        if (node.peerman) node.peerman->StopMessageProcessing();
         LOCK2(::cs_main, ::g_cs_orphans);
         node.connman->StopNodes();
     }
@@ -267,8 +291,13 @@ void PrepareShutdown(NodeContext& node)
     // After everything has been shut down, but before things get flushed, stop the
     // CScheduler/checkqueue, threadGroup and load block thread.
     if (node.scheduler) node.scheduler->stop();
+    if (node.maintenance_scheduler) node.maintenance_scheduler->stop();
+    statsClient.Stop();
     if (node.chainman && node.chainman->m_load_block.joinable()) node.chainman->m_load_block.join();
     StopScriptCheckWorkerThreads();
+    StopHeaderHashWorkerThreads();
+    StopProTxSigCheckWorkerThreads();
+    g_kawpow_epoch_contexts.Stop();
 
     // After there are no more peers/RPC left to give us new data which may generate
     // CValidationInterface callbacks, flush them...
@@ -276,6 +305,7 @@ void PrepareShutdown(NodeContext& node)
 
     // After the threads that potentially access these pointers have been stopped,
     // destruct and reset all to nullptr.
+    node.block_template_cache.reset();
     node.peerman.reset();
     node.connman.reset();
     node.banman.reset();
@@ -310,12 +340,13 @@ void PrepareShutdown(NodeContext& node)
     ::mmetaman.reset();
     node.dstxman = nullptr;
     ::dstxManager.reset();
+    // governance records whether it was synced when it's written out on destruction
+    node.govman = nullptr;
+    ::governance.reset();
     node.mn_sync = nullptr;
     ::masternodeSync.reset();
     node.sporkman = nullptr;
     ::sporkManager.reset();
-    node.govman = nullptr;
-    ::governance.reset();
 
     // Stop and delete all indexes only after flushing background callbacks.
     if (g_txindex) {
@@ -326,6 +357,18 @@ void PrepareShutdown(NodeContext& node)
         g_coin_stats_index->Stop();
         g_coin_stats_index.reset();
     }
+    if (g_addressindex) {
+        g_addressindex->Stop();
+        g_addressindex.reset();
+    }
+    if (g_spentindex) {
+        g_spentindex->Stop();
+        g_spentindex.reset();
+    }
+    if (g_timestampindex) {
+        g_timestampindex->Stop();
+        g_timestampindex.reset();
+    }
     ForEachBlockFilterIndex([](BlockFilterIndex& index) { index.Stop(); });
     DestroyAllBlockFilterIndexes();
 
@@ -415,6 +458,7 @@ void Shutdown(NodeContext& node)
     node.fee_estimator.reset();
     node.chainman = nullptr;
     node.scheduler.reset();
+    node.maintenance_scheduler.reset();
 
     try {
         if (!fs::remove(GetPidFile(*node.args))) {
@@ -426,6 +470,7 @@ void Shutdown(NodeContext& node)
 
     node.args = nullptr;
     LogPrintf("%s: done\n", __func__);
+    LogInstance().StopAsyncLogging();
 }
 
 /**
@@ -520,6 +565,7 @@ void SetupServerArgs(NodeContext& node)
     argsman.AddArg("-alertnotify=<cmd>", "Execute command when an alert is raised (%s in cmd is replaced by message)", ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
 #endif
     argsman.AddArg("-assumevalid=<hex>", strprintf("If this block is in the chain assume that it and its ancestors are valid and potentially skip their script verification (0 to verify all, default: %s, testnet: %s)", defaultChainParams->GetConsensus().defaultAssumeValid.GetHex(), testnetChainParams->GetConsensus().defaultAssumeValid.GetHex()), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-backgroundflush", strprintf("Write the periodic flushes of the UTXO set and evodb caches to disk in the background, while validation goes on (default: %u)", DEFAULT_BACKGROUND_FLUSH), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-blocksdir=<dir>", "Specify directory to hold blocks subdirectory for *.dat files (default: <datadir>)", ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-fastprune", "Use smaller block files and lower minimum prune height for testing purposes", ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY, OptionsCategory::DEBUG_TEST);
 #if HAVE_SYSTEM
@@ -530,15 +576,22 @@ void SetupServerArgs(NodeContext& node)
 #if HAVE_SYSTEM
     argsman.AddArg("-chainlocknotify=<cmd>", "Execute command when the best chainlock changes (%s in cmd is replaced by chainlocked block hash)", ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
 #endif
+    argsman.AddArg("-clustermempool", strprintf("Select transactions for blocks and evict them from a full mempool by the linearizations of their clusters instead of ancestor and descendant feerates (default: %u)", DEFAULT_CLUSTER_MEMPOOL), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-coinstatsindex", strprintf("Maintain coinstats index used by the gettxoutsetinfo RPC (default: %u)", DEFAULT_COINSTATSINDEX), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-conf=<file>", strprintf("Specify path to read-only configuration file. Relative paths will be prefixed by datadir location. (default: %s)", BITCOIN_CONF_FILENAME), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-datadir=<dir>", "Specify data directory", ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-dbbatchsize", strprintf("Maximum database write batch size in bytes (default: %u)", nDefaultDbBatchSize), ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY, OptionsCategory::OPTIONS);
     argsman.AddArg("-dbcache=<n>", strprintf("Maximum database cache size <n> MiB (%d to %d, default: %d). In addition, unused mempool memory is shared for this cache (see -maxmempool).", nMinDbCache, nMaxDbCache, nDefaultDbCache), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-dbprofile=<db>:<setting>=<value>[,...]", "Tune the LevelDB options of a database, named by its directory relative to the data directory (e.g. chainstate, evodb, llmq/isdb, indexes/txindex). Settings are bloombits (bits per key of the bloom filters, 0 for none), blocksize (bytes), blockcache and writebuffer (percent of the cache of the database). Can be specified multiple times", ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY, OptionsCategory::OPTIONS);
     argsman.AddArg("-debuglogfile=<file>", strprintf("Specify location of debug log file. Relative paths will be prefixed by a net-specific datadir location. (-nodebuglogfile to disable; default: %s)", DEFAULT_DEBUGLOGFILE), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-includeconf=<file>", "Specify additional configuration file, relative to the -datadir path (only useable from configuration file, not command line)", ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-kawpowprefetchblocks=<n>", strprintf("Build the KAWPOW light cache of the next epoch in the background once the tip is this many blocks before the epoch boundary, 0 = build it when first needed (default: %d)", KAWPOW_EPOCH_PREFETCH_BLOCKS), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-kawpowfulldag", strprintf("Keep the full KAWPOW dataset of the current epoch in memory, generated in the background, to speed up full KAWPOW hashing. Needs several GB of RAM (default: %u)", DEFAULT_KAWPOW_FULL_DAG), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-loadblock=<file>", "Imports blocks from external file on startup", ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-maintenancethreads=<n>", strprintf("Number of threads which run the periodic masternode, governance, CoinJoin and stats maintenance, apart from the scheduler thread which runs the notifications and network tasks (1 to %d, default: %d)",
+        MAX_MAINTENANCE_THREADS, DEFAULT_MAINTENANCE_THREADS), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-maxmempool=<n>", strprintf("Keep the transaction memory pool below <n> megabytes (default: %u)", DEFAULT_MAX_MEMPOOL_SIZE), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-maxmnlistcache=<n>", strprintf("Keep the cache of masternode lists and list diffs below <n> MiB (default: %u)", DEFAULT_MAX_MNLIST_CACHE_SIZE), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-maxorphantxsize=<n>", strprintf("Maximum total size of all orphan transactions in megabytes (default: %u)", DEFAULT_MAX_ORPHAN_TRANSACTIONS_SIZE), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-maxrecsigsage=<n>", strprintf("Number of seconds to keep LLMQ recovery sigs (default: %u)", llmq::DEFAULT_MAX_RECOVERED_SIGS_AGE), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-mempoolexpiry=<n>", strprintf("Do not keep transactions in the mempool longer than <n> hours (default: %u)", DEFAULT_MEMPOOL_EXPIRY), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
@@ -547,9 +600,11 @@ void SetupServerArgs(NodeContext& node)
         -GetNumCores(), MAX_SCRIPTCHECK_THREADS, DEFAULT_SCRIPTCHECK_THREADS), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-persistmempool", strprintf("Whether to save the mempool on shutdown and load on restart (default: %u)", DEFAULT_PERSIST_MEMPOOL), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-pid=<file>", strprintf("Specify pid file. Relative paths will be prefixed by a net-specific datadir location. (default: %s)", BITCOIN_PID_FILENAME), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
-    argsman.AddArg("-prune=<n>", strprintf("Reduce storage requirements by enabling pruning (deleting) of old blocks. This allows the pruneblockchain RPC to be called to delete specific blocks, and enables automatic pruning of old blocks if a target size in MiB is provided. This mode is incompatible with -txindex, -coinstatsindex, -rescan and -disablegovernance=false. "
+    argsman.AddArg("-prune=<n>", strprintf("Reduce storage requirements by enabling pruning (deleting) of old blocks. This allows the pruneblockchain RPC to be called to delete specific blocks, and enables automatic pruning of old blocks if a target size in MiB is provided. This mode is incompatible with -txindex, -coinstatsindex, -addressindex, -spentindex, -timestampindex, -rescan and -disablegovernance=false. "
             "Warning: Reverting this setting requires re-downloading the entire blockchain. "
             "(default: 0 = disable pruning blocks, 1 = allow manual pruning via RPC, >%u = automatically prune block files to stay under the specified target size in MiB)", MIN_DISK_SPACE_FOR_BLOCK_FILES / 1024 / 1024), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-prunekeepquorumblocks", strprintf("When pruning, also keep the blocks of all active quorums and the blocks the credit pool is traced back through before them, instead of only the last %u blocks (default: %u)", MIN_BLOCKS_TO_KEEP, DEFAULT_PRUNE_KEEP_QUORUM_BLOCKS), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-scriptcheckaffinity", strprintf("Run every script verification thread on a core of its own, next to each other as far as possible (Linux only, default: %u)", DEFAULT_SCRIPTCHECK_AFFINITY), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-settings=<file>", strprintf("Specify path to dynamic settings data file. Can be disabled with -nosettings. File is written at runtime and not meant to be edited by users (use %s instead for custom settings). Relative paths will be prefixed by datadir location. (default: %s)", BITCOIN_CONF_FILENAME, BITCOIN_SETTINGS_FILENAME), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-syncmempool", strprintf("Sync mempool from other nodes on start (default: %u)", DEFAULT_SYNC_MEMPOOL), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
 #if HAVE_SYSTEM
@@ -560,6 +615,8 @@ void SetupServerArgs(NodeContext& node)
 #else
     hidden_args.emplace_back("-sysperms");
 #endif
+    argsman.AddArg("-validationsignalthreads=<n>", strprintf("Number of threads which deliver block and transaction notifications to the wallet, ZMQ and other subscribers, which then don't wait for each other (0 to %d, 0 = the scheduler thread, default: %d)",
+        MAX_VALIDATION_SIGNAL_THREADS, DEFAULT_VALIDATION_SIGNAL_THREADS), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-version", "Print version and exit", ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
 
     argsman.AddArg("-addressindex", strprintf("Maintain a full address index, used to query for the balance, txids and unspent outputs for addresses (default: %u)", DEFAULT_ADDRESSINDEX), ArgsManager::ALLOW_ANY, OptionsCategory::INDEXING);
@@ -587,11 +644,14 @@ void SetupServerArgs(NodeContext& node)
     argsman.AddArg("-forcednsseed", strprintf("Always query for peer addresses via DNS lookup (default: %u)", DEFAULT_FORCEDNSSEED), ArgsManager::ALLOW_ANY, OptionsCategory::CONNECTION);
     argsman.AddArg("-listen", "Accept connections from outside (default: 1 if no -proxy or -connect)", ArgsManager::ALLOW_ANY, OptionsCategory::CONNECTION);
     argsman.AddArg("-listenonion", strprintf("Automatically create Tor onion service (default: %d)", DEFAULT_LISTEN_ONION), ArgsManager::ALLOW_ANY, OptionsCategory::CONNECTION);
+    argsman.AddArg("-maxbloomcputime=<n>", strprintf("Milliseconds per second a peer may spend on matching its bloom filter, filtered blocks and transaction announcements for it wait beyond that, 0 = no limit (default: %d)", DEFAULT_MAX_BLOOM_CPU_TIME), ArgsManager::ALLOW_ANY, OptionsCategory::CONNECTION);
     argsman.AddArg("-maxconnections=<n>", strprintf("Maintain at most <n> connections to peers (temporary service connections excluded) (default: %u)", DEFAULT_MAX_PEER_CONNECTIONS), ArgsManager::ALLOW_ANY, OptionsCategory::CONNECTION);
     argsman.AddArg("-maxreceivebuffer=<n>", strprintf("Maximum per-connection receive buffer, <n>*1000 bytes (default: %u)", DEFAULT_MAXRECEIVEBUFFER), ArgsManager::ALLOW_ANY, OptionsCategory::CONNECTION);
     argsman.AddArg("-maxsendbuffer=<n>", strprintf("Maximum per-connection send buffer, <n>*1000 bytes (default: %u)", DEFAULT_MAXSENDBUFFER), ArgsManager::ALLOW_ANY, OptionsCategory::CONNECTION);
     argsman.AddArg("-maxtimeadjustment", strprintf("Maximum allowed median peer time offset adjustment. Local perspective of time may be influenced by peers forward or backward by this amount. (default: %u seconds)", DEFAULT_MAX_TIME_ADJUSTMENT), ArgsManager::ALLOW_ANY, OptionsCategory::CONNECTION);
     argsman.AddArg("-maxuploadtarget=<n>", strprintf("Tries to keep outbound traffic under the given target (in MiB per 24h). Limit does not apply to peers with 'download' permission. 0 = no limit (default: %d)", DEFAULT_MAX_UPLOAD_TARGET), ArgsManager::ALLOW_ANY, OptionsCategory::CONNECTION);
+    argsman.AddArg("-mnconnectparallel=<n>", strprintf("Open up to <n> masternode and quorum connections at once (1 to %d, default: %d)", MAX_MASTERNODE_CONNECT_PARALLEL, DEFAULT_MASTERNODE_CONNECT_PARALLEL), ArgsManager::ALLOW_ANY, OptionsCategory::CONNECTION);
+    argsman.AddArg("-msgprocthreads=<n>", strprintf("Number of threads processing signature shares, governance votes, CoinJoin queues, DKG contributions, quorum data requests and MNAUTH handshakes besides the message handler thread, up to %d, 0 = process them on the message handler thread (default: %d)", MAX_MSGPROC_THREADS, DEFAULT_MSGPROC_THREADS), ArgsManager::ALLOW_ANY, OptionsCategory::CONNECTION);
     argsman.AddArg("-onion=<ip:port>", "Use separate SOCKS5 proxy to reach peers via Tor onion services, set -noonion to disable (default: -proxy)", ArgsManager::ALLOW_ANY, OptionsCategory::CONNECTION);
     argsman.AddArg("-i2psam=<ip:port>", "I2P SAM proxy to reach I2P peers and accept I2P connections (default: none)", ArgsManager::ALLOW_ANY, OptionsCategory::CONNECTION);
     argsman.AddArg("-i2pacceptincoming", "If set and -i2psam is also set then incoming I2P connections are accepted via the SAM proxy. If this is not set but -i2psam is set then only outgoing connections will be made to the I2P network. Ignored if -i2psam is not set. Listening for incoming I2P connections is done through the SAM proxy, not by binding to a local address and port (default: 1)", ArgsManager::ALLOW_BOOL, OptionsCategory::CONNECTION);
@@ -608,6 +668,7 @@ void SetupServerArgs(NodeContext& node)
     argsman.AddArg("-timeout=<n>", strprintf("Specify socket connection timeout in milliseconds. If an initial attempt to connect is unsuccessful after this amount of time, drop it (minimum: 1, default: %d)", DEFAULT_CONNECT_TIMEOUT), ArgsManager::ALLOW_ANY, OptionsCategory::CONNECTION);
     argsman.AddArg("-torcontrol=<ip>:<port>", strprintf("Tor control port to use if onion listening enabled (default: %s)", DEFAULT_TOR_CONTROL), ArgsManager::ALLOW_ANY, OptionsCategory::CONNECTION);
     argsman.AddArg("-torpassword=<pass>", "Tor control port password (default: empty)", ArgsManager::ALLOW_ANY | ArgsManager::SENSITIVE, OptionsCategory::CONNECTION);
+    argsman.AddArg("-txbatchsize=<n>", strprintf("Accept up to <n> transactions a peer sent back to back together, verifying their scripts on the script verification threads, up to %d, 0 = one at a time (default: %d)", MAX_TX_BATCH_SIZE, DEFAULT_TX_BATCH_SIZE), ArgsManager::ALLOW_ANY, OptionsCategory::CONNECTION);
 #ifdef USE_UPNP
 #if USE_UPNP
     argsman.AddArg("-upnp", "Use UPnP to map the listening port (default: 1 when listening and no -proxy)", ArgsManager::ALLOW_ANY, OptionsCategory::CONNECTION);
@@ -709,6 +770,7 @@ void SetupServerArgs(NodeContext& node)
 #endif
 
     argsman.AddArg("-checkblockindex", strprintf("Do a consistency check for the block tree, and  occasionally. (default: %u, regtest: %u)", defaultChainParams->DefaultConsistencyChecks(), regtestChainParams->DefaultConsistencyChecks()), ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY, OptionsCategory::DEBUG_TEST);
+    argsman.AddArg("-checkblockindexpow", strprintf("Recompute the proof of work hash of every block index entry at startup instead of taking it from the database key (default: %u)", DEFAULT_CHECKBLOCKINDEXPOW), ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY, OptionsCategory::DEBUG_TEST);
     argsman.AddArg("-checkblocks=<n>", strprintf("How many blocks to check at startup (default: %u, 0 = all)", DEFAULT_CHECKBLOCKS), ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY, OptionsCategory::DEBUG_TEST);
     argsman.AddArg("-checklevel=<n>", strprintf("How thorough the block verification of -checkblocks is: %s (0-4, default: %u)", Join(CHECKLEVEL_DOC, ", "), DEFAULT_CHECKLEVEL), ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY, OptionsCategory::DEBUG_TEST);
     argsman.AddArg("-checkmempool=<n>", strprintf("Run checks every <n> transactions (default: %u, regtest: %u)", defaultChainParams->DefaultConsistencyChecks(), regtestChainParams->DefaultConsistencyChecks()), ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY, OptionsCategory::DEBUG_TEST);
@@ -727,6 +789,8 @@ void SetupServerArgs(NodeContext& node)
         "If <category> is not supplied or if <category> = 1, output all debugging information. <category> can be: " + LogInstance().LogCategoriesString() + ". This option can be specified multiple times to output multiple categories.", ArgsManager::ALLOW_ANY, OptionsCategory::DEBUG_TEST);
     argsman.AddArg("-debugexclude=<category>", strprintf("Exclude debugging information for a category. Can be used in conjunction with -debug=1 to output debug logs for all categories except the specified category. This option can be specified multiple times to exclude multiple categories."), ArgsManager::ALLOW_ANY, OptionsCategory::DEBUG_TEST);
     argsman.AddArg("-disablegovernance", strprintf("Disable governance validation (0-1, default: %u)", 0), ArgsManager::ALLOW_ANY, OptionsCategory::DEBUG_TEST);
+    argsman.AddArg("-lockstats", "Measure the time locks are waited for and held at each place they are taken, see getlockstats (default: 0)", ArgsManager::ALLOW_ANY, OptionsCategory::DEBUG_TEST);
+    argsman.AddArg("-logasync", strprintf("Write debug.log from a background thread, so logging threads don't wait for the disk. If it falls behind by %u MiB, messages are dropped. The last messages before a crash may be missing (default: %u)", MAX_ASYNC_LOG_BYTES >> 20, DEFAULT_LOGASYNC), ArgsManager::ALLOW_ANY, OptionsCategory::DEBUG_TEST);
     argsman.AddArg("-logips", strprintf("Include IP addresses in debug output (default: %u)", DEFAULT_LOGIPS), ArgsManager::ALLOW_ANY, OptionsCategory::DEBUG_TEST);
     argsman.AddArg("-logtimemicros", strprintf("Add microsecond precision to debug timestamps (default: %u)", DEFAULT_LOGTIMEMICROS), ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY, OptionsCategory::DEBUG_TEST);
 #ifdef HAVE_THREAD_LOCAL
@@ -767,6 +831,7 @@ void SetupServerArgs(NodeContext& node)
 
     argsman.AddArg("-blockmaxsize=<n>", strprintf("Set maximum block size in bytes (default: %d)", DEFAULT_BLOCK_MAX_SIZE), ArgsManager::ALLOW_ANY, OptionsCategory::BLOCK_CREATION);
     argsman.AddArg("-blockmintxfee=<amt>", strprintf("Set lowest fee rate (in %s/kB) for transactions to be included in block creation. (default: %s)", CURRENCY_UNIT, FormatMoney(DEFAULT_BLOCK_MIN_TX_FEE)), ArgsManager::ALLOW_ANY, OptionsCategory::BLOCK_CREATION);
+    argsman.AddArg("-blocktemplatecache", strprintf("Keep a block template for getblocktemplate built in the background, updated when the tip or the mempool changes (default: %u)", DEFAULT_BLOCK_TEMPLATE_CACHE), ArgsManager::ALLOW_ANY, OptionsCategory::BLOCK_CREATION);
     argsman.AddArg("-blockversion=<n>", "Override block version to test forking scenarios", ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY, OptionsCategory::BLOCK_CREATION);
 
     argsman.AddArg("-rest", strprintf("Accept public REST requests (default: %u)", DEFAULT_REST_ENABLE), ArgsManager::ALLOW_ANY, OptionsCategory::RPC);
@@ -776,12 +841,15 @@ void SetupServerArgs(NodeContext& node)
     argsman.AddArg("-rpccookiefile=<loc>", "Location of the auth cookie. Relative paths will be prefixed by a net-specific datadir location. (default: data dir)", ArgsManager::ALLOW_ANY, OptionsCategory::RPC);
     argsman.AddArg("-rpcpassword=<pw>", "Password for JSON-RPC connections", ArgsManager::ALLOW_ANY | ArgsManager::SENSITIVE, OptionsCategory::RPC);
     argsman.AddArg("-rpcport=<port>", strprintf("Listen for JSON-RPC connections on <port> (default: %u, testnet: %u, regtest: %u)", defaultBaseParams->RPCPort(), testnetBaseParams->RPCPort(), regtestBaseParams->RPCPort()), ArgsManager::ALLOW_ANY | ArgsManager::NETWORK_ONLY, OptionsCategory::RPC);
+    argsman.AddArg("-rpcslowmethods=<methods>", strprintf("Comma-separated list of RPC methods, or of methods and their subcommand separated by a space, which are served by separate worker threads so they can't hold up other calls (default: %s)", DEFAULT_RPC_SLOW_METHODS), ArgsManager::ALLOW_ANY, OptionsCategory::RPC);
+    argsman.AddArg("-rpcslowthreads=<n>", strprintf("Set the number of threads to service slow RPC calls and REST requests, 0 serves them with the other calls (default: %d)", DEFAULT_HTTP_SLOW_THREADS), ArgsManager::ALLOW_ANY, OptionsCategory::RPC);
     argsman.AddArg("-rpcservertimeout=<n>", strprintf("Timeout during HTTP requests (default: %d)", DEFAULT_HTTP_SERVER_TIMEOUT), ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY, OptionsCategory::RPC);
+    argsman.AddArg("-rpcbatchthreads=<n>", strprintf("Number of threads executing the entries of JSON-RPC batch requests concurrently besides the thread serving the request, up to %d, 0 = execute them one after another (default: %d)", MAX_RPC_BATCH_THREADS, DEFAULT_RPC_BATCH_THREADS), ArgsManager::ALLOW_ANY, OptionsCategory::RPC);
     argsman.AddArg("-rpcthreads=<n>", strprintf("Set the number of threads to service RPC calls (default: %d)", DEFAULT_HTTP_THREADS), ArgsManager::ALLOW_ANY, OptionsCategory::RPC);
     argsman.AddArg("-rpcuser=<user>", "Username for JSON-RPC connections", ArgsManager::ALLOW_ANY | ArgsManager::SENSITIVE, OptionsCategory::RPC);
     argsman.AddArg("-rpcwhitelist=<whitelist>", "Set a whitelist to filter incoming RPC calls for a specific user. The field <whitelist> comes in the format: <USERNAME>:<rpc 1>,<rpc 2>,...,<rpc n>. If multiple whitelists are set for a given user, they are set-intersected. See -rpcwhitelistdefault documentation for information on default whitelist behavior.", ArgsManager::ALLOW_ANY, OptionsCategory::RPC);
     argsman.AddArg("-rpcwhitelistdefault", "Sets default behavior for rpc whitelisting. Unless rpcwhitelistdefault is set to 0, if any -rpcwhitelist is set, the rpc server acts as if all rpc users are subject to empty-unless-otherwise-specified whitelists. If rpcwhitelistdefault is set to 1 and no -rpcwhitelist is set, rpc server acts as if all rpc users are subject to empty whitelists.", ArgsManager::ALLOW_BOOL, OptionsCategory::RPC);
-    argsman.AddArg("-rpcworkqueue=<n>", strprintf("Set the depth of the work queue to service RPC calls (default: %d)", DEFAULT_HTTP_WORKQUEUE), ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY, OptionsCategory::RPC);
+    argsman.AddArg("-rpcworkqueue=<n>", strprintf("Set the depth of each work queue to service RPC calls (default: %d)", DEFAULT_HTTP_WORKQUEUE), ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY, OptionsCategory::RPC);
     argsman.AddArg("-server", "Accept command line and JSON-RPC commands", ArgsManager::ALLOW_ANY, OptionsCategory::RPC);
 
     argsman.AddArg("-statsenabled", strprintf("Publish internal stats to statsd (default: %u)", DEFAULT_STATSD_ENABLE), ArgsManager::ALLOW_ANY, OptionsCategory::STATSD);
@@ -936,6 +1004,15 @@ static void PeriodicStats(ArgsManager& args, const CTxMemPool& mempool)
         statsClient.gauge("transactions.mempool.memoryUsageBytes", (int64_t) mempool.DynamicMemoryUsage(), 1.0f);
         statsClient.gauge("transactions.mempool.minFeePerKb", mempool.GetMinFee(args.GetArg("-maxmempool", DEFAULT_MAX_MEMPOOL_SIZE) * 1000000).GetFeePerK(), 1.0f);
     }
+
+    for (const auto& metric : perf::GetSnapshot()) {
+        if (metric.type == perf::MetricType::HISTOGRAM) {
+            statsClient.gauge("perf." + metric.name + ".count", metric.histogram.count, 1.0f);
+            statsClient.gauge("perf." + metric.name + ".sumMicros", metric.histogram.sum, 1.0f);
+        } else {
+            statsClient.gauge("perf." + metric.name, metric.value, 1.0f);
+        }
+    }
 }
 
 /** Sanity checks
@@ -1060,18 +1137,6 @@ void InitParameterInteraction(ArgsManager& args)
         }
     }
 
-    // Make sure additional indexes are recalculated correctly in VerifyDB
-    // (we must reconnect blocks whenever we disconnect them for these indexes to work)
-    bool fAdditionalIndexes =
-        args.GetBoolArg("-addressindex", DEFAULT_ADDRESSINDEX) ||
-        args.GetBoolArg("-spentindex", DEFAULT_SPENTINDEX) ||
-        args.GetBoolArg("-timestampindex", DEFAULT_TIMESTAMPINDEX);
-
-    if (fAdditionalIndexes && args.GetArg("-checklevel", DEFAULT_CHECKLEVEL) < 4) {
-        args.ForceSetArg("-checklevel", "4");
-        LogPrintf("%s: parameter interaction: additional indexes -> setting -checklevel=4\n", __func__);
-    }
-
     if (args.IsArgSet("-masternodeblsprivkey") && args.SoftSetBoolArg("-disablewallet", true)) {
         LogPrintf("%s: parameter interaction: -masternodeblsprivkey set -> setting -disablewallet=1\n", __func__);
     }
@@ -1090,6 +1155,7 @@ void InitLogging(const ArgsManager& args)
     LogInstance().m_print_to_console = args.GetBoolArg("-printtoconsole", !args.GetBoolArg("-daemon", false));
     LogInstance().m_log_timestamps = args.GetBoolArg("-logtimestamps", DEFAULT_LOGTIMESTAMPS);
     LogInstance().m_log_time_micros = args.GetBoolArg("-logtimemicros", DEFAULT_LOGTIMEMICROS);
+    LogInstance().m_async_file = args.GetBoolArg("-logasync", DEFAULT_LOGASYNC);
 #ifdef HAVE_THREAD_LOCAL
     LogInstance().m_log_threadnames = args.GetBoolArg("-logthreadnames", DEFAULT_LOGTHREADNAMES);
 #endif
@@ -1208,6 +1274,13 @@ bool AppInitParameterInteraction(const ArgsManager& args)
     }
 
     // parse and validate enabled filter types
+    for (const std::string& arg : args.GetArgs("-dbprofile")) {
+        std::string error;
+        if (!CheckDBProfileArg(arg, error)) {
+            return InitError(strprintf(_("Invalid -dbprofile '%s': %s"), arg, error));
+        }
+    }
+
     std::string blockfilterindex_value = args.GetArg("-blockfilterindex", DEFAULT_BLOCKFILTERINDEX);
     if (blockfilterindex_value == "" || blockfilterindex_value == "1") {
         g_enabled_filter_types = AllBlockFilterTypes();
@@ -1237,6 +1310,12 @@ bool AppInitParameterInteraction(const ArgsManager& args)
             return InitError(_("Prune mode is incompatible with -txindex."));
         if (args.GetBoolArg("-coinstatsindex", DEFAULT_COINSTATSINDEX))
             return InitError(_("Prune mode is incompatible with -coinstatsindex."));
+        if (args.GetBoolArg("-addressindex", DEFAULT_ADDRESSINDEX))
+            return InitError(_("Prune mode is incompatible with -addressindex."));
+        if (args.GetBoolArg("-spentindex", DEFAULT_SPENTINDEX))
+            return InitError(_("Prune mode is incompatible with -spentindex."));
+        if (args.GetBoolArg("-timestampindex", DEFAULT_TIMESTAMPINDEX))
+            return InitError(_("Prune mode is incompatible with -timestampindex."));
         if (!args.GetBoolArg("-disablegovernance", false)) {
             return InitError(_("Prune mode is incompatible with -disablegovernance=false."));
         }
@@ -1309,6 +1388,12 @@ bool AppInitParameterInteraction(const ArgsManager& args)
 
     fCheckBlockIndex = args.GetBoolArg("-checkblockindex", chainparams.DefaultConsistencyChecks());
     fCheckpointsEnabled = args.GetBoolArg("-checkpoints", DEFAULT_CHECKPOINTS_ENABLED);
+    lockstats::g_enabled = args.GetBoolArg("-lockstats", false);
+
+    // The mempool keeps its own entries for the additional indexes
+    fAddressIndex = args.GetBoolArg("-addressindex", DEFAULT_ADDRESSINDEX);
+    fTimestampIndex = args.GetBoolArg("-timestampindex", DEFAULT_TIMESTAMPINDEX);
+    fSpentIndex = args.GetBoolArg("-spentindex", DEFAULT_SPENTINDEX);
 
     hashAssumeValid = uint256S(args.GetArg("-assumevalid", chainparams.GetConsensus().defaultAssumeValid.GetHex()));
     if (!hashAssumeValid.IsNull())
@@ -1369,6 +1454,10 @@ bool AppInitParameterInteraction(const ArgsManager& args)
         LogPrintf("Prune configured to target %u MiB on disk for block and undo files.\n", nPruneTarget / 1024 / 1024);
         fPruneMode = true;
     }
+    if (fPruneMode && args.GetBoolArg("-prunekeepquorumblocks", DEFAULT_PRUNE_KEEP_QUORUM_BLOCKS)) {
+        nPruneBlocksToKeep = GetQuorumBlocksToKeep(chainparams.GetConsensus());
+        LogPrintf("Prune: keeping the last %u blocks for quorums and the credit pool\n", nPruneBlocksToKeep);
+    }
 
     nConnectTimeout = args.GetArg("-timeout", DEFAULT_CONNECT_TIMEOUT);
     if (nConnectTimeout <= 0) {
@@ -1492,6 +1581,14 @@ static bool LockDataDirectory(bool probeOnly)
     return true;
 }
 
+/** Log how long a startup phase took, the last startup's durations are also kept in the init.<phase>_ms gauges */
+static void LogStartupPhase(const std::string& phase, int64_t start_time)
+{
+    const int64_t elapsed = GetTimeMillis() - start_time;
+    perf::GetGauge(strprintf("init.%s_ms", phase), strprintf("Milliseconds the %s phase of the last startup took", phase)).Set(elapsed);
+    LogPrintf("Startup phase %-10s %7dms\n", phase, elapsed);
+}
+
 bool AppInitSanityChecks()
 {
     // ********************************************************* Step 4: sanity checks
@@ -1606,7 +1703,15 @@ bool AppInitMain(const CoreContext& context, NodeContext& node, interfaces::Bloc
     LogPrintf("Script verification uses %d additional threads\n", script_threads);
     if (script_threads >= 1) {
         g_parallel_script_checks = true;
-        StartScriptCheckWorkerThreads(script_threads);
+        StartScriptCheckWorkerThreads(script_threads, args.GetBoolArg("-scriptcheckaffinity", DEFAULT_SCRIPTCHECK_AFFINITY));
+        StartHeaderHashWorkerThreads(script_threads);
+        StartProTxSigCheckWorkerThreads(script_threads);
+    }
+
+    g_kawpow_epoch_contexts.SetPrefetchBlocks(args.GetArg("-kawpowprefetchblocks", KAWPOW_EPOCH_PREFETCH_BLOCKS));
+    if (args.GetBoolArg("-kawpowfulldag", DEFAULT_KAWPOW_FULL_DAG)) {
+        LogPrintf("KAWPOW full dataset is kept in memory, generated on %d threads\n", GetNumCores());
+        g_kawpow_epoch_contexts.EnableFullDataset(GetNumCores());
     }
 
     assert(activeMasternodeInfo.blsKeyOperator == nullptr);
@@ -1645,7 +1750,8 @@ bool AppInitMain(const CoreContext& context, NodeContext& node, interfaces::Bloc
         RandAddPeriodic();
     }, std::chrono::minutes{1});
 
-    GetMainSignals().RegisterBackgroundSignalScheduler(*node.scheduler);
+    GetMainSignals().RegisterBackgroundSignalScheduler(*node.scheduler,
+        std::clamp<int>(args.GetArg("-validationsignalthreads", DEFAULT_VALIDATION_SIGNAL_THREADS), 0, MAX_VALIDATION_SIGNAL_THREADS));
 
     tableRPC.InitPlatformRestrictions();
 
@@ -1704,7 +1810,7 @@ bool AppInitMain(const CoreContext& context, NodeContext& node, interfaces::Bloc
 
     assert(!node.mempool);
     int check_ratio = std::min<int>(std::max<int>(args.GetArg("-checkmempool", chainparams.DefaultConsistencyChecks() ? 1 : 0), 0), 1000000);
-    node.mempool = std::make_unique<CTxMemPool>(node.fee_estimator.get(), check_ratio);
+    node.mempool = std::make_unique<CTxMemPool>(node.fee_estimator.get(), check_ratio, args.GetBoolArg("-clustermempool", DEFAULT_CLUSTER_MEMPOOL));
 
     assert(!node.chainman);
     node.chainman = &g_chainman;
@@ -1885,10 +1991,15 @@ bool AppInitMain(const CoreContext& context, NodeContext& node, interfaces::Bloc
 
     // ********************************************************* Step 7a: Load sporks
 
-    if (!node.sporkman->LoadCache()) {
-        auto file_path = (GetDataDir() / "sporks.dat").string();
-        return InitError(strprintf(_("Failed to load sporks cache from %s"), file_path));
-    }
+    // Nothing reads sporks before the LLMQ context is started below, so they are loaded while the block
+    // and evo databases are opened. The future waits for the load in its destructor on early returns.
+    std::future<bool> spork_load = std::async(std::launch::async, [&] {
+        util::ThreadRename("sporkload");
+        const int64_t spork_load_start_time = GetTimeMillis();
+        const bool loaded = node.sporkman->LoadCache();
+        LogStartupPhase("sporks", spork_load_start_time);
+        return loaded;
+    });
 
     // ********************************************************* Step 7b: load block chain
 
@@ -1965,7 +2076,8 @@ bool AppInitMain(const CoreContext& context, NodeContext& node, interfaces::Bloc
 
                 // Same logic as above with pblocktree
                 deterministicMNManager.reset();
-                deterministicMNManager = std::make_unique<CDeterministicMNManager>(chainman.ActiveChainstate(), *node.connman, *node.evodb);
+                deterministicMNManager = std::make_unique<CDeterministicMNManager>(chainman.ActiveChainstate(), *node.connman, *node.evodb,
+                                                                                  std::max<int64_t>(args.GetArg("-maxmnlistcache", DEFAULT_MAX_MNLIST_CACHE_SIZE), 0) << 20);
                 node.dmnman = deterministicMNManager.get();
                 creditPoolManager.reset();
                 creditPoolManager = std::make_unique<CCreditPoolManager>(*node.evodb);
@@ -1979,6 +2091,10 @@ bool AppInitMain(const CoreContext& context, NodeContext& node, interfaces::Bloc
                 }
                 node.llmq_ctx.reset();
                 node.llmq_ctx.reset(new LLMQContext(chainman.ActiveChainstate(), *node.connman, *node.evodb, *node.sporkman, *node.mempool, node.peerman, false, fReset || fReindexChainState));
+                if (spork_load.valid() && !spork_load.get()) {
+                    auto file_path = (GetDataDir() / "sporks.dat").string();
+                    return InitError(strprintf(_("Failed to load sporks cache from %s"), file_path));
+                }
                 // Have to start it early to let VerifyDB check ChainLock signatures in coinbase
                 node.llmq_ctx->Start();
 
@@ -1995,11 +2111,13 @@ bool AppInitMain(const CoreContext& context, NodeContext& node, interfaces::Bloc
                 // block file from disk.
                 // Note that it also sets fReindex based on the disk flag!
                 // From here on out fReindex and fReset mean something different!
+                int64_t phase_start_time = GetTimeMillis();
                 if (!chainman.LoadBlockIndex()) {
                     if (ShutdownRequested()) break;
                     strLoadError = _("Error loading block database");
                     break;
                 }
+                LogStartupPhase("blockindex", phase_start_time);
 
                 if (!fDisableGovernance && !args.GetBoolArg("-txindex", DEFAULT_TXINDEX) && chainparams.NetworkIDString() != CBaseChainParams::REGTEST) { // TODO remove this when pruning is fixed. See https://github.com/dashpay/dash/pull/1817 and https://github.com/dashpay/dash/pull/1743
                     return InitError(_("Transaction index can't be disabled with governance validation enabled. Either start with -disablegovernance command line switch or enable transaction index."));
@@ -2017,24 +2135,6 @@ bool AppInitMain(const CoreContext& context, NodeContext& node, interfaces::Bloc
                     return InitError(_("Incorrect or no devnet genesis block found. Wrong datadir for devnet specified?"));
                 }
 
-                // Check for changed -addressindex state
-                if (fAddressIndex != args.GetBoolArg("-addressindex", DEFAULT_ADDRESSINDEX)) {
-                    strLoadError = _("You need to rebuild the database using -reindex to change -addressindex");
-                    break;
-                }
-
-                // Check for changed -timestampindex state
-                if (fTimestampIndex != args.GetBoolArg("-timestampindex", DEFAULT_TIMESTAMPINDEX)) {
-                    strLoadError = _("You need to rebuild the database using -reindex to change -timestampindex");
-                    break;
-                }
-
-                // Check for changed -spentindex state
-                if (fSpentIndex != args.GetBoolArg("-spentindex", DEFAULT_SPENTINDEX)) {
-                    strLoadError = _("You need to rebuild the database using -reindex to change -spentindex");
-                    break;
-                }
-
                 // Check for changed -prune state.  What we are concerned about is a user who has pruned blocks
                 // in the past, but is now trying to run unpruned.
                 if (fHavePruned && !fPruneMode) {
@@ -2054,6 +2154,7 @@ bool AppInitMain(const CoreContext& context, NodeContext& node, interfaces::Bloc
                 // At this point we're either in reindex or we've loaded a useful
                 // block tree into BlockIndex()!
 
+                phase_start_time = GetTimeMillis();
                 bool failed_chainstate_init = false;
                 for (CChainState* chainstate : chainman.GetAll()) {
                     chainstate->InitCoinsDB(
@@ -2110,7 +2211,9 @@ bool AppInitMain(const CoreContext& context, NodeContext& node, interfaces::Bloc
                 if (failed_chainstate_init) {
                     break; // out of the chainstate activation do-while
                 }
+                LogStartupPhase("chainstate", phase_start_time);
 
+                phase_start_time = GetTimeMillis();
                 if (!node.dmnman->MigrateDBIfNeeded()) {
                     strLoadError = _("Error upgrading evo database");
                     break;
@@ -2119,7 +2222,11 @@ bool AppInitMain(const CoreContext& context, NodeContext& node, interfaces::Bloc
                     strLoadError = _("Error upgrading evo database");
                     break;
                 }
+                // A mismatch only leaves the lookups on evodb, VerifyDB below finds out what's wrong
+                node.llmq_ctx->quorum_block_processor->LoadMinedCommitments();
+                LogStartupPhase("evo", phase_start_time);
 
+                phase_start_time = GetTimeMillis();
                 for (CChainState* chainstate : chainman.GetAll()) {
                     if (!is_coinsview_empty(chainstate)) {
                         uiInterface.InitMessage(_("Verifying blocks...").translated);
@@ -2176,6 +2283,8 @@ bool AppInitMain(const CoreContext& context, NodeContext& node, interfaces::Bloc
                         }
                     }
                 }
+                if (failed_verification) break;
+                LogStartupPhase("verifydb", phase_start_time);
             } catch (const std::exception& e) {
                 LogPrintf("%s\n", e.what());
                 strLoadError = _("Error opening block database");
@@ -2229,23 +2338,32 @@ bool AppInitMain(const CoreContext& context, NodeContext& node, interfaces::Bloc
     // ********************************************************* Step 7d: Setup other Dash services
 
     bool fLoadCacheFiles = !(fReindex || fReindexChainState) && (::ChainActive().Tip() != nullptr);
+    const int64_t load_caches_start_time = GetTimeMillis();
 
-    if (!fDisableGovernance) {
-        if (!node.govman->LoadCache(fLoadCacheFiles)) {
-            auto file_path = (GetDataDir() / "governance.dat").string();
-            if (fLoadCacheFiles && !fDisableGovernance) {
-                return InitError(strprintf(_("Failed to load governance cache from %s"), file_path));
-            }
-            return InitError(strprintf(_("Failed to clear governance cache at %s"), file_path));
+    // The masternode and fulfilled request caches don't depend on governance or on each other,
+    // load them while governance is loading instead of one after another
+    assert(!::mmetaman);
+    assert(!::netfulfilledman);
+    std::thread cache_thread([&] {
+        ::mmetaman = std::make_unique<CMasternodeMetaMan>(fLoadCacheFiles);
+        ::netfulfilledman = std::make_unique<CNetFulfilledRequestManager>(fLoadCacheFiles);
+    });
+
+    const bool fGovernanceLoaded = fDisableGovernance || node.govman->LoadCache(fLoadCacheFiles);
+    cache_thread.join();
+
+    if (!fGovernanceLoaded) {
+        auto file_path = (GetDataDir() / "governance").string();
+        if (fLoadCacheFiles) {
+            return InitError(strprintf(_("Failed to load governance cache from %s"), file_path));
         }
+        return InitError(strprintf(_("Failed to clear governance cache at %s"), file_path));
     }
 
     assert(!::dstxManager);
     ::dstxManager = std::make_unique<CDSTXManager>();
     node.dstxman = ::dstxManager.get();
 
-    assert(!::mmetaman);
-    ::mmetaman = std::make_unique<CMasternodeMetaMan>(fLoadCacheFiles);
     node.mn_metaman = ::mmetaman.get();
     if (!node.mn_metaman->IsValid()) {
         auto file_path = (GetDataDir() / "mncache.dat").string();
@@ -2255,8 +2373,6 @@ bool AppInitMain(const CoreContext& context, NodeContext& node, interfaces::Bloc
         return InitError(strprintf(_("Failed to clear masternode cache at %s"), file_path));
     }
 
-    assert(!::netfulfilledman);
-    ::netfulfilledman = std::make_unique<CNetFulfilledRequestManager>(fLoadCacheFiles);
     node.netfulfilledman = ::netfulfilledman.get();
     if (!node.netfulfilledman->IsValid()) {
         auto file_path = (GetDataDir() / "netfulfilled.dat").string();
@@ -2265,6 +2381,7 @@ bool AppInitMain(const CoreContext& context, NodeContext& node, interfaces::Bloc
         }
         return InitError(strprintf(_("Failed to clear fulfilled requests cache at %s"), file_path));
     }
+    LogStartupPhase("caches", load_caches_start_time);
 
     // ********************************************************* Step 8: start indexers
     if (args.GetBoolArg("-txindex", DEFAULT_TXINDEX)) {
@@ -2288,12 +2405,35 @@ bool AppInitMain(const CoreContext& context, NodeContext& node, interfaces::Bloc
         }
     }
 
+    if (fAddressIndex) {
+        g_addressindex = std::make_unique<AddressIndex>(/* cache size */ 0, false, fReindex);
+        if (!g_addressindex->Start(::ChainstateActive())) {
+            return false;
+        }
+    }
+
+    if (fSpentIndex) {
+        g_spentindex = std::make_unique<SpentIndex>(/* cache size */ 0, false, fReindex);
+        if (!g_spentindex->Start(::ChainstateActive())) {
+            return false;
+        }
+    }
+
+    if (fTimestampIndex) {
+        g_timestampindex = std::make_unique<TimestampIndex>(/* cache size */ 0, false, fReindex);
+        if (!g_timestampindex->Start(::ChainstateActive())) {
+            return false;
+        }
+    }
+
     // ********************************************************* Step 9: load wallet
+    const int64_t load_wallets_start_time = GetTimeMillis();
     for (const auto& client : node.chain_clients) {
         if (!client->load()) {
             return false;
         }
     }
+    LogStartupPhase("wallets", load_wallets_start_time);
 
     // As InitLoadWallet can take several minutes, it's possible the user
     // requested to kill the GUI during the last operation. If so, exit.
@@ -2329,28 +2469,42 @@ bool AppInitMain(const CoreContext& context, NodeContext& node, interfaces::Bloc
 
     // ********************************************************* Step 10a: schedule Dash-specific tasks
 
-    node.scheduler->scheduleEvery(std::bind(&CNetFulfilledRequestManager::DoMaintenance, std::ref(*node.netfulfilledman)), std::chrono::minutes{1});
-    node.scheduler->scheduleEvery(std::bind(&CMasternodeSync::DoMaintenance, std::ref(*node.mn_sync)), std::chrono::seconds{1});
-    node.scheduler->scheduleEvery(std::bind(&CMasternodeUtils::DoMaintenance, std::ref(*node.connman), std::ref(*node.mn_sync), std::ref(*node.cj_ctx)), std::chrono::minutes{1});
-    node.scheduler->scheduleEvery(std::bind(&CDeterministicMNManager::DoMaintenance, std::ref(*node.dmnman)), std::chrono::seconds{10});
+    // These run on their own threads, so slow maintenance doesn't hold up the notifications and network tasks
+    assert(!node.maintenance_scheduler);
+    node.maintenance_scheduler = std::make_unique<CScheduler>();
+    node.maintenance_scheduler->StartServiceThreads("maintenance",
+        std::clamp<int>(args.GetArg("-maintenancethreads", DEFAULT_MAINTENANCE_THREADS), 1, MAX_MAINTENANCE_THREADS));
+
+    node.maintenance_scheduler->scheduleEvery(std::bind(&CNetFulfilledRequestManager::DoMaintenance, std::ref(*node.netfulfilledman)), std::chrono::minutes{1}, "netfulfilled");
+    node.maintenance_scheduler->scheduleEvery(std::bind(&CMasternodeSync::DoMaintenance, std::ref(*node.mn_sync)), std::chrono::seconds{1}, "mnsync");
+    node.maintenance_scheduler->scheduleEvery(std::bind(&CMasternodeUtils::DoMaintenance, std::ref(*node.connman), std::ref(*node.mn_sync), std::ref(*node.cj_ctx)), std::chrono::minutes{1}, "mnutils");
+    node.maintenance_scheduler->scheduleEvery(std::bind(&CDeterministicMNManager::DoMaintenance, std::ref(*node.dmnman)), std::chrono::seconds{10}, "dmnman");
 
     if (!fDisableGovernance) {
-        node.scheduler->scheduleEvery(std::bind(&CGovernanceManager::DoMaintenance, std::ref(*node.govman), std::ref(*node.connman)), std::chrono::minutes{5});
+        node.maintenance_scheduler->scheduleEvery(std::bind(&CGovernanceManager::DoMaintenance, std::ref(*node.govman), std::ref(*node.connman)), std::chrono::minutes{5}, "governance");
+        node.maintenance_scheduler->scheduleEvery(std::bind(&CGovernanceManager::ProcessPendingVotes, std::ref(*node.govman), std::ref(*node.connman), std::ref(*node.peerman), node.llmq_ctx->bls_worker.get()), std::chrono::milliseconds{100}, "governance_votes");
     }
 
     if (fMasternodeMode) {
-        node.scheduler->scheduleEvery(std::bind(&CCoinJoinServer::DoMaintenance, std::ref(*node.cj_ctx->server)), std::chrono::seconds{1});
-        node.scheduler->scheduleEvery(std::bind(&llmq::CDKGSessionManager::CleanupOldContributions, std::ref(*node.llmq_ctx->qdkgsman)), std::chrono::hours{1});
+        node.maintenance_scheduler->scheduleEvery(std::bind(&CCoinJoinServer::DoMaintenance, std::ref(*node.cj_ctx->server)), std::chrono::seconds{1}, "coinjoin_server");
+        node.maintenance_scheduler->scheduleEvery(std::bind(&llmq::CDKGSessionManager::CleanupOldContributions, std::ref(*node.llmq_ctx->qdkgsman)), std::chrono::hours{1}, "dkg_cleanup");
 #ifdef ENABLE_WALLET
     } else if (!ignores_incoming_txs) {
-        node.scheduler->scheduleEvery(std::bind(&CCoinJoinClientQueueManager::DoMaintenance, std::ref(*node.cj_ctx->queueman)), std::chrono::seconds{1});
-        node.scheduler->scheduleEvery(std::bind(&CoinJoinWalletManager::DoMaintenance, std::ref(*node.cj_ctx->walletman), std::ref(*node.fee_estimator)), std::chrono::seconds{1});
+        node.maintenance_scheduler->scheduleEvery(std::bind(&CCoinJoinClientQueueManager::DoMaintenance, std::ref(*node.cj_ctx->queueman)), std::chrono::seconds{1}, "coinjoin_queue");
+        node.maintenance_scheduler->scheduleEvery(std::bind(&CoinJoinWalletManager::DoMaintenance, std::ref(*node.cj_ctx->walletman), std::ref(*node.fee_estimator)), std::chrono::seconds{1}, "coinjoin_wallet");
 #endif // ENABLE_WALLET
     }
 
+    if (args.GetBoolArg("-blocktemplatecache", DEFAULT_BLOCK_TEMPLATE_CACHE)) {
+        node.block_template_cache = std::make_unique<BlockTemplateCache>(node);
+        RegisterValidationInterface(node.block_template_cache.get());
+        node.block_template_cache->Start();
+    }
+
     if (args.GetBoolArg("-statsenabled", DEFAULT_STATSD_ENABLE)) {
+        statsClient.Start();
         int nStatsPeriod = std::min(std::max((int)args.GetArg("-statsperiod", DEFAULT_STATSD_PERIOD), MIN_STATSD_PERIOD), MAX_STATSD_PERIOD);
-        node.scheduler->scheduleEvery(std::bind(&PeriodicStats, std::ref(*node.args), std::cref(*node.mempool)), std::chrono::seconds{nStatsPeriod});
+        node.maintenance_scheduler->scheduleEvery(std::bind(&PeriodicStats, std::ref(*node.args), std::cref(*node.mempool)), std::chrono::seconds{nStatsPeriod}, "stats");
     }
 
     // ********************************************************* Step 11: import blocks
@@ -2432,6 +2586,10 @@ bool AppInitMain(const CoreContext& context, NodeContext& node, interfaces::Bloc
         LOCK(cs_main);
         LogPrintf("block tree size = %u\n", chainman.BlockIndex().size());
         chain_active_height = chainman.ActiveChain().Height();
+        const CBlockIndex* tip = chainman.ActiveChain().Tip();
+        if (tip && tip->nTime >= nKAWPOWActivationTime && !chainman.ActiveChainstate().IsInitialBlockDownload()) {
+            g_kawpow_epoch_contexts.PrepareFullDataset(ethash::get_epoch_number(tip->nHeight));
+        }
         if (tip_info) {
             tip_info->block_height = chain_active_height;
             tip_info->block_time = chainman.ActiveChain().Tip() ? chainman.ActiveChain().Tip()->GetBlockTime() : Params().GenesisBlock().GetBlockTime();
@@ -0,0 +1,277 @@
+// Copyright (c) 2026 The Dash Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <kawpow.h>
+
+#include <crypto-X16R/ethash/include/ethash/progpow.hpp>
+#include <crypto-X16R/ethash/lib/ethash/ethash-internal.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <new>
+#include <vector>
+
+namespace {
+//! Number of 2048 bit dataset items a generator thread claims at a time
+constexpr uint32_t FULL_DATASET_CHUNK_ITEMS = 4096;
+
+uint64_t LightContextBytes(const ethash::epoch_context& context)
+{
+    return ethash::get_light_cache_size(context.light_cache_num_items) + progpow::l1_cache_size;
+}
+
+int64_t MicrosSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+} // namespace
+
+CKAWPOWEpochContextCache g_kawpow_epoch_contexts;
+
+CKAWPOWEpochContextCache::CKAWPOWEpochContextCache(size_t max_epochs) :
+    m_max_epochs(std::max<size_t>(max_epochs, 1))
+{
+}
+
+CKAWPOWEpochContextCache::~CKAWPOWEpochContextCache()
+{
+    Stop();
+}
+
+CKAWPOWEpochContextCache::ContextPtr CKAWPOWEpochContextCache::Get(int epoch_number)
+{
+    return Get(epoch_number, /* prefetch */ false);
+}
+
+CKAWPOWEpochContextCache::ContextPtr CKAWPOWEpochContextCache::Get(int epoch_number, bool prefetch)
+{
+    const auto start = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> lock(m_mutex);
+    bool waited{false};
+    while (true) {
+        auto it = m_entries.find(epoch_number);
+        if (it == m_entries.end()) break;
+        if (it->second.context) {
+            it->second.last_used = ++m_use_counter;
+            if (waited && !prefetch) m_light_blocked_us += MicrosSince(start);
+            return it->second.context;
+        }
+        // Somebody else is building this epoch right now, wait for them
+        waited = true;
+        m_cv.wait(lock);
+    }
+
+    // Claim the build and do the expensive part without holding the lock
+    m_entries.emplace(epoch_number, Entry{});
+    lock.unlock();
+
+    // The light cache is a chain of hashes, every item depends on the one before, so it can't be built in parallel
+    const auto build_start = std::chrono::steady_clock::now();
+    ethash::epoch_context* raw = ethash_create_epoch_context(epoch_number);
+
+    lock.lock();
+    ++m_light_builds;
+    m_light_last_build_us = MicrosSince(build_start);
+    if (!prefetch) m_light_blocked_us += MicrosSince(start);
+    if (raw == nullptr) {
+        m_entries.erase(epoch_number);
+        m_cv.notify_all();
+        throw std::bad_alloc();
+    }
+    ContextPtr context(raw, [](const ethash::epoch_context* ctx) {
+        ethash_destroy_epoch_context(const_cast<ethash::epoch_context*>(ctx));
+    });
+    Entry& entry = m_entries[epoch_number];
+    entry.context = context;
+    entry.last_used = ++m_use_counter;
+    EvictLocked();
+    m_cv.notify_all();
+    return context;
+}
+
+void CKAWPOWEpochContextCache::EvictLocked()
+{
+    size_t built = 0;
+    for (const auto& [_, entry] : m_entries) {
+        if (entry.context) ++built;
+    }
+    while (built > m_max_epochs) {
+        auto oldest = m_entries.end();
+        for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+            if (!it->second.context) continue;
+            if (oldest == m_entries.end() || it->second.last_used < oldest->second.last_used) {
+                oldest = it;
+            }
+        }
+        // Users still holding the context keep it alive until they are done
+        m_entries.erase(oldest);
+        --built;
+    }
+}
+
+void CKAWPOWEpochContextCache::Prefetch(int epoch_number)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_stopped || m_prefetch_running || m_entries.count(epoch_number)) return;
+
+    // The previous prefetch already cleared m_prefetch_running, so this join does not block on the lock
+    if (m_prefetch_thread.joinable()) m_prefetch_thread.join();
+
+    m_prefetch_running = true;
+    m_prefetch_thread = std::thread([this, epoch_number] {
+        try {
+            Get(epoch_number, /* prefetch */ true);
+        } catch (const std::bad_alloc&) {
+            // Whoever needs the epoch next will retry and report the failure
+        }
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_prefetch_running = false;
+    });
+}
+
+void CKAWPOWEpochContextCache::MaybePrefetchNext(int block_height)
+{
+    const int prefetch_blocks = m_prefetch_blocks;
+    if (block_height < 0 || prefetch_blocks <= 0) return;
+    if (block_height % ethash::epoch_length < ethash::epoch_length - prefetch_blocks) return;
+    Prefetch(ethash::get_epoch_number(block_height) + 1);
+}
+
+void CKAWPOWEpochContextCache::SetPrefetchBlocks(int blocks)
+{
+    m_prefetch_blocks = std::clamp(blocks, 0, ethash::epoch_length);
+}
+
+void CKAWPOWEpochContextCache::EnableFullDataset(int threads)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_full_threads = std::max(threads, 0);
+}
+
+void CKAWPOWEpochContextCache::PrepareFullDataset(int epoch_number)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_full_threads == 0 || m_stopped || m_full_epoch == epoch_number) return;
+    if (m_full_running) {
+        // Wind down the generation for the old epoch; the next call starts over
+        m_full_abort = true;
+        return;
+    }
+
+    // The previous generation already cleared m_full_running, so this join does not block on the lock
+    if (m_full_thread.joinable()) m_full_thread.join();
+
+    // Only one dataset is ever kept: hashes still running on the old one keep it alive until done
+    m_full_context.reset();
+    m_full_ready = false;
+    m_full_epoch = epoch_number;
+    m_full_items_done = 0;
+    m_full_items_total = ethash::calculate_full_dataset_num_items(epoch_number) / 2;
+    m_full_abort = false;
+    m_full_running = true;
+    m_full_thread = std::thread([this, epoch_number] { GenerateFullDataset(epoch_number); });
+}
+
+void CKAWPOWEpochContextCache::GenerateFullDataset(int epoch_number)
+{
+    // Only the light cache is built here, the dataset memory is merely reserved
+    ethash::epoch_context_full* raw = ethash_create_epoch_context_full(epoch_number);
+    if (raw == nullptr) {
+        // Out of memory, keep hashing with the light context
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_full_running = false;
+        return;
+    }
+    FullContextPtr context(raw, [](const ethash::epoch_context_full* ctx) {
+        ethash_destroy_epoch_context_full(const_cast<ethash::epoch_context_full*>(ctx));
+    });
+    int threads;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_full_context = context;
+        threads = m_full_threads;
+    }
+
+    // progpow looks the dataset up in 2048 bit items, which is what gets precomputed
+    auto* items = reinterpret_cast<ethash::hash2048*>(raw->full_dataset);
+    const uint32_t total = raw->full_dataset_num_items / 2;
+    std::atomic<uint32_t> next_chunk{0};
+    auto generate = [&] {
+        while (!m_full_abort) {
+            const uint32_t begin = next_chunk.fetch_add(FULL_DATASET_CHUNK_ITEMS);
+            if (begin >= total) break;
+            const uint32_t end = std::min(total, begin + FULL_DATASET_CHUNK_ITEMS);
+            for (uint32_t i = begin; i < end; ++i) {
+                items[i] = ethash::calculate_dataset_item_2048(*raw, i);
+            }
+            m_full_items_done += end - begin;
+        }
+    };
+    std::vector<std::thread> workers;
+    for (int i = 1; i < threads; ++i) {
+        workers.emplace_back(generate);
+    }
+    generate();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_full_abort) {
+        m_full_context.reset();
+        m_full_epoch = -1;
+    } else {
+        m_full_ready = true;
+    }
+    m_full_running = false;
+}
+
+CKAWPOWEpochContextCache::FullContextPtr CKAWPOWEpochContextCache::GetFullDataset(int epoch_number) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_full_ready || m_full_epoch != epoch_number) return nullptr;
+    return m_full_context;
+}
+
+void CKAWPOWEpochContextCache::Stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopped = true;
+        m_full_abort = true;
+    }
+    if (m_prefetch_thread.joinable()) m_prefetch_thread.join();
+    if (m_full_thread.joinable()) m_full_thread.join();
+}
+
+bool CKAWPOWEpochContextCache::IsCached(int epoch_number) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_entries.find(epoch_number);
+    return it != m_entries.end() && it->second.context;
+}
+
+CKAWPOWEpochContextCache::Stats CKAWPOWEpochContextCache::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Stats stats;
+    for (const auto& [_, entry] : m_entries) {
+        if (!entry.context) continue;
+        ++stats.light_epochs;
+        stats.light_bytes += LightContextBytes(*entry.context);
+    }
+    stats.full_epoch = m_full_epoch;
+    if (m_full_context) {
+        stats.full_bytes = LightContextBytes(*m_full_context) +
+                           ethash::get_full_dataset_size(m_full_context->full_dataset_num_items);
+    }
+    if (m_full_items_total > 0) {
+        stats.full_progress = double(m_full_items_done) / m_full_items_total;
+    }
+    stats.full_ready = m_full_ready;
+    stats.light_builds = m_light_builds;
+    stats.light_last_build_us = m_light_last_build_us;
+    stats.light_blocked_us = m_light_blocked_us;
+    return stats;
+}
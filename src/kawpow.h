@@ -0,0 +1,151 @@
+// Copyright (c) 2026 The Dash Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_KAWPOW_H
+#define BITCOIN_KAWPOW_H
+
+#include <crypto-X16R/ethash/include/ethash/ethash.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+/** Number of epoch contexts kept around by default (previous, current and next epoch) */
+static constexpr size_t DEFAULT_KAWPOW_CACHED_EPOCHS = 3;
+/** Start building the next epoch's light cache this many blocks before the boundary by default */
+static constexpr int KAWPOW_EPOCH_PREFETCH_BLOCKS = 100;
+/** Whether to keep the full KAWPOW dataset of the current epoch in memory by default */
+static constexpr bool DEFAULT_KAWPOW_FULL_DAG = false;
+
+/**
+ * Process-wide cache of ethash epoch contexts used for KAWPOW hashing.
+ *
+ * Contexts are handed out as shared pointers, so a caller may keep using one
+ * after it has been evicted. Building a light cache takes seconds, so a given
+ * epoch is only ever built by one thread; everybody else asking for it waits
+ * for that build to finish instead of starting their own.
+ *
+ * Optionally (see EnableFullDataset()) the full dataset of one epoch is kept
+ * as well. It is generated on background threads and only handed out once
+ * every item is in place, because ethash fills in missing items lazily and not
+ * in a thread safe way. Until then hashing keeps using the light context.
+ *
+ * Validating headers and blocks doesn't use these contexts, it computes the
+ * hash from the mix hash a header carries (KAWPOWHash_OnlyMix), so header
+ * sync and reindex never wait for a light cache. They are needed to mine.
+ *
+ * This only depends on the standard library because it is used from hash.cpp,
+ * which is part of the consensus library.
+ */
+class CKAWPOWEpochContextCache
+{
+public:
+    using ContextPtr = std::shared_ptr<const ethash::epoch_context>;
+    using FullContextPtr = std::shared_ptr<const ethash::epoch_context_full>;
+
+    struct Stats {
+        //! Number of light contexts built and cached
+        size_t light_epochs{0};
+        //! Bytes used by those light contexts
+        uint64_t light_bytes{0};
+        //! Epoch of the full dataset being generated or kept, -1 if none
+        int full_epoch{-1};
+        //! Bytes allocated for the full dataset, including its own light cache
+        uint64_t full_bytes{0};
+        //! Fraction of the full dataset generated so far
+        double full_progress{0};
+        //! Whether the full dataset is complete and used for hashing
+        bool full_ready{false};
+        //! Number of light contexts built, in the background or not
+        uint64_t light_builds{0};
+        //! Microseconds the last light context took to build
+        int64_t light_last_build_us{0};
+        //! Microseconds callers of Get() spent building or waiting for a context they needed right away
+        int64_t light_blocked_us{0};
+    };
+
+    explicit CKAWPOWEpochContextCache(size_t max_epochs = DEFAULT_KAWPOW_CACHED_EPOCHS);
+    ~CKAWPOWEpochContextCache();
+
+    CKAWPOWEpochContextCache(const CKAWPOWEpochContextCache&) = delete;
+    CKAWPOWEpochContextCache& operator=(const CKAWPOWEpochContextCache&) = delete;
+
+    /** Return the context for epoch_number, building it on the calling thread if nobody else is */
+    ContextPtr Get(int epoch_number);
+
+    /** Build the context for epoch_number on the background thread unless it is cached or being built */
+    void Prefetch(int epoch_number);
+
+    /** Prefetch the following epoch once block_height is close enough to the end of its own */
+    void MaybePrefetchNext(int block_height);
+
+    /** Set how many blocks before the end of an epoch MaybePrefetchNext starts, 0 = never */
+    void SetPrefetchBlocks(int blocks);
+
+    /** Keep a full dataset around, generating it on the given number of threads (0 = disabled) */
+    void EnableFullDataset(int threads);
+
+    /**
+     * Get the full dataset of epoch_number ready in the background, dropping any
+     * other one. Cheap to call repeatedly; does nothing unless enabled.
+     */
+    void PrepareFullDataset(int epoch_number);
+
+    /** The full dataset of epoch_number if it is completely generated, null otherwise */
+    FullContextPtr GetFullDataset(int epoch_number) const;
+
+    /** Wait for a running prefetch to finish and abort dataset generation; later requests are ignored */
+    void Stop();
+
+    /** Whether the context for epoch_number is built and cached */
+    bool IsCached(int epoch_number) const;
+
+    Stats GetStats() const;
+
+private:
+    struct Entry {
+        //! Null while the context is being built
+        ContextPtr context;
+        //! Value of m_use_counter on last access, used for LRU eviction
+        uint64_t last_used{0};
+    };
+
+    ContextPtr Get(int epoch_number, bool prefetch);
+    void EvictLocked();
+    void GenerateFullDataset(int epoch_number);
+
+    const size_t m_max_epochs;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::map<int, Entry> m_entries;
+    uint64_t m_use_counter{0};
+
+    std::thread m_prefetch_thread;
+    bool m_prefetch_running{false};
+    bool m_stopped{false};
+    std::atomic<int> m_prefetch_blocks{KAWPOW_EPOCH_PREFETCH_BLOCKS};
+
+    uint64_t m_light_builds{0};
+    int64_t m_light_last_build_us{0};
+    int64_t m_light_blocked_us{0};
+
+    int m_full_threads{0};
+    int m_full_epoch{-1};
+    FullContextPtr m_full_context;
+    bool m_full_ready{false};
+    bool m_full_running{false};
+    std::thread m_full_thread;
+    std::atomic<bool> m_full_abort{false};
+    std::atomic<uint32_t> m_full_items_done{0};
+    uint32_t m_full_items_total{0};
+};
+
+extern CKAWPOWEpochContextCache g_kawpow_epoch_contexts;
+
+#endif // BITCOIN_KAWPOW_H
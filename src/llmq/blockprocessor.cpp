@@ -24,6 +24,8 @@
 #include <util/underlying.h>
 #include <validation.h>
 
+#include <algorithm>
+#include <limits>
 #include <map>
 
 static void PreComputeQuorumMembers(const CBlockIndex* pindex, bool reset_cache = false)
@@ -50,6 +52,7 @@ CQuorumBlockProcessor::CQuorumBlockProcessor(CChainState& chainstate, CConnman&
     m_chainstate(chainstate), connman(_connman), m_evoDb(evoDb)
 {
     utils::InitQuorumsCache(mapHasMinedCommitmentCache);
+    utils::InitQuorumsCache(mapMinedCommitmentHashCache, false);
 }
 
 PeerMsgRet CQuorumBlockProcessor::ProcessMessage(const CNode& peer, std::string_view msg_type, CDataStream& vRecv)
@@ -189,7 +192,7 @@ bool CQuorumBlockProcessor::ProcessBlock(const CBlock& block, gsl::not_null<cons
 
     for (const auto& p : qcs) {
         const auto& qc = p.second;
-        if (!ProcessCommitment(pindex->nHeight, blockHash, qc, state, fJustCheck, fBLSChecks)) {
+        if (!ProcessCommitment(pindex, qc, state, fJustCheck, fBLSChecks)) {
             LogPrintf("[ProcessBlock] failed h[%d] llmqType[%d] version[%d] quorumIndex[%d] quorumHash[%s]\n", pindex->nHeight, ToUnderlying(qc.llmqType), qc.nVersion, qc.quorumIndex, qc.quorumHash.ToString());
             return false;
         }
@@ -214,10 +217,12 @@ static std::tuple<std::string, Consensus::LLMQType, int, uint32_t> BuildInversed
     return std::make_tuple(DB_MINED_COMMITMENT_BY_INVERSED_HEIGHT_Q_INDEXED, llmqType, quorumIndex, htobe32(std::numeric_limits<uint32_t>::max() - nMinedHeight));
 }
 
-bool CQuorumBlockProcessor::ProcessCommitment(int nHeight, const uint256& blockHash, const CFinalCommitment& qc, BlockValidationState& state, bool fJustCheck, bool fBLSChecks)
+bool CQuorumBlockProcessor::ProcessCommitment(gsl::not_null<const CBlockIndex*> pindex, const CFinalCommitment& qc, BlockValidationState& state, bool fJustCheck, bool fBLSChecks)
 {
     AssertLockHeld(cs_main);
 
+    const int nHeight = pindex->nHeight;
+
     const auto& llmq_params_opt = Params().GetLLMQ(qc.llmqType);
     if (!llmq_params_opt.has_value()) {
         LogPrint(BCLog::LLMQ, "CQuorumBlockProcessor::%s -- invalid commitment type %d\n", __func__, ToUnderlying(qc.llmqType));
@@ -284,26 +289,66 @@ bool CQuorumBlockProcessor::ProcessCommitment(int nHeight, const uint256& blockH
                  nHeight, pQuorumBaseBlockIndex->nHeight, qc.quorumIndex, qc.nVersion);
     }
 
+    WriteMinedCommitment(llmq_params, pindex, qc, pQuorumBaseBlockIndex);
+
+    LogPrint(BCLog::LLMQ, "CQuorumBlockProcessor::%s -- processed commitment from block. type=%d, quorumIndex=%d, quorumHash=%s, signers=%s, validMembers=%d, quorumPublicKey=%s\n", __func__,
+             ToUnderlying(qc.llmqType), qc.quorumIndex, quorumHash.ToString(), qc.CountSigners(), qc.CountValidMembers(), qc.quorumPublicKey.ToString());
+
+    return true;
+}
+
+void CQuorumBlockProcessor::WriteMinedCommitment(const Consensus::LLMQParams& llmq_params, gsl::not_null<const CBlockIndex*> pMinedBlockIndex,
+                                                 const CFinalCommitment& qc, gsl::not_null<const CBlockIndex*> pQuorumBaseBlockIndex)
+{
+    const int nHeight = pMinedBlockIndex->nHeight;
+
     // Store commitment in DB
-    auto cacheKey = std::make_pair(llmq_params.type, quorumHash);
-    m_evoDb.Write(std::make_pair(DB_MINED_COMMITMENT, cacheKey), std::make_pair(qc, blockHash));
+    auto cacheKey = std::make_pair(llmq_params.type, qc.quorumHash);
+    m_evoDb.Write(std::make_pair(DB_MINED_COMMITMENT, cacheKey), std::make_pair(qc, pMinedBlockIndex->GetBlockHash()));
 
-    if (rotation_enabled) {
+    const bool fRotation = IsQuorumRotationEnabled(llmq_params, pQuorumBaseBlockIndex);
+    if (fRotation) {
         m_evoDb.Write(BuildInversedHeightKeyIndexed(llmq_params.type, nHeight, int(qc.quorumIndex)), pQuorumBaseBlockIndex->nHeight);
     } else {
         m_evoDb.Write(BuildInversedHeightKey(llmq_params.type, nHeight), pQuorumBaseBlockIndex->nHeight);
     }
 
+    {
+        LOCK(cs_mined_by_height);
+        auto& entries = mapMinedByHeight[{llmq_params.type, fRotation ? int(qc.quorumIndex) : -1}];
+        const auto range = entries.equal_range(nHeight);
+        // blocks are connected again after a rolled back attempt or a reorg back to them
+        if (std::none_of(range.first, range.second, [&](const auto& p) { return p.second.pMinedBlockIndex == pMinedBlockIndex; })) {
+            entries.emplace(nHeight, MinedCommitmentEntry{pMinedBlockIndex, pQuorumBaseBlockIndex->nHeight});
+        }
+    }
+
     {
         LOCK(minableCommitmentsCs);
         mapHasMinedCommitmentCache[qc.llmqType].erase(qc.quorumHash);
+        mapMinedCommitmentHashCache[qc.llmqType].erase(qc.quorumHash);
         minableCommitmentsByQuorum.erase(cacheKey);
         minableCommitments.erase(::SerializeHash(qc));
     }
+}
 
-    LogPrint(BCLog::LLMQ, "CQuorumBlockProcessor::%s -- processed commitment from block. type=%d, quorumIndex=%d, quorumHash=%s, signers=%s, validMembers=%d, quorumPublicKey=%s\n", __func__,
-             ToUnderlying(qc.llmqType), qc.quorumIndex, quorumHash.ToString(), qc.CountSigners(), qc.CountValidMembers(), qc.quorumPublicKey.ToString());
-
+bool CQuorumBlockProcessor::ImportMinedCommitment(const CFinalCommitment& qc, gsl::not_null<const CBlockIndex*> pMinedBlockIndex)
+{
+    const auto llmq_params_opt = Params().GetLLMQ(qc.llmqType);
+    if (!llmq_params_opt.has_value() || qc.IsNull()) {
+        return false;
+    }
+    const auto* pQuorumBaseBlockIndex = m_chainstate.m_blockman.LookupBlockIndex(qc.quorumHash);
+    if (pQuorumBaseBlockIndex == nullptr || pMinedBlockIndex->GetAncestor(pQuorumBaseBlockIndex->nHeight) != pQuorumBaseBlockIndex) {
+        return false;
+    }
+    // The members are checked against the masternode lists, which must be imported first
+    if (!qc.Verify(pQuorumBaseBlockIndex, /* checkSigs */ true)) {
+        LogPrint(BCLog::LLMQ, "CQuorumBlockProcessor::%s -- type=%d, quorumHash=%s, qc verify failed\n", __func__,
+                 ToUnderlying(qc.llmqType), qc.quorumHash.ToString());
+        return false;
+    }
+    WriteMinedCommitment(llmq_params_opt.value(), pMinedBlockIndex, qc, pQuorumBaseBlockIndex);
     return true;
 }
 
@@ -339,6 +384,7 @@ bool CQuorumBlockProcessor::UndoBlock(const CBlock& block, gsl::not_null<const C
         {
             LOCK(minableCommitmentsCs);
             mapHasMinedCommitmentCache[qc.llmqType].erase(qc.quorumHash);
+            mapMinedCommitmentHashCache[qc.llmqType].erase(qc.quorumHash);
         }
 
         // if a reorg happened, we should allow to mine this commitment later
@@ -480,9 +526,118 @@ CFinalCommitmentPtr CQuorumBlockProcessor::GetMinedCommitment(Consensus::LLMQTyp
     return std::make_unique<CFinalCommitment>(p.first);
 }
 
+std::optional<uint256> CQuorumBlockProcessor::GetMinedCommitmentHash(Consensus::LLMQType llmqType, const uint256& quorumHash) const
+{
+    uint256 qcHash;
+    {
+        LOCK(minableCommitmentsCs);
+        if (mapMinedCommitmentHashCache[llmqType].get(quorumHash, qcHash)) {
+            return qcHash;
+        }
+    }
+
+    uint256 dummyHash;
+    const auto pqc = GetMinedCommitment(llmqType, quorumHash, dummyHash);
+    if (pqc == nullptr) {
+        return std::nullopt;
+    }
+    qcHash = ::SerializeHash(*pqc);
+
+    LOCK(minableCommitmentsCs);
+    mapMinedCommitmentHashCache[llmqType].insert(quorumHash, qcHash);
+
+    return qcHash;
+}
+
+bool CQuorumBlockProcessor::LoadMinedCommitments()
+{
+    decltype(mapMinedByHeight) loaded;
+    size_t count{0};
+    {
+        LOCK2(cs_main, m_evoDb.cs);
+        auto dbIt = m_evoDb.GetCurTransaction().NewIteratorUniquePtr();
+
+        auto addEntry = [&](Consensus::LLMQType llmqType, int quorumIndex, uint32_t nInversedHeight, int quorumHeight) {
+            const int nMinedHeight = std::numeric_limits<uint32_t>::max() - be32toh(nInversedHeight);
+            // the mined blocks are on the chain evodb was written for
+            const CBlockIndex* pMinedBlockIndex = m_chainstate.m_chain[nMinedHeight];
+            if (pMinedBlockIndex == nullptr || quorumHeight < 0 || quorumHeight > nMinedHeight) {
+                return false;
+            }
+            loaded[{llmqType, quorumIndex}].emplace(nMinedHeight, MinedCommitmentEntry{pMinedBlockIndex, quorumHeight});
+            ++count;
+            return true;
+        };
+
+        dbIt->Seek(std::make_tuple(DB_MINED_COMMITMENT_BY_INVERSED_HEIGHT, Consensus::LLMQType{0}, uint32_t{0}));
+        for (; dbIt->Valid(); dbIt->Next()) {
+            std::tuple<std::string, Consensus::LLMQType, uint32_t> curKey;
+            int quorumHeight;
+            if (!dbIt->GetKey(curKey) || std::get<0>(curKey) != DB_MINED_COMMITMENT_BY_INVERSED_HEIGHT) {
+                break;
+            }
+            if (!dbIt->GetValue(quorumHeight) || !addEntry(std::get<1>(curKey), -1, std::get<2>(curKey), quorumHeight)) {
+                LogPrintf("CQuorumBlockProcessor::%s -- mined commitments don't match the chain, reading them from evodb\n", __func__);
+                return false;
+            }
+        }
+
+        dbIt->Seek(std::make_tuple(DB_MINED_COMMITMENT_BY_INVERSED_HEIGHT_Q_INDEXED, Consensus::LLMQType{0}, 0, uint32_t{0}));
+        for (; dbIt->Valid(); dbIt->Next()) {
+            std::tuple<std::string, Consensus::LLMQType, int, uint32_t> curKey;
+            int quorumHeight;
+            if (!dbIt->GetKey(curKey) || std::get<0>(curKey) != DB_MINED_COMMITMENT_BY_INVERSED_HEIGHT_Q_INDEXED) {
+                break;
+            }
+            if (!dbIt->GetValue(quorumHeight) || !addEntry(std::get<1>(curKey), std::get<2>(curKey), std::get<3>(curKey), quorumHeight)) {
+                LogPrintf("CQuorumBlockProcessor::%s -- mined commitments don't match the chain, reading them from evodb\n", __func__);
+                return false;
+            }
+        }
+    }
+
+    LOCK(cs_mined_by_height);
+    mapMinedByHeight = std::move(loaded);
+    fMinedByHeightLoaded = true;
+    LogPrintf("CQuorumBlockProcessor::%s -- loaded %d mined commitments\n", __func__, count);
+    return true;
+}
+
+std::optional<std::vector<const CBlockIndex*>> CQuorumBlockProcessor::GetMinedByHeight(Consensus::LLMQType llmqType, int quorumIndex, gsl::not_null<const CBlockIndex*> pindex, size_t skip, size_t maxCount) const
+{
+    LOCK(cs_mined_by_height);
+    if (!fMinedByHeightLoaded) {
+        return std::nullopt;
+    }
+
+    std::vector<const CBlockIndex*> ret;
+    const auto it = mapMinedByHeight.find({llmqType, quorumIndex});
+    if (it == mapMinedByHeight.end()) {
+        return ret;
+    }
+    for (auto jt = it->second.lower_bound(pindex->nHeight); jt != it->second.end() && ret.size() < maxCount; ++jt) {
+        const auto& entry = jt->second;
+        if (pindex->GetAncestor(entry.pMinedBlockIndex->nHeight) != entry.pMinedBlockIndex) {
+            continue;
+        }
+        if (skip > 0) {
+            --skip;
+            continue;
+        }
+        const auto* pQuorumBaseBlockIndex = pindex->GetAncestor(entry.quorumHeight);
+        assert(pQuorumBaseBlockIndex);
+        ret.emplace_back(pQuorumBaseBlockIndex);
+    }
+    return ret;
+}
+
 // The returned quorums are in reversed order, so the most recent one is at index 0
 std::vector<const CBlockIndex*> CQuorumBlockProcessor::GetMinedCommitmentsUntilBlock(Consensus::LLMQType llmqType, gsl::not_null<const CBlockIndex*> pindex, size_t maxCount) const
 {
+    if (auto ret = GetMinedByHeight(llmqType, -1, pindex, 0, maxCount)) {
+        return *ret;
+    }
+
     AssertLockNotHeld(m_evoDb.cs);
     LOCK(m_evoDb.cs);
 
@@ -527,6 +682,10 @@ std::vector<const CBlockIndex*> CQuorumBlockProcessor::GetMinedCommitmentsUntilB
 
 std::optional<const CBlockIndex*> CQuorumBlockProcessor::GetLastMinedCommitmentsByQuorumIndexUntilBlock(Consensus::LLMQType llmqType, const CBlockIndex* pindex, int quorumIndex, size_t cycle) const
 {
+    if (auto ret = GetMinedByHeight(llmqType, quorumIndex, pindex, cycle, 1)) {
+        return ret->empty() ? std::nullopt : std::make_optional(ret->front());
+    }
+
     AssertLockNotHeld(m_evoDb.cs);
     LOCK(m_evoDb.cs);
 
@@ -45,10 +45,27 @@ private:
     std::map<uint256, CFinalCommitment> minableCommitments GUARDED_BY(minableCommitmentsCs);
 
     mutable std::map<Consensus::LLMQType, unordered_lru_cache<uint256, bool, StaticSaltedHasher>> mapHasMinedCommitmentCache GUARDED_BY(minableCommitmentsCs);
+    // hashes of mined commitments by quorum hash, the active set is hashed again for the cbtx of every block
+    mutable std::map<Consensus::LLMQType, unordered_lru_cache<uint256, uint256, StaticSaltedHasher>> mapMinedCommitmentHashCache GUARDED_BY(minableCommitmentsCs);
+
+    struct MinedCommitmentEntry {
+        const CBlockIndex* pMinedBlockIndex;
+        int quorumHeight;
+    };
+    // The mined height -> quorum height indexes of evodb, by llmq type and quorum index (-1 without rotation),
+    // most recent first. Entries are never removed, they are checked to be on the chain of the block asked for
+    // instead, so a disconnected block or a rolled back evodb transaction leaves nothing wrong behind.
+    mutable Mutex cs_mined_by_height;
+    std::map<std::pair<Consensus::LLMQType, int>, std::multimap<int, MinedCommitmentEntry, std::greater<int>>> mapMinedByHeight GUARDED_BY(cs_mined_by_height);
+    // until the indexes are loaded they are read from evodb
+    bool fMinedByHeightLoaded GUARDED_BY(cs_mined_by_height){false};
 
 public:
     explicit CQuorumBlockProcessor(CChainState& chainstate, CConnman& _connman, CEvoDB& evoDb);
 
+    /** Load the mined commitment indexes into memory, the chain tip must match evodb */
+    bool LoadMinedCommitments() LOCKS_EXCLUDED(cs_mined_by_height);
+
     PeerMsgRet ProcessMessage(const CNode& peer, std::string_view msg_type, CDataStream& vRecv);
 
     bool ProcessBlock(const CBlock& block, gsl::not_null<const CBlockIndex*> pindex, BlockValidationState& state, bool fJustCheck, bool fBLSChecks) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
@@ -61,6 +78,7 @@ public:
     bool GetMineableCommitmentsTx(const Consensus::LLMQParams& llmqParams, int nHeight, std::vector<CTransactionRef>& ret) const EXCLUSIVE_LOCKS_REQUIRED(cs_main);
     bool HasMinedCommitment(Consensus::LLMQType llmqType, const uint256& quorumHash) const;
     CFinalCommitmentPtr GetMinedCommitment(Consensus::LLMQType llmqType, const uint256& quorumHash, uint256& retMinedBlockHash) const;
+    std::optional<uint256> GetMinedCommitmentHash(Consensus::LLMQType llmqType, const uint256& quorumHash) const;
 
     std::vector<const CBlockIndex*> GetMinedCommitmentsUntilBlock(Consensus::LLMQType llmqType, gsl::not_null<const CBlockIndex*> pindex, size_t maxCount) const;
     std::map<Consensus::LLMQType, std::vector<const CBlockIndex*>> GetMinedAndActiveCommitmentsUntilBlock(gsl::not_null<const CBlockIndex*> pindex) const;
@@ -68,9 +86,14 @@ public:
     std::vector<const CBlockIndex*> GetMinedCommitmentsIndexedUntilBlock(Consensus::LLMQType llmqType, const CBlockIndex* pindex, size_t maxCount) const;
     std::vector<std::pair<int, const CBlockIndex*>> GetLastMinedCommitmentsPerQuorumIndexUntilBlock(Consensus::LLMQType llmqType, const CBlockIndex* pindex, size_t cycle) const;
     std::optional<const CBlockIndex*> GetLastMinedCommitmentsByQuorumIndexUntilBlock(Consensus::LLMQType llmqType, const CBlockIndex* pindex, int quorumIndex, size_t cycle) const;
+
+    /** Verify and store a commitment mined in a block which isn't on disk, e.g. before the base of a UTXO snapshot */
+    bool ImportMinedCommitment(const CFinalCommitment& qc, gsl::not_null<const CBlockIndex*> pMinedBlockIndex);
 private:
     static bool GetCommitmentsFromBlock(const CBlock& block, gsl::not_null<const CBlockIndex*> pindex, std::multimap<Consensus::LLMQType, CFinalCommitment>& ret, BlockValidationState& state) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
-    bool ProcessCommitment(int nHeight, const uint256& blockHash, const CFinalCommitment& qc, BlockValidationState& state, bool fJustCheck, bool fBLSChecks) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+    bool ProcessCommitment(gsl::not_null<const CBlockIndex*> pindex, const CFinalCommitment& qc, BlockValidationState& state, bool fJustCheck, bool fBLSChecks) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+    void WriteMinedCommitment(const Consensus::LLMQParams& llmq_params, gsl::not_null<const CBlockIndex*> pMinedBlockIndex, const CFinalCommitment& qc, gsl::not_null<const CBlockIndex*> pQuorumBaseBlockIndex);
+    std::optional<std::vector<const CBlockIndex*>> GetMinedByHeight(Consensus::LLMQType llmqType, int quorumIndex, gsl::not_null<const CBlockIndex*> pindex, size_t skip, size_t maxCount) const LOCKS_EXCLUDED(cs_mined_by_height);
     static bool IsMiningPhase(const Consensus::LLMQParams& llmqParams, int nHeight) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
     size_t GetNumCommitmentsRequired(const Consensus::LLMQParams& llmqParams, int nHeight) const EXCLUSIVE_LOCKS_REQUIRED(cs_main);
     static uint256 GetQuorumBlockHash(const Consensus::LLMQParams& llmqParams, int nHeight, int quorumIndex) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
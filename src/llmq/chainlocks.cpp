@@ -55,7 +55,7 @@ void CChainLocksHandler::Start()
         EnforceBestChainLock();
         // regularly retry signing the current chaintip as it might have failed before due to missing islocks
         TrySignChainTip();
-    }, std::chrono::seconds{5});
+    }, std::chrono::seconds{5}, "chainlocks");
 }
 
 void CChainLocksHandler::Stop()
@@ -305,13 +305,20 @@ void CChainLocksHandler::TrySignChainTip()
                 break;
             }
 
-            auto txids = GetBlockTxs(pindexWalk->GetBlockHash());
-            if (!txids) {
+            // only TXs which were not known to be safe on the last attempt need to be checked again
+            auto unsafeTxids = GetUnsafeBlockTxs(pindexWalk->GetBlockHash());
+            if (!unsafeTxids) {
                 pindexWalk = pindexWalk->pprev;
                 continue;
             }
 
-            for (const auto& txid : *txids) {
+            std::vector<uint256> txidsToCheck;
+            {
+                LOCK(cs);
+                txidsToCheck.assign(unsafeTxids->begin(), unsafeTxids->end());
+            }
+
+            for (const auto& txid : txidsToCheck) {
                 int64_t txAge = 0;
                 {
                     LOCK(cs);
@@ -326,6 +333,10 @@ void CChainLocksHandler::TrySignChainTip()
                               pindexWalk->GetBlockHash().ToString(), txid.ToString(), txAge);
                     return;
                 }
+
+                // a TX never becomes unsafe again once it is islocked or old enough
+                LOCK(cs);
+                unsafeTxids->erase(txid);
             }
 
             pindexWalk = pindexWalk->pprev;
@@ -367,7 +378,24 @@ void CChainLocksHandler::BlockConnected(const std::shared_ptr<const CBlock>& pbl
 
     // We listen for BlockConnected so that we can collect all TX ids of all included TXs of newly received blocks
     // We need this information later when we try to sign a new tip, so that we can determine if all included TXs are
-    // safe.
+    // safe. TXs which are already islocked are left out of the unsafe set right away, so that usually nothing is left
+    // to check when the block becomes the tip.
+
+    std::vector<uint256> lockableTxids;
+    lockableTxids.reserve(pblock->vtx.size());
+    for (const auto& tx : pblock->vtx) {
+        if (tx->IsCoinBase() || tx->vin.empty()) {
+            continue;
+        }
+        lockableTxids.emplace_back(tx->GetHash());
+    }
+
+    std::vector<bool> isLocked(lockableTxids.size(), false);
+    if (quorumInstantSendManager) {
+        for (size_t i = 0; i < lockableTxids.size(); i++) {
+            isLocked[i] = quorumInstantSendManager->IsLocked(lockableTxids[i]);
+        }
+    }
 
     LOCK(cs);
 
@@ -379,23 +407,29 @@ void CChainLocksHandler::BlockConnected(const std::shared_ptr<const CBlock>& pbl
     }
     auto& txids = *it->second;
 
+    auto itUnsafe = blockUnsafeTxs.find(pindex->GetBlockHash());
+    if (itUnsafe == blockUnsafeTxs.end()) {
+        itUnsafe = blockUnsafeTxs.emplace(pindex->GetBlockHash(), std::make_shared<std::unordered_set<uint256, StaticSaltedHasher>>()).first;
+    }
+    auto& unsafeTxids = *itUnsafe->second;
+
     int64_t curTime = GetTime<std::chrono::seconds>().count();
 
-    for (const auto& tx : pblock->vtx) {
-        if (tx->IsCoinBase() || tx->vin.empty()) {
-            continue;
+    for (size_t i = 0; i < lockableTxids.size(); i++) {
+        const auto& txid = lockableTxids[i];
+        txids.emplace(txid);
+        auto itSeen = txFirstSeenTime.emplace(txid, curTime).first;
+        if (!isLocked[i] && curTime - itSeen->second < WAIT_FOR_ISLOCK_TIMEOUT) {
+            unsafeTxids.emplace(txid);
         }
-
-        txids.emplace(tx->GetHash());
-        txFirstSeenTime.emplace(tx->GetHash(), curTime);
     }
-
 }
 
 void CChainLocksHandler::BlockDisconnected(const std::shared_ptr<const CBlock>& pblock, gsl::not_null<const CBlockIndex*> pindexDisconnected)
 {
     LOCK(cs);
     blockTxs.erase(pindexDisconnected->GetBlockHash());
+    blockUnsafeTxs.erase(pindexDisconnected->GetBlockHash());
 }
 
 CChainLocksHandler::BlockTxs::mapped_type CChainLocksHandler::GetBlockTxs(const uint256& blockHash)
@@ -447,6 +481,29 @@ CChainLocksHandler::BlockTxs::mapped_type CChainLocksHandler::GetBlockTxs(const
     return ret;
 }
 
+CChainLocksHandler::BlockTxs::mapped_type CChainLocksHandler::GetUnsafeBlockTxs(const uint256& blockHash)
+{
+    AssertLockNotHeld(cs);
+    AssertLockNotHeld(cs_main);
+
+    {
+        LOCK(cs);
+        auto it = blockUnsafeTxs.find(blockHash);
+        if (it != blockUnsafeTxs.end()) {
+            return it->second;
+        }
+    }
+
+    // Not connected while we were running, start out with all TXs of the block being unsafe
+    auto txids = GetBlockTxs(blockHash);
+    if (!txids) {
+        return nullptr;
+    }
+
+    LOCK(cs);
+    return blockUnsafeTxs.emplace(blockHash, std::make_shared<std::unordered_set<uint256, StaticSaltedHasher>>(*txids)).first->second;
+}
+
 bool CChainLocksHandler::IsTxSafeForMining(const uint256& txid) const
 {
     int64_t txAge = 0;
@@ -646,6 +703,13 @@ void CChainLocksHandler::Cleanup()
             ++it;
         }
     }
+    for (auto it = blockUnsafeTxs.begin(); it != blockUnsafeTxs.end(); ) {
+        if (blockTxs.count(it->first) == 0) {
+            it = blockUnsafeTxs.erase(it);
+        } else {
+            ++it;
+        }
+    }
     for (auto it = txFirstSeenTime.begin(); it != txFirstSeenTime.end(); ) {
         uint256 hashBlock;
         CTransactionRef tx = GetTransaction(/* block_index */ nullptr, &mempool, it->first, Params().GetConsensus(), hashBlock);
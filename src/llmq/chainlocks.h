@@ -78,6 +78,9 @@ private:
     };
     using BlockTxs = std::unordered_map<uint256, std::shared_ptr<std::unordered_set<uint256, StaticSaltedHasher>>, BlockHasher>;
     BlockTxs blockTxs GUARDED_BY(cs);
+    // The subset of blockTxs which was neither islocked nor old enough the last time we looked. A TX never becomes
+    // unsafe again, so only these have to be checked again when trying to sign a new tip.
+    BlockTxs blockUnsafeTxs GUARDED_BY(cs);
     std::unordered_map<uint256, int64_t, StaticSaltedHasher> txFirstSeenTime GUARDED_BY(cs);
 
     std::map<uint256, int64_t> seenChainLocks GUARDED_BY(cs);
@@ -122,6 +125,7 @@ private:
     bool InternalHasConflictingChainLock(int nHeight, const uint256& blockHash) const EXCLUSIVE_LOCKS_REQUIRED(cs);
 
     BlockTxs::mapped_type GetBlockTxs(const uint256& blockHash) LOCKS_EXCLUDED(cs);
+    BlockTxs::mapped_type GetUnsafeBlockTxs(const uint256& blockHash) LOCKS_EXCLUDED(cs);
 
     void Cleanup() LOCKS_EXCLUDED(cs);
 };
@@ -18,7 +18,7 @@ namespace llmq {
         return blockHash;
     }
     const CBLSSignature& CChainLockSig::getSig() const {
-        return sig;
+        return sig.Get();
     }
     bool CChainLockSig::IsNull() const
     {
@@ -19,14 +19,16 @@ class CChainLockSig
 private:
     int32_t nHeight{-1};
     uint256 blockHash;
-    CBLSSignature sig;
+    // Only decompressed when verified, the many CLSIGs we already know are dropped before that
+    CBLSLazySignature sig;
 
 public:
-    CChainLockSig(int32_t nHeight, const uint256& blockHash, const CBLSSignature& sig) :
+    CChainLockSig(int32_t nHeight, const uint256& blockHash, const CBLSSignature& _sig) :
         nHeight(nHeight),
-        blockHash(blockHash),
-        sig(sig)
-    {}
+        blockHash(blockHash)
+    {
+        sig.Set(_sig, bls::bls_legacy_scheme.load());
+    }
     CChainLockSig() = default;
 
 
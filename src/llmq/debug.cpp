@@ -13,6 +13,8 @@
 #include <util/irange.h>
 #include <util/underlying.h>
 
+#include <cassert>
+
 namespace llmq
 {
 UniValue CDKGDebugSessionStatus::ToJson(int quorumIndex, int detailLevel) const
@@ -134,10 +136,34 @@ UniValue CDKGDebugStatus::ToJson(int detailLevel) const
     return ret;
 }
 
-void CDKGDebugManager::GetLocalDebugStatus(llmq::CDKGDebugStatus& ret) const
+std::shared_ptr<const CDKGDebugStatus> CDKGDebugManager::GetLocalDebugStatus() const
 {
     LOCK(cs);
-    ret = localStatus;
+    if (!localStatusSnapshot) {
+        localStatusSnapshot = std::make_shared<const CDKGDebugStatus>(localStatus);
+    }
+    return localStatusSnapshot;
+}
+
+UniValue CDKGDebugManager::GetLocalDebugStatusJson(int detailLevel) const
+{
+    assert(detailLevel >= 0 && detailLevel < int(localStatusJson.size()));
+    auto status = GetLocalDebugStatus();
+
+    LOCK(cs_json);
+    auto& [jsonStatus, json] = localStatusJson[detailLevel];
+    if (jsonStatus != status) {
+        json = status->ToJson(detailLevel);
+        jsonStatus = std::move(status);
+    }
+    return json;
+}
+
+void CDKGDebugManager::LocalStatusChanged()
+{
+    AssertLockHeld(cs);
+    localStatus.nTime = GetAdjustedTime();
+    localStatusSnapshot.reset();
 }
 
 void CDKGDebugManager::ResetLocalSessionStatus(Consensus::LLMQType llmqType, int quorumIndex)
@@ -150,7 +176,7 @@ void CDKGDebugManager::ResetLocalSessionStatus(Consensus::LLMQType llmqType, int
     }
 
     localStatus.sessions.erase(it);
-    localStatus.nTime = GetAdjustedTime();
+    LocalStatusChanged();
 }
 
 void CDKGDebugManager::InitLocalSessionStatus(const Consensus::LLMQParams& llmqParams, int quorumIndex, const uint256& quorumHash, int quorumHeight)
@@ -170,6 +196,8 @@ void CDKGDebugManager::InitLocalSessionStatus(const Consensus::LLMQParams& llmqP
     session.statusBitset = 0;
     session.members.clear();
     session.members.resize((size_t)llmqParams.size);
+    // readers must not see the previous session anymore, the time is left as it was
+    localStatusSnapshot.reset();
 }
 
 void CDKGDebugManager::UpdateLocalSessionStatus(Consensus::LLMQType llmqType, int quorumIndex, std::function<bool(CDKGDebugSessionStatus& status)>&& func)
@@ -182,7 +210,7 @@ void CDKGDebugManager::UpdateLocalSessionStatus(Consensus::LLMQType llmqType, in
     }
 
     if (func(it->second)) {
-        localStatus.nTime = GetAdjustedTime();
+        LocalStatusChanged();
     }
 }
 
@@ -195,8 +223,12 @@ void CDKGDebugManager::UpdateLocalMemberStatus(Consensus::LLMQType llmqType, int
         return;
     }
 
-    if (func(it->second.members.at(memberIdx))) {
-        localStatus.nTime = GetAdjustedTime();
+    auto& member = it->second.members.at(memberIdx);
+    const uint8_t prevBitset = member.statusBitset;
+    const size_t prevComplaints = member.complaintsFromMembers.size();
+    // duplicate messages set bits which are already set, that's no change for readers
+    if (func(member) && (member.statusBitset != prevBitset || member.complaintsFromMembers.size() != prevComplaints)) {
+        LocalStatusChanged();
     }
 }
 
@@ -9,7 +9,9 @@
 #include <sync.h>
 #include <univalue.h>
 
+#include <array>
 #include <functional>
+#include <memory>
 #include <set>
 
 class CDataStream;
@@ -92,19 +94,29 @@ public:
 class CDKGDebugManager
 {
 private:
-    mutable RecursiveMutex cs;
+    mutable Mutex cs;
     CDKGDebugStatus localStatus GUARDED_BY(cs);
+    /// copy of localStatus handed out to readers, it's made again after localStatus changed
+    mutable std::shared_ptr<const CDKGDebugStatus> localStatusSnapshot GUARDED_BY(cs);
+
+    /// the JSON of a snapshot per detail level, rendered without holding cs so DKG updates don't wait for RPC
+    mutable Mutex cs_json;
+    mutable std::array<std::pair<std::shared_ptr<const CDKGDebugStatus>, UniValue>, 3> localStatusJson GUARDED_BY(cs_json);
 
 public:
     CDKGDebugManager();
 
-    void GetLocalDebugStatus(CDKGDebugStatus& ret) const;
+    std::shared_ptr<const CDKGDebugStatus> GetLocalDebugStatus() const LOCKS_EXCLUDED(cs);
+    UniValue GetLocalDebugStatusJson(int detailLevel) const LOCKS_EXCLUDED(cs, cs_json);
+
+    void ResetLocalSessionStatus(Consensus::LLMQType llmqType, int quorumIndex) LOCKS_EXCLUDED(cs);
+    void InitLocalSessionStatus(const Consensus::LLMQParams& llmqParams, int quorumIndex, const uint256& quorumHash, int quorumHeight) LOCKS_EXCLUDED(cs);
 
-    void ResetLocalSessionStatus(Consensus::LLMQType llmqType, int quorumIndex);
-    void InitLocalSessionStatus(const Consensus::LLMQParams& llmqParams, int quorumIndex, const uint256& quorumHash, int quorumHeight);
+    void UpdateLocalSessionStatus(Consensus::LLMQType llmqType, int quorumIndex, std::function<bool(CDKGDebugSessionStatus& status)>&& func) LOCKS_EXCLUDED(cs);
+    void UpdateLocalMemberStatus(Consensus::LLMQType llmqType, int quorumIndex, size_t memberIdx, std::function<bool(CDKGDebugMemberStatus& status)>&& func) LOCKS_EXCLUDED(cs);
 
-    void UpdateLocalSessionStatus(Consensus::LLMQType llmqType, int quorumIndex, std::function<bool(CDKGDebugSessionStatus& status)>&& func);
-    void UpdateLocalMemberStatus(Consensus::LLMQType llmqType, int quorumIndex, size_t memberIdx, std::function<bool(CDKGDebugMemberStatus& status)>&& func);
+private:
+    void LocalStatusChanged() EXCLUSIVE_LOCKS_REQUIRED(cs);
 };
 
 } // namespace llmq
@@ -182,17 +182,26 @@ void CDKGSession::SendContributions(CDKGPendingMessages& pendingMessages)
     qc.contributions = std::make_shared<CBLSIESMultiRecipientObjects<CBLSSecretKey>>();
     qc.contributions->InitEncrypt(members.size());
 
+    std::vector<CBLSSecretKey> skContribs(m_sk_contributions);
+    std::vector<CBLSPublicKey> recipients;
+    recipients.reserve(members.size());
     for (const auto i : irange::range(members.size())) {
         const auto& m = members[i];
-        CBLSSecretKey skContrib = m_sk_contributions[i];
-
         if (i != myIdx && ShouldSimulateError(DKGError::type::CONTRIBUTION_LIE)) {
             logger.Batch("lying for %s", m->dmn->proTxHash.ToString());
-            skContrib.MakeNewKey();
+            skContribs[i].MakeNewKey();
         }
+        recipients.emplace_back(m->dmn->pdmnState->pubKeyOperator.Get());
+    }
 
-        if (!qc.contributions->Encrypt(i, m->dmn->pdmnState->pubKeyOperator.Get(), skContrib, PROTOCOL_VERSION)) {
-            logger.Batch("failed to encrypt contribution for %s", m->dmn->proTxHash.ToString());
+    // Every recipient costs a DH key exchange, which only touches its own blob
+    std::vector<uint8_t> encrypted(members.size());
+    blsWorker.RunParallel(members.size(), [&](size_t i) {
+        encrypted[i] = qc.contributions->Encrypt(i, recipients[i], skContribs[i], PROTOCOL_VERSION);
+    });
+    for (const auto i : irange::range(members.size())) {
+        if (!encrypted[i]) {
+            logger.Batch("failed to encrypt contribution for %s", members[i]->dmn->proTxHash.ToString());
             return;
         }
     }
@@ -335,76 +344,103 @@ void CDKGSession::ReceiveMessage(const CDKGContribution& qc, bool& retBan)
 
     logger.Batch("decrypted our contribution share. time=%d", t2.count());
 
-    bool verifyPending = false;
     receivedSkContributions[member->idx] = skContribution;
     vecEncryptedContributions[member->idx] = qc.contributions;
     pendingContributionVerifications.emplace_back(member->idx);
     if (pendingContributionVerifications.size() >= 32) {
-        verifyPending = true;
+        StartPendingContributionVerification();
     }
 
-    if (verifyPending) {
-        VerifyPendingContributions();
-    }
+    // pick up whatever the BLS worker finished in the meantime, without waiting for the rest
+    ProcessContributionVerifications(false);
 }
 
-// Verifies all pending secret key contributions in one batch
+// Starts verifying all pending secret key contributions in one batch on the BLS worker
 // This is done by aggregating the verification vectors belonging to the secret key contributions
 // The resulting aggregated vvec is then used to recover a public key share
 // The public key share must match the public key belonging to the aggregated secret key contributions
 // See CBLSWorker::VerifyContributionShares for more details.
-void CDKGSession::VerifyPendingContributions()
+void CDKGSession::StartPendingContributionVerification()
 {
     AssertLockHeld(cs_pending);
 
-    CDKGLogger logger(*this, __func__);
-
-    cxxtimer::Timer t1(true);
-
     std::vector<size_t> pend = std::move(pendingContributionVerifications);
     if (pend.empty()) {
         return;
     }
 
-    std::vector<size_t> memberIndexes;
-    std::vector<BLSVerificationVectorPtr> vvecs;
-    std::vector<CBLSSecretKey> skContributions;
+    auto batch = std::make_shared<ContributionVerificationBatch>();
+    batch->nStartTime = GetTimeMillis();
 
     for (const auto& idx : pend) {
         const auto& m = members[idx];
         if (m->bad || m->weComplain) {
             continue;
         }
-        memberIndexes.emplace_back(idx);
-        vvecs.emplace_back(receivedVvecs[idx]);
-        skContributions.emplace_back(receivedSkContributions[idx]);
+        batch->memberIndexes.emplace_back(idx);
+        batch->vvecs.emplace_back(receivedVvecs[idx]);
+        batch->skContributions.emplace_back(receivedSkContributions[idx]);
         // Write here to definitely store one contribution for each member no matter if
         // our share is valid or not, could be that others are still correct
         dkgManager.WriteEncryptedContributions(params.type, m_quorum_base_block_index, m->dmn->proTxHash, *vecEncryptedContributions[idx]);
     }
-
-    auto result = blsWorker.VerifyContributionShares(myId, vvecs, skContributions);
-    if (result.size() != memberIndexes.size()) {
-        logger.Batch("VerifyContributionShares returned result of size %d but size %d was expected, something is wrong", result.size(), memberIndexes.size());
+    if (batch->memberIndexes.empty()) {
         return;
     }
 
-    for (const auto i : irange::range(memberIndexes.size())) {
-        if (!result[i]) {
-            const auto& m = members[memberIndexes[i]];
-            logger.Batch("invalid contribution from %s. will complain later", m->dmn->proTxHash.ToString());
-            m->weComplain = true;
-            dkgDebugManager.UpdateLocalMemberStatus(params.type, quorumIndex, m->idx, [&](CDKGDebugMemberStatus& status) {
-                status.statusBits.weComplain = true;
-                return true;
-            });
-        } else {
-            size_t memberIdx = memberIndexes[i];
-            dkgManager.WriteVerifiedSkContribution(params.type, m_quorum_base_block_index, members[memberIdx]->dmn->proTxHash, skContributions[i]);
+    blsWorker.AsyncVerifyContributionShares(myId, batch->vvecs, batch->skContributions, true, true, [batch](const std::vector<bool>& result) {
+        batch->promise.set_value(result);
+    });
+    contributionVerificationsInFlight.emplace_back(std::move(batch));
+}
+
+// Handles the results of started batches in order. Unless wait is set, this stops at the first unfinished batch
+void CDKGSession::ProcessContributionVerifications(bool wait)
+{
+    AssertLockHeld(cs_pending);
+
+    CDKGLogger logger(*this, __func__);
+
+    while (!contributionVerificationsInFlight.empty()) {
+        const auto batch = contributionVerificationsInFlight.front();
+        if (!wait && batch->result.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            break;
+        }
+        contributionVerificationsInFlight.pop_front();
+
+        const auto result = batch->result.get();
+        const auto& memberIndexes = batch->memberIndexes;
+        if (result.size() != memberIndexes.size()) {
+            logger.Batch("VerifyContributionShares returned result of size %d but size %d was expected, something is wrong", result.size(), memberIndexes.size());
+            continue;
         }
+
+        for (const auto i : irange::range(memberIndexes.size())) {
+            if (!result[i]) {
+                const auto& m = members[memberIndexes[i]];
+                logger.Batch("invalid contribution from %s. will complain later", m->dmn->proTxHash.ToString());
+                m->weComplain = true;
+                dkgDebugManager.UpdateLocalMemberStatus(params.type, quorumIndex, m->idx, [&](CDKGDebugMemberStatus& status) {
+                    status.statusBits.weComplain = true;
+                    return true;
+                });
+            } else {
+                size_t memberIdx = memberIndexes[i];
+                dkgManager.WriteVerifiedSkContribution(params.type, m_quorum_base_block_index, members[memberIdx]->dmn->proTxHash, batch->skContributions[i]);
+            }
+        }
+
+        logger.Batch("verified %d pending contributions. time=%d", memberIndexes.size(), GetTimeMillis() - batch->nStartTime);
     }
+}
+
+// Verifies everything that is still pending or in flight and waits for the results
+void CDKGSession::VerifyPendingContributions()
+{
+    AssertLockHeld(cs_pending);
 
-    logger.Batch("verified %d pending contributions. time=%d", pend.size(), t1.count());
+    StartPendingContributionVerification();
+    ProcessContributionVerifications(true);
 }
 
 void CDKGSession::VerifyAndComplain(CDKGPendingMessages& pendingMessages)
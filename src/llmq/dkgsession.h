@@ -13,6 +13,7 @@
 #include <util/underlying.h>
 #include <sync.h>
 
+#include <deque>
 #include <optional>
 
 class UniValue;
@@ -304,8 +305,20 @@ private:
     std::map<uint256, CDKGJustification> justifications GUARDED_BY(invCs);
     std::map<uint256, CDKGPrematureCommitment> prematureCommitments GUARDED_BY(invCs);
 
+    // Contributions are verified in batches on the BLS worker while we keep receiving more of them
+    struct ContributionVerificationBatch {
+        std::vector<size_t> memberIndexes;
+        std::vector<BLSVerificationVectorPtr> vvecs;
+        std::vector<CBLSSecretKey> skContributions;
+        std::promise<std::vector<bool>> promise;
+        std::future<std::vector<bool>> result{promise.get_future()};
+        int64_t nStartTime;
+    };
+
     mutable RecursiveMutex cs_pending;
     std::vector<size_t> pendingContributionVerifications GUARDED_BY(cs_pending);
+    // in the order they were started, shared with the BLS worker as it reads the inputs until it is done
+    std::deque<std::shared_ptr<ContributionVerificationBatch>> contributionVerificationsInFlight GUARDED_BY(cs_pending);
 
     // filled by ReceivePrematureCommitment and used by FinalizeCommitments
     std::set<uint256> validCommitments GUARDED_BY(invCs);
@@ -336,6 +349,8 @@ public:
     void SendContributions(CDKGPendingMessages& pendingMessages);
     bool PreVerifyMessage(const CDKGContribution& qc, bool& retBan) const;
     void ReceiveMessage(const CDKGContribution& qc, bool& retBan);
+    void StartPendingContributionVerification() EXCLUSIVE_LOCKS_REQUIRED(cs_pending);
+    void ProcessContributionVerifications(bool wait) EXCLUSIVE_LOCKS_REQUIRED(cs_pending);
     void VerifyPendingContributions() EXCLUSIVE_LOCKS_REQUIRED(cs_pending);
 
     // Phase 2: complaint
@@ -19,6 +19,7 @@
 #include <net_processing.h>
 #include <validation.h>
 #include <util/thread.h>
+#include <util/trace.h>
 #include <util/underlying.h>
 
 namespace llmq
@@ -70,21 +71,44 @@ void CDKGPendingMessages::PushPendingMessage(NodeId from, PeerManager* peerman,
         EraseObjectRequest(from, CInv(invType, hash));
     }
 
-    LOCK(cs);
-
-    if (messagesPerNode[from] >= maxMessagesPerNode) {
-        // TODO ban?
-        LogPrint(BCLog::LLMQ_DKG, "CDKGPendingMessages::%s -- too many messages, peer=%d\n", __func__, from);
+    // All DKG messages start with the llmq type, the quorum hash and the proTxHash of the sender
+    uint8_t msgLlmqType;
+    uint256 msgQuorumHash;
+    uint256 msgProTxHash;
+    try {
+        SpanReader{SER_NETWORK, PROTOCOL_VERSION, MakeUCharSpan(*pm), 0} >> msgLlmqType >> msgQuorumHash >> msgProTxHash;
+    } catch (const std::ios_base::failure&) {
+        LogPrint(BCLog::LLMQ_DKG, "CDKGPendingMessages::%s -- message too short, peer=%d\n", __func__, from);
+        Misbehaving(from, 100);
         return;
     }
-    messagesPerNode[from]++;
 
-    if (!seenMessages.emplace(hash).second) {
-        LogPrint(BCLog::LLMQ_DKG, "CDKGPendingMessages::%s -- already seen %s, peer=%d\n", __func__, hash.ToString(), from);
-        return;
+    {
+        LOCK(cs);
+
+        if (seenMessages.count(hash) != 0) {
+            LogPrint(BCLog::LLMQ_DKG, "CDKGPendingMessages::%s -- already seen %s, peer=%d\n", __func__, hash.ToString(), from);
+            return;
+        }
+
+        // Same as PreVerifyMessage, messages for other quorums are dropped there without a penalty
+        const bool fNonMember = msgQuorumHash == quorumHash && quorumMembers.count(msgProTxHash) == 0;
+        if (!fNonMember) {
+            if (messagesPerNode[from] >= maxMessagesPerNode) {
+                // TODO ban?
+                LogPrint(BCLog::LLMQ_DKG, "CDKGPendingMessages::%s -- too many messages, peer=%d\n", __func__, from);
+                return;
+            }
+            messagesPerNode[from]++;
+            seenMessages.emplace(hash);
+            pendingMessages.emplace_back(std::make_pair(from, std::move(pm)));
+            return;
+        }
     }
 
-    pendingMessages.emplace_back(std::make_pair(from, std::move(pm)));
+    LogPrint(BCLog::LLMQ_DKG, "CDKGPendingMessages::%s -- sender %s not a member of quorum %s, peer=%d\n", __func__,
+             msgProTxHash.ToString(), msgQuorumHash.ToString(), from);
+    Misbehaving(from, 100);
 }
 
 std::list<CDKGPendingMessages::BinaryMessage> CDKGPendingMessages::PopPendingMessages(size_t maxCount)
@@ -120,6 +144,13 @@ void CDKGPendingMessages::Clear()
     seenMessages.clear();
 }
 
+void CDKGPendingMessages::SetQuorumMembers(const uint256& _quorumHash, std::set<uint256> _quorumMembers)
+{
+    LOCK(cs);
+    quorumHash = _quorumHash;
+    quorumMembers = std::move(_quorumMembers);
+}
+
 //////
 
 void CDKGSessionHandler::UpdatedBlockTip(const CBlockIndex* pindexNew)
@@ -147,6 +178,15 @@ void CDKGSessionHandler::UpdatedBlockTip(const CBlockIndex* pindexNew)
 
     LogPrint(BCLog::LLMQ_DKG, "CDKGSessionHandler::%s -- %s qi[%d] currentHeight=%d, pQuorumBaseBlockIndex->nHeight=%d, oldPhase=%d, newPhase=%d\n", __func__,
              params.name, quorumIndex, currentHeight, pQuorumBaseBlockIndex->nHeight, ToUnderlying(oldPhase), ToUnderlying(phase));
+    if (phase != oldPhase) {
+        TRACE6(llmq, dkg_phase_changed,
+            ToUnderlying(params.type),
+            quorumIndex,
+            quorumHash.data(),
+            currentHeight,
+            ToUnderlying(oldPhase),
+            ToUnderlying(phase));
+    }
 }
 
 void CDKGSessionHandler::ProcessMessage(const CNode& pfrom, gsl::not_null<PeerManager*> peerman, const std::string& msg_type, CDataStream& vRecv)
@@ -195,6 +235,14 @@ bool CDKGSessionHandler::InitNewQuorum(const CBlockIndex* pQuorumBaseBlockIndex)
         return false;
     }
 
+    std::set<uint256> memberHashes;
+    for (const auto& dmn : mns) {
+        memberHashes.emplace(dmn->proTxHash);
+    }
+    for (auto* pending : {&pendingContributions, &pendingComplaints, &pendingJustifications, &pendingPrematureCommitments}) {
+        pending->SetQuorumMembers(pQuorumBaseBlockIndex->GetBlockHash(), memberHashes);
+    }
+
     LogPrintf("CDKGSessionManager::%s -- height[%d] quorum initialization OK for %s qi[%d]\n", __func__, pQuorumBaseBlockIndex->nHeight, curSession->params.name, quorumIndex);
     return true;
 }
@@ -342,12 +390,22 @@ void CDKGSessionHandler::HandlePhase(QuorumPhase curPhase,
                                      const WhileWaitFunc& runWhileWaiting)
 {
     LogPrint(BCLog::LLMQ_DKG, "CDKGSessionManager::%s -- %s qi[%d] - starting, curPhase=%d, nextPhase=%d\n", __func__, params.name, quorumIndex, ToUnderlying(curPhase), ToUnderlying(nextPhase));
+    TRACE4(llmq, dkg_phase_start,
+        ToUnderlying(params.type),
+        quorumIndex,
+        expectedQuorumHash.data(),
+        ToUnderlying(curPhase));
 
     SleepBeforePhase(curPhase, expectedQuorumHash, randomSleepFactor, runWhileWaiting);
     startPhaseFunc();
     WaitForNextPhase(curPhase, nextPhase, expectedQuorumHash, runWhileWaiting);
 
     LogPrint(BCLog::LLMQ_DKG, "CDKGSessionManager::%s -- %s qi[%d] - done, curPhase=%d, nextPhase=%d\n", __func__, params.name, quorumIndex, ToUnderlying(curPhase), ToUnderlying(nextPhase));
+    TRACE4(llmq, dkg_phase_done,
+        ToUnderlying(params.type),
+        quorumIndex,
+        expectedQuorumHash.data(),
+        ToUnderlying(curPhase));
 }
 
 // returns a set of NodeIds which sent invalid messages
@@ -435,9 +493,9 @@ std::set<NodeId> BatchVerifyMessageSigs(CDKGSession& session, const std::vector<
 }
 
 template<typename Message, int MessageType>
-bool ProcessPendingMessageBatch(CDKGSession& session, CDKGPendingMessages& pendingMessages, size_t maxCount)
+bool ProcessPendingMessageBatch(CDKGSession& session, CDKGPendingMessages& pendingMessages, CBLSWorker& blsWorker, size_t maxCount)
 {
-    auto msgs = pendingMessages.PopAndDeserializeMessages<Message>(maxCount);
+    auto msgs = pendingMessages.PopAndDeserializeMessages<Message>(maxCount, blsWorker);
     if (msgs.empty()) {
         return false;
     }
@@ -538,7 +596,7 @@ void CDKGSessionHandler::HandleDKGRound()
         curSession->Contribute(pendingContributions);
     };
     auto fContributeWait = [this] {
-        return ProcessPendingMessageBatch<CDKGContribution, MSG_QUORUM_CONTRIB>(*curSession, pendingContributions, 8);
+        return ProcessPendingMessageBatch<CDKGContribution, MSG_QUORUM_CONTRIB>(*curSession, pendingContributions, blsWorker, 8);
     };
     HandlePhase(QuorumPhase::Contribute, QuorumPhase::Complain, curQuorumHash, 0.05, fContributeStart, fContributeWait);
 
@@ -547,7 +605,7 @@ void CDKGSessionHandler::HandleDKGRound()
         curSession->VerifyAndComplain(pendingComplaints);
     };
     auto fComplainWait = [this] {
-        return ProcessPendingMessageBatch<CDKGComplaint, MSG_QUORUM_COMPLAINT>(*curSession, pendingComplaints, 8);
+        return ProcessPendingMessageBatch<CDKGComplaint, MSG_QUORUM_COMPLAINT>(*curSession, pendingComplaints, blsWorker, 8);
     };
     HandlePhase(QuorumPhase::Complain, QuorumPhase::Justify, curQuorumHash, 0.05, fComplainStart, fComplainWait);
 
@@ -556,7 +614,7 @@ void CDKGSessionHandler::HandleDKGRound()
         curSession->VerifyAndJustify(pendingJustifications);
     };
     auto fJustifyWait = [this] {
-        return ProcessPendingMessageBatch<CDKGJustification, MSG_QUORUM_JUSTIFICATION>(*curSession, pendingJustifications, 8);
+        return ProcessPendingMessageBatch<CDKGJustification, MSG_QUORUM_JUSTIFICATION>(*curSession, pendingJustifications, blsWorker, 8);
     };
     HandlePhase(QuorumPhase::Justify, QuorumPhase::Commit, curQuorumHash, 0.05, fJustifyStart, fJustifyWait);
 
@@ -565,11 +623,16 @@ void CDKGSessionHandler::HandleDKGRound()
         curSession->VerifyAndCommit(pendingPrematureCommitments);
     };
     auto fCommitWait = [this] {
-        return ProcessPendingMessageBatch<CDKGPrematureCommitment, MSG_QUORUM_PREMATURE_COMMITMENT>(*curSession, pendingPrematureCommitments, 8);
+        return ProcessPendingMessageBatch<CDKGPrematureCommitment, MSG_QUORUM_PREMATURE_COMMITMENT>(*curSession, pendingPrematureCommitments, blsWorker, 8);
     };
     HandlePhase(QuorumPhase::Commit, QuorumPhase::Finalize, curQuorumHash, 0.1, fCommitStart, fCommitWait);
 
     auto finalCommitments = curSession->FinalizeCommitments();
+    TRACE4(llmq, dkg_finalized,
+        ToUnderlying(params.type),
+        quorumIndex,
+        curQuorumHash.data(),
+        finalCommitments.size());
     for (const auto& fqc : finalCommitments) {
         quorumBlockProcessor.AddMineableCommitment(fqc);
     }
@@ -587,6 +650,9 @@ void CDKGSessionHandler::PhaseHandlerThread()
                 return true;
             });
             LogPrint(BCLog::LLMQ_DKG, "CDKGSessionHandler::%s -- %s qi[%d] - aborted current DKG session\n", __func__, params.name, quorumIndex);
+            TRACE2(llmq, dkg_aborted,
+                ToUnderlying(params.type),
+                quorumIndex);
         }
     }
 }
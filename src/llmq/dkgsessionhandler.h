@@ -5,17 +5,20 @@
 #ifndef BITCOIN_LLMQ_DKGSESSIONHANDLER_H
 #define BITCOIN_LLMQ_DKGSESSIONHANDLER_H
 
+#include <bls/bls_worker.h>
 #include <ctpl_stl.h>
 #include <net.h>
+#include <saltedhasher.h>
 
 #include <gsl/pointers.h>
 
 #include <atomic>
 #include <map>
 #include <optional>
+#include <set>
+#include <unordered_set>
 
 class CBlockIndex;
-class CBLSWorker;
 class CChainState;
 class PeerManager;
 
@@ -43,6 +46,9 @@ enum class QuorumPhase {
  * handler thread.
  *
  * Each message type has it's own instance of this class.
+ *
+ * Duplicates and messages of senders which are not members of the current quorum are dropped on arrival. Only the
+ * header all DKG messages start with is read for this, the payload is deserialized later.
  */
 class CDKGPendingMessages
 {
@@ -50,13 +56,16 @@ public:
     using BinaryMessage = std::pair<NodeId, std::shared_ptr<CDataStream>>;
 
 private:
-    mutable RecursiveMutex cs;
+    mutable Mutex cs;
     std::atomic<PeerManager*> m_peerman{nullptr};
     const int invType;
     size_t maxMessagesPerNode GUARDED_BY(cs);
     std::list<BinaryMessage> pendingMessages GUARDED_BY(cs);
     std::map<NodeId, size_t> messagesPerNode GUARDED_BY(cs);
-    std::set<uint256> seenMessages GUARDED_BY(cs);
+    std::unordered_set<uint256, StaticSaltedHasher> seenMessages GUARDED_BY(cs);
+    // the quorum of the current session and its members, set once the session is initialized
+    uint256 quorumHash GUARDED_BY(cs);
+    std::set<uint256> quorumMembers GUARDED_BY(cs);
 
 public:
     explicit CDKGPendingMessages(size_t _maxMessagesPerNode, int _invType) :
@@ -67,6 +76,7 @@ public:
     bool HasSeen(const uint256& hash) const;
     void Misbehaving(NodeId from, int score);
     void Clear();
+    void SetQuorumMembers(const uint256& _quorumHash, std::set<uint256> _quorumMembers);
 
     template<typename Message>
     void PushPendingMessage(NodeId from, PeerManager* peerman, Message& msg)
@@ -77,8 +87,9 @@ public:
     }
 
     // Might return nullptr messages, which indicates that deserialization failed for some reason
+    // The messages are deserialized in parallel, the BLS keys and signatures they carry are slow to decode
     template<typename Message>
-    std::vector<std::pair<NodeId, std::shared_ptr<Message>>> PopAndDeserializeMessages(size_t maxCount)
+    std::vector<std::pair<NodeId, std::shared_ptr<Message>>> PopAndDeserializeMessages(size_t maxCount, CBLSWorker& blsWorker)
     {
         auto binaryMessages = PopPendingMessages(maxCount);
         if (binaryMessages.empty()) {
@@ -86,16 +97,22 @@ public:
         }
 
         std::vector<std::pair<NodeId, std::shared_ptr<Message>>> ret;
+        std::vector<CDataStream*> streams;
         ret.reserve(binaryMessages.size());
+        streams.reserve(binaryMessages.size());
         for (const auto& bm : binaryMessages) {
+            ret.emplace_back(bm.first, nullptr);
+            streams.push_back(bm.second.get());
+        }
+        blsWorker.RunParallel(streams.size(), [&](size_t i) {
             auto msg = std::make_shared<Message>();
             try {
-                *bm.second >> *msg;
+                *streams[i] >> *msg;
             } catch (...) {
-                msg = nullptr;
+                return;
             }
-            ret.emplace_back(std::make_pair(bm.first, std::move(msg)));
-        }
+            ret[i].second = std::move(msg);
+        });
 
         return ret;
     }
@@ -21,6 +21,7 @@
 #include <util/irange.h>
 #include <util/ranges.h>
 #include <util/thread.h>
+#include <util/trace.h>
 #include <validation.h>
 
 #include <cxxtimer.hpp>
@@ -40,6 +41,11 @@ static const std::string_view DB_ARCHIVED_BY_HASH = "is_a2";
 
 static const std::string_view DB_VERSION = "is_v";
 
+// Reasons passed to the instantsend:islock_removed tracepoint
+[[maybe_unused]] static constexpr int ISLOCK_REMOVED_CONFIRMED = 0;
+[[maybe_unused]] static constexpr int ISLOCK_REMOVED_CONFLICT = 1;
+[[maybe_unused]] static constexpr int ISLOCK_REMOVED_CHAINED = 2;
+
 std::unique_ptr<CInstantSendManager> quorumInstantSendManager;
 
 uint256 CInstantSendLock::GetRequestId() const
@@ -52,10 +58,90 @@ uint256 CInstantSendLock::GetRequestId() const
 
 ////////////////
 
+void CInstantSendOutpointIndex::Add(const COutPoint& outpoint, const Entry& entry)
+{
+    auto& shard = GetShard(outpoint);
+    LOCK(shard.cs);
+    auto it = shard.entries.find(outpoint);
+    if (it != shard.entries.end()) {
+        it->second = entry;
+        return;
+    }
+    if (m_size >= m_max_entries) {
+        if (m_complete.exchange(false)) {
+            LogPrintf("CInstantSendOutpointIndex::%s -- more than %d locked outpoints, falling back to the db\n", __func__, m_max_entries);
+        }
+        return;
+    }
+    shard.entries.emplace(outpoint, entry);
+    ++m_size;
+}
+
+void CInstantSendOutpointIndex::Add(const uint256& islockHash, const CInstantSendLock& islock)
+{
+    for (const auto& in : islock.inputs) {
+        Add(in, Entry{islockHash, islock.txid});
+    }
+}
+
+void CInstantSendOutpointIndex::Remove(const uint256& islockHash, const CInstantSendLock& islock)
+{
+    for (const auto& in : islock.inputs) {
+        auto& shard = GetShard(in);
+        LOCK(shard.cs);
+        auto it = shard.entries.find(in);
+        if (it != shard.entries.end() && it->second.islockHash == islockHash) {
+            shard.entries.erase(it);
+            --m_size;
+        }
+    }
+}
+
+std::optional<CInstantSendOutpointIndex::Entry> CInstantSendOutpointIndex::Get(const COutPoint& outpoint) const
+{
+    const auto& shard = GetShard(outpoint);
+    LOCK(shard.cs);
+    auto it = shard.entries.find(outpoint);
+    if (it == shard.entries.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+////////////////
+
 
 CInstantSendDb::CInstantSendDb(bool unitTests, bool fWipe) :
     db(std::make_unique<CDBWrapper>(unitTests ? "" : (GetDataDir() / "llmq/isdb"), 32 << 20, unitTests, fWipe))
 {
+    LOCK(cs_db);
+    LoadOutpointIndex();
+}
+
+void CInstantSendDb::LoadOutpointIndex()
+{
+    AssertLockHeld(cs_db);
+    cxxtimer::Timer timer(true);
+
+    auto it = std::unique_ptr<CDBIterator>(db->NewIterator());
+    auto firstKey = std::make_tuple(std::string{DB_ISLOCK_BY_HASH}, uint256());
+    it->Seek(firstKey);
+    decltype(firstKey) curKey;
+
+    CInstantSendLock islock;
+    while (it->Valid()) {
+        if (!it->GetKey(curKey) || std::get<0>(curKey) != DB_ISLOCK_BY_HASH) {
+            break;
+        }
+        if (it->GetValue(islock)) {
+            outpointIndex.Add(std::get<1>(curKey), islock);
+        }
+        it->Next();
+    }
+    outpointIndex.SetComplete(true);
+
+    LogPrint(BCLog::INSTANTSEND, "CInstantSendDb::%s -- loaded %d locked outpoints in %dms, complete=%d\n", __func__,
+             outpointIndex.size(), timer.count(), outpointIndex.IsComplete());
 }
 
 CInstantSendDb::~CInstantSendDb() = default;
@@ -87,6 +173,7 @@ void CInstantSendDb::Upgrade(const CTxMemPool& mempool)
                     batch.Erase(std::make_tuple(DB_HASH_BY_OUTPOINT, in));
                 }
                 batch.Erase(curKey);
+                outpointIndex.Remove(std::get<1>(curKey), islock);
             }
             it->Next();
         }
@@ -99,17 +186,52 @@ void CInstantSendDb::WriteNewInstantSendLock(const uint256& hash, const CInstant
 {
     LOCK(cs_db);
     CDBBatch batch(*db);
+    WriteNewInstantSendLock(batch, hash, islock);
+    db->WriteBatch(batch);
+
+    AddToCaches(hash, std::make_shared<CInstantSendLock>(islock));
+    outpointIndex.Add(hash, islock);
+}
+
+void CInstantSendDb::WriteNewInstantSendLocks(const std::vector<std::pair<uint256, CInstantSendLockPtr>>& islocks,
+                                              const std::vector<std::pair<uint256, int>>& mined)
+{
+    if (islocks.empty()) {
+        return;
+    }
+
+    LOCK(cs_db);
+    CDBBatch batch(*db);
+    for (const auto& [hash, islock] : islocks) {
+        WriteNewInstantSendLock(batch, hash, *islock);
+    }
+    for (const auto& [hash, nHeight] : mined) {
+        WriteInstantSendLockMined(batch, hash, nHeight);
+    }
+    db->WriteBatch(batch);
+
+    for (const auto& [hash, islock] : islocks) {
+        AddToCaches(hash, islock);
+        outpointIndex.Add(hash, *islock);
+    }
+}
+
+void CInstantSendDb::WriteNewInstantSendLock(CDBBatch& batch, const uint256& hash, const CInstantSendLock& islock)
+{
+    AssertLockHeld(cs_db);
     batch.Write(std::make_tuple(DB_ISLOCK_BY_HASH, hash), islock);
     batch.Write(std::make_tuple(DB_HASH_BY_TXID, islock.txid), hash);
     for (const auto& in : islock.inputs) {
         batch.Write(std::make_tuple(DB_HASH_BY_OUTPOINT, in), hash);
     }
-    db->WriteBatch(batch);
+}
 
-    auto p = std::make_shared<CInstantSendLock>(islock);
-    islockCache.insert(hash, p);
-    txidCache.insert(islock.txid, hash);
-    for (const auto& in : islock.inputs) {
+void CInstantSendDb::AddToCaches(const uint256& hash, const CInstantSendLockPtr& islock)
+{
+    AssertLockHeld(cs_db);
+    islockCache.insert(hash, islock);
+    txidCache.insert(islock->txid, hash);
+    for (const auto& in : islock->inputs) {
         outpointCache.insert(in, hash);
     }
 }
@@ -129,6 +251,7 @@ void CInstantSendDb::RemoveInstantSendLock(CDBBatch& batch, const uint256& hash,
     for (auto& in : islock->inputs) {
         batch.Erase(std::make_tuple(DB_HASH_BY_OUTPOINT, in));
     }
+    outpointIndex.Remove(hash, *islock);
 
     if (!keep_cache) {
         islockCache.erase(hash);
@@ -221,36 +344,68 @@ std::unordered_map<uint256, CInstantSendLockPtr, StaticSaltedHasher> CInstantSen
 
 void CInstantSendDb::RemoveArchivedInstantSendLocks(int nUntilHeight)
 {
-    LOCK(cs_db);
     if (nUntilHeight <= 0) {
         return;
     }
 
-    auto it = std::unique_ptr<CDBIterator>(db->NewIterator());
+    int nConfirmedUntilHeight{0};
+    {
+        LOCK(cs_db);
+        auto it = std::unique_ptr<CDBIterator>(db->NewIterator());
 
-    auto firstKey = BuildInversedISLockKey(DB_ARCHIVED_BY_HEIGHT_AND_HASH, nUntilHeight, uint256());
+        auto firstKey = BuildInversedISLockKey(DB_ARCHIVED_BY_HEIGHT_AND_HASH, nUntilHeight, uint256());
 
-    it->Seek(firstKey);
+        it->Seek(firstKey);
 
-    CDBBatch batch(*db);
-    while (it->Valid()) {
-        decltype(firstKey) curKey;
-        if (!it->GetKey(curKey) || std::get<0>(curKey) != DB_ARCHIVED_BY_HEIGHT_AND_HASH) {
-            break;
-        }
-        uint32_t nHeight = std::numeric_limits<uint32_t>::max() - be32toh(std::get<1>(curKey));
-        if (nHeight > uint32_t(nUntilHeight)) {
-            break;
+        CDBBatch batch(*db);
+        while (it->Valid()) {
+            decltype(firstKey) curKey;
+            if (!it->GetKey(curKey) || std::get<0>(curKey) != DB_ARCHIVED_BY_HEIGHT_AND_HASH) {
+                break;
+            }
+            uint32_t nHeight = std::numeric_limits<uint32_t>::max() - be32toh(std::get<1>(curKey));
+            if (nHeight > uint32_t(nUntilHeight)) {
+                break;
+            }
+
+            auto& islockHash = std::get<2>(curKey);
+            batch.Erase(std::make_tuple(DB_ARCHIVED_BY_HASH, islockHash));
+            batch.Erase(curKey);
+
+            it->Next();
         }
+        it.reset();
 
-        auto& islockHash = std::get<2>(curKey);
-        batch.Erase(std::make_tuple(DB_ARCHIVED_BY_HASH, islockHash));
-        batch.Erase(curKey);
+        db->WriteBatch(batch);
 
-        it->Next();
+        // LevelDB rarely compacts a database with as few writes as this one on its own, so without this the scans
+        // above skip over the tombstones of everything which was ever pruned
+        if (nUntilHeight - last_compaction_height < COMPACTION_INTERVAL) {
+            return;
+        }
+        last_compaction_height = nUntilHeight;
+        nConfirmedUntilHeight = best_confirmed_height;
     }
+    CompactPrunedRanges(nConfirmedUntilHeight, nUntilHeight);
+}
 
-    db->WriteBatch(batch);
+void CInstantSendDb::CompactPrunedRanges(int nConfirmedUntilHeight, int nArchivedUntilHeight)
+{
+    // db is only ever set by the constructor and LevelDB does its own locking, so the compactions, which
+    // can take a while, don't need to block everything else waiting for cs_db
+    CDBWrapper& dbw = *WITH_LOCK(cs_db, return db.get());
+    const uint256 maxHash = uint256S(std::string(64, 'f'));
+    int64_t nStart = GetTimeMillis();
+    // Higher heights come first in the height indexes, so the pruned part of each ends at height 0
+    dbw.CompactRange(BuildInversedISLockKey(DB_MINED_BY_HEIGHT_AND_HASH, nConfirmedUntilHeight, uint256()),
+                     BuildInversedISLockKey(DB_MINED_BY_HEIGHT_AND_HASH, 0, maxHash));
+    dbw.CompactRange(BuildInversedISLockKey(DB_ARCHIVED_BY_HEIGHT_AND_HASH, nArchivedUntilHeight, uint256()),
+                     BuildInversedISLockKey(DB_ARCHIVED_BY_HEIGHT_AND_HASH, 0, maxHash));
+    // Only the archive of the last 100 blocks is left in here, whatever else was in the range got deleted
+    dbw.CompactRange(std::make_tuple(std::string{DB_ARCHIVED_BY_HASH}, uint256()),
+                     std::make_tuple(std::string{DB_ARCHIVED_BY_HASH}, maxHash));
+    LogPrint(BCLog::INSTANTSEND, "CInstantSendDb::%s -- compacted pruned ranges up to height %d in %d ms\n", __func__,
+             nArchivedUntilHeight, GetTimeMillis() - nStart);
 }
 
 void CInstantSendDb::WriteBlockInstantSendLocks(const gsl::not_null<std::shared_ptr<const CBlock>>& pblock,
@@ -375,6 +530,25 @@ CInstantSendLockPtr CInstantSendDb::GetInstantSendLockByInput(const COutPoint& o
     return GetInstantSendLockByHashInternal(islockHash);
 }
 
+CInstantSendLockPtr CInstantSendDb::GetConflictingLockByInput(const COutPoint& outpoint, const uint256& txid) const
+{
+    if (const auto entry = outpointIndex.Get(outpoint)) {
+        if (entry->txid == txid) {
+            return nullptr;
+        }
+        return GetInstantSendLockByHash(entry->islockHash);
+    }
+    if (outpointIndex.IsComplete()) {
+        return nullptr;
+    }
+
+    auto islock = GetInstantSendLockByInput(outpoint);
+    if (islock == nullptr || islock->txid == txid) {
+        return nullptr;
+    }
+    return islock;
+}
+
 std::vector<uint256> CInstantSendDb::GetInstantSendLocksByParent(const uint256& parent) const
 {
     AssertLockHeld(cs_db);
@@ -744,6 +918,9 @@ void CInstantSendManager::HandleNewInstantSendLockRecoveredSig(const llmq::CReco
     if (WITH_LOCK(cs_pendingLocks, return pendingInstantSendLocks.count(hash)) || db.KnownInstantSendLock(hash)) {
         return;
     }
+    TRACE2(instantsend, islock_recovered,
+        hash.data(),
+        islock->txid.data());
     LOCK(cs_pendingLocks);
     pendingInstantSendLocks.emplace(hash, std::make_pair(-1, islock));
 }
@@ -795,6 +972,11 @@ PeerMsgRet CInstantSendManager::ProcessMessageInstantSendLock(const CNode& pfrom
 
     LogPrint(BCLog::INSTANTSEND, "CInstantSendManager::%s -- txid=%s, islock=%s: received islock, peer=%d\n", __func__,
             islock->txid.ToString(), hash.ToString(), pfrom.GetId());
+    TRACE4(instantsend, islock_received,
+        hash.data(),
+        islock->txid.data(),
+        islock->inputs.size(),
+        pfrom.GetId());
 
     LOCK(cs_pendingLocks);
     pendingInstantSendLocks.emplace(hash, std::make_pair(pfrom.GetId(), islock));
@@ -888,7 +1070,7 @@ bool CInstantSendManager::ProcessPendingInstantSendLocks()
 
 std::unordered_set<uint256, StaticSaltedHasher> CInstantSendManager::ProcessPendingInstantSendLocks(const Consensus::LLMQParams& llmq_params, int signOffset, const std::unordered_map<uint256, std::pair<NodeId, CInstantSendLockPtr>, StaticSaltedHasher>& pend, bool ban)
 {
-    CBLSBatchVerifier<NodeId, uint256> batchVerifier(false, true, 8);
+    CBLSBatchVerifier<NodeId, uint256> batchVerifier(true, true, 8);
     std::unordered_map<uint256, CRecoveredSig, StaticSaltedHasher> recSigs;
 
     size_t verifyCount = 0;
@@ -950,6 +1132,12 @@ std::unordered_set<uint256, StaticSaltedHasher> CInstantSendManager::ProcessPend
 
     LogPrint(BCLog::INSTANTSEND, "CInstantSendManager::%s -- verified locks. count=%d, alreadyVerified=%d, vt=%d, nodes=%d\n", __func__,
             verifyCount, alreadyVerified, verifyTimer.count(), batchVerifier.GetUniqueSourceCount());
+    TRACE5(instantsend, islocks_verified,
+        verifyCount,
+        alreadyVerified,
+        batchVerifier.badMessages.size(),
+        batchVerifier.badSources.size(),
+        verifyTimer.count<std::chrono::microseconds>());
 
     std::unordered_set<uint256, StaticSaltedHasher> badISLocks;
 
@@ -961,6 +1149,12 @@ std::unordered_set<uint256, StaticSaltedHasher> CInstantSendManager::ProcessPend
             m_peerman.load()->Misbehaving(nodeId, 20);
         }
     }
+    // Locks are accepted one by one, but all of them end up in the db in one batch before any is relayed or
+    // announced to the mempool and wallet
+    std::vector<AcceptedISLock> accepted;
+    std::vector<std::pair<uint256, CInstantSendLockPtr>> toWrite;
+    std::vector<std::pair<uint256, int>> toWriteMined;
+    std::unordered_set<uint256, StaticSaltedHasher> batchTxids;
     for (const auto& p : pend) {
         const auto& hash = p.first;
         auto nodeId = p.second.first;
@@ -969,11 +1163,24 @@ std::unordered_set<uint256, StaticSaltedHasher> CInstantSendManager::ProcessPend
         if (batchVerifier.badMessages.count(hash)) {
             LogPrint(BCLog::INSTANTSEND, "CInstantSendManager::%s -- txid=%s, islock=%s: invalid sig in islock, peer=%d\n", __func__,
                      islock->txid.ToString(), hash.ToString(), nodeId);
+            TRACE3(instantsend, islock_invalid,
+                hash.data(),
+                islock->txid.data(),
+                nodeId);
             badISLocks.emplace(hash);
             continue;
         }
 
-        ProcessInstantSendLock(nodeId, hash, islock);
+        if (auto a = AcceptInstantSendLock(nodeId, hash, islock, batchTxids)) {
+            if (a->tx != nullptr) {
+                toWrite.emplace_back(hash, islock);
+                batchTxids.emplace(islock->txid);
+                if (a->pindexMined != nullptr) {
+                    toWriteMined.emplace_back(hash, a->pindexMined->nHeight);
+                }
+            }
+            accepted.emplace_back(std::move(*a));
+        }
 
         // See comment further on top. We pass a reconstructed recovered sig to the signing manager to avoid
         // double-verification of the sig.
@@ -988,10 +1195,21 @@ std::unordered_set<uint256, StaticSaltedHasher> CInstantSendManager::ProcessPend
         }
     }
 
+    db.WriteNewInstantSendLocks(toWrite, toWriteMined);
+
+    for (const auto& a : accepted) {
+        ProcessAcceptedInstantSendLock(a);
+    }
+    if (!toWrite.empty()) {
+        // bump mempool counter to make sure newly locked txes are picked up by getblocktemplate
+        mempool.AddTransactionsUpdated(toWrite.size());
+    }
+
     return badISLocks;
 }
 
-void CInstantSendManager::ProcessInstantSendLock(NodeId from, const uint256& hash, const CInstantSendLockPtr& islock)
+std::optional<CInstantSendManager::AcceptedISLock> CInstantSendManager::AcceptInstantSendLock(NodeId from, const uint256& hash, const CInstantSendLockPtr& islock,
+                                                                                              const std::unordered_set<uint256, StaticSaltedHasher>& batchTxids)
 {
     LogPrint(BCLog::INSTANTSEND, "CInstantSendManager::%s -- txid=%s, islock=%s: processing islock, peer=%d\n", __func__,
              islock->txid.ToString(), hash.ToString(), from);
@@ -1001,7 +1219,7 @@ void CInstantSendManager::ProcessInstantSendLock(NodeId from, const uint256& has
         txToCreatingInstantSendLocks.erase(islock->txid);
     }
     if (db.KnownInstantSendLock(hash)) {
-        return;
+        return std::nullopt;
     }
 
     uint256 hashBlock;
@@ -1016,14 +1234,13 @@ void CInstantSendManager::ProcessInstantSendLock(NodeId from, const uint256& has
         if (pindexMined != nullptr && clhandler.HasChainLock(pindexMined->nHeight, pindexMined->GetBlockHash())) {
             LogPrint(BCLog::INSTANTSEND, "CInstantSendManager::%s -- txlock=%s, islock=%s: dropping islock as it already got a ChainLock in block %s, peer=%d\n", __func__,
                      islock->txid.ToString(), hash.ToString(), hashBlock.ToString(), from);
-            return;
+            return std::nullopt;
         }
     }
 
-    const auto sameTxIsLock = db.GetInstantSendLockByTxid(islock->txid);
-    if (sameTxIsLock != nullptr) {
+    if (batchTxids.count(islock->txid) || db.GetInstantSendLockByTxid(islock->txid) != nullptr) {
         // can happen, nothing to do
-        return;
+        return std::nullopt;
     }
     for (const auto& in : islock->inputs) {
         const auto sameOutpointIsLock = db.GetInstantSendLockByInput(in);
@@ -1037,13 +1254,21 @@ void CInstantSendManager::ProcessInstantSendLock(NodeId from, const uint256& has
         // put it in a separate pending map and try again later
         LOCK(cs_pendingLocks);
         pendingNoTxInstantSendLocks.try_emplace(hash, std::make_pair(from, islock));
-    } else {
-        db.WriteNewInstantSendLock(hash, *islock);
-        if (pindexMined) {
-            db.WriteInstantSendLockMined(hash, pindexMined->nHeight);
-        }
     }
 
+    return AcceptedISLock{from, hash, islock, tx, pindexMined};
+}
+
+void CInstantSendManager::ProcessAcceptedInstantSendLock(const AcceptedISLock& accepted)
+{
+    const auto& [from, hash, islock, tx, pindexMined] = accepted;
+    TRACE5(instantsend, islock_accepted,
+        hash.data(),
+        islock->txid.data(),
+        from,
+        tx != nullptr,
+        pindexMined != nullptr ? pindexMined->nHeight : -1);
+
     // This will also add children TXs to pendingRetryTxs
     RemoveNonLockedTx(islock->txid, true);
     // We don't need the recovered sigs for the inputs anymore. This prevents unnecessary propagation of these sigs.
@@ -1066,8 +1291,6 @@ void CInstantSendManager::ProcessInstantSendLock(NodeId from, const uint256& has
         LogPrint(BCLog::INSTANTSEND, "CInstantSendManager::%s -- notify about lock %s for tx %s\n", __func__,
                 hash.ToString(), tx->GetHash().ToString());
         GetMainSignals().NotifyTransactionLock(tx, islock);
-        // bump mempool counter to make sure newly locked txes are picked up by getblocktemplate
-        mempool.AddTransactionsUpdated(1);
     } else {
         AskNodesForLockedTx(islock->txid, connman);
     }
@@ -1288,6 +1511,10 @@ void CInstantSendManager::HandleFullyConfirmedBlock(const CBlockIndex* pindex)
     for (const auto& [islockHash, islock] : removeISLocks) {
         LogPrint(BCLog::INSTANTSEND, "CInstantSendManager::%s -- txid=%s, islock=%s: removed islock as it got fully confirmed\n", __func__,
                  islock->txid.ToString(), islockHash.ToString());
+        TRACE3(instantsend, islock_removed,
+            islockHash.data(),
+            islock->txid.data(),
+            ISLOCK_REMOVED_CONFIRMED);
 
         // No need to keep recovered sigs for fully confirmed IS locks, as there is no chance for conflicts
         // from now on. All inputs are spent now and can't be spend in any other TX.
@@ -1444,12 +1671,20 @@ void CInstantSendManager::RemoveConflictingLock(const uint256& islockHash, const
 {
     LogPrintf("CInstantSendManager::%s -- txid=%s, islock=%s: Removing ISLOCK and its chained children\n", __func__,
               islock.txid.ToString(), islockHash.ToString());
+    TRACE3(instantsend, islock_removed,
+        islockHash.data(),
+        islock.txid.data(),
+        ISLOCK_REMOVED_CONFLICT);
     int tipHeight = WITH_LOCK(cs_main, return m_chainstate.m_chain.Height());
 
     auto removedIslocks = db.RemoveChainedInstantSendLocks(islockHash, islock.txid, tipHeight);
     for (const auto& h : removedIslocks) {
         LogPrintf("CInstantSendManager::%s -- txid=%s, islock=%s: removed (child) ISLOCK %s\n", __func__,
                   islock.txid.ToString(), islockHash.ToString(), h.ToString());
+        TRACE3(instantsend, islock_removed,
+            h.data(),
+            islock.txid.data(),
+            ISLOCK_REMOVED_CHAINED);
     }
 }
 
@@ -1634,12 +1869,7 @@ CInstantSendLockPtr CInstantSendManager::GetConflictingLock(const CTransaction&
     }
 
     for (const auto& in : tx.vin) {
-        auto otherIsLock = db.GetInstantSendLockByInput(in.prevout);
-        if (!otherIsLock) {
-            continue;
-        }
-
-        if (otherIsLock->txid != tx.GetHash()) {
+        if (auto otherIsLock = db.GetConflictingLockByInput(in.prevout, tx.GetHash())) {
             return otherIsLock;
         }
     }
@@ -17,7 +17,9 @@
 
 #include <gsl/pointers.h>
 
+#include <array>
 #include <atomic>
+#include <optional>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -61,23 +63,86 @@ struct CInstantSendLock
 
 using CInstantSendLockPtr = std::shared_ptr<CInstantSendLock>;
 
+/**
+ * Maps the inputs of all islocks which are not archived yet to their islock and its txid. Conflict checks done for
+ * every input of every tx entering the mempool are answered from here, without cs_db and without touching the db.
+ *
+ * It's split into shards with their own mutex so concurrent lookups don't contend. If it ever needs more than its
+ * limit of entries it stops being complete and lookups have to fall back to the db.
+ */
+class CInstantSendOutpointIndex
+{
+public:
+    static constexpr size_t SHARDS{16};
+    static constexpr size_t DEFAULT_MAX_ENTRIES{200000};
+
+    struct Entry {
+        uint256 islockHash;
+        uint256 txid;
+    };
+
+    explicit CInstantSendOutpointIndex(size_t nMaxEntries = DEFAULT_MAX_ENTRIES) : m_max_entries(nMaxEntries) {}
+
+    void Add(const COutPoint& outpoint, const Entry& entry);
+    void Add(const uint256& islockHash, const CInstantSendLock& islock);
+    /** Only removes entries which still belong to islockHash */
+    void Remove(const uint256& islockHash, const CInstantSendLock& islock);
+
+    /** Whether an outpoint that isn't in the index is known to not be locked */
+    [[nodiscard]] bool IsComplete() const { return m_complete; }
+    void SetComplete(bool complete) { m_complete = complete && m_size <= m_max_entries; }
+
+    [[nodiscard]] std::optional<Entry> Get(const COutPoint& outpoint) const;
+    [[nodiscard]] size_t size() const { return m_size; }
+
+private:
+    struct Shard {
+        mutable Mutex cs;
+        std::unordered_map<COutPoint, Entry, SaltedOutpointHasher> entries GUARDED_BY(cs);
+    };
+
+    Shard& GetShard(const COutPoint& outpoint) const { return m_shards[m_shard_hasher(outpoint) % SHARDS]; }
+
+    const size_t m_max_entries;
+    const SaltedOutpointHasher m_shard_hasher;
+    mutable std::array<Shard, SHARDS> m_shards;
+    std::atomic<size_t> m_size{0};
+    std::atomic<bool> m_complete{false};
+};
+
 class CInstantSendDb
 {
 private:
     mutable Mutex cs_db;
 
     static constexpr int CURRENT_VERSION{1};
+    // Number of blocks between compactions of the pruned parts of the height indexes
+    static constexpr int COMPACTION_INTERVAL{576};
 
     int best_confirmed_height GUARDED_BY(cs_db) {0};
+    int last_compaction_height GUARDED_BY(cs_db) {0};
 
     std::unique_ptr<CDBWrapper> db GUARDED_BY(cs_db) {nullptr};
     mutable unordered_lru_cache<uint256, CInstantSendLockPtr, StaticSaltedHasher, 10000> islockCache GUARDED_BY(cs_db);
     mutable unordered_lru_cache<uint256, uint256, StaticSaltedHasher, 10000> txidCache GUARDED_BY(cs_db);
 
     mutable unordered_lru_cache<COutPoint, uint256, SaltedOutpointHasher, 10000> outpointCache GUARDED_BY(cs_db);
+    // Has its own locks, see CInstantSendOutpointIndex
+    CInstantSendOutpointIndex outpointIndex;
+
+    void LoadOutpointIndex() EXCLUSIVE_LOCKS_REQUIRED(cs_db);
+    void WriteNewInstantSendLock(CDBBatch& batch, const uint256& hash, const CInstantSendLock& islock) EXCLUSIVE_LOCKS_REQUIRED(cs_db);
+    void AddToCaches(const uint256& hash, const CInstantSendLockPtr& islock) EXCLUSIVE_LOCKS_REQUIRED(cs_db);
     void WriteInstantSendLockMined(CDBBatch& batch, const uint256& hash, int nHeight) EXCLUSIVE_LOCKS_REQUIRED(cs_db);
 
     void RemoveInstantSendLockMined(CDBBatch& batch, const uint256& hash, int nHeight) EXCLUSIVE_LOCKS_REQUIRED(cs_db);
+    /**
+     * Compacts the parts of the mined and archived indexes which were pruned, so that the scans of
+     * RemoveConfirmedInstantSendLocks and RemoveArchivedInstantSendLocks don't have to skip their tombstones
+     * @param nConfirmedUntilHeight The height up to which mined IS Locks were removed
+     * @param nArchivedUntilHeight The height up to which archived IS Locks were removed
+     */
+    void CompactPrunedRanges(int nConfirmedUntilHeight, int nArchivedUntilHeight) LOCKS_EXCLUDED(cs_db);
 
     /**
      * This method removes a InstantSend Lock from the database and is called when a tx with an IS lock is confirmed and Chainlocked
@@ -124,6 +189,13 @@ public:
      * @param islock The InstantSend Lock object itself
      */
     void WriteNewInstantSendLock(const uint256& hash, const CInstantSendLock& islock) LOCKS_EXCLUDED(cs_db);
+    /**
+     * Adds many InstantSend Locks to the database in a single batch
+     * @param islocks The hashes of the InstantSend Locks and the locks themselves
+     * @param mined The hashes and mined heights of those locks of which the transaction is already in a block
+     */
+    void WriteNewInstantSendLocks(const std::vector<std::pair<uint256, CInstantSendLockPtr>>& islocks,
+                                  const std::vector<std::pair<uint256, int>>& mined) LOCKS_EXCLUDED(cs_db);
     /**
      * This method updates a DB entry for an InstantSend Lock from being not included in a block to being included in a block
      * @param hash The hash of the InstantSend Lock
@@ -182,6 +254,14 @@ public:
      * @return IS Lock Pointer associated with that input.
      */
     CInstantSendLockPtr GetInstantSendLockByInput(const COutPoint& outpoint) const LOCKS_EXCLUDED(cs_db);
+    /**
+     * Gets the IS Lock of an input if it locks another transaction than txid. Does not need cs_db unless there is a
+     * conflict.
+     * @param outpoint The input
+     * @param txid The transaction spending the input
+     * @return IS Lock Pointer of the conflicting lock, nullptr if there is none
+     */
+    CInstantSendLockPtr GetConflictingLockByInput(const COutPoint& outpoint, const uint256& txid) const LOCKS_EXCLUDED(cs_db);
     /**
      * Called when a ChainLock invalidated a IS Lock, removes any chained/children IS Locks and the invalidated IS Lock
      * @param islockHash IS Lock hash which has been invalidated
@@ -290,7 +370,23 @@ private:
                                                                                    std::pair<NodeId, CInstantSendLockPtr>,
                                                                                    StaticSaltedHasher>& pend,
                                                                                    bool ban) LOCKS_EXCLUDED(cs_pendingLocks);
-    void ProcessInstantSendLock(NodeId from, const uint256& hash, const CInstantSendLockPtr& islock) LOCKS_EXCLUDED(cs_creating, cs_pendingLocks);
+    /** A verified lock which is new to us, see AcceptInstantSendLock */
+    struct AcceptedISLock {
+        NodeId from;
+        uint256 hash;
+        CInstantSendLockPtr islock;
+        CTransactionRef tx;
+        const CBlockIndex* pindexMined;
+    };
+    /**
+     * First stage of processing a verified lock: decide if it is needed at all. Locks of which the tx is still unknown
+     * are queued in pendingNoTxInstantSendLocks, all others have to be written to the db by the caller.
+     * @param batchTxids txids of the locks the caller is about to write, which the db does not know about yet
+     */
+    std::optional<AcceptedISLock> AcceptInstantSendLock(NodeId from, const uint256& hash, const CInstantSendLockPtr& islock,
+                                                        const std::unordered_set<uint256, StaticSaltedHasher>& batchTxids) LOCKS_EXCLUDED(cs_creating, cs_pendingLocks);
+    /** Second stage, once the lock is in the db: relay it and update everything depending on it */
+    void ProcessAcceptedInstantSendLock(const AcceptedISLock& accepted);
 
     void AddNonLockedTx(const CTransactionRef& tx, const CBlockIndex* pindexMined) LOCKS_EXCLUDED(cs_pendingLocks, cs_nonLocked);
     void RemoveNonLockedTx(const uint256& txid, bool retryChildren) LOCKS_EXCLUDED(cs_nonLocked, cs_pendingRetry);
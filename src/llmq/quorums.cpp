@@ -21,6 +21,7 @@
 #include <netmessagemaker.h>
 #include <univalue.h>
 #include <util/irange.h>
+#include <util/perfcounters.h>
 #include <util/time.h>
 #include <util/underlying.h>
 #include <validation.h>
@@ -32,6 +33,13 @@ namespace llmq
 
 static const std::string DB_QUORUM_SK_SHARE = "q_Qsk";
 static const std::string DB_QUORUM_QUORUM_VVEC = "q_Qqvvec";
+static const std::string DB_QUORUM_PUBKEY_SHARES = "q_Qpks";
+static const std::string DB_QUORUM_MEMBERS = "q_Qmembers";
+
+// Bump this whenever the serialization of DB_QUORUM_PUBKEY_SHARES changes, entries of other versions are recomputed
+static constexpr uint8_t QUORUM_PUBKEY_SHARES_VERSION = 1;
+// Same for DB_QUORUM_MEMBERS, which includes CDeterministicMN::MN_CURRENT_FORMAT changes
+static constexpr uint8_t QUORUM_MEMBERS_VERSION = 1;
 
 std::unique_ptr<CQuorumManager> quorumManager;
 
@@ -52,6 +60,47 @@ static uint256 MakeQuorumKey(const CQuorum& q)
     return hw.GetHash();
 }
 
+// Members are stored before the quorum key, which is built from them, can be known
+static uint256 MakeQuorumMembersKey(Consensus::LLMQType llmqType, const uint256& quorumHash)
+{
+    return ::SerializeHash(std::make_pair(llmqType, quorumHash));
+}
+
+static void WriteQuorumMembers(CEvoDB& evoDb, Consensus::LLMQType llmqType, const uint256& quorumHash, const std::vector<CDeterministicMNCPtr>& members)
+{
+    CDataStream s(SER_DISK, CLIENT_VERSION);
+    s << QUORUM_MEMBERS_VERSION;
+    WriteCompactSize(s, members.size());
+    for (const auto& dmn : members) {
+        s << *dmn;
+    }
+    evoDb.GetRawDB().Write(std::make_pair(DB_QUORUM_MEMBERS, MakeQuorumMembersKey(llmqType, quorumHash)), s);
+}
+
+static bool ReadQuorumMembers(CEvoDB& evoDb, Consensus::LLMQType llmqType, const uint256& quorumHash, std::vector<CDeterministicMNCPtr>& membersRet)
+{
+    CDataStream s(SER_DISK, CLIENT_VERSION);
+    if (!evoDb.GetRawDB().ReadDataStream(std::make_pair(DB_QUORUM_MEMBERS, MakeQuorumMembersKey(llmqType, quorumHash)), s)) {
+        return false;
+    }
+
+    try {
+        uint8_t version;
+        s >> version;
+        if (version != QUORUM_MEMBERS_VERSION) {
+            return false;
+        }
+        std::vector<CDeterministicMNCPtr> members(ReadCompactSize(s));
+        for (auto& dmn : members) {
+            dmn = std::make_shared<const CDeterministicMN>(deserialize, s, CDeterministicMN::MN_CURRENT_FORMAT);
+        }
+        membersRet = std::move(members);
+    } catch (const std::exception&) {
+        return false;
+    }
+    return true;
+}
+
 std::string CQuorumDataRequest::GetErrorString() const
 {
     switch (nError) {
@@ -131,6 +180,10 @@ bool CQuorum::IsValidMember(const uint256& proTxHash) const
 
 CBLSPublicKey CQuorum::GetPubKeyShare(size_t memberIdx) const
 {
+    if (const auto shares = std::atomic_load(&pubKeyShares)) {
+        return memberIdx < shares->size() ? (*shares)[memberIdx] : CBLSPublicKey();
+    }
+
     LOCK(cs);
     if (!HasVerificationVector() || memberIdx >= members.size() || !qc->validMembers[memberIdx]) {
         return CBLSPublicKey();
@@ -144,6 +197,16 @@ bool CQuorum::HasVerificationVector() const {
     return quorumVvec != nullptr;
 }
 
+bool CQuorum::HasPubKeyShares() const {
+    return std::atomic_load(&pubKeyShares) != nullptr;
+}
+
+void CQuorum::SetPubKeyShares(std::vector<CBLSPublicKey>&& pubKeySharesIn) const
+{
+    assert(pubKeySharesIn.size() == members.size());
+    std::atomic_store(&pubKeyShares, std::make_shared<const std::vector<CBLSPublicKey>>(std::move(pubKeySharesIn)));
+}
+
 CBLSSecretKey CQuorum::GetSkShare() const
 {
     LOCK(cs);
@@ -202,6 +265,56 @@ bool CQuorum::ReadContributions(CEvoDB& evoDb)
     // member of the quorum but observed the whole DKG process to have the quorum verification vector.
     evoDb.GetRawDB().Read(std::make_pair(DB_QUORUM_SK_SHARE, dbKey), skShare);
 
+    // Missing or outdated public key shares are simply recovered again by the cache populator
+    ReadPubKeyShares(evoDb);
+
+    return true;
+}
+
+void CQuorum::WritePubKeyShares(CEvoDB& evoDb) const
+{
+    uint256 dbKey = MakeQuorumKey(*this);
+
+    const auto shares = std::atomic_load(&pubKeyShares);
+    if (shares == nullptr) {
+        return;
+    }
+    CDataStream s(SER_DISK, CLIENT_VERSION);
+    s << QUORUM_PUBKEY_SHARES_VERSION << qc->quorumVvecHash;
+    WriteCompactSize(s, shares->size());
+    for (const auto& pubkey : *shares) {
+        s << ConstCBLSPublicKeyVersionWrapper(pubkey, false);
+    }
+    evoDb.GetRawDB().Write(std::make_pair(DB_QUORUM_PUBKEY_SHARES, dbKey), s);
+}
+
+bool CQuorum::ReadPubKeyShares(CEvoDB& evoDb)
+{
+    uint256 dbKey = MakeQuorumKey(*this);
+    CDataStream s(SER_DISK, CLIENT_VERSION);
+
+    if (!evoDb.GetRawDB().ReadDataStream(std::make_pair(DB_QUORUM_PUBKEY_SHARES, dbKey), s)) {
+        return false;
+    }
+
+    uint8_t version;
+    uint256 vvecHash;
+    s >> version;
+    if (version != QUORUM_PUBKEY_SHARES_VERSION) {
+        return false;
+    }
+    s >> vvecHash;
+    // the shares are only worth anything if they were recovered from this very quorum's vvec
+    if (vvecHash != qc->quorumVvecHash || ReadCompactSize(s) != members.size()) {
+        return false;
+    }
+
+    std::vector<CBLSPublicKey> shares(members.size());
+    for (auto& pubkey : shares) {
+        s >> CBLSPublicKeyVersionWrapper(pubkey, false);
+    }
+    SetPubKeyShares(std::move(shares));
+
     return true;
 }
 
@@ -216,13 +329,23 @@ CQuorumManager::CQuorumManager(CBLSWorker& _blsWorker, CChainState& chainstate,
     m_mn_sync(mn_sync)
 {
     utils::InitQuorumsCache(mapQuorumsCache, false);
+    for (const auto& llmq : Params().GetConsensus().llmqs) {
+        mapScanQuorumsTip.emplace(llmq.type, nullptr);
+    }
     quorumThreadInterrupt.reset();
 }
 
+static perf::Gauge& g_data_recovery_queued{perf::GetGauge("llmq.data_recovery.queued", "Quorum data recoveries waiting for a worker")};
+static perf::Gauge& g_data_recovery_running{perf::GetGauge("llmq.data_recovery.running", "Quorum data recoveries in progress")};
+static perf::Counter& g_data_recovery_success{perf::GetCounter("llmq.data_recovery.success", "Quorum data recoveries which received all data")};
+static perf::Counter& g_data_recovery_failed{perf::GetCounter("llmq.data_recovery.failed", "Quorum data recoveries which gave up or were aborted")};
+static perf::Histogram& g_data_recovery_time{perf::GetHistogram("llmq.data_recovery.time", "How long a quorum data recovery ran")};
+static perf::Histogram& g_cache_populator_time{perf::GetHistogram("llmq.cache_populator.time", "Time to build the public key shares of a quorum")};
+
 void CQuorumManager::Start()
 {
-    int workerCount = std::thread::hardware_concurrency() / 2;
-    workerCount = std::max(std::min(1, workerCount), 4);
+    // at least two, so a recovery waiting for peers never holds the only worker
+    const int workerCount = std::clamp<int>(std::thread::hardware_concurrency() / 2, 2, 4);
     workerPool.resize(workerCount);
     RenameThreadPool(workerPool, "q-mngr");
 }
@@ -232,6 +355,15 @@ void CQuorumManager::Stop()
     quorumThreadInterrupt();
     workerPool.clear_queue();
     workerPool.stop(true);
+
+    LOCK(cs_data_recovery);
+    for (auto* queue : {&dataRecoveryMemberQueue, &dataRecoveryWatchQueue}) {
+        for (const auto& task : *queue) {
+            task.pQuorum->fQuorumDataRecoveryThreadRunning = false;
+        }
+        queue->clear();
+    }
+    g_data_recovery_queued.Set(0);
 }
 
 void CQuorumManager::TriggerQuorumDataRecoveryThreads(const CBlockIndex* pIndex) const
@@ -280,7 +412,7 @@ void CQuorumManager::TriggerQuorumDataRecoveryThreads(const CBlockIndex* pIndex)
             }
 
             // Finally start the thread which triggers the requests for this quorum
-            StartQuorumDataRecoveryThread(pQuorum, pIndex, nDataMask);
+            StartQuorumDataRecoveryThread(pQuorum, pIndex, nDataMask, fWeAreQuorumMember);
         }
     }
 }
@@ -293,6 +425,14 @@ void CQuorumManager::UpdatedBlockTip(const CBlockIndex* pindexNew, bool fInitial
         CheckQuorumConnections(params, pindexNew);
     }
 
+    // Publish the quorums at the new tip before signing asks for them
+    for (const auto& params : Params().GetConsensus().llmqs) {
+        const CBlockIndex* pindexStore = GetScanQuorumsStoreIndex(params, pindexNew);
+        if (pindexStore == nullptr) continue;
+        auto tip = std::make_shared<const ScanQuorumsTip>(ScanQuorumsTip{pindexStore, ScanQuorums(params.type, pindexNew, params.keepOldConnections)});
+        std::atomic_store(&mapScanQuorumsTip.at(params.type), std::move(tip));
+    }
+
     if (fMasternodeMode || IsWatchQuorumsEnabled()) {
         // Cleanup expired data requests
         LOCK(cs_data_requests);
@@ -308,6 +448,7 @@ void CQuorumManager::UpdatedBlockTip(const CBlockIndex* pindexNew, bool fInitial
 
     TriggerQuorumDataRecoveryThreads(pindexNew);
     StartCleanupOldQuorumDataThread(pindexNew);
+    StartPrecomputeQuorumMembersThread(pindexNew);
 }
 
 void CQuorumManager::CheckQuorumConnections(const Consensus::LLMQParams& llmqParams, const CBlockIndex* pindexNew) const
@@ -390,7 +531,16 @@ CQuorumPtr CQuorumManager::BuildQuorumFromCommitment(const Consensus::LLMQType l
     const auto& llmq_params_opt = Params().GetLLMQ(llmqType);
     assert(llmq_params_opt.has_value());
     auto quorum = std::make_shared<CQuorum>(llmq_params_opt.value(), blsWorker);
-    auto members = utils::GetAllQuorumMembers(qc->llmqType, pQuorumBaseBlockIndex);
+    // Members of rotated quorums take the whole quarter rotation to compute, don't redo that after every restart
+    std::vector<CDeterministicMNCPtr> members;
+    if (ReadQuorumMembers(m_evoDb, llmqType, quorumHash, members)) {
+        utils::AddQuorumMembersToCache(llmqType, pQuorumBaseBlockIndex, members);
+    } else {
+        members = utils::GetAllQuorumMembers(qc->llmqType, pQuorumBaseBlockIndex);
+        if (!members.empty()) {
+            WriteQuorumMembers(m_evoDb, llmqType, quorumHash, members);
+        }
+    }
 
     quorum->Init(std::move(qc), pQuorumBaseBlockIndex, minedBlockHash, members);
 
@@ -509,32 +659,47 @@ std::vector<CQuorumCPtr> CQuorumManager::ScanQuorums(Consensus::LLMQType llmqTyp
     return ScanQuorums(llmqType, pindex, nCountRequested);
 }
 
+// Quorum sets can only change during the mining phase of DKG, this is the block whose set pindexStart has
+const CBlockIndex* CQuorumManager::GetScanQuorumsStoreIndex(const Consensus::LLMQParams& llmq_params, gsl::not_null<const CBlockIndex*> pindexStart)
+{
+    const int quorumCycleStartHeight = pindexStart->nHeight - (pindexStart->nHeight % llmq_params.dkgInterval);
+    const int quorumCycleMiningStartHeight = quorumCycleStartHeight + llmq_params.dkgMiningWindowStart;
+    const int quorumCycleMiningEndHeight = quorumCycleStartHeight + llmq_params.dkgMiningWindowEnd;
+
+    if (pindexStart->nHeight < quorumCycleMiningStartHeight) {
+        // too early for this cycle, use the previous one
+        // bail out if it's below genesis block
+        if (quorumCycleMiningEndHeight < llmq_params.dkgInterval) return nullptr;
+        return pindexStart->GetAncestor(quorumCycleMiningEndHeight - llmq_params.dkgInterval);
+    } else if (pindexStart->nHeight > quorumCycleMiningEndHeight) {
+        // we are past the mining phase of this cycle, use it
+        return pindexStart->GetAncestor(quorumCycleMiningEndHeight);
+    }
+    // everything else is inside the mining phase of this cycle, no pindexStore adjustment needed
+    return pindexStart;
+}
+
 std::vector<CQuorumCPtr> CQuorumManager::ScanQuorums(Consensus::LLMQType llmqType, const CBlockIndex* pindexStart, size_t nCountRequested) const
 {
     if (pindexStart == nullptr || nCountRequested == 0 || !IsQuorumTypeEnabled(llmqType, pindexStart)) {
         return {};
     }
 
-    gsl::not_null<const CBlockIndex*> pindexStore{pindexStart};
     const auto& llmq_params_opt = Params().GetLLMQ(llmqType);
     assert(llmq_params_opt.has_value());
 
-    // Quorum sets can only change during the mining phase of DKG.
-    // Find the closest known block index.
-    const int quorumCycleStartHeight = pindexStart->nHeight - (pindexStart->nHeight % llmq_params_opt->dkgInterval);
-    const int quorumCycleMiningStartHeight = quorumCycleStartHeight + llmq_params_opt->dkgMiningWindowStart;
-    const int quorumCycleMiningEndHeight = quorumCycleStartHeight + llmq_params_opt->dkgMiningWindowEnd;
+    const CBlockIndex* pindexStoreOpt = GetScanQuorumsStoreIndex(*llmq_params_opt, pindexStart);
+    if (pindexStoreOpt == nullptr) {
+        return {};
+    }
+    gsl::not_null<const CBlockIndex*> pindexStore{pindexStoreOpt};
 
-    if (pindexStart->nHeight < quorumCycleMiningStartHeight) {
-        // too early for this cycle, use the previous one
-        // bail out if it's below genesis block
-        if (quorumCycleMiningEndHeight < llmq_params_opt->dkgInterval) return {};
-        pindexStore = pindexStart->GetAncestor(quorumCycleMiningEndHeight - llmq_params_opt->dkgInterval);
-    } else if (pindexStart->nHeight > quorumCycleMiningEndHeight) {
-        // we are past the mining phase of this cycle, use it
-        pindexStore = pindexStart->GetAncestor(quorumCycleMiningEndHeight);
+    if (const auto it = mapScanQuorumsTip.find(llmqType); it != mapScanQuorumsTip.end()) {
+        const auto tip = std::atomic_load(&it->second);
+        if (tip && tip->pindexStore == pindexStore && tip->quorums.size() >= nCountRequested) {
+            return {tip->quorums.begin(), tip->quorums.begin() + nCountRequested};
+        }
     }
-    // everything else is inside the mining phase of this cycle, no pindexStore adjustment needed
 
     gsl::not_null<const CBlockIndex*> pIndexScanCommitments{pindexStore};
     size_t nScanCommitments{nCountRequested};
@@ -846,7 +1011,7 @@ PeerMsgRet CQuorumManager::ProcessMessage(CNode& pfrom, const std::string& msg_t
 
 void CQuorumManager::StartCachePopulatorThread(const CQuorumCPtr pQuorum) const
 {
-    if (!pQuorum->HasVerificationVector()) {
+    if (!pQuorum->HasVerificationVector() || pQuorum->HasPubKeyShares()) {
         return;
     }
 
@@ -858,14 +1023,26 @@ void CQuorumManager::StartCachePopulatorThread(const CQuorumCPtr pQuorum) const
 
     // when then later some other thread tries to get keys, it will be much faster
     workerPool.push([pQuorum, t, this](int threadId) {
-        for (const auto i : irange::range(pQuorum->members.size())) {
+        const auto vvec = WITH_LOCK(pQuorum->cs, return pQuorum->quorumVvec);
+        std::vector<CBLSPublicKey> pubKeyShares(pQuorum->members.size());
+        std::atomic<bool> interrupted{false};
+        // every share is recovered independently from the vvec, spread them over the BLS worker
+        blsWorker.RunParallel(pQuorum->members.size(), [&](size_t i) {
             if (quorumThreadInterrupt) {
-                break;
+                interrupted = true;
+                return;
             }
             if (pQuorum->qc->validMembers[i]) {
-                pQuorum->GetPubKeyShare(i);
+                pubKeyShares[i] = CBLSWorker::BuildPubKeyShare(vvec, CBLSId(pQuorum->members[i]->proTxHash));
             }
+        });
+        if (interrupted) {
+            return;
         }
+        // keep them around for good, also across restarts
+        pQuorum->SetPubKeyShares(std::move(pubKeyShares));
+        pQuorum->WritePubKeyShares(m_evoDb);
+        g_cache_populator_time.Observe(t.count<std::chrono::microseconds>());
         LogPrint(BCLog::LLMQ, "CQuorumManager::StartCachePopulatorThread -- type=%d height=%d hash=%s done. time=%d\n",
                 ToUnderlying(pQuorum->params.type),
                 pQuorum->m_quorum_base_block_index->nHeight,
@@ -874,7 +1051,7 @@ void CQuorumManager::StartCachePopulatorThread(const CQuorumCPtr pQuorum) const
     });
 }
 
-void CQuorumManager::StartQuorumDataRecoveryThread(const CQuorumCPtr pQuorum, const CBlockIndex* pIndex, uint16_t nDataMaskIn) const
+void CQuorumManager::StartQuorumDataRecoveryThread(const CQuorumCPtr pQuorum, const CBlockIndex* pIndex, uint16_t nDataMask, bool fWeAreQuorumMember) const
 {
     if (pQuorum->fQuorumDataRecoveryThreadRunning) {
         LogPrint(BCLog::LLMQ, "CQuorumManager::%s -- Already running\n", __func__);
@@ -882,122 +1059,157 @@ void CQuorumManager::StartQuorumDataRecoveryThread(const CQuorumCPtr pQuorum, co
     }
     pQuorum->fQuorumDataRecoveryThreadRunning = true;
 
-    workerPool.push([pQuorum, pIndex, nDataMaskIn, this](int threadId) {
-        size_t nTries{0};
-        uint16_t nDataMask{nDataMaskIn};
-        int64_t nTimeLastSuccess{0};
-        uint256* pCurrentMemberHash{nullptr};
-        std::vector<uint256> vecMemberHashes;
-        const size_t nMyStartOffset{GetQuorumRecoveryStartOffset(pQuorum, pIndex)};
-        const int64_t nRequestTimeout{10};
-
-        auto printLog = [&](const std::string& strMessage) {
-            const std::string strMember{pCurrentMemberHash == nullptr ? "nullptr" : pCurrentMemberHash->ToString()};
-            LogPrint(BCLog::LLMQ, "CQuorumManager::StartQuorumDataRecoveryThread -- %s - for llmqType %d, quorumHash %s, nDataMask (%d/%d), pCurrentMemberHash %s, nTries %d\n",
-                strMessage, ToUnderlying(pQuorum->qc->llmqType), pQuorum->qc->quorumHash.ToString(), nDataMask, nDataMaskIn, strMember, nTries);
-        };
-        printLog("Start");
+    LOCK(cs_data_recovery);
+    (fWeAreQuorumMember ? dataRecoveryMemberQueue : dataRecoveryWatchQueue).push_back({pQuorum, pIndex, nDataMask});
+    g_data_recovery_queued.Add(1);
+    ScheduleQuorumDataRecoveryThreads();
+}
 
-        while (!m_mn_sync->IsBlockchainSynced() && !quorumThreadInterrupt) {
-            quorumThreadInterrupt.sleep_for(std::chrono::seconds(nRequestTimeout));
+void CQuorumManager::ScheduleQuorumDataRecoveryThreads() const
+{
+    AssertLockHeld(cs_data_recovery);
+    const size_t nMaxRunning = std::max<size_t>(1, workerPool.size() / 2);
+    while (nDataRecoveryRunning < nMaxRunning && !quorumThreadInterrupt) {
+        auto& queue = !dataRecoveryMemberQueue.empty() ? dataRecoveryMemberQueue : dataRecoveryWatchQueue;
+        if (queue.empty()) {
+            break;
         }
+        DataRecoveryTask task = std::move(queue.front());
+        queue.pop_front();
+        g_data_recovery_queued.Add(-1);
+        ++nDataRecoveryRunning;
+        g_data_recovery_running.Add(1);
+
+        workerPool.push([task = std::move(task), this](int threadId) {
+            QuorumDataRecoveryThread(task.pQuorum, task.pIndex, task.nDataMask);
+            g_data_recovery_running.Add(-1);
+            LOCK(cs_data_recovery);
+            --nDataRecoveryRunning;
+            ScheduleQuorumDataRecoveryThreads();
+        });
+    }
+}
 
-        if (quorumThreadInterrupt) {
-            printLog("Aborted");
-            return;
-        }
+void CQuorumManager::QuorumDataRecoveryThread(const CQuorumCPtr pQuorum, const CBlockIndex* pIndex, uint16_t nDataMaskIn) const
+{
+    cxxtimer::Timer t(/*start=*/ true);
+    size_t nTries{0};
+    uint16_t nDataMask{nDataMaskIn};
+    int64_t nTimeLastSuccess{0};
+    uint256* pCurrentMemberHash{nullptr};
+    std::vector<uint256> vecMemberHashes;
+    const size_t nMyStartOffset{GetQuorumRecoveryStartOffset(pQuorum, pIndex)};
+    const int64_t nRequestTimeout{10};
+
+    auto printLog = [&](const std::string& strMessage) {
+        const std::string strMember{pCurrentMemberHash == nullptr ? "nullptr" : pCurrentMemberHash->ToString()};
+        LogPrint(BCLog::LLMQ, "CQuorumManager::StartQuorumDataRecoveryThread -- %s - for llmqType %d, quorumHash %s, nDataMask (%d/%d), pCurrentMemberHash %s, nTries %d\n",
+            strMessage, ToUnderlying(pQuorum->qc->llmqType), pQuorum->qc->quorumHash.ToString(), nDataMask, nDataMaskIn, strMember, nTries);
+    };
+    printLog("Start");
 
-        vecMemberHashes.reserve(pQuorum->qc->validMembers.size());
-        for (auto& member : pQuorum->members) {
-            if (pQuorum->IsValidMember(member->proTxHash) && member->proTxHash != WITH_LOCK(activeMasternodeInfoCs, return activeMasternodeInfo.proTxHash)) {
-                vecMemberHashes.push_back(member->proTxHash);
-            }
+    while (!m_mn_sync->IsBlockchainSynced() && !quorumThreadInterrupt) {
+        quorumThreadInterrupt.sleep_for(std::chrono::seconds(nRequestTimeout));
+    }
+
+    if (quorumThreadInterrupt) {
+        printLog("Aborted");
+        g_data_recovery_failed.Add();
+        return;
+    }
+
+    vecMemberHashes.reserve(pQuorum->qc->validMembers.size());
+    for (auto& member : pQuorum->members) {
+        if (pQuorum->IsValidMember(member->proTxHash) && member->proTxHash != WITH_LOCK(activeMasternodeInfoCs, return activeMasternodeInfo.proTxHash)) {
+            vecMemberHashes.push_back(member->proTxHash);
         }
-        std::sort(vecMemberHashes.begin(), vecMemberHashes.end());
+    }
+    std::sort(vecMemberHashes.begin(), vecMemberHashes.end());
 
-        printLog("Try to request");
+    printLog("Try to request");
 
-        while (nDataMask > 0 && !quorumThreadInterrupt) {
+    while (nDataMask > 0 && !quorumThreadInterrupt) {
 
-            if (nDataMask & llmq::CQuorumDataRequest::QUORUM_VERIFICATION_VECTOR &&
-                pQuorum->HasVerificationVector()) {
-                nDataMask &= ~llmq::CQuorumDataRequest::QUORUM_VERIFICATION_VECTOR;
-                printLog("Received quorumVvec");
-            }
+        if (nDataMask & llmq::CQuorumDataRequest::QUORUM_VERIFICATION_VECTOR &&
+            pQuorum->HasVerificationVector()) {
+            nDataMask &= ~llmq::CQuorumDataRequest::QUORUM_VERIFICATION_VECTOR;
+            printLog("Received quorumVvec");
+        }
 
-            if (nDataMask & llmq::CQuorumDataRequest::ENCRYPTED_CONTRIBUTIONS && pQuorum->GetSkShare().IsValid()) {
-                nDataMask &= ~llmq::CQuorumDataRequest::ENCRYPTED_CONTRIBUTIONS;
-                printLog("Received skShare");
-            }
+        if (nDataMask & llmq::CQuorumDataRequest::ENCRYPTED_CONTRIBUTIONS && pQuorum->GetSkShare().IsValid()) {
+            nDataMask &= ~llmq::CQuorumDataRequest::ENCRYPTED_CONTRIBUTIONS;
+            printLog("Received skShare");
+        }
 
-            if (nDataMask == 0) {
-                printLog("Success");
+        if (nDataMask == 0) {
+            printLog("Success");
+            break;
+        }
+
+        if ((GetTime<std::chrono::seconds>().count() - nTimeLastSuccess) > nRequestTimeout) {
+            if (nTries >= vecMemberHashes.size()) {
+                printLog("All tried but failed");
                 break;
             }
-
-            if ((GetTime<std::chrono::seconds>().count() - nTimeLastSuccess) > nRequestTimeout) {
-                if (nTries >= vecMemberHashes.size()) {
-                    printLog("All tried but failed");
-                    break;
+            // Access the member list of the quorum with the calculated offset applied to balance the load equally
+            pCurrentMemberHash = &vecMemberHashes[(nMyStartOffset + nTries++) % vecMemberHashes.size()];
+            {
+                LOCK(cs_data_requests);
+                const CQuorumDataRequestKey key(*pCurrentMemberHash, true, pQuorum->qc->quorumHash, pQuorum->qc->llmqType);
+                auto it = mapQuorumDataRequests.find(key);
+                if (it != mapQuorumDataRequests.end() && !it->second.IsExpired(/*add_bias=*/true)) {
+                    printLog("Already asked");
+                    continue;
                 }
-                // Access the member list of the quorum with the calculated offset applied to balance the load equally
-                pCurrentMemberHash = &vecMemberHashes[(nMyStartOffset + nTries++) % vecMemberHashes.size()];
-                {
-                    LOCK(cs_data_requests);
-                    const CQuorumDataRequestKey key(*pCurrentMemberHash, true, pQuorum->qc->quorumHash, pQuorum->qc->llmqType);
-                    auto it = mapQuorumDataRequests.find(key);
-                    if (it != mapQuorumDataRequests.end() && !it->second.IsExpired(/*add_bias=*/true)) {
-                        printLog("Already asked");
-                        continue;
-                    }
-                }
-                // Sleep a bit depending on the start offset to balance out multiple requests to same masternode
-                quorumThreadInterrupt.sleep_for(std::chrono::milliseconds(nMyStartOffset * 100));
-                nTimeLastSuccess = GetTime<std::chrono::seconds>().count();
-                connman.AddPendingMasternode(*pCurrentMemberHash);
-                printLog("Connect");
             }
+            // Sleep a bit depending on the start offset to balance out multiple requests to same masternode
+            quorumThreadInterrupt.sleep_for(std::chrono::milliseconds(nMyStartOffset * 100));
+            nTimeLastSuccess = GetTime<std::chrono::seconds>().count();
+            connman.AddPendingMasternode(*pCurrentMemberHash);
+            printLog("Connect");
+        }
 
-            auto proTxHash = WITH_LOCK(activeMasternodeInfoCs, return activeMasternodeInfo.proTxHash);
-            connman.ForEachNode([&](CNode* pNode) {
-                auto verifiedProRegTxHash = pNode->GetVerifiedProRegTxHash();
-                if (pCurrentMemberHash == nullptr || verifiedProRegTxHash != *pCurrentMemberHash) {
-                    return;
-                }
+        auto proTxHash = WITH_LOCK(activeMasternodeInfoCs, return activeMasternodeInfo.proTxHash);
+        connman.ForEachNode([&](CNode* pNode) {
+            auto verifiedProRegTxHash = pNode->GetVerifiedProRegTxHash();
+            if (pCurrentMemberHash == nullptr || verifiedProRegTxHash != *pCurrentMemberHash) {
+                return;
+            }
 
-                if (RequestQuorumData(pNode, pQuorum->qc->llmqType, pQuorum->m_quorum_base_block_index, nDataMask, proTxHash)) {
-                    nTimeLastSuccess = GetTime<std::chrono::seconds>().count();
-                    printLog("Requested");
+            if (RequestQuorumData(pNode, pQuorum->qc->llmqType, pQuorum->m_quorum_base_block_index, nDataMask, proTxHash)) {
+                nTimeLastSuccess = GetTime<std::chrono::seconds>().count();
+                printLog("Requested");
+            } else {
+                LOCK(cs_data_requests);
+                const CQuorumDataRequestKey key(*pCurrentMemberHash, true, pQuorum->qc->quorumHash, pQuorum->qc->llmqType);
+                auto it = mapQuorumDataRequests.find(key);
+                if (it == mapQuorumDataRequests.end()) {
+                    printLog("Failed");
+                    pNode->fDisconnect = true;
+                    pCurrentMemberHash = nullptr;
+                    return;
+                } else if (it->second.IsProcessed()) {
+                    printLog("Processed");
+                    pNode->fDisconnect = true;
+                    pCurrentMemberHash = nullptr;
+                    return;
                 } else {
-                    LOCK(cs_data_requests);
-                    const CQuorumDataRequestKey key(*pCurrentMemberHash, true, pQuorum->qc->quorumHash, pQuorum->qc->llmqType);
-                    auto it = mapQuorumDataRequests.find(key);
-                    if (it == mapQuorumDataRequests.end()) {
-                        printLog("Failed");
-                        pNode->fDisconnect = true;
-                        pCurrentMemberHash = nullptr;
-                        return;
-                    } else if (it->second.IsProcessed()) {
-                        printLog("Processed");
-                        pNode->fDisconnect = true;
-                        pCurrentMemberHash = nullptr;
-                        return;
-                    } else {
-                        printLog("Waiting");
-                        return;
-                    }
+                    printLog("Waiting");
+                    return;
                 }
-            });
-            quorumThreadInterrupt.sleep_for(std::chrono::seconds(1));
-        }
-        pQuorum->fQuorumDataRecoveryThreadRunning = false;
-        printLog("Done");
-    });
+            }
+        });
+        quorumThreadInterrupt.sleep_for(std::chrono::seconds(1));
+    }
+    (nDataMask == 0 ? g_data_recovery_success : g_data_recovery_failed).Add();
+    g_data_recovery_time.Observe(t.count<std::chrono::microseconds>());
+    pQuorum->fQuorumDataRecoveryThreadRunning = false;
+    printLog("Done");
 }
 
 static void DataCleanupHelper(CDBWrapper& db, std::set<uint256> skip_list, bool compact = false)
 {
-    const auto prefixes = {DB_QUORUM_QUORUM_VVEC, DB_QUORUM_SK_SHARE};
+    const auto prefixes = {DB_QUORUM_QUORUM_VVEC, DB_QUORUM_SK_SHARE, DB_QUORUM_PUBKEY_SHARES, DB_QUORUM_MEMBERS};
 
     CDBBatch batch(db);
     std::unique_ptr<CDBIterator> pcursor(db.NewIterator());
@@ -1073,10 +1285,12 @@ void CQuorumManager::StartCleanupOldQuorumDataThread(const CBlockIndex* pIndex)
             auto& cache = cleanupQuorumsCache[params.type];
             const CBlockIndex* pindex_loop{pIndex};
             std::set<uint256> quorum_keys;
+            std::set<uint256> members_keys;
             while (pindex_loop != nullptr && pIndex->nHeight - pindex_loop->nHeight < params.max_store_depth()) {
                 uint256 quorum_key;
                 if (cache.get(pindex_loop->GetBlockHash(), quorum_key)) {
                     quorum_keys.insert(quorum_key);
+                    members_keys.insert(MakeQuorumMembersKey(params.type, pindex_loop->GetBlockHash()));
                     if (quorum_keys.size() >= static_cast<size_t>(params.keepOldKeys)) break; // extra safety belt
                 }
                 pindex_loop = pindex_loop->pprev;
@@ -1084,9 +1298,11 @@ void CQuorumManager::StartCleanupOldQuorumDataThread(const CBlockIndex* pIndex)
             for (const auto& pQuorum : ScanQuorums(params.type, pIndex, params.keepOldKeys - quorum_keys.size())) {
                 const uint256 quorum_key = MakeQuorumKey(*pQuorum);
                 quorum_keys.insert(quorum_key);
+                members_keys.insert(MakeQuorumMembersKey(params.type, pQuorum->qc->quorumHash));
                 cache.insert(pQuorum->m_quorum_base_block_index->GetBlockHash(), quorum_key);
             }
             dbKeysToSkip.merge(quorum_keys);
+            dbKeysToSkip.merge(members_keys);
         }
 
         if (!quorumThreadInterrupt) {
@@ -1097,6 +1313,30 @@ void CQuorumManager::StartCleanupOldQuorumDataThread(const CBlockIndex* pIndex)
     });
 }
 
+void CQuorumManager::StartPrecomputeQuorumMembersThread(const CBlockIndex* pIndex) const
+{
+    if ((!fMasternodeMode && !IsWatchQuorumsEnabled()) || pIndex == nullptr) {
+        return;
+    }
+
+    for (const auto& params : Params().GetConsensus().llmqs) {
+        // A new DKG cycle starts with this block. Its members are needed by the DKG and for the quorum connections of
+        // all types right away, for rotated types this computes all quorums of the cycle at once
+        if (pIndex->nHeight % params.dkgInterval != 0) {
+            continue;
+        }
+        workerPool.push([llmqType = params.type, pIndex, this](int threadId) {
+            if (quorumThreadInterrupt) {
+                return;
+            }
+            cxxtimer::Timer t(/*start=*/ true);
+            const auto members = utils::GetAllQuorumMembers(llmqType, pIndex);
+            LogPrint(BCLog::LLMQ, "CQuorumManager::StartPrecomputeQuorumMembersThread -- llmqType[%d] nHeight[%d] %d members. time=%d\n",
+                     ToUnderlying(llmqType), pIndex->nHeight, members.size(), t.count());
+        });
+    }
+}
+
 CQuorumCPtr SelectQuorumForSigning(const Consensus::LLMQParams& llmq_params, const CQuorumManager& quorum_manager, const uint256& selectionHash, int signHeight, int signOffset)
 {
     size_t poolSize = llmq_params.signingActiveQuorumCount;
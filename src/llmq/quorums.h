@@ -19,6 +19,7 @@
 #include <gsl/pointers.h>
 
 #include <atomic>
+#include <deque>
 #include <map>
 
 class CBlockIndex;
@@ -183,6 +184,10 @@ private:
     // These are only valid when we either participated in the DKG or fully watched it
     BLSVerificationVectorPtr quorumVvec GUARDED_BY(cs);
     CBLSSecretKey skShare GUARDED_BY(cs);
+    // Public key shares of all members, indexed like members and invalid for invalid members. Null until the cache
+    // populator recovered all of them or they were loaded from disk, which spares us recovering them after a restart.
+    // Only ever set as a whole and accessed through std::atomic_load/std::atomic_store, so lookups don't need cs
+    mutable std::shared_ptr<const std::vector<CBLSPublicKey>> pubKeyShares;
 
 public:
     CQuorum(const Consensus::LLMQParams& _params, CBLSWorker& _blsWorker);
@@ -193,6 +198,7 @@ public:
     bool SetSecretKeyShare(const CBLSSecretKey& secretKeyShare);
 
     bool HasVerificationVector() const;
+    bool HasPubKeyShares() const;
     bool IsMember(const uint256& proTxHash) const;
     bool IsValidMember(const uint256& proTxHash) const;
     int GetMemberIndex(const uint256& proTxHash) const;
@@ -203,6 +209,9 @@ public:
 private:
     void WriteContributions(CEvoDB& evoDb) const;
     bool ReadContributions(CEvoDB& evoDb);
+    void SetPubKeyShares(std::vector<CBLSPublicKey>&& pubKeySharesIn) const;
+    void WritePubKeyShares(CEvoDB& evoDb) const;
+    bool ReadPubKeyShares(CEvoDB& evoDb);
 };
 
 /**
@@ -226,12 +235,33 @@ private:
     mutable std::map<Consensus::LLMQType, unordered_lru_cache<uint256, CQuorumPtr, StaticSaltedHasher>> mapQuorumsCache GUARDED_BY(cs_map_quorums);
     mutable RecursiveMutex cs_scan_quorums;
     mutable std::map<Consensus::LLMQType, unordered_lru_cache<uint256, std::vector<CQuorumCPtr>, StaticSaltedHasher>> scanQuorumsCache GUARDED_BY(cs_scan_quorums);
+
+    struct ScanQuorumsTip {
+        const CBlockIndex* pindexStore;
+        std::vector<CQuorumCPtr> quorums;
+    };
+    // The keepOldConnections most recent quorums at the chain tip by llmq type, built in UpdatedBlockTip. The map is
+    // filled in the constructor and its entries are only replaced as a whole through std::atomic_load/std::atomic_store,
+    // so ScanQuorums at the tip, which is what signing asks for, doesn't need cs_scan_quorums.
+    mutable std::map<Consensus::LLMQType, std::shared_ptr<const ScanQuorumsTip>> mapScanQuorumsTip;
     mutable Mutex cs_cleanup;
     mutable std::map<Consensus::LLMQType, unordered_lru_cache<uint256, uint256, StaticSaltedHasher>> cleanupQuorumsCache GUARDED_BY(cs_cleanup);
 
     mutable ctpl::thread_pool workerPool;
     mutable CThreadInterrupt quorumThreadInterrupt;
 
+    struct DataRecoveryTask {
+        CQuorumCPtr pQuorum;
+        const CBlockIndex* pIndex;
+        uint16_t nDataMask;
+    };
+    mutable Mutex cs_data_recovery;
+    // Recoveries waiting for a worker, the ones of quorums we are a member of are started first. Only up to half of
+    // the workers run them as they mostly wait for peers, the rest stays free for the cache populator and cleanups.
+    mutable std::deque<DataRecoveryTask> dataRecoveryMemberQueue GUARDED_BY(cs_data_recovery);
+    mutable std::deque<DataRecoveryTask> dataRecoveryWatchQueue GUARDED_BY(cs_data_recovery);
+    mutable size_t nDataRecoveryRunning GUARDED_BY(cs_data_recovery){0};
+
 public:
     CQuorumManager(CBLSWorker& _blsWorker, CChainState& chainstate, CConnman& _connman, CDKGSessionManager& _dkgManager,
                    CEvoDB& _evoDb, CQuorumBlockProcessor& _quorumBlockProcessor, const std::unique_ptr<CMasternodeSync>& mn_sync);
@@ -261,6 +291,8 @@ private:
     // all private methods here are cs_main-free
     void CheckQuorumConnections(const Consensus::LLMQParams& llmqParams, const CBlockIndex *pindexNew) const;
 
+    static const CBlockIndex* GetScanQuorumsStoreIndex(const Consensus::LLMQParams& llmq_params, gsl::not_null<const CBlockIndex*> pindexStart);
+
     CQuorumPtr BuildQuorumFromCommitment(Consensus::LLMQType llmqType, gsl::not_null<const CBlockIndex*> pQuorumBaseBlockIndex, bool populate_cache) const;
     bool BuildQuorumContributions(const CFinalCommitmentPtr& fqc, const std::shared_ptr<CQuorum>& quorum) const;
 
@@ -271,9 +303,12 @@ private:
     size_t GetQuorumRecoveryStartOffset(const CQuorumCPtr pQuorum, const CBlockIndex* pIndex) const;
 
     void StartCachePopulatorThread(const CQuorumCPtr pQuorum) const;
-    void StartQuorumDataRecoveryThread(const CQuorumCPtr pQuorum, const CBlockIndex* pIndex, uint16_t nDataMask) const;
+    void StartQuorumDataRecoveryThread(const CQuorumCPtr pQuorum, const CBlockIndex* pIndex, uint16_t nDataMask, bool fWeAreQuorumMember) const;
+    void ScheduleQuorumDataRecoveryThreads() const EXCLUSIVE_LOCKS_REQUIRED(cs_data_recovery);
+    void QuorumDataRecoveryThread(const CQuorumCPtr pQuorum, const CBlockIndex* pIndex, uint16_t nDataMaskIn) const;
 
     void StartCleanupOldQuorumDataThread(const CBlockIndex* pIndex) const;
+    void StartPrecomputeQuorumMembersThread(const CBlockIndex* pIndex) const;
 };
 
 extern std::unique_ptr<CQuorumManager> quorumManager;
@@ -10,7 +10,9 @@
 #include <llmq/signing_shares.h>
 
 #include <bls/bls_batchverifier.h>
+#include <bls/bls_worker.h>
 #include <chainparams.h>
+#include <crypto/siphash.h>
 #include <cxxtimer.hpp>
 #include <dbwrapper.h>
 #include <hash.h>
@@ -19,13 +21,18 @@
 #include <netmessagemaker.h>
 #include <scheduler.h>
 #include <streams.h>
+#include <util/fastrange.h>
 #include <util/irange.h>
+#include <util/perfcounters.h>
 #include <util/thread.h>
 #include <util/time.h>
 #include <util/underlying.h>
 #include <validation.h>
 
 #include <algorithm>
+#include <cmath>
+#include <limits>
+#include <optional>
 #include <unordered_set>
 
 namespace llmq
@@ -42,14 +49,203 @@ UniValue CRecoveredSig::ToJson() const
     return ret;
 }
 
+// False positive rate of CRecoveredSigsFilter as long as it isn't full
+static constexpr double RECSIGS_FILTER_FP_RATE = 0.001;
+// Every recovered sig adds 3 keys to the filter, always make room for at least this many
+static constexpr uint64_t RECSIGS_FILTER_MIN_CAPACITY = 3 * 100000;
+// Only there between a clean shutdown and the next start
+static const std::string DB_RECSIGS_FILTER = "rs_f";
+// Recovered sigs and votes expire in whole buckets of this many seconds. Cleanup then deletes and compacts one
+// contiguous range of the time index at once, instead of trickling out a few keys every few seconds
+static constexpr uint32_t RECSIGS_CLEANUP_BUCKET_SECONDS{60 * 60};
+
+// Everything written before this is expired
+static uint32_t GetCleanupEndTime(int64_t maxAge)
+{
+    uint32_t endTime = (uint32_t)(GetTime<std::chrono::seconds>().count() - maxAge);
+    return endTime - endTime % RECSIGS_CLEANUP_BUCKET_SECONDS;
+}
+
+static CRecoveredSigsFilter::Key MakeFilterKey(char prefix, Consensus::LLMQType llmqType, const uint256& hash)
+{
+    CRecoveredSigsFilter::Key key;
+    key[0] = uint8_t(prefix);
+    key[1] = uint8_t(llmqType);
+    std::copy(hash.begin(), hash.end(), key.begin() + 2);
+    return key;
+}
+
+static CRecoveredSigsFilter::Key FilterKeyForId(Consensus::LLMQType llmqType, const uint256& id)
+{
+    return MakeFilterKey('i', llmqType, id);
+}
+
+static CRecoveredSigsFilter::Key FilterKeyForSession(const uint256& signHash)
+{
+    return MakeFilterKey('s', Consensus::LLMQType::LLMQ_NONE, signHash);
+}
+
+static CRecoveredSigsFilter::Key FilterKeyForHash(const uint256& hash)
+{
+    return MakeFilterKey('h', Consensus::LLMQType::LLMQ_NONE, hash);
+}
+
+CRecoveredSigsFilter::CRecoveredSigsFilter(uint64_t nCapacityIn) :
+    nCapacity(nCapacityIn)
+{
+    if (nCapacity == 0) {
+        return;
+    }
+    const double logFpRate = std::log(RECSIGS_FILTER_FP_RATE);
+    nHashFuncs = std::max(1, int(std::round(logFpRate / std::log(0.5))));
+    // bit positions are 32 bit
+    const double nBits = std::min(std::ceil(-1.0 * nCapacity * logFpRate / (std::log(2.0) * std::log(2.0))), double(std::numeric_limits<uint32_t>::max()));
+    data.assign((uint64_t(nBits) + 63) / 64, 0);
+    k0 = GetRand(std::numeric_limits<uint64_t>::max());
+    k1 = GetRand(std::numeric_limits<uint64_t>::max());
+}
+
+void CRecoveredSigsFilter::insert(const Key& key)
+{
+    if (data.empty()) {
+        return;
+    }
+    // Double hashing, deriving all bit positions from the two halves of one SipHash
+    const uint64_t h = CSipHasher(k0, k1).Write(key.data(), key.size()).Finalize();
+    const uint32_t nBits = uint32_t(data.size() * 64);
+    for (uint32_t i = 0; i < nHashFuncs; i++) {
+        const uint32_t pos = FastRange32(uint32_t(h) + i * uint32_t(h >> 32), nBits);
+        data[pos >> 6] |= uint64_t{1} << (pos & 63);
+    }
+    nInserted++;
+}
+
+bool CRecoveredSigsFilter::contains(const Key& key) const
+{
+    if (data.empty()) {
+        // we know nothing
+        return true;
+    }
+    const uint64_t h = CSipHasher(k0, k1).Write(key.data(), key.size()).Finalize();
+    const uint32_t nBits = uint32_t(data.size() * 64);
+    for (uint32_t i = 0; i < nHashFuncs; i++) {
+        const uint32_t pos = FastRange32(uint32_t(h) + i * uint32_t(h >> 32), nBits);
+        if (!((data[pos >> 6] >> (pos & 63)) & 1)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool CRecoveredSigsFilter::IsValid() const
+{
+    return nCapacity > 0 && nHashFuncs > 0 && nHashFuncs <= 50 && !data.empty() && data.size() <= (uint64_t{1} << 26);
+}
 
 CRecoveredSigsDb::CRecoveredSigsDb(bool fMemory, bool fWipe) :
         db(std::make_unique<CDBWrapper>(fMemory ? "" : (GetDataDir() / "llmq/recsigdb"), 8 << 20, fMemory, fWipe))
 {
     MigrateRecoveredSigs();
+    LoadOrRebuildFilter();
+}
+
+CRecoveredSigsDb::~CRecoveredSigsDb()
+{
+    // Saves scanning the whole DB on the next start, which takes the filter out again right away
+    LOCK(cs);
+    if (!fRebuildingFilter) {
+        db->Write(DB_RECSIGS_FILTER, filter, true);
+    }
+}
+
+void CRecoveredSigsDb::LoadOrRebuildFilter()
+{
+    CRecoveredSigsFilter loaded;
+    if (db->Read(DB_RECSIGS_FILTER, loaded)) {
+        // Whatever gets written from now on isn't in there, so this must not be loaded again after a crash
+        db->Erase(DB_RECSIGS_FILTER, true);
+        if (loaded.IsValid() && !loaded.IsFull()) {
+            LOCK(cs);
+            filter = std::move(loaded);
+            return;
+        }
+    }
+    RebuildFilter();
+}
+
+void CRecoveredSigsDb::RebuildFilter()
+{
+    {
+        LOCK(cs);
+        if (fRebuildingFilter) {
+            return;
+        }
+        // from here on, new keys are also collected for the new filter
+        fRebuildingFilter = true;
+    }
+
+    // Calls f with the filter key of every id, session and hash in the DB
+    auto forEachKey = [this](auto&& f) {
+        std::unique_ptr<CDBIterator> pcursor(db->NewIterator());
+
+        // there are two keys per recovered sig with the id, (llmqType, id) and (llmqType, id, msgHash), next to each other
+        auto startId = std::make_tuple(std::string("rs_r"), (Consensus::LLMQType)0, uint256());
+        std::optional<CRecoveredSigsFilter::Key> lastIdKey;
+        pcursor->Seek(startId);
+        while (pcursor->Valid()) {
+            decltype(startId) k;
+            if (!pcursor->GetKey(k) || std::get<0>(k) != "rs_r") {
+                break;
+            }
+            auto key = FilterKeyForId(std::get<1>(k), std::get<2>(k));
+            if (key != lastIdKey) {
+                f(key);
+                lastIdKey = key;
+            }
+            pcursor->Next();
+        }
+
+        for (const auto& [prefix, makeKey] : {std::make_pair("rs_s", &FilterKeyForSession), std::make_pair("rs_h", &FilterKeyForHash)}) {
+            auto start = std::make_tuple(std::string(prefix), uint256());
+            pcursor->Seek(start);
+            while (pcursor->Valid()) {
+                decltype(start) k;
+                if (!pcursor->GetKey(k) || std::get<0>(k) != prefix) {
+                    break;
+                }
+                f(makeKey(std::get<1>(k)));
+                pcursor->Next();
+            }
+        }
+    };
+
+    cxxtimer::Timer t(true);
+
+    uint64_t nKeys{0};
+    forEachKey([&nKeys](const CRecoveredSigsFilter::Key&) { nKeys++; });
+    // twice the room, so that this isn't needed again too soon
+    CRecoveredSigsFilter newFilter(std::max(2 * nKeys, RECSIGS_FILTER_MIN_CAPACITY));
+    forEachKey([&newFilter](const CRecoveredSigsFilter::Key& key) { newFilter.insert(key); });
+
+    LOCK(cs);
+    for (const auto& key : filterRebuildKeys) {
+        newFilter.insert(key);
+    }
+    filterRebuildKeys.clear();
+    filter = std::move(newFilter);
+    fRebuildingFilter = false;
+
+    LogPrint(BCLog::LLMQ, "CRecoveredSigsDb::%s -- %d keys, time=%d\n", __func__, nKeys, t.count());
 }
 
-CRecoveredSigsDb::~CRecoveredSigsDb() = default;
+void CRecoveredSigsDb::AddToFilter(const CRecoveredSigsFilter::Key& key)
+{
+    AssertLockHeld(cs);
+    filter.insert(key);
+    if (fRebuildingFilter) {
+        filterRebuildKeys.emplace_back(key);
+    }
+}
 
 void CRecoveredSigsDb::MigrateRecoveredSigs()
 {
@@ -238,6 +434,10 @@ void CRecoveredSigsDb::MigrateRecoveredSigs()
 
 bool CRecoveredSigsDb::HasRecoveredSig(Consensus::LLMQType llmqType, const uint256& id, const uint256& msgHash) const
 {
+    if (!WITH_LOCK(cs, return filter.contains(FilterKeyForId(llmqType, id)))) {
+        return false;
+    }
+
     auto k = std::make_tuple(std::string("rs_r"), llmqType, id, msgHash);
     return db->Exists(k);
 }
@@ -248,6 +448,9 @@ bool CRecoveredSigsDb::HasRecoveredSigForId(Consensus::LLMQType llmqType, const
     bool ret;
     {
         LOCK(cs);
+        if (!filter.contains(FilterKeyForId(llmqType, id))) {
+            return false;
+        }
         if (hasSigForIdCache.get(cacheKey, ret)) {
             return ret;
         }
@@ -267,6 +470,9 @@ bool CRecoveredSigsDb::HasRecoveredSigForSession(const uint256& signHash) const
     bool ret;
     {
         LOCK(cs);
+        if (!filter.contains(FilterKeyForSession(signHash))) {
+            return false;
+        }
         if (hasSigForSessionCache.get(signHash, ret)) {
             return ret;
         }
@@ -285,6 +491,9 @@ bool CRecoveredSigsDb::HasRecoveredSigForHash(const uint256& hash) const
     bool ret;
     {
         LOCK(cs);
+        if (!filter.contains(FilterKeyForHash(hash))) {
+            return false;
+        }
         if (hasSigForHashCache.get(hash, ret)) {
             return ret;
         }
@@ -365,6 +574,9 @@ void CRecoveredSigsDb::WriteRecoveredSig(const llmq::CRecoveredSig& recSig)
         hasSigForIdCache.insert(std::make_pair(recSig.getLlmqType(), recSig.getId()), true);
         hasSigForSessionCache.insert(signHash, true);
         hasSigForHashCache.insert(recSig.GetHash(), true);
+        AddToFilter(FilterKeyForId(recSig.getLlmqType(), recSig.getId()));
+        AddToFilter(FilterKeyForSession(signHash));
+        AddToFilter(FilterKeyForHash(recSig.GetHash()));
     }
 }
 
@@ -420,10 +632,21 @@ void CRecoveredSigsDb::TruncateRecoveredSig(Consensus::LLMQType llmqType, const
 
 void CRecoveredSigsDb::CleanupOldRecoveredSigs(int64_t maxAge)
 {
+    // Deleted keys stay in the filter, so this also gets rid of them once enough keys went in since the last rebuild
+    if (WITH_LOCK(cs, return filter.IsFull())) {
+        RebuildFilter();
+    }
+
+    const uint32_t endTime = GetCleanupEndTime(maxAge);
+    if (endTime <= nRecSigsCleanupEndTime) {
+        // nothing new expired since the last run
+        return;
+    }
+    nRecSigsCleanupEndTime = endTime;
+
     std::unique_ptr<CDBIterator> pcursor(db->NewIterator());
 
     auto start = std::make_tuple(std::string("rs_t"), (uint32_t)0, (Consensus::LLMQType)0, uint256());
-    uint32_t endTime = (uint32_t)(GetTime<std::chrono::seconds>().count() - maxAge);
     pcursor->Seek(start);
 
     std::vector<std::pair<Consensus::LLMQType, uint256>> toDelete;
@@ -469,6 +692,9 @@ void CRecoveredSigsDb::CleanupOldRecoveredSigs(int64_t maxAge)
 
     db->WriteBatch(batch);
 
+    // The expired part of the time index is nothing but tombstones now, get rid of them right away
+    db->CompactRange(start, toDelete2.back());
+
     LogPrint(BCLog::LLMQ, "CRecoveredSigsDb::%d -- deleted %d entries\n", __func__, toDelete.size());
 }
 
@@ -498,14 +724,20 @@ void CRecoveredSigsDb::WriteVoteForId(Consensus::LLMQType llmqType, const uint25
 
 void CRecoveredSigsDb::CleanupOldVotes(int64_t maxAge)
 {
+    const uint32_t endTime = GetCleanupEndTime(maxAge);
+    if (endTime <= nVotesCleanupEndTime) {
+        return;
+    }
+    nVotesCleanupEndTime = endTime;
+
     std::unique_ptr<CDBIterator> pcursor(db->NewIterator());
 
     auto start = std::make_tuple(std::string("rs_vt"), (uint32_t)0, (Consensus::LLMQType)0, uint256());
-    uint32_t endTime = (uint32_t)(GetTime<std::chrono::seconds>().count() - maxAge);
     pcursor->Seek(start);
 
     CDBBatch batch(*db);
     size_t cnt = 0;
+    decltype(start) lastKey;
     while (pcursor->Valid()) {
         decltype(start) k;
 
@@ -521,6 +753,7 @@ void CRecoveredSigsDb::CleanupOldVotes(int64_t maxAge)
 
         batch.Erase(k);
         batch.Erase(std::make_tuple(std::string("rs_v"), llmqType, id));
+        lastKey = k;
 
         cnt++;
 
@@ -534,14 +767,16 @@ void CRecoveredSigsDb::CleanupOldVotes(int64_t maxAge)
 
     db->WriteBatch(batch);
 
+    db->CompactRange(start, lastKey);
+
     LogPrint(BCLog::LLMQ, "CRecoveredSigsDb::%d -- deleted %d entries\n", __func__, cnt);
 }
 
 //////////////////
 
-CSigningManager::CSigningManager(CConnman& _connman, const CQuorumManager& _qman,
+CSigningManager::CSigningManager(CConnman& _connman, const CQuorumManager& _qman, CBLSWorker& _blsWorker,
                                  bool fMemory, bool fWipe) :
-    db(fMemory, fWipe), connman(_connman), qman(_qman)
+    db(fMemory, fWipe), connman(_connman), qman(_qman), blsWorker(_blsWorker)
 {
 }
 
@@ -622,6 +857,7 @@ PeerMsgRet CSigningManager::ProcessMessageRecoveredSig(const CNode& pfrom, gsl::
     assert(m_peerman == peerman);
 
     pendingRecoveredSigs[pfrom.GetId()].emplace_back(recoveredSig);
+    workInterrupt.wakeup();
     return {};
 }
 
@@ -735,15 +971,23 @@ bool CSigningManager::ProcessPendingRecoveredSigs()
 
     ProcessPendingReconstructedRecoveredSigs();
 
-    const size_t nMaxBatchSize{32};
+    size_t nPending{0};
+    {
+        LOCK(cs);
+        for (const auto& p : pendingRecoveredSigs) {
+            nPending += p.second.size();
+        }
+    }
+    const size_t nMaxBatchSize{GetBatchVerifySize(nPending)};
     CollectPendingRecoveredSigsToVerify(nMaxBatchSize, recSigsByNode, quorums);
     if (recSigsByNode.empty()) {
         return false;
     }
 
-    // It's ok to perform insecure batched verification here as we verify against the quorum public keys, which are not
-    // craftable by individual entities, making the rogue public key attack impossible
-    CBLSBatchVerifier<NodeId, uint256> batchVerifier(false, false);
+    // The quorum public keys are not craftable by individual entities, but peers relay recovered sigs they didn't
+    // create and could make two of them invalid in a way that cancels out in an insecure batch. The randomized batch
+    // costs the same pairings, recovered sigs mostly have distinct hashes anyway
+    CBLSBatchVerifier<NodeId, uint256> batchVerifier(true, false, 0, &blsWorker);
 
     size_t verifyCount = 0;
     for (const auto& p : recSigsByNode) {
@@ -789,10 +1033,12 @@ bool CSigningManager::ProcessPendingRecoveredSigs()
         }
     }
 
-    return recSigsByNode.size() >= nMaxBatchSize;
+    return nPending > nMaxBatchSize;
 }
 
 // signature must be verified already
+static perf::Counter& g_recovered_sigs{perf::GetCounter("llmq.recsigs.accepted", "Recovered sigs which were new and got stored, whether recovered locally or received")};
+
 void CSigningManager::ProcessRecoveredSig(const std::shared_ptr<const CRecoveredSig>& recoveredSig)
 {
     auto llmqType = recoveredSig->getLlmqType();
@@ -834,8 +1080,11 @@ void CSigningManager::ProcessRecoveredSig(const std::shared_ptr<const CRecovered
         }
 
         db.WriteRecoveredSig(*recoveredSig);
+        g_recovered_sigs.Add();
 
         pendingReconstructedRecoveredSigs.erase(recoveredSig->GetHash());
+
+        stats.Record(llmqType, signHash, CSigningStats::Stage::Recovered);
     }
 
     if (fMasternodeMode) {
@@ -858,6 +1107,7 @@ void CSigningManager::PushReconstructedRecoveredSig(const std::shared_ptr<const
 {
     LOCK(cs);
     pendingReconstructedRecoveredSigs.emplace(std::piecewise_construct, std::forward_as_tuple(recoveredSig->GetHash()), std::forward_as_tuple(recoveredSig));
+    workInterrupt.wakeup();
 }
 
 void CSigningManager::TruncateRecoveredSig(Consensus::LLMQType llmqType, const uint256& id)
@@ -876,6 +1126,7 @@ void CSigningManager::Cleanup()
 
     db.CleanupOldRecoveredSigs(maxAge);
     db.CleanupOldVotes(maxAge);
+    stats.Cleanup(now);
 
     lastCleanupTime = GetTimeMillis();
 }
@@ -957,6 +1208,7 @@ bool CSigningManager::AsyncSignIfMember(Consensus::LLMQType llmqType, CSigShares
         // make us re-announce all known shares (other nodes might have run into a timeout)
         shareman.ForceReAnnouncement(quorum, llmqType, id, msgHash);
     }
+    stats.Record(llmqType, BuildSignHash(llmqType, quorum->qc->quorumHash, id, msgHash), CSigningStats::Stage::SignRequested);
     shareman.AsyncSign(quorum, id, msgHash);
 
     return true;
@@ -1040,7 +1292,7 @@ void CSigningManager::WorkThreadMain()
 
         Cleanup();
 
-        // TODO Wakeup when pending signing is needed?
+        // Incoming recovered sigs wake us up, the timeout is only there for the periodic cleanup
         if (!fMoreWork && !workInterrupt.sleep_for(std::chrono::milliseconds(100))) {
             return;
         }
@@ -1073,4 +1325,12 @@ bool IsQuorumActive(Consensus::LLMQType llmqType, const CQuorumManager& qman, co
     return ranges::any_of(quorums, [&quorumHash](const auto& q){ return q->qc->quorumHash == quorumHash; });
 }
 
+size_t GetBatchVerifySize(size_t pendingCount)
+{
+    // Take on a quarter of the backlog per round, which keeps rounds short enough to not starve newer signatures
+    static constexpr size_t MIN_BATCH_VERIFY_SIZE{32};
+    static constexpr size_t MAX_BATCH_VERIFY_SIZE{1024};
+    return std::clamp(pendingCount / 4, MIN_BATCH_VERIFY_SIZE, MAX_BATCH_VERIFY_SIZE);
+}
+
 } // namespace llmq
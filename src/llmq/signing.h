@@ -8,16 +8,20 @@
 #include <bls/bls.h>
 #include <consensus/params.h>
 #include <gsl/pointers.h>
+#include <llmq/signing_stats.h>
 #include <net_types.h>
 #include <random.h>
 #include <saltedhasher.h>
+#include <serialize.h>
 #include <sync.h>
 #include <threadinterrupt.h>
 #include <univalue.h>
 #include <unordered_lru_cache.h>
 
+#include <array>
 #include <unordered_map>
 
+class CBLSWorker;
 class CConnman;
 class CDataStream;
 class CDBBatch;
@@ -108,12 +112,57 @@ public:
     UniValue ToJson() const;
 };
 
+/**
+ * Bloom filter in front of the existence checks of CRecoveredSigsDb, so that lookups for things we don't have (which
+ * is what most inventory floods ask for) are answered without going to disk.
+ *
+ * Nothing is ever removed from it, removed keys merely turn into false positives which the DB lookup then sorts out.
+ * Once more keys went in than it was sized for, it should be rebuilt from the DB.
+ */
+class CRecoveredSigsFilter
+{
+public:
+    static constexpr size_t KEY_SIZE = 34;
+    using Key = std::array<unsigned char, KEY_SIZE>;
+
+    explicit CRecoveredSigsFilter(uint64_t nCapacityIn = 0);
+
+    void insert(const Key& key);
+    bool contains(const Key& key) const;
+
+    //! Whether this is a sane filter, which a deserialized one might not be
+    bool IsValid() const;
+    //! Whether more keys were inserted than the filter was sized for
+    bool IsFull() const { return nInserted > nCapacity; }
+
+    SERIALIZE_METHODS(CRecoveredSigsFilter, obj)
+    {
+        READWRITE(obj.nCapacity, obj.nInserted, obj.nHashFuncs, obj.k0, obj.k1, obj.data);
+    }
+
+private:
+    uint64_t nCapacity{0};
+    uint64_t nInserted{0};
+    uint32_t nHashFuncs{0};
+    uint64_t k0{0};
+    uint64_t k1{0};
+    std::vector<uint64_t> data;
+};
+
 class CRecoveredSigsDb
 {
 private:
     std::unique_ptr<CDBWrapper> db{nullptr};
 
     mutable RecursiveMutex cs;
+    // Keys that are written while the filter is rebuilt are collected and added to the new one when it's done
+    CRecoveredSigsFilter filter GUARDED_BY(cs);
+    bool fRebuildingFilter GUARDED_BY(cs){false};
+    std::vector<CRecoveredSigsFilter::Key> filterRebuildKeys GUARDED_BY(cs);
+
+    // Only used by the cleanup, which runs on a single thread
+    uint32_t nRecSigsCleanupEndTime{0};
+    uint32_t nVotesCleanupEndTime{0};
     mutable unordered_lru_cache<std::pair<Consensus::LLMQType, uint256>, bool, StaticSaltedHasher, 30000> hasSigForIdCache GUARDED_BY(cs);
     mutable unordered_lru_cache<uint256, bool, StaticSaltedHasher, 30000> hasSigForSessionCache GUARDED_BY(cs);
     mutable unordered_lru_cache<uint256, bool, StaticSaltedHasher, 30000> hasSigForHashCache GUARDED_BY(cs);
@@ -143,6 +192,10 @@ public:
 private:
     void MigrateRecoveredSigs();
 
+    void LoadOrRebuildFilter();
+    void RebuildFilter() LOCKS_EXCLUDED(cs);
+    void AddToFilter(const CRecoveredSigsFilter::Key& key) EXCLUSIVE_LOCKS_REQUIRED(cs);
+
     bool ReadRecoveredSig(Consensus::LLMQType llmqType, const uint256& id, CRecoveredSig& ret) const;
     void RemoveRecoveredSig(CDBBatch& batch, Consensus::LLMQType llmqType, const uint256& id, bool deleteHashKey, bool deleteTimeKey) EXCLUSIVE_LOCKS_REQUIRED(cs);
 };
@@ -163,6 +216,7 @@ private:
     CRecoveredSigsDb db;
     CConnman& connman;
     const CQuorumManager& qman;
+    CBLSWorker& blsWorker;
 
     std::atomic<PeerManager*> m_peerman{nullptr};
 
@@ -176,8 +230,10 @@ private:
 
     std::vector<CRecoveredSigsListener*> recoveredSigsListeners GUARDED_BY(cs);
 
+    CSigningStats stats;
+
 public:
-    CSigningManager(CConnman& _connman, const CQuorumManager& _qman, bool fMemory, bool fWipe);
+    CSigningManager(CConnman& _connman, const CQuorumManager& _qman, CBLSWorker& _blsWorker, bool fMemory, bool fWipe);
 
     bool AlreadyHave(const CInv& inv) const;
     bool GetRecoveredSigForGetData(const uint256& hash, CRecoveredSig& ret) const;
@@ -223,6 +279,9 @@ public:
 
     bool GetVoteForId(Consensus::LLMQType llmqType, const uint256& id, uint256& msgHashRet) const;
 
+    CSigningStats& GetStats() { return stats; }
+    const CSigningStats& GetStats() const { return stats; }
+
 private:
     std::thread workThread;
     CThreadInterrupt workInterrupt;
@@ -268,6 +327,13 @@ uint256 BuildSignHash(Consensus::LLMQType llmqType, const uint256& quorumHash, c
 
 bool IsQuorumActive(Consensus::LLMQType llmqType, const CQuorumManager& qman, const uint256& quorumHash);
 
+/**
+ * Number of unique sessions to collect for one round of batched signature verification, given how many signatures
+ * are waiting to be verified. The batch grows with the backlog so a busy node verifies fewer, bigger batches that
+ * are spread over the BLS worker threads, instead of falling further behind 32 signatures at a time.
+ */
+size_t GetBatchVerifySize(size_t pendingCount);
+
 } // namespace llmq
 
 #endif // BITCOIN_LLMQ_SIGNING_H
@@ -10,6 +10,7 @@
 #include <llmq/signing.h>
 
 #include <bls/bls_batchverifier.h>
+#include <bls/bls_worker.h>
 #include <chainparams.h>
 #include <evo/deterministicmns.h>
 #include <masternode/node.h>
@@ -19,6 +20,7 @@
 #include <util/irange.h>
 #include <util/thread.h>
 #include <util/time.h>
+#include <util/trace.h>
 #include <util/underlying.h>
 
 #include <cxxtimer.hpp>
@@ -86,7 +88,8 @@ void CSigSharesInv::SetAll(bool v)
     std::fill(inv.begin(), inv.end(), v);
 }
 
-std::string CBatchedSigShares::ToInvString() const
+template<typename T>
+static std::string BatchToInvString(const std::vector<std::pair<uint16_t, T>>& sigShares)
 {
     CSigSharesInv inv;
     // we use 400 here no matter what the real size is. We don't really care about that size as we just want to call ToString()
@@ -97,6 +100,16 @@ std::string CBatchedSigShares::ToInvString() const
     return inv.ToString();
 }
 
+std::string CBatchedSigShares::ToInvString() const
+{
+    return BatchToInvString(sigShares);
+}
+
+std::string CBatchedSigSharesToSend::ToInvString() const
+{
+    return BatchToInvString(sigShares);
+}
+
 static void InitSession(CSigSharesNodeState::Session& s, const uint256& signHash, CSigBase from)
 {
     const auto& llmq_params_opt = Params().GetLLMQ(from.getLlmqType());
@@ -324,6 +337,10 @@ bool CSigSharesManager::ProcessMessageSigSesAnn(const CNode& pfrom, const CSigSe
     session.recvSessionId = ann.getSessionId();
     session.quorum = quorum;
     nodeState.sessionByRecvId.try_emplace(ann.getSessionId(), &session);
+    // Sessions which are only announced (e.g. after we recovered the sig already) would otherwise stay in the node
+    // state until the peer disconnects. Receiving a share refreshes this, so Cleanup() expires them like any other
+    // session without new shares
+    timeSeenForSessions.try_emplace(session.signHash, GetTime<std::chrono::seconds>().count());
 
     return true;
 }
@@ -368,6 +385,8 @@ bool CSigSharesManager::ProcessMessageSigSharesInv(const CNode& pfrom, const CSi
     }
     session->announced.Merge(inv);
     session->knows.Merge(inv);
+    // we might want to request some of the announced shares
+    workInterrupt.wakeup();
     return true;
 }
 
@@ -398,6 +417,7 @@ bool CSigSharesManager::ProcessMessageGetSigShares(const CNode& pfrom, const CSi
     }
     session->requested.Merge(inv);
     session->knows.Merge(inv);
+    workInterrupt.wakeup();
     return true;
 }
 
@@ -412,46 +432,19 @@ bool CSigSharesManager::ProcessMessageBatchedSigShares(const CNode& pfrom, const
         return !ban;
     }
 
-    std::vector<CSigShare> sigSharesToProcess;
-    sigSharesToProcess.reserve(batchedSigShares.sigShares.size());
-
-    {
-        LOCK(cs);
-        auto& nodeState = nodeStates[pfrom.GetId()];
-
-        for (const auto& sigSharetmp : batchedSigShares.sigShares) {
-            CSigShare sigShare = RebuildSigShare(sessionInfo, sigSharetmp);
-            nodeState.requestedSigShares.Erase(sigShare.GetKey());
-
-            // TODO track invalid sig shares received for PoSe?
-            // It's important to only skip seen *valid* sig shares here. If a node sends us a
-            // batch of mostly valid sig shares with a single invalid one and thus batched
-            // verification fails, we'd skip the valid ones in the future if received from other nodes
-            if (sigShares.Has(sigShare.GetKey())) {
-                continue;
-            }
-
-            // TODO for PoSe, we should consider propagating shares even if we already have a recovered sig
-            if (sigman.HasRecoveredSigForId(sigShare.getLlmqType(), sigShare.getId())) {
-                continue;
-            }
-
-            sigSharesToProcess.emplace_back(sigShare);
-        }
-    }
-
-    LogPrint(BCLog::LLMQ_SIGS, "CSigSharesManager::%s -- signHash=%s, shares=%d, new=%d, inv={%s}, node=%d\n", __func__,
-             sessionInfo.signHash.ToString(), batchedSigShares.sigShares.size(), sigSharesToProcess.size(), batchedSigShares.ToInvString(), pfrom.GetId());
+    LogPrint(BCLog::LLMQ_SIGS, "CSigSharesManager::%s -- signHash=%s, shares=%d, inv={%s}, node=%d\n", __func__,
+             sessionInfo.signHash.ToString(), batchedSigShares.sigShares.size(), batchedSigShares.ToInvString(), pfrom.GetId());
+    TRACE4(llmq, sigshares_received,
+        sessionInfo.signHash.data(),
+        ToUnderlying(sessionInfo.llmqType),
+        batchedSigShares.sigShares.size(),
+        pfrom.GetId());
 
-    if (sigSharesToProcess.empty()) {
-        return true;
-    }
-
-    LOCK(cs);
-    auto& nodeState = nodeStates[pfrom.GetId()];
-    for (const auto& s : sigSharesToProcess) {
-        nodeState.pendingIncomingSigShares.Add(s.GetKey(), s);
+    // Duplicates are filtered out by ProcessIncomingSigShares
+    for (const auto& sigSharetmp : batchedSigShares.sigShares) {
+        incomingSigShares.Push({pfrom.GetId(), RebuildSigShare(sessionInfo, sigSharetmp)});
     }
+    workInterrupt.wakeup();
     return true;
 }
 
@@ -487,20 +480,13 @@ void CSigSharesManager::ProcessMessageSigShare(NodeId fromId, const CSigShare& s
         return;
     }
 
-    {
-        LOCK(cs);
-
-        if (sigShares.Has(sigShare.GetKey())) {
-            return;
-        }
-
-        if (sigman.HasRecoveredSigForId(sigShare.getLlmqType(), sigShare.getId())) {
-            return;
-        }
-
-        auto& nodeState = nodeStates[fromId];
-        nodeState.pendingIncomingSigShares.Add(sigShare.GetKey(), sigShare);
-    }
+    incomingSigShares.Push({fromId, sigShare});
+    workInterrupt.wakeup();
+    TRACE4(llmq, sigshares_received,
+        sigShare.GetSignHash().data(),
+        ToUnderlying(sigShare.getLlmqType()),
+        1,
+        fromId);
 
     LogPrint(BCLog::LLMQ_SIGS, "CSigSharesManager::%s -- signHash=%s, id=%s, msgHash=%s, member=%d, node=%d\n", __func__,
              sigShare.GetSignHash().ToString(), sigShare.getId().ToString(), sigShare.getMsgHash().ToString(), sigShare.getQuorumMember(), fromId);
@@ -547,6 +533,47 @@ bool CSigSharesManager::PreVerifyBatchedSigShares(const CQuorumManager& quorum_m
     return true;
 }
 
+void CSigSharesManager::ProcessIncomingSigShares()
+{
+    auto incoming = incomingSigShares.PopAll();
+    if (incoming.empty()) {
+        return;
+    }
+
+    // Shares of one session mostly arrive together, so only look up each recovered sig once
+    std::unordered_map<std::pair<Consensus::LLMQType, uint256>, bool, StaticSaltedHasher> hasRecoveredSig;
+    size_t added = 0;
+
+    LOCK(cs);
+    for (const auto& [nodeId, sigShare] : incoming) {
+        auto& nodeState = nodeStates[nodeId];
+        nodeState.requestedSigShares.Erase(sigShare.GetKey());
+
+        // TODO track invalid sig shares received for PoSe?
+        // It's important to only skip seen *valid* sig shares here. If a node sends us a
+        // batch of mostly valid sig shares with a single invalid one and thus batched
+        // verification fails, we'd skip the valid ones in the future if received from other nodes
+        if (sigShares.Has(sigShare.GetKey())) {
+            continue;
+        }
+
+        // TODO for PoSe, we should consider propagating shares even if we already have a recovered sig
+        auto [it, inserted] = hasRecoveredSig.try_emplace(std::make_pair(sigShare.getLlmqType(), sigShare.getId()));
+        if (inserted) {
+            it->second = sigman.HasRecoveredSigForId(sigShare.getLlmqType(), sigShare.getId());
+        }
+        if (it->second) {
+            continue;
+        }
+
+        if (nodeState.pendingIncomingSigShares.Add(sigShare.GetKey(), sigShare)) {
+            added++;
+        }
+    }
+
+    LogPrint(BCLog::LLMQ_SIGS, "CSigSharesManager::%s -- shares=%d, new=%d\n", __func__, incoming.size(), added);
+}
+
 void CSigSharesManager::CollectPendingSigSharesToVerify(
         size_t maxUniqueSessions,
         std::unordered_map<NodeId, std::vector<CSigShare>>& retSigShares,
@@ -610,15 +637,24 @@ bool CSigSharesManager::ProcessPendingSigShares(const CConnman& connman)
     std::unordered_map<NodeId, std::vector<CSigShare>> sigSharesByNodes;
     std::unordered_map<std::pair<Consensus::LLMQType, uint256>, CQuorumCPtr, StaticSaltedHasher> quorums;
 
-    const size_t nMaxBatchSize{32};
+    size_t nPending{0};
+    {
+        LOCK(cs);
+        for (const auto& [_, ns] : nodeStates) {
+            nPending += ns.pendingIncomingSigShares.Size();
+        }
+    }
+    const size_t nMaxBatchSize{GetBatchVerifySize(nPending)};
     CollectPendingSigSharesToVerify(nMaxBatchSize, sigSharesByNodes, quorums);
     if (sigSharesByNodes.empty()) {
         return false;
     }
 
     // It's ok to perform insecure batched verification here as we verify against the quorum public key shares,
-    // which are not craftable by individual entities, making the rogue public key attack impossible
-    CBLSBatchVerifier<NodeId, SigShareKey> batchVerifier(false, true);
+    // which are not craftable by individual entities, making the rogue public key attack impossible. Many shares
+    // sign the same hash, so the random weights of a secure batch would cost more than the pairings they share, and
+    // shares which only pass together are caught when the recovered sig is verified
+    CBLSBatchVerifier<NodeId, SigShareKey> batchVerifier(false, true, 0, &blsWorker);
 
     cxxtimer::Timer prepareTimer(true);
     size_t verifyCount = 0;
@@ -657,6 +693,13 @@ bool CSigSharesManager::ProcessPendingSigShares(const CConnman& connman)
     verifyTimer.stop();
 
     LogPrint(BCLog::LLMQ_SIGS, "CSigSharesManager::%s -- verified sig shares. count=%d, pt=%d, vt=%d, nodes=%d\n", __func__, verifyCount, prepareTimer.count(), verifyTimer.count(), sigSharesByNodes.size());
+    TRACE6(llmq, sigshares_verified,
+        verifyCount,
+        sigSharesByNodes.size(),
+        batchVerifier.badSources.size(),
+        nPending,
+        prepareTimer.count<std::chrono::microseconds>(),
+        verifyTimer.count<std::chrono::microseconds>());
 
     for (const auto& [nodeId, v] : sigSharesByNodes) {
         if (batchVerifier.badSources.count(nodeId) != 0) {
@@ -670,7 +713,7 @@ bool CSigSharesManager::ProcessPendingSigShares(const CConnman& connman)
         ProcessPendingSigShares(v, quorums, connman);
     }
 
-    return sigSharesByNodes.size() >= nMaxBatchSize;
+    return nPending > nMaxBatchSize;
 }
 
 // It's ensured that no duplicates are passed to this method
@@ -718,6 +761,7 @@ void CSigSharesManager::ProcessSigShare(const CSigShare& sigShare, const CConnma
 
         // Update the time we've seen the last sigShare
         timeSeenForSessions[sigShare.GetSignHash()] = GetTime<std::chrono::seconds>().count();
+        sigman.GetStats().Record(llmqType, sigShare.GetSignHash(), CSigningStats::Stage::FirstShareSeen);
 
         if (!quorumNodes.empty()) {
             // don't announce and wait for other nodes to request this share and directly send it to them
@@ -771,12 +815,22 @@ void CSigSharesManager::TryRecoverSig(const CQuorumCPtr& quorum, const uint256&
         if (sigSharesForRecovery.size() < size_t(quorum->params.threshold)) {
             return;
         }
+        sigman.GetStats().Record(quorum->params.type, signHash, CSigningStats::Stage::RecoveryStarted);
     }
 
     // now recover it
     cxxtimer::Timer t(true);
     CBLSSignature recoveredSig;
-    if (!recoveredSig.Recover(sigSharesForRecovery, idsForRecovery)) {
+    const bool recovered = blsWorker.RecoverSig(sigSharesForRecovery, idsForRecovery, recoveredSig);
+    TRACE7(llmq, sig_recovered,
+        ToUnderlying(quorum->params.type),
+        quorum->qc->quorumHash.data(),
+        id.data(),
+        msgHash.data(),
+        sigSharesForRecovery.size(),
+        recovered,
+        t.count<std::chrono::microseconds>());
+    if (!recovered) {
         LogPrint(BCLog::LLMQ_SIGS, "CSigSharesManager::%s -- failed to recover signature. id=%s, msgHash=%s, time=%d\n", __func__,
                   id.ToString(), msgHash.ToString(), t.count());
         return;
@@ -916,7 +970,8 @@ void CSigSharesManager::CollectSigSharesToRequest(std::unordered_map<NodeId, std
     }
 }
 
-void CSigSharesManager::CollectSigSharesToSend(std::unordered_map<NodeId, std::unordered_map<uint256, CBatchedSigShares, StaticSaltedHasher>>& sigSharesToSend)
+void CSigSharesManager::CollectSigSharesToSend(std::unordered_map<NodeId, std::unordered_map<uint256, CBatchedSigSharesToSend, StaticSaltedHasher>>& sigSharesToSend,
+                                               SerializedSigShares& serializedSigShares)
 {
     AssertLockHeld(cs);
 
@@ -936,7 +991,7 @@ void CSigSharesManager::CollectSigSharesToSend(std::unordered_map<NodeId, std::u
                 continue;
             }
 
-            CBatchedSigShares batchedSigShares;
+            CBatchedSigSharesToSend batchedSigShares;
 
             for (const auto i : irange::range(session.requested.inv.size())) {
                 if (!session.requested.inv[i]) {
@@ -952,7 +1007,12 @@ void CSigSharesManager::CollectSigSharesToSend(std::unordered_map<NodeId, std::u
                     continue;
                 }
 
-                batchedSigShares.sigShares.emplace_back((uint16_t)i, sigShare->sigShare);
+                // the same share is usually requested by several peers
+                auto [it, inserted] = serializedSigShares.try_emplace(k);
+                if (inserted) {
+                    CVectorWriter(SER_NETWORK, PROTOCOL_VERSION, it->second, 0, (uint16_t)i, sigShare->sigShare);
+                }
+                batchedSigShares.sigShares.emplace_back((uint16_t)i, &it->second);
             }
 
             if (!batchedSigShares.sigShares.empty()) {
@@ -1068,10 +1128,12 @@ void CSigSharesManager::CollectSigSharesToAnnounce(std::unordered_map<NodeId, st
 bool CSigSharesManager::SendMessages()
 {
     std::unordered_map<NodeId, std::unordered_map<uint256, CSigSharesInv, StaticSaltedHasher>> sigSharesToRequest;
-    std::unordered_map<NodeId, std::unordered_map<uint256, CBatchedSigShares, StaticSaltedHasher>> sigShareBatchesToSend;
+    std::unordered_map<NodeId, std::unordered_map<uint256, CBatchedSigSharesToSend, StaticSaltedHasher>> sigShareBatchesToSend;
+    SerializedSigShares serializedSigShares;
     std::unordered_map<NodeId, std::vector<CSigShare>> sigSharesToSend;
     std::unordered_map<NodeId, std::unordered_map<uint256, CSigSharesInv, StaticSaltedHasher>> sigSharesToAnnounce;
     std::unordered_map<NodeId, std::vector<CSigSesAnn>> sigSessionAnnouncements;
+    std::unordered_map<uint256, Consensus::LLMQType, StaticSaltedHasher> relayedSessions;
 
     auto addSigSesAnnIfNeeded = [&](NodeId nodeId, const uint256& signHash) {
         AssertLockHeld(cs);
@@ -1094,7 +1156,7 @@ bool CSigSharesManager::SendMessages()
     {
         LOCK(cs);
         CollectSigSharesToRequest(sigSharesToRequest);
-        CollectSigSharesToSend(sigShareBatchesToSend);
+        CollectSigSharesToSend(sigShareBatchesToSend, serializedSigShares);
         CollectSigSharesToAnnounce(sigSharesToAnnounce);
         CollectSigSharesToSendConcentrated(sigSharesToSend, vNodesCopy);
 
@@ -1106,11 +1168,18 @@ bool CSigSharesManager::SendMessages()
         for (auto& [nodeId, sigShareBatchesMap] : sigShareBatchesToSend) {
             for (auto& [hash, sigShareBatch] : sigShareBatchesMap) {
                 sigShareBatch.sessionId = addSigSesAnnIfNeeded(nodeId, hash);
+                relayedSessions.try_emplace(hash, nodeStates[nodeId].GetSessionBySignHash(hash)->llmqType);
             }
         }
         for (auto& [nodeId, sigShareMap] : sigSharesToAnnounce) {
             for (auto& [hash, sigShareInv] : sigShareMap) {
                 sigShareInv.sessionId = addSigSesAnnIfNeeded(nodeId, hash);
+                relayedSessions.try_emplace(hash, nodeStates[nodeId].GetSessionBySignHash(hash)->llmqType);
+            }
+        }
+        for (const auto& [_, sigShares] : sigSharesToSend) {
+            for (const auto& sigShare : sigShares) {
+                relayedSessions.try_emplace(sigShare.GetSignHash(), sigShare.getLlmqType());
             }
         }
     }
@@ -1160,7 +1229,7 @@ bool CSigSharesManager::SendMessages()
 
         if (const auto jt = sigShareBatchesToSend.find(pnode->GetId()); jt != sigShareBatchesToSend.end()) {
             size_t totalSigsCount = 0;
-            std::vector<CBatchedSigShares> msgs;
+            std::vector<CBatchedSigSharesToSend> msgs;
             for (const auto& [signHash, inv] : jt->second) {
                 assert(!inv.sigShares.empty());
                 LogPrint(BCLog::LLMQ_SIGS, "CSigSharesManager::SendMessages -- QBSIGSHARES signHash=%s, inv={%s}, node=%d\n",
@@ -1222,6 +1291,11 @@ bool CSigSharesManager::SendMessages()
     // looped through all nodes, release them
     connman.ReleaseNodeVector(vNodesCopy);
 
+    auto& stats = sigman.GetStats();
+    for (const auto& [signHash, llmqType] : relayedSessions) {
+        stats.Record(llmqType, signHash, CSigningStats::Stage::SharesRelayed);
+    }
+
     return didSend;
 }
 
@@ -1254,7 +1328,8 @@ void CSigSharesManager::Cleanup()
 
     {
         LOCK(cs);
-        sigShares.ForEach([&quorums](const SigShareKey&, const CSigShare& sigShare) {
+        sigShares.ForEachSignHash([&quorums](const uint256&, const SigShareMemberMap<CSigShare>& m) {
+            const auto& sigShare = m.begin()->second;
             quorums.try_emplace(std::make_pair(sigShare.getLlmqType(), sigShare.getQuorumHash()), nullptr);
         });
     }
@@ -1273,9 +1348,10 @@ void CSigSharesManager::Cleanup()
         // Now delete sessions which are for inactive quorums
         LOCK(cs);
         std::unordered_set<uint256, StaticSaltedHasher> inactiveQuorumSessions;
-        sigShares.ForEach([&quorums, &inactiveQuorumSessions](const SigShareKey&, const CSigShare& sigShare) {
+        sigShares.ForEachSignHash([&quorums, &inactiveQuorumSessions](const uint256& signHash, const SigShareMemberMap<CSigShare>& m) {
+            const auto& sigShare = m.begin()->second;
             if (quorums.count(std::make_pair(sigShare.getLlmqType(), sigShare.getQuorumHash())) == 0) {
-                inactiveQuorumSessions.emplace(sigShare.GetSignHash());
+                inactiveQuorumSessions.emplace(signHash);
             }
         });
         for (const auto& signHash : inactiveQuorumSessions) {
@@ -1288,12 +1364,9 @@ void CSigSharesManager::Cleanup()
 
         // Remove sessions which were successfully recovered
         std::unordered_set<uint256, StaticSaltedHasher> doneSessions;
-        sigShares.ForEach([&doneSessions, this](const SigShareKey&, const CSigShare& sigShare) {
-            if (doneSessions.count(sigShare.GetSignHash()) != 0) {
-                return;
-            }
-            if (sigman.HasRecoveredSigForSession(sigShare.GetSignHash())) {
-                doneSessions.emplace(sigShare.GetSignHash());
+        sigShares.ForEachSignHash([&doneSessions, this](const uint256& signHash, const SigShareMemberMap<CSigShare>&) {
+            if (sigman.HasRecoveredSigForSession(signHash)) {
+                doneSessions.emplace(signHash);
             }
         });
         for (const auto& signHash : doneSessions) {
@@ -1435,18 +1508,20 @@ void CSigSharesManager::WorkThreadMain()
 
     while (!workInterrupt) {
         RemoveBannedNodeStates();
+        ProcessIncomingSigShares();
 
         bool fMoreWork = ProcessPendingSigShares(connman);
         SignPendingSigShares();
 
-        if (GetTimeMillis() - lastSendTime > 100) {
+        // Send right away once caught up, but not after every single round while working off a backlog
+        if (!fMoreWork || GetTimeMillis() - lastSendTime > 100) {
             SendMessages();
             lastSendTime = GetTimeMillis();
         }
 
         Cleanup();
 
-        // TODO Wakeup when pending signing is needed?
+        // New shares, requests and signing jobs wake us up, the timeout is only there for retries and cleanup
         if (!fMoreWork && !workInterrupt.sleep_for(std::chrono::milliseconds(100))) {
             return;
         }
@@ -1457,6 +1532,7 @@ void CSigSharesManager::AsyncSign(const CQuorumCPtr& quorum, const uint256& id,
 {
     LOCK(cs);
     pendingSigns.emplace_back(quorum, id, msgHash);
+    workInterrupt.wakeup();
 }
 
 void CSigSharesManager::SignPendingSigShares()
@@ -1467,11 +1543,39 @@ void CSigSharesManager::SignPendingSigShares()
         v = std::move(pendingSigns);
     }
 
+    // Signing bursts of a ChainLock or an InstantSend wave mostly hit the same few quorums, the shares of each quorum
+    // are signed together on the BLS workers
+    std::vector<std::optional<CSigShare>> sigShares;
+    std::map<const CQuorum*, std::vector<size_t>> byQuorum;
+    sigShares.reserve(v.size());
     for (const auto& [pQuorum, id, msgHash] : v) {
-        auto opt_sigShare = CreateSigShare(pQuorum, id, msgHash);
+        sigShares.emplace_back(PrepareSigShare(pQuorum, id, msgHash));
+        if (sigShares.back().has_value()) {
+            byQuorum[pQuorum.get()].emplace_back(sigShares.size() - 1);
+        }
+    }
+    for (const auto& [quorum, idxs] : byQuorum) {
+        cxxtimer::Timer t(true);
+        std::vector<uint256> signHashes;
+        signHashes.reserve(idxs.size());
+        for (const size_t idx : idxs) {
+            signHashes.emplace_back(sigShares[idx]->GetSignHash());
+        }
+        const auto sigs = blsWorker.SignBatch(quorum->GetSkShare(), signHashes);
+        for (size_t i = 0; i < idxs.size(); i++) {
+            if (!FinishSigShare(*quorum, *sigShares[idxs[i]], sigs[i], t)) {
+                sigShares[idxs[i]].reset();
+            }
+        }
+    }
+
+    for (size_t i = 0; i < v.size(); i++) {
+        const auto& pQuorum = v[i].quorum;
+        const auto& opt_sigShare = sigShares[i];
 
         if (opt_sigShare.has_value() && opt_sigShare->sigShare.Get().IsValid()) {
             auto sigShare = *opt_sigShare;
+            sigman.GetStats().Record(sigShare.getLlmqType(), sigShare.GetSignHash(), CSigningStats::Stage::ShareCreated);
             ProcessSigShare(sigShare, connman, pQuorum);
 
             if (IsAllMembersConnectedEnabled(pQuorum->params.type)) {
@@ -1489,6 +1593,15 @@ void CSigSharesManager::SignPendingSigShares()
 std::optional<CSigShare> CSigSharesManager::CreateSigShare(const CQuorumCPtr& quorum, const uint256& id, const uint256& msgHash) const
 {
     cxxtimer::Timer t(true);
+    auto sigShare = PrepareSigShare(quorum, id, msgHash);
+    if (!sigShare.has_value() || !FinishSigShare(*quorum, *sigShare, quorum->GetSkShare().Sign(sigShare->GetSignHash()), t)) {
+        return std::nullopt;
+    }
+    return sigShare;
+}
+
+std::optional<CSigShare> CSigSharesManager::PrepareSigShare(const CQuorumCPtr& quorum, const uint256& id, const uint256& msgHash) const
+{
     auto activeMasterNodeProTxHash = WITH_LOCK(activeMasternodeInfoCs, return activeMasternodeInfo.proTxHash);
 
     if (!quorum->IsValidMember(activeMasterNodeProTxHash)) {
@@ -1508,21 +1621,24 @@ std::optional<CSigShare> CSigSharesManager::CreateSigShare(const CQuorumCPtr& qu
     }
 
     CSigShare sigShare(quorum->params.type, quorum->qc->quorumHash, id, msgHash, uint16_t(memberIdx), {});
-    uint256 signHash = sigShare.buildSignHash();
+    sigShare.UpdateKey();
+    return sigShare;
+}
+
+bool CSigSharesManager::FinishSigShare(const CQuorum& quorum, CSigShare& sigShare, const CBLSSignature& sig, const cxxtimer::Timer& t) const
+{
+    const uint256& signHash = sigShare.GetSignHash();
 
-    sigShare.sigShare.Set(skShare.Sign(signHash), bls::bls_legacy_scheme.load());
+    sigShare.sigShare.Set(sig, bls::bls_legacy_scheme.load());
     if (!sigShare.sigShare.Get().IsValid()) {
         LogPrintf("CSigSharesManager::%s -- failed to sign sigShare. signHash=%s, id=%s, msgHash=%s, time=%s\n", __func__,
                   signHash.ToString(), sigShare.getId().ToString(), sigShare.getMsgHash().ToString(), t.count());
-        return std::nullopt;
+        return false;
     }
 
-    sigShare.UpdateKey();
-
     LogPrint(BCLog::LLMQ_SIGS, "CSigSharesManager::%s -- created sigShare. signHash=%s, id=%s, msgHash=%s, llmqType=%d, quorum=%s, time=%s\n", __func__,
-              signHash.ToString(), sigShare.getId().ToString(), sigShare.getMsgHash().ToString(), ToUnderlying(quorum->params.type), quorum->qc->quorumHash.ToString(), t.count());
-
-    return sigShare;
+              signHash.ToString(), sigShare.getId().ToString(), sigShare.getMsgHash().ToString(), ToUnderlying(quorum.params.type), quorum.qc->quorumHash.ToString(), t.count());
+    return true;
 }
 
 // causes all known sigShares to be re-announced
@@ -14,12 +14,14 @@
 #include <threadinterrupt.h>
 #include <sync.h>
 #include <uint256.h>
+#include <util/mpsc_queue.h>
 
 #include <atomic>
 #include <optional>
 #include <thread>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 class CDeterministicMN;
 class CEvoDB;
@@ -27,6 +29,10 @@ class CScheduler;
 class CSporkManager;
 class PeerManager;
 
+namespace cxxtimer {
+class Timer;
+} // namespace cxxtimer
+
 using CDeterministicMNCPtr = std::shared_ptr<const CDeterministicMN>;
 
 namespace llmq
@@ -149,26 +155,141 @@ public:
     [[nodiscard]] std::string ToInvString() const;
 };
 
+// Serialized member index and signature of sig shares, each serialized only once however many peers it is sent to
+using SerializedSigShares = std::unordered_map<SigShareKey, std::vector<uint8_t>, StaticSaltedHasher>;
+
+// The sending side of CBatchedSigShares. It only references the serialized sig shares and writes exactly what a
+// CBatchedSigShares holding the same shares would
+class CBatchedSigSharesToSend
+{
+public:
+    uint32_t sessionId{UNINITIALIZED_SESSION_ID};
+    std::vector<std::pair<uint16_t, const std::vector<uint8_t>*>> sigShares;
+
+public:
+    template<typename Stream>
+    void Serialize(Stream& s) const
+    {
+        s << VARINT(sessionId);
+        WriteCompactSize(s, sigShares.size());
+        for (const auto& [_, serialized] : sigShares) {
+            s.write(MakeByteSpan(*serialized));
+        }
+    }
+
+    [[nodiscard]] std::string ToInvString() const;
+};
+
+// Entries of one signing session by quorum member. They are kept in one contiguous array, plus an array indexed by
+// quorum member holding the position of each member's entry, so a lookup is two array accesses and adding an entry
+// usually doesn't allocate at all
+template<typename T>
+class SigShareMemberMap
+{
+public:
+    using value_type = std::pair<uint16_t, T>;
+    using const_iterator = typename std::vector<value_type>::const_iterator;
+
+private:
+    static constexpr uint16_t NO_ENTRY{std::numeric_limits<uint16_t>::max()};
+
+    std::vector<value_type> entries;
+    std::vector<uint16_t> positions;
+
+public:
+    const_iterator begin() const { return entries.begin(); }
+    const_iterator end() const { return entries.end(); }
+    [[nodiscard]] size_t size() const { return entries.size(); }
+    [[nodiscard]] bool empty() const { return entries.empty(); }
+
+    [[nodiscard]] size_t count(uint16_t member) const
+    {
+        return member < positions.size() && positions[member] != NO_ENTRY ? 1 : 0;
+    }
+
+    T* find(uint16_t member)
+    {
+        return count(member) ? &entries[positions[member]].second : nullptr;
+    }
+
+    bool emplace(uint16_t member, const T& v)
+    {
+        if (member >= positions.size()) {
+            positions.resize(size_t(member) + 1, NO_ENTRY);
+        } else if (positions[member] != NO_ENTRY) {
+            return false;
+        }
+        assert(entries.size() < NO_ENTRY);
+        positions[member] = uint16_t(entries.size());
+        entries.emplace_back(member, v);
+        return true;
+    }
+
+    void erase(uint16_t member)
+    {
+        if (!count(member)) {
+            return;
+        }
+        // Move the last entry into the gap, which keeps the array dense
+        const uint16_t pos = positions[member];
+        positions[member] = NO_ENTRY;
+        if (size_t(pos) + 1 != entries.size()) {
+            entries[pos] = std::move(entries.back());
+            positions[entries[pos].first] = pos;
+        }
+        entries.pop_back();
+    }
+
+    template<typename F>
+    void EraseIf(const uint256& signHash, F&& f)
+    {
+        SigShareKey k;
+        k.first = signHash;
+        for (size_t i = 0; i < entries.size(); ) {
+            k.second = entries[i].first;
+            if (f(k, entries[i].second)) {
+                // erase() moves a not yet visited entry to i
+                erase(k.second);
+            } else {
+                ++i;
+            }
+        }
+    }
+
+    template<typename F>
+    void ForEach(const uint256& signHash, F&& f)
+    {
+        SigShareKey k;
+        k.first = signHash;
+        for (auto& [member, v] : entries) {
+            k.second = member;
+            f(k, v);
+        }
+    }
+};
+
 template<typename T>
 class SigShareMap
 {
 private:
-    std::unordered_map<uint256, std::unordered_map<uint16_t, T>, StaticSaltedHasher> internalMap;
+    std::unordered_map<uint256, SigShareMemberMap<T>, StaticSaltedHasher> internalMap;
 
 public:
     bool Add(const SigShareKey& k, const T& v)
     {
         auto& m = internalMap[k.first];
-        return m.emplace(k.second, v).second;
+        return m.emplace(k.second, v);
     }
 
     void Erase(const SigShareKey& k)
     {
+        // k might point into the entry which is about to be overwritten
+        const uint16_t member = k.second;
         auto it = internalMap.find(k.first);
         if (it == internalMap.end()) {
             return;
         }
-        it->second.erase(k.second);
+        it->second.erase(member);
         if (it->second.empty()) {
             internalMap.erase(it);
         }
@@ -194,13 +315,7 @@ public:
         if (it == internalMap.end()) {
             return nullptr;
         }
-
-        auto jt = it->second.find(k.second);
-        if (jt == it->second.end()) {
-            return nullptr;
-        }
-
-        return &jt->second;
+        return it->second.find(k.second);
     }
 
     T& GetOrAdd(const SigShareKey& k)
@@ -244,7 +359,7 @@ public:
         return internalMap.empty();
     }
 
-    const std::unordered_map<uint16_t, T>* GetAllForSignHash(const uint256& signHash) const
+    const SigShareMemberMap<T>* GetAllForSignHash(const uint256& signHash) const
     {
         auto it = internalMap.find(signHash);
         if (it == internalMap.end()) {
@@ -262,16 +377,7 @@ public:
     void EraseIf(F&& f)
     {
         for (auto it = internalMap.begin(); it != internalMap.end(); ) {
-            SigShareKey k;
-            k.first = it->first;
-            for (auto jt = it->second.begin(); jt != it->second.end(); ) {
-                k.second = jt->first;
-                if (f(k, jt->second)) {
-                    jt = it->second.erase(jt);
-                } else {
-                    ++jt;
-                }
-            }
+            it->second.EraseIf(it->first, f);
             if (it->second.empty()) {
                 it = internalMap.erase(it);
             } else {
@@ -284,12 +390,16 @@ public:
     void ForEach(F&& f)
     {
         for (auto& p : internalMap) {
-            SigShareKey k;
-            k.first = p.first;
-            for (auto& p2 : p.second) {
-                k.second = p2.first;
-                f(k, p2.second);
-            }
+            p.second.ForEach(p.first, f);
+        }
+    }
+
+    // Calls f once per signHash with all entries of it, which is never empty
+    template<typename F>
+    void ForEachSignHash(F&& f) const
+    {
+        for (const auto& [signHash, m] : internalMap) {
+            f(signHash, m);
         }
     }
 };
@@ -384,6 +494,9 @@ private:
     std::unordered_map<uint256, int64_t, StaticSaltedHasher> timeSeenForSessions GUARDED_BY(cs);
 
     std::unordered_map<NodeId, CSigSharesNodeState> nodeStates GUARDED_BY(cs);
+    // Sig shares from the message handler, queued without taking cs and moved to the node states in bulk by the
+    // worker thread
+    MPSCQueue<std::pair<NodeId, CSigShare>> incomingSigShares;
     SigShareMap<std::pair<NodeId, int64_t>> sigSharesRequested GUARDED_BY(cs);
     SigShareMap<bool> sigSharesQueuedToAnnounce GUARDED_BY(cs);
 
@@ -402,6 +515,7 @@ private:
     CConnman& connman;
     const CQuorumManager& qman;
     CSigningManager& sigman;
+    CBLSWorker& blsWorker;
 
     const std::unique_ptr<PeerManager>& m_peerman;
 
@@ -409,8 +523,9 @@ private:
     std::atomic<uint32_t> recoveredSigsCounter{0};
 
 public:
-    explicit CSigSharesManager(CConnman& _connman, CQuorumManager& _qman, CSigningManager& _sigman, const std::unique_ptr<PeerManager>& peerman) :
-        connman(_connman), qman(_qman), sigman(_sigman), m_peerman(peerman)
+    explicit CSigSharesManager(CConnman& _connman, CQuorumManager& _qman, CSigningManager& _sigman, CBLSWorker& _blsWorker,
+                               const std::unique_ptr<PeerManager>& peerman) :
+        connman(_connman), qman(_qman), sigman(_sigman), blsWorker(_blsWorker), m_peerman(peerman)
     {
         workInterrupt.reset();
     };
@@ -444,6 +559,7 @@ private:
     static bool VerifySigSharesInv(Consensus::LLMQType llmqType, const CSigSharesInv& inv);
     static bool PreVerifyBatchedSigShares(const CQuorumManager& quorum_manager, const CSigSharesNodeState::SessionInfo& session, const CBatchedSigShares& batchedSigShares, bool& retBan);
 
+    void ProcessIncomingSigShares();
     void CollectPendingSigSharesToVerify(size_t maxUniqueSessions,
             std::unordered_map<NodeId, std::vector<CSigShare>>& retSigShares,
             std::unordered_map<std::pair<Consensus::LLMQType, uint256>, CQuorumCPtr, StaticSaltedHasher>& retQuorums);
@@ -467,10 +583,14 @@ private:
 
     bool SendMessages();
     void CollectSigSharesToRequest(std::unordered_map<NodeId, std::unordered_map<uint256, CSigSharesInv, StaticSaltedHasher>>& sigSharesToRequest) EXCLUSIVE_LOCKS_REQUIRED(cs);
-    void CollectSigSharesToSend(std::unordered_map<NodeId, std::unordered_map<uint256, CBatchedSigShares, StaticSaltedHasher>>& sigSharesToSend) EXCLUSIVE_LOCKS_REQUIRED(cs);
+    void CollectSigSharesToSend(std::unordered_map<NodeId, std::unordered_map<uint256, CBatchedSigSharesToSend, StaticSaltedHasher>>& sigSharesToSend,
+                                SerializedSigShares& serializedSigShares) EXCLUSIVE_LOCKS_REQUIRED(cs);
     void CollectSigSharesToSendConcentrated(std::unordered_map<NodeId, std::vector<CSigShare>>& sigSharesToSend, const std::vector<CNode*>& vNodes) EXCLUSIVE_LOCKS_REQUIRED(cs);
     void CollectSigSharesToAnnounce(std::unordered_map<NodeId, std::unordered_map<uint256, CSigSharesInv, StaticSaltedHasher>>& sigSharesToAnnounce) EXCLUSIVE_LOCKS_REQUIRED(cs);
     void SignPendingSigShares();
+    // CreateSigShare in two steps, so that the signing in between can be batched
+    std::optional<CSigShare> PrepareSigShare(const CQuorumCPtr& quorum, const uint256& id, const uint256& msgHash) const;
+    bool FinishSigShare(const CQuorum& quorum, CSigShare& sigShare, const CBLSSignature& sig, const cxxtimer::Timer& t) const;
     void WorkThreadMain();
 };
 } // namespace llmq
@@ -0,0 +1,156 @@
+// Copyright (c) 2026 The Dash Core developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <llmq/signing_stats.h>
+
+#include <llmq/params.h>
+
+#include <statsd_client.h>
+#include <tinyformat.h>
+#include <util/time.h>
+#include <util/underlying.h>
+
+#include <algorithm>
+#include <string>
+
+namespace llmq
+{
+
+static std::string LLMQTypeName(Consensus::LLMQType llmqType)
+{
+    for (const auto& llmq : Consensus::available_llmqs) {
+        if (llmq.type == llmqType) {
+            return std::string(llmq.name);
+        }
+    }
+    return strprintf("%d", ToUnderlying(llmqType));
+}
+
+const char* CSigningStats::LatencyName(Latency latency)
+{
+    switch (latency) {
+    case Latency::SignToShare: return "sign_to_share";
+    case Latency::ShareToRelayed: return "share_to_relayed";
+    case Latency::SignToRecovered: return "sign_to_recovered";
+    case Latency::FirstShareToRecovered: return "first_share_to_recovered";
+    case Latency::RecoveryStartedToRecovered: return "recovery_started_to_recovered";
+    case Latency::COUNT: break;
+    }
+    assert(false);
+}
+
+void CSigningStats::Samples::Add(int64_t value)
+{
+    if (values.size() < MAX_SAMPLES) {
+        values.emplace_back(value);
+    } else {
+        values[next] = value;
+        next = (next + 1) % MAX_SAMPLES;
+    }
+    total++;
+}
+
+void CSigningStats::Record(Consensus::LLMQType llmqType, const uint256& signHash, Stage stage)
+{
+    Record(llmqType, signHash, stage, GetTimeMillis());
+}
+
+void CSigningStats::Record(Consensus::LLMQType llmqType, const uint256& signHash, Stage stage, int64_t nTimeMs)
+{
+    std::vector<std::pair<Latency, int64_t>> finished;
+    {
+        LOCK(cs);
+        auto it = sessions.find(signHash);
+        if (it == sessions.end()) {
+            if (stage != Stage::SignRequested && stage != Stage::FirstShareSeen) {
+                return;
+            }
+            it = sessions.emplace(signHash, Session{llmqType}).first;
+        }
+        auto& t = it->second.times[size_t(stage)];
+        if (t != 0) {
+            return;
+        }
+        t = nTimeMs;
+        if (stage != Stage::Recovered) {
+            return;
+        }
+
+        const auto& times = it->second.times;
+        const auto add = [&](Latency latency, Stage start, Stage end) {
+            const int64_t nStart = times[size_t(start)];
+            const int64_t nEnd = times[size_t(end)];
+            // Stages of other nodes can be seen in any order, only keep what makes sense
+            if (nStart == 0 || nEnd == 0 || nEnd < nStart) {
+                return;
+            }
+            histograms[llmqType][size_t(latency)].Add(nEnd - nStart);
+            finished.emplace_back(latency, nEnd - nStart);
+        };
+        add(Latency::SignToShare, Stage::SignRequested, Stage::ShareCreated);
+        add(Latency::ShareToRelayed, Stage::ShareCreated, Stage::SharesRelayed);
+        add(Latency::SignToRecovered, Stage::SignRequested, Stage::Recovered);
+        add(Latency::FirstShareToRecovered, Stage::FirstShareSeen, Stage::Recovered);
+        add(Latency::RecoveryStartedToRecovered, Stage::RecoveryStarted, Stage::Recovered);
+        sessions.erase(it);
+    }
+
+    if (finished.empty()) {
+        return;
+    }
+    const std::string prefix = strprintf("llmq.signing.%s.", LLMQTypeName(llmqType));
+    for (const auto& [latency, ms] : finished) {
+        statsClient.timing(prefix + LatencyName(latency), ms, 1.0f);
+    }
+}
+
+void CSigningStats::Cleanup(int64_t nTimeMs)
+{
+    LOCK(cs);
+    for (auto it = sessions.begin(); it != sessions.end(); ) {
+        const auto& times = it->second.times;
+        const int64_t nLastTime = *std::max_element(times.begin(), times.end());
+        if (nTimeMs - nLastTime > SESSION_TIMEOUT * 1000) {
+            it = sessions.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+UniValue CSigningStats::ToJson() const
+{
+    LOCK(cs);
+    UniValue ret(UniValue::VOBJ);
+    ret.pushKV("pending_sessions", uint64_t(sessions.size()));
+
+    UniValue types(UniValue::VOBJ);
+    for (const auto& [llmqType, latencies] : histograms) {
+        UniValue obj(UniValue::VOBJ);
+        for (size_t i = 0; i < latencies.size(); i++) {
+            const auto& samples = latencies[i];
+            if (samples.values.empty()) {
+                continue;
+            }
+            std::vector<int64_t> sorted = samples.values;
+            std::sort(sorted.begin(), sorted.end());
+            const auto percentile = [&](int p) {
+                return sorted[(sorted.size() - 1) * p / 100];
+            };
+            UniValue h(UniValue::VOBJ);
+            h.pushKV("total", samples.total);
+            h.pushKV("samples", uint64_t(sorted.size()));
+            h.pushKV("p50", percentile(50));
+            h.pushKV("p90", percentile(90));
+            h.pushKV("p99", percentile(99));
+            h.pushKV("max", sorted.back());
+            obj.pushKV(LatencyName(Latency(i)), h);
+        }
+        types.pushKV(LLMQTypeName(llmqType), obj);
+    }
+    ret.pushKV("llmqs", types);
+    return ret;
+}
+
+} // namespace llmq
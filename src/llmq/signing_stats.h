@@ -0,0 +1,98 @@
+// Copyright (c) 2026 The Dash Core developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_LLMQ_SIGNING_STATS_H
+#define BITCOIN_LLMQ_SIGNING_STATS_H
+
+#include <consensus/params.h>
+#include <saltedhasher.h>
+#include <sync.h>
+#include <uint256.h>
+#include <univalue.h>
+
+#include <array>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+namespace llmq
+{
+
+/**
+ * Keeps track of when a signing session went through each of its stages and
+ * turns that into latency histograms per LLMQ type. Every latency is also
+ * reported to statsd as a timing, the histograms are what
+ * "quorum signingstats" shows.
+ *
+ * Sessions are identified by their sign hash. Only the first time a stage is
+ * seen counts, re-signing or receiving more shares does not move it.
+ */
+class CSigningStats
+{
+public:
+    enum class Stage : uint8_t {
+        SignRequested,   // AsyncSignIfMember picked a quorum we are a member of
+        ShareCreated,    // our own share is signed
+        SharesRelayed,   // shares of the session were handed to the network
+        FirstShareSeen,  // the first share of the session, ours or not, was accepted
+        RecoveryStarted, // enough shares, TryRecoverSig started recovering
+        Recovered,       // ProcessRecoveredSig accepted the recovered sig
+        COUNT,
+    };
+
+    enum class Latency : uint8_t {
+        SignToShare,
+        ShareToRelayed,
+        SignToRecovered,
+        FirstShareToRecovered,
+        RecoveryStartedToRecovered,
+        COUNT,
+    };
+
+    //! Number of latest samples kept per LLMQ type and latency
+    static constexpr size_t MAX_SAMPLES = 1000;
+    //! Sessions which never get recovered are forgotten after this many seconds
+    static constexpr int64_t SESSION_TIMEOUT = 10 * 60;
+
+    static const char* LatencyName(Latency latency);
+
+    /**
+     * Record that a session reached a stage. Only SignRequested and
+     * FirstShareSeen start tracking a session, other stages of unknown
+     * sessions are ignored.
+     */
+    void Record(Consensus::LLMQType llmqType, const uint256& signHash, Stage stage, int64_t nTimeMs);
+    void Record(Consensus::LLMQType llmqType, const uint256& signHash, Stage stage);
+
+    void Cleanup(int64_t nTimeMs);
+
+    UniValue ToJson() const;
+
+private:
+    struct Session {
+        Consensus::LLMQType llmqType;
+        std::array<int64_t, size_t(Stage::COUNT)> times{};
+    };
+
+    struct Samples {
+        std::vector<int64_t> values;
+        size_t next{0};
+        uint64_t total{0};
+
+        void Add(int64_t value);
+    };
+
+    using Histograms = std::array<Samples, size_t(Latency::COUNT)>;
+
+    void FinishSession(const Session& session) EXCLUSIVE_LOCKS_REQUIRED(cs);
+    void AddSample(Consensus::LLMQType llmqType, Latency latency, int64_t start, int64_t end) EXCLUSIVE_LOCKS_REQUIRED(cs);
+
+    mutable Mutex cs;
+    std::unordered_map<uint256, Session, StaticSaltedHasher> sessions GUARDED_BY(cs);
+    std::map<Consensus::LLMQType, Histograms> histograms GUARDED_BY(cs);
+};
+
+} // namespace llmq
+
+#endif // BITCOIN_LLMQ_SIGNING_STATS_H
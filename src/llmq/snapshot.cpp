@@ -16,6 +16,8 @@
 #include <univalue.h>
 #include <validation.h>
 
+#include <set>
+
 namespace llmq {
 
 static const std::string DB_QUORUM_SNAPSHOT = "llmq_S";
@@ -201,6 +203,12 @@ bool BuildQuorumRotationInfo(const CGetQuorumRotationInfo& request, CQuorumRotat
     const CBlockIndex* pWorkBlockHMinus4CIndex = pBlockHMinus4CIndex->GetAncestor(pBlockHMinus4CIndex->nHeight - workDiff);
     //Checked later if extraShare is on
 
+    std::vector<const CBlockIndex*> snapshotBlockIndexes{pBlockHMinusCIndex, pBlockHMinus2CIndex, pBlockHMinus3CIndex};
+    if (request.extraShare) {
+        snapshotBlockIndexes.push_back(pBlockHMinus4CIndex);
+    }
+    quorumSnapshotManager->PrefetchSnapshots(llmqType, snapshotBlockIndexes);
+
     if (!BuildSimplifiedMNListDiff(GetLastBaseBlockHash(baseBlockIndexes, pWorkBlockHMinusCIndex), pWorkBlockHMinusCIndex->GetBlockHash(), response.mnListDiffAtHMinusC, quorumBlockProcessor, errorRet)) {
         return false;
     }
@@ -289,6 +297,14 @@ bool BuildQuorumRotationInfo(const CGetQuorumRotationInfo& request, CQuorumRotat
     if (request.extraShare)
         snapshotHeightsNeeded.erase(pBlockHMinus4CIndex->nHeight);
 
+    snapshotBlockIndexes.clear();
+    for (const auto& h : snapshotHeightsNeeded) {
+        if (const CBlockIndex* pNeededBlockIndex = tipBlockIndex->GetAncestor(h)) {
+            snapshotBlockIndexes.push_back(pNeededBlockIndex);
+        }
+    }
+    quorumSnapshotManager->PrefetchSnapshots(llmqType, snapshotBlockIndexes);
+
     for (const auto& h : snapshotHeightsNeeded) {
         const CBlockIndex* pNeededBlockIndex = tipBlockIndex->GetAncestor(h);
         if (!pNeededBlockIndex) {
@@ -331,18 +347,24 @@ uint256 GetLastBaseBlockHash(Span<const CBlockIndex*> baseBlockIndexes, const CB
     return hash;
 }
 
+static uint256 GetSnapshotHash(Consensus::LLMQType llmqType, const CBlockIndex* pindex)
+{
+    return ::SerializeHash(std::make_pair(llmqType, pindex->GetBlockHash()));
+}
+
 std::optional<CQuorumSnapshot> CQuorumSnapshotManager::GetSnapshotForBlock(const Consensus::LLMQType llmqType, const CBlockIndex* pindex)
 {
     CQuorumSnapshot snapshot = {};
 
-    auto snapshotHash = ::SerializeHash(std::make_pair(llmqType, pindex->GetBlockHash()));
+    const auto snapshotHash = GetSnapshotHash(llmqType, pindex);
 
-    LOCK(snapshotCacheCs);
     // try using cache before reading from disk
-    if (quorumSnapshotCache.get(snapshotHash, snapshot)) {
+    if (WITH_LOCK(snapshotCacheCs, return quorumSnapshotCache.get(snapshotHash, snapshot))) {
         return snapshot;
     }
+    // other readers don't have to wait for the disk
     if (m_evoDb.Read(std::make_pair(DB_QUORUM_SNAPSHOT, snapshotHash), snapshot)) {
+        LOCK(snapshotCacheCs);
         quorumSnapshotCache.insert(snapshotHash, snapshot);
         return snapshot;
     }
@@ -350,9 +372,31 @@ std::optional<CQuorumSnapshot> CQuorumSnapshotManager::GetSnapshotForBlock(const
     return std::nullopt;
 }
 
+void CQuorumSnapshotManager::PrefetchSnapshots(const Consensus::LLMQType llmqType, Span<const CBlockIndex* const> pindexes)
+{
+    std::set<uint256> missing;
+    {
+        LOCK(snapshotCacheCs);
+        for (const auto* pindex : pindexes) {
+            const auto snapshotHash = GetSnapshotHash(llmqType, pindex);
+            if (!quorumSnapshotCache.exists(snapshotHash)) {
+                missing.emplace(snapshotHash);
+            }
+        }
+    }
+    // uint256 orders like its serialization, so this walks the db forward
+    for (const auto& snapshotHash : missing) {
+        CQuorumSnapshot snapshot;
+        if (m_evoDb.Read(std::make_pair(DB_QUORUM_SNAPSHOT, snapshotHash), snapshot)) {
+            LOCK(snapshotCacheCs);
+            quorumSnapshotCache.insert(snapshotHash, snapshot);
+        }
+    }
+}
+
 void CQuorumSnapshotManager::StoreSnapshotForBlock(const Consensus::LLMQType llmqType, const CBlockIndex* pindex, const CQuorumSnapshot& snapshot)
 {
-    auto snapshotHash = ::SerializeHash(std::make_pair(llmqType, pindex->GetBlockHash()));
+    const auto snapshotHash = GetSnapshotHash(llmqType, pindex);
 
     // LOCK(cs_main);
     AssertLockNotHeld(m_evoDb.cs);
@@ -13,6 +13,7 @@
 #include <serialize.h>
 #include <univalue.h>
 #include <unordered_lru_cache.h>
+#include <span.h>
 #include <util/irange.h>
 
 #include <optional>
@@ -211,6 +212,13 @@ bool BuildQuorumRotationInfo(const CGetQuorumRotationInfo& request, CQuorumRotat
                              const CQuorumManager& qman, const CQuorumBlockProcessor& quorumBlockProcessor, std::string& errorRet);
 uint256 GetLastBaseBlockHash(Span<const CBlockIndex*> baseBlockIndexes, const CBlockIndex* blockIndex);
 
+/**
+ * Snapshots in the cache, one is about a bit per registered masternode. getqrinfo answers need up to four of the
+ * quorum type's cycles plus those of the quorums mined since, so this keeps the snapshots of all recent cycles which
+ * clients ask about.
+ */
+static constexpr size_t QUORUM_SNAPSHOT_CACHE_SIZE{512};
+
 class CQuorumSnapshotManager
 {
 private:
@@ -222,10 +230,13 @@ private:
 
 public:
     explicit CQuorumSnapshotManager(CEvoDB& evoDb) :
-        m_evoDb(evoDb), quorumSnapshotCache(32) {}
+        m_evoDb(evoDb), quorumSnapshotCache(QUORUM_SNAPSHOT_CACHE_SIZE) {}
 
     std::optional<CQuorumSnapshot> GetSnapshotForBlock(Consensus::LLMQType llmqType, const CBlockIndex* pindex);
     void StoreSnapshotForBlock(Consensus::LLMQType llmqType, const CBlockIndex* pindex, const CQuorumSnapshot& snapshot);
+
+    // Read the snapshots of all pindexes which are not cached yet in one go, in the order of their db keys
+    void PrefetchSnapshots(Consensus::LLMQType llmqType, Span<const CBlockIndex* const> pindexes);
 };
 
 extern std::unique_ptr<CQuorumSnapshotManager> quorumSnapshotManager;
@@ -97,12 +97,13 @@ static uint256 GetHashModifier(const Consensus::LLMQParams& llmqParams, gsl::not
     return ::SerializeHash(std::make_pair(llmqParams.type, pCycleQuorumBaseBlockIndex->GetBlockHash()));
 }
 
+static RecursiveMutex cs_members;
+static std::map<Consensus::LLMQType, unordered_lru_cache<uint256, std::vector<CDeterministicMNCPtr>, StaticSaltedHasher>> mapQuorumMembers GUARDED_BY(cs_members);
+static RecursiveMutex cs_indexed_members;
+static std::map<Consensus::LLMQType, unordered_lru_cache<std::pair<uint256, int>, std::vector<CDeterministicMNCPtr>, StaticSaltedHasher>> mapIndexedQuorumMembers GUARDED_BY(cs_indexed_members);
+
 std::vector<CDeterministicMNCPtr> GetAllQuorumMembers(Consensus::LLMQType llmqType, gsl::not_null<const CBlockIndex*> pQuorumBaseBlockIndex, bool reset_cache)
 {
-    static RecursiveMutex cs_members;
-    static std::map<Consensus::LLMQType, unordered_lru_cache<uint256, std::vector<CDeterministicMNCPtr>, StaticSaltedHasher>> mapQuorumMembers GUARDED_BY(cs_members);
-    static RecursiveMutex cs_indexed_members;
-    static std::map<Consensus::LLMQType, unordered_lru_cache<std::pair<uint256, int>, std::vector<CDeterministicMNCPtr>, StaticSaltedHasher>> mapIndexedQuorumMembers GUARDED_BY(cs_indexed_members);
     if (!IsQuorumTypeEnabled(llmqType, pQuorumBaseBlockIndex->pprev)) {
         return {};
     }
@@ -172,6 +173,15 @@ std::vector<CDeterministicMNCPtr> GetAllQuorumMembers(Consensus::LLMQType llmqTy
     return quorumMembers;
 }
 
+void AddQuorumMembersToCache(Consensus::LLMQType llmqType, gsl::not_null<const CBlockIndex*> pQuorumBaseBlockIndex, const std::vector<CDeterministicMNCPtr>& members)
+{
+    LOCK(cs_members);
+    if (mapQuorumMembers.empty()) {
+        InitQuorumsCache(mapQuorumMembers);
+    }
+    mapQuorumMembers[llmqType].insert(pQuorumBaseBlockIndex->GetBlockHash(), members);
+}
+
 std::vector<CDeterministicMNCPtr> ComputeQuorumMembers(Consensus::LLMQType llmqType, const CBlockIndex* pQuorumBaseBlockIndex)
 {
     bool EvoOnly = (Params().GetConsensus().llmqTypePlatform == llmqType) && IsV19Active(pQuorumBaseBlockIndex);
@@ -649,85 +659,133 @@ uint256 DeterministicOutboundConnection(const uint256& proTxHash1, const uint256
     return proTxHash2;
 }
 
-std::set<uint256> GetQuorumConnections(const Consensus::LLMQParams& llmqParams, gsl::not_null<const CBlockIndex*> pQuorumBaseBlockIndex,
-                                                   const uint256& forMember, bool onlyOutbound)
+// Relay to nodes at indexes (i+2^k)%n, where
+//   k: 0..max(1, floor(log2(n-1))-1)
+//   n: size of the quorum/ring
+static std::vector<bool> CalcRelayTargets(size_t i, size_t memberCount)
 {
-    if (IsAllMembersConnectedEnabled(llmqParams.type)) {
-        auto mns = GetAllQuorumMembers(llmqParams.type, pQuorumBaseBlockIndex);
-        std::set<uint256> result;
+    std::vector<bool> r(memberCount);
+    if (memberCount == 1) {
+        // No outbound connections are needed when there is one MN only.
+        // Also note that trying to calculate results via the algorithm below
+        // would result in an endless loop.
+        return r;
+    }
+    int gap = 1;
+    int gap_max = (int)memberCount - 1;
+    int k = 0;
+    while ((gap_max >>= 1) || k <= 1) {
+        size_t idx = (i + gap) % memberCount;
+        // It doesn't matter if this node is going to be added to the resulting set or not,
+        // we should always bump the gap and the k (step count) regardless.
+        // Refusing to bump the gap results in an incomplete set in the best case scenario
+        // (idx won't ever change again once we hit `==`). Not bumping k guarantees an endless
+        // loop when the first or the second node we check is the one that should be skipped
+        // (k <= 1 forever).
+        gap <<= 1;
+        k++;
+        if (idx == i) {
+            continue;
+        }
+        r[idx] = true;
+    }
+    return r;
+}
 
-        for (const auto& dmn : mns) {
-            if (dmn->proTxHash == forMember) {
-                continue;
-            }
-            // Determine which of the two MNs (forMember vs dmn) should initiate the outbound connection and which
-            // one should wait for the inbound connection. We do this in a deterministic way, so that even when we
-            // end up with both connecting to each other, we know which one to disconnect
-            uint256 deterministicOutbound = DeterministicOutboundConnection(forMember, dmn->proTxHash);
-            if (!onlyOutbound || deterministicOutbound == dmn->proTxHash) {
-                result.emplace(dmn->proTxHash);
-            }
+static QuorumMemberConnections CalcQuorumMemberConnections(const Consensus::LLMQParams& llmqParams, const std::vector<CDeterministicMNCPtr>& mns,
+                                                           const uint256& forMember)
+{
+    const size_t n = mns.size();
+    QuorumMemberConnections result;
+    result.relayMembers.resize(n);
+    result.outboundRelayMembers.resize(n);
+
+    const auto it = ranges::find_if(mns, [&](const auto& dmn) { return dmn->proTxHash == forMember; });
+    if (it != mns.end()) {
+        const size_t myIdx = it - mns.begin();
+        result.outboundRelayMembers = CalcRelayTargets(myIdx, n);
+        // Without onlyOutbound, members which relay to forMember are included too
+        for (const auto i : irange::range(n)) {
+            result.relayMembers[i] = result.outboundRelayMembers[i] || (i != myIdx && CalcRelayTargets(i, n)[myIdx]);
         }
+    }
+
+    if (!IsAllMembersConnectedEnabled(llmqParams.type)) {
+        result.connections = result.relayMembers;
+        result.outboundConnections = result.outboundRelayMembers;
         return result;
     }
-    return GetQuorumRelayMembers(llmqParams, pQuorumBaseBlockIndex, forMember, onlyOutbound);
+
+    result.connections.resize(n);
+    result.outboundConnections.resize(n);
+    for (const auto i : irange::range(n)) {
+        const auto& dmn = mns[i];
+        if (dmn->proTxHash == forMember) {
+            continue;
+        }
+        // Determine which of the two MNs (forMember vs dmn) should initiate the outbound connection and which
+        // one should wait for the inbound connection. We do this in a deterministic way, so that even when we
+        // end up with both connecting to each other, we know which one to disconnect
+        uint256 deterministicOutbound = DeterministicOutboundConnection(forMember, dmn->proTxHash);
+        result.connections[i] = true;
+        result.outboundConnections[i] = deterministicOutbound == dmn->proTxHash;
+    }
+    return result;
 }
 
-std::set<uint256> GetQuorumRelayMembers(const Consensus::LLMQParams& llmqParams, gsl::not_null<const CBlockIndex*> pQuorumBaseBlockIndex,
-                                                    const uint256& forMember, bool onlyOutbound)
+static Mutex cs_member_connections;
+static std::map<Consensus::LLMQType, unordered_lru_cache<uint256, std::shared_ptr<const QuorumMemberConnections>, StaticSaltedHasher>> mapQuorumMemberConnections GUARDED_BY(cs_member_connections);
+
+std::shared_ptr<const QuorumMemberConnections> GetQuorumMemberConnections(const Consensus::LLMQParams& llmqParams, gsl::not_null<const CBlockIndex*> pQuorumBaseBlockIndex,
+                                                                          const uint256& forMember)
 {
     auto mns = GetAllQuorumMembers(llmqParams.type, pQuorumBaseBlockIndex);
-    std::set<uint256> result;
+    const uint256 cacheKey = ::SerializeHash(std::make_pair(pQuorumBaseBlockIndex->GetBlockHash(), forMember));
 
-    auto calcOutbound = [&](size_t i, const uint256& proTxHash) {
-        if (mns.size() == 1) {
-            // No outbound connections are needed when there is one MN only.
-            // Also note that trying to calculate results via the algorithm below
-            // would result in an endless loop.
-            return std::set<uint256>();
-        }
-        // Relay to nodes at indexes (i+2^k)%n, where
-        //   k: 0..max(1, floor(log2(n-1))-1)
-        //   n: size of the quorum/ring
-        std::set<uint256> r;
-        int gap = 1;
-        int gap_max = (int)mns.size() - 1;
-        int k = 0;
-        while ((gap_max >>= 1) || k <= 1) {
-            size_t idx = (i + gap) % mns.size();
-            // It doesn't matter if this node is going to be added to the resulting set or not,
-            // we should always bump the gap and the k (step count) regardless.
-            // Refusing to bump the gap results in an incomplete set in the best case scenario
-            // (idx won't ever change again once we hit `==`). Not bumping k guarantees an endless
-            // loop when the first or the second node we check is the one that should be skipped
-            // (k <= 1 forever).
-            gap <<= 1;
-            k++;
-            const auto& otherDmn = mns[idx];
-            if (otherDmn->proTxHash == proTxHash) {
-                continue;
-            }
-            r.emplace(otherDmn->proTxHash);
+    std::shared_ptr<const QuorumMemberConnections> result;
+    {
+        LOCK(cs_member_connections);
+        if (mapQuorumMemberConnections.empty()) {
+            InitQuorumsCache(mapQuorumMemberConnections);
         }
-        return r;
-    };
-
-    for (const auto i : irange::range(mns.size())) {
-        const auto& dmn = mns[i];
-        if (dmn->proTxHash == forMember) {
-            auto r = calcOutbound(i, dmn->proTxHash);
-            result.insert(r.begin(), r.end());
-        } else if (!onlyOutbound) {
-            auto r = calcOutbound(i, dmn->proTxHash);
-            if (r.count(forMember)) {
-                result.emplace(dmn->proTxHash);
-            }
+        if (mapQuorumMemberConnections[llmqParams.type].get(cacheKey, result) && result->relayMembers.size() == mns.size()) {
+            return result;
         }
     }
 
+    result = std::make_shared<const QuorumMemberConnections>(CalcQuorumMemberConnections(llmqParams, mns, forMember));
+    LOCK(cs_member_connections);
+    mapQuorumMemberConnections[llmqParams.type].insert(cacheKey, result);
     return result;
 }
 
+static std::set<uint256> MemberBitsToProTxHashes(const std::vector<CDeterministicMNCPtr>& mns, const std::vector<bool>& bits)
+{
+    std::set<uint256> result;
+    for (const auto i : irange::range(std::min(mns.size(), bits.size()))) {
+        if (bits[i]) {
+            result.emplace(mns[i]->proTxHash);
+        }
+    }
+    return result;
+}
+
+std::set<uint256> GetQuorumConnections(const Consensus::LLMQParams& llmqParams, gsl::not_null<const CBlockIndex*> pQuorumBaseBlockIndex,
+                                                   const uint256& forMember, bool onlyOutbound)
+{
+    auto mns = GetAllQuorumMembers(llmqParams.type, pQuorumBaseBlockIndex);
+    const auto conns = GetQuorumMemberConnections(llmqParams, pQuorumBaseBlockIndex, forMember);
+    return MemberBitsToProTxHashes(mns, onlyOutbound ? conns->outboundConnections : conns->connections);
+}
+
+std::set<uint256> GetQuorumRelayMembers(const Consensus::LLMQParams& llmqParams, gsl::not_null<const CBlockIndex*> pQuorumBaseBlockIndex,
+                                                    const uint256& forMember, bool onlyOutbound)
+{
+    auto mns = GetAllQuorumMembers(llmqParams.type, pQuorumBaseBlockIndex);
+    const auto conns = GetQuorumMemberConnections(llmqParams, pQuorumBaseBlockIndex, forMember);
+    return MemberBitsToProTxHashes(mns, onlyOutbound ? conns->outboundRelayMembers : conns->relayMembers);
+}
+
 std::set<size_t> CalcDeterministicWatchConnections(Consensus::LLMQType llmqType, gsl::not_null<const CBlockIndex*> pQuorumBaseBlockIndex,
                                                                size_t memberCount, size_t connectionCount)
 {
@@ -773,8 +831,9 @@ bool EnsureQuorumConnections(const Consensus::LLMQParams& llmqParams, gsl::not_n
     std::set<uint256> connections;
     std::set<uint256> relayMembers;
     if (isMember) {
-        connections = GetQuorumConnections(llmqParams, pQuorumBaseBlockIndex, myProTxHash, true);
-        relayMembers = GetQuorumRelayMembers(llmqParams, pQuorumBaseBlockIndex, myProTxHash, true);
+        const auto conns = GetQuorumMemberConnections(llmqParams, pQuorumBaseBlockIndex, myProTxHash);
+        connections = MemberBitsToProTxHashes(members, conns->outboundConnections);
+        relayMembers = MemberBitsToProTxHashes(members, conns->outboundRelayMembers);
     } else {
         auto cindexes = CalcDeterministicWatchConnections(llmqParams.type, pQuorumBaseBlockIndex, members.size(), 1);
         for (auto idx : cindexes) {
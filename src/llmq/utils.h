@@ -11,6 +11,7 @@
 #include <uint256.h>
 
 #include <map>
+#include <memory>
 #include <set>
 #include <vector>
 
@@ -28,8 +29,23 @@ namespace utils
 
 // includes members which failed DKG
 std::vector<CDeterministicMNCPtr> GetAllQuorumMembers(Consensus::LLMQType llmqType, gsl::not_null<const CBlockIndex*> pQuorumBaseBlockIndex, bool reset_cache = false);
+// Make GetAllQuorumMembers return members which were computed before, e.g. by a previous run and kept on disk
+void AddQuorumMembersToCache(Consensus::LLMQType llmqType, gsl::not_null<const CBlockIndex*> pQuorumBaseBlockIndex, const std::vector<CDeterministicMNCPtr>& members);
+
+/**
+ * Connections and relay members of one member of a quorum as bitsets over the indexes of GetAllQuorumMembers.
+ * These are computed once per quorum and member and kept in a cache, the outbound variants are the ones used
+ * with onlyOutbound=true.
+ */
+struct QuorumMemberConnections {
+    std::vector<bool> connections;
+    std::vector<bool> outboundConnections;
+    std::vector<bool> relayMembers;
+    std::vector<bool> outboundRelayMembers;
+};
 
 uint256 DeterministicOutboundConnection(const uint256& proTxHash1, const uint256& proTxHash2);
+std::shared_ptr<const QuorumMemberConnections> GetQuorumMemberConnections(const Consensus::LLMQParams& llmqParams, gsl::not_null<const CBlockIndex*> pQuorumBaseBlockIndex, const uint256& forMember);
 std::set<uint256> GetQuorumConnections(const Consensus::LLMQParams& llmqParams, gsl::not_null<const CBlockIndex*> pQuorumBaseBlockIndex, const uint256& forMember, bool onlyOutbound);
 std::set<uint256> GetQuorumRelayMembers(const Consensus::LLMQParams& llmqParams, gsl::not_null<const CBlockIndex*> pQuorumBaseBlockIndex, const uint256& forMember, bool onlyOutbound);
 std::set<size_t> CalcDeterministicWatchConnections(Consensus::LLMQType llmqType, gsl::not_null<const CBlockIndex*> pQuorumBaseBlockIndex, size_t memberCount, size_t connectionCount);
@@ -4,6 +4,7 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include <logging.h>
+#include <util/perfcounters.h>
 #include <util/system.h>
 #include <util/threadnames.h>
 #include <util/time.h>
@@ -43,7 +44,11 @@ static int FileWriteStr(const std::string &str, FILE *fp)
 
 bool BCLog::Logger::StartLogging()
 {
+    // Registered before taking m_cs, with -debug=lock the registry lock may log
+    m_async_dropped_counter = &perf::GetCounter("logging.dropped", "Log messages not written to debug.log because the async writer fell behind");
+
     StdLockGuard scoped_lock(m_cs);
+    StdLockGuard file_lock(m_file_cs);
 
     assert(m_buffering);
     assert(m_fileout == nullptr);
@@ -77,12 +82,75 @@ bool BCLog::Logger::StartLogging()
     }
     if (m_print_to_console) fflush(stdout);
 
+    if (m_print_to_file && m_async_file) {
+        m_async_stop = false;
+        m_async_running = true;
+        m_async_thread = std::thread([this] {
+            util::ThreadRename("logger");
+            while (!m_async_stop) {
+                std::this_thread::sleep_for(ASYNC_LOG_INTERVAL);
+                WriteAsyncQueue();
+            }
+            WriteAsyncQueue();
+        });
+    }
+
     return true;
 }
 
+void BCLog::Logger::StopAsyncLogging()
+{
+    {
+        // Later messages are written directly, after everything queued before
+        StdLockGuard scoped_lock(m_cs);
+        if (!m_async_running) return;
+        m_async_running = false;
+    }
+    m_async_stop = true;
+    m_async_thread.join();
+}
+
+void BCLog::Logger::WriteAsyncQueue()
+{
+    std::string out;
+    size_t bytes{0};
+    for (const auto& msg : m_async_queue.PopAll()) {
+        bytes += msg.size();
+        out += msg;
+    }
+    m_async_queued_bytes -= bytes;
+    if (const uint64_t dropped = m_async_dropped.exchange(0)) {
+        out += strprintf("[%d log messages were dropped because writing debug.log fell behind]\n", dropped);
+    }
+    if (out.empty()) return;
+
+    // One write for everything queued, the file is unbuffered
+    StdLockGuard file_lock(m_file_cs);
+    WriteToFile(out);
+}
+
+void BCLog::Logger::WriteToFile(const std::string& str)
+{
+    assert(m_fileout != nullptr);
+
+    // reopen the log file, if requested
+    if (m_reopen_file) {
+        m_reopen_file = false;
+        FILE* new_fileout = fsbridge::fopen(m_file_path, "a");
+        if (new_fileout) {
+            setbuf(new_fileout, nullptr); // unbuffered
+            fclose(m_fileout);
+            m_fileout = new_fileout;
+        }
+    }
+    FileWriteStr(str, m_fileout);
+}
+
 void BCLog::Logger::DisconnectTestLogger()
 {
+    StopAsyncLogging();
     StdLockGuard scoped_lock(m_cs);
+    StdLockGuard file_lock(m_file_cs);
     m_buffering = true;
     if (m_fileout != nullptr) fclose(m_fileout);
     m_fileout = nullptr;
@@ -297,19 +365,19 @@ void BCLog::Logger::LogPrintStr(const std::string& str)
         cb(str_prefixed);
     }
     if (m_print_to_file) {
-        assert(m_fileout != nullptr);
-
-        // reopen the log file, if requested
-        if (m_reopen_file) {
-            m_reopen_file = false;
-            FILE* new_fileout = fsbridge::fopen(m_file_path, "a");
-            if (new_fileout) {
-                setbuf(new_fileout, nullptr); // unbuffered
-                fclose(m_fileout);
-                m_fileout = new_fileout;
+        if (m_async_running) {
+            // Leave the write to the writer thread, or drop the message rather than wait for it
+            if (m_async_queued_bytes.fetch_add(str_prefixed.size()) + str_prefixed.size() > MAX_ASYNC_LOG_BYTES) {
+                m_async_queued_bytes -= str_prefixed.size();
+                ++m_async_dropped;
+                m_async_dropped_counter->Add();
+            } else {
+                m_async_queue.Push(std::move(str_prefixed));
             }
+        } else {
+            StdLockGuard file_lock(m_file_cs);
+            WriteToFile(str_prefixed);
         }
-        FileWriteStr(str_prefixed, m_fileout);
     }
 }
 
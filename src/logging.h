@@ -9,21 +9,32 @@
 #include <fs.h>
 #include <tinyformat.h>
 #include <threadsafety.h>
+#include <util/mpsc_queue.h>
 #include <util/string.h>
 
 #include <atomic>
+#include <chrono>
 #include <cstdint>
 #include <list>
 #include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 
 static const bool DEFAULT_LOGTIMEMICROS  = false;
 static const bool DEFAULT_LOGIPS         = false;
 static const bool DEFAULT_LOGTIMESTAMPS  = true;
 static const bool DEFAULT_LOGTHREADNAMES = false;
+static const bool DEFAULT_LOGASYNC       = false;
+/** With -logasync, messages beyond this many bytes waiting to be written are dropped */
+static constexpr size_t MAX_ASYNC_LOG_BYTES{64 << 20};
+static constexpr std::chrono::milliseconds ASYNC_LOG_INTERVAL{50};
 extern const char * const DEFAULT_DEBUGLOGFILE;
 
+namespace perf {
+class Counter;
+} // namespace perf
+
 extern bool fLogThreadNames;
 extern bool fLogIPs;
 
@@ -88,8 +99,10 @@ namespace BCLog {
     {
     private:
         mutable StdMutex m_cs; // Can not use Mutex from sync.h because in debug mode it would cause a deadlock when a potential deadlock was detected
+        //! Lock order: m_cs before m_file_cs. The async writer only takes m_file_cs, so it never blocks logging threads.
+        mutable StdMutex m_file_cs;
 
-        FILE* m_fileout GUARDED_BY(m_cs) = nullptr;
+        FILE* m_fileout GUARDED_BY(m_file_cs) = nullptr;
         std::list<std::string> m_msgs_before_open GUARDED_BY(m_cs);
         bool m_buffering GUARDED_BY(m_cs) = true; //!< Buffer messages before logging can be started.
 
@@ -106,6 +119,18 @@ namespace BCLog {
         std::string LogTimestampStr(const std::string& str);
         std::string LogThreadNameStr(const std::string &str);
 
+        /** Messages for the file which wait for the writer thread with m_async_file */
+        MPSCQueue<std::string> m_async_queue;
+        std::atomic<size_t> m_async_queued_bytes{0};
+        std::atomic<uint64_t> m_async_dropped{0};
+        std::atomic<bool> m_async_stop{false};
+        std::thread m_async_thread;
+        bool m_async_running GUARDED_BY(m_cs){false};
+        perf::Counter* m_async_dropped_counter{nullptr};
+
+        void WriteToFile(const std::string& str) EXCLUSIVE_LOCKS_REQUIRED(m_file_cs);
+        void WriteAsyncQueue();
+
         /** Slots that connect to the print signal */
         std::list<std::function<void(const std::string&)>> m_print_callbacks /* GUARDED_BY(m_cs) */ {};
 
@@ -116,6 +141,8 @@ namespace BCLog {
         bool m_log_timestamps = DEFAULT_LOGTIMESTAMPS;
         bool m_log_time_micros = DEFAULT_LOGTIMEMICROS;
         bool m_log_threadnames = DEFAULT_LOGTHREADNAMES;
+        //! Write to the file from a background thread, set before StartLogging()
+        bool m_async_file = DEFAULT_LOGASYNC;
 
         fs::path m_file_path;
         std::atomic<bool> m_reopen_file{false};
@@ -147,6 +174,8 @@ namespace BCLog {
 
         /** Start logging (and flush all buffered messages) */
         bool StartLogging();
+        /** Write what is queued for the file and stop the writer thread of m_async_file, if it runs */
+        void StopAsyncLogging();
         /** Only for testing */
         void DisconnectTestLogger();
 
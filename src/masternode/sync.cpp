@@ -69,7 +69,8 @@ void CMasternodeSync::SwitchToNextAsset()
         case(MASTERNODE_SYNC_BLOCKCHAIN):
             LogPrintf("CMasternodeSync::SwitchToNextAsset -- Completed %s in %llds\n", GetAssetName(), GetTime() - nTimeAssetSyncStarted);
             nCurrentAsset = MASTERNODE_SYNC_GOVERNANCE;
-            LogPrintf("CMasternodeSync::SwitchToNextAsset -- Starting %s\n", GetAssetName());
+            fResumeGovernance = m_govman.IsSyncedWithin(MASTERNODE_SYNC_RESUME_SECONDS);
+            LogPrintf("CMasternodeSync::SwitchToNextAsset -- Starting %s%s\n", GetAssetName(), fResumeGovernance ? " (resuming)" : "");
             break;
         case(MASTERNODE_SYNC_GOVERNANCE):
             LogPrintf("CMasternodeSync::SwitchToNextAsset -- Completed %s in %llds\n", GetAssetName(), GetTime() - nTimeAssetSyncStarted);
@@ -247,6 +248,15 @@ void CMasternodeSync::ProcessTick()
 
                 SendGovernanceSyncRequest(pnode);
 
+                if (fResumeGovernance && nTriedPeerCount >= MASTERNODE_SYNC_RESUME_PEERS) {
+                    // We were synced until shortly before, the objects these peers announce fill the gap
+                    // and the votes we miss are requested gradually once the sync has finished
+                    LogPrintf("CMasternodeSync::ProcessTick -- nTick %d nCurrentAsset %d -- governance was synced recently, finishing\n", nTick, nCurrentAsset);
+                    SwitchToNextAsset();
+                    connman.ReleaseNodeVector(vNodesCopy);
+                    return;
+                }
+
                 break; //this will cause each peer to get one request each six seconds for the various assets we need
             }
         }
@@ -24,6 +24,8 @@ static constexpr int MASTERNODE_SYNC_FINISHED        = 999;
 static constexpr int MASTERNODE_SYNC_TICK_SECONDS    = 6;
 static constexpr int MASTERNODE_SYNC_TIMEOUT_SECONDS = 30; // our blocks are 2.5 minutes so 30 seconds should be fine
 static constexpr int MASTERNODE_SYNC_RESET_SECONDS   = 900; // Reset fReachedBestHeader in CMasternodeSync::Reset if UpdateBlockTip hasn't been called for this seconds
+static constexpr int MASTERNODE_SYNC_RESUME_SECONDS  = 900; // Governance state flushed by a synced node at most this long ago only has to catch up
+static constexpr int MASTERNODE_SYNC_RESUME_PEERS    = 2; // Peers asked for their governance objects before a resumed sync finishes
 
 extern std::unique_ptr<CMasternodeSync> masternodeSync;
 
@@ -48,6 +50,8 @@ private:
     std::atomic<bool> fReachedBestHeader{false};
     /// Last time UpdateBlockTip has been called
     std::atomic<int64_t> nTimeLastUpdateBlockTip{0};
+    /// Set when the governance asset starts and the governance state was synced shortly before
+    std::atomic<bool> fResumeGovernance{false};
 
     CConnman& connman;
     const CGovernanceManager& m_govman;
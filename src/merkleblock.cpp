@@ -7,6 +7,9 @@
 
 #include <hash.h>
 #include <consensus/consensus.h>
+#include <consensus/merkle.h>
+
+#include <cassert>
 
 
 std::vector<unsigned char> BitsToBytes(const std::vector<bool>& bits)
@@ -27,8 +30,11 @@ std::vector<bool> BytesToBits(const std::vector<unsigned char>& bytes)
     return ret;
 }
 
-CMerkleBlock::CMerkleBlock(const CBlock& block, CBloomFilter* filter, const std::set<uint256>* txids)
+CMerkleBlock::CMerkleBlock(const CBlock& block, CBloomFilter* filter, const std::set<uint256>* txids,
+                           const std::vector<CBloomTxElements>* elements, const std::vector<std::vector<uint256>>* merkle_tree)
 {
+    assert(elements == nullptr || elements->size() == block.vtx.size());
+    assert(merkle_tree == nullptr || (!merkle_tree->empty() && merkle_tree->front().size() == block.vtx.size()));
     header = block.GetBlockHeader();
 
     std::vector<bool> vMatch;
@@ -56,39 +62,20 @@ CMerkleBlock::CMerkleBlock(const CBlock& block, CBloomFilter* filter, const std:
 
         if (txids && txids->count(hash)) {
             vMatch.push_back(true);
-        } else if (isAllowedType && filter && filter->IsRelevantAndUpdate(*block.vtx[i])) {
+        } else if (isAllowedType && filter &&
+                   (elements ? filter->IsRelevantAndUpdate(tx, (*elements)[i]) : filter->IsRelevantAndUpdate(tx))) {
             vMatch.push_back(true);
             vMatchedTxn.emplace_back(i, hash);
         } else {
             vMatch.push_back(false);
         }
-        vHashes.push_back(hash);
+        if (!merkle_tree) vHashes.push_back(hash);
     }
 
-    txn = CPartialMerkleTree(vHashes, vMatch);
-}
-
-uint256 CPartialMerkleTree::CalcHash(int height, unsigned int pos, const std::vector<uint256> &vTxid) {
-    //we can never have zero txs in a merkle block, we always need the coinbase tx
-    //if we do not have this assert, we can hit a memory access violation when indexing into vTxid
-    assert(vTxid.size() != 0);
-    if (height == 0) {
-        // hash at height 0 is the txids themself
-        return vTxid[pos];
-    } else {
-        // calculate left hash
-        uint256 left = CalcHash(height-1, pos*2, vTxid), right;
-        // calculate right hash if not beyond the end of the array - copy left hash otherwise
-        if (pos*2+1 < CalcTreeWidth(height-1))
-            right = CalcHash(height-1, pos*2+1, vTxid);
-        else
-            right = left;
-        // combine subhashes
-        return Hash(left, right);
-    }
+    txn = merkle_tree ? CPartialMerkleTree(*merkle_tree, vMatch) : CPartialMerkleTree(vHashes, vMatch);
 }
 
-void CPartialMerkleTree::TraverseAndBuild(int height, unsigned int pos, const std::vector<uint256> &vTxid, const std::vector<bool> &vMatch) {
+void CPartialMerkleTree::TraverseAndBuild(int height, unsigned int pos, const std::vector<std::vector<uint256>> &vTree, const std::vector<bool> &vMatch) {
     // determine whether this node is the parent of at least one matched txid
     bool fParentOfMatch = false;
     for (unsigned int p = pos << height; p < (pos+1) << height && p < nTransactions; p++)
@@ -97,12 +84,12 @@ void CPartialMerkleTree::TraverseAndBuild(int height, unsigned int pos, const st
     vBits.push_back(fParentOfMatch);
     if (height==0 || !fParentOfMatch) {
         // if at height 0, or nothing interesting below, store hash and stop
-        vHash.push_back(CalcHash(height, pos, vTxid));
+        vHash.push_back(vTree[height][pos]);
     } else {
         // otherwise, don't store any hash, but descend into the subtrees
-        TraverseAndBuild(height-1, pos*2, vTxid, vMatch);
+        TraverseAndBuild(height-1, pos*2, vTree, vMatch);
         if (pos*2+1 < CalcTreeWidth(height-1))
-            TraverseAndBuild(height-1, pos*2+1, vTxid, vMatch);
+            TraverseAndBuild(height-1, pos*2+1, vTree, vMatch);
     }
 }
 
@@ -144,18 +131,27 @@ uint256 CPartialMerkleTree::TraverseAndExtract(int height, unsigned int pos, uns
     }
 }
 
-CPartialMerkleTree::CPartialMerkleTree(const std::vector<uint256> &vTxid, const std::vector<bool> &vMatch) : nTransactions(vTxid.size()), fBad(false) {
+CPartialMerkleTree::CPartialMerkleTree(const std::vector<uint256> &vTxid, const std::vector<bool> &vMatch) :
+    // hash the whole tree level by level, which uses the multi-way SHA256D64 implementations
+    CPartialMerkleTree(ComputeMerkleTree(vTxid), vMatch) {}
+
+CPartialMerkleTree::CPartialMerkleTree(const std::vector<std::vector<uint256>> &vTree, const std::vector<bool> &vMatch) : nTransactions(vTree.empty() ? 0 : vTree[0].size()), fBad(false) {
     // reset state
     vBits.clear();
     vHash.clear();
 
+    //we can never have zero txs in a merkle block, we always need the coinbase tx
+    //if we do not have this assert, we can hit a memory access violation when indexing into the tree
+    assert(nTransactions != 0);
+
     // calculate height of tree
     int nHeight = 0;
     while (CalcTreeWidth(nHeight) > 1)
         nHeight++;
+    assert(vTree.size() == size_t(nHeight) + 1);
 
     // traverse the partial tree
-    TraverseAndBuild(nHeight, 0, vTxid, vMatch);
+    TraverseAndBuild(nHeight, 0, vTree, vMatch);
 }
 
 CPartialMerkleTree::CPartialMerkleTree() : nTransactions(0), fBad(true) {}
@@ -71,11 +71,8 @@ protected:
         return (nTransactions+(1 << height)-1) >> height;
     }
 
-    /** calculate the hash of a node in the merkle tree (at leaf level: the txid's themselves) */
-    uint256 CalcHash(int height, unsigned int pos, const std::vector<uint256> &vTxid);
-
-    /** recursive function that traverses tree nodes, storing the data as bits and hashes */
-    void TraverseAndBuild(int height, unsigned int pos, const std::vector<uint256> &vTxid, const std::vector<bool> &vMatch);
+    /** recursive function that traverses tree nodes, storing the data as bits and the hashes of vTree, see ComputeMerkleTree() */
+    void TraverseAndBuild(int height, unsigned int pos, const std::vector<std::vector<uint256>> &vTree, const std::vector<bool> &vMatch);
 
     /**
      * recursive function that traverses tree nodes, consuming the bits and hashes produced by TraverseAndBuild.
@@ -98,6 +95,9 @@ public:
     /** Construct a partial merkle tree from a list of transaction ids, and a mask that selects a subset of them */
     CPartialMerkleTree(const std::vector<uint256> &vTxid, const std::vector<bool> &vMatch);
 
+    /** Same from all levels of the merkle tree, see ComputeMerkleTree(), so one tree serves many masks */
+    CPartialMerkleTree(const std::vector<std::vector<uint256>> &vTree, const std::vector<bool> &vMatch);
+
     CPartialMerkleTree();
 
     /**
@@ -141,10 +141,15 @@ public:
      * Note that this will call IsRelevantAndUpdate on the filter for each transaction,
      * thus the filter will likely be modified.
      */
-    CMerkleBlock(const CBlock& block, CBloomFilter& filter) : CMerkleBlock(block, &filter, nullptr) { }
+    CMerkleBlock(const CBlock& block, CBloomFilter& filter) : CMerkleBlock(block, &filter, nullptr, nullptr, nullptr) { }
+
+    // Same with the bloom elements of the transactions of block and its merkle tree, which are shared by all filters
+    CMerkleBlock(const CBlock& block, CBloomFilter& filter, const std::vector<CBloomTxElements>& elements,
+                 const std::vector<std::vector<uint256>>& merkle_tree) :
+        CMerkleBlock(block, &filter, nullptr, &elements, &merkle_tree) { }
 
     // Create from a CBlock, matching the txids in the set
-    CMerkleBlock(const CBlock& block, const std::set<uint256>& txids) : CMerkleBlock(block, nullptr, &txids) { }
+    CMerkleBlock(const CBlock& block, const std::set<uint256>& txids) : CMerkleBlock(block, nullptr, &txids, nullptr, nullptr) { }
 
     CMerkleBlock() {}
 
@@ -152,7 +157,8 @@ public:
 
 private:
     // Combined constructor to consolidate code
-    CMerkleBlock(const CBlock& block, CBloomFilter* filter, const std::set<uint256>* txids);
+    CMerkleBlock(const CBlock& block, CBloomFilter* filter, const std::set<uint256>* txids,
+                 const std::vector<CBloomTxElements>* elements, const std::vector<std::vector<uint256>>* merkle_tree);
 };
 
 #endif // BITCOIN_MERKLEBLOCK_H
@@ -14,6 +14,7 @@
 #include <consensus/tx_verify.h>
 #include <consensus/validation.h>
 #include <deploymentstatus.h>
+#include <node/context.h>
 #include <policy/feerate.h>
 #include <policy/policy.h>
 #include <pow.h>
@@ -21,6 +22,7 @@
 #include <timedata.h>
 #include <util/moneystr.h>
 #include <util/system.h>
+#include <util/thread.h>
 
 #include <evo/specialtx.h>
 #include <evo/cbtx.h>
@@ -37,7 +39,14 @@
 #include <spork.h>
 #include <validation.h>
 
+#include <hash.h>
+#include <kawpow.h>
+#include <crypto-X16R/ethash/include/ethash/progpow.hpp>
+
 #include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
 #include <utility>
 
 int64_t UpdateTime(CBlockHeader* pblock, const Consensus::Params& consensusParams, const CBlockIndex* pindexPrev)
@@ -175,7 +184,11 @@ std::unique_ptr<CBlockTemplate> BlockAssembler::CreateNewBlock(const CScript& sc
     int nPackagesSelected = 0;
     int nDescendantsUpdated = 0;
 
-    addPackageTxs(nPackagesSelected, nDescendantsUpdated, pindexPrev);
+    if (m_mempool.IsClusterOrdered()) {
+        addChunkTxs(nPackagesSelected, pindexPrev);
+    } else {
+        addPackageTxs(nPackagesSelected, nDescendantsUpdated, pindexPrev);
+    }
 
     int64_t nTime1 = GetTimeMicros();
 
@@ -257,6 +270,9 @@ std::unique_ptr<CBlockTemplate> BlockAssembler::CreateNewBlock(const CScript& sc
     UpdateTime(pblock, chainparams.GetConsensus(), pindexPrev);
     pblock->nBits          = GetNextWorkRequired(pindexPrev, pblock, chainparams.GetConsensus());
     pblock->nNonce         = 0;
+    pblock->nHeight        = nHeight;
+    pblock->nNonce64       = 0;
+    pblock->mix_hash.SetNull();
     pblocktemplate->nPrevBits = pindexPrev->nBits;
     pblocktemplate->vTxSigOps[0] = GetLegacySigOpCount(*pblock->vtx[0]);
 
@@ -565,6 +581,94 @@ void BlockAssembler::addPackageTxs(int &nPackagesSelected, int &nDescendantsUpda
     }
 }
 
+// With cluster ordering the mempool keeps the chunks of all clusters sorted by
+// feerate. A chunk only depends on earlier chunks of its cluster, so walking them
+// from the best one down needs no updates of the remaining packages like the
+// ancestor score selection above. Once a chunk can't be included, the rest of its
+// cluster is skipped as it may depend on it.
+void BlockAssembler::addChunkTxs(int &nPackagesSelected, const CBlockIndex* const pindexPrev)
+{
+    AssertLockHeld(m_mempool.cs);
+
+    std::optional<CCreditPoolDiff> creditPoolDiff;
+    if (DeploymentActiveAfter(pindexPrev, chainparams.GetConsensus(), Consensus::DEPLOYMENT_V20)) {
+        CCreditPool creditPool = creditPoolManager->GetCreditPool(pindexPrev, chainparams.GetConsensus());
+        creditPoolDiff.emplace(std::move(creditPool), pindexPrev, chainparams.GetConsensus(), 0);
+    }
+    std::unordered_map<uint8_t, int> signals = m_chainstate.GetMNHFSignalsStage(pindexPrev);
+
+    m_mempool.UpdateClusters();
+
+    std::set<uint64_t> failedClusters;
+    const int64_t MAX_CONSECUTIVE_FAILURES = 1000;
+    int64_t nConsecutiveFailed = 0;
+
+    const auto& chunks = m_mempool.GetChunkIndex();
+    for (auto chunk_it = chunks.rbegin(); chunk_it != chunks.rend(); ++chunk_it) {
+        const CTxMemPool::ChunkRef& chunk = *chunk_it;
+        if (failedClusters.count(chunk.cluster)) continue;
+
+        if (chunk.fee < blockMinFeeRate.GetFee(chunk.size)) {
+            // Everything else we might consider has a lower fee rate
+            return;
+        }
+
+        const Span<const CTxMemPool::txiter> txs = m_mempool.GetChunkTxs(chunk);
+        CTxMemPool::setEntries package(txs.begin(), txs.end());
+        unsigned int packageSigOps{0};
+        for (CTxMemPool::txiter it : txs) {
+            packageSigOps += it->GetSigOpCount();
+        }
+
+        if (!TestPackage(chunk.size, packageSigOps)) {
+            failedClusters.insert(chunk.cluster);
+            ++nConsecutiveFailed;
+            if (nConsecutiveFailed > MAX_CONSECUTIVE_FAILURES && nBlockSize > nBlockMaxSize - 1000) {
+                // Give up if we're close to full and haven't succeeded in a while
+                break;
+            }
+            continue;
+        }
+
+        if (!TestPackageTransactions(package)) {
+            failedClusters.insert(chunk.cluster);
+            continue;
+        }
+
+        bool fSkipped{false};
+        for (CTxMemPool::txiter it : txs) {
+            if (creditPoolDiff != std::nullopt) {
+                TxValidationState state;
+                if (!creditPoolDiff->ProcessLockUnlockTransaction(it->GetTx(), state)) {
+                    LogPrintf("%s: asset-locks tx %s skipped due %s\n",
+                              __func__, it->GetTx().GetHash().ToString(), state.ToString());
+                    fSkipped = true;
+                    break;
+                }
+            }
+            if (std::optional<uint8_t> signal = extractEHFSignal(it->GetTx()); signal != std::nullopt) {
+                if (signals.find(*signal) != signals.end()) {
+                    LogPrintf("%s: ehf signal tx %s skipped due to duplicate %d\n",
+                              __func__, it->GetTx().GetHash().ToString(), *signal);
+                    fSkipped = true;
+                    break;
+                }
+                signals.insert({*signal, 0});
+            }
+        }
+        if (fSkipped) {
+            failedClusters.insert(chunk.cluster);
+            continue;
+        }
+
+        nConsecutiveFailed = 0;
+        for (CTxMemPool::txiter it : txs) {
+            AddToBlock(it);
+        }
+        ++nPackagesSelected;
+    }
+}
+
 void IncrementExtraNonce(CBlock* pblock, const CBlockIndex* pindexPrev, unsigned int& nExtraNonce)
 {
     // Update nExtraNonce
@@ -583,3 +687,155 @@ void IncrementExtraNonce(CBlock* pblock, const CBlockIndex* pindexPrev, unsigned
     pblock->vtx[0] = MakeTransactionRef(std::move(txCoinbase));
     pblock->hashMerkleRoot = BlockMerkleRoot(*pblock);
 }
+
+bool SolveKAWPOWBlock(CBlockHeader& block, const Consensus::Params& consensusParams, uint64_t& nMaxTries, int nThreads, const std::function<bool()>& interrupt)
+{
+    if (nMaxTries == 0) return false;
+
+    // Everything but nNonce64 and mix_hash is fixed while searching, so the
+    // header hash and the epoch context (or full dataset) are shared by all threads
+    const int epoch_number = ethash::get_epoch_number(block.nHeight);
+    const auto full_context = g_kawpow_epoch_contexts.GetFullDataset(epoch_number);
+    const auto context = full_context ? nullptr : g_kawpow_epoch_contexts.Get(epoch_number);
+    const auto header_hash = UintToEthashHash(block.GetKAWPOWHeaderHash());
+    const int height = block.nHeight;
+    const uint64_t start_nonce = block.nNonce64;
+    const uint64_t max_tries = nMaxTries;
+
+    std::atomic<uint64_t> next_try{0};
+    std::atomic<bool> done{false};
+    std::mutex found_mutex;
+    std::optional<uint64_t> found_try;
+    ethash::hash256 found_mix{};
+
+    auto search = [&] {
+        while (!done.load(std::memory_order_relaxed)) {
+            if (interrupt()) break;
+            const uint64_t n = next_try.fetch_add(1, std::memory_order_relaxed);
+            if (n >= max_tries) break;
+            const auto result = full_context ? progpow::hash(*full_context, height, header_hash, start_nonce + n) :
+                                               progpow::hash(*context, height, header_hash, start_nonce + n);
+            if (CheckProofOfWork(EthashHashToUint(result.final_hash), block.nBits, consensusParams)) {
+                std::lock_guard<std::mutex> lock(found_mutex);
+                // Keep the lowest solution so the outcome does not depend on scheduling
+                if (!found_try || n < *found_try) {
+                    found_try = n;
+                    found_mix = result.mix_hash;
+                }
+                done = true;
+            }
+        }
+        done = true;
+    };
+
+    std::vector<std::thread> threads;
+    for (int i = 1; i < nThreads; ++i) {
+        threads.emplace_back(search);
+    }
+    search();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    const uint64_t tried = found_try ? *found_try + 1 : std::min(next_try.load(), max_tries);
+    nMaxTries -= tried;
+    if (!found_try) {
+        block.nNonce64 = start_nonce + tried;
+        return false;
+    }
+    block.nNonce64 = start_nonce + *found_try;
+    block.mix_hash = EthashHashToUint(found_mix);
+    block.SetKnownHash(EthashHashToUint(progpow::hash_no_verify(height, header_hash, found_mix, block.nNonce64)));
+    return true;
+}
+
+BlockTemplateCache::BlockTemplateCache(NodeContext& node) : m_node(node) {}
+
+BlockTemplateCache::~BlockTemplateCache()
+{
+    Stop();
+}
+
+void BlockTemplateCache::Start()
+{
+    assert(!m_thread.joinable());
+    m_thread = std::thread(&util::TraceThread, "gbtcache", [this] { ThreadRefresh(); });
+}
+
+void BlockTemplateCache::Stop()
+{
+    WITH_LOCK(m_mutex, m_stop = true);
+    m_cv.notify_all();
+    if (m_thread.joinable()) m_thread.join();
+}
+
+bool BlockTemplateCache::IsRecent(const CBlockIndex* pindex_prev, unsigned int tx_updated) const
+{
+    AssertLockHeld(m_mutex);
+    return m_entry && m_entry->pindex_prev == pindex_prev &&
+           (m_entry->tx_updated == tx_updated || GetTime() - m_entry->time <= BLOCK_TEMPLATE_MAX_AGE);
+}
+
+std::optional<BlockTemplateCache::Entry> BlockTemplateCache::Get(const CBlockIndex* pindex_prev, unsigned int tx_updated)
+{
+    LOCK(m_mutex);
+    m_last_request = GetTime();
+    if (IsRecent(pindex_prev, tx_updated)) return m_entry;
+    return std::nullopt;
+}
+
+void BlockTemplateCache::Put(Entry entry)
+{
+    WITH_LOCK(m_mutex, m_entry = std::move(entry));
+    m_cv.notify_all();
+}
+
+void BlockTemplateCache::WaitForTip(const uint256& hash, std::chrono::milliseconds timeout)
+{
+    WAIT_LOCK(m_mutex, lock);
+    m_last_request = GetTime();
+    m_cv.wait_for(lock, timeout, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) {
+        return m_stop || (m_entry && m_entry->pindex_prev->GetBlockHash() == hash);
+    });
+}
+
+void BlockTemplateCache::UpdatedBlockTip(const CBlockIndex* pindexNew, const CBlockIndex* pindexFork, bool fInitialDownload)
+{
+    if (fInitialDownload) return;
+    WITH_LOCK(m_mutex, m_tip_changed = true);
+    m_cv.notify_all();
+}
+
+void BlockTemplateCache::ThreadRefresh()
+{
+    while (true) {
+        {
+            WAIT_LOCK(m_mutex, lock);
+            m_cv.wait_for(lock, std::chrono::seconds{1}, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return m_stop || m_tip_changed; });
+            if (m_stop) return;
+            m_tip_changed = false;
+            if (GetTime() - m_last_request > BLOCK_TEMPLATE_CACHE_IDLE) continue;
+        }
+
+        LOCK(cs_main);
+        CChainState& active_chainstate = m_node.chainman->ActiveChainstate();
+        const CBlockIndex* pindex_prev = active_chainstate.m_chain.Tip();
+        if (pindex_prev == nullptr || active_chainstate.IsInitialBlockDownload()) continue;
+        const unsigned int tx_updated = m_node.mempool->GetTransactionsUpdated();
+        if (WITH_LOCK(m_mutex, return IsRecent(pindex_prev, tx_updated))) continue;
+
+        Entry entry;
+        entry.pindex_prev = pindex_prev;
+        entry.tx_updated = tx_updated;
+        entry.time = GetTime();
+        try {
+            CScript scriptDummy = CScript() << OP_TRUE;
+            entry.block_template = BlockAssembler(*m_node.sporkman, *m_node.govman, *m_node.llmq_ctx, *m_node.evodb,
+                                                  active_chainstate, *m_node.mempool, Params()).CreateNewBlock(scriptDummy);
+        } catch (const std::runtime_error& e) {
+            LogPrintf("%s: %s\n", __func__, e.what());
+            continue;
+        }
+        if (entry.block_template) Put(std::move(entry));
+    }
+}
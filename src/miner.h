@@ -7,11 +7,17 @@
 #define BITCOIN_MINER_H
 
 #include <primitives/block.h>
+#include <sync.h>
 #include <txmempool.h>
+#include <validationinterface.h>
 
+#include <chrono>
+#include <condition_variable>
+#include <functional>
 #include <memory>
 #include <optional>
 #include <stdint.h>
+#include <thread>
 
 #include <boost/multi_index_container.hpp>
 #include <boost/multi_index/ordered_index.hpp>
@@ -24,6 +30,7 @@ class CGovernanceManager;
 class CScript;
 class CSporkManager;
 struct LLMQContext;
+struct NodeContext;
 
 namespace Consensus { struct Params; };
 namespace llmq {
@@ -33,6 +40,16 @@ class CQuorumBlockProcessor;
 } // namespace llmq
 
 static const bool DEFAULT_PRINTPRIORITY = false;
+/** Default number of threads generatetoaddress and friends search KAWPOW nonces with */
+static const int DEFAULT_KAWPOW_MINING_THREADS = 1;
+/** Upper bound on the number of KAWPOW nonce search threads */
+static const int MAX_KAWPOW_MINING_THREADS = 64;
+/** Default for -blocktemplatecache */
+static constexpr bool DEFAULT_BLOCK_TEMPLATE_CACHE{false};
+/** getblocktemplate keeps serving a template on the same tip for this many seconds after the mempool changed */
+static constexpr int64_t BLOCK_TEMPLATE_MAX_AGE{5};
+/** The template cache stops refreshing when getblocktemplate wasn't called for this many seconds */
+static constexpr int64_t BLOCK_TEMPLATE_CACHE_IDLE{60};
 
 struct CBlockTemplate
 {
@@ -197,6 +214,10 @@ private:
     void addPackageTxs(int& nPackagesSelected, int& nDescendantsUpdated,
                        const CBlockIndex* pindexPrev) EXCLUSIVE_LOCKS_REQUIRED(m_mempool.cs);
 
+    /** Add the chunks of the mempool clusters by feerate, with -clustermempool
+      * Increments nPackagesSelected with the number of chunks selected. */
+    void addChunkTxs(int& nPackagesSelected, const CBlockIndex* pindexPrev) EXCLUSIVE_LOCKS_REQUIRED(m_mempool.cs);
+
     // helper functions for addPackageTxs()
     /** Remove confirmed (inBlock) entries from given set */
     void onlyUnconfirmed(CTxMemPool::setEntries& testSet);
@@ -221,5 +242,61 @@ private:
 /** Modify the extranonce in a block */
 void IncrementExtraNonce(CBlock* pblock, const CBlockIndex* pindexPrev, unsigned int& nExtraNonce);
 int64_t UpdateTime(CBlockHeader* pblock, const Consensus::Params& consensusParams, const CBlockIndex* pindexPrev);
+/**
+ * Search nNonce64 of a KAWPOW header for a valid proof of work, starting at its
+ * current value. The tries are split between nThreads threads sharing one epoch
+ * context, all of which stop as soon as one of them finds a solution or
+ * interrupt() returns true. On success nNonce64 and mix_hash are set and true is
+ * returned; nMaxTries is reduced by the number of nonces used up either way.
+ */
+bool SolveKAWPOWBlock(CBlockHeader& block, const Consensus::Params& consensusParams, uint64_t& nMaxTries, int nThreads, const std::function<bool()>& interrupt);
+
+/**
+ * Keeps a block template on the active tip built in the background, so getblocktemplate can answer without
+ * building one while the miner waits. A new template is built as soon as the tip changes, and once the mempool
+ * changed and the current one is older than BLOCK_TEMPLATE_MAX_AGE, which is when getblocktemplate would build
+ * one itself. Nothing is built while getblocktemplate isn't being called.
+ */
+class BlockTemplateCache final : public CValidationInterface
+{
+public:
+    struct Entry {
+        std::shared_ptr<const CBlockTemplate> block_template;
+        const CBlockIndex* pindex_prev{nullptr};
+        //! mempool transactions updated counter when the template was built
+        unsigned int tx_updated{0};
+        int64_t time{0};
+    };
+
+    explicit BlockTemplateCache(NodeContext& node);
+    ~BlockTemplateCache();
+
+    void Start();
+    void Stop();
+
+    /** The cached template on top of pindex_prev, if it is as recent as getblocktemplate requires */
+    std::optional<Entry> Get(const CBlockIndex* pindex_prev, unsigned int tx_updated);
+    /** Replace the cached template with one getblocktemplate had to build itself */
+    void Put(Entry entry);
+    /** Wait up to timeout for a template on top of the block hash, used by longpoll callers after a new tip */
+    void WaitForTip(const uint256& hash, std::chrono::milliseconds timeout);
+
+protected:
+    void UpdatedBlockTip(const CBlockIndex* pindexNew, const CBlockIndex* pindexFork, bool fInitialDownload) override;
+
+private:
+    void ThreadRefresh();
+    bool IsRecent(const CBlockIndex* pindex_prev, unsigned int tx_updated) const EXCLUSIVE_LOCKS_REQUIRED(m_mutex);
+
+    NodeContext& m_node;
+
+    Mutex m_mutex;
+    std::condition_variable m_cv;
+    std::optional<Entry> m_entry GUARDED_BY(m_mutex);
+    bool m_tip_changed GUARDED_BY(m_mutex){false};
+    int64_t m_last_request GUARDED_BY(m_mutex){0};
+    bool m_stop GUARDED_BY(m_mutex){false};
+    std::thread m_thread;
+};
 
 #endif // BITCOIN_MINER_H
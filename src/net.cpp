@@ -42,6 +42,7 @@
 #include <string.h>
 #else
 #include <fcntl.h>
+#include <sys/uio.h>
 #endif
 
 #if HAVE_DECL_GETIFADDRS && HAVE_DECL_FREEIFADDRS
@@ -61,6 +62,7 @@
 #endif
 
 #include <algorithm>
+#include <array>
 #include <cstdint>
 #include <functional>
 #include <unordered_map>
@@ -672,15 +674,17 @@ void CNode::copyStats(CNodeStats &stats, const std::vector<bool> &m_asmap)
     stats.fInbound = IsInboundConn();
     stats.m_manual_connection = IsManualConn();
     X(nStartingHeight);
-    {
-        LOCK(cs_vSend);
-        X(mapSendBytesPerMsgCmd);
-        X(nSendBytes);
-    }
-    {
-        LOCK(cs_vRecv);
-        X(mapRecvBytesPerMsgCmd);
-        X(nRecvBytes);
+    X(nSendBytes);
+    X(nRecvBytes);
+    const auto& msg_types = getAllNetMessageTypes();
+    for (size_t i = 0; i <= msg_types.size(); ++i) {
+        const std::string& msg_type = i < msg_types.size() ? msg_types[i] : NET_MESSAGE_COMMAND_OTHER;
+        if (const uint64_t sent = m_send_bytes_per_msg_type[i].load(std::memory_order_relaxed); sent > 0) {
+            stats.mapSendBytesPerMsgCmd.emplace(msg_type, sent);
+        }
+        if (const uint64_t recv = m_recv_bytes_per_msg_type[i].load(std::memory_order_relaxed); recv > 0) {
+            stats.mapRecvBytesPerMsgCmd.emplace(msg_type, recv);
+        }
     }
     X(m_legacyWhitelisted);
     X(m_permissionFlags);
@@ -715,6 +719,55 @@ void CNode::copyStats(CNodeStats &stats, const std::vector<bool> &m_asmap)
 }
 #undef X
 
+CDataStream CNetRecvBufferPool::Get(size_t size, int type, int version)
+{
+    int bits = MIN_SIZE_BITS;
+    while (bits < MAX_SIZE_BITS && (size_t{1} << bits) < size) {
+        ++bits;
+    }
+    {
+        LOCK(m_mutex);
+        auto& buffers = m_buffers[bits - MIN_SIZE_BITS];
+        if (!buffers.empty()) {
+            CDataStream buf{std::move(buffers.back())};
+            buffers.pop_back();
+            buf.SetType(type);
+            buf.SetVersion(version);
+            return buf;
+        }
+    }
+    CDataStream buf(type, version);
+    buf.reserve(size_t{1} << bits);
+    return buf;
+}
+
+void CNetRecvBufferPool::Put(CDataStream&& buf)
+{
+    buf.clear();
+    const size_t capacity = buf.capacity();
+    if (capacity < (size_t{1} << MIN_SIZE_BITS) || capacity >= (size_t{1} << (MAX_SIZE_BITS + 1))) {
+        // Nothing to keep, or grown with a large message
+        return;
+    }
+    // The largest class the buffer has room for
+    int bits = MIN_SIZE_BITS;
+    while (bits < MAX_SIZE_BITS && (size_t{2} << bits) <= capacity) {
+        ++bits;
+    }
+    LOCK(m_mutex);
+    auto& buffers = m_buffers[bits - MIN_SIZE_BITS];
+    if ((buffers.size() + 1) << bits <= MAX_BYTES_PER_CLASS) {
+        buffers.push_back(std::move(buf));
+    }
+}
+
+/** Shared by all connections, it lives as long as the process as messages may outlive their CNode */
+static CNetRecvBufferPool& GetRecvBufferPool()
+{
+    static CNetRecvBufferPool* const pool{new CNetRecvBufferPool()};
+    return *pool;
+}
+
 bool CNode::ReceiveMsgBytes(Span<const uint8_t> msg_bytes, bool& complete)
 {
     complete = false;
@@ -730,33 +783,46 @@ bool CNode::ReceiveMsgBytes(Span<const uint8_t> msg_bytes, bool& complete)
             return false;
         }
 
-        if (m_deserializer->Complete()) {
-            // decompose a transport agnostic CNetMessage from the deserializer
-            uint32_t out_err_raw_size{0};
-            std::optional<CNetMessage> result{m_deserializer->GetMessage(nTimeMicros, out_err_raw_size)};
-            if (!result) {
-                // Message deserialization failed.  Drop the message but don't disconnect the peer.
-                // store the size of the corrupt message
-                mapRecvBytesPerMsgCmd.find(NET_MESSAGE_COMMAND_OTHER)->second += out_err_raw_size;
-                continue;
-            }
+        if (m_deserializer->Complete() && TakeCompleteMessage(nTimeMicros)) {
+            complete = true;
+        }
+    }
 
-            //store received bytes per message command
-            //to prevent a memory DOS, only allow valid commands
-            mapMsgCmdSize::iterator i = mapRecvBytesPerMsgCmd.find(result->m_command);
-            if (i == mapRecvBytesPerMsgCmd.end())
-                i = mapRecvBytesPerMsgCmd.find(NET_MESSAGE_COMMAND_OTHER);
-            assert(i != mapRecvBytesPerMsgCmd.end());
-            i->second += result->m_raw_message_size;
-            statsClient.count("bandwidth.message." + std::string(result->m_command) + ".bytesReceived", result->m_raw_message_size, 1.0f);
+    return true;
+}
 
-            // push the message to the process queue,
-            vRecvMsg.push_back(std::move(*result));
+void CNode::ReceivedPayloadBytes(size_t nBytes, bool& complete)
+{
+    complete = false;
+    int64_t nTimeMicros = GetTimeMicros();
+    LOCK(cs_vRecv);
+    nLastRecv = nTimeMicros / 1000000;
+    nRecvBytes += nBytes;
+    m_deserializer->PayloadReceived(nBytes);
+    if (m_deserializer->Complete() && TakeCompleteMessage(nTimeMicros)) {
+        complete = true;
+    }
+}
 
-            complete = true;
-        }
+bool CNode::TakeCompleteMessage(int64_t nTimeMicros)
+{
+    // decompose a transport agnostic CNetMessage from the deserializer
+    uint32_t out_err_raw_size{0};
+    std::optional<CNetMessage> result{m_deserializer->GetMessage(nTimeMicros, out_err_raw_size)};
+    if (!result) {
+        // Message deserialization failed.  Drop the message but don't disconnect the peer.
+        // store the size of the corrupt message
+        m_recv_bytes_per_msg_type[getAllNetMessageTypes().size()].fetch_add(out_err_raw_size, std::memory_order_relaxed);
+        return false;
     }
 
+    //store received bytes per message command
+    //to prevent a memory DOS, only allow valid commands
+    m_recv_bytes_per_msg_type[GetNetMessageTypeIndex(result->m_command)].fetch_add(result->m_raw_message_size, std::memory_order_relaxed);
+    statsClient.count("bandwidth.message." + std::string(result->m_command) + ".bytesReceived", result->m_raw_message_size, 1.0f);
+
+    // push the message to the process queue,
+    vRecvMsg.push_back(std::move(*result));
     return true;
 }
 
@@ -796,6 +862,11 @@ int V1TransportDeserializer::readHeader(Span<const uint8_t> msg_bytes)
 
     // switch state to reading message data
     in_data = true;
+    if (m_buffer_pool) {
+        const int type = vRecv.GetType(), version = vRecv.GetVersion();
+        m_buffer_pool->Put(std::move(vRecv));
+        vRecv = m_buffer_pool->Get(hdr.nMessageSize, type, version);
+    }
 
     return nCopy;
 }
@@ -817,6 +888,23 @@ int V1TransportDeserializer::readData(Span<const uint8_t> msg_bytes)
     return nCopy;
 }
 
+Span<uint8_t> V1TransportDeserializer::GetPayloadBuffer()
+{
+    if (!in_data) return {};
+    if (vRecv.size() < hdr.nMessageSize) {
+        // Like readData, allocate up to 256 KiB ahead
+        vRecv.resize(std::min(hdr.nMessageSize, nDataPos + 256 * 1024));
+    }
+    return {UCharCast(vRecv.data()) + nDataPos, vRecv.size() - nDataPos};
+}
+
+void V1TransportDeserializer::PayloadReceived(size_t nBytes)
+{
+    assert(in_data && nDataPos + nBytes <= vRecv.size());
+    hasher.Write({UCharCast(vRecv.data()) + nDataPos, nBytes});
+    nDataPos += nBytes;
+}
+
 const uint256& V1TransportDeserializer::GetMessageHash() const
 {
     assert(Complete());
@@ -828,7 +916,7 @@ const uint256& V1TransportDeserializer::GetMessageHash() const
 std::optional<CNetMessage> V1TransportDeserializer::GetMessage(int64_t time, uint32_t& out_err_raw_size)
 {
     // decompose a single CNetMessage from the TransportDeserializer
-    std::optional<CNetMessage> msg(std::move(vRecv));
+    std::optional<CNetMessage> msg(std::in_place, std::move(vRecv), m_buffer_pool);
 
     // store command string, time, and sizes
     msg->m_command = hdr.GetCommand();
@@ -875,33 +963,74 @@ void V1TransportSerializer::prepareForTransport(CSerializedNetMsg& msg, std::vec
     CVectorWriter{SER_NETWORK, INIT_PROTO_VERSION, header, 0, hdr};
 }
 
+/** Maximum number of queued buffers handed to the socket with a single call */
+static constexpr size_t MAX_SEND_BUFFERS_PER_CALL = 64;
+
+/**
+ * Send as many of the buffers from begin to end as the socket takes with a single call, skipping offset bytes
+ * of the first one. attempted is set to the number of bytes handed to the socket.
+ */
+template <typename It>
+static ssize_t SendBuffers(SOCKET hSocket, It begin, It end, size_t offset, size_t& attempted)
+{
+#ifdef WIN32
+    attempted = begin->size() - offset;
+    return send(hSocket, reinterpret_cast<const char*>(begin->data()) + offset, attempted, MSG_NOSIGNAL | MSG_DONTWAIT);
+#else
+    // Coalesce the small messages which are queued behind each other, like the header and payload of a message
+    std::array<iovec, MAX_SEND_BUFFERS_PER_CALL> iov;
+    size_t count = 0;
+    attempted = 0;
+    for (It it = begin; it != end && count < iov.size(); ++it, ++count) {
+        const size_t skip = count == 0 ? offset : 0;
+        iov[count].iov_base = const_cast<unsigned char*>(it->data()) + skip;
+        iov[count].iov_len = it->size() - skip;
+        attempted += iov[count].iov_len;
+    }
+    msghdr msg{};
+    msg.msg_iov = iov.data();
+    msg.msg_iovlen = count;
+    return sendmsg(hSocket, &msg, MSG_NOSIGNAL | MSG_DONTWAIT);
+#endif
+}
+
 size_t CConnman::SocketSendData(CNode *pnode) EXCLUSIVE_LOCKS_REQUIRED(pnode->cs_vSend)
 {
     auto it = pnode->vSendMsg.begin();
     size_t nSentSize = 0;
+    size_t nSendCalls = 0;
 
     while (it != pnode->vSendMsg.end()) {
-        const auto &data = *it;
-        assert(data.size() > pnode->nSendOffset);
-        int nBytes = 0;
+        assert(it->size() > pnode->nSendOffset);
+        ssize_t nBytes = 0;
+        size_t nAttempted = 0;
         {
             LOCK(pnode->cs_hSocket);
             if (pnode->hSocket == INVALID_SOCKET)
                 break;
-            nBytes = send(pnode->hSocket, reinterpret_cast<const char*>(data.data()) + pnode->nSendOffset, data.size() - pnode->nSendOffset, MSG_NOSIGNAL | MSG_DONTWAIT);
+            nBytes = SendBuffers(pnode->hSocket, it, pnode->vSendMsg.end(), pnode->nSendOffset, nAttempted);
         }
+        nSendCalls++;
         if (nBytes > 0) {
             pnode->nLastSend = GetSystemTimeInSeconds();
             pnode->nSendBytes += nBytes;
-            pnode->nSendOffset += nBytes;
             nSentSize += nBytes;
-            if (pnode->nSendOffset == data.size()) {
+            // skip past the buffers which were sent completely, the last one may have been sent partially
+            size_t nLeft = nBytes;
+            while (nLeft > 0) {
+                const size_t nRemaining = it->size() - pnode->nSendOffset;
+                if (nLeft < nRemaining) {
+                    pnode->nSendOffset += nLeft;
+                    break;
+                }
+                nLeft -= nRemaining;
                 pnode->nSendOffset = 0;
-                pnode->nSendSize -= data.size();
-                pnode->fPauseSend = pnode->nSendSize > nSendBufferMaxSize;
+                pnode->nSendSize -= it->size();
                 it++;
-            } else {
-                // could not send full message; stop sending more
+            }
+            pnode->fPauseSend = pnode->nSendSize > nSendBufferMaxSize;
+            if ((size_t)nBytes < nAttempted) {
+                // could not send all messages; stop sending more
                 pnode->fCanSendData = false;
                 break;
             }
@@ -927,6 +1056,8 @@ size_t CConnman::SocketSendData(CNode *pnode) EXCLUSIVE_LOCKS_REQUIRED(pnode->cs
     }
     pnode->vSendMsg.erase(pnode->vSendMsg.begin(), it);
     pnode->nSendMsgSize = pnode->vSendMsg.size();
+    // together with bandwidth.bytesSent this tells how many bytes a single send call takes on average
+    if (nSendCalls) statsClient.count("bandwidth.sendCalls", nSendCalls, 0.01f);
     return nSentSize;
 }
 
@@ -1445,15 +1576,11 @@ void CConnman::CalculateNumConnectionsChangedStats()
     mapSentBytesMsgStats[NET_MESSAGE_COMMAND_OTHER] = 0;
     auto vNodesCopy = CopyNodeVector(CConnman::FullyConnectedOnly);
     for (auto pnode : vNodesCopy) {
-        {
-            LOCK(pnode->cs_vRecv);
-            for (const mapMsgCmdSize::value_type &i : pnode->mapRecvBytesPerMsgCmd)
-                mapRecvBytesMsgStats[i.first] += i.second;
-        }
-        {
-            LOCK(pnode->cs_vSend);
-            for (const mapMsgCmdSize::value_type &i : pnode->mapSendBytesPerMsgCmd)
-                mapSentBytesMsgStats[i.first] += i.second;
+        const auto& msg_types = getAllNetMessageTypes();
+        for (size_t i = 0; i <= msg_types.size(); ++i) {
+            const std::string& msg_type = i < msg_types.size() ? msg_types[i] : NET_MESSAGE_COMMAND_OTHER;
+            mapRecvBytesMsgStats[msg_type] += pnode->m_recv_bytes_per_msg_type[i].load(std::memory_order_relaxed);
+            mapSentBytesMsgStats[msg_type] += pnode->m_send_bytes_per_msg_type[i].load(std::memory_order_relaxed);
         }
         if(pnode->fClient)
             spvNodes++;
@@ -1607,14 +1734,18 @@ void CConnman::SocketEventsKqueue(std::set<SOCKET> &recv_set, std::set<SOCKET> &
 #ifdef USE_EPOLL
 void CConnman::SocketEventsEpoll(std::set<SOCKET> &recv_set, std::set<SOCKET> &send_set, std::set<SOCKET> &error_set, bool fOnlyPoll)
 {
-    const size_t maxEvents = 64;
-    epoll_event events[maxEvents];
+    // Leave room for an event of every registered socket, so that a single pass of the socket handler serves all
+    // sockets which became ready instead of only the first few of them
+    const size_t maxEvents = std::max<size_t>(64, WITH_LOCK(cs_vNodes, return mapSocketToNode.size()) + vhListenSocket.size() + 1);
+    if (epollEvents.size() < maxEvents) {
+        epollEvents.resize(maxEvents);
+    }
 
     wakeupSelectNeeded = true;
-    int n = epoll_wait(epollfd, events, maxEvents, fOnlyPoll ? 0 : SELECT_TIMEOUT_MILLISECONDS);
+    int n = epoll_wait(epollfd, epollEvents.data(), epollEvents.size(), fOnlyPoll ? 0 : SELECT_TIMEOUT_MILLISECONDS);
     wakeupSelectNeeded = false;
     for (int i = 0; i < n; i++) {
-        auto& e = events[i];
+        auto& e = epollEvents[i];
         if((e.events & EPOLLERR) || (e.events & EPOLLHUP)) {
             error_set.insert((SOCKET)e.data.fd);
             continue;
@@ -1971,19 +2102,32 @@ size_t CConnman::SocketRecvData(CNode *pnode)
     // typical socket buffer is 8K-64K
     uint8_t pchBuf[0x10000];
     int nBytes = 0;
+    bool notify = false;
+    bool fMalformed = false;
     {
-        LOCK(pnode->cs_hSocket);
-        if (pnode->hSocket == INVALID_SOCKET)
-            return 0;
-        nBytes = recv(pnode->hSocket, (char*)pchBuf, sizeof(pchBuf), MSG_DONTWAIT);
-        if (nBytes < (int)sizeof(pchBuf)) {
-            pnode->fHasRecvData = false;
+        LOCK(pnode->cs_vRecv);
+        // The rest of a large payload is received right into the message, saving the copy out of pchBuf
+        const Span<uint8_t> payload = pnode->GetRecvPayloadBuffer();
+        const bool fDirect = payload.size() >= sizeof(pchBuf);
+        const Span<uint8_t> buf = fDirect ? payload : Span<uint8_t>(pchBuf, sizeof(pchBuf));
+        {
+            LOCK(pnode->cs_hSocket);
+            if (pnode->hSocket == INVALID_SOCKET)
+                return 0;
+            nBytes = recv(pnode->hSocket, (char*)buf.data(), buf.size(), MSG_DONTWAIT);
+            if (nBytes < (int)buf.size()) {
+                pnode->fHasRecvData = false;
+            }
+        }
+        if (nBytes > 0 && fDirect) {
+            pnode->ReceivedPayloadBytes(nBytes, notify);
+        } else if (nBytes > 0) {
+            fMalformed = !pnode->ReceiveMsgBytes(Span<const uint8_t>(pchBuf, nBytes), notify);
         }
     }
     if (nBytes > 0)
     {
-        bool notify = false;
-        if (!pnode->ReceiveMsgBytes(Span<const uint8_t>(pchBuf, nBytes), notify)) {
+        if (fMalformed) {
             LOCK(cs_vNodes);
             pnode->CloseSocketDisconnect(this);
         }
@@ -2651,6 +2795,8 @@ void CConnman::ThreadOpenMasternodeConnections()
 
     auto& chainParams = Params();
 
+    const size_t nMaxParallel = std::clamp<int64_t>(gArgs.GetArg("-mnconnectparallel", DEFAULT_MASTERNODE_CONNECT_PARALLEL), 1, MAX_MASTERNODE_CONNECT_PARALLEL);
+
     bool didConnect = false;
     while (!interruptNet)
     {
@@ -2684,10 +2830,6 @@ void CConnman::ThreadOpenMasternodeConnections()
         int64_t nANow = GetTime<std::chrono::seconds>().count();
         constexpr const auto &_func_ = __func__;
 
-        // NOTE: Process only one pending masternode at a time
-
-        MasternodeProbeConn isProbe = MasternodeProbeConn::IsNotConnection;
-
         const auto getPendingQuorumNodes = [&]() {
             LockAssertion lock(cs_vPendingMasternodes);
             std::vector<CDeterministicMNCPtr> ret;
@@ -2756,62 +2898,92 @@ void CConnman::ThreadOpenMasternodeConnections()
             return ret;
         };
 
-        auto getConnectToDmn = [&]() -> CDeterministicMNCPtr {
+        // Collect up to nMaxParallel masternodes to connect to, pending masternodes first, then quorum members, then probes
+        auto getConnectToDmns = [&]() {
             // don't hold lock while calling OpenMasternodeConnection as cs_main is locked deep inside
             LOCK2(cs_vNodes, cs_vPendingMasternodes);
 
-            if (!vPendingMasternodes.empty()) {
+            std::vector<std::pair<CDeterministicMNCPtr, MasternodeProbeConn>> ret;
+            std::set<CService> chosenAddrs;
+
+            while (!vPendingMasternodes.empty() && ret.size() < nMaxParallel) {
                 auto dmn = mnList.GetValidMN(vPendingMasternodes.front());
                 vPendingMasternodes.erase(vPendingMasternodes.begin());
-                if (dmn && !connectedNodes.count(dmn->pdmnState->addr) && !IsMasternodeOrDisconnectRequested(dmn->pdmnState->addr)) {
+                if (dmn && !connectedNodes.count(dmn->pdmnState->addr) && !IsMasternodeOrDisconnectRequested(dmn->pdmnState->addr) &&
+                    chosenAddrs.emplace(dmn->pdmnState->addr).second) {
                     LogPrint(BCLog::NET_NETCONN, "CConnman::%s -- opening pending masternode connection to %s, service=%s\n", _func_, dmn->proTxHash.ToString(), dmn->pdmnState->addr.ToString(false));
-                    return dmn;
+                    ret.emplace_back(dmn, MasternodeProbeConn::IsNotConnection);
                 }
             }
 
-            if (const auto pending = getPendingQuorumNodes(); !pending.empty()) {
-                // not-null
-                auto dmn = pending[GetRand(pending.size())];
-                LogPrint(BCLog::NET_NETCONN, "CConnman::%s -- opening quorum connection to %s, service=%s\n",
-                         _func_, dmn->proTxHash.ToString(), dmn->pdmnState->addr.ToString(false));
-                return dmn;
+            if (ret.size() < nMaxParallel) {
+                auto pending = getPendingQuorumNodes();
+                Shuffle(pending.begin(), pending.end(), FastRandomContext());
+                for (const auto& dmn : pending) {
+                    if (ret.size() >= nMaxParallel) break;
+                    if (!chosenAddrs.emplace(dmn->pdmnState->addr).second) continue;
+                    LogPrint(BCLog::NET_NETCONN, "CConnman::%s -- opening quorum connection to %s, service=%s\n",
+                             _func_, dmn->proTxHash.ToString(), dmn->pdmnState->addr.ToString(false));
+                    ret.emplace_back(dmn, MasternodeProbeConn::IsNotConnection);
+                }
             }
 
-            if (const auto pending = getPendingProbes(); !pending.empty()) {
-                // not-null
-                auto dmn = pending[GetRand(pending.size())];
-                masternodePendingProbes.erase(dmn->proTxHash);
-                isProbe = MasternodeProbeConn::IsConnection;
-
-                LogPrint(BCLog::NET_NETCONN, "CConnman::%s -- probing masternode %s, service=%s\n", _func_, dmn->proTxHash.ToString(), dmn->pdmnState->addr.ToString(false));
-                return dmn;
+            if (ret.size() < nMaxParallel) {
+                auto pending = getPendingProbes();
+                Shuffle(pending.begin(), pending.end(), FastRandomContext());
+                for (const auto& dmn : pending) {
+                    if (ret.size() >= nMaxParallel) break;
+                    if (!chosenAddrs.emplace(dmn->pdmnState->addr).second) continue;
+                    masternodePendingProbes.erase(dmn->proTxHash);
+                    LogPrint(BCLog::NET_NETCONN, "CConnman::%s -- probing masternode %s, service=%s\n", _func_, dmn->proTxHash.ToString(), dmn->pdmnState->addr.ToString(false));
+                    ret.emplace_back(dmn, MasternodeProbeConn::IsConnection);
+                }
             }
-            return nullptr;
+            return ret;
         };
 
-        CDeterministicMNCPtr connectToDmn = getConnectToDmn();
+        const auto connectToDmns = getConnectToDmns();
 
-        if (connectToDmn == nullptr) {
+        if (connectToDmns.empty()) {
             continue;
         }
 
         didConnect = true;
 
-        mmetaman->GetMetaInfo(connectToDmn->proTxHash)->SetLastOutboundAttempt(nANow);
+        for (const auto& [dmn, isProbe] : connectToDmns) {
+            mmetaman->GetMetaInfo(dmn->proTxHash)->SetLastOutboundAttempt(nANow);
+        }
 
-        OpenMasternodeConnection(CAddress(connectToDmn->pdmnState->addr, NODE_NETWORK), isProbe);
-        // should be in the list now if connection was opened
-        bool connected = ForNode(connectToDmn->pdmnState->addr, CConnman::AllNodes, [&](CNode* pnode) {
-            if (pnode->fDisconnect) {
-                return false;
+        // Connecting blocks until the peer answers or the connect timeout hits, so open all of them at once
+        if (connectToDmns.size() == 1) {
+            OpenMasternodeConnection(CAddress(connectToDmns.front().first->pdmnState->addr, NODE_NETWORK), connectToDmns.front().second);
+        } else {
+            std::vector<std::thread> threads;
+            threads.reserve(connectToDmns.size());
+            for (const auto& [dmn, isProbe] : connectToDmns) {
+                threads.emplace_back([this, addr = dmn->pdmnState->addr, probe = isProbe] {
+                    OpenMasternodeConnection(CAddress(addr, NODE_NETWORK), probe);
+                });
             }
-            return true;
-        });
-        if (!connected) {
-            LogPrint(BCLog::NET_NETCONN, "CConnman::%s -- connection failed for masternode  %s, service=%s\n", __func__, connectToDmn->proTxHash.ToString(), connectToDmn->pdmnState->addr.ToString(false));
-            // Will take a few consequent failed attempts to PoSe-punish a MN.
-            if (mmetaman->GetMetaInfo(connectToDmn->proTxHash)->OutboundFailedTooManyTimes()) {
-                LogPrint(BCLog::NET_NETCONN, "CConnman::%s -- failed to connect to masternode %s too many times\n", __func__, connectToDmn->proTxHash.ToString());
+            for (auto& thread : threads) {
+                thread.join();
+            }
+        }
+
+        for (const auto& [dmn, isProbe] : connectToDmns) {
+            // should be in the list now if connection was opened
+            bool connected = ForNode(dmn->pdmnState->addr, CConnman::AllNodes, [&](CNode* pnode) {
+                if (pnode->fDisconnect) {
+                    return false;
+                }
+                return true;
+            });
+            if (!connected) {
+                LogPrint(BCLog::NET_NETCONN, "CConnman::%s -- connection failed for masternode  %s, service=%s\n", __func__, dmn->proTxHash.ToString(), dmn->pdmnState->addr.ToString(false));
+                // Will take a few consequent failed attempts to PoSe-punish a MN.
+                if (mmetaman->GetMetaInfo(dmn->proTxHash)->OutboundFailedTooManyTimes()) {
+                    LogPrint(BCLog::NET_NETCONN, "CConnman::%s -- failed to connect to masternode %s too many times\n", __func__, dmn->proTxHash.ToString());
+                }
             }
         }
     }
@@ -3858,7 +4030,7 @@ void CConnman::RelayTransaction(const CTransaction& tx)
 {
     uint256 hash = tx.GetHash();
     int nInv = MSG_TX;
-    if (::dstxManager->GetDSTX(hash)) {
+    if (::dstxManager->HasDSTX(hash)) {
         nInv = MSG_DSTX;
     }
     CInv inv(nInv, hash);
@@ -4033,17 +4205,13 @@ CNode::CNode(NodeId idIn, ServiceFlags nLocalServicesIn, SOCKET hSocketIn, const
         m_addr_known = std::make_unique<CRollingBloomFilter>(5000, 0.001);
     }
 
-    for (const std::string &msg : getAllNetMessageTypes())
-        mapRecvBytesPerMsgCmd[msg] = 0;
-    mapRecvBytesPerMsgCmd[NET_MESSAGE_COMMAND_OTHER] = 0;
-
     if (fLogIPs) {
         LogPrint(BCLog::NET, "Added connection to %s peer=%d\n", addrName, id);
     } else {
         LogPrint(BCLog::NET, "Added connection peer=%d\n", id);
     }
 
-    m_deserializer = std::make_unique<V1TransportDeserializer>(V1TransportDeserializer(Params(), GetId(), SER_NETWORK, INIT_PROTO_VERSION));
+    m_deserializer = std::make_unique<V1TransportDeserializer>(V1TransportDeserializer(Params(), GetId(), SER_NETWORK, INIT_PROTO_VERSION, &GetRecvBufferPool()));
     m_serializer = std::make_unique<V1TransportSerializer>(V1TransportSerializer());
 }
 
@@ -4057,7 +4225,7 @@ bool CConnman::NodeFullyConnected(const CNode* pnode)
     return pnode && pnode->fSuccessfullyConnected && !pnode->fDisconnect;
 }
 
-void CConnman::PushMessage(CNode* pnode, CSerializedNetMsg&& msg)
+size_t CConnman::PrepareMessage(CNode* pnode, CSerializedNetMsg& msg, std::vector<unsigned char>& serializedHeader)
 {
     size_t nMessageSize = msg.data.size();
     LogPrint(BCLog::NET, "sending %s (%d bytes) peer=%d\n", SanitizeString(msg.command), nMessageSize, pnode->GetId());
@@ -4066,41 +4234,70 @@ void CConnman::PushMessage(CNode* pnode, CSerializedNetMsg&& msg)
     }
 
     // make sure we use the appropriate network transport format
-    std::vector<unsigned char> serializedHeader;
     pnode->m_serializer->prepareForTransport(msg, serializedHeader);
 
     size_t nTotalSize = nMessageSize + serializedHeader.size();
     statsClient.count("bandwidth.message." + SanitizeString(msg.command.c_str()) + ".bytesSent", nTotalSize, 1.0f);
     statsClient.inc("message.sent." + SanitizeString(msg.command.c_str()), 1.0f);
+    return nTotalSize;
+}
 
+void CConnman::QueueMessage(CNode* pnode, CSerializedNetMsg&& msg, std::vector<unsigned char>&& serializedHeader, size_t nTotalSize)
+{
+    //log total amount of bytes per command
+    pnode->m_send_bytes_per_msg_type[GetNetMessageTypeIndex(msg.command)].fetch_add(nTotalSize, std::memory_order_relaxed);
+    pnode->nSendSize += nTotalSize;
+
+    if (pnode->nSendSize > nSendBufferMaxSize) pnode->fPauseSend = true;
+    pnode->vSendMsg.push_back(std::move(serializedHeader));
+    if (!msg.data.empty()) pnode->vSendMsg.push_back(std::move(msg.data));
+    pnode->nSendMsgSize = pnode->vSendMsg.size();
+}
+
+void CConnman::ScheduleSend(CNode* pnode, bool hasPendingData)
+{
     {
-        LOCK(pnode->cs_vSend);
-        bool hasPendingData = !pnode->vSendMsg.empty();
+        LOCK(cs_mapNodesWithDataToSend);
+        // we're not holding cs_vNodes here, so there is a chance of this node being disconnected shortly before
+        // we get here. Whoever called PushMessage still has a ref to CNode*, but will later Release() it, so we
+        // might end up having an entry in mapNodesWithDataToSend that is not in vNodes anymore. We need to
+        // Add/Release refs when adding/erasing mapNodesWithDataToSend.
+        if (mapNodesWithDataToSend.emplace(pnode->GetId(), pnode).second) {
+            pnode->AddRef();
+        }
+    }
 
-        //log total amount of bytes per command
-        pnode->mapSendBytesPerMsgCmd[msg.command] += nTotalSize;
-        pnode->nSendSize += nTotalSize;
+    // wake up select() call in case there was no pending data before (so it was not selecting this socket for sending)
+    if (!hasPendingData && wakeupSelectNeeded)
+        WakeSelect();
+}
+
+void CConnman::PushMessage(CNode* pnode, CSerializedNetMsg&& msg)
+{
+    std::vector<unsigned char> serializedHeader;
+    const size_t nTotalSize = PrepareMessage(pnode, msg, serializedHeader);
 
-        if (pnode->nSendSize > nSendBufferMaxSize) pnode->fPauseSend = true;
-        pnode->vSendMsg.push_back(std::move(serializedHeader));
-        if (nMessageSize) pnode->vSendMsg.push_back(std::move(msg.data));
-        pnode->nSendMsgSize = pnode->vSendMsg.size();
+    LOCK(pnode->cs_vSend);
+    bool hasPendingData = !pnode->vSendMsg.empty();
+    QueueMessage(pnode, std::move(msg), std::move(serializedHeader), nTotalSize);
+    ScheduleSend(pnode, hasPendingData);
+}
 
-        {
-            LOCK(cs_mapNodesWithDataToSend);
-            // we're not holding cs_vNodes here, so there is a chance of this node being disconnected shortly before
-            // we get here. Whoever called PushMessage still has a ref to CNode*, but will later Release() it, so we
-            // might end up having an entry in mapNodesWithDataToSend that is not in vNodes anymore. We need to
-            // Add/Release refs when adding/erasing mapNodesWithDataToSend.
-            if (mapNodesWithDataToSend.emplace(pnode->GetId(), pnode).second) {
-                pnode->AddRef();
-            }
-        }
+void CConnman::PushMessages(CNode* pnode, std::vector<CSerializedNetMsg>&& msgs)
+{
+    if (msgs.empty()) return;
+    std::vector<std::vector<unsigned char>> serializedHeaders(msgs.size());
+    std::vector<size_t> totalSizes(msgs.size());
+    for (size_t i = 0; i < msgs.size(); ++i) {
+        totalSizes[i] = PrepareMessage(pnode, msgs[i], serializedHeaders[i]);
+    }
 
-        // wake up select() call in case there was no pending data before (so it was not selecting this socket for sending)
-        if (!hasPendingData && wakeupSelectNeeded)
-            WakeSelect();
+    LOCK(pnode->cs_vSend);
+    bool hasPendingData = !pnode->vSendMsg.empty();
+    for (size_t i = 0; i < msgs.size(); ++i) {
+        QueueMessage(pnode, std::move(msgs[i]), std::move(serializedHeaders[i]), totalSizes[i]);
     }
+    ScheduleSend(pnode, hasPendingData);
 }
 
 bool CConnman::ForNode(const CService& addr, std::function<bool(const CNode* pnode)> cond, std::function<bool(CNode* pnode)> func)
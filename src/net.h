@@ -31,7 +31,9 @@
 #include <consensus/params.h>
 #include <util/check.h>
 
+#include <array>
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <cstdint>
 #include <deque>
@@ -40,11 +42,16 @@
 #include <thread>
 #include <optional>
 #include <queue>
+#include <utility>
 
 #ifndef WIN32
 #define USE_WAKEUP_PIPE
 #endif
 
+#ifdef USE_EPOLL
+#include <sys/epoll.h>
+#endif
+
 class CScheduler;
 class CNode;
 class BanMan;
@@ -102,6 +109,10 @@ static const bool DEFAULT_FORCEDNSSEED = false;
 static const size_t DEFAULT_MAXRECEIVEBUFFER = 5 * 1000;
 static const size_t DEFAULT_MAXSENDBUFFER    = 1 * 1000;
 
+/** Default and maximum for -mnconnectparallel, the number of masternode connections opened at once */
+static const int DEFAULT_MASTERNODE_CONNECT_PARALLEL = 8;
+static const int MAX_MASTERNODE_CONNECT_PARALLEL = 32;
+
 #if defined USE_KQUEUE
 #define DEFAULT_SOCKETEVENTS "kqueue"
 #elif defined USE_EPOLL
@@ -356,6 +367,8 @@ public:
     bool IsMasternodeOrDisconnectRequested(const CService& addr);
 
     void PushMessage(CNode* pnode, CSerializedNetMsg&& msg);
+    /** Queue messages which belong together at once, so the socket handler sends them in one go */
+    void PushMessages(CNode* pnode, std::vector<CSerializedNetMsg>&& msgs);
 
     template<typename Condition, typename Callable>
     bool ForEachNodeContinueIf(const Condition& cond, Callable&& func)
@@ -654,6 +667,13 @@ private:
     NodeId GetNewNodeId();
 
     size_t SocketSendData(CNode *pnode);
+    /** Serialize the transport header of msg and count it in the stats, returns the size of header and payload */
+    size_t PrepareMessage(CNode* pnode, CSerializedNetMsg& msg, std::vector<unsigned char>& serializedHeader);
+    /** Append a prepared message to the send queue of pnode */
+    void QueueMessage(CNode* pnode, CSerializedNetMsg&& msg, std::vector<unsigned char>&& serializedHeader, size_t nTotalSize)
+        EXCLUSIVE_LOCKS_REQUIRED(pnode->cs_vSend);
+    /** Have the socket handler send the queue of pnode, hasPendingData is whether it had any before */
+    void ScheduleSend(CNode* pnode, bool hasPendingData) EXCLUSIVE_LOCKS_REQUIRED(pnode->cs_vSend);
     size_t SocketRecvData(CNode* pnode);
     void DumpAddresses();
 
@@ -816,6 +836,8 @@ private:
 #endif
 #ifdef USE_EPOLL
     int epollfd{-1};
+    /** Buffer the events of epoll_wait are returned in, only used by the socket handler thread */
+    std::vector<epoll_event> epollEvents;
 #endif
 
     /** Protected by cs_vNodes */
@@ -993,6 +1015,29 @@ public:
 
 
 
+/**
+ * Receive buffers of processed messages, kept in power of two size classes for the next messages of about the
+ * same size, so the socket handler doesn't allocate a new buffer for each of the many small messages it receives.
+ * A buffer is never more than twice as large as the class of its message, which keeps queued messages from
+ * taking much more memory than their size.
+ */
+class CNetRecvBufferPool
+{
+public:
+    /** An empty buffer with room for size bytes, or for the largest size class if size is larger */
+    CDataStream Get(size_t size, int type, int version);
+    /** Keep the buffer of a processed message for reuse, if its size class isn't full yet */
+    void Put(CDataStream&& buf);
+
+private:
+    static constexpr int MIN_SIZE_BITS = 6;  // 64 bytes
+    static constexpr int MAX_SIZE_BITS = 18; // 256 KiB, as much as V1TransportDeserializer allocates ahead
+    static constexpr size_t MAX_BYTES_PER_CLASS = 1 << 20;
+
+    Mutex m_mutex;
+    std::array<std::vector<CDataStream>, MAX_SIZE_BITS - MIN_SIZE_BITS + 1> m_buffers GUARDED_BY(m_mutex);
+};
+
 /** Transport protocol agnostic message container.
  * Ideally it should only contain receive time, payload,
  * command and size.
@@ -1004,8 +1049,21 @@ public:
     uint32_t m_message_size = 0;         // size of the payload
     uint32_t m_raw_message_size = 0;     // used wire size of the message (including header/checksum)
     std::string m_command;
-
-    CNetMessage(CDataStream&& recv_in) : m_recv(std::move(recv_in)) {}
+    CNetRecvBufferPool* m_buffer_pool{nullptr}; // where m_recv goes back to once the message is processed
+
+    CNetMessage(CDataStream&& recv_in, CNetRecvBufferPool* buffer_pool = nullptr) : m_recv(std::move(recv_in)), m_buffer_pool(buffer_pool) {}
+    CNetMessage(CNetMessage&& other) noexcept
+        : m_recv(std::move(other.m_recv)),
+          m_time(other.m_time),
+          m_message_size(other.m_message_size),
+          m_raw_message_size(other.m_raw_message_size),
+          m_command(std::move(other.m_command)),
+          m_buffer_pool(std::exchange(other.m_buffer_pool, nullptr)) {}
+    CNetMessage& operator=(CNetMessage&&) = delete;
+    ~CNetMessage()
+    {
+        if (m_buffer_pool) m_buffer_pool->Put(std::move(m_recv));
+    }
 
     void SetVersion(int nVersionIn)
     {
@@ -1025,6 +1083,10 @@ public:
     virtual void SetVersion(int version) = 0;
     /** read and deserialize data, advances msg_bytes data pointer */
     virtual int Read(Span<const uint8_t>& msg_bytes) = 0;
+    /** where the next bytes of the payload being received can be written directly, empty outside a payload */
+    virtual Span<uint8_t> GetPayloadBuffer() = 0;
+    /** account for nBytes written to the start of GetPayloadBuffer() */
+    virtual void PayloadReceived(size_t nBytes) = 0;
     // decomposes a message from the context
     virtual std::optional<CNetMessage> GetMessage(int64_t time, uint32_t& out_err) = 0;
     virtual ~TransportDeserializer() {}
@@ -1035,6 +1097,7 @@ class V1TransportDeserializer final : public TransportDeserializer
 private:
     const CChainParams& m_chain_params;
     const NodeId m_node_id; // Only for logging
+    CNetRecvBufferPool* const m_buffer_pool; // Optional, where payload buffers come from
     mutable CHash256 hasher;
     mutable uint256 data_hash;
     bool in_data;                   // parsing header (false) or data (true)
@@ -1060,9 +1123,10 @@ private:
     }
 
 public:
-    V1TransportDeserializer(const CChainParams& chain_params, const NodeId node_id, int nTypeIn, int nVersionIn)
+    V1TransportDeserializer(const CChainParams& chain_params, const NodeId node_id, int nTypeIn, int nVersionIn, CNetRecvBufferPool* buffer_pool = nullptr)
         : m_chain_params(chain_params),
           m_node_id(node_id),
+          m_buffer_pool(buffer_pool),
           hdrbuf(nTypeIn, nVersionIn),
           vRecv(nTypeIn, nVersionIn)
     {
@@ -1090,6 +1154,8 @@ public:
         }
         return ret;
     }
+    Span<uint8_t> GetPayloadBuffer() override;
+    void PayloadReceived(size_t nBytes) override;
     std::optional<CNetMessage> GetMessage(int64_t time, uint32_t& out_err_raw_size) override;
 };
 
@@ -1124,7 +1190,7 @@ public:
     size_t nSendSize GUARDED_BY(cs_vSend){0};
     /** Offset inside the first vSendMsg already sent */
     size_t nSendOffset GUARDED_BY(cs_vSend){0};
-    uint64_t nSendBytes GUARDED_BY(cs_vSend){0};
+    std::atomic<uint64_t> nSendBytes{0};
     std::list<std::vector<unsigned char>> vSendMsg GUARDED_BY(cs_vSend);
     std::atomic<size_t> nSendMsgSize{0};
     RecursiveMutex cs_vSend;
@@ -1137,7 +1203,7 @@ public:
 
     RecursiveMutex cs_sendProcessing;
 
-    uint64_t nRecvBytes GUARDED_BY(cs_vRecv){0};
+    std::atomic<uint64_t> nRecvBytes{0};
 
     std::atomic<int64_t> nLastSend{0};
     std::atomic<int64_t> nLastRecv{0};
@@ -1272,8 +1338,11 @@ public:
     }
 
 protected:
-    mapMsgCmdSize mapSendBytesPerMsgCmd GUARDED_BY(cs_vSend);
-    mapMsgCmdSize mapRecvBytesPerMsgCmd GUARDED_BY(cs_vRecv);
+    // Bytes sent and received per message type, indexed by GetNetMessageTypeIndex() with the last entry for all
+    // unknown types. These are atomic so that copyStats() doesn't wait for the network threads holding cs_vSend
+    // and cs_vRecv. They are independent statistics, so relaxed ordering is enough.
+    const std::unique_ptr<std::atomic<uint64_t>[]> m_send_bytes_per_msg_type{std::make_unique<std::atomic<uint64_t>[]>(getAllNetMessageTypes().size() + 1)};
+    const std::unique_ptr<std::atomic<uint64_t>[]> m_recv_bytes_per_msg_type{std::make_unique<std::atomic<uint64_t>[]>(getAllNetMessageTypes().size() + 1)};
 
 public:
     uint256 hashContinue;
@@ -1314,6 +1383,9 @@ public:
         //    unless it loads a bloom filter.
         bool fRelayTxes GUARDED_BY(cs_filter){false};
         std::unique_ptr<CBloomFilter> pfilter PT_GUARDED_BY(cs_filter) GUARDED_BY(cs_filter){nullptr};
+        // Time spent matching pfilter which isn't paid off yet, it drains at the rate -maxbloomcputime allows
+        std::chrono::microseconds m_bloom_time GUARDED_BY(cs_filter){0};
+        std::chrono::steady_clock::time_point m_bloom_time_updated GUARDED_BY(cs_filter);
 
         mutable RecursiveMutex cs_tx_inventory;
         // inventory based relay
@@ -1366,6 +1438,9 @@ private:
     const NodeId id;
     const uint64_t nLocalHostNonce;
     const ConnectionType m_conn_type;
+
+    /** Move the message the deserializer completed to vRecvMsg, returns false if it had to be dropped */
+    bool TakeCompleteMessage(int64_t nTimeMicros) EXCLUSIVE_LOCKS_REQUIRED(cs_vRecv);
     std::atomic<int> m_greatest_common_version{INIT_PROTO_VERSION};
 
     //! Services offered to this peer.
@@ -1431,6 +1506,18 @@ public:
      */
     bool ReceiveMsgBytes(Span<const uint8_t> msg_bytes, bool& complete);
 
+    /** Where the next bytes of the payload being received can be received directly, without a copy */
+    Span<uint8_t> GetRecvPayloadBuffer() EXCLUSIVE_LOCKS_REQUIRED(cs_vRecv) { return m_deserializer->GetPayloadBuffer(); }
+
+    /**
+     * Like ReceiveMsgBytes, for bytes received right into GetRecvPayloadBuffer(). These can't be
+     * malformed, as the header was checked already.
+     *
+     * @param[in]   nBytes      The number of bytes written to GetRecvPayloadBuffer()
+     * @param[out]  complete    Set True if a message has been completed and is ready to be processed
+     */
+    void ReceivedPayloadBytes(size_t nBytes, bool& complete);
+
     void SetCommonVersion(int greatest_common_version)
     {
         Assume(m_greatest_common_version == INIT_PROTO_VERSION);
@@ -10,7 +10,9 @@
 #include <blockencodings.h>
 #include <blockfilter.h>
 #include <chainparams.h>
+#include <consensus/merkle.h>
 #include <consensus/validation.h>
+#include <core_memusage.h>
 #include <hash.h>
 #include <index/blockfilterindex.h>
 #include <validation.h>
@@ -29,10 +31,13 @@
 #include <tinyformat.h>
 #include <index/txindex.h>
 #include <txmempool.h>
+#include <unordered_lru_cache.h>
 #include <util/check.h> // For NDEBUG compile time check
+#include <util/perfcounters.h>
 #include <util/system.h>
 #include <util/strencodings.h>
 
+#include <array>
 #include <list>
 #include <memory>
 #include <optional>
@@ -65,6 +70,8 @@
 
 #include <statsd_client.h>
 
+#include <ctpl_stl.h>
+
 /** Maximum number of in-flight objects from a peer */
 static constexpr int32_t MAX_PEER_OBJECT_IN_FLIGHT = 100;
 /** Maximum number of announced objects from a peer */
@@ -86,6 +93,8 @@ static const unsigned int MAX_GETDATA_SZ = 1000;
 static constexpr int64_t ORPHAN_TX_EXPIRE_TIME = 20 * 60;
 /** Minimum time between orphan transactions expire time checks in seconds */
 static constexpr int64_t ORPHAN_TX_EXPIRE_INTERVAL = 5 * 60;
+/** Maximum number of orphan transactions reconsidered together in one AcceptToMemoryPoolBatch call */
+static constexpr size_t MAX_ORPHAN_BATCH_SIZE = 100;
 /** How long to cache transactions in mapRelay for normal relay */
 static constexpr std::chrono::seconds RELAY_TX_CACHE_TIME = std::chrono::minutes{15};
 /** How long a transaction has to be in the mempool before it can unconditionally be relayed (even when not in mapRelay). */
@@ -120,8 +129,16 @@ static const int PING_INTERVAL = 2 * 60;
 static const unsigned int MAX_LOCATOR_SZ = 101;
 /** Number of blocks that can be requested at any given time from a single peer. */
 static const int MAX_BLOCKS_IN_TRANSIT_PER_PEER = 16;
+/** During initial block download, the number of blocks in transit from a peer which delivers them quickly grows up to this. */
+static const int MAX_BLOCKS_IN_TRANSIT_PER_PEER_IBD = 64;
+/** How much the in-transit limit of a peer grows once it delivered as many blocks quickly while its queue was full. */
+static const int BLOCKS_IN_TRANSIT_LIMIT_STEP = 4;
 /** Timeout in seconds during which a peer must stall block download progress before being disconnected. */
 static const unsigned int BLOCK_STALLING_TIMEOUT = 2;
+/** A block which arrives later than this after it was requested halves the in-transit limit of the peer. */
+static constexpr auto BLOCK_DOWNLOAD_SLOW_TIME = std::chrono::seconds{BLOCK_STALLING_TIMEOUT};
+/** A block holding up the download window is requested from an idle peer once it has been in flight for this long. */
+static constexpr auto BLOCK_STALLING_REREQUEST_TIME = std::chrono::seconds{1};
 /** Maximum depth of blocks we're willing to serve as compact blocks to peers
  *  when requested. For older blocks, a regular BLOCK response will be sent. */
 static const int MAX_CMPCTBLOCK_DEPTH = 5;
@@ -171,6 +188,43 @@ static constexpr uint32_t MAX_GETCFHEADERS_SIZE = 2000;
 /** the maximum percentage of addresses from our addrman to return in response to a getaddr message. */
 static constexpr size_t MAX_PCT_ADDR_TO_SEND = 23;
 
+/**
+ * Whether messages of this type may be processed by the message processing threads (-msgprocthreads). Their
+ * handlers keep their state behind their own locks and at most look up block indexes, so they are safe to run
+ * besides the message handler thread, the messages of a peer are still processed one at a time and in order.
+ *
+ * MNAUTH is usually the first message after VERACK, it's handed over as such too. When masternodes reconnect
+ * all at once the BLS verification of their MNAUTHs is spread over the threads instead of stalling the handler.
+ */
+static bool IsParallelMessageType(const std::string& msg_type, bool first_message)
+{
+    if (msg_type == NetMsgType::MNAUTH) return true;
+    if (first_message) return false;
+    return msg_type == NetMsgType::QSIGSHARE ||
+           msg_type == NetMsgType::QBSIGSHARES ||
+           msg_type == NetMsgType::MNGOVERNANCEOBJECTVOTE ||
+           msg_type == NetMsgType::DSQUEUE ||
+           msg_type == NetMsgType::QCONTRIB ||
+           msg_type == NetMsgType::QGETDATA;
+}
+
+/**
+ * Masternodes keep long lived connections to each other and to the members of their quorums, these are the peers
+ * we want to hear about new blocks from first, so ChainLock signing can start as early as possible.
+ */
+static bool IsPreferredCmpctPeer(const CNode& node)
+{
+    if (node.m_masternode_probe_connection) return false;
+    return node.m_masternode_connection || !node.GetVerifiedProRegTxHash().IsNull();
+}
+
+/** Peer class used to tell apart block propagation metrics */
+static const char* CmpctPeerClass(const CNode& node)
+{
+    if (node.m_masternode_iqr_connection) return "quorum";
+    return IsPreferredCmpctPeer(node) ? "masternode" : "regular";
+}
+
 struct COrphanTx {
     // When modifying, adapt the copy of this definition in tests/DoS_tests.
     CTransactionRef tx;
@@ -178,6 +232,7 @@ struct COrphanTx {
     int64_t nTimeExpire;
     size_t list_pos;
     size_t nTxSize;
+    size_t nMemUsage;
 };
 
 /** Guards orphan transactions and extra txs for compact blocks */
@@ -187,6 +242,16 @@ RecursiveMutex g_cs_orphans;
 std::map<uint256, COrphanTx> mapOrphanTransactions GUARDED_BY(g_cs_orphans);
 
 size_t nMapOrphanTransactionsSize = 0;
+/** Dynamic memory used by mapOrphanTransactions and mapOrphanTransactionsByPrev */
+size_t nMapOrphanTransactionsUsage = 0;
+
+static perf::Gauge& g_orphans_count{perf::GetGauge("net.orphans.count", "Orphan transactions in the orphan pool")};
+static perf::Gauge& g_orphans_bytes{perf::GetGauge("net.orphans.bytes", "Serialized size of the orphan transactions in the orphan pool")};
+static perf::Gauge& g_orphans_memusage{perf::GetGauge("net.orphans.memusage", "Dynamic memory used by the orphan pool")};
+static perf::Counter& g_orphans_accepted{perf::GetCounter("net.orphans.accepted", "Orphan transactions accepted to the mempool once their parents arrived")};
+static perf::Counter& g_orphans_rejected{perf::GetCounter("net.orphans.rejected", "Orphan transactions rejected once their parents arrived")};
+static perf::Counter& g_orphans_evicted{perf::GetCounter("net.orphans.evicted", "Orphan transactions evicted at random to keep the orphan pool within -maxorphantxsize")};
+static perf::Counter& g_orphans_expired{perf::GetCounter("net.orphans.expired", "Orphan transactions erased because they expired")};
 void EraseOrphansFor(NodeId peer);
 
 // Internal stuff
@@ -197,6 +262,7 @@ struct QueuedBlock {
     const CBlockIndex* pindex;                               //!< Optional.
     bool fValidatedHeaders;                                  //!< Whether this block has validated headers at the time of request.
     std::unique_ptr<PartiallyDownloadedBlock> partialBlock;  //!< Optional, used for CMPCTBLOCK downloads
+    std::chrono::microseconds m_time_requested;              //!< When the block was requested.
 };
 
 /**
@@ -227,6 +293,15 @@ struct Peer {
     Mutex m_getdata_requests_mutex;
     /** Work queue of items requested by this peer **/
     std::deque<CInv> m_getdata_requests GUARDED_BY(m_getdata_requests_mutex);
+    /** Whether the next item of m_getdata_requests waits until the peer is within -maxbloomcputime again **/
+    bool m_getdata_bloom_throttled GUARDED_BY(m_getdata_requests_mutex){false};
+
+    /** Protects the messages handed to the message processing threads **/
+    Mutex m_parallel_msgs_mutex;
+    /** Messages waiting for a message processing thread, in the order they were received **/
+    std::list<CNetMessage> m_parallel_msgs GUARDED_BY(m_parallel_msgs_mutex);
+    /** Whether a message processing thread works on this peer's messages, only one ever does to keep their order **/
+    bool m_parallel_msgs_busy GUARDED_BY(m_parallel_msgs_mutex){false};
 
     explicit Peer(NodeId id) : m_id(id) {}
 };
@@ -246,6 +321,7 @@ public:
     void BlockDisconnected(const std::shared_ptr<const CBlock> &block, const CBlockIndex* pindex) override;
     void UpdatedBlockTip(const CBlockIndex *pindexNew, const CBlockIndex *pindexFork, bool fInitialDownload) override;
     void BlockChecked(const CBlock& block, const BlockValidationState& state) override;
+    void TransactionRemovedFromMempool(const CTransactionRef& tx, MemPoolRemovalReason reason) override;
     void NewPoWValidBlock(const CBlockIndex *pindex, const std::shared_ptr<const CBlock>& pblock) override;
 
     /** Implement NetEventsInterface */
@@ -264,11 +340,21 @@ public:
     void ProcessMessage(CNode& pfrom, const std::string& msg_type, CDataStream& vRecv,
                         int64_t nTimeReceived, const std::atomic<bool>& interruptMsgProc) override;
     bool IsBanned(NodeId pnode) override EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+    void StopMessageProcessing() override;
 
 private:
     /** Helper to process result of external handlers of message */
     void ProcessPeerMsgRet(const PeerMsgRet& ret, CNode& pfrom);
 
+    /** Capture and process a message taken from the receive queue of a peer */
+    void ProcessReceivedMessage(CNode& pfrom, CNetMessage& msg, const std::atomic<bool>& interruptMsgProc);
+
+    /** Process the messages a peer handed to the message processing threads, runs on one of them */
+    void ProcessParallelMessages(CNode& pfrom, Peer& peer, const std::atomic<bool>& interruptMsgProc);
+
+    /** Process TX messages a peer sent back to back, accepting the transactions with AcceptToMemoryPoolBatch */
+    void ProcessTxBatch(CNode& pfrom, Peer& peer, std::list<CNetMessage>& msgs);
+
     /** Consider evicting an outbound peer based on the amount of time they've been behind our tip */
     void ConsiderEviction(CNode& pto, int64_t time_in_seconds) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
@@ -317,6 +403,11 @@ private:
 
     void ProcessOrphanTx(std::set<uint256>& orphan_work_set)
         EXCLUSIVE_LOCKS_REQUIRED(cs_main, g_cs_orphans);
+    /** Relay a transaction we already have again if it came from a peer with forcerelay permission */
+    void ProcessAlreadyHaveTx(CNode& pfrom, const CTransaction& tx) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+    /** Handle the mempool acceptance result of a transaction received from pfrom, dstx is set for DSTX messages */
+    void ProcessTxResult(CNode& pfrom, Peer& peer, const CTransactionRef& ptx, const CCoinJoinBroadcastTx* dstx,
+                         const MempoolAcceptResult& result) EXCLUSIVE_LOCKS_REQUIRED(cs_main, g_cs_orphans);
     /** Process a single headers message from a peer. */
     void ProcessHeadersMessage(CNode& pfrom, const std::vector<CBlockHeader>& headers, bool via_compact_block);
 
@@ -325,6 +416,9 @@ private:
     /** Send a version message to a peer */
     void PushNodeVersion(CNode& pnode, int64_t nTime);
 
+    /** Send a copy of an mnlistdiff or qrinfo message we already serialized for another request */
+    void PushCachedMNListResponse(CNode& pnode, const std::string& msg_type, const std::vector<unsigned char>& data);
+
     const CChainParams& m_chainparams;
     CConnman& m_connman;
     CAddrMan& m_addrman;
@@ -345,6 +439,42 @@ private:
     /** Whether this node is running in blocks only mode */
     const bool m_ignore_incoming_txs;
 
+    /** Whether messages are handed to the message processing threads, see -msgprocthreads */
+    bool m_parallel_msgproc{false};
+    /** Threads processing the messages which need neither the message handler thread nor chainstate */
+    ctpl::thread_pool m_msgproc_pool;
+
+    /** Most TX messages of a peer processed as one batch, see -txbatchsize */
+    const size_t m_tx_batch_size;
+
+    /** Time per second a peer may spend on matching its bloom filter, see -maxbloomcputime */
+    const std::chrono::microseconds m_max_bloom_time;
+    /**
+     * Add time spent on matching the bloom filter of a peer and return whether the peer used more than
+     * m_max_bloom_time allows. Filtered blocks and transaction announcements for it wait while it did.
+     */
+    bool UpdateBloomTime(CNode& node, std::chrono::microseconds time = std::chrono::microseconds{0})
+        EXCLUSIVE_LOCKS_REQUIRED(node.m_tx_relay->cs_filter);
+
+    /** What serving a block as merkleblock needs besides the filter of the peer, the same for all peers */
+    struct FilteredBlockData {
+        std::shared_ptr<const CBlock> block;
+        std::vector<CBloomTxElements> elements;
+        //! all levels of the merkle tree of the block, see ComputeMerkleTree()
+        std::vector<std::vector<uint256>> merkle_tree;
+    };
+
+    /**
+     * The bloom filter elements of recently relayed transactions and the recently served filtered blocks. SPV
+     * wallets ask many nodes for the same recent blocks, they are read and hashed only once.
+     */
+    Mutex m_bloom_elements_mutex;
+    unordered_lru_cache<uint256, std::shared_ptr<const CBloomTxElements>, StaticSaltedHasher, 10000> m_bloom_tx_elements GUARDED_BY(m_bloom_elements_mutex);
+    unordered_lru_cache<uint256, std::shared_ptr<const FilteredBlockData>, StaticSaltedHasher, 16> m_filtered_blocks GUARDED_BY(m_bloom_elements_mutex);
+    std::shared_ptr<const CBloomTxElements> GetBloomTxElements(const CTransaction& tx) EXCLUSIVE_LOCKS_REQUIRED(!m_bloom_elements_mutex);
+    std::shared_ptr<const FilteredBlockData> GetFilteredBlockData(const uint256& hash) EXCLUSIVE_LOCKS_REQUIRED(!m_bloom_elements_mutex);
+    std::shared_ptr<const FilteredBlockData> AddFilteredBlockData(std::shared_ptr<const CBlock> block) EXCLUSIVE_LOCKS_REQUIRED(!m_bloom_elements_mutex);
+
     /** Protects m_peer_map */
     mutable Mutex m_peer_mutex;
     /**
@@ -446,6 +576,18 @@ private:
     int m_outbound_peers_with_protect_from_disconnect GUARDED_BY(cs_main) = 0;
 
     bool AlreadyHave(const CInv& inv) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+    /** Ask the subsystem owning the inventory type, AlreadyHave() checks m_seen_inventory first */
+    bool AlreadyHaveInSubsystem(const CInv& inv) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+
+    /**
+     * Filter for Dash inventory (sporks, DKG messages, recovered sigs, ChainLocks and
+     * InstantSend locks) a subsystem already confirmed to have. These are never
+     * needed again once we had them, so repeated announcements during inv floods
+     * are answered here without taking the locks or doing the database reads of
+     * the subsystems. The hashes of different inventory types can't collide, so
+     * one filter serves all of them.
+     */
+    CRollingBloomFilter m_seen_inventory GUARDED_BY(cs_main){50'000, 0.000'001};
 
     /**
      * Filter for transactions that were recently rejected by
@@ -487,10 +629,15 @@ private:
     Mutex m_recent_confirmed_transactions_mutex;
     CRollingBloomFilter m_recent_confirmed_transactions GUARDED_BY(m_recent_confirmed_transactions_mutex){48'000, 0.000'001};
 
+    /** Serialized mnlistdiff and qrinfo messages we sent recently, cleared on reorgs */
+    CMNListResponseCache m_mnlist_response_cache;
+
     /* Returns a bool indicating whether we requested this block.
      * Also used if a block was /not/ received and timed out or started with another peer
      */
-    bool MarkBlockAsReceived(const uint256& hash) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+    /* If from is the peer the block was requested from, its block download statistics are updated too.
+     */
+    bool MarkBlockAsReceived(const uint256& hash, NodeId from = -1) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
     /* Mark a block as in flight
      * Returns false, still setting pit, if the block was already in flight from the same peer
@@ -501,9 +648,9 @@ private:
     bool TipMayBeStale() EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
     /** Update pindexLastCommonBlock and add not-in-flight missing successors to vBlocks, until it has
-     *  at most count entries.
+     *  at most count entries. If the window can't move, pindexStalled is the block nodeStaller holds it up with.
      */
-    void FindNextBlocksToDownload(NodeId nodeid, unsigned int count, std::vector<const CBlockIndex*>& vBlocks, NodeId& nodeStaller) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+    void FindNextBlocksToDownload(NodeId nodeid, unsigned int count, std::vector<const CBlockIndex*>& vBlocks, NodeId& nodeStaller, const CBlockIndex*& pindexStalled) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
     std::map<uint256, std::pair<NodeId, std::list<QueuedBlock>::iterator> > mapBlocksInFlight GUARDED_BY(cs_main);
 
@@ -598,6 +745,14 @@ struct CNodeState {
     int64_t nDownloadingSince;
     int nBlocksInFlight;
     int nBlocksInFlightValidHeaders;
+    //! How many blocks may be in flight from this peer during IBD, adapted to how fast it delivers them.
+    int m_blocks_in_transit_limit;
+    //! Blocks this peer delivered quickly while its queue was full since its in-transit limit last changed.
+    int m_blocks_fast_at_limit;
+    //! Number of requested blocks this peer delivered.
+    uint64_t m_blocks_received;
+    //! Moving average of the time between requesting a block from this peer and receiving it.
+    std::chrono::microseconds m_block_download_time;
     //! Whether we consider this a preferred download peer.
     bool fPreferredDownload;
     //! Whether this peer wants invs or headers (when possible) for block announcements.
@@ -737,6 +892,10 @@ struct CNodeState {
         nDownloadingSince = 0;
         nBlocksInFlight = 0;
         nBlocksInFlightValidHeaders = 0;
+        m_blocks_in_transit_limit = MAX_BLOCKS_IN_TRANSIT_PER_PEER;
+        m_blocks_fast_at_limit = 0;
+        m_blocks_received = 0;
+        m_block_download_time = std::chrono::microseconds{0};
         fPreferredDownload = false;
         fPreferHeaders = false;
         fPreferHeadersCompressed = false;
@@ -773,12 +932,33 @@ static void UpdatePreferredDownload(const CNode& node, CNodeState* state) EXCLUS
     nPreferredDownload += state->fPreferredDownload;
 }
 
-bool PeerManagerImpl::MarkBlockAsReceived(const uint256& hash)
+/**
+ * Grow the in-transit limit of a peer additively while it keeps up with a full queue, halve it when a
+ * block takes too long. As blocks queue up behind each other, the limit settles where the peer
+ * delivers a full queue within BLOCK_DOWNLOAD_SLOW_TIME.
+ */
+static void UpdateBlockDownloadStats(CNodeState& state, const QueuedBlock& block) EXCLUSIVE_LOCKS_REQUIRED(cs_main)
+{
+    const auto download_time = GetTime<std::chrono::microseconds>() - block.m_time_requested;
+    state.m_block_download_time = state.m_blocks_received++ == 0 ? download_time : (state.m_block_download_time * 7 + download_time) / 8;
+    if (download_time > BLOCK_DOWNLOAD_SLOW_TIME) {
+        state.m_blocks_in_transit_limit = std::max(MAX_BLOCKS_IN_TRANSIT_PER_PEER, state.m_blocks_in_transit_limit / 2);
+        state.m_blocks_fast_at_limit = 0;
+    } else if (state.nBlocksInFlight >= state.m_blocks_in_transit_limit && ++state.m_blocks_fast_at_limit >= state.m_blocks_in_transit_limit) {
+        state.m_blocks_in_transit_limit = std::min(MAX_BLOCKS_IN_TRANSIT_PER_PEER_IBD, state.m_blocks_in_transit_limit + BLOCKS_IN_TRANSIT_LIMIT_STEP);
+        state.m_blocks_fast_at_limit = 0;
+    }
+}
+
+bool PeerManagerImpl::MarkBlockAsReceived(const uint256& hash, NodeId from)
 {
     std::map<uint256, std::pair<NodeId, std::list<QueuedBlock>::iterator> >::iterator itInFlight = mapBlocksInFlight.find(hash);
     if (itInFlight != mapBlocksInFlight.end()) {
         CNodeState *state = State(itInFlight->second.first);
         assert(state != nullptr);
+        if (itInFlight->second.first == from) {
+            UpdateBlockDownloadStats(*state, *itInFlight->second.second);
+        }
         state->nBlocksInFlightValidHeaders -= itInFlight->second.second->fValidatedHeaders;
         if (state->nBlocksInFlightValidHeaders == 0 && itInFlight->second.second->fValidatedHeaders) {
             // Last validated block on the queue was received.
@@ -815,7 +995,7 @@ bool PeerManagerImpl::MarkBlockAsInFlight(NodeId nodeid, const uint256& hash, co
     MarkBlockAsReceived(hash);
 
     std::list<QueuedBlock>::iterator it = state->vBlocksInFlight.insert(state->vBlocksInFlight.end(),
-            {hash, pindex, pindex != nullptr, std::unique_ptr<PartiallyDownloadedBlock>(pit ? new PartiallyDownloadedBlock(&m_mempool) : nullptr)});
+            {hash, pindex, pindex != nullptr, std::unique_ptr<PartiallyDownloadedBlock>(pit ? new PartiallyDownloadedBlock(&m_mempool) : nullptr), GetTime<std::chrono::microseconds>()});
     state->nBlocksInFlight++;
     state->nBlocksInFlightValidHeaders += it->fValidatedHeaders;
     if (state->nBlocksInFlight == 1) {
@@ -852,12 +1032,19 @@ void PeerManagerImpl::MaybeSetPeerAsAnnouncingHeaderAndIDs(NodeId nodeid)
             uint64_t nCMPCTBLOCKVersion = 1;
             if (lNodesAnnouncingHeaderAndIDs.size() >= 3) {
                 // As per BIP152, we only get 3 of our peers to announce
-                // blocks using compact encodings.
-                m_connman.ForNode(lNodesAnnouncingHeaderAndIDs.front(), [this, nCMPCTBLOCKVersion](CNode* pnodeStop){
+                // blocks using compact encodings. Replace the oldest one
+                // which is not a masternode or quorum peer, if there is any.
+                auto itStop = std::find_if(lNodesAnnouncingHeaderAndIDs.begin(), lNodesAnnouncingHeaderAndIDs.end(), [this](NodeId id) {
+                    return !m_connman.ForNode(id, [](CNode* pnode) { return IsPreferredCmpctPeer(*pnode); });
+                });
+                if (itStop == lNodesAnnouncingHeaderAndIDs.end()) {
+                    itStop = lNodesAnnouncingHeaderAndIDs.begin();
+                }
+                m_connman.ForNode(*itStop, [this, nCMPCTBLOCKVersion](CNode* pnodeStop){
                     m_connman.PushMessage(pnodeStop, CNetMsgMaker(pnodeStop->GetCommonVersion()).Make(NetMsgType::SENDCMPCT, /*fAnnounceUsingCMPCTBLOCK=*/false, nCMPCTBLOCKVersion));
                     return true;
                 });
-                lNodesAnnouncingHeaderAndIDs.pop_front();
+                lNodesAnnouncingHeaderAndIDs.erase(itStop);
             }
             m_connman.PushMessage(pfrom, CNetMsgMaker(pfrom->GetCommonVersion()).Make(NetMsgType::SENDCMPCT, /*fAnnounceUsingCMPCTBLOCK=*/true, nCMPCTBLOCKVersion));
             lNodesAnnouncingHeaderAndIDs.push_back(pfrom->GetId());
@@ -925,7 +1112,7 @@ void PeerManagerImpl::UpdateBlockAvailability(NodeId nodeid, const uint256 &hash
     }
 }
 
-void PeerManagerImpl::FindNextBlocksToDownload(NodeId nodeid, unsigned int count, std::vector<const CBlockIndex*>& vBlocks, NodeId& nodeStaller)
+void PeerManagerImpl::FindNextBlocksToDownload(NodeId nodeid, unsigned int count, std::vector<const CBlockIndex*>& vBlocks, NodeId& nodeStaller, const CBlockIndex*& pindexStalled)
 {
     if (count == 0)
         return;
@@ -962,6 +1149,7 @@ void PeerManagerImpl::FindNextBlocksToDownload(NodeId nodeid, unsigned int count
     int nWindowEnd = state->pindexLastCommonBlock->nHeight + BLOCK_DOWNLOAD_WINDOW;
     int nMaxHeight = std::min<int>(state->pindexBestKnownBlock->nHeight, nWindowEnd + 1);
     NodeId waitingfor = -1;
+    const CBlockIndex* pindexWaitingFor = nullptr;
     while (pindexWalk->nHeight < nMaxHeight) {
         // Read up to 128 (or more, if more blocks than that are needed) successors of pindexWalk (towards
         // pindexBestKnownBlock) into vToFetch. We fetch 128, because CBlockIndex::GetAncestor may be as expensive
@@ -993,6 +1181,7 @@ void PeerManagerImpl::FindNextBlocksToDownload(NodeId nodeid, unsigned int count
                     if (vBlocks.size() == 0 && waitingfor != nodeid) {
                         // We aren't able to fetch anything, but we would be if the download window was one larger.
                         nodeStaller = waitingfor;
+                        pindexStalled = pindexWaitingFor;
                     }
                     return;
                 }
@@ -1003,12 +1192,21 @@ void PeerManagerImpl::FindNextBlocksToDownload(NodeId nodeid, unsigned int count
             } else if (waitingfor == -1) {
                 // This is the first already-in-flight block.
                 waitingfor = mapBlocksInFlight[pindex->GetBlockHash()].first;
+                pindexWaitingFor = pindex;
             }
         }
     }
 }
 } // namespace
 
+void PeerManagerImpl::PushCachedMNListResponse(CNode& pnode, const std::string& msg_type, const std::vector<unsigned char>& data)
+{
+    CSerializedNetMsg msg;
+    msg.command = msg_type;
+    msg.data = data;
+    m_connman.PushMessage(&pnode, std::move(msg));
+}
+
 void PeerManagerImpl::PushNodeVersion(CNode& pnode, int64_t nTime)
 {
     const auto& params = Params();
@@ -1312,6 +1510,9 @@ bool PeerManagerImpl::GetNodeStateStats(NodeId nodeid, CNodeStateStats &stats)
             if (queue.pindex)
                 stats.vHeightInFlight.push_back(queue.pindex->nHeight);
         }
+        stats.m_blocks_in_transit_limit = state->m_blocks_in_transit_limit;
+        stats.m_blocks_received = state->m_blocks_received;
+        stats.m_block_download_time = state->m_block_download_time;
     }
 
     PeerRef peer = GetPeerRef(nodeid);
@@ -1357,7 +1558,11 @@ bool AddOrphanTx(const CTransactionRef& tx, NodeId peer) EXCLUSIVE_LOCKS_REQUIRE
         return false;
     }
 
-    auto ret = mapOrphanTransactions.emplace(hash, COrphanTx{tx, peer, GetTime() + ORPHAN_TX_EXPIRE_TIME, g_orphan_list.size(), sz});
+    // The transaction, its entry in mapOrphanTransactions and g_orphan_list, and at most one
+    // entry in mapOrphanTransactionsByPrev and its set per input
+    const size_t mem_usage = RecursiveDynamicUsage(tx) + memusage::IncrementalDynamicUsage(mapOrphanTransactions) + sizeof(void*) +
+                             tx->vin.size() * (memusage::IncrementalDynamicUsage(mapOrphanTransactionsByPrev) + memusage::MallocUsage(sizeof(memusage::stl_tree_node<void*>)));
+    auto ret = mapOrphanTransactions.emplace(hash, COrphanTx{tx, peer, GetTime() + ORPHAN_TX_EXPIRE_TIME, g_orphan_list.size(), sz, mem_usage});
     assert(ret.second);
     g_orphan_list.push_back(ret.first);
     for (const CTxIn& txin : tx->vin) {
@@ -1367,6 +1572,10 @@ bool AddOrphanTx(const CTransactionRef& tx, NodeId peer) EXCLUSIVE_LOCKS_REQUIRE
     AddToCompactExtraTransactions(tx);
 
     nMapOrphanTransactionsSize += sz;
+    nMapOrphanTransactionsUsage += mem_usage;
+    g_orphans_count.Set(mapOrphanTransactions.size());
+    g_orphans_bytes.Set(nMapOrphanTransactionsSize);
+    g_orphans_memusage.Set(nMapOrphanTransactionsUsage);
 
     LogPrint(BCLog::MEMPOOL, "stored orphan tx %s (mapsz %u outsz %u)\n", hash.ToString(),
              mapOrphanTransactions.size(), mapOrphanTransactionsByPrev.size());
@@ -1403,7 +1612,12 @@ int static EraseOrphanTx(uint256 hash) EXCLUSIVE_LOCKS_REQUIRED(g_cs_orphans)
 
     assert(nMapOrphanTransactionsSize >= it->second.nTxSize);
     nMapOrphanTransactionsSize -= it->second.nTxSize;
+    assert(nMapOrphanTransactionsUsage >= it->second.nMemUsage);
+    nMapOrphanTransactionsUsage -= it->second.nMemUsage;
     mapOrphanTransactions.erase(it);
+    g_orphans_count.Set(mapOrphanTransactions.size());
+    g_orphans_bytes.Set(nMapOrphanTransactionsSize);
+    g_orphans_memusage.Set(nMapOrphanTransactionsUsage);
     statsClient.inc("transactions.orphans.remove", 1.0f);
     statsClient.gauge("transactions.orphans", mapOrphanTransactions.size());
     return 1;
@@ -1449,6 +1663,7 @@ unsigned int LimitOrphanTxSize(unsigned int nMaxOrphansSize)
         }
         // Sweep again 5 minutes after the next entry that expires in order to batch the linear scan.
         nNextSweep = nMinExpTime + ORPHAN_TX_EXPIRE_INTERVAL;
+        g_orphans_expired.Add(nErased);
         if (nErased > 0) LogPrint(BCLog::MEMPOOL, "Erased %d orphan tx due to expiration\n", nErased);
     }
     FastRandomContext rng;
@@ -1459,6 +1674,7 @@ unsigned int LimitOrphanTxSize(unsigned int nMaxOrphansSize)
         EraseOrphanTx(g_orphan_list[randompos]->first);
         ++nEvicted;
     }
+    g_orphans_evicted.Add(nEvicted);
     return nEvicted;
 }
 
@@ -1606,7 +1822,9 @@ PeerManagerImpl::PeerManagerImpl(const CChainParams& chainparams, CConnman& conn
       m_cj_ctx(cj_ctx),
       m_llmq_ctx(llmq_ctx),
       m_govman(govman),
-      m_ignore_incoming_txs(ignore_incoming_txs)
+      m_ignore_incoming_txs(ignore_incoming_txs),
+      m_tx_batch_size(std::clamp<int>(gArgs.GetArg("-txbatchsize", DEFAULT_TX_BATCH_SIZE), 0, MAX_TX_BATCH_SIZE)),
+      m_max_bloom_time(std::chrono::milliseconds{std::clamp<int64_t>(gArgs.GetArg("-maxbloomcputime", DEFAULT_MAX_BLOOM_CPU_TIME), 0, 1000)})
 {
     assert(std::addressof(g_chainman) == std::addressof(m_chainman));
     // Stale tip checking and peer eviction are on two different timers, but we
@@ -1619,6 +1837,20 @@ PeerManagerImpl::PeerManagerImpl(const CChainParams& chainparams, CConnman& conn
     // schedule next run for 10-15 minutes in the future
     const std::chrono::milliseconds delta = std::chrono::minutes{10} + GetRandMillis(std::chrono::minutes{5});
     scheduler.scheduleFromNow([&] { ReattemptInitialBroadcast(scheduler); }, delta);
+
+    const int msgproc_threads = std::clamp<int>(gArgs.GetArg("-msgprocthreads", DEFAULT_MSGPROC_THREADS), 0, MAX_MSGPROC_THREADS);
+    if (msgproc_threads > 0) {
+        m_msgproc_pool.resize(msgproc_threads);
+        RenameThreadPool(m_msgproc_pool, "msgproc");
+        m_parallel_msgproc = true;
+    }
+}
+
+void PeerManagerImpl::StopMessageProcessing()
+{
+    // Queued work only finishes quickly, it stops as soon as it sees the message handler was interrupted
+    m_msgproc_pool.stop(true);
+    m_parallel_msgproc = false;
 }
 
 /**
@@ -1691,8 +1923,22 @@ void PeerManagerImpl::BlockDisconnected(const std::shared_ptr<const CBlock> &blo
     // block's worth of transactions in it, but that should be fine, since
     // presumably the most common case of relaying a confirmed transaction
     // should be just after a new block containing it is found.
-    LOCK(m_recent_confirmed_transactions_mutex);
-    m_recent_confirmed_transactions.reset();
+    {
+        LOCK(m_recent_confirmed_transactions_mutex);
+        m_recent_confirmed_transactions.reset();
+    }
+    m_mnlist_response_cache.Clear();
+}
+
+/**
+ * Keep transactions which left the mempool without being mined, e.g. the ones conflicting with an InstantSend lock or
+ * expired, around for compact block reconstruction. Blocks of other miners may well still include them.
+ */
+void PeerManagerImpl::TransactionRemovedFromMempool(const CTransactionRef& tx, MemPoolRemovalReason reason)
+{
+    if (reason == MemPoolRemovalReason::BLOCK) return;
+    LOCK(g_cs_orphans);
+    AddToCompactExtraTransactions(tx);
 }
 
 // All of the following cache a recent block, and are protected by cs_most_recent_block
@@ -1823,7 +2069,101 @@ void PeerManagerImpl::BlockChecked(const CBlock& block, const BlockValidationSta
 //
 
 
+/** Inventory types which can be answered by m_seen_inventory, see there */
+static bool IsSeenInventoryType(int type)
+{
+    switch (type) {
+    case MSG_SPORK:
+    case MSG_QUORUM_CONTRIB:
+    case MSG_QUORUM_COMPLAINT:
+    case MSG_QUORUM_JUSTIFICATION:
+    case MSG_QUORUM_PREMATURE_COMMITMENT:
+    case MSG_QUORUM_RECOVERED_SIG:
+    case MSG_CLSIG:
+    case MSG_ISDLOCK:
+        return true;
+    }
+    return false;
+}
+
+/** Subsystem answering AlreadyHave() for an inventory type, used for stats */
+enum class AlreadyHaveSubsystem : size_t {
+    MEMPOOL,
+    SPORK,
+    GOVERNANCE,
+    QUORUM_BLOCK_PROCESSOR,
+    DKG,
+    SIGMAN,
+    CLHANDLER,
+    ISMAN,
+    UNKNOWN,
+    COUNT,
+};
+
+/** Names of the AlreadyHaveSubsystem values, in the same order */
+static constexpr std::array<const char*, size_t(AlreadyHaveSubsystem::COUNT)> ALREADY_HAVE_SUBSYSTEM_NAMES{
+    "mempool", "spork", "governance", "quorum_block_processor", "dkg", "sigman", "clhandler", "isman", "unknown"};
+static_assert(ALREADY_HAVE_SUBSYSTEM_NAMES.back() != nullptr, "every AlreadyHaveSubsystem needs a name");
+
+static AlreadyHaveSubsystem GetAlreadyHaveSubsystem(int type)
+{
+    switch (type) {
+    case MSG_TX:
+    case MSG_DSTX:
+        return AlreadyHaveSubsystem::MEMPOOL;
+    case MSG_SPORK:
+        return AlreadyHaveSubsystem::SPORK;
+    case MSG_GOVERNANCE_OBJECT:
+    case MSG_GOVERNANCE_OBJECT_VOTE:
+        return AlreadyHaveSubsystem::GOVERNANCE;
+    case MSG_QUORUM_FINAL_COMMITMENT:
+        return AlreadyHaveSubsystem::QUORUM_BLOCK_PROCESSOR;
+    case MSG_QUORUM_CONTRIB:
+    case MSG_QUORUM_COMPLAINT:
+    case MSG_QUORUM_JUSTIFICATION:
+    case MSG_QUORUM_PREMATURE_COMMITMENT:
+        return AlreadyHaveSubsystem::DKG;
+    case MSG_QUORUM_RECOVERED_SIG:
+        return AlreadyHaveSubsystem::SIGMAN;
+    case MSG_CLSIG:
+        return AlreadyHaveSubsystem::CLHANDLER;
+    case MSG_ISDLOCK:
+        return AlreadyHaveSubsystem::ISMAN;
+    }
+    return AlreadyHaveSubsystem::UNKNOWN;
+}
+
+/** The "inv.alreadyhave.<subsystem>.<have|new>" stat name of an inventory, built once for each subsystem */
+static const std::string& AlreadyHaveStatName(int type, bool fAlreadyHave)
+{
+    static const auto names = [] {
+        std::array<std::array<std::string, 2>, size_t(AlreadyHaveSubsystem::COUNT)> ret;
+        for (size_t i = 0; i < ret.size(); ++i) {
+            ret[i] = {strprintf("inv.alreadyhave.%s.new", ALREADY_HAVE_SUBSYSTEM_NAMES[i]),
+                      strprintf("inv.alreadyhave.%s.have", ALREADY_HAVE_SUBSYSTEM_NAMES[i])};
+        }
+        return ret;
+    }();
+    return names[size_t(GetAlreadyHaveSubsystem(type))][fAlreadyHave];
+}
+
 bool PeerManagerImpl::AlreadyHave(const CInv& inv)
+{
+    const bool fSeenType = IsSeenInventoryType(inv.type);
+    if (fSeenType && m_seen_inventory.contains(inv.hash)) {
+        statsClient.inc("inv.alreadyhave.seen_filter", 1.0f);
+        return true;
+    }
+
+    const bool fAlreadyHave = AlreadyHaveInSubsystem(inv);
+    statsClient.inc(AlreadyHaveStatName(inv.type, fAlreadyHave), 1.0f);
+    if (fSeenType && fAlreadyHave) {
+        m_seen_inventory.insert(inv.hash);
+    }
+    return fAlreadyHave;
+}
+
+bool PeerManagerImpl::AlreadyHaveInSubsystem(const CInv& inv)
 {
     switch (inv.type)
     {
@@ -1867,7 +2207,7 @@ bool PeerManagerImpl::AlreadyHave(const CInv& inv)
                                         m_llmq_ctx->isman->IsLocked(inv.hash);
 
             return (!fIgnoreRecentRejects && m_recent_rejects.contains(inv.hash)) ||
-                   (inv.IsMsgDstx() && static_cast<bool>(::dstxManager->GetDSTX(inv.hash))) ||
+                   (inv.IsMsgDstx() && ::dstxManager->HasDSTX(inv.hash)) ||
                    m_mempool.exists(inv.hash) ||
                    (g_txindex != nullptr && g_txindex->HasTx(inv.hash));
         }
@@ -1917,7 +2257,7 @@ bool PeerManagerImpl::AlreadyHaveBlock(const uint256& block_hash)
 
 void PeerManagerImpl::RelayTransaction(const uint256& txid)
 {
-    CInv inv(::dstxManager->GetDSTX(txid) ? MSG_DSTX : MSG_TX, txid);
+    CInv inv(::dstxManager->HasDSTX(txid) ? MSG_DSTX : MSG_TX, txid);
     m_connman.ForEachNode([&inv](CNode* pnode)
     {
         pnode->PushInventory(inv);
@@ -1963,6 +2303,59 @@ static void RelayAddress(const CAddress& addr, bool fReachable, const CConnman&
     connman.ForEachNodeThen(std::move(sortfunc), std::move(pushfunc));
 }
 
+static perf::Counter& g_bloom_time{perf::GetCounter("net.bloom.time_us", "Microseconds spent matching the bloom filters of peers")};
+static perf::Counter& g_bloom_throttled{perf::GetCounter("net.bloom.throttled", "Times a filtered block or transaction announcement waited because the peer exceeded -maxbloomcputime")};
+
+bool PeerManagerImpl::UpdateBloomTime(CNode& node, std::chrono::microseconds time)
+{
+    auto& tx_relay = *node.m_tx_relay;
+    g_bloom_time.Add(time.count());
+    if (m_max_bloom_time == 0us) return false;
+
+    const auto now = std::chrono::steady_clock::now();
+    // Ten seconds of draining pay off any burst which was allowed to start
+    const auto elapsed = std::min<std::chrono::microseconds>(std::chrono::duration_cast<std::chrono::microseconds>(now - tx_relay.m_bloom_time_updated), 10s);
+    const std::chrono::microseconds drained{elapsed.count() * m_max_bloom_time.count() / 1000000};
+    tx_relay.m_bloom_time = std::max(tx_relay.m_bloom_time - drained, 0us) + time;
+    tx_relay.m_bloom_time_updated = now;
+    return tx_relay.m_bloom_time > m_max_bloom_time;
+}
+
+std::shared_ptr<const CBloomTxElements> PeerManagerImpl::GetBloomTxElements(const CTransaction& tx)
+{
+    std::shared_ptr<const CBloomTxElements> elements;
+    if (WITH_LOCK(m_bloom_elements_mutex, return m_bloom_tx_elements.get(tx.GetHash(), elements))) {
+        return elements;
+    }
+    elements = std::make_shared<const CBloomTxElements>(tx);
+    WITH_LOCK(m_bloom_elements_mutex, m_bloom_tx_elements.insert(tx.GetHash(), elements));
+    return elements;
+}
+
+std::shared_ptr<const PeerManagerImpl::FilteredBlockData> PeerManagerImpl::GetFilteredBlockData(const uint256& hash)
+{
+    std::shared_ptr<const FilteredBlockData> data;
+    LOCK(m_bloom_elements_mutex);
+    m_filtered_blocks.get(hash, data);
+    return data;
+}
+
+std::shared_ptr<const PeerManagerImpl::FilteredBlockData> PeerManagerImpl::AddFilteredBlockData(std::shared_ptr<const CBlock> block)
+{
+    auto data = std::make_shared<FilteredBlockData>();
+    data->elements.reserve(block->vtx.size());
+    std::vector<uint256> txids;
+    txids.reserve(block->vtx.size());
+    for (const auto& tx : block->vtx) {
+        data->elements.emplace_back(*tx);
+        txids.push_back(tx->GetHash());
+    }
+    data->merkle_tree = ComputeMerkleTree(std::move(txids));
+    data->block = std::move(block);
+    WITH_LOCK(m_bloom_elements_mutex, m_filtered_blocks.insert(data->block->GetHash(), data));
+    return data;
+}
+
 void PeerManagerImpl::ProcessGetBlockData(CNode& pfrom, const CChainParams& chainparams, const CInv& inv, CConnman& connman, llmq::CInstantSendManager& isman)
 {
     bool send = false;
@@ -2034,8 +2427,22 @@ void PeerManagerImpl::ProcessGetBlockData(CNode& pfrom, const CChainParams& chai
     if (send && (pindex->nStatus & BLOCK_HAVE_DATA))
     {
         std::shared_ptr<const CBlock> pblock;
-        if (a_recent_block && a_recent_block->GetHash() == pindex->GetBlockHash()) {
+        std::shared_ptr<const FilteredBlockData> filtered_block;
+        if (inv.IsMsgFilteredBlk() && (filtered_block = GetFilteredBlockData(pindex->GetBlockHash()))) {
+            pblock = filtered_block->block;
+        } else if (a_recent_block && a_recent_block->GetHash() == pindex->GetBlockHash()) {
             pblock = a_recent_block;
+        } else if (inv.IsMsgBlk()) {
+            // Fast-path: the network format of the block matches the one on disk, so it is sent as
+            // it is stored instead of being deserialized, checked and serialized again. The data is
+            // moved into the send queue of the peer without being copied.
+            CSerializedNetMsg msg;
+            msg.command = NetMsgType::BLOCK;
+            if (!ReadRawBlockFromDisk(msg.data, pindex->GetBlockPos(), chainparams.MessageStart()))
+                assert(!"cannot load block from disk");
+            statsClient.count("blocks.served.raw_bytes", msg.data.size(), 1.0f);
+            connman.PushMessage(&pfrom, std::move(msg));
+            // Don't set pblock as we've sent the block
         } else {
             // Send block from disk
             std::shared_ptr<CBlock> pblockRead = std::make_shared<CBlock>();
@@ -2052,28 +2459,34 @@ void PeerManagerImpl::ProcessGetBlockData(CNode& pfrom, const CChainParams& chai
                 if (pfrom.RelayAddrsWithConn()) {
                     LOCK(pfrom.m_tx_relay->cs_filter);
                     if (pfrom.m_tx_relay->pfilter) {
+                        if (!filtered_block) filtered_block = AddFilteredBlockData(pblock);
                         sendMerkleBlock = true;
-                        merkleBlock = CMerkleBlock(*pblock, *pfrom.m_tx_relay->pfilter);
+                        const auto start = std::chrono::steady_clock::now();
+                        merkleBlock = CMerkleBlock(*pblock, *pfrom.m_tx_relay->pfilter, filtered_block->elements, filtered_block->merkle_tree);
+                        UpdateBloomTime(pfrom, std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start));
                     }
                 }
                 if (sendMerkleBlock) {
-                    connman.PushMessage(&pfrom, msgMaker.Make(NetMsgType::MERKLEBLOCK, merkleBlock));
+                    std::vector<CSerializedNetMsg> msgs;
+                    msgs.reserve(1 + 2 * merkleBlock.vMatchedTxn.size());
+                    msgs.push_back(msgMaker.Make(NetMsgType::MERKLEBLOCK, merkleBlock));
                     // CMerkleBlock just contains hashes, so also push any transactions in the block the client did not see
                     // This avoids hurting performance by pointlessly requiring a round-trip
                     // Note that there is currently no way for a node to request any single transactions we didn't send here -
                     // they must either disconnect and retry or request the full block.
                     // Thus, the protocol spec specified allows for us to provide duplicate txn here,
                     // however we MUST always provide at least what the remote peer needs
-                    typedef std::pair<unsigned int, uint256> PairType;
-                    for (PairType &pair : merkleBlock.vMatchedTxn) {
-                        connman.PushMessage(&pfrom, msgMaker.Make(NetMsgType::TX, *pblock->vtx[pair.first]));
+                    for (const auto& [tx_index, txid] : merkleBlock.vMatchedTxn) {
+                        msgs.push_back(msgMaker.Make(NetMsgType::TX, *pblock->vtx[tx_index]));
                     }
-                    for (PairType &pair : merkleBlock.vMatchedTxn) {
-                        auto islock = isman.GetInstantSendLockByTxid(pair.second);
+                    for (const auto& [tx_index, txid] : merkleBlock.vMatchedTxn) {
+                        auto islock = isman.GetInstantSendLockByTxid(txid);
                         if (islock != nullptr) {
-                            connman.PushMessage(&pfrom, msgMaker.Make(NetMsgType::ISDLOCK, *islock));
+                            msgs.push_back(msgMaker.Make(NetMsgType::ISDLOCK, *islock));
                         }
                     }
+                    // the block, its transactions and their locks leave in one burst
+                    connman.PushMessages(&pfrom, std::move(msgs));
                 }
                 // else
                     // no response
@@ -2314,9 +2727,15 @@ void PeerManagerImpl::ProcessGetData(CNode& pfrom, Peer& peer, const std::atomic
         }
     }
 
+    // A filtered block waits while the peer is over its bloom filter budget, ProcessMessages doesn't count that
+    // as more work, so the request is retried when the message handler wakes up next
+    peer.m_getdata_bloom_throttled = it != peer.m_getdata_requests.end() && it->IsMsgFilteredBlk() && pfrom.RelayAddrsWithConn() &&
+                                     WITH_LOCK(pfrom.m_tx_relay->cs_filter, return pfrom.m_tx_relay->pfilter && UpdateBloomTime(pfrom));
+    if (peer.m_getdata_bloom_throttled) g_bloom_throttled.Add();
+
     // Only process one BLOCK item per call, since they're uncommon and can be
     // expensive to process.
-    if (it != peer.m_getdata_requests.end() && !pfrom.fPauseSend) {
+    if (it != peer.m_getdata_requests.end() && !pfrom.fPauseSend && !peer.m_getdata_bloom_throttled) {
         const CInv &inv = *it++;
         if (inv.IsGenBlkMsg()) {
             ProcessGetBlockData(pfrom, m_chainparams, inv, m_connman, *m_llmq_ctx->isman);
@@ -2370,6 +2789,9 @@ void PeerManagerImpl::ProcessHeadersMessage(CNode& pfrom, const std::vector<CBlo
         return;
     }
 
+    // Hash every header once, in parallel and before taking cs_main, and reuse the results below
+    const std::vector<uint256> hashes = HashBlockHeaders(headers);
+
     bool received_new_header = false;
     const CBlockIndex *pindexLast = nullptr;
     {
@@ -2389,7 +2811,7 @@ void PeerManagerImpl::ProcessHeadersMessage(CNode& pfrom, const std::vector<CBlo
             std::string msg_type = (pfrom.nServices & NODE_HEADERS_COMPRESSED) ? NetMsgType::GETHEADERS2 : NetMsgType::GETHEADERS;
             m_connman.PushMessage(&pfrom, msgMaker.Make(msg_type, m_chainman.ActiveChain().GetLocator(pindexBestHeader), uint256()));
             LogPrint(BCLog::NET, "received header %s: missing prev block %s, sending %s (%d) to end (peer=%d, nUnconnectingHeaders=%d)\n",
-                    headers[0].GetHash().ToString(),
+                    hashes[0].ToString(),
                     headers[0].hashPrevBlock.ToString(),
                     msg_type,
                     pindexBestHeader->nHeight,
@@ -2397,7 +2819,7 @@ void PeerManagerImpl::ProcessHeadersMessage(CNode& pfrom, const std::vector<CBlo
             // Set hashLastUnknownBlock for this peer, so that if we
             // eventually get the headers - even from a different peer -
             // we can use this peer to download.
-            UpdateBlockAvailability(pfrom.GetId(), headers.back().GetHash());
+            UpdateBlockAvailability(pfrom.GetId(), hashes.back());
 
             if (nodestate->nUnconnectingHeaders % MAX_UNCONNECTING_HEADERS == 0) {
                 Misbehaving(pfrom.GetId(), 20, strprintf("%d non-connecting headers", nodestate->nUnconnectingHeaders));
@@ -2406,12 +2828,12 @@ void PeerManagerImpl::ProcessHeadersMessage(CNode& pfrom, const std::vector<CBlo
         }
 
         uint256 hashLastBlock;
-        for (const CBlockHeader& header : headers) {
-            if (!hashLastBlock.IsNull() && header.hashPrevBlock != hashLastBlock) {
+        for (size_t i = 0; i < headers.size(); ++i) {
+            if (!hashLastBlock.IsNull() && headers[i].hashPrevBlock != hashLastBlock) {
                 Misbehaving(pfrom.GetId(), 20, "non-continuous headers sequence");
                 return;
             }
-            hashLastBlock = header.GetHash();
+            hashLastBlock = hashes[i];
         }
 
         // If we don't have the last header, then they'll have given us
@@ -2422,7 +2844,7 @@ void PeerManagerImpl::ProcessHeadersMessage(CNode& pfrom, const std::vector<CBlo
     }
 
     BlockValidationState state;
-    if (!m_chainman.ProcessNewBlockHeaders(headers, state, m_chainparams, &pindexLast)) {
+    if (!m_chainman.ProcessNewBlockHeaders(headers, hashes, state, m_chainparams, &pindexLast)) {
         if (state.IsInvalid()) {
             MaybePunishNodeForBlock(pfrom.GetId(), state, via_compact_block, "invalid header received");
             return;
@@ -2547,54 +2969,75 @@ void PeerManagerImpl::ProcessHeadersMessage(CNode& pfrom, const std::vector<CBlo
  * Reconsider orphan transactions after a parent has been accepted to the mempool.
  *
  * @param[in/out]  orphan_work_set  The set of orphan transactions to reconsider. Generally only one
- *                                  orphan will be reconsidered on each call of this function. This set
- *                                  may be added to if accepting an orphan causes its children to be
- *                                  reconsidered.
+ *                                  orphan will be reconsidered on each call of this function. With
+ *                                  -txbatchsize, up to MAX_ORPHAN_BATCH_SIZE orphans are taken from it
+ *                                  and accepted together with AcceptToMemoryPoolBatch instead, so that
+ *                                  their scripts are checked on the script check threads. This set may be
+ *                                  added to if accepting an orphan causes its children to be reconsidered.
  */
 void PeerManagerImpl::ProcessOrphanTx(std::set<uint256>& orphan_work_set)
 {
     AssertLockHeld(cs_main);
     AssertLockHeld(g_cs_orphans);
 
-    while (!orphan_work_set.empty()) {
-        const uint256 orphanHash = *orphan_work_set.begin();
-        orphan_work_set.erase(orphan_work_set.begin());
-
-        auto orphan_it = mapOrphanTransactions.find(orphanHash);
-        if (orphan_it == mapOrphanTransactions.end()) continue;
-
-        const CTransactionRef porphanTx = orphan_it->second.tx;
-        const MempoolAcceptResult result = AcceptToMemoryPool(m_chainman.ActiveChainstate(), m_mempool, porphanTx, false /* bypass_limits */);
-        const TxValidationState& state = result.m_state;
-
-        if (result.m_result_type == MempoolAcceptResult::ResultType::VALID) {
-            LogPrint(BCLog::MEMPOOL, "   accepted orphan tx %s\n", orphanHash.ToString());
-            RelayTransaction(porphanTx->GetHash());
-            for (unsigned int i = 0; i < porphanTx->vout.size(); i++) {
-                auto it_by_prev = mapOrphanTransactionsByPrev.find(COutPoint(orphanHash, i));
-                if (it_by_prev != mapOrphanTransactionsByPrev.end()) {
-                    for (const auto& elem : it_by_prev->second) {
-                        orphan_work_set.insert(elem->first);
+    const size_t max_orphans = m_tx_batch_size > 1 ? MAX_ORPHAN_BATCH_SIZE : 1;
+    bool done{false};
+    while (!done && !orphan_work_set.empty()) {
+        std::vector<CTransactionRef> orphans;
+        std::vector<NodeId> from_peers;
+        while (!orphan_work_set.empty() && orphans.size() < max_orphans) {
+            const uint256 orphanHash = *orphan_work_set.begin();
+            orphan_work_set.erase(orphan_work_set.begin());
+
+            auto orphan_it = mapOrphanTransactions.find(orphanHash);
+            if (orphan_it == mapOrphanTransactions.end()) continue;
+
+            orphans.push_back(orphan_it->second.tx);
+            from_peers.push_back(orphan_it->second.fromPeer);
+        }
+        if (orphans.empty()) break;
+
+        // A batch is only reconsidered once per call, single orphans until one of them is accepted or rejected
+        done = max_orphans > 1;
+        const std::vector<MempoolAcceptResult> results = max_orphans > 1 ?
+            AcceptToMemoryPoolBatch(m_chainman.ActiveChainstate(), m_mempool, orphans) :
+            std::vector<MempoolAcceptResult>{AcceptToMemoryPool(m_chainman.ActiveChainstate(), m_mempool, orphans[0], false /* bypass_limits */)};
+        for (size_t i = 0; i < orphans.size(); ++i) {
+            const CTransactionRef& porphanTx = orphans[i];
+            const uint256& orphanHash = porphanTx->GetHash();
+            const TxValidationState& state = results[i].m_state;
+
+            if (results[i].m_result_type == MempoolAcceptResult::ResultType::VALID) {
+                LogPrint(BCLog::MEMPOOL, "   accepted orphan tx %s\n", orphanHash.ToString());
+                RelayTransaction(orphanHash);
+                for (unsigned int j = 0; j < porphanTx->vout.size(); j++) {
+                    auto it_by_prev = mapOrphanTransactionsByPrev.find(COutPoint(orphanHash, j));
+                    if (it_by_prev != mapOrphanTransactionsByPrev.end()) {
+                        for (const auto& elem : it_by_prev->second) {
+                            orphan_work_set.insert(elem->first);
+                        }
                     }
                 }
+                EraseOrphanTx(orphanHash);
+                g_orphans_accepted.Add();
+                done = true;
+            } else if (state.GetResult() != TxValidationResult::TX_MISSING_INPUTS) {
+                if (state.IsInvalid()) {
+                    LogPrint(BCLog::MEMPOOL, "   invalid orphan tx %s from peer=%d. %s\n",
+                        orphanHash.ToString(),
+                        from_peers[i],
+                        state.ToString());
+                    // Maybe punish peer that gave us an invalid orphan tx
+                    MaybePunishNodeForTx(from_peers[i], state);
+                }
+                // Has inputs but not accepted to mempool
+                // Probably non-standard or insufficient fee
+                LogPrint(BCLog::MEMPOOL, "   removed orphan tx %s\n", orphanHash.ToString());
+                m_recent_rejects.insert(orphanHash);
+                EraseOrphanTx(orphanHash);
+                g_orphans_rejected.Add();
+                done = true;
             }
-            EraseOrphanTx(orphanHash);
-            break;
-        } else if (state.GetResult() != TxValidationResult::TX_MISSING_INPUTS) {
-            if (state.IsInvalid()) {
-                LogPrint(BCLog::MEMPOOL, "   invalid orphan tx %s from peer=%d. %s\n",
-                    orphanHash.ToString(),
-                    orphan_it->second.fromPeer,
-                    state.ToString());
-                // Maybe punish peer that gave us an invalid orphan tx
-                MaybePunishNodeForTx(orphan_it->second.fromPeer, state);
-            }
-            // Has inputs but not accepted to mempool
-            // Probably non-standard or insufficient fee
-            LogPrint(BCLog::MEMPOOL, "   removed orphan tx %s\n", orphanHash.ToString());
-            m_recent_rejects.insert(orphanHash);
-            EraseOrphanTx(orphanHash);
-            break;
         }
     }
     m_mempool.check(m_chainman.ActiveChainstate());
@@ -2779,7 +3222,7 @@ std::pair<bool /*ret*/, bool /*do_return*/> static ValidateDSTX(CTxMemPool& memp
         LogPrint(BCLog::COINJOIN, "DSTX -- Invalid DSTX structure: %s\n", hashTx.ToString());
         return {false, true};
     }
-    if (::dstxManager->GetDSTX(hashTx)) {
+    if (::dstxManager->HasDSTX(hashTx)) {
         LogPrint(BCLog::COINJOIN, "DSTX -- Already have %s, skipping...\n", hashTx.ToString());
         return {true, true}; // not an error
     }
@@ -2842,6 +3285,12 @@ void PeerManagerImpl::ProcessBlock(CNode& pfrom, const std::shared_ptr<const CBl
     m_chainman.ProcessNewBlock(m_chainparams, pblock, fForceProcessing, &fNewBlock);
     if (fNewBlock) {
         pfrom.nLastBlockTime = GetTime();
+        if (!m_chainman.ActiveChainstate().IsInitialBlockDownload()) {
+            const int64_t nDelay = GetTimeMillis() - pblock->GetBlockTime() * 1000;
+            if (nDelay >= 0) {
+                statsClient.timing(strprintf("blocks.propagation.%s_ms", CmpctPeerClass(pfrom)), nDelay, 1.0f);
+            }
+        }
     } else {
         LOCK(cs_main);
         mapBlockSource.erase(pblock->GetHash());
@@ -2853,6 +3302,128 @@ void PeerManagerImpl::ProcessPeerMsgRet(const PeerMsgRet& ret, CNode& pfrom)
     if (!ret) Misbehaving(pfrom.GetId(), ret.error().score, ret.error().message);
 }
 
+void PeerManagerImpl::ProcessAlreadyHaveTx(CNode& pfrom, const CTransaction& tx)
+{
+    if (pfrom.HasPermission(PF_FORCERELAY)) {
+        // Always relay transactions received from peers with forcerelay permission, even
+        // if they were already in the mempool,
+        // allowing the node to function as a gateway for
+        // nodes hidden behind it.
+        if (!m_mempool.exists(tx.GetHash())) {
+            LogPrintf("Not relaying non-mempool transaction %s from forcerelay peer=%d\n", tx.GetHash().ToString(), pfrom.GetId());
+        } else {
+            LogPrintf("Force relaying tx %s from peer=%d\n", tx.GetHash().ToString(), pfrom.GetId());
+            RelayTransaction(tx.GetHash());
+        }
+    }
+}
+
+void PeerManagerImpl::ProcessTxResult(CNode& pfrom, Peer& peer, const CTransactionRef& ptx, const CCoinJoinBroadcastTx* dstx,
+                                      const MempoolAcceptResult& result)
+{
+    const CTransaction& tx = *ptx;
+    const uint256& txid = ptx->GetHash();
+    const TxValidationState& state = result.m_state;
+
+    if (result.m_result_type == MempoolAcceptResult::ResultType::VALID) {
+        // Process custom txes, this changes AlreadyHave to "true"
+        if (dstx != nullptr) {
+            LogPrint(BCLog::COINJOIN, "DSTX -- Masternode transaction accepted, txid=%s, peer=%d\n",
+                     tx.GetHash().ToString(), pfrom.GetId());
+            ::dstxManager->AddDSTX(*dstx);
+        }
+
+        m_mempool.check(m_chainman.ActiveChainstate());
+        RelayTransaction(tx.GetHash());
+
+        for (unsigned int i = 0; i < tx.vout.size(); i++) {
+            auto it_by_prev = mapOrphanTransactionsByPrev.find(COutPoint(txid, i));
+            if (it_by_prev != mapOrphanTransactionsByPrev.end()) {
+                for (const auto& elem : it_by_prev->second) {
+                    peer.m_orphan_work_set.insert(elem->first);
+                }
+            }
+        }
+
+        pfrom.nLastTXTime = GetTime();
+
+        LogPrint(BCLog::MEMPOOL, "AcceptToMemoryPool: peer=%d: accepted %s (poolsz %u txn, %u kB)\n",
+                 pfrom.GetId(),
+                 tx.GetHash().ToString(),
+                 m_mempool.size(), m_mempool.DynamicMemoryUsage() / 1000);
+
+        // Recursively process any orphan transactions that depended on this one
+        ProcessOrphanTx(peer.m_orphan_work_set);
+    }
+    else if (state.GetResult() == TxValidationResult::TX_MISSING_INPUTS)
+    {
+        bool fRejectedParents = false; // It may be the case that the orphans parents have all been rejected
+        for (const CTxIn& txin : tx.vin) {
+            if (m_recent_rejects.contains(txin.prevout.hash)) {
+                fRejectedParents = true;
+                break;
+            }
+        }
+        if (!fRejectedParents) {
+            const auto current_time = GetTime<std::chrono::microseconds>();
+
+            for (const CTxIn& txin : tx.vin) {
+                CInv _inv(MSG_TX, txin.prevout.hash);
+                pfrom.AddKnownInventory(_inv.hash);
+                if (!AlreadyHave(_inv)) RequestObject(State(pfrom.GetId()), _inv, current_time);
+                // We don't know if the previous tx was a regular or a mixing one, try both
+                CInv _inv2(MSG_DSTX, txin.prevout.hash);
+                pfrom.AddKnownInventory(_inv2.hash);
+                if (!AlreadyHave(_inv2)) RequestObject(State(pfrom.GetId()), _inv2, current_time);
+            }
+            AddOrphanTx(ptx, pfrom.GetId());
+
+            // DoS prevention: do not allow mapOrphanTransactions to grow unbounded (see CVE-2012-3789)
+            unsigned int nMaxOrphanTxSize = (unsigned int)std::max((int64_t)0, gArgs.GetArg("-maxorphantxsize", DEFAULT_MAX_ORPHAN_TRANSACTIONS_SIZE)) * 1000000;
+            unsigned int nEvicted = LimitOrphanTxSize(nMaxOrphanTxSize);
+            if (nEvicted > 0) {
+                LogPrint(BCLog::MEMPOOL, "mapOrphan overflow, removed %u tx\n", nEvicted);
+            }
+        } else {
+            LogPrint(BCLog::MEMPOOL, "not keeping orphan with rejected parents %s\n",tx.GetHash().ToString());
+            // We will continue to reject this tx since it has rejected
+            // parents so avoid re-requesting it from other peers.
+            m_recent_rejects.insert(tx.GetHash());
+            m_llmq_ctx->isman->TransactionRemovedFromMempool(ptx);
+        }
+    } else {
+        m_recent_rejects.insert(tx.GetHash());
+        if (RecursiveDynamicUsage(*ptx) < 100000) {
+            AddToCompactExtraTransactions(ptx);
+        }
+    }
+
+    // If a tx has been detected by m_recent_rejects, we will have reached
+    // this point and the tx will have been ignored. Because we haven't run
+    // the tx through AcceptToMemoryPool, we won't have computed a DoS
+    // score for it or determined exactly why we consider it invalid.
+    //
+    // This means we won't penalize any peer subsequently relaying a DoSy
+    // tx (even if we penalized the first peer who gave it to us) because
+    // we have to account for m_recent_rejects showing false positives. In
+    // other words, we shouldn't penalize a peer if we aren't *sure* they
+    // submitted a DoSy tx.
+    //
+    // Note that m_recent_rejects doesn't just record DoSy or invalid
+    // transactions, but any tx not accepted by the m_mempool, which may be
+    // due to node policy (vs. consensus). So we can't blanket penalize a
+    // peer simply for relaying a tx that our m_recent_rejects has caught,
+    // regardless of false positives.
+
+    if (state.IsInvalid()) {
+        LogPrint(BCLog::MEMPOOLREJ, "%s from peer=%d was not accepted: %s\n", tx.GetHash().ToString(),
+            pfrom.GetId(),
+            state.ToString());
+        MaybePunishNodeForTx(pfrom.GetId(), state);
+        m_llmq_ctx->isman->TransactionRemovedFromMempool(ptx);
+    }
+}
+
 void PeerManagerImpl::ProcessMessage(
     CNode& pfrom,
     const std::string& msg_type,
@@ -3256,6 +3827,10 @@ void PeerManagerImpl::ProcessMessage(
             State(pfrom.GetId())->fProvidesHeaderAndIDs = true;
             State(pfrom.GetId())->fPreferHeaderAndIDs = fAnnounceUsingCMPCTBLOCK;
             State(pfrom.GetId())->fSupportsDesiredCmpctVersion = true;
+            // Masternode and quorum peers are asked for high-bandwidth relay right away
+            if (IsPreferredCmpctPeer(pfrom) && !m_chainman.ActiveChainstate().IsInitialBlockDownload()) {
+                MaybeSetPeerAsAnnouncingHeaderAndIDs(pfrom.GetId());
+            }
         }
         return;
     }
@@ -3637,121 +4212,12 @@ void PeerManagerImpl::ProcessMessage(
         LOCK2(cs_main, g_cs_orphans);
 
         if (AlreadyHave(inv)) {
-            if (pfrom.HasPermission(PF_FORCERELAY)) {
-                // Always relay transactions received from peers with forcerelay permission, even
-                // if they were already in the mempool,
-                // allowing the node to function as a gateway for
-                // nodes hidden behind it.
-                if (!m_mempool.exists(tx.GetHash())) {
-                    LogPrintf("Not relaying non-mempool transaction %s from forcerelay peer=%d\n", tx.GetHash().ToString(), pfrom.GetId());
-                } else {
-                    LogPrintf("Force relaying tx %s from peer=%d\n", tx.GetHash().ToString(), pfrom.GetId());
-                    RelayTransaction(tx.GetHash());
-                }
-            }
+            ProcessAlreadyHaveTx(pfrom, tx);
             return;
         }
 
         const MempoolAcceptResult result = AcceptToMemoryPool(m_chainman.ActiveChainstate(), m_mempool, ptx, false /* bypass_limits */);
-        const TxValidationState& state = result.m_state;
-
-        if (result.m_result_type == MempoolAcceptResult::ResultType::VALID) {
-            // Process custom txes, this changes AlreadyHave to "true"
-            if (nInvType == MSG_DSTX) {
-                LogPrint(BCLog::COINJOIN, "DSTX -- Masternode transaction accepted, txid=%s, peer=%d\n",
-                         tx.GetHash().ToString(), pfrom.GetId());
-                ::dstxManager->AddDSTX(dstx);
-            }
-
-            m_mempool.check(m_chainman.ActiveChainstate());
-            RelayTransaction(tx.GetHash());
-
-            for (unsigned int i = 0; i < tx.vout.size(); i++) {
-                auto it_by_prev = mapOrphanTransactionsByPrev.find(COutPoint(txid, i));
-                if (it_by_prev != mapOrphanTransactionsByPrev.end()) {
-                    for (const auto& elem : it_by_prev->second) {
-                        peer->m_orphan_work_set.insert(elem->first);
-                    }
-                }
-            }
-
-            pfrom.nLastTXTime = GetTime();
-
-            LogPrint(BCLog::MEMPOOL, "AcceptToMemoryPool: peer=%d: accepted %s (poolsz %u txn, %u kB)\n",
-                     pfrom.GetId(),
-                     tx.GetHash().ToString(),
-                     m_mempool.size(), m_mempool.DynamicMemoryUsage() / 1000);
-
-            // Recursively process any orphan transactions that depended on this one
-            ProcessOrphanTx(peer->m_orphan_work_set);
-        }
-        else if (state.GetResult() == TxValidationResult::TX_MISSING_INPUTS)
-        {
-            bool fRejectedParents = false; // It may be the case that the orphans parents have all been rejected
-            for (const CTxIn& txin : tx.vin) {
-                if (m_recent_rejects.contains(txin.prevout.hash)) {
-                    fRejectedParents = true;
-                    break;
-                }
-            }
-            if (!fRejectedParents) {
-                const auto current_time = GetTime<std::chrono::microseconds>();
-
-                for (const CTxIn& txin : tx.vin) {
-                    CInv _inv(MSG_TX, txin.prevout.hash);
-                    pfrom.AddKnownInventory(_inv.hash);
-                    if (!AlreadyHave(_inv)) RequestObject(State(pfrom.GetId()), _inv, current_time);
-                    // We don't know if the previous tx was a regular or a mixing one, try both
-                    CInv _inv2(MSG_DSTX, txin.prevout.hash);
-                    pfrom.AddKnownInventory(_inv2.hash);
-                    if (!AlreadyHave(_inv2)) RequestObject(State(pfrom.GetId()), _inv2, current_time);
-                }
-                AddOrphanTx(ptx, pfrom.GetId());
-
-                // DoS prevention: do not allow mapOrphanTransactions to grow unbounded (see CVE-2012-3789)
-                unsigned int nMaxOrphanTxSize = (unsigned int)std::max((int64_t)0, gArgs.GetArg("-maxorphantxsize", DEFAULT_MAX_ORPHAN_TRANSACTIONS_SIZE)) * 1000000;
-                unsigned int nEvicted = LimitOrphanTxSize(nMaxOrphanTxSize);
-                if (nEvicted > 0) {
-                    LogPrint(BCLog::MEMPOOL, "mapOrphan overflow, removed %u tx\n", nEvicted);
-                }
-            } else {
-                LogPrint(BCLog::MEMPOOL, "not keeping orphan with rejected parents %s\n",tx.GetHash().ToString());
-                // We will continue to reject this tx since it has rejected
-                // parents so avoid re-requesting it from other peers.
-                m_recent_rejects.insert(tx.GetHash());
-                m_llmq_ctx->isman->TransactionRemovedFromMempool(ptx);
-            }
-        } else {
-            m_recent_rejects.insert(tx.GetHash());
-            if (RecursiveDynamicUsage(*ptx) < 100000) {
-                AddToCompactExtraTransactions(ptx);
-            }
-        }
-
-        // If a tx has been detected by m_recent_rejects, we will have reached
-        // this point and the tx will have been ignored. Because we haven't run
-        // the tx through AcceptToMemoryPool, we won't have computed a DoS
-        // score for it or determined exactly why we consider it invalid.
-        //
-        // This means we won't penalize any peer subsequently relaying a DoSy
-        // tx (even if we penalized the first peer who gave it to us) because
-        // we have to account for m_recent_rejects showing false positives. In
-        // other words, we shouldn't penalize a peer if we aren't *sure* they
-        // submitted a DoSy tx.
-        //
-        // Note that m_recent_rejects doesn't just record DoSy or invalid
-        // transactions, but any tx not accepted by the m_mempool, which may be
-        // due to node policy (vs. consensus). So we can't blanket penalize a
-        // peer simply for relaying a tx that our m_recent_rejects has caught,
-        // regardless of false positives.
-
-        if (state.IsInvalid()) {
-            LogPrint(BCLog::MEMPOOLREJ, "%s from peer=%d was not accepted: %s\n", tx.GetHash().ToString(),
-                pfrom.GetId(),
-                state.ToString());
-            MaybePunishNodeForTx(pfrom.GetId(), state);
-            m_llmq_ctx->isman->TransactionRemovedFromMempool(ptx);
-        }
+        ProcessTxResult(pfrom, *peer, ptx, nInvType == MSG_DSTX ? &dstx : nullptr, result);
         return;
     }
 
@@ -3868,6 +4334,7 @@ void PeerManagerImpl::ProcessMessage(
                     return;
                 } else if (status == READ_STATUS_FAILED) {
                     // Duplicate txindexes, the block is now in-flight, so just request it
+                    statsClient.inc("blocks.compact.fallback_getdata", 1.0f);
                     std::vector<CInv> vInv(1);
                     vInv[0] = CInv(MSG_BLOCK, cmpctblock.header.GetHash());
                     m_connman.PushMessage(&pfrom, msgMaker.Make(NetMsgType::GETDATA, vInv));
@@ -3887,7 +4354,20 @@ void PeerManagerImpl::ProcessMessage(
                     fProcessBLOCKTXN = true;
                 } else {
                     req.blockhash = pindex->GetBlockHash();
+                    statsClient.inc("blocks.compact.getblocktxn", 1.0f);
+                    statsClient.count("blocks.compact.txs_missing", req.indexes.size(), 1.0f);
                     m_connman.PushMessage(&pfrom, msgMaker.Make(NetMsgType::GETBLOCKTXN, req));
+                    // Make use of the round trip, transactions which aren't in our mempool aren't in the
+                    // script execution cache yet
+                    std::vector<CTransactionRef> vPrecheckTxs;
+                    for (const auto& tx : partialBlock.GetAvailableTxs()) {
+                        if (tx && !tx->IsCoinBase() && !m_mempool.exists(tx->GetHash())) {
+                            vPrecheckTxs.push_back(tx);
+                        }
+                    }
+                    if (!vPrecheckTxs.empty()) {
+                        PrecheckBlockTxScripts(m_chainman.ActiveChainstate(), pindex, vPrecheckTxs);
+                    }
                 }
             } else {
                 // This block is either already in flight from a different
@@ -3994,6 +4474,7 @@ void PeerManagerImpl::ProcessMessage(
                 return;
             } else if (status == READ_STATUS_FAILED) {
                 // Might have collided, fall back to getdata now :(
+                statsClient.inc("blocks.compact.fallback_getdata", 1.0f);
                 std::vector<CInv> invs;
                 invs.push_back(CInv(MSG_BLOCK, resp.blockhash));
                 m_connman.PushMessage(&pfrom, msgMaker.Make(NetMsgType::GETDATA, invs));
@@ -4015,7 +4496,7 @@ void PeerManagerImpl::ProcessMessage(
                 // though the block was successfully read, and rely on the
                 // handling in ProcessNewBlock to ensure the block index is
                 // updated, etc.
-                MarkBlockAsReceived(resp.blockhash); // it is now an empty pointer
+                MarkBlockAsReceived(resp.blockhash, pfrom.GetId()); // it is now an empty pointer
                 fBlockRead = true;
                 // mapBlockSource is used for potentially punishing peers and
                 // updating which peers send us compact blocks, so the race
@@ -4092,7 +4573,7 @@ void PeerManagerImpl::ProcessMessage(
             LOCK(cs_main);
             // Also always process if we requested the block explicitly, as we may
             // need it even though it is not a candidate for a new best tip.
-            forceProcessing |= MarkBlockAsReceived(hash);
+            forceProcessing |= MarkBlockAsReceived(hash, pfrom.GetId());
             // mapBlockSource is only used for punishing peers and setting
             // which peers send us compact blocks, so the race between here and
             // cs_main in ProcessNewBlock is fine.
@@ -4306,10 +4787,23 @@ void PeerManagerImpl::ProcessMessage(
 
         LOCK(cs_main);
 
+        // The diff between two blocks never changes as long as both stay in the active chain
+        const auto isActive = [this](const uint256& blockHash) EXCLUSIVE_LOCKS_REQUIRED(cs_main) {
+            const CBlockIndex* pindex = m_chainman.m_blockman.LookupBlockIndex(blockHash);
+            return pindex != nullptr && m_chainman.ActiveChain().Contains(pindex);
+        };
+        const uint256 cacheKey = SerializeHash(std::make_tuple(std::string(NetMsgType::MNLISTDIFF), pfrom.GetCommonVersion(), cmd.baseBlockHash, cmd.blockHash));
+        if (auto buffer = m_mnlist_response_cache.Get(cacheKey); buffer && (cmd.baseBlockHash.IsNull() || isActive(cmd.baseBlockHash)) && isActive(cmd.blockHash)) {
+            PushCachedMNListResponse(pfrom, NetMsgType::MNLISTDIFF, *buffer);
+            return;
+        }
+
         CSimplifiedMNListDiff mnListDiff;
         std::string strError;
         if (BuildSimplifiedMNListDiff(cmd.baseBlockHash, cmd.blockHash, mnListDiff, *m_llmq_ctx->quorum_block_processor, strError)) {
-            m_connman.PushMessage(&pfrom, msgMaker.Make(NetMsgType::MNLISTDIFF, mnListDiff));
+            CSerializedNetMsg msg = msgMaker.Make(NetMsgType::MNLISTDIFF, mnListDiff);
+            m_mnlist_response_cache.Add(cacheKey, std::make_shared<const std::vector<unsigned char>>(msg.data));
+            m_connman.PushMessage(&pfrom, std::move(msg));
         } else {
             strError = strprintf("getmnlistdiff failed for baseBlockHash=%s, blockHash=%s. error=%s", cmd.baseBlockHash.ToString(), cmd.blockHash.ToString(), strError);
             Misbehaving(pfrom.GetId(), 1, strError);
@@ -4345,10 +4839,19 @@ void PeerManagerImpl::ProcessMessage(
 
         LOCK(cs_main);
 
+        // Rotation info always comes with a diff to the tip
+        const uint256 cacheKey = SerializeHash(std::make_tuple(std::string(NetMsgType::QUORUMROTATIONINFO), pfrom.GetCommonVersion(), m_chainman.ActiveChain().Tip()->GetBlockHash(), cmd));
+        if (auto buffer = m_mnlist_response_cache.Get(cacheKey)) {
+            PushCachedMNListResponse(pfrom, NetMsgType::QUORUMROTATIONINFO, *buffer);
+            return;
+        }
+
         llmq::CQuorumRotationInfo quorumRotationInfoRet;
         std::string strError;
         if (BuildQuorumRotationInfo(cmd, quorumRotationInfoRet, *m_llmq_ctx->qman, *m_llmq_ctx->quorum_block_processor, strError)) {
-            m_connman.PushMessage(&pfrom, msgMaker.Make(NetMsgType::QUORUMROTATIONINFO, quorumRotationInfoRet));
+            CSerializedNetMsg msg = msgMaker.Make(NetMsgType::QUORUMROTATIONINFO, quorumRotationInfoRet);
+            m_mnlist_response_cache.Add(cacheKey, std::make_shared<const std::vector<unsigned char>>(msg.data));
+            m_connman.PushMessage(&pfrom, std::move(msg));
         } else {
             strError = strprintf("getquorumrotationinfo failed for size(baseBlockHashes)=%d, blockRequestHash=%s. error=%s", cmd.baseBlockHashes.size(), cmd.blockRequestHash.ToString(), strError);
             Misbehaving(pfrom.GetId(), 1, strError);
@@ -4410,6 +4913,13 @@ void PeerManagerImpl::ProcessMessage(
         ::masternodeSync->ProcessMessage(pfrom, msg_type, vRecv);
         ProcessPeerMsgRet(m_govman.ProcessMessage(pfrom, m_connman, msg_type, vRecv), pfrom);
         ProcessPeerMsgRet(CMNAuth::ProcessMessage(pfrom, m_connman, msg_type, vRecv), pfrom);
+        if (msg_type == NetMsgType::MNAUTH && IsPreferredCmpctPeer(pfrom)) {
+            // The peer proved to be a masternode, which may happen only after it sent SENDCMPCT
+            LOCK(cs_main);
+            if (!m_chainman.ActiveChainstate().IsInitialBlockDownload()) {
+                MaybeSetPeerAsAnnouncingHeaderAndIDs(pfrom.GetId());
+            }
+        }
         ProcessPeerMsgRet(m_llmq_ctx->quorum_block_processor->ProcessMessage(pfrom, msg_type, vRecv), pfrom);
         ProcessPeerMsgRet(m_llmq_ctx->qdkgsman->ProcessMessage(pfrom, this, msg_type, vRecv), pfrom);
         ProcessPeerMsgRet(m_llmq_ctx->qman->ProcessMessage(pfrom, msg_type, vRecv), pfrom);
@@ -4498,7 +5008,7 @@ bool PeerManagerImpl::ProcessMessages(CNode* pfrom, std::atomic<bool>& interrupt
     // and prevents m_getdata_requests to grow unbounded
     {
         LOCK(peer->m_getdata_requests_mutex);
-        if (!peer->m_getdata_requests.empty()) return true;
+        if (!peer->m_getdata_requests.empty()) return !peer->m_getdata_bloom_throttled;
     }
 
     {
@@ -4513,38 +5023,158 @@ bool PeerManagerImpl::ProcessMessages(CNode* pfrom, std::atomic<bool>& interrupt
     {
         LOCK(pfrom->cs_vProcessMsg);
         if (pfrom->vProcessMsg.empty()) return false;
-        // Just take one message
-        msgs.splice(msgs.begin(), pfrom->vProcessMsg, pfrom->vProcessMsg.begin());
-        pfrom->nProcessQueueSize -= msgs.front().m_raw_message_size;
+
+        if (m_parallel_msgproc && pfrom->fSuccessfullyConnected) {
+            LOCK(peer->m_parallel_msgs_mutex);
+            // while the first message is still being processed in parallel it's unknown whether this one comes first
+            const bool first_message = pfrom->nTimeFirstMessageReceived == 0;
+            if (!(first_message && peer->m_parallel_msgs_busy) &&
+                IsParallelMessageType(pfrom->vProcessMsg.front().m_command, first_message)) {
+                // Hand it to the message processing threads, it's only removed from the process queue size once it
+                // was processed so that the queued messages still count against the receive flood size
+                peer->m_parallel_msgs.splice(peer->m_parallel_msgs.end(), pfrom->vProcessMsg, pfrom->vProcessMsg.begin());
+                if (!peer->m_parallel_msgs_busy) {
+                    peer->m_parallel_msgs_busy = true;
+                    pfrom->AddRef();
+                    m_msgproc_pool.push([this, pfrom, peer, &interruptMsgProc](int) {
+                        ProcessParallelMessages(*pfrom, *peer, interruptMsgProc);
+                    });
+                }
+                return !pfrom->vProcessMsg.empty();
+            }
+            // Everything else waits for the messages received before it, this is retried once they are processed
+            if (peer->m_parallel_msgs_busy) return false;
+        }
+
+        // Transactions sent back to back, like the answer to a getdata, are accepted together
+        size_t tx_batch{1};
+        if (m_tx_batch_size > 1 && pfrom->fSuccessfullyConnected && pfrom->nTimeFirstMessageReceived != 0 && !pfrom->IsBlockRelayOnly()) {
+            tx_batch = 0;
+            for (auto it = pfrom->vProcessMsg.begin(); it != pfrom->vProcessMsg.end() && it->m_command == NetMsgType::TX && tx_batch < m_tx_batch_size; ++it) {
+                ++tx_batch;
+            }
+            tx_batch = std::max<size_t>(tx_batch, 1);
+        }
+
+        // Just take one message, or the batch of transactions
+        msgs.splice(msgs.begin(), pfrom->vProcessMsg, pfrom->vProcessMsg.begin(), std::next(pfrom->vProcessMsg.begin(), tx_batch));
+        for (const CNetMessage& msg : msgs) {
+            pfrom->nProcessQueueSize -= msg.m_raw_message_size;
+        }
         pfrom->fPauseRecv = pfrom->nProcessQueueSize > m_connman.GetReceiveFloodSize();
         fMoreWork = !pfrom->vProcessMsg.empty();
     }
-    CNetMessage& msg(msgs.front());
 
+    if (msgs.size() > 1) {
+        ProcessTxBatch(*pfrom, *peer, msgs);
+    } else {
+        ProcessReceivedMessage(*pfrom, msgs.front(), interruptMsgProc);
+    }
+    if (interruptMsgProc) return false;
+    {
+        LOCK(peer->m_getdata_requests_mutex);
+        if (!peer->m_getdata_requests.empty()) fMoreWork = true;
+    }
+
+    return fMoreWork;
+}
+
+void PeerManagerImpl::ProcessReceivedMessage(CNode& pfrom, CNetMessage& msg, const std::atomic<bool>& interruptMsgProc)
+{
     if (gArgs.GetBoolArg("-capturemessages", false)) {
-        CaptureMessage(pfrom->addr, msg.m_command, MakeUCharSpan(msg.m_recv), /* incoming */ true);
+        CaptureMessage(pfrom.addr, msg.m_command, MakeUCharSpan(msg.m_recv), /* incoming */ true);
     }
 
-    msg.SetVersion(pfrom->GetCommonVersion());
+    msg.SetVersion(pfrom.GetCommonVersion());
     const std::string& msg_type = msg.m_command;
 
     // Message size
     unsigned int nMessageSize = msg.m_message_size;
 
     try {
-        ProcessMessage(*pfrom, msg_type, msg.m_recv, msg.m_time, interruptMsgProc);
-        if (interruptMsgProc) return false;
-        {
-            LOCK(peer->m_getdata_requests_mutex);
-            if (!peer->m_getdata_requests.empty()) fMoreWork = true;
-        }
+        ProcessMessage(pfrom, msg_type, msg.m_recv, msg.m_time, interruptMsgProc);
     } catch (const std::exception& e) {
         LogPrint(BCLog::NET, "%s(%s, %u bytes): Exception '%s' (%s) caught\n", __func__, SanitizeString(msg_type), nMessageSize, e.what(), typeid(e).name());
     } catch (...) {
         LogPrint(BCLog::NET, "%s(%s, %u bytes): Unknown exception caught\n", __func__, SanitizeString(msg_type), nMessageSize);
     }
+}
 
-    return fMoreWork;
+void PeerManagerImpl::ProcessTxBatch(CNode& pfrom, Peer& peer, std::list<CNetMessage>& msgs)
+{
+    std::vector<CTransactionRef> txs;
+    txs.reserve(msgs.size());
+    for (CNetMessage& msg : msgs) {
+        if (gArgs.GetBoolArg("-capturemessages", false)) {
+            CaptureMessage(pfrom.addr, msg.m_command, MakeUCharSpan(msg.m_recv), /* incoming */ true);
+        }
+        msg.SetVersion(pfrom.GetCommonVersion());
+        LogPrint(BCLog::NET, "received: %s (%u bytes) peer=%d\n", SanitizeString(msg.m_command), msg.m_recv.size(), pfrom.GetId());
+        statsClient.inc("message.received." + SanitizeString(msg.m_command), 1.0f);
+
+        try {
+            CTransactionRef ptx;
+            msg.m_recv >> ptx;
+            pfrom.AddKnownInventory(ptx->GetHash());
+            txs.push_back(std::move(ptx));
+        } catch (const std::exception& e) {
+            LogPrint(BCLog::NET, "%s(%s, %u bytes): Exception '%s' (%s) caught\n", __func__, SanitizeString(msg.m_command), msg.m_message_size, e.what(), typeid(e).name());
+        }
+    }
+
+    LOCK2(cs_main, g_cs_orphans);
+
+    std::vector<CTransactionRef> to_accept;
+    std::vector<CTransactionRef> duplicates;
+    std::set<uint256> seen;
+    for (const CTransactionRef& ptx : txs) {
+        const CInv inv(MSG_TX, ptx->GetHash());
+        EraseObjectRequest(pfrom.GetId(), inv);
+        // Processed one at a time, AlreadyHave would find the first copy
+        if (!seen.insert(inv.hash).second) {
+            duplicates.push_back(ptx);
+        } else if (AlreadyHave(inv)) {
+            ProcessAlreadyHaveTx(pfrom, *ptx);
+        } else {
+            to_accept.push_back(ptx);
+        }
+    }
+
+    if (!to_accept.empty()) {
+        const std::vector<MempoolAcceptResult> results = AcceptToMemoryPoolBatch(m_chainman.ActiveChainstate(), m_mempool, to_accept);
+        for (size_t i = 0; i < to_accept.size(); ++i) {
+            ProcessTxResult(pfrom, peer, to_accept[i], nullptr, results[i]);
+        }
+    }
+    for (const CTransactionRef& ptx : duplicates) {
+        ProcessAlreadyHaveTx(pfrom, *ptx);
+    }
+}
+
+void PeerManagerImpl::ProcessParallelMessages(CNode& pfrom, Peer& peer, const std::atomic<bool>& interruptMsgProc)
+{
+    while (true) {
+        std::list<CNetMessage> msgs;
+        {
+            LOCK(peer.m_parallel_msgs_mutex);
+            if (peer.m_parallel_msgs.empty() || interruptMsgProc || pfrom.fDisconnect) {
+                peer.m_parallel_msgs.clear();
+                peer.m_parallel_msgs_busy = false;
+                break;
+            }
+            msgs.splice(msgs.begin(), peer.m_parallel_msgs, peer.m_parallel_msgs.begin());
+        }
+
+        ProcessReceivedMessage(pfrom, msgs.front(), interruptMsgProc);
+
+        LOCK(pfrom.cs_vProcessMsg);
+        pfrom.nProcessQueueSize -= msgs.front().m_raw_message_size;
+        pfrom.fPauseRecv = pfrom.nProcessQueueSize > m_connman.GetReceiveFloodSize();
+    }
+    pfrom.Release();
+
+    // Messages of this peer may be waiting for these to be processed
+    m_connman.WakeMessageHandler();
 }
 
 void PeerManagerImpl::ConsiderEviction(CNode& pto, int64_t time_in_seconds)
@@ -5115,9 +5745,15 @@ bool PeerManagerImpl::SendMessages(CNode* pto)
                     for (const auto& txinfo : vtxinfo) {
                         const uint256& hash = txinfo.tx->GetHash();
                         pto->m_tx_relay->setInventoryTxToSend.erase(hash);
-                        if (pto->m_tx_relay->pfilter && !pto->m_tx_relay->pfilter->IsRelevantAndUpdate(*txinfo.tx)) continue;
+                        if (pto->m_tx_relay->pfilter) {
+                            // The answer to a mempool request is counted but never waits, the peer asked for all of it
+                            const auto start = std::chrono::steady_clock::now();
+                            const bool relevant = pto->m_tx_relay->pfilter->IsRelevantAndUpdate(*txinfo.tx, *GetBloomTxElements(*txinfo.tx));
+                            UpdateBloomTime(*pto, std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start));
+                            if (!relevant) continue;
+                        }
 
-                        int nInvType = ::dstxManager->GetDSTX(hash) ? MSG_DSTX : MSG_TX;
+                        int nInvType = ::dstxManager->HasDSTX(hash) ? MSG_DSTX : MSG_TX;
                         queueAndMaybePushInv(CInv(nInvType, hash));
 
                         const auto islock = m_llmq_ctx->isman->GetInstantSendLockByTxid(hash);
@@ -5154,6 +5790,11 @@ bool PeerManagerImpl::SendMessages(CNode* pto)
                     // especially since we have many peers and some will draw much shorter delays.
                     unsigned int nRelayedTransactions = 0;
                     while (!vInvTx.empty() && nRelayedTransactions < INVENTORY_BROADCAST_MAX_PER_1MB_BLOCK * MaxBlockSize() / 1000000) {
+                        // The rest is announced with a later trickle once the peer is within its bloom filter budget
+                        if (pto->m_tx_relay->pfilter && UpdateBloomTime(*pto)) {
+                            g_bloom_throttled.Add();
+                            break;
+                        }
                         // Fetch the top element from the heap
                         std::pop_heap(vInvTx.begin(), vInvTx.end(), compareInvMempoolOrder);
                         std::set<uint256>::iterator it = vInvTx.back();
@@ -5170,7 +5811,12 @@ bool PeerManagerImpl::SendMessages(CNode* pto)
                         if (!txinfo.tx) {
                             continue;
                         }
-                        if (pto->m_tx_relay->pfilter && !pto->m_tx_relay->pfilter->IsRelevantAndUpdate(*txinfo.tx)) continue;
+                        if (pto->m_tx_relay->pfilter) {
+                            const auto start = std::chrono::steady_clock::now();
+                            const bool relevant = pto->m_tx_relay->pfilter->IsRelevantAndUpdate(*txinfo.tx, *GetBloomTxElements(*txinfo.tx));
+                            UpdateBloomTime(*pto, std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start));
+                            if (!relevant) continue;
+                        }
                         // Send
                         State(pto->GetId())->m_recently_announced_invs.insert(hash);
                         nRelayedTransactions++;
@@ -5187,7 +5833,7 @@ bool PeerManagerImpl::SendMessages(CNode* pto)
                                 vRelayExpiration.emplace_back(count_microseconds(current_time + std::chrono::microseconds{RELAY_TX_CACHE_TIME}), ret.first);
                             }
                         }
-                        int nInvType = ::dstxManager->GetDSTX(hash) ? MSG_DSTX : MSG_TX;
+                        int nInvType = ::dstxManager->HasDSTX(hash) ? MSG_DSTX : MSG_TX;
                         queueAndMaybePushInv(CInv(nInvType, hash));
                     }
                 }
@@ -5282,10 +5928,14 @@ bool PeerManagerImpl::SendMessages(CNode* pto)
         // Message: getdata (blocks)
         //
         std::vector<CInv> vGetData;
-        if (!pto->fClient && pto->CanRelay() && ((fFetch && !pto->m_limited_node) || !m_chainman.ActiveChainstate().IsInitialBlockDownload()) && state.nBlocksInFlight < MAX_BLOCKS_IN_TRANSIT_PER_PEER) {
+        const bool fInitialBlockDownload = m_chainman.ActiveChainstate().IsInitialBlockDownload();
+        // Peers which keep up may have more blocks in flight while we're catching up
+        const int nMaxBlocksInTransit = fInitialBlockDownload ? state.m_blocks_in_transit_limit : MAX_BLOCKS_IN_TRANSIT_PER_PEER;
+        if (!pto->fClient && pto->CanRelay() && ((fFetch && !pto->m_limited_node) || !fInitialBlockDownload) && state.nBlocksInFlight < nMaxBlocksInTransit) {
             std::vector<const CBlockIndex*> vToDownload;
             NodeId staller = -1;
-            FindNextBlocksToDownload(pto->GetId(), MAX_BLOCKS_IN_TRANSIT_PER_PEER - state.nBlocksInFlight, vToDownload, staller);
+            const CBlockIndex* pindexStalled = nullptr;
+            FindNextBlocksToDownload(pto->GetId(), nMaxBlocksInTransit - state.nBlocksInFlight, vToDownload, staller, pindexStalled);
             for (const CBlockIndex *pindex : vToDownload) {
                 vGetData.push_back(CInv(MSG_BLOCK, pindex->GetBlockHash()));
                 MarkBlockAsInFlight(pto->GetId(), pindex->GetBlockHash(), pindex);
@@ -5293,10 +5943,26 @@ bool PeerManagerImpl::SendMessages(CNode* pto)
                     pindex->nHeight, pto->GetId());
             }
             if (state.nBlocksInFlight == 0 && staller != -1) {
-                if (State(staller)->nStallingSince == 0) {
-                    State(staller)->nStallingSince = count_microseconds(current_time);
+                CNodeState* stallerState = State(staller);
+                if (stallerState->nStallingSince == 0) {
+                    stallerState->nStallingSince = count_microseconds(current_time);
+                    stallerState->m_blocks_in_transit_limit = std::max(MAX_BLOCKS_IN_TRANSIT_PER_PEER, stallerState->m_blocks_in_transit_limit / 2);
+                    stallerState->m_blocks_fast_at_limit = 0;
                     LogPrint(BCLog::NET, "Stall started peer=%d\n", staller);
                 }
+                // This peer is idle while the window waits for a single block, ask it for that block too. The
+                // staller's copy is still accepted if it arrives first, and it still has to deliver something
+                // before BLOCK_STALLING_TIMEOUT to stay connected.
+                const auto itStalled = pindexStalled ? mapBlocksInFlight.find(pindexStalled->GetBlockHash()) : mapBlocksInFlight.end();
+                if (itStalled != mapBlocksInFlight.end() && itStalled->second.first == staller && !itStalled->second.second->partialBlock &&
+                    current_time - itStalled->second.second->m_time_requested > BLOCK_STALLING_REREQUEST_TIME) {
+                    const int64_t nStallingSince = stallerState->nStallingSince;
+                    vGetData.push_back(CInv(MSG_BLOCK, pindexStalled->GetBlockHash()));
+                    MarkBlockAsInFlight(pto->GetId(), pindexStalled->GetBlockHash(), pindexStalled);
+                    stallerState->nStallingSince = nStallingSince;
+                    LogPrint(BCLog::NET, "Requesting block %s (%d) held up by peer=%d from peer=%d\n", pindexStalled->GetBlockHash().ToString(),
+                        pindexStalled->nHeight, staller, pto->GetId());
+                }
             }
         }
 
@@ -5385,6 +6051,7 @@ public:
         mapOrphanTransactions.clear();
         mapOrphanTransactionsByPrev.clear();
         nMapOrphanTransactionsSize = 0;
+        nMapOrphanTransactionsUsage = 0;
     }
 };
 static CNetProcessingCleanup instance_of_cnetprocessingcleanup;
@@ -11,6 +11,7 @@
 #include <validationinterface.h>
 
 #include <atomic>
+#include <chrono>
 
 class CAddrMan;
 class CTxMemPool;
@@ -29,12 +30,25 @@ static const unsigned int DEFAULT_MAX_ORPHAN_TRANSACTIONS_SIZE = 10; // this all
 static const unsigned int DEFAULT_BLOCK_RECONSTRUCTION_EXTRA_TXN = 100;
 static const bool DEFAULT_PEERBLOOMFILTERS = true;
 static const bool DEFAULT_PEERBLOCKFILTERS = false;
+/** Default for -msgprocthreads, number of threads processing Dash messages besides the message handler thread */
+static const int DEFAULT_MSGPROC_THREADS = 0;
+/** Maximum number of message processing threads */
+static const int MAX_MSGPROC_THREADS = 16;
+/** Default for -txbatchsize, 0 = transactions are accepted one at a time */
+static const int DEFAULT_TX_BATCH_SIZE = 0;
+/** Maximum number of transactions of one peer accepted together */
+static const int MAX_TX_BATCH_SIZE = 1000;
+/** Default for -maxbloomcputime, milliseconds per second one peer may spend of our time on its bloom filter */
+static const int DEFAULT_MAX_BLOOM_CPU_TIME = 100;
 
 struct CNodeStateStats {
     int m_misbehavior_score = 0;
     int nSyncHeight = -1;
     int nCommonHeight = -1;
     std::vector<int> vHeightInFlight;
+    int m_blocks_in_transit_limit = 0;
+    uint64_t m_blocks_received = 0;
+    std::chrono::microseconds m_block_download_time{0};
 };
 
 class PeerManager : public CValidationInterface, public NetEventsInterface
@@ -76,6 +90,12 @@ public:
 
     virtual bool IsBanned(NodeId pnode) = 0;
 
+    /**
+     * Finish the messages handed to the message processing threads and stop them.
+     * Must only be called once the message handler thread was stopped.
+     */
+    virtual void StopMessageProcessing() = 0;
+
     /** Whether we've completed initial sync yet, for determining when to turn
       * on extra block-relay-only peers. */
     bool m_initial_sync_finished{false};
@@ -15,7 +15,9 @@
 #include <pow.h>
 #include <shutdown.h>
 #include <streams.h>
+#include <util/strencodings.h>
 #include <util/system.h>
+#include <util/thread.h>
 #include <validation.h>
 #include <walletinitinterface.h>
 
@@ -30,17 +32,23 @@ static bool WriteBlockToDisk(const CBlock& block, FlatFilePos& pos, const CMessa
         return error("WriteBlockToDisk: OpenBlockFile failed");
     }
 
-    // Write index header
+    // Serialize the whole record first, so it reaches the file in a single write
     unsigned int nSize = GetSerializeSize(block, fileout.GetVersion());
-    fileout << messageStart << nSize;
+    CDataStream record(SER_DISK, CLIENT_VERSION);
+    record.reserve(nSize + 8);
+
+    // Write index header
+    record << messageStart << nSize;
 
     // Write block
     long fileOutPos = ftell(fileout.Get());
     if (fileOutPos < 0) {
         return error("WriteBlockToDisk: ftell failed");
     }
-    pos.nPos = (unsigned int)fileOutPos;
-    fileout << block;
+    pos.nPos = (unsigned int)fileOutPos + record.size();
+    record << block;
+
+    fileout.write(MakeByteSpan(record));
 
     return true;
 }
@@ -84,6 +92,114 @@ bool ReadBlockFromDisk(CBlock& block, const CBlockIndex* pindex, const Consensus
     return true;
 }
 
+bool ReadRawBlockFromDisk(std::vector<uint8_t>& block, const FlatFilePos& pos, const CMessageHeader::MessageStartChars& message_start)
+{
+    FlatFilePos hpos = pos;
+    hpos.nPos -= 8; // Seek back 8 bytes for the message start and size written by WriteBlockToDisk
+    CAutoFile filein(OpenBlockFile(hpos, true), SER_DISK, CLIENT_VERSION);
+    if (filein.IsNull()) {
+        return error("%s: OpenBlockFile failed for %s", __func__, pos.ToString());
+    }
+
+    try {
+        CMessageHeader::MessageStartChars blk_start;
+        unsigned int blk_size;
+
+        filein >> blk_start >> blk_size;
+
+        if (memcmp(blk_start, message_start, CMessageHeader::MESSAGE_START_SIZE)) {
+            return error("%s: Block magic mismatch for %s: %s versus expected %s", __func__, pos.ToString(),
+                         HexStr(blk_start), HexStr(message_start));
+        }
+
+        if (blk_size > MAX_SIZE) {
+            return error("%s: Block data is larger than maximum deserialization size for %s: %s versus %s", __func__, pos.ToString(),
+                         blk_size, MAX_SIZE);
+        }
+
+        block.resize(blk_size);
+        filein.read(MakeWritableByteSpan(block));
+    } catch (const std::exception& e) {
+        return error("%s: Read from block file failed: %s for %s", __func__, e.what(), pos.ToString());
+    }
+
+    return true;
+}
+
+BlockReadAhead::BlockReadAhead(const std::vector<const CBlockIndex*>& block_indexes, bool read_undo,
+                               const Consensus::Params& consensus_params, size_t max_ahead)
+    : m_positions{[&] {
+          LOCK(cs_main);
+          std::vector<Position> positions;
+          positions.reserve(block_indexes.size());
+          for (const CBlockIndex* pindex : block_indexes) {
+              positions.push_back({pindex->GetBlockHash(), pindex->pprev ? pindex->pprev->GetBlockHash() : uint256(),
+                                   pindex->GetBlockPos(), pindex->GetUndoPos()});
+          }
+          return positions;
+      }()},
+      m_read_undo{read_undo},
+      m_max_ahead{std::max<size_t>(max_ahead, 1)}
+{
+    m_thread = std::thread(&util::TraceThread, "blkread", [this, &consensus_params] { ThreadRead(consensus_params); });
+}
+
+BlockReadAhead::~BlockReadAhead()
+{
+    WITH_LOCK(m_mutex, m_stop = true);
+    m_cond.notify_all();
+    m_thread.join();
+}
+
+void BlockReadAhead::ThreadRead(const Consensus::Params& consensus_params)
+{
+    for (const Position& position : m_positions) {
+        {
+            WAIT_LOCK(m_mutex, lock);
+            m_cond.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return m_stop || m_entries.size() < m_max_ahead; });
+            if (m_stop) return;
+        }
+
+        Entry entry;
+        if (!ReadBlockFromDisk(entry.m_block, position.m_block_pos, consensus_params)) {
+            LogPrintf("%s: Failed to read block %s\n", __func__, position.m_block_hash.ToString());
+        } else if (entry.m_block.GetHash() != position.m_block_hash) {
+            LogPrintf("%s: GetHash() doesn't match index for %s at %s\n", __func__,
+                      position.m_block_hash.ToString(), position.m_block_pos.ToString());
+        } else if (m_read_undo && !position.m_undo_pos.IsNull() &&
+                   !UndoReadFromDisk(entry.m_block_undo, position.m_undo_pos, position.m_prev_block_hash)) {
+            LogPrintf("%s: Failed to read undo data of block %s\n", __func__, position.m_block_hash.ToString());
+        } else {
+            entry.m_ok = true;
+        }
+
+        {
+            LOCK(m_mutex);
+            m_entries.push_back(std::move(entry));
+        }
+        m_cond.notify_all();
+    }
+}
+
+bool BlockReadAhead::Next(CBlock& block, CBlockUndo* block_undo)
+{
+    assert(m_next_taken < m_positions.size());
+    ++m_next_taken;
+
+    Entry entry;
+    {
+        WAIT_LOCK(m_mutex, lock);
+        m_cond.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return !m_entries.empty(); });
+        entry = std::move(m_entries.front());
+        m_entries.pop_front();
+    }
+    m_cond.notify_all();
+
+    block = std::move(entry.m_block);
+    if (block_undo) *block_undo = std::move(entry.m_block_undo);
+    return entry.m_ok;
+}
+
 /** Store block on disk. If dbp is non-nullptr, the file is known to already reside on disk */
 FlatFilePos SaveBlockToDisk(const CBlock& block, int nHeight, CChain& active_chain, const CChainParams& chainparams, const FlatFilePos* dbp)
 {
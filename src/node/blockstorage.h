@@ -5,32 +5,92 @@
 #ifndef BITCOIN_NODE_BLOCKSTORAGE_H
 #define BITCOIN_NODE_BLOCKSTORAGE_H
 
+#include <flatfile.h>
 #include <fs.h>
+#include <primitives/block.h>
 #include <protocol.h> // For CMessageHeader::MessageStartChars
+#include <sync.h>
+#include <undo.h>
 
+#include <condition_variable>
 #include <cstdint>
+#include <deque>
+#include <thread>
 #include <vector>
 
 class ArgsManager;
-class CBlock;
 class CBlockIndex;
-class CBlockUndo;
 class CChain;
 class CChainParams;
 class CDSNotificationInterface;
 class ChainstateManager;
-struct FlatFilePos;
 namespace Consensus {
 struct Params;
 }
 
 static constexpr bool DEFAULT_STOPAFTERBLOCKIMPORT{false};
+/** Number of blocks BlockReadAhead keeps read ahead of its consumer by default */
+static constexpr size_t DEFAULT_BLOCK_READ_AHEAD{16};
 
 /** Functions for disk access for blocks */
 bool ReadBlockFromDisk(CBlock& block, const FlatFilePos& pos, const Consensus::Params& consensusParams);
 bool ReadBlockFromDisk(CBlock& block, const CBlockIndex* pindex, const Consensus::Params& consensusParams);
+/** Read the serialized block at pos as it is stored, without deserializing it */
+bool ReadRawBlockFromDisk(std::vector<uint8_t>& block, const FlatFilePos& pos, const CMessageHeader::MessageStartChars& message_start);
 
 bool UndoReadFromDisk(CBlockUndo& blockundo, const CBlockIndex* pindex);
+/** Read the undo data at pos, which is checksummed together with the hash of the previous block */
+bool UndoReadFromDisk(CBlockUndo& blockundo, const FlatFilePos& pos, const uint256& hash_prev_block);
+
+/**
+ * Reads a sequence of blocks, and optionally their undo data, on a background thread ahead of a
+ * consumer that takes them in the same order, so that the consumer doesn't wait on the disk for
+ * every block. At most max_ahead blocks are kept in memory. The positions of the blocks are looked
+ * up on construction, so that the consumer may hold cs_main while waiting for a block.
+ */
+class BlockReadAhead
+{
+public:
+    BlockReadAhead(const std::vector<const CBlockIndex*>& block_indexes, bool read_undo,
+                   const Consensus::Params& consensus_params, size_t max_ahead = DEFAULT_BLOCK_READ_AHEAD);
+    ~BlockReadAhead();
+
+    BlockReadAhead(const BlockReadAhead&) = delete;
+    BlockReadAhead& operator=(const BlockReadAhead&) = delete;
+
+    /**
+     * Wait for the next block of the sequence to be read and take it. The undo data is left empty
+     * if it was not requested or the block has none. Returns false if the block couldn't be read.
+     */
+    bool Next(CBlock& block, CBlockUndo* block_undo = nullptr);
+
+private:
+    struct Entry {
+        bool m_ok{false};
+        CBlock m_block;
+        CBlockUndo m_block_undo;
+    };
+
+    struct Position {
+        uint256 m_block_hash;
+        uint256 m_prev_block_hash;
+        FlatFilePos m_block_pos;
+        FlatFilePos m_undo_pos;
+    };
+
+    void ThreadRead(const Consensus::Params& consensus_params);
+
+    const std::vector<Position> m_positions;
+    const bool m_read_undo;
+    const size_t m_max_ahead;
+    size_t m_next_taken{0};
+
+    Mutex m_mutex;
+    std::condition_variable m_cond;
+    std::deque<Entry> m_entries GUARDED_BY(m_mutex);
+    bool m_stop GUARDED_BY(m_mutex){false};
+    std::thread m_thread;
+};
 
 FlatFilePos SaveBlockToDisk(const CBlock& block, int nHeight, CChain& active_chain, const CChainParams& chainparams, const FlatFilePos* dbp);
 
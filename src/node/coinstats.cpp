@@ -7,6 +7,7 @@
 
 #include <coins.h>
 #include <crypto/muhash.h>
+#include <ctpl_stl.h>
 #include <hash.h>
 #include <index/coinstatsindex.h>
 #include <serialize.h>
@@ -16,6 +17,7 @@
 #include <util/system.h>
 #include <validation.h>
 
+#include <algorithm>
 #include <map>
 
 uint64_t GetBogoSize(const CScript& script_pub_key)
@@ -36,6 +38,78 @@ CDataStream TxOutSer(const COutPoint& outpoint, const Coin& coin) {
     return ss;
 }
 
+int GetMuHashThreads()
+{
+    // with a single core the thread adding the coins would only compete with the pool
+    return std::clamp(GetNumCores() - 1, 0, MAX_MUHASH_THREADS);
+}
+
+ParallelMuHash::ParallelMuHash(MuHash3072& muhash, ctpl::thread_pool* pool, size_t batch_size) :
+    m_muhash(muhash),
+    m_pool(pool),
+    m_batch_size(batch_size),
+    m_max_pending(pool != nullptr ? 2 * pool->size() : 0)
+{
+}
+
+void ParallelMuHash::Insert(CDataStream&& element)
+{
+    if (m_pool == nullptr) {
+        m_muhash.Insert(MakeUCharSpan(element));
+        return;
+    }
+    m_batch.inserts.emplace_back(std::move(element));
+    if (m_batch.size() >= m_batch_size) PushBatch();
+}
+
+void ParallelMuHash::Remove(CDataStream&& element)
+{
+    if (m_pool == nullptr) {
+        m_muhash.Remove(MakeUCharSpan(element));
+        return;
+    }
+    m_batch.removes.emplace_back(std::move(element));
+    if (m_batch.size() >= m_batch_size) PushBatch();
+}
+
+void ParallelMuHash::PushBatch()
+{
+    if (m_pending.size() >= m_max_pending) {
+        m_muhash *= m_pending.front().get();
+        m_pending.pop_front();
+    }
+    m_pending.emplace_back(m_pool->push([batch = std::move(m_batch)](int) {
+        MuHash3072 acc;
+        for (const auto& element : batch.inserts) {
+            acc.Insert(MakeUCharSpan(element));
+        }
+        for (const auto& element : batch.removes) {
+            acc.Remove(MakeUCharSpan(element));
+        }
+        return acc;
+    }));
+    m_batch = Batch{};
+}
+
+MuHash3072& ParallelMuHash::Finish()
+{
+    if (m_pool == nullptr) return m_muhash;
+
+    // a small last batch is quicker to apply here than to hand over
+    for (const auto& element : m_batch.inserts) {
+        m_muhash.Insert(MakeUCharSpan(element));
+    }
+    for (const auto& element : m_batch.removes) {
+        m_muhash.Remove(MakeUCharSpan(element));
+    }
+    m_batch = Batch{};
+    for (auto& pending : m_pending) {
+        m_muhash *= pending.get();
+    }
+    m_pending.clear();
+    return m_muhash;
+}
+
 //! Warning: be very careful when changing this! assumeutxo and UTXO snapshot
 //! validation commitments are reliant on the hash constructed by this
 //! function.
@@ -68,12 +142,12 @@ static void ApplyHash(CHashWriter& ss, const uint256& hash, const std::map<uint3
 
 static void ApplyHash(std::nullptr_t, const uint256& hash, const std::map<uint32_t, Coin>& outputs) {}
 
-static void ApplyHash(MuHash3072& muhash, const uint256& hash, const std::map<uint32_t, Coin>& outputs)
+static void ApplyHash(ParallelMuHash& muhash, const uint256& hash, const std::map<uint32_t, Coin>& outputs)
 {
     for (auto it = outputs.begin(); it != outputs.end(); ++it) {
         COutPoint outpoint = COutPoint(hash, it->first);
         Coin coin = it->second;
-        muhash.Insert(MakeUCharSpan(TxOutSer(outpoint, coin)));
+        muhash.Insert(TxOutSer(outpoint, coin));
     }
 }
 
@@ -166,7 +240,14 @@ bool GetUTXOStats(CCoinsView* view, BlockManager& blockman, CCoinsStats& stats,
     }
     case(CoinStatsHashType::MUHASH): {
         MuHash3072 muhash;
-        return GetUTXOStats(view, blockman, stats, muhash, interruption_point, pindex);
+        // the coins are read on this thread, the pool does the hashing
+        std::unique_ptr<ctpl::thread_pool> pool;
+        if (const int n_threads = GetMuHashThreads(); n_threads > 0 && !(stats.index_requested && g_coin_stats_index)) {
+            pool = std::make_unique<ctpl::thread_pool>(n_threads);
+            RenameThreadPool(*pool, "muhash");
+        }
+        ParallelMuHash parallel_muhash(muhash, pool.get());
+        return GetUTXOStats<ParallelMuHash&>(view, blockman, stats, parallel_muhash, interruption_point, pindex);
     }
     case(CoinStatsHashType::NONE): {
         return GetUTXOStats(view, blockman, stats, nullptr, interruption_point, pindex);
@@ -181,17 +262,17 @@ static void PrepareHash(CHashWriter& ss, const CCoinsStats& stats)
     ss << stats.hashBlock;
 }
 // MuHash does not need the prepare step
-static void PrepareHash(MuHash3072& muhash, CCoinsStats& stats) {}
+static void PrepareHash(ParallelMuHash& muhash, CCoinsStats& stats) {}
 static void PrepareHash(std::nullptr_t, CCoinsStats& stats) {}
 
 static void FinalizeHash(CHashWriter& ss, CCoinsStats& stats)
 {
     stats.hashSerialized = ss.GetHash();
 }
-static void FinalizeHash(MuHash3072& muhash, CCoinsStats& stats)
+static void FinalizeHash(ParallelMuHash& muhash, CCoinsStats& stats)
 {
     uint256 out;
-    muhash.Finalize(out);
+    muhash.Finish().Finalize(out);
     stats.hashSerialized = out;
 }
 static void FinalizeHash(std::nullptr_t, CCoinsStats& stats) {}
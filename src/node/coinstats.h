@@ -9,15 +9,22 @@
 #include <amount.h>
 #include <chain.h>
 #include <coins.h>
+#include <crypto/muhash.h>
 #include <streams.h>
 #include <uint256.h>
 
 #include <cstdint>
+#include <deque>
 #include <functional>
+#include <future>
 #include <optional>
+#include <vector>
 
 class BlockManager;
 class CCoinsView;
+namespace ctpl {
+class thread_pool;
+} // namespace ctpl
 
 enum class CoinStatsHashType {
     HASH_SERIALIZED,
@@ -78,4 +85,51 @@ uint64_t GetBogoSize(const CScript& script_pub_key);
 
 CDataStream TxOutSer(const COutPoint& outpoint, const Coin& coin);
 
+/** Most threads the MuHash of the UTXO set is computed on, besides the thread adding the coins */
+static constexpr int MAX_MUHASH_THREADS{8};
+
+/** The number of threads for ParallelMuHash on this machine, 0 if it's not worth using any */
+int GetMuHashThreads();
+
+/**
+ * Updates a MuHash3072 on the threads of a pool. Turning an element into a
+ * number (ChaCha20) and multiplying it in are by far the most costly part of
+ * hashing a coin, both are done for batches of elements on the pool, which
+ * give one MuHash3072 each. Those are multiplied into the MuHash3072 by
+ * Finish(), which gives the same hash as inserting and removing the elements
+ * one after another. Without a pool the elements are applied right away.
+ */
+class ParallelMuHash
+{
+public:
+    ParallelMuHash(MuHash3072& muhash, ctpl::thread_pool* pool, size_t batch_size = DEFAULT_BATCH_SIZE);
+    ParallelMuHash(const ParallelMuHash&) = delete;
+    ParallelMuHash& operator=(const ParallelMuHash&) = delete;
+
+    void Insert(CDataStream&& element);
+    void Remove(CDataStream&& element);
+
+    /** Wait for the batches still being processed and apply them */
+    MuHash3072& Finish();
+
+    static constexpr size_t DEFAULT_BATCH_SIZE{1024};
+
+private:
+    struct Batch {
+        std::vector<CDataStream> inserts;
+        std::vector<CDataStream> removes;
+        size_t size() const { return inserts.size() + removes.size(); }
+    };
+
+    MuHash3072& m_muhash;
+    ctpl::thread_pool* const m_pool;
+    const size_t m_batch_size;
+    //! at most this many batches are processed at a time, the rest waits so the elements don't pile up
+    const size_t m_max_pending;
+    Batch m_batch;
+    std::deque<std::future<MuHash3072>> m_pending;
+
+    void PushBatch();
+};
+
 #endif // BITCOIN_NODE_COINSTATS_H
@@ -12,6 +12,7 @@
 
 class ArgsManager;
 class BanMan;
+class BlockTemplateCache;
 class CAddrMan;
 class CBlockPolicyEstimator;
 class CConnman;
@@ -68,8 +69,11 @@ struct NodeContext {
     interfaces::WalletLoader* wallet_loader{nullptr};
     std::unique_ptr<interfaces::CoinJoin::Loader> coinjoin_loader{nullptr};
     std::unique_ptr<CScheduler> scheduler;
+    //! runs the periodic Dash maintenance, apart from the tasks on scheduler
+    std::unique_ptr<CScheduler> maintenance_scheduler;
     std::function<void()> rpc_interruption_point = [] {};
     //! Dash
+    std::unique_ptr<BlockTemplateCache> block_template_cache;
     std::unique_ptr<CEvoDB> evodb;
     std::unique_ptr<CJContext> cj_ctx;
     std::unique_ptr<CMNHFManager> mnhf_manager;
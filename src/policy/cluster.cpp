@@ -0,0 +1,108 @@
+// Copyright (c) 2026 The Dash Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <policy/cluster.h>
+
+#include <cassert>
+#include <cstddef>
+
+namespace {
+
+/** Kahn's algorithm, ties are broken by index to keep the result deterministic */
+std::vector<uint32_t> TopologicalOrder(const std::vector<ClusterTx>& txs)
+{
+    const uint32_t n = txs.size();
+    std::vector<uint32_t> missing_parents(n);
+    std::vector<std::vector<uint32_t>> children(n);
+    for (uint32_t i = 0; i < n; ++i) {
+        missing_parents[i] = txs[i].parents.size();
+        for (const uint32_t parent : txs[i].parents) {
+            children[parent].push_back(i);
+        }
+    }
+
+    std::vector<uint32_t> order;
+    order.reserve(n);
+    for (uint32_t i = 0; i < n; ++i) {
+        if (missing_parents[i] == 0) order.push_back(i);
+    }
+    for (size_t pos = 0; pos < order.size(); ++pos) {
+        for (const uint32_t child : children[order[pos]]) {
+            if (--missing_parents[child] == 0) order.push_back(child);
+        }
+    }
+    assert(order.size() == n);
+    return order;
+}
+
+} // namespace
+
+std::vector<uint32_t> LinearizeCluster(const std::vector<ClusterTx>& txs)
+{
+    const uint32_t n = txs.size();
+    std::vector<uint32_t> topo = TopologicalOrder(txs);
+    if (n <= 1 || n > MAX_CLUSTER_LINEARIZE_SIZE) {
+        return topo;
+    }
+    static_assert(MAX_CLUSTER_LINEARIZE_SIZE <= 64, "ancestor sets are kept in a uint64_t");
+
+    std::vector<uint64_t> ancestors(n);
+    for (const uint32_t i : topo) {
+        ancestors[i] = uint64_t{1} << i;
+        for (const uint32_t parent : txs[i].parents) {
+            ancestors[i] |= ancestors[parent];
+        }
+    }
+
+    std::vector<uint32_t> ret;
+    ret.reserve(n);
+    const uint64_t all = n == 64 ? ~uint64_t{0} : (uint64_t{1} << n) - 1;
+    uint64_t done{0};
+    while (done != all) {
+        uint64_t best_set{0};
+        CAmount best_fee{0};
+        int64_t best_size{0};
+        for (uint32_t i = 0; i < n; ++i) {
+            if (done >> i & 1) continue;
+            const uint64_t set = ancestors[i] & ~done;
+            CAmount fee{0};
+            int64_t size{0};
+            for (uint32_t j = 0; j < n; ++j) {
+                if (set >> j & 1) {
+                    fee += txs[j].fee;
+                    size += txs[j].size;
+                }
+            }
+            if (best_set == 0 || FeeRateHigher(fee, size, best_fee, best_size) ||
+                (!FeeRateHigher(best_fee, best_size, fee, size) && size < best_size)) {
+                best_set = set;
+                best_fee = fee;
+                best_size = size;
+            }
+        }
+        for (const uint32_t i : topo) {
+            if (best_set >> i & 1) ret.push_back(i);
+        }
+        done |= best_set;
+    }
+    return ret;
+}
+
+std::vector<ClusterChunk> ChunkLinearization(const std::vector<ClusterTx>& txs, const std::vector<uint32_t>& linearization)
+{
+    std::vector<ClusterChunk> chunks;
+    for (const uint32_t i : linearization) {
+        chunks.push_back({txs[i].fee, txs[i].size, 1});
+        // A chunk paying more than the one before it is mined together with it
+        while (chunks.size() >= 2 && FeeRateHigher(chunks.back().fee, chunks.back().size,
+                                                    chunks[chunks.size() - 2].fee, chunks[chunks.size() - 2].size)) {
+            const ClusterChunk last = chunks.back();
+            chunks.pop_back();
+            chunks.back().fee += last.fee;
+            chunks.back().size += last.size;
+            chunks.back().count += last.count;
+        }
+    }
+    return chunks;
+}
@@ -0,0 +1,53 @@
+// Copyright (c) 2026 The Dash Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_POLICY_CLUSTER_H
+#define BITCOIN_POLICY_CLUSTER_H
+
+#include <amount.h>
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * Clusters are the connected components of the mempool dependency graph. A linearization is an order of the
+ * transactions of a cluster in which parents come before their children, and its chunks are the groups of
+ * consecutive transactions with decreasing feerate which mining and eviction take or drop as a whole.
+ */
+
+/** Default for -clustermempool */
+static constexpr bool DEFAULT_CLUSTER_MEMPOOL{false};
+/** Clusters up to this many transactions are linearized by ancestor set feerate, larger ones by topology only */
+static constexpr unsigned int MAX_CLUSTER_LINEARIZE_SIZE{64};
+
+struct ClusterTx {
+    CAmount fee{0};
+    int64_t size{0};
+    //! indexes of the in-cluster parents
+    std::vector<uint32_t> parents;
+};
+
+struct ClusterChunk {
+    CAmount fee{0};
+    int64_t size{0};
+    uint32_t count{0};
+};
+
+/** Whether fee_a/size_a is a higher feerate than fee_b/size_b */
+inline bool FeeRateHigher(CAmount fee_a, int64_t size_a, CAmount fee_b, int64_t size_b)
+{
+    // same as the mempool score comparators, the products overflow int64_t for large fees
+    return (double)fee_a * size_b > (double)fee_b * size_a;
+}
+
+/**
+ * Order the transactions of a cluster for mining. Repeatedly the remaining ancestor set with the highest
+ * feerate is taken, which is what the ancestor score block assembly finds but without revisiting descendants.
+ */
+std::vector<uint32_t> LinearizeCluster(const std::vector<ClusterTx>& txs);
+
+/** Split a linearization into chunks of decreasing feerate */
+std::vector<ClusterChunk> ChunkLinearization(const std::vector<ClusterTx>& txs, const std::vector<uint32_t>& linearization);
+
+#endif // BITCOIN_POLICY_CLUSTER_H
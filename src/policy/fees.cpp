@@ -13,6 +13,8 @@
 #include <util/serfloat.h>
 #include <util/system.h>
 
+#include <algorithm>
+
 static const char* FEE_ESTIMATES_FILENAME = "fee_estimates.dat";
 
 static constexpr double INF_FEERATE = 1e99;
@@ -59,7 +61,11 @@ class TxConfirmStats
 private:
     //Define the buckets we will group transactions into
     const std::vector<double>& buckets;              // The upper-bound of the range for the bucket (inclusive)
-    const std::map<double, unsigned int>& bucketMap; // Map of bucket upper-bound to index into all vectors by bucket
+
+    // Number of buckets and of confirmation periods, the tables below hold
+    // one row of m_num_buckets values per period in a single allocation
+    size_t m_num_buckets;
+    size_t m_num_periods;
 
     // For each bucket X:
     // Count the total # of txs in each bucket
@@ -68,11 +74,11 @@ private:
 
     // Count the total # of txs confirmed within Y blocks in each bucket
     // Track the historical moving average of these totals over blocks
-    std::vector<std::vector<double>> confAvg; // confAvg[Y][X]
+    std::vector<double> confAvg; // confAvg[Y * m_num_buckets + X]
 
     // Track moving avg of txs which have been evicted from the mempool
     // after failing to be confirmed within Y blocks
-    std::vector<std::vector<double>> failAvg; // failAvg[Y][X]
+    std::vector<double> failAvg; // failAvg[Y * m_num_buckets + X]
 
     // Sum the total feerate of all tx's in each bucket
     // Track the historical moving average of this total over blocks
@@ -89,12 +95,16 @@ private:
     // Mempool counts of outstanding transactions
     // For each bucket X, track the number of transactions in the mempool
     // that are unconfirmed for each possible confirmation value Y
-    std::vector<std::vector<int> > unconfTxs;  //unconfTxs[Y][X]
+    std::vector<int> unconfTxs;  //unconfTxs[Y * m_num_buckets + X]
     // transactions still unconfirmed after GetMaxConfirms for each bucket
     std::vector<int> oldUnconfTxs;
 
     void resizeInMemoryCounters(size_t newbuckets);
 
+    /** Convert between the flat tables and the nested vectors of the estimates file */
+    static std::vector<std::vector<double>> ToRows(const std::vector<double>& table, size_t num_buckets);
+    static std::vector<double> FromRows(const std::vector<std::vector<double>>& rows, size_t num_buckets);
+
 public:
     /**
      * Create new TxConfirmStats. This is called by BlockPolicyEstimator's
@@ -103,8 +113,7 @@ public:
      * @param maxPeriods max number of periods to track
      * @param decay how much to decay the historical moving average per block
      */
-    TxConfirmStats(const std::vector<double>& defaultBuckets, const std::map<double, unsigned int>& defaultBucketMap,
-                   unsigned int maxPeriods, double decay, unsigned int scale);
+    TxConfirmStats(const std::vector<double>& defaultBuckets, unsigned int maxPeriods, double decay, unsigned int scale);
 
     /** Roll the circular buffer for unconfirmed txs*/
     void ClearCurrent(unsigned int nBlockHeight);
@@ -113,12 +122,13 @@ public:
      * Record a new transaction data point in the current block stats
      * @param blocksToConfirm the number of blocks it took this transaction to confirm
      * @param val the feerate of the transaction
+     * @param bucketIndex the bucket of the feerate
      * @warning blocksToConfirm is 1-based and has to be >= 1
      */
-    void Record(int blocksToConfirm, double val);
+    void Record(int blocksToConfirm, double val, unsigned int bucketIndex);
 
-    /** Record a new transaction entering the mempool*/
-    unsigned int NewTx(unsigned int nBlockHeight, double val);
+    /** Record a new transaction entering the mempool in the given feerate bucket*/
+    void NewTx(unsigned int nBlockHeight, unsigned int bucketIndex);
 
     /** Remove a transaction from mempool tracking stats*/
     void removeTx(unsigned int entryHeight, unsigned int nBestSeenHeight,
@@ -142,7 +152,7 @@ public:
                              EstimationResult *result = nullptr) const;
 
     /** Return the max number of confirms we're tracking */
-    unsigned int GetMaxConfirms() const { return scale * confAvg.size(); }
+    unsigned int GetMaxConfirms() const { return scale * m_num_periods; }
 
     /** Write state of estimation data to a file*/
     void Write(CAutoFile& fileout) const;
@@ -156,17 +166,12 @@ public:
 
 
 TxConfirmStats::TxConfirmStats(const std::vector<double>& defaultBuckets,
-                                const std::map<double, unsigned int>& defaultBucketMap,
                                unsigned int maxPeriods, double _decay, unsigned int _scale)
-    : buckets(defaultBuckets), bucketMap(defaultBucketMap), decay(_decay), scale(_scale)
+    : buckets(defaultBuckets), m_num_buckets(defaultBuckets.size()), m_num_periods(maxPeriods), decay(_decay), scale(_scale)
 {
     assert(_scale != 0 && "_scale must be non-zero");
-    confAvg.resize(maxPeriods);
-    failAvg.resize(maxPeriods);
-    for (unsigned int i = 0; i < maxPeriods; i++) {
-        confAvg[i].resize(buckets.size());
-        failAvg[i].resize(buckets.size());
-    }
+    confAvg.resize(m_num_periods * m_num_buckets);
+    failAvg.resize(m_num_periods * m_num_buckets);
 
     txCtAvg.resize(buckets.size());
     m_feerate_avg.resize(buckets.size());
@@ -176,32 +181,50 @@ TxConfirmStats::TxConfirmStats(const std::vector<double>& defaultBuckets,
 
 void TxConfirmStats::resizeInMemoryCounters(size_t newbuckets) {
     // newbuckets must be passed in because the buckets referred to during Read have not been updated yet.
-    unconfTxs.resize(GetMaxConfirms());
-    for (unsigned int i = 0; i < unconfTxs.size(); i++) {
-        unconfTxs[i].resize(newbuckets);
+    unconfTxs.assign(size_t{GetMaxConfirms()} * newbuckets, 0);
+    oldUnconfTxs.assign(newbuckets, 0);
+}
+
+std::vector<std::vector<double>> TxConfirmStats::ToRows(const std::vector<double>& table, size_t num_buckets)
+{
+    std::vector<std::vector<double>> rows;
+    rows.reserve(table.size() / num_buckets);
+    for (auto it = table.begin(); it != table.end(); it += num_buckets) {
+        rows.emplace_back(it, it + num_buckets);
+    }
+    return rows;
+}
+
+std::vector<double> TxConfirmStats::FromRows(const std::vector<std::vector<double>>& rows, size_t num_buckets)
+{
+    std::vector<double> table;
+    table.reserve(rows.size() * num_buckets);
+    for (const auto& row : rows) {
+        assert(row.size() == num_buckets);
+        table.insert(table.end(), row.begin(), row.end());
     }
-    oldUnconfTxs.resize(newbuckets);
+    return table;
 }
 
 // Roll the unconfirmed txs circular buffer
 void TxConfirmStats::ClearCurrent(unsigned int nBlockHeight)
 {
-    for (unsigned int j = 0; j < buckets.size(); j++) {
-        oldUnconfTxs[j] += unconfTxs[nBlockHeight % unconfTxs.size()][j];
-        unconfTxs[nBlockHeight%unconfTxs.size()][j] = 0;
+    int* const current = &unconfTxs[(nBlockHeight % GetMaxConfirms()) * m_num_buckets];
+    for (size_t j = 0; j < m_num_buckets; j++) {
+        oldUnconfTxs[j] += current[j];
     }
+    std::fill(current, current + m_num_buckets, 0);
 }
 
 
-void TxConfirmStats::Record(int blocksToConfirm, double feerate)
+void TxConfirmStats::Record(int blocksToConfirm, double feerate, unsigned int bucketindex)
 {
     // blocksToConfirm is 1-based
     if (blocksToConfirm < 1)
         return;
     int periodsToConfirm = (blocksToConfirm + scale - 1) / scale;
-    unsigned int bucketindex = bucketMap.lower_bound(feerate)->second;
-    for (size_t i = periodsToConfirm; i <= confAvg.size(); i++) {
-        confAvg[i - 1][bucketindex]++;
+    for (size_t i = periodsToConfirm; i <= m_num_periods; i++) {
+        confAvg[(i - 1) * m_num_buckets + bucketindex]++;
     }
     txCtAvg[bucketindex]++;
     m_feerate_avg[bucketindex] += feerate;
@@ -209,14 +232,13 @@ void TxConfirmStats::Record(int blocksToConfirm, double feerate)
 
 void TxConfirmStats::UpdateMovingAverages()
 {
-    assert(confAvg.size() == failAvg.size());
-    for (unsigned int j = 0; j < buckets.size(); j++) {
-        for (unsigned int i = 0; i < confAvg.size(); i++) {
-            confAvg[i][j] *= decay;
-            failAvg[i][j] *= decay;
+    // Every average is decayed by the same factor, so each table is a single
+    // contiguous pass which the compiler can vectorize
+    const double d = decay;
+    for (std::vector<double>* table : {&confAvg, &failAvg, &m_feerate_avg, &txCtAvg}) {
+        for (double& avg : *table) {
+            avg *= d;
         }
-        m_feerate_avg[j] *= decay;
-        txCtAvg[j] *= decay;
     }
 }
 
@@ -244,7 +266,9 @@ double TxConfirmStats::EstimateMedianVal(int confTarget, double sufficientTxVal,
     unsigned int bestFarBucket = maxbucketindex;
 
     bool foundAnswer = false;
-    unsigned int bins = unconfTxs.size();
+    const unsigned int bins = GetMaxConfirms();
+    const double* const confRow = &confAvg[(periodTarget - 1) * m_num_buckets];
+    const double* const failRow = &failAvg[(periodTarget - 1) * m_num_buckets];
     bool newBucketRange = true;
     bool passing = true;
     EstimatorBucket passBucket;
@@ -257,11 +281,11 @@ double TxConfirmStats::EstimateMedianVal(int confTarget, double sufficientTxVal,
             newBucketRange = false;
         }
         curFarBucket = bucket;
-        nConf += confAvg[periodTarget - 1][bucket];
+        nConf += confRow[bucket];
         totalNum += txCtAvg[bucket];
-        failNum += failAvg[periodTarget - 1][bucket];
-        for (unsigned int confct = confTarget; confct < GetMaxConfirms(); confct++)
-            extraNum += unconfTxs[(nBlockHeight - confct) % bins][bucket];
+        failNum += failRow[bucket];
+        for (unsigned int confct = confTarget; confct < bins; confct++)
+            extraNum += unconfTxs[((nBlockHeight - confct) % bins) * m_num_buckets + bucket];
         extraNum += oldUnconfTxs[bucket];
         // If we have enough transaction data points in this range of buckets,
         // we can test for success
@@ -380,8 +404,8 @@ void TxConfirmStats::Write(CAutoFile& fileout) const
     fileout << scale;
     fileout << Using<VectorFormatter<EncodedDoubleFormatter>>(m_feerate_avg);
     fileout << Using<VectorFormatter<EncodedDoubleFormatter>>(txCtAvg);
-    fileout << Using<VectorFormatter<VectorFormatter<EncodedDoubleFormatter>>>(confAvg);
-    fileout << Using<VectorFormatter<VectorFormatter<EncodedDoubleFormatter>>>(failAvg);
+    fileout << Using<VectorFormatter<VectorFormatter<EncodedDoubleFormatter>>>(ToRows(confAvg, m_num_buckets));
+    fileout << Using<VectorFormatter<VectorFormatter<EncodedDoubleFormatter>>>(ToRows(failAvg, m_num_buckets));
 }
 
 void TxConfirmStats::Read(CAutoFile& filein, int nFileVersion, size_t numBuckets)
@@ -409,29 +433,35 @@ void TxConfirmStats::Read(CAutoFile& filein, int nFileVersion, size_t numBuckets
     if (txCtAvg.size() != numBuckets) {
         throw std::runtime_error("Corrupt estimates file. Mismatch in tx count bucket count");
     }
-    filein >> Using<VectorFormatter<VectorFormatter<EncodedDoubleFormatter>>>(confAvg);
-    maxPeriods = confAvg.size();
+    std::vector<std::vector<double>> fileConfAvg, fileFailAvg;
+    filein >> Using<VectorFormatter<VectorFormatter<EncodedDoubleFormatter>>>(fileConfAvg);
+    maxPeriods = fileConfAvg.size();
     maxConfirms = scale * maxPeriods;
 
     if (maxConfirms <= 0 || maxConfirms > 6 * 24 * 7) { // one week
         throw std::runtime_error("Corrupt estimates file.  Must maintain estimates for between 1 and 1008 (one week) confirms");
     }
     for (unsigned int i = 0; i < maxPeriods; i++) {
-        if (confAvg[i].size() != numBuckets) {
+        if (fileConfAvg[i].size() != numBuckets) {
             throw std::runtime_error("Corrupt estimates file. Mismatch in feerate conf average bucket count");
         }
     }
 
-    filein >> Using<VectorFormatter<VectorFormatter<EncodedDoubleFormatter>>>(failAvg);
-    if (maxPeriods != failAvg.size()) {
+    filein >> Using<VectorFormatter<VectorFormatter<EncodedDoubleFormatter>>>(fileFailAvg);
+    if (maxPeriods != fileFailAvg.size()) {
         throw std::runtime_error("Corrupt estimates file. Mismatch in confirms tracked for failures");
     }
     for (unsigned int i = 0; i < maxPeriods; i++) {
-        if (failAvg[i].size() != numBuckets) {
+        if (fileFailAvg[i].size() != numBuckets) {
             throw std::runtime_error("Corrupt estimates file. Mismatch in one of failure average bucket counts");
         }
     }
 
+    m_num_buckets = numBuckets;
+    m_num_periods = maxPeriods;
+    confAvg = FromRows(fileConfAvg, numBuckets);
+    failAvg = FromRows(fileFailAvg, numBuckets);
+
     // Resize the current block variables which aren't stored in the data file
     // to match the number of confirms and buckets
     resizeInMemoryCounters(numBuckets);
@@ -440,12 +470,10 @@ void TxConfirmStats::Read(CAutoFile& filein, int nFileVersion, size_t numBuckets
              numBuckets, maxConfirms);
 }
 
-unsigned int TxConfirmStats::NewTx(unsigned int nBlockHeight, double val)
+void TxConfirmStats::NewTx(unsigned int nBlockHeight, unsigned int bucketindex)
 {
-    unsigned int bucketindex = bucketMap.lower_bound(val)->second;
-    unsigned int blockIndex = nBlockHeight % unconfTxs.size();
-    unconfTxs[blockIndex][bucketindex]++;
-    return bucketindex;
+    unsigned int blockIndex = nBlockHeight % GetMaxConfirms();
+    unconfTxs[blockIndex * m_num_buckets + bucketindex]++;
 }
 
 void TxConfirmStats::removeTx(unsigned int entryHeight, unsigned int nBestSeenHeight, unsigned int bucketindex, bool inBlock)
@@ -459,7 +487,7 @@ void TxConfirmStats::removeTx(unsigned int entryHeight, unsigned int nBestSeenHe
         return;  //This can't happen because we call this with our best seen height, no entries can have higher
     }
 
-    if (blocksAgo >= (int)unconfTxs.size()) {
+    if (blocksAgo >= (int)GetMaxConfirms()) {
         if (oldUnconfTxs[bucketindex] > 0) {
             oldUnconfTxs[bucketindex]--;
         } else {
@@ -468,9 +496,9 @@ void TxConfirmStats::removeTx(unsigned int entryHeight, unsigned int nBestSeenHe
         }
     }
     else {
-        unsigned int blockIndex = entryHeight % unconfTxs.size();
-        if (unconfTxs[blockIndex][bucketindex] > 0) {
-            unconfTxs[blockIndex][bucketindex]--;
+        unsigned int blockIndex = entryHeight % GetMaxConfirms();
+        if (unconfTxs[blockIndex * m_num_buckets + bucketindex] > 0) {
+            unconfTxs[blockIndex * m_num_buckets + bucketindex]--;
         } else {
             LogPrint(BCLog::ESTIMATEFEE, "Blockpolicy error, mempool tx removed from blockIndex=%u,bucketIndex=%u already\n",
                      blockIndex, bucketindex);
@@ -479,8 +507,8 @@ void TxConfirmStats::removeTx(unsigned int entryHeight, unsigned int nBestSeenHe
     if (!inBlock && (unsigned int)blocksAgo >= scale) { // Only counts as a failure if not confirmed for entire period
         assert(scale != 0);
         unsigned int periodsAgo = blocksAgo / scale;
-        for (size_t i = 0; i < periodsAgo && i < failAvg.size(); i++) {
-            failAvg[i][bucketindex]++;
+        for (size_t i = 0; i < periodsAgo && i < m_num_periods; i++) {
+            failAvg[i * m_num_buckets + bucketindex]++;
         }
     }
 }
@@ -499,12 +527,12 @@ bool CBlockPolicyEstimator::removeTx(uint256 hash, bool inBlock)
 bool CBlockPolicyEstimator::_removeTx(const uint256& hash, bool inBlock)
 {
     AssertLockHeld(m_cs_fee_estimator);
-    std::map<uint256, TxStatsInfo>::iterator pos = mapMemPoolTxs.find(hash);
+    auto pos = mapMemPoolTxs.find(hash);
     if (pos != mapMemPoolTxs.end()) {
         feeStats->removeTx(pos->second.blockHeight, nBestSeenHeight, pos->second.bucketIndex, inBlock);
         shortStats->removeTx(pos->second.blockHeight, nBestSeenHeight, pos->second.bucketIndex, inBlock);
         longStats->removeTx(pos->second.blockHeight, nBestSeenHeight, pos->second.bucketIndex, inBlock);
-        mapMemPoolTxs.erase(hash);
+        mapMemPoolTxs.erase(pos);
         return true;
     } else {
         return false;
@@ -525,9 +553,9 @@ CBlockPolicyEstimator::CBlockPolicyEstimator()
     bucketMap[INF_FEERATE] = bucketIndex;
     assert(bucketMap.size() == buckets.size());
 
-    feeStats = std::make_unique<TxConfirmStats>(buckets, bucketMap, MED_BLOCK_PERIODS, MED_DECAY, MED_SCALE);
-    shortStats = std::make_unique<TxConfirmStats>(buckets, bucketMap, SHORT_BLOCK_PERIODS, SHORT_DECAY, SHORT_SCALE);
-    longStats = std::make_unique<TxConfirmStats>(buckets, bucketMap, LONG_BLOCK_PERIODS, LONG_DECAY, LONG_SCALE);
+    feeStats = std::make_unique<TxConfirmStats>(buckets, MED_BLOCK_PERIODS, MED_DECAY, MED_SCALE);
+    shortStats = std::make_unique<TxConfirmStats>(buckets, SHORT_BLOCK_PERIODS, SHORT_DECAY, SHORT_SCALE);
+    longStats = std::make_unique<TxConfirmStats>(buckets, LONG_BLOCK_PERIODS, LONG_DECAY, LONG_SCALE);
 
     // If the fee estimation file is present, read recorded estimations
     fs::path est_filepath = GetDataDir() / FEE_ESTIMATES_FILENAME;
@@ -545,7 +573,7 @@ void CBlockPolicyEstimator::processTransaction(const CTxMemPoolEntry& entry, boo
 {
     LOCK(m_cs_fee_estimator);
     unsigned int txHeight = entry.GetHeight();
-    uint256 hash = entry.GetTx().GetHash();
+    const uint256& hash = entry.GetTx().GetHash();
     if (mapMemPoolTxs.count(hash)) {
         LogPrint(BCLog::ESTIMATEFEE, "Blockpolicy error mempool tx %s already being tracked\n", hash.ToString());
         return;
@@ -570,13 +598,14 @@ void CBlockPolicyEstimator::processTransaction(const CTxMemPoolEntry& entry, boo
     // Feerates are stored and reported as BTC-per-kb:
     CFeeRate feeRate(entry.GetFee(), entry.GetTxSize());
 
-    mapMemPoolTxs[hash].blockHeight = txHeight;
-    unsigned int bucketIndex = feeStats->NewTx(txHeight, (double)feeRate.GetFeePerK());
-    mapMemPoolTxs[hash].bucketIndex = bucketIndex;
-    unsigned int bucketIndex2 = shortStats->NewTx(txHeight, (double)feeRate.GetFeePerK());
-    assert(bucketIndex == bucketIndex2);
-    unsigned int bucketIndex3 = longStats->NewTx(txHeight, (double)feeRate.GetFeePerK());
-    assert(bucketIndex == bucketIndex3);
+    // All three horizons share the buckets, so the bucket is only looked up once
+    const unsigned int bucketIndex = bucketMap.lower_bound((double)feeRate.GetFeePerK())->second;
+    TxStatsInfo& info = mapMemPoolTxs[hash];
+    info.blockHeight = txHeight;
+    info.bucketIndex = bucketIndex;
+    feeStats->NewTx(txHeight, bucketIndex);
+    shortStats->NewTx(txHeight, bucketIndex);
+    longStats->NewTx(txHeight, bucketIndex);
 }
 
 bool CBlockPolicyEstimator::processBlockTx(unsigned int nBlockHeight, const CTxMemPoolEntry* entry)
@@ -601,9 +630,11 @@ bool CBlockPolicyEstimator::processBlockTx(unsigned int nBlockHeight, const CTxM
     // Feerates are stored and reported as BTC-per-kb:
     CFeeRate feeRate(entry->GetFee(), entry->GetTxSize());
 
-    feeStats->Record(blocksToConfirm, (double)feeRate.GetFeePerK());
-    shortStats->Record(blocksToConfirm, (double)feeRate.GetFeePerK());
-    longStats->Record(blocksToConfirm, (double)feeRate.GetFeePerK());
+    const double feePerK = (double)feeRate.GetFeePerK();
+    const unsigned int bucketIndex = bucketMap.lower_bound(feePerK)->second;
+    feeStats->Record(blocksToConfirm, feePerK, bucketIndex);
+    shortStats->Record(blocksToConfirm, feePerK, bucketIndex);
+    longStats->Record(blocksToConfirm, feePerK, bucketIndex);
     return true;
 }
 
@@ -952,9 +983,9 @@ bool CBlockPolicyEstimator::Read(CAutoFile& filein)
                 throw std::runtime_error("Corrupt estimates file. Must have between 2 and 1000 feerate buckets");
             }
 
-            auto fileFeeStats{std::make_unique<TxConfirmStats>(buckets, bucketMap, MED_BLOCK_PERIODS, MED_DECAY, MED_SCALE)};
-            auto fileShortStats{std::make_unique<TxConfirmStats>(buckets, bucketMap, SHORT_BLOCK_PERIODS, SHORT_DECAY, SHORT_SCALE)};
-            auto fileLongStats{std::make_unique<TxConfirmStats>(buckets, bucketMap, LONG_BLOCK_PERIODS, LONG_DECAY, LONG_SCALE)};
+            auto fileFeeStats{std::make_unique<TxConfirmStats>(buckets, MED_BLOCK_PERIODS, MED_DECAY, MED_SCALE)};
+            auto fileShortStats{std::make_unique<TxConfirmStats>(buckets, SHORT_BLOCK_PERIODS, SHORT_DECAY, SHORT_SCALE)};
+            auto fileLongStats{std::make_unique<TxConfirmStats>(buckets, LONG_BLOCK_PERIODS, LONG_DECAY, LONG_SCALE)};
             fileFeeStats->Read(filein, nVersionThatWrote, numBuckets);
             fileShortStats->Read(filein, nVersionThatWrote, numBuckets);
             fileLongStats->Read(filein, nVersionThatWrote, numBuckets);
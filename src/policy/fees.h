@@ -10,11 +10,13 @@
 #include <uint256.h>
 #include <random.h>
 #include <sync.h>
+#include <util/hasher.h>
 
 #include <array>
 #include <map>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 class CAutoFile;
@@ -253,7 +255,7 @@ private:
     };
 
     // map of txids to information about that transaction
-    std::map<uint256, TxStatsInfo> mapMemPoolTxs GUARDED_BY(m_cs_fee_estimator);
+    std::unordered_map<uint256, TxStatsInfo, SaltedTxidHasher> mapMemPoolTxs GUARDED_BY(m_cs_fee_estimator);
 
     /** Classes to track historical data on transaction confirmations */
     std::unique_ptr<TxConfirmStats> feeStats PT_GUARDED_BY(m_cs_fee_estimator);
@@ -12,9 +12,58 @@
 
 #include <math.h>
 
-unsigned int static KimotoGravityWell(const CBlockIndex* pindexLast, const Consensus::Params& params) {
-    const CBlockIndex *BlockLastSolved = pindexLast;
-    const CBlockIndex *BlockReading = pindexLast;
+#include <algorithm>
+
+CPowWindow g_pow_window;
+
+namespace {
+//! Number of blocks DarkGravityWave averages over
+constexpr int64_t DGW_PAST_BLOCKS = 24;
+
+uint64_t KGWPastBlocksMax(const Consensus::Params& params)
+{
+    uint64_t pastSecondsMax = params.nPowTargetTimespan * 7;
+    return pastSecondsMax / params.nPowTargetSpacing;
+}
+
+/** Walks back from a block through the block index */
+class BlockIndexCursor
+{
+    const CBlockIndex* m_pindex;
+
+public:
+    explicit BlockIndexCursor(const CBlockIndex* pindex) : m_pindex(pindex) {}
+    unsigned int Bits() const { return m_pindex->nBits; }
+    int64_t Time() const { return m_pindex->GetBlockTime(); }
+    int Height() const { return m_pindex->nHeight; }
+    bool HasPrev() const { return m_pindex->pprev != nullptr; }
+    void MovePrev() { m_pindex = m_pindex->pprev; }
+};
+
+/** Walks back from the tip through a CPowWindow */
+class WindowCursor
+{
+    const std::deque<CPowWindow::Entry>& m_entries;
+    size_t m_pos{0};
+
+public:
+    explicit WindowCursor(const std::deque<CPowWindow::Entry>& entries) : m_entries(entries) {}
+    unsigned int Bits() const { return m_entries[m_pos].nBits; }
+    int64_t Time() const { return m_entries[m_pos].nTime; }
+    int Height() const { return m_entries[m_pos].nHeight; }
+    bool HasPrev() const { return Height() > 0; }
+    void MovePrev()
+    {
+        ++m_pos;
+        // The window is sized so the retargets never look past its end
+        assert(m_pos < m_entries.size());
+    }
+};
+} // namespace
+
+template <typename Cursor>
+unsigned int static KimotoGravityWell(Cursor BlockReading, const Consensus::Params& params) {
+    const int64_t nLastSolvedTime = BlockReading.Time();
     uint64_t PastBlocksMass = 0;
     int64_t PastRateActualSeconds = 0;
     int64_t PastRateTargetSeconds = 0;
@@ -26,17 +75,16 @@ unsigned int static KimotoGravityWell(const CBlockIndex* pindexLast, const Conse
     double EventHorizonDeviationSlow;
 
     uint64_t pastSecondsMin = params.nPowTargetTimespan * 0.025;
-    uint64_t pastSecondsMax = params.nPowTargetTimespan * 7;
     uint64_t PastBlocksMin = pastSecondsMin / params.nPowTargetSpacing;
-    uint64_t PastBlocksMax = pastSecondsMax / params.nPowTargetSpacing;
+    uint64_t PastBlocksMax = KGWPastBlocksMax(params);
 
-    if (BlockLastSolved == nullptr || BlockLastSolved->nHeight == 0 || (uint64_t)BlockLastSolved->nHeight < PastBlocksMin) { return UintToArith256(params.powLimit).GetCompact(); }
+    if (BlockReading.Height() == 0 || (uint64_t)BlockReading.Height() < PastBlocksMin) { return UintToArith256(params.powLimit).GetCompact(); }
 
-    for (unsigned int i = 1; BlockReading && BlockReading->nHeight > 0; i++) {
+    for (unsigned int i = 1; BlockReading.Height() > 0; i++) {
         if (PastBlocksMax > 0 && i > PastBlocksMax) { break; }
         PastBlocksMass++;
 
-        PastDifficultyAverage.SetCompact(BlockReading->nBits);
+        PastDifficultyAverage.SetCompact(BlockReading.Bits());
         if (i > 1) {
             // handle negative arith_uint256
             if(PastDifficultyAverage >= PastDifficultyAveragePrev)
@@ -46,7 +94,7 @@ unsigned int static KimotoGravityWell(const CBlockIndex* pindexLast, const Conse
         }
         PastDifficultyAveragePrev = PastDifficultyAverage;
 
-        PastRateActualSeconds = BlockLastSolved->GetBlockTime() - BlockReading->GetBlockTime();
+        PastRateActualSeconds = nLastSolvedTime - BlockReading.Time();
         PastRateTargetSeconds = params.nPowTargetSpacing * PastBlocksMass;
         PastRateAdjustmentRatio = double(1);
         if (PastRateActualSeconds < 0) { PastRateActualSeconds = 0; }
@@ -59,10 +107,10 @@ unsigned int static KimotoGravityWell(const CBlockIndex* pindexLast, const Conse
 
         if (PastBlocksMass >= PastBlocksMin) {
                 if ((PastRateAdjustmentRatio <= EventHorizonDeviationSlow) || (PastRateAdjustmentRatio >= EventHorizonDeviationFast))
-                { assert(BlockReading); break; }
+                { break; }
         }
-        if (BlockReading->pprev == nullptr) { assert(BlockReading); break; }
-        BlockReading = BlockReading->pprev;
+        if (!BlockReading.HasPrev()) { break; }
+        BlockReading.MovePrev();
     }
 
     arith_uint256 bnNew(PastDifficultyAverage);
@@ -78,21 +126,22 @@ unsigned int static KimotoGravityWell(const CBlockIndex* pindexLast, const Conse
     return bnNew.GetCompact();
 }
 
-unsigned int static DarkGravityWave(const CBlockIndex* pindexLast, const Consensus::Params& params) {
+template <typename Cursor>
+unsigned int static DarkGravityWave(Cursor pindex, const Consensus::Params& params) {
     /* current difficulty formula, dash - DarkGravity v3, written by Evan Duffield - evan@dash.org */
     const arith_uint256 bnPowLimit = UintToArith256(params.powLimit);
-    int64_t nPastBlocks = 24;
+    int64_t nPastBlocks = DGW_PAST_BLOCKS;
 
     // make sure we have at least (nPastBlocks + 1) blocks, otherwise just return powLimit
-    if (!pindexLast || pindexLast->nHeight < nPastBlocks) {
+    if (pindex.Height() < nPastBlocks) {
         return bnPowLimit.GetCompact();
     }
 
-    const CBlockIndex *pindex = pindexLast;
+    const int64_t nLastTime = pindex.Time();
     arith_uint256 bnPastTargetAvg;
 
     for (unsigned int nCountBlocks = 1; nCountBlocks <= nPastBlocks; nCountBlocks++) {
-        arith_uint256 bnTarget = arith_uint256().SetCompact(pindex->nBits);
+        arith_uint256 bnTarget = arith_uint256().SetCompact(pindex.Bits());
         if (nCountBlocks == 1) {
             bnPastTargetAvg = bnTarget;
         } else {
@@ -101,14 +150,14 @@ unsigned int static DarkGravityWave(const CBlockIndex* pindexLast, const Consens
         }
 
         if(nCountBlocks != nPastBlocks) {
-            assert(pindex->pprev); // should never fail
-            pindex = pindex->pprev;
+            assert(pindex.HasPrev()); // should never fail
+            pindex.MovePrev();
         }
     }
 
     arith_uint256 bnNew(bnPastTargetAvg);
 
-    int64_t nActualTimespan = pindexLast->GetBlockTime() - pindex->GetBlockTime();
+    int64_t nActualTimespan = nLastTime - pindex.Time();
     // NOTE: is this accurate? nActualTimespan counts it for (nPastBlocks - 1) blocks only...
     int64_t nTargetTimespan = nPastBlocks * params.nPowTargetSpacing;
 
@@ -128,6 +177,80 @@ unsigned int static DarkGravityWave(const CBlockIndex* pindexLast, const Consens
     return bnNew.GetCompact();
 }
 
+static CPowWindow::Entry MakePowWindowEntry(const CBlockIndex& index)
+{
+    return CPowWindow::Entry{index.nBits, index.GetBlockTime(), index.nHeight};
+}
+
+void CPowWindow::SetTip(const CBlockIndex* pindex, const Consensus::Params& params)
+{
+    LOCK(m_mutex);
+    if (pindex == nullptr || pindex->phashBlock == nullptr) {
+        ResetLocked();
+        return;
+    }
+    m_memo[0].reset();
+    m_memo[1].reset();
+
+    const size_t capacity = std::max<uint64_t>(DGW_PAST_BLOCKS, KGWPastBlocksMax(params) + 1);
+    const bool same_chain = m_tip != nullptr && m_params == &params && m_capacity == capacity;
+    if (same_chain && pindex->pprev == m_tip) {
+        // Connected a block
+        m_entries.push_front(MakePowWindowEntry(*pindex));
+        if (m_entries.size() > capacity) m_entries.pop_back();
+    } else if (same_chain && pindex == m_tip_prev && m_entries.size() > 1) {
+        // Disconnected the tip, top up the far end again
+        m_entries.pop_front();
+        if (m_entries.back().nHeight > 0) {
+            m_entries.push_back(MakePowWindowEntry(*pindex->GetAncestor(m_entries.back().nHeight - 1)));
+        }
+    } else {
+        m_entries.clear();
+        for (const CBlockIndex* p = pindex; p != nullptr && m_entries.size() < capacity; p = p->pprev) {
+            m_entries.push_back(MakePowWindowEntry(*p));
+        }
+    }
+    m_capacity = capacity;
+    m_params = &params;
+    m_tip = pindex;
+    m_tip_prev = pindex->pprev;
+    m_tip_hash = *pindex->phashBlock;
+}
+
+void CPowWindow::Reset()
+{
+    LOCK(m_mutex);
+    ResetLocked();
+}
+
+void CPowWindow::ResetLocked()
+{
+    m_entries.clear();
+    m_capacity = 0;
+    m_tip = nullptr;
+    m_tip_prev = nullptr;
+    m_tip_hash.SetNull();
+    m_params = nullptr;
+    m_memo[0].reset();
+    m_memo[1].reset();
+}
+
+std::optional<unsigned int> CPowWindow::GetRetarget(const CBlockIndex* pindexLast, const Consensus::Params& params, bool dgw)
+{
+    LOCK(m_mutex);
+    if (m_tip == nullptr || pindexLast != m_tip || pindexLast->phashBlock == nullptr || *pindexLast->phashBlock != m_tip_hash || &params != m_params) {
+        return std::nullopt;
+    }
+    // Without an upper bound KGW may look back arbitrarily far
+    if (!dgw && KGWPastBlocksMax(params) == 0) return std::nullopt;
+
+    auto& memo = m_memo[dgw];
+    if (!memo) {
+        memo = dgw ? DarkGravityWave(WindowCursor(m_entries), params) : KimotoGravityWell(WindowCursor(m_entries), params);
+    }
+    return memo;
+}
+
 unsigned int GetNextWorkRequiredBTC(const CBlockIndex* pindexLast, const CBlockHeader *pblock, const Consensus::Params& params)
 {
     assert(pindexLast != nullptr);
@@ -200,11 +323,15 @@ unsigned int GetNextWorkRequired(const CBlockIndex* pindexLast, const CBlockHead
         }
     }
 
-    if (pindexLast->nHeight + 1 < params.nPowDGWHeight) {
-        return KimotoGravityWell(pindexLast, params);
+    const bool dgw = pindexLast->nHeight + 1 >= params.nPowDGWHeight;
+    if (const auto retarget = g_pow_window.GetRetarget(pindexLast, params, dgw)) {
+        return *retarget;
+    }
+    if (!dgw) {
+        return KimotoGravityWell(BlockIndexCursor(pindexLast), params);
     }
 
-    return DarkGravityWave(pindexLast, params);
+    return DarkGravityWave(BlockIndexCursor(pindexLast), params);
 }
 
 // for DIFF_BTC only!
@@ -7,17 +7,66 @@
 #define BITCOIN_POW_H
 
 #include <consensus/params.h>
+#include <sync.h>
+#include <uint256.h>
 
+#include <deque>
+#include <optional>
 #include <stdint.h>
 
 class CBlockHeader;
 class CBlockIndex;
-class uint256;
 
 unsigned int GetNextWorkRequired(const CBlockIndex* pindexLast, const CBlockHeader *pblock, const Consensus::Params&);
 unsigned int CalculateNextWorkRequired(const CBlockIndex* pindexLast, int64_t nFirstBlockTime, const Consensus::Params&);
 
 
+/**
+ * Targets and timestamps of the most recent blocks of the active chain.
+ *
+ * DarkGravityWave and KimotoGravityWell for the tracked tip are evaluated from
+ * this window instead of by walking pprev, and the result is remembered until
+ * the tip moves, so repeated getblocktemplate calls are answered straight away.
+ * Connecting or disconnecting a block only touches the ends of the window.
+ *
+ * It is only ever a cache: for anything but the tracked tip
+ * GetNextWorkRequired() walks the block index as before, using the very same
+ * code.
+ */
+class CPowWindow
+{
+public:
+    struct Entry {
+        unsigned int nBits;
+        int64_t nTime;
+        int nHeight;
+    };
+
+    /** Follow the new tip of the active chain */
+    void SetTip(const CBlockIndex* pindex, const Consensus::Params& params) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+    /** Forget everything, e.g. because the block index is being unloaded */
+    void Reset() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+    /** The DGW (or KGW) retarget after pindexLast, if pindexLast is the tracked tip */
+    std::optional<unsigned int> GetRetarget(const CBlockIndex* pindexLast, const Consensus::Params& params, bool dgw) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+private:
+    void ResetLocked() EXCLUSIVE_LOCKS_REQUIRED(m_mutex);
+
+    Mutex m_mutex;
+    //! Newest block first, min(capacity, tip height + 1) of them
+    std::deque<Entry> m_entries GUARDED_BY(m_mutex);
+    size_t m_capacity GUARDED_BY(m_mutex){0};
+    //! Only compared against, never dereferenced
+    const CBlockIndex* m_tip GUARDED_BY(m_mutex){nullptr};
+    const CBlockIndex* m_tip_prev GUARDED_BY(m_mutex){nullptr};
+    uint256 m_tip_hash GUARDED_BY(m_mutex);
+    const Consensus::Params* m_params GUARDED_BY(m_mutex){nullptr};
+    //! Retargets already computed for the tip, indexed by dgw
+    std::optional<unsigned int> m_memo[2] GUARDED_BY(m_mutex);
+};
+
+extern CPowWindow g_pow_window;
+
 /** Check whether a block hash satisfies the proof-of-work requirement specified by nBits */
 bool CheckProofOfWork(uint256 hash, unsigned int nBits, const Consensus::Params&);
 
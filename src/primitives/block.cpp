@@ -7,33 +7,73 @@
 #include <hash.h>
 #include <streams.h>
 #include <tinyformat.h>
+#include <util/trace.h>
 
 
 uint32_t nKAWPOWActivationTime;
 
+struct CBlockHeaderHashCache::Entry {
+    // Everything GetHash() depends on
+    int32_t nVersion;
+    uint256 hashPrevBlock;
+    uint256 hashMerkleRoot;
+    uint32_t nTime;
+    uint32_t nBits;
+    uint32_t nNonce;
+    uint32_t nHeight;
+    uint64_t nNonce64;
+    uint256 mix_hash;
+    uint32_t nActivationTime;
+
+    uint256 hash;
+
+    Entry(const CBlockHeader& header, const uint256& hashIn) :
+        nVersion(header.nVersion), hashPrevBlock(header.hashPrevBlock), hashMerkleRoot(header.hashMerkleRoot),
+        nTime(header.nTime), nBits(header.nBits), nNonce(header.nNonce),
+        nHeight(header.nHeight), nNonce64(header.nNonce64), mix_hash(header.mix_hash),
+        nActivationTime(nKAWPOWActivationTime), hash(hashIn) {}
+
+    bool Matches(const CBlockHeader& header) const
+    {
+        return nNonce == header.nNonce && nNonce64 == header.nNonce64 && nTime == header.nTime &&
+               nVersion == header.nVersion && nBits == header.nBits && nHeight == header.nHeight &&
+               hashMerkleRoot == header.hashMerkleRoot && hashPrevBlock == header.hashPrevBlock &&
+               mix_hash == header.mix_hash && nActivationTime == nKAWPOWActivationTime;
+    }
+};
+
 uint256 CBlockHeader::GetHash() const
 {
-    return KAWPOWHash_OnlyMix(*this);
+    if (const auto entry = m_hash_cache.Load(); entry && entry->Matches(*this)) {
+        return entry->hash;
+    }
+
+    const uint256 hash = nTime < nKAWPOWActivationTime ? GetX16RHash() : KAWPOWHash_OnlyMix(*this);
+    m_hash_cache.Store(std::make_shared<const CBlockHeaderHashCache::Entry>(*this, hash));
+    return hash;
 }
 
-uint256 CBlockHeader::GetHash() const
+void CBlockHeader::SetKnownHash(const uint256& hash) const
 {
-    if (nTime < nKAWPOWActivationTime) {
-        std::vector<unsigned char> vch(80);
-        CVectorWriter ss(SER_GETHASH, PROTOCOL_VERSION, vch, 0);
-        ss << *this;
-        return HashX11((const char *)vch.data(), (const char *)vch.data() + vch.size(), hashPrevBlock);
-    } else {
-        return KAWPOWHash_OnlyMix(*this);
-    }
+    m_hash_cache.Store(std::make_shared<const CBlockHeaderHashCache::Entry>(*this, hash));
 }
 
 uint256 CBlockHeader::GetX16RHash() const
 {
+    return GetX16RHash(X16RSchedule(hashPrevBlock));
+}
+
+uint256 CBlockHeader::GetX16RHash(const X16RSchedule& schedule) const
+{
+    assert(schedule.GetPrevBlockHash() == hashPrevBlock);
     std::vector<unsigned char> vch(80);
     CVectorWriter ss(SER_GETHASH, PROTOCOL_VERSION, vch, 0);
     ss << *this;
-    return HashX11((const char *)vch.data(), (const char *)vch.data() + vch.size(), hashPrevBlock);
+    TRACE(pow, x16r_hash_start);
+    const uint256 hash = schedule.Hash(vch.data(), vch.size());
+    TRACE1(pow, x16r_hash_done,
+        hash.data());
+    return hash;
 }
 
 uint256 CBlockHeader::GetHashFull(uint256& mix_hash) const
@@ -11,8 +11,42 @@
 #include <serialize.h>
 #include <uint256.h>
 #include <cstddef>
+#include <memory>
 #include <type_traits>
 extern uint32_t nKAWPOWActivationTime;
+
+class X16RSchedule;
+
+/**
+ * Memoized result of CBlockHeader::GetHash().
+ *
+ * X16R and KAWPOW are far too expensive to recompute every time a header's
+ * hash is asked for. The entry remembers the header fields it was computed
+ * from, so changing any of them (e.g. bumping the nonce while mining) simply
+ * makes the next GetHash() miss. The entry is swapped atomically, so const
+ * headers shared between threads may be hashed concurrently.
+ */
+class CBlockHeaderHashCache
+{
+public:
+    struct Entry;
+
+    CBlockHeaderHashCache() = default;
+    CBlockHeaderHashCache(const CBlockHeaderHashCache& other) : m_entry(other.Load()) {}
+    CBlockHeaderHashCache& operator=(const CBlockHeaderHashCache& other)
+    {
+        if (this != &other) Store(other.Load());
+        return *this;
+    }
+
+    std::shared_ptr<const Entry> Load() const { return std::atomic_load(&m_entry); }
+    void Store(std::shared_ptr<const Entry> entry) const { std::atomic_store(&m_entry, std::move(entry)); }
+    void Clear() { Store(nullptr); }
+
+private:
+    mutable std::shared_ptr<const Entry> m_entry;
+};
+
 /** Nodes collect new transactions into a block, hash them into a hash tree,
  * and scan through nonce values to make the block's hash satisfy proof-of-work
  * requirements.  When they solve the proof-of-work, they broadcast the block
@@ -36,6 +70,9 @@ public:
     uint64_t nNonce64;
     uint256 mix_hash;
 
+    // memory only
+    CBlockHeaderHashCache m_hash_cache;
+
     CBlockHeader()
     {
         SetNull();
@@ -70,6 +107,8 @@ public:
         nNonce64 = 0;
         nHeight = 0;
         mix_hash.SetNull();
+
+        m_hash_cache.Clear();
     }
 
     bool IsNull() const
@@ -78,8 +117,13 @@ public:
     }
     uint256 GetHashFull(uint256& mix_hash) const;
     uint256 GetKAWPOWHeaderHash() const;
+    /** The PoW hash identifying this block, only computed again after a header field changed */
     uint256 GetHash() const;
+    /** Seed the memoized hash with one that is already known to be GetHash() of this header, e.g. from a CBlockIndex */
+    void SetKnownHash(const uint256& hash) const;
     uint256 GetX16RHash() const;
+    /** Same as GetX16RHash(), reusing an X16RSchedule built for hashPrevBlock */
+    uint256 GetX16RHash(const X16RSchedule& schedule) const;
     int64_t GetBlockTime() const
     {
         return (int64_t)nTime;
@@ -172,8 +216,7 @@ struct CompressibleBlockHeader : CBlockHeader {
 
     explicit CompressibleBlockHeader(CBlockHeader&& block_header)
     {
-        static_assert(std::is_trivially_copyable_v<CBlockHeader>, "If CBlockHeader is not trivially copyable, please consider using std::move on the next line");
-        *static_cast<CBlockHeader*>(this) = block_header;
+        *static_cast<CBlockHeader*>(this) = std::move(block_header);
 
         // When we create this from a block header, mark everything as uncompressed
         bit_field.SetVersionOffset(0);
@@ -255,6 +298,7 @@ public:
         block.nHeight        = nHeight;
         block.nNonce64       = nNonce64;
         block.mix_hash       = mix_hash;
+        block.m_hash_cache   = m_hash_cache;
         return block;
     }
 
@@ -10,6 +10,8 @@
 #include <script/script.h>
 #include <serialize.h>
 #include <uint256.h>
+
+#include <memory>
 #include <tuple>
 
 /** Transaction types */
@@ -206,6 +208,8 @@ public:
 private:
     /** Memory only. */
     const uint256 hash;
+    /** Memory only. What GetTxPayload decoded from vExtraPayload, see evo/specialtx.h */
+    mutable std::shared_ptr<const void> m_payload_cache;
 
     uint256 ComputeHash() const;
 
@@ -239,6 +243,9 @@ public:
 
     const uint256& GetHash() const { return hash; }
 
+    std::shared_ptr<const void> GetPayloadCache() const { return std::atomic_load(&m_payload_cache); }
+    void SetPayloadCache(std::shared_ptr<const void> cache) const { std::atomic_store(&m_payload_cache, std::move(cache)); }
+
     // Return sum of txouts.
     CAmount GetValueOut() const;
 
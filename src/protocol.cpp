@@ -8,6 +8,7 @@
 #include <util/system.h>
 
 #include <atomic>
+#include <unordered_map>
 
 static std::atomic<bool> g_initial_block_download_completed(false);
 
@@ -326,6 +327,19 @@ const std::vector<std::string> &getAllNetMessageTypes()
     return allNetMessageTypesVec;
 }
 
+size_t GetNetMessageTypeIndex(const std::string& msg_type)
+{
+    static const std::unordered_map<std::string, size_t> indexes = [] {
+        std::unordered_map<std::string, size_t> ret;
+        for (size_t i = 0; i < allNetMessageTypesVec.size(); ++i) {
+            ret.emplace(allNetMessageTypesVec[i], i);
+        }
+        return ret;
+    }();
+    const auto it = indexes.find(msg_type);
+    return it == indexes.end() ? allNetMessageTypesVec.size() : it->second;
+}
+
 bool NetMessageViolatesBlocksOnly(const std::string& msg_type)
 {
     return netMessageTypesViolateBlocksOnlySet.find(msg_type) != netMessageTypesViolateBlocksOnlySet.end();
@@ -300,6 +300,9 @@ extern const char* QUORUMROTATIONINFO;
 /* Get a vector of all valid message types (see above) */
 const std::vector<std::string>& getAllNetMessageTypes();
 
+/** Get the position of a message type in getAllNetMessageTypes(), which is getAllNetMessageTypes().size() for unknown types */
+size_t GetNetMessageTypeIndex(const std::string& msg_type);
+
 /* Whether the message type violates blocks-relay-only policy */
 bool NetMessageViolatesBlocksOnly(const std::string& msg_type);
 
@@ -10,6 +10,8 @@
 
 /* Milliseconds between model updates */
 static const int MODEL_UPDATE_DELAY = 250;
+/* Milliseconds between updates of the CoinJoin progress on the overview page while balances change */
+static const int COINJOIN_PROGRESS_UPDATE_DELAY = 1000;
 
 /* AskPassphraseDialog -- Maximum passphrase length */
 static const int MAX_PASSPHRASE_SIZE = 1024;
@@ -8,6 +8,7 @@
 
 #include <qt/bitcoinunits.h>
 #include <qt/clientmodel.h>
+#include <qt/guiconstants.h>
 #include <qt/guiutil.h>
 #include <qt/optionsmodel.h>
 #include <qt/transactionfilterproxy.h>
@@ -117,6 +118,7 @@ public:
 OverviewPage::OverviewPage(QWidget* parent) :
     QWidget(parent),
     timer(nullptr),
+    m_coinjoin_progress_timer(new QTimer(this)),
     ui(new Ui::OverviewPage),
     clientModel(nullptr),
     walletModel(nullptr),
@@ -171,6 +173,12 @@ OverviewPage::OverviewPage(QWidget* parent) :
 
     timer = new QTimer(this);
     connect(timer, &QTimer::timeout, [this]{ coinJoinStatus(); });
+
+    // The anonymizable balance of the mixing progress is calculated over the whole wallet, while mixing the
+    // balances change many times per block
+    m_coinjoin_progress_timer->setSingleShot(true);
+    m_coinjoin_progress_timer->setInterval(COINJOIN_PROGRESS_UPDATE_DELAY);
+    connect(m_coinjoin_progress_timer, &QTimer::timeout, this, &OverviewPage::updateCoinJoinProgress);
 }
 
 void OverviewPage::handleTransactionClicked(const QModelIndex &index)
@@ -235,7 +243,10 @@ void OverviewPage::setBalance(const interfaces::WalletBalances& balances)
     ui->labelImmatureText->setVisible(showImmature || showWatchOnlyImmature);
     ui->labelWatchImmature->setVisible(!walletModel->wallet().privateKeysDisabled() && showWatchOnlyImmature); // show watch-only immature balance
 
-    updateCoinJoinProgress();
+    // the progress is updated with the latest balances once the timer fires
+    if (!m_coinjoin_progress_timer->isActive()) {
+        m_coinjoin_progress_timer->start();
+    }
 
     int numISLocks = walletModel->getNumISLocks();
     if(cachedNumISLocks != numISLocks) {
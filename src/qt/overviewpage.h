@@ -47,6 +47,8 @@ Q_SIGNALS:
 
 private:
     QTimer *timer;
+    //! Limits how often updateCoinJoinProgress runs while balances change
+    QTimer *m_coinjoin_progress_timer;
     Ui::OverviewPage *ui;
     ClientModel *clientModel;
     WalletModel *walletModel;
@@ -13,11 +13,14 @@
 
 #include <core_io.h>
 #include <interfaces/handler.h>
+#include <sync.h>
 #include <uint256.h>
 #include <util/system.h>
 
 #include <algorithm>
 #include <functional>
+#include <map>
+#include <utility>
 
 #include <QColor>
 #include <QDateTime>
@@ -27,6 +30,9 @@
 #include <QMessageBox>
 
 
+// Batches of notifications at least this large refresh the whole table instead of updating it row by row
+static constexpr size_t MAX_INCREMENTAL_NOTIFICATIONS{10000};
+
 // Amount column is right-aligned it contains numbers
 static int column_alignments[] = {
         Qt::AlignLeft|Qt::AlignVCenter, /* status */
@@ -98,6 +104,13 @@ public:
     bool fQueueNotifications = false;
     std::vector< TransactionNotification > vQueueNotifications;
 
+    /* Notifications which arrived since the model last processed them, with the status and
+     * showTransaction of the latest one per transaction. A CoinJoin session changes the same
+     * transactions many times per block, the model catches up with all of them at once.
+     */
+    Mutex m_pending_mutex;
+    std::map<uint256, std::pair<int, bool>> m_pending_notifications GUARDED_BY(m_pending_mutex);
+
     void NotifyTransactionChanged(const uint256 &hash, ChangeType status);
     void NotifyAddressBookChanged(const CTxDestination &address, const std::string &label, bool isMine, const std::string &purpose, ChangeType status);
     void ShowProgress(const std::string &title, int nProgress);
@@ -124,9 +137,10 @@ public:
     /* Update our model of the wallet incrementally, to synchronize our model of the wallet
        with that of the core.
 
-       Call with transaction that was added, removed or changed.
+       Call with transaction that was added, removed or changed. With batched, status changes
+       don't emit dataChanged, the caller does so once for the whole batch.
      */
-    void updateWallet(interfaces::Wallet& wallet, const uint256 &hash, int status, bool showTransaction)
+    void updateWallet(interfaces::Wallet& wallet, const uint256 &hash, int status, bool showTransaction, bool batched = false)
     {
         qDebug() << "TransactionTablePriv::updateWallet: " + QString::fromStdString(hash.ToString()) + " " + QString::number(status);
 
@@ -202,11 +216,35 @@ public:
                 TransactionRecord *rec = &cachedWallet[i];
                 rec->status.needsUpdate = true;
             }
-            Q_EMIT parent->dataChanged(parent->index(lowerIndex, TransactionTableModel::Status), parent->index(upperIndex, TransactionTableModel::Status));
+            if (!batched) {
+                Q_EMIT parent->dataChanged(parent->index(lowerIndex, TransactionTableModel::Status), parent->index(upperIndex, TransactionTableModel::Status));
+            }
             break;
         }
     }
 
+    /* Apply the pending notifications, the latest one of each transaction is enough to get it
+       in sync with the wallet.
+     */
+    void updateWalletPending(interfaces::Wallet& wallet)
+    {
+        std::map<uint256, std::pair<int, bool>> notifications;
+        WITH_LOCK(m_pending_mutex, notifications.swap(m_pending_notifications));
+        if (notifications.empty()) return;
+        if (notifications.size() >= MAX_INCREMENTAL_NOTIFICATIONS) {
+            // it's much faster to just refresh the whole thing instead
+            refreshWallet(wallet);
+            return;
+        }
+        for (const auto& [hash, notification] : notifications) {
+            updateWallet(wallet, hash, notification.first, notification.second, /* batched */ true);
+        }
+        // Only the visible rows are actually requested again
+        if (!cachedWallet.isEmpty()) {
+            Q_EMIT parent->dataChanged(parent->index(0, TransactionTableModel::Status), parent->index(cachedWallet.size() - 1, TransactionTableModel::Status));
+        }
+    }
+
     void updateAddressBook(interfaces::Wallet& wallet, const QString& address, const QString& label, bool isMine, const QString& purpose, int status)
     {
         std::string address2 = address.toStdString();
@@ -301,6 +339,11 @@ void TransactionTableModel::updateTransaction(const QString &hash, int status, b
     priv->updateWallet(walletModel->wallet(), updated, status, showTransaction);
 }
 
+void TransactionTableModel::updatePendingTransactions()
+{
+    priv->updateWalletPending(walletModel->wallet());
+}
+
 void TransactionTableModel::updateAddressBook(const QString& address, const QString& label, bool isMine,
                                               const QString& purpose, int status)
 {
@@ -796,7 +839,18 @@ void TransactionTablePriv::NotifyTransactionChanged(const uint256 &hash, ChangeT
         vQueueNotifications.push_back(notification);
         return;
     }
-    notification.invoke(parent);
+
+    bool dispatch;
+    {
+        LOCK(m_pending_mutex);
+        // A call to updatePendingTransactions is queued already unless this is the first pending notification
+        dispatch = m_pending_notifications.empty();
+        m_pending_notifications.insert_or_assign(hash, std::make_pair(int(status), showTransaction));
+    }
+    if (dispatch) {
+        bool invoked = QMetaObject::invokeMethod(parent, "updatePendingTransactions", Qt::QueuedConnection);
+        assert(invoked);
+    }
 }
 
 void TransactionTablePriv::NotifyAddressBookChanged(const CTxDestination &address, const std::string &label, bool isMine, const std::string &purpose, ChangeType status)
@@ -818,7 +872,7 @@ void TransactionTablePriv::ShowProgress(const std::string &title, int nProgress)
     if (nProgress == 100)
     {
         fQueueNotifications = false;
-        if (vQueueNotifications.size() < 10000) {
+        if (vQueueNotifications.size() < MAX_INCREMENTAL_NOTIFICATIONS) {
             if (vQueueNotifications.size() > 10) { // prevent balloon spam, show maximum 10 balloons
                 bool invoked = QMetaObject::invokeMethod(parent, "setProcessingQueuedTransactions", Qt::QueuedConnection, Q_ARG(bool, true));
                 assert(invoked);
@@ -117,6 +117,8 @@ public Q_SLOTS:
     void refreshWallet();
     /* New transaction, or transaction changed status */
     void updateTransaction(const QString &hash, int status, bool showTransaction);
+    /* Transactions changed, apply all notifications received since the last call */
+    void updatePendingTransactions();
     void updateAddressBook(const QString &address, const QString &label,
                            bool isMine, const QString &purpose, int status);
     void updateConfirmations();
@@ -23,6 +23,7 @@
 #include <sync.h>
 #include <txmempool.h>
 #include <util/check.h>
+#include <util/perfcounters.h>
 #include <validation.h>
 #include <version.h>
 
@@ -222,9 +223,8 @@ static bool rest_headers(const CoreContext& context,
             ssHeader << pindex->GetBlockHeader();
         }
 
-        std::string binaryHeader = ssHeader.str();
         req->WriteHeader("Content-Type", "application/octet-stream");
-        req->WriteReply(HTTP_OK, binaryHeader);
+        req->WriteReply(HTTP_OK, ssHeader);
         return true;
     }
 
@@ -236,7 +236,7 @@ static bool rest_headers(const CoreContext& context,
 
         std::string strHex = HexStr(ssHeader) + "\n";
         req->WriteHeader("Content-Type", "text/plain");
-        req->WriteReply(HTTP_OK, strHex);
+        req->WriteReply(HTTP_OK, std::move(strHex));
         return true;
     }
     case RetFormat::JSON: {
@@ -246,7 +246,7 @@ static bool rest_headers(const CoreContext& context,
         }
         std::string strJSON = jsonHeaders.write() + "\n";
         req->WriteHeader("Content-Type", "application/json");
-        req->WriteReply(HTTP_OK, strJSON);
+        req->WriteReply(HTTP_OK, std::move(strJSON));
         return true;
     }
     default: {
@@ -269,7 +269,7 @@ static bool rest_block(const CoreContext& context,
     if (!ParseHashStr(hashStr, hash))
         return RESTERR(req, HTTP_BAD_REQUEST, "Invalid hash: " + hashStr);
 
-    CBlock block;
+    FlatFilePos block_pos;
     CBlockIndex* pblockindex = nullptr;
     CBlockIndex* tip = nullptr;
     {
@@ -286,26 +286,31 @@ static bool rest_block(const CoreContext& context,
         if (IsBlockPruned(pblockindex))
             return RESTERR(req, HTTP_NOT_FOUND, hashStr + " not available (pruned data)");
 
+        block_pos = pblockindex->GetBlockPos();
+    }
+
+    // The binary and hex formats are served as the block is stored, without deserializing it first
+    std::vector<uint8_t> block_data;
+    CBlock block;
+    if (rf == RetFormat::BINARY || rf == RetFormat::HEX) {
+        if (!ReadRawBlockFromDisk(block_data, block_pos, Params().MessageStart()))
+            return RESTERR(req, HTTP_NOT_FOUND, hashStr + " not found");
+    } else if (rf == RetFormat::JSON) {
         if (!ReadBlockFromDisk(block, pblockindex, Params().GetConsensus()))
             return RESTERR(req, HTTP_NOT_FOUND, hashStr + " not found");
     }
 
     switch (rf) {
     case RetFormat::BINARY: {
-        CDataStream ssBlock(SER_NETWORK, PROTOCOL_VERSION);
-        ssBlock << block;
-        std::string binaryBlock = ssBlock.str();
         req->WriteHeader("Content-Type", "application/octet-stream");
-        req->WriteReply(HTTP_OK, binaryBlock);
+        req->WriteReply(HTTP_OK, MakeByteSpan(block_data));
         return true;
     }
 
     case RetFormat::HEX: {
-        CDataStream ssBlock(SER_NETWORK, PROTOCOL_VERSION);
-        ssBlock << block;
-        std::string strHex = HexStr(ssBlock) + "\n";
+        std::string strHex = HexStr(block_data) + "\n";
         req->WriteHeader("Content-Type", "text/plain");
-        req->WriteReply(HTTP_OK, strHex);
+        req->WriteReply(HTTP_OK, std::move(strHex));
         return true;
     }
 
@@ -313,7 +318,7 @@ static bool rest_block(const CoreContext& context,
         UniValue objBlock = blockToJSON(block, tip, pblockindex, *llmq::chainLocksHandler, *llmq::quorumInstantSendManager, showTxDetails);
         std::string strJSON = objBlock.write() + "\n";
         req->WriteHeader("Content-Type", "application/json");
-        req->WriteReply(HTTP_OK, strJSON);
+        req->WriteReply(HTTP_OK, std::move(strJSON));
         return true;
     }
 
@@ -350,7 +355,7 @@ static bool rest_chaininfo(const CoreContext& context, HTTPRequest* req, const s
         UniValue chainInfoObject = getblockchaininfo(jsonRequest);
         std::string strJSON = chainInfoObject.write() + "\n";
         req->WriteHeader("Content-Type", "application/json");
-        req->WriteReply(HTTP_OK, strJSON);
+        req->WriteReply(HTTP_OK, std::move(strJSON));
         return true;
     }
     default: {
@@ -359,6 +364,17 @@ static bool rest_chaininfo(const CoreContext& context, HTTPRequest* req, const s
     }
 }
 
+static bool rest_metrics(const CoreContext& context, HTTPRequest* req, const std::string& strURIPart)
+{
+    // Prometheus scrapes a plain path, so the text format is served without a suffix
+    if (!strURIPart.empty()) {
+        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: none)");
+    }
+    req->WriteHeader("Content-Type", "text/plain; version=0.0.4");
+    req->WriteReply(HTTP_OK, perf::FormatPrometheus(perf::GetSnapshot()));
+    return true;
+}
+
 static bool rest_mempool_info(const CoreContext& context, HTTPRequest* req, const std::string& strURIPart)
 {
     if (!CheckWarmup(req))
@@ -374,7 +390,7 @@ static bool rest_mempool_info(const CoreContext& context, HTTPRequest* req, cons
 
         std::string strJSON = mempoolInfoObject.write() + "\n";
         req->WriteHeader("Content-Type", "application/json");
-        req->WriteReply(HTTP_OK, strJSON);
+        req->WriteReply(HTTP_OK, std::move(strJSON));
         return true;
     }
     default: {
@@ -397,7 +413,7 @@ static bool rest_mempool_contents(const CoreContext& context, HTTPRequest* req,
 
         std::string strJSON = mempoolObject.write() + "\n";
         req->WriteHeader("Content-Type", "application/json");
-        req->WriteReply(HTTP_OK, strJSON);
+        req->WriteReply(HTTP_OK, std::move(strJSON));
         return true;
     }
     default: {
@@ -446,7 +462,7 @@ static bool rest_tx(const CoreContext& context, HTTPRequest* req, const std::str
 
         std::string strHex = HexStr(ssTx) + "\n";
         req->WriteHeader("Content-Type", "text/plain");
-        req->WriteReply(HTTP_OK, strHex);
+        req->WriteReply(HTTP_OK, std::move(strHex));
         return true;
     }
 
@@ -455,7 +471,7 @@ static bool rest_tx(const CoreContext& context, HTTPRequest* req, const std::str
         TxToUniv(*tx, hashBlock, objTx);
         std::string strJSON = objTx.write() + "\n";
         req->WriteHeader("Content-Type", "application/json");
-        req->WriteReply(HTTP_OK, strJSON);
+        req->WriteReply(HTTP_OK, std::move(strJSON));
         return true;
     }
 
@@ -615,7 +631,7 @@ static bool rest_getutxos(const CoreContext& context, HTTPRequest* req, const st
         std::string strHex = HexStr(ssGetUTXOResponse) + "\n";
 
         req->WriteHeader("Content-Type", "text/plain");
-        req->WriteReply(HTTP_OK, strHex);
+        req->WriteReply(HTTP_OK, std::move(strHex));
         return true;
     }
 
@@ -645,7 +661,7 @@ static bool rest_getutxos(const CoreContext& context, HTTPRequest* req, const st
         // return json string
         std::string strJSON = objGetUTXOResponse.write() + "\n";
         req->WriteHeader("Content-Type", "application/json");
-        req->WriteReply(HTTP_OK, strJSON);
+        req->WriteReply(HTTP_OK, std::move(strJSON));
         return true;
     }
     default: {
@@ -707,23 +723,26 @@ static bool rest_blockhash_by_height(const CoreContext& context, HTTPRequest* re
 static const struct {
     const char* prefix;
     bool (*handler)(const CoreContext& context, HTTPRequest* req, const std::string& strReq);
+    HTTPWorkClass work_class;
 } uri_prefixes[] = {
-      {"/rest/tx/", rest_tx},
-      {"/rest/block/notxdetails/", rest_block_notxdetails},
-      {"/rest/block/", rest_block_extended},
-      {"/rest/chaininfo", rest_chaininfo},
-      {"/rest/mempool/info", rest_mempool_info},
-      {"/rest/mempool/contents", rest_mempool_contents},
-      {"/rest/headers/", rest_headers},
-      {"/rest/getutxos", rest_getutxos},
-      {"/rest/blockhashbyheight/", rest_blockhash_by_height},
+      {"/rest/tx/", rest_tx, HTTPWorkClass::DEFAULT},
+      {"/rest/block/notxdetails/", rest_block_notxdetails, HTTPWorkClass::SLOW},
+      {"/rest/block/", rest_block_extended, HTTPWorkClass::SLOW},
+      {"/rest/chaininfo", rest_chaininfo, HTTPWorkClass::DEFAULT},
+      {"/rest/mempool/info", rest_mempool_info, HTTPWorkClass::DEFAULT},
+      {"/rest/metrics", rest_metrics, HTTPWorkClass::DEFAULT},
+      {"/rest/mempool/contents", rest_mempool_contents, HTTPWorkClass::SLOW},
+      {"/rest/headers/", rest_headers, HTTPWorkClass::DEFAULT},
+      {"/rest/getutxos", rest_getutxos, HTTPWorkClass::DEFAULT},
+      {"/rest/blockhashbyheight/", rest_blockhash_by_height, HTTPWorkClass::DEFAULT},
 };
 
 void StartREST(const CoreContext& context)
 {
     for (const auto& up : uri_prefixes) {
         auto handler = [&context, up](HTTPRequest* req, const std::string& prefix) { return up.handler(context, req, prefix); };
-        RegisterHTTPHandler(up.prefix, false, handler);
+        auto classifier = [up](HTTPRequest*, const std::string&) { return up.work_class; };
+        RegisterHTTPHandler(up.prefix, false, handler, classifier);
     }
 }
 
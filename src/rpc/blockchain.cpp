@@ -18,6 +18,7 @@
 #include <deploymentstatus.h>
 #include <index/blockfilterindex.h>
 #include <index/coinstatsindex.h>
+#include <index/timestampindex.h>
 #include <index/txindex.h>
 #include <llmq/context.h>
 #include <node/blockstorage.h>
@@ -46,6 +47,7 @@
 #include <evo/specialtx.h>
 #include <evo/cbtx.h>
 #include <evo/evodb.h>
+#include <evo/evosnapshot.h>
 
 #include <llmq/chainlocks.h>
 #include <llmq/instantsend.h>
@@ -227,12 +229,12 @@ UniValue blockToJSON(const CBlock& block, const CBlockIndex* tip, const CBlockIn
             bool fLocked = isman.IsLocked(tx->GetHash());
             objTx.pushKV("instantlock", fLocked || result["chainlock"].get_bool());
             objTx.pushKV("instantlock_internal", fLocked);
-            txs.push_back(objTx);
+            txs.push_back(std::move(objTx));
         }
         else
             txs.push_back(tx->GetHash().GetHex());
     }
-    result.pushKV("tx", txs);
+    result.pushKV("tx", std::move(txs));
     if (!block.vtx[0]->vExtraPayload.empty()) {
         if (const auto opt_cbTx = GetTxPayload<CCbTx>(block.vtx[0]->vExtraPayload)) {
             result.pushKV("cbTx", opt_cbTx->ToJson());
@@ -573,7 +575,7 @@ UniValue MempoolToJSON(const CTxMemPool& pool, llmq::CInstantSendManager* isman,
             // Mempool has unique entries so there is no advantage in using
             // UniValue::pushKV, which checks if the key already exists in O(N).
             // UniValue::__pushKV is used instead which currently is O(1).
-            o.__pushKV(hash.ToString(), info);
+            o.__pushKV(hash.ToString(), std::move(info));
         }
         return o;
     } else {
@@ -810,7 +812,11 @@ static UniValue getblockhashes(const JSONRPCRequest& request)
     unsigned int low = request.params[1].get_int();
     std::vector<uint256> blockHashes;
 
-    if (!GetTimestampIndex(high, low, blockHashes)) {
+    if (g_timestampindex) {
+        g_timestampindex->BlockUntilSyncedToCurrentChain();
+    }
+
+    if (!g_timestampindex || !g_timestampindex->FindBlockHashes(high, low, blockHashes)) {
         throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for block hashes");
     }
 
@@ -1273,9 +1279,9 @@ static UniValue pruneblockchain(const JSONRPCRequest& request)
         throw JSONRPCError(RPC_MISC_ERROR, "Blockchain is too short for pruning.");
     else if (height > chainHeight)
         throw JSONRPCError(RPC_INVALID_PARAMETER, "Blockchain is shorter than the attempted prune height.");
-    else if (height > chainHeight - MIN_BLOCKS_TO_KEEP) {
+    else if (height > chainHeight - nPruneBlocksToKeep) {
         LogPrint(BCLog::RPC, "Attempt to prune blocks close to the tip.  Retaining the minimum number of blocks.\n");
-        height = chainHeight - MIN_BLOCKS_TO_KEEP;
+        height = chainHeight - nPruneBlocksToKeep;
     }
 
     PruneBlockFilesManual(active_chainstate, height);
@@ -1897,6 +1903,7 @@ UniValue MempoolInfoToJSON(const CTxMemPool& pool, llmq::CInstantSendManager& is
     ret.pushKV("size", (int64_t)pool.size());
     ret.pushKV("bytes", (int64_t)pool.GetTotalTxSize());
     ret.pushKV("usage", (int64_t)pool.DynamicMemoryUsage());
+    ret.pushKV("indexusage", (int64_t)pool.IndexDynamicMemoryUsage());
     ret.pushKV("total_fee", ValueFromAmount(pool.GetTotalFee()));
     size_t maxmempool = gArgs.GetArg("-maxmempool", DEFAULT_MAX_MEMPOOL_SIZE) * 1000000;
     ret.pushKV("maxmempool", (int64_t) maxmempool);
@@ -1919,6 +1926,7 @@ static UniValue getmempoolinfo(const JSONRPCRequest& request)
                 {RPCResult::Type::NUM, "size", "Current tx count"},
                 {RPCResult::Type::NUM, "bytes", "Sum of all transaction sizes"},
                 {RPCResult::Type::NUM, "usage", "Total memory usage for the mempool"},
+                {RPCResult::Type::NUM, "indexusage", "Memory usage of the mempool address and spent indexes, not included in usage"},
                 {RPCResult::Type::STR_AMOUNT, "total_fee", "Total fees for the mempool in " + CURRENCY_UNIT + ", ignoring modified fees through prioritizetransaction"},
                 {RPCResult::Type::NUM, "maxmempool", "Maximum memory usage for the mempool"},
                 {RPCResult::Type::STR_AMOUNT, "mempoolminfee", "Minimum fee rate in " + CURRENCY_UNIT + "/kB for tx to be accepted. Is the maximum of minrelaytxfee and minimum mempool fee"},
@@ -2879,11 +2887,67 @@ UniValue dumptxoutset(const JSONRPCRequest& request)
     return result;
 }
 
+static UniValue loadtxoutsnapshot(const JSONRPCRequest& request)
+{
+    RPCHelpMan{
+        "loadtxoutsnapshot",
+        "Load a UTXO set written by dumptxoutset and continue syncing from its base block.\n"
+        "The snapshot must be of a block known to the chainparams as assumeutxo height. Above DIP0003 it carries the\n"
+        "masternode lists, quorums and credit pool at that block, which are checked against its coinbase.",
+        {
+            {"path", RPCArg::Type::STR, RPCArg::Optional::NO, "Path to the snapshot file. If relative, will be prefixed by datadir."},
+        },
+        RPCResult{
+            RPCResult::Type::OBJ, "", "",
+                {
+                    {RPCResult::Type::NUM, "coins_loaded", "the number of coins loaded from the snapshot"},
+                    {RPCResult::Type::STR_HEX, "base_hash", "the hash of the base of the snapshot"},
+                    {RPCResult::Type::NUM, "base_height", "the height of the base of the snapshot"},
+                    {RPCResult::Type::STR, "path", "the absolute path that the snapshot was loaded from"},
+                }
+        },
+        RPCExamples{
+            HelpExampleCli("loadtxoutsnapshot", "utxo.dat")
+        }
+    }.Check(request);
+
+    NodeContext& node = EnsureAnyNodeContext(request.context);
+    ChainstateManager& chainman = EnsureChainman(node);
+    const fs::path path = fsbridge::AbsPathJoin(GetDataDir(), request.params[0].get_str());
+
+    FILE* file{fsbridge::fopen(path, "rb")};
+    CAutoFile afile{file, SER_DISK, CLIENT_VERSION};
+    if (afile.IsNull()) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Couldn't open file " + path.string() + " for reading.");
+    }
+
+    SnapshotMetadata metadata;
+    try {
+        afile >> metadata;
+    } catch (const std::ios_base::failure&) {
+        throw JSONRPCError(RPC_DESERIALIZATION_ERROR, "Unable to read snapshot metadata");
+    }
+
+    if (!chainman.ActivateSnapshot(afile, metadata, /* in_memory */ false)) {
+        throw JSONRPCError(RPC_INTERNAL_ERROR, "Unable to load UTXO snapshot " + path.string() + ", see debug.log for details");
+    }
+
+    const CBlockIndex* base = WITH_LOCK(::cs_main, return chainman.m_blockman.LookupBlockIndex(metadata.m_base_blockhash));
+
+    UniValue result(UniValue::VOBJ);
+    result.pushKV("coins_loaded", metadata.m_coins_count);
+    result.pushKV("base_hash", metadata.m_base_blockhash.ToString());
+    result.pushKV("base_height", base->nHeight);
+    result.pushKV("path", path.string());
+    return result;
+}
+
 UniValue CreateUTXOSnapshot(NodeContext& node, CChainState& chainstate, CAutoFile& afile)
 {
     std::unique_ptr<CCoinsViewCursor> pcursor;
     CCoinsStats stats{CoinStatsHashType::NONE};
     CBlockIndex* tip;
+    std::optional<CEvoSnapshot> evo_snapshot;
 
     {
         // We need to lock cs_main to ensure that the coinsdb isn't written to
@@ -2909,6 +2973,16 @@ UniValue CreateUTXOSnapshot(NodeContext& node, CChainState& chainstate, CAutoFil
         pcursor = chainstate.CoinsDB().Cursor();
         tip = chainstate.m_blockman.LookupBlockIndex(stats.hashBlock);
         CHECK_NONFATAL(tip);
+
+        // Nodes loading the snapshot can't build the masternode lists and quorums without the blocks below it
+        if (tip->nHeight >= Params().GetConsensus().DIP0003Height) {
+            CHECK_NONFATAL(node.dmnman && node.cpoolman && node.mnhf_manager);
+            std::string strError;
+            if (!CreateEvoSnapshot(tip, *node.dmnman, *node.cpoolman, *node.mnhf_manager,
+                                   *EnsureLLMQContext(node).quorum_block_processor, evo_snapshot.emplace(), strError)) {
+                throw JSONRPCError(RPC_INTERNAL_ERROR, "Unable to read evo state: " + strError);
+            }
+        }
     }
 
     SnapshotMetadata metadata{tip->GetBlockHash(), stats.coins_count, tip->nChainTx};
@@ -2930,6 +3004,11 @@ UniValue CreateUTXOSnapshot(NodeContext& node, CChainState& chainstate, CAutoFil
         pcursor->Next();
     }
 
+    if (evo_snapshot) {
+        afile << EVO_SNAPSHOT_MAGIC;
+        afile << *evo_snapshot;
+    }
+
     afile.fclose();
 
     UniValue result(UniValue::VOBJ);
@@ -2984,6 +3063,7 @@ static const CRPCCommand commands[] =
     { "hidden",             "waitforblockheight",     &waitforblockheight,     {"height","timeout"} },
     { "hidden",             "syncwithvalidationinterfacequeue", &syncwithvalidationinterfacequeue, {} },
     { "hidden",             "dumptxoutset",           &dumptxoutset,           {"path"} },
+    { "hidden",             "loadtxoutsnapshot",      &loadtxoutsnapshot,      {"path"} },
 };
 // clang-format on
 
@@ -32,9 +32,12 @@ static const CRPCConvertParam vRPCConvertParams[] =
 #if ENABLE_MINER
     { "generatetoaddress", 0, "nblocks" },
     { "generatetoaddress", 2, "maxtries" },
+    { "generatetoaddress", 3, "threads" },
     { "generatetodescriptor", 0, "num_blocks" },
     { "generatetodescriptor", 2, "maxtries" },
+    { "generatetodescriptor", 3, "threads" },
     { "generateblock", 1, "transactions" },
+    { "generateblock", 2, "threads" },
 #endif // ENABLE_MINER
     { "getnetworkhashps", 0, "nblocks" },
     { "getnetworkhashps", 1, "height" },
@@ -172,6 +175,8 @@ static const CRPCConvertParam vRPCConvertParams[] =
     { "setwalletflag", 1, "value" },
     { "getmempoolancestors", 1, "verbose" },
     { "getmempooldescendants", 1, "verbose" },
+    { "getlockstats", 0, "reset" },
+    { "getlockstats", 1, "enable" },
     { "logging", 0, "include" },
     { "logging", 1, "exclude" },
     { "sporkupdate", 1, "value" },
@@ -1788,6 +1788,41 @@ static UniValue bls_fromsecret(const JSONRPCRequest& request, const ChainstateMa
     return ret;
 }
 
+static void bls_cacheinfo_help(const JSONRPCRequest& request)
+{
+    RPCHelpMan{"bls cacheinfo",
+        "\nReturns statistics of the cache of decompressed BLS public keys.\n",
+        {},
+        RPCResult{
+            RPCResult::Type::OBJ, "", "",
+            {
+                {RPCResult::Type::NUM, "size", "Number of public keys in the cache"},
+                {RPCResult::Type::NUM, "max_size", "Number of public keys the cache is truncated to"},
+                {RPCResult::Type::NUM, "hits", "Public keys taken from the cache since startup"},
+                {RPCResult::Type::NUM, "misses", "Public keys decompressed since startup"},
+                {RPCResult::Type::NUM, "hit_rate", "Share of hits in all lookups"},
+            }},
+        RPCExamples{
+            HelpExampleCli("bls cacheinfo", "")
+        },
+    }.Check(request);
+}
+
+static UniValue bls_cacheinfo(const JSONRPCRequest& request)
+{
+    bls_cacheinfo_help(request);
+
+    const CBLSPublicKeyCacheStats stats = GetBLSPublicKeyCacheStats();
+    UniValue ret(UniValue::VOBJ);
+    ret.pushKV("size", uint64_t{stats.size});
+    ret.pushKV("max_size", uint64_t{BLS_PUBLIC_KEY_CACHE_SIZE});
+    ret.pushKV("hits", stats.hits);
+    ret.pushKV("misses", stats.misses);
+    const uint64_t lookups = stats.hits + stats.misses;
+    ret.pushKV("hit_rate", lookups == 0 ? 0.0 : (double)stats.hits / lookups);
+    return ret;
+}
+
 [[ noreturn ]] static void bls_help()
 {
     RPCHelpMan{"bls",
@@ -1795,7 +1830,8 @@ static UniValue bls_fromsecret(const JSONRPCRequest& request, const ChainstateMa
         "To get help on individual commands, use \"help bls command\".\n"
         "\nAvailable commands:\n"
         "  generate          - Create a BLS secret/public key pair\n"
-        "  fromsecret        - Parse a BLS secret key and return the secret/public key pair\n",
+        "  fromsecret        - Parse a BLS secret key and return the secret/public key pair\n"
+        "  cacheinfo         - Return statistics of the BLS public key cache\n",
         {
             {"command", RPCArg::Type::STR, RPCArg::Optional::NO, "The command to execute"},
         },
@@ -1815,6 +1851,8 @@ static UniValue _bls(const JSONRPCRequest& request)
         return bls_generate(new_request, chainman);
     } else if (command == "blsfromsecret") {
         return bls_fromsecret(new_request, chainman);
+    } else if (command == "blscacheinfo") {
+        return bls_cacheinfo(new_request);
     } else {
         bls_help();
     }
@@ -637,7 +637,7 @@ static UniValue ListObjects(CGovernanceManager& govman, const std::string& strCa
         bObj.pushKV("fCachedDelete",  govObj.IsSetCachedDelete());
         bObj.pushKV("fCachedEndorsed",  govObj.IsSetCachedEndorsed());
 
-        objResult.pushKV(govObj.GetHash().ToString(), bObj);
+        objResult.pushKV(govObj.GetHash().ToString(), std::move(bObj));
     }
 
     return objResult;
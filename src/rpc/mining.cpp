@@ -49,6 +49,7 @@
 #include <masternode/sync.h>
 
 #include <memory>
+#include <optional>
 #include <stdint.h>
 
 /**
@@ -118,7 +119,7 @@ static UniValue getnetworkhashps(const JSONRPCRequest& request)
 }
 
 #if ENABLE_MINER
-static bool GenerateBlock(ChainstateManager& chainman, CBlock& block, uint64_t& max_tries, unsigned int& extra_nonce, uint256& block_hash)
+static bool GenerateBlock(ChainstateManager& chainman, CBlock& block, uint64_t& max_tries, unsigned int& extra_nonce, uint256& block_hash, int threads)
 {
     block_hash.SetNull();
 
@@ -130,15 +131,21 @@ static bool GenerateBlock(ChainstateManager& chainman, CBlock& block, uint64_t&
 
     CChainParams chainparams(Params());
 
-    while (max_tries > 0 && block.nNonce < std::numeric_limits<uint32_t>::max() && !CheckProofOfWork(block.GetHash(), block.nBits, chainparams.GetConsensus()) && !ShutdownRequested()) {
-        ++block.nNonce;
-        --max_tries;
-    }
-    if (max_tries == 0 || ShutdownRequested()) {
-        return false;
-    }
-    if (block.nNonce == std::numeric_limits<uint32_t>::max()) {
-        return true;
+    if (block.nTime >= nKAWPOWActivationTime) {
+        if (!SolveKAWPOWBlock(block, chainparams.GetConsensus(), max_tries, threads, [] { return ShutdownRequested(); })) {
+            return false;
+        }
+    } else {
+        while (max_tries > 0 && block.nNonce < std::numeric_limits<uint32_t>::max() && !CheckProofOfWork(block.GetHash(), block.nBits, chainparams.GetConsensus()) && !ShutdownRequested()) {
+            ++block.nNonce;
+            --max_tries;
+        }
+        if (max_tries == 0 || ShutdownRequested()) {
+            return false;
+        }
+        if (block.nNonce == std::numeric_limits<uint32_t>::max()) {
+            return true;
+        }
     }
 
     std::shared_ptr<const CBlock> shared_pblock = std::make_shared<const CBlock>(block);
@@ -152,7 +159,7 @@ static bool GenerateBlock(ChainstateManager& chainman, CBlock& block, uint64_t&
 
 static UniValue generateBlocks(ChainstateManager& chainman, CEvoDB& evodb, CGovernanceManager& govman, CSporkManager& sporkman,
                                LLMQContext& llmq_ctx, const CTxMemPool& mempool, const CScript& coinbase_script, int nGenerate,
-                               uint64_t nMaxTries)
+                               uint64_t nMaxTries, int nThreads)
 {
     int nHeightEnd = 0;
     int nHeight = 0;
@@ -173,7 +180,7 @@ static UniValue generateBlocks(ChainstateManager& chainman, CEvoDB& evodb, CGove
         CBlock *pblock = &pblocktemplate->block;
 
         uint256 block_hash;
-        if (!GenerateBlock(chainman, *pblock, nMaxTries, nExtraNonce, block_hash)) {
+        if (!GenerateBlock(chainman, *pblock, nMaxTries, nExtraNonce, block_hash, nThreads)) {
             break;
         }
 
@@ -185,6 +192,16 @@ static UniValue generateBlocks(ChainstateManager& chainman, CEvoDB& evodb, CGove
     return blockHashes;
 }
 
+static int ParseMiningThreads(const UniValue& param)
+{
+    if (param.isNull()) return DEFAULT_KAWPOW_MINING_THREADS;
+    const int threads{param.get_int()};
+    if (threads < 1 || threads > MAX_KAWPOW_MINING_THREADS) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, strprintf("threads must be between 1 and %d", MAX_KAWPOW_MINING_THREADS));
+    }
+    return threads;
+}
+
 static bool getScriptFromDescriptor(const std::string& descriptor, CScript& script, std::string& error)
 {
     FlatSigningProvider key_provider;
@@ -228,6 +245,7 @@ static UniValue generatetodescriptor(const JSONRPCRequest& request)
             {"num_blocks", RPCArg::Type::NUM, RPCArg::Optional::NO, "How many blocks are generated immediately."},
             {"descriptor", RPCArg::Type::STR, RPCArg::Optional::NO, "The descriptor to send the newly generated coins to."},
             {"maxtries", RPCArg::Type::NUM, /* default */ ToString(DEFAULT_MAX_TRIES), "How many iterations to try."},
+            {"threads", RPCArg::Type::NUM, /* default */ ToString(DEFAULT_KAWPOW_MINING_THREADS), "How many threads search for a KAWPOW nonce in parallel."},
         },
         RPCResult{
             RPCResult::Type::ARR, "", "",
@@ -242,6 +260,7 @@ static UniValue generatetodescriptor(const JSONRPCRequest& request)
 
     const int num_blocks{request.params[0].get_int()};
     const uint64_t max_tries{request.params[2].isNull() ? DEFAULT_MAX_TRIES : request.params[2].get_int()};
+    const int threads{ParseMiningThreads(request.params[3])};
 
     CScript coinbase_script;
     std::string error;
@@ -254,7 +273,7 @@ static UniValue generatetodescriptor(const JSONRPCRequest& request)
     ChainstateManager& chainman = EnsureChainman(node);
     LLMQContext& llmq_ctx = EnsureLLMQContext(node);
 
-    return generateBlocks(chainman, *node.evodb, *node.govman, *node.sporkman, llmq_ctx, mempool, coinbase_script, num_blocks, max_tries);
+    return generateBlocks(chainman, *node.evodb, *node.govman, *node.sporkman, llmq_ctx, mempool, coinbase_script, num_blocks, max_tries, threads);
 }
 
 static UniValue generatetoaddress(const JSONRPCRequest& request)
@@ -265,6 +284,7 @@ static UniValue generatetoaddress(const JSONRPCRequest& request)
             {"nblocks", RPCArg::Type::NUM, RPCArg::Optional::NO, "How many blocks are generated immediately."},
             {"address", RPCArg::Type::STR, RPCArg::Optional::NO, "The address to send the newly generated coins to."},
             {"maxtries", RPCArg::Type::NUM, /* default */ ToString(DEFAULT_MAX_TRIES), "How many iterations to try."},
+            {"threads", RPCArg::Type::NUM, /* default */ ToString(DEFAULT_KAWPOW_MINING_THREADS), "How many threads search for a KAWPOW nonce in parallel."},
         },
         RPCResult{
             RPCResult::Type::ARR, "", "hashes of blocks generated",
@@ -280,6 +300,7 @@ static UniValue generatetoaddress(const JSONRPCRequest& request)
 
     const int num_blocks{request.params[0].get_int()};
     const uint64_t max_tries{request.params[2].isNull() ? DEFAULT_MAX_TRIES : request.params[2].get_int()};
+    const int threads{ParseMiningThreads(request.params[3])};
 
     CTxDestination destination = DecodeDestination(request.params[1].get_str());
     if (!IsValidDestination(destination)) {
@@ -293,7 +314,7 @@ static UniValue generatetoaddress(const JSONRPCRequest& request)
 
     CScript coinbase_script = GetScriptForDestination(destination);
 
-    return generateBlocks(chainman, *node.evodb, *node.govman, *node.sporkman, llmq_ctx, mempool, coinbase_script, num_blocks, max_tries);
+    return generateBlocks(chainman, *node.evodb, *node.govman, *node.sporkman, llmq_ctx, mempool, coinbase_script, num_blocks, max_tries, threads);
 }
 
 static UniValue generateblock(const JSONRPCRequest& request)
@@ -308,7 +329,8 @@ static UniValue generateblock(const JSONRPCRequest& request)
                 {
                     {"rawtx/txid", RPCArg::Type::STR_HEX, RPCArg::Optional::OMITTED, ""},
                 },
-            }
+            },
+            {"threads", RPCArg::Type::NUM, /* default */ ToString(DEFAULT_KAWPOW_MINING_THREADS), "How many threads search for a KAWPOW nonce in parallel."},
         },
         RPCResult{
             RPCResult::Type::OBJ, "", "",
@@ -323,6 +345,7 @@ static UniValue generateblock(const JSONRPCRequest& request)
     }.Check(request);
 
     const auto address_or_descriptor = request.params[0].get_str();
+    const int threads{ParseMiningThreads(request.params[2])};
     CScript coinbase_script;
     std::string error;
 
@@ -399,7 +422,7 @@ static UniValue generateblock(const JSONRPCRequest& request)
     uint64_t max_tries{DEFAULT_MAX_TRIES};
     unsigned int extra_nonce{0};
 
-    if (!GenerateBlock(chainman, block, max_tries, extra_nonce, block_hash) || block_hash.IsNull()) {
+    if (!GenerateBlock(chainman, block, max_tries, extra_nonce, block_hash, threads) || block_hash.IsNull()) {
         throw JSONRPCError(RPC_MISC_ERROR, "Failed to make block.");
     }
 
@@ -764,6 +787,13 @@ static UniValue getblocktemplate(const JSONRPCRequest& request)
                 }
             }
         }
+        // A new tip wakes all longpoll callers at once, let them share the template built for it in the background
+        if (node.block_template_cache) {
+            const uint256 best_block = WITH_LOCK(g_best_block_mutex, return g_best_block);
+            if (best_block != hashWatchedChain) {
+                node.block_template_cache->WaitForTip(best_block, std::chrono::seconds{2});
+            }
+        }
         ENTER_CRITICAL_SECTION(cs_main);
 
         if (!IsRPCRunning())
@@ -772,29 +802,45 @@ static UniValue getblocktemplate(const JSONRPCRequest& request)
     }
 
     // Update block
-    static CBlockIndex* pindexPrev;
+    static const CBlockIndex* pindexPrev;
     static int64_t nStart;
     static std::unique_ptr<CBlockTemplate> pblocktemplate;
     if (pindexPrev != active_chain.Tip() ||
-        (mempool.GetTransactionsUpdated() != nTransactionsUpdatedLast && GetTime() - nStart > 5))
+        (mempool.GetTransactionsUpdated() != nTransactionsUpdatedLast && GetTime() - nStart > BLOCK_TEMPLATE_MAX_AGE))
     {
         // Clear pindexPrev so future calls make a new block, despite any failures from here on
         pindexPrev = nullptr;
 
-        // Store the ::ChainActive().Tip() used before CreateNewBlock, to avoid races
-        nTransactionsUpdatedLast = mempool.GetTransactionsUpdated();
-        CBlockIndex* pindexPrevNew = active_chain.Tip();
-        nStart = GetTime();
-
-        // Create new block
-        CScript scriptDummy = CScript() << OP_TRUE;
-        LLMQContext& llmq_ctx = EnsureAnyLLMQContext(request.context);
-        pblocktemplate = BlockAssembler(*node.sporkman, *node.govman, llmq_ctx, *node.evodb, active_chainstate, mempool, Params()).CreateNewBlock(scriptDummy);
-        if (!pblocktemplate)
-            throw JSONRPCError(RPC_OUT_OF_MEMORY, "Out of memory");
+        std::optional<BlockTemplateCache::Entry> cached;
+        if (node.block_template_cache) {
+            cached = node.block_template_cache->Get(active_chain.Tip(), mempool.GetTransactionsUpdated());
+        }
+        if (cached) {
+            nTransactionsUpdatedLast = cached->tx_updated;
+            nStart = cached->time;
+            // The cached template is shared, the copy gets its time updated below
+            pblocktemplate = std::make_unique<CBlockTemplate>(*cached->block_template);
+            pindexPrev = cached->pindex_prev;
+        } else {
+            // Store the ::ChainActive().Tip() used before CreateNewBlock, to avoid races
+            nTransactionsUpdatedLast = mempool.GetTransactionsUpdated();
+            CBlockIndex* pindexPrevNew = active_chain.Tip();
+            nStart = GetTime();
+
+            // Create new block
+            CScript scriptDummy = CScript() << OP_TRUE;
+            LLMQContext& llmq_ctx = EnsureAnyLLMQContext(request.context);
+            pblocktemplate = BlockAssembler(*node.sporkman, *node.govman, llmq_ctx, *node.evodb, active_chainstate, mempool, Params()).CreateNewBlock(scriptDummy);
+            if (!pblocktemplate)
+                throw JSONRPCError(RPC_OUT_OF_MEMORY, "Out of memory");
+
+            if (node.block_template_cache) {
+                node.block_template_cache->Put({std::make_shared<const CBlockTemplate>(*pblocktemplate), pindexPrevNew, nTransactionsUpdatedLast, nStart});
+            }
 
-        // Need to update only after we know CreateNewBlock succeeded
-        pindexPrev = pindexPrevNew;
+            // Need to update only after we know CreateNewBlock succeeded
+            pindexPrev = pindexPrevNew;
+        }
     }
     CHECK_NONFATAL(pindexPrev);
     CBlock* pblock = &pblocktemplate->block; // pointer for convenience
@@ -1268,13 +1314,13 @@ static const CRPCCommand commands[] =
     { "mining",             "submitheader",           &submitheader,           {"hexdata"} },
 
 #if ENABLE_MINER
-    { "generating",         "generatetoaddress",      &generatetoaddress,      {"nblocks","address","maxtries"} },
-    { "generating",         "generatetodescriptor",   &generatetodescriptor,   {"num_blocks","descriptor","maxtries"} },
-    { "generating",         "generateblock",          &generateblock,          {"address","transactions"} },
+    { "generating",         "generatetoaddress",      &generatetoaddress,      {"nblocks","address","maxtries","threads"} },
+    { "generating",         "generatetodescriptor",   &generatetodescriptor,   {"num_blocks","descriptor","maxtries","threads"} },
+    { "generating",         "generateblock",          &generateblock,          {"address","transactions","threads"} },
 #else
-    { "hidden",             "generatetoaddress",      &generatetoaddress,      {"nblocks","address","maxtries"} }, // Hidden as it isn't functional, just an error to let people know if miner isn't compiled
-    { "hidden",             "generatetodescriptor",   &generatetodescriptor,   {"num_blocks","descriptor","maxtries"} },
-    { "hidden",             "generateblock",          &generateblock,          {"address","transactions"} },
+    { "hidden",             "generatetoaddress",      &generatetoaddress,      {"nblocks","address","maxtries","threads"} }, // Hidden as it isn't functional, just an error to let people know if miner isn't compiled
+    { "hidden",             "generatetodescriptor",   &generatetodescriptor,   {"num_blocks","descriptor","maxtries","threads"} },
+    { "hidden",             "generateblock",          &generateblock,          {"address","transactions","threads"} },
 #endif // ENABLE_MINER
 
     { "util",               "estimatesmartfee",       &estimatesmartfee,       {"conf_target", "estimate_mode"} },
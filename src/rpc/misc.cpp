@@ -6,16 +6,21 @@
 
 #include <addressindex.h>
 #include <chainparams.h>
+#include <clientversion.h>
 #include <consensus/consensus.h>
 #include <deploymentstatus.h>
+#include <evo/deterministicmns.h>
 #include <evo/mnauth.h>
 #include <httpserver.h>
+#include <index/addressindex.h>
 #include <index/blockfilterindex.h>
 #include <index/coinstatsindex.h>
+#include <index/spentindex.h>
 #include <index/txindex.h>
 #include <init.h>
 #include <interfaces/chain.h>
 #include <key_io.h>
+#include <kawpow.h>
 #include <net.h>
 #include <node/context.h>
 #include <rpc/blockchain.h>
@@ -23,9 +28,11 @@
 #include <rpc/util.h>
 #include <scheduler.h>
 #include <script/descriptor.h>
+#include <streams.h>
 #include <txmempool.h>
 #include <util/check.h>
 #include <util/message.h> // For MessageSign(), MessageVerify()
+#include <util/perfcounters.h>
 #include <util/strencodings.h>
 #include <util/system.h>
 #include <validation.h>
@@ -663,6 +670,95 @@ static bool getAddressesFromParams(const UniValue& params, std::vector<std::pair
     return true;
 }
 
+static size_t getLimitFromParams(const UniValue& params)
+{
+    if (!params[0].isObject()) {
+        return 0;
+    }
+    const UniValue& limitValue = find_value(params[0].get_obj(), "limit");
+    if (limitValue.isNull()) {
+        return 0;
+    }
+    const int limit = limitValue.get_int();
+    if (limit <= 0) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Limit is expected to be positive");
+    }
+    return limit;
+}
+
+template <typename Key>
+static std::optional<Key> getCursorFromParams(const UniValue& params)
+{
+    if (!params[0].isObject()) {
+        return std::nullopt;
+    }
+    const UniValue& cursorValue = find_value(params[0].get_obj(), "cursor");
+    if (cursorValue.isNull()) {
+        return std::nullopt;
+    }
+    if (!IsHex(cursorValue.get_str())) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid cursor");
+    }
+    CDataStream ss(ParseHex(cursorValue.get_str()), SER_DISK, CLIENT_VERSION);
+    Key key;
+    try {
+        ss >> key;
+    } catch (const std::ios_base::failure&) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid cursor");
+    }
+    if (!ss.empty()) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid cursor");
+    }
+    return key;
+}
+
+/**
+ * Read the index entries of the addresses in the order they were given, starting after the cursor.
+ * If there is a limit, at most that many entries are read and the cursor of the next page is returned
+ * when there are more.
+ */
+template <typename Key, typename Value, typename Read>
+static std::optional<std::string> readAddressIndexPage(const std::vector<std::pair<uint160, AddressType> >& addresses,
+                                                       const std::optional<Key>& cursor, size_t limit,
+                                                       std::vector<std::pair<Key, Value> >& entries, Read read)
+{
+    auto it = addresses.begin();
+    if (cursor) {
+        it = std::find_if(addresses.begin(), addresses.end(), [&cursor](const auto& address) {
+            return address.first == cursor->m_address_bytes && address.second == cursor->m_address_type;
+        });
+        if (it == addresses.end()) {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "Cursor does not belong to any of the addresses");
+        }
+    }
+
+    for (const auto itCursor = it; it != addresses.end(); ++it) {
+        // Read one more than needed to know whether there is another page
+        const size_t max_count = limit > 0 ? limit + 1 - entries.size() : std::numeric_limits<size_t>::max();
+        if (!read(*it, it == itCursor ? cursor : std::nullopt, max_count, entries)) {
+            throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
+        }
+        if (limit > 0 && entries.size() > limit) {
+            entries.resize(limit);
+            CDataStream ss(SER_DISK, CLIENT_VERSION);
+            ss << entries.back().first;
+            return HexStr(ss);
+        }
+    }
+    return std::nullopt;
+}
+
+/** Wrap a page of results together with the cursor of the next page */
+static UniValue makeAddressIndexPage(const std::string& name, UniValue&& result, const std::optional<std::string>& nextCursor)
+{
+    UniValue page(UniValue::VOBJ);
+    page.pushKV(name, std::move(result));
+    if (nextCursor) {
+        page.pushKV("cursor", *nextCursor);
+    }
+    return page;
+}
+
 static bool heightSort(std::pair<CAddressUnspentKey, CAddressUnspentValue> a,
                 std::pair<CAddressUnspentKey, CAddressUnspentValue> b) {
     return a.second.m_block_height < b.second.m_block_height;
@@ -746,7 +842,9 @@ static UniValue getaddressmempool(const JSONRPCRequest& request)
 static UniValue getaddressutxos(const JSONRPCRequest& request)
 {
     RPCHelpMan{"getaddressutxos",
-        "\nReturns all unspent outputs for an address (requires addressindex to be enabled).\n",
+        "\nReturns all unspent outputs for an address (requires addressindex to be enabled).\n"
+        "Results can be paged by passing \"limit\" and the \"cursor\" of the previous page in the request object,\n"
+        "pages are ordered by address and output instead of by height.\n",
         {
             {"addresses", RPCArg::Type::ARR, /* default */ "", "",
                 {
@@ -754,19 +852,27 @@ static UniValue getaddressutxos(const JSONRPCRequest& request)
                 },
             },
         },
-        RPCResult{
-            RPCResult::Type::ARR, "", "",
-            {
-                {RPCResult::Type::OBJ, "", "",
+        {
+            RPCResult{"if limit is not set",
+                RPCResult::Type::ARR, "", "",
                 {
-                    {RPCResult::Type::STR, "address", "The address base58check encoded"},
-                    {RPCResult::Type::STR_HEX, "txid", "The output txid"},
-                    {RPCResult::Type::NUM, "index", "The output index"},
-                    {RPCResult::Type::STR_HEX, "script", "The script hex-encoded"},
-                    {RPCResult::Type::NUM, "satoshis", "The number of duffs of the output"},
-                    {RPCResult::Type::NUM, "height", "The block height"},
+                    {RPCResult::Type::OBJ, "", "",
+                    {
+                        {RPCResult::Type::STR, "address", "The address base58check encoded"},
+                        {RPCResult::Type::STR_HEX, "txid", "The output txid"},
+                        {RPCResult::Type::NUM, "index", "The output index"},
+                        {RPCResult::Type::STR_HEX, "script", "The script hex-encoded"},
+                        {RPCResult::Type::NUM, "satoshis", "The number of duffs of the output"},
+                        {RPCResult::Type::NUM, "height", "The block height"},
+                    }},
                 }},
-            }},
+            RPCResult{"if limit is set",
+                RPCResult::Type::OBJ, "", "",
+                {
+                    {RPCResult::Type::ARR, "utxos", "The unspent outputs like above", {{RPCResult::Type::ELISION, "", ""}}},
+                    {RPCResult::Type::STR_HEX, "cursor", /* optional */ true, "The cursor of the next page, only present if there are more results"},
+                }},
+        },
         RPCExamples{
             HelpExampleCli("getaddressutxos", "'{\"addresses\": [\"" + EXAMPLE_ADDRESS[0] + "\"]}'")
     + HelpExampleRpc("getaddressutxos", "{\"addresses\": [\"" + EXAMPLE_ADDRESS[0] + "\"]}")
@@ -779,15 +885,23 @@ static UniValue getaddressutxos(const JSONRPCRequest& request)
         throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Invalid address");
     }
 
-    std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > unspentOutputs;
+    const size_t limit = getLimitFromParams(request.params);
+    const auto cursor = getCursorFromParams<CAddressUnspentKey>(request.params);
 
-    for (const auto& address : addresses) {
-        if (!GetAddressUnspent(address.first, address.second, unspentOutputs)) {
-            throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
-        }
+    if (g_addressindex) {
+        g_addressindex->BlockUntilSyncedToCurrentChain();
     }
 
-    std::sort(unspentOutputs.begin(), unspentOutputs.end(), heightSort);
+    std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > unspentOutputs;
+
+    const auto nextCursor = readAddressIndexPage(addresses, cursor, limit, unspentOutputs,
+        [](const auto& address, const auto& after, size_t max_count, auto& entries) {
+            return g_addressindex && g_addressindex->FindAddressUnspent(address.first, address.second, entries, after, max_count);
+        });
+
+    if (limit == 0) {
+        std::sort(unspentOutputs.begin(), unspentOutputs.end(), heightSort);
+    }
 
     UniValue result(UniValue::VARR);
 
@@ -807,13 +921,17 @@ static UniValue getaddressutxos(const JSONRPCRequest& request)
         result.push_back(output);
     }
 
+    if (limit > 0) {
+        return makeAddressIndexPage("utxos", std::move(result), nextCursor);
+    }
     return result;
 }
 
 static UniValue getaddressdeltas(const JSONRPCRequest& request)
 {
     RPCHelpMan{"getaddressdeltas",
-        "\nReturns all changes for an address (requires addressindex to be enabled).\n",
+        "\nReturns all changes for an address (requires addressindex to be enabled).\n"
+        "Results can be paged by passing \"limit\" and the \"cursor\" of the previous page in the request object.\n",
         {
             {"addresses", RPCArg::Type::ARR, /* default */ "", "",
                 {
@@ -821,19 +939,27 @@ static UniValue getaddressdeltas(const JSONRPCRequest& request)
                 },
             },
         },
-        RPCResult{
-            RPCResult::Type::ARR, "", "",
-            {
-                {RPCResult::Type::OBJ, "", "",
+        {
+            RPCResult{"if limit is not set",
+                RPCResult::Type::ARR, "", "",
                 {
-                    {RPCResult::Type::NUM, "satoshis", "The difference of duffs"},
-                    {RPCResult::Type::STR_HEX, "txid", "The related txid"},
-                    {RPCResult::Type::NUM, "index", "The related input or output index"},
-                    {RPCResult::Type::NUM, "blockindex", "The related block index"},
-                    {RPCResult::Type::NUM, "height", "The block height"},
-                    {RPCResult::Type::STR, "address", "The base58check encoded address"},
+                    {RPCResult::Type::OBJ, "", "",
+                    {
+                        {RPCResult::Type::NUM, "satoshis", "The difference of duffs"},
+                        {RPCResult::Type::STR_HEX, "txid", "The related txid"},
+                        {RPCResult::Type::NUM, "index", "The related input or output index"},
+                        {RPCResult::Type::NUM, "blockindex", "The related block index"},
+                        {RPCResult::Type::NUM, "height", "The block height"},
+                        {RPCResult::Type::STR, "address", "The base58check encoded address"},
+                    }},
                 }},
-            }},
+            RPCResult{"if limit is set",
+                RPCResult::Type::OBJ, "", "",
+                {
+                    {RPCResult::Type::ARR, "deltas", "The changes like above", {{RPCResult::Type::ELISION, "", ""}}},
+                    {RPCResult::Type::STR_HEX, "cursor", /* optional */ true, "The cursor of the next page, only present if there are more results"},
+                }},
+        },
         RPCExamples{
             HelpExampleCli("getaddressdeltas", "'{\"addresses\": [\"" + EXAMPLE_ADDRESS[0] + "\"]}'")
     + HelpExampleRpc("getaddressdeltas", "{\"addresses\": [\"" + EXAMPLE_ADDRESS[0] + "\"]}")
@@ -861,20 +987,20 @@ static UniValue getaddressdeltas(const JSONRPCRequest& request)
         throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Invalid address");
     }
 
-    std::vector<std::pair<CAddressIndexKey, CAmount> > addressIndex;
+    const size_t limit = getLimitFromParams(request.params);
+    const auto cursor = getCursorFromParams<CAddressIndexKey>(request.params);
 
-    for (const auto& address : addresses) {
-        if (start > 0 && end > 0) {
-            if (!GetAddressIndex(address.first, address.second, addressIndex, start, end)) {
-                throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
-            }
-        } else {
-            if (!GetAddressIndex(address.first, address.second, addressIndex)) {
-                throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
-            }
-        }
+    if (g_addressindex) {
+        g_addressindex->BlockUntilSyncedToCurrentChain();
     }
 
+    std::vector<std::pair<CAddressIndexKey, CAmount> > addressIndex;
+
+    const auto nextCursor = readAddressIndexPage(addresses, cursor, limit, addressIndex,
+        [start, end](const auto& address, const auto& after, size_t max_count, auto& entries) {
+            return g_addressindex && g_addressindex->FindAddressIndex(address.first, address.second, entries, start, end, after, max_count);
+        });
+
     UniValue result(UniValue::VARR);
 
     for (const auto& [indexKey, indexDelta] : addressIndex) {
@@ -893,6 +1019,9 @@ static UniValue getaddressdeltas(const JSONRPCRequest& request)
         result.push_back(delta);
     }
 
+    if (limit > 0) {
+        return makeAddressIndexPage("deltas", std::move(result), nextCursor);
+    }
     return result;
 }
 
@@ -914,6 +1043,7 @@ static UniValue getaddressbalance(const JSONRPCRequest& request)
                     {RPCResult::Type::NUM, "balance_immature", "The current immature balance in duffs"},
                     {RPCResult::Type::NUM, "balance_spendable", "The current spendable balance in duffs"},
                     {RPCResult::Type::NUM, "received", "The total number of duffs received (including change)"},
+                    {RPCResult::Type::NUM, "tx_count", "The number of transactions of the address(es), counted once per address"},
                 }},
         RPCExamples{
             HelpExampleCli("getaddressbalance", "'{\"addresses\": [\"" + EXAMPLE_ADDRESS[0] + "\"]}'")
@@ -927,39 +1057,45 @@ static UniValue getaddressbalance(const JSONRPCRequest& request)
         throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Invalid address");
     }
 
-    std::vector<std::pair<CAddressIndexKey, CAmount> > addressIndex;
-
-    for (const auto& address : addresses) {
-        if (!GetAddressIndex(address.first, address.second, addressIndex)) {
-            throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
-        }
+    if (g_addressindex) {
+        g_addressindex->BlockUntilSyncedToCurrentChain();
     }
 
     ChainstateManager& chainman = EnsureAnyChainman(request.context);
     int nHeight = WITH_LOCK(cs_main, return chainman.ActiveChain().Height());
 
     CAmount balance = 0;
-    CAmount balance_spendable = 0;
     CAmount balance_immature = 0;
     CAmount received = 0;
+    uint64_t tx_count = 0;
 
-    for (const auto& [indexKey, indexDelta] : addressIndex) {
-        if (indexDelta > 0) {
-            received += indexDelta;
+    for (const auto& address : addresses) {
+        CAddressBalance summary;
+        // Only coinbase outputs of the last blocks can be immature, they are the only deltas that need to be read
+        std::vector<std::pair<CAddressIndexKey, CAmount> > addressIndex;
+        if (!g_addressindex || !g_addressindex->FindAddressBalance(address.first, address.second, summary) ||
+            !g_addressindex->FindAddressIndex(address.first, address.second, addressIndex, std::max(1, nHeight - COINBASE_MATURITY + 1), std::max(1, nHeight))) {
+            throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
         }
-        if (indexKey.m_block_tx_pos == 0 && nHeight - indexKey.m_block_height < COINBASE_MATURITY) {
-            balance_immature += indexDelta;
-        } else {
-            balance_spendable += indexDelta;
+
+        balance += summary.m_balance;
+        received += summary.m_received;
+        tx_count += summary.m_tx_count;
+        for (const auto& [indexKey, indexDelta] : addressIndex) {
+            if (indexKey.m_block_tx_pos == 0) {
+                balance_immature += indexDelta;
+            }
         }
-        balance += indexDelta;
     }
 
+    const CAmount balance_spendable = balance - balance_immature;
+
     UniValue result(UniValue::VOBJ);
     result.pushKV("balance", balance);
     result.pushKV("balance_immature", balance_immature);
     result.pushKV("balance_spendable", balance_spendable);
     result.pushKV("received", received);
+    result.pushKV("tx_count", tx_count);
 
     return result;
 
@@ -968,7 +1104,9 @@ static UniValue getaddressbalance(const JSONRPCRequest& request)
 static UniValue getaddresstxids(const JSONRPCRequest& request)
 {
     RPCHelpMan{"getaddresstxids",
-        "\nReturns the txids for an address(es) (requires addressindex to be enabled).\n",
+        "\nReturns the txids for an address(es) (requires addressindex to be enabled).\n"
+        "Results for a single address can be paged by passing \"limit\" and the \"cursor\" of the previous page\n"
+        "in the request object.\n",
         {
             {"addresses", RPCArg::Type::ARR, /* default */ "", "",
                 {
@@ -976,9 +1114,17 @@ static UniValue getaddresstxids(const JSONRPCRequest& request)
                 },
             },
         },
-        RPCResult{
-            RPCResult::Type::ARR, "", "",
-            {{RPCResult::Type::STR_HEX, "transactionid", "The transaction id"}}
+        {
+            RPCResult{"if limit is not set",
+                RPCResult::Type::ARR, "", "",
+                {{RPCResult::Type::STR_HEX, "transactionid", "The transaction id"}}
+            },
+            RPCResult{"if limit is set",
+                RPCResult::Type::OBJ, "", "",
+                {
+                    {RPCResult::Type::ARR, "txids", "", {{RPCResult::Type::STR_HEX, "transactionid", "The transaction id"}}},
+                    {RPCResult::Type::STR_HEX, "cursor", /* optional */ true, "The cursor of the next page, only present if there are more results"},
+                }},
         },
         RPCExamples{
             HelpExampleCli("getaddresstxids", "'{\"addresses\": [\"" + EXAMPLE_ADDRESS[0] + "\"]}'")
@@ -1003,24 +1149,33 @@ static UniValue getaddresstxids(const JSONRPCRequest& request)
         }
     }
 
-    std::vector<std::pair<CAddressIndexKey, CAmount> > addressIndex;
+    const size_t limit = getLimitFromParams(request.params);
+    const auto cursor = getCursorFromParams<CAddressIndexKey>(request.params);
+    if (limit > 0 && addresses.size() > 1) {
+        // Txids of several addresses are merged and sorted by height, which can't be done a page at a time
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Limit is only supported for a single address");
+    }
 
-    for (const auto& address : addresses) {
-        if (start > 0 && end > 0) {
-            if (!GetAddressIndex(address.first, address.second, addressIndex, start, end)) {
-                throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
-            }
-        } else {
-            if (!GetAddressIndex(address.first, address.second, addressIndex)) {
-                throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
-            }
-        }
+    if (g_addressindex) {
+        g_addressindex->BlockUntilSyncedToCurrentChain();
     }
 
+    std::vector<std::pair<CAddressIndexKey, CAmount> > addressIndex;
+
+    const auto nextCursor = readAddressIndexPage(addresses, cursor, limit, addressIndex,
+        [start, end](const auto& address, const auto& after, size_t max_count, auto& entries) {
+            return g_addressindex && g_addressindex->FindAddressIndex(address.first, address.second, entries, start, end, after, max_count);
+        });
+
     std::set<std::pair<int, std::string> > txids;
     UniValue result(UniValue::VARR);
 
     for (const auto& [indexKey, _]: addressIndex) {
+        // The transaction was already listed at the end of the previous page
+        if (cursor && indexKey.m_tx_hash == cursor->m_tx_hash) {
+            continue;
+        }
+
         int height = indexKey.m_block_height;
         std::string txid = indexKey.m_tx_hash.GetHex();
 
@@ -1039,6 +1194,9 @@ static UniValue getaddresstxids(const JSONRPCRequest& request)
         }
     }
 
+    if (limit > 0) {
+        return makeAddressIndexPage("txids", std::move(result), nextCursor);
+    }
     return result;
 
 }
@@ -1080,6 +1238,10 @@ static UniValue getspentinfo(const JSONRPCRequest& request)
     CSpentIndexKey key(txid, outputIndex);
     CSpentIndexValue value;
 
+    if (g_spentindex) {
+        g_spentindex->BlockUntilSyncedToCurrentChain();
+    }
+
     CTxMemPool& mempool = EnsureAnyMemPool(request.context);
     if (!GetSpentIndex(mempool, key, value)) {
         throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Unable to get spent info");
@@ -1137,6 +1299,36 @@ static UniValue RPCLockedMemoryInfo()
     return obj;
 }
 
+static UniValue RPCKAWPOWMemoryInfo()
+{
+    const CKAWPOWEpochContextCache::Stats stats = g_kawpow_epoch_contexts.GetStats();
+    UniValue obj(UniValue::VOBJ);
+    obj.pushKV("light_epochs", uint64_t(stats.light_epochs));
+    obj.pushKV("light_bytes", stats.light_bytes);
+    obj.pushKV("full_epoch", stats.full_epoch);
+    obj.pushKV("full_bytes", stats.full_bytes);
+    obj.pushKV("full_progress", stats.full_progress);
+    obj.pushKV("full_ready", stats.full_ready);
+    obj.pushKV("light_builds", stats.light_builds);
+    obj.pushKV("light_last_build_us", stats.light_last_build_us);
+    obj.pushKV("light_blocked_us", stats.light_blocked_us);
+    return obj;
+}
+
+static UniValue RPCMNListCacheInfo(CDeterministicMNManager& dmnman)
+{
+    const CDeterministicMNListCache::Stats stats = dmnman.GetCacheStats();
+    UniValue obj(UniValue::VOBJ);
+    obj.pushKV("lists", uint64_t(stats.lists));
+    obj.pushKV("diffs", uint64_t(stats.diffs));
+    obj.pushKV("usage", uint64_t(stats.usage));
+    obj.pushKV("max_usage", uint64_t(stats.max_usage));
+    obj.pushKV("hits", stats.hits);
+    obj.pushKV("misses", stats.misses);
+    obj.pushKV("evictions", stats.evictions);
+    return obj;
+}
+
 #ifdef HAVE_MALLOC_INFO
 static std::string RPCMallocInfo()
 {
@@ -1156,6 +1348,124 @@ static std::string RPCMallocInfo()
 }
 #endif
 
+static UniValue getlockstats(const JSONRPCRequest& request)
+{
+    RPCHelpMan{"getlockstats",
+        "Returns how long locks were waited for and held at each place they are taken, the longest total wait first.\n"
+        "Locks are only measured while profiling is turned on, with -lockstats or the enable argument.\n",
+        {
+            {"reset", RPCArg::Type::BOOL, /* default */ "false", "Clear the stats after returning them"},
+            {"enable", RPCArg::Type::BOOL, /* default */ "unchanged", "Turn profiling on or off"},
+        },
+        RPCResult{
+            RPCResult::Type::ARR, "", "",
+            {
+                {RPCResult::Type::OBJ, "", "",
+                {
+                    {RPCResult::Type::STR, "lock", "The lock as written in the code"},
+                    {RPCResult::Type::STR, "location", "File and line where it is taken"},
+                    {RPCResult::Type::NUM, "locks", "Number of times it was taken"},
+                    {RPCResult::Type::NUM, "contended", "Number of times it had to be waited for"},
+                    {RPCResult::Type::NUM, "wait_us", "Total time waited, in microseconds"},
+                    {RPCResult::Type::NUM, "max_wait_us", "Longest wait, in microseconds"},
+                    {RPCResult::Type::NUM, "hold_us", "Total time held until the end of the scope, in microseconds"},
+                    {RPCResult::Type::NUM, "max_hold_us", "Longest hold, in microseconds"},
+                }},
+            }},
+        RPCExamples{
+            HelpExampleCli("getlockstats", "")
+    + HelpExampleCli("getlockstats", "true false")
+    + HelpExampleRpc("getlockstats", "false, true")
+        },
+    }.Check(request);
+
+    auto stats = lockstats::GetStats();
+    if (!request.params[0].isNull() && request.params[0].get_bool()) {
+        lockstats::Reset();
+    }
+    if (!request.params[1].isNull()) {
+        lockstats::g_enabled = request.params[1].get_bool();
+    }
+
+    std::sort(stats.begin(), stats.end(), [](const auto& a, const auto& b) { return a.wait_ns > b.wait_ns; });
+    UniValue ret(UniValue::VARR);
+    for (const auto& site : stats) {
+        UniValue obj(UniValue::VOBJ);
+        obj.pushKV("lock", site.name);
+        obj.pushKV("location", strprintf("%s:%d", site.file, site.line));
+        obj.pushKV("locks", site.locks);
+        obj.pushKV("contended", site.contended);
+        obj.pushKV("wait_us", site.wait_ns / 1000);
+        obj.pushKV("max_wait_us", site.max_wait_ns / 1000);
+        obj.pushKV("hold_us", site.hold_ns / 1000);
+        obj.pushKV("max_hold_us", site.max_hold_ns / 1000);
+        ret.push_back(obj);
+    }
+    return ret;
+}
+
+static UniValue getperfcounters(const JSONRPCRequest& request)
+{
+    RPCHelpMan{"getperfcounters",
+        "Returns the performance counters of the node. The same counters are sent to statsd with -statsenabled and\n"
+        "are served in the Prometheus text format at /rest/metrics with -rest.\n",
+        {},
+        RPCResult{
+            RPCResult::Type::OBJ_DYN, "", "",
+            {
+                {RPCResult::Type::OBJ, "name", "",
+                {
+                    {RPCResult::Type::STR, "type", "\"counter\", \"gauge\" or \"histogram\""},
+                    {RPCResult::Type::STR, "help", "What is counted"},
+                    {RPCResult::Type::NUM, "value", /* optional */ true, "The value of a counter or gauge"},
+                    {RPCResult::Type::NUM, "count", /* optional */ true, "The number of durations in a histogram"},
+                    {RPCResult::Type::NUM, "sum_us", /* optional */ true, "Their sum, in microseconds"},
+                    {RPCResult::Type::OBJ_DYN, "buckets", /* optional */ true, "The number of durations below each power of two microseconds, empty buckets are left out",
+                    {
+                        {RPCResult::Type::NUM, "upper_bound_us", "The number of durations below it and above the previous bound"},
+                    }},
+                }},
+            }},
+        RPCExamples{
+            HelpExampleCli("getperfcounters", "")
+    + HelpExampleRpc("getperfcounters", "")
+        },
+    }.Check(request);
+
+    UniValue ret(UniValue::VOBJ);
+    for (const auto& metric : perf::GetSnapshot()) {
+        UniValue obj(UniValue::VOBJ);
+        switch (metric.type) {
+        case perf::MetricType::COUNTER:
+            obj.pushKV("type", "counter");
+            obj.pushKV("help", metric.help);
+            obj.pushKV("value", metric.value);
+            break;
+        case perf::MetricType::GAUGE:
+            obj.pushKV("type", "gauge");
+            obj.pushKV("help", metric.help);
+            obj.pushKV("value", metric.value);
+            break;
+        case perf::MetricType::HISTOGRAM: {
+            obj.pushKV("type", "histogram");
+            obj.pushKV("help", metric.help);
+            obj.pushKV("count", metric.histogram.count);
+            obj.pushKV("sum_us", metric.histogram.sum);
+            UniValue buckets(UniValue::VOBJ);
+            for (size_t i = 0; i < perf::Histogram::BUCKETS; ++i) {
+                if (metric.histogram.buckets[i] == 0) continue;
+                const std::string bound = i + 1 < perf::Histogram::BUCKETS ? ToString(uint64_t{1} << i) : "inf";
+                buckets.pushKV(bound, metric.histogram.buckets[i]);
+            }
+            obj.pushKV("buckets", buckets);
+            break;
+        }
+        }
+        ret.pushKV(metric.name, obj);
+    }
+    return ret;
+}
+
 static UniValue getmemoryinfo(const JSONRPCRequest& request)
 {
     /* Please, avoid using the word "pool" here in the RPC interface or help,
@@ -1181,6 +1491,28 @@ static UniValue getmemoryinfo(const JSONRPCRequest& request)
                         {RPCResult::Type::NUM, "chunks_used", "Number allocated chunks"},
                         {RPCResult::Type::NUM, "chunks_free", "Number unused chunks"},
                     }},
+                    {RPCResult::Type::OBJ, "kawpow", "Information about KAWPOW epoch data",
+                    {
+                        {RPCResult::Type::NUM, "light_epochs", "Number of epochs with a light cache in memory"},
+                        {RPCResult::Type::NUM, "light_bytes", "Number of bytes used by those light caches"},
+                        {RPCResult::Type::NUM, "full_epoch", "Epoch of the full dataset kept with -kawpowfulldag, -1 if none"},
+                        {RPCResult::Type::NUM, "full_bytes", "Number of bytes allocated for the full dataset"},
+                        {RPCResult::Type::NUM, "full_progress", "Fraction of the full dataset generated so far"},
+                        {RPCResult::Type::BOOL, "full_ready", "Whether the full dataset is complete and used for hashing"},
+                        {RPCResult::Type::NUM, "light_builds", "Number of light caches built since startup"},
+                        {RPCResult::Type::NUM, "light_last_build_us", "Microseconds the last light cache took to build"},
+                        {RPCResult::Type::NUM, "light_blocked_us", "Microseconds hashing spent building or waiting for a light cache which wasn't prefetched"},
+                    }},
+                    {RPCResult::Type::OBJ, "mnlists", /* optional */ true, "Information about the masternode list cache",
+                    {
+                        {RPCResult::Type::NUM, "lists", "Number of cached masternode lists"},
+                        {RPCResult::Type::NUM, "diffs", "Number of cached masternode list diffs"},
+                        {RPCResult::Type::NUM, "usage", "Estimated number of bytes used, masternodes shared between lists are counted once"},
+                        {RPCResult::Type::NUM, "max_usage", "Limit set with -maxmnlistcache, in bytes"},
+                        {RPCResult::Type::NUM, "hits", "Number of list lookups answered from memory"},
+                        {RPCResult::Type::NUM, "misses", "Number of list lookups which had to read from disk"},
+                        {RPCResult::Type::NUM, "evictions", "Number of lists and diffs evicted to stay below the limit"},
+                    }},
                 }
             },
             RPCResult{"mode \"mallocinfo\"",
@@ -1197,6 +1529,11 @@ static UniValue getmemoryinfo(const JSONRPCRequest& request)
     if (mode == "stats") {
         UniValue obj(UniValue::VOBJ);
         obj.pushKV("locked", RPCLockedMemoryInfo());
+        obj.pushKV("kawpow", RPCKAWPOWMemoryInfo());
+        const NodeContext& node = EnsureAnyNodeContext(request.context);
+        if (node.dmnman) {
+            obj.pushKV("mnlists", RPCMNListCacheInfo(*node.dmnman));
+        }
         return obj;
     } else if (mode == "mallocinfo") {
 #ifdef HAVE_MALLOC_INFO
@@ -1380,6 +1717,8 @@ static const CRPCCommand commands[] =
   //  --------------------- ------------------------  -----------------------  ----------
     { "control",            "debug",                  &debug,                  {} },
     { "control",            "getmemoryinfo",          &getmemoryinfo,          {"mode"} },
+    { "control",            "getlockstats",           &getlockstats,           {"reset", "enable"} },
+    { "control",            "getperfcounters",        &getperfcounters,        {} },
     { "control",            "logging",                &logging,                {"include", "exclude"}},
     { "util",               "validateaddress",        &validateaddress,        {"address"} },
     { "util",               "createmultisig",         &createmultisig,         {"nrequired","keys"} },
@@ -141,6 +141,9 @@ static UniValue getpeerinfo(const JSONRPCRequest& request)
                     {
                         {RPCResult::Type::NUM, "n", "The heights of blocks we're currently asking from this peer"},
                     }},
+                    {RPCResult::Type::NUM, "inflight_limit", "How many blocks may be in flight from this peer during initial block download"},
+                    {RPCResult::Type::NUM, "blocks_received", "The number of requested blocks this peer delivered"},
+                    {RPCResult::Type::NUM, "block_download_time", "The moving average of the time between requesting a block from this peer and receiving it, in decimal seconds"},
                     {RPCResult::Type::BOOL, "whitelisted", "Whether the peer is whitelisted"},
                     {RPCResult::Type::OBJ_DYN, "bytessent_per_msg", "",
                     {
@@ -232,6 +235,9 @@ static UniValue getpeerinfo(const JSONRPCRequest& request)
                 heights.push_back(height);
             }
             obj.pushKV("inflight", heights);
+            obj.pushKV("inflight_limit", statestats.m_blocks_in_transit_limit);
+            obj.pushKV("blocks_received", statestats.m_blocks_received);
+            obj.pushKV("block_download_time", ((double)statestats.m_block_download_time.count()) / 1e6);
         }
         obj.pushKV("whitelisted", stats.m_legacyWhitelisted);
         UniValue permissions(UniValue::VARR);
@@ -164,11 +164,11 @@ static UniValue quorum_list_extended(const JSONRPCRequest& request, const Chains
                 j.pushKV("minedBlockHash", q->minedBlockHash.ToString());
                 j.pushKV("numValidMembers", (int32_t)num_valid_members);
                 j.pushKV("healthRatio", ss.str());
-                obj.pushKV(q->qc->quorumHash.ToString(),j);
+                obj.pushKV(q->qc->quorumHash.ToString(), std::move(j));
             }
-            v.push_back(obj);
+            v.push_back(std::move(obj));
         }
-        ret.pushKV(std::string(llmq_params.name), v);
+        ret.pushKV(std::string(llmq_params.name), std::move(v));
     }
 
     return ret;
@@ -287,10 +287,7 @@ static UniValue quorum_dkgstatus(const JSONRPCRequest& request, const Chainstate
         }
     }
 
-    llmq::CDKGDebugStatus status;
-    llmq_ctx.dkg_debugman->GetLocalDebugStatus(status);
-
-    auto ret = status.ToJson(detailLevel);
+    auto ret = llmq_ctx.dkg_debugman->GetLocalDebugStatusJson(detailLevel);
 
     CBlockIndex* pindexTip = WITH_LOCK(cs_main, return chainman.ActiveChain().Tip());
     int tipHeight = pindexTip->nHeight;
@@ -811,10 +808,9 @@ static UniValue quorum_dkginfo(const JSONRPCRequest& request, const LLMQContext&
 {
     quorum_dkginfo_help(request);
 
-    llmq::CDKGDebugStatus status;
-    llmq_ctx.dkg_debugman->GetLocalDebugStatus(status);
+    const auto status = llmq_ctx.dkg_debugman->GetLocalDebugStatus();
     UniValue ret(UniValue::VOBJ);
-    ret.pushKV("active_dkgs", int(status.sessions.size()));
+    ret.pushKV("active_dkgs", int(status->sessions.size()));
 
     const int nTipHeight{WITH_LOCK(cs_main, return chainman.ActiveChain().Height())};
     auto minNextDKG = [](const Consensus::Params& consensusParams, int nTipHeight) {
@@ -832,6 +828,46 @@ static UniValue quorum_dkginfo(const JSONRPCRequest& request, const LLMQContext&
     return ret;
 }
 
+static void quorum_signingstats_help(const JSONRPCRequest& request)
+{
+    RPCHelpMan{"quorum signingstats",
+        "Return latency percentiles, in milliseconds, of the signing sessions this node saw recovered.\n"
+        "Only the latest " + ToString(llmq::CSigningStats::MAX_SAMPLES) + " samples per LLMQ type are kept.\n",
+        {},
+        RPCResult{
+            RPCResult::Type::OBJ, "", "",
+            {
+                {RPCResult::Type::NUM, "pending_sessions", "Number of sessions seen but not recovered yet"},
+                {RPCResult::Type::OBJ_DYN, "llmqs", "Latencies per LLMQ type",
+                {
+                    {RPCResult::Type::OBJ_DYN, "type", "Latencies by name (sign_to_share, share_to_relayed, sign_to_recovered, first_share_to_recovered, recovery_started_to_recovered)",
+                    {
+                        {RPCResult::Type::OBJ, "latency", "",
+                        {
+                            {RPCResult::Type::NUM, "total", "Number of sessions measured since startup"},
+                            {RPCResult::Type::NUM, "samples", "Number of sessions the percentiles are computed from"},
+                            {RPCResult::Type::NUM, "p50", "Median"},
+                            {RPCResult::Type::NUM, "p90", "90th percentile"},
+                            {RPCResult::Type::NUM, "p99", "99th percentile"},
+                            {RPCResult::Type::NUM, "max", "Largest sample"},
+                        }},
+                    }},
+                }},
+            }
+        },
+        RPCExamples{
+            HelpExampleCli("quorum", "signingstats")
+        },
+    }.Check(request);
+}
+
+static UniValue quorum_signingstats(const JSONRPCRequest& request, const LLMQContext& llmq_ctx)
+{
+    quorum_signingstats_help(request);
+
+    return llmq_ctx.sigman->GetStats().ToJson();
+}
+
 [[ noreturn ]] static void quorum_help()
 {
     throw std::runtime_error(
@@ -854,7 +890,8 @@ static UniValue quorum_dkginfo(const JSONRPCRequest& request, const LLMQContext&
             "  isconflicting     - Test if a conflict exists\n"
             "  selectquorum      - Return the quorum that would/should sign a request\n"
             "  getdata           - Request quorum data from other masternodes in the quorum\n"
-            "  rotationinfo      - Request quorum rotation information\n",
+            "  rotationinfo      - Request quorum rotation information\n"
+            "  signingstats      - Return latencies of recent signing sessions\n",
             {
                 {"command", RPCArg::Type::STR, RPCArg::Optional::NO, "The command to execute"},
             },
@@ -895,6 +932,8 @@ static UniValue _quorum(const JSONRPCRequest& request)
         return quorum_getdata(new_request, llmq_ctx, chainman);
     } else if (command == "quorumrotationinfo") {
         return quorum_rotationinfo(new_request, llmq_ctx);
+    } else if (command == "quorumsigningstats") {
+        return quorum_signingstats(new_request, llmq_ctx);
     } else {
         quorum_help();
     }
@@ -11,6 +11,7 @@
 #include <consensus/validation.h>
 #include <core_io.h>
 #include <evo/creditpool.h>
+#include <index/spentindex.h>
 #include <index/txindex.h>
 #include <init.h>
 #include <key_io.h>
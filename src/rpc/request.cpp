@@ -30,22 +30,31 @@ UniValue JSONRPCRequestObj(const std::string& strMethod, const UniValue& params,
     return request;
 }
 
-UniValue JSONRPCReplyObj(const UniValue& result, const UniValue& error, const UniValue& id)
+UniValue JSONRPCReplyObj(UniValue result, UniValue error, const UniValue& id)
 {
     UniValue reply(UniValue::VOBJ);
     if (!error.isNull())
         reply.pushKV("result", NullUniValue);
     else
-        reply.pushKV("result", result);
-    reply.pushKV("error", error);
+        reply.pushKV("result", std::move(result));
+    reply.pushKV("error", std::move(error));
     reply.pushKV("id", id);
     return reply;
 }
 
 std::string JSONRPCReply(const UniValue& result, const UniValue& error, const UniValue& id)
 {
-    UniValue reply = JSONRPCReplyObj(result, error, id);
-    return reply.write() + "\n";
+    // The same as writing JSONRPCReplyObj, without copying a possibly huge result into the reply object
+    std::string reply;
+    reply.reserve(1024);
+    reply += "{\"result\":";
+    (error.isNull() ? result : NullUniValue).write(reply);
+    reply += ",\"error\":";
+    error.write(reply);
+    reply += ",\"id\":";
+    id.write(reply);
+    reply += "}\n";
+    return reply;
 }
 
 UniValue JSONRPCError(int code, const std::string& message)
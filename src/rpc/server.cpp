@@ -15,10 +15,12 @@
 #include <util/system.h>
 
 #include <boost/signals2/signal.hpp>
+#include <ctpl_stl.h>
 
 #include <algorithm>
 #include <atomic>
 #include <cassert>
+#include <condition_variable>
 #include <memory> // for unique_ptr
 #include <mutex>
 #include <unordered_map>
@@ -30,6 +32,10 @@ static std::string rpcWarmupStatus GUARDED_BY(g_rpc_warmup_mutex) = "RPC server
 /* Timer-creating functions */
 static RPCTimerInterface* timerInterface = nullptr;
 /* Map of name to timer. */
+// Threads which help executing the entries of batch requests, set while RPC is running
+static Mutex g_rpc_batch_mutex;
+static std::unique_ptr<ctpl::thread_pool> g_rpc_batch_pool GUARDED_BY(g_rpc_batch_mutex);
+
 static Mutex g_deadline_timers_mutex;
 static std::map<std::string, std::unique_ptr<RPCTimerBase> > deadlineTimers GUARDED_BY(g_deadline_timers_mutex);
 static bool ExecuteCommand(const CRPCCommand& command, const JSONRPCRequest& request, UniValue& result, bool last_handler, const std::multimap<std::string, std::vector<UniValue>>& mapPlatformRestrictions);
@@ -321,6 +327,12 @@ bool CRPCTable::removeCommand(const std::string& name, const CRPCCommand* pcmd)
 void StartRPC()
 {
     LogPrint(BCLog::RPC, "Starting RPC\n");
+    const int batch_threads = std::clamp<int>(gArgs.GetArg("-rpcbatchthreads", DEFAULT_RPC_BATCH_THREADS), 0, MAX_RPC_BATCH_THREADS);
+    if (batch_threads > 0) {
+        LOCK(g_rpc_batch_mutex);
+        g_rpc_batch_pool = std::make_unique<ctpl::thread_pool>(batch_threads);
+        RenameThreadPool(*g_rpc_batch_pool, "rpcbatch");
+    }
     g_rpc_running = true;
     g_rpcSignals.Started();
 }
@@ -344,6 +356,11 @@ void StopRPC()
     std::call_once(g_rpc_stop_flag, []() {
         LogPrint(BCLog::RPC, "Stopping RPC\n");
         WITH_LOCK(g_deadline_timers_mutex, deadlineTimers.clear());
+        std::unique_ptr<ctpl::thread_pool> batch_pool = WITH_LOCK(g_rpc_batch_mutex, return std::move(g_rpc_batch_pool));
+        if (batch_pool) {
+            // Batches being executed don't wait for the pool, whatever it hasn't started yet is done by their own thread
+            batch_pool->stop(true);
+        }
         DeleteAuthCookie();
         g_rpcSignals.Stopped();
     });
@@ -395,7 +412,7 @@ static UniValue JSONRPCExecOne(JSONRPCRequest jreq, const UniValue& req)
         jreq.parse(req);
 
         UniValue result = tableRPC.execute(jreq);
-        rpc_result = JSONRPCReplyObj(result, NullUniValue, jreq.id);
+        rpc_result = JSONRPCReplyObj(std::move(result), NullUniValue, jreq.id);
     }
     catch (const UniValue& objError)
     {
@@ -410,11 +427,55 @@ static UniValue JSONRPCExecOne(JSONRPCRequest jreq, const UniValue& req)
     return rpc_result;
 }
 
+namespace {
+/** A batch request shared by the thread serving it and the batch threads helping with it */
+struct BatchExecution {
+    explicit BatchExecution(size_t size) : results(size) {}
+
+    std::vector<UniValue> results;
+    //! the next entry to execute, entries are taken in order by whichever thread is free
+    std::atomic<size_t> next{0};
+    Mutex mutex;
+    std::condition_variable cond;
+    size_t done GUARDED_BY(mutex){0};
+};
+} // namespace
+
+/**
+ * Execute the entries of batch until none is left. The request and entries are only accessed for an entry which
+ * was taken, which the serving thread waits for, so a batch thread which starts late only touches batch.
+ */
+static void JSONRPCExecBatchEntries(BatchExecution& batch, const JSONRPCRequest& jreq, const UniValue& vReq)
+{
+    for (size_t reqIdx = batch.next++; reqIdx < batch.results.size(); reqIdx = batch.next++) {
+        batch.results[reqIdx] = JSONRPCExecOne(jreq, vReq[reqIdx]);
+        LOCK(batch.mutex);
+        if (++batch.done == batch.results.size()) batch.cond.notify_all();
+    }
+}
+
 std::string JSONRPCExecBatch(const JSONRPCRequest& jreq, const UniValue& vReq)
 {
+    auto batch = std::make_shared<BatchExecution>(vReq.size());
+    if (vReq.size() > 1) {
+        LOCK(g_rpc_batch_mutex);
+        if (g_rpc_batch_pool) {
+            // A batch uses at most all batch threads, the serving thread takes part so it never waits for a busy pool
+            const size_t helpers = std::min<size_t>(g_rpc_batch_pool->size(), vReq.size() - 1);
+            for (size_t i = 0; i < helpers; ++i) {
+                g_rpc_batch_pool->push([batch, &jreq, &vReq](int) { JSONRPCExecBatchEntries(*batch, jreq, vReq); });
+            }
+        }
+    }
+    JSONRPCExecBatchEntries(*batch, jreq, vReq);
+    {
+        WAIT_LOCK(batch->mutex, lock);
+        batch->cond.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(batch->mutex) { return batch->done == batch->results.size(); });
+    }
+
     UniValue ret(UniValue::VARR);
-    for (unsigned int reqIdx = 0; reqIdx < vReq.size(); reqIdx++)
-        ret.push_back(JSONRPCExecOne(jreq, vReq[reqIdx]));
+    for (UniValue& result : batch->results)
+        ret.push_back(std::move(result));
 
     return ret.write() + "\n";
 }
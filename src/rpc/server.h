@@ -17,6 +17,11 @@
 
 #include <univalue.h>
 
+/** Default for -rpcbatchthreads, 0 = the entries of a batch request run one after another */
+static const int DEFAULT_RPC_BATCH_THREADS = 0;
+/** Maximum number of threads helping with batch requests */
+static const int MAX_RPC_BATCH_THREADS = 16;
+
 class CRPCCommand;
 
 namespace RPCServer
@@ -180,6 +185,10 @@ extern CRPCTable tableRPC;
 void StartRPC();
 void InterruptRPC();
 void StopRPC();
+/**
+ * Execute the entries of a batch request. With -rpcbatchthreads they run concurrently on the
+ * calling thread and the batch threads, the results are in the order of the entries.
+ */
 std::string JSONRPCExecBatch(const JSONRPCRequest& jreq, const UniValue& vReq);
 
 #endif // BITCOIN_RPC_SERVER_H
@@ -5,6 +5,8 @@
 #include <scheduler.h>
 
 #include <random.h>
+#include <util/perfcounters.h>
+#include <util/thread.h>
 #include <util/time.h>
 
 #include <assert.h>
@@ -52,14 +54,23 @@ void CScheduler::serviceQueue()
             if (shouldStop() || taskQueue.empty())
                 continue;
 
-            Function f = taskQueue.begin()->second;
+            const std::chrono::system_clock::time_point due = taskQueue.begin()->first;
+            Task task = std::move(taskQueue.begin()->second);
             taskQueue.erase(taskQueue.begin());
 
             {
                 // Unlock before calling f, so it can reschedule itself or another task
                 // without deadlocking:
                 REVERSE_LOCK(lock);
-                f();
+                if (task.lateness) {
+                    task.lateness->Observe(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now() - due).count());
+                }
+                if (task.runtime) {
+                    perf::ScopedTimer timer(*task.runtime);
+                    task.f();
+                } else {
+                    task.f();
+                }
             }
         } catch (...) {
             --nThreadsServicingQueue;
@@ -71,14 +82,35 @@ void CScheduler::serviceQueue()
 }
 
 void CScheduler::schedule(CScheduler::Function f, std::chrono::system_clock::time_point t)
+{
+    scheduleTask({std::move(f)}, t);
+}
+
+void CScheduler::scheduleTask(Task task, std::chrono::system_clock::time_point t)
 {
     {
         LOCK(newTaskMutex);
-        taskQueue.insert(std::make_pair(t, f));
+        taskQueue.emplace(t, std::move(task));
     }
     newTaskScheduled.notify_one();
 }
 
+void CScheduler::StartServiceThreads(const char* thread_name, int threads)
+{
+    for (int i = 0; i < threads; ++i) {
+        m_service_threads.emplace_back(&util::TraceThread, thread_name, [this] { serviceQueue(); });
+    }
+}
+
+void CScheduler::JoinServiceThreads()
+{
+    if (m_service_thread.joinable()) m_service_thread.join();
+    for (auto& thread : m_service_threads) {
+        thread.join();
+    }
+    m_service_threads.clear();
+}
+
 void CScheduler::MockForward(std::chrono::seconds delta_seconds)
 {
     assert(delta_seconds > 0s && delta_seconds <= 1h);
@@ -87,7 +119,7 @@ void CScheduler::MockForward(std::chrono::seconds delta_seconds)
         LOCK(newTaskMutex);
 
         // use temp_queue to maintain updated schedule
-        std::multimap<std::chrono::system_clock::time_point, Function> temp_queue;
+        std::multimap<std::chrono::system_clock::time_point, Task> temp_queue;
 
         for (const auto& element : taskQueue) {
             temp_queue.emplace_hint(temp_queue.cend(), element.first - delta_seconds, element.second);
@@ -101,15 +133,20 @@ void CScheduler::MockForward(std::chrono::seconds delta_seconds)
     newTaskScheduled.notify_one();
 }
 
-static void Repeat(CScheduler& s, CScheduler::Function f, std::chrono::milliseconds delta)
+void CScheduler::Repeat(Task task, std::chrono::milliseconds delta)
 {
-    f();
-    s.scheduleFromNow([=, &s] { Repeat(s, f, delta); }, delta);
+    task.f();
+    scheduleTask({[this, task, delta] { Repeat(task, delta); }, task.runtime, task.lateness}, std::chrono::system_clock::now() + delta);
 }
 
-void CScheduler::scheduleEvery(CScheduler::Function f, std::chrono::milliseconds delta)
+void CScheduler::scheduleEvery(CScheduler::Function f, std::chrono::milliseconds delta, const std::string& name)
 {
-    scheduleFromNow([=] { Repeat(*this, f, delta); }, delta);
+    Task task{std::move(f)};
+    if (!name.empty()) {
+        task.runtime = &perf::GetHistogram("scheduler." + name + ".runtime", "How long the task runs");
+        task.lateness = &perf::GetHistogram("scheduler." + name + ".lateness", "How long after it was due the task starts");
+    }
+    scheduleTask({[this, task, delta] { Repeat(task, delta); }, task.runtime, task.lateness}, std::chrono::system_clock::now() + delta);
 }
 
 size_t CScheduler::getQueueInfo(std::chrono::system_clock::time_point& first,
@@ -15,8 +15,14 @@
 #include <functional>
 #include <list>
 #include <map>
+#include <string>
 #include <thread>
 #include <utility>
+#include <vector>
+
+namespace perf {
+class Histogram;
+} // namespace perf
 
 /**
  * Simple class for background tasks that should be run
@@ -42,6 +48,8 @@ public:
     ~CScheduler();
 
     std::thread m_service_thread;
+    //! threads started by StartServiceThreads, joined by stop() like m_service_thread
+    std::vector<std::thread> m_service_threads;
 
     typedef std::function<void()> Function;
 
@@ -59,8 +67,11 @@ public:
      *
      * The timing is not exact: Every time f is finished, it is rescheduled to run again after delta. If you need more
      * accurate scheduling, don't use this method.
+     *
+     * If name is given, how long f runs and how late it starts are recorded in the perf histograms
+     * "scheduler.<name>.runtime" and "scheduler.<name>.lateness".
      */
-    void scheduleEvery(Function f, std::chrono::milliseconds delta);
+    void scheduleEvery(Function f, std::chrono::milliseconds delta, const std::string& name = {});
 
     /**
      * Mock the scheduler to fast forward in time.
@@ -74,19 +85,25 @@ public:
      */
     void serviceQueue();
 
+    /**
+     * Start threads threads running serviceQueue. Tasks then run concurrently with each other,
+     * but a task repeated by scheduleEvery never concurrently with itself.
+     */
+    void StartServiceThreads(const char* thread_name, int threads);
+
     /** Tell any threads running serviceQueue to stop as soon as the current task is done */
     void stop()
     {
         WITH_LOCK(newTaskMutex, stopRequested = true);
         newTaskScheduled.notify_all();
-        if (m_service_thread.joinable()) m_service_thread.join();
+        JoinServiceThreads();
     }
     /** Tell any threads running serviceQueue to stop when there is no work left to be done */
     void StopWhenDrained()
     {
         WITH_LOCK(newTaskMutex, stopWhenEmpty = true);
         newTaskScheduled.notify_all();
-        if (m_service_thread.joinable()) m_service_thread.join();
+        JoinServiceThreads();
     }
 
     /**
@@ -100,13 +117,24 @@ public:
     bool AreThreadsServicingQueue() const;
 
 private:
+    struct Task {
+        Function f;
+        //! where the run and start times of a named task go, nullptr for other tasks
+        perf::Histogram* runtime{nullptr};
+        perf::Histogram* lateness{nullptr};
+    };
+
     mutable Mutex newTaskMutex;
     std::condition_variable newTaskScheduled;
-    std::multimap<std::chrono::system_clock::time_point, Function> taskQueue GUARDED_BY(newTaskMutex);
+    std::multimap<std::chrono::system_clock::time_point, Task> taskQueue GUARDED_BY(newTaskMutex);
     int nThreadsServicingQueue GUARDED_BY(newTaskMutex){0};
     bool stopRequested GUARDED_BY(newTaskMutex){false};
     bool stopWhenEmpty GUARDED_BY(newTaskMutex){false};
     bool shouldStop() const EXCLUSIVE_LOCKS_REQUIRED(newTaskMutex) { return stopRequested || (stopWhenEmpty && taskQueue.empty()); }
+
+    void scheduleTask(Task task, std::chrono::system_clock::time_point t);
+    void Repeat(Task task, std::chrono::milliseconds delta);
+    void JoinServiceThreads();
 };
 
 /**
@@ -1458,18 +1458,17 @@ public:
             ::Serialize(s, txTo.vout[nOutput]);
     }
 
-    /** Serialize txTo */
+    /** Serialize nVersion and the number of inputs */
     template<typename S>
-    void Serialize(S &s) const {
-        // Serialize nVersion
+    void SerializeHeader(S &s) const {
         int32_t n32bitVersion = txTo.nVersion | (txTo.nType << 16);
         ::Serialize(s, n32bitVersion);
-        // Serialize vin
-        unsigned int nInputs = fAnyoneCanPay ? 1 : txTo.vin.size();
-        ::WriteCompactSize(s, nInputs);
-        for (unsigned int nInput = 0; nInput < nInputs; nInput++)
-             SerializeInput(s, nInput);
-        // Serialize vout
+        ::WriteCompactSize(s, fAnyoneCanPay ? 1 : txTo.vin.size());
+    }
+
+    /** Serialize vout, nLockTime and the payload */
+    template<typename S>
+    void SerializeTail(S &s) const {
         unsigned int nOutputs = fHashNone ? 0 : (fHashSingle ? nIn+1 : txTo.vout.size());
         ::WriteCompactSize(s, nOutputs);
         for (unsigned int nOutput = 0; nOutput < nOutputs; nOutput++)
@@ -1479,6 +1478,55 @@ public:
         if (txTo.nVersion == 3 && txTo.nType != TRANSACTION_NORMAL)
             ::Serialize(s, txTo.vExtraPayload);
     }
+
+    /** Serialize txTo */
+    template<typename S>
+    void Serialize(S &s) const {
+        SerializeHeader(s);
+        unsigned int nInputs = fAnyoneCanPay ? 1 : txTo.vin.size();
+        for (unsigned int nInput = 0; nInput < nInputs; nInput++)
+             SerializeInput(s, nInput);
+        SerializeTail(s);
+    }
+};
+
+/** Size of an input serialized for signing another input with SIGHASH_ALL: prevout, empty script, nSequence */
+constexpr size_t LEGACY_BLANK_INPUT_SIZE{32 + 4 + 1 + 4};
+
+/** A stream for serializing into a SHA256 state, which may continue from a midstate */
+class SHA256Writer
+{
+private:
+    CSHA256& m_sha;
+
+public:
+    explicit SHA256Writer(CSHA256& sha) : m_sha(sha) {}
+
+    int GetType() const { return SER_GETHASH; }
+    int GetVersion() const { return 0; }
+
+    void write(Span<const std::byte> src)
+    {
+        m_sha.Write(UCharCast(src.data()), src.size());
+    }
+};
+
+/** A stream for serializing to the end of a byte vector */
+class AppendWriter
+{
+private:
+    std::vector<unsigned char>& m_data;
+
+public:
+    explicit AppendWriter(std::vector<unsigned char>& data) : m_data(data) {}
+
+    int GetType() const { return SER_GETHASH; }
+    int GetVersion() const { return 0; }
+
+    void write(Span<const std::byte> src)
+    {
+        m_data.insert(m_data.end(), UCharCast(src.data()), UCharCast(src.data() + src.size()));
+    }
 };
 
 /** Compute the (single) SHA256 of the concatenation of all prevouts of a tx. */
@@ -1523,6 +1571,26 @@ void PrecomputedTransactionData::Init(const T& txTo, std::vector<CTxOut>&& spent
 
     m_spent_outputs = std::move(spent_outputs);
 
+    if (txTo.vin.size() >= LEGACY_SIGHASH_CACHE_MIN_INPUTS) {
+        // With nIn past the last input, every input is serialized blanked
+        const CTransactionSignatureSerializer<T> txTmp(txTo, CScript(), txTo.vin.size(), SIGHASH_ALL);
+        AppendWriter suffix(m_legacy_suffix);
+        for (unsigned int nInput = 0; nInput < txTo.vin.size(); nInput++) {
+            txTmp.SerializeInput(suffix, nInput);
+        }
+        assert(m_legacy_suffix.size() == txTo.vin.size() * LEGACY_BLANK_INPUT_SIZE);
+        txTmp.SerializeTail(suffix);
+
+        m_legacy_midstates.reserve(txTo.vin.size());
+        CSHA256 sha;
+        SHA256Writer prefix(sha);
+        txTmp.SerializeHeader(prefix);
+        for (unsigned int nInput = 0; nInput < txTo.vin.size(); nInput++) {
+            m_legacy_midstates.push_back(sha);
+            sha.Write(m_legacy_suffix.data() + nInput * LEGACY_BLANK_INPUT_SIZE, LEGACY_BLANK_INPUT_SIZE);
+        }
+    }
+
     m_ready = true;
 }
 
@@ -1554,6 +1622,22 @@ uint256 SignatureHash(const CScript& scriptCode, const T& txTo, unsigned int nIn
     // Wrapper to serialize only the necessary parts of the transaction being signed
     CTransactionSignatureSerializer<T> txTmp(txTo, scriptCode, nIn, nHashType);
 
+    const int nBaseType = nHashType & 0x1f;
+    if (cache && cache->m_legacy_midstates.size() == txTo.vin.size() &&
+        !(nHashType & SIGHASH_ANYONECANPAY) && nBaseType != SIGHASH_SINGLE && nBaseType != SIGHASH_NONE) {
+        // Same serialization as below, continued from the state after the inputs before this one were hashed
+        CSHA256 sha = cache->m_legacy_midstates[nIn];
+        SHA256Writer s(sha);
+        txTmp.SerializeInput(s, nIn);
+        const size_t offset = (nIn + 1) * LEGACY_BLANK_INPUT_SIZE;
+        sha.Write(cache->m_legacy_suffix.data() + offset, cache->m_legacy_suffix.size() - offset);
+        ::Serialize(s, nHashType);
+        uint256 result;
+        sha.Finalize(result.begin());
+        CSHA256().Write(result.begin(), CSHA256::OUTPUT_SIZE).Finalize(result.begin());
+        return result;
+    }
+
     // Serialize and hash
     CHashWriter ss(SER_GETHASH, 0);
     ss << txTmp << nHashType;
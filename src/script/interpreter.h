@@ -6,6 +6,7 @@
 #ifndef BITCOIN_SCRIPT_INTERPRETER_H
 #define BITCOIN_SCRIPT_INTERPRETER_H
 
+#include <crypto-X16R/sha256.h>
 #include <script/script_error.h>
 #include <primitives/transaction.h>
 
@@ -109,12 +110,23 @@ enum : uint32_t {
 
 bool CheckSignatureEncoding(const std::vector<unsigned char> &vchSig, unsigned int flags, ScriptError* serror);
 
+/** Transactions with at least this many inputs get their legacy SIGHASH_ALL serialization precomputed */
+static constexpr size_t LEGACY_SIGHASH_CACHE_MIN_INPUTS{4};
+
 struct PrecomputedTransactionData
 {
     uint256 hashPrevouts, hashSequence, hashOutputs;
     bool m_ready = false;
     std::vector<CTxOut> m_spent_outputs;
 
+    /**
+     * Legacy SIGHASH_ALL serializes the whole transaction for every input, with the scripts of the other inputs
+     * blanked. For transactions with many inputs, the SHA256 midstate before each input and the serialization
+     * of the blanked inputs and the outputs are kept, so only the signed input and what follows it are hashed.
+     */
+    std::vector<CSHA256> m_legacy_midstates;
+    std::vector<unsigned char> m_legacy_suffix;
+
     PrecomputedTransactionData() = default;
 
     template <class T>
@@ -5,13 +5,16 @@
 
 #include <script/sigcache.h>
 
+#include <crypto/common.h>
 #include <pubkey.h>
 #include <random.h>
 #include <uint256.h>
+#include <util/perfcounters.h>
 #include <util/system.h>
 
 #include <cuckoocache.h>
 
+#include <array>
 #include <mutex>
 #include <shared_mutex>
 #include <vector>
@@ -21,6 +24,9 @@ namespace {
  * Valid signature cache, to avoid doing expensive ECDSA signature checking
  * twice for every transaction (once when accepted into memory pool, and
  * again when accepted into the block chain)
+ *
+ * The cache is split into shards with a lock each, so the inserts of mempool
+ * acceptance only block the lookups of block validation which hit the same shard.
  */
 class CSignatureCache
 {
@@ -28,8 +34,22 @@ private:
      //! Entries are SHA256(nonce || signature hash || public key || signature):
     CSHA256 m_salted_hasher;
     typedef CuckooCache::cache<uint256, SignatureCacheHasher> map_type;
-    map_type setValid;
-    std::shared_mutex cs_sigcache;
+    struct Shard {
+        map_type setValid;
+        std::shared_mutex cs_sigcache;
+    };
+    std::array<Shard, SIGNATURE_CACHE_SHARDS> m_shards;
+
+    Shard& GetShard(const uint256& entry)
+    {
+        // The cuckoo hashes each take 32 bits of the entry. Picking the shard from the xor of all of them keeps
+        // every single one uniform within a shard.
+        uint32_t x{0};
+        for (size_t i = 0; i < 8; ++i) {
+            x ^= ReadLE32(entry.begin() + 4 * i);
+        }
+        return m_shards[x % SIGNATURE_CACHE_SHARDS];
+    }
 
 public:
     CSignatureCache()
@@ -52,21 +72,33 @@ public:
     bool
     Get(const uint256& entry, const bool erase)
     {
-        std::shared_lock<std::shared_mutex> lock(cs_sigcache);
-        return setValid.contains(entry, erase);
+        Shard& shard = GetShard(entry);
+        std::shared_lock<std::shared_mutex> lock(shard.cs_sigcache);
+        return shard.setValid.contains(entry, erase);
     }
 
-    void Set(const uint256& entry)
+    /** Returns whether another entry was evicted for this one */
+    bool Set(const uint256& entry)
     {
-        std::unique_lock<std::shared_mutex> lock(cs_sigcache);
-        setValid.insert(entry);
+        Shard& shard = GetShard(entry);
+        std::unique_lock<std::shared_mutex> lock(shard.cs_sigcache);
+        return shard.setValid.insert(entry);
     }
-    uint32_t setup_bytes(size_t n)
+    size_t setup_bytes(size_t n)
     {
-        return setValid.setup_bytes(n);
+        size_t elems{0};
+        for (Shard& shard : m_shards) {
+            elems += shard.setValid.setup_bytes(n / SIGNATURE_CACHE_SHARDS);
+        }
+        return elems;
     }
 };
 
+perf::Counter& g_sigcache_hits{perf::GetCounter("sigcache.hits", "Signature checks answered by the signature cache")};
+perf::Counter& g_sigcache_misses{perf::GetCounter("sigcache.misses", "Signature checks not found in the signature cache")};
+perf::Counter& g_sigcache_inserts{perf::GetCounter("sigcache.inserts", "Valid signatures added to the signature cache")};
+perf::Counter& g_sigcache_evictions{perf::GetCounter("sigcache.evictions", "Signatures evicted from the full signature cache")};
+
 /* In previous versions of this code, signatureCache was a local static variable
  * in CachingTransactionSignatureChecker::VerifySignature.  We initialize
  * signatureCache outside of VerifySignature to avoid the atomic operation per
@@ -92,11 +124,16 @@ bool CachingTransactionSignatureChecker::VerifySignature(const std::vector<unsig
 {
     uint256 entry;
     signatureCache.ComputeEntry(entry, sighash, vchSig, pubkey);
-    if (signatureCache.Get(entry, !store))
+    if (signatureCache.Get(entry, !store)) {
+        g_sigcache_hits.Add();
         return true;
+    }
+    g_sigcache_misses.Add();
     if (!TransactionSignatureChecker::VerifySignature(vchSig, pubkey, sighash))
         return false;
-    if (store)
-        signatureCache.Set(entry);
+    if (store) {
+        g_sigcache_inserts.Add();
+        if (signatureCache.Set(entry)) g_sigcache_evictions.Add();
+    }
     return true;
 }
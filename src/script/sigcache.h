@@ -17,6 +17,8 @@
 static const unsigned int DEFAULT_MAX_SIG_CACHE_SIZE = 32;
 // Maximum sig cache size allowed
 static const int64_t MAX_MAX_SIG_CACHE_SIZE = 16384;
+// Number of independently locked parts of the signature cache
+static constexpr size_t SIGNATURE_CACHE_SHARDS{16};
 
 class CPubKey;
 
@@ -126,6 +126,13 @@ public:
         return 57;
     }
 
+    friend bool operator==(const CAddressUnspentKey& a, const CAddressUnspentKey& b) {
+        auto to_tuple = [](const CAddressUnspentKey& obj) {
+            return std::tie(obj.m_address_type, obj.m_address_bytes, obj.m_tx_hash, obj.m_tx_index);
+        };
+        return to_tuple(a) == to_tuple(b);
+    }
+
     template<typename Stream>
     void Serialize(Stream& s) const {
         ser_writedata8(s, ToUnderlying(m_address_type));
@@ -27,19 +27,20 @@ std::unique_ptr<CSporkManager> sporkManager;
 
 const std::string SporkStore::SERIALIZATION_VERSION_STRING = "CSporkManager-Version-2";
 
+static std::optional<size_t> GetSporkDefIndex(SporkId nSporkID)
+{
+    for (size_t i = 0; i < sporkDefs.size(); ++i) {
+        if (sporkDefs[i].sporkId == nSporkID) return i;
+    }
+    return std::nullopt;
+}
+
 std::optional<SporkValue> CSporkManager::SporkValueIfActive(SporkId nSporkID) const
 {
     AssertLockHeld(cs);
 
     if (!mapSporksActive.count(nSporkID)) return std::nullopt;
 
-    {
-        LOCK(cs_mapSporksCachedValues);
-        if (auto it = mapSporksCachedValues.find(nSporkID); it != mapSporksCachedValues.end()) {
-            return {it->second};
-        }
-    }
-
     // calc how many values we have and how many signers vote for every value
     std::unordered_map<SporkValue, int> mapValueCounts;
     for (const auto& [_, spork] : mapSporksActive.at(nSporkID)) {
@@ -47,10 +48,6 @@ std::optional<SporkValue> CSporkManager::SporkValueIfActive(SporkId nSporkID) co
         if (mapValueCounts.at(spork.nValue) >= nMinSporkKeys) {
             // nMinSporkKeys is always more than the half of the max spork keys number,
             // so there is only one such value and we can stop here
-            {
-                LOCK(cs_mapSporksCachedValues);
-                mapSporksCachedValues[nSporkID] = spork.nValue;
-            }
             return {spork.nValue};
         }
     }
@@ -58,6 +55,31 @@ std::optional<SporkValue> CSporkManager::SporkValueIfActive(SporkId nSporkID) co
     return std::nullopt;
 }
 
+void CSporkManager::PublishSporkValues()
+{
+    AssertLockHeld(cs);
+
+    for (size_t i = 0; i < sporkDefs.size(); ++i) {
+        sporkValues[i] = SporkValueIfActive(sporkDefs[i].sporkId).value_or(sporkDefs[i].defaultValue);
+    }
+    // readers which see the new version also see the new values
+    ++nSporkValuesVersion;
+}
+
+std::optional<CKeyID> CSporkManager::GetSignerKeyID(const CSporkMessage& spork, const uint256& hash) const
+{
+    CKeyID keyID;
+    if (WITH_LOCK(cs_signerCache, return signerCache.get(hash, keyID))) {
+        return keyID;
+    }
+    auto opt_keyID = spork.GetSignerKeyID();
+    if (opt_keyID) {
+        LOCK(cs_signerCache);
+        signerCache.insert(hash, *opt_keyID);
+    }
+    return opt_keyID;
+}
+
 void SporkStore::Clear()
 {
     LOCK(cs);
@@ -70,6 +92,8 @@ void SporkStore::Clear()
 CSporkManager::CSporkManager() :
     m_db{std::make_unique<db_type>("sporks.dat", "magicSporkCache")}
 {
+    LOCK(cs);
+    PublishSporkValues();
 }
 
 CSporkManager::~CSporkManager()
@@ -84,6 +108,10 @@ bool CSporkManager::LoadCache()
     is_valid = m_db->Load(*this);
     if (is_valid) {
         CheckAndRemove();
+    } else {
+        // a failed load may have left some of the sporks behind
+        LOCK(cs);
+        PublishSporkValues();
     }
     return is_valid;
 }
@@ -92,13 +120,16 @@ void CSporkManager::CheckAndRemove()
 {
     LOCK(cs);
 
-    if (setSporkPubKeyIDs.empty()) return;
+    if (setSporkPubKeyIDs.empty()) {
+        PublishSporkValues();
+        return;
+    }
 
     for (auto itActive = mapSporksActive.begin(); itActive != mapSporksActive.end();) {
         auto itSignerPair = itActive->second.begin();
         while (itSignerPair != itActive->second.end()) {
             bool fHasValidSig = setSporkPubKeyIDs.find(itSignerPair->first) != setSporkPubKeyIDs.end() &&
-                                itSignerPair->second.CheckSignature(itSignerPair->first);
+                                GetSignerKeyID(itSignerPair->second, itSignerPair->second.GetHash()) == itSignerPair->first;
             if (!fHasValidSig) {
                 mapSporksByHash.erase(itSignerPair->second.GetHash());
                 itActive->second.erase(itSignerPair++);
@@ -114,19 +145,15 @@ void CSporkManager::CheckAndRemove()
     }
 
     for (auto itByHash = mapSporksByHash.begin(); itByHash != mapSporksByHash.end();) {
-        bool found = false;
-        for (const auto& signer : setSporkPubKeyIDs) {
-            if (itByHash->second.CheckSignature(signer)) {
-                found = true;
-                break;
-            }
-        }
-        if (!found) {
+        const auto opt_keyIDSigner = GetSignerKeyID(itByHash->second, itByHash->first);
+        if (!opt_keyIDSigner || !setSporkPubKeyIDs.count(*opt_keyIDSigner)) {
             mapSporksByHash.erase(itByHash++);
             continue;
         }
         ++itByHash;
     }
+
+    PublishSporkValues();
 }
 
 PeerMsgRet CSporkManager::ProcessMessage(CNode& peer, CConnman& connman, std::string_view msg_type, CDataStream& vRecv)
@@ -159,7 +186,7 @@ PeerMsgRet CSporkManager::ProcessSpork(const CNode& peer, CConnman& connman, CDa
         return tl::unexpected{100};
     }
 
-    auto opt_keyIDSigner = spork.GetSignerKeyID();
+    auto opt_keyIDSigner = GetSignerKeyID(spork, hash);
 
     if (opt_keyIDSigner == std::nullopt || WITH_LOCK(cs, return !setSporkPubKeyIDs.count(*opt_keyIDSigner))) {
         LogPrint(BCLog::SPORK, "CSporkManager::ProcessSpork -- ERROR: invalid signature\n");
@@ -191,9 +218,7 @@ PeerMsgRet CSporkManager::ProcessSpork(const CNode& peer, CConnman& connman, CDa
         LOCK(cs); // make sure to not lock this together with cs_main
         mapSporksByHash[hash] = spork;
         mapSporksActive[spork.nSporkID][keyIDSigner] = spork;
-        // Clear cached values on new spork being processed
-        WITH_LOCK(cs_mapSporksCachedActive, mapSporksCachedActive.erase(spork.nSporkID));
-        WITH_LOCK(cs_mapSporksCachedValues, mapSporksCachedValues.erase(spork.nSporkID));
+        PublishSporkValues();
     }
     spork.Relay(connman);
     return {};
@@ -232,9 +257,7 @@ bool CSporkManager::UpdateSpork(SporkId nSporkID, SporkValue nValue, CConnman& c
 
         mapSporksByHash[spork.GetHash()] = spork;
         mapSporksActive[nSporkID][*opt_keyIDSigner] = spork;
-        // Clear cached values on new spork being processed
-        WITH_LOCK(cs_mapSporksCachedActive, mapSporksCachedActive.erase(spork.nSporkID));
-        WITH_LOCK(cs_mapSporksCachedValues, mapSporksCachedValues.erase(spork.nSporkID));
+        PublishSporkValues();
     }
 
     spork.Relay(connman);
@@ -243,41 +266,33 @@ bool CSporkManager::UpdateSpork(SporkId nSporkID, SporkValue nValue, CConnman& c
 
 bool CSporkManager::IsSporkActive(SporkId nSporkID) const
 {
-    // If nSporkID is cached, and the cached value is true, then return early true
-    {
-        LOCK(cs_mapSporksCachedActive);
-        if (auto it = mapSporksCachedActive.find(nSporkID); it != mapSporksCachedActive.end() && it->second) {
-            return true;
-        }
+    const auto index = GetSporkDefIndex(nSporkID);
+    if (!index) {
+        return GetSporkValue(nSporkID) < GetAdjustedTime();
     }
 
-    SporkValue nSporkValue = GetSporkValue(nSporkID);
+    // The version is read before the value, a spork seen active with an old value is recorded for a stale version
+    const uint64_t nVersion = nSporkValuesVersion;
+    if (sporkActiveVersions[*index] == nVersion) {
+        return true;
+    }
     // Get time is somewhat costly it looks like
-    bool ret = nSporkValue < GetAdjustedTime();
+    bool ret = sporkValues[*index] < GetAdjustedTime();
     // Only cache true values
     if (ret) {
-        LOCK(cs_mapSporksCachedActive);
-        mapSporksCachedActive[nSporkID] = ret;
+        sporkActiveVersions[*index] = nVersion;
     }
     return ret;
 }
 
 SporkValue CSporkManager::GetSporkValue(SporkId nSporkID) const
 {
-    LOCK(cs);
-
-    if (auto opt_sporkValue = SporkValueIfActive(nSporkID)) {
-        return *opt_sporkValue;
+    if (const auto index = GetSporkDefIndex(nSporkID)) {
+        return sporkValues[*index];
     }
 
-
-    if (auto optSpork = ranges::find_if_opt(sporkDefs,
-                                            [&nSporkID](const auto& sporkDef){return sporkDef.sporkId == nSporkID;})) {
-        return optSpork->defaultValue;
-    } else {
-        LogPrint(BCLog::SPORK, "CSporkManager::GetSporkValue -- Unknown Spork ID %d\n", nSporkID);
-        return -1;
-    }
+    LogPrint(BCLog::SPORK, "CSporkManager::GetSporkValue -- Unknown Spork ID %d\n", nSporkID);
+    return -1;
 }
 
 SporkId CSporkManager::GetSporkIDByName(std::string_view strName)
@@ -311,6 +326,7 @@ bool CSporkManager::SetSporkAddress(const std::string& strAddress)
         return false;
     }
     setSporkPubKeyIDs.insert(ToKeyID(*pkhash));
+    PublishSporkValues();
     return true;
 }
 
@@ -322,6 +338,7 @@ bool CSporkManager::SetMinSporkKeys(int minSporkKeys)
         return false;
     }
     nMinSporkKeys = minSporkKeys;
+    PublishSporkValues();
     return true;
 }
 
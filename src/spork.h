@@ -13,8 +13,10 @@
 #include <saltedhasher.h>
 #include <sync.h>
 #include <uint256.h>
+#include <unordered_lru_cache.h>
 
 #include <array>
+#include <atomic>
 #include <optional>
 #include <string_view>
 #include <unordered_map>
@@ -221,11 +223,20 @@ private:
     const std::unique_ptr<db_type> m_db;
     bool is_valid{false};
 
-    mutable Mutex cs_mapSporksCachedActive;
-    mutable std::unordered_map<const SporkId, bool> mapSporksCachedActive GUARDED_BY(cs_mapSporksCachedActive);
-
-    mutable Mutex cs_mapSporksCachedValues;
-    mutable std::unordered_map<SporkId, SporkValue> mapSporksCachedValues GUARDED_BY(cs_mapSporksCachedValues);
+    // Signers recovered from spork signatures by spork hash, recovering a
+    // public key from a compact signature is what makes checking sporks costly
+    mutable Mutex cs_signerCache;
+    mutable unordered_lru_cache<uint256, CKeyID, StaticSaltedHasher, 1024> signerCache GUARDED_BY(cs_signerCache);
+
+    // The value of each spork in sporkDefs, in the same order. Republished
+    // whenever the active sporks or the signer rules change, so reading a
+    // spork value doesn't take cs.
+    std::array<std::atomic<SporkValue>, sporkDefs.size()> sporkValues{};
+    // Bumped after every publication of sporkValues
+    std::atomic<uint64_t> nSporkValuesVersion{0};
+    // The version at which a time based spork was seen active. A spork stays
+    // active until its value changes, so the time is only checked once per version.
+    mutable std::array<std::atomic<uint64_t>, sporkDefs.size()> sporkActiveVersions{};
 
     std::set<CKeyID> setSporkPubKeyIDs GUARDED_BY(cs);
     int nMinSporkKeys GUARDED_BY(cs) {std::numeric_limits<int>::max()};
@@ -237,6 +248,18 @@ private:
      */
     std::optional<SporkValue> SporkValueIfActive(SporkId nSporkID) const EXCLUSIVE_LOCKS_REQUIRED(cs);
 
+    /**
+     * PublishSporkValues recalculates the value of every known spork for the
+     * lock-free readers. Called after each change of the active sporks.
+     */
+    void PublishSporkValues() EXCLUSIVE_LOCKS_REQUIRED(cs);
+
+    /**
+     * GetSignerKeyID recovers the signer of a spork message with the given
+     * hash, remembering the result for the next time the message is checked.
+     */
+    std::optional<CKeyID> GetSignerKeyID(const CSporkMessage& spork, const uint256& hash) const LOCKS_EXCLUDED(cs_signerCache);
+
 public:
     CSporkManager();
     ~CSporkManager();
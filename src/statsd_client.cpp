@@ -33,10 +33,17 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <compat.h>
 #include <netbase.h>
 #include <random.h>
+#include <threadinterrupt.h>
+#include <util/mpsc_queue.h>
+#include <util/perfcounters.h>
 #include <util/system.h>
+#include <util/thread.h>
 
+#include <atomic>
 #include <cmath>
 #include <cstdio>
+#include <thread>
+#include <vector>
 
 statsd::StatsdClient statsClient;
 
@@ -72,6 +79,12 @@ struct _StatsdClientData {
     bool    init;
 
     char    errmsg[1024];
+
+    // metrics wait here for the sender thread, which is the only one using the socket
+    MPSCQueue<std::string> queue;
+    std::atomic<size_t> queued{0};
+    std::thread thread;
+    CThreadInterrupt interrupt;
 };
 
 StatsdClient::StatsdClient(const std::string& host, int port, const std::string& ns) :
@@ -83,6 +96,7 @@ StatsdClient::StatsdClient(const std::string& host, int port, const std::string&
 
 StatsdClient::~StatsdClient()
 {
+    Stop();
     // close socket
     CloseSocket(d->sock);
 }
@@ -225,13 +239,68 @@ int StatsdClient::sendDouble(std::string key, double value, const std::string& t
 }
 
 int StatsdClient::send(const std::string& message)
+{
+    static bool fEnabled = gArgs.GetBoolArg("-statsenabled", DEFAULT_STATSD_ENABLE);
+    if (!fEnabled) return -3;
+
+    static perf::Counter& dropped = perf::GetCounter("statsd.dropped", "Metrics not sent to statsd because the send queue was full");
+    if (d->queued.fetch_add(1, std::memory_order_relaxed) >= STATSD_MAX_QUEUE_SIZE) {
+        d->queued.fetch_sub(1, std::memory_order_relaxed);
+        dropped.Add();
+        return -4;
+    }
+    d->queue.Push(message);
+    return 0;
+}
+
+void StatsdClient::Start()
+{
+    d->interrupt.reset();
+    d->thread = std::thread(&util::TraceThread, "statsd", [this] {
+        while (d->interrupt.sleep_for(STATSD_SEND_INTERVAL)) {
+            sendQueued();
+        }
+        sendQueued();
+    });
+}
+
+void StatsdClient::Stop()
+{
+    if (!d->thread.joinable()) return;
+    d->interrupt();
+    d->thread.join();
+}
+
+void StatsdClient::sendQueued()
+{
+    const std::vector<std::string> messages = d->queue.PopAll();
+    d->queued.fetch_sub(messages.size(), std::memory_order_relaxed);
+
+    // statsd takes several metrics per packet, separated by newlines
+    std::string packet;
+    for (const auto& message : messages) {
+        if (!packet.empty() && packet.size() + 1 + message.size() > STATSD_MAX_PACKET_SIZE) {
+            sendPacket(packet);
+            packet.clear();
+        }
+        if (!packet.empty()) {
+            packet += '\n';
+        }
+        packet += message;
+    }
+    if (!packet.empty()) {
+        sendPacket(packet);
+    }
+}
+
+int StatsdClient::sendPacket(const std::string& packet)
 {
     int ret = init();
     if ( ret )
     {
         return ret;
     }
-    ret = sendto(d->sock, message.data(), message.size(), 0, (struct sockaddr *) &d->server, sizeof(d->server));
+    ret = sendto(d->sock, packet.data(), packet.size(), 0, (struct sockaddr *) &d->server, sizeof(d->server));
     if ( ret == -1) {
         snprintf(d->errmsg, sizeof(d->errmsg),
                 "sendto server fail, host=%s:%d, err=%m", d->host.c_str(), d->port);
@@ -5,6 +5,7 @@
 #ifndef BITCOIN_STATSD_CLIENT_H
 #define BITCOIN_STATSD_CLIENT_H
 
+#include <chrono>
 #include <string>
 #include <memory>
 
@@ -19,6 +20,12 @@ static const int DEFAULT_STATSD_PERIOD = 60;
 static const int MIN_STATSD_PERIOD = 5;
 static const int MAX_STATSD_PERIOD = 60 * 60;
 
+// queued metrics are packed into packets up to this size, which fits the MTU of most networks
+static const size_t STATSD_MAX_PACKET_SIZE = 1432;
+// metrics beyond this many waiting to be sent are dropped
+static const size_t STATSD_MAX_QUEUE_SIZE = 100000;
+static constexpr std::chrono::milliseconds STATSD_SEND_INTERVAL{100};
+
 namespace statsd {
 
 struct _StatsdClientData;
@@ -33,6 +40,10 @@ class StatsdClient {
         void config(const std::string& host, int port, const std::string& ns = DEFAULT_STATSD_NAMESPACE);
         const char* errmsg();
 
+        // start and stop the thread which sends the queued metrics, Stop() sends what is left
+        void Start();
+        void Stop();
+
     public:
         int inc(const std::string& key, float sample_rate = 1.0);
         int dec(const std::string& key, float sample_rate = 1.0);
@@ -45,6 +56,7 @@ class StatsdClient {
         /**
          * (Low Level Api) manually send a message
          * which might be composed of several lines.
+         * It is queued for the sender thread and dropped if the queue is full.
          */
         int send(const std::string& message);
 
@@ -59,6 +71,8 @@ class StatsdClient {
     protected:
         int init();
         static void cleanup(std::string& key);
+        void sendQueued();
+        int sendPacket(const std::string& packet);
 
     protected:
         std::unique_ptr<struct _StatsdClientData> d;
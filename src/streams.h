@@ -156,7 +156,7 @@ public:
         if (pos > m_data.size()) {
             throw std::ios_base::failure("SpanReader(...): end of data (pos > m_data.size())");
         }
-        data = data.subspan(pos);
+        m_data = m_data.subspan(pos);
     }
 
     /**
@@ -198,6 +198,14 @@ public:
         memcpy(dst.data(), m_data.data(), dst.size());
         m_data = m_data.subspan(dst.size());
     }
+
+    void ignore(size_t n)
+    {
+        if (n > m_data.size()) {
+            throw std::ios_base::failure("SpanReader::ignore(): end of data");
+        }
+        m_data = m_data.subspan(n);
+    }
 };
 
 /** Double ended buffer combining vector and stream-like interfaces.
@@ -244,6 +252,7 @@ public:
     bool empty() const                               { return vch.size() == m_read_pos; }
     void resize(size_type n, value_type c = value_type{}) { vch.resize(n + m_read_pos, c); }
     void reserve(size_type n)                        { vch.reserve(n + m_read_pos); }
+    size_type capacity() const                       { return vch.capacity() - m_read_pos; }
     const_reference operator[](size_type pos) const  { return vch[pos + m_read_pos]; }
     reference operator[](size_type pos)              { return vch[pos + m_read_pos]; }
     void clear()                                     { vch.clear(); m_read_pos = 0; }
@@ -13,6 +13,8 @@
 #include <util/strencodings.h>
 #include <util/threadnames.h>
 
+#include <algorithm>
+#include <functional>
 #include <map>
 #include <mutex>
 #include <set>
@@ -33,6 +35,115 @@ void PrintLockContention(const char* pszName, const char* pszFile, int nLine)
 }
 #endif /* DEBUG_LOCKCONTENTION */
 
+namespace lockstats {
+
+std::atomic<bool> g_enabled{false};
+
+struct Site {
+    //! 0 while free, 1 while being claimed, 2 once name, file and line are set
+    std::atomic<int> state{0};
+    const char* name{nullptr};
+    const char* file{nullptr};
+    int line{0};
+
+    std::atomic<uint64_t> locks{0};
+    std::atomic<uint64_t> contended{0};
+    std::atomic<int64_t> wait_ns{0};
+    std::atomic<int64_t> max_wait_ns{0};
+    std::atomic<int64_t> hold_ns{0};
+    std::atomic<int64_t> max_hold_ns{0};
+};
+
+// An open addressing table which is never shrunk, so sites are found and claimed without a lock
+static constexpr size_t MAX_SITES{4096};
+static Site g_sites[MAX_SITES];
+
+static void UpdateMax(std::atomic<int64_t>& max, int64_t value)
+{
+    int64_t prev = max.load(std::memory_order_relaxed);
+    while (value > prev && !max.compare_exchange_weak(prev, value, std::memory_order_relaxed)) {
+    }
+}
+
+Site* GetSite(const char* name, const char* file, int line)
+{
+    const size_t hash = std::hash<const void*>{}(file) ^ (size_t(line) * 0x9e3779b9);
+    for (size_t i = 0; i < MAX_SITES; ++i) {
+        Site& site = g_sites[(hash + i) % MAX_SITES];
+        int state = site.state.load(std::memory_order_acquire);
+        if (state == 0 && site.state.compare_exchange_strong(state, 1, std::memory_order_acq_rel)) {
+            site.name = name;
+            site.file = file;
+            site.line = line;
+            site.state.store(2, std::memory_order_release);
+            return &site;
+        }
+        while (state == 1) {
+            std::this_thread::yield();
+            state = site.state.load(std::memory_order_acquire);
+        }
+        if (site.file == file && site.line == line) return &site;
+    }
+    return nullptr;
+}
+
+void RecordLocked(Site* site, bool contended, int64_t wait_ns)
+{
+    if (!site) return;
+    site->locks.fetch_add(1, std::memory_order_relaxed);
+    if (contended) {
+        site->contended.fetch_add(1, std::memory_order_relaxed);
+        site->wait_ns.fetch_add(wait_ns, std::memory_order_relaxed);
+        UpdateMax(site->max_wait_ns, wait_ns);
+    }
+}
+
+void RecordUnlocked(Site* site, int64_t hold_ns)
+{
+    site->hold_ns.fetch_add(hold_ns, std::memory_order_relaxed);
+    UpdateMax(site->max_hold_ns, hold_ns);
+}
+
+std::vector<SiteStats> GetStats()
+{
+    // A header locking in several translation units has one __FILE__ pointer per unit, those are merged here
+    std::map<std::pair<std::string, int>, SiteStats> merged;
+    for (const Site& site : g_sites) {
+        if (site.state.load(std::memory_order_acquire) != 2) continue;
+        const uint64_t locks = site.locks.load(std::memory_order_relaxed);
+        if (locks == 0) continue;
+        auto [it, inserted] = merged.try_emplace({site.file, site.line}, SiteStats{site.name, site.file, site.line, 0, 0, 0, 0, 0, 0});
+        SiteStats& stats = it->second;
+        stats.locks += locks;
+        stats.contended += site.contended.load(std::memory_order_relaxed);
+        stats.wait_ns += site.wait_ns.load(std::memory_order_relaxed);
+        stats.max_wait_ns = std::max(stats.max_wait_ns, site.max_wait_ns.load(std::memory_order_relaxed));
+        stats.hold_ns += site.hold_ns.load(std::memory_order_relaxed);
+        stats.max_hold_ns = std::max(stats.max_hold_ns, site.max_hold_ns.load(std::memory_order_relaxed));
+    }
+    std::vector<SiteStats> ret;
+    ret.reserve(merged.size());
+    for (auto& [key, stats] : merged) {
+        ret.push_back(std::move(stats));
+    }
+    return ret;
+}
+
+void Reset()
+{
+    // Locks running concurrently may still add to the fresh stats what they measured before
+    for (Site& site : g_sites) {
+        site.locks = 0;
+        site.contended = 0;
+        site.wait_ns = 0;
+        site.max_wait_ns = 0;
+        site.hold_ns = 0;
+        site.max_hold_ns = 0;
+    }
+}
+
+} // namespace lockstats
+
 #ifdef DEBUG_LOCKORDER
 //
 // Early deadlock detection.
@@ -13,10 +13,14 @@
 #include <boost/thread/mutex.hpp>
 #include <boost/thread/recursive_mutex.hpp>
 
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <cstdint>
 #include <mutex>
 #include <string>
 #include <thread>
+#include <vector>
 
 /////////////////////////////////////////////////
 //                                             //
@@ -132,14 +136,68 @@ typedef AnnotatedMixin<std::mutex> Mutex;
 void PrintLockContention(const char* pszName, const char* pszFile, int nLine);
 #endif
 
+/**
+ * Lock contention profiling, enabled at runtime with -lockstats. The time waited for and the time held of every
+ * LOCK, WAIT_LOCK and successful TRY_LOCK is added to the stats of its call site. Hold times run to the end of the
+ * scope, so they include the time spent waiting on a condition variable with the lock.
+ */
+namespace lockstats {
+struct Site;
+
+extern std::atomic<bool> g_enabled;
+
+/** The stats of a call site, nullptr if there is no room for more sites */
+Site* GetSite(const char* name, const char* file, int line);
+void RecordLocked(Site* site, bool contended, int64_t wait_ns);
+void RecordUnlocked(Site* site, int64_t hold_ns);
+
+struct SiteStats {
+    std::string name;
+    std::string file;
+    int line;
+    uint64_t locks;
+    uint64_t contended;
+    int64_t wait_ns;
+    int64_t max_wait_ns;
+    int64_t hold_ns;
+    int64_t max_hold_ns;
+};
+
+/** The stats of all call sites which locked since the last reset */
+std::vector<SiteStats> GetStats();
+void Reset();
+} // namespace lockstats
+
 /** Wrapper around std::unique_lock style lock for Mutex. */
 template <typename Mutex, typename Base = typename Mutex::UniqueLock>
 class SCOPED_LOCKABLE UniqueLock : public Base
 {
 private:
+    lockstats::Site* m_stats_site{nullptr};
+    std::chrono::steady_clock::time_point m_locked_at;
+
+    void EnterProfiled(const char* pszName, const char* pszFile, int nLine)
+    {
+        m_stats_site = lockstats::GetSite(pszName, pszFile, nLine);
+        bool contended{false};
+        int64_t wait_ns{0};
+        if (!Base::try_lock()) {
+            contended = true;
+            const auto start = std::chrono::steady_clock::now();
+            Base::lock();
+            wait_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        }
+        m_locked_at = std::chrono::steady_clock::now();
+        lockstats::RecordLocked(m_stats_site, contended, wait_ns);
+    }
+
     void Enter(const char* pszName, const char* pszFile, int nLine)
     {
         EnterCritical(pszName, pszFile, nLine, Base::mutex());
+        if (lockstats::g_enabled.load(std::memory_order_relaxed)) {
+            EnterProfiled(pszName, pszFile, nLine);
+            return;
+        }
 #ifdef DEBUG_LOCKCONTENTION
         if (!Base::try_lock()) {
             PrintLockContention(pszName, pszFile, nLine);
@@ -154,6 +212,11 @@ private:
     {
         EnterCritical(pszName, pszFile, nLine, Base::mutex(), true);
         if (Base::try_lock()) {
+            if (lockstats::g_enabled.load(std::memory_order_relaxed)) {
+                m_stats_site = lockstats::GetSite(pszName, pszFile, nLine);
+                m_locked_at = std::chrono::steady_clock::now();
+                lockstats::RecordLocked(m_stats_site, false, 0);
+            }
             return true;
         }
         LeaveCritical();
@@ -182,8 +245,12 @@ public:
 
     ~UniqueLock() UNLOCK_FUNCTION()
     {
-        if (Base::owns_lock())
+        if (Base::owns_lock()) {
+            if (m_stats_site) {
+                lockstats::RecordUnlocked(m_stats_site, std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_locked_at).count());
+            }
             LeaveCritical();
+        }
     }
 
     operator bool()
@@ -203,6 +270,8 @@ public:
     public:
         explicit reverse_lock(UniqueLock& _lock, const char* _guardname, const char* _file, int _line) : lock(_lock), file(_file), line(_line) {
             CheckLastCritical((void*)lock.mutex(), lockname, _guardname, _file, _line);
+            // the lock is released in between, so the hold time would be meaningless
+            lock.m_stats_site = nullptr;
             lock.unlock();
             LeaveCritical();
             lock.swap(templock);
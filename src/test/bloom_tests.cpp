@@ -5,6 +5,7 @@
 #include <bloom.h>
 #include <bls/bls.h>
 #include <clientversion.h>
+#include <consensus/merkle.h>
 #include <key.h>
 #include <key_io.h>
 #include <merkleblock.h>
@@ -497,6 +498,44 @@ BOOST_AUTO_TEST_CASE(merkle_block_4)
         BOOST_CHECK(vMatched[i] == merkleBlock.vMatchedTxn[i].second);
 }
 
+BOOST_AUTO_TEST_CASE(merkle_block_shared_elements)
+{
+    CBlock block = getBlock13b8a();
+    std::vector<CBloomTxElements> elements;
+    std::vector<uint256> txids;
+    for (const auto& tx : block.vtx) {
+        elements.emplace_back(*tx);
+        txids.push_back(tx->GetHash());
+    }
+    const auto merkle_tree = ComputeMerkleTree(txids);
+
+    for (const unsigned char flags : {BLOOM_UPDATE_NONE, BLOOM_UPDATE_ALL, BLOOM_UPDATE_P2PUBKEY_ONLY}) {
+        // Match an output of every other transaction, so later ones spending them match through the update too
+        CBloomFilter filter(10, 0.000001, 0, flags);
+        for (size_t i = 0; i < block.vtx.size(); i += 2) {
+            CScript::const_iterator pc = block.vtx[i]->vout[0].scriptPubKey.begin();
+            opcodetype opcode;
+            std::vector<unsigned char> data;
+            if (block.vtx[i]->vout[0].scriptPubKey.GetOp(pc, opcode, data) && !data.empty()) filter.insert(data);
+        }
+        CBloomFilter filter_shared = filter;
+
+        const CMerkleBlock merkleBlock(block, filter);
+        const CMerkleBlock merkleBlockShared(block, filter_shared, elements, merkle_tree);
+        BOOST_CHECK(!merkleBlock.vMatchedTxn.empty());
+        BOOST_CHECK(merkleBlock.vMatchedTxn == merkleBlockShared.vMatchedTxn);
+        CDataStream ss(SER_NETWORK, PROTOCOL_VERSION), ss_shared(SER_NETWORK, PROTOCOL_VERSION);
+        ss << merkleBlock;
+        ss_shared << merkleBlockShared;
+        BOOST_CHECK(ss.str() == ss_shared.str());
+
+        CDataStream stream(SER_NETWORK, PROTOCOL_VERSION), stream_shared(SER_NETWORK, PROTOCOL_VERSION);
+        stream << filter;
+        stream_shared << filter_shared;
+        BOOST_CHECK(stream.str() == stream_shared.str());
+    }
+}
+
 BOOST_AUTO_TEST_CASE(merkle_block_4_test_p2pubkey_only)
 {
     // Random real block (000000000000b731f2eef9e8c63173adfb07e41bd53eb0ef0a6b720d6cb6dea4)
@@ -4,6 +4,7 @@
 
 #include <bls/bls.h>
 #include <bls/bls_batchverifier.h>
+#include <bls/bls_worker.h>
 #include <clientversion.h>
 #include <random.h>
 #include <streams.h>
@@ -227,6 +228,52 @@ void FuncSigAggSecure(const bool legacy_scheme)
     BOOST_CHECK(sec_agg_sig.VerifySecureAggregated(vec_pks, hash));
 }
 
+void FuncSigBatchRandomized(const bool legacy_scheme)
+{
+    bls::bls_legacy_scheme.store(legacy_scheme);
+
+    CBLSSecretKey sk1, sk2, sk3;
+    sk1.MakeNewKey();
+    sk2.MakeNewKey();
+    sk3.MakeNewKey();
+    const uint256 hash1 = GetRandHash();
+    const uint256 hash2 = GetRandHash();
+    std::vector<CBLSPublicKey> vec_pks{sk1.GetPublicKey(), sk2.GetPublicKey(), sk3.GetPublicKey()};
+    std::vector<uint256> vec_hashes{hash1, hash2, hash1};
+    std::vector<CBLSSignature> vec_sigs{sk1.Sign(hash1), sk2.Sign(hash2), sk3.Sign(hash1)};
+    BOOST_CHECK(CBLSSignature::VerifyBatchRandomized(vec_sigs, vec_pks, vec_hashes));
+
+    // two invalid sigs which cancel out pass an insecure aggregated verification but not a randomized one
+    CBLSSecretKey sk_delta;
+    sk_delta.MakeNewKey();
+    const CBLSSignature delta = sk_delta.Sign(GetRandHash());
+    vec_sigs[0].AggregateInsecure(delta);
+    vec_sigs[1].SubInsecure(delta);
+    BOOST_CHECK(CBLSSignature::AggregateInsecure(vec_sigs).VerifyInsecureAggregated(vec_pks, vec_hashes));
+    BOOST_CHECK(!CBLSSignature::VerifyBatchRandomized(vec_sigs, vec_pks, vec_hashes));
+
+    // fewer keys than hashes, like recovered sigs of a few quorums, share a pairing per key
+    std::vector<CBLSPublicKey> quorum_pks;
+    std::vector<uint256> quorum_hashes;
+    std::vector<CBLSSignature> quorum_sigs;
+    for (int i = 0; i < 10; i++) {
+        const CBLSSecretKey& sk = i % 2 ? sk1 : sk2;
+        quorum_hashes.emplace_back(GetRandHash());
+        quorum_pks.emplace_back(sk.GetPublicKey());
+        quorum_sigs.emplace_back(sk.Sign(quorum_hashes.back()));
+    }
+    BOOST_CHECK(CBLSSignature::VerifyBatchRandomized(quorum_sigs, quorum_pks, quorum_hashes));
+    quorum_sigs[0].AggregateInsecure(delta);
+    quorum_sigs[3].SubInsecure(delta);
+    BOOST_CHECK(!CBLSSignature::VerifyBatchRandomized(quorum_sigs, quorum_pks, quorum_hashes));
+    quorum_sigs[0] = sk2.Sign(quorum_hashes[0]);
+    quorum_sigs[3] = sk1.Sign(quorum_hashes[3]);
+    BOOST_CHECK(CBLSSignature::VerifyBatchRandomized(quorum_sigs, quorum_pks, quorum_hashes));
+    // a signature by the wrong key of two
+    quorum_sigs[5] = sk2.Sign(quorum_hashes[5]);
+    BOOST_CHECK(!CBLSSignature::VerifyBatchRandomized(quorum_sigs, quorum_pks, quorum_hashes));
+}
+
 void FuncDHExchange(const bool legacy_scheme)
 {
     bls::bls_legacy_scheme.store(legacy_scheme);
@@ -280,9 +327,9 @@ static void AddMessage(std::vector<Message>& vec, uint32_t sourceId, uint32_t ms
     vec.emplace_back(m);
 }
 
-static void Verify(std::vector<Message>& vec, bool secureVerification, bool perMessageFallback)
+static void Verify(std::vector<Message>& vec, bool secureVerification, bool perMessageFallback, CBLSWorker* worker = nullptr)
 {
-    CBLSBatchVerifier<uint32_t, uint32_t> batchVerifier(secureVerification, perMessageFallback);
+    CBLSBatchVerifier<uint32_t, uint32_t> batchVerifier(secureVerification, perMessageFallback, 0, worker);
 
     std::set<uint32_t> expectedBadMessages;
     std::set<uint32_t> expectedBadSources;
@@ -306,12 +353,12 @@ static void Verify(std::vector<Message>& vec, bool secureVerification, bool perM
     }
 }
 
-static void Verify(std::vector<Message>& vec)
+static void Verify(std::vector<Message>& vec, CBLSWorker* worker = nullptr)
 {
-    Verify(vec, false, false);
-    Verify(vec, true, false);
-    Verify(vec, false, true);
-    Verify(vec, true, true);
+    Verify(vec, false, false, worker);
+    Verify(vec, true, false, worker);
+    Verify(vec, false, true, worker);
+    Verify(vec, true, true, worker);
 }
 
 void FuncBatchVerifier(const bool legacy_scheme)
@@ -359,6 +406,41 @@ void FuncBatchVerifier(const bool legacy_scheme)
     Verify(msgs);
 }
 
+void FuncBatchVerifierParallel(const bool legacy_scheme)
+{
+    bls::bls_legacy_scheme.store(legacy_scheme);
+
+    CBLSWorker worker;
+    worker.Start();
+
+    // enough messages to get split across the workers, bisecting down to single sources and messages
+    std::vector<Message> msgs;
+    uint32_t msgId = 0;
+    for (uint32_t sourceId = 0; sourceId < 40; sourceId++) {
+        for (int i = 0; i < 5; i++, msgId++) {
+            AddMessage(msgs, sourceId, msgId, msgId % 60, true);
+        }
+    }
+    Verify(msgs, &worker);
+
+    // invalid sigs spread over a few sources, some sharing their message hash with valid ones
+    AddMessage(msgs, 3, msgId++, 3, false);
+    AddMessage(msgs, 17, msgId++, 200, false);
+    AddMessage(msgs, 17, msgId++, 201, false);
+    AddMessage(msgs, 39, msgId++, 59, false);
+    Verify(msgs, &worker);
+
+    // a single invalid source
+    msgs.erase(msgs.begin() + 5, msgs.end());
+    AddMessage(msgs, 0, msgId++, 1, false);
+    Verify(msgs, &worker);
+
+    worker.Stop();
+
+    // a stopped worker has no threads left, verification then simply runs on the calling thread
+    Verify(msgs, &worker);
+}
+
 void FuncThresholdSignature(const bool legacy_scheme)
 {
     bls::bls_legacy_scheme.store(legacy_scheme);
@@ -451,6 +533,12 @@ BOOST_AUTO_TEST_CASE(bls_sig_agg_secure_tests)
     FuncSigAggSecure(false);
 }
 
+BOOST_AUTO_TEST_CASE(bls_sig_batch_randomized_tests)
+{
+    FuncSigBatchRandomized(true);
+    FuncSigBatchRandomized(false);
+}
+
 BOOST_AUTO_TEST_CASE(bls_dh_exchange_tests)
 {
     FuncDHExchange(true);
@@ -463,10 +551,129 @@ BOOST_AUTO_TEST_CASE(batch_verifier_tests)
     FuncBatchVerifier(false);
 }
 
+BOOST_AUTO_TEST_CASE(batch_verifier_parallel_tests)
+{
+    FuncBatchVerifierParallel(true);
+    FuncBatchVerifierParallel(false);
+}
+
 BOOST_AUTO_TEST_CASE(bls_threshold_signature_tests)
 {
     FuncThresholdSignature(true);
     FuncThresholdSignature(false);
 }
 
+BOOST_AUTO_TEST_CASE(bls_worker_sign_batch_tests)
+{
+    CBLSWorker worker;
+    worker.Start();
+
+    CBLSSecretKey sk;
+    sk.MakeNewKey();
+    std::vector<uint256> hashes;
+    for (int i = 0; i < 20; i++) {
+        hashes.emplace_back(GetRandHash());
+    }
+    const auto sigs = worker.SignBatch(sk, hashes);
+    BOOST_CHECK_EQUAL(sigs.size(), hashes.size());
+    for (size_t i = 0; i < hashes.size(); i++) {
+        BOOST_CHECK(sigs[i] == sk.Sign(hashes[i]));
+    }
+
+    worker.Stop();
+}
+
+BOOST_AUTO_TEST_CASE(bls_worker_recover_sig_tests)
+{
+    CBLSWorker worker;
+    worker.Start();
+
+    const uint256 hash = GetRandHash();
+    constexpr size_t threshold = 25;
+    std::vector<CBLSSecretKey> poly(threshold);
+    for (auto& sk : poly) {
+        sk.MakeNewKey();
+    }
+    std::vector<CBLSId> ids;
+    std::vector<CBLSSignature> sigShares;
+    for (size_t i = 0; i < threshold; i++) {
+        ids.emplace_back(GetRandHash());
+        CBLSSecretKey skShare;
+        BOOST_CHECK(skShare.SecretKeyShare(poly, ids.back()));
+        sigShares.emplace_back(skShare.Sign(hash));
+    }
+
+    CBLSSignature expected;
+    BOOST_CHECK(expected.Recover(sigShares, ids));
+    BOOST_CHECK(expected == poly[0].Sign(hash));
+    // the second time the coefficients come from the cache
+    for (int i = 0; i < 2; i++) {
+        CBLSSignature recovered;
+        BOOST_CHECK(worker.RecoverSig(sigShares, ids, recovered));
+        BOOST_CHECK(recovered == expected);
+    }
+
+    CBLSSignature recovered;
+    std::vector<CBLSId> dupIds = ids;
+    dupIds[1] = dupIds[0];
+    BOOST_CHECK(!worker.RecoverSig(sigShares, dupIds, recovered));
+    BOOST_CHECK(!recovered.IsValid());
+    sigShares[3] = CBLSSignature();
+    BOOST_CHECK(!worker.RecoverSig(sigShares, ids, recovered));
+
+    worker.Stop();
+}
+
+BOOST_AUTO_TEST_CASE(bls_secret_key_shares_tests)
+{
+    std::vector<CBLSSecretKey> poly(10);
+    for (auto& sk : poly) {
+        sk.MakeNewKey();
+    }
+    std::vector<CBLSId> ids;
+    for (int i = 0; i < 20; i++) {
+        ids.emplace_back(GetRandHash());
+    }
+    std::vector<CBLSSecretKey> shares(ids.size());
+    BOOST_CHECK(CBLSSecretKey::SecretKeyShares(poly, ids, shares));
+    for (size_t i = 0; i < ids.size(); i++) {
+        CBLSSecretKey share;
+        BOOST_CHECK(share.SecretKeyShare(poly, ids[i]));
+        BOOST_CHECK(shares[i] == share);
+    }
+
+    poly[5] = CBLSSecretKey();
+    BOOST_CHECK(!CBLSSecretKey::SecretKeyShares(poly, ids, shares));
+    BOOST_CHECK(!CBLSSecretKey::SecretKeyShares(Span{poly}.first(1), ids, shares));
+}
+
+BOOST_AUTO_TEST_CASE(bls_lazy_pubkey_cache_tests)
+{
+    CBLSSecretKey sk;
+    sk.MakeNewKey();
+    const CBLSPublicKey pk = sk.GetPublicKey();
+    CDataStream ds(SER_DISK, CLIENT_VERSION);
+    ds << ConstCBLSPublicKeyVersionWrapper(pk, true);
+    const auto stats_before = GetBLSPublicKeyCacheStats();
+    for (int i = 0; i < 3; i++) {
+        CDataStream ds2 = ds;
+        CBLSLazyPublicKey lazy;
+        ds2 >> CBLSLazyPublicKeyVersionWrapper(lazy, true);
+        BOOST_CHECK(lazy.Get() == pk);
+    }
+    // only the first copy is decompressed
+    const auto stats_after = GetBLSPublicKeyCacheStats();
+    BOOST_CHECK_EQUAL(stats_after.misses - stats_before.misses, 1U);
+    BOOST_CHECK_EQUAL(stats_after.hits - stats_before.hits, 2U);
+
+    // invalid keys are not taken from nor put into the cache
+    CDataStream ds_invalid(SER_DISK, CLIENT_VERSION);
+    ds_invalid << std::vector<uint8_t>(BLS_CURVE_PUBKEY_SIZE, 0x55);
+    ds_invalid.ignore(1);
+    CBLSLazyPublicKey lazy_invalid;
+    ds_invalid >> CBLSLazyPublicKeyVersionWrapper(lazy_invalid, true);
+    BOOST_CHECK(!lazy_invalid.Get().IsValid());
+    BOOST_CHECK_EQUAL(GetBLSPublicKeyCacheStats().size, stats_after.size);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -4,6 +4,8 @@
 #include <streams.h>
 #include <version.h>
 
+#include <list>
+
 #include <boost/test/unit_test.hpp>
 
 BOOST_AUTO_TEST_SUITE(cachemap_tests)
@@ -133,4 +135,39 @@ BOOST_AUTO_TEST_CASE(cachemap_test)
     BOOST_CHECK(Compare(cmapTest1, mapTest4));
 }
 
+BOOST_AUTO_TEST_CASE(cachemap_format_test)
+{
+    // evict and erase enough to have slots reused out of order
+    CacheMap<int,int> cmapTest(4);
+    for(int i = 0; i < 10; ++i) {
+        cmapTest.Insert(i, i * 10);
+    }
+    cmapTest.Erase(7);
+    cmapTest.Insert(10, 100);
+    cmapTest.Insert(11, 110);
+
+    std::list<CacheItem<int,int>> listExpected;
+    for(int i : {11, 10, 9, 8}) {
+        listExpected.emplace_back(i, i * 10);
+    }
+    std::list<CacheItem<int,int>>::const_iterator eit = listExpected.begin();
+    for(const auto& item : cmapTest.GetItemList()) {
+        BOOST_CHECK(item.key == eit->key && item.value == eit->value);
+        ++eit;
+    }
+    BOOST_CHECK(eit == listExpected.end());
+
+    // must stay readable by and for the std::list based format used before
+    CDataStream ss(SER_DISK, PROTOCOL_VERSION);
+    ss << cmapTest;
+    CDataStream ssExpected(SER_DISK, PROTOCOL_VERSION);
+    ssExpected << uint32_t{4} << listExpected;
+    BOOST_CHECK(ss.str() == ssExpected.str());
+
+    CacheMap<int,int> cmapTest2;
+    ssExpected >> cmapTest2;
+    BOOST_CHECK(Compare(cmapTest, cmapTest2));
+    BOOST_CHECK(!cmapTest2.HasKey(7));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
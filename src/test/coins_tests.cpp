@@ -53,9 +53,9 @@ public:
 
     uint256 GetBestBlock() const override { return hashBestBlock_; }
 
-    bool BatchWrite(CCoinsMap& mapCoins, const uint256& hashBlock) override
+    bool BatchWrite(CCoinsMap& mapCoins, const uint256& hashBlock, bool erase) override
     {
-        for (CCoinsMap::iterator it = mapCoins.begin(); it != mapCoins.end(); ) {
+        for (CCoinsMap::iterator it = mapCoins.begin(); it != mapCoins.end(); it = erase ? mapCoins.erase(it) : std::next(it)) {
             if (it->second.flags & CCoinsCacheEntry::DIRTY) {
                 // Same optimization used in CCoinsViewDB is to only write dirty entries.
                 map_[it->first] = it->second.coin;
@@ -64,7 +64,6 @@ public:
                     map_.erase(it->first);
                 }
             }
-            mapCoins.erase(it++);
         }
         if (!hashBlock.IsNull())
             hashBestBlock_ = hashBlock;
@@ -608,9 +607,10 @@ void GetCoinsMapEntry(const CCoinsMap& map, CAmount& value, char& flags)
 
 void WriteCoinsViewEntry(CCoinsView& view, CAmount value, char flags)
 {
-    CCoinsMap map;
+    CCoinsMapMemoryResource resource;
+    CCoinsMap map{0, SaltedOutpointHasher{}, CCoinsMap::key_equal{}, &resource};
     InsertCoinsMapEntry(map, value, flags);
-    BOOST_CHECK(view.BatchWrite(map, {}));
+    BOOST_CHECK(view.BatchWrite(map, {}, /* erase = */ true));
 }
 
 class SingleEntryCacheTest
@@ -877,4 +877,94 @@ BOOST_AUTO_TEST_CASE(ccoins_write)
                     CheckWriteCoins(parent_value, child_value, parent_value, parent_flags, child_flags, parent_flags);
 }
 
+BOOST_AUTO_TEST_CASE(ccoins_sync)
+{
+    CCoinsViewTest base;
+    CCoinsViewCacheTest parent(&base);
+    CCoinsViewCacheTest cache(&parent);
+
+    const COutPoint unspent(InsecureRand256(), 0);
+    const COutPoint spent(InsecureRand256(), 1);
+    const COutPoint spent_fresh(InsecureRand256(), 2);
+    for (const auto& outpoint : {unspent, spent}) {
+        parent.AddCoin(outpoint, Coin(CTxOut(VALUE1, CScript() << OP_TRUE), 1, false), false);
+    }
+    cache.AddCoin(spent_fresh, Coin(CTxOut(VALUE2, CScript() << OP_TRUE), 2, false), false);
+    cache.SpendCoin(spent);
+    BOOST_CHECK(cache.Sync());
+
+    // The parent got all changes, the child kept its unspent coins, now clean
+    BOOST_CHECK(!parent.AccessCoin(unspent).IsSpent());
+    BOOST_CHECK(parent.AccessCoin(spent).IsSpent());
+    BOOST_CHECK(!parent.AccessCoin(spent_fresh).IsSpent());
+    BOOST_CHECK_EQUAL(cache.map().size(), 1U);
+    BOOST_CHECK_EQUAL(cache.map().at(spent_fresh).flags, 0);
+    BOOST_CHECK_EQUAL(cache.AccessCoin(spent_fresh).out.nValue, VALUE2);
+    cache.SelfTest();
+
+    // Syncing the parent to its base keeps its unspent coins as well
+    BOOST_CHECK(parent.Sync());
+    BOOST_CHECK_EQUAL(parent.map().size(), 2U);
+    for (const auto& outpoint : {unspent, spent_fresh}) {
+        BOOST_CHECK_EQUAL(parent.map().at(outpoint).flags, 0);
+        BOOST_CHECK(base.HaveCoin(outpoint));
+    }
+    BOOST_CHECK(!base.HaveCoin(spent));
+    parent.SelfTest();
+
+    // Once synced, spending a coin of the cache is written on the next flush
+    cache.SpendCoin(spent_fresh);
+    BOOST_CHECK(cache.Flush());
+    BOOST_CHECK(parent.Flush());
+    BOOST_CHECK(parent.map().empty());
+    BOOST_CHECK(!base.HaveCoin(spent_fresh));
+    BOOST_CHECK(base.HaveCoin(unspent));
+}
+
+
+BOOST_AUTO_TEST_CASE(ccoins_background_flush)
+{
+    CCoinsViewTest base;
+    CCoinsViewBackgroundFlush flush_view(&base);
+    CCoinsViewCacheTest cache(&flush_view);
+
+    const COutPoint unspent(InsecureRand256(), 0);
+    const COutPoint spent(InsecureRand256(), 1);
+    cache.AddCoin(unspent, Coin(CTxOut(VALUE1, CScript() << OP_TRUE), 1, false), false);
+    cache.AddCoin(spent, Coin(CTxOut(VALUE2, CScript() << OP_TRUE), 1, false), false);
+    const uint256 block1 = InsecureRand256();
+    cache.SetBestBlock(block1);
+    BOOST_CHECK(cache.Flush());
+
+    // A background write makes the cache clean at once, the snapshot answers until the base has the coins
+    bool after_write_called{false};
+    cache.SpendCoin(spent);
+    const uint256 block2 = InsecureRand256();
+    cache.SetBestBlock(block2);
+    flush_view.WriteNextInBackground([&] { after_write_called = true; return true; });
+    BOOST_CHECK(cache.Flush());
+    BOOST_CHECK(cache.map().empty());
+    BOOST_CHECK(!flush_view.HaveCoin(spent));
+    BOOST_CHECK_EQUAL(flush_view.GetBestBlock(), block2);
+
+    BOOST_CHECK(flush_view.WaitForWrite());
+    BOOST_CHECK(after_write_called);
+    BOOST_CHECK(base.HaveCoin(unspent));
+    BOOST_CHECK(!base.HaveCoin(spent));
+    BOOST_CHECK_EQUAL(base.GetBestBlock(), block2);
+    BOOST_CHECK_EQUAL(cache.AccessCoin(unspent).out.nValue, VALUE1);
+    BOOST_CHECK(!flush_view.WriteFailed());
+    BOOST_CHECK_EQUAL(flush_view.DynamicMemoryUsage(), 0U);
+
+    // A failed write is reported by the next one and keeps its snapshot, which still counts as used memory
+    flush_view.WriteNextInBackground([] { return false; });
+    cache.AddCoin(COutPoint(InsecureRand256(), 0), Coin(CTxOut(VALUE1, CScript() << OP_TRUE), 2, false), false);
+    cache.SetBestBlock(InsecureRand256());
+    BOOST_CHECK(cache.Flush());
+    BOOST_CHECK(!flush_view.WaitForWrite());
+    BOOST_CHECK(flush_view.WriteFailed());
+    BOOST_CHECK(flush_view.DynamicMemoryUsage() > 0);
+    BOOST_CHECK(!cache.Flush());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -2,7 +2,10 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include <ctpl_stl.h>
 #include <index/coinstatsindex.h>
+#include <random.h>
+#include <streams.h>
 #include <test/util/index.h>
 #include <test/util/setup_common.h>
 #include <util/time.h>
@@ -68,4 +71,33 @@ BOOST_FIXTURE_TEST_CASE(coinstatsindex_initial_sync, TestChain100Setup)
     // Rest of shutdown sequence and destructors happen in ~TestingSetup()
 }
 
+BOOST_AUTO_TEST_CASE(parallel_muhash)
+{
+    FastRandomContext rng(true);
+    std::vector<CDataStream> inserts, removes;
+    for (int i = 0; i < 100; ++i) {
+        CDataStream ss(SER_DISK, PROTOCOL_VERSION);
+        ss << rng.rand256();
+        (rng.randbool() ? inserts : removes).emplace_back(std::move(ss));
+    }
+
+    MuHash3072 sequential;
+    for (const auto& element : inserts) sequential.Insert(MakeUCharSpan(element));
+    for (const auto& element : removes) sequential.Remove(MakeUCharSpan(element));
+    uint256 expected;
+    sequential.Finalize(expected);
+
+    // batches smaller than the input and more of them than the pool takes at a time, mixing inserts and removes
+    ctpl::thread_pool pool(2);
+    MuHash3072 acc;
+    ParallelMuHash muhash(acc, &pool, 7);
+    for (size_t i = 0; i < std::max(inserts.size(), removes.size()); ++i) {
+        if (i < removes.size()) muhash.Remove(CDataStream(removes[i]));
+        if (i < inserts.size()) muhash.Insert(CDataStream(inserts[i]));
+    }
+    uint256 out;
+    muhash.Finish().Finalize(out);
+    BOOST_CHECK(out == expected);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
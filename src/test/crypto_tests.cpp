@@ -623,6 +623,42 @@ BOOST_AUTO_TEST_CASE(chacha20_midblock)
     BOOST_CHECK_EQUAL(0, memcmp(b3, block + 12, 52));
 }
 
+BOOST_AUTO_TEST_CASE(chacha20_multiblock)
+{
+    // Runs of blocks may be computed several at a time, they must match the blocks computed one by one. The
+    // block counter crosses from its low into its high word in the middle of the run.
+    auto key = ParseHex("000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f");
+    constexpr size_t BLOCKS = 21;
+    ChaCha20Aligned multi{key.data()}, single{key.data()};
+    multi.SetIV(0x4a000000UL);
+    single.SetIV(0x4a000000UL);
+    multi.Seek64(0xfffffffcUL);
+    single.Seek64(0xfffffffcUL);
+
+    std::vector<unsigned char> keystream(BLOCKS * 64), expected(BLOCKS * 64);
+    multi.Keystream64(keystream.data(), BLOCKS);
+    for (size_t i = 0; i < BLOCKS; ++i) {
+        single.Keystream64(expected.data() + i * 64, 1);
+    }
+    BOOST_CHECK(keystream == expected);
+
+    // both continue with the same block
+    unsigned char next_multi[64], next_single[64];
+    multi.Keystream64(next_multi, 1);
+    single.Keystream64(next_single, 1);
+    BOOST_CHECK_EQUAL(0, memcmp(next_multi, next_single, 64));
+
+    // encrypting in place xors the message with the same keystream
+    std::vector<unsigned char> message(BLOCKS * 64);
+    for (size_t i = 0; i < message.size(); ++i) message[i] = i * 7;
+    std::vector<unsigned char> ciphertext{message};
+    multi.Seek64(0xfffffffcUL);
+    multi.Crypt64(ciphertext.data(), ciphertext.data(), BLOCKS);
+    for (size_t i = 0; i < message.size(); ++i) {
+        BOOST_CHECK_EQUAL(ciphertext[i], message[i] ^ expected[i]);
+    }
+}
+
 BOOST_AUTO_TEST_CASE(poly1305_testvector)
 {
     // RFC 7539, section 2.5.2.
@@ -876,6 +912,22 @@ BOOST_AUTO_TEST_CASE(sha256d64)
     }
 }
 
+BOOST_AUTO_TEST_CASE(sha256s64)
+{
+    for (int i = 0; i <= 32; ++i) {
+        unsigned char in[64 * 32];
+        unsigned char out1[32 * 32], out2[32 * 32];
+        for (int j = 0; j < 64 * i; ++j) {
+            in[j] = InsecureRandBits(8);
+        }
+        for (int j = 0; j < i; ++j) {
+            CSHA256().Write(in + 64 * j, 64).Finalize(out1 + 32 * j);
+        }
+        SHA256S64(out2, in, i);
+        BOOST_CHECK(memcmp(out1, out2, 32 * i) == 0);
+    }
+}
+
 static void TestSHA3_256(const std::string& input, const std::string& output)
 {
     const auto in_bytes = ParseHex(input);
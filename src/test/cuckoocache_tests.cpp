@@ -49,6 +49,29 @@ BOOST_AUTO_TEST_CASE(test_cuckoocache_no_fakes)
     }
 };
 
+/* Test that insert reports evictions only once the cache is full */
+BOOST_AUTO_TEST_CASE(test_cuckoocache_evictions)
+{
+    SeedInsecureRand(SeedRand::ZEROS);
+    CuckooCache::cache<uint256, SignatureCacheHasher> cc{};
+    const uint32_t elems = cc.setup_bytes(1 << 20);
+    std::vector<uint256> hashes;
+    size_t evictions{0};
+    for (uint32_t x = 0; x < elems / 2; ++x) {
+        hashes.push_back(InsecureRand256());
+        evictions += cc.insert(hashes.back());
+    }
+    BOOST_CHECK_EQUAL(evictions, 0U);
+    // Inserting an element again keeps it and evicts nothing
+    for (const uint256& hash : hashes) {
+        BOOST_CHECK(!cc.insert(hash));
+    }
+    for (uint32_t x = 0; x < elems * 2; ++x) {
+        evictions += cc.insert(InsecureRand256());
+    }
+    BOOST_CHECK_GE(evictions, elems);
+};
+
 /** This helper returns the hit rate when megabytes*load worth of entries are
  * inserted into a megabytes sized cache
  */
@@ -158,6 +158,55 @@ BOOST_AUTO_TEST_CASE(dbwrapper_batch)
     }
 }
 
+BOOST_AUTO_TEST_CASE(dbwrapper_transaction)
+{
+    using RootTransaction = CDBTransaction<CDBWrapper, CDBBatch>;
+    using CurTransaction = CDBTransaction<RootTransaction, RootTransaction>;
+
+    fs::path ph = GetDataDir() / "dbwrapper_transaction";
+    CDBWrapper dbw(ph, (1 << 20), true, false, false);
+    CDBBatch batch(dbw);
+    RootTransaction root(dbw, batch);
+    CurTransaction cur(root, root);
+
+    uint8_t key{'i'};
+    uint8_t key2{'j'};
+    const uint256 in = InsecureRand256();
+    const uint256 in2 = InsecureRand256();
+    BOOST_CHECK(dbw.Write(key2, in2));
+
+    std::vector<unsigned char> value(100, 0x01);
+    cur.Write(key, value);
+    // overwriting and erasing keeps the memory usage in line with the pending entries
+    value.assign(200, 0x02);
+    cur.Write(key, value);
+    cur.Erase(key2);
+    BOOST_CHECK_EQUAL(cur.GetMemoryUsage(), 2 * sizeof(key) + ::GetSerializeSize(value, CLIENT_VERSION));
+
+    std::vector<unsigned char> res;
+    BOOST_CHECK(cur.Read(key, res));
+    BOOST_CHECK(res == value);
+    BOOST_CHECK(!cur.Exists(key2));
+    BOOST_CHECK(root.Exists(key2));
+
+    // values and keys are moved on through the commits
+    cur.Commit();
+    BOOST_CHECK(cur.IsClean());
+    BOOST_CHECK_EQUAL(cur.GetMemoryUsage(), 0U);
+    BOOST_CHECK(root.Read(key, res));
+    BOOST_CHECK(res == value);
+    BOOST_CHECK(!root.Exists(key2));
+
+    root.Write(key2, in);
+    root.Commit();
+    BOOST_CHECK(dbw.WriteBatch(batch));
+    BOOST_CHECK(dbw.Read(key, res));
+    BOOST_CHECK(res == value);
+    uint256 res2;
+    BOOST_CHECK(dbw.Read(key2, res2));
+    BOOST_CHECK_EQUAL(res2.ToString(), in.ToString());
+}
+
 BOOST_AUTO_TEST_CASE(dbwrapper_iterator)
 {
     // Perform tests both obfuscated and non-obfuscated.
@@ -411,5 +460,38 @@ BOOST_AUTO_TEST_CASE(unicodepath)
     BOOST_CHECK(fs::exists(lockPath));
 }
 
+BOOST_AUTO_TEST_CASE(dbwrapper_profiles)
+{
+    BOOST_CHECK_EQUAL(GetDBProfileName(GetDataDir() / "chainstate"), "chainstate");
+    BOOST_CHECK_EQUAL(GetDBProfileName(GetDataDir() / "llmq" / "isdb"), "llmq/isdb");
+    BOOST_CHECK_EQUAL(GetDBProfileName(GetDataDir() / "indexes" / "blockfilter" / "basic" / "db"), "indexes/blockfilter/basic");
+    BOOST_CHECK_EQUAL(GetDBProfileName(""), "");
+
+    std::string error;
+    BOOST_CHECK(CheckDBProfileArg("llmq/isdb:bloombits=20,blocksize=16384", error));
+    BOOST_CHECK(!CheckDBProfileArg("llmq/isdb", error));
+    BOOST_CHECK(!CheckDBProfileArg("llmq/isdb:bloombits", error));
+    BOOST_CHECK(!CheckDBProfileArg("llmq/isdb:blockcache=0", error));
+    BOOST_CHECK(!CheckDBProfileArg("llmq/isdb:compression=1", error));
+
+    BOOST_CHECK_EQUAL(GetDBProfile("chainstate").bloom_bits, 10);
+    BOOST_CHECK_EQUAL(GetDBProfile("llmq/isdb").bloom_bits, 16);
+    BOOST_CHECK_EQUAL(GetDBProfile("indexes/timestampindex").bloom_bits, 0);
+    gArgs.ForceSetArg("-dbprofile", "chainstate:bloombits=12,writebuffer=10");
+    BOOST_CHECK_EQUAL(GetDBProfile("chainstate").bloom_bits, 12);
+    BOOST_CHECK_EQUAL(GetDBProfile("chainstate").write_buffer_percent, 10);
+    BOOST_CHECK_EQUAL(GetDBProfile("chainstate").block_cache_percent, 50);
+    BOOST_CHECK_EQUAL(GetDBProfile("llmq/isdb").bloom_bits, 16);
+
+    // A database opened with the profile works as any other one
+    {
+        CDBWrapper dbw(GetDataDir() / "chainstate", 1 << 20, true, false, false);
+        BOOST_CHECK(dbw.Write(uint8_t{'k'}, uint256::ONE));
+        uint256 res;
+        BOOST_CHECK(dbw.Read(uint8_t{'k'}, res));
+        BOOST_CHECK_EQUAL(res, uint256::ONE);
+    }
+    gArgs.ForceSetArg("-dbprofile", "");
+}
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -38,6 +38,8 @@ struct COrphanTx {
     int64_t nTimeExpire;
 };
 extern std::map<uint256, COrphanTx> mapOrphanTransactions GUARDED_BY(g_cs_orphans);
+extern size_t nMapOrphanTransactionsSize;
+extern size_t nMapOrphanTransactionsUsage;
 
 static CService ip(uint32_t i)
 {
@@ -414,6 +416,7 @@ BOOST_AUTO_TEST_CASE(DoS_mapOrphans)
     }
 
     LOCK2(cs_main, g_cs_orphans);
+    BOOST_CHECK(nMapOrphanTransactionsUsage > nMapOrphanTransactionsSize);
     // Test EraseOrphansFor:
     for (NodeId i = 0; i < 3; i++)
     {
@@ -429,6 +432,8 @@ BOOST_AUTO_TEST_CASE(DoS_mapOrphans)
     BOOST_CHECK(mapOrphanTransactions.size() <= 10);
     LimitOrphanTxSize(0);
     BOOST_CHECK(mapOrphanTransactions.empty());
+    BOOST_CHECK_EQUAL(nMapOrphanTransactionsSize, 0U);
+    BOOST_CHECK_EQUAL(nMapOrphanTransactionsUsage, 0U);
 }
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -402,4 +402,45 @@ BOOST_FIXTURE_TEST_CASE(evo_assetunlock, TestChain100Setup)
 
 }
 
+BOOST_FIXTURE_TEST_CASE(evo_payload_cache, TestChain100Setup)
+{
+    FillableSigningProvider keystore;
+    CKey key;
+    key.MakeNewKey(true);
+    const CTransaction tx{CreateAssetUnlockTx(keystore, key)};
+    BOOST_CHECK(tx.GetPayloadCache() == nullptr);
+
+    const auto payload = GetTxPayload<CAssetUnlockPayload>(tx);
+    BOOST_REQUIRE(payload.has_value());
+    const auto cache = tx.GetPayloadCache();
+    BOOST_CHECK(cache != nullptr);
+
+    // The payload is decoded once
+    const auto cached_payload = GetTxPayload<CAssetUnlockPayload>(tx);
+    BOOST_REQUIRE(cached_payload.has_value());
+    BOOST_CHECK(tx.GetPayloadCache() == cache);
+    BOOST_CHECK_EQUAL(cached_payload->getIndex(), payload->getIndex());
+    BOOST_CHECK(cached_payload->getQuorumSig() == payload->getQuorumSig());
+
+    // Another type doesn't match the transaction at all
+    BOOST_CHECK(!GetTxPayload<CAssetLockPayload>(tx, false).has_value());
+    BOOST_CHECK(tx.GetPayloadCache() == cache);
+
+    // The signature is decoded again once the BLS scheme changes
+    const bool legacy_scheme = bls::bls_legacy_scheme.exchange(!bls::bls_legacy_scheme.load());
+    BOOST_CHECK(GetTxPayload<CAssetUnlockPayload>(tx).has_value());
+    BOOST_CHECK(tx.GetPayloadCache() != cache);
+    bls::bls_legacy_scheme.store(legacy_scheme);
+
+    // Payloads which fail to decode are remembered too
+    CMutableTransaction mtx{tx};
+    mtx.vExtraPayload.push_back(0);
+    const CTransaction tx_bad{mtx};
+    BOOST_CHECK(!GetTxPayload<CAssetUnlockPayload>(tx_bad).has_value());
+    BOOST_CHECK(tx_bad.GetPayloadCache() != nullptr);
+    BOOST_CHECK(!GetTxPayload<CAssetUnlockPayload>(tx_bad).has_value());
+    // A mutable transaction has nothing to keep it in
+    BOOST_CHECK(!GetTxPayload<CAssetUnlockPayload>(mtx).has_value());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
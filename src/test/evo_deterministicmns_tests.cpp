@@ -461,6 +461,9 @@ void FuncDIP3Protx(TestChainSetup& setup)
     // check MN reward payments
     for (size_t i = 0; i < 20; i++) {
         auto dmnExpectedPayee = dmnman.GetListAtChainTip().GetMNPayee(::ChainActive().Tip());
+        const auto projectedPayees = dmnman.GetListAtChainTip().GetProjectedMNPayees(::ChainActive().Tip());
+        BOOST_CHECK_EQUAL(projectedPayees.size(), dmnman.GetListAtChainTip().GetValidWeightedMNsCount());
+        BOOST_CHECK_EQUAL(projectedPayees.at(0)->proTxHash.ToString(), dmnExpectedPayee->proTxHash.ToString());
 
         CBlock block = setup.CreateAndProcessBlock({}, setup.coinbaseKey);
         dmnman.UpdatedBlockTip(::ChainActive().Tip());
@@ -798,6 +801,26 @@ void FuncVerifyDB(TestChainSetup& setup)
     BOOST_ASSERT(CVerifyDB().VerifyDB(::ChainstateActive(), Params(), ::ChainstateActive().CoinsTip(), *(setup.m_node.evodb), 4, 2));
 }
 
+static CDeterministicMNCPtr MakeCacheTestMN(uint64_t internalId)
+{
+    auto dmn = std::make_shared<CDeterministicMN>(internalId);
+    dmn->proTxHash = InsecureRand256();
+    dmn->collateralOutpoint = COutPoint(InsecureRand256(), 0);
+    auto state = std::make_shared<CDeterministicMNState>();
+    const uint256 r = InsecureRand256();
+    state->keyIDOwner = CKeyID(uint160(std::vector<unsigned char>(r.begin(), r.begin() + 20)));
+    dmn->pdmnState = state;
+    return dmn;
+}
+
+static CDeterministicMNListDiff MakeCacheTestDiff(int nHeight)
+{
+    CDeterministicMNListDiff diff;
+    diff.nHeight = nHeight;
+    diff.removedMns = {1, 2, 3};
+    return diff;
+}
+
 BOOST_AUTO_TEST_SUITE(evo_dip3_activation_tests)
 
 // DIP3 can only be activated with legacy scheme (v19 is activated later)
@@ -857,4 +880,177 @@ BOOST_AUTO_TEST_CASE(verify_db_legacy)
     FuncVerifyDB(setup);
 }
 
+BOOST_AUTO_TEST_CASE(mnlist_cache)
+{
+    BasicTestingSetup setup;
+
+    CDeterministicMNList list1(InsecureRand256(), 1, 0);
+    for (uint64_t i = 0; i < 100; i++) {
+        list1.AddMN(MakeCacheTestMN(i));
+    }
+    CDeterministicMNList list2 = list1;
+    list2.SetBlockHash(InsecureRand256());
+    list2.SetHeight(2);
+    list2.AddMN(MakeCacheTestMN(100));
+
+    // Masternodes shared between lists are only charged once
+    CDeterministicMNListCache cache(std::numeric_limits<size_t>::max());
+    cache.AddList(list1);
+    const size_t usage1 = cache.DynamicMemoryUsage();
+    cache.AddList(list2);
+    const size_t usage2 = cache.DynamicMemoryUsage() - usage1;
+    BOOST_CHECK_LT(usage2 * 20, usage1);
+    cache.AddList(list1);
+    BOOST_CHECK_EQUAL(cache.DynamicMemoryUsage(), usage1 + usage2);
+
+    // Dropping a list only frees the masternodes no other list holds
+    cache.Erase(list1.GetBlockHash());
+    BOOST_CHECK(cache.GetList(list1.GetBlockHash()) == nullptr);
+    BOOST_CHECK_GT(cache.DynamicMemoryUsage(), usage1);
+    BOOST_CHECK_LT(cache.DynamicMemoryUsage(), usage1 + usage2);
+    cache.Erase(list2.GetBlockHash());
+    BOOST_CHECK_EQUAL(cache.DynamicMemoryUsage(), 0U);
+
+    // The least recently used entries go first
+    cache.AddDiff(uint256::ONE, MakeCacheTestDiff(1));
+    const size_t diffUsage = cache.DynamicMemoryUsage();
+    CDeterministicMNListCache small(diffUsage * 5 / 2);
+    const std::vector<uint256> hashes{InsecureRand256(), InsecureRand256(), InsecureRand256()};
+    small.AddDiff(hashes[0], MakeCacheTestDiff(1));
+    small.AddDiff(hashes[1], MakeCacheTestDiff(2));
+    BOOST_CHECK(small.GetDiff(hashes[0]) != nullptr);
+    small.AddDiff(hashes[2], MakeCacheTestDiff(3));
+    // nothing is evicted before Trim()
+    BOOST_CHECK(small.GetDiff(hashes[1]) != nullptr);
+    BOOST_CHECK(small.GetDiff(hashes[0]) != nullptr);
+    small.Trim();
+    BOOST_CHECK(small.GetDiff(hashes[2]) == nullptr);
+    BOOST_CHECK(small.GetDiff(hashes[1]) != nullptr);
+    BOOST_CHECK_EQUAL(small.GetStats().evictions, 1U);
+    BOOST_CHECK_EQUAL(small.GetStats().diffs, 2U);
+
+    // The most recently used list is kept even if it alone is over the limit
+    small.AddList(list1);
+    small.AddList(list2);
+    small.Trim();
+    const auto stats = small.GetStats();
+    BOOST_CHECK_EQUAL(stats.lists, 1U);
+    BOOST_CHECK_EQUAL(stats.diffs, 0U);
+    BOOST_CHECK(small.GetList(list2.GetBlockHash()) != nullptr);
+
+    small.EraseListsIf([](const CDeterministicMNList& mnList) { return mnList.GetHeight() == 2; });
+    BOOST_CHECK_EQUAL(small.GetStats().lists, 0U);
+    BOOST_CHECK_EQUAL(small.DynamicMemoryUsage(), 0U);
+}
+
+BOOST_AUTO_TEST_CASE(mnlist_secondary_indexes)
+{
+    BasicTestingSetup setup;
+
+    CBLSSecretKey sk1, sk2;
+    sk1.MakeNewKey();
+    sk2.MakeNewKey();
+    const CService addr1 = LookupNumeric("1.2.3.4", 1000);
+    const CService addr2 = LookupNumeric("1.2.3.4", 1001);
+
+    auto dmn = std::make_shared<CDeterministicMN>(*MakeCacheTestMN(0));
+    auto state = std::make_shared<CDeterministicMNState>(*dmn->pdmnState);
+    state->pubKeyOperator.Set(sk1.GetPublicKey(), true);
+    state->addr = addr1;
+    dmn->pdmnState = state;
+
+    CDeterministicMNList mnList(InsecureRand256(), 1, 0);
+    mnList.AddMN(MakeCacheTestMN(1));
+    mnList.AddMN(dmn);
+    BOOST_REQUIRE(mnList.GetMNByOperatorKey(sk1.GetPublicKey()));
+    BOOST_CHECK_EQUAL(mnList.GetMNByOperatorKey(sk1.GetPublicKey())->proTxHash, dmn->proTxHash);
+    BOOST_REQUIRE(mnList.GetMNByService(addr1));
+    BOOST_CHECK_EQUAL(mnList.GetMNByService(addr1)->proTxHash, dmn->proTxHash);
+    BOOST_CHECK(!mnList.GetMNByOperatorKey(sk2.GetPublicKey()));
+    BOOST_CHECK(!mnList.GetMNByService(addr2));
+    BOOST_CHECK(!mnList.GetMNByOperatorKey(CBLSPublicKey()));
+    BOOST_CHECK(!mnList.GetMNByService(CService()));
+
+    // Keys set with the basic scheme are found just like legacy ones
+    auto newState = std::make_shared<CDeterministicMNState>(*state);
+    newState->nVersion = CProRegTx::BASIC_BLS_VERSION;
+    newState->pubKeyOperator.Set(sk2.GetPublicKey(), false);
+    newState->addr = addr2;
+    mnList.UpdateMN(dmn->proTxHash, newState);
+    BOOST_CHECK(!mnList.GetMNByOperatorKey(sk1.GetPublicKey()));
+    BOOST_CHECK(!mnList.GetMNByService(addr1));
+    BOOST_REQUIRE(mnList.GetMNByOperatorKey(sk2.GetPublicKey()));
+    BOOST_CHECK_EQUAL(mnList.GetMNByOperatorKey(sk2.GetPublicKey())->proTxHash, dmn->proTxHash);
+    BOOST_CHECK(mnList.GetMNByService(addr2));
+
+    // Copies are unaffected by changes to the original
+    const CDeterministicMNList copy = mnList;
+    mnList.RemoveMN(dmn->proTxHash);
+    BOOST_CHECK(!mnList.GetMNByOperatorKey(sk2.GetPublicKey()));
+    BOOST_CHECK(!mnList.GetMNByService(addr2));
+    BOOST_CHECK(copy.GetMNByOperatorKey(sk2.GetPublicKey()));
+    BOOST_CHECK(copy.GetMNByService(addr2));
+
+    // Indexes are rebuilt when a list is read back
+    CDataStream ss(SER_DISK, CLIENT_VERSION);
+    ss << copy;
+    CDeterministicMNList copy2;
+    ss >> copy2;
+    BOOST_CHECK(copy2.GetMNByOperatorKey(sk2.GetPublicKey()));
+    BOOST_CHECK(copy2.GetMNByService(addr2));
+}
+
+BOOST_AUTO_TEST_CASE(mnlist_compact_snapshot)
+{
+    BasicTestingSetup setup;
+
+    CBLSSecretKey sk;
+    sk.MakeNewKey();
+    const CScript sharedPayout = CScript() << OP_TRUE;
+
+    CDeterministicMNList mnList(InsecureRand256(), 1000, 3);
+    for (uint64_t i = 0; i < 3; i++) {
+        auto dmn = std::make_shared<CDeterministicMN>(*MakeCacheTestMN(i));
+        auto state = std::make_shared<CDeterministicMNState>(*dmn->pdmnState);
+        state->nRegisteredHeight = 100 + i;
+        state->nLastPaidHeight = 900;
+        state->scriptPayout = sharedPayout;
+        if (i == 0) {
+            // collateral in the ProRegTx, confirmed, PoSe banned and on the basic scheme
+            dmn->collateralOutpoint = COutPoint(dmn->proTxHash, 1);
+            state->nVersion = CProRegTx::BASIC_BLS_VERSION;
+            state->pubKeyOperator.Set(sk.GetPublicKey(), false);
+            state->addr = LookupNumeric("1.2.3.4", 1000);
+            state->UpdateConfirmedHash(dmn->proTxHash, InsecureRand256());
+            state->nPoSePenalty = 10;
+            state->BanIfNotBanned(950);
+        } else if (i == 1) {
+            dmn->nType = MnType::Evo;
+            dmn->nOperatorReward = 1000;
+            state->platformNodeID = uint160(std::vector<unsigned char>(20, 1));
+            state->platformP2PPort = 26656;
+            state->platformHTTPPort = 443;
+            state->scriptOperatorPayout = CScript() << OP_FALSE;
+        }
+        dmn->pdmnState = state;
+        mnList.AddMN(dmn);
+    }
+
+    CDataStream ssFull(SER_DISK, CLIENT_VERSION);
+    ssFull << mnList;
+    CDataStream ssCompact(SER_DISK, CLIENT_VERSION);
+    ssCompact << CDeterministicMNListCompact(mnList);
+    BOOST_CHECK_LT(ssCompact.size(), ssFull.size());
+
+    // Read back, the list is the same as the original one
+    CDeterministicMNListCompact compact;
+    ssCompact >> compact;
+    BOOST_CHECK(ssCompact.empty());
+    CDataStream ssRoundtrip(SER_DISK, CLIENT_VERSION);
+    ssRoundtrip << compact.list;
+    BOOST_CHECK(ssRoundtrip.str() == ssFull.str());
+    BOOST_CHECK(compact.list.GetMNByOperatorKey(sk.GetPublicKey()));
+    BOOST_CHECK_EQUAL(compact.list.GetValidMNsCount(), 2U);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -69,4 +69,101 @@ BOOST_AUTO_TEST_CASE(simplifiedmns_merkleroots)
 
     BOOST_CHECK(expectedMerkleRoot == calculatedMerkleRoot);
 }
+
+static CDeterministicMNCPtr MakeMerkleTreeTestMN(uint64_t internalId)
+{
+    auto dmn = std::make_shared<CDeterministicMN>(internalId);
+    dmn->proTxHash = InsecureRand256();
+    dmn->collateralOutpoint = COutPoint(InsecureRand256(), 0);
+    auto state = std::make_shared<CDeterministicMNState>();
+    const uint256 r = InsecureRand256();
+    state->keyIDOwner = CKeyID(uint160(std::vector<unsigned char>(r.begin(), r.begin() + 20)));
+    state->confirmedHash = InsecureRand256();
+    dmn->pdmnState = state;
+    return dmn;
+}
+
+BOOST_AUTO_TEST_CASE(simplifiedmns_merkletree)
+{
+    CSimplifiedMNListMerkleTree tree;
+    CDeterministicMNList mnList;
+    BOOST_CHECK(tree.Update(mnList).IsNull());
+
+    std::vector<uint256> proTxHashes;
+    uint64_t nextId{0};
+    for (int step = 0; step < 50; step++) {
+        // A few masternodes get added, updated and removed with every list
+        for (int i = 0; i < 5; i++) {
+            const auto dmn = MakeMerkleTreeTestMN(nextId++);
+            mnList.AddMN(dmn);
+            proTxHashes.emplace_back(dmn->proTxHash);
+        }
+        for (int i = 0; i < 3 && !proTxHashes.empty(); i++) {
+            const auto dmn = mnList.GetMN(proTxHashes[InsecureRandRange(proTxHashes.size())]);
+            auto newState = std::make_shared<CDeterministicMNState>(*dmn->pdmnState);
+            newState->confirmedHash = InsecureRand256();
+            mnList.UpdateMN(*dmn, newState);
+        }
+        for (int i = 0; i < 2 && !proTxHashes.empty(); i++) {
+            const size_t idx = InsecureRandRange(proTxHashes.size());
+            mnList.RemoveMN(proTxHashes[idx]);
+            proTxHashes.erase(proTxHashes.begin() + idx);
+        }
+
+        bool mutated{true};
+        const uint256 root = tree.Update(mnList, &mutated);
+        BOOST_CHECK(!mutated);
+        BOOST_CHECK_EQUAL(tree.size(), mnList.GetAllMNsCount());
+        BOOST_CHECK_EQUAL(root, CSimplifiedMNList(mnList).CalcMerkleRoot());
+    }
+
+    // Going back to an older list works just as well
+    const CDeterministicMNList oldList = mnList;
+    for (const auto& proTxHash : proTxHashes) {
+        mnList.RemoveMN(proTxHash);
+    }
+    BOOST_CHECK(tree.Update(mnList).IsNull());
+    BOOST_CHECK_EQUAL(tree.Update(oldList), CSimplifiedMNList(oldList).CalcMerkleRoot());
+}
+
+BOOST_AUTO_TEST_CASE(mnlist_response_cache)
+{
+    CMNListResponseCache cache(250);
+    const auto makeBuffer = [](size_t size) {
+        return std::make_shared<const std::vector<unsigned char>>(size, 0);
+    };
+
+    const uint256 key1 = InsecureRand256();
+    const uint256 key2 = InsecureRand256();
+    const uint256 key3 = InsecureRand256();
+    BOOST_CHECK(cache.Get(key1) == nullptr);
+
+    const auto buffer1 = makeBuffer(100);
+    cache.Add(key1, buffer1);
+    // Everyone gets the very same buffer
+    BOOST_CHECK_EQUAL(cache.Get(key1).get(), buffer1.get());
+    cache.Add(key1, makeBuffer(10));
+    BOOST_CHECK_EQUAL(cache.Get(key1).get(), buffer1.get());
+
+    cache.Add(key2, makeBuffer(100));
+    BOOST_CHECK_EQUAL(cache.DynamicMemoryUsage(), 200U);
+
+    // key1 was used last, so key2 has to go
+    BOOST_CHECK(cache.Get(key1) != nullptr);
+    cache.Add(key3, makeBuffer(100));
+    BOOST_CHECK_EQUAL(cache.Size(), 2U);
+    BOOST_CHECK(cache.Get(key2) == nullptr);
+    BOOST_CHECK(cache.Get(key1) != nullptr);
+
+    // A single buffer above the limit is still kept
+    cache.Add(key2, makeBuffer(1000));
+    BOOST_CHECK_EQUAL(cache.Size(), 1U);
+    BOOST_CHECK(cache.Get(key2) != nullptr);
+
+    cache.Clear();
+    BOOST_CHECK_EQUAL(cache.Size(), 0U);
+    BOOST_CHECK_EQUAL(cache.DynamicMemoryUsage(), 0U);
+    BOOST_CHECK(cache.Get(key2) == nullptr);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
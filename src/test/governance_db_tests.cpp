@@ -0,0 +1,58 @@
+// Copyright (c) 2026 The Dash Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <governance/governance.h>
+#include <governance/governancedb.h>
+#include <governance/object.h>
+#include <test/util/setup_common.h>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(governance_db_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(governance_db_objects)
+{
+    CGovernanceDb db(true, true);
+    BOOST_CHECK(db.IsEmpty());
+
+    GovernanceStore store;
+    CGovernanceObject obj1(uint256(), 1, 1700000000, InsecureRand256(), "");
+    CGovernanceObject obj2(uint256(), 1, 1700000001, InsecureRand256(), "");
+    BOOST_CHECK(obj1.IsSetDirtyDisk());
+    obj2.PrepareDeletion(1700001000);
+
+    BOOST_CHECK(db.Write(store, {&obj1, &obj2}, {}, 0));
+    BOOST_CHECK(!db.IsEmpty());
+    BOOST_CHECK(db.ReadStore(store));
+
+    std::map<uint256, CGovernanceObject> objects;
+    BOOST_CHECK(db.ReadObjects(objects));
+    BOOST_CHECK_EQUAL(objects.size(), 2U);
+    BOOST_CHECK(objects.count(obj1.GetHash()));
+    BOOST_CHECK_EQUAL(objects.at(obj2.GetHash()).GetDeletionTime(), 1700001000);
+
+    // Only what is passed gets written, the rest stays as it is
+    objects.clear();
+    BOOST_CHECK(db.Write(store, {}, {obj1.GetHash()}, 0));
+    BOOST_CHECK(db.ReadObjects(objects));
+    BOOST_CHECK_EQUAL(objects.size(), 1U);
+    BOOST_CHECK(objects.count(obj2.GetHash()));
+
+    // Erasing and adding an object again in the same write keeps it
+    objects.clear();
+    BOOST_CHECK(db.Write(store, {&obj2}, {obj2.GetHash()}, 0));
+    BOOST_CHECK(db.ReadObjects(objects));
+    BOOST_CHECK_EQUAL(objects.size(), 1U);
+    BOOST_CHECK(objects.count(obj2.GetHash()));
+
+    // The synced time is only written once there is one and then kept
+    int64_t nTimeSynced{0};
+    BOOST_CHECK(!db.ReadSyncedTime(nTimeSynced));
+    BOOST_CHECK(db.Write(store, {}, {}, 1700002000));
+    BOOST_CHECK(db.Write(store, {}, {}, 0));
+    BOOST_CHECK(db.ReadSyncedTime(nTimeSynced));
+    BOOST_CHECK_EQUAL(nTimeSynced, 1700002000);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -1,5 +1,6 @@
 // Copyright (c) 2014-2023 The Dash Core developers
 
+#include <governance/object.h>
 #include <governance/validators.h>
 #include <util/strencodings.h>
 
@@ -9,6 +10,7 @@
 #include <test/util/setup_common.h>
 
 #include <string>
+#include <vector>
 
 #include <boost/test/unit_test.hpp>
 
@@ -79,4 +81,42 @@ BOOST_AUTO_TEST_CASE(invalid_proposals_test)
     }
 }
 
+BOOST_AUTO_TEST_CASE(cached_payload_test)
+{
+    // the validation from the cached payload of an object gives the same results as CProposalValidator on its data
+    UniValue valid = read_json(std::string(json_tests::proposals_valid, json_tests::proposals_valid + sizeof(json_tests::proposals_valid)));
+    UniValue invalid = read_json(std::string(json_tests::proposals_invalid, json_tests::proposals_invalid + sizeof(json_tests::proposals_invalid)));
+
+    std::vector<std::string> vecHexData{""};
+    for (size_t i = 0; i < valid.size(); ++i) {
+        vecHexData.push_back(CreateEncodedProposalObject(valid[i][0]));
+        vecHexData.push_back(HexStr(valid[i][0].write()));
+    }
+    for (size_t i = 0; i < invalid.size(); ++i) {
+        vecHexData.push_back(CreateEncodedProposalObject(invalid[i]));
+        vecHexData.push_back(HexStr(invalid[i].write()));
+    }
+
+    for (const auto& strHexData : vecHexData) {
+        const CGovernanceObject govobj(uint256(), 1, GetTime(), uint256(), strHexData);
+        BOOST_CHECK_EQUAL(govobj.GetDataAsHexString(), strHexData);
+        for (const bool fAllowScript : {true, false}) {
+            for (const bool fCheckExpiration : {true, false}) {
+                CProposalValidator validator(strHexData, fAllowScript);
+                const bool fValid = validator.Validate(fCheckExpiration);
+                std::string strError;
+                BOOST_CHECK_EQUAL(govobj.ValidateProposal(fCheckExpiration, fAllowScript, strError), fValid);
+                // with the expiration check the first failing check can differ
+                if (!fCheckExpiration) {
+                    BOOST_CHECK_EQUAL(strError, validator.GetErrorMessages());
+                }
+            }
+        }
+
+        // copies share the decoded data
+        const CGovernanceObject govobjCopy(govobj);
+        BOOST_CHECK(govobjCopy.GetPayload() == govobj.GetPayload());
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -148,4 +148,30 @@ BOOST_AUTO_TEST_CASE(siphash)
     BOOST_CHECK_EQUAL(SipHashUint256(1, 2, ss.GetHash()), 0x79751e980c2a0a35ULL);
 }
 
+BOOST_AUTO_TEST_CASE(kawpow_hash_conversion)
+{
+    // The binary bridge must agree byte-for-byte with the old hex round-trips
+    for (int i = 0; i < 16; ++i) {
+        const uint256 x = InsecureRand256();
+        const ethash::hash256 h = UintToEthashHash(x);
+        BOOST_CHECK(h == to_hash256(x.GetHex()));
+        BOOST_CHECK_EQUAL(EthashHashToUint(h), uint256S(to_hex(h)));
+        BOOST_CHECK_EQUAL(EthashHashToUint(h), x);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(x16r_schedule)
+{
+    // The precomputed schedule must match the reference HashX11 for any parent and input size
+    for (int i = 0; i < 32; ++i) {
+        const uint256 prev = InsecureRand256();
+        const X16RSchedule schedule(prev);
+        BOOST_CHECK_EQUAL(schedule.GetPrevBlockHash(), prev);
+        for (size_t len : {0, 1, 32, 80, 200}) {
+            const std::vector<unsigned char> in = g_insecure_rand_ctx.randbytes(len);
+            BOOST_CHECK_EQUAL(schedule.Hash(in.begin(), in.end()), HashX11(in.begin(), in.end(), prev));
+        }
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,247 @@
+// Copyright (c) 2026 The Dash Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <chainparams.h>
+#include <crypto-X16R/ethash/helpers.hpp>
+#include <crypto-X16R/ethash/include/ethash/progpow.hpp>
+#include <crypto-X16R/ethash/progpow_test_vectors.hpp>
+#include <hash.h>
+#include <kawpow.h>
+#include <miner.h>
+#include <pow.h>
+#include <test/util/setup_common.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+namespace {
+struct KAWPOWHashTestCase
+{
+    int block_number;
+    const char* header_hash_hex;
+    uint64_t nonce;
+    const char* final_hash_hex;
+    const char* mix_hash_hex;
+};
+
+// Computed with the ProgPoW implementation before the program of a period was decoded once, on both sides
+// of the period boundary at block 3 and of the epoch boundary at block 7500
+const KAWPOWHashTestCase kawpow_hash_test_cases[] = {
+    {0, "0000000000000000000000000000000000000000000000000000000000000000", 0x0,
+     "e601a7257a70dc48fccc97a7330d704d776047623b92883d77111fb36870f3d1",
+     "6e97b47b134fda0c7888802988e1a373affeb28bcd813b6e9a0fc669c935d03a"},
+    {2, "63155f732f2bf556967f906155b510c917e48e99685ead76ea83f4eca03ab12b", 0x7073c07,
+     "47f6e6941e8ab44a319609792964736a7722ce5aace8d0651ad74ab59116c0bc",
+     "ba8d864c0aff8b04840a283052196ee092b7062c76672659baafc37c5181f246"},
+    {3, "63155f732f2bf556967f906155b510c917e48e99685ead76ea83f4eca03ab12b", 0x7073c07,
+     "0c691b737817f9676544c657ff2cdfe03ecfaa08d8f5b922bdc0c66e9a4dc98a",
+     "02cc2fdd0ccd57c4eaa0e6e222291085d0f5fc01bcbbbf16255953d797be0f81"},
+    {7499, "9e7248f20914913a73d80a70174c331b1d34f260535ac3631d770e656b5dd922", 0x76e482e,
+     "a4f568b56bd0cc066a3ae9788dd0f002e15fbc677ce42237187b593e7c5b4e41",
+     "f8bce27a43b31a89f12eb2f1a9c1efeccd9ebd7767f2012039a19910f0855c4f"},
+    {7500, "9e7248f20914913a73d80a70174c331b1d34f260535ac3631d770e656b5dd922", 0x76e482e,
+     "5f265c504b53b03ed1ad45b3028b13ad9ef9fe0e770a8e49f369d6ff8cc79c3f",
+     "46c311d25284a14ac6b538f93b1e5e7583d6239c184b3a7e6795f2df970470bc"},
+    {7502, "de37e1824c86d35d154cf65a88de6d9286aec4f7f10c3fc9f0fa1bcc2687188d", 0x3917afab,
+     "f6b0818e1e3f9abd172dc1b26ed788388746065e3a09c1963dc1eb9a65973ec1",
+     "c7a016c28f08280b9e2288f5ee4141502d61cddb1f7a08d5a3f08eb039d1d6c5"},
+    {7503, "de37e1824c86d35d154cf65a88de6d9286aec4f7f10c3fc9f0fa1bcc2687188d", 0xffffffffffffffff,
+     "b47b104268c3cb2e640977153803eed03dd4b8a2fc504003cd665b561a1bcbe4",
+     "3a42046f88f34e70f0ba44edb6fbb9658119d0c491e9193c80000ef580be6279"},
+};
+
+ethash::result KAWPOWHash(CKAWPOWEpochContextCache& cache, const KAWPOWHashTestCase& t)
+{
+    const auto context = cache.Get(ethash::get_epoch_number(t.block_number));
+    return progpow::hash(*context, t.block_number, to_hash256(t.header_hash_hex), t.nonce);
+}
+
+void CheckKAWPOWHash(const KAWPOWHashTestCase& t, const ethash::result& result)
+{
+    BOOST_CHECK_EQUAL(to_hex(result.final_hash), t.final_hash_hex);
+    BOOST_CHECK_EQUAL(to_hex(result.mix_hash), t.mix_hash_hex);
+}
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(kawpow_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(progpow_hash_known_answers)
+{
+    CKAWPOWEpochContextCache cache(2);
+    for (const auto& t : kawpow_hash_test_cases) {
+        CheckKAWPOWHash(t, KAWPOWHash(cache, t));
+    }
+
+    // The upstream vectors of the first two epochs
+    for (const auto& t : progpow_hash_test_cases) {
+        if (t.block_number >= 2 * ethash::epoch_length) continue;
+        const auto context = cache.Get(ethash::get_epoch_number(t.block_number));
+        const auto result = progpow::hash(*context, t.block_number, to_hash256(t.header_hash_hex), std::strtoull(t.nonce_hex, nullptr, 16));
+        BOOST_CHECK_EQUAL(to_hex(result.final_hash), t.final_hash_hex);
+        BOOST_CHECK_EQUAL(to_hex(result.mix_hash), t.mix_hash_hex);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(progpow_hash_threads_switch_periods)
+{
+    // Each thread keeps the program of the last period it hashed, so switching back and forth between
+    // periods, in opposite orders on two threads, must still give the hash of the block's own period
+    CKAWPOWEpochContextCache cache(2);
+    const auto& period_0 = kawpow_hash_test_cases[1];
+    const auto& period_1 = kawpow_hash_test_cases[2];
+    constexpr int rounds{4};
+    std::vector<std::vector<ethash::result>> results(2);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < results.size(); ++i) {
+        threads.emplace_back([&, i] {
+            for (int j = 0; j < rounds; ++j) {
+                results[i].push_back(KAWPOWHash(cache, i == 0 ? period_0 : period_1));
+                results[i].push_back(KAWPOWHash(cache, i == 0 ? period_1 : period_0));
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+
+    for (size_t i = 0; i < results.size(); ++i) {
+        BOOST_REQUIRE_EQUAL(results[i].size(), 2U * rounds);
+        for (size_t j = 0; j < results[i].size(); ++j) {
+            CheckKAWPOWHash((i + j) % 2 == 0 ? period_0 : period_1, results[i][j]);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(epoch_context_cache_shared)
+{
+    CKAWPOWEpochContextCache cache(2);
+    BOOST_CHECK(!cache.IsCached(0));
+
+    // Concurrent callers all end up with the one context that got built
+    std::vector<CKAWPOWEpochContextCache::ContextPtr> results(4);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < results.size(); ++i) {
+        threads.emplace_back([&, i] { results[i] = cache.Get(0); });
+    }
+    for (auto& t : threads) t.join();
+
+    BOOST_CHECK(cache.IsCached(0));
+    for (const auto& ctx : results) {
+        BOOST_REQUIRE(ctx);
+        BOOST_CHECK_EQUAL(ctx.get(), results[0].get());
+        BOOST_CHECK_EQUAL(ctx->epoch_number, 0);
+    }
+    BOOST_CHECK_EQUAL(cache.Get(0).get(), results[0].get());
+}
+
+BOOST_AUTO_TEST_CASE(epoch_context_cache_eviction)
+{
+    CKAWPOWEpochContextCache cache(1);
+    auto ctx0 = cache.Get(0);
+    auto ctx1 = cache.Get(1);
+    BOOST_CHECK(!cache.IsCached(0));
+    BOOST_CHECK(cache.IsCached(1));
+
+    // Evicted contexts stay usable for whoever still holds them
+    BOOST_CHECK_EQUAL(ctx0->epoch_number, 0);
+    BOOST_CHECK_EQUAL(ctx1->epoch_number, 1);
+}
+
+BOOST_AUTO_TEST_CASE(epoch_context_cache_prefetch)
+{
+    CKAWPOWEpochContextCache cache(2);
+
+    // Too far from the boundary, nothing happens
+    cache.MaybePrefetchNext(ethash::epoch_length - KAWPOW_EPOCH_PREFETCH_BLOCKS - 1);
+    cache.Stop();
+    BOOST_CHECK(!cache.IsCached(1));
+
+    CKAWPOWEpochContextCache cache2(2);
+    cache2.MaybePrefetchNext(ethash::epoch_length - KAWPOW_EPOCH_PREFETCH_BLOCKS);
+    // Get() waits for the background build instead of starting a second one
+    BOOST_CHECK_EQUAL(cache2.Get(1)->epoch_number, 1);
+    cache2.Stop();
+    BOOST_CHECK(cache2.IsCached(1));
+
+    // Stopped caches ignore further prefetch requests
+    cache2.Prefetch(2);
+    BOOST_CHECK(!cache2.IsCached(2));
+
+    // A configured distance moves the start, 0 turns prefetching off
+    CKAWPOWEpochContextCache cache3(2);
+    cache3.SetPrefetchBlocks(0);
+    cache3.MaybePrefetchNext(ethash::epoch_length - 1);
+    cache3.SetPrefetchBlocks(10);
+    cache3.MaybePrefetchNext(ethash::epoch_length - 11);
+    cache3.Stop();
+    BOOST_CHECK(!cache3.IsCached(1));
+}
+
+BOOST_AUTO_TEST_CASE(epoch_context_cache_stats)
+{
+    CKAWPOWEpochContextCache cache(2);
+    auto ctx = cache.Get(0);
+
+    auto stats = cache.GetStats();
+    BOOST_CHECK_EQUAL(stats.light_epochs, 1U);
+    BOOST_CHECK_EQUAL(stats.light_bytes, ethash::get_light_cache_size(ctx->light_cache_num_items) + progpow::l1_cache_size);
+    BOOST_CHECK_EQUAL(stats.light_builds, 1U);
+    BOOST_CHECK(stats.light_last_build_us > 0);
+    BOOST_CHECK(stats.light_blocked_us >= stats.light_last_build_us);
+
+    // The full dataset is off unless enabled, generating one is far too slow for a unit test
+    cache.PrepareFullDataset(0);
+    stats = cache.GetStats();
+    BOOST_CHECK_EQUAL(stats.full_epoch, -1);
+    BOOST_CHECK_EQUAL(stats.full_bytes, 0U);
+    BOOST_CHECK(!stats.full_ready);
+    BOOST_CHECK(!cache.GetFullDataset(0));
+}
+
+BOOST_AUTO_TEST_CASE(solve_kawpow_block_threads)
+{
+    const auto chainParams = CreateChainParams(*m_node.args, CBaseChainParams::REGTEST);
+    const auto& consensus = chainParams->GetConsensus();
+
+    CBlockHeader header;
+    header.nVersion = 4;
+    header.hashPrevBlock = InsecureRand256();
+    header.hashMerkleRoot = InsecureRand256();
+    header.nTime = 1700000000;
+    header.nBits = 0x2007ffff; // roughly one in sixteen hashes is good enough
+    header.nHeight = 10;
+
+    const auto never = [] { return false; };
+
+    CBlockHeader single = header;
+    uint64_t single_tries = 1000;
+    BOOST_REQUIRE(SolveKAWPOWBlock(single, consensus, single_tries, 1, never));
+    BOOST_CHECK(CheckProofOfWork(KAWPOWHash_OnlyMix(single), single.nBits, consensus));
+    BOOST_CHECK_EQUAL(single.GetHash(), KAWPOWHash_OnlyMix(single));
+    BOOST_CHECK_EQUAL(1000 - single_tries, single.nNonce64 + 1);
+
+    // More threads find the very same, lowest, nonce
+    CBlockHeader multi = header;
+    uint64_t multi_tries = 1000;
+    BOOST_REQUIRE(SolveKAWPOWBlock(multi, consensus, multi_tries, 4, never));
+    BOOST_CHECK_EQUAL(multi.nNonce64, single.nNonce64);
+    BOOST_CHECK_EQUAL(multi.mix_hash, single.mix_hash);
+    BOOST_CHECK_EQUAL(multi_tries, single_tries);
+
+    // Running out of tries or being interrupted fails without touching mix_hash
+    CBlockHeader hard = header;
+    hard.nBits = 0x1d00ffff;
+    uint64_t hard_tries = 8;
+    BOOST_CHECK(!SolveKAWPOWBlock(hard, consensus, hard_tries, 2, never));
+    BOOST_CHECK_EQUAL(hard_tries, 0U);
+    BOOST_CHECK_EQUAL(hard.nNonce64, 8U);
+    BOOST_CHECK(hard.mix_hash.IsNull());
+
+    uint64_t interrupted_tries = 1000;
+    BOOST_CHECK(!SolveKAWPOWBlock(hard, consensus, interrupted_tries, 2, [] { return true; }));
+    BOOST_CHECK_EQUAL(interrupted_tries, 1000U);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
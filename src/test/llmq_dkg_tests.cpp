@@ -3,12 +3,15 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include <llmq/dkgsession.h>
+#include <llmq/dkgsessionhandler.h>
+#include <protocol.h>
+#include <test/util/setup_common.h>
 #include <util/irange.h>
 #include <util/underlying.h>
 
 #include <boost/test/unit_test.hpp>
 
-BOOST_AUTO_TEST_SUITE(llmq_dkg_tests)
+BOOST_FIXTURE_TEST_SUITE(llmq_dkg_tests, BasicTestingSetup)
 
 BOOST_AUTO_TEST_CASE(llmq_dkgerror)
 {
@@ -23,6 +26,44 @@ BOOST_AUTO_TEST_CASE(llmq_dkgerror)
     BOOST_ASSERT(GetSimulatedErrorRate(llmq::DKGError::type::_COUNT) == 0.0);
 }
 
+BOOST_AUTO_TEST_CASE(llmq_dkg_pending_messages)
+{
+    using namespace llmq;
+    const uint256 quorumHash = uint256S("01");
+    const uint256 member = uint256S("02");
+    const uint256 nonMember = uint256S("03");
+    auto makeComplaint = [](const uint256& quorumHash, const uint256& proTxHash, bool bad) {
+        CDKGComplaint qc;
+        qc.llmqType = Consensus::LLMQType::LLMQ_TEST;
+        qc.quorumHash = quorumHash;
+        qc.proTxHash = proTxHash;
+        qc.badMembers = {bad};
+        qc.complainForMembers = {false};
+        return qc;
+    };
+
+    CDKGPendingMessages pending(10, MSG_QUORUM_COMPLAINT);
+    pending.SetQuorumMembers(quorumHash, {member});
 
+    auto qc1 = makeComplaint(quorumHash, member, false);
+    pending.PushPendingMessage(-1, nullptr, qc1);
+    BOOST_CHECK(pending.HasSeen(::SerializeHash(qc1)));
+    // duplicates are dropped
+    pending.PushPendingMessage(-1, nullptr, qc1);
+    // non-members are rejected before the payload is queued
+    auto qc2 = makeComplaint(quorumHash, nonMember, false);
+    pending.PushPendingMessage(-1, nullptr, qc2);
+    BOOST_CHECK(!pending.HasSeen(::SerializeHash(qc2)));
+    // other quorums are left to PreVerifyMessage
+    auto qc3 = makeComplaint(uint256S("04"), nonMember, true);
+    pending.PushPendingMessage(-1, nullptr, qc3);
+
+    CBLSWorker worker;
+    const auto msgs = pending.PopAndDeserializeMessages<CDKGComplaint>(10, worker);
+    BOOST_REQUIRE_EQUAL(msgs.size(), 2U);
+    BOOST_REQUIRE(msgs[0].second && msgs[1].second);
+    BOOST_CHECK(msgs[0].second->proTxHash == member);
+    BOOST_CHECK(msgs[1].second->quorumHash == qc3.quorumHash && msgs[1].second->badMembers == qc3.badMembers);
+}
 
 BOOST_AUTO_TEST_SUITE_END()
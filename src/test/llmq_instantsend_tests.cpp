@@ -0,0 +1,116 @@
+// Copyright (c) 2026 The Dash Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <llmq/instantsend.h>
+#include <test/util/setup_common.h>
+
+#include <boost/test/unit_test.hpp>
+
+using namespace llmq;
+
+static CInstantSendLockPtr MakeTestISLock(size_t nInputs)
+{
+    auto islock = std::make_shared<CInstantSendLock>();
+    islock->txid = InsecureRand256();
+    islock->cycleHash = InsecureRand256();
+    for (size_t i = 0; i < nInputs; i++) {
+        islock->inputs.emplace_back(InsecureRand256(), i);
+    }
+    return islock;
+}
+
+BOOST_FIXTURE_TEST_SUITE(llmq_instantsend_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(islock_db_batch_write)
+{
+    CInstantSendDb db(true, true);
+
+    std::vector<std::pair<uint256, CInstantSendLockPtr>> islocks;
+    for (size_t i = 1; i <= 3; i++) {
+        const auto islock = MakeTestISLock(i);
+        islocks.emplace_back(::SerializeHash(*islock), islock);
+    }
+    // Nothing to write does not touch the db
+    db.WriteNewInstantSendLocks({}, {});
+    BOOST_CHECK(!db.KnownInstantSendLock(islocks[0].first));
+
+    db.WriteNewInstantSendLocks(islocks, {{islocks[2].first, 100}});
+    for (const auto& [hash, islock] : islocks) {
+        BOOST_CHECK(db.KnownInstantSendLock(hash));
+        BOOST_CHECK_EQUAL(db.GetInstantSendLockHashByTxid(islock->txid), hash);
+        for (const auto& in : islock->inputs) {
+            BOOST_CHECK(db.GetInstantSendLockByInput(in) != nullptr);
+        }
+        // really written, not only cached
+        const auto fromDb = db.GetInstantSendLockByHash(hash, false);
+        BOOST_REQUIRE(fromDb != nullptr);
+        BOOST_CHECK_EQUAL(::SerializeHash(*fromDb), hash);
+    }
+    BOOST_CHECK_EQUAL(db.GetInstantSendLockCount(), 3U);
+
+    // Only the lock written as mined gets confirmed
+    const auto confirmed = db.RemoveConfirmedInstantSendLocks(100);
+    BOOST_CHECK_EQUAL(confirmed.size(), 1U);
+    BOOST_CHECK(confirmed.count(islocks[2].first));
+    BOOST_CHECK_EQUAL(db.GetInstantSendLockCount(), 2U);
+}
+
+BOOST_AUTO_TEST_CASE(islock_outpoint_index)
+{
+    CInstantSendOutpointIndex index(3);
+    const auto islock1 = MakeTestISLock(2);
+    const auto islock2 = MakeTestISLock(2);
+    const uint256 hash1 = ::SerializeHash(*islock1);
+    const uint256 hash2 = ::SerializeHash(*islock2);
+
+    index.Add(hash1, *islock1);
+    index.SetComplete(true);
+    BOOST_CHECK(index.IsComplete());
+    BOOST_CHECK_EQUAL(index.size(), 2U);
+    const auto entry = index.Get(islock1->inputs[1]);
+    BOOST_REQUIRE(entry);
+    BOOST_CHECK_EQUAL(entry->islockHash, hash1);
+    BOOST_CHECK_EQUAL(entry->txid, islock1->txid);
+
+    // Removing a lock leaves entries of other locks alone
+    index.Remove(hash2, *islock1);
+    BOOST_CHECK_EQUAL(index.size(), 2U);
+
+    // Running out of room makes the index incomplete instead of growing
+    index.Add(hash2, *islock2);
+    BOOST_CHECK_EQUAL(index.size(), 3U);
+    BOOST_CHECK(!index.IsComplete());
+    BOOST_CHECK(index.Get(islock2->inputs[0]));
+    BOOST_CHECK(!index.Get(islock2->inputs[1]));
+
+    index.Remove(hash1, *islock1);
+    BOOST_CHECK_EQUAL(index.size(), 1U);
+    BOOST_CHECK(!index.Get(islock1->inputs[0]));
+    BOOST_CHECK(!index.IsComplete());
+}
+
+BOOST_AUTO_TEST_CASE(islock_db_conflicts)
+{
+    CInstantSendDb db(true, true);
+    const auto islock = MakeTestISLock(2);
+    const uint256 hash = ::SerializeHash(*islock);
+    const COutPoint unlocked(InsecureRand256(), 0);
+
+    BOOST_CHECK(db.GetConflictingLockByInput(islock->inputs[0], InsecureRand256()) == nullptr);
+    db.WriteNewInstantSendLock(hash, *islock);
+
+    // The locked tx itself does not conflict with its lock
+    BOOST_CHECK(db.GetConflictingLockByInput(islock->inputs[0], islock->txid) == nullptr);
+    const auto conflict = db.GetConflictingLockByInput(islock->inputs[1], InsecureRand256());
+    BOOST_REQUIRE(conflict != nullptr);
+    BOOST_CHECK_EQUAL(::SerializeHash(*conflict), hash);
+    BOOST_CHECK(db.GetConflictingLockByInput(unlocked, InsecureRand256()) == nullptr);
+
+    // Locks of confirmed txes are gone from the index too
+    db.WriteInstantSendLockMined(hash, 10);
+    db.RemoveConfirmedInstantSendLocks(10);
+    BOOST_CHECK(db.GetConflictingLockByInput(islock->inputs[1], InsecureRand256()) == nullptr);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,180 @@
+// Copyright (c) 2026 The Dash Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <clientversion.h>
+#include <bls/bls.h>
+#include <llmq/signing.h>
+#include <llmq/signing_shares.h>
+#include <llmq/signing_stats.h>
+#include <streams.h>
+#include <test/util/setup_common.h>
+
+#include <boost/test/unit_test.hpp>
+
+using namespace llmq;
+
+static CRecoveredSigsFilter::Key RandomFilterKey()
+{
+    CRecoveredSigsFilter::Key key;
+    const uint256 r = InsecureRand256();
+    std::copy(r.begin(), r.end(), key.begin());
+    key[32] = InsecureRandBits(8);
+    key[33] = InsecureRandBits(8);
+    return key;
+}
+
+BOOST_FIXTURE_TEST_SUITE(llmq_signing_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(recsigs_filter)
+{
+    // An unsized filter knows nothing and has to let everything through
+    CRecoveredSigsFilter empty;
+    BOOST_CHECK(!empty.IsValid());
+    BOOST_CHECK(empty.contains(RandomFilterKey()));
+
+    CRecoveredSigsFilter filter(10000);
+    BOOST_CHECK(filter.IsValid());
+    std::vector<CRecoveredSigsFilter::Key> keys;
+    for (int i = 0; i < 10000; i++) {
+        keys.emplace_back(RandomFilterKey());
+        filter.insert(keys.back());
+    }
+    BOOST_CHECK(!filter.IsFull());
+    for (const auto& key : keys) {
+        BOOST_CHECK(filter.contains(key));
+    }
+
+    int falsePositives{0};
+    for (int i = 0; i < 10000; i++) {
+        falsePositives += filter.contains(RandomFilterKey());
+    }
+    // sized for a rate of 0.001, leave plenty of slack
+    BOOST_CHECK_LT(falsePositives, 100);
+
+    filter.insert(RandomFilterKey());
+    BOOST_CHECK(filter.IsFull());
+
+    CDataStream ss(SER_DISK, CLIENT_VERSION);
+    ss << filter;
+    CRecoveredSigsFilter filter2;
+    ss >> filter2;
+    BOOST_CHECK(filter2.IsValid());
+    BOOST_CHECK(filter2.IsFull());
+    for (const auto& key : keys) {
+        BOOST_CHECK(filter2.contains(key));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(recsigs_db_existence)
+{
+    CRecoveredSigsDb db(true, true);
+
+    const auto llmqType = Consensus::LLMQType::LLMQ_TEST;
+    const CRecoveredSig recSig(llmqType, InsecureRand256(), InsecureRand256(), InsecureRand256(), CBLSSignature());
+    const uint256 signHash = recSig.buildSignHash();
+
+    BOOST_CHECK(!db.HasRecoveredSigForId(llmqType, recSig.getId()));
+    BOOST_CHECK(!db.HasRecoveredSigForSession(signHash));
+    BOOST_CHECK(!db.HasRecoveredSigForHash(recSig.GetHash()));
+
+    db.WriteRecoveredSig(recSig);
+    BOOST_CHECK(db.HasRecoveredSig(llmqType, recSig.getId(), recSig.getMsgHash()));
+    BOOST_CHECK(db.HasRecoveredSigForId(llmqType, recSig.getId()));
+    BOOST_CHECK(db.HasRecoveredSigForSession(signHash));
+    BOOST_CHECK(db.HasRecoveredSigForHash(recSig.GetHash()));
+
+    BOOST_CHECK(!db.HasRecoveredSig(llmqType, recSig.getId(), InsecureRand256()));
+    BOOST_CHECK(!db.HasRecoveredSigForId(Consensus::LLMQType::LLMQ_TEST_V17, recSig.getId()));
+    BOOST_CHECK(!db.HasRecoveredSigForId(llmqType, InsecureRand256()));
+    BOOST_CHECK(!db.HasRecoveredSigForSession(InsecureRand256()));
+    BOOST_CHECK(!db.HasRecoveredSigForHash(InsecureRand256()));
+
+    // Removed keys stay in the filter, the DB still has the final say
+    db.TruncateRecoveredSig(llmqType, recSig.getId());
+    BOOST_CHECK(!db.HasRecoveredSigForId(llmqType, recSig.getId()));
+    BOOST_CHECK(!db.HasRecoveredSigForSession(signHash));
+    BOOST_CHECK(db.HasRecoveredSigForHash(recSig.GetHash()));
+}
+
+BOOST_AUTO_TEST_CASE(signing_stats)
+{
+    using Stage = CSigningStats::Stage;
+    CSigningStats stats;
+    const auto llmqType = Consensus::LLMQType::LLMQ_TEST;
+
+    // Stages of sessions which were never started are ignored
+    stats.Record(llmqType, InsecureRand256(), Stage::Recovered, 1000);
+    BOOST_CHECK_EQUAL(stats.ToJson()["pending_sessions"].get_int(), 0);
+    BOOST_CHECK(stats.ToJson()["llmqs"].empty());
+
+    for (int i = 1; i <= 100; i++) {
+        const uint256 signHash = InsecureRand256();
+        stats.Record(llmqType, signHash, Stage::SignRequested, 1000);
+        stats.Record(llmqType, signHash, Stage::ShareCreated, 1000 + i);
+        // only the first time a stage is reached counts
+        stats.Record(llmqType, signHash, Stage::ShareCreated, 5000);
+        stats.Record(llmqType, signHash, Stage::Recovered, 1000 + 10 * i);
+    }
+    BOOST_CHECK_EQUAL(stats.ToJson()["pending_sessions"].get_int(), 0);
+
+    const UniValue json = stats.ToJson()["llmqs"]["llmq_test"];
+    const UniValue& signToShare = json["sign_to_share"];
+    BOOST_CHECK_EQUAL(signToShare["total"].get_int(), 100);
+    BOOST_CHECK_EQUAL(signToShare["p50"].get_int(), 50);
+    BOOST_CHECK_EQUAL(signToShare["p99"].get_int(), 99);
+    BOOST_CHECK_EQUAL(signToShare["max"].get_int(), 100);
+    BOOST_CHECK_EQUAL(json["sign_to_recovered"]["max"].get_int(), 1000);
+    // never reached, so never measured
+    BOOST_CHECK(json["share_to_relayed"].isNull());
+    BOOST_CHECK(json["first_share_to_recovered"].isNull());
+
+    // Sessions which never recover time out
+    stats.Record(llmqType, InsecureRand256(), Stage::FirstShareSeen, 1000);
+    BOOST_CHECK_EQUAL(stats.ToJson()["pending_sessions"].get_int(), 1);
+    stats.Cleanup(1000 + CSigningStats::SESSION_TIMEOUT * 1000);
+    BOOST_CHECK_EQUAL(stats.ToJson()["pending_sessions"].get_int(), 1);
+    stats.Cleanup(1001 + CSigningStats::SESSION_TIMEOUT * 1000);
+    BOOST_CHECK_EQUAL(stats.ToJson()["pending_sessions"].get_int(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(batched_sigshares_to_send)
+{
+    // Batches sent from shares serialized once must be read back like batches serialized as a whole
+    CBatchedSigShares batch;
+    batch.sessionId = 300;
+    for (const uint16_t member : {0, 7, 399}) {
+        CBLSSecretKey sk;
+        sk.MakeNewKey();
+        CBLSLazySignature sig;
+        sig.Set(sk.Sign(InsecureRand256()), bls::bls_legacy_scheme.load());
+        batch.sigShares.emplace_back(member, sig);
+    }
+
+    SerializedSigShares serialized;
+    CBatchedSigSharesToSend toSend;
+    toSend.sessionId = batch.sessionId;
+    for (const auto& [member, sig] : batch.sigShares) {
+        auto& bytes = serialized[std::make_pair(uint256(), member)];
+        CVectorWriter(SER_NETWORK, PROTOCOL_VERSION, bytes, 0, member, sig);
+        toSend.sigShares.emplace_back(member, &bytes);
+    }
+
+    CDataStream expected(SER_NETWORK, PROTOCOL_VERSION), ss(SER_NETWORK, PROTOCOL_VERSION);
+    expected << std::vector<CBatchedSigShares>{batch};
+    ss << std::vector<CBatchedSigSharesToSend>{toSend};
+    BOOST_CHECK(ss.str() == expected.str());
+    BOOST_CHECK_EQUAL(toSend.ToInvString(), batch.ToInvString());
+
+    std::vector<CBatchedSigShares> read;
+    ss >> read;
+    BOOST_REQUIRE_EQUAL(read.size(), 1U);
+    BOOST_CHECK_EQUAL(read[0].sessionId, batch.sessionId);
+    BOOST_REQUIRE_EQUAL(read[0].sigShares.size(), batch.sigShares.size());
+    for (size_t i = 0; i < batch.sigShares.size(); i++) {
+        BOOST_CHECK_EQUAL(read[0].sigShares[i].first, batch.sigShares[i].first);
+        BOOST_CHECK(read[0].sigShares[i].second == batch.sigShares[i].second);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
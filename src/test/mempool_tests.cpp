@@ -592,6 +592,141 @@ inline CTransactionRef make_tx(std::vector<CAmount>&& output_values, std::vector
 }
 
 
+BOOST_AUTO_TEST_CASE(MempoolClusterTest)
+{
+    CTxMemPool pool(/* estimator */ nullptr, /* check_ratio */ 0, /* cluster_order */ true);
+    LOCK2(cs_main, pool.cs);
+    TestMemPoolEntryHelper entry;
+
+    CMutableTransaction tx1 = CMutableTransaction();
+    tx1.vin.resize(1);
+    tx1.vin[0].scriptSig = CScript() << OP_1;
+    tx1.vout.resize(1);
+    tx1.vout[0].scriptPubKey = CScript() << OP_1 << OP_EQUAL;
+    tx1.vout[0].nValue = 10 * COIN;
+    pool.addUnchecked(entry.Fee(10000LL).FromTx(tx1));
+
+    CMutableTransaction tx2 = CMutableTransaction();
+    tx2.vin.resize(1);
+    tx2.vin[0].scriptSig = CScript() << OP_2;
+    tx2.vout.resize(2);
+    tx2.vout[0].scriptPubKey = CScript() << OP_2 << OP_EQUAL;
+    tx2.vout[0].nValue = 10 * COIN;
+    tx2.vout[1].scriptPubKey = CScript() << OP_2 << OP_EQUAL;
+    tx2.vout[1].nValue = 10 * COIN;
+    pool.addUnchecked(entry.Fee(1000LL).FromTx(tx2));
+
+    CMutableTransaction tx3 = CMutableTransaction();
+    tx3.vin.resize(1);
+    tx3.vin[0].prevout = COutPoint(tx2.GetHash(), 0);
+    tx3.vin[0].scriptSig = CScript() << OP_2;
+    tx3.vout.resize(1);
+    tx3.vout[0].scriptPubKey = CScript() << OP_3 << OP_EQUAL;
+    tx3.vout[0].nValue = 10 * COIN;
+    pool.addUnchecked(entry.Fee(40000LL).FromTx(tx3));
+
+    CMutableTransaction tx4 = CMutableTransaction();
+    tx4.vin.resize(1);
+    tx4.vin[0].prevout = COutPoint(tx2.GetHash(), 1);
+    tx4.vin[0].scriptSig = CScript() << OP_2;
+    tx4.vout.resize(1);
+    tx4.vout[0].scriptPubKey = CScript() << OP_4 << OP_EQUAL;
+    tx4.vout[0].nValue = 10 * COIN;
+    pool.addUnchecked(entry.Fee(0LL).FromTx(tx4));
+
+    // tx3 pays for tx2 and is mined with it before tx1, tx4 doesn't pay for anything and comes last
+    pool.UpdateClusters();
+    const auto& chunks = pool.GetChunkIndex();
+    BOOST_CHECK_EQUAL(chunks.size(), 3U);
+    const auto best = pool.GetChunkTxs(*chunks.rbegin());
+    BOOST_CHECK_EQUAL(best.size(), 2U);
+    BOOST_CHECK(best[0]->GetTx().GetHash() == tx2.GetHash());
+    BOOST_CHECK(best[1]->GetTx().GetHash() == tx3.GetHash());
+    const auto worst = pool.GetChunkTxs(*chunks.begin());
+    BOOST_CHECK_EQUAL(worst.size(), 1U);
+    BOOST_CHECK(worst[0]->GetTx().GetHash() == tx4.GetHash());
+
+    // only the last chunk of the cluster is evicted
+    pool.TrimToSize(pool.DynamicMemoryUsage() - 1);
+    BOOST_CHECK(pool.exists(tx1.GetHash()));
+    BOOST_CHECK(pool.exists(tx2.GetHash()));
+    BOOST_CHECK(pool.exists(tx3.GetHash()));
+    BOOST_CHECK(!pool.exists(tx4.GetHash()));
+
+    // priorities change the linearization like fees
+    pool.PrioritiseTransaction(tx1.GetHash(), 100000LL);
+    pool.UpdateClusters();
+    BOOST_CHECK(pool.GetChunkTxs(*pool.GetChunkIndex().rbegin())[0]->GetTx().GetHash() == tx1.GetHash());
+
+    pool.TrimToSize(1);
+    BOOST_CHECK_EQUAL(pool.size(), 0U);
+    BOOST_CHECK(pool.GetChunkIndex().empty());
+}
+
+BOOST_AUTO_TEST_CASE(MempoolAddressIndexTest)
+{
+    CTxMemPool pool;
+    LOCK2(cs_main, pool.cs);
+    TestMemPoolEntryHelper entry;
+    CCoinsView dummy;
+    CCoinsViewCache view(&dummy);
+
+    const uint160 key_id{std::vector<unsigned char>(20, 0x42)};
+    const CScript script = CScript() << OP_DUP << OP_HASH160 << ToByteVector(key_id) << OP_EQUALVERIFY << OP_CHECKSIG;
+    const COutPoint funding(uint256S("01"), 0);
+    view.AddCoin(funding, Coin(CTxOut(10 * COIN, script), 1, false), false);
+
+    // three transactions paying the address, the first one spends from it
+    std::vector<CMutableTransaction> txs(3);
+    for (int i = 0; i < 3; i++) {
+        txs[i].vin.resize(1);
+        txs[i].vin[0].prevout = i == 0 ? funding : COutPoint(uint256S("02"), i);
+        txs[i].vout.resize(2);
+        txs[i].vout[0].scriptPubKey = script;
+        txs[i].vout[0].nValue = i * COIN;
+        txs[i].vout[1].scriptPubKey = script;
+        txs[i].vout[1].nValue = COIN;
+        const CTxMemPoolEntry tx_entry = entry.Time(i).FromTx(txs[i]);
+        pool.addUnchecked(tx_entry);
+        pool.addAddressIndex(tx_entry, view);
+        pool.addSpentIndex(tx_entry, view);
+    }
+
+    std::vector<std::pair<uint160, AddressType>> addresses{{key_id, AddressType::P2PK_OR_P2PKH}};
+    std::vector<std::pair<CMempoolAddressDeltaKey, CMempoolAddressDelta>> deltas;
+    pool.getAddressIndex(addresses, deltas);
+    BOOST_CHECK_EQUAL(deltas.size(), 7U);
+    BOOST_CHECK(pool.IndexDynamicMemoryUsage() > 0);
+
+    CSpentIndexKey spent_key(funding.hash, funding.n);
+    CSpentIndexValue spent_value;
+    BOOST_CHECK(pool.getSpentIndex(spent_key, spent_value));
+    BOOST_CHECK(spent_value.m_tx_hash == txs[0].GetHash());
+    BOOST_CHECK_EQUAL(spent_value.m_amount, 10 * COIN);
+
+    // removing entries from the middle keeps the others reachable
+    pool.removeRecursive(CTransaction(txs[0]), REMOVAL_REASON_DUMMY);
+    deltas.clear();
+    pool.getAddressIndex(addresses, deltas);
+    BOOST_CHECK_EQUAL(deltas.size(), 4U);
+    for (const auto& [key, delta] : deltas) {
+        BOOST_CHECK(key.m_tx_hash != txs[0].GetHash());
+        BOOST_CHECK(!key.m_tx_spent);
+    }
+    BOOST_CHECK(!pool.getSpentIndex(spent_key, spent_value));
+
+    pool.removeRecursive(CTransaction(txs[2]), REMOVAL_REASON_DUMMY);
+    deltas.clear();
+    pool.getAddressIndex(addresses, deltas);
+    BOOST_CHECK_EQUAL(deltas.size(), 2U);
+    BOOST_CHECK_EQUAL(deltas[0].second.m_time.count() + deltas[1].second.m_time.count(), 2);
+
+    pool.removeRecursive(CTransaction(txs[1]), REMOVAL_REASON_DUMMY);
+    deltas.clear();
+    pool.getAddressIndex(addresses, deltas);
+    BOOST_CHECK(deltas.empty());
+}
+
 BOOST_AUTO_TEST_CASE(MempoolAncestryTests)
 {
     size_t ancestors, descendants;
@@ -230,6 +230,17 @@ BOOST_AUTO_TEST_CASE(merkle_test)
             BOOST_CHECK((newRoot == uint256()) == (ntx == 0));
             BOOST_CHECK(oldMutated == newMutated);
             BOOST_CHECK(newMutated == !!mutate);
+            // The level by level tree has the same root, and as many nodes as the old one.
+            if (ntx3 > 0) {
+                std::vector<uint256> leaves;
+                for (const auto& tx : block.vtx) leaves.push_back(tx->GetHash());
+                const auto levels = ComputeMerkleTree(leaves);
+                size_t nodes = 0;
+                for (const auto& level : levels) nodes += level.size();
+                BOOST_CHECK(levels.back().size() == 1 && levels.back()[0] == newRoot);
+                BOOST_CHECK(levels.front() == leaves);
+                BOOST_CHECK_EQUAL(nodes, merkleTree.size());
+            }
             // If no mutation was done (once for every ntx value), try up to 16 branches.
             if (mutate == 0) {
                 for (int loop = 0; loop < std::min(ntx, 16); loop++) {
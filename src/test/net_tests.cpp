@@ -11,6 +11,7 @@
 #include <net.h>
 #include <netaddress.h>
 #include <netbase.h>
+#include <protocol.h>
 #include <serialize.h>
 #include <span.h>
 #include <streams.h>
@@ -21,9 +22,12 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <algorithm>
 #include <cstdint>
+#include <cstring>
 #include <ios>
 #include <memory>
+#include <optional>
 #include <string>
 
 using namespace std::literals;
@@ -844,5 +848,75 @@ BOOST_AUTO_TEST_CASE(LocalAddress_BasicLifecycle)
     BOOST_CHECK_EQUAL(IsLocal(addr), false);
 }
 
+BOOST_AUTO_TEST_CASE(recv_buffer_pool)
+{
+    CNetRecvBufferPool pool;
+    CDataStream buf{pool.Get(100, SER_NETWORK, PROTOCOL_VERSION)};
+    BOOST_CHECK(buf.empty());
+    BOOST_CHECK_EQUAL(buf.capacity(), 128U);
+    buf.resize(100);
+    const auto* data = buf.data();
+    pool.Put(std::move(buf));
+
+    // The next message of the same size class gets the same buffer
+    CDataStream reused{pool.Get(65, SER_NETWORK, PROTOCOL_VERSION)};
+    BOOST_CHECK(reused.empty());
+    reused.resize(65);
+    BOOST_CHECK(reused.data() == data);
+    // The pool is empty again
+    BOOST_CHECK_EQUAL(pool.Get(128, SER_NETWORK, PROTOCOL_VERSION).capacity(), 128U);
+
+    // Buffers which grew with a large message aren't kept
+    CDataStream large{pool.Get(MAX_PROTOCOL_MESSAGE_LENGTH, SER_NETWORK, PROTOCOL_VERSION)};
+    BOOST_CHECK_EQUAL(large.capacity(), 256U << 10);
+    large.resize(1 << 20);
+    pool.Put(std::move(large));
+    BOOST_CHECK_EQUAL(pool.Get(300000, SER_NETWORK, PROTOCOL_VERSION).capacity(), 256U << 10);
+}
+
+BOOST_AUTO_TEST_CASE(recv_payload_in_place)
+{
+    CNetRecvBufferPool pool;
+    V1TransportDeserializer deserializer{Params(), 0, SER_NETWORK, INIT_PROTO_VERSION, &pool};
+    BOOST_CHECK(deserializer.GetPayloadBuffer().empty());
+
+    CSerializedNetMsg msg;
+    msg.command = NetMsgType::PING;
+    msg.data.resize(300);
+    for (size_t i = 0; i < msg.data.size(); ++i) {
+        msg.data[i] = i;
+    }
+    std::vector<unsigned char> header;
+    V1TransportSerializer{}.prepareForTransport(msg, header);
+
+    Span<const uint8_t> header_bytes{header};
+    BOOST_CHECK_EQUAL(deserializer.Read(header_bytes), CMessageHeader::HEADER_SIZE);
+    BOOST_CHECK(header_bytes.empty());
+
+    // Receive the first part of the payload the usual way, the rest right into the message buffer
+    Span<const uint8_t> first_bytes{Span{msg.data}.first(100)};
+    BOOST_CHECK_EQUAL(deserializer.Read(first_bytes), 100);
+    const Span<uint8_t> payload = deserializer.GetPayloadBuffer();
+    BOOST_REQUIRE_EQUAL(payload.size(), 200U);
+    memcpy(payload.data(), msg.data.data() + 100, 200);
+    BOOST_CHECK(!deserializer.Complete());
+    deserializer.PayloadReceived(200);
+    BOOST_CHECK(deserializer.Complete());
+
+    uint32_t out_err_raw_size{0};
+    std::optional<CNetMessage> result{deserializer.GetMessage(0, out_err_raw_size)};
+    BOOST_REQUIRE(result);
+    BOOST_CHECK_EQUAL(result->m_command, NetMsgType::PING);
+    BOOST_CHECK_EQUAL(result->m_message_size, 300U);
+    BOOST_CHECK(std::equal(result->m_recv.begin(), result->m_recv.end(), MakeByteSpan(msg.data).begin(), MakeByteSpan(msg.data).end()));
+
+    // The buffer goes back to the pool once the message is processed
+    const auto* data = result->m_recv.data();
+    result.reset();
+    CDataStream reused{pool.Get(300, SER_NETWORK, PROTOCOL_VERSION)};
+    reused.resize(1);
+    BOOST_CHECK(reused.data() == data);
+}
+
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,55 @@
+// Copyright (c) 2026 The Dash Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <test/util/setup_common.h>
+#include <util/perfcounters.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+BOOST_FIXTURE_TEST_SUITE(perfcounters_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(histogram_buckets)
+{
+    perf::Histogram histogram;
+    for (const int64_t micros : std::vector<int64_t>{0, 1, 2, 3, 4, 1000, std::numeric_limits<int64_t>::max() / 2}) {
+        histogram.Observe(micros);
+    }
+    const auto snapshot = histogram.Get();
+    BOOST_CHECK_EQUAL(snapshot.count, 7U);
+    BOOST_CHECK_EQUAL(snapshot.buckets[0], 1U); // 0
+    BOOST_CHECK_EQUAL(snapshot.buckets[1], 1U); // 1
+    BOOST_CHECK_EQUAL(snapshot.buckets[2], 2U); // 2, 3
+    BOOST_CHECK_EQUAL(snapshot.buckets[3], 1U); // 4
+    BOOST_CHECK_EQUAL(snapshot.buckets[10], 1U); // 1000 < 1024
+    BOOST_CHECK_EQUAL(snapshot.buckets[perf::Histogram::BUCKETS - 1], 1U);
+}
+
+BOOST_AUTO_TEST_CASE(registry)
+{
+    perf::Counter& counter = perf::GetCounter("test.perfcounters.counter", "A test counter");
+    BOOST_CHECK_EQUAL(&counter, &perf::GetCounter("test.perfcounters.counter", "A test counter"));
+    counter.Add(3);
+    perf::GetGauge("test.perfcounters.gauge", "A test gauge").Set(-5);
+    perf::GetHistogram("test.perfcounters.histogram", "A test histogram").Observe(1500000);
+
+    const auto metrics = perf::GetSnapshot();
+    BOOST_CHECK(std::is_sorted(metrics.begin(), metrics.end(), [](const auto& a, const auto& b) { return a.name < b.name; }));
+    const auto it = std::find_if(metrics.begin(), metrics.end(), [](const auto& metric) { return metric.name == "test.perfcounters.counter"; });
+    BOOST_REQUIRE(it != metrics.end());
+    BOOST_CHECK(it->type == perf::MetricType::COUNTER);
+    BOOST_CHECK_EQUAL(it->value, 3);
+
+    const std::string text = perf::FormatPrometheus(metrics);
+    BOOST_CHECK(text.find("# TYPE dash_test_perfcounters_counter counter\ndash_test_perfcounters_counter 3\n") != std::string::npos);
+    BOOST_CHECK(text.find("dash_test_perfcounters_gauge -5\n") != std::string::npos);
+    BOOST_CHECK(text.find("dash_test_perfcounters_histogram_bucket{le=\"1.04858\"} 0\n") != std::string::npos);
+    BOOST_CHECK(text.find("dash_test_perfcounters_histogram_bucket{le=\"2.09715\"} 1\n") != std::string::npos);
+    BOOST_CHECK(text.find("dash_test_perfcounters_histogram_sum 1.5\ndash_test_perfcounters_histogram_count 1\n") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
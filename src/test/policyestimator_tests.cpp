@@ -2,10 +2,14 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include <clientversion.h>
+#include <fs.h>
 #include <policy/fees.h>
 #include <policy/policy.h>
 #include <txmempool.h>
+#include <streams.h>
 #include <uint256.h>
+#include <util/system.h>
 #include <util/time.h>
 
 #include <test/util/setup_common.h>
@@ -178,6 +182,23 @@ BOOST_AUTO_TEST_CASE(BlockPolicyEstimates)
     for (int i = 2; i < 9; i++) { // At 9, the original estimate was already at the bottom (b/c scale = 2)
         BOOST_CHECK(feeEst.estimateFee(i).GetFeePerK() < origFeeEst[i-1] - deltaFee);
     }
+
+    // The estimates survive a round trip through the estimates file
+    const fs::path est_path = GetDataDir() / "fee_estimates_test.dat";
+    {
+        CAutoFile est_file(fsbridge::fopen(est_path, "wb"), SER_DISK, CLIENT_VERSION);
+        BOOST_CHECK(feeEst.Write(est_file));
+    }
+    CBlockPolicyEstimator readFeeEst;
+    {
+        CAutoFile est_file(fsbridge::fopen(est_path, "rb"), SER_DISK, CLIENT_VERSION);
+        BOOST_CHECK(readFeeEst.Read(est_file));
+    }
+    for (int i = 1; i < 10; i++) {
+        BOOST_CHECK(readFeeEst.estimateFee(i) == feeEst.estimateFee(i));
+        BOOST_CHECK(readFeeEst.estimateRawFee(i, 0.95, FeeEstimateHorizon::LONG_HALFLIFE) ==
+                    feeEst.estimateRawFee(i, 0.95, FeeEstimateHorizon::LONG_HALFLIFE));
+    }
 }
 
 BOOST_AUTO_TEST_SUITE_END()
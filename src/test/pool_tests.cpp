@@ -0,0 +1,83 @@
+// Copyright (c) 2026 The Dash Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <memusage.h>
+#include <support/allocators/pool.h>
+#include <test/util/setup_common.h>
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(pool_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(pool_resource_reuse)
+{
+    PoolResource<64, 8> resource(1024);
+    BOOST_CHECK_EQUAL(resource.NumAllocatedChunks(), 1U);
+    BOOST_CHECK_EQUAL(resource.ChunkSizeBytes(), 1024U);
+
+    // Blocks come out of the chunk one after another, freed ones are handed out again
+    void* a = resource.Allocate(8, 8);
+    void* b = resource.Allocate(8, 8);
+    BOOST_CHECK_EQUAL(static_cast<std::byte*>(b) - static_cast<std::byte*>(a), 8);
+    resource.Deallocate(a, 8, 8);
+    BOOST_CHECK_EQUAL(resource.Allocate(8, 8), a);
+
+    // Sizes are rounded up to the alignment, blocks of 16 bytes have their own free list
+    void* c = resource.Allocate(9, 8);
+    resource.Deallocate(c, 16, 8);
+    BOOST_CHECK(resource.Allocate(8, 8) != c);
+    BOOST_CHECK_EQUAL(resource.Allocate(16, 8), c);
+
+    // Too large or too strictly aligned blocks don't use the pool
+    void* d = resource.Allocate(128, 8);
+    void* e = resource.Allocate(8, 64);
+    BOOST_CHECK(reinterpret_cast<std::uintptr_t>(e) % 64 == 0);
+    resource.Deallocate(d, 128, 8);
+    resource.Deallocate(e, 8, 64);
+    BOOST_CHECK_EQUAL(resource.NumAllocatedChunks(), 1U);
+
+    // A new chunk is allocated once the first one is used up
+    for (int i = 0; i < 1024 / 64; ++i) {
+        resource.Allocate(64, 8);
+    }
+    BOOST_CHECK_EQUAL(resource.NumAllocatedChunks(), 2U);
+}
+
+BOOST_AUTO_TEST_CASE(pool_allocator_unordered_map)
+{
+    using Map = std::unordered_map<uint64_t, uint64_t, std::hash<uint64_t>, std::equal_to<uint64_t>,
+                                   PoolAllocator<std::pair<const uint64_t, uint64_t>, sizeof(std::pair<const uint64_t, uint64_t>) + sizeof(void*) * 4>>;
+    Map::allocator_type::ResourceType resource;
+    Map map{0, std::hash<uint64_t>{}, std::equal_to<uint64_t>{}, &resource};
+
+    for (uint64_t i = 0; i < 100000; ++i) {
+        map[i] = i * 2;
+    }
+    for (uint64_t i = 0; i < 100000; i += 2) {
+        map.erase(i);
+    }
+    const size_t chunks = resource.NumAllocatedChunks();
+    BOOST_CHECK(chunks > 1);
+
+    // Erased nodes are reused, inserting as many again doesn't take more memory
+    for (uint64_t i = 0; i < 100000; i += 2) {
+        map[i] = i * 2;
+    }
+    BOOST_CHECK_EQUAL(resource.NumAllocatedChunks(), chunks);
+    BOOST_CHECK_EQUAL(map.size(), 100000U);
+    for (uint64_t i = 0; i < 100000; ++i) {
+        BOOST_CHECK_EQUAL(map.at(i), i * 2);
+    }
+
+    // The memory usage accounts for the chunks, not for the entries in the map
+    BOOST_CHECK(memusage::DynamicUsage(map) >= chunks * resource.ChunkSizeBytes());
+    map.clear();
+    BOOST_CHECK(memusage::DynamicUsage(map) >= chunks * resource.ChunkSizeBytes());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
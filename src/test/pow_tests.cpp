@@ -6,9 +6,13 @@
 #include <chainparams.h>
 #include <pow.h>
 #include <test/util/setup_common.h>
+#include <uint256.h>
 
 #include <boost/test/unit_test.hpp>
 
+#include <limits>
+#include <vector>
+
 BOOST_FIXTURE_TEST_SUITE(pow_tests, BasicTestingSetup)
 
 /* Test calculation of next difficulty target with DGW */
@@ -254,4 +258,86 @@ BOOST_AUTO_TEST_CASE(GetBlockProofEquivalentTime_test)
     }
 }
 
+BOOST_AUTO_TEST_CASE(block_header_hash_cache)
+{
+    CBlockHeader header;
+    header.nVersion = 1;
+    header.hashPrevBlock = InsecureRand256();
+    header.hashMerkleRoot = InsecureRand256();
+    header.nTime = 1;
+    header.nBits = 0x207fffff;
+
+    const uint256 hash = header.GetHash();
+    BOOST_CHECK_EQUAL(header.GetHash(), hash);
+    BOOST_CHECK_EQUAL(header.GetHash(), header.GetX16RHash());
+
+    // Copies carry the memoized hash, and any field change invalidates it
+    CBlockHeader copy = header;
+    BOOST_CHECK_EQUAL(copy.GetHash(), hash);
+    copy.nNonce++;
+    BOOST_CHECK(copy.GetHash() != hash);
+    BOOST_CHECK_EQUAL(copy.GetHash(), copy.GetX16RHash());
+    copy.nNonce--;
+    BOOST_CHECK_EQUAL(copy.GetHash(), hash);
+
+    // A seeded hash is trusted until the header changes
+    const uint256 fake = InsecureRand256();
+    copy.SetKnownHash(fake);
+    BOOST_CHECK_EQUAL(copy.GetHash(), fake);
+    copy.hashMerkleRoot = InsecureRand256();
+    BOOST_CHECK_EQUAL(copy.GetHash(), copy.GetX16RHash());
+
+    CBlock block(header);
+    BOOST_CHECK_EQUAL(block.GetHash(), hash);
+    BOOST_CHECK_EQUAL(block.GetBlockHeader().GetHash(), hash);
+    block.SetNull();
+    BOOST_CHECK(block.GetHash() != hash);
+}
+
+BOOST_AUTO_TEST_CASE(pow_window_matches_block_index)
+{
+    const auto chainParams = CreateChainParams(*m_node.args, CBaseChainParams::MAIN);
+    for (const bool dgw : {true, false}) {
+        Consensus::Params params = chainParams->GetConsensus();
+        params.nMinimumDifficultyBlocks = 0;
+        params.fPowAllowMinDifficultyBlocks = false;
+        params.fPowNoRetargeting = false;
+        params.nPowKGWHeight = 0;
+        params.nPowDGWHeight = dgw ? 0 : std::numeric_limits<int>::max();
+        // A copy lives elsewhere, so the window never answers for it
+        const Consensus::Params walk_params = params;
+
+        // Blocks 0-299 form one chain, blocks 300-399 fork off block 149
+        std::vector<uint256> hashes(400);
+        std::vector<CBlockIndex> blocks(400);
+        for (size_t i = 0; i < blocks.size(); ++i) {
+            CBlockIndex& block = blocks[i];
+            block.pprev = i == 0 ? nullptr : i == 300 ? &blocks[149] : &blocks[i - 1];
+            block.nHeight = block.pprev ? block.pprev->nHeight + 1 : 0;
+            block.nTime = 1600000000 + block.nHeight * 60 + InsecureRandRange(120);
+            block.nBits = 0x1c0f0000 + InsecureRandRange(0xffff);
+            hashes[i] = InsecureRand256();
+            block.phashBlock = &hashes[i];
+            block.BuildSkip();
+        }
+
+        CBlockHeader header;
+        auto check = [&](const CBlockIndex* tip) {
+            g_pow_window.SetTip(tip, params);
+            header.nTime = tip->nTime + 60;
+            const unsigned int expected = GetNextWorkRequired(tip, &header, walk_params);
+            BOOST_CHECK_EQUAL(g_pow_window.GetRetarget(tip, params, dgw).value(), expected);
+            BOOST_CHECK_EQUAL(GetNextWorkRequired(tip, &header, params), expected);
+            // Only the tracked tip is answered from the window
+            if (tip->pprev) BOOST_CHECK(!g_pow_window.GetRetarget(tip->pprev, params, dgw));
+        };
+
+        for (size_t i = 0; i < 300; ++i) check(&blocks[i]);
+        for (size_t i = 299; i-- > 149;) check(&blocks[i]);
+        for (size_t i = 300; i < 400; ++i) check(&blocks[i]);
+        check(&blocks[299]);
+        g_pow_window.Reset();
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -8,6 +8,7 @@
 #include <node/context.h>
 #include <rpc/blockchain.h>
 #include <rpc/client.h>
+#include <rpc/request.h>
 #include <rpc/server.h>
 #include <rpc/util.h>
 #include <test/util/setup_common.h>
@@ -295,6 +296,23 @@ BOOST_AUTO_TEST_CASE(json_parse_errors)
     BOOST_CHECK_THROW(ParseNonRFCJSONValue("3J98t1WpEZ73CNmQviecrnyiWrnqRhWNL"), std::runtime_error);
 }
 
+BOOST_AUTO_TEST_CASE(rpc_reply)
+{
+    // JSONRPCReply writes the reply directly, it must match the reply object
+    UniValue result(UniValue::VOBJ);
+    result.pushKV("tx", ParseNonRFCJSONValue("[\"ab\\\"c\", 1.5, true, null, {\"x\": []}]"));
+    const UniValue error = JSONRPCError(RPC_MISC_ERROR, "fail\n");
+    for (const UniValue& id : {NullUniValue, UniValue{7}, UniValue{"id"}}) {
+        BOOST_CHECK_EQUAL(JSONRPCReply(result, NullUniValue, id), JSONRPCReplyObj(result, NullUniValue, id).write() + "\n");
+        BOOST_CHECK_EQUAL(JSONRPCReply(result, error, id), JSONRPCReplyObj(result, error, id).write() + "\n");
+    }
+
+    // Writing appends to the string
+    std::string str{"x"};
+    result.write(str);
+    BOOST_CHECK_EQUAL(str, "x" + result.write());
+}
+
 BOOST_AUTO_TEST_CASE(rpc_ban)
 {
     BOOST_CHECK_NO_THROW(CallRPC(std::string("clearbanned")));
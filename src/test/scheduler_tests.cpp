@@ -4,10 +4,12 @@
 
 #include <random.h>
 #include <scheduler.h>
+#include <util/perfcounters.h>
 #include <util/time.h>
 
 #include <boost/test/unit_test.hpp>
 
+#include <atomic>
 #include <functional>
 #include <mutex>
 #include <thread>
@@ -212,4 +214,34 @@ BOOST_AUTO_TEST_CASE(mockforward)
 }
 */
 
+BOOST_AUTO_TEST_CASE(named_repeating_task)
+{
+    CScheduler scheduler;
+    scheduler.StartServiceThreads("test", 4);
+
+    // With several service threads, a repeating task still never runs concurrently with itself
+    std::atomic<int> running{0};
+    std::atomic<int> runs{0};
+    std::atomic<bool> overlapped{false};
+    scheduler.scheduleEvery([&] {
+        if (running++ != 0) overlapped = true;
+        UninterruptibleSleep(std::chrono::milliseconds{2});
+        --running;
+        ++runs;
+    }, std::chrono::milliseconds{1}, "test_repeating");
+
+    while (runs < 5) {
+        UninterruptibleSleep(std::chrono::milliseconds{1});
+    }
+    scheduler.stop();
+    BOOST_CHECK(!scheduler.AreThreadsServicingQueue());
+    BOOST_CHECK(!overlapped);
+
+    const auto runtime = perf::GetHistogram("scheduler.test_repeating.runtime", "").Get();
+    const auto lateness = perf::GetHistogram("scheduler.test_repeating.lateness", "").Get();
+    BOOST_CHECK_GE(runtime.count, 5U);
+    BOOST_CHECK_EQUAL(runtime.count, lateness.count);
+    BOOST_CHECK_GE(runtime.sum, 5 * 2000);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -7,6 +7,7 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <algorithm>
 #include <mutex>
 #include <stdexcept>
 
@@ -140,4 +141,37 @@ BOOST_AUTO_TEST_CASE(double_lock_recursive_mutex)
 }
 #endif /* DEBUG_LOCKORDER */
 
+BOOST_AUTO_TEST_CASE(lock_stats)
+{
+    Mutex mutex;
+    lockstats::Reset();
+    lockstats::g_enabled = true;
+    for (int i = 0; i < 3; ++i) {
+        LOCK(mutex);
+    }
+    {
+        TRY_LOCK(mutex, locked);
+        if (!locked) BOOST_ERROR("TRY_LOCK failed");
+    }
+    lockstats::g_enabled = false;
+    {
+        LOCK(mutex);
+    }
+
+    const auto stats = lockstats::GetStats();
+    const auto count_locks = [&](const std::string& name) {
+        uint64_t locks{0};
+        for (const auto& site : stats) {
+            if (site.name == name && site.file == __FILE__) locks += site.locks;
+        }
+        return locks;
+    };
+    // the loop and the TRY_LOCK, not the one after profiling was turned off
+    BOOST_CHECK_EQUAL(count_locks("mutex"), 4U);
+    BOOST_CHECK(std::all_of(stats.begin(), stats.end(), [](const auto& site) { return site.max_hold_ns <= site.hold_ns; }));
+
+    lockstats::Reset();
+    BOOST_CHECK(lockstats::GetStats().empty());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
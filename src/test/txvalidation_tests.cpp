@@ -10,6 +10,7 @@
 #include <script/script.h>
 #include <script/standard.h>
 #include <test/util/setup_common.h>
+#include <util/string.h>
 #include <validation.h>
 
 #include <boost/test/unit_test.hpp>
@@ -144,4 +145,68 @@ BOOST_FIXTURE_TEST_CASE(package_tests, TestChain100Setup)
     // Check that mempool size hasn't changed.
     BOOST_CHECK_EQUAL(m_node.mempool->size(), initialPoolSize);
 }
+
+BOOST_FIXTURE_TEST_CASE(batch_accept_tests, TestChain100Setup)
+{
+    LOCK(cs_main);
+    unsigned int initialPoolSize = m_node.mempool->size();
+
+    CKey key;
+    key.MakeNewKey(true);
+    CScript locking_script = GetScriptForDestination(PKHash(key.GetPubKey()));
+
+    CTransactionRef tx_parent = MakeTransactionRef(CreateValidMempoolTransaction(m_coinbase_txns[0], 0, 0, coinbaseKey, locking_script, CAmount(49 * COIN), /* submit */ false));
+    // Spends the parent, accepted after the batch
+    CTransactionRef tx_child = MakeTransactionRef(CreateValidMempoolTransaction(tx_parent, 0, 101, key, locking_script, CAmount(48 * COIN), /* submit */ false));
+    // Spends the same coin as the parent
+    CTransactionRef tx_conflict = MakeTransactionRef(CreateValidMempoolTransaction(m_coinbase_txns[0], 0, 0, coinbaseKey, locking_script, CAmount(48 * COIN), /* submit */ false));
+    CTransactionRef tx_independent = MakeTransactionRef(CreateValidMempoolTransaction(m_coinbase_txns[1], 0, 0, coinbaseKey, locking_script, CAmount(49 * COIN), /* submit */ false));
+    // Changing the output after signing makes the signature invalid
+    CMutableTransaction mtx_bad_sig = CreateValidMempoolTransaction(m_coinbase_txns[2], 0, 0, coinbaseKey, locking_script, CAmount(49 * COIN), /* submit */ false);
+    mtx_bad_sig.vout[0].nValue -= 1;
+    CTransactionRef tx_bad_sig = MakeTransactionRef(mtx_bad_sig);
+
+    const auto results = AcceptToMemoryPoolBatch(m_node.chainman->ActiveChainstate(), *m_node.mempool,
+                                                 {tx_parent, tx_bad_sig, tx_child, tx_conflict, tx_independent});
+    BOOST_REQUIRE_EQUAL(results.size(), 5U);
+    BOOST_CHECK(results[0].m_result_type == MempoolAcceptResult::ResultType::VALID);
+    BOOST_CHECK(results[1].m_result_type == MempoolAcceptResult::ResultType::INVALID);
+    BOOST_CHECK(results[1].m_state.GetRejectReason().find("mandatory-script-verify-flag-failed") == 0);
+    BOOST_CHECK(results[2].m_result_type == MempoolAcceptResult::ResultType::VALID);
+    BOOST_CHECK(results[3].m_result_type == MempoolAcceptResult::ResultType::INVALID);
+    BOOST_CHECK_EQUAL(results[3].m_state.GetRejectReason(), "txn-mempool-conflict");
+    BOOST_CHECK(results[4].m_result_type == MempoolAcceptResult::ResultType::VALID);
+
+    BOOST_CHECK_EQUAL(m_node.mempool->size(), initialPoolSize + 3);
+    BOOST_CHECK(m_node.mempool->exists(tx_parent->GetHash()));
+    BOOST_CHECK(m_node.mempool->exists(tx_child->GetHash()));
+    BOOST_CHECK(m_node.mempool->exists(tx_independent->GetHash()));
+}
+
+BOOST_FIXTURE_TEST_CASE(batch_accept_evicted_parent_tests, TestChain100Setup)
+{
+    LOCK(cs_main);
+
+    CKey key;
+    key.MakeNewKey(true);
+    CScript locking_script = GetScriptForDestination(PKHash(key.GetPubKey()));
+
+    CTransactionRef tx_parent = MakeTransactionRef(CreateValidMempoolTransaction(m_coinbase_txns[0], 0, 0, coinbaseKey, locking_script, CAmount(49 * COIN), /* submit */ true));
+    BOOST_REQUIRE(m_node.mempool->exists(tx_parent->GetHash()));
+    CTransactionRef tx_first = MakeTransactionRef(CreateValidMempoolTransaction(m_coinbase_txns[1], 0, 0, coinbaseKey, locking_script, CAmount(49 * COIN), /* submit */ false));
+    CTransactionRef tx_child = MakeTransactionRef(CreateValidMempoolTransaction(tx_parent, 0, 101, key, locking_script, CAmount(48 * COIN), /* submit */ false));
+
+    // With no room in the mempool, adding the first member of the batch evicts the parent of the second
+    gArgs.ForceSetArg("-maxmempool", "0");
+    const auto results = AcceptToMemoryPoolBatch(m_node.chainman->ActiveChainstate(), *m_node.mempool, {tx_first, tx_child});
+    gArgs.ForceSetArg("-maxmempool", ToString(DEFAULT_MAX_MEMPOOL_SIZE));
+
+    BOOST_REQUIRE_EQUAL(results.size(), 2U);
+    BOOST_CHECK(results[0].m_result_type == MempoolAcceptResult::ResultType::INVALID);
+    BOOST_CHECK_EQUAL(results[0].m_state.GetRejectReason(), "mempool full");
+    BOOST_CHECK(results[1].m_result_type == MempoolAcceptResult::ResultType::INVALID);
+    BOOST_CHECK_EQUAL(results[1].m_state.GetRejectReason(), "bad-txns-inputs-missingorspent");
+    BOOST_CHECK(!m_node.mempool->exists(tx_parent->GetHash()));
+    BOOST_CHECK_EQUAL(m_node.mempool->size(), 0U);
+}
 BOOST_AUTO_TEST_SUITE_END()
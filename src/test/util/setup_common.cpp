@@ -115,6 +115,7 @@ void DashTestSetup(NodeContext& node)
     node.coinjoin_loader = interfaces::MakeCoinJoinLoader(*node.cj_ctx->walletman);
 #endif // ENABLE_WALLET
     node.llmq_ctx = std::make_unique<LLMQContext>(chainstate, *node.connman, *node.evodb, *node.sporkman, *node.mempool, node.peerman, true, false);
+    node.llmq_ctx->quorum_block_processor->LoadMinedCommitments();
 }
 
 void DashTestSetupClose(NodeContext& node)
@@ -235,6 +236,7 @@ ChainTestingSetup::ChainTestingSetup(const std::string& chainName, const std::ve
     // Start script-checking threads. Set g_parallel_script_checks to true so they are used.
     constexpr int script_check_threads = 2;
     StartScriptCheckWorkerThreads(script_check_threads);
+    StartProTxSigCheckWorkerThreads(script_check_threads);
     g_parallel_script_checks = true;
 }
 
@@ -242,6 +244,7 @@ ChainTestingSetup::~ChainTestingSetup()
 {
     m_node.scheduler->stop();
     StopScriptCheckWorkerThreads();
+    StopProTxSigCheckWorkerThreads();
     GetMainSignals().FlushBackgroundCallbacks();
     GetMainSignals().UnregisterBackgroundSignalScheduler();
     m_node.netfulfilledman = nullptr;
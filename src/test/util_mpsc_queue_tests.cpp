@@ -0,0 +1,66 @@
+// Copyright (c) 2026 The Dash Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <test/util/setup_common.h>
+#include <util/mpsc_queue.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+BOOST_FIXTURE_TEST_SUITE(util_mpsc_queue_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(mpsc_queue_order)
+{
+    MPSCQueue<std::unique_ptr<int>> queue;
+    BOOST_CHECK(queue.Empty());
+    BOOST_CHECK(queue.PopAll().empty());
+
+    for (int i = 0; i < 3; ++i) {
+        queue.Push(std::make_unique<int>(i));
+    }
+    BOOST_CHECK(!queue.Empty());
+    auto items = queue.PopAll();
+    BOOST_CHECK(queue.Empty());
+    BOOST_REQUIRE_EQUAL(items.size(), 3U);
+    for (int i = 0; i < 3; ++i) {
+        BOOST_CHECK_EQUAL(*items[i], i);
+    }
+
+    // Whatever is left gets freed along with the queue
+    queue.Push(std::make_unique<int>(3));
+}
+
+BOOST_AUTO_TEST_CASE(mpsc_queue_concurrent_producers)
+{
+    constexpr int PRODUCERS = 4;
+    constexpr int ITEMS = 10000;
+
+    MPSCQueue<std::pair<int, int>> queue;
+    std::vector<std::thread> threads;
+    for (int p = 0; p < PRODUCERS; ++p) {
+        threads.emplace_back([&queue, p] {
+            for (int i = 0; i < ITEMS; ++i) {
+                queue.Push({p, i});
+            }
+        });
+    }
+
+    // Drain while the producers are still busy; every producer's items come out in order, none twice
+    std::vector<int> next(PRODUCERS, 0);
+    int received = 0;
+    while (received < PRODUCERS * ITEMS) {
+        for (const auto& [p, i] : queue.PopAll()) {
+            BOOST_REQUIRE_EQUAL(i, next[p]);
+            ++next[p];
+            ++received;
+        }
+    }
+    for (auto& t : threads) t.join();
+    BOOST_CHECK(queue.Empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
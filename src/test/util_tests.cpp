@@ -11,6 +11,7 @@
 #include <test/util/logging.h>
 #include <test/util/setup_common.h>
 #include <test/util/str.h>
+#include <threadinterrupt.h>
 #include <uint256.h>
 #include <util/getuniquepath.h>
 #include <util/message.h> // For MessageSign(), MessageVerify(), MESSAGE_MAGIC
@@ -201,6 +202,12 @@ BOOST_AUTO_TEST_CASE(util_HexStr)
         BOOST_CHECK_EQUAL(HexStr(in_u), out_exp);
         BOOST_CHECK_EQUAL(HexStr(in_s), out_exp);
         BOOST_CHECK_EQUAL(HexStr(in_b), out_exp);
+
+        std::string out(out_exp.size(), '\0');
+        HexStrTo(in_u, out.data());
+        BOOST_CHECK_EQUAL(out, out_exp);
+        HexStrTo(in_u, out.data(), /* reverse */ true);
+        BOOST_CHECK_EQUAL(out, "b0fd8a6704");
     }
 }
 
@@ -2635,4 +2642,29 @@ BOOST_AUTO_TEST_CASE(message_hash)
     BOOST_CHECK_NE(message_hash1, signature_hash);
 }
 
+BOOST_AUTO_TEST_CASE(thread_interrupt_wakeup)
+{
+    using namespace std::chrono_literals;
+    CThreadInterrupt interrupt;
+
+    // A wakeup before the sleep is not lost, and only cuts one sleep short
+    interrupt.wakeup();
+    const auto start = std::chrono::steady_clock::now();
+    BOOST_CHECK(interrupt.sleep_for(1h));
+    BOOST_CHECK(std::chrono::steady_clock::now() - start < 1min);
+    BOOST_CHECK(!interrupt);
+    BOOST_CHECK(interrupt.sleep_for(1ms));
+
+    // Waking up a sleeping thread
+    std::thread t([&] { std::this_thread::sleep_for(10ms); interrupt.wakeup(); });
+    BOOST_CHECK(interrupt.sleep_for(1h));
+    t.join();
+
+    // An interrupt is still reported as such
+    interrupt.wakeup();
+    interrupt();
+    BOOST_CHECK(!interrupt.sleep_for(1h));
+    BOOST_CHECK(interrupt);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
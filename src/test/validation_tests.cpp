@@ -2,7 +2,10 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include <chainparams.h>
+#include <evo/creditpool.h>
 #include <net.h>
+#include <primitives/block.h>
 #include <uint256.h>
 #include <validation.h>
 
@@ -35,4 +38,44 @@ BOOST_AUTO_TEST_CASE(test_assumeutxo)
     BOOST_CHECK_EQUAL(out210.nChainTx, (unsigned int)210);
 }
 
+//! HashBlockHeaders must return exactly GetHash() of every header, in order
+BOOST_AUTO_TEST_CASE(hash_block_headers)
+{
+    std::vector<CBlockHeader> headers(50);
+    for (size_t i = 0; i < headers.size(); ++i) {
+        headers[i].nVersion = 1;
+        headers[i].hashPrevBlock = InsecureRand256();
+        headers[i].hashMerkleRoot = InsecureRand256();
+        headers[i].nTime = 1;
+        headers[i].nBits = 0x207fffff;
+        headers[i].nNonce = i;
+    }
+
+    for (int threads : {0, 3}) {
+        if (threads) StartHeaderHashWorkerThreads(threads);
+        const std::vector<uint256> hashes = HashBlockHeaders(headers);
+        if (threads) StopHeaderHashWorkerThreads();
+
+        BOOST_REQUIRE_EQUAL(hashes.size(), headers.size());
+        for (size_t i = 0; i < headers.size(); ++i) {
+            BOOST_CHECK_EQUAL(hashes[i], headers[i].GetHash());
+        }
+    }
+    BOOST_CHECK(HashBlockHeaders({}).empty());
+}
+
+//! With -prunekeepquorumblocks the blocks of every active quorum are kept
+BOOST_AUTO_TEST_CASE(quorum_blocks_to_keep)
+{
+    for (const auto& network : {CBaseChainParams::MAIN, CBaseChainParams::TESTNET, CBaseChainParams::REGTEST}) {
+        const auto params = CreateChainParams(*m_node.args, network);
+        const unsigned int blocks_to_keep = GetQuorumBlocksToKeep(params->GetConsensus());
+        BOOST_CHECK(blocks_to_keep >= MIN_BLOCKS_TO_KEEP);
+        for (const auto& llmq : params->GetConsensus().llmqs) {
+            const int active_blocks = (llmq.useRotation ? 1 : llmq.signingActiveQuorumCount) * llmq.dkgInterval;
+            BOOST_CHECK(blocks_to_keep >= static_cast<unsigned int>(active_blocks + CCreditPoolManager::LimitBlocksToTrace));
+        }
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
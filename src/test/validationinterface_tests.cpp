@@ -8,8 +8,13 @@
 #include <scheduler.h>
 #include <test/util/setup_common.h>
 #include <util/check.h>
+#include <util/time.h>
 #include <validationinterface.h>
 
+#include <atomic>
+#include <future>
+#include <vector>
+
 BOOST_FIXTURE_TEST_SUITE(validationinterface_tests, ChainTestingSetup)
 
 struct TestSubscriberNoop final : public CValidationInterface {
@@ -91,4 +96,57 @@ BOOST_AUTO_TEST_CASE(unregister_all_during_call)
     BOOST_CHECK(destroyed);
 }
 
+struct TestTxSubscriber final : public CValidationInterface {
+    std::function<void()> m_on_call;
+    std::vector<uint32_t> m_seen;
+    std::atomic<size_t> m_count{0};
+    void TransactionAddedToMempool(const CTransactionRef& tx, int64_t) override
+    {
+        if (m_on_call) m_on_call();
+        m_seen.push_back(tx->nLockTime);
+        ++m_count;
+    }
+};
+
+BOOST_AUTO_TEST_CASE(parallel_subscribers)
+{
+    // Deliver on threads of their own, the chain test setup flushes and unregisters them at the end
+    m_node.scheduler->stop();
+    GetMainSignals().FlushBackgroundCallbacks();
+    GetMainSignals().UnregisterBackgroundSignalScheduler();
+    GetMainSignals().RegisterBackgroundSignalScheduler(*m_node.scheduler, 2);
+
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future();
+    auto slow = std::make_shared<TestTxSubscriber>();
+    slow->m_on_call = [released] { released.wait(); };
+    auto fast = std::make_shared<TestTxSubscriber>();
+    RegisterSharedValidationInterface(slow);
+    RegisterSharedValidationInterface(fast);
+
+    std::vector<uint32_t> expected;
+    for (uint32_t i = 0; i < 10; ++i) {
+        CMutableTransaction mtx;
+        mtx.nLockTime = i;
+        GetMainSignals().TransactionAddedToMempool(MakeTransactionRef(mtx), 0);
+        expected.push_back(i);
+    }
+    // The slow subscriber is stuck in its first call, which doesn't hold up the fast one
+    for (int i = 0; i < 1000 && fast->m_count < expected.size(); ++i) {
+        UninterruptibleSleep(std::chrono::milliseconds{5});
+    }
+    BOOST_CHECK_EQUAL(fast->m_count, expected.size());
+    BOOST_CHECK_EQUAL(slow->m_count, 0U);
+    BOOST_CHECK_EQUAL(GetMainSignals().CallbacksPending(), expected.size());
+
+    release.set_value();
+    SyncWithValidationInterfaceQueue();
+    BOOST_CHECK_EQUAL(GetMainSignals().CallbacksPending(), 0U);
+    BOOST_CHECK(fast->m_seen == expected);
+    BOOST_CHECK(slow->m_seen == expected);
+
+    UnregisterSharedValidationInterface(slow);
+    UnregisterSharedValidationInterface(fast);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
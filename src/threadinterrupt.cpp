@@ -27,8 +27,19 @@ void CThreadInterrupt::operator()()
     cond.notify_all();
 }
 
+void CThreadInterrupt::wakeup()
+{
+    {
+        LOCK(mut);
+        woken = true;
+    }
+    cond.notify_all();
+}
+
 bool CThreadInterrupt::sleep_for(Clock::duration rel_time)
 {
     WAIT_LOCK(mut, lock);
-    return !cond.wait_for(lock, rel_time, [this]() { return flag.load(std::memory_order_acquire); });
+    cond.wait_for(lock, rel_time, [this]() EXCLUSIVE_LOCKS_REQUIRED(mut) { return woken || flag.load(std::memory_order_acquire); });
+    woken = false;
+    return !flag.load(std::memory_order_acquire);
 }
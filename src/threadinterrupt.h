@@ -15,6 +15,10 @@
     A helper class for interruptible sleeps. Calling operator() will interrupt
     any current sleep, and after that point operator bool() will return true
     until reset.
+
+    wakeup() only cuts the current sleep short, or the next one if nobody is
+    sleeping right now, so a worker thread can wait for new work without
+    missing any.
 */
 class CThreadInterrupt
 {
@@ -24,12 +28,14 @@ public:
     explicit operator bool() const;
     void operator()();
     void reset();
+    void wakeup() EXCLUSIVE_LOCKS_REQUIRED(!mut);
     bool sleep_for(Clock::duration rel_time) EXCLUSIVE_LOCKS_REQUIRED(!mut);
 
 private:
     std::condition_variable cond;
     Mutex mut;
     std::atomic<bool> flag;
+    bool woken GUARDED_BY(mut){false};
 };
 
 #endif //BITCOIN_THREADINTERRUPT_H
@@ -11,6 +11,7 @@
 #include <shutdown.h>
 #include <uint256.h>
 #include <util/system.h>
+#include <util/thread.h>
 #include <util/translation.h>
 #include <util/vector.h>
 
@@ -19,10 +20,6 @@
 static constexpr uint8_t DB_COIN{'C'};
 static constexpr uint8_t DB_COINS{'c'};
 static constexpr uint8_t DB_BLOCK_FILES{'f'};
-static constexpr uint8_t DB_ADDRESSINDEX{'a'};
-static constexpr uint8_t DB_ADDRESSUNSPENTINDEX{'u'};
-static constexpr uint8_t DB_TIMESTAMPINDEX{'s'};
-static constexpr uint8_t DB_SPENTINDEX{'p'};
 static constexpr uint8_t DB_BLOCK_INDEX{'b'};
 
 static constexpr uint8_t DB_BEST_BLOCK{'B'};
@@ -84,7 +81,7 @@ std::vector<uint256> CCoinsViewDB::GetHeadBlocks() const {
     return vhashHeadBlocks;
 }
 
-bool CCoinsViewDB::BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock) {
+bool CCoinsViewDB::BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock, bool erase) {
     CDBBatch batch(*m_db);
     size_t count = 0;
     size_t changed = 0;
@@ -119,8 +116,7 @@ bool CCoinsViewDB::BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock) {
             changed++;
         }
         count++;
-        CCoinsMap::iterator itOld = it++;
-        mapCoins.erase(itOld);
+        it = erase ? mapCoins.erase(it) : std::next(it);
         if (batch.SizeEstimate() > batch_size) {
             LogPrint(BCLog::COINDB, "Writing partial batch of %.2f MiB\n", batch.SizeEstimate() * (1.0 / 1048576.0));
             m_db->WriteBatch(batch);
@@ -145,6 +141,125 @@ bool CCoinsViewDB::BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock) {
     return ret;
 }
 
+CCoinsViewBackgroundFlush::~CCoinsViewBackgroundFlush()
+{
+    WaitForWrite();
+}
+
+bool CCoinsViewBackgroundFlush::GetCoin(const COutPoint &outpoint, Coin &coin) const
+{
+    {
+        LOCK(m_mutex);
+        if (m_snapshot) {
+            CCoinsMap::const_iterator it = m_snapshot->find(outpoint);
+            if (it != m_snapshot->end()) {
+                coin = it->second.coin;
+                return !coin.IsSpent();
+            }
+        }
+    }
+    return base->GetCoin(outpoint, coin);
+}
+
+bool CCoinsViewBackgroundFlush::HaveCoin(const COutPoint &outpoint) const
+{
+    {
+        LOCK(m_mutex);
+        if (m_snapshot) {
+            CCoinsMap::const_iterator it = m_snapshot->find(outpoint);
+            if (it != m_snapshot->end()) {
+                return !it->second.coin.IsSpent();
+            }
+        }
+    }
+    return base->HaveCoin(outpoint);
+}
+
+uint256 CCoinsViewBackgroundFlush::GetBestBlock() const
+{
+    {
+        LOCK(m_mutex);
+        if (m_snapshot) {
+            return m_snapshot_block;
+        }
+    }
+    return base->GetBestBlock();
+}
+
+void CCoinsViewBackgroundFlush::WriteNextInBackground(std::function<bool()> after_write)
+{
+    m_after_write = std::move(after_write);
+}
+
+bool CCoinsViewBackgroundFlush::WaitForWrite()
+{
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+    return !m_write_failed;
+}
+
+size_t CCoinsViewBackgroundFlush::DynamicMemoryUsage() const
+{
+    LOCK(m_mutex);
+    return m_snapshot_usage;
+}
+
+bool CCoinsViewBackgroundFlush::BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock, bool erase)
+{
+    if (!WaitForWrite()) {
+        return false;
+    }
+    if (!m_after_write) {
+        return base->BatchWrite(mapCoins, hashBlock, erase);
+    }
+
+    // The entries of mapCoins are allocated from the resource of the cache, which goes on using it, so the
+    // changes are copied into a map of their own
+    auto resource = std::make_unique<CCoinsMapMemoryResource>();
+    auto snapshot = std::make_unique<CCoinsMap>(0, SaltedOutpointHasher(), CCoinsMap::key_equal{}, resource.get());
+    size_t coins_usage{0};
+    for (CCoinsMap::iterator it = mapCoins.begin(); it != mapCoins.end();) {
+        if (it->second.flags & CCoinsCacheEntry::DIRTY) {
+            coins_usage += it->second.coin.DynamicMemoryUsage();
+            snapshot->emplace(std::piecewise_construct, std::forward_as_tuple(it->first),
+                std::forward_as_tuple(erase ? std::move(it->second.coin) : Coin(it->second.coin), CCoinsCacheEntry::DIRTY));
+        }
+        it = erase ? mapCoins.erase(it) : std::next(it);
+    }
+    LogPrint(BCLog::COINDB, "Writing %u changed transaction outputs of block %s in the background\n", snapshot->size(), hashBlock.ToString());
+
+    CCoinsMap& frozen = *snapshot;
+    {
+        LOCK(m_mutex);
+        m_snapshot_usage = memusage::DynamicUsage(*snapshot) + coins_usage;
+        m_snapshot = std::move(snapshot);
+        m_snapshot_resource = std::move(resource);
+        m_snapshot_block = hashBlock;
+    }
+    m_thread = std::thread(&util::TraceThread, "coinsflush", [this, &frozen, hashBlock, after_write = std::move(m_after_write)] {
+        // Without erase the map isn't changed by the write, lookups can read it meanwhile
+        bool ok{false};
+        try {
+            ok = base->BatchWrite(frozen, hashBlock, /* erase = */ false) && after_write();
+        } catch (const std::exception& e) {
+            LogPrintf("%s: %s\n", __func__, e.what());
+        }
+        if (!ok) {
+            // Keep the snapshot, the database lacks its changes
+            LogPrintf("Failed to write the coins of block %s in the background\n", hashBlock.ToString());
+            m_write_failed = true;
+            return;
+        }
+        LOCK(m_mutex);
+        m_snapshot.reset();
+        m_snapshot_resource.reset();
+        m_snapshot_usage = 0;
+    });
+    m_after_write = nullptr;
+    return true;
+}
+
 size_t CCoinsViewDB::EstimateSize() const
 {
     return m_db->EstimateSize(DB_COIN, uint8_t(DB_COIN + 1));
@@ -263,138 +378,6 @@ bool CBlockTreeDB::WriteBatchSync(const std::vector<std::pair<int, const CBlockF
     return WriteBatch(batch, true);
 }
 
-bool CBlockTreeDB::ReadSpentIndex(CSpentIndexKey &key, CSpentIndexValue &value) {
-    return Read(std::make_pair(DB_SPENTINDEX, key), value);
-}
-
-bool CBlockTreeDB::UpdateSpentIndex(const std::vector<std::pair<CSpentIndexKey, CSpentIndexValue> >&vect) {
-    CDBBatch batch(*this);
-    for (std::vector<std::pair<CSpentIndexKey,CSpentIndexValue> >::const_iterator it=vect.begin(); it!=vect.end(); it++) {
-        if (it->second.IsNull()) {
-            batch.Erase(std::make_pair(DB_SPENTINDEX, it->first));
-        } else {
-            batch.Write(std::make_pair(DB_SPENTINDEX, it->first), it->second);
-        }
-    }
-    return WriteBatch(batch);
-}
-
-bool CBlockTreeDB::UpdateAddressUnspentIndex(const std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue > >&vect) {
-    CDBBatch batch(*this);
-    for (std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> >::const_iterator it=vect.begin(); it!=vect.end(); it++) {
-        if (it->second.IsNull()) {
-            batch.Erase(std::make_pair(DB_ADDRESSUNSPENTINDEX, it->first));
-        } else {
-            batch.Write(std::make_pair(DB_ADDRESSUNSPENTINDEX, it->first), it->second);
-        }
-    }
-    return WriteBatch(batch);
-}
-
-bool CBlockTreeDB::ReadAddressUnspentIndex(uint160 addressHash, AddressType type,
-                                           std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > &unspentOutputs) {
-
-    std::unique_ptr<CDBIterator> pcursor(NewIterator());
-
-    pcursor->Seek(std::make_pair(DB_ADDRESSUNSPENTINDEX, CAddressIndexIteratorKey(type, addressHash)));
-
-    while (pcursor->Valid()) {
-        std::pair<uint8_t, CAddressUnspentKey> key;
-        if (pcursor->GetKey(key) && key.first == DB_ADDRESSUNSPENTINDEX && key.second.m_address_bytes == addressHash) {
-            CAddressUnspentValue nValue;
-            if (pcursor->GetValue(nValue)) {
-                unspentOutputs.push_back(std::make_pair(key.second, nValue));
-                pcursor->Next();
-            } else {
-                return error("failed to get address unspent value");
-            }
-        } else {
-            break;
-        }
-    }
-
-    return true;
-}
-
-bool CBlockTreeDB::WriteAddressIndex(const std::vector<std::pair<CAddressIndexKey, CAmount > >&vect) {
-    CDBBatch batch(*this);
-    for (std::vector<std::pair<CAddressIndexKey, CAmount> >::const_iterator it=vect.begin(); it!=vect.end(); it++)
-        batch.Write(std::make_pair(DB_ADDRESSINDEX, it->first), it->second);
-    return WriteBatch(batch);
-}
-
-bool CBlockTreeDB::EraseAddressIndex(const std::vector<std::pair<CAddressIndexKey, CAmount > >&vect) {
-    CDBBatch batch(*this);
-    for (std::vector<std::pair<CAddressIndexKey, CAmount> >::const_iterator it=vect.begin(); it!=vect.end(); it++)
-        batch.Erase(std::make_pair(DB_ADDRESSINDEX, it->first));
-    return WriteBatch(batch);
-}
-
-bool CBlockTreeDB::ReadAddressIndex(uint160 addressHash, AddressType type,
-                                    std::vector<std::pair<CAddressIndexKey, CAmount> > &addressIndex,
-                                    int start, int end) {
-
-    std::unique_ptr<CDBIterator> pcursor(NewIterator());
-
-    if (start > 0 && end > 0) {
-        pcursor->Seek(std::make_pair(DB_ADDRESSINDEX, CAddressIndexIteratorHeightKey(type, addressHash, start)));
-    } else {
-        pcursor->Seek(std::make_pair(DB_ADDRESSINDEX, CAddressIndexIteratorKey(type, addressHash)));
-    }
-
-    while (pcursor->Valid()) {
-        std::pair<uint8_t, CAddressIndexKey> key;
-        if (pcursor->GetKey(key) && key.first == DB_ADDRESSINDEX && key.second.m_address_bytes == addressHash) {
-            if (end > 0 && key.second.m_block_height > end) {
-                break;
-            }
-            CAmount nValue;
-            if (pcursor->GetValue(nValue)) {
-                addressIndex.push_back(std::make_pair(key.second, nValue));
-                pcursor->Next();
-            } else {
-                return error("failed to get address index value");
-            }
-        } else {
-            break;
-        }
-    }
-
-    return true;
-}
-
-bool CBlockTreeDB::WriteTimestampIndex(const CTimestampIndexKey &timestampIndex) {
-    CDBBatch batch(*this);
-    batch.Write(std::make_pair(DB_TIMESTAMPINDEX, timestampIndex), 0);
-    return WriteBatch(batch);
-}
-
-bool CBlockTreeDB::EraseTimestampIndex(const CTimestampIndexKey& timestampIndex)
-{
-    CDBBatch batch(*this);
-    batch.Erase(std::make_pair(DB_TIMESTAMPINDEX, timestampIndex));
-    return WriteBatch(batch);
-}
-
-bool CBlockTreeDB::ReadTimestampIndex(const unsigned int &high, const unsigned int &low, std::vector<uint256> &hashes) {
-
-    std::unique_ptr<CDBIterator> pcursor(NewIterator());
-
-    pcursor->Seek(std::make_pair(DB_TIMESTAMPINDEX, CTimestampIndexIteratorKey(low)));
-
-    while (pcursor->Valid()) {
-        std::pair<uint8_t, CTimestampIndexKey> key;
-        if (pcursor->GetKey(key) && key.first == DB_TIMESTAMPINDEX && key.second.m_block_time <= high) {
-            hashes.push_back(key.second.m_block_hash);
-            pcursor->Next();
-        } else {
-            break;
-        }
-    }
-
-    return true;
-}
-
 bool CBlockTreeDB::WriteFlag(const std::string &name, bool fValue) {
     return Write(std::make_pair(DB_FLAG, name), fValue ? uint8_t{'1'} : uint8_t{'0'});
 }
@@ -413,6 +396,10 @@ bool CBlockTreeDB::LoadBlockIndexGuts(const Consensus::Params& consensusParams,
 
     pcursor->Seek(std::make_pair(DB_BLOCK_INDEX, uint256()));
 
+    // The key is the block hash. Computing it from the header again runs X16R or KAWPOW for every block of the
+    // chain, which takes minutes, so it's only done on request.
+    const bool fRehash = gArgs.GetBoolArg("-checkblockindexpow", DEFAULT_CHECKBLOCKINDEXPOW);
+
     // Load m_block_index
     while (pcursor->Valid()) {
         if (ShutdownRequested()) return false;
@@ -420,8 +407,11 @@ bool CBlockTreeDB::LoadBlockIndexGuts(const Consensus::Params& consensusParams,
         if (pcursor->GetKey(key) && key.first == DB_BLOCK_INDEX) {
             CDiskBlockIndex diskindex;
             if (pcursor->GetValue(diskindex)) {
+                if (fRehash && diskindex.GetBlockHash() != key.second) {
+                    return error("%s: block hash mismatch: %s", __func__, key.second.ToString());
+                }
                 // Construct block index object
-                CBlockIndex* pindexNew = insertBlockIndex(diskindex.GetBlockHash());
+                CBlockIndex* pindexNew = insertBlockIndex(key.second);
                 pindexNew->pprev          = insertBlockIndex(diskindex.hashPrev);
                 pindexNew->nHeight        = diskindex.nHeight;
                 pindexNew->nFile          = diskindex.nFile;
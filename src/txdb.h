@@ -11,9 +11,13 @@
 #include <chain.h>
 #include <primitives/block.h>
 #include <spentindex.h>
+#include <sync.h>
 #include <timestampindex.h>
 
+#include <atomic>
+#include <functional>
 #include <memory>
+#include <thread>
 #include <string>
 #include <utility>
 #include <vector>
@@ -26,6 +30,8 @@ class uint256;
 static const int64_t nDefaultDbCache = 300;
 //! -dbbatchsize default (bytes)
 static const int64_t nDefaultDbBatchSize = 16 << 20;
+//! -checkblockindexpow default
+static const bool DEFAULT_CHECKBLOCKINDEXPOW = false;
 //! max. -dbcache (MiB)
 static const int64_t nMaxDbCache = sizeof(void*) > 4 ? 16384 : 1024;
 //! min. -dbcache (MiB)
@@ -62,7 +68,7 @@ public:
     bool HaveCoin(const COutPoint &outpoint) const override;
     uint256 GetBestBlock() const override;
     std::vector<uint256> GetHeadBlocks() const override;
-    bool BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock) override;
+    bool BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock, bool erase) override;
     std::unique_ptr<CCoinsViewCursor> Cursor() const override;
 
     //! Attempt to update from an older database format. Returns whether an error occurred.
@@ -73,6 +79,53 @@ public:
     void ResizeCache(size_t new_cache_size) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 };
 
+/**
+ * CCoinsView between the coins cache and the coin database, which can write the changes of the cache to the
+ * database on a background thread. The changes are copied into a frozen snapshot, lookups are answered from it
+ * until the write is done, so the cache can go on with the next blocks meanwhile. Only one write is in flight
+ * at a time, each write waits for the previous one first.
+ */
+class CCoinsViewBackgroundFlush final : public CCoinsViewBacked
+{
+private:
+    mutable Mutex m_mutex;
+    //! The snapshot being written, its entries are allocated from its own resource
+    std::unique_ptr<CCoinsMapMemoryResource> m_snapshot_resource GUARDED_BY(m_mutex);
+    std::unique_ptr<CCoinsMap> m_snapshot GUARDED_BY(m_mutex);
+    uint256 m_snapshot_block GUARDED_BY(m_mutex);
+    //! Memory used by the snapshot and its coins
+    size_t m_snapshot_usage GUARDED_BY(m_mutex) {0};
+
+    //! Set by WriteNextInBackground for the next BatchWrite
+    std::function<bool()> m_after_write;
+    std::atomic<bool> m_write_failed{false};
+    std::thread m_thread;
+
+public:
+    explicit CCoinsViewBackgroundFlush(CCoinsView* view) : CCoinsViewBacked(view) {}
+    ~CCoinsViewBackgroundFlush();
+
+    bool GetCoin(const COutPoint &outpoint, Coin &coin) const override;
+    bool HaveCoin(const COutPoint &outpoint) const override;
+    uint256 GetBestBlock() const override;
+    bool BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock, bool erase) override;
+
+    /**
+     * Write the changes of the next BatchWrite in the background. after_write is called on the background
+     * thread once the coins are written, for state which must not get ahead of them on disk.
+     */
+    void WriteNextInBackground(std::function<bool()> after_write);
+
+    //! Wait for the background write to be done. Returns false if a write or its after_write failed.
+    bool WaitForWrite();
+
+    //! Whether a background write failed, without waiting for the one in flight
+    bool WriteFailed() const { return m_write_failed; }
+
+    //! Memory used by the snapshot which is being written, or which failed to be written
+    size_t DynamicMemoryUsage() const;
+};
+
 /** Access to the block database (blocks/index/) */
 class CBlockTreeDB : public CDBWrapper
 {
@@ -84,19 +137,6 @@ public:
     bool ReadLastBlockFile(int &nFile);
     bool WriteReindexing(bool fReindexing);
     void ReadReindexing(bool &fReindexing);
-    bool ReadSpentIndex(CSpentIndexKey &key, CSpentIndexValue &value);
-    bool UpdateSpentIndex(const std::vector<std::pair<CSpentIndexKey, CSpentIndexValue> >&vect);
-    bool UpdateAddressUnspentIndex(const std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue > >&vect);
-    bool ReadAddressUnspentIndex(uint160 addressHash, AddressType type,
-                                 std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > &vect);
-    bool WriteAddressIndex(const std::vector<std::pair<CAddressIndexKey, CAmount> > &vect);
-    bool EraseAddressIndex(const std::vector<std::pair<CAddressIndexKey, CAmount> > &vect);
-    bool ReadAddressIndex(uint160 addressHash, AddressType type,
-                          std::vector<std::pair<CAddressIndexKey, CAmount> > &addressIndex,
-                          int start = 0, int end = 0);
-    bool WriteTimestampIndex(const CTimestampIndexKey &timestampIndex);
-    bool EraseTimestampIndex(const CTimestampIndexKey& timestampIndex);
-    bool ReadTimestampIndex(const unsigned int &high, const unsigned int &low, std::vector<uint256> &vect);
     bool WriteFlag(const std::string &name, bool fValue);
     bool ReadFlag(const std::string &name, bool &fValue);
     bool LoadBlockIndexGuts(const Consensus::Params& consensusParams, std::function<CBlockIndex*(const uint256&)> insertBlockIndex);
@@ -8,6 +8,7 @@
 #include <consensus/consensus.h>
 #include <consensus/tx_verify.h>
 #include <consensus/validation.h>
+#include <crypto/siphash.h>
 #include <hash.h>
 #include <policy/fees.h>
 #include <policy/policy.h>
@@ -336,8 +337,8 @@ void CTxMemPoolEntry::UpdateAncestorState(int64_t modifySize, CAmount modifyFee,
     assert(int(nSigOpCountWithAncestors) >= 0);
 }
 
-CTxMemPool::CTxMemPool(CBlockPolicyEstimator* estimator, int check_ratio)
-    : m_check_ratio(check_ratio), minerPolicyEstimator(estimator)
+CTxMemPool::CTxMemPool(CBlockPolicyEstimator* estimator, int check_ratio, bool cluster_order)
+    : m_check_ratio(check_ratio), m_cluster_order(cluster_order), minerPolicyEstimator(estimator)
 {
     _clear(); //lock free clear
 }
@@ -365,6 +366,7 @@ void CTxMemPool::addUnchecked(const CTxMemPoolEntry &entry, setEntries &setAnces
     // all the appropriate checks.
     indexed_transaction_set::iterator newit = mapTx.insert(entry).first;
     mapLinks.insert(make_pair(newit, TxLinks()));
+    InvalidateCluster(newit);
 
     // Update transaction for any feeDelta created by PrioritiseTransaction
     CAmount delta{0};
@@ -454,58 +456,59 @@ void CTxMemPool::addUnchecked(const CTxMemPoolEntry &entry, setEntries &setAnces
     }
 }
 
+CTxMemPool::IndexAddressHasher::IndexAddressHasher() : k0(GetRand(std::numeric_limits<uint64_t>::max())), k1(GetRand(std::numeric_limits<uint64_t>::max())) {}
+
+size_t CTxMemPool::IndexAddressHasher::operator()(const IndexAddress& address) const noexcept
+{
+    return CSipHasher(k0, k1).Write(address.m_bytes.begin(), address.m_bytes.size()).Write(static_cast<uint64_t>(address.m_type)).Finalize();
+}
+
 void CTxMemPool::addAddressIndex(const CTxMemPoolEntry &entry, const CCoinsViewCache &view)
 {
     LOCK(cs);
     const CTransaction& tx = entry.GetTx();
-    std::vector<CMempoolAddressDeltaKey> inserted;
-
-    uint256 txhash = tx.GetHash();
-    for (unsigned int j = 0; j < tx.vin.size(); j++) {
-        const CTxIn input = tx.vin[j];
-        const Coin& coin = view.AccessCoin(input.prevout);
-        const CTxOut &prevout = coin.out;
+    const uint256& txhash = tx.GetHash();
+    prevector<4, AddressIndexSlot> slots;
 
-        AddressType address_type{AddressType::UNKNOWN};
-        uint160 address_bytes;
-
-        if (!AddressBytesFromScript(prevout.scriptPubKey, address_type, address_bytes)) {
-            continue;
+    auto add = [&](const CScript& script, CAmount amount, uint32_t index, bool spent) {
+        IndexAddress address;
+        if (!AddressBytesFromScript(script, address.m_type, address.m_bytes)) {
+            return;
         }
-
-        CMempoolAddressDeltaKey key(address_type, address_bytes, txhash, j, /* tx_spent */ true);
-        CMempoolAddressDelta delta(entry.GetTime(), prevout.nValue * -1, input.prevout.hash, input.prevout.n);
-        mapAddress.insert(std::make_pair(key, delta));
-        inserted.push_back(key);
+        auto& entries = m_address_index[address];
+        slots.push_back({address, static_cast<uint32_t>(entries.size())});
+        entries.push_back({txhash, amount, index, spent});
+    };
+    for (unsigned int j = 0; j < tx.vin.size(); j++) {
+        const CTxOut& prevout = view.AccessCoin(tx.vin[j].prevout).out;
+        add(prevout.scriptPubKey, prevout.nValue * -1, j, /* tx_spent */ true);
     }
-
     for (unsigned int k = 0; k < tx.vout.size(); k++) {
-        const CTxOut &out = tx.vout[k];
-
-        AddressType address_type{AddressType::UNKNOWN};
-        uint160 address_bytes;
-
-        if (!AddressBytesFromScript(out.scriptPubKey, address_type, address_bytes)) {
-            continue;
-        }
-
-        CMempoolAddressDeltaKey key(address_type, address_bytes, txhash, k, /* tx_spent */ false);
-        mapAddress.insert(std::make_pair(key, CMempoolAddressDelta(entry.GetTime(), out.nValue)));
-        inserted.push_back(key);
+        add(tx.vout[k].scriptPubKey, tx.vout[k].nValue, k, /* tx_spent */ false);
     }
 
-    mapAddressInserted.insert(std::make_pair(txhash, inserted));
+    if (!slots.empty()) {
+        m_address_index_slots.emplace(txhash, std::move(slots));
+    }
 }
 
 bool CTxMemPool::getAddressIndex(std::vector<std::pair<uint160, AddressType> > &addresses,
                                  std::vector<std::pair<CMempoolAddressDeltaKey, CMempoolAddressDelta> > &results)
 {
     LOCK(cs);
-    for (const auto& address : addresses) {
-        addressDeltaMap::iterator ait = mapAddress.lower_bound(CMempoolAddressDeltaKey(address.second, address.first));
-        while (ait != mapAddress.end() && (*ait).first.m_address_bytes == address.first && (*ait).first.m_address_type == address.second) {
-            results.push_back(*ait);
-            ait++;
+    for (const auto& [address_bytes, address_type] : addresses) {
+        const auto ait = m_address_index.find(IndexAddress{address_type, address_bytes});
+        if (ait == m_address_index.end()) continue;
+        for (const AddressIndexEntry& entry : ait->second) {
+            const auto txit = mapTx.find(entry.m_tx_hash);
+            assert(txit != mapTx.end());
+            CMempoolAddressDeltaKey key(address_type, address_bytes, entry.m_tx_hash, entry.m_tx_index, entry.m_tx_spent);
+            if (entry.m_tx_spent) {
+                const COutPoint& prevout = txit->GetTx().vin[entry.m_tx_index].prevout;
+                results.emplace_back(key, CMempoolAddressDelta(txit->GetTime(), entry.m_amount, prevout.hash, prevout.n));
+            } else {
+                results.emplace_back(key, CMempoolAddressDelta(txit->GetTime(), entry.m_amount));
+            }
         }
     }
     return true;
@@ -514,15 +517,33 @@ bool CTxMemPool::getAddressIndex(std::vector<std::pair<uint160, AddressType> > &
 bool CTxMemPool::removeAddressIndex(const uint256 txhash)
 {
     LOCK(cs);
-    addressDeltaMapInserted::iterator it = mapAddressInserted.find(txhash);
+    const auto it = m_address_index_slots.find(txhash);
+    if (it == m_address_index_slots.end()) {
+        return true;
+    }
 
-    if (it != mapAddressInserted.end()) {
-        std::vector<CMempoolAddressDeltaKey> keys = (*it).second;
-        for (std::vector<CMempoolAddressDeltaKey>::iterator mit = keys.begin(); mit != keys.end(); mit++) {
-            mapAddress.erase(*mit);
+    // Entries are removed by moving the last one of the address into their place, the slot of the moved entry,
+    // which may be one of this transaction's, is updated to the new position
+    for (const AddressIndexSlot& slot : it->second) {
+        const auto ait = m_address_index.find(slot.m_address);
+        assert(ait != m_address_index.end());
+        auto& entries = ait->second;
+        const uint32_t last_pos = entries.size() - 1;
+        if (slot.m_pos != last_pos) {
+            entries[slot.m_pos] = entries[last_pos];
+            auto& moved_slots = m_address_index_slots.at(entries[slot.m_pos].m_tx_hash);
+            const auto moved_slot = std::find_if(moved_slots.begin(), moved_slots.end(), [&](const AddressIndexSlot& other) {
+                return other.m_pos == last_pos && other.m_address == slot.m_address;
+            });
+            assert(moved_slot != moved_slots.end());
+            moved_slot->m_pos = slot.m_pos;
+        }
+        entries.pop_back();
+        if (entries.empty()) {
+            m_address_index.erase(ait);
         }
-        mapAddressInserted.erase(it);
     }
+    m_address_index_slots.erase(it);
 
     return true;
 }
@@ -531,61 +552,62 @@ void CTxMemPool::addSpentIndex(const CTxMemPoolEntry &entry, const CCoinsViewCac
 {
     LOCK(cs);
 
-    const CTransaction& tx = entry.GetTx();
-    std::vector<CSpentIndexKey> inserted;
-
-    uint256 txhash = tx.GetHash();
-    for (unsigned int j = 0; j < tx.vin.size(); j++) {
-        const CTxIn input = tx.vin[j];
-        const Coin& coin = view.AccessCoin(input.prevout);
-        const CTxOut &prevout = coin.out;
+    for (const CTxIn& input : entry.GetTx().vin) {
+        const CTxOut& prevout = view.AccessCoin(input.prevout).out;
 
-        AddressType address_type{AddressType::UNKNOWN};
-        uint160 address_bytes;
-
-        if (!AddressBytesFromScript(prevout.scriptPubKey, address_type, address_bytes)) {
+        IndexAddress address;
+        if (!AddressBytesFromScript(prevout.scriptPubKey, address.m_type, address.m_bytes)) {
             continue;
         }
-
-        CSpentIndexKey key = CSpentIndexKey(input.prevout.hash, input.prevout.n);
-        CSpentIndexValue value = CSpentIndexValue(txhash, j, -1, prevout.nValue, address_type, address_bytes);
-
-        mapSpent.insert(std::make_pair(key, value));
-        inserted.push_back(key);
+        m_spent_index.emplace(input.prevout, SpentIndexEntry{prevout.nValue, address});
     }
-
-    mapSpentInserted.insert(make_pair(txhash, inserted));
 }
 
 bool CTxMemPool::getSpentIndex(CSpentIndexKey &key, CSpentIndexValue &value)
 {
     LOCK(cs);
-    mapSpentIndex::iterator it;
+    const COutPoint outpoint(key.m_tx_hash, key.m_tx_index);
+    const auto it = m_spent_index.find(outpoint);
+    if (it == m_spent_index.end()) {
+        return false;
+    }
 
-    it = mapSpent.find(key);
-    if (it != mapSpent.end()) {
-        value = it->second;
-        return true;
+    // The spending transaction is in the mempool for as long as the entry exists
+    const auto next_it = mapNextTx.find(outpoint);
+    assert(next_it != mapNextTx.end());
+    const CTransaction& tx = *next_it->second;
+    uint32_t input_index{0};
+    while (tx.vin[input_index].prevout != outpoint) {
+        ++input_index;
     }
-    return false;
+    value = CSpentIndexValue(tx.GetHash(), input_index, -1, it->second.m_amount, it->second.m_address.m_type, it->second.m_address.m_bytes);
+    return true;
 }
 
-bool CTxMemPool::removeSpentIndex(const uint256 txhash)
+bool CTxMemPool::removeSpentIndex(const CTransaction& tx)
 {
     LOCK(cs);
-    mapSpentIndexInserted::iterator it = mapSpentInserted.find(txhash);
-
-    if (it != mapSpentInserted.end()) {
-        std::vector<CSpentIndexKey> keys = (*it).second;
-        for (std::vector<CSpentIndexKey>::iterator mit = keys.begin(); mit != keys.end(); mit++) {
-            mapSpent.erase(*mit);
-        }
-        mapSpentInserted.erase(it);
+    for (const CTxIn& input : tx.vin) {
+        m_spent_index.erase(input.prevout);
     }
 
     return true;
 }
 
+size_t CTxMemPool::IndexDynamicMemoryUsage() const
+{
+    LOCK(cs);
+    size_t usage = memusage::DynamicUsage(m_address_index) + memusage::DynamicUsage(m_address_index_slots) +
+                   memusage::DynamicUsage(m_spent_index);
+    for (const auto& [address, entries] : m_address_index) {
+        usage += memusage::DynamicUsage(entries);
+    }
+    for (const auto& [txhash, slots] : m_address_index_slots) {
+        usage += memusage::DynamicUsage(slots);
+    }
+    return usage;
+}
+
 void CTxMemPool::removeUnchecked(txiter it, MemPoolRemovalReason reason)
 {
     if (reason != MemPoolRemovalReason::BLOCK) {
@@ -651,12 +673,14 @@ void CTxMemPool::removeUnchecked(txiter it, MemPoolRemovalReason reason)
     m_total_fee -= it->GetFee();
     cachedInnerUsage -= it->DynamicMemoryUsage();
     cachedInnerUsage -= memusage::DynamicUsage(mapLinks[it].parents) + memusage::DynamicUsage(mapLinks[it].children);
+    InvalidateCluster(it);
+    m_cluster_dirty.erase(it);
     mapLinks.erase(it);
+    removeAddressIndex(hash);
+    removeSpentIndex(it->GetTx());
     mapTx.erase(it);
     nTransactionsUpdated++;
     if (minerPolicyEstimator) {minerPolicyEstimator->removeTx(hash, false);}
-    removeAddressIndex(hash);
-    removeSpentIndex(hash);
 }
 
 // Calculates descendants of entry that are not already in setDescendants, and adds to
@@ -991,10 +1015,17 @@ void CTxMemPool::removeExpiredAssetUnlock(int nBlockHeight)
 void CTxMemPool::_clear()
 {
     mapLinks.clear();
+    m_clusters.clear();
+    m_chunk_index.clear();
+    m_cluster_dirty.clear();
+    m_cluster_usage = 0;
     mapTx.clear();
     mapNextTx.clear();
     mapProTxAddresses.clear();
     mapProTxPubKeyIDs.clear();
+    m_address_index.clear();
+    m_address_index_slots.clear();
+    m_spent_index.clear();
     totalTxSize = 0;
     m_total_fee = 0;
     cachedInnerUsage = 0;
@@ -1334,6 +1365,7 @@ void CTxMemPool::PrioritiseTransaction(const uint256& hash, const CAmount& nFeeD
         txiter it = mapTx.find(hash);
         if (it != mapTx.end()) {
             mapTx.modify(it, update_fee_delta(delta));
+            InvalidateCluster(it);
             // Now update all ancestors' modified fees with descendants
             setEntries setAncestors;
             uint64_t nNoLimit = std::numeric_limits<uint64_t>::max();
@@ -1437,7 +1469,8 @@ void CCoinsViewMemPool::PackageAddTransaction(const CTransactionRef& tx)
 size_t CTxMemPool::DynamicMemoryUsage() const {
     LOCK(cs);
     // Estimate the overhead of mapTx to be 12 pointers + an allocation, as no exact formula for boost::multi_index_contained is implemented.
-    return memusage::MallocUsage(sizeof(CTxMemPoolEntry) + 12 * sizeof(void*)) * mapTx.size() + memusage::DynamicUsage(mapNextTx) + memusage::DynamicUsage(mapDeltas) + memusage::DynamicUsage(mapLinks) + memusage::DynamicUsage(vTxHashes) + cachedInnerUsage;
+    return memusage::MallocUsage(sizeof(CTxMemPoolEntry) + 12 * sizeof(void*)) * mapTx.size() + memusage::DynamicUsage(mapNextTx) + memusage::DynamicUsage(mapDeltas) + memusage::DynamicUsage(mapLinks) + memusage::DynamicUsage(vTxHashes) + cachedInnerUsage +
+           memusage::DynamicUsage(m_clusters) + memusage::DynamicUsage(m_chunk_index) + memusage::DynamicUsage(m_cluster_dirty) + m_cluster_usage;
 }
 
 void CTxMemPool::RemoveUnbroadcastTx(const uint256& txid, const bool unchecked) {
@@ -1507,7 +1540,96 @@ void CTxMemPool::UpdateParent(txiter entry, txiter parent, bool add)
         cachedInnerUsage += memusage::IncrementalDynamicUsage(s);
     } else if (!add && mapLinks[entry].parents.erase(parent)) {
         cachedInnerUsage -= memusage::IncrementalDynamicUsage(s);
+    } else {
+        return;
     }
+    // Links are always updated in pairs, the clusters of both ends are invalidated here
+    InvalidateCluster(entry);
+    InvalidateCluster(parent);
+}
+
+void CTxMemPool::InvalidateCluster(txiter entry)
+{
+    AssertLockHeld(cs);
+    if (!m_cluster_order) return;
+
+    const auto links_it = mapLinks.find(entry);
+    assert(links_it != mapLinks.end());
+    if (links_it->second.cluster == 0) {
+        m_cluster_dirty.insert(entry);
+        return;
+    }
+    const auto cluster_it = m_clusters.find(links_it->second.cluster);
+    assert(cluster_it != m_clusters.end());
+    const TxCluster& cluster = cluster_it->second;
+    for (size_t i = 0; i < cluster.chunks.size(); ++i) {
+        m_chunk_index.erase(ChunkRef{cluster.chunks[i].fee, cluster.chunks[i].size, cluster_it->first, (uint32_t)i});
+    }
+    for (txiter member : cluster.txs) {
+        mapLinks.at(member).cluster = 0;
+        m_cluster_dirty.insert(member);
+    }
+    m_cluster_usage -= memusage::DynamicUsage(cluster.txs) + memusage::DynamicUsage(cluster.chunks) + memusage::DynamicUsage(cluster.chunk_start);
+    m_clusters.erase(cluster_it);
+}
+
+void CTxMemPool::UpdateClusters() const
+{
+    AssertLockHeld(cs);
+    assert(m_cluster_order);
+
+    while (!m_cluster_dirty.empty()) {
+        // Collect the connected component, all of it is dirty as it was merged or split from the clusters before
+        std::vector<txiter> members{*m_cluster_dirty.begin()};
+        std::map<txiter, uint32_t, CompareIteratorByHash> positions{{members[0], 0}};
+        for (size_t i = 0; i < members.size(); ++i) {
+            const TxLinks& links = mapLinks.at(members[i]);
+            for (const setEntries* linked : {&links.parents, &links.children}) {
+                for (txiter it : *linked) {
+                    if (positions.emplace(it, members.size()).second) {
+                        members.push_back(it);
+                    }
+                }
+            }
+        }
+
+        std::vector<ClusterTx> txs(members.size());
+        for (size_t i = 0; i < members.size(); ++i) {
+            txs[i].fee = members[i]->GetModifiedFee();
+            txs[i].size = members[i]->GetTxSize();
+            for (txiter parent : mapLinks.at(members[i]).parents) {
+                txs[i].parents.push_back(positions.at(parent));
+            }
+        }
+        const std::vector<uint32_t> linearization = LinearizeCluster(txs);
+
+        const uint64_t id = m_next_cluster_id++;
+        TxCluster& cluster = m_clusters[id];
+        cluster.txs.reserve(members.size());
+        for (const uint32_t i : linearization) {
+            cluster.txs.push_back(members[i]);
+        }
+        cluster.chunks = ChunkLinearization(txs, linearization);
+        uint32_t start{0};
+        for (size_t i = 0; i < cluster.chunks.size(); ++i) {
+            cluster.chunk_start.push_back(start);
+            start += cluster.chunks[i].count;
+            m_chunk_index.insert(ChunkRef{cluster.chunks[i].fee, cluster.chunks[i].size, id, (uint32_t)i});
+        }
+        m_cluster_usage += memusage::DynamicUsage(cluster.txs) + memusage::DynamicUsage(cluster.chunks) + memusage::DynamicUsage(cluster.chunk_start);
+
+        for (txiter member : members) {
+            mapLinks.at(member).cluster = id;
+            m_cluster_dirty.erase(member);
+        }
+    }
+}
+
+Span<const CTxMemPool::txiter> CTxMemPool::GetChunkTxs(const ChunkRef& chunk) const
+{
+    AssertLockHeld(cs);
+    const TxCluster& cluster = m_clusters.at(chunk.cluster);
+    return Span<const txiter>(cluster.txs).subspan(cluster.chunk_start[chunk.chunk], cluster.chunks[chunk.chunk].count);
 }
 
 const CTxMemPool::setEntries & CTxMemPool::GetMemPoolParents(txiter entry) const
@@ -1564,19 +1686,31 @@ void CTxMemPool::TrimToSize(size_t sizelimit, std::vector<COutPoint>* pvNoSpends
     unsigned nTxnRemoved = 0;
     CFeeRate maxFeeRateRemoved(0);
     while (!mapTx.empty() && DynamicMemoryUsage() > sizelimit) {
-        indexed_transaction_set::index<descendant_score>::type::iterator it = mapTx.get<descendant_score>().begin();
+        CFeeRate removed;
+        setEntries stage;
+        if (m_cluster_order) {
+            // The lowest feerate chunk is the last one of its cluster and has no descendants outside of it, the
+            // rest of the cluster is mined as before
+            UpdateClusters();
+            const ChunkRef& worst = *m_chunk_index.begin();
+            removed = CFeeRate(worst.fee, worst.size);
+            for (txiter chunk_it : GetChunkTxs(worst)) {
+                CalculateDescendants(chunk_it, stage);
+            }
+        } else {
+            indexed_transaction_set::index<descendant_score>::type::iterator it = mapTx.get<descendant_score>().begin();
+            removed = CFeeRate(it->GetModFeesWithDescendants(), it->GetSizeWithDescendants());
+            CalculateDescendants(mapTx.project<0>(it), stage);
+        }
 
         // We set the new mempool min fee to the feerate of the removed set, plus the
         // "minimum reasonable fee rate" (ie some value under which we consider txn
         // to have 0 fee). This way, we don't allow txn to enter mempool with feerate
         // equal to txn which were removed with no block in between.
-        CFeeRate removed(it->GetModFeesWithDescendants(), it->GetSizeWithDescendants());
         removed += incrementalRelayFee;
         trackPackageRemoved(removed);
         maxFeeRateRemoved = std::max(maxFeeRateRemoved, removed);
 
-        setEntries stage;
-        CalculateDescendants(mapTx.project<0>(it), stage);
         nTxnRemoved += stage.size();
 
         std::vector<CTransaction> txn;
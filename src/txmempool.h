@@ -11,6 +11,7 @@
 #include <optional>
 #include <set>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -19,9 +20,13 @@
 #include <amount.h>
 #include <coins.h>
 #include <indirectmap.h>
+#include <policy/cluster.h>
 #include <policy/feerate.h>
+#include <prevector.h>
 #include <primitives/transaction.h>
 #include <random.h>
+#include <span.h>
+#include <support/allocators/pool.h>
 #include <netaddress.h>
 #include <pubkey.h>
 #include <sync.h>
@@ -444,6 +449,7 @@ class CTxMemPool
 {
 protected:
     const int m_check_ratio; //!< Value n means that 1 times in n we check.
+    const bool m_cluster_order; //!< Whether clusters are linearized for mining and eviction
     std::atomic<unsigned int> nTransactionsUpdated{0}; //!< Used by getblocktemplate to trigger CreateNewBlock() invocation
     CBlockPolicyEstimator* minerPolicyEstimator;
 
@@ -530,6 +536,26 @@ public:
     };
     typedef std::set<txiter, CompareIteratorByHash> setEntries;
 
+    /**
+     * A chunk of a linearized cluster. They are ordered by feerate, equal ones so that iterating from the highest
+     * feerate down yields the chunks of a cluster in linearization order, the lowest one is always the last chunk
+     * of its cluster.
+     */
+    struct ChunkRef {
+        CAmount fee;
+        int64_t size;
+        uint64_t cluster;
+        uint32_t chunk;
+
+        bool operator<(const ChunkRef& other) const
+        {
+            if (FeeRateHigher(other.fee, other.size, fee, size)) return true;
+            if (FeeRateHigher(fee, size, other.fee, other.size)) return false;
+            if (cluster != other.cluster) return cluster < other.cluster;
+            return chunk > other.chunk;
+        }
+    };
+
     const setEntries & GetMemPoolParents(txiter entry) const EXCLUSIVE_LOCKS_REQUIRED(cs);
     const setEntries & GetMemPoolChildren(txiter entry) const EXCLUSIVE_LOCKS_REQUIRED(cs);
     uint64_t CalculateDescendantMaximum(txiter entry) const EXCLUSIVE_LOCKS_REQUIRED(cs);
@@ -539,22 +565,61 @@ private:
     struct TxLinks {
         setEntries parents;
         setEntries children;
+        mutable uint64_t cluster{0}; //!< id in m_clusters, 0 while the cluster needs to be linearized again
     };
 
     typedef std::map<txiter, TxLinks, CompareIteratorByHash> txlinksMap;
     txlinksMap mapLinks;
 
-    typedef std::map<CMempoolAddressDeltaKey, CMempoolAddressDelta, CMempoolAddressDeltaKeyCompare> addressDeltaMap;
-    addressDeltaMap mapAddress;
+    /**
+     * The address and spent indexes only keep what can't be taken from the mempool transactions themselves, the
+     * time, the spending input and the previous output are looked up when the indexes are queried.
+     */
+    struct IndexAddress {
+        AddressType m_type{AddressType::UNKNOWN};
+        uint160 m_bytes;
 
-    typedef std::map<uint256, std::vector<CMempoolAddressDeltaKey> > addressDeltaMapInserted;
-    addressDeltaMapInserted mapAddressInserted;
+        bool operator==(const IndexAddress& other) const { return m_type == other.m_type && m_bytes == other.m_bytes; }
+    };
+    class IndexAddressHasher
+    {
+        const uint64_t k0, k1;
 
-    typedef std::map<CSpentIndexKey, CSpentIndexValue, CSpentIndexKeyCompare> mapSpentIndex;
-    mapSpentIndex mapSpent;
+    public:
+        IndexAddressHasher();
+        size_t operator()(const IndexAddress& address) const noexcept;
+    };
+    //! an output paying an address or an input spending from it
+    struct AddressIndexEntry {
+        uint256 m_tx_hash;
+        CAmount m_amount{0};
+        uint32_t m_tx_index{0};
+        bool m_tx_spent{false};
+    };
+    //! where in m_address_index the entries of a transaction are
+    struct AddressIndexSlot {
+        IndexAddress m_address;
+        uint32_t m_pos{0};
+    };
+    struct SpentIndexEntry {
+        CAmount m_amount{0};
+        IndexAddress m_address;
+    };
 
-    typedef std::map<uint256, std::vector<CSpentIndexKey> > mapSpentIndexInserted;
-    mapSpentIndexInserted mapSpentInserted;
+    template <typename Key, typename T, typename Hash>
+    using IndexMap = std::unordered_map<Key, T, Hash, std::equal_to<Key>,
+                                        PoolAllocator<std::pair<const Key, T>, sizeof(std::pair<const Key, T>) + sizeof(void*) * 4>>;
+    using AddressIndexMap = IndexMap<IndexAddress, std::vector<AddressIndexEntry>, IndexAddressHasher>;
+    using AddressIndexSlotsMap = IndexMap<uint256, prevector<4, AddressIndexSlot>, SaltedTxidHasher>;
+    using SpentIndexMap = IndexMap<COutPoint, SpentIndexEntry, SaltedOutpointHasher>;
+
+    //! the indexes are mostly disabled, their pools start with small chunks
+    AddressIndexMap::allocator_type::ResourceType m_address_index_resource{1 << 15};
+    AddressIndexSlotsMap::allocator_type::ResourceType m_address_index_slots_resource{1 << 15};
+    SpentIndexMap::allocator_type::ResourceType m_spent_index_resource{1 << 15};
+    AddressIndexMap m_address_index{0, AddressIndexMap::hasher{}, AddressIndexMap::key_equal{}, &m_address_index_resource};
+    AddressIndexSlotsMap m_address_index_slots{0, AddressIndexSlotsMap::hasher{}, AddressIndexSlotsMap::key_equal{}, &m_address_index_slots_resource};
+    SpentIndexMap m_spent_index{0, SpentIndexMap::hasher{}, SpentIndexMap::key_equal{}, &m_spent_index_resource};
 
     std::multimap<uint256, uint256> mapProTxRefs; // proTxHash -> transaction (all TXs that refer to an existing proTx)
     std::map<CService, uint256> mapProTxAddresses;
@@ -566,6 +631,27 @@ private:
     void UpdateParent(txiter entry, txiter parent, bool add) EXCLUSIVE_LOCKS_REQUIRED(cs);
     void UpdateChild(txiter entry, txiter child, bool add) EXCLUSIVE_LOCKS_REQUIRED(cs);
 
+    /** A cluster with its linearization, see policy/cluster.h */
+    struct TxCluster {
+        std::vector<txiter> txs; //!< in linearization order
+        std::vector<ClusterChunk> chunks;
+        std::vector<uint32_t> chunk_start; //!< position of the first tx of each chunk in txs
+    };
+
+    /**
+     * Clusters are linearized lazily: a change to a cluster drops its linearization and marks its transactions
+     * dirty, the next UpdateClusters() call linearizes the clusters they form now. The cached state is mutable
+     * as it is derived from mapTx and mapLinks only, like the results of a const lookup.
+     */
+    mutable std::map<uint64_t, TxCluster> m_clusters GUARDED_BY(cs);
+    mutable std::set<ChunkRef> m_chunk_index GUARDED_BY(cs);
+    mutable setEntries m_cluster_dirty GUARDED_BY(cs);
+    mutable uint64_t m_next_cluster_id GUARDED_BY(cs){1};
+    mutable size_t m_cluster_usage GUARDED_BY(cs){0}; //!< dynamic memory usage of the vectors of m_clusters
+
+    /** Drop the linearization of the cluster of entry, after its links or fee changed */
+    void InvalidateCluster(txiter entry) EXCLUSIVE_LOCKS_REQUIRED(cs);
+
     std::vector<indexed_transaction_set::const_iterator> GetSortedDepthAndScore() const EXCLUSIVE_LOCKS_REQUIRED(cs);
 
     /**
@@ -584,8 +670,9 @@ public:
      *
      * @param[in] estimator is used to estimate appropriate transaction fees.
      * @param[in] check_ratio is the ratio used to determine how often sanity checks will run.
+     * @param[in] cluster_order whether mining and eviction use cluster linearizations instead of ancestor and descendant scores.
      */
-    explicit CTxMemPool(CBlockPolicyEstimator* estimator = nullptr, int check_ratio = 0);
+    explicit CTxMemPool(CBlockPolicyEstimator* estimator = nullptr, int check_ratio = 0, bool cluster_order = DEFAULT_CLUSTER_MEMPOOL);
 
     /**
      * If sanity-checking is turned on, check makes sure the pool is
@@ -612,7 +699,10 @@ public:
 
     void addSpentIndex(const CTxMemPoolEntry &entry, const CCoinsViewCache &view);
     bool getSpentIndex(CSpentIndexKey &key, CSpentIndexValue &value);
-    bool removeSpentIndex(const uint256 txhash);
+    bool removeSpentIndex(const CTransaction& tx);
+
+    /** Memory used by the address and spent indexes, which DynamicMemoryUsage() leaves out */
+    size_t IndexDynamicMemoryUsage() const;
 
     void removeRecursive(const CTransaction& tx, MemPoolRemovalReason reason) EXCLUSIVE_LOCKS_REQUIRED(cs);
     void removeForReorg(CChainState& active_chainstate, int flags) EXCLUSIVE_LOCKS_REQUIRED(cs, cs_main);
@@ -704,6 +794,21 @@ public:
       */
     void TrimToSize(size_t sizelimit, std::vector<COutPoint>* pvNoSpendsRemaining = nullptr) EXCLUSIVE_LOCKS_REQUIRED(cs);
 
+    bool IsClusterOrdered() const { return m_cluster_order; }
+
+    /** Linearize the clusters changed since the last call. Only with cluster ordering enabled. */
+    void UpdateClusters() const EXCLUSIVE_LOCKS_REQUIRED(cs);
+
+    /** The chunks of all clusters by feerate, valid until the mempool changes or clusters are updated again */
+    const std::set<ChunkRef>& GetChunkIndex() const EXCLUSIVE_LOCKS_REQUIRED(cs)
+    {
+        AssertLockHeld(cs);
+        return m_chunk_index;
+    }
+
+    /** The transactions of a chunk in a valid order for a block */
+    Span<const txiter> GetChunkTxs(const ChunkRef& chunk) const EXCLUSIVE_LOCKS_REQUIRED(cs);
+
     /** Expire all transaction (and their dependencies) in the mempool older than time. Return the number of removed transactions. */
     int Expire(std::chrono::seconds time) EXCLUSIVE_LOCKS_REQUIRED(cs);
 
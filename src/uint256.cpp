@@ -10,11 +10,15 @@
 template <unsigned int BITS>
 std::string base_blob<BITS>::GetHex() const
 {
-    uint8_t m_data_rev[WIDTH];
-    for (int i = 0; i < WIDTH; ++i) {
-        m_data_rev[i] = m_data[WIDTH - 1 - i];
-    }
-    return HexStr(m_data_rev);
+    std::string rv(WIDTH * 2, '\0');
+    WriteHex(rv.data());
+    return rv;
+}
+
+template <unsigned int BITS>
+void base_blob<BITS>::WriteHex(char* out) const
+{
+    HexStrTo(m_data, out, /* reverse */ true);
 }
 
 template <unsigned int BITS>
@@ -59,12 +63,14 @@ std::string base_blob<BITS>::ToString() const
 
 // Explicit instantiations for base_blob<160>
 template std::string base_blob<160>::GetHex() const;
+template void base_blob<160>::WriteHex(char*) const;
 template std::string base_blob<160>::ToString() const;
 template void base_blob<160>::SetHex(const char*);
 template void base_blob<160>::SetHex(const std::string&);
 
 // Explicit instantiations for base_blob<256>
 template std::string base_blob<256>::GetHex() const;
+template void base_blob<256>::WriteHex(char*) const;
 template std::string base_blob<256>::ToString() const;
 template void base_blob<256>::SetHex(const char*);
 template void base_blob<256>::SetHex(const std::string&);
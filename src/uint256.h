@@ -58,6 +58,8 @@ public:
     friend constexpr bool operator<(const base_blob& a, const base_blob& b) { return a.Compare(b) < 0; }
 
     std::string GetHex() const;
+    /** Write the GetHex() string to out, which must have room for size() * 2 characters, without a terminating null character */
+    void WriteHex(char* out) const;
     void SetHex(const char* psz);
     void SetHex(const std::string& str);
     std::string ToString() const;
@@ -7,22 +7,21 @@
 #include "univalue.h"
 #include "univalue_escapes.h"
 
-static std::string json_escape(const std::string& inS)
+// Appends inS quoted and escaped, the runs of characters which need no escaping are copied at once
+static void json_escape(const std::string& inS, std::string& s)
 {
-    std::string outS;
-    outS.reserve(inS.size() * 2);
-
-    for (unsigned int i = 0; i < inS.size(); i++) {
-        unsigned char ch = static_cast<unsigned char>(inS[i]);
-        const char *escStr = escapes[ch];
-
-        if (escStr)
-            outS += escStr;
-        else
-            outS += static_cast<char>(ch);
+    s += '"';
+    size_t start = 0;
+    for (size_t i = 0; i < inS.size(); i++) {
+        const char *escStr = escapes[static_cast<unsigned char>(inS[i])];
+        if (escStr) {
+            s.append(inS, start, i - start);
+            s += escStr;
+            start = i + 1;
+        }
     }
-
-    return outS;
+    s.append(inS, start, std::string::npos);
+    s += '"';
 }
 
 std::string UniValue::write(unsigned int prettyIndent,
@@ -30,23 +29,35 @@ std::string UniValue::write(unsigned int prettyIndent,
 {
     std::string s;
     s.reserve(1024);
+    write(s, prettyIndent, indentLevel);
+    return s;
+}
 
+void UniValue::write(std::string& s, unsigned int prettyIndent,
+                     unsigned int indentLevel) const
+{
     unsigned int modIndent = indentLevel;
     if (modIndent == 0)
         modIndent = 1;
 
+    writeValue(prettyIndent, modIndent, s);
+}
+
+// Nested values are written into the same string, without a temporary one per value
+void UniValue::writeValue(unsigned int prettyIndent, unsigned int indentLevel, std::string& s) const
+{
     switch (typ) {
     case VNULL:
         s += "null";
         break;
     case VOBJ:
-        writeObject(prettyIndent, modIndent, s);
+        writeObject(prettyIndent, indentLevel, s);
         break;
     case VARR:
-        writeArray(prettyIndent, modIndent, s);
+        writeArray(prettyIndent, indentLevel, s);
         break;
     case VSTR:
-        s += "\"" + json_escape(val) + "\"";
+        json_escape(val, s);
         break;
     case VNUM:
         s += val;
@@ -55,8 +66,6 @@ std::string UniValue::write(unsigned int prettyIndent,
         s += (val == "1" ? "true" : "false");
         break;
     }
-
-    return s;
 }
 
 static void indentStr(unsigned int prettyIndent, unsigned int indentLevel, std::string& s)
@@ -73,7 +82,7 @@ void UniValue::writeArray(unsigned int prettyIndent, unsigned int indentLevel, s
     for (unsigned int i = 0; i < values.size(); i++) {
         if (prettyIndent)
             indentStr(prettyIndent, indentLevel, s);
-        s += values[i].write(prettyIndent, indentLevel + 1);
+        values[i].writeValue(prettyIndent, indentLevel + 1, s);
         if (i != (values.size() - 1)) {
             s += ",";
         }
@@ -95,10 +104,11 @@ void UniValue::writeObject(unsigned int prettyIndent, unsigned int indentLevel,
     for (unsigned int i = 0; i < keys.size(); i++) {
         if (prettyIndent)
             indentStr(prettyIndent, indentLevel, s);
-        s += "\"" + json_escape(keys[i]) + "\":";
+        json_escape(keys[i], s);
+        s += ":";
         if (prettyIndent)
             s += " ";
-        s += values.at(i).write(prettyIndent, indentLevel + 1);
+        values.at(i).writeValue(prettyIndent, indentLevel + 1, s);
         if (i != (values.size() - 1))
             s += ",";
         if (prettyIndent)
@@ -32,6 +32,7 @@ public:
     }
 
     size_t max_size() const { return maxSize; }
+    size_t size() const { return cacheMap.size(); }
 
     template<typename Value2>
     void _emplace(const Key& key, Value2&& v)
@@ -0,0 +1,63 @@
+// Copyright (c) 2026 The Dash Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_UTIL_MPSC_QUEUE_H
+#define BITCOIN_UTIL_MPSC_QUEUE_H
+
+#include <algorithm>
+#include <atomic>
+#include <utility>
+#include <vector>
+
+/**
+ * Unbounded queue which any number of threads push to without taking a lock.
+ *
+ * Each push links a new node onto an atomic list head. The consumer takes
+ * the whole list in one atomic exchange, so there is no ABA problem and
+ * taking is lock free too; items come back in the order they were pushed.
+ */
+template <typename T>
+class MPSCQueue
+{
+private:
+    struct Node {
+        T value;
+        Node* next;
+    };
+
+    std::atomic<Node*> m_head{nullptr};
+
+public:
+    MPSCQueue() = default;
+    ~MPSCQueue() { PopAll(); }
+
+    MPSCQueue(const MPSCQueue&) = delete;
+    MPSCQueue& operator=(const MPSCQueue&) = delete;
+
+    void Push(T value)
+    {
+        Node* node = new Node{std::move(value), m_head.load(std::memory_order_relaxed)};
+        while (!m_head.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed)) {
+        }
+    }
+
+    /** Take everything pushed so far, oldest first */
+    std::vector<T> PopAll()
+    {
+        Node* node = m_head.exchange(nullptr, std::memory_order_acquire);
+        std::vector<T> ret;
+        while (node != nullptr) {
+            ret.emplace_back(std::move(node->value));
+            Node* next = node->next;
+            delete node;
+            node = next;
+        }
+        std::reverse(ret.begin(), ret.end());
+        return ret;
+    }
+
+    bool Empty() const { return m_head.load(std::memory_order_relaxed) == nullptr; }
+};
+
+#endif // BITCOIN_UTIL_MPSC_QUEUE_H
@@ -0,0 +1,155 @@
+// Copyright (c) 2026 The Dash Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <util/perfcounters.h>
+
+#include <crypto/common.h>
+#include <sync.h>
+#include <tinyformat.h>
+
+#include <algorithm>
+#include <cassert>
+#include <map>
+#include <memory>
+
+namespace perf {
+
+void Histogram::Observe(int64_t micros)
+{
+    const size_t bucket = std::min<size_t>(CountBits(std::max<int64_t>(micros, 0)), BUCKETS - 1);
+    m_buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_sum.fetch_add(micros, std::memory_order_relaxed);
+}
+
+Histogram::Snapshot Histogram::Get() const
+{
+    // Not one consistent snapshot, an observation running concurrently may be in some of the fields only
+    Snapshot ret;
+    ret.count = m_count.load(std::memory_order_relaxed);
+    ret.sum = m_sum.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < BUCKETS; ++i) {
+        ret.buckets[i] = m_buckets[i].load(std::memory_order_relaxed);
+    }
+    return ret;
+}
+
+namespace {
+
+struct Entry {
+    MetricType type;
+    std::string help;
+    std::unique_ptr<Counter> counter;
+    std::unique_ptr<Gauge> gauge;
+    std::unique_ptr<Histogram> histogram;
+};
+
+struct Registry {
+    Mutex mutex;
+    std::map<std::string, Entry> entries GUARDED_BY(mutex);
+};
+
+Registry& GetRegistry()
+{
+    // Never destroyed, metrics may be updated by threads which outlive static destruction
+    static Registry* registry = new Registry();
+    return *registry;
+}
+
+Entry& Register(const std::string& name, const std::string& help, MetricType type)
+{
+    Registry& registry = GetRegistry();
+    LOCK(registry.mutex);
+    auto [it, inserted] = registry.entries.try_emplace(name);
+    Entry& entry = it->second;
+    if (inserted) {
+        entry.type = type;
+        entry.help = help;
+        switch (type) {
+        case MetricType::COUNTER: entry.counter = std::make_unique<Counter>(); break;
+        case MetricType::GAUGE: entry.gauge = std::make_unique<Gauge>(); break;
+        case MetricType::HISTOGRAM: entry.histogram = std::make_unique<Histogram>(); break;
+        }
+    }
+    assert(entry.type == type);
+    return entry;
+}
+
+std::string PrometheusName(const std::string& name, const std::string& prefix)
+{
+    std::string ret = prefix + name;
+    std::replace_if(ret.begin(), ret.end(), [](char c) {
+        return !((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_');
+    }, '_');
+    return ret;
+}
+
+} // namespace
+
+Counter& GetCounter(const std::string& name, const std::string& help)
+{
+    return *Register(name, help, MetricType::COUNTER).counter;
+}
+
+Gauge& GetGauge(const std::string& name, const std::string& help)
+{
+    return *Register(name, help, MetricType::GAUGE).gauge;
+}
+
+Histogram& GetHistogram(const std::string& name, const std::string& help)
+{
+    return *Register(name, help, MetricType::HISTOGRAM).histogram;
+}
+
+std::vector<MetricSnapshot> GetSnapshot()
+{
+    Registry& registry = GetRegistry();
+    LOCK(registry.mutex);
+    std::vector<MetricSnapshot> ret;
+    ret.reserve(registry.entries.size());
+    for (const auto& [name, entry] : registry.entries) {
+        MetricSnapshot& metric = ret.emplace_back();
+        metric.name = name;
+        metric.help = entry.help;
+        metric.type = entry.type;
+        switch (entry.type) {
+        case MetricType::COUNTER: metric.value = entry.counter->Get(); break;
+        case MetricType::GAUGE: metric.value = entry.gauge->Get(); break;
+        case MetricType::HISTOGRAM: metric.histogram = entry.histogram->Get(); break;
+        }
+    }
+    return ret;
+}
+
+std::string FormatPrometheus(const std::vector<MetricSnapshot>& metrics, const std::string& prefix)
+{
+    std::string ret;
+    for (const auto& metric : metrics) {
+        const std::string name = PrometheusName(metric.name, prefix);
+        ret += strprintf("# HELP %s %s\n", name, metric.help);
+        switch (metric.type) {
+        case MetricType::COUNTER:
+            ret += strprintf("# TYPE %s counter\n%s %d\n", name, name, metric.value);
+            break;
+        case MetricType::GAUGE:
+            ret += strprintf("# TYPE %s gauge\n%s %d\n", name, name, metric.value);
+            break;
+        case MetricType::HISTOGRAM: {
+            // Prometheus histograms are cumulative and in seconds
+            ret += strprintf("# TYPE %s histogram\n", name);
+            uint64_t cumulative{0};
+            for (size_t i = 0; i + 1 < Histogram::BUCKETS; ++i) {
+                cumulative += metric.histogram.buckets[i];
+                ret += strprintf("%s_bucket{le=\"%g\"} %d\n", name, double(uint64_t{1} << i) / 1e6, cumulative);
+            }
+            ret += strprintf("%s_bucket{le=\"+Inf\"} %d\n", name, metric.histogram.count);
+            ret += strprintf("%s_sum %g\n%s_count %d\n", name, metric.histogram.sum / 1e6, name, metric.histogram.count);
+            break;
+        }
+        }
+    }
+    return ret;
+}
+
+} // namespace perf
@@ -0,0 +1,112 @@
+// Copyright (c) 2026 The Dash Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_UTIL_PERFCOUNTERS_H
+#define BITCOIN_UTIL_PERFCOUNTERS_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * A registry of named performance counters which the getperfcounters RPC, the periodic statsd stats and the
+ * /rest/metrics endpoint export. Metrics are registered once, usually into a function local static reference,
+ * and updated with relaxed atomics, so updating them never takes a lock.
+ */
+namespace perf {
+
+/** A count of events which only goes up */
+class Counter
+{
+public:
+    void Add(uint64_t n = 1) { m_value.fetch_add(n, std::memory_order_relaxed); }
+    uint64_t Get() const { return m_value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> m_value{0};
+};
+
+/** A value which is set to the current state of something */
+class Gauge
+{
+public:
+    void Set(int64_t value) { m_value.store(value, std::memory_order_relaxed); }
+    void Add(int64_t n) { m_value.fetch_add(n, std::memory_order_relaxed); }
+    int64_t Get() const { return m_value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<int64_t> m_value{0};
+};
+
+/** Durations in microseconds, bucket i counts the ones below 2^i us and the last bucket all longer ones */
+class Histogram
+{
+public:
+    static constexpr size_t BUCKETS{32};
+
+    struct Snapshot {
+        uint64_t count{0};
+        int64_t sum{0};
+        std::array<uint64_t, BUCKETS> buckets{};
+    };
+
+    void Observe(int64_t micros);
+    Snapshot Get() const;
+
+private:
+    std::array<std::atomic<uint64_t>, BUCKETS> m_buckets{};
+    std::atomic<uint64_t> m_count{0};
+    std::atomic<int64_t> m_sum{0};
+};
+
+/** Adds the lifetime of the timer to a histogram */
+class ScopedTimer
+{
+public:
+    explicit ScopedTimer(Histogram& histogram) : m_histogram(histogram) {}
+    ~ScopedTimer()
+    {
+        m_histogram.Observe(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_start).count());
+    }
+
+private:
+    Histogram& m_histogram;
+    const std::chrono::steady_clock::time_point m_start{std::chrono::steady_clock::now()};
+};
+
+/**
+ * Find or register a metric. Names are dot separated like the statsd keys, e.g. "validation.connecttip.flush".
+ * The returned references stay valid for the lifetime of the process.
+ */
+Counter& GetCounter(const std::string& name, const std::string& help);
+Gauge& GetGauge(const std::string& name, const std::string& help);
+Histogram& GetHistogram(const std::string& name, const std::string& help);
+
+enum class MetricType {
+    COUNTER,
+    GAUGE,
+    HISTOGRAM,
+};
+
+struct MetricSnapshot {
+    std::string name;
+    std::string help;
+    MetricType type;
+    //! value of counters and gauges
+    int64_t value{0};
+    Histogram::Snapshot histogram;
+};
+
+/** The current values of all registered metrics, sorted by name */
+std::vector<MetricSnapshot> GetSnapshot();
+
+/** Format metrics in the Prometheus text exposition format, names get the prefix and '_' for '.' */
+std::string FormatPrometheus(const std::vector<MetricSnapshot>& metrics, const std::string& prefix = "dash_");
+
+} // namespace perf
+
+#endif // BITCOIN_UTIL_PERFCOUNTERS_H
@@ -9,6 +9,7 @@
 #include <tinyformat.h>
 
 #include <algorithm>
+#include <array>
 #include <cstdlib>
 #include <cstring>
 #include <optional>
@@ -501,17 +502,40 @@ bool ParseFixedPoint(const std::string &val, int decimals, int64_t *amount_out)
     return true;
 }
 
+namespace {
+/** Both hex characters of every byte value, so that each byte takes one lookup */
+constexpr std::array<std::array<char, 2>, 256> CreateByteToHexMap()
+{
+    constexpr char hexmap[16] = { '0', '1', '2', '3', '4', '5', '6', '7',
+                                  '8', '9', 'a', 'b', 'c', 'd', 'e', 'f' };
+    std::array<std::array<char, 2>, 256> byte_to_hex{};
+    for (size_t i = 0; i < byte_to_hex.size(); ++i) {
+        byte_to_hex[i][0] = hexmap[i >> 4];
+        byte_to_hex[i][1] = hexmap[i & 15];
+    }
+    return byte_to_hex;
+}
+constexpr auto BYTE_TO_HEX{CreateByteToHexMap()};
+} // namespace
+
+void HexStrTo(const Span<const uint8_t> s, char* out, bool reverse)
+{
+    if (reverse) {
+        for (size_t i = s.size(); i-- > 0; out += 2) {
+            std::memcpy(out, BYTE_TO_HEX[s[i]].data(), 2);
+        }
+    } else {
+        for (uint8_t v : s) {
+            std::memcpy(out, BYTE_TO_HEX[v].data(), 2);
+            out += 2;
+        }
+    }
+}
+
 std::string HexStr(const Span<const uint8_t> s)
 {
     std::string rv(s.size() * 2, '\0');
-    static constexpr char hexmap[16] = { '0', '1', '2', '3', '4', '5', '6', '7',
-                                         '8', '9', 'a', 'b', 'c', 'd', 'e', 'f' };
-    auto it = rv.begin();
-    for (uint8_t v : s) {
-        *it++ = hexmap[v >> 4];
-        *it++ = hexmap[v & 15];
-    }
-    assert(it == rv.end());
+    HexStrTo(s, rv.data());
     return rv;
 }
 
@@ -194,6 +194,12 @@ std::optional<T> ToIntegral(const std::string& str)
  * Convert a span of bytes to a lower-case hexadecimal string.
  */
 std::string HexStr(const Span<const uint8_t> s);
+/**
+ * Write the lower-case hexadecimal form of a span of bytes to out, which must have room for 2 * s.size()
+ * characters. No terminating null character is written. With reverse the bytes are written from the last
+ * to the first, the order uint256::GetHex() uses.
+ */
+void HexStrTo(const Span<const uint8_t> s, char* out, bool reverse = false);
 inline std::string HexStr(const Span<const char> s) { return HexStr(MakeUCharSpan(s)); }
 inline std::string HexStr(const Span<const std::byte> s) { return HexStr(MakeUCharSpan(s)); }
 
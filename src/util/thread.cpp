@@ -10,6 +10,11 @@
 
 #include <exception>
 
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
 void util::TraceThread(const char* thread_name, std::function<void()> thread_func)
 {
     util::ThreadRename(thread_name);
@@ -22,3 +27,15 @@ void util::TraceThread(const char* thread_name, std::function<void()> thread_fun
         throw;
     }
 }
+
+bool util::PinThreadToCore(unsigned int core)
+{
+#ifdef __linux__
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    CPU_SET(core, &cpuset);
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset) == 0;
+#else
+    return false;
+#endif
+}
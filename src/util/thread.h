@@ -13,6 +13,9 @@ namespace util {
  */
 void TraceThread(const char* thread_name, std::function<void()> thread_func);
 
+/** Make the calling thread run on the given core only. Returns false if that isn't supported on this platform. */
+bool PinThreadToCore(unsigned int core);
+
 } // namespace util
 
 #endif // BITCOIN_UTIL_THREAD_H
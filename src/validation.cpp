@@ -20,6 +20,7 @@
 #include <flatfile.h>
 #include <hash.h>
 #include <index/blockfilterindex.h>
+#include <kawpow.h>
 #include <logging.h>
 #include <logging/timer.h>
 #include <node/blockstorage.h>
@@ -44,17 +45,21 @@
 #include <undo.h>
 #include <util/check.h> // For NDEBUG compile time check
 #include <util/hasher.h>
+#include <util/perfcounters.h>
 #include <util/strencodings.h>
 #include <util/translation.h>
 #include <util/system.h>
+#include <util/trace.h>
 #include <validationinterface.h>
 #include <warnings.h>
 
 #include <masternode/payments.h>
 #include <masternode/sync.h>
 
+#include <evo/creditpool.h>
 #include <evo/deterministicmns.h>
 #include <evo/evodb.h>
+#include <evo/evosnapshot.h>
 #include <evo/mnhftx.h>
 #include <evo/specialtx.h>
 #include <evo/specialtxman.h>
@@ -68,6 +73,7 @@
 #include <deque>
 #include <numeric>
 #include <optional>
+#include <set>
 #include <string>
 
 #define MICRO 0.000001
@@ -75,10 +81,12 @@
 
 /** Maximum kilobytes for transactions to store for processing during reorg */
 static const unsigned int MAX_DISCONNECTED_TX_POOL_SIZE = 20000;
+/** Maximum number of blocks DisconnectTips applies to the chain state in one batch */
+static const unsigned int MAX_DISCONNECT_TIPS_BATCH = 32;
 /** The pre-allocation chunk size for blk?????.dat files (since 0.8) */
 static const unsigned int BLOCKFILE_CHUNK_SIZE = 0x1000000; // 16 MiB
 /** The pre-allocation chunk size for rev?????.dat files (since 0.8) */
-static const unsigned int UNDOFILE_CHUNK_SIZE = 0x100000; // 1 MiB
+static const unsigned int UNDOFILE_CHUNK_SIZE = 0x400000; // 4 MiB
 /** Time to wait between writing blocks/block index to disk. */
 static constexpr std::chrono::hours DATABASE_WRITE_INTERVAL{1};
 /** Time to wait between flushing chainstate to disk. */
@@ -156,6 +164,7 @@ bool fRequireStandard = true;
 bool fCheckBlockIndex = false;
 bool fCheckpointsEnabled = DEFAULT_CHECKPOINTS_ENABLED;
 uint64_t nPruneTarget = 0;
+unsigned int nPruneBlocksToKeep = MIN_BLOCKS_TO_KEEP;
 int64_t nMaxTipAge = DEFAULT_MAX_TIP_AGE;
 
 // TODO: drop this global variable. Used by net.cpp module only
@@ -523,6 +532,8 @@ static bool CheckInputsFromMempoolAndCache(const CTransaction& tx, TxValidationS
     return CheckInputScripts(tx, state, view, flags, /* cacheSigStore = */ true, /* cacheFullSciptStore = */ true, txdata);
 }
 
+static CCheckQueue<CScriptCheck> scriptcheckqueue(128);
+
 namespace {
 
 class MemPoolAccept
@@ -563,6 +574,14 @@ public:
     */
     PackageMempoolAcceptResult AcceptMultipleTransactions(const std::vector<CTransactionRef>& txns, ATMPArgs& args) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
+    /**
+    * Accept transactions independently of each other, with the same result as AcceptSingleTransaction
+    * for each of them in order, but with the script checks of the whole batch run on the script check
+    * threads at once. Transactions which spend an output or an input of an earlier one of the batch
+    * are accepted one at a time after it. args holds the arguments of each transaction.
+    */
+    std::vector<MempoolAcceptResult> AcceptTransactionBatch(const std::vector<CTransactionRef>& txns, std::vector<ATMPArgs>& args) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+
 private:
     // All the intermediate state that gets passed between the various levels
     // of checking a given transaction.
@@ -577,6 +596,9 @@ private:
         const CTransactionRef& m_ptx;
         const uint256& m_hash;
         TxValidationState m_state;
+
+        // In-mempool parents when PreChecks passed, only kept for batches
+        std::vector<uint256> m_mempool_parents;
     };
 
     // Run the policy checks on a given transaction, excluding any script checks.
@@ -585,6 +607,13 @@ private:
     // only tests that are fast should be done here (to avoid CPU DoS).
     bool PreChecks(ATMPArgs& args, Workspace& ws) EXCLUSIVE_LOCKS_REQUIRED(cs_main, m_pool.cs);
 
+    // Calculate the in-mempool ancestors of the entry, up to the package limits.
+    bool CalculateAncestors(Workspace& ws) EXCLUSIVE_LOCKS_REQUIRED(cs_main, m_pool.cs);
+
+    // Repeat the parts of PreChecks which depend on other mempool transactions, for a batch
+    // transaction after the ones before it were added.
+    bool BatchRechecks(const ATMPArgs& args, Workspace& ws) EXCLUSIVE_LOCKS_REQUIRED(cs_main, m_pool.cs);
+
     // Run the script checks using our policy flags. As this can be slow, we should
     // only invoke this on transactions that have otherwise passed policy checks.
     bool PolicyScriptChecks(const ATMPArgs& args, Workspace& ws, PrecomputedTransactionData& txdata) EXCLUSIVE_LOCKS_REQUIRED(cs_main, m_pool.cs);
@@ -644,7 +673,6 @@ bool MemPoolAccept::PreChecks(ATMPArgs& args, Workspace& ws)
 
     // Alias what we need out of ws
     TxValidationState& state = ws.m_state;
-    CTxMemPool::setEntries& setAncestors = ws.m_ancestors;
     std::unique_ptr<CTxMemPoolEntry>& entry = ws.m_entry;
     CAmount& nModifiedFees = ws.m_modified_fees;
 
@@ -803,9 +831,32 @@ bool MemPoolAccept::PreChecks(ATMPArgs& args, Workspace& ws)
         if (!bypass_limits && !CheckFeeRate(nSize, nModifiedFees, state)) return false;
     }
 
+    if (!CalculateAncestors(ws)) return false;
+
+    // check special TXs after all the other checks. If we'd do this before the other checks, we might end up
+    // DoS scoring a node for non-critical errors, e.g. duplicate keys because a TX is received that was already
+    // mined
+    // NOTE: we use UTXO here and do NOT allow mempool txes as masternode collaterals
+    if (!CheckSpecialTx(tx, m_active_chainstate.m_chain.Tip(), m_active_chainstate.CoinsTip(), true, state))
+        return false;
+
+    if (m_pool.existsProviderTxConflict(tx)) {
+        return state.Invalid(TxValidationResult::TX_CONFLICT, "protx-dup");
+    }
+
+    return true;
+}
+
+bool MemPoolAccept::CalculateAncestors(Workspace& ws)
+{
+    TxValidationState& state = ws.m_state;
+    CTxMemPool::setEntries& setAncestors = ws.m_ancestors;
+    const CTxMemPoolEntry& entry = *ws.m_entry;
+    const unsigned int nSize = entry.GetTxSize();
+
     // Calculate in-mempool ancestors, up to a limit.
     std::string errString;
-    if (!m_pool.CalculateMemPoolAncestors(*entry, setAncestors, m_limit_ancestors, m_limit_ancestor_size, m_limit_descendants, m_limit_descendant_size, errString)) {
+    if (!m_pool.CalculateMemPoolAncestors(entry, setAncestors, m_limit_ancestors, m_limit_ancestor_size, m_limit_descendants, m_limit_descendant_size, errString)) {
         setAncestors.clear();
         // If CalculateMemPoolAncestors fails second time, we want the original error string.
         std::string dummy_err_string;
@@ -820,22 +871,37 @@ bool MemPoolAccept::PreChecks(ATMPArgs& args, Workspace& ws)
         // outputs - one for each counterparty. For more info on the uses for
         // this, see https://lists.linuxfoundation.org/pipermail/bitcoin-dev/2018-November/016518.html
         if (nSize >  EXTRA_DESCENDANT_TX_SIZE_LIMIT ||
-                !m_pool.CalculateMemPoolAncestors(*entry, setAncestors, 2, m_limit_ancestor_size, m_limit_descendants + 1, m_limit_descendant_size + EXTRA_DESCENDANT_TX_SIZE_LIMIT, dummy_err_string)) {
+                !m_pool.CalculateMemPoolAncestors(entry, setAncestors, 2, m_limit_ancestor_size, m_limit_descendants + 1, m_limit_descendant_size + EXTRA_DESCENDANT_TX_SIZE_LIMIT, dummy_err_string)) {
             return state.Invalid(TxValidationResult::TX_MEMPOOL_POLICY, "too-long-mempool-chain", errString);
         }
     }
+    return true;
+}
 
-    // check special TXs after all the other checks. If we'd do this before the other checks, we might end up
-    // DoS scoring a node for non-critical errors, e.g. duplicate keys because a TX is received that was already
-    // mined
-    // NOTE: we use UTXO here and do NOT allow mempool txes as masternode collaterals
-    if (!CheckSpecialTx(tx, m_active_chainstate.m_chain.Tip(), m_active_chainstate.CoinsTip(), true, state))
-        return false;
+bool MemPoolAccept::BatchRechecks(const ATMPArgs& args, Workspace& ws)
+{
+    const CTransaction& tx = *ws.m_ptx;
+    TxValidationState& state = ws.m_state;
+
+    // Adding the transactions before this one may have evicted a parent, as may PreChecks of a later one
+    // removing conflicts of a transaction InstantSend waits for. The ancestors found by PreChecks also
+    // don't count the transactions before this one against the descendant limits of shared parents.
+    for (const uint256& parent : ws.m_mempool_parents) {
+        if (!m_pool.exists(parent)) {
+            return state.Invalid(TxValidationResult::TX_MISSING_INPUTS, "bad-txns-inputs-missingorspent");
+        }
+    }
+    ws.m_ancestors.clear();
+    if (!CalculateAncestors(ws)) return false;
+
+    // The mempool minimum fee may have gone up
+    if (tx.nVersion != 3 || tx.nType != TRANSACTION_MNHF_SIGNAL) {
+        if (!args.m_bypass_limits && !CheckFeeRate(ws.m_entry->GetTxSize(), ws.m_modified_fees, state)) return false;
+    }
 
     if (m_pool.existsProviderTxConflict(tx)) {
         return state.Invalid(TxValidationResult::TX_CONFLICT, "protx-dup");
     }
-
     return true;
 }
 
@@ -1024,6 +1090,102 @@ PackageMempoolAcceptResult MemPoolAccept::AcceptMultipleTransactions(const std::
     return PackageMempoolAcceptResult(package_state, std::move(results));
 }
 
+std::vector<MempoolAcceptResult> MemPoolAccept::AcceptTransactionBatch(const std::vector<CTransactionRef>& txns, std::vector<ATMPArgs>& args)
+{
+    auto start = Now<SteadyMilliseconds>();
+    AssertLockHeld(cs_main);
+    assert(args.size() == txns.size());
+    LOCK(m_pool.cs); // mempool "read lock" (held through GetMainSignals().TransactionAddedToMempool())
+
+    std::vector<std::optional<MempoolAcceptResult>> results(txns.size());
+    std::vector<Workspace> workspaces;
+    workspaces.reserve(txns.size());
+    std::vector<size_t> batch;
+    std::vector<size_t> deferred;
+    std::set<uint256> batch_txids;
+    std::set<COutPoint> batch_prevouts;
+
+    for (size_t i = 0; i < txns.size(); ++i) {
+        const CTransaction& tx = *txns[i];
+        const bool depends = batch_txids.count(tx.GetHash()) ||
+                             std::any_of(tx.vin.cbegin(), tx.vin.cend(), [&](const CTxIn& txin) {
+                                 return batch_txids.count(txin.prevout.hash) || batch_prevouts.count(txin.prevout);
+                             });
+        if (depends) {
+            deferred.push_back(i);
+            continue;
+        }
+
+        Workspace& ws = workspaces.emplace_back(txns[i]);
+        if (!PreChecks(args[i], ws)) {
+            results[i].emplace(MempoolAcceptResult::Failure(ws.m_state));
+            workspaces.pop_back();
+            continue;
+        }
+        for (const CTxIn& txin : tx.vin) {
+            if (m_pool.exists(txin.prevout.hash)) ws.m_mempool_parents.push_back(txin.prevout.hash);
+            batch_prevouts.insert(txin.prevout);
+        }
+        batch_txids.insert(tx.GetHash());
+        batch.push_back(i);
+    }
+
+    // The prevouts of the batch are all different, so each transaction's script checks only depend on
+    // the coins PreChecks put into m_view for it
+    std::vector<PrecomputedTransactionData> txdata(batch.size());
+    bool scripts_ok{false};
+    if (g_parallel_script_checks && batch.size() > 1) {
+        CCheckQueueControl<CScriptCheck> control(&scriptcheckqueue);
+        for (size_t k = 0; k < batch.size(); ++k) {
+            std::vector<CScriptCheck> vChecks;
+            CheckInputScripts(*workspaces[k].m_ptx, workspaces[k].m_state, m_view, STANDARD_SCRIPT_VERIFY_FLAGS,
+                              /* cacheSigStore = */ true, /* cacheFullScriptStore = */ false, txdata[k], &vChecks);
+            control.Add(vChecks);
+        }
+        scripts_ok = control.Wait();
+    }
+
+    for (size_t k = 0; k < batch.size(); ++k) {
+        Workspace& ws = workspaces[k];
+        const size_t i = batch[k];
+        // ConsensusScriptChecks expects every mempool parent to still be there, so recheck them first
+        if (!BatchRechecks(args[i], ws)) {
+            results[i].emplace(MempoolAcceptResult::Failure(ws.m_state));
+            continue;
+        }
+        // When a check of the batch failed, find out which transaction it belongs to one at a time. The
+        // signatures of the valid ones are in the signature cache by now.
+        if (!scripts_ok && !PolicyScriptChecks(args[i], ws, txdata[k])) {
+            results[i].emplace(MempoolAcceptResult::Failure(ws.m_state));
+            continue;
+        }
+        if (!ConsensusScriptChecks(args[i], ws, txdata[k]) || !Finalize(args[i], ws)) {
+            results[i].emplace(MempoolAcceptResult::Failure(ws.m_state));
+            continue;
+        }
+
+        GetMainSignals().TransactionAddedToMempool(ws.m_ptx, args[i].m_accept_time);
+        statsClient.inc("transactions.accepted", 1.0f);
+        statsClient.count("transactions.inputs", ws.m_ptx->vin.size(), 1.0f);
+        statsClient.count("transactions.outputs", ws.m_ptx->vout.size(), 1.0f);
+        results[i].emplace(MempoolAcceptResult::Success(ws.m_base_fees));
+    }
+
+    for (const size_t i : deferred) {
+        results[i].emplace(MemPoolAccept(m_pool, m_active_chainstate).AcceptSingleTransaction(txns[i], args[i]));
+    }
+
+    auto finish = Now<SteadyMilliseconds>();
+    statsClient.timing("AcceptToMemoryPoolBatch_ms", count_milliseconds(finish - start), 1.0f);
+
+    std::vector<MempoolAcceptResult> ret;
+    ret.reserve(results.size());
+    for (auto& result : results) {
+        ret.push_back(std::move(*result));
+    }
+    return ret;
+}
+
 } // anon namespace
 
 /** (try to) add transaction to memory pool with a specified acceptance time **/
@@ -1062,6 +1224,42 @@ MempoolAcceptResult AcceptToMemoryPool(CChainState& active_chainstate, CTxMemPoo
     return AcceptToMemoryPoolWithTime(Params(), pool, active_chainstate, tx, GetTime(), bypass_limits, test_accept);
 }
 
+/** (try to) add transactions to memory pool together, each with a specified acceptance time **/
+static std::vector<MempoolAcceptResult> AcceptToMemoryPoolBatchWithTime(const CChainParams& chainparams, CTxMemPool& pool, CChainState& active_chainstate,
+                                                                        const std::vector<CTransactionRef>& txns, const std::vector<int64_t>& accept_times)
+                                                                        EXCLUSIVE_LOCKS_REQUIRED(cs_main)
+{
+    AssertLockHeld(cs_main);
+    assert(std::all_of(txns.cbegin(), txns.cend(), [](const auto& tx){return tx != nullptr;}));
+    assert(accept_times.size() == txns.size());
+
+    std::vector<std::vector<COutPoint>> coins_to_uncache(txns.size());
+    std::vector<MemPoolAccept::ATMPArgs> args;
+    args.reserve(txns.size());
+    for (size_t i = 0; i < txns.size(); ++i) {
+        args.push_back(MemPoolAccept::ATMPArgs{ chainparams, accept_times[i], /* bypass_limits */ false, coins_to_uncache[i], /* test_accept */ false });
+    }
+
+    assert(std::addressof(::ChainstateActive()) == std::addressof(active_chainstate));
+    std::vector<MempoolAcceptResult> results = MemPoolAccept(pool, active_chainstate).AcceptTransactionBatch(txns, args);
+    for (size_t i = 0; i < txns.size(); ++i) {
+        if (results[i].m_result_type == MempoolAcceptResult::ResultType::VALID) continue;
+        LogPrint(BCLog::MEMPOOL, "%s: %s %s (%s)\n", __func__, txns[i]->GetHash().ToString(), results[i].m_state.GetRejectReason(), results[i].m_state.GetDebugMessage());
+        // Same as AcceptToMemoryPoolWithTime, the coins of different transactions of the batch are never the same
+        for (const COutPoint& hashTx : coins_to_uncache[i]) {
+            active_chainstate.CoinsTip().Uncache(hashTx);
+        }
+    }
+    BlockValidationState state_dummy;
+    active_chainstate.FlushStateToDisk(state_dummy, FlushStateMode::PERIODIC);
+    return results;
+}
+
+std::vector<MempoolAcceptResult> AcceptToMemoryPoolBatch(CChainState& active_chainstate, CTxMemPool& pool, const std::vector<CTransactionRef>& txns)
+{
+    return AcceptToMemoryPoolBatchWithTime(Params(), pool, active_chainstate, txns, std::vector<int64_t>(txns.size(), GetTime()));
+}
+
 PackageMempoolAcceptResult ProcessNewPackage(CChainState& active_chainstate, CTxMemPool& pool,
                                              const Package& package, bool test_accept)
 {
@@ -1083,55 +1281,6 @@ PackageMempoolAcceptResult ProcessNewPackage(CChainState& active_chainstate, CTx
     return result;
 }
 
-bool GetTimestampIndex(const unsigned int &high, const unsigned int &low, std::vector<uint256> &hashes)
-{
-    if (!fTimestampIndex)
-        return error("Timestamp index not enabled");
-
-    if (!pblocktree->ReadTimestampIndex(high, low, hashes))
-        return error("Unable to get hashes for timestamps");
-
-    return true;
-}
-
-bool GetSpentIndex(CTxMemPool& mempool, CSpentIndexKey &key, CSpentIndexValue &value)
-{
-    if (!fSpentIndex)
-        return false;
-
-    if (mempool.getSpentIndex(key, value))
-        return true;
-
-    if (!pblocktree->ReadSpentIndex(key, value))
-        return false;
-
-    return true;
-}
-
-bool GetAddressIndex(uint160 addressHash, AddressType type,
-                     std::vector<std::pair<CAddressIndexKey, CAmount> > &addressIndex, int start, int end)
-{
-    if (!fAddressIndex)
-        return error("address index not enabled");
-
-    if (!pblocktree->ReadAddressIndex(addressHash, type, addressIndex, start, end))
-        return error("unable to get txids for address");
-
-    return true;
-}
-
-bool GetAddressUnspent(uint160 addressHash, AddressType type,
-                       std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > &unspentOutputs)
-{
-    if (!fAddressIndex)
-        return error("address index not enabled");
-
-    if (!pblocktree->ReadAddressUnspentIndex(addressHash, type, unspentOutputs))
-        return error("unable to get txids for address");
-
-    return true;
-}
-
 
 double ConvertBitsToDouble(unsigned int nBits)
 {
@@ -1286,7 +1435,8 @@ CoinsViews::CoinsViews(
     bool in_memory,
     bool should_wipe) : m_dbview(
                             GetDataDir() / ldb_name, cache_size_bytes, in_memory, should_wipe),
-                        m_catcherview(&m_dbview) {}
+                        m_flushview(&m_dbview),
+                        m_catcherview(&m_flushview) {}
 
 void CoinsViews::InitCache()
 {
@@ -1490,6 +1640,10 @@ int BlockManager::GetSpendHeight(const CCoinsViewCache& inputs)
 
 static CuckooCache::cache<uint256, SignatureCacheHasher> g_scriptExecutionCache;
 static CSHA256 g_scriptExecutionCacheHasher;
+static perf::Counter& g_script_cache_hits{perf::GetCounter("scriptcache.hits", "Transactions whose scripts did not need to be run thanks to the script execution cache")};
+static perf::Counter& g_script_cache_misses{perf::GetCounter("scriptcache.misses", "Transactions not found in the script execution cache")};
+static perf::Counter& g_script_cache_inserts{perf::GetCounter("scriptcache.inserts", "Transactions added to the script execution cache")};
+static perf::Counter& g_script_cache_evictions{perf::GetCounter("scriptcache.evictions", "Transactions evicted from the full script execution cache")};
 
 void InitScriptExecutionCache() {
     // Setup the salted hasher
@@ -1545,8 +1699,10 @@ bool CheckInputScripts(const CTransaction& tx, TxValidationState &state, const C
     hasher.Write(tx.GetHash().begin(), 32).Write((unsigned char*)&flags, sizeof(flags)).Finalize(hashCacheEntry.begin());
     AssertLockHeld(cs_main); //TODO: Remove this requirement by making CuckooCache not require external locks
     if (g_scriptExecutionCache.contains(hashCacheEntry, !cacheFullScriptStore)) {
+        g_script_cache_hits.Add();
         return true;
     }
+    g_script_cache_misses.Add();
 
     if (!txdata.m_ready) {
         txdata.Init(tx, {});
@@ -1602,7 +1758,8 @@ bool CheckInputScripts(const CTransaction& tx, TxValidationState &state, const C
     if (cacheFullScriptStore && !pvChecks) {
         // We executed all of the provided scripts, and were told to
         // cache the result. Do so now.
-        g_scriptExecutionCache.insert(hashCacheEntry);
+        g_script_cache_inserts.Add();
+        if (g_scriptExecutionCache.insert(hashCacheEntry)) g_script_cache_evictions.Add();
     }
 
     auto finish = Now<SteadyMilliseconds>();
@@ -1611,6 +1768,31 @@ bool CheckInputScripts(const CTransaction& tx, TxValidationState &state, const C
     return true;
 }
 
+void PrecheckBlockTxScripts(CChainState& active_chainstate, const CBlockIndex* pindex, const std::vector<CTransactionRef>& txs)
+{
+    AssertLockHeld(cs_main);
+    if (pindex->pprev != active_chainstate.m_chain.Tip()) {
+        return;
+    }
+
+    const unsigned int flags = GetBlockScriptFlags(pindex, Params().GetConsensus());
+    CCoinsViewCache view(&active_chainstate.CoinsTip());
+    size_t nChecked = 0;
+    for (const auto& tx : txs) {
+        // Missing ones are nullptr, transactions spending outputs of the same block are left to ConnectBlock
+        if (!tx || tx->IsCoinBase()) continue;
+        if (!std::all_of(tx->vin.begin(), tx->vin.end(), [&view](const CTxIn& txin) { return view.HaveCoin(txin.prevout); })) {
+            continue;
+        }
+        // Successful checks end up in the script execution cache, all we care about
+        PrecomputedTransactionData txdata;
+        TxValidationState tx_state;
+        CheckInputScripts(*tx, tx_state, view, flags, /* cacheSigStore = */ true, /* cacheFullScriptStore = */ true, txdata);
+        ++nChecked;
+    }
+    statsClient.count("blocks.compact.txs_prechecked", nChecked, 1.0f);
+}
+
 static bool UndoWriteToDisk(const CBlockUndo& blockundo, FlatFilePos& pos, const uint256& hashBlock, const CMessageHeader::MessageStartChars& messageStart)
 {
     // Open history file to append
@@ -1618,22 +1800,28 @@ static bool UndoWriteToDisk(const CBlockUndo& blockundo, FlatFilePos& pos, const
     if (fileout.IsNull())
         return error("%s: OpenUndoFile failed", __func__);
 
-    // Write index header
+    // Serialize the whole record first, so it reaches the file in a single write
     unsigned int nSize = GetSerializeSize(blockundo, fileout.GetVersion());
-    fileout << messageStart << nSize;
+    CDataStream record(SER_DISK, CLIENT_VERSION);
+    record.reserve(nSize + 40);
+
+    // Write index header
+    record << messageStart << nSize;
 
     // Write undo data
     long fileOutPos = ftell(fileout.Get());
     if (fileOutPos < 0)
         return error("%s: ftell failed", __func__);
-    pos.nPos = (unsigned int)fileOutPos;
-    fileout << blockundo;
+    pos.nPos = (unsigned int)fileOutPos + record.size();
+    record << blockundo;
 
     // calculate & write checksum
     CHashWriter hasher(SER_GETHASH, PROTOCOL_VERSION);
     hasher << hashBlock;
     hasher << blockundo;
-    fileout << hasher.GetHash();
+    record << hasher.GetHash();
+
+    fileout.write(MakeByteSpan(record));
 
     return true;
 }
@@ -1645,6 +1833,11 @@ bool UndoReadFromDisk(CBlockUndo& blockundo, const CBlockIndex* pindex)
         return error("%s: no undo data available", __func__);
     }
 
+    return UndoReadFromDisk(blockundo, pos, pindex->pprev->GetBlockHash());
+}
+
+bool UndoReadFromDisk(CBlockUndo& blockundo, const FlatFilePos& pos, const uint256& hash_prev_block)
+{
     // Open history file to read
     CAutoFile filein(OpenUndoFile(pos, true), SER_DISK, CLIENT_VERSION);
     if (filein.IsNull())
@@ -1654,7 +1847,7 @@ bool UndoReadFromDisk(CBlockUndo& blockundo, const CBlockIndex* pindex)
     uint256 hashChecksum;
     CHashVerifier<CAutoFile> verifier(&filein); // We need a CHashVerifier as reserializing may lose data
     try {
-        verifier << pindex->pprev->GetBlockHash();
+        verifier << hash_prev_block;
         verifier >> blockundo;
         filein >> hashChecksum;
     }
@@ -1712,7 +1905,8 @@ int ApplyTxInUndo(Coin&& undo, CCoinsViewCache& view, const COutPoint& out)
 
 /** Undo the effects of this block (with given index) on the UTXO set represented by coins.
  *  When FAILED is returned, view is left in an indeterminate state. */
-DisconnectResult CChainState::DisconnectBlock(const CBlock& block, const CBlockIndex* pindex, CCoinsViewCache& view)
+DisconnectResult CChainState::DisconnectBlock(const CBlock& block, const CBlockIndex* pindex, CCoinsViewCache& view,
+                                              std::optional<MNListUpdates>* mnlist_updates)
 {
     AssertLockHeld(cs_main);
     assert(m_quorum_block_processor);
@@ -1739,10 +1933,6 @@ DisconnectResult CChainState::DisconnectBlock(const CBlock& block, const CBlockI
         return DISCONNECT_FAILED;
     }
 
-    std::vector<std::pair<CAddressIndexKey, CAmount> > addressIndex;
-    std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > addressUnspentIndex;
-    std::vector<std::pair<CSpentIndexKey, CSpentIndexValue> > spentIndex;
-
     std::optional<MNListUpdates> mnlist_updates_opt{std::nullopt};
     if (!UndoSpecialTxsInBlock(block, pindex, m_mnhfManager, *m_quorum_block_processor, mnlist_updates_opt)) {
         error("DisconnectBlock(): UndoSpecialTxsInBlock failed");
@@ -1755,25 +1945,6 @@ DisconnectResult CChainState::DisconnectBlock(const CBlock& block, const CBlockI
         uint256 hash = tx.GetHash();
         bool is_coinbase = tx.IsCoinBase();
 
-        if (fAddressIndex) {
-            for (unsigned int k = tx.vout.size(); k-- > 0;) {
-                const CTxOut &out = tx.vout[k];
-
-                AddressType address_type{AddressType::UNKNOWN};
-                uint160 address_bytes;
-
-                if (!AddressBytesFromScript(out.scriptPubKey, address_type, address_bytes)) {
-                    continue;
-                }
-
-                // undo receiving activity
-                addressIndex.push_back(std::make_pair(CAddressIndexKey(address_type, address_bytes, pindex->nHeight, i, hash, k, false), out.nValue));
-
-                // undo unspent index
-                addressUnspentIndex.push_back(std::make_pair(CAddressUnspentKey(address_type, address_bytes, hash, k), CAddressUnspentValue()));
-            }
-        }
-
         // Check that all outputs are available and match the outputs in the block itself
         // exactly.
         for (size_t o = 0; o < tx.vout.size(); o++) {
@@ -1796,71 +1967,21 @@ DisconnectResult CChainState::DisconnectBlock(const CBlock& block, const CBlockI
             }
             for (unsigned int j = tx.vin.size(); j-- > 0;) {
                 const COutPoint &out = tx.vin[j].prevout;
-                int undoHeight = txundo.vprevout[j].nHeight;
                 int res = ApplyTxInUndo(std::move(txundo.vprevout[j]), view, out);
                 if (res == DISCONNECT_FAILED) return DISCONNECT_FAILED;
                 fClean = fClean && res != DISCONNECT_UNCLEAN;
-
-                const CTxIn input = tx.vin[j];
-
-                if (fSpentIndex) {
-                    // undo and delete the spent index
-                    spentIndex.push_back(std::make_pair(CSpentIndexKey(input.prevout.hash, input.prevout.n), CSpentIndexValue()));
-                }
-
-                if (fAddressIndex) {
-                    const Coin &coin = view.AccessCoin(tx.vin[j].prevout);
-                    const CTxOut &prevout = coin.out;
-
-                    AddressType address_type{AddressType::UNKNOWN};
-                    uint160 address_bytes;
-
-                    if (!AddressBytesFromScript(prevout.scriptPubKey, address_type, address_bytes)) {
-                        continue;
-                    }
-
-                    // undo spending activity
-                    addressIndex.push_back(std::make_pair(CAddressIndexKey(address_type, address_bytes, pindex->nHeight, i, hash, j, true), prevout.nValue * -1));
-
-                    // restore unspent index
-                    addressUnspentIndex.push_back(std::make_pair(CAddressUnspentKey(address_type, address_bytes, input.prevout.hash, input.prevout.n), CAddressUnspentValue(prevout.nValue, prevout.scriptPubKey, undoHeight)));
-                }
             }
             // At this point, all of txundo.vprevout should have been moved out.
         }
     }
 
-
-    if (fSpentIndex) {
-        if (!pblocktree->UpdateSpentIndex(spentIndex)) {
-            AbortNode("Failed to delete spent index");
-            return DISCONNECT_FAILED;
-        }
-    }
-
-    if (fAddressIndex) {
-        if (!pblocktree->EraseAddressIndex(addressIndex)) {
-            AbortNode("Failed to delete address index");
-            return DISCONNECT_FAILED;
-        }
-        if (!pblocktree->UpdateAddressUnspentIndex(addressUnspentIndex)) {
-            AbortNode("Failed to write address unspent index");
-            return DISCONNECT_FAILED;
-        }
-    }
-
-    if (fTimestampIndex) {
-        if (!pblocktree->EraseTimestampIndex(CTimestampIndexKey(pindex->nTime, pindex->GetBlockHash()))) {
-            AbortNode("Failed to delete timestamp index");
-            return DISCONNECT_FAILED;
-        }
-    }
-
     // move best block pointer to prevout block
     view.SetBestBlock(pindex->pprev->GetBlockHash());
     m_evoDb.WriteBestBlock(pindex->pprev->GetBlockHash());
 
-    if (mnlist_updates_opt.has_value()) {
+    if (mnlist_updates) {
+        *mnlist_updates = std::move(mnlist_updates_opt);
+    } else if (mnlist_updates_opt.has_value()) {
         auto mnlu = mnlist_updates_opt.value();
         GetMainSignals().NotifyMasternodeListChanged(true, mnlu.old_list, mnlu.diff);
         uiInterface.NotifyMasternodeListChanged(mnlu.new_list, pindex->pprev);
@@ -1873,10 +1994,10 @@ DisconnectResult CChainState::DisconnectBlock(const CBlock& block, const CBlockI
     return fClean ? DISCONNECT_OK : DISCONNECT_UNCLEAN;
 }
 
-static void FlushUndoFile(int block_file, bool finalize = false)
+static void FlushUndoFile(int block_file, bool finalize = false, bool commit_dir = true)
 {
     FlatFilePos undo_pos_old(block_file, vinfoBlockFile[block_file].nUndoSize);
-    if (!UndoFileSeq().Flush(undo_pos_old, finalize)) {
+    if (!UndoFileSeq().Flush(undo_pos_old, finalize, commit_dir)) {
         AbortNode("Flushing undo file to disk failed. This is likely the result of an I/O error.");
     }
 }
@@ -1885,12 +2006,14 @@ static void FlushBlockFile(bool fFinalize = false, bool finalize_undo = false)
 {
     LOCK(cs_LastBlockFile);
     FlatFilePos block_pos_old(nLastBlockFile, vinfoBlockFile[nLastBlockFile].nSize);
-    if (!BlockFileSeq().Flush(block_pos_old, fFinalize)) {
+    // Block and undo files share the blocks directory, which is committed once for both
+    if (!BlockFileSeq().Flush(block_pos_old, fFinalize, /* commit_dir */ false)) {
         AbortNode("Flushing block file to disk failed. This is likely the result of an I/O error.");
     }
     // we do not always flush the undo file, as the chain tip may be lagging behind the incoming blocks,
     // e.g. during IBD or a sync after a node going offline
-    if (!fFinalize || finalize_undo) FlushUndoFile(nLastBlockFile, finalize_undo);
+    if (!fFinalize || finalize_undo) FlushUndoFile(nLastBlockFile, finalize_undo, /* commit_dir */ false);
+    BlockFileSeq().CommitDirectory();
 }
 
 static bool FindUndoPos(BlockValidationState &state, int nFile, FlatFilePos &pos, unsigned int nAddSize);
@@ -1922,11 +2045,9 @@ static bool WriteUndoDataForBlock(const CBlockUndo& blockundo, BlockValidationSt
     return true;
 }
 
-static CCheckQueue<CScriptCheck> scriptcheckqueue(128);
-
-void StartScriptCheckWorkerThreads(int threads_num)
+void StartScriptCheckWorkerThreads(int threads_num, bool pin_threads)
 {
-    scriptcheckqueue.StartWorkerThreads(threads_num);
+    scriptcheckqueue.StartWorkerThreads(threads_num, "scriptch", pin_threads);
 }
 
 void StopScriptCheckWorkerThreads()
@@ -1934,6 +2055,77 @@ void StopScriptCheckWorkerThreads()
     scriptcheckqueue.StopWorkerThreads();
 }
 
+/** Computes the PoW hash of a single header for headerhashqueue */
+class CHeaderHashCheck
+{
+private:
+    const CBlockHeader* m_header{nullptr};
+    uint256* m_hash{nullptr};
+
+public:
+    CHeaderHashCheck() = default;
+    CHeaderHashCheck(const CBlockHeader& header, uint256& hash) : m_header(&header), m_hash(&hash) {}
+
+    bool operator()()
+    {
+        *m_hash = m_header->GetHash();
+        return true;
+    }
+
+    void swap(CHeaderHashCheck& check) noexcept
+    {
+        std::swap(m_header, check.m_header);
+        std::swap(m_hash, check.m_hash);
+    }
+};
+
+/** ProTx payload signatures, mostly BLS, are expensive too */
+static CCheckQueue<CProTxSigCheck> protxsigcheckqueue(8);
+
+void StartProTxSigCheckWorkerThreads(int threads_num)
+{
+    protxsigcheckqueue.StartWorkerThreads(threads_num, "protxsig");
+}
+
+void StopProTxSigCheckWorkerThreads()
+{
+    protxsigcheckqueue.StopWorkerThreads();
+}
+
+/** Each header costs a full X16R chain or a progpow hash, so keep batches small */
+static CCheckQueue<CHeaderHashCheck> headerhashqueue(8);
+
+void StartHeaderHashWorkerThreads(int threads_num)
+{
+    headerhashqueue.StartWorkerThreads(threads_num, "hdrhash");
+}
+
+void StopHeaderHashWorkerThreads()
+{
+    headerhashqueue.StopWorkerThreads();
+}
+
+std::vector<uint256> HashBlockHeaders(const std::vector<CBlockHeader>& headers)
+{
+    AssertLockNotHeld(cs_main);
+    std::vector<uint256> hashes(headers.size());
+    if (headers.size() == 1) {
+        hashes[0] = headers[0].GetHash();
+        return hashes;
+    }
+
+    std::vector<CHeaderHashCheck> checks;
+    checks.reserve(headers.size());
+    for (size_t i = 0; i < headers.size(); ++i) {
+        checks.emplace_back(headers[i], hashes[i]);
+    }
+    // The calling thread joins the workers until every hash is done
+    CCheckQueueControl<CHeaderHashCheck> control(&headerhashqueue);
+    control.Add(checks);
+    control.Wait();
+    return hashes;
+}
+
 bool GetBlockHash(uint256& hashRet, int nBlockHeight)
 {
     LOCK(cs_main);
@@ -2022,10 +2214,19 @@ static int64_t nTimePayeeValid = 0;
 static int64_t nTimeProcessSpecial = 0;
 static int64_t nTimeDashSpecific = 0;
 static int64_t nTimeConnect = 0;
-static int64_t nTimeIndexConnect = 0;
-static int64_t nTimeIndexWrite = 0;
 static int64_t nTimeCallbacks = 0;
 static int64_t nTimeTotal = 0;
+static perf::Histogram& g_perf_check{perf::GetHistogram("validation.connectblock.check", "Time of the context free checks of a block in ConnectBlock")};
+static perf::Histogram& g_perf_forks{perf::GetHistogram("validation.connectblock.forks", "Time to determine the script flags of a block")};
+static perf::Histogram& g_perf_process_special{perf::GetHistogram("validation.connectblock.processspecial", "Time to process the special transactions of a block")};
+static perf::Histogram& g_perf_connect_txs{perf::GetHistogram("validation.connectblock.connecttxs", "Time to process the special transactions and update the coins of a block")};
+static perf::Histogram& g_perf_credit_pool{perf::GetHistogram("validation.connectblock.creditpool", "Time to check the credit pool changes of a block")};
+static perf::Histogram& g_perf_block_value{perf::GetHistogram("validation.connectblock.blockvalue", "Time to check the value of a block")};
+static perf::Histogram& g_perf_block_payee{perf::GetHistogram("validation.connectblock.blockpayee", "Time to check the masternode and superblock payments of a block")};
+static perf::Histogram& g_perf_is_filter{perf::GetHistogram("validation.connectblock.isfilter", "Time to check the transactions of a block against InstantSend locks")};
+static perf::Histogram& g_perf_callbacks{perf::GetHistogram("validation.connectblock.callbacks", "Time to write the undo data and notify the masternode list changes of a block")};
+static perf::Histogram& g_perf_verify{perf::GetHistogram("validation.connectblock.verify", "Time to connect the transactions of a block and verify their scripts")};
+static perf::Histogram& g_perf_dash_specific{perf::GetHistogram("validation.connectblock.dashspecific", "Time of the Dash specific checks of a block")};
 static int64_t nBlocksTotal = 0;
 
 /** Apply the effects of this block (with given index) on the UTXO set represented by coins.
@@ -2039,8 +2240,8 @@ bool CChainState::ConnectBlock(const CBlock& block, BlockValidationState& state,
     AssertLockHeld(cs_main);
     assert(pindex);
 
-    uint256 block_hash{block.GetHash()};
-    assert(*pindex->phashBlock == block_hash);
+    const uint256 block_hash{pindex->GetBlockHash()};
+    assert(block.GetHash() == block_hash);
 
     assert(m_clhandler);
     assert(m_isman);
@@ -2071,6 +2272,9 @@ bool CChainState::ConnectBlock(const CBlock& block, BlockValidationState& state,
 
     if (pindex->pprev && pindex->phashBlock && m_clhandler->HasConflictingChainLock(pindex->nHeight, pindex->GetBlockHash())) {
         LogPrintf("ERROR: %s: conflicting with chainlock\n", __func__);
+        TRACE2(validation, chainlock_conflict,
+            pindex->GetBlockHash().data(),
+            pindex->nHeight);
         return state.Invalid(BlockValidationResult::BLOCK_CHAINLOCK, "bad-chainlock");
     }
 
@@ -2127,6 +2331,7 @@ bool CChainState::ConnectBlock(const CBlock& block, BlockValidationState& state,
     }
 
     int64_t nTime1 = GetTimeMicros(); nTimeCheck += nTime1 - nTimeStart;
+    g_perf_check.Observe(nTime1 - nTimeStart);
     LogPrint(BCLog::BENCHMARK, "    - Sanity checks: %.2fms [%.2fs (%.2fms/blk)]\n", MILLI * (nTime1 - nTimeStart), nTimeCheck * MICRO, nTimeCheck * MILLI / nBlocksTotal);
 
     // Do not allow blocks that contain transactions which 'overwrite' older transactions,
@@ -2187,6 +2392,7 @@ bool CChainState::ConnectBlock(const CBlock& block, BlockValidationState& state,
     unsigned int flags = GetBlockScriptFlags(pindex, m_params.GetConsensus());
 
     int64_t nTime2 = GetTimeMicros(); nTimeForks += nTime2 - nTime1;
+    g_perf_forks.Observe(nTime2 - nTime1);
     LogPrint(BCLog::BENCHMARK, "    - Fork checks: %.2fms [%.2fs (%.2fms/blk)]\n", MILLI * (nTime2 - nTime1), nTimeForks * MICRO, nTimeForks * MILLI / nBlocksTotal);
 
     CBlockUndo blockundo;
@@ -2198,30 +2404,28 @@ bool CChainState::ConnectBlock(const CBlock& block, BlockValidationState& state,
     // for as long as `control`.
     CCheckQueueControl<CScriptCheck> control(fScriptChecks && g_parallel_script_checks ? &scriptcheckqueue : nullptr);
     std::vector<PrecomputedTransactionData> txsdata(block.vtx.size());
+    CCheckQueueControl<CProTxSigCheck> protx_sig_control(fScriptChecks && g_parallel_script_checks ? &protxsigcheckqueue : nullptr);
 
     std::vector<int> prevheights;
     CAmount nFees = 0;
     int nInputs = 0;
     unsigned int nSigOps = 0;
     blockundo.vtxundo.reserve(block.vtx.size() - 1);
-    std::vector<std::pair<CAddressIndexKey, CAmount> > addressIndex;
-    std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > addressUnspentIndex;
-    std::vector<std::pair<CSpentIndexKey, CSpentIndexValue> > spentIndex;
 
     bool fDIP0001Active_context = pindex->nHeight >= Params().GetConsensus().DIP0001Height;
 
     // MUST process special txes before updating UTXO to ensure consistency between mempool and block processing
     std::optional<MNListUpdates> mnlist_updates_opt{std::nullopt};
-    if (!ProcessSpecialTxsInBlock(block, pindex, m_mnhfManager, *m_quorum_block_processor, *m_clhandler, m_params.GetConsensus(), view, fJustCheck, fScriptChecks, state, mnlist_updates_opt)) {
+    if (!ProcessSpecialTxsInBlock(block, pindex, m_mnhfManager, *m_quorum_block_processor, *m_clhandler, m_params.GetConsensus(), view, fJustCheck, fScriptChecks, state, mnlist_updates_opt,
+                                  fScriptChecks && g_parallel_script_checks ? &protx_sig_control : nullptr)) {
         return error("ConnectBlock(DASH): ProcessSpecialTxsInBlock for block %s failed with %s",
                      pindex->GetBlockHash().ToString(), state.ToString());
     }
 
     int64_t nTime2_1 = GetTimeMicros(); nTimeProcessSpecial += nTime2_1 - nTime2;
+    g_perf_process_special.Observe(nTime2_1 - nTime2);
     LogPrint(BCLog::BENCHMARK, "      - ProcessSpecialTxsInBlock: %.2fms [%.2fs (%.2fms/blk)]\n", MILLI * (nTime2_1 - nTime2), nTimeProcessSpecial * MICRO, nTimeProcessSpecial * MILLI / nBlocksTotal);
 
-    int64_t nTime2_index = 0;
-
     for (unsigned int i = 0; i < block.vtx.size(); i++)
     {
         const CTransaction &tx = *(block.vtx[i]);
@@ -2257,37 +2461,6 @@ bool CChainState::ConnectBlock(const CBlock& block, BlockValidationState& state,
                 LogPrintf("ERROR: %s: contains a non-BIP68-final transaction\n", __func__);
                 return state.Invalid(BlockValidationResult::BLOCK_CONSENSUS, "bad-txns-nonfinal");
             }
-
-            if (fAddressIndex || fSpentIndex)
-            {
-                int64_t nTime2_index1 = GetTimeMicros();
-
-                for (size_t j = 0; j < tx.vin.size(); j++) {
-                    const CTxIn input = tx.vin[j];
-                    const Coin& coin = view.AccessCoin(tx.vin[j].prevout);
-                    const CTxOut &prevout = coin.out;
-
-                    AddressType address_type{AddressType::UNKNOWN};
-                    uint160 address_bytes;
-
-                    AddressBytesFromScript(prevout.scriptPubKey, address_type, address_bytes);
-
-                    if (fAddressIndex && address_type != AddressType::UNKNOWN) {
-                        // record spending activity
-                        addressIndex.push_back(std::make_pair(CAddressIndexKey(address_type, address_bytes, pindex->nHeight, i, txhash, j, true), prevout.nValue * -1));
-
-                        // remove address from unspent index
-                        addressUnspentIndex.push_back(std::make_pair(CAddressUnspentKey(address_type, address_bytes, input.prevout.hash, input.prevout.n), CAddressUnspentValue()));
-                    }
-
-                    if (fSpentIndex) {
-                        // add the spent index to determine the txid and input that spent an output
-                        // and to find the amount and address from an input
-                        spentIndex.push_back(std::make_pair(CSpentIndexKey(input.prevout.hash, input.prevout.n), CSpentIndexValue(txhash, j, pindex->nHeight, prevout.nValue, address_type, address_bytes)));
-                    }
-                }
-                nTime2_index += GetTimeMicros() - nTime2_index1;
-            }
         }
 
         // GetTransactionSigOpCount counts 2 types of sigops:
@@ -2316,27 +2489,6 @@ bool CChainState::ConnectBlock(const CBlock& block, BlockValidationState& state,
             control.Add(vChecks);
         }
 
-        if (fAddressIndex) {
-            int64_t nTime2_index2 = GetTimeMicros();
-            for (unsigned int k = 0; k < tx.vout.size(); k++) {
-                const CTxOut &out = tx.vout[k];
-
-                AddressType address_type{AddressType::UNKNOWN};
-                uint160 address_bytes;
-
-                if (!AddressBytesFromScript(out.scriptPubKey, address_type, address_bytes)) {
-                    continue;
-                }
-
-                // record receiving activity
-                addressIndex.push_back(std::make_pair(CAddressIndexKey(address_type, address_bytes, pindex->nHeight, i, txhash, k, false), out.nValue));
-
-                // record unspent output
-                addressUnspentIndex.push_back(std::make_pair(CAddressUnspentKey(address_type, address_bytes, txhash, k), CAddressUnspentValue(out.nValue, out.scriptPubKey, pindex->nHeight)));
-            }
-            nTime2_index += GetTimeMicros() - nTime2_index2;
-        }
-
         CTxUndo undoDummy;
         if (i > 0) {
             blockundo.vtxundo.push_back(CTxUndo());
@@ -2344,22 +2496,74 @@ bool CChainState::ConnectBlock(const CBlock& block, BlockValidationState& state,
         UpdateCoins(tx, view, i == 0 ? undoDummy : blockundo.vtxundo.back(), pindex->nHeight);
     }
 
-    nTimeIndexConnect += nTime2_index;
-    LogPrint(BCLog::BENCHMARK, "        - Connect index: %.2fms [%.2fs (%.2fms/blk)]\n", MILLI * nTime2_index, nTimeIndexConnect * MICRO, nTimeIndexConnect * MILLI / nBlocksTotal);
     int64_t nTime3 = GetTimeMicros(); nTimeConnect += nTime3 - nTime2;
+    g_perf_connect_txs.Observe(nTime3 - nTime2);
     LogPrint(BCLog::BENCHMARK, "      - Connect %u transactions: %.2fms (%.3fms/tx, %.3fms/txin) [%.2fs (%.2fms/blk)]\n", (unsigned)block.vtx.size(), MILLI * (nTime3 - nTime2), MILLI * (nTime3 - nTime2) / block.vtx.size(), nInputs <= 1 ? 0 : MILLI * (nTime3 - nTime2) / (nInputs-1), nTimeConnect * MICRO, nTimeConnect * MILLI / nBlocksTotal);
 
 
+    // DASH : MODIFIED TO CHECK MASTERNODE PAYMENTS AND SUPERBLOCKS
+
+    // The script and ProTx signature checks are still running on the check queue threads, run checks which
+    // don't depend on them in the meantime. Their result is only looked at after the script checks and the
+    // InstantSend checks below, so a block failing several checks is still rejected for the same reason.
+    BlockValidationState dash_state;
+    CAmount blockSubsidy = GetBlockSubsidy(pindex, m_params.GetConsensus());
+    CAmount feeReward = nFees;
+
+    int64_t nTime3_1 = GetTimeMicros(); nTimeSubsidy += nTime3_1 - nTime3;
+    LogPrint(BCLog::BENCHMARK, "      - GetBlockSubsidy: %.2fms [%.2fs (%.2fms/blk)]\n", MILLI * (nTime3_1 - nTime3), nTimeSubsidy * MICRO, nTimeSubsidy * MILLI / nBlocksTotal);
+
+    const bool fDashPaymentsValid = [&]() {
+        // TODO: resync data (both ways?) and try to reprocess this block later.
+        std::string strError = "";
+
+        int64_t nTime3_2 = GetTimeMicros();
+        if (!CheckCreditPoolDiffForBlock(block, pindex, m_params.GetConsensus(), blockSubsidy, dash_state)) {
+            return error("ConnectBlock(DASH): CheckCreditPoolDiffForBlock for block %s failed with %s",
+                         pindex->GetBlockHash().ToString(), dash_state.ToString());
+        }
+
+        int64_t nTime3_3 = GetTimeMicros(); nTimeCreditPool += nTime3_3 - nTime3_2;
+        g_perf_credit_pool.Observe(nTime3_3 - nTime3_2);
+        LogPrint(BCLog::BENCHMARK, "      - CheckCreditPoolDiffForBlock: %.2fms [%.2fs (%.2fms/blk)]\n", MILLI * (nTime3_3 - nTime3_2), nTimeCreditPool * MICRO, nTimeCreditPool * MILLI / nBlocksTotal);
+
+        if (!MasternodePayments::IsBlockValueValid(*sporkManager, *governance, *::masternodeSync, block, pindex->nHeight, blockSubsidy + feeReward, strError)) {
+            // NOTE: Do not punish, the node might be missing governance data
+            LogPrintf("ERROR: ConnectBlock(DASH): %s\n", strError);
+            return dash_state.Invalid(BlockValidationResult::BLOCK_RESULT_UNSET, "bad-cb-amount");
+        }
+
+        int64_t nTime3_4 = GetTimeMicros(); nTimeValueValid += nTime3_4 - nTime3_3;
+        g_perf_block_value.Observe(nTime3_4 - nTime3_3);
+        LogPrint(BCLog::BENCHMARK, "      - IsBlockValueValid: %.2fms [%.2fs (%.2fms/blk)]\n", MILLI * (nTime3_4 - nTime3_3), nTimeValueValid * MICRO, nTimeValueValid * MILLI / nBlocksTotal);
+
+        if (!MasternodePayments::IsBlockPayeeValid(*sporkManager, *governance, *::masternodeSync, *block.vtx[0], pindex->pprev, blockSubsidy, feeReward)) {
+            // NOTE: Do not punish, the node might be missing governance data
+            LogPrintf("ERROR: ConnectBlock(DASH): couldn't find masternode or superblock payments\n");
+            return dash_state.Invalid(BlockValidationResult::BLOCK_RESULT_UNSET, "bad-cb-payee");
+        }
+
+        int64_t nTime3_5 = GetTimeMicros(); nTimePayeeValid += nTime3_5 - nTime3_4;
+        g_perf_block_payee.Observe(nTime3_5 - nTime3_4);
+        LogPrint(BCLog::BENCHMARK, "      - IsBlockPayeeValid: %.2fms [%.2fs (%.2fms/blk)]\n", MILLI * (nTime3_5 - nTime3_4), nTimePayeeValid * MICRO, nTimePayeeValid * MILLI / nBlocksTotal);
+        return true;
+    }();
+
+    int64_t nTime3_6 = GetTimeMicros(); nTimeDashSpecific += nTime3_6 - nTime3;
+
     if (!control.Wait()) {
         LogPrintf("ERROR: %s: CheckQueue failed\n", __func__);
         return state.Invalid(BlockValidationResult::BLOCK_CONSENSUS, "block-validation-failed");
     }
+    if (!protx_sig_control.Wait()) {
+        LogPrintf("ERROR: %s: ProTx signature check failed\n", __func__);
+        return state.Invalid(BlockValidationResult::BLOCK_CONSENSUS, "bad-protx-sig");
+    }
     int64_t nTime4 = GetTimeMicros(); nTimeVerify += nTime4 - nTime2;
+    g_perf_verify.Observe(nTime4 - nTime2);
     LogPrint(BCLog::BENCHMARK, "    - Verify %u txins: %.2fms (%.3fms/txin) [%.2fs (%.2fms/blk)]\n", nInputs - 1, MILLI * (nTime4 - nTime2), nInputs <= 1 ? 0 : MILLI * (nTime4 - nTime2) / (nInputs-1), nTimeVerify * MICRO, nTimeVerify * MILLI / nBlocksTotal);
 
 
-    // DASH
-
     // It's possible that we simply don't have enough data and this could fail
     // (i.e. block itself could be a correct one and we need to store it),
     // that's why this is in ConnectBlock. Could be the other way around however -
@@ -2368,6 +2572,7 @@ bool CChainState::ConnectBlock(const CBlock& block, BlockValidationState& state,
 
     // DASH : CHECK TRANSACTIONS FOR INSTANTSEND
 
+    // Runs only after the script checks passed as it may drop conflicting islocks
     if (m_isman->RejectConflictingBlocks()) {
         // Require other nodes to comply, send them some data in case they are missing it.
         for (const auto& tx : block.vtx) {
@@ -2377,6 +2582,10 @@ bool CChainState::ConnectBlock(const CBlock& block, BlockValidationState& state,
                 if (m_clhandler->HasChainLock(pindex->nHeight, pindex->GetBlockHash())) {
                     LogPrint(BCLog::ALL, "ConnectBlock(DASH): chain-locked transaction %s overrides islock %s\n",
                             tx->GetHash().ToString(), ::SerializeHash(*conflictLock).ToString());
+                    TRACE3(validation, islock_overridden,
+                        pindex->GetBlockHash().data(),
+                        tx->GetHash().data(),
+                        conflictLock->txid.data());
                     m_isman->RemoveConflictingLock(::SerializeHash(*conflictLock), *conflictLock);
                 } else {
                     // The node which relayed this should switch to correct chain.
@@ -2388,48 +2597,24 @@ bool CChainState::ConnectBlock(const CBlock& block, BlockValidationState& state,
         }
     }
 
-    int64_t nTime5_1 = GetTimeMicros(); nTimeISFilter += nTime5_1 - nTime4;
-    LogPrint(BCLog::BENCHMARK, "      - IS filter: %.2fms [%.2fs (%.2fms/blk)]\n", MILLI * (nTime5_1 - nTime4), nTimeISFilter * MICRO, nTimeISFilter * MILLI / nBlocksTotal);
-
-    // DASH : MODIFIED TO CHECK MASTERNODE PAYMENTS AND SUPERBLOCKS
-
-    // TODO: resync data (both ways?) and try to reprocess this block later.
-    CAmount blockSubsidy = GetBlockSubsidy(pindex, m_params.GetConsensus());
-    CAmount feeReward = nFees;
-    std::string strError = "";
+    int64_t nTime5 = GetTimeMicros(); nTimeISFilter += nTime5 - nTime4; nTimeDashSpecific += nTime5 - nTime4;
+    g_perf_is_filter.Observe(nTime5 - nTime4);
+    LogPrint(BCLog::BENCHMARK, "      - IS filter: %.2fms [%.2fs (%.2fms/blk)]\n", MILLI * (nTime5 - nTime4), nTimeISFilter * MICRO, nTimeISFilter * MILLI / nBlocksTotal);
+    LogPrint(BCLog::BENCHMARK, "    - Dash specific: %.2fms [%.2fs (%.2fms/blk)]\n", MILLI * (nTime3_6 - nTime3 + nTime5 - nTime4), nTimeDashSpecific * MICRO, nTimeDashSpecific * MILLI / nBlocksTotal);
+    g_perf_dash_specific.Observe(nTime3_6 - nTime3 + nTime5 - nTime4);
+    TRACE6(validation, dash_checks_done,
+        pindex->GetBlockHash().data(),
+        pindex->nHeight,
+        fDashPaymentsValid,
+        nTime2_1 - nTime2,
+        nTime3_6 - nTime3,
+        nTime5 - nTime4);
 
-    int64_t nTime5_2 = GetTimeMicros(); nTimeSubsidy += nTime5_2 - nTime5_1;
-    LogPrint(BCLog::BENCHMARK, "      - GetBlockSubsidy: %.2fms [%.2fs (%.2fms/blk)]\n", MILLI * (nTime5_2 - nTime5_1), nTimeSubsidy * MICRO, nTimeSubsidy * MILLI / nBlocksTotal);
-
-    if (!CheckCreditPoolDiffForBlock(block, pindex, m_params.GetConsensus(), blockSubsidy, state)) {
-        return error("ConnectBlock(DASH): CheckCreditPoolDiffForBlock for block %s failed with %s",
-                     pindex->GetBlockHash().ToString(), state.ToString());
-    }
-
-    int64_t nTime5_3 = GetTimeMicros(); nTimeCreditPool += nTime5_3 - nTime5_2;
-    LogPrint(BCLog::BENCHMARK, "      - CheckCreditPoolDiffForBlock: %.2fms [%.2fs (%.2fms/blk)]\n", MILLI * (nTime5_3 - nTime5_2), nTimeCreditPool * MICRO, nTimeCreditPool * MILLI / nBlocksTotal);
-
-    if (!MasternodePayments::IsBlockValueValid(*sporkManager, *governance, *::masternodeSync, block, pindex->nHeight, blockSubsidy + feeReward, strError)) {
-        // NOTE: Do not punish, the node might be missing governance data
-        LogPrintf("ERROR: ConnectBlock(DASH): %s\n", strError);
-        return state.Invalid(BlockValidationResult::BLOCK_RESULT_UNSET, "bad-cb-amount");
-    }
-
-    int64_t nTime5_4 = GetTimeMicros(); nTimeValueValid += nTime5_4 - nTime5_3;
-    LogPrint(BCLog::BENCHMARK, "      - IsBlockValueValid: %.2fms [%.2fs (%.2fms/blk)]\n", MILLI * (nTime5_4 - nTime5_3), nTimeValueValid * MICRO, nTimeValueValid * MILLI / nBlocksTotal);
-
-    if (!MasternodePayments::IsBlockPayeeValid(*sporkManager, *governance, *::masternodeSync, *block.vtx[0], pindex->pprev, blockSubsidy, feeReward)) {
-        // NOTE: Do not punish, the node might be missing governance data
-        LogPrintf("ERROR: ConnectBlock(DASH): couldn't find masternode or superblock payments\n");
-        return state.Invalid(BlockValidationResult::BLOCK_RESULT_UNSET, "bad-cb-payee");
+    if (!fDashPaymentsValid) {
+        state = dash_state;
+        return false;
     }
 
-    int64_t nTime5_5 = GetTimeMicros(); nTimePayeeValid += nTime5_5 - nTime5_4;
-    LogPrint(BCLog::BENCHMARK, "      - IsBlockPayeeValid: %.2fms [%.2fs (%.2fms/blk)]\n", MILLI * (nTime5_5 - nTime5_4), nTimePayeeValid * MICRO, nTimePayeeValid * MILLI / nBlocksTotal);
-
-    int64_t nTime5 = GetTimeMicros(); nTimeDashSpecific += nTime5 - nTime4;
-    LogPrint(BCLog::BENCHMARK, "    - Dash specific: %.2fms [%.2fs (%.2fms/blk)]\n", MILLI * (nTime5 - nTime4), nTimeDashSpecific * MICRO, nTimeDashSpecific * MILLI / nBlocksTotal);
-
     // END DASH
 
     if (fJustCheck)
@@ -2444,29 +2629,6 @@ bool CChainState::ConnectBlock(const CBlock& block, BlockValidationState& state,
         setDirtyBlockIndex.insert(pindex);
     }
 
-    int64_t nTime6 = GetTimeMicros();
-
-    if (fAddressIndex) {
-        if (!pblocktree->WriteAddressIndex(addressIndex)) {
-            return AbortNode(state, "Failed to write address index");
-        }
-
-        if (!pblocktree->UpdateAddressUnspentIndex(addressUnspentIndex)) {
-            return AbortNode(state, "Failed to write address unspent index");
-        }
-    }
-
-    if (fSpentIndex)
-        if (!pblocktree->UpdateSpentIndex(spentIndex))
-            return AbortNode(state, "Failed to write transaction index");
-
-    if (fTimestampIndex)
-        if (!pblocktree->WriteTimestampIndex(CTimestampIndexKey(pindex->nTime, pindex->GetBlockHash())))
-            return AbortNode(state, "Failed to write timestamp index");
-
-    int64_t nTime7 = GetTimeMicros(); nTimeIndexWrite += nTime7 - nTime6;
-    LogPrint(BCLog::BENCHMARK, "      - Index writing: %.2fms [%.2fs (%.2fms/blk)]\n", MILLI * (nTime7 - nTime6), nTimeIndexWrite * MICRO, nTimeIndexWrite * MILLI / nBlocksTotal);
-
     assert(pindex->phashBlock);
     // add this block to the view's block chain
     view.SetBestBlock(pindex->GetBlockHash());
@@ -2479,8 +2641,17 @@ bool CChainState::ConnectBlock(const CBlock& block, BlockValidationState& state,
     }
 
     int64_t nTime8 = GetTimeMicros(); nTimeCallbacks += nTime8 - nTime5;
+    g_perf_callbacks.Observe(nTime8 - nTime5);
     LogPrint(BCLog::BENCHMARK, "    - Callbacks: %.2fms [%.2fs (%.2fms/blk)]\n", MILLI * (nTime8 - nTime5), nTimeCallbacks * MICRO, nTimeCallbacks * MILLI / nBlocksTotal);
 
+    TRACE6(validation, block_connected,
+        pindex->GetBlockHash().data(),
+        pindex->nHeight,
+        block.vtx.size(),
+        nInputs,
+        nSigOps,
+        nTime8 - nTimeStart);
+
     statsClient.timing("ConnectBlock_ms", (nTime8 - nTimeStart) / 1000, 1.0f);
     statsClient.gauge("blocks.tip.SizeBytes", ::GetSerializeSize(block, PROTOCOL_VERSION), 1.0f);
     statsClient.gauge("blocks.tip.Height", m_chain.Height(), 1.0f);
@@ -2503,7 +2674,8 @@ CoinsCacheSizeState CChainState::GetCoinsCacheSizeState(
     size_t max_mempool_size_bytes)
 {
     const int64_t nMempoolUsage = m_mempool ? m_mempool->DynamicMemoryUsage() : 0;
-    int64_t cacheSize = CoinsTip().DynamicMemoryUsage();
+    // The snapshot of a background flush holds a copy of the coins it writes until it is done
+    int64_t cacheSize = CoinsTip().DynamicMemoryUsage() + m_coins_views->m_flushview.DynamicMemoryUsage();
     int64_t nTotalSpace =
         max_coins_cache_size_bytes + std::max<int64_t>(int64_t(max_mempool_size_bytes) - nMempoolUsage, 0);
 
@@ -2543,6 +2715,11 @@ bool CChainState::FlushStateToDisk(
 
     try {
     {
+        // The chainstate a failed background write reported as flushed isn't on disk, don't connect any
+        // more blocks on top of it
+        if (m_coins_views->m_flushview.WriteFailed()) {
+            return AbortNode(state, "Failed to write to coin database");
+        }
         bool fFlushForPrune = false;
         bool fDoFullFlush = false;
 
@@ -2638,6 +2815,20 @@ bool CChainState::FlushStateToDisk(
         }
         // Flush best chain related state. This can only be done if the blocks / block index write was also done.
         if (fDoFullFlush && !CoinsTip().GetBestBlock().IsNull()) {
+            CCoinsViewBackgroundFlush& flush_view = m_coins_views->m_flushview;
+            // The previous flush may still be written in the background, its evodb changes must be on disk
+            // before the next ones are set aside
+            if (!flush_view.WaitForWrite()) {
+                return AbortNode(state, "Failed to write to coin database");
+            }
+            // Write the coins and evodb in the background, unless we are asked to have them on disk when
+            // returning. They are written in the same order as below, so a crash in between leaves the same
+            // states behind.
+            const bool fBackground = mode != FlushStateMode::ALWAYS && gArgs.GetBoolArg("-backgroundflush", DEFAULT_BACKGROUND_FLUSH);
+            if (fBackground) {
+                m_evoDb.FreezeRootTransaction();
+                flush_view.WriteNextInBackground([this] { return m_evoDb.CommitFrozenTransaction(); });
+            }
             {
                 LOG_TIME_SECONDS(strprintf("write coins cache to disk (%d coins, %.2fkB)",
                     coins_count, coins_mem_usage / 1000));
@@ -2650,18 +2841,21 @@ bool CChainState::FlushStateToDisk(
                 if (!CheckDiskSpace(GetDataDir(), 48 * 2 * 2 * CoinsTip().GetCacheSize())) {
                     return AbortNode(state, "Disk space is too low!", _("Disk space is too low!"));
                 }
-                // Flush the chainstate (which may refer to block index entries).
-                if (!CoinsTip().Flush())
+                // Flush the chainstate (which may refer to block index entries). Only empty the cache if it
+                // is about to exceed its limit or we are asked to, otherwise keep the coins for the next blocks.
+                const bool fEmptyCache = mode == FlushStateMode::ALWAYS || fCacheLarge || fCacheCritical;
+                if (!(fEmptyCache ? CoinsTip().Flush() : CoinsTip().Sync()))
                     return AbortNode(state, "Failed to write to coin database");
             }
-            {
+            if (!fBackground) {
                 LOG_TIME_SECONDS("write evodb cache to disk");
                 if (!m_evoDb.CommitRootTransaction()) {
                     return AbortNode(state, "Failed to commit EvoDB");
                 }
             }
             nLastFlush = nNow;
-            full_flush_completed = true;
+            // Wallets are told about the flush once it is on disk, which a background one isn't yet
+            full_flush_completed = !fBackground;
         }
     }
     if (full_flush_completed) {
@@ -2722,6 +2916,18 @@ void CChainState::UpdateTip(const CBlockIndex* pindexNew)
         g_best_block_cv.notify_all();
     }
 
+    // Keep the retarget window in step, so GetNextWorkRequired() for the new tip needs no walk back
+    g_pow_window.SetTip(pindexNew, m_params.GetConsensus());
+
+    // Get the next KAWPOW light cache ready before the first block of the next epoch shows up
+    if (pindexNew->nTime >= nKAWPOWActivationTime) {
+        g_kawpow_epoch_contexts.MaybePrefetchNext(pindexNew->nHeight);
+        // With -kawpowfulldag keep the full dataset of the tip's epoch, but don't churn through them during IBD
+        if (!this->IsInitialBlockDownload()) {
+            g_kawpow_epoch_contexts.PrepareFullDataset(ethash::get_epoch_number(pindexNew->nHeight));
+        }
+    }
+
     bilingual_str warning_messages;
     assert(std::addressof(::ChainstateActive()) == std::addressof(*this));
     if (!this->IsInitialBlockDownload())
@@ -2750,7 +2956,10 @@ void CChainState::UpdateTip(const CBlockIndex* pindexNew)
       !warning_messages.empty() ? strprintf(" warning='%s'", warning_messages.original) : "");
 }
 
-/** Disconnect m_chain's tip.
+/** Disconnect blocks from m_chain's tip until pindexFork is the tip, or
+  * MAX_DISCONNECT_TIPS_BATCH blocks were disconnected. The blocks are applied
+  * to the coins and the evodb in one transaction, so a deep reorg doesn't pay
+  * for a flush of both per block.
   * After calling, the mempool will be in an inconsistent state, with
   * transactions from disconnected blocks being added to disconnectpool.  You
   * should make the mempool consistent again by calling MaybeUpdateMempoolForReorg.
@@ -2759,58 +2968,75 @@ void CChainState::UpdateTip(const CBlockIndex* pindexNew)
   * If disconnectpool is nullptr, then no disconnected transactions are added to
   * disconnectpool (note that the caller is responsible for mempool consistency
   * in any case).
+  *
+  * If vDisconnected is not nullptr, the disconnected blocks are appended to it,
+  * starting with the old tip.
   */
-bool CChainState::DisconnectTip(BlockValidationState& state, DisconnectedBlockTransactions* disconnectpool)
+bool CChainState::DisconnectTips(BlockValidationState& state, const CBlockIndex* pindexFork, DisconnectedBlockTransactions* disconnectpool, std::vector<CBlockIndex*>* vDisconnected)
 {
     AssertLockHeld(cs_main);
     if (m_mempool) AssertLockHeld(m_mempool->cs);
 
     CBlockIndex *pindexDelete = m_chain.Tip();
-    assert(pindexDelete);
-    // Read block from disk.
-    std::shared_ptr<CBlock> pblock = std::make_shared<CBlock>();
-    CBlock& block = *pblock;
-    if (!ReadBlockFromDisk(block, pindexDelete, m_params.GetConsensus())) {
-        return error("DisconnectTip(): Failed to read block");
-    }
-    // Apply the block atomically to the chain state.
+    assert(pindexDelete && pindexDelete != pindexFork);
+    std::vector<std::pair<CBlockIndex*, std::shared_ptr<const CBlock>>> vBlocks;
+    // The masternode list changes of each block, notified once they are committed
+    std::vector<std::optional<MNListUpdates>> vMNListUpdates;
+    // Apply the blocks atomically to the chain state.
     int64_t nStart = GetTimeMicros();
     {
         auto dbTx = m_evoDb.BeginTransaction();
 
         CCoinsViewCache view(&CoinsTip());
         assert(view.GetBestBlock() == pindexDelete->GetBlockHash());
-        if (DisconnectBlock(block, pindexDelete, view) != DISCONNECT_OK)
-            return error("DisconnectTip(): DisconnectBlock %s failed", pindexDelete->GetBlockHash().ToString());
+        do {
+            // Read block from disk.
+            std::shared_ptr<CBlock> pblock = std::make_shared<CBlock>();
+            if (!ReadBlockFromDisk(*pblock, pindexDelete, m_params.GetConsensus())) {
+                return error("DisconnectTips(): Failed to read block");
+            }
+            if (DisconnectBlock(*pblock, pindexDelete, view, &vMNListUpdates.emplace_back()) != DISCONNECT_OK)
+                return error("DisconnectTips(): DisconnectBlock %s failed", pindexDelete->GetBlockHash().ToString());
+            vBlocks.emplace_back(pindexDelete, std::move(pblock));
+            pindexDelete = pindexDelete->pprev;
+        } while (pindexDelete != pindexFork && vBlocks.size() < MAX_DISCONNECT_TIPS_BATCH);
         bool flushed = view.Flush();
         assert(flushed);
         dbTx->Commit();
     }
-    LogPrint(BCLog::BENCHMARK, "- Disconnect block: %.2fms\n", (GetTimeMicros() - nStart) * MILLI);
+    LogPrint(BCLog::BENCHMARK, "- Disconnect %u blocks: %.2fms\n", vBlocks.size(), (GetTimeMicros() - nStart) * MILLI);
     // Write the chain state to disk, if necessary.
     if (!FlushStateToDisk(state, FlushStateMode::IF_NEEDED)) {
         return false;
     }
 
-    if (disconnectpool && m_mempool) {
-        // Save transactions to re-add to mempool at end of reorg
-        for (auto it = block.vtx.rbegin(); it != block.vtx.rend(); ++it) {
-            disconnectpool->addTransaction(*it);
+    for (size_t i = 0; i < vBlocks.size(); ++i) {
+        const auto& [pindex, pblock] = vBlocks[i];
+        if (const auto& mnlu = vMNListUpdates[i]; mnlu.has_value()) {
+            GetMainSignals().NotifyMasternodeListChanged(true, mnlu->old_list, mnlu->diff);
+            uiInterface.NotifyMasternodeListChanged(mnlu->new_list, pindex->pprev);
         }
-        while (disconnectpool->DynamicMemoryUsage() > MAX_DISCONNECTED_TX_POOL_SIZE * 1000) {
-            // Drop the earliest entry, and remove its children from the mempool.
-            auto it = disconnectpool->queuedTx.get<insertion_order>().begin();
-            m_mempool->removeRecursive(**it, MemPoolRemovalReason::REORG);
-            disconnectpool->removeEntry(it);
+        if (disconnectpool && m_mempool) {
+            // Save transactions to re-add to mempool at end of reorg
+            for (auto it = pblock->vtx.rbegin(); it != pblock->vtx.rend(); ++it) {
+                disconnectpool->addTransaction(*it);
+            }
+            while (disconnectpool->DynamicMemoryUsage() > MAX_DISCONNECTED_TX_POOL_SIZE * 1000) {
+                // Drop the earliest entry, and remove its children from the mempool.
+                auto it = disconnectpool->queuedTx.get<insertion_order>().begin();
+                m_mempool->removeRecursive(**it, MemPoolRemovalReason::REORG);
+                disconnectpool->removeEntry(it);
+            }
         }
-    }
 
-    m_chain.SetTip(pindexDelete->pprev);
+        m_chain.SetTip(pindex->pprev);
 
-    UpdateTip(pindexDelete->pprev);
-    // Let wallets know transactions went from 1-confirmed to
-    // 0-confirmed or conflicted:
-    GetMainSignals().BlockDisconnected(pblock, pindexDelete);
+        UpdateTip(pindex->pprev);
+        // Let wallets know transactions went from 1-confirmed to
+        // 0-confirmed or conflicted:
+        GetMainSignals().BlockDisconnected(pblock, pindex);
+        if (vDisconnected) vDisconnected->push_back(pindex);
+    }
     return true;
 }
 
@@ -2819,6 +3045,12 @@ static int64_t nTimeConnectTotal = 0;
 static int64_t nTimeFlush = 0;
 static int64_t nTimeChainState = 0;
 static int64_t nTimePostConnect = 0;
+static perf::Histogram& g_perf_read_block{perf::GetHistogram("validation.connecttip.readblock", "Time to load a block from disk to connect it")};
+static perf::Histogram& g_perf_connect{perf::GetHistogram("validation.connecttip.connect", "Time of ConnectBlock")};
+static perf::Histogram& g_perf_flush{perf::GetHistogram("validation.connecttip.flush", "Time to flush the coins and evodb changes of a block")};
+static perf::Histogram& g_perf_chainstate{perf::GetHistogram("validation.connecttip.chainstate", "Time to write the chainstate if needed after a block")};
+static perf::Histogram& g_perf_post_connect{perf::GetHistogram("validation.connecttip.postprocess", "Time to update the mempool and the tip after a block")};
+static perf::Histogram& g_perf_connect_tip{perf::GetHistogram("validation.connecttip.total", "Time to connect a block to the tip")};
 
 struct PerBlockConnectTrace {
     CBlockIndex* pindex = nullptr;
@@ -2887,6 +3119,7 @@ bool CChainState::ConnectTip(BlockValidationState& state, CBlockIndex* pindexNew
     const CBlock& blockConnecting = *pthisBlock;
     // Apply the block atomically to the chain state.
     int64_t nTime2 = GetTimeMicros(); nTimeReadFromDisk += nTime2 - nTime1;
+    g_perf_read_block.Observe(nTime2 - nTime1);
     int64_t nTime3;
     LogPrint(BCLog::BENCHMARK, "  - Load block from disk: %.2fms [%.2fs]\n", (nTime2 - nTime1) * MILLI, nTimeReadFromDisk * MICRO);
     {
@@ -2901,6 +3134,7 @@ bool CChainState::ConnectTip(BlockValidationState& state, CBlockIndex* pindexNew
             return error("%s: ConnectBlock %s failed, %s", __func__, pindexNew->GetBlockHash().ToString(), state.ToString());
         }
         nTime3 = GetTimeMicros(); nTimeConnectTotal += nTime3 - nTime2;
+        g_perf_connect.Observe(nTime3 - nTime2);
         assert(nBlocksTotal > 0);
         LogPrint(BCLog::BENCHMARK, "  - Connect total: %.2fms [%.2fs (%.2fms/blk)]\n", (nTime3 - nTime2) * MILLI, nTimeConnectTotal * MICRO, nTimeConnectTotal * MILLI / nBlocksTotal);
         bool flushed = view.Flush();
@@ -2908,12 +3142,14 @@ bool CChainState::ConnectTip(BlockValidationState& state, CBlockIndex* pindexNew
         dbTx->Commit();
     }
     int64_t nTime4 = GetTimeMicros(); nTimeFlush += nTime4 - nTime3;
+    g_perf_flush.Observe(nTime4 - nTime3);
     LogPrint(BCLog::BENCHMARK, "  - Flush: %.2fms [%.2fs (%.2fms/blk)]\n", (nTime4 - nTime3) * MILLI, nTimeFlush * MICRO, nTimeFlush * MILLI / nBlocksTotal);
     // Write the chain state to disk, if necessary.
     if (!FlushStateToDisk(state, FlushStateMode::IF_NEEDED)) {
         return false;
     }
     int64_t nTime5 = GetTimeMicros(); nTimeChainState += nTime5 - nTime4;
+    g_perf_chainstate.Observe(nTime5 - nTime4);
     LogPrint(BCLog::BENCHMARK, "  - Writing chainstate: %.2fms [%.2fs (%.2fms/blk)]\n", (nTime5 - nTime4) * MILLI, nTimeChainState * MICRO, nTimeChainState * MILLI / nBlocksTotal);
     // Remove conflicting transactions from the mempool.;
     if (m_mempool) {
@@ -2926,6 +3162,8 @@ bool CChainState::ConnectTip(BlockValidationState& state, CBlockIndex* pindexNew
     UpdateTip(pindexNew);
 
     int64_t nTime6 = GetTimeMicros(); nTimePostConnect += nTime6 - nTime5; nTimeTotal += nTime6 - nTime1;
+    g_perf_post_connect.Observe(nTime6 - nTime5);
+    g_perf_connect_tip.Observe(nTime6 - nTime1);
     LogPrint(BCLog::BENCHMARK, "  - Connect postprocess: %.2fms [%.2fs (%.2fms/blk)]\n", (nTime6 - nTime5) * MILLI, nTimePostConnect * MICRO, nTimePostConnect * MILLI / nBlocksTotal);
     LogPrint(BCLog::BENCHMARK, "- Connect block: %.2fms [%.2fs (%.2fms/blk)]\n", (nTime6 - nTime1) * MILLI, nTimeTotal * MICRO, nTimeTotal * MILLI / nBlocksTotal);
 
@@ -3029,7 +3267,7 @@ bool CChainState::ActivateBestChainStep(BlockValidationState& state, CBlockIndex
     bool fBlocksDisconnected = false;
     DisconnectedBlockTransactions disconnectpool;
     while (m_chain.Tip() && m_chain.Tip() != pindexFork) {
-        if (!DisconnectTip(state, &disconnectpool)) {
+        if (!DisconnectTips(state, pindexFork, &disconnectpool)) {
             // This is likely a fatal error, but keep the mempool consistent,
             // just in case. Only remove from the mempool in this case.
             MaybeUpdateMempoolForReorg(disconnectpool, false);
@@ -3285,7 +3523,7 @@ bool CChainState::InvalidateBlock(BlockValidationState& state, CBlockIndex* pind
 
     CBlockIndex* to_mark_failed = pindex;
     bool pindex_was_in_chain = false;
-    int disconnected = 0;
+    size_t disconnected = 0;
 
     // We do not allow ActivateBestChain() to run while InvalidateBlock() is
     // running, as that could cause the tip to change while we disconnect
@@ -3328,67 +3566,69 @@ bool CChainState::InvalidateBlock(BlockValidationState& state, CBlockIndex* pind
 
         LOCK(cs_main);
         // Lock for as long as disconnectpool is in scope to make sure MaybeUpdateMempoolForReorg is
-        // called after DisconnectTip without unlocking in between
+        // called after DisconnectTips without unlocking in between
         LOCK(MempoolMutex());
         if (!m_chain.Contains(pindex)) break;
         pindex_was_in_chain = true;
-        CBlockIndex *invalid_walk_tip = m_chain.Tip();
-        const CBlockIndex* pindexOldTip = m_chain.Tip();
-
-        if (pindex == pindexBestHeader) {
-            pindexBestInvalid = pindexBestHeader;
-            pindexBestHeader = pindexBestHeader->pprev;
-        }
 
         // ActivateBestChain considers blocks already in m_chain
         // unconditionally valid already, so force disconnect away from it.
         DisconnectedBlockTransactions disconnectpool;
-        bool ret = DisconnectTip(state, &disconnectpool);
-        // DisconnectTip will add transactions to disconnectpool.
+        std::vector<CBlockIndex*> vDisconnected;
+        bool ret = DisconnectTips(state, pindex->pprev, &disconnectpool, &vDisconnected);
+        disconnected += vDisconnected.size();
+        // DisconnectTips will add transactions to disconnectpool.
         // Adjust the mempool to be consistent with the new tip, adding
         // transactions back to the mempool if disconnecting was successful,
         // and we're not doing a very deep invalidation (in which case
         // keeping the mempool up to date is probably futile anyway).
         assert(std::addressof(::ChainstateActive()) == std::addressof(*this));
-        MaybeUpdateMempoolForReorg(disconnectpool, /* fAddToMempool = */ (++disconnected <= 10) && ret);
+        MaybeUpdateMempoolForReorg(disconnectpool, /* fAddToMempool = */ (disconnected <= 10) && ret);
         if (!ret) return false;
-        assert(invalid_walk_tip->pprev == m_chain.Tip());
-
-        if (pindexOldTip == pindexBestHeader) {
-            pindexBestInvalid = pindexBestHeader;
-            pindexBestHeader = pindexBestHeader->pprev;
-        }
-
-        // We immediately mark the disconnected blocks as invalid.
-        // This prevents a case where pruned nodes may fail to invalidateblock
-        // and be left unable to start as they have no tip candidates (as there
-        // are no blocks that meet the "have data and are not invalid per
-        // nStatus" criteria for inclusion in setBlockIndexCandidates).
-        invalid_walk_tip->nStatus |= BLOCK_FAILED_VALID;
-        setDirtyBlockIndex.insert(invalid_walk_tip);
-        setBlockIndexCandidates.erase(invalid_walk_tip);
-        setBlockIndexCandidates.insert(invalid_walk_tip->pprev);
-        if (invalid_walk_tip->pprev == to_mark_failed && (to_mark_failed->nStatus & BLOCK_FAILED_VALID)) {
-            // We only want to mark the last disconnected block as BLOCK_FAILED_VALID; its children
-            // need to be BLOCK_FAILED_CHILD instead.
-            to_mark_failed->nStatus = (to_mark_failed->nStatus ^ BLOCK_FAILED_VALID) | BLOCK_FAILED_CHILD;
-            setDirtyBlockIndex.insert(to_mark_failed);
-        }
-
-        // Add any equal or more work headers to setBlockIndexCandidates
-        auto candidate_it = candidate_blocks_by_work.lower_bound(invalid_walk_tip->pprev->nChainWork);
-        while (candidate_it != candidate_blocks_by_work.end()) {
-            if (!CBlockIndexWorkComparator()(candidate_it->second, invalid_walk_tip->pprev)) {
-                setBlockIndexCandidates.insert(candidate_it->second);
-                candidate_it = candidate_blocks_by_work.erase(candidate_it);
-            } else {
-                ++candidate_it;
+        assert(vDisconnected.back()->pprev == m_chain.Tip());
+
+        for (CBlockIndex* invalid_walk_tip : vDisconnected) {
+            if (pindex == pindexBestHeader) {
+                pindexBestInvalid = pindexBestHeader;
+                pindexBestHeader = pindexBestHeader->pprev;
+            }
+
+            if (invalid_walk_tip == pindexBestHeader) {
+                pindexBestInvalid = pindexBestHeader;
+                pindexBestHeader = pindexBestHeader->pprev;
+            }
+
+            // We immediately mark the disconnected blocks as invalid.
+            // This prevents a case where pruned nodes may fail to invalidateblock
+            // and be left unable to start as they have no tip candidates (as there
+            // are no blocks that meet the "have data and are not invalid per
+            // nStatus" criteria for inclusion in setBlockIndexCandidates).
+            invalid_walk_tip->nStatus |= BLOCK_FAILED_VALID;
+            setDirtyBlockIndex.insert(invalid_walk_tip);
+            setBlockIndexCandidates.erase(invalid_walk_tip);
+            setBlockIndexCandidates.insert(invalid_walk_tip->pprev);
+            if (invalid_walk_tip->pprev == to_mark_failed && (to_mark_failed->nStatus & BLOCK_FAILED_VALID)) {
+                // We only want to mark the last disconnected block as BLOCK_FAILED_VALID; its children
+                // need to be BLOCK_FAILED_CHILD instead.
+                to_mark_failed->nStatus = (to_mark_failed->nStatus ^ BLOCK_FAILED_VALID) | BLOCK_FAILED_CHILD;
+                setDirtyBlockIndex.insert(to_mark_failed);
+            }
+
+            // Add any equal or more work headers to setBlockIndexCandidates
+            auto candidate_it = candidate_blocks_by_work.lower_bound(invalid_walk_tip->pprev->nChainWork);
+            while (candidate_it != candidate_blocks_by_work.end()) {
+                if (!CBlockIndexWorkComparator()(candidate_it->second, invalid_walk_tip->pprev)) {
+                    setBlockIndexCandidates.insert(candidate_it->second);
+                    candidate_it = candidate_blocks_by_work.erase(candidate_it);
+                } else {
+                    ++candidate_it;
+                }
             }
-        }
 
-        // Track the last disconnected block, so we can correct its BLOCK_FAILED_CHILD status in future
-        // iterations, or, if it's the last one, call InvalidChainFound on it.
-        to_mark_failed = invalid_walk_tip;
+            // Track the last disconnected block, so we can correct its BLOCK_FAILED_CHILD status in future
+            // iterations, or, if it's the last one, call InvalidChainFound on it.
+            to_mark_failed = invalid_walk_tip;
+        }
     }
 
     CheckBlockIndex();
@@ -3480,21 +3720,23 @@ bool CChainState::MarkConflictingBlock(BlockValidationState& state, CBlockIndex
     }
 
     {
-    LOCK(MempoolMutex()); // Lock for as long as disconnectpool is in scope to make sure UpdateMempoolForReorg is called after DisconnectTip without unlocking in between
+    LOCK(MempoolMutex()); // Lock for as long as disconnectpool is in scope to make sure UpdateMempoolForReorg is called after DisconnectTips without unlocking in between
     DisconnectedBlockTransactions disconnectpool;
     while (m_chain.Contains(pindex)) {
-        const CBlockIndex* pindexOldTip = m_chain.Tip();
         pindex_was_in_chain = true;
         // ActivateBestChain considers blocks already in m_chain
         // unconditionally valid already, so force disconnect away from it.
-        if (!DisconnectTip(state, &disconnectpool)) {
+        std::vector<CBlockIndex*> vDisconnected;
+        if (!DisconnectTips(state, pindex->pprev, &disconnectpool, &vDisconnected)) {
             // It's probably hopeless to try to make the mempool consistent
-            // here if DisconnectTip failed, but we can try.
+            // here if DisconnectTips failed, but we can try.
             MaybeUpdateMempoolForReorg(disconnectpool, false);
             return false;
         }
-        if (pindexOldTip == pindexBestHeader) {
-            pindexBestHeader = pindexBestHeader->pprev;
+        for (const CBlockIndex* pindexOldTip : vDisconnected) {
+            if (pindexOldTip == pindexBestHeader) {
+                pindexBestHeader = pindexBestHeader->pprev;
+            }
         }
     }
 
@@ -3510,7 +3752,7 @@ bool CChainState::MarkConflictingBlock(BlockValidationState& state, CBlockIndex
     pindex->nStatus |= BLOCK_CONFLICT_CHAINLOCK;
     setBlockIndexCandidates.erase(pindex);
 
-    // DisconnectTip will add transactions to disconnectpool; try to add these
+    // DisconnectTips will add transactions to disconnectpool; try to add these
     // back to the mempool.
         MaybeUpdateMempoolForReorg(disconnectpool, true);
     } // m_mempool.cs
@@ -3608,7 +3850,8 @@ CBlockIndex* BlockManager::AddToBlockIndex(const CBlockHeader& block, const uint
         return it->second;
 
     // Construct new block index object
-    CBlockIndex* pindexNew = new CBlockIndex(block);
+    CBlockIndex* pindexNew = NewBlockIndex();
+    *pindexNew = CBlockIndex(block);
     // We assign the sequence id to blocks only when the full data is available,
     // to avoid miners withholding blocks but broadcasting headers, to get a
     // competitive advantage.
@@ -4011,10 +4254,14 @@ static bool ContextualCheckBlock(const CBlock& block, BlockValidationState& stat
 }
 
 bool BlockManager::AcceptBlockHeader(const CBlockHeader& block, BlockValidationState& state, const CChainParams& chainparams, CBlockIndex** ppindex)
+{
+    return AcceptBlockHeader(block, block.GetHash(), state, chainparams, ppindex);
+}
+
+bool BlockManager::AcceptBlockHeader(const CBlockHeader& block, const uint256& hash, BlockValidationState& state, const CChainParams& chainparams, CBlockIndex** ppindex)
 {
     AssertLockHeld(cs_main);
     // Check for duplicate
-    uint256 hash = block.GetHash();
     BlockMap::iterator miSelf = m_block_index.find(hash);
     CBlockIndex *pindex = nullptr;
 
@@ -4126,15 +4373,21 @@ bool BlockManager::AcceptBlockHeader(const CBlockHeader& block, BlockValidationS
 
 // Exposed wrapper for AcceptBlockHeader
 bool ChainstateManager::ProcessNewBlockHeaders(const std::vector<CBlockHeader>& headers, BlockValidationState& state, const CChainParams& chainparams, const CBlockIndex** ppindex)
+{
+    return ProcessNewBlockHeaders(headers, HashBlockHeaders(headers), state, chainparams, ppindex);
+}
+
+bool ChainstateManager::ProcessNewBlockHeaders(const std::vector<CBlockHeader>& headers, const std::vector<uint256>& hashes, BlockValidationState& state, const CChainParams& chainparams, const CBlockIndex** ppindex)
 {
     assert(std::addressof(::ChainstateActive()) == std::addressof(ActiveChainstate()));
+    assert(headers.size() == hashes.size());
     AssertLockNotHeld(cs_main);
     {
         LOCK(cs_main);
-        for (const CBlockHeader& header : headers) {
+        for (size_t i = 0; i < headers.size(); ++i) {
             CBlockIndex *pindex = nullptr; // Use a temp pindex instead of ppindex to avoid a const_cast
             bool accepted = m_blockman.AcceptBlockHeader(
-                header, state, chainparams, &pindex);
+                headers[i], hashes[i], state, chainparams, &pindex);
             ActiveChainstate().CheckBlockIndex();
 
             if (!accepted) {
@@ -4311,7 +4564,7 @@ bool TestBlockValidity(BlockValidationState& state,
     }
 
     CCoinsViewCache viewNew(&chainstate.CoinsTip());
-    uint256 block_hash(block.GetHash());
+    uint256 block_hash(hash);
     CBlockIndex indexDummy(block);
     indexDummy.pprev = pindexPrev;
     indexDummy.nHeight = pindexPrev->nHeight + 1;
@@ -4412,8 +4665,8 @@ void BlockManager::FindFilesToPruneManual(std::set<int>& setFilesToPrune, int nM
         return;
     }
 
-    // last block to prune is the lesser of (user-specified height, MIN_BLOCKS_TO_KEEP from the tip)
-    unsigned int nLastBlockWeCanPrune = std::min((unsigned)nManualPruneHeight, chain_tip_height - MIN_BLOCKS_TO_KEEP);
+    // last block to prune is the lesser of (user-specified height, nPruneBlocksToKeep from the tip)
+    unsigned int nLastBlockWeCanPrune = std::min((unsigned)nManualPruneHeight, chain_tip_height - nPruneBlocksToKeep);
     int count = 0;
     for (int fileNumber = 0; fileNumber < nLastBlockFile; fileNumber++) {
         if (vinfoBlockFile[fileNumber].nSize == 0 || vinfoBlockFile[fileNumber].nHeightLast > nLastBlockWeCanPrune) {
@@ -4426,6 +4679,16 @@ void BlockManager::FindFilesToPruneManual(std::set<int>& setFilesToPrune, int nM
     LogPrintf("Prune (Manual): prune_height=%d removed %d blk/rev pairs\n", nLastBlockWeCanPrune, count);
 }
 
+unsigned int GetQuorumBlocksToKeep(const Consensus::Params& params)
+{
+    // Rotated quorums of one type are all created within a single cycle
+    int quorum_blocks{0};
+    for (const auto& llmq : params.llmqs) {
+        quorum_blocks = std::max(quorum_blocks, (llmq.useRotation ? 1 : llmq.signingActiveQuorumCount) * llmq.dkgInterval);
+    }
+    return std::max<unsigned int>(MIN_BLOCKS_TO_KEEP, quorum_blocks + CCreditPoolManager::LimitBlocksToTrace);
+}
+
 /* This function is called from the RPC code for pruneblockchain */
 void PruneBlockFilesManual(CChainState& active_chainstate, int nManualPruneHeight)
 {
@@ -4446,7 +4709,7 @@ void BlockManager::FindFilesToPrune(std::set<int>& setFilesToPrune, uint64_t nPr
         return;
     }
 
-    unsigned int nLastBlockWeCanPrune{(unsigned)std::min(prune_height, chain_tip_height - static_cast<int>(MIN_BLOCKS_TO_KEEP))};
+    unsigned int nLastBlockWeCanPrune{(unsigned)std::min(prune_height, chain_tip_height - static_cast<int>(nPruneBlocksToKeep))};
     uint64_t nCurrentUsage = CalculateCurrentUsage();
     // We don't check to prune until after we've allocated new space for files
     // So we should leave a buffer under our target to account for another allocation
@@ -4476,7 +4739,7 @@ void BlockManager::FindFilesToPrune(std::set<int>& setFilesToPrune, uint64_t nPr
                 break;
             }
 
-            // don't prune files that could have a block within MIN_BLOCKS_TO_KEEP of the main chain's tip but keep scanning
+            // don't prune files that could have a block within nPruneBlocksToKeep of the main chain's tip but keep scanning
             if (vinfoBlockFile[fileNumber].nHeightLast > nLastBlockWeCanPrune) {
                 continue;
             }
@@ -4519,6 +4782,17 @@ fs::path GetBlockPosFilename(const FlatFilePos &pos)
     return BlockFileSeq().FileName(pos);
 }
 
+CBlockIndex* BlockManager::NewBlockIndex()
+{
+    AssertLockHeld(cs_main);
+
+    if (m_block_index_slab_used == BLOCK_INDEX_SLAB_SIZE) {
+        m_block_index_slabs.emplace_back(std::make_unique<CBlockIndex[]>(BLOCK_INDEX_SLAB_SIZE));
+        m_block_index_slab_used = 0;
+    }
+    return &m_block_index_slabs.back()[m_block_index_slab_used++];
+}
+
 CBlockIndex * BlockManager::InsertBlockIndex(const uint256& hash)
 {
     AssertLockHeld(cs_main);
@@ -4532,7 +4806,7 @@ CBlockIndex * BlockManager::InsertBlockIndex(const uint256& hash)
         return (*mi).second;
 
     // Create new
-    CBlockIndex* pindexNew = new CBlockIndex();
+    CBlockIndex* pindexNew = NewBlockIndex();
     mi = m_block_index.insert(std::make_pair(hash, pindexNew)).first;
     pindexNew->phashBlock = &((*mi).first);
 
@@ -4603,12 +4877,11 @@ void BlockManager::Unload() {
     m_failed_blocks.clear();
     m_blocks_unlinked.clear();
 
-    for (const BlockMap::value_type& entry : m_block_index) {
-        delete entry.second;
-    }
-
     m_block_index.clear();
     m_prev_block_index.clear();
+
+    m_block_index_slabs.clear();
+    m_block_index_slab_used = BLOCK_INDEX_SLAB_SIZE;
 }
 
 bool CChainState::LoadBlockIndexDB()
@@ -4664,18 +4937,6 @@ bool CChainState::LoadBlockIndexDB()
     pblocktree->ReadReindexing(fReindexing);
     if(fReindexing) fReindex = true;
 
-    // Check whether we have an address index
-    pblocktree->ReadFlag("addressindex", fAddressIndex);
-    LogPrintf("%s: address index %s\n", __func__, fAddressIndex ? "enabled" : "disabled");
-
-    // Check whether we have a timestamp index
-    pblocktree->ReadFlag("timestampindex", fTimestampIndex);
-    LogPrintf("%s: timestamp index %s\n", __func__, fTimestampIndex ? "enabled" : "disabled");
-
-    // Check whether we have a spent index
-    pblocktree->ReadFlag("spentindex", fSpentIndex);
-    LogPrintf("%s: spent index %s\n", __func__, fSpentIndex ? "enabled" : "disabled");
-
     return true;
 }
 
@@ -4758,6 +5019,17 @@ bool CVerifyDB::VerifyDB(
 
     const bool is_snapshot_cs{!chainstate.m_from_snapshot_blockhash};
 
+    // Read the blocks to verify ahead, stopping at the same blocks as the loop below
+    std::vector<const CBlockIndex*> blocks_to_verify;
+    for (pindex = chainstate.m_chain.Tip(); pindex && pindex->pprev; pindex = pindex->pprev) {
+        if (pindex->nHeight <= chainstate.m_chain.Height()-nCheckDepth)
+            break;
+        if ((fPruneMode || is_snapshot_cs) && !(pindex->nStatus & BLOCK_HAVE_DATA))
+            break;
+        blocks_to_verify.push_back(pindex);
+    }
+    BlockReadAhead reader(blocks_to_verify, /* read_undo */ nCheckLevel >= 2, chainparams.GetConsensus());
+
     for (pindex = chainstate.m_chain.Tip(); pindex && pindex->pprev; pindex = pindex->pprev) {
         const int percentageDone = std::max(1, std::min(99, (int)(((double)(chainstate.m_chain.Height() - pindex->nHeight)) / (double)nCheckDepth * (nCheckLevel >= 4 ? 50 : 100))));
         if (reportDone < percentageDone/10) {
@@ -4775,22 +5047,16 @@ bool CVerifyDB::VerifyDB(
             break;
         }
         CBlock block;
+        CBlockUndo undo;
         // check level 0: read from disk
-        if (!ReadBlockFromDisk(block, pindex, chainparams.GetConsensus()))
-            return error("VerifyDB(): *** ReadBlockFromDisk failed at %d, hash=%s", pindex->nHeight, pindex->GetBlockHash().ToString());
+        // check level 2: verify undo validity, the undo data is read along with the block
+        if (!reader.Next(block, &undo))
+            return error("VerifyDB(): *** failed to read block%s at %d, hash=%s", nCheckLevel >= 2 ? " or undo data" : "",
+                         pindex->nHeight, pindex->GetBlockHash().ToString());
         // check level 1: verify block validity
         if (nCheckLevel >= 1 && !CheckBlock(block, state, chainparams.GetConsensus()))
             return error("%s: *** found bad block at %d, hash=%s (%s)\n", __func__,
                          pindex->nHeight, pindex->GetBlockHash().ToString(), state.ToString());
-        // check level 2: verify undo validity
-        if (nCheckLevel >= 2 && pindex) {
-            CBlockUndo undo;
-            if (!pindex->GetUndoPos().IsNull()) {
-                if (!UndoReadFromDisk(undo, pindex)) {
-                    return error("VerifyDB(): *** found bad undo data at %d, hash=%s\n", pindex->nHeight, pindex->GetBlockHash().ToString());
-                }
-            }
-        }
         // check level 3: check for inconsistencies during memory-only disconnect of tip blocks
         size_t curr_coins_usage = coins.DynamicMemoryUsage() + chainstate.CoinsTip().DynamicMemoryUsage();
 
@@ -4817,6 +5083,11 @@ bool CVerifyDB::VerifyDB(
 
     // check level 4: try reconnecting blocks
     if (nCheckLevel >= 4) {
+        std::vector<const CBlockIndex*> blocks_to_connect;
+        for (const CBlockIndex* pindex_next = chainstate.m_chain.Next(pindex); pindex_next; pindex_next = chainstate.m_chain.Next(pindex_next)) {
+            blocks_to_connect.push_back(pindex_next);
+        }
+        BlockReadAhead connect_reader(blocks_to_connect, /* read_undo */ false, chainparams.GetConsensus());
         while (pindex != chainstate.m_chain.Tip()) {
             const int percentageDone = std::max(1, std::min(99, 100 - (int)(((double)(chainstate.m_chain.Height() - pindex->nHeight)) / (double)nCheckDepth * 50)));
             if (reportDone < percentageDone/10) {
@@ -4827,7 +5098,7 @@ bool CVerifyDB::VerifyDB(
             uiInterface.ShowProgress(_("Verifying blocks...").translated, percentageDone, false);
             pindex = chainstate.m_chain.Next(pindex);
             CBlock block;
-            if (!ReadBlockFromDisk(block, pindex, chainparams.GetConsensus()))
+            if (!connect_reader.Next(block))
                 return error("VerifyDB(): *** ReadBlockFromDisk failed at %d, hash=%s", pindex->nHeight, pindex->GetBlockHash().ToString());
             if (!chainstate.ConnectBlock(block, state, pindex, coins))
                 return error("VerifyDB(): *** found unconnectable block at %d, hash=%s (%s)", pindex->nHeight, pindex->GetBlockHash().ToString(), state.ToString());
@@ -4860,62 +5131,8 @@ bool CChainState::RollforwardBlock(const CBlockIndex* pindex, CCoinsViewCache& i
             pindex->GetBlockHash().ToString(), state.ToString());
     }
 
-    std::vector<std::pair<CAddressIndexKey, CAmount> > addressIndex;
-    std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > addressUnspentIndex;
-    std::vector<std::pair<CSpentIndexKey, CSpentIndexValue> > spentIndex;
-
-    for (size_t i = 0; i < block.vtx.size(); i++) {
-        const CTransactionRef& tx = block.vtx[i];
-        const uint256 txhash = tx->GetHash();
-
+    for (const CTransactionRef& tx : block.vtx) {
         if (!tx->IsCoinBase()) {
-            // Update indexes
-            if (fAddressIndex || fSpentIndex) {
-                for (size_t j = 0; j < tx->vin.size(); j++) {
-                    const CTxIn input = tx->vin[j];
-                    const Coin& coin = inputs.AccessCoin(tx->vin[j].prevout);
-                    const CTxOut& prevout = coin.out;
-
-                    AddressType address_type{AddressType::UNKNOWN};
-                    uint160 address_bytes;
-
-                    AddressBytesFromScript(prevout.scriptPubKey, address_type, address_bytes);
-
-                    if (fAddressIndex && address_type != AddressType::UNKNOWN) {
-                        // record spending activity
-                        addressIndex.push_back(std::make_pair(CAddressIndexKey(address_type, address_bytes, pindex->nHeight, i, txhash, j, true), prevout.nValue * -1));
-
-                        // remove address from unspent index
-                        addressUnspentIndex.push_back(std::make_pair(CAddressUnspentKey(address_type, address_bytes, input.prevout.hash, input.prevout.n), CAddressUnspentValue()));
-                    }
-
-                    if (fSpentIndex) {
-                        // add the spent index to determine the txid and input that spent an output
-                        // and to find the amount and address from an input
-                        spentIndex.push_back(std::make_pair(CSpentIndexKey(input.prevout.hash, input.prevout.n), CSpentIndexValue(txhash, j, pindex->nHeight, prevout.nValue, address_type, address_bytes)));
-                    }
-                }
-            }
-
-            if (fAddressIndex) {
-                for (size_t k = 0; k < tx->vout.size(); k++) {
-                    const CTxOut& out = tx->vout[k];
-
-                    AddressType address_type{AddressType::UNKNOWN};
-                    uint160 address_bytes;
-
-                    if (!AddressBytesFromScript(out.scriptPubKey, address_type, address_bytes)) {
-                        continue;
-                    }
-
-                    // record receiving activity
-                    addressIndex.push_back(std::make_pair(CAddressIndexKey(address_type, address_bytes, pindex->nHeight, i, txhash, k, false), out.nValue));
-
-                    // record unspent output
-                    addressUnspentIndex.push_back(std::make_pair(CAddressUnspentKey(address_type, address_bytes, txhash, k), CAddressUnspentValue(out.nValue, out.scriptPubKey, pindex->nHeight)));
-                }
-            }
-
             for (const CTxIn &txin : tx->vin) {
                 inputs.SpendCoin(txin.prevout);
             }
@@ -4924,26 +5141,6 @@ bool CChainState::RollforwardBlock(const CBlockIndex* pindex, CCoinsViewCache& i
         AddCoins(inputs, *tx, pindex->nHeight, true);
     }
 
-    if (fAddressIndex) {
-        if (!pblocktree->WriteAddressIndex(addressIndex)) {
-            return error("RollforwardBlock(DASH): Failed to write address index");
-        }
-
-        if (!pblocktree->UpdateAddressUnspentIndex(addressUnspentIndex)) {
-            return error("RollforwardBlock(DASH): Failed to write address unspent index");
-        }
-    }
-
-    if (fSpentIndex) {
-        if (!pblocktree->UpdateSpentIndex(spentIndex))
-            return error("RollforwardBlock(DASH): Failed to write transaction index");
-    }
-
-    if (fTimestampIndex) {
-        if (!pblocktree->WriteTimestampIndex(CTimestampIndexKey(pindex->nTime, pindex->GetBlockHash())))
-            return error("RollforwardBlock(DASH): Failed to write timestamp index");
-    }
-
     return true;
 }
 
@@ -5035,6 +5232,7 @@ void UnloadBlockIndex(CTxMemPool* mempool, ChainstateManager& chainman)
 {
     LOCK(cs_main);
     chainman.Unload();
+    g_pow_window.Reset();
     pindexBestInvalid = nullptr;
     pindexBestHeader = nullptr;
     if (mempool) mempool->clear();
@@ -5068,18 +5266,6 @@ bool ChainstateManager::LoadBlockIndex()
         // needs_init.
 
         LogPrintf("Initializing databases...\n");
-
-        // Use the provided setting for -addressindex in the new database
-        fAddressIndex = gArgs.GetBoolArg("-addressindex", DEFAULT_ADDRESSINDEX);
-        pblocktree->WriteFlag("addressindex", fAddressIndex);
-
-        // Use the provided setting for -timestampindex in the new database
-        fTimestampIndex = gArgs.GetBoolArg("-timestampindex", DEFAULT_TIMESTAMPINDEX);
-        pblocktree->WriteFlag("timestampindex", fTimestampIndex);
-
-        // Use the provided setting for -spentindex in the new database
-        fSpentIndex = gArgs.GetBoolArg("-spentindex", DEFAULT_SPENTINDEX);
-        pblocktree->WriteFlag("spentindex", fSpentIndex);
     }
     return true;
 }
@@ -5496,6 +5682,8 @@ CBlockFileInfo* GetBlockFileInfo(size_t n)
 }
 
 static const uint64_t MEMPOOL_DUMP_VERSION = 1;
+/** Number of transactions from mempool.dat accepted together */
+static constexpr size_t LOAD_MEMPOOL_BATCH_SIZE{100};
 
 bool LoadMempool(CTxMemPool& pool, CChainState& active_chainstate, FopenFn mockable_fopen_function)
 {
@@ -5513,8 +5701,40 @@ bool LoadMempool(CTxMemPool& pool, CChainState& active_chainstate, FopenFn mocka
     int64_t failed = 0;
     int64_t already_there = 0;
     int64_t unbroadcast = 0;
+    int64_t locked = 0;
     int64_t nNow = GetTime();
 
+    // Transactions are accepted in batches, whose scripts are checked on the script check threads
+    std::vector<CTransactionRef> batch;
+    std::vector<int64_t> batch_times;
+    const auto accept_batch = [&] {
+        if (batch.empty()) return;
+        LOCK(cs_main);
+        assert(std::addressof(::ChainstateActive()) == std::addressof(active_chainstate));
+        const std::vector<MempoolAcceptResult> results = AcceptToMemoryPoolBatchWithTime(chainparams, pool, active_chainstate, batch, batch_times);
+        for (size_t i = 0; i < batch.size(); ++i) {
+            if (results[i].m_result_type == MempoolAcceptResult::ResultType::VALID) {
+                ++count;
+                // The islocks are kept in the InstantSend database, the transactions are locked again as soon as they are back
+                if (llmq::quorumInstantSendManager && llmq::quorumInstantSendManager->IsLocked(batch[i]->GetHash())) {
+                    ++locked;
+                }
+            } else {
+                // mempool may contain the transaction already, e.g. from
+                // wallet(s) having loaded it while we were processing
+                // mempool transactions; consider these as valid, instead of
+                // failed, but mark them as 'already there'
+                if (pool.exists(batch[i]->GetHash())) {
+                    ++already_there;
+                } else {
+                    ++failed;
+                }
+            }
+        }
+        batch.clear();
+        batch_times.clear();
+    };
+
     try {
         uint64_t version;
         file >> version;
@@ -5523,6 +5743,9 @@ bool LoadMempool(CTxMemPool& pool, CChainState& active_chainstate, FopenFn mocka
         }
         uint64_t num;
         file >> num;
+        const uint64_t total = num;
+        int last_progress = -1;
+        uiInterface.ShowProgress(_("Loading mempool...").translated, 0, false);
         while (num) {
             --num;
             CTransactionRef tx;
@@ -5537,28 +5760,28 @@ bool LoadMempool(CTxMemPool& pool, CChainState& active_chainstate, FopenFn mocka
                 pool.PrioritiseTransaction(tx->GetHash(), amountdelta);
             }
             if (nTime > nNow - nExpiryTimeout) {
-                LOCK(cs_main);
-                assert(std::addressof(::ChainstateActive()) == std::addressof(active_chainstate));
-                if (AcceptToMemoryPoolWithTime(chainparams, pool, active_chainstate, tx, nTime, false /* bypass_limits */,
-                                               false /* test_accept */).m_result_type == MempoolAcceptResult::ResultType::VALID) {
-                    ++count;
-                } else {
-                    // mempool may contain the transaction already, e.g. from
-                    // wallet(s) having loaded it while we were processing
-                    // mempool transactions; consider these as valid, instead of
-                    // failed, but mark them as 'already there'
-                    if (pool.exists(tx->GetHash())) {
-                        ++already_there;
-                    } else {
-                        ++failed;
-                    }
-                }
+                batch.push_back(std::move(tx));
+                batch_times.push_back(nTime);
             } else {
                 ++expired;
             }
-            if (ShutdownRequested())
+            if (batch.size() >= LOAD_MEMPOOL_BATCH_SIZE || num == 0) {
+                accept_batch();
+                const int progress = (total - num) * 100 / total;
+                if (progress != last_progress) {
+                    uiInterface.ShowProgress(_("Loading mempool...").translated, progress, false);
+                    if (progress / 10 != last_progress / 10) {
+                        LogPrintf("Loading mempool transactions from disk: %d%%\n", progress);
+                    }
+                    last_progress = progress;
+                }
+            }
+            if (ShutdownRequested()) {
+                uiInterface.ShowProgress("", 100, false);
                 return false;
+            }
         }
+        uiInterface.ShowProgress("", 100, false);
         std::map<uint256, CAmount> mapDeltas;
         file >> mapDeltas;
 
@@ -5577,10 +5800,13 @@ bool LoadMempool(CTxMemPool& pool, CChainState& active_chainstate, FopenFn mocka
 
     } catch (const std::exception& e) {
         LogPrintf("Failed to deserialize mempool data on disk: %s. Continuing anyway.\n", e.what());
+        // The transactions read before the error are still accepted
+        accept_batch();
+        uiInterface.ShowProgress("", 100, false);
         return false;
     }
 
-    LogPrintf("Imported mempool transactions from disk: %i succeeded, %i failed, %i expired, %i already there, %i waiting for initial broadcast\n", count, failed, expired, already_there, unbroadcast);
+    LogPrintf("Imported mempool transactions from disk: %i succeeded (%i InstantSend locked), %i failed, %i expired, %i already there, %i waiting for initial broadcast\n", count, locked, failed, expired, already_there, unbroadcast);
     return true;
 }
 
@@ -5925,17 +6151,34 @@ bool ChainstateManager::PopulateAndValidateSnapshot(
     // method.
     coins_cache.SetBestBlock(base_blockhash);
 
+    // The coins may be followed by the evo state at the base block
+    std::optional<CEvoSnapshot> evo_snapshot;
+    uint32_t evo_magic{0};
     bool out_of_coins{false};
     try {
-        coins_file >> outpoint;
+        coins_file >> evo_magic;
     } catch (const std::ios_base::failure&) {
         // We expect an exception since we should be out of coins.
         out_of_coins = true;
     }
     if (!out_of_coins) {
-        LogPrintf("[snapshot] bad snapshot - coins left over after deserializing %d coins\n",
-            coins_count);
-        return false;
+        if (evo_magic != EVO_SNAPSHOT_MAGIC) {
+            LogPrintf("[snapshot] bad snapshot - coins left over after deserializing %d coins\n",
+                coins_count);
+            return false;
+        }
+        try {
+            coins_file >> evo_snapshot.emplace();
+        } catch (const std::ios_base::failure&) {
+            LogPrintf("[snapshot] bad snapshot format or truncated evo state\n");
+            return false;
+        }
+        try {
+            coins_file >> evo_magic;
+            LogPrintf("[snapshot] bad snapshot - data left over after the evo state\n");
+            return false;
+        } catch (const std::ios_base::failure&) {
+        }
     }
 
     LogPrintf("[snapshot] loaded %d (%.2f MB) coins from snapshot %s\n",
@@ -5973,6 +6216,20 @@ bool ChainstateManager::PopulateAndValidateSnapshot(
     // The remainder of this function requires modifying data protected by cs_main.
     LOCK(::cs_main);
 
+    // Without the blocks below the base its masternode lists, quorums and credit pool can't be built
+    if (base_height >= ::Params().GetConsensus().DIP0003Height) {
+        if (!evo_snapshot) {
+            LogPrintf("[snapshot] bad snapshot - evo state missing for height %d\n", base_height);
+            return false;
+        }
+        std::string strError;
+        if (!LoadEvoSnapshot(*evo_snapshot, snapshot_start_block, snapshot_chainstate.m_evoDb, *deterministicMNManager, *creditPoolManager,
+                             snapshot_chainstate.m_mnhfManager, *snapshot_chainstate.m_quorum_block_processor, strError)) {
+            LogPrintf("[snapshot] bad snapshot evo state: %s\n", strError);
+            return false;
+        }
+    }
+
     // Fake various pieces of CBlockIndex state:
     //
     //   - nChainTx: so that we accurately report IBD-to-tip progress
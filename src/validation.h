@@ -63,6 +63,7 @@ class CScriptCheck;
 class CTxMemPool;
 class TxValidationState;
 class ChainstateManager;
+struct MNListUpdates;
 struct PrecomputedTransactionData;
 struct ChainTxData;
 
@@ -91,7 +92,9 @@ static const unsigned int DEFAULT_MEMPOOL_EXPIRY = 336;
 /** The maximum size of a blk?????.dat file (since 0.8) */
 static const unsigned int MAX_BLOCKFILE_SIZE = 0x8000000; // 128 MiB
 /** Maximum number of dedicated script-checking threads allowed */
-static const int MAX_SCRIPTCHECK_THREADS = 15;
+static const int MAX_SCRIPTCHECK_THREADS = 63;
+/** Default for -scriptcheckaffinity */
+static const bool DEFAULT_SCRIPTCHECK_AFFINITY = false;
 /** -par default (number of script-checking threads, 0 = auto) */
 static const int DEFAULT_SCRIPTCHECK_THREADS = 0;
 /** Number of headers sent in one getheaders result. We rely on the assumption that if a peer sends
@@ -112,11 +115,15 @@ static const unsigned int DEFAULT_BANSCORE_THRESHOLD = 100;
 static const bool DEFAULT_PERSIST_MEMPOOL = true;
 /** Default for -syncmempool */
 static const bool DEFAULT_SYNC_MEMPOOL = true;
+/** Default for -backgroundflush */
+static const bool DEFAULT_BACKGROUND_FLUSH = false;
 
 /** Default for -stopatheight */
 static const int DEFAULT_STOPATHEIGHT = 0;
 /** Block files containing a block-height within MIN_BLOCKS_TO_KEEP of ::ChainActive().Tip() will not be pruned. */
 static const unsigned int MIN_BLOCKS_TO_KEEP = 288;
+/** Default for -prunekeepquorumblocks */
+static const bool DEFAULT_PRUNE_KEEP_QUORUM_BLOCKS = false;
 static const signed int DEFAULT_CHECKBLOCKS = 6;
 static const unsigned int DEFAULT_CHECKLEVEL = 3;
 
@@ -181,6 +188,8 @@ extern bool fHavePruned;
 extern bool fPruneMode;
 /** Number of MiB of block files that we're trying to stay below. */
 extern uint64_t nPruneTarget;
+/** Block files containing a block-height within this many blocks of the tip will not be pruned, at least MIN_BLOCKS_TO_KEEP. */
+extern unsigned int nPruneBlocksToKeep;
 /** Documentation for argument 'checklevel'. */
 extern const std::vector<std::string> CHECKLEVEL_DOC;
 
@@ -191,9 +200,22 @@ fs::path GetBlockPosFilename(const FlatFilePos &pos);
 /** Unload database information */
 void UnloadBlockIndex(CTxMemPool* mempool, ChainstateManager& chainman);
 /** Run instances of script checking worker threads */
-void StartScriptCheckWorkerThreads(int threads_num);
+void StartScriptCheckWorkerThreads(int threads_num, bool pin_threads = false);
 /** Stop all of the script checking worker threads */
 void StopScriptCheckWorkerThreads();
+/** Run instances of ProTx payload signature checking worker threads */
+void StartProTxSigCheckWorkerThreads(int threads_num);
+/** Stop all of the ProTx payload signature checking worker threads */
+void StopProTxSigCheckWorkerThreads();
+/** Run instances of header hashing worker threads */
+void StartHeaderHashWorkerThreads(int threads_num);
+/** Stop all of the header hashing worker threads */
+void StopHeaderHashWorkerThreads();
+/**
+ * Compute GetHash() for every header, spread over the header hashing worker threads.
+ * Must not be called with cs_main held, it is slow for X16R and KAWPOW headers.
+ */
+std::vector<uint256> HashBlockHeaders(const std::vector<CBlockHeader>& headers) LOCKS_EXCLUDED(cs_main);
 
 CTransactionRef GetTransaction(const CBlockIndex* const block_index, const CTxMemPool* const mempool, const uint256& hash, const Consensus::Params& consensusParams, uint256& hashBlock);
 
@@ -224,6 +246,12 @@ void UnlinkPrunedFiles(const std::set<int>& setFilesToPrune);
 /** Prune block files up to a given height */
 void PruneBlockFilesManual(CChainState& active_chainstate, int nManualPruneHeight);
 
+/**
+ * Number of blocks from the tip which the quorum and credit pool code may still read back from disk: the
+ * base blocks of all active quorums and the coinbases the credit pool is traced back through before them.
+ */
+unsigned int GetQuorumBlocksToKeep(const Consensus::Params& params);
+
 /**
 * Validation result for a single transaction mempool acceptance.
 */
@@ -290,6 +318,15 @@ struct PackageMempoolAcceptResult
 MempoolAcceptResult AcceptToMemoryPool(CChainState& active_chainstate, CTxMemPool& pool, const CTransactionRef& tx,
                                        bool bypass_limits, bool test_accept=false) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
+/**
+ * (Try to) add transactions to the memory pool, in order and independently of each other. The result
+ * is the same as calling AcceptToMemoryPool for each of them, but the script checks of the batch are
+ * run on the script check threads together.
+ * @returns a MempoolAcceptResult for each of txns.
+ */
+std::vector<MempoolAcceptResult> AcceptToMemoryPoolBatch(CChainState& active_chainstate, CTxMemPool& pool,
+                                                         const std::vector<CTransactionRef>& txns) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+
 /**
 * Atomically test acceptance of a package. If the package only contains one tx, package rules still
 * apply. The transaction(s) cannot spend the same inputs as any transaction in the mempool.
@@ -327,6 +364,13 @@ bool CheckFinalTx(const CBlockIndex* active_chain_tip, const CTransaction &tx, i
  */
 bool TestLockPointValidity(CChain& active_chain, const LockPoints* lp) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
+/**
+ * Verify the scripts of the transactions we already have of a block which builds on our tip and is still being
+ * downloaded, so ConnectBlock finds them in the script execution cache once the block is complete. Transactions
+ * whose inputs are not in the UTXO set are skipped, results are only cached, never reported.
+ */
+void PrecheckBlockTxScripts(CChainState& active_chainstate, const CBlockIndex* pindex, const std::vector<CTransactionRef>& txs) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+
 /**
  * Check if transaction will be BIP68 final in the next block to be created on top of tip.
  * @param[in]   tip             Chain tip to check tx sequence locks against. For example,
@@ -389,13 +433,6 @@ public:
     ScriptError GetScriptError() const { return error; }
 };
 
-bool GetTimestampIndex(const unsigned int &high, const unsigned int &low, std::vector<uint256> &hashes);
-bool GetSpentIndex(CTxMemPool& mempool, CSpentIndexKey &key, CSpentIndexValue &value);
-bool GetAddressIndex(uint160 addressHash, AddressType type,
-                     std::vector<std::pair<CAddressIndexKey, CAmount> > &addressIndex,
-                     int start = 0, int end = 0);
-bool GetAddressUnspent(uint160 addressHash, AddressType type,
-                       std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > &unspentOutputs);
 /** Initializes the script-execution cache */
 void InitScriptExecutionCache();
 
@@ -482,6 +519,18 @@ private:
      */
     void FindFilesToPrune(std::set<int>& setFilesToPrune, uint64_t nPruneAfterHeight, int chain_tip_height, int prune_height, bool is_ibd);
 
+    /**
+     * Block index entries live in slabs of this many instead of being allocated one by one. They are only freed
+     * together by Unload, so this saves the allocator overhead of every entry and keeps entries created together,
+     * like the headers of a sync, next to each other for walks along pprev and pskip.
+     */
+    static constexpr size_t BLOCK_INDEX_SLAB_SIZE{1024};
+    std::vector<std::unique_ptr<CBlockIndex[]>> m_block_index_slabs GUARDED_BY(cs_main);
+    size_t m_block_index_slab_used GUARDED_BY(cs_main){BLOCK_INDEX_SLAB_SIZE};
+
+    /** A default constructed entry which stays valid until Unload */
+    CBlockIndex* NewBlockIndex() EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+
 public:
     BlockMap m_block_index GUARDED_BY(cs_main);
     PrevBlockMap m_prev_block_index GUARDED_BY(cs_main);
@@ -544,6 +593,13 @@ public:
         BlockValidationState& state,
         const CChainParams& chainparams,
         CBlockIndex** ppindex) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+    /** Same as above, with hash being the already computed block.GetHash() */
+    bool AcceptBlockHeader(
+        const CBlockHeader& block,
+        const uint256& hash,
+        BlockValidationState& state,
+        const CChainParams& chainparams,
+        CBlockIndex** ppindex) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
     CBlockIndex* LookupBlockIndex(const uint256& hash) const EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
@@ -581,6 +637,9 @@ public:
     //! All unspent coins reside in this store.
     CCoinsViewDB m_dbview GUARDED_BY(cs_main);
 
+    //! This view writes the flushes of the cache to the leveldb instance, in the background with -backgroundflush.
+    CCoinsViewBackgroundFlush m_flushview GUARDED_BY(cs_main);
+
     //! This view wraps access to the leveldb instance and handles read errors gracefully.
     CCoinsViewErrorCatcher m_catcherview GUARDED_BY(cs_main);
 
@@ -732,6 +791,8 @@ public:
     //! @returns A reference to the on-disk UTXO set database.
     CCoinsViewDB& CoinsDB() EXCLUSIVE_LOCKS_REQUIRED(cs_main)
     {
+        // It is only complete once a flush running in the background is done
+        m_coins_views->m_flushview.WaitForWrite();
         return m_coins_views->m_dbview;
     }
 
@@ -804,11 +865,13 @@ public:
     bool AcceptBlock(const std::shared_ptr<const CBlock>& pblock, BlockValidationState& state, CBlockIndex** ppindex, bool fRequested, const FlatFilePos* dbp, bool* fNewBlock) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
     // Block (dis)connection on a given view:
-    DisconnectResult DisconnectBlock(const CBlock& block, const CBlockIndex* pindex, CCoinsViewCache& view) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+    // If mnlist_updates is set, the masternode list changes are returned in it instead of being notified
+    DisconnectResult DisconnectBlock(const CBlock& block, const CBlockIndex* pindex, CCoinsViewCache& view,
+                                     std::optional<MNListUpdates>* mnlist_updates = nullptr) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
     bool ConnectBlock(const CBlock& block, BlockValidationState& state, CBlockIndex* pindex, CCoinsViewCache& view, bool fJustCheck = false) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
-    // Apply the effects of a block disconnection on the UTXO set.
-    bool DisconnectTip(BlockValidationState& state, DisconnectedBlockTransactions* disconnectpool) EXCLUSIVE_LOCKS_REQUIRED(cs_main, m_mempool->cs);
+    // Apply the effects of disconnecting up to MAX_DISCONNECT_TIPS_BATCH blocks towards pindexFork on the UTXO set.
+    bool DisconnectTips(BlockValidationState& state, const CBlockIndex* pindexFork, DisconnectedBlockTransactions* disconnectpool, std::vector<CBlockIndex*>* vDisconnected = nullptr) EXCLUSIVE_LOCKS_REQUIRED(cs_main, m_mempool->cs);
 
     // Manual block validity manipulation:
     /** Mark a block as precious and reorganize.
@@ -1125,6 +1188,8 @@ public:
      * @param[out] first_invalid First header that fails validation, if one exists
      */
     bool ProcessNewBlockHeaders(const std::vector<CBlockHeader>& block, BlockValidationState& state, const CChainParams& chainparams, const CBlockIndex** ppindex = nullptr) LOCKS_EXCLUDED(cs_main);
+    /** Same as above, with hashes holding HashBlockHeaders(block) */
+    bool ProcessNewBlockHeaders(const std::vector<CBlockHeader>& block, const std::vector<uint256>& hashes, BlockValidationState& state, const CChainParams& chainparams, const CBlockIndex** ppindex = nullptr) LOCKS_EXCLUDED(cs_main);
 
     //! Load the block tree and coins database from disk, initializing state if we're running with -reindex
     bool LoadBlockIndex() EXCLUSIVE_LOCKS_REQUIRED(cs_main);
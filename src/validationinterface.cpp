@@ -12,14 +12,21 @@
 #include <primitives/block.h>
 #include <primitives/transaction.h>
 #include <scheduler.h>
+#include <tinyformat.h>
+#include <util/perfcounters.h>
+#include <util/thread.h>
 
 #include <governance/vote.h>
 #include <llmq/clsig.h>
 #include <llmq/signing.h>
 
+#include <algorithm>
+#include <deque>
 #include <future>
+#include <thread>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 //! The MainSignalsInstance manages a list of shared_ptr<CValidationInterface>
 //! callbacks.
@@ -28,6 +35,14 @@
 //! registered, and a std::list is to used to store the callbacks that are
 //! currently registered as well as any callbacks that are just unregistered
 //! and about to be deleted when they are done executing.
+//!
+//! Background events are kept in one log and every registered subscriber works
+//! through it on its own, so a slow subscriber only delays itself. Each
+//! subscriber gets the events in order and never runs two at once. A subscriber
+//! which registers starts at the oldest event which isn't done yet, like it would
+//! have been called for the events still in a single queue. Functions queued with
+//! CallFunctionInValidationInterfaceQueue are barriers: they run once every
+//! subscriber got the events before them, and nobody gets later events before.
 struct MainSignalsInstance {
 private:
     Mutex m_mutex;
@@ -35,24 +50,152 @@ private:
     //! count is equal to the number of current executions of that entry, plus 1
     //! if it's registered. It cannot be 0 because that would imply it is
     //! unregistered and also not being executed (so shouldn't exist).
-    struct ListEntry { std::shared_ptr<CValidationInterface> callbacks; int count = 1; };
+    struct ListEntry {
+        std::shared_ptr<CValidationInterface> callbacks;
+        int count = 1;
+        bool registered{true};
+        //! index of the next event for this subscriber
+        uint64_t cursor{0};
+        //! a step of this subscriber is scheduled or running
+        bool scheduled{false};
+    };
     std::list<ListEntry> m_list GUARDED_BY(m_mutex);
     std::unordered_map<CValidationInterface*, std::list<ListEntry>::iterator> m_map GUARDED_BY(m_mutex);
 
+    struct Event {
+        std::function<void(CValidationInterface&)> callback;
+        //! set instead of callback for a barrier
+        std::function<void()> func;
+        bool func_started{false};
+        bool func_done{false};
+    };
+    std::deque<Event> m_events GUARDED_BY(m_mutex);
+    //! index of m_events.front()
+    uint64_t m_events_base GUARDED_BY(m_mutex){0};
+
+    //! set when the events are dispatched by threads of their own instead of the given scheduler
+    std::unique_ptr<CScheduler> m_dispatcher;
+    CScheduler& m_scheduler;
+    std::vector<std::thread> m_dispatch_threads;
+
+    perf::Gauge& m_queue_gauge{perf::GetGauge("validationinterface.queue", "Validation interface events not yet processed by all subscribers")};
+    perf::Gauge& m_busy_gauge{perf::GetGauge("validationinterface.busy_subscribers", "Validation interface subscribers with events to process")};
+
+    Event& EventAt(uint64_t index) EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return m_events[index - m_events_base]; }
+    uint64_t EventsEnd() const EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return m_events_base + m_events.size(); }
+
+    //! Skip the barriers which are done, return whether an event is left for the subscriber
+    bool Runnable(ListEntry& entry) EXCLUSIVE_LOCKS_REQUIRED(m_mutex)
+    {
+        while (entry.cursor < EventsEnd()) {
+            const Event& event = EventAt(entry.cursor);
+            if (event.callback) return true;
+            if (!event.func_done) return false;
+            ++entry.cursor;
+        }
+        return false;
+    }
+
+    //! Whether the oldest event is a barrier which can run, after trimming
+    bool BarrierReady(uint64_t min_cursor) const EXCLUSIVE_LOCKS_REQUIRED(m_mutex)
+    {
+        return !m_events.empty() && !m_events.front().callback && !m_events.front().func_started && min_cursor >= m_events_base;
+    }
+
+    //! Drop the events all subscribers are done with and give work to the ones which can go on
+    void Pump(bool schedule = true) EXCLUSIVE_LOCKS_REQUIRED(m_mutex)
+    {
+        uint64_t min_cursor = EventsEnd();
+        int64_t busy{0};
+        for (const auto& [_, it] : m_map) {
+            if (Runnable(*it)) {
+                ++busy;
+                if (schedule && !it->scheduled) {
+                    it->scheduled = true;
+                    ++it->count;
+                    m_scheduler.schedule([this, it = it] { Step(it); }, std::chrono::system_clock::now());
+                }
+            }
+            min_cursor = std::min(min_cursor, it->cursor);
+        }
+        while (!m_events.empty() && m_events_base < min_cursor &&
+               (m_events.front().callback || m_events.front().func_done)) {
+            m_events.pop_front();
+            ++m_events_base;
+        }
+        // Subscribers can't pass a barrier which isn't done, so it can run once none is behind it
+        if (schedule && BarrierReady(min_cursor)) {
+            m_events.front().func_started = true;
+            m_scheduler.schedule([this, index = m_events_base] { RunBarrier(index); }, std::chrono::system_clock::now());
+        }
+        m_queue_gauge.Set(m_events.size());
+        m_busy_gauge.Set(busy);
+    }
+
+    void Step(std::list<ListEntry>::iterator it) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        WAIT_LOCK(m_mutex, lock);
+        if (it->registered && Runnable(*it)) {
+            // the event can be dropped meanwhile if this subscriber is unregistered
+            const auto callback = EventAt(it->cursor).callback;
+            {
+                REVERSE_LOCK(lock);
+                callback(*it->callbacks);
+            }
+            ++it->cursor;
+        }
+        it->scheduled = false;
+        if (!--it->count) m_list.erase(it);
+        Pump();
+    }
+
+    void RunBarrier(uint64_t index) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        WAIT_LOCK(m_mutex, lock);
+        // deque references stay valid while other events are added, this one isn't dropped before it is done
+        Event& event = EventAt(index);
+        {
+            REVERSE_LOCK(lock);
+            event.func();
+        }
+        event.func_done = true;
+        Pump();
+    }
+
 public:
-    // We are not allowed to assume the scheduler only runs in one thread,
-    // but must ensure all callbacks happen in-order, so we end up creating
-    // our own queue here :(
-    SingleThreadedSchedulerClient m_schedulerClient;
+    explicit MainSignalsInstance(CScheduler& scheduler LIFETIMEBOUND, int threads) :
+        m_dispatcher(threads > 0 ? std::make_unique<CScheduler>() : nullptr),
+        m_scheduler(m_dispatcher ? *m_dispatcher : scheduler)
+    {
+        for (int i = 0; i < threads; ++i) {
+            m_dispatch_threads.emplace_back(&util::TraceThread, "valsig", [this] { m_dispatcher->serviceQueue(); });
+        }
+    }
+
+    ~MainSignalsInstance()
+    {
+        StopDispatchThreads();
+    }
 
-    explicit MainSignalsInstance(CScheduler& scheduler LIFETIMEBOUND) : m_schedulerClient(scheduler) {}
+    void StopDispatchThreads()
+    {
+        if (!m_dispatcher) return;
+        m_dispatcher->stop();
+        for (auto& thread : m_dispatch_threads) {
+            if (thread.joinable()) thread.join();
+        }
+    }
 
     void Register(std::shared_ptr<CValidationInterface> callbacks)
     {
         LOCK(m_mutex);
         auto inserted = m_map.emplace(callbacks.get(), m_list.end());
-        if (inserted.second) inserted.first->second = m_list.emplace(m_list.end());
+        if (inserted.second) {
+            inserted.first->second = m_list.emplace(m_list.end());
+            inserted.first->second->cursor = m_events_base;
+        }
         inserted.first->second->callbacks = std::move(callbacks);
+        Pump();
     }
 
     void Unregister(CValidationInterface* callbacks)
@@ -60,9 +203,11 @@ public:
         LOCK(m_mutex);
         auto it = m_map.find(callbacks);
         if (it != m_map.end()) {
+            it->second->registered = false;
             if (!--it->second->count) m_list.erase(it->second);
             m_map.erase(it);
         }
+        Pump();
     }
 
     //! Clear unregisters every previously registered callback, erasing every
@@ -73,9 +218,11 @@ public:
     {
         LOCK(m_mutex);
         for (const auto& entry : m_map) {
+            entry.second->registered = false;
             if (!--entry.second->count) m_list.erase(entry.second);
         }
         m_map.clear();
+        Pump();
     }
 
     template<typename F> void Iterate(F&& f)
@@ -90,14 +237,83 @@ public:
             it = --it->count ? std::next(it) : m_list.erase(it);
         }
     }
+
+    //! Queue an event for all registered subscribers
+    void Enqueue(std::function<void(CValidationInterface&)> callback)
+    {
+        LOCK(m_mutex);
+        m_events.push_back({std::move(callback), {}});
+        Pump();
+    }
+
+    void EnqueueBarrier(std::function<void()> func)
+    {
+        LOCK(m_mutex);
+        m_events.push_back({{}, std::move(func)});
+        Pump();
+    }
+
+    size_t CallbacksPending()
+    {
+        LOCK(m_mutex);
+        return m_events.size();
+    }
+
+    /**
+     * Process all remaining events on the calling thread. Must be called after the scheduler
+     * has no threads running it anymore, the steps it still has queued are never run.
+     */
+    void EmptyQueue()
+    {
+        StopDispatchThreads();
+        WAIT_LOCK(m_mutex, lock);
+        while (true) {
+            bool progress{false};
+            for (auto map_it = m_map.begin(); map_it != m_map.end();) {
+                auto it = map_it->second;
+                ++map_it;
+                it->scheduled = false;
+                if (!Runnable(*it)) continue;
+                const auto callback = EventAt(it->cursor).callback;
+                ++it->count;
+                {
+                    REVERSE_LOCK(lock);
+                    callback(*it->callbacks);
+                }
+                ++it->cursor;
+                if (!--it->count) m_list.erase(it);
+                progress = true;
+                // the callback may have unregistered others
+                break;
+            }
+            Pump(/*schedule=*/false);
+            if (!progress) {
+                uint64_t min_cursor = EventsEnd();
+                for (const auto& [_, it] : m_map) min_cursor = std::min(min_cursor, it->cursor);
+                // a barrier can be started already if its task was left in the stopped scheduler
+                if (!m_events.empty() && !m_events.front().callback && min_cursor >= m_events_base) {
+                    Event& event = m_events.front();
+                    event.func_started = true;
+                    {
+                        REVERSE_LOCK(lock);
+                        event.func();
+                    }
+                    event.func_done = true;
+                    progress = true;
+                }
+            }
+            if (!progress) break;
+        }
+        Pump(/*schedule=*/false);
+    }
 };
 
 static CMainSignals g_signals;
 
-void CMainSignals::RegisterBackgroundSignalScheduler(CScheduler& scheduler)
+void CMainSignals::RegisterBackgroundSignalScheduler(CScheduler& scheduler, int threads)
 {
     assert(!m_internals);
-    m_internals = std::make_unique<MainSignalsInstance>(scheduler);
+    m_internals = std::make_unique<MainSignalsInstance>(scheduler, threads);
 }
 
 void CMainSignals::UnregisterBackgroundSignalScheduler()
@@ -108,14 +324,14 @@ void CMainSignals::UnregisterBackgroundSignalScheduler()
 void CMainSignals::FlushBackgroundCallbacks()
 {
     if (m_internals) {
-        m_internals->m_schedulerClient.EmptyQueue();
+        m_internals->EmptyQueue();
     }
 }
 
 size_t CMainSignals::CallbacksPending()
 {
     if (!m_internals) return 0;
-    return m_internals->m_schedulerClient.CallbacksPending();
+    return m_internals->CallbacksPending();
 }
 
 CMainSignals& GetMainSignals()
@@ -159,7 +375,7 @@ void UnregisterAllValidationInterfaces()
 
 void CallFunctionInValidationInterfaceQueue(std::function<void()> func)
 {
-    g_signals.m_internals->m_schedulerClient.AddToProcessQueue(std::move(func));
+    g_signals.m_internals->EnqueueBarrier(std::move(func));
 }
 
 void SyncWithValidationInterfaceQueue()
@@ -176,15 +392,12 @@ void SyncWithValidationInterfaceQueue()
 // Use a macro instead of a function for conditional logging to prevent
 // evaluating arguments when logging is not enabled.
 //
-// NOTE: The lambda captures all local variables by value.
+// The event is called once for every subscriber, which may happen on different threads.
 #define ENQUEUE_AND_LOG_EVENT(event, fmt, name, ...)           \
     do {                                                       \
         auto local_name = (name);                              \
         LOG_EVENT("Enqueuing " fmt, local_name, __VA_ARGS__);  \
-        m_internals->m_schedulerClient.AddToProcessQueue([=] { \
-            LOG_EVENT(fmt, local_name, __VA_ARGS__);           \
-            event();                                           \
-        });                                                    \
+        m_internals->Enqueue(std::move(event));                \
     } while (0)
 
 #define LOG_EVENT(fmt, ...) \
@@ -195,8 +408,8 @@ void CMainSignals::UpdatedBlockTip(const CBlockIndex *pindexNew, const CBlockInd
     // the chain actually updates. One way to ensure this is for the caller to invoke this signal
     // in the same critical section where the chain is updated
 
-    auto event = [pindexNew, pindexFork, fInitialDownload, this] {
-        m_internals->Iterate([&](CValidationInterface& callbacks) { callbacks.UpdatedBlockTip(pindexNew, pindexFork, fInitialDownload); });
+    auto event = [pindexNew, pindexFork, fInitialDownload](CValidationInterface& callbacks) {
+        callbacks.UpdatedBlockTip(pindexNew, pindexFork, fInitialDownload);
     };
     ENQUEUE_AND_LOG_EVENT(event, "%s: new block hash=%s fork block hash=%s (in IBD=%s)", __func__,
                           pindexNew->GetBlockHash().ToString(),
@@ -209,24 +422,24 @@ void CMainSignals::SynchronousUpdatedBlockTip(const CBlockIndex *pindexNew, cons
 }
 
 void CMainSignals::TransactionAddedToMempool(const CTransactionRef& tx, int64_t nAcceptTime) {
-    auto event = [tx, nAcceptTime, this] {
-        m_internals->Iterate([&](CValidationInterface& callbacks) { callbacks.TransactionAddedToMempool(tx, nAcceptTime); });
+    auto event = [tx, nAcceptTime](CValidationInterface& callbacks) {
+        callbacks.TransactionAddedToMempool(tx, nAcceptTime);
     };
     ENQUEUE_AND_LOG_EVENT(event, "%s: txid=%s", __func__,
                           tx->GetHash().ToString());
 }
 
 void CMainSignals::TransactionRemovedFromMempool(const CTransactionRef& tx, MemPoolRemovalReason reason) {
-    auto event = [tx, reason, this] {
-        m_internals->Iterate([&](CValidationInterface& callbacks) { callbacks.TransactionRemovedFromMempool(tx, reason); });
+    auto event = [tx, reason](CValidationInterface& callbacks) {
+        callbacks.TransactionRemovedFromMempool(tx, reason);
     };
     ENQUEUE_AND_LOG_EVENT(event, "%s: txid=%s", __func__,
                           tx->GetHash().ToString());
 }
 
 void CMainSignals::BlockConnected(const std::shared_ptr<const CBlock> &pblock, const CBlockIndex *pindex) {
-    auto event = [pblock, pindex, this] {
-        m_internals->Iterate([&](CValidationInterface& callbacks) { callbacks.BlockConnected(pblock, pindex); });
+    auto event = [pblock, pindex](CValidationInterface& callbacks) {
+        callbacks.BlockConnected(pblock, pindex);
     };
     ENQUEUE_AND_LOG_EVENT(event, "%s: block hash=%s block height=%d", __func__,
                           pblock->GetHash().ToString(),
@@ -234,8 +447,8 @@ void CMainSignals::BlockConnected(const std::shared_ptr<const CBlock> &pblock, c
 }
 
 void CMainSignals::BlockDisconnected(const std::shared_ptr<const CBlock> &pblock, const CBlockIndex* pindex) {
-    auto event = [pblock, pindex, this] {
-        m_internals->Iterate([&](CValidationInterface& callbacks) { callbacks.BlockDisconnected(pblock, pindex); });
+    auto event = [pblock, pindex](CValidationInterface& callbacks) {
+        callbacks.BlockDisconnected(pblock, pindex);
     };
     ENQUEUE_AND_LOG_EVENT(event, "%s: block hash=%s block height=%d", __func__,
                           pblock->GetHash().ToString(),
@@ -243,8 +456,8 @@ void CMainSignals::BlockDisconnected(const std::shared_ptr<const CBlock> &pblock
 }
 
 void CMainSignals::ChainStateFlushed(const CBlockLocator &locator) {
-    auto event = [locator, this] {
-        m_internals->Iterate([&](CValidationInterface& callbacks) { callbacks.ChainStateFlushed(locator); });
+    auto event = [locator](CValidationInterface& callbacks) {
+        callbacks.ChainStateFlushed(locator);
     };
     ENQUEUE_AND_LOG_EVENT(event, "%s: block hash=%s", __func__,
                           locator.IsNull() ? "null" : locator.vHave.front().ToString());
@@ -272,16 +485,16 @@ void CMainSignals::NotifyHeaderTip(const CBlockIndex *pindexNew, bool fInitialDo
 }
 
 void CMainSignals::NotifyTransactionLock(const CTransactionRef &tx, const std::shared_ptr<const llmq::CInstantSendLock>& islock) {
-    auto event = [tx, islock, this] {
-        m_internals->Iterate([&](CValidationInterface& callbacks) { callbacks.NotifyTransactionLock(tx, islock); });
+    auto event = [tx, islock](CValidationInterface& callbacks) {
+        callbacks.NotifyTransactionLock(tx, islock);
     };
     ENQUEUE_AND_LOG_EVENT(event, "%s: transaction lock txid=%s", __func__,
                           tx->GetHash().ToString());
 }
 
 void CMainSignals::NotifyChainLock(const CBlockIndex* pindex, const std::shared_ptr<const llmq::CChainLockSig>& clsig) {
-    auto event = [pindex, clsig, this] {
-        m_internals->Iterate([&](CValidationInterface& callbacks) { callbacks.NotifyChainLock(pindex, clsig); });
+    auto event = [pindex, clsig](CValidationInterface& callbacks) {
+        callbacks.NotifyChainLock(pindex, clsig);
     };
     ENQUEUE_AND_LOG_EVENT(event, "%s: notify chainlock at block=%s cl=%s", __func__,
             pindex->GetBlockHash().ToString(),
@@ -289,22 +502,22 @@ void CMainSignals::NotifyChainLock(const CBlockIndex* pindex, const std::shared_
 }
 
 void CMainSignals::NotifyGovernanceVote(const std::shared_ptr<const CGovernanceVote>& vote) {
-    auto event = [vote, this] {
-        m_internals->Iterate([&](CValidationInterface& callbacks) { callbacks.NotifyGovernanceVote(vote); });
+    auto event = [vote](CValidationInterface& callbacks) {
+        callbacks.NotifyGovernanceVote(vote);
     };
     ENQUEUE_AND_LOG_EVENT(event, "%s: notify governance vote: %s", __func__, vote->GetHash().ToString());
 }
 
 void CMainSignals::NotifyGovernanceObject(const std::shared_ptr<const Governance::Object>& object) {
-    auto event = [object, this] {
-        m_internals->Iterate([&](CValidationInterface& callbacks) { callbacks.NotifyGovernanceObject(object); });
+    auto event = [object](CValidationInterface& callbacks) {
+        callbacks.NotifyGovernanceObject(object);
     };
     ENQUEUE_AND_LOG_EVENT(event, "%s: notify governance object: %s", __func__, object->GetHash().ToString());
 }
 
 void CMainSignals::NotifyInstantSendDoubleSpendAttempt(const CTransactionRef& currentTx, const CTransactionRef& previousTx) {
-    auto event = [currentTx, previousTx, this] {
-        m_internals->Iterate([&](CValidationInterface& callbacks) { callbacks.NotifyInstantSendDoubleSpendAttempt(currentTx, previousTx); });
+    auto event = [currentTx, previousTx](CValidationInterface& callbacks) {
+        callbacks.NotifyInstantSendDoubleSpendAttempt(currentTx, previousTx);
     };
     ENQUEUE_AND_LOG_EVENT(event, "%s: notify instant doublespendattempt currenttxid=%s previoustxid=%s", __func__,
             currentTx->GetHash().ToString(),
@@ -312,8 +525,8 @@ void CMainSignals::NotifyInstantSendDoubleSpendAttempt(const CTransactionRef& cu
 }
 
 void CMainSignals::NotifyRecoveredSig(const std::shared_ptr<const llmq::CRecoveredSig>& sig) {
-    auto event = [sig, this] {
-        m_internals->Iterate([&](CValidationInterface& callbacks) { callbacks.NotifyRecoveredSig(sig); });
+    auto event = [sig](CValidationInterface& callbacks) {
+        callbacks.NotifyRecoveredSig(sig);
     };
     ENQUEUE_AND_LOG_EVENT(event, "%s: notify recoveredsig=%s", __func__,
             sig->GetHash().ToString());
@@ -37,6 +37,10 @@ namespace llmq {
     class CRecoveredSig;
 } // namespace llmq
 
+/** Default for -validationsignalthreads, 0 runs the subscribers on the scheduler thread */
+static constexpr int DEFAULT_VALIDATION_SIGNAL_THREADS{0};
+static constexpr int MAX_VALIDATION_SIGNAL_THREADS{16};
+
 /** Register subscriber */
 void RegisterValidationInterface(CValidationInterface* callbacks);
 /** Unregister subscriber. DEPRECATED. This is not safe to use when the RPC server or main message handler thread is running. */
@@ -212,13 +216,17 @@ private:
     friend void ::CallFunctionInValidationInterfaceQueue(std::function<void ()> func);
 
 public:
-    /** Register a CScheduler to give callbacks which should run in the background (may only be called once) */
-    void RegisterBackgroundSignalScheduler(CScheduler& scheduler);
+    /**
+     * Register a CScheduler to give callbacks which should run in the background (may only be called once).
+     * With threads > 0 they run on that many threads of their own instead, subscribers in parallel.
+     */
+    void RegisterBackgroundSignalScheduler(CScheduler& scheduler, int threads = 0);
     /** Unregister a CScheduler to give callbacks which should run in the background - these callbacks will now be dropped! */
     void UnregisterBackgroundSignalScheduler();
     /** Call any remaining callbacks on the calling thread */
     void FlushBackgroundCallbacks();
 
+    /** Number of background events which not all subscribers have processed yet */
     size_t CallbacksPending();
 
 
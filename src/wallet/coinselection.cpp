@@ -10,6 +10,8 @@
 
 #include <coinjoin/common.h>
 
+#include <algorithm>
+#include <array>
 #include <optional>
 
 // Descending order comparator
@@ -246,6 +248,81 @@ bool less_then_denom (const OutputGroup& group1, const OutputGroup& group2)
     return (!found1 && found2);
 }
 
+/*
+ * Every standard denomination is ten times the next smaller one, so smaller denominations which add up to at
+ * least a larger one always contain a subset of exactly its value. A selection can thus take as many coins of
+ * each denomination as fit into what is left of the target, and the only choice per denomination is to stop
+ * with one coin more than fits instead. Of these few selections the one which exceeds the target the least is
+ * taken, with the fewest inputs on a tie. There is no change for fully mixed coins, the excess pays the fee.
+ */
+bool SelectCoinsDenominated(const CAmount& nTargetValue, const std::vector<OutputGroup>& groups, std::set<CInputCoin>& setCoinsRet, CAmount& nValueRet, CAmount maxTxFee)
+{
+    static constexpr auto denoms = CoinJoin::GetStandardDenominations();
+    static_assert(denoms.size() == 5 && denoms[0] % denoms[1] == 0 && denoms[1] % denoms[2] == 0 &&
+                  denoms[2] % denoms[3] == 0 && denoms[3] % denoms[4] == 0,
+                  "denominations must be descending and each a multiple of the next");
+
+    setCoinsRet.clear();
+    nValueRet = 0;
+
+    if (nTargetValue <= 0) {
+        return false;
+    }
+
+    // groups were shuffled by the caller, taking the first ones of each denomination is random
+    std::array<std::vector<const OutputGroup*>, denoms.size()> vecDenomGroups;
+    for (const OutputGroup& group : groups) {
+        const auto it = std::find(denoms.begin(), denoms.end(), group.m_value);
+        if (it != denoms.end()) {
+            vecDenomGroups[it - denoms.begin()].push_back(&group);
+        }
+    }
+
+    std::array<size_t, denoms.size()> vecCounts{};
+    std::array<size_t, denoms.size()> vecBestCounts{};
+    std::optional<CAmount> nBest;
+    size_t nBestInputs{0};
+    auto consider = [&](const std::array<size_t, denoms.size()>& counts, CAmount nValue, size_t nInputs) {
+        if (!nBest || nValue < *nBest || (nValue == *nBest && nInputs < nBestInputs)) {
+            vecBestCounts = counts;
+            nBest = nValue;
+            nBestInputs = nInputs;
+        }
+    };
+
+    CAmount nRemaining = nTargetValue;
+    CAmount nSelected = 0;
+    size_t nInputs = 0;
+    for (size_t i = 0; i < denoms.size() && nRemaining > 0; ++i) {
+        const size_t nFit = std::min<size_t>(vecDenomGroups[i].size(), nRemaining / denoms[i]);
+        if (nFit < vecDenomGroups[i].size()) {
+            auto counts = vecCounts;
+            counts[i] = nFit + 1;
+            consider(counts, nSelected + (nFit + 1) * denoms[i], nInputs + nFit + 1);
+        }
+        vecCounts[i] = nFit;
+        nSelected += nFit * denoms[i];
+        nInputs += nFit;
+        nRemaining -= nFit * denoms[i];
+    }
+    if (nRemaining <= 0) {
+        consider(vecCounts, nSelected, nInputs);
+    }
+
+    if (!nBest || *nBest - nTargetValue > maxTxFee) {
+        return false;
+    }
+
+    for (size_t i = 0; i < denoms.size(); ++i) {
+        for (size_t j = 0; j < vecBestCounts[i]; ++j) {
+            util::insert(setCoinsRet, vecDenomGroups[i][j]->m_outputs);
+            nValueRet += vecDenomGroups[i][j]->m_value;
+        }
+    }
+    LogPrint(BCLog::SELECTCOINS, "SelectCoinsDenominated -- %d inputs, total %s\n", nBestInputs, FormatMoney(nValueRet));
+    return true;
+}
+
 bool KnapsackSolver(const CAmount& nTargetValue, std::vector<OutputGroup>& groups, std::set<CInputCoin>& setCoinsRet, CAmount& nValueRet, bool fFulyMixedOnly, CAmount maxTxFee)
 {
     setCoinsRet.clear();
@@ -258,6 +335,11 @@ bool KnapsackSolver(const CAmount& nTargetValue, std::vector<OutputGroup>& group
 
     Shuffle(groups.begin(), groups.end(), FastRandomContext());
 
+    // Most fully mixed spends are solved exactly from the denomination counts, the search below is the fallback
+    if (fFulyMixedOnly && SelectCoinsDenominated(nTargetValue, groups, setCoinsRet, nValueRet, maxTxFee)) {
+        return true;
+    }
+
     int tryDenomStart = 0;
     CAmount nMinChange = MIN_CHANGE;
 
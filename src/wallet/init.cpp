@@ -21,6 +21,9 @@
 #include <wallet/bdb.h>
 #endif
 #include <wallet/coincontrol.h>
+#ifdef USE_SQLITE
+#include <wallet/sqlite.h>
+#endif
 #include <wallet/wallet.h>
 #include <walletinitinterface.h>
 
@@ -109,9 +112,11 @@ void WalletInit::AddWalletOptions(ArgsManager& argsman) const
 #endif
 
 #ifdef USE_SQLITE
+    argsman.AddArg("-walletsqlitemmap=<n>", strprintf("Read descriptor wallet databases through a memory map of up to <n> MiB, 0 to disable (default: %u)", DEFAULT_SQLITE_MMAP_SIZE), ArgsManager::ALLOW_ANY, OptionsCategory::WALLET);
+    argsman.AddArg("-walletsqlitewal", strprintf("Use a write-ahead log for descriptor wallet databases, which syncs to disk far less often. The most recent wallet changes can be lost on power failure (default: %u)", DEFAULT_SQLITE_WAL), ArgsManager::ALLOW_BOOL, OptionsCategory::WALLET);
     argsman.AddArg("-unsafesqlitesync", "Set SQLite synchronous=OFF to disable waiting for the database to sync to disk. This is unsafe and can cause data loss and corruption. This option is only used by tests to improve their performance (default: false)", ArgsManager::ALLOW_BOOL | ArgsManager::DEBUG_ONLY, OptionsCategory::WALLET_DEBUG_TEST);
 #else
-    argsman.AddHiddenArgs({"-unsafesqlitesync"});
+    argsman.AddHiddenArgs({"-unsafesqlitesync", "-walletsqlitemmap", "-walletsqlitewal"});
 #endif
 
     argsman.AddArg("-walletrejectlongchains", strprintf("Wallet will not create transactions that violate mempool chain limits (default: %u)", DEFAULT_WALLET_REJECT_LONG_CHAINS), ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY, OptionsCategory::WALLET_DEBUG_TEST);
@@ -826,11 +826,11 @@ bool LegacyScriptPubKeyMan::AddKeyPubKeyWithDB(WalletBatch& batch, const CKey& s
     CScript script;
     script = GetScriptForDestination(PKHash(pubkey));
     if (HaveWatchOnly(script)) {
-        RemoveWatchOnly(script);
+        RemoveWatchOnlyWithDB(batch, script);
     }
     script = GetScriptForRawPubKey(pubkey);
     if (HaveWatchOnly(script)) {
-        RemoveWatchOnly(script);
+        RemoveWatchOnlyWithDB(batch, script);
     }
 
     if (!m_storage.HasEncryptionKeys()) {
@@ -1008,6 +1008,12 @@ static bool ExtractPubKey(const CScript &dest, CPubKey& pubKeyOut)
 }
 
 bool LegacyScriptPubKeyMan::RemoveWatchOnly(const CScript &dest)
+{
+    WalletBatch batch(m_storage.GetDatabase());
+    return RemoveWatchOnlyWithDB(batch, dest);
+}
+
+bool LegacyScriptPubKeyMan::RemoveWatchOnlyWithDB(WalletBatch& batch, const CScript& dest)
 {
     {
         LOCK(cs_KeyStore);
@@ -1020,7 +1026,7 @@ bool LegacyScriptPubKeyMan::RemoveWatchOnly(const CScript &dest)
 
     if (!HaveWatchOnly())
         NotifyWatchonlyChanged(false);
-    if (!WalletBatch(m_storage.GetDatabase()).EraseWatchOnly(dest))
+    if (!batch.EraseWatchOnly(dest))
         return false;
 
     return true;
@@ -1131,10 +1137,10 @@ bool LegacyScriptPubKeyMan::AddHDPubKey(WalletBatch &batch, const CExtPubKey &ex
     CScript script;
     script = GetScriptForDestination(PKHash(extPubKey.pubkey));
     if (HaveWatchOnly(script))
-        RemoveWatchOnly(script);
+        RemoveWatchOnlyWithDB(batch, script);
     script = GetScriptForRawPubKey(extPubKey.pubkey);
     if (HaveWatchOnly(script))
-        RemoveWatchOnly(script);
+        RemoveWatchOnlyWithDB(batch, script);
 
     LOCK(cs_KeyStore);
 
@@ -1335,6 +1341,82 @@ void LegacyScriptPubKeyMan::DeriveNewChildKey(WalletBatch &batch, CKeyMetadata&
         throw std::runtime_error(std::string(__func__) + ": AddHDPubKey failed");
 }
 
+std::vector<CPubKey> LegacyScriptPubKeyMan::DeriveNewChildKeys(WalletBatch& batch, uint32_t nAccountIndex, bool fInternal, int64_t count)
+{
+    CHDChain hdChainTmp;
+    if (!GetHDChain(hdChainTmp)) {
+        throw std::runtime_error(std::string(__func__) + ": GetHDChain failed");
+    }
+
+    if (!DecryptHDChain(m_storage.GetEncryptionKey(), hdChainTmp))
+        throw std::runtime_error(std::string(__func__) + ": DecryptHDChain failed");
+    // make sure seed matches this chain
+    if (hdChainTmp.GetID() != hdChainTmp.GetSeedHash())
+        throw std::runtime_error(std::string(__func__) + ": Wrong HD chain!");
+
+    CHDAccount acc;
+    if (!hdChainTmp.GetAccount(nAccountIndex, acc))
+        throw std::runtime_error(std::string(__func__) + ": Wrong HD account!");
+
+    CExtKey changeKey;
+    KeyOriginInfo change_key_origin;
+    hdChainTmp.DeriveChangeExtKey(nAccountIndex, fInternal, changeKey, change_key_origin);
+
+    const int64_t nCreationTime = GetTime();
+    std::vector<CPubKey> ret;
+    ret.reserve(count);
+    // derive child keys from the next index on, skip keys already known to the wallet
+    uint32_t nChildIndex = fInternal ? acc.nInternalChainCounter : acc.nExternalChainCounter;
+    while (int64_t(ret.size()) < count) {
+        CExtKey childKey;
+        changeKey.Derive(childKey, nChildIndex);
+        const CExtPubKey childPubKey = childKey.Neuter();
+        const CPubKey& pubkey = childPubKey.pubkey;
+        if (HaveKey(pubkey.GetID())) {
+            nChildIndex++;
+            continue;
+        }
+        assert(childKey.key.VerifyPubKey(pubkey));
+
+        // store metadata
+        CKeyMetadata metadata(nCreationTime);
+        metadata.key_origin = change_key_origin;
+        metadata.key_origin.path.push_back(nChildIndex);
+        metadata.has_key_origin = true;
+        mapKeyMetadata[pubkey.GetID()] = metadata;
+
+        if (!AddHDPubKey(batch, childPubKey, fInternal))
+            throw std::runtime_error(std::string(__func__) + ": AddHDPubKey failed");
+        ret.push_back(pubkey);
+        nChildIndex++;
+    }
+    UpdateTimeFirstKey(nCreationTime);
+
+    // update the chain model in the database, once for all keys
+    CHDChain hdChainCurrent;
+    GetHDChain(hdChainCurrent);
+
+    if (fInternal) {
+        acc.nInternalChainCounter = nChildIndex;
+    }
+    else {
+        acc.nExternalChainCounter = nChildIndex;
+    }
+
+    if (!hdChainCurrent.SetAccount(nAccountIndex, acc))
+        throw std::runtime_error(std::string(__func__) + ": SetAccount failed");
+
+    if (m_storage.HasEncryptionKeys()) {
+        if (!SetCryptedHDChain(batch, hdChainCurrent, false))
+            throw std::runtime_error(std::string(__func__) + ": SetCryptedHDChain failed");
+    }
+    else {
+        if (!SetHDChain(batch, hdChainCurrent, false))
+            throw std::runtime_error(std::string(__func__) + ": SetHDChain failed");
+    }
+    return ret;
+}
+
 void LegacyScriptPubKeyMan::LoadKeyPool(int64_t nIndex, const CKeyPool &keypool)
 {
     LOCK(cs_KeyStore);
@@ -1443,18 +1525,29 @@ bool LegacyScriptPubKeyMan::TopUpInner(unsigned int kpSize)
             m_storage.UpdateProgress(strMsg, 0);
         }
 
-        bool fInternal = false;
         int64_t current_index{0};
         WalletBatch batch(m_storage.GetDatabase());
-
-        for (current_index = 0; current_index < total_missing; ++current_index) {
-            if (current_index == missingExternal) {
-                fInternal = true;
+        // HD keys are written in one transaction, committed below. Random keys may bump the wallet version with a
+        // batch of its own, which must not wait for this transaction.
+        const bool in_txn = IsHDEnabled() && batch.TxnBegin();
+
+        while (current_index < total_missing) {
+            // HD keys are derived in chunks, which is much faster than one by one and still allows to report progress
+            const bool fInternal = current_index >= missingExternal;
+            const int64_t chunk_size = std::min(TOPUP_CHUNK_SIZE, (fInternal ? total_missing : missingExternal) - current_index);
+
+            if (IsHDEnabled()) {
+                // TODO: implement keypools for all accounts?
+                for (const CPubKey& pubkey : DeriveNewChildKeys(batch, 0, fInternal, chunk_size)) {
+                    AddKeypoolPubkeyWithDB(pubkey, fInternal, batch);
+                }
+            } else {
+                for (int64_t i = 0; i < chunk_size; ++i) {
+                    CPubKey pubkey(GenerateNewKey(batch, 0, fInternal));
+                    AddKeypoolPubkeyWithDB(pubkey, fInternal, batch);
+                }
             }
-
-            // TODO: implement keypools for all accounts?
-            CPubKey pubkey(GenerateNewKey(batch, 0, fInternal));
-            AddKeypoolPubkeyWithDB(pubkey, fInternal, batch);
+            current_index += chunk_size;
 
             if (GetTime() >= progress_report_time + PROGRESS_REPORT_INTERVAL) {
                 const double dProgress = 100.f * current_index / total_missing;
@@ -1466,8 +1559,11 @@ bool LegacyScriptPubKeyMan::TopUpInner(unsigned int kpSize)
                 }
             }
         }
+        if (in_txn && !batch.TxnCommit()) {
+            throw std::runtime_error(std::string(__func__) + ": writing keypool failed");
+        }
         WalletLogPrintf("Keypool added %d keys, size=%u (%u internal)\n",
-                  current_index + 1, setInternalKeyPool.size() + setExternalKeyPool.size(), setInternalKeyPool.size());
+                  current_index, setInternalKeyPool.size() + setExternalKeyPool.size(), setInternalKeyPool.size());
         if (should_show_progress) {
             m_storage.UpdateProgress("", 100);
         }
@@ -1757,6 +1853,36 @@ std::set<CKeyID> LegacyScriptPubKeyMan::GetKeys() const
     return set_address;
 }
 
+std::unordered_set<CScript, SaltedSipHasher> LegacyScriptPubKeyMan::GetScriptPubKeys() const
+{
+    LOCK(cs_KeyStore);
+    std::unordered_set<CScript, SaltedSipHasher> spks;
+
+    // P2PK and P2PKH of all keys, HD ones included
+    const auto add_key = [&](const CKeyID& keyid) {
+        CPubKey pubkey;
+        if (GetPubKey(keyid, pubkey)) {
+            spks.insert(GetScriptForRawPubKey(pubkey));
+        }
+        spks.insert(GetScriptForDestination(PKHash(keyid)));
+    };
+    for (const auto& keyid : GetKeys()) {
+        add_key(keyid);
+    }
+    for (const auto& [keyid, _] : mapHdPubKeys) {
+        add_key(keyid);
+    }
+    // P2SH of the redeem scripts which are solvable
+    for (const auto& scriptid : GetCScripts()) {
+        const CScript spk = GetScriptForDestination(ScriptHash(scriptid));
+        if (IsMine(spk) != ISMINE_NO) {
+            spks.insert(spk);
+        }
+    }
+    spks.insert(setWatchOnly.begin(), setWatchOnly.end());
+    return spks;
+}
+
 bool LegacyScriptPubKeyMan::GetHDChain(CHDChain& hdChainRet) const
 {
     LOCK(cs_KeyStore);
@@ -9,6 +9,7 @@
 #include <script/signingprovider.h>
 #include <script/standard.h>
 #include <util/error.h>
+#include <util/hasher.h>
 #include <util/message.h>
 #include <util/time.h>
 #include <wallet/crypter.h>
@@ -19,6 +20,7 @@
 #include <boost/signals2/signal.hpp>
 
 #include <optional>
+#include <unordered_set>
 
 // Wallet storage things that ScriptPubKeyMans need in order to be able to store things to the wallet database.
 // It provides access to things that are part of the entire wallet and not specific to a ScriptPubKeyMan such as
@@ -49,6 +51,8 @@ public:
 
 //! Default for -keypool
 static const unsigned int DEFAULT_KEYPOOL_SIZE = 1000;
+//! Keys derived between two progress reports while topping up the keypool
+static constexpr int64_t TOPUP_CHUNK_SIZE{100};
 
 std::vector<CKeyID> GetAffectedKeys(const CScript& spk, const SigningProvider& provider);
 
@@ -280,6 +284,8 @@ private:
 
     /* HD derive new child key (on internal or external chain) */
     void DeriveNewChildKey(WalletBatch& batch, CKeyMetadata& metadata, CKey& secretRet, uint32_t nAccountIndex, bool fInternal /*= false*/) EXCLUSIVE_LOCKS_REQUIRED(cs_KeyStore);
+    /* HD derive count new child keys at once, the hardened part of the path is derived only once for all of them */
+    std::vector<CPubKey> DeriveNewChildKeys(WalletBatch& batch, uint32_t nAccountIndex, bool fInternal, int64_t count) EXCLUSIVE_LOCKS_REQUIRED(cs_KeyStore);
 
     std::set<int64_t> setInternalKeyPool GUARDED_BY(cs_KeyStore);
     std::set<int64_t> setExternalKeyPool GUARDED_BY(cs_KeyStore);
@@ -328,6 +334,11 @@ public:
     //! Upgrade stored CKeyMetadata objects to store key origin info as KeyOriginInfo
     void UpgradeKeyMetadata();
 
+    /** All scriptPubKeys which IsMine considers ours, to match them against block filters */
+    std::unordered_set<CScript, SaltedSipHasher> GetScriptPubKeys() const;
+    /** Grows whenever keys are added to the keypool, i.e. when GetScriptPubKeys() may return more */
+    int64_t GetMaxKeypoolIndex() const { return WITH_LOCK(cs_KeyStore, return m_max_keypool_index); }
+
     /* Returns true if HD is enabled */
     bool IsHDEnabled() const override;
 
@@ -405,6 +416,7 @@ public:
     bool HaveWatchOnly() const;
     //! Remove a watch only script from the keystore
     bool RemoveWatchOnly(const CScript &dest);
+    bool RemoveWatchOnlyWithDB(WalletBatch& batch, const CScript& dest);
     //! Adds a watch-only address to the store, and saves it to disk.
     bool AddWatchOnly(const CScript& dest, int64_t nCreateTime) EXCLUSIVE_LOCKS_REQUIRED(cs_KeyStore);
     //! Adds a watch-only address to the store, and saves it to disk.
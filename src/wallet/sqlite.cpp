@@ -22,6 +22,9 @@
 
 static constexpr int32_t WALLET_SCHEMA_VERSION = 0;
 
+/** Sets of prepared statements a database keeps for the next batches */
+static constexpr size_t SQLITE_STATEMENT_CACHE_SIZE{4};
+
 static Mutex g_sqlite_mutex;
 static int g_sqlite_count GUARDED_BY(g_sqlite_mutex) = 0;
 
@@ -103,6 +106,16 @@ SQLiteDatabase::SQLiteDatabase(const fs::path& dir_path, const fs::path& file_pa
 
 void SQLiteBatch::SetupSQLStatements()
 {
+    SQLiteStatements cached;
+    if (m_database.TakeCachedStatements(cached)) {
+        m_read_stmt = cached[0];
+        m_insert_stmt = cached[1];
+        m_overwrite_stmt = cached[2];
+        m_delete_stmt = cached[3];
+        m_cursor_stmt = cached[4];
+        return;
+    }
+
     const std::vector<std::pair<sqlite3_stmt**, const char*>> statements{
         {&m_read_stmt, "SELECT value FROM main WHERE key = ?"},
         {&m_insert_stmt, "INSERT INTO main VALUES(?, ?)"},
@@ -238,6 +251,19 @@ void SQLiteDatabase::Open()
     // Enable fullfsync for the platforms that use it
     SetPragma(m_db, "fullfsync", "true", "Failed to enable fullfsync");
 
+    if (!m_mock && gArgs.GetBoolArg("-walletsqlitewal", DEFAULT_SQLITE_WAL)) {
+        // With the exclusive locking mode the write-ahead log needs no shared memory file. Commits only append to
+        // the log, which is synced when it is checkpointed into the database, so the last transactions before a
+        // power failure can be lost but the database stays consistent.
+        SetPragma(m_db, "journal_mode", "WAL", "Failed to set journal mode to WAL");
+        SetPragma(m_db, "synchronous", "NORMAL", "Failed to set synchronous mode to NORMAL");
+    }
+
+    const int64_t mmap_size = gArgs.GetArg("-walletsqlitemmap", DEFAULT_SQLITE_MMAP_SIZE);
+    if (!m_mock && mmap_size > 0) {
+        SetPragma(m_db, "mmap_size", strprintf("%d", mmap_size << 20), "Failed to set the memory map size");
+    }
+
     if (gArgs.GetBoolArg("-unsafesqlitesync", false)) {
         // Use normal synchronous mode for the journal
         LogPrintf("WARNING SQLite is configured to not wait for data to be flushed to disk. Data loss and corruption may occur.\n");
@@ -318,6 +344,7 @@ bool SQLiteDatabase::Backup(const std::string& dest) const
 
 void SQLiteDatabase::Close()
 {
+    ClearStatementCache();
     int res = sqlite3_close(m_db);
     if (res != SQLITE_OK) {
         throw std::runtime_error(strprintf("SQLiteDatabase: Failed to close database: %s\n", sqlite3_errstr(res)));
@@ -325,6 +352,34 @@ void SQLiteDatabase::Close()
     m_db = nullptr;
 }
 
+bool SQLiteDatabase::TakeCachedStatements(SQLiteStatements& stmts)
+{
+    LOCK(m_stmt_cache_mutex);
+    if (m_stmt_cache.empty()) return false;
+    stmts = m_stmt_cache.back();
+    m_stmt_cache.pop_back();
+    return true;
+}
+
+bool SQLiteDatabase::CacheStatements(const SQLiteStatements& stmts)
+{
+    LOCK(m_stmt_cache_mutex);
+    if (m_stmt_cache.size() >= SQLITE_STATEMENT_CACHE_SIZE) return false;
+    m_stmt_cache.push_back(stmts);
+    return true;
+}
+
+void SQLiteDatabase::ClearStatementCache()
+{
+    LOCK(m_stmt_cache_mutex);
+    for (const auto& stmts : m_stmt_cache) {
+        for (sqlite3_stmt* stmt : stmts) {
+            sqlite3_finalize(stmt);
+        }
+    }
+    m_stmt_cache.clear();
+}
+
 std::unique_ptr<DatabaseBatch> SQLiteDatabase::MakeBatch(bool flush_on_close)
 {
     // We ignore flush_on_close because we don't do manual flushing for SQLite
@@ -351,6 +406,20 @@ void SQLiteBatch::Close()
         }
     }
 
+    // Leave the prepared statements to the next batch if the database still has room for them
+    if (m_database.m_db && m_read_stmt && m_insert_stmt && m_overwrite_stmt && m_delete_stmt && m_cursor_stmt) {
+        const SQLiteStatements stmts{m_read_stmt, m_insert_stmt, m_overwrite_stmt, m_delete_stmt, m_cursor_stmt};
+        for (sqlite3_stmt* stmt : stmts) {
+            sqlite3_clear_bindings(stmt);
+            sqlite3_reset(stmt);
+        }
+        m_cursor_init = false;
+        if (m_database.CacheStatements(stmts)) {
+            m_read_stmt = m_insert_stmt = m_overwrite_stmt = m_delete_stmt = m_cursor_stmt = nullptr;
+            return;
+        }
+    }
+
     // Free all of the prepared statements
     const std::vector<std::pair<sqlite3_stmt**, const char*>> statements{
         {&m_read_stmt, "read"},
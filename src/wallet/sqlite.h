@@ -5,13 +5,25 @@
 #ifndef BITCOIN_WALLET_SQLITE_H
 #define BITCOIN_WALLET_SQLITE_H
 
+#include <sync.h>
 #include <wallet/db.h>
 
 #include <sqlite3.h>
 
+#include <array>
+#include <vector>
+
 struct bilingual_str;
 class SQLiteDatabase;
 
+/** Default for -walletsqlitewal */
+static constexpr bool DEFAULT_SQLITE_WAL{false};
+/** Default for -walletsqlitemmap, in MiB */
+static constexpr int64_t DEFAULT_SQLITE_MMAP_SIZE{0};
+
+/** The read, insert, overwrite, delete and cursor statements of a batch */
+using SQLiteStatements = std::array<sqlite3_stmt*, 5>;
+
 /** RAII class that provides access to a WalletDatabase */
 class SQLiteBatch : public DatabaseBatch
 {
@@ -63,6 +75,13 @@ private:
 
     void Cleanup() noexcept;
 
+    Mutex m_stmt_cache_mutex;
+    /** Prepared statements of closed batches, wallets make a batch for most reads and writes */
+    std::vector<SQLiteStatements> m_stmt_cache GUARDED_BY(m_stmt_cache_mutex);
+
+    /** Finalize the cached statements, they must be gone before the db handle can be closed */
+    void ClearStatementCache();
+
 public:
     SQLiteDatabase() = delete;
 
@@ -110,6 +129,11 @@ public:
     /** Make a SQLiteBatch connected to this database */
     std::unique_ptr<DatabaseBatch> MakeBatch(bool flush_on_close = true) override;
 
+    /** Hand out the statements of a closed batch, false if there are none */
+    bool TakeCachedStatements(SQLiteStatements& stmts);
+    /** Keep the reset statements of a closing batch, false if the cache is full and they must be finalized */
+    bool CacheStatements(const SQLiteStatements& stmts);
+
     sqlite3* m_db{nullptr};
 };
 
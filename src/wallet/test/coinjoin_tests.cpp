@@ -307,4 +307,32 @@ BOOST_FIXTURE_TEST_CASE(CTransactionBuilderTest, CTransactionBuilderTestSetup)
     }
 }
 
+BOOST_FIXTURE_TEST_CASE(coinjoin_denominated_utxo_tests, CTransactionBuilderTestSetup)
+{
+    const CAmount nDenomAmount = CoinJoin::GetSmallestDenomination();
+    const int nDenom = CoinJoin::AmountToDenomination(nDenomAmount);
+    const auto countDenoms = [&]() { return wallet->CountInputsWithAmounts(CoinJoin::GetStandardDenominations()); };
+
+    BOOST_CHECK_EQUAL(countDenoms().size(), CoinJoin::GetStandardDenominations().size());
+    BOOST_CHECK_EQUAL(countDenoms().at(nDenomAmount), 0);
+
+    CompactTallyItem tallyItem = GetTallyItem({nDenomAmount, nDenomAmount, nDenomAmount * 3});
+    BOOST_CHECK_EQUAL(countDenoms().at(nDenomAmount), 2);
+
+    std::vector<CTxDSIn> vecTxDSIn;
+    BOOST_CHECK(wallet->SelectTxDSInsByDenomination(nDenom, CoinJoin::GetMaxPoolAmount(), vecTxDSIn));
+    BOOST_CHECK_EQUAL(vecTxDSIn.size(), 2);
+    // nothing of other denominations
+    BOOST_CHECK(!wallet->SelectTxDSInsByDenomination(CoinJoin::AmountToDenomination(nDenomAmount * 10), CoinJoin::GetMaxPoolAmount(), vecTxDSIn));
+
+    // spent coins are gone from the index right away
+    CTransactionBuilder txBuilder(wallet, tallyItem, *m_node.fee_estimator);
+    CTransactionBuilderOutput* output = txBuilder.AddOutput();
+    BOOST_CHECK(output->UpdateAmount(txBuilder.GetAmountLeft()));
+    bilingual_str strResult;
+    BOOST_CHECK(txBuilder.Commit(strResult));
+    BOOST_CHECK_EQUAL(countDenoms().at(nDenomAmount), 0);
+    BOOST_CHECK(!wallet->SelectTxDSInsByDenomination(nDenom, CoinJoin::GetMaxPoolAmount(), vecTxDSIn));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
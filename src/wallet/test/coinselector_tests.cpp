@@ -3,6 +3,7 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include <amount.h>
+#include <coinjoin/common.h>
 #include <node/context.h>
 #include <primitives/transaction.h>
 #include <random.h>
@@ -583,6 +584,47 @@ BOOST_AUTO_TEST_CASE(knapsack_solver_test)
     empty_wallet();
 }
 
+BOOST_AUTO_TEST_CASE(denominated_selection_test)
+{
+    const auto denoms = CoinJoin::GetStandardDenominations();
+    std::vector<CInputCoin> coins;
+    int nInput = 0;
+    for (int i = 0; i < 3; ++i) add_coin(denoms[0], nInput++, coins);
+    for (int i = 0; i < 5; ++i) add_coin(denoms[1], nInput++, coins);
+    for (int i = 0; i < 20; ++i) add_coin(denoms[2], nInput++, coins);
+    // not a denomination, it's never selected
+    add_coin(3 * COIN, nInput++, coins);
+
+    CoinSet setCoinsRet;
+    CAmount nValueRet;
+
+    // exact match
+    BOOST_CHECK(SelectCoinsDenominated(denoms[0] + 2 * denoms[1] + 3 * denoms[2], GroupCoins(coins), setCoinsRet, nValueRet, 0));
+    BOOST_CHECK_EQUAL(nValueRet, denoms[0] + 2 * denoms[1] + 3 * denoms[2]);
+    BOOST_CHECK_EQUAL(setCoinsRet.size(), 6U);
+
+    // exact match with smaller denominations standing in for a larger one
+    BOOST_CHECK(SelectCoinsDenominated(denoms[0] + 15 * denoms[2], GroupCoins(coins), setCoinsRet, nValueRet, 0));
+    BOOST_CHECK_EQUAL(nValueRet, denoms[0] + denoms[1] + 5 * denoms[2]);
+    BOOST_CHECK_EQUAL(setCoinsRet.size(), 7U);
+
+    // the least excess, and then the fewest inputs: not 25 * denoms[2] or 3 * denoms[1]
+    BOOST_CHECK(SelectCoinsDenominated(250 * CENT, GroupCoins(coins), setCoinsRet, nValueRet, COIN));
+    BOOST_CHECK_EQUAL(nValueRet, 2 * denoms[1] + 5 * denoms[2]);
+    BOOST_CHECK_EQUAL(setCoinsRet.size(), 7U);
+
+    // the excess pays the fee and can't be more than maxTxFee
+    BOOST_CHECK(!SelectCoinsDenominated(250 * CENT, GroupCoins(coins), setCoinsRet, nValueRet, 2000));
+    BOOST_CHECK(setCoinsRet.empty());
+
+    // more than all denominated coins
+    BOOST_CHECK(!SelectCoinsDenominated(3 * denoms[0] + 5 * denoms[1] + 20 * denoms[2] + 1, GroupCoins(coins), setCoinsRet, nValueRet, COIN));
+
+    // the knapsack solver takes it for fully mixed coins
+    BOOST_CHECK(KnapsackSolver(250 * CENT, GroupCoins(coins), setCoinsRet, nValueRet, true, COIN));
+    BOOST_CHECK_EQUAL(nValueRet, 2 * denoms[1] + 5 * denoms[2]);
+}
+
 BOOST_AUTO_TEST_CASE(ApproximateBestSubset)
 {
     CoinSet setCoinsRet;
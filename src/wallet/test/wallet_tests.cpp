@@ -433,13 +433,9 @@ static int64_t AddTx(ChainstateManager& chainman, CWallet& wallet, uint32_t lock
     CBlockIndex* block = nullptr;
     if (blockTime > 0) {
         LOCK(cs_main);
-        auto inserted = chainman.BlockIndex().emplace(GetRandHash(), new CBlockIndex);
-        assert(inserted.second);
-        const uint256& hash = inserted.first->first;
-        block = inserted.first->second;
+        block = chainman.m_blockman.InsertBlockIndex(GetRandHash());
         block->nTime = blockTime;
-        block->phashBlock = &hash;
-        confirm = {CWalletTx::Status::CONFIRMED, block->nHeight, hash, 0};
+        confirm = {CWalletTx::Status::CONFIRMED, block->nHeight, block->GetBlockHash(), 0};
     }
 
     // If transaction is already in map, to avoid inconsistencies, unconfirmation
@@ -628,6 +624,20 @@ public:
     std::unique_ptr<CWallet> wallet;
 };
 
+BOOST_FIXTURE_TEST_CASE(balance_cache, ListCoinsTestingSetup)
+{
+    // Only the coinbase of block 1 is mature, at depth 101
+    BOOST_CHECK_EQUAL(wallet->GetBalance().m_mine_trusted, 500 * COIN);
+    BOOST_CHECK_EQUAL(wallet->GetBalance().m_mine_trusted, 500 * COIN);
+    BOOST_CHECK_EQUAL(wallet->GetBalance(/* min_depth */ 102).m_mine_trusted, 0);
+
+    // Spending it and mining a block, which matures the next coinbase, invalidates the cached balances
+    const CWalletTx& wtx = AddTx(CRecipient{GetScriptForRawPubKey({}), 1 * COIN, false /* subtract fee */});
+    const CAmount fee = WITH_LOCK(wallet->cs_wallet, return wtx.GetDebit(ISMINE_ALL)) - wtx.tx->GetValueOut();
+    BOOST_CHECK_EQUAL(wallet->GetBalance().m_mine_trusted, 1000 * COIN - 1 * COIN - fee);
+    BOOST_CHECK_EQUAL(wallet->GetBalance(/* min_depth */ 2).m_mine_trusted, 500 * COIN);
+}
+
 BOOST_FIXTURE_TEST_CASE(ListCoins, ListCoinsTestingSetup)
 {
     std::string coinbaseAddress = coinbaseKey.GetPubKey().GetID().ToString();
@@ -6,6 +6,7 @@
 
 #include <wallet/wallet.h>
 
+#include <blockfilter.h>
 #include <chain.h>
 #include <chainparams.h>
 #include <consensus/consensus.h>
@@ -577,7 +578,7 @@ bool CWallet::IsSpent(const uint256& hash, unsigned int n) const
 void CWallet::AddToSpends(const COutPoint& outpoint, const uint256& wtxid)
 {
     mapTxSpends.insert(std::make_pair(outpoint, wtxid));
-    setWalletUTXO.erase(outpoint);
+    RemoveWalletUTXO(outpoint);
 
     setLockedCoins.erase(outpoint);
 
@@ -882,7 +883,7 @@ CWalletTx* CWallet::AddToWallet(CTransactionRef tx, const CWalletTx::Confirmatio
         std::vector<std::pair<const CTransactionRef&, unsigned int>> outputs;
         for(unsigned int i = 0; i < wtx.tx->vout.size(); ++i) {
             if (IsMine(wtx.tx->vout[i]) && !IsSpent(hash, i)) {
-                setWalletUTXO.insert(COutPoint(hash, i));
+                AddWalletUTXO(COutPoint(hash, i), wtx.tx->vout[i].nValue);
                 outputs.emplace_back(wtx.tx, i);
             }
         }
@@ -908,7 +909,7 @@ CWalletTx* CWallet::AddToWallet(CTransactionRef tx, const CWalletTx::Confirmatio
         std::vector<std::pair<const CTransactionRef&, unsigned int>> outputs;
         for(unsigned int i = 0; i < wtx.tx->vout.size(); ++i) {
             if (IsMine(wtx.tx->vout[i]) && !IsSpent(hash, i)) {
-                bool new_utxo = setWalletUTXO.insert(COutPoint(hash, i)).second;
+                bool new_utxo = AddWalletUTXO(COutPoint(hash, i), wtx.tx->vout[i].nValue);
                 if (new_utxo) {
                     outputs.emplace_back(wtx.tx, i);
                     fUpdated = true;
@@ -1226,6 +1227,7 @@ void CWallet::transactionAddedToMempool(const CTransactionRef& tx, int64_t nAcce
     auto it = mapWallet.find(tx->GetHash());
     if (it != mapWallet.end()) {
         it->second.fInMempool = true;
+        MarkBalanceDirty();
     }
 }
 
@@ -1235,6 +1237,7 @@ void CWallet::transactionRemovedFromMempool(const CTransactionRef& tx, MemPoolRe
         auto it = mapWallet.find(tx->GetHash());
         if (it != mapWallet.end()) {
             it->second.fInMempool = false;
+            MarkBalanceDirty();
         }
     }
     // Handle transactions that were removed from the mempool because they
@@ -1277,6 +1280,8 @@ void CWallet::blockConnected(const CBlock& block, int height)
 
     m_last_block_processed_height = height;
     m_last_block_processed = block_hash;
+    // the depth of all transactions changed
+    MarkBalanceDirty();
     WalletBatch batch(GetDatabase());
     for (size_t index = 0; index < block.vtx.size(); index++) {
         SyncTransaction(block.vtx[index], {CWalletTx::Status::CONFIRMED, height, block_hash, (int)index}, batch);
@@ -1298,6 +1303,7 @@ void CWallet::blockDisconnected(const CBlock& block, int height)
     // future with a stickier abandoned state or even removing abandontransaction call.
     m_last_block_processed_height = height - 1;
     m_last_block_processed = block.hashPrevBlock;
+    MarkBalanceDirty();
     WalletBatch batch(GetDatabase());
     for (const CTransactionRef& ptx : block.vtx) {
         SyncTransaction(ptx, {CWalletTx::Status::UNCONFIRMED, /* block height */ 0, /* block hash */ {}, /* index */ 0}, batch);
@@ -1921,6 +1927,43 @@ int64_t CWallet::RescanFromTime(int64_t startTime, const WalletRescanReserver& r
     return startTime;
 }
 
+namespace {
+/** Matches the scriptPubKeys of a wallet against BIP 157 block filters, so a rescan only reads blocks which may pay or spend them */
+class FastWalletRescanFilter
+{
+public:
+    explicit FastWalletRescanFilter(const CWallet& wallet) : m_wallet(wallet)
+    {
+        UpdateIfNeeded();
+    }
+
+    void UpdateIfNeeded()
+    {
+        // the scripts only become more when the keypool is topped up after a payment to one of its keys was found
+        const LegacyScriptPubKeyMan* spk_man = m_wallet.GetLegacyScriptPubKeyMan();
+        const int64_t max_keypool_index = spk_man ? spk_man->GetMaxKeypoolIndex() : 0;
+        if (m_filter_set && max_keypool_index == m_max_keypool_index) return;
+        m_max_keypool_index = max_keypool_index;
+        m_filter_set.emplace();
+        if (spk_man) {
+            for (const auto& script : spk_man->GetScriptPubKeys()) {
+                m_filter_set->emplace(script.begin(), script.end());
+            }
+        }
+    }
+
+    std::optional<bool> MatchesBlock(const uint256& block_hash) const
+    {
+        return m_wallet.chain().blockFilterMatchesAny(BlockFilterType::BASIC_FILTER, block_hash, *m_filter_set);
+    }
+
+private:
+    const CWallet& m_wallet;
+    std::optional<GCSFilter::ElementSet> m_filter_set;
+    int64_t m_max_keypool_index{0};
+};
+} // namespace
+
 /**
  * Scan the block chain (starting in start_block) for transactions
  * from or to us. If fUpdate is true, found transactions that already
@@ -1954,7 +1997,11 @@ CWallet::ScanResult CWallet::ScanForWalletTransactions(const uint256& start_bloc
     uint256 block_hash = start_block;
     ScanResult result;
 
-    WalletLogPrintf("Rescan started from block %s...\n", start_block.ToString());
+    std::unique_ptr<FastWalletRescanFilter> fast_rescan_filter;
+    if (chain().hasBlockFilterIndex(BlockFilterType::BASIC_FILTER)) fast_rescan_filter = std::make_unique<FastWalletRescanFilter>(*this);
+
+    WalletLogPrintf("Rescan started from block %s... (%s)\n", start_block.ToString(),
+                    fast_rescan_filter ? "fast variant using block filters" : "slow variant inspecting all blocks");
 
     ShowProgress(strprintf("%s " + _("Rescanning...").translated, GetDisplayName()), 0); // show rescan progress in GUI as dialog or on splashscreen, if -rescan on startup
     uint256 tip_hash = WITH_LOCK(cs_wallet, return GetLastBlockHash());
@@ -1979,36 +2026,51 @@ CWallet::ScanResult CWallet::ScanForWalletTransactions(const uint256& start_bloc
             WalletLogPrintf("Still rescanning. At block %d. Progress=%f\n", block_height, progress_current);
         }
 
-        // Read block data
-        CBlock block;
-        chain().findBlock(block_hash, FoundBlock().data(block));
+        bool fetch_block = true;
+        if (fast_rescan_filter) {
+            fast_rescan_filter->UpdateIfNeeded();
+            const auto matches_block = fast_rescan_filter->MatchesBlock(block_hash);
+            // blocks the index has no filter for yet are read
+            if (matches_block.has_value() && !*matches_block) {
+                // nothing in the block can be ours, it is scanned
+                result.last_scanned_block = block_hash;
+                result.last_scanned_height = block_height;
+                fetch_block = false;
+            }
+        }
 
-        // Find next block separately from reading data above, because reading
+        // Find next block separately from reading data below, because reading
         // is slow and there might be a reorg while it is read.
         bool block_still_active = false;
         bool next_block = false;
         uint256 next_block_hash;
         chain().findBlock(block_hash, FoundBlock().inActiveChain(block_still_active).nextBlock(FoundBlock().inActiveChain(next_block).hash(next_block_hash)));
 
-        if (!block.IsNull()) {
-            LOCK(cs_wallet);
-            if (!block_still_active) {
-                // Abort scan if current block is no longer active, to prevent
-                // marking transactions as coming from the wrong block.
+        if (fetch_block) {
+            // Read block data
+            CBlock block;
+            chain().findBlock(block_hash, FoundBlock().data(block));
+
+            if (!block.IsNull()) {
+                LOCK(cs_wallet);
+                if (!block_still_active) {
+                    // Abort scan if current block is no longer active, to prevent
+                    // marking transactions as coming from the wrong block.
+                    result.last_failed_block = block_hash;
+                    result.status = ScanResult::FAILURE;
+                    break;
+                }
+                for (size_t posInBlock = 0; posInBlock < block.vtx.size(); ++posInBlock) {
+                    SyncTransaction(block.vtx[posInBlock], {CWalletTx::Status::CONFIRMED, block_height, block_hash, (int)posInBlock}, batch, fUpdate);
+                }
+                // scan succeeded, record block as most recent successfully scanned
+                result.last_scanned_block = block_hash;
+                result.last_scanned_height = block_height;
+            } else {
+                // could not scan block, keep scanning but record this block as the most recent failure
                 result.last_failed_block = block_hash;
                 result.status = ScanResult::FAILURE;
-                break;
             }
-            for (size_t posInBlock = 0; posInBlock < block.vtx.size(); ++posInBlock) {
-                SyncTransaction(block.vtx[posInBlock], {CWalletTx::Status::CONFIRMED, block_height, block_hash, (int)posInBlock}, batch, fUpdate);
-            }
-            // scan succeeded, record block as most recent successfully scanned
-            result.last_scanned_block = block_hash;
-            result.last_scanned_height = block_height;
-        } else {
-            // could not scan block, keep scanning but record this block as the most recent failure
-            result.last_failed_block = block_hash;
-            result.status = ScanResult::FAILURE;
         }
         if (max_height && block_height >= *max_height) {
             break;
@@ -2433,21 +2495,55 @@ void MaybeResendWalletTxs()
  */
 
 
+bool CWallet::AddWalletUTXO(const COutPoint& outpoint, CAmount nValue)
+{
+    AssertLockHeld(cs_wallet);
+
+    if (!setWalletUTXO.insert(outpoint).second) return false;
+    MarkBalanceDirty();
+    if (CoinJoin::IsDenominatedAmount(nValue)) {
+        mapDenominatedUTXO[nValue].insert(outpoint);
+    }
+    return true;
+}
+
+bool CWallet::RemoveWalletUTXO(const COutPoint& outpoint)
+{
+    AssertLockHeld(cs_wallet);
+
+    if (setWalletUTXO.erase(outpoint) == 0) return false;
+    MarkBalanceDirty();
+    const auto it = mapWallet.find(outpoint.hash);
+    if (it != mapWallet.end() && outpoint.n < it->second.tx->vout.size()) {
+        const auto jt = mapDenominatedUTXO.find(it->second.tx->vout[outpoint.n].nValue);
+        if (jt != mapDenominatedUTXO.end()) {
+            jt->second.erase(outpoint);
+        }
+    }
+    return true;
+}
+
 std::unordered_set<const CWalletTx*, WalletTxHasher> CWallet::GetSpendableTXs() const
+{
+    AssertLockHeld(cs_wallet);
+    return GetSpendableTXs(setWalletUTXO);
+}
+
+std::unordered_set<const CWalletTx*, WalletTxHasher> CWallet::GetSpendableTXs(const std::set<COutPoint>& setUTXO) const
 {
     AssertLockHeld(cs_wallet);
 
     std::unordered_set<const CWalletTx*, WalletTxHasher> ret;
-    for (auto it = setWalletUTXO.begin(); it != setWalletUTXO.end(); ) {
+    for (auto it = setUTXO.begin(); it != setUTXO.end(); ) {
         const auto& outpoint = *it;
         const auto jt = mapWallet.find(outpoint.hash);
         if (jt != mapWallet.end()) {
             ret.emplace(&jt->second);
         }
 
-        // setWalletUTXO is sorted by COutPoint, which means that all UTXOs for the same TX are neighbors
+        // setUTXO is sorted by COutPoint, which means that all UTXOs for the same TX are neighbors
         // skip entries until we encounter a new TX
-        while (it != setWalletUTXO.end() && it->hash == outpoint.hash) {
+        while (it != setUTXO.end() && it->hash == outpoint.hash) {
             ++it;
         }
     }
@@ -2460,6 +2556,19 @@ CWallet::Balance CWallet::GetBalance(const int min_depth, const bool avoid_reuse
     isminefilter reuse_filter = avoid_reuse ? ISMINE_NO : ISMINE_USED;
     {
         LOCK(cs_wallet);
+        // the version is read before the balance is calculated, a change while doing so makes the result stale
+        const uint64_t balance_version = m_balance_version;
+        if (m_balance_cache_version != balance_version) {
+            m_balance_cache.clear();
+            m_balance_cache_version = balance_version;
+        }
+        const auto cache_key = std::make_tuple(min_depth, avoid_reuse, fAddLocked,
+                                               CCoinJoinClientOptions::IsEnabled() ? CCoinJoinClientOptions::GetRounds() : -1);
+        if (coinControl == nullptr) {
+            if (const auto it = m_balance_cache.find(cache_key); it != m_balance_cache.end()) {
+                return it->second;
+            }
+        }
         std::set<uint256> trusted_parents;
         for (auto pcoin : GetSpendableTXs()) {
             const bool is_trusted{pcoin->IsTrusted(trusted_parents)};
@@ -2482,6 +2591,9 @@ CWallet::Balance CWallet::GetBalance(const int min_depth, const bool avoid_reuse
                 ret.m_denominated_untrusted_pending += pcoin->GetDenominatedCredit(true);
             }
         }
+        if (coinControl == nullptr) {
+            m_balance_cache.emplace(cache_key, ret);
+        }
     }
     return ret;
 }
@@ -2583,8 +2695,16 @@ void CWallet::AvailableCoins(std::vector<COutput> &vCoins, bool fOnlySafe, const
     const int min_depth = {coinControl ? coinControl->m_min_depth : DEFAULT_MIN_DEPTH};
     const int max_depth = {coinControl ? coinControl->m_max_depth : DEFAULT_MAX_DEPTH};
 
+    // Coins of a single denomination are indexed, only look at the txes which have some
+    static const std::set<COutPoint> setNoUTXO;
+    const std::set<COutPoint>* pSetUTXO = &setWalletUTXO;
+    if ((nCoinType == CoinType::ONLY_FULLY_MIXED || nCoinType == CoinType::ONLY_READY_TO_MIX) && nMinimumAmount == nMaximumAmount) {
+        const auto it = mapDenominatedUTXO.find(nMinimumAmount);
+        pSetUTXO = it != mapDenominatedUTXO.end() ? &it->second : &setNoUTXO;
+    }
+
     std::set<uint256> trusted_parents;
-    for (auto pcoin : GetSpendableTXs()) {
+    for (auto pcoin : GetSpendableTXs(*pSetUTXO)) {
         const uint256& wtxid = pcoin->GetHash();
 
         if (!chain().checkFinalTx(*pcoin->tx))
@@ -2611,6 +2731,9 @@ void CWallet::AvailableCoins(std::vector<COutput> &vCoins, bool fOnlySafe, const
         }
 
         for (unsigned int i = 0; i < pcoin->tx->vout.size(); i++) {
+            if (pcoin->tx->vout[i].nValue < nMinimumAmount || pcoin->tx->vout[i].nValue > nMaximumAmount)
+                continue;
+
             bool found = false;
             if (nCoinType == CoinType::ONLY_FULLY_MIXED) {
                 if (!CoinJoin::IsDenominatedAmount(pcoin->tx->vout[i].nValue)) continue;
@@ -2630,9 +2753,6 @@ void CWallet::AvailableCoins(std::vector<COutput> &vCoins, bool fOnlySafe, const
             }
             if(!found) continue;
 
-            if (pcoin->tx->vout[i].nValue < nMinimumAmount || pcoin->tx->vout[i].nValue > nMaximumAmount)
-                continue;
-
             if (coinControl && coinControl->HasSelected() && !coinControl->fAllowOtherInputs && !coinControl->IsSelected(COutPoint(wtxid, i)))
                 continue;
 
@@ -3180,7 +3300,7 @@ bool CWallet::SelectTxDSInsByDenomination(int nDenom, CAmount nValueMax, std::ve
 
     CCoinControl coin_control;
     coin_control.nCoinType = CoinType::ONLY_READY_TO_MIX;
-    AvailableCoins(vCoins, true, &coin_control);
+    AvailableCoins(vCoins, true, &coin_control, nDenomAmount, nDenomAmount);
     WalletCJLogPrint((*this), "CWallet::%s -- vCoins.size(): %d\n", __func__, vCoins.size());
 
     Shuffle(vCoins.rbegin(), vCoins.rend(), FastRandomContext());
@@ -3395,22 +3515,28 @@ bool CWallet::SelectDenominatedAmounts(CAmount nValueMax, std::set<CAmount>& set
     return nValueTotal >= CoinJoin::GetSmallestDenomination();
 }
 
-int CWallet::CountInputsWithAmount(CAmount nInputAmount) const
+std::map<CAmount, int> CWallet::CountInputsWithAmounts(Span<const CAmount> amounts) const
 {
-    CAmount nTotal = 0;
+    std::map<CAmount, int> mapCounts;
+    for (const auto nAmount : amounts) {
+        mapCounts.emplace(nAmount, 0);
+    }
 
     LOCK(cs_wallet);
 
-    for (const auto& outpoint : setWalletUTXO) {
-        const auto it = mapWallet.find(outpoint.hash);
-        if (it == mapWallet.end()) continue;
-        if (it->second.tx->vout[outpoint.n].nValue != nInputAmount) continue;
-        if (it->second.GetDepthInMainChain() < 0) continue;
+    for (auto& [nAmount, nCount] : mapCounts) {
+        const auto denomIt = mapDenominatedUTXO.find(nAmount);
+        if (denomIt == mapDenominatedUTXO.end()) continue;
+        for (const auto& outpoint : denomIt->second) {
+            const auto it = mapWallet.find(outpoint.hash);
+            if (it == mapWallet.end()) continue;
+            if (it->second.GetDepthInMainChain() < 0) continue;
 
-        nTotal++;
+            nCount++;
+        }
     }
 
-    return nTotal;
+    return mapCounts;
 }
 
 bool CWallet::HasCollateralInputs(bool fOnlyConfirmed) const
@@ -3892,7 +4018,7 @@ DBErrors CWallet::LoadWallet(bool& fFirstRunRet)
             for (auto& pair : mapWallet) {
                 for(unsigned int i = 0; i < pair.second.tx->vout.size(); ++i) {
                     if (IsMine(pair.second.tx->vout[i]) && !IsSpent(pair.first, i)) {
-                        setWalletUTXO.insert(COutPoint(pair.first, i));
+                        AddWalletUTXO(COutPoint(pair.first, i), pair.second.tx->vout[i].nValue);
                     }
                 }
             }
@@ -5155,6 +5281,7 @@ void CWallet::notifyTransactionLock(const CTransactionRef &tx, const std::shared
     uint256 txHash = tx->GetHash();
     std::map<uint256, CWalletTx>::const_iterator mi = mapWallet.find(txHash);
     if (mi != mapWallet.end()){
+        MarkBalanceDirty();
         NotifyTransactionChanged(this, txHash, CT_UPDATED);
         NotifyISLockReceived();
 #if HAVE_SYSTEM
@@ -5179,6 +5306,7 @@ void CWallet::notifyTransactionLock(const CTransactionRef &tx, const std::shared
 
 void CWallet::notifyChainLock(const CBlockIndex* pindexChainLock, const std::shared_ptr<const llmq::CChainLockSig>& clsig)
 {
+    MarkBalanceDirty();
     NotifyChainLockReceived(pindexChainLock->nHeight);
 }
 
@@ -5219,6 +5347,20 @@ CKeyPool::CKeyPool(const CPubKey& vchPubKeyIn, bool fInternalIn)
     fInternal = fInternalIn;
 }
 
+void CWalletTx::MarkDirty()
+{
+    m_amounts[DEBIT].Reset();
+    m_amounts[CREDIT].Reset();
+    m_amounts[ANON_CREDIT].Reset();
+    m_amounts[DENOM_CREDIT].Reset();
+    m_amounts[DENOM_UCREDIT].Reset();
+    m_amounts[IMMATURE_CREDIT].Reset();
+    m_amounts[AVAILABLE_CREDIT].Reset();
+    fChangeCached = false;
+    m_is_cache_empty = true;
+    pwallet->MarkBalanceDirty();
+}
+
 int CWalletTx::GetDepthInMainChain() const
 {
     assert(pwallet != nullptr);
@@ -38,6 +38,7 @@
 #include <stdexcept>
 #include <stdint.h>
 #include <string>
+#include <tuple>
 #include <unordered_set>
 #include <utility>
 #include <vector>
@@ -470,18 +471,8 @@ public:
     }
 
     //! make sure balances are recalculated
-    void MarkDirty()
-    {
-        m_amounts[DEBIT].Reset();
-        m_amounts[CREDIT].Reset();
-        m_amounts[ANON_CREDIT].Reset();
-        m_amounts[DENOM_CREDIT].Reset();
-        m_amounts[DENOM_UCREDIT].Reset();
-        m_amounts[IMMATURE_CREDIT].Reset();
-        m_amounts[AVAILABLE_CREDIT].Reset();
-        fChangeCached = false;
-        m_is_cache_empty = true;
-    }
+    //! make sure balances are recalculated, also the ones cached by the wallet
+    void MarkDirty();
 
     const CWallet* GetWallet() const
     {
@@ -711,8 +702,14 @@ private:
     void AddToSpends(const uint256& wtxid) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
 
     std::set<COutPoint> setWalletUTXO;
+    /** The outpoints of setWalletUTXO which have a denominated amount, by amount */
+    std::map<CAmount, std::set<COutPoint>> mapDenominatedUTXO GUARDED_BY(cs_wallet);
     mutable std::map<COutPoint, int> mapOutpointRoundsCache;
 
+    /** Keep setWalletUTXO and mapDenominatedUTXO in sync, returns false if the outpoint was known/unknown already */
+    bool AddWalletUTXO(const COutPoint& outpoint, CAmount nValue) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+    bool RemoveWalletUTXO(const COutPoint& outpoint) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+
     /**
      * Add a transaction to the wallet, or update it.  pIndex and posInBlock should
      * be set when the transaction was known to be included in a block.  When
@@ -770,6 +767,7 @@ private:
 
     // A helper function which loops through wallet UTXOs
     std::unordered_set<const CWalletTx*, WalletTxHasher> GetSpendableTXs() const EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+    std::unordered_set<const CWalletTx*, WalletTxHasher> GetSpendableTXs(const std::set<COutPoint>& setUTXO) const EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
 
     /**
      * The following is used to keep track of how far behind the wallet is
@@ -920,7 +918,8 @@ public:
     std::vector<CompactTallyItem> SelectCoinsGroupedByAddresses(bool fSkipDenominated = true, bool fAnonymizable = true, bool fSkipUnconfirmed = true, int nMaxOupointsPerAddress = -1) const;
 
     bool HasCollateralInputs(bool fOnlyConfirmed = true) const;
-    int  CountInputsWithAmount(CAmount nInputAmount) const;
+    /** Count the inputs with each of the given denominated amounts, other amounts are never counted */
+    std::map<CAmount, int> CountInputsWithAmounts(Span<const CAmount> amounts) const;
 
     // get the CoinJoin chain depth for a given input
     int GetRealOutpointCoinJoinRounds(const COutPoint& outpoint, int nRounds = 0) const;
@@ -1040,7 +1039,16 @@ public:
         CAmount m_denominated_trusted{0};
         CAmount m_denominated_untrusted_pending{0};
     };
+    /** Cached until anything changes which the balance depends on, unless a coinControl is given */
     Balance GetBalance(const int min_depth = 0, const bool avoid_reuse = true, const bool fAddLocked = false, const CCoinControl* coinControl = nullptr) const;
+    /** Invalidate the cached GetBalance() results, is called whenever a transaction, its depth or lock status changes */
+    void MarkBalanceDirty() const { ++m_balance_version; }
+private:
+    //! GetBalance() results by min_depth, avoid_reuse, fAddLocked and CoinJoin rounds, valid for m_balance_cache_version
+    mutable std::map<std::tuple<int, bool, bool, int>, Balance> m_balance_cache GUARDED_BY(cs_wallet);
+    mutable uint64_t m_balance_cache_version GUARDED_BY(cs_wallet){0};
+    mutable std::atomic<uint64_t> m_balance_version{0};
+public:
 
     CAmount GetAnonymizableBalance(bool fSkipDenominated = false, bool fSkipUnconfirmed = true) const;
     float GetAverageAnonymizedRounds() const;
@@ -1385,6 +1393,7 @@ public:
         AssertLockHeld(cs_wallet);
         m_last_block_processed_height = block_height;
         m_last_block_processed = block_hash;
+        MarkBalanceDirty();
     };
 
     //! Connect the signals from ScriptPubKeyMans to the signals in CWallet
@@ -105,6 +105,7 @@ bool CZMQNotificationInterface::Initialize()
         }
     }
 
+    StartZmqPublisher();
     return true;
 }
 
@@ -114,6 +115,8 @@ void CZMQNotificationInterface::Shutdown()
     LogPrint(BCLog::ZMQ, "zmq: Shutdown notification interface\n");
     if (pcontext)
     {
+        // sends what is still queued, the sockets belong to this thread again afterwards
+        StopZmqPublisher();
         for (auto& notifier : notifiers) {
             LogPrint(BCLog::ZMQ, "zmq: Shutdown notifier %s at %s\n", notifier->GetType(), notifier->GetAddress());
             notifier->Shutdown();
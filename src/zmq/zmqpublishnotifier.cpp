@@ -8,6 +8,10 @@
 #include <chainparams.h>
 #include <node/blockstorage.h>
 #include <streams.h>
+#include <sync.h>
+#include <tinyformat.h>
+#include <util/perfcounters.h>
+#include <util/thread.h>
 #include <validation.h>
 #include <zmq/zmqutil.h>
 
@@ -20,10 +24,12 @@
 
 #include <zmq.h>
 
-#include <cstdarg>
+#include <condition_variable>
 #include <cstddef>
+#include <deque>
 #include <map>
 #include <string>
+#include <thread>
 #include <utility>
 
 static std::multimap<std::string, CZMQAbstractPublishNotifier*> mapPublishNotifiers;
@@ -47,47 +53,124 @@ static const char *MSG_RAWGOBJ       = "rawgovernanceobject";
 static const char *MSG_RAWISCON      = "rawinstantsenddoublespend";
 static const char *MSG_RAWRECSIG     = "rawrecoveredsig";
 
-// Internal function to send multipart message
-static int zmq_send_multipart(void *sock, const void* data, size_t size, ...)
+namespace {
+
+struct ZmqQueuedMessage {
+    CZMQAbstractPublishNotifier* notifier;
+    const char* command;
+    CZMQAbstractPublishNotifier::PayloadFunc payload;
+    uint32_t sequence;
+};
+
+/**
+ * All publish notifiers queue their messages here and one thread sends them, so that validation callbacks don't
+ * wait for sockets and that messages sharing a socket keep their order. The sequence numbers are assigned when
+ * queueing, a message dropped later still uses its number so subscribers see the gap.
+ */
+Mutex g_zmq_queue_mutex;
+std::condition_variable g_zmq_queue_cond;
+std::deque<ZmqQueuedMessage> g_zmq_queue GUARDED_BY(g_zmq_queue_mutex);
+bool g_zmq_publisher_running GUARDED_BY(g_zmq_queue_mutex){false};
+bool g_zmq_publisher_stop GUARDED_BY(g_zmq_queue_mutex){false};
+std::thread g_zmq_publisher_thread;
+
+void CountDropped(const char* command)
 {
-    va_list args;
-    va_start(args, size);
+    perf::GetCounter(strprintf("zmq.dropped.%s", command), "ZMQ messages dropped because the queue or a subscriber was full").Add();
+}
 
-    while (1)
-    {
-        zmq_msg_t msg;
+void FreePayload(void* /* data */, void* hint)
+{
+    delete static_cast<std::shared_ptr<const CDataStream>*>(hint);
+}
 
-        int rc = zmq_msg_init_size(&msg, size);
-        if (rc != 0)
-        {
-            zmqError("Unable to initialize ZMQ msg");
-            va_end(args);
-            return -1;
-        }
+// Send one part, without blocking when the high water mark of the socket is reached
+int SendPart(void* sock, const void* data, size_t size, int flags)
+{
+    zmq_msg_t msg;
+    if (zmq_msg_init_size(&msg, size) != 0) {
+        zmqError("Unable to initialize ZMQ msg");
+        return -1;
+    }
+    memcpy(zmq_msg_data(&msg), data, size);
+    int rc = zmq_msg_send(&msg, sock, flags | ZMQ_DONTWAIT);
+    if (rc == -1) zmq_msg_close(&msg);
+    return rc;
+}
 
-        void *buf = zmq_msg_data(&msg);
-        memcpy(buf, data, size);
+// Like SendPart, but zmq keeps a reference to payload instead of copying it
+int SendPart(void* sock, const std::shared_ptr<const CDataStream>& payload, int flags)
+{
+    zmq_msg_t msg;
+    auto hint = new std::shared_ptr<const CDataStream>(payload);
+    if (zmq_msg_init_data(&msg, const_cast<std::byte*>(payload->data()), payload->size(), FreePayload, hint) != 0) {
+        delete hint;
+        zmqError("Unable to initialize ZMQ msg");
+        return -1;
+    }
+    int rc = zmq_msg_send(&msg, sock, flags | ZMQ_DONTWAIT);
+    if (rc == -1) zmq_msg_close(&msg);
+    return rc;
+}
 
-        data = va_arg(args, const void*);
+// The subscriptions an XPUB socket hands up are not needed, read them so they don't pile up
+void DrainSubscriptions(void* sock)
+{
+#ifdef ZMQ_XPUB_NODROP
+    unsigned char buf[256];
+    while (zmq_recv(sock, buf, sizeof(buf), ZMQ_DONTWAIT) != -1) {}
+#endif
+}
 
-        rc = zmq_msg_send(&msg, sock, data ? ZMQ_SNDMORE : 0);
-        if (rc == -1)
-        {
-            zmqError("Unable to send ZMQ msg");
-            zmq_msg_close(&msg);
-            va_end(args);
-            return -1;
-        }
+void PublisherThread()
+{
+    WAIT_LOCK(g_zmq_queue_mutex, lock);
+    while (true) {
+        g_zmq_queue_cond.wait(lock, []() EXCLUSIVE_LOCKS_REQUIRED(g_zmq_queue_mutex) { return g_zmq_publisher_stop || !g_zmq_queue.empty(); });
+        if (g_zmq_queue.empty()) break;
+        ZmqQueuedMessage message = std::move(g_zmq_queue.front());
+        g_zmq_queue.pop_front();
+        REVERSE_LOCK(lock);
+        message.notifier->SendQueued(message.command, message.payload, message.sequence);
+    }
+}
 
-        zmq_msg_close(&msg);
+std::shared_ptr<const CDataStream> ReadBlockData(const CBlockIndex* pindex, const llmq::CChainLockSig* clsig = nullptr)
+{
+    auto ss = std::make_shared<CDataStream>(SER_NETWORK, PROTOCOL_VERSION);
+    LOCK(cs_main);
+    CBlock block;
+    if (!ReadBlockFromDisk(block, pindex, Params().GetConsensus())) {
+        zmqError("Can't read block from disk");
+        return nullptr;
+    }
+    *ss << block;
+    if (clsig) *ss << *clsig;
+    return ss;
+}
 
-        if (!data)
-            break;
+} // namespace
 
-        size = va_arg(args, size_t);
+void StartZmqPublisher()
+{
+    LOCK(g_zmq_queue_mutex);
+    assert(!g_zmq_publisher_running);
+    g_zmq_publisher_running = true;
+    g_zmq_publisher_stop = false;
+    g_zmq_publisher_thread = std::thread(&util::TraceThread, "zmqpub", &PublisherThread);
+}
+
+void StopZmqPublisher()
+{
+    {
+        LOCK(g_zmq_queue_mutex);
+        if (!g_zmq_publisher_running) return;
+        g_zmq_publisher_stop = true;
     }
-    va_end(args);
-    return 0;
+    g_zmq_queue_cond.notify_one();
+    g_zmq_publisher_thread.join();
+    LOCK(g_zmq_queue_mutex);
+    g_zmq_publisher_running = false;
 }
 
 bool CZMQAbstractPublishNotifier::Initialize(void *pcontext)
@@ -99,7 +182,12 @@ bool CZMQAbstractPublishNotifier::Initialize(void *pcontext)
 
     if (i==mapPublishNotifiers.end())
     {
+#ifdef ZMQ_XPUB_NODROP
+        // an XPUB socket reports a full subscriber instead of dropping silently like PUB
+        psocket = zmq_socket(pcontext, ZMQ_XPUB);
+#else
         psocket = zmq_socket(pcontext, ZMQ_PUB);
+#endif
         if (!psocket)
         {
             zmqError("Failed to create socket");
@@ -116,6 +204,16 @@ bool CZMQAbstractPublishNotifier::Initialize(void *pcontext)
             return false;
         }
 
+#ifdef ZMQ_XPUB_NODROP
+        const int nodrop_option {1};
+        rc = zmq_setsockopt(psocket, ZMQ_XPUB_NODROP, &nodrop_option, sizeof(nodrop_option));
+        if (rc != 0) {
+            zmqError("Failed to set ZMQ_XPUB_NODROP");
+            zmq_close(psocket);
+            return false;
+        }
+#endif
+
         const int so_keepalive_option {1};
         rc = zmq_setsockopt(psocket, ZMQ_TCP_KEEPALIVE, &so_keepalive_option, sizeof(so_keepalive_option));
         if (rc != 0) {
@@ -180,21 +278,67 @@ void CZMQAbstractPublishNotifier::Shutdown()
 
 bool CZMQAbstractPublishNotifier::SendZmqMessage(const char *command, const void* data, size_t size)
 {
-    assert(psocket);
+    auto ss = std::make_shared<CDataStream>(SER_NETWORK, PROTOCOL_VERSION);
+    ss->write(MakeByteSpan(Span{static_cast<const unsigned char*>(data), size}));
+    return SendZmqMessage(command, std::shared_ptr<const CDataStream>(std::move(ss)));
+}
 
-    /* send three parts, command & data & a LE 4byte sequence number */
-    unsigned char msgseq[sizeof(uint32_t)];
-    WriteLE32(msgseq, nSequence);
-    int rc = zmq_send_multipart(psocket, command, strlen(command), data, size, msgseq, (size_t)sizeof(uint32_t), nullptr);
-    if (rc == -1)
-        return false;
+bool CZMQAbstractPublishNotifier::SendZmqMessage(const char *command, std::shared_ptr<const CDataStream> data)
+{
+    return SendZmqMessage(command, [data = std::move(data)] { return data; });
+}
 
-    /* increment memory only sequence number after sending */
-    nSequence++;
+bool CZMQAbstractPublishNotifier::SendZmqMessage(const char *command, PayloadFunc payload)
+{
+    assert(psocket);
 
+    bool running;
+    uint32_t sequence;
+    {
+        LOCK(g_zmq_queue_mutex);
+        running = g_zmq_publisher_running && !g_zmq_publisher_stop;
+        sequence = nSequence++;
+        if (running) {
+            if (g_zmq_queue.size() >= MAX_ZMQ_PUBLISH_QUEUE) {
+                CountDropped(command);
+                return true;
+            }
+            g_zmq_queue.push_back({this, command, std::move(payload), sequence});
+        }
+    }
+    if (running) {
+        g_zmq_queue_cond.notify_one();
+    } else {
+        SendQueued(command, payload, sequence);
+    }
     return true;
 }
 
+void CZMQAbstractPublishNotifier::SendQueued(const char *command, const PayloadFunc& payload, uint32_t sequence)
+{
+    assert(psocket);
+
+    DrainSubscriptions(psocket);
+    const auto data = payload();
+    if (!data) return;
+
+    /* send three parts, command & data & a LE 4byte sequence number */
+    unsigned char msgseq[sizeof(uint32_t)];
+    WriteLE32(msgseq, sequence);
+    // once the first part is accepted zmq takes the rest of the message too
+    if (SendPart(psocket, command, strlen(command), ZMQ_SNDMORE) == -1) {
+        if (zmq_errno() == EAGAIN) {
+            CountDropped(command);
+        } else {
+            zmqError("Unable to send ZMQ msg");
+        }
+        return;
+    }
+    if (SendPart(psocket, data, ZMQ_SNDMORE) == -1 || SendPart(psocket, msgseq, sizeof(msgseq), 0) == -1) {
+        zmqError("Unable to send ZMQ msg");
+    }
+}
+
 bool CZMQPublishHashBlockNotifier::NotifyBlock(const CBlockIndex *pindex)
 {
     uint256 hash = pindex->GetBlockHash();
@@ -281,129 +425,88 @@ bool CZMQPublishRawBlockNotifier::NotifyBlock(const CBlockIndex *pindex)
 {
     LogPrint(BCLog::ZMQ, "zmq: Publish rawblock %s to %s\n", pindex->GetBlockHash().GetHex(), this->address);
 
-    const Consensus::Params& consensusParams = Params().GetConsensus();
-    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
-    {
-        LOCK(cs_main);
-        CBlock block;
-        if(!ReadBlockFromDisk(block, pindex, consensusParams))
-        {
-            zmqError("Can't read block from disk");
-            return false;
-        }
-
-        ss << block;
-    }
-
-    return SendZmqMessage(MSG_RAWBLOCK, &(*ss.begin()), ss.size());
+    // read on the publisher thread, not in the validation callback
+    return SendZmqMessage(MSG_RAWBLOCK, [pindex] { return ReadBlockData(pindex); });
 }
 
 bool CZMQPublishRawChainLockNotifier::NotifyChainLock(const CBlockIndex *pindex, const std::shared_ptr<const llmq::CChainLockSig>& clsig)
 {
     LogPrint(BCLog::ZMQ, "zmq: Publish rawchainlock %s\n", pindex->GetBlockHash().GetHex());
 
-    const Consensus::Params& consensusParams = Params().GetConsensus();
-    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
-    {
-        LOCK(cs_main);
-        CBlock block;
-        if(!ReadBlockFromDisk(block, pindex, consensusParams))
-        {
-            zmqError("Can't read block from disk");
-            return false;
-        }
-
-        ss << block;
-    }
-
-    return SendZmqMessage(MSG_RAWCHAINLOCK, &(*ss.begin()), ss.size());
+    return SendZmqMessage(MSG_RAWCHAINLOCK, [pindex] { return ReadBlockData(pindex); });
 }
 
 bool CZMQPublishRawChainLockSigNotifier::NotifyChainLock(const CBlockIndex *pindex, const std::shared_ptr<const llmq::CChainLockSig>& clsig)
 {
     LogPrint(BCLog::ZMQ, "zmq: Publish rawchainlocksig %s\n", pindex->GetBlockHash().GetHex());
 
-    const Consensus::Params& consensusParams = Params().GetConsensus();
-    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
-    {
-        LOCK(cs_main);
-        CBlock block;
-        if(!ReadBlockFromDisk(block, pindex, consensusParams))
-        {
-            zmqError("Can't read block from disk");
-            return false;
-        }
-
-        ss << block;
-        ss << *clsig;
-    }
-
-    return SendZmqMessage(MSG_RAWCLSIG, &(*ss.begin()), ss.size());
+    return SendZmqMessage(MSG_RAWCLSIG, [pindex, clsig] { return ReadBlockData(pindex, clsig.get()); });
 }
 
 bool CZMQPublishRawTransactionNotifier::NotifyTransaction(const CTransaction &transaction)
 {
     uint256 hash = transaction.GetHash();
     LogPrint(BCLog::ZMQ, "zmq: Publish rawtx %s to %s\n", hash.GetHex(), this->address);
-    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
-    ss << transaction;
-    return SendZmqMessage(MSG_RAWTX, &(*ss.begin()), ss.size());
+    auto ss = std::make_shared<CDataStream>(SER_NETWORK, PROTOCOL_VERSION);
+    *ss << transaction;
+    return SendZmqMessage(MSG_RAWTX, ss);
 }
 
 bool CZMQPublishRawTransactionLockNotifier::NotifyTransactionLock(const CTransactionRef& transaction, const std::shared_ptr<const llmq::CInstantSendLock>& islock)
 {
     uint256 hash = transaction->GetHash();
     LogPrint(BCLog::ZMQ, "zmq: Publish rawtxlock %s to %s\n", hash.GetHex(), this->address);
-    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
-    ss << *transaction;
-    return SendZmqMessage(MSG_RAWTXLOCK, &(*ss.begin()), ss.size());
+    auto ss = std::make_shared<CDataStream>(SER_NETWORK, PROTOCOL_VERSION);
+    *ss << *transaction;
+    return SendZmqMessage(MSG_RAWTXLOCK, ss);
 }
 
 bool CZMQPublishRawTransactionLockSigNotifier::NotifyTransactionLock(const CTransactionRef& transaction, const std::shared_ptr<const llmq::CInstantSendLock>& islock)
 {
     uint256 hash = transaction->GetHash();
     LogPrint(BCLog::ZMQ, "zmq: Publish rawtxlocksig %s to %s\n", hash.GetHex(), this->address);
-    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
-    ss << *transaction;
-    ss << *islock;
-    return SendZmqMessage(MSG_RAWTXLOCKSIG, &(*ss.begin()), ss.size());
+    auto ss = std::make_shared<CDataStream>(SER_NETWORK, PROTOCOL_VERSION);
+    *ss << *transaction;
+    *ss << *islock;
+    return SendZmqMessage(MSG_RAWTXLOCKSIG, ss);
 }
 
 bool CZMQPublishRawGovernanceVoteNotifier::NotifyGovernanceVote(const std::shared_ptr<const CGovernanceVote>& vote)
 {
     uint256 nHash = vote->GetHash();
     LogPrint(BCLog::ZMQ, "zmq: Publish rawgovernanceobject: hash = %s to %s, vote = %d\n", nHash.ToString(), this->address, vote->ToString());
-    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
-    ss << *vote;
-    return SendZmqMessage(MSG_RAWGVOTE, &(*ss.begin()), ss.size());
+    auto ss = std::make_shared<CDataStream>(SER_NETWORK, PROTOCOL_VERSION);
+    *ss << *vote;
+    return SendZmqMessage(MSG_RAWGVOTE, ss);
 }
 
 bool CZMQPublishRawGovernanceObjectNotifier::NotifyGovernanceObject(const std::shared_ptr<const Governance::Object>& govobj)
 {
     uint256 nHash = govobj->GetHash();
     LogPrint(BCLog::ZMQ, "zmq: Publish rawgovernanceobject: hash = %s to %s, type = %d\n", nHash.ToString(), this->address, ToUnderlying(govobj->type));
-    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
-    ss << *govobj;
-    return SendZmqMessage(MSG_RAWGOBJ, &(*ss.begin()), ss.size());
+    auto ss = std::make_shared<CDataStream>(SER_NETWORK, PROTOCOL_VERSION);
+    *ss << *govobj;
+    return SendZmqMessage(MSG_RAWGOBJ, ss);
 }
 
 bool CZMQPublishRawInstantSendDoubleSpendNotifier::NotifyInstantSendDoubleSpendAttempt(const CTransactionRef& currentTx, const CTransactionRef& previousTx)
 {
     LogPrint(BCLog::ZMQ, "zmq: Publish rawinstantsenddoublespend %s conflicts with %s\n", currentTx->GetHash().ToString(), previousTx->GetHash().ToString());
-    CDataStream ssCurrent(SER_NETWORK, PROTOCOL_VERSION), ssPrevious(SER_NETWORK, PROTOCOL_VERSION);
-    ssCurrent << *currentTx;
-    ssPrevious << *previousTx;
-    return SendZmqMessage(MSG_RAWISCON, &(*ssCurrent.begin()), ssCurrent.size())
-        && SendZmqMessage(MSG_RAWISCON, &(*ssPrevious.begin()), ssPrevious.size());
+    auto ssCurrent = std::make_shared<CDataStream>(SER_NETWORK, PROTOCOL_VERSION);
+    auto ssPrevious = std::make_shared<CDataStream>(SER_NETWORK, PROTOCOL_VERSION);
+    *ssCurrent << *currentTx;
+    *ssPrevious << *previousTx;
+    return SendZmqMessage(MSG_RAWISCON, ssCurrent)
+        && SendZmqMessage(MSG_RAWISCON, ssPrevious);
 }
 
 bool CZMQPublishRawRecoveredSigNotifier::NotifyRecoveredSig(const std::shared_ptr<const llmq::CRecoveredSig>& sig)
 {
     LogPrint(BCLog::ZMQ, "zmq: Publish rawrecoveredsig %s\n", sig->getMsgHash().ToString());
 
-    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
-    ss << *sig;
+    auto ss = std::make_shared<CDataStream>(SER_NETWORK, PROTOCOL_VERSION);
+    *ss << *sig;
 
-    return SendZmqMessage(MSG_RAWRECSIG, &(*ss.begin()), ss.size());
+    return SendZmqMessage(MSG_RAWRECSIG, ss);
 }
 
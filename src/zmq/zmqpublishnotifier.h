@@ -7,7 +7,12 @@
 
 #include <zmq/zmqabstractnotifier.h>
 
+#include <cstdint>
+#include <functional>
+#include <memory>
+
 class CBlockIndex;
+class CDataStream;
 class CGovernanceVote;
 
 namespace Governance
@@ -16,20 +21,37 @@ namespace Governance
 } //namespace Governance
 
 
+/** Messages waiting for the publisher thread beyond this many are dropped */
+static constexpr size_t MAX_ZMQ_PUBLISH_QUEUE{10000};
+
+/**
+ * Start the thread which sends the messages of all publish notifiers. Their sockets are only used by it until
+ * StopZmqPublisher(), which sends what is still queued.
+ */
+void StartZmqPublisher();
+void StopZmqPublisher();
+
 class CZMQAbstractPublishNotifier : public CZMQAbstractNotifier
 {
 private:
-    uint32_t nSequence {0U}; //!< upcounting per message sequence number
+    uint32_t nSequence {0U}; //!< upcounting per message sequence number, assigned when a message is queued
 
 public:
+    //! Makes the data of a message on the publisher thread, nullptr if it can't
+    using PayloadFunc = std::function<std::shared_ptr<const CDataStream>()>;
 
-    /* send zmq multipart message
+    /* queue zmq multipart message for the publisher thread
        parts:
           * command
           * data
           * message sequence number
     */
     bool SendZmqMessage(const char *command, const void* data, size_t size);
+    bool SendZmqMessage(const char *command, std::shared_ptr<const CDataStream> data);
+    bool SendZmqMessage(const char *command, PayloadFunc payload);
+
+    /** Send a message on the publisher thread, the data is handed to zmq without a copy */
+    void SendQueued(const char *command, const PayloadFunc& payload, uint32_t sequence);
 
     bool Initialize(void *pcontext) override;
     void Shutdown() override;
@@ -11,9 +11,8 @@ import binascii
 
 from test_framework.messages import COIN, COutPoint, CTransaction, CTxIn, CTxOut
 from test_framework.test_framework import BitcoinTestFramework
-from test_framework.test_node import ErrorMatch
 from test_framework.script import CScript, OP_CHECKSIG, OP_DUP, OP_EQUAL, OP_EQUALVERIFY, OP_HASH160
-from test_framework.util import assert_equal
+from test_framework.util import assert_equal, assert_raises_rpc_error
 
 class AddressIndexTest(BitcoinTestFramework):
 
@@ -40,15 +39,11 @@ class AddressIndexTest(BitcoinTestFramework):
         self.import_deterministic_coinbase_privkeys()
 
     def run_test(self):
-        self.log.info("Test that settings can't be changed without -reindex...")
-        self.stop_node(1)
-        self.nodes[1].assert_start_raises_init_error(["-addressindex=0"], "You need to rebuild the database using -reindex to change -addressindex", match=ErrorMatch.PARTIAL_REGEX)
-        self.start_node(1, ["-addressindex=0", "-reindex"])
+        self.log.info("Test that the index can be toggled without -reindex...")
+        self.restart_node(1, ["-addressindex=0"])
         self.connect_nodes(0, 1)
         self.sync_all()
-        self.stop_node(1)
-        self.nodes[1].assert_start_raises_init_error(["-addressindex"], "You need to rebuild the database using -reindex to change -addressindex", match=ErrorMatch.PARTIAL_REGEX)
-        self.start_node(1, ["-addressindex", "-reindex"])
+        self.restart_node(1, ["-addressindex"])
         self.connect_nodes(0, 1)
         self.sync_all()
 
@@ -150,6 +145,19 @@ class AddressIndexTest(BitcoinTestFramework):
         assert_equal(len(txidsmany), 4)
         assert_equal(txidsmany[3], sent_txid)
 
+        # Check that txids can be paged
+        self.log.info("Testing paged txids...")
+        paged_txids = []
+        page = self.nodes[1].getaddresstxids({"addresses": ["93bVhahvUKmQu8gu9g3QnPPa2cxFK98pMB"], "limit": 1})
+        while True:
+            paged_txids += page["txids"]
+            if "cursor" not in page:
+                break
+            page = self.nodes[1].getaddresstxids({"addresses": ["93bVhahvUKmQu8gu9g3QnPPa2cxFK98pMB"], "limit": 1, "cursor": page["cursor"]})
+        assert_equal(paged_txids, txidsmany)
+        assert_raises_rpc_error(-8, "Limit is only supported for a single address", self.nodes[1].getaddresstxids,
+                                {"addresses": ["93bVhahvUKmQu8gu9g3QnPPa2cxFK98pMB", "yMNJePdcKvXtWWQnFYHNeJ5u8TF2v1dfK4"], "limit": 1})
+
         # Check that balances are correct
         self.log.info("Testing balances...")
         balance0 = self.nodes[1].getaddressbalance("93bVhahvUKmQu8gu9g3QnPPa2cxFK98pMB")
@@ -176,6 +184,7 @@ class AddressIndexTest(BitcoinTestFramework):
         self.sync_all()
         balance1 = self.nodes[1].getaddressbalance(address2)
         assert_equal(balance1["balance"], amount)
+        assert_equal(balance1["tx_count"], 1)
 
         tx = CTransaction()
         tx.vin = [CTxIn(COutPoint(int(spending_txid, 16), 0))]
@@ -191,6 +200,8 @@ class AddressIndexTest(BitcoinTestFramework):
 
         balance2 = self.nodes[1].getaddressbalance(address2)
         assert_equal(balance2["balance"], change_amount)
+        assert_equal(balance2["received"], amount + change_amount)
+        assert_equal(balance2["tx_count"], 2)
 
         # Check that deltas are returned correctly
         deltas = self.nodes[1].getaddressdeltas({"addresses": [address2], "start": 0, "end": 200})
@@ -209,6 +220,14 @@ class AddressIndexTest(BitcoinTestFramework):
         deltas = self.nodes[1].getaddressdeltas({"addresses": [address2], "start": 113, "end": 113})
         assert_equal(len(deltas), 1)
 
+        # Check that deltas can be paged
+        page = self.nodes[1].getaddressdeltas({"addresses": [address2], "limit": 1})
+        assert_equal(page["deltas"], deltasAll[:1])
+        page = self.nodes[1].getaddressdeltas({"addresses": [address2], "limit": len(deltasAll), "cursor": page["cursor"]})
+        assert_equal(page["deltas"], deltasAll[1:])
+        assert "cursor" not in page
+        assert_raises_rpc_error(-8, "Invalid cursor", self.nodes[1].getaddressdeltas, {"addresses": [address2], "limit": 1, "cursor": "00"})
+
         # Check that unspent outputs can be queried
         self.log.info("Testing utxos...")
         utxos = self.nodes[1].getaddressutxos({"addresses": [address2]})
@@ -0,0 +1,183 @@
+#!/usr/bin/env python3
+# Copyright (c) 2026 The Dash Core developers
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+'''
+feature_llmq_is_load.py
+
+Sends a steady stream of InstantSend transactions through a regtest
+masternode network and reports how the quorums keep up with it:
+islock and ChainLock latencies, recovered sigs per second and the
+bandwidth used by sig shares.
+
+Not run by default, use e.g.
+    feature_llmq_is_load.py --txrate=20 --duration=60 --output=load.json
+'''
+
+import json
+import time
+
+from test_framework.test_framework import DashTestFramework
+from test_framework.util import assert_greater_than
+
+# Messages which carry sig shares and their announcements between quorum members
+SIG_SHARE_MESSAGES = ["qsigsesann", "qsigsinv", "qgetsigs", "qbsigs", "qsigshare"]
+
+
+def percentiles(values):
+    if not values:
+        return None
+    values = sorted(values)
+    def at(p):
+        return values[(len(values) - 1) * p // 100]
+    return {
+        "count": len(values),
+        "p50_ms": at(50),
+        "p90_ms": at(90),
+        "p99_ms": at(99),
+        "max_ms": values[-1],
+    }
+
+
+class LLMQISLoadTest(DashTestFramework):
+    def set_test_params(self):
+        # -whitelist is needed to avoid the trickling logic, the latencies would mostly measure it otherwise
+        self.set_dash_test_params(5, 4, [["-whitelist=127.0.0.1"]] * 5, fast_dip3_enforcement=True)
+
+    def add_options(self, parser):
+        parser.add_argument("--txrate", dest="txrate", default=5, type=float,
+                            help="Transactions sent per second (default: %(default)s)")
+        parser.add_argument("--duration", dest="duration", default=30, type=float,
+                            help="Seconds to send transactions for (default: %(default)s)")
+        parser.add_argument("--blockinterval", dest="blockinterval", default=5, type=float,
+                            help="Seconds between blocks while sending (default: %(default)s)")
+        parser.add_argument("--utxos", dest="utxos", default=200, type=int,
+                            help="Number of coins the sending wallet is split into first (default: %(default)s)")
+        parser.add_argument("--output", dest="output", default=None,
+                            help="Write the results as JSON to this file instead of only logging them")
+
+    def run_test(self):
+        self.activate_dip8()
+
+        self.nodes[0].sporkupdate("SPORK_17_QUORUM_DKG_ENABLED", 0)
+        self.wait_for_sporks_same()
+
+        self.activate_v19(expected_activation_height=900)
+        self.move_to_next_cycle()
+        self.move_to_next_cycle()
+        self.move_to_next_cycle()
+        self.mine_cycle_quorum(llmq_type_name='llmq_test_dip0024', llmq_type=103)
+        self.wait_for_chainlocked_block_all_nodes(self.nodes[0].getbestblockhash(), timeout=30)
+
+        self.prepare_coins()
+        results = self.generate_load()
+
+        self.log.info("Results: %s" % json.dumps(results, indent=1))
+        if self.options.output is not None:
+            with open(self.options.output, 'w', encoding='utf8') as f:
+                json.dump(results, f, indent=1)
+
+        assert results["islock_latency"] is not None
+        assert_greater_than(max(results["recovered_sigs_per_node"]), 0)
+
+    def prepare_coins(self):
+        node = self.nodes[0]
+        self.log.info("Splitting the wallet into %d coins" % self.options.utxos)
+        remaining = self.options.utxos
+        while remaining > 0:
+            count = min(remaining, 100)
+            node.sendmany("", {node.getnewaddress(): 1 for _ in range(count)})
+            remaining -= count
+        self.bump_mocktime(1)
+        block = node.generate(1)[0]
+        self.wait_for_chainlocked_block_all_nodes(block, timeout=30)
+
+    def recovered_sigs(self):
+        return [node.getperfcounters().get("llmq.recsigs.accepted", {}).get("value", 0) for node in self.nodes]
+
+    def sig_share_bytes(self):
+        total = 0
+        for node in self.nodes:
+            for peer in node.getpeerinfo():
+                total += sum(peer["bytessent_per_msg"].get(msg, 0) for msg in SIG_SHARE_MESSAGES)
+        return total
+
+    def generate_load(self):
+        node = self.nodes[0]
+        txrate = self.options.txrate
+        duration = self.options.duration
+        self.log.info("Sending %s tx/s for %s s" % (txrate, duration))
+
+        recsigs_start = self.recovered_sigs()
+        sig_share_bytes_start = self.sig_share_bytes()
+
+        pending_txs = {}    # txid -> time it was sent
+        pending_blocks = {} # block hash -> time it was mined
+        islock_latencies = []
+        chainlock_latencies = []
+        sent = 0
+        failed = 0
+
+        start = time.time()
+        last_bump = start
+        last_block = start
+        # Keep polling after the last transaction until everything is locked or it is clear it won't be
+        while True:
+            now = time.time()
+            sending = now - start < duration
+            if not sending and ((not pending_txs and not pending_blocks) or now - start > duration + 60):
+                break
+
+            if sending:
+                while sent + failed < (now - start) * txrate:
+                    try:
+                        txid = node.sendtoaddress(node.getnewaddress(), 0.01)
+                        pending_txs[txid] = time.time()
+                        sent += 1
+                    except Exception as e:
+                        self.log.debug("sendtoaddress failed: %s" % e)
+                        failed += 1
+
+            for txid in list(pending_txs):
+                if node.getrawtransaction(txid, True)["instantlock"]:
+                    islock_latencies.append(int((time.time() - pending_txs.pop(txid)) * 1000))
+
+            if sending and now - last_block >= self.options.blockinterval:
+                pending_blocks[node.generate(1)[0]] = time.time()
+                last_block = now
+
+            for block_hash in list(pending_blocks):
+                if node.getblock(block_hash)["chainlock"]:
+                    chainlock_latencies.append(int((time.time() - pending_blocks.pop(block_hash)) * 1000))
+
+            # Nothing which times out or retries should stall because mocktime does not move
+            if now - last_bump >= 1:
+                self.bump_mocktime(1)
+                last_bump = now
+            time.sleep(0.05)
+
+        elapsed = time.time() - start
+        recsigs = [end - begin for begin, end in zip(recsigs_start, self.recovered_sigs())]
+        sig_share_bytes = self.sig_share_bytes() - sig_share_bytes_start
+
+        return {
+            "txrate": txrate,
+            "duration_s": duration,
+            "elapsed_s": round(elapsed, 3),
+            "txs_sent": sent,
+            "txs_failed": failed,
+            "txs_not_islocked": len(pending_txs),
+            "blocks_not_chainlocked": len(pending_blocks),
+            "islock_latency": percentiles(islock_latencies),
+            "chainlock_latency": percentiles(chainlock_latencies),
+            "recovered_sigs_per_node": recsigs,
+            "recovered_sigs_per_s": round(max(recsigs) / elapsed, 3),
+            "sig_share_bytes": sig_share_bytes,
+            "sig_share_bytes_per_s": round(sig_share_bytes / elapsed, 1),
+            "sig_share_bytes_per_islock": round(sig_share_bytes / len(islock_latencies), 1) if islock_latencies else None,
+        }
+
+
+if __name__ == '__main__':
+    LLMQISLoadTest().main()
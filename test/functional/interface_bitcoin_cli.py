@@ -5,6 +5,7 @@
 """Test dash-cli"""
 
 from decimal import Decimal
+import json
 
 from test_framework.blocktools import COINBASE_MATURITY
 from test_framework.test_framework import BitcoinTestFramework
@@ -61,6 +62,15 @@ class TestBitcoinCli(BitcoinTestFramework):
         assert_equal(['foo', 'bar'], self.nodes[0].cli('-rpcuser={}'.format(user), '-stdin', '-stdinrpcpass', input=password + '\nfoo\nbar').echo())
         assert_raises_process_error(1, 'Incorrect rpcuser or rpcpassword', self.nodes[0].cli('-rpcuser={}'.format(user), '-stdin', '-stdinrpcpass', input='foo').echo)
 
+        self.log.info("Test -batch runs the commands of standard input and prints the replies in order")
+        commands = ["getblockcount", "# a comment", "", '["echo", "a b", 1]'] + ["getblockhash {}".format(h) for h in range(10)]
+        replies = [json.loads(line) for line in self.nodes[0].cli('-batch', '-batchsize=3', '-batchconnections=2', input="\n".join(commands)).send_cli().splitlines()]
+        assert_equal([reply["id"] for reply in replies], list(range(1, 13)))
+        assert_equal(replies[0]["result"], BLOCKS)
+        assert_equal(replies[1]["result"], ["a b", "1"])
+        assert_equal([reply["result"] for reply in replies[2:]], [self.nodes[0].getblockhash(h) for h in range(10)])
+        assert_raises_process_error(1, "", self.nodes[0].cli('-batch', input="getblockcount\ngetblockhash foo").send_cli)
+
         self.log.info("Test connecting to a non-existing server")
         assert_raises_process_error(1, "Could not connect to the server", self.nodes[0].cli('-rpcport=1').echo)
 
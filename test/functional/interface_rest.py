@@ -247,6 +247,8 @@ class RESTTest (BitcoinTestFramework):
         assert_greater_than(int(response_hex.getheader('content-length')), BLOCK_HEADER_SIZE*2)
         response_hex_bytes = response_hex.read().strip(b'\n')
         assert_equal(binascii.hexlify(response_bytes), response_hex_bytes)
+        # The block is served as it is stored, which must match its serialization
+        assert_equal(response_hex_bytes.decode(), self.nodes[0].getblock(bb_hash, 0))
 
         # Compare with hex block header
         response_header_hex = self.test_rest_request("/headers/1/{}".format(bb_hash), req_type=ReqType.HEX, ret_type=RetType.OBJ)
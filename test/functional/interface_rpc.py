@@ -74,6 +74,28 @@ class RPCInterfaceTest(BitcoinTestFramework):
         assert_equal(result_by_id[3]['error'], None)
         assert result_by_id[3]['result'] is not None
 
+    def test_parallel_batch_request(self):
+        self.log.info("Testing JSON-RPC batch request with batch threads...")
+        self.restart_node(0, ['-rpcbatchthreads=4'])
+
+        calls = []
+        for i in range(100):
+            if i % 10 == 3:
+                calls.append({"method": "invalidmethod", "id": i})
+            else:
+                calls.append({"method": "getblockhash", "id": i, "params": [0]})
+        results = self.nodes[0].batch(calls)
+
+        # The results are in the order of the requests
+        assert_equal([res["id"] for res in results], list(range(100)))
+        genesis_hash = self.nodes[0].getblockhash(0)
+        for res in results:
+            if res["id"] % 10 == 3:
+                assert_equal(res['error']['code'], -32601)
+            else:
+                assert_equal(res['error'], None)
+                assert_equal(res['result'], genesis_hash)
+
     def test_http_status_codes(self):
         self.log.info("Testing HTTP status codes for JSON-RPC requests...")
 
@@ -92,11 +114,25 @@ class RPCInterfaceTest(BitcoinTestFramework):
         for t in threads:
             t.join()
 
+        self.log.info("Testing slow work queue exceeded...")
+        self.restart_node(0, ['-rpcworkqueue=1', '-rpcslowthreads=1', '-rpcslowmethods=getrpcinfo'])
+        got_exceeded_error = []
+        threads = []
+        for _ in range(3):
+            t = Thread(target=test_work_queue_getblock, args=(self.nodes[0], got_exceeded_error))
+            t.start()
+            threads.append(t)
+        for t in threads:
+            t.join()
+        # The default work queue is not affected
+        assert_equal(self.nodes[0].getblockcount(), 0)
+
     def run_test(self):
         self.test_getrpcinfo()
         self.test_batch_request()
         self.test_http_status_codes()
         self.test_work_queue_exceeded()
+        self.test_parallel_batch_request()
 
 
 if __name__ == '__main__':
@@ -84,6 +84,7 @@ EXTENDED_SCRIPTS = [
     # Longest test should go first, to favor running tests in parallel
     'feature_pruning.py', # NOTE: Prune mode is incompatible with -txindex, should work with governance validation disabled though.
     'feature_dbcrash.py',
+    'feature_llmq_is_load.py', # NOTE: a load generator, see its --txrate, --duration and --output options
 ]
 
 BASE_SCRIPTS = [